@@ -81,6 +81,20 @@ generating aggregated SDFormat descriptions for sdformat.org, please install \
 ignition-tools.")
 endif()
 
+################################################
+# Find zlib and zstd for reading compressed SDFormat and URDF files
+find_package(ZLIB QUIET)
+if (NOT ZLIB_FOUND)
+  BUILD_WARNING("zlib not found. Gzip compressed files will not be read.")
+endif()
+
+if (PKG_CONFIG_FOUND)
+  pkg_check_modules(ZSTD libzstd)
+endif()
+if (NOT ZSTD_FOUND)
+  BUILD_WARNING("libzstd not found. Zstandard compressed files will not be read.")
+endif()
+
 ################################################
 # Find the Python interpreter for running the
 # check_test_ran.py script
@@ -93,6 +107,13 @@ if(NOT PY_PSUTIL)
   BUILD_WARNING("Python psutil package not found. Memory leak tests will be skipped")
 endif()
 
+################################################
+# Find Google Benchmark for the benchmarks in test/benchmark
+find_package(benchmark QUIET)
+if (NOT benchmark_FOUND)
+  BUILD_WARNING("Google Benchmark not found. Benchmarks will not be built.")
+endif()
+
 ################################################
 # Find Valgrind for checking memory leaks in the
 # tests
@@ -110,6 +131,15 @@ if (NOT RUBY)
     BUILD_ERROR ("Ruby version 1.9 is needed to build xml schemas")
 else()
     message(STATUS "Found ruby executable: ${RUBY}")
+
+    # sdf/embedSdf.rb parses the spec files with REXML, which is a bundled
+    # gem rather than a default one since Ruby 3.0.
+    execute_process(COMMAND ${RUBY} -e "require 'rexml/document'"
+      RESULT_VARIABLE RUBY_REXML_RESULT
+      OUTPUT_QUIET ERROR_QUIET)
+    if (NOT RUBY_REXML_RESULT EQUAL 0)
+      BUILD_ERROR ("The rexml ruby gem is needed to embed the SDF spec")
+    endif()
 endif()
 
 #################################################
@@ -19,6 +19,8 @@
 
 #include <memory>
 #include <string>
+#include <string_view>
+#include <vector>
 
 #include <ignition/math/Pose3.hh>
 
@@ -47,6 +49,20 @@ namespace sdf
   // Forward declare private data class.
   class ActorPrivate;
 
+  /// \enum TrajectoryInterpolation
+  /// \brief How the pose of a trajectory is interpolated between its
+  /// waypoints.
+  enum class TrajectoryInterpolation
+  {
+    /// \brief Positions are interpolated linearly.
+    LINEAR = 0,
+
+    /// \brief Positions are interpolated with a cardinal spline through
+    /// the waypoints, whose tangents are scaled by one minus the tension of
+    /// the trajectory. A tension of 0 is a Catmull-Rom spline.
+    SPLINE = 1,
+  };
+
   /// \brief Animation in Actor.
   class SDFORMAT_VISIBLE Animation
   {
@@ -264,6 +280,37 @@ namespace sdf
     /// \param[in] _waypoint Waypoint to be added.
     public: void AddWaypoint(const Waypoint &_waypoint);
 
+    /// \brief Get the pose of the trajectory at a time, interpolated
+    /// between the waypoints before and after it, in the order of their
+    /// times. The rotation is interpolated spherically. The waypoint is
+    /// found with a binary search of a time index kept by the trajectory.
+    /// \param[in] _time Time of the pose. The pose before the first
+    /// waypoint is that of the first one, and the pose after the last
+    /// waypoint is that of the last one, so looping scripts should wrap
+    /// the time themselves.
+    /// \param[in] _interpolation How positions are interpolated.
+    /// \return The pose, or a zero pose if there are no waypoints.
+    public: ignition::math::Pose3d PoseAt(double _time,
+                TrajectoryInterpolation _interpolation =
+                    TrajectoryInterpolation::SPLINE) const;
+
+    /// \brief Get the poses of several trajectories, such as those of the
+    /// actors of a crowd, each at its own time.
+    /// \param[in] _trajectories The trajectories. A null trajectory has a
+    /// zero pose.
+    /// \param[in] _times Time of each trajectory, of the same size as
+    /// _trajectories.
+    /// \param[out] _poses Set to the pose of each trajectory, as with
+    /// PoseAt. Its memory is reused if it is large enough.
+    /// \param[in] _interpolation How positions are interpolated.
+    /// \sa PoseAt
+    public: static void PosesAt(
+                const std::vector<const Trajectory *> &_trajectories,
+                const std::vector<double> &_times,
+                std::vector<ignition::math::Pose3d> &_poses,
+                TrajectoryInterpolation _interpolation =
+                    TrajectoryInterpolation::SPLINE);
+
     /// \brief Copy trajectory from a trajectory instance.
     /// \param[in] _trajectory The trajectory to set values from.
     public: void CopyFrom(const Trajectory &_trajectory);
@@ -414,7 +461,7 @@ namespace sdf
     /// \brief Get whether an animation name exists.
     /// \param[in] _name Name of the animation to check.
     /// \return True if there exists an animation with the given name.
-    public: bool AnimationNameExists(const std::string &_name) const;
+    public: bool AnimationNameExists(std::string_view _name) const;
 
     /// \brief Add a new animation.
     /// \param[in] _anim Animation to be added.
@@ -480,7 +527,7 @@ namespace sdf
     /// \brief Get whether a link name exists.
     /// \param[in] _name Name of the link to check.
     /// \return True if there exists a link with the given name.
-    public: bool LinkNameExists(const std::string &_name) const;
+    public: bool LinkNameExists(std::string_view _name) const;
 
     /// \brief Get the number of joints.
     /// \return Number of joints.
@@ -496,7 +543,7 @@ namespace sdf
     /// \brief Get whether a joint name exists.
     /// \param[in] _name Name of the joint to check.
     /// \return True if there exists a joint with the given name.
-    public: bool JointNameExists(const std::string &_name) const;
+    public: bool JointNameExists(std::string_view _name) const;
 
     /// \brief Get a pointer to the SDF element that was used during
     /// load.
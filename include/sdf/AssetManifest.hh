@@ -0,0 +1,91 @@
+/*
+ * Copyright 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef SDF_ASSETMANIFEST_HH_
+#define SDF_ASSETMANIFEST_HH_
+
+#include <string>
+#include <vector>
+
+#include "sdf/sdf_config.h"
+
+namespace sdf
+{
+  // Inline bracket to help doxygen filtering.
+  inline namespace SDF_VERSION_NAMESPACE {
+  //
+
+  /// \enum AssetType
+  /// \brief The kinds of files referenced by a document.
+  enum class AssetType
+  {
+    /// \brief A mesh, such as the mesh of a geometry or the skin of an
+    /// actor.
+    MESH,
+
+    /// \brief A texture of a material, such as a normal map or a map of a
+    /// PBR workflow.
+    TEXTURE,
+
+    /// \brief An animation of an actor.
+    ANIMATION,
+  };
+
+  /// \brief A use of an asset by a DOM object.
+  struct AssetReference
+  {
+    /// \brief Scoped name of the object that references the asset, such as
+    /// "world::model::link::visual" for the mesh or material of a visual,
+    /// "model::link::collision" for the mesh of a collision of a model of
+    /// the root, or "world::actor" for the skin of an actor.
+    std::string scopedName;
+
+    /// \brief The property of the object that references the asset:
+    /// "mesh", "normal_map", the element name of a PBR map such as
+    /// "albedo_map", "skin", or the name of an animation.
+    std::string property;
+  };
+
+  /// \brief A file referenced by a document, with every use of it.
+  struct Asset
+  {
+    /// \brief Kind of the asset.
+    AssetType type = AssetType::MESH;
+
+    /// \brief URI of the asset, as written in the first reference to it.
+    std::string uri;
+
+    /// \brief Resolved path of the asset, or an empty string if it was not
+    /// found.
+    std::string path;
+
+    /// \brief The objects that reference the asset, in document order.
+    std::vector<AssetReference> references;
+  };
+
+  /// \brief The assets referenced by a document, each resolved once, as
+  /// returned by Root::Assets. Assets that resolve to the same path are
+  /// listed once, so that engines can load each of them once, and
+  /// concurrently.
+  struct AssetManifest
+  {
+    /// \brief The assets, in the order of their first reference. Assets
+    /// that were not found have an empty path and are listed by URI.
+    std::vector<Asset> assets;
+  };
+  }
+}
+#endif
@@ -17,6 +17,8 @@
 #ifndef SDF_ATMOSPHERE_HH_
 #define SDF_ATMOSPHERE_HH_
 
+#include <cstddef>
+#include <vector>
 #include <ignition/math/Temperature.hh>
 #include "sdf/Element.hh"
 #include "sdf/Types.hh"
@@ -39,6 +41,62 @@ namespace sdf
   // Forward declarations.
   class AtmospherePrivate;
 
+  /// \brief Temperatures and pressures of an atmosphere sampled at evenly
+  /// spaced altitudes, made by Atmosphere::Table, so that sensors read them
+  /// by linear interpolation instead of evaluating the model with pow or
+  /// exp per reading. Altitudes outside of the table are clamped to its
+  /// ends.
+  struct AtmosphereTable
+  {
+    /// \brief Altitude of the first sample in meters.
+    double minAltitude = 0.0;
+
+    /// \brief Distance between samples in meters.
+    double resolution = 1.0;
+
+    /// \brief Temperature of each sample in kelvins.
+    std::vector<double> temperatures;
+
+    /// \brief Pressure of each sample in pascals.
+    std::vector<double> pressures;
+
+    /// \brief Get the temperature at an altitude.
+    /// \param[in] _altitude Altitude in meters.
+    /// \return Temperature in kelvins, or 0 if the table is empty.
+    double Temperature(const double _altitude) const
+    {
+      return this->Interpolate(this->temperatures, _altitude);
+    }
+
+    /// \brief Get the pressure at an altitude.
+    /// \param[in] _altitude Altitude in meters.
+    /// \return Pressure in pascals, or 0 if the table is empty.
+    double Pressure(const double _altitude) const
+    {
+      return this->Interpolate(this->pressures, _altitude);
+    }
+
+    /// \brief Interpolate samples linearly.
+    /// \param[in] _samples The samples.
+    /// \param[in] _altitude Altitude in meters.
+    /// \return The interpolated value.
+    double Interpolate(const std::vector<double> &_samples,
+                       const double _altitude) const
+    {
+      if (_samples.empty())
+        return 0.0;
+      const double position =
+          (_altitude - this->minAltitude) / this->resolution;
+      if (!(position > 0.0))
+        return _samples.front();
+      const std::size_t index = static_cast<std::size_t>(position);
+      if (index + 1 >= _samples.size())
+        return _samples.back();
+      const double t = position - static_cast<double>(index);
+      return _samples[index] + t * (_samples[index + 1] - _samples[index]);
+    }
+  };
+
   /// \brief The Atmosphere class contains information about
   /// an atmospheric model and related parameters such as temperature
   /// and pressure at sea level. An Atmosphere instance is optionally part of
@@ -111,6 +169,35 @@ namespace sdf
     /// \param[in] _pressure The pressure at sea level in pascals.
     public: void SetPressure(const double _pressure);
 
+    /// \brief Get the temperature of the model at an altitude, which
+    /// changes linearly with the temperature gradient.
+    /// \param[in] _altitude Altitude above sea level in meters.
+    /// \return Temperature in kelvins.
+    public: double TemperatureAt(const double _altitude) const;
+
+    /// \brief Get the pressure of the model at an altitude, from the
+    /// barometric formula of an atmosphere with the temperature of
+    /// TemperatureAt.
+    /// \param[in] _altitude Altitude above sea level in meters.
+    /// \return Pressure in pascals, or 0 above the altitude where the
+    /// temperature reaches 0 K.
+    public: double PressureAt(const double _altitude) const;
+
+    /// \brief Sample the temperature and pressure of the model over a range
+    /// of altitudes, for AtmosphereTable. With the default atmosphere,
+    /// linear interpolation of pressures sampled every 10 m is within about
+    /// 0.02 Pa of PressureAt near sea level.
+    /// \param[in] _minAltitude Lowest altitude in meters.
+    /// \param[in] _maxAltitude Highest altitude in meters. The table
+    /// covers it even if the range is not a multiple of the resolution.
+    /// \param[in] _resolution Distance between samples in meters, which
+    /// must be positive.
+    /// \return The table, which is empty if the range or the resolution is
+    /// not valid.
+    public: AtmosphereTable Table(const double _minAltitude,
+                                  const double _maxAltitude,
+                                  const double _resolution) const;
+
     /// \brief Equality operator that returns true if this atmosphere
     /// instance equals the given atmosphere instance.
     /// \param[in] _atmosphere Atmosphere instance to compare.
@@ -17,7 +17,10 @@
 #ifndef SDF_CAMERA_HH_
 #define SDF_CAMERA_HH_
 
+#include <memory>
 #include <string>
+#include <vector>
+#include <ignition/math/Matrix3.hh>
 #include <ignition/math/Pose3.hh>
 
 #include <sdf/Error.hh>
@@ -59,6 +62,26 @@ namespace sdf
     BAYER_GRBG8,
   };
 
+  /// \brief Map from the pixels of an undistorted camera image to the
+  /// pixels of the distorted image, to undistort an image by sampling it,
+  /// as with cv::remap. The coordinates are stored in separate arrays, and
+  /// ordered by row, so that the pixel at row `v` and column `u` of the
+  /// undistorted image is at index `v * width + u`.
+  struct CameraDistortionMap
+  {
+    /// \brief Width of the images in pixels.
+    uint32_t width = 0;
+
+    /// \brief Height of the images in pixels.
+    uint32_t height = 0;
+
+    /// \brief Column of the distorted image of each pixel.
+    std::vector<float> x;
+
+    /// \brief Row of the distorted image of each pixel.
+    std::vector<float> y;
+  };
+
   /// \brief Information about a monocular camera sensor.
   class SDFORMAT_VISIBLE Camera
   {
@@ -113,7 +136,7 @@ namespace sdf
 
     /// \brief Get the name of the camera.
     /// \return Name of the sensor.
-    public: std::string Name() const;
+    public: const std::string &Name() const;
 
     /// \brief Set the name of the camera.
     /// \param[in] _name Name of the sensor.
@@ -351,7 +374,7 @@ namespace sdf
     /// projection, it is recommended to specify a horizontal_fov of less than
     /// or equal to 90 degrees
     /// \return The lens type.
-    public: std::string LensType() const;
+    public: const std::string &LensType() const;
 
     /// \brief Set the lens type. Supported values are gnomonical,
     /// stereographic, equidistant, equisolid_angle, orthographic, custom.
@@ -470,6 +493,26 @@ namespace sdf
     /// \param[in] _s The lens XY axis skew.
     public: void SetLensIntrinsicsSkew(double _s);
 
+    /// \brief Get the intrinsic matrix of the camera, which projects a
+    /// point in the optical frame to the image in pixels. It is made of the
+    /// lens intrinsics if they were loaded or set, otherwise of the focal
+    /// length of the horizontal field of view and of the center of the
+    /// image, without skew.
+    /// \return The matrix `[fx s cx; 0 fy cy; 0 0 1]`.
+    public: ignition::math::Matrix3d ProjectionMatrix() const;
+
+    /// \brief Get the map that undistorts the images of the camera, from
+    /// the distortion coefficients and center, and the focal lengths of
+    /// ProjectionMatrix. The distortion is the Brown-Conrady model, around
+    /// the distortion center scaled to the image size.
+    ///
+    /// The map is computed once for each set of image size, focal lengths
+    /// and distortion, and shared by all cameras with the same ones until
+    /// they are modified or destroyed, so that many identical cameras do
+    /// not compute and store their own map.
+    /// \return The map, or null if the camera has no distortion.
+    public: std::shared_ptr<const CameraDistortionMap> DistortionMap() const;
+
     /// \brief Convert a string to a PixelFormatType.
     /// \param[in] _format String equivalent of a pixel format type to convert.
     /// \return The matching PixelFormatType.
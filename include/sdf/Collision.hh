@@ -78,7 +78,7 @@ namespace sdf
     /// \brief Get the name of the collision.
     /// The name of the collision must be unique within the scope of a Link.
     /// \return Name of the collision.
-    public: std::string Name() const;
+    public: const std::string &Name() const;
 
     /// \brief Set the name of the collision.
     /// The name of the collision must be unique within the scope of a Link.
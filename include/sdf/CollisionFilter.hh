@@ -0,0 +1,99 @@
+/*
+ * Copyright 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef SDF_COLLISIONFILTER_HH_
+#define SDF_COLLISIONFILTER_HH_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "sdf/sdf_config.h"
+
+namespace sdf
+{
+  // Inline bracket to help doxygen filtering.
+  inline namespace SDF_VERSION_NAMESPACE {
+  //
+
+  /// \brief Which collisions of a world or model may collide, according to
+  /// the category and collide bitmasks of their contact surfaces, so that
+  /// broadphase filtering is a single lookup. It is filled by
+  /// Model::ResolveCollisionFilter and World::ResolveCollisionFilter.
+  ///
+  /// Collisions with the same pair of bitmasks form a group, and a bit
+  /// matrix tells which groups collide. Two collisions collide if the
+  /// category bitmask of either one shares a bit with the collide bitmask of
+  /// the other. Other reasons that engines skip pairs, such as
+  /// Model::SelfCollide, are not taken into account.
+  struct CollisionFilter
+  {
+    /// \brief Index of the model of each collision in World::ModelByIndex,
+    /// or 0 when filled by Model::ResolveCollisionFilter.
+    std::vector<uint64_t> modelIndices;
+
+    /// \brief Index of the link of each collision in Model::LinkByIndex.
+    std::vector<uint64_t> linkIndices;
+
+    /// \brief Index of each collision in Link::CollisionByIndex.
+    std::vector<uint64_t> collisionIndices;
+
+    /// \brief Group of each collision.
+    std::vector<uint32_t> groups;
+
+    /// \brief Category bitmask of each group.
+    std::vector<uint16_t> categoryBitmasks;
+
+    /// \brief Collide bitmask of each group.
+    std::vector<uint16_t> collideBitmasks;
+
+    /// \brief Bit matrix of the groups that collide. Row i starts at word
+    /// i * WordsPerRow(), and bit j of the row is set if groups i and j
+    /// collide. The matrix is symmetric.
+    std::vector<uint64_t> matrix;
+
+    /// \brief Get the number of 64-bit words of each row of the matrix.
+    /// \return Number of words.
+    std::size_t WordsPerRow() const
+    {
+      return (this->categoryBitmasks.size() + 63) / 64;
+    }
+
+    /// \brief Get whether two groups collide.
+    /// \param[in] _groupA The first group.
+    /// \param[in] _groupB The second group.
+    /// \return True if collisions of the groups collide.
+    bool GroupsCollide(const uint32_t _groupA, const uint32_t _groupB) const
+    {
+      const uint64_t word =
+          this->matrix[_groupA * this->WordsPerRow() + _groupB / 64];
+      return ((word >> (_groupB % 64)) & 1u) != 0;
+    }
+
+    /// \brief Get whether two collisions collide.
+    /// \param[in] _collisionA Position of the first collision in the arrays.
+    /// \param[in] _collisionB Position of the second collision.
+    /// \return True if the collisions collide.
+    bool Collide(const std::size_t _collisionA,
+                 const std::size_t _collisionB) const
+    {
+      return this->GroupsCollide(this->groups[_collisionA],
+                                 this->groups[_collisionB]);
+    }
+  };
+  }
+}
+#endif
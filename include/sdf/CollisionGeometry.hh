@@ -0,0 +1,78 @@
+/*
+ * Copyright 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef SDF_COLLISIONGEOMETRY_HH_
+#define SDF_COLLISIONGEOMETRY_HH_
+
+#include <cstdint>
+#include <vector>
+#include <ignition/math/Matrix3.hh>
+#include <ignition/math/Pose3.hh>
+#include <ignition/math/Vector3.hh>
+
+#include "sdf/Geometry.hh"
+#include "sdf/sdf_config.h"
+
+namespace sdf
+{
+  // Inline bracket to help doxygen filtering.
+  inline namespace SDF_VERSION_NAMESPACE {
+  //
+
+  /// \brief The collisions of a link or model stored as contiguous arrays,
+  /// one array per property, with the bounds, volume and inertia derived
+  /// from their shape, for broadphase setup and for comparing the shapes of
+  /// links to their inertial. It is filled by Link::ResolveCollisionGeometry
+  /// and Model::ResolveCollisionGeometry.
+  ///
+  /// The properties of boxes, cylinders and spheres are computed
+  /// analytically. Other shapes, such as planes and meshes, have unbounded
+  /// boxes, and zero volume and inertia.
+  struct CollisionGeometry
+  {
+    /// \brief Index of the link of each collision in Model::LinkByIndex, or
+    /// 0 when filled by Link::ResolveCollisionGeometry.
+    std::vector<uint64_t> linkIndices;
+
+    /// \brief Index of each collision in Link::CollisionByIndex.
+    std::vector<uint64_t> collisionIndices;
+
+    /// \brief Shape of each collision.
+    std::vector<GeometryType> types;
+
+    /// \brief Pose of each collision relative to its link.
+    std::vector<ignition::math::Pose3d> poses;
+
+    /// \brief Minimum corner of the axis-aligned bounding box of each
+    /// collision, in the link frame.
+    std::vector<ignition::math::Vector3d> minCorners;
+
+    /// \brief Maximum corner of the axis-aligned bounding box of each
+    /// collision, in the link frame.
+    std::vector<ignition::math::Vector3d> maxCorners;
+
+    /// \brief Volume of each collision.
+    std::vector<double> volumes;
+
+    /// \brief Moment of inertia matrix of each collision for a uniform
+    /// density of 1, so that its mass is its volume, about the origin of
+    /// the collision and in the coordinates of the link frame. Multiply it
+    /// by the density of the link to compare it to the link inertial.
+    std::vector<ignition::math::Matrix3d> inertias;
+  };
+  }
+}
+#endif
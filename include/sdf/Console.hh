@@ -18,9 +18,15 @@
 #ifndef SDF_CONSOLE_HH_
 #define SDF_CONSOLE_HH_
 
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
 #include <fstream>
+#include <functional>
 #include <iostream>
 #include <memory>
+#include <mutex>
+#include <sstream>
 #include <string>
 
 #include <sdf/sdf_config.h>
@@ -58,8 +64,43 @@ namespace sdf
                                                      __FILE__, __LINE__, 31))
 
   class ConsolePrivate;
+  class ConsoleQueue;
   class Console;
 
+  /// \enum ConsoleLogSink
+  /// \brief Where Console logs its output, in addition to the terminal.
+  /// The default is set by the SDF_CONSOLE_LOG environment variable, which
+  /// may be "file", "process" or "none", and is LOG_FILE if it is not set.
+  enum class ConsoleLogSink
+  {
+    /// \brief Log to ~/.sdformat/sdformat.log, which is the default.
+    LOG_FILE = 0,
+
+    /// \brief Log to ~/.sdformat/sdformat-<process id>.log, so that
+    /// processes that run at the same time do not overwrite each other's
+    /// log.
+    PROCESS_LOG_FILE = 1,
+
+    /// \brief Do not log.
+    NONE = 2,
+
+    /// \brief Pass the output to the function set with
+    /// Console::SetLogCallback.
+    CALLBACK = 3
+  };
+
+  /// \enum ConsoleDropPolicy
+  /// \brief What an asynchronous Console does with output when its queue
+  /// is full.
+  enum class ConsoleDropPolicy
+  {
+    /// \brief Drop the output, and count it in Console::DroppedCount.
+    DROP_NEWEST = 0,
+
+    /// \brief Wait until the background thread makes room for the output.
+    BLOCK = 1
+  };
+
   /// \def ConsolePtr
   /// \brief Shared pointer to a Console Element
   typedef std::shared_ptr<Console> ConsolePtr;
@@ -128,6 +169,72 @@ namespace sdf
                                const std::string &file,
                                unsigned int line);
 
+    /// \brief Set where the output is logged. The log file is created when
+    /// the first output is logged to it, and not when the console is
+    /// created, so that a console whose output is not logged does not touch
+    /// the file system. Changing the sink closes the log file, if open.
+    /// \param[in] _sink Where to log the output.
+    public: void SetLogSink(ConsoleLogSink _sink);
+
+    /// \brief Get where the output is logged.
+    /// \return The log sink.
+    public: ConsoleLogSink LogSink() const;
+
+    /// \brief Log the output by calling a function, and set the log sink
+    /// to ConsoleLogSink::CALLBACK. The function is called with each piece
+    /// of output, such as a message prefix or a value written with
+    /// operator<<, one at a time and in order. It must not write to the
+    /// console.
+    /// \param[in] _callback The function, or nullptr to not log, which sets
+    /// the log sink to ConsoleLogSink::NONE.
+    public: void SetLogCallback(
+        std::function<void(const std::string &)> _callback);
+
+    /// \brief Set whether output is written by a background thread. In
+    /// asynchronous mode, each piece of output is pushed into a bounded
+    /// lock-free queue, and the thread writes it to the terminal and to the
+    /// log file, so that threads that log many messages do not wait for
+    /// the writes, nor for each other. The output of each thread stays in
+    /// order. Disabling it writes the output that is queued first.
+    /// \param[in] _async True to write output in the background.
+    /// \param[in] _capacity Number of pieces of output that the queue
+    /// holds. It is rounded up to a power of two.
+    /// \param[in] _policy What to do with output when the queue is full.
+    public: void SetAsync(bool _async, std::size_t _capacity = 4096,
+        ConsoleDropPolicy _policy = ConsoleDropPolicy::DROP_NEWEST);
+
+    /// \brief Get whether output is written by a background thread.
+    /// \return True in asynchronous mode.
+    public: bool Async() const;
+
+    /// \brief Wait until the output queued so far is written. It returns
+    /// immediately when the console is not asynchronous.
+    public: void Flush();
+
+    /// \brief Get the number of pieces of output dropped because the queue
+    /// was full, since the console was created.
+    /// \return Number of dropped pieces of output.
+    public: uint64_t DroppedCount() const;
+
+    /// \brief Get whether output is logged.
+    /// \return True unless the log sink is ConsoleLogSink::NONE.
+    private: bool Logging() const;
+
+    /// \brief Log output to the log sink.
+    /// \param[in] _text The output.
+    private: void WriteLog(const std::string &_text);
+
+    /// \brief Push output into the queue, or write it if the console is
+    /// not asynchronous.
+    /// \param[in] _stream Terminal stream of the output, or nullptr.
+    /// \param[in] _text The output.
+    /// \param[in] _logText The output for the log file, if different.
+    /// \param[in] _hasLogText True to write _logText to the log file
+    /// instead of _text.
+    private: void Enqueue(std::ostream *_stream, std::string _text,
+                          std::string _logText = std::string(),
+                          bool _hasLogText = false);
+
     /// \internal
     /// \brief Pointer to private data.
     private: std::unique_ptr<ConsolePrivate> dataPtr;
@@ -148,21 +255,57 @@ namespace sdf
 
     /// \brief logfile stream
     public: std::ofstream logFileStream;
+
+    /// \brief True once logFileStream was opened, or failed to open, for
+    /// the current log sink.
+    public: bool logFileOpened = false;
+
+    /// \brief Where the output is logged, accessed atomically.
+    public: std::atomic<ConsoleLogSink> logSink{ConsoleLogSink::LOG_FILE};
+
+    /// \brief Function called with the output for ConsoleLogSink::CALLBACK.
+    public: std::function<void(const std::string &)> logCallback;
+
+    /// \brief Mutex to serialize writes to logFileStream, and calls of
+    /// logCallback, from several threads. It also protects logFileOpened
+    /// and logCallback.
+    public: std::mutex logFileMutex;
+
+    /// \brief Queue of the output and its background thread in
+    /// asynchronous mode, or nullptr. Owned by the console.
+    public: std::atomic<ConsoleQueue *> queue{nullptr};
+
+    /// \brief Number of threads that are pushing output into the queue,
+    /// so that it is only deleted once they are done.
+    public: std::atomic<int> queueUsers{0};
+
+    /// \brief Number of pieces of output dropped because the queue was full.
+    public: std::atomic<uint64_t> droppedCount{0};
   };
 
   ///////////////////////////////////////////////
   template <class T>
   Console::ConsoleStream &Console::ConsoleStream::operator<<(const T &_rhs)
   {
+    ConsolePtr console = Console::Instance();
+    if (console->Async())
+    {
+      std::ostringstream text;
+      text << _rhs;
+      console->Enqueue(this->stream, text.str());
+      return *this;
+    }
+
     if (this->stream)
     {
       *this->stream << _rhs;
     }
 
-    if (Console::Instance()->dataPtr->logFileStream.is_open())
+    if (console->Logging())
     {
-      Console::Instance()->dataPtr->logFileStream << _rhs;
-      Console::Instance()->dataPtr->logFileStream.flush();
+      std::ostringstream text;
+      text << _rhs;
+      console->WriteLog(text.str());
     }
 
     return *this;
@@ -18,14 +18,26 @@
 #define SDF_ELEMENT_HH_
 
 #include <any>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
 #include <map>
 #include <memory>
+#include <ostream>
 #include <set>
 #include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
+#include "sdf/InternedString.hh"
+#include "sdf/MemoryFootprint.hh"
 #include "sdf/Param.hh"
+#include "sdf/PrintConfig.hh"
 #include "sdf/sdf_config.h"
 #include "sdf/system_util.hh"
 #include "sdf/Types.hh"
@@ -45,8 +57,11 @@ namespace sdf
   inline namespace SDF_VERSION_NAMESPACE {
   //
 
-  class ElementPrivate;
+  class SDFORMAT_VISIBLE ElementPrivate;
+  class ElementSchema;
   class SDFORMAT_VISIBLE Element;
+  class ElementReadTable;
+  template <typename T> class ElementField;
 
   /// \def ElementPtr
   /// \brief Shared pointer to an SDF Element
@@ -74,10 +89,36 @@ namespace sdf
     /// \brief Destructor.
     public: virtual ~Element();
 
+    /// \brief Allocate memory for an element. While a document is read with
+    /// ParserConfig::SetArenaAllocation enabled, elements are allocated from
+    /// an arena that is shared by the whole element tree.
+    /// \param[in] _size Size of the element.
+    /// \return Memory for the element.
+    public: static void *operator new(std::size_t _size);
+
+    /// \brief Free memory allocated by operator new.
+    /// \param[in] _ptr Memory of the element.
+    public: static void operator delete(void *_ptr);
+
     /// \brief Create a copy of this Element.
     /// \return A copy of this Element.
     public: ElementPtr Clone() const;
 
+    /// \brief Create a copy of this Element that shares the attributes,
+    /// value and child elements of this element until they are modified or
+    /// handed out, for example by GetAttribute or GetFirstElement. They are
+    /// then copied one level at a time, the child elements as copy-on-write
+    /// clones themselves, so that copies of large trees that are only read
+    /// in part are cheap. Reading values with Get, HasElement, HasAttribute
+    /// or ToString does not copy anything.
+    ///
+    /// This element must not be modified while a clone shares its content,
+    /// which makes this suitable for cached or template elements. Like any
+    /// element, a clone must not be used from several threads at once, even
+    /// through const functions, since they may copy the shared content.
+    /// \return A copy of this Element.
+    public: ElementPtr CopyOnWriteClone() const;
+
     /// \brief Copy values from an Element.
     /// \param[in] _elem Element to copy value from.
     public: void Copy(const ElementPtr _elem);
@@ -122,6 +163,24 @@ namespace sdf
     /// \return True to copy child elements during parsing.
     public: bool GetCopyChildren() const;
 
+    /// \brief Keep the child elements of this element as XML text until
+    /// they are first accessed, as the parser does with
+    /// ParserConfig::SetDeferCopiedElements. The elements are then read the
+    /// way the parser copies elements that are not in the SDF spec: with a
+    /// string value and string attributes. The current child elements are
+    /// removed.
+    /// \param[in] _xml XML of the child elements, such as
+    /// "<a>1</a><b c='2'/>".
+    public: void SetDeferredElements(const std::string &_xml);
+
+    /// \brief Get whether the child elements of this element are still
+    /// kept as XML text. They are read the first time they are accessed,
+    /// such as by GetElement, GetFirstElement, Children, Visit or ToString,
+    /// after which this returns false.
+    /// \return True if the child elements have not been read yet.
+    /// \sa SetDeferredElements
+    public: bool ElementsDeferred() const;
+
     /// \brief Set reference SDF element.
     /// \param[in] _value Name of the reference sdf element.
     public: void SetReferenceSDF(const std::string &_value);
@@ -134,10 +193,25 @@ namespace sdf
     /// \param[in] _prefix String value to prefix to the output.
     public: void PrintDescription(const std::string &_prefix) const;
 
+    /// \brief Write Element's description to a stream, as it is printed by
+    /// PrintDescription, without building it in memory first.
+    /// \param[out] _out Stream to write to.
+    /// \param[in] _prefix String value to prefix to the output.
+    public: void PrintDescription(std::ostream &_out,
+                                  const std::string &_prefix) const;
+
     /// \brief Output Element's values to stdout.
     /// \param[in] _prefix String value to prefix to the output.
     public: void PrintValues(std::string _prefix) const;
 
+    /// \brief Append the start tag of this element, with the attributes
+    /// that PrintValues prints, but without its value or child elements,
+    /// so that the element can be printed in parts.
+    /// \param[in] _prefix String value to prefix to the tag.
+    /// \param[in,out] _buffer String to append the tag to.
+    public: void AppendStartTag(const std::string &_prefix,
+                                std::string &_buffer) const;
+
     /// \brief Helper function for SDF::PrintDoc
     ///
     /// This generates the SDF html documentation.
@@ -155,11 +229,84 @@ namespace sdf
     public: void PrintDocRightPane(std::string &_html,
                                   int _spacing, int &_index) const;
 
+    /// \brief Write the left pane of the SDF html documentation to a
+    /// stream, as it is appended by PrintDocLeftPane, without building it
+    /// in memory first.
+    /// \param[out] _out Stream to write to.
+    /// \param[in] _spacing Amount of spacing for this element.
+    /// \param[in,out] _index Unique index for this element.
+    public: void PrintDocLeftPane(std::ostream &_out,
+                                  int _spacing, int &_index) const;
+
+    /// \brief Write the right pane of the SDF html documentation to a
+    /// stream, as it is appended by PrintDocRightPane.
+    /// \param[out] _out Stream to write to.
+    /// \param[in] _spacing Amount of spacing for this element.
+    /// \param[in,out] _index Unique index for this element.
+    public: void PrintDocRightPane(std::ostream &_out,
+                                   int _spacing, int &_index) const;
+
     /// \brief Convert the element values to a string representation.
     /// \param[in] _prefix String value to prefix to the output.
     /// \return The string representation.
     public: std::string ToString(const std::string &_prefix) const;
 
+    /// \brief Convert the element values to a string representation.
+    /// \param[in] _prefix String value to prefix to the output.
+    /// \param[in] _config Options that control the representation.
+    /// \return The string representation.
+    public: std::string ToString(const std::string &_prefix,
+                                 const PrintConfig &_config) const;
+
+    /// \brief Write the same representation as ToString to a stream. The
+    /// output goes through a buffer that is written to the stream in
+    /// blocks, so that the whole representation is never held in memory.
+    /// \param[out] _out Stream to write to.
+    /// \param[in] _prefix String value to prefix to the output.
+    public: void Write(std::ostream &_out,
+                       const std::string &_prefix = "") const;
+
+    /// \brief Write the same representation as ToString to a stream.
+    /// \param[out] _out Stream to write to.
+    /// \param[in] _prefix String value to prefix to the output.
+    /// \param[in] _config Options that control the representation.
+    public: void Write(std::ostream &_out, const std::string &_prefix,
+                       const PrintConfig &_config) const;
+
+    /// \brief Get the approximate memory used by this element and its
+    /// descendants, in total and by element name. The content that
+    /// copy-on-write clones share with their source is counted once.
+    /// \return The footprint of the tree.
+    public: TreeFootprint MemoryFootprint() const;
+
+    /// \brief Release the memory that this element and its descendants
+    /// keep for growth, such as the capacity of their child and attribute
+    /// vectors, and the parameters cached for Update. The content that
+    /// copy-on-write clones share with their source and the deferred
+    /// elements are left as they are. It must not be called while other
+    /// threads use the tree.
+    /// \sa Root::Compact
+    public: void Compact();
+
+    /// \brief Get a hash of the name, attributes, value and descendants of
+    /// this element, so that identical subtrees can be found without
+    /// comparing them. The file path, include file name and original
+    /// version are not part of it.
+    ///
+    /// The hash of each element is cached, and is computed from the cached
+    /// hashes of its children, so it is only computed again for the
+    /// elements that changed since the last call. The functions of Element
+    /// that modify an element, or hand out its attributes or value for
+    /// modification, such as Set, GetValue, GetAttribute, AddElement,
+    /// InsertElement and RemoveChild, discard the hashes of the element and
+    /// of its ancestors. Modifying a parameter does not, so a parameter
+    /// returned by GetValue or GetAttribute must be modified before this
+    /// function is called again. If it is modified later, the hash stays
+    /// stale until the parameter is handed out again by GetValue or
+    /// GetAttribute, or the element is otherwise modified.
+    /// \return The hash.
+    public: uint64_t Hash() const;
+
     /// \brief Add an attribute value.
     /// \param[in] _key Key value.
     /// \param[in] _type Type of data the attribute will hold.
@@ -173,6 +320,11 @@ namespace sdf
                               bool _required,
                               const std::string &_description="");
 
+    /// \brief Remove an attribute.
+    /// \param[in] _key Key of the attribute. Nothing happens if the element
+    /// has no such attribute.
+    public: void RemoveAttribute(const std::string &_key);
+
     /// \brief Add a value to this Element.
     /// \param[in] _type Type of data the attribute will hold.
     /// \param[in] _defaultValue Default value for the attribute.
@@ -186,7 +338,7 @@ namespace sdf
     /// \brief Get the param of an attribute.
     /// \param[in] _key the name of the attribute.
     /// \return The parameter attribute value. NULL if the key is invalid.
-    public: ParamPtr GetAttribute(const std::string &_key) const;
+    public: ParamPtr GetAttribute(std::string_view _key) const;
 
     /// \brief Get the number of attributes.
     /// \return The number of attributes.
@@ -209,17 +361,17 @@ namespace sdf
     /// \brief Get an element description using a key
     /// \param[in] _key the key to use to find the element.
     /// \return An Element pointer to the found element.
-    public: ElementPtr GetElementDescription(const std::string &_key) const;
+    public: ElementPtr GetElementDescription(std::string_view _key) const;
 
     /// \brief Return true if an element description exists.
     /// \param[in] _name the name of the element to find.
     /// \return True if the element description exists, false otherwise.
-    public: bool HasElementDescription(const std::string &_name) const;
+    public: bool HasElementDescription(std::string_view _name) const;
 
     /// \brief Return true if an attribute exists.
     /// \param[in] _key the key to use to find the attribute.
     /// \return True if the attribute exists, false otherwise.
-    public: bool HasAttribute(const std::string &_key) const;
+    public: bool HasAttribute(std::string_view _key) const;
 
     /// \brief Return true if the attribute was set (i.e. not default value)
     /// \param[in] _key the key to use to find the attribute.
@@ -275,7 +427,7 @@ namespace sdf
     /// \brief Return true if the named element exists.
     /// \param[in] _name the name of the element to look for.
     /// \return True if the named element was found, false otherwise.
-    public: bool HasElement(const std::string &_name) const;
+    public: bool HasElement(std::string_view _name) const;
 
     /// \brief Get the first child element.
     /// \return A smart pointer to the first child of this element, or
@@ -293,8 +445,136 @@ namespace sdf
     /// This can be used in combination with GetFirstElement() to walk the SDF
     /// tree. First call parent->GetFirstElement() to get the first child. Call
     /// child = child->GetNextElement() to iterate through the children.
+    /// Each call searches the siblings of this element for it, so walking
+    /// many children this way is quadratic; use Children() instead.
     public: ElementPtr GetNextElement(const std::string &_name = "") const;
 
+    /// \brief A range over the child elements of an element, returned by
+    /// Element::Children. Advancing it takes constant time, apart from
+    /// skipping children with other names. Adding or removing children of
+    /// the element while iterating over the range invalidates it.
+    public: class SDFORMAT_VISIBLE ChildRange
+    {
+      /// \brief Forward iterator over the child elements of a range.
+      public: class SDFORMAT_VISIBLE Iterator
+      {
+        /// \brief Iterator category.
+        public: using iterator_category = std::forward_iterator_tag;
+
+        /// \brief Type of the elements.
+        public: using value_type = ElementPtr;
+
+        /// \brief Type of the distance between iterators.
+        public: using difference_type = std::ptrdiff_t;
+
+        /// \brief Pointer to an element.
+        public: using pointer = const ElementPtr *;
+
+        /// \brief Reference to an element.
+        public: using reference = const ElementPtr &;
+
+        /// \brief Constructor.
+        /// \param[in] _elements The child elements.
+        /// \param[in] _index Index of the first child to consider.
+        /// \param[in] _name Name of the children to visit, or an empty
+        /// string to visit all of them.
+        public: Iterator(const ElementPtr_V *_elements, std::size_t _index,
+                         InternedString _name);
+
+        /// \brief Get the current child.
+        /// \return The child.
+        public: const ElementPtr &operator*() const;
+
+        /// \brief Access the current child.
+        /// \return Pointer to the child.
+        public: const ElementPtr *operator->() const;
+
+        /// \brief Advance to the next child with the name of the range.
+        /// \return This iterator.
+        public: Iterator &operator++();
+
+        /// \brief Advance to the next child with the name of the range.
+        /// \return A copy of this iterator before it advanced.
+        public: Iterator operator++(int);
+
+        /// \brief Equality operator.
+        /// \param[in] _other Iterator of the same range.
+        /// \return True if both iterators are at the same child.
+        public: bool operator==(const Iterator &_other) const;
+
+        /// \brief Inequality operator.
+        /// \param[in] _other Iterator of the same range.
+        /// \return True if the iterators are at different children.
+        public: bool operator!=(const Iterator &_other) const;
+
+        /// \brief Skip the children whose name differs from that of the
+        /// range.
+        private: void SkipOtherNames();
+
+        /// \brief The child elements.
+        private: const ElementPtr_V *elements = nullptr;
+
+        /// \brief Index of the current child.
+        private: std::size_t index = 0;
+
+        /// \brief Name of the children to visit, which is compared by
+        /// pointer since element names are interned.
+        private: InternedString name;
+      };
+
+      /// \brief Constructor.
+      /// \param[in] _parent The element whose children are visited. Its
+      /// shared content must have been copied.
+      /// \param[in] _name Name of the children to visit, or an empty string
+      /// to visit all of them.
+      public: ChildRange(ElementPtr _parent, const std::string &_name);
+
+      /// \brief Get an iterator to the first child of the range.
+      /// \return The iterator.
+      public: Iterator begin() const;
+
+      /// \brief Get an iterator past the last child of the range.
+      /// \return The iterator.
+      public: Iterator end() const;
+
+      /// \brief Get whether the range has no children.
+      /// \return True if no child has the name of the range.
+      public: bool Empty() const;
+
+      /// \brief The element whose children are visited, which the range
+      /// keeps alive.
+      private: ElementPtr parent;
+
+      /// \brief Name of the children to visit.
+      private: InternedString name;
+    };
+
+    /// \brief Get the child elements, optionally only those with a given
+    /// name, in order. Unlike walking them with GetNextElement, this visits
+    /// N children in O(N):
+    ///
+    ///     for (const sdf::ElementPtr &model : world->Children("model"))
+    ///       ...
+    ///
+    /// \param[in] _name If given, only visit children with this name.
+    /// \return The range of children.
+    public: ChildRange Children(const std::string &_name = "") const;
+
+    /// \brief Visit this element and its descendants, depth first and in
+    /// document order. Elements are passed by reference, so that walking a
+    /// tree does not copy ElementPtr, and their content is read without
+    /// copying the content shared by copy-on-write clones, so that several
+    /// threads can walk a shared tree. The tree must not be modified while
+    /// it is visited.
+    /// \param[in] _preOrder Called for an element before its descendants.
+    /// Its descendants are skipped if it returns false. It may be nullptr.
+    /// \param[in] _postOrder Called for an element after its descendants,
+    /// including when they were skipped. It may be nullptr.
+    public: void Visit(
+        const std::function<bool(const Element &)> &_preOrder,
+        const std::function<void(const Element &)> &_postOrder = nullptr)
+        const;
+
     /// \brief Get set of child element type names.
     /// \return A set of the names of the child elements.
     public: std::set<std::string> GetElementTypeNames() const;
@@ -321,7 +601,8 @@ namespace sdf
     /// \brief Return a pointer to the child element with the provided name.
     ///
     /// A new child element, with the provided name, is added to this element
-    /// if there is no existing child element.
+    /// if there is no existing child element. Since this modifies the tree,
+    /// threads that read a tree at once use FindElement instead.
     /// \remarks If there are multiple elements with the given tag, it returns
     ///          the first one.
     /// \param[in] _name Name of the child element to retreive.
@@ -329,6 +610,17 @@ namespace sdf
     /// element if an existing child element did not exist.
     public: ElementPtr GetElement(const std::string &_name);
 
+    /// \brief Return a pointer to the child element with the provided name.
+    ///
+    /// Unlike GetElement, this never adds a child element, so it can be used
+    /// to read optional elements without modifying or allocating the tree.
+    /// \remarks If there are multiple elements with the given tag, it returns
+    ///          the first one.
+    /// \param[in] _name Name of the child element to retreive.
+    /// \return Pointer to the existing child element, or nullptr if there is
+    /// no child element with the provided name.
+    public: ElementPtr FindElement(const std::string &_name) const;
+
     /// \brief Add a named element.
     /// \param[in] _name the name of the element to add.
     /// \return A pointer to the newly created Element object.
@@ -354,6 +646,10 @@ namespace sdf
 
     /// \brief Call the Update() callback on each element, as well as
     ///        the embedded Param.
+    /// The parameters with an update function are collected on the first
+    /// call, and only collected again after an update function is set or
+    /// elements are inserted or removed, so that repeated calls only touch
+    /// those parameters.
     public: void Update();
 
     /// \brief Call reset on each element and element description
@@ -369,6 +665,23 @@ namespace sdf
     /// \return The include filename.
     public: std::string GetInclude() const;
 
+    /// \brief Record the `<include>` element that this element was read
+    /// through, such as `<include><uri>model://box</uri></include>`,
+    /// together with the current hash of this element. Writers that
+    /// preserve includes print the `<include>` element instead of this
+    /// element while its hash is unchanged. The parser records it on the
+    /// models, actors and lights it includes in worlds.
+    /// \param[in] _xml The `<include>` element, on one line, or an empty
+    /// string to forget it.
+    /// \sa PrintConfig::SetPreserveIncludes
+    public: void SetIncludeXml(const std::string &_xml);
+
+    /// \brief Get the `<include>` element that this element was read
+    /// through.
+    /// \return The `<include>` element, or an empty string.
+    /// \sa SetIncludeXml
+    public: const std::string &IncludeXml() const;
+
     /// \brief Set the path to the SDF document where this element came from.
     /// \param[in] _path Full path to SDF document.
     public: void SetFilePath(const std::string &_path);
@@ -404,15 +717,40 @@ namespace sdf
 
     /// \brief Generate a string (XML) representation of this object.
     /// \param[in] _prefix arbitrary prefix to put on the string.
-    /// \param[out] _out the std::ostreamstream to write output to.
-    private: void ToString(const std::string &_prefix,
-                           std::ostringstream &_out) const;
+    /// \param[in,out] _buffer String to append the output to.
+    /// \param[out] _out If not null, stream to which the buffer is written
+    /// and cleared whenever it grows large.
+    /// \param[in] _config Options that control the representation.
+    private: void ToString(const std::string &_prefix, std::string &_buffer,
+                           std::ostream *_out,
+                           const PrintConfig &_config) const;
 
     /// \brief Generate a string (XML) representation of this object.
     /// \param[in] _prefix arbitrary prefix to put on the string.
-    /// \param[out] _out the std::ostreamstream to write output to.
+    /// \param[in,out] _buffer String to append the output to.
+    /// \param[out] _out If not null, stream to which the buffer is written
+    /// and cleared whenever it grows large.
+    /// \param[in] _config Options that control the representation.
     private: void PrintValuesImpl(const std::string &_prefix,
-                                  std::ostringstream &_out) const;
+                                  std::string &_buffer,
+                                  std::ostream *_out,
+                                  const PrintConfig &_config) const;
+
+    /// \brief Generate a string (XML) representation of this object, with
+    /// the children of elements that have many children printed
+    /// concurrently, as described in PrintConfig::SetThreadCount.
+    /// \param[in] _prefix arbitrary prefix to put on the string.
+    /// \param[in,out] _buffer String to append the output to.
+    /// \param[out] _out If not null, stream to which the buffer is written
+    /// and cleared whenever it grows large.
+    /// \param[in] _config Options that control the representation.
+    /// \param[in] _depth Number of levels of descendants that are still
+    /// searched for elements with many children.
+    private: void PrintValuesParallel(const std::string &_prefix,
+                                      std::string &_buffer,
+                                      std::ostream *_out,
+                                      const PrintConfig &_config,
+                                      int _depth) const;
 
     /// \brief Create a new Param object and return it.
     /// \param[in] _key Key for the parameter.
@@ -428,30 +766,192 @@ namespace sdf
                                   bool _required,
                                   const std::string &_description="");
 
+    /// \brief Add the footprint of this element and its descendants.
+    /// \param[in,out] _footprint The footprint to add to.
+    /// \param[in,out] _counted Private data whose content has been counted,
+    /// to count the content shared by copy-on-write clones once.
+    private: void AddMemoryFootprint(TreeFootprint &_footprint,
+                 std::unordered_set<const ElementPrivate *> &_counted) const;
+
+    /// \brief Collect the parameters of this element and its descendants
+    /// that have an update function, copying the content shared by
+    /// copy-on-write clones so that they are updated in this tree.
+    /// \param[out] _params The parameters are appended to this.
+    private: void CollectUpdateParams(std::vector<ParamPtr> &_params);
+
+    /// \brief Get the private data that holds the attributes, value and
+    /// child elements of this element. A copy-on-write clone reads those of
+    /// its source until it copies them.
+    /// \return The private data of this element, or of its source.
+    private: const ElementPrivate &Content() const;
+
+    /// \brief Copy the attributes, value and child elements that a
+    /// copy-on-write clone shares with its source, so that they can be
+    /// modified or handed out. Child elements are copied as copy-on-write
+    /// clones, so only one level of the tree is copied.
+    /// \param[in] _copyElements False to drop the child elements instead of
+    /// copying them, when they are about to be cleared.
+    private: void CopySharedContent(bool _copyElements = true) const;
+
+    /// \brief Read the child elements that are kept as XML text, if any,
+    /// into this element, or into the source of this copy-on-write clone.
+    /// It is safe to call concurrently on a tree that is not modified.
+    /// \sa SetDeferredElements
+    private: void ReadDeferredElements() const;
+
+    /// \brief Get the value for reading, without copying shared content.
+    /// \return The value, which must not be modified.
+    private: ParamPtr SharedValue() const;
+
+    /// \brief Get an attribute for reading, without copying shared content.
+    /// \param[in] _key Key of the attribute.
+    /// \return The attribute, which must not be modified, or nullptr.
+    private: ParamPtr SharedAttribute(std::string_view _key) const;
+
+    /// \brief Get a child element for reading, without copying shared
+    /// content.
+    /// \param[in] _name Name of the child element.
+    /// \return The child element, which must not be modified, or nullptr.
+    private: ElementPtr SharedElement(std::string_view _name) const;
+
+    /// \brief Find the param that Get reads for a key, without copying
+    /// shared content: the value of this element for an empty key, else an
+    /// attribute, else the value of a child element, else the value of an
+    /// element description. Each of them is looked up once.
+    /// \param[in] _key Key of an attribute or name of a child element.
+    /// \param[out] _param The param, which must not be modified. It is
+    /// nullptr if the key is not found or the element found has no value.
+    /// \return True if the key is found.
+    private: bool ResolveParam(const std::string &_key,
+                               ParamPtr &_param) const;
+
+    /// \brief Get the schema of this element for modification. If the
+    /// schema is shared with other elements, it is copied first so that
+    /// the other elements are not affected.
+    /// \return The schema owned by this element.
+    private: ElementSchema &MutableSchema();
+
+    /// \brief Add the last child element to the index of child elements by
+    /// name, or build the index if this element now has enough children.
+    private: void IndexLastElement();
+
+    /// \brief Rebuild the index of child elements by name.
+    private: void RebuildElementIndex();
+
+    /// \brief Discard the cached hash of this element and of its
+    /// ancestors, after this element changed.
+    /// \sa Hash
+    private: void ResetHash() const;
+
+    /// \brief Rebuild the index of child elements of the parent element
+    /// after the name of this element changed.
+    private: void UpdateParentElementIndex();
+
+    /// \brief ElementField reads attributes and child elements without
+    /// copying shared content, and identifies elements by their schema.
+    template <typename T> friend class ElementField;
+
+    /// \brief ElementReadTable is cached in the schema of elements.
+    friend class ElementReadTable;
+
+    /// \brief Constructor of an element that shares the schema of another
+    /// element, used by Clone.
+    /// \param[in] _schema The schema.
+    private: explicit Element(std::shared_ptr<ElementSchema> _schema);
 
     /// \brief Private data pointer
     private: std::unique_ptr<ElementPrivate> dataPtr;
   };
 
   /// \internal
-  /// \brief Private data for Element
-  class ElementPrivate
+  /// \brief Description of an element that comes from the SDF spec. It is
+  /// the same for every instance of an element, so it is shared between an
+  /// element description and all the elements created from it, instead of
+  /// being copied by Element::Clone and Element::AddElement. A schema must
+  /// not be modified while it is shared; Element copies it on write.
+  class ElementSchema
   {
     /// \brief Element name
-    public: std::string name;
+    public: InternedString name;
 
     /// \brief True if element is required
-    public: std::string required;
+    public: InternedString required;
 
     /// \brief Element description
-    public: std::string description;
+    public: InternedString description;
 
     /// \brief True if element's children should be copied.
-    public: bool copyChildren;
+    public: bool copyChildren = false;
+
+    /// \brief Name of reference sdf.
+    public: std::string referenceSDF;
+
+    /// \brief The possible child elements
+    public: ElementPtr_V elementDescriptions;
+
+    /// \brief Index in elementDescriptions of the first description with
+    /// each name, by hash of the name, so that descriptions are found from a
+    /// std::string_view.
+    public: std::unordered_multimap<std::size_t, std::size_t>
+            elementDescriptionIndex;
+
+    /// \brief Table used by readXml to read elements of this schema, built
+    /// on first use and accessed atomically. It is discarded when the
+    /// schema is modified.
+    public: mutable std::shared_ptr<const ElementReadTable> readTable;
+  };
+
+  /// \internal
+  /// \brief Where an element came from. It is the same for all the elements
+  /// read from a file, so they share one record instead of each holding a
+  /// copy of the strings. A record is not modified once it is shared; the
+  /// setters of Element replace the record of the element instead.
+  class ElementProvenance
+  {
+    /// \brief Path to file where the element came from
+    public: std::string path;
+
+    /// \brief Spec version that the element was originally parsed from.
+    public: std::string originalVersion;
+
+    /// \brief Name of the include file that was used to create the element
+    public: std::string includeFilename;
+
+    /// \brief The <include> element that the element was read through.
+    /// \sa Element::SetIncludeXml
+    public: std::string includeXml;
+
+    /// \brief Hash of the element when includeXml was set.
+    public: uint64_t includeHash = 0;
+  };
+
+  /// \internal
+  /// \brief Private data for Element
+  class SDFORMAT_VISIBLE ElementPrivate
+  {
+    /// \brief Allocate memory for the private data, from the same arena as
+    /// its element.
+    /// \param[in] _size Size of the private data.
+    /// \return Memory for the private data.
+    /// \sa Element::operator new
+    public: static void *operator new(std::size_t _size);
+
+    /// \brief Free memory allocated by operator new.
+    /// \param[in] _ptr Memory of the private data.
+    public: static void operator delete(void *_ptr);
+
+    /// \brief Description of the element, shared with the element
+    /// description that this element was created from.
+    public: std::shared_ptr<ElementSchema> schema;
 
     /// \brief Element's parent
     public: ElementWeakPtr parent;
 
+    /// \brief The element that parent points to, for the walks inside the
+    /// tree that do not need to lock it. It is only valid while parent has
+    /// not expired.
+    public: Element *parentElement = nullptr;
+
     // Attributes of this element
     public: Param_V attributes;
 
@@ -461,20 +961,43 @@ namespace sdf
     // The existing child elements
     public: ElementPtr_V elements;
 
-    // The possible child elements
-    public: ElementPtr_V elementDescriptions;
-
-    /// name of the include file that was used to create this element
-    public: std::string includeFilename;
-
-    /// \brief Name of reference sdf.
-    public: std::string referenceSDF;
-
-    /// \brief Path to file where this element came from
-    public: std::string path;
-
-    /// \brief Spec version that this was originally parsed from.
-    public: std::string originalVersion;
+    /// \brief Index in elements of the first child element with each name,
+    /// by hash of the name, so that children are found from a
+    /// std::string_view. It is only built for elements with many children,
+    /// and is empty otherwise.
+    public: std::unordered_multimap<std::size_t, std::size_t> elementIndex;
+
+    /// \brief Where this element came from, usually shared with its parent
+    /// and the other elements of the same file, or nullptr if the file
+    /// path, original version and include file name are all empty.
+    public: std::shared_ptr<const ElementProvenance> provenance;
+
+    /// \brief Element whose attributes, value and child elements are
+    /// shared by this copy-on-write clone, or nullptr once they have been
+    /// copied. The source is never a copy-on-write clone itself.
+    /// \sa Element::CopyOnWriteClone
+    public: ElementPtr copyOnWriteSource;
+
+    /// \brief Parameters of this element and its descendants that have an
+    /// update function, in the order Element::Update updates them.
+    public: std::vector<ParamPtr> updateParams;
+
+    /// \brief Value of paramUpdateGeneration() when updateParams was
+    /// collected, or 0 if it was never collected.
+    public: uint64_t updateParamsGeneration = 0;
+
+    /// \brief XML of the child elements while they are deferred, shared
+    /// with the clones of this element, or nullptr.
+    /// \sa Element::SetDeferredElements
+    public: std::shared_ptr<const std::string> deferredXml;
+
+    /// \brief True while deferredXml is set, so that accessors can check
+    /// it without taking a lock.
+    public: std::atomic<bool> elementsDeferred{false};
+
+    /// \brief Cached hash of the element, or 0 if it must be computed.
+    /// \sa Element::Hash
+    public: std::atomic<uint64_t> hash{0};
   };
 
   ///////////////////////////////////////////////
@@ -482,10 +1005,10 @@ namespace sdf
   T Element::Get(const std::string &_key) const
   {
     T result = T();
-
-    std::pair<T, bool> ret = this->Get<T>(_key, result);
-
-    return ret.first;
+    ParamPtr param;
+    if (this->ResolveParam(_key, param) && param)
+      param->Get<T>(result);
+    return result;
   }
 
   ///////////////////////////////////////////////
@@ -506,33 +1029,19 @@ namespace sdf
   {
     std::pair<T, bool> result(_defaultValue, true);
 
-    if (_key.empty() && this->dataPtr->value)
+    ParamPtr param;
+    if (!this->ResolveParam(_key, param))
     {
-      this->dataPtr->value->Get<T>(result.first);
+      result.second = false;
     }
-    else if (!_key.empty())
+    else if (param)
     {
-      ParamPtr param = this->GetAttribute(_key);
-      if (param)
-      {
-        param->Get(result.first);
-      }
-      else if (this->HasElement(_key))
-      {
-        result.first = this->GetElementImpl(_key)->Get<T>();
-      }
-      else if (this->HasElementDescription(_key))
-      {
-        result.first = this->GetElementDescription(_key)->Get<T>();
-      }
-      else
-      {
-        result.second = false;
-      }
+      param->Get<T>(result.first);
     }
-    else
+    else if (!_key.empty())
     {
-      result.second = false;
+      // A child element or description without value reads as T().
+      result.first = T();
     }
 
     return result;
@@ -542,9 +1051,10 @@ namespace sdf
   template<typename T>
   bool Element::Set(const T &_value)
   {
-    if (this->dataPtr->value)
+    ParamPtr value = this->GetValue();
+    if (value)
     {
-      this->dataPtr->value->Set(_value);
+      value->Set(_value);
       return true;
     }
     return false;
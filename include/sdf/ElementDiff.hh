@@ -0,0 +1,114 @@
+/*
+ * Copyright 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef SDF_ELEMENTDIFF_HH_
+#define SDF_ELEMENTDIFF_HH_
+
+#include <string>
+#include <vector>
+
+#include "sdf/Element.hh"
+#include "sdf/sdf_config.h"
+#include "sdf/system_util.hh"
+
+namespace sdf
+{
+  // Inline bracket to help doxygen filtering.
+  inline namespace SDF_VERSION_NAMESPACE {
+  //
+
+  class Root;
+
+  /// \enum ElementChangeType
+  /// \brief The kinds of change of an ElementChange.
+  enum class ElementChangeType
+  {
+    /// \brief An element of the new tree has no matching element in the
+    /// old tree.
+    ADDED = 0,
+
+    /// \brief An element of the old tree has no matching element in the
+    /// new tree.
+    REMOVED = 1,
+
+    /// \brief The value of an element changed.
+    VALUE_CHANGED = 2,
+
+    /// \brief The value of an attribute of an element changed, or the
+    /// attribute was added or removed.
+    ATTRIBUTE_CHANGED = 3,
+  };
+
+  /// \brief A change between two element trees, computed by diffElements.
+  struct ElementChange
+  {
+    /// \brief The kind of change.
+    ElementChangeType type = ElementChangeType::ADDED;
+
+    /// \brief Path of the changed element from the root of the trees.
+    /// Each child is named after its element name and, if it has one, its
+    /// name attribute, such as "world[default]/model[box]/pose". Children
+    /// without name attribute are numbered among the children of their
+    /// parent with the same element name, such as "plugin#1", starting from
+    /// 0. The roots themselves have an empty path.
+    std::string path;
+
+    /// \brief Key of the changed attribute, for ATTRIBUTE_CHANGED.
+    std::string attribute;
+
+    /// \brief The old value, for VALUE_CHANGED and ATTRIBUTE_CHANGED. It is
+    /// empty for an attribute that was added.
+    std::string oldValue;
+
+    /// \brief The new value, for VALUE_CHANGED and ATTRIBUTE_CHANGED. It is
+    /// empty for an attribute that was removed.
+    std::string newValue;
+
+    /// \brief The element of the new tree for ADDED, VALUE_CHANGED and
+    /// ATTRIBUTE_CHANGED, or of the old tree for REMOVED.
+    ElementPtr element;
+  };
+
+  /// \brief Compute the changes between two element trees, such as two
+  /// versions of a world, so that only what changed is updated.
+  ///
+  /// Children are matched by their path, as described in
+  /// ElementChange::path, so that a child that moved among its siblings is
+  /// not a change. Matching subtrees with equal Element::Hash are skipped
+  /// without being compared, and the hashes are cached in the elements, so
+  /// that diffing trees again after a few changes only hashes the changed
+  /// elements again. An added or removed subtree is one change, with the
+  /// root of the subtree as its element.
+  /// \param[in] _old The old tree. It may be nullptr, in which case the
+  /// whole new tree is added.
+  /// \param[in] _new The new tree. It may be nullptr, in which case the
+  /// whole old tree is removed.
+  /// \return The changes, in document order of the new tree, followed by
+  /// the removed elements in document order of the old tree.
+  SDFORMAT_VISIBLE
+  std::vector<ElementChange> diffElements(const ElementPtr &_old,
+                                          const ElementPtr &_new);
+
+  /// \brief Compute the changes between the element trees of two roots, as
+  /// by diffElements.
+  /// \param[in] _old The old root.
+  /// \param[in] _new The new root.
+  /// \return The changes.
+  SDFORMAT_VISIBLE
+  std::vector<ElementChange> diffRoots(const Root &_old, const Root &_new);
+  }
+}
+#endif
@@ -131,6 +131,17 @@ namespace sdf
 
     /// \brief Indicates that reading an SDF string failed.
     STRING_READ,
+
+    /// \brief Indicates that a file could not be written.
+    FILE_WRITE,
+
+    /// \brief Loading was stopped by ParserConfig::CancelCallback, such as
+    /// through LoadHandle::Cancel.
+    LOAD_CANCELLED,
+
+    /// \brief Elements are nested deeper than
+    /// ParserConfig::MaxNestingDepth.
+    ELEMENT_NESTING_TOO_DEEP,
   };
 
   class SDFORMAT_VISIBLE Error
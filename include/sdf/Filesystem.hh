@@ -18,6 +18,7 @@
 #ifndef SDF_FILESYSTEM_HH_
 #define SDF_FILESYSTEM_HH_
 
+#include <ctime>
 #include <memory>
 #include <string>
 
@@ -40,6 +41,9 @@ namespace sdf
   namespace filesystem
   {
     /// \brief Determine whether the given path exists on the filesystem.
+    /// The members of the archives mounted by sdf::addURIPath exist at
+    /// paths below the path of their archive, which is a directory for this
+    /// function and for is_directory, last_write_time and status.
     /// \param[in] _path  The path to check for existence
     /// \return True if the path exists on the filesystem, false otherwise.
     SDFORMAT_VISIBLE
@@ -51,6 +55,63 @@ namespace sdf
     SDFORMAT_VISIBLE
     bool is_directory(const std::string &_path);
 
+    /// \brief Get the time at which the given path was last modified.
+    /// \param[in] _path The path to check
+    /// \return The modification time, or -1 if the path does not exist.
+    SDFORMAT_VISIBLE
+    std::time_t last_write_time(const std::string &_path);
+
+    /// \brief The type of a path, given by status.
+    enum class file_type
+    {
+      /// \brief The path does not exist.
+      not_found,
+
+      /// \brief A regular file.
+      regular,
+
+      /// \brief A directory.
+      directory,
+
+      /// \brief Any other type of file, such as a device.
+      other
+    };
+
+    /// \brief The existence, type and modification time of a path, which
+    /// status queries at once.
+    struct file_status
+    {
+      /// \brief The type of the path.
+      file_type type = file_type::not_found;
+
+      /// \brief The time at which the path was last modified, or -1 if it
+      /// does not exist.
+      std::time_t write_time = static_cast<std::time_t>(-1);
+
+      /// \brief Determine whether the path exists.
+      /// \return True if the path exists, like filesystem::exists.
+      bool exists() const
+      {
+        return this->type != file_type::not_found;
+      }
+
+      /// \brief Determine whether the path is a directory.
+      /// \return True if the path is a directory, like
+      /// filesystem::is_directory.
+      bool is_directory() const
+      {
+        return this->type == file_type::directory;
+      }
+    };
+
+    /// \brief Get the existence, type and modification time of a path with
+    /// a single query of the filesystem, instead of calling exists,
+    /// is_directory and last_write_time separately.
+    /// \param[in] _path The path to check
+    /// \return The status of the path.
+    SDFORMAT_VISIBLE
+    file_status status(const std::string &_path);
+
     /// \brief Create a new directory on the filesystem.  Intermediate
     ///        directories must already exist.
     /// \param[in] _path  The new directory path to create
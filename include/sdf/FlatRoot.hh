@@ -0,0 +1,414 @@
+/*
+ * Copyright 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef SDF_FLATROOT_HH_
+#define SDF_FLATROOT_HH_
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <ignition/math/Matrix3.hh>
+#include <ignition/math/Pose3.hh>
+#include <ignition/math/Vector3.hh>
+
+#include "sdf/Error.hh"
+#include "sdf/Joint.hh"
+#include "sdf/Sensor.hh"
+#include "sdf/Types.hh"
+#include "sdf/sdf_config.h"
+#include "sdf/system_util.hh"
+
+namespace sdf
+{
+  // Inline bracket to help doxygen filtering.
+  inline namespace SDF_VERSION_NAMESPACE {
+  //
+
+  class FlatLink;
+  class FlatJoint;
+  class FlatModel;
+  class FlatRoot;
+  class FlatWorld;
+
+  /// \brief A sensor of a buffer written by Root::SaveFlat. It refers to
+  /// the buffer, which must outlive it.
+  class SDFORMAT_VISIBLE FlatSensor
+  {
+    /// \brief Get the name of the sensor.
+    /// \return Name of the sensor.
+    public: std::string_view Name() const;
+
+    /// \brief Get the type of the sensor.
+    /// \return Type of the sensor.
+    public: SensorType Type() const;
+
+    /// \brief Get the topic of the sensor.
+    /// \return Topic of the sensor.
+    public: std::string_view Topic() const;
+
+    /// \brief Get the update rate of the sensor.
+    /// \return Update rate in Hz.
+    public: double UpdateRate() const;
+
+    /// \brief Get the pose of the sensor as written in the file.
+    /// \return The raw pose.
+    public: ignition::math::Pose3d RawPose() const;
+
+    /// \brief Get the frame that the raw pose is relative to.
+    /// \return Name of the frame, or an empty string for the parent link.
+    public: std::string_view PoseRelativeTo() const;
+
+    /// \brief Get the pose of the sensor resolved relative to its link.
+    /// \return The resolved pose.
+    public: ignition::math::Pose3d Pose() const;
+
+    /// \brief Constructor used by FlatLink.
+    /// \param[in] _data The buffer.
+    /// \param[in] _record Offset of the sensor record in the buffer.
+    private: FlatSensor(const char *_data, uint64_t _record);
+
+    /// \brief The buffer.
+    private: const char *data;
+
+    /// \brief Offset of the sensor record in the buffer.
+    private: uint64_t record;
+
+    friend class FlatLink;
+  };
+
+  /// \brief A link of a buffer written by Root::SaveFlat. It refers to the
+  /// buffer, which must outlive it.
+  class SDFORMAT_VISIBLE FlatLink
+  {
+    /// \brief Get the name of the link.
+    /// \return Name of the link.
+    public: std::string_view Name() const;
+
+    /// \brief Get the pose of the link as written in the file.
+    /// \return The raw pose.
+    public: ignition::math::Pose3d RawPose() const;
+
+    /// \brief Get the frame that the raw pose is relative to.
+    /// \return Name of the frame, or an empty string for the model frame.
+    public: std::string_view PoseRelativeTo() const;
+
+    /// \brief Get the pose of the link resolved relative to its model.
+    /// \return The resolved pose.
+    public: ignition::math::Pose3d Pose() const;
+
+    /// \brief Get the mass of the link.
+    /// \return The mass.
+    public: double Mass() const;
+
+    /// \brief Get the moment of inertia matrix of the link about its
+    /// inertial pose.
+    /// \return The matrix.
+    public: ignition::math::Matrix3d Moi() const;
+
+    /// \brief Get the pose of the center of mass of the link, relative to
+    /// the link.
+    /// \return The inertial pose.
+    public: ignition::math::Pose3d InertialPose() const;
+
+    /// \brief Get whether the link is affected by wind.
+    /// \return True if the link is affected by wind.
+    public: bool EnableWind() const;
+
+    /// \brief Get the number of sensors of the link.
+    /// \return Number of sensors.
+    public: uint64_t SensorCount() const;
+
+    /// \brief Get a sensor of the link.
+    /// \param[in] _index Index of the sensor, in Link::SensorByIndex order.
+    /// It must be less than SensorCount().
+    /// \return The sensor.
+    public: FlatSensor SensorByIndex(const uint64_t _index) const;
+
+    /// \brief Constructor used by FlatModel.
+    /// \param[in] _data The buffer.
+    /// \param[in] _record Offset of the link record in the buffer.
+    private: FlatLink(const char *_data, uint64_t _record);
+
+    /// \brief The buffer.
+    private: const char *data;
+
+    /// \brief Offset of the link record in the buffer.
+    private: uint64_t record;
+
+    friend class FlatModel;
+  };
+
+  /// \brief A joint of a buffer written by Root::SaveFlat. It refers to the
+  /// buffer, which must outlive it.
+  class SDFORMAT_VISIBLE FlatJoint
+  {
+    /// \brief Get the name of the joint.
+    /// \return Name of the joint.
+    public: std::string_view Name() const;
+
+    /// \brief Get the type of the joint.
+    /// \return Type of the joint.
+    public: JointType Type() const;
+
+    /// \brief Get the name of the parent link of the joint.
+    /// \return Name of the parent link.
+    public: std::string_view ParentLinkName() const;
+
+    /// \brief Get the name of the child link of the joint.
+    /// \return Name of the child link.
+    public: std::string_view ChildLinkName() const;
+
+    /// \brief Get the index of the parent link of the joint in
+    /// FlatModel::LinkByIndex, as in KinematicTree::jointParents.
+    /// \return Index of the parent link, or -1 for the world.
+    public: int64_t ParentLinkIndex() const;
+
+    /// \brief Get the index of the child link of the joint in
+    /// FlatModel::LinkByIndex, as in KinematicTree::jointChildren.
+    /// \return Index of the child link, or -1.
+    public: int64_t ChildLinkIndex() const;
+
+    /// \brief Get the pose of the joint as written in the file.
+    /// \return The raw pose.
+    public: ignition::math::Pose3d RawPose() const;
+
+    /// \brief Get the frame that the raw pose is relative to.
+    /// \return Name of the frame, or an empty string for the child link.
+    public: std::string_view PoseRelativeTo() const;
+
+    /// \brief Get the pose of the joint resolved relative to its model.
+    /// \return The resolved pose.
+    public: ignition::math::Pose3d Pose() const;
+
+    /// \brief Get the number of axes of the joint.
+    /// \return 0, 1 or 2.
+    public: unsigned int AxisCount() const;
+
+    /// \brief Get the unit vector of an axis, resolved in the model frame
+    /// as by Model::ResolveJointAxes.
+    /// \param[in] _index Index of the axis, 0 or 1.
+    /// \return The vector, or zero if the joint does not have the axis.
+    public: ignition::math::Vector3d AxisXyz(
+        const unsigned int _index = 0) const;
+
+    /// \brief Get the lower limit of an axis.
+    /// \param[in] _index Index of the axis, 0 or 1.
+    /// \return The lower limit, or 0 if the joint does not have the axis.
+    public: double AxisLower(const unsigned int _index = 0) const;
+
+    /// \brief Get the upper limit of an axis.
+    /// \param[in] _index Index of the axis, 0 or 1.
+    /// \return The upper limit, or 0 if the joint does not have the axis.
+    public: double AxisUpper(const unsigned int _index = 0) const;
+
+    /// \brief Get the effort limit of an axis.
+    /// \param[in] _index Index of the axis, 0 or 1.
+    /// \return The effort limit, or 0 if the joint does not have the axis.
+    public: double AxisEffort(const unsigned int _index = 0) const;
+
+    /// \brief Get the velocity limit of an axis.
+    /// \param[in] _index Index of the axis, 0 or 1.
+    /// \return The velocity limit, or 0 if the joint does not have the
+    /// axis.
+    public: double AxisMaxVelocity(const unsigned int _index = 0) const;
+
+    /// \brief Constructor used by FlatModel.
+    /// \param[in] _data The buffer.
+    /// \param[in] _record Offset of the joint record in the buffer.
+    private: FlatJoint(const char *_data, uint64_t _record);
+
+    /// \brief The buffer.
+    private: const char *data;
+
+    /// \brief Offset of the joint record in the buffer.
+    private: uint64_t record;
+
+    friend class FlatModel;
+  };
+
+  /// \brief A model of a buffer written by Root::SaveFlat. It refers to the
+  /// buffer, which must outlive it.
+  class SDFORMAT_VISIBLE FlatModel
+  {
+    /// \brief Get the name of the model.
+    /// \return Name of the model.
+    public: std::string_view Name() const;
+
+    /// \brief Get whether the model is static.
+    /// \return True if the model is static.
+    public: bool Static() const;
+
+    /// \brief Get whether the links of the model collide with each other.
+    /// \return True if self collision is enabled.
+    public: bool SelfCollide() const;
+
+    /// \brief Get whether the model may be auto-disabled.
+    /// \return True if auto-disable is allowed.
+    public: bool AllowAutoDisable() const;
+
+    /// \brief Get whether the model is affected by wind.
+    /// \return True if the model is affected by wind.
+    public: bool EnableWind() const;
+
+    /// \brief Get the name of the canonical link of the model.
+    /// \return Name of the canonical link, or an empty string for the first
+    /// link.
+    public: std::string_view CanonicalLinkName() const;
+
+    /// \brief Get the pose of the model as written in the file.
+    /// \return The raw pose.
+    public: ignition::math::Pose3d RawPose() const;
+
+    /// \brief Get the frame that the raw pose is relative to.
+    /// \return Name of the frame, or an empty string for the world frame.
+    public: std::string_view PoseRelativeTo() const;
+
+    /// \brief Get the pose of the model resolved relative to the world
+    /// frame, or the raw pose for a model that is not in a world.
+    /// \return The resolved pose.
+    public: ignition::math::Pose3d Pose() const;
+
+    /// \brief Get the number of links of the model.
+    /// \return Number of links.
+    public: uint64_t LinkCount() const;
+
+    /// \brief Get a link of the model.
+    /// \param[in] _index Index of the link, in Model::LinkByIndex order. It
+    /// must be less than LinkCount().
+    /// \return The link.
+    public: FlatLink LinkByIndex(const uint64_t _index) const;
+
+    /// \brief Get the number of joints of the model.
+    /// \return Number of joints.
+    public: uint64_t JointCount() const;
+
+    /// \brief Get a joint of the model.
+    /// \param[in] _index Index of the joint, in Model::JointByIndex order.
+    /// It must be less than JointCount().
+    /// \return The joint.
+    public: FlatJoint JointByIndex(const uint64_t _index) const;
+
+    /// \brief Constructor used by FlatWorld and FlatRoot.
+    /// \param[in] _data The buffer.
+    /// \param[in] _record Offset of the model record in the buffer.
+    private: FlatModel(const char *_data, uint64_t _record);
+
+    /// \brief The buffer.
+    private: const char *data;
+
+    /// \brief Offset of the model record in the buffer.
+    private: uint64_t record;
+
+    friend class FlatRoot;
+    friend class FlatWorld;
+  };
+
+  /// \brief A world of a buffer written by Root::SaveFlat. It refers to the
+  /// buffer, which must outlive it.
+  class SDFORMAT_VISIBLE FlatWorld
+  {
+    /// \brief Get the name of the world.
+    /// \return Name of the world.
+    public: std::string_view Name() const;
+
+    /// \brief Get the gravity of the world.
+    /// \return Gravity in m/s^2.
+    public: ignition::math::Vector3d Gravity() const;
+
+    /// \brief Get the magnetic field of the world.
+    /// \return Magnetic field in Tesla.
+    public: ignition::math::Vector3d MagneticField() const;
+
+    /// \brief Get the linear velocity of the wind of the world.
+    /// \return Wind velocity in m/s.
+    public: ignition::math::Vector3d WindLinearVelocity() const;
+
+    /// \brief Get the number of models of the world.
+    /// \return Number of models.
+    public: uint64_t ModelCount() const;
+
+    /// \brief Get a model of the world.
+    /// \param[in] _index Index of the model, in World::ModelByIndex order.
+    /// It must be less than ModelCount().
+    /// \return The model.
+    public: FlatModel ModelByIndex(const uint64_t _index) const;
+
+    /// \brief Constructor used by FlatRoot.
+    /// \param[in] _data The buffer.
+    /// \param[in] _record Offset of the world record in the buffer.
+    private: FlatWorld(const char *_data, uint64_t _record);
+
+    /// \brief The buffer.
+    private: const char *data;
+
+    /// \brief Offset of the world record in the buffer.
+    private: uint64_t record;
+
+    friend class FlatRoot;
+  };
+
+  /// \brief Reads in place the typed DOM that Root::SaveFlat writes to a
+  /// buffer, so that processes that receive the buffer through shared
+  /// memory or a memory-mapped file read worlds, models, links, joints and
+  /// sensors without parsing or copying anything.
+  ///
+  /// The buffer holds fixed-size records that refer to each other and to
+  /// their strings by offset from the start of the buffer. Open checks
+  /// every offset once, after which the accessors of the views read the
+  /// records directly. The buffer is not copied, so it must stay mapped
+  /// while the views are used. It must be aligned to 8 bytes, which memory
+  /// mappings and shared memory segments are, and it is only read by a
+  /// machine with the byte order of the writer.
+  class SDFORMAT_VISIBLE FlatRoot
+  {
+    /// \brief Check a buffer written by Root::SaveFlat and read it.
+    /// \param[in] _data The buffer, aligned to 8 bytes.
+    /// \param[in] _size Size of the buffer in bytes.
+    /// \return Errors of a truncated or invalid buffer. Nothing can be read
+    /// if there are errors.
+    public: Errors Open(const void *_data, std::size_t _size);
+
+    /// \brief Get the SDFormat version of the root that was written.
+    /// \return The version, or an empty string if no buffer is open.
+    public: std::string_view Version() const;
+
+    /// \brief Get the number of worlds.
+    /// \return Number of worlds.
+    public: uint64_t WorldCount() const;
+
+    /// \brief Get a world.
+    /// \param[in] _index Index of the world, in Root::WorldByIndex order. It
+    /// must be less than WorldCount().
+    /// \return The world.
+    public: FlatWorld WorldByIndex(const uint64_t _index) const;
+
+    /// \brief Get the number of models that are not in a world, which is 0
+    /// or 1 as for Root::ModelCount.
+    /// \return Number of models.
+    public: uint64_t ModelCount() const;
+
+    /// \brief Get a model that is not in a world.
+    /// \param[in] _index Index of the model. It must be less than
+    /// ModelCount().
+    /// \return The model.
+    public: FlatModel ModelByIndex(const uint64_t _index) const;
+
+    /// \brief The buffer, or nullptr if none is open.
+    private: const char *data = nullptr;
+  };
+  }
+}
+#endif
@@ -0,0 +1,164 @@
+/*
+ * Copyright 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef SDF_INCLUDECACHE_HH_
+#define SDF_INCLUDECACHE_HH_
+
+#include <cstddef>
+#include <string>
+
+#include "sdf/Element.hh"
+#include "sdf/sdf_config.h"
+#include "sdf/system_util.hh"
+
+namespace sdf
+{
+  // Inline bracket to help doxygen filtering.
+  inline namespace SDF_VERSION_NAMESPACE {
+  //
+
+  // Forward declare private data class.
+  class IncludeCachePrivate;
+
+  /// \brief Cache of files that have been read while resolving
+  /// `<include>` elements.
+  ///
+  /// Each entry stores the fully read and converted element tree of a
+  /// model file, keyed by the resolved path of that file. An entry is only
+  /// used while the modification time of the file matches the time at which
+  /// the entry was stored. When a world includes the same model many times,
+  /// the parser then reads the model file once, and every `<include>`
+  /// applies its `<name>`, `<pose>`, `<static>` and `<plugin>` overrides to
+  /// a copy-on-write clone of the stored tree, which only copies the
+  /// elements that the overrides change.
+  ///
+  /// Nested includes are resolved when the model file is first read, so
+  /// changes to files included by a cached model file are not detected.
+  ///
+  /// The cache also stores the model file chosen for each included model
+  /// directory from its model.config, so that the config is only parsed
+  /// again when its modification time changes.
+  ///
+  /// A cache can also share its element trees with other processes on the
+  /// same host through a directory, see SetSharedDirectory, so that a model
+  /// library is only parsed and converted by the first process that
+  /// includes it.
+  ///
+  /// All functions are safe to call from several threads at once, so a
+  /// single cache can be shared by concurrent loads.
+  ///
+  /// \sa ParserConfig::SetIncludeCache
+  class SDFORMAT_VISIBLE IncludeCache
+  {
+    /// \brief Default constructor
+    public: IncludeCache();
+
+    /// \brief Copy constructor is explicitly deleted.
+    public: IncludeCache(const IncludeCache &_cache) = delete;
+
+    /// \brief Assignment operator is explicitly deleted.
+    public: IncludeCache &operator=(const IncludeCache &_cache) = delete;
+
+    /// \brief Destructor
+    public: ~IncludeCache();
+
+    /// \brief Get a copy of the element tree stored for a file. The copy
+    /// shares the stored tree until it is modified or read in depth, see
+    /// Element::CopyOnWriteClone, so includes that are used as they are
+    /// cost little.
+    /// \param[in] _filename Resolved path of the file.
+    /// \return A clone of the stored element tree, or nullptr if no
+    /// entry exists for the file or the file changed after it was stored.
+    public: ElementPtr Find(const std::string &_filename) const;
+
+    /// \brief Store the element tree read from a file. The tree is cloned,
+    /// so later changes to _elem do not affect the cache.
+    /// \param[in] _filename Resolved path of the file.
+    /// \param[in] _elem Element tree read from the file.
+    /// \sa Share
+    public: void Insert(const std::string &_filename, const ElementPtr _elem);
+
+    /// \brief Store the element tree read from a file without cloning it,
+    /// and get a copy of it as Find does. The tree must not be modified
+    /// afterwards, so the caller uses the copy instead, such as the first
+    /// `<include>` of a file, which then applies its overrides to a copy
+    /// like the other includes of the file.
+    /// \param[in] _filename Resolved path of the file.
+    /// \param[in] _elem Element tree read from the file.
+    /// \return A copy of _elem that shares it until it is modified, or
+    /// _elem itself if it is not stored, because it is null or the file
+    /// does not exist.
+    public: ElementPtr Share(const std::string &_filename,
+                             const ElementPtr _elem);
+
+    /// \brief Get the model file stored for a model directory.
+    /// \param[in] _modelDirPath Path of the model directory.
+    /// \return Path of the model file, or an empty string if no entry
+    /// exists for the directory or its config file changed after it was
+    /// stored.
+    /// \sa getModelFilePath
+    public: std::string FindModelFile(const std::string &_modelDirPath) const;
+
+    /// \brief Store the model file chosen for a model directory. The entry
+    /// is tied to the modification time of the model.config, or of the
+    /// deprecated manifest.xml, of the directory.
+    /// \param[in] _modelDirPath Path of the model directory.
+    /// \param[in] _modelFilePath Path of the model file.
+    public: void InsertModelFile(const std::string &_modelDirPath,
+                                 const std::string &_modelFilePath);
+
+    /// \brief Set a directory through which the cache shares element trees
+    /// with the caches of other processes. Each stored tree is also written
+    /// to this directory in the binary format, in a file named after the
+    /// library version and a hash of the resolved path of the included file.
+    /// A tree that is not stored in this cache is looked for in the
+    /// directory before the file is parsed, and the entry is memory mapped
+    /// and read without parsing XML, converting or resolving includes.
+    /// Entries are only used while the modification time of the included
+    /// file matches the time at which they were written.
+    ///
+    /// A directory in a memory file system, such as /dev/shm on Linux,
+    /// keeps the entries in shared memory. Entries are written to a
+    /// temporary file that is then renamed, so that other processes never
+    /// read a partial entry. They are never deleted by the cache.
+    /// \param[in] _path Path of the directory, which is created if its
+    /// parent exists, or an empty string to not share trees, which is the
+    /// default.
+    /// \return False if the directory does not exist and could not be
+    /// created, in which case trees are not shared.
+    public: bool SetSharedDirectory(const std::string &_path);
+
+    /// \brief Get the directory through which trees are shared with other
+    /// processes.
+    /// \return Path of the directory, or an empty string if trees are not
+    /// shared.
+    /// \sa SetSharedDirectory
+    public: std::string SharedDirectory() const;
+
+    /// \brief Get the number of stored files.
+    /// \return Number of entries in the cache.
+    public: std::size_t Size() const;
+
+    /// \brief Remove all entries from the cache, including the model files
+    /// of model directories.
+    public: void Clear();
+
+    /// \brief Private data pointer.
+    private: IncludeCachePrivate *dataPtr = nullptr;
+  };
+  }
+}
+#endif
@@ -0,0 +1,173 @@
+/*
+ * Copyright 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef SDF_INTERNEDSTRING_HH_
+#define SDF_INTERNEDSTRING_HH_
+
+#include <cstddef>
+#include <ostream>
+#include <string>
+
+#include "sdf/sdf_config.h"
+#include "sdf/system_util.hh"
+
+namespace sdf
+{
+  // Inline bracket to help doxygen filtering.
+  inline namespace SDF_VERSION_NAMESPACE {
+  //
+
+  /// \brief A string stored once in a global, thread-safe symbol table.
+  ///
+  /// Element names, attribute keys, type names and descriptions come from
+  /// the small vocabulary of the SDFormat specification, but are held by
+  /// every element and parameter. An InternedString only holds a pointer
+  /// to the single copy of its string, and two interned strings are equal
+  /// if and only if they point to the same copy. Strings are never removed
+  /// from the table, so references returned by Str() stay valid for the
+  /// lifetime of the program.
+  class SDFORMAT_VISIBLE InternedString
+  {
+    /// \brief Constructor for the empty string.
+    public: InternedString();
+
+    /// \brief Constructor, which interns a string.
+    /// \param[in] _str The string.
+    // cppcheck-suppress noExplicitConstructor
+    public: InternedString(const std::string &_str);
+
+    /// \brief Constructor, which interns a string.
+    /// \param[in] _str The null terminated string.
+    // cppcheck-suppress noExplicitConstructor
+    public: InternedString(const char *_str);
+
+    /// \brief Get the string.
+    /// \return The interned copy of the string.
+    public: const std::string &Str() const;
+
+    /// \brief Get the string.
+    /// \return The interned copy of the string.
+    public: operator const std::string &() const;
+
+    /// \brief Get whether the string is empty.
+    /// \return True if the string is empty.
+    public: bool Empty() const;
+
+    /// \brief Get the number of strings in the symbol table.
+    /// \return Number of distinct strings that have been interned.
+    public: static std::size_t TableSize();
+
+    /// \brief Get the number of bytes of the strings in the symbol table.
+    /// \return Total size of the distinct strings that have been interned,
+    /// not counting the overhead of the table.
+    public: static std::size_t TableBytes();
+
+    /// \brief Equality operator, which compares pointers.
+    /// \param[in] _a First string.
+    /// \param[in] _b Second string.
+    /// \return True if the strings are equal.
+    public: friend bool operator==(const InternedString &_a,
+                                   const InternedString &_b)
+    {
+      return _a.str == _b.str;
+    }
+
+    /// \brief Inequality operator, which compares pointers.
+    /// \param[in] _a First string.
+    /// \param[in] _b Second string.
+    /// \return True if the strings differ.
+    public: friend bool operator!=(const InternedString &_a,
+                                   const InternedString &_b)
+    {
+      return _a.str != _b.str;
+    }
+
+    /// \brief Equality operator with a string that is not interned.
+    /// \param[in] _a Interned string.
+    /// \param[in] _b Other string.
+    /// \return True if the strings are equal.
+    public: friend bool operator==(const InternedString &_a,
+                                   const std::string &_b)
+    {
+      return *_a.str == _b;
+    }
+
+    /// \brief Equality operator with a string that is not interned.
+    /// \param[in] _a Other string.
+    /// \param[in] _b Interned string.
+    /// \return True if the strings are equal.
+    public: friend bool operator==(const std::string &_a,
+                                   const InternedString &_b)
+    {
+      return _a == *_b.str;
+    }
+
+    /// \brief Equality operator with a string that is not interned.
+    /// \param[in] _a Interned string.
+    /// \param[in] _b Other null terminated string.
+    /// \return True if the strings are equal.
+    public: friend bool operator==(const InternedString &_a,
+                                   const char *_b)
+    {
+      return *_a.str == _b;
+    }
+
+    /// \brief Inequality operator with a string that is not interned.
+    /// \param[in] _a Interned string.
+    /// \param[in] _b Other string.
+    /// \return True if the strings differ.
+    public: friend bool operator!=(const InternedString &_a,
+                                   const std::string &_b)
+    {
+      return *_a.str != _b;
+    }
+
+    /// \brief Inequality operator with a string that is not interned.
+    /// \param[in] _a Other string.
+    /// \param[in] _b Interned string.
+    /// \return True if the strings differ.
+    public: friend bool operator!=(const std::string &_a,
+                                   const InternedString &_b)
+    {
+      return _a != *_b.str;
+    }
+
+    /// \brief Inequality operator with a string that is not interned.
+    /// \param[in] _a Interned string.
+    /// \param[in] _b Other null terminated string.
+    /// \return True if the strings differ.
+    public: friend bool operator!=(const InternedString &_a,
+                                   const char *_b)
+    {
+      return *_a.str != _b;
+    }
+
+    /// \brief Stream insertion operator.
+    /// \param[in] _out The output stream.
+    /// \param[in] _str The string to write.
+    /// \return The output stream.
+    public: friend std::ostream &operator<<(std::ostream &_out,
+                                            const InternedString &_str)
+    {
+      return _out << *_str.str;
+    }
+
+    /// \brief The interned copy of the string.
+    private: const std::string *str;
+  };
+  }
+}
+#endif
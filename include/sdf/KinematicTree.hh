@@ -0,0 +1,123 @@
+/*
+ * Copyright 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef SDF_KINEMATICTREE_HH_
+#define SDF_KINEMATICTREE_HH_
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "sdf/sdf_config.h"
+
+namespace sdf
+{
+  // Inline bracket to help doxygen filtering.
+  inline namespace SDF_VERSION_NAMESPACE {
+  //
+
+  /// \brief The tree formed by the links and joints of a model, built when
+  /// the model is loaded and returned by Model::KinematicTree.
+  ///
+  /// The parent joint of a link is the first joint of which it is the
+  /// child, and the other joints of which it is the child close loops.
+  /// Links and joints are referred to by their index in Model::LinkByIndex
+  /// and Model::JointByIndex, and -1 refers to the world or to no object.
+  struct KinematicTree
+  {
+    /// \brief Index of each link in topological order: every link comes
+    /// after the link it is attached to by its parent joint. Links on a
+    /// loop of parent joints are last, in index order.
+    std::vector<uint64_t> linkOrder;
+
+    /// \brief Parent joint of each link, or -1.
+    std::vector<int64_t> parentJoints;
+
+    /// \brief Parent link of each link, or -1 for a link without parent
+    /// joint or whose parent joint is attached to the world.
+    std::vector<int64_t> parentLinks;
+
+    /// \brief Number of parent joints between each link and the world, so
+    /// 0 for the roots of the tree, or -1 for links on a loop of parent
+    /// joints.
+    std::vector<int64_t> depths;
+
+    /// \brief Position in childLinks of the first child of each link. The
+    /// children of link i are childLinks[childOffsets[i]] up to
+    /// childLinks[childOffsets[i + 1]], so there is one more offset than
+    /// there are links.
+    std::vector<uint64_t> childOffsets;
+
+    /// \brief The links of which each link is the parent link, grouped by
+    /// parent and in index order.
+    std::vector<uint64_t> childLinks;
+
+    /// \brief Parent link of each joint, or -1 for the world or a link that
+    /// does not exist.
+    std::vector<int64_t> jointParents;
+
+    /// \brief Child link of each joint, or -1 for a link that does not
+    /// exist.
+    std::vector<int64_t> jointChildren;
+  };
+
+  /// \brief The pairs of links of a model that are not checked for
+  /// collision with each other, because they are attached by joints,
+  /// returned by Model::SelfCollisionExclusions. Models with the same links
+  /// and joints share the same exclusions, such as the copies of a robot.
+  ///
+  /// Links are referred to by their index in Model::LinkByIndex. The pairs
+  /// are sorted by first link and then by second link, and the first link
+  /// of a pair is less than the second.
+  struct SelfCollisionExclusions
+  {
+    /// \brief Number of links of the model.
+    uint64_t linkCount = 0;
+
+    /// \brief Whether the model has self collision enabled, as in
+    /// Model::SelfCollide. If it is false, every pair is excluded.
+    bool selfCollide = false;
+
+    /// \brief First link of each pair.
+    std::vector<uint64_t> firstLinks;
+
+    /// \brief Second link of each pair.
+    std::vector<uint64_t> secondLinks;
+
+    /// \brief Get whether two links are not checked for collision with
+    /// each other.
+    /// \param[in] _linkA Index of the first link.
+    /// \param[in] _linkB Index of the second link.
+    /// \return True if the pair is excluded or the links are the same.
+    bool Excluded(uint64_t _linkA, uint64_t _linkB) const
+    {
+      if (!this->selfCollide || _linkA == _linkB)
+        return true;
+      if (_linkA > _linkB)
+        std::swap(_linkA, _linkB);
+      auto begin = std::lower_bound(this->firstLinks.begin(),
+          this->firstLinks.end(), _linkA);
+      auto end = std::upper_bound(begin, this->firstLinks.end(), _linkA);
+      const auto offset = begin - this->firstLinks.begin();
+      return std::binary_search(this->secondLinks.begin() + offset,
+          this->secondLinks.begin() + (end - this->firstLinks.begin()),
+          _linkB);
+    }
+  };
+  }
+}
+#endif
@@ -17,6 +17,9 @@
 #ifndef SDF_LIDAR_HH_
 #define SDF_LIDAR_HH_
 
+#include <memory>
+#include <vector>
+
 #include <sdf/Error.hh>
 #include <sdf/Element.hh>
 #include <sdf/Noise.hh>
@@ -31,6 +34,31 @@ namespace sdf
   //
   class LidarPrivate;
 
+  /// \brief Unit vectors of the rays of a lidar, in the sensor frame. The
+  /// coordinates are stored in separate arrays, so that ray casters can
+  /// process several rays at once. The rays are ordered by vertical angle
+  /// and then by horizontal angle, so that the ray at vertical index `v`
+  /// and horizontal index `h` is at index `v * horizontalCount + h`.
+  struct LidarRayDirections
+  {
+    /// \brief Number of rays horizontally, which is the number of
+    /// horizontal scan samples.
+    unsigned int horizontalCount = 0;
+
+    /// \brief Number of rays vertically, which is the number of vertical
+    /// scan samples.
+    unsigned int verticalCount = 0;
+
+    /// \brief X coordinates of the rays.
+    std::vector<double> x;
+
+    /// \brief Y coordinates of the rays.
+    std::vector<double> y;
+
+    /// \brief Z coordinates of the rays.
+    std::vector<double> z;
+  };
+
   /// \brief Lidar contains information about a Lidar sensor.
   /// This sensor can be attached to a link. The Lidar sensor can be defined
   /// SDF XML using either the "ray" or "lidar" types. The "lidar" type is
@@ -209,6 +237,19 @@ namespace sdf
     /// \param[in] Maximum angle for vertical scan.
     public: void SetVerticalScanMaxAngle(const ignition::math::Angle &_max);
 
+    /// \brief Get the unit vectors of the rays of the lidar, in the sensor
+    /// frame. The rays are evenly spaced from the minimum to the maximum
+    /// angle of each scan, and a scan with a single sample is at its
+    /// minimum angle. The ray at horizontal angle `h` and vertical angle
+    /// `v` is `(cos(v) cos(h), cos(v) sin(h), sin(v))`.
+    ///
+    /// The table is computed once for each set of scan samples and angles,
+    /// and shared by all lidars with the same ones until they are modified
+    /// or destroyed, so that many identical sensors do not compute and
+    /// store their own table.
+    /// \return The ray directions, which are never null.
+    public: std::shared_ptr<const LidarRayDirections> RayDirections() const;
+
     /// \brief Get minimum distance for each lidar ray.
     /// \return Minimum distance for each lidar ray.
     public: double RangeMin() const;
@@ -103,7 +103,7 @@ namespace sdf
 
     /// \brief Get the name of the light.
     /// \return Name of the light.
-    public: std::string Name() const;
+    public: const std::string &Name() const;
 
     /// \brief Set the name of the light.
     /// \param[in] _name Name of the light.
@@ -0,0 +1,149 @@
+/*
+ * Copyright 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef SDF_LIGHTCULLING_HH_
+#define SDF_LIGHTCULLING_HH_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <ignition/math/Pose3.hh>
+#include <ignition/math/Vector3.hh>
+
+#include "sdf/Light.hh"
+#include "sdf/sdf_config.h"
+
+namespace sdf
+{
+  // Inline bracket to help doxygen filtering.
+  inline namespace SDF_VERSION_NAMESPACE {
+  //
+
+  /// \brief The lights of a world or root with what a renderer needs to
+  /// cull them, stored as contiguous arrays, one array per property, so
+  /// that forward+ or clustered shading builds its clusters in one pass.
+  /// It is filled by World::ResolveLightCulling and
+  /// Root::ResolveLightCulling.
+  ///
+  /// The influence radius of a light is the smaller of its attenuation
+  /// range and the distance at which its attenuation
+  /// 1 / (constant + linear * d + quadratic * d^2) falls below 1/256. It is
+  /// infinite for directional lights. The bounds of a light are the
+  /// smallest sphere that holds its influence: the sphere of the influence
+  /// radius around a point light, and the sphere around the cone of a spot
+  /// light, whose angle is its outer angle.
+  ///
+  /// If the cell size given to the Resolve function is positive, the lights
+  /// are also assigned to the cells of a uniform grid that their bounds
+  /// overlap. Cell (x, y, z) spans [x, x + 1) * cellSize along the X axis,
+  /// and likewise for Y and Z. Lights with infinite bounds, such as
+  /// directional lights, are in no cell and are to be applied everywhere.
+  /// Only the cells that hold lights are listed. The lights of cell c are
+  /// cellLights[CellBegin(c)] to cellLights[CellEnd(c) - 1], in the order
+  /// of the light arrays.
+  struct LightCulling
+  {
+    /// \brief Type of each light.
+    std::vector<LightType> types;
+
+    /// \brief Index of the model of each light in World::ModelByIndex, or
+    /// -1 for a light of the world or root.
+    std::vector<int64_t> modelIndices;
+
+    /// \brief Index of the link of each light in Model::LinkByIndex, or -1
+    /// for a light of the world or root.
+    std::vector<int64_t> linkIndices;
+
+    /// \brief Index of each light in the LightByIndex function of its
+    /// link, world or root.
+    std::vector<uint64_t> indices;
+
+    /// \brief Pose of each light in the world frame.
+    std::vector<ignition::math::Pose3d> poses;
+
+    /// \brief Unit direction of each spot and directional light in the
+    /// world frame, or zero if its direction is zero.
+    std::vector<ignition::math::Vector3d> directions;
+
+    /// \brief Influence radius of each light.
+    std::vector<double> radii;
+
+    /// \brief Cosine of half the inner angle of each spot light, or 1 for
+    /// other lights.
+    std::vector<double> spotCosInner;
+
+    /// \brief Cosine of half the outer angle of each spot light, or -1 for
+    /// other lights.
+    std::vector<double> spotCosOuter;
+
+    /// \brief Center of the bounds of each light in the world frame.
+    std::vector<ignition::math::Vector3d> boundCenters;
+
+    /// \brief Radius of the bounds of each light.
+    std::vector<double> boundRadii;
+
+    /// \brief Whether each light casts shadows.
+    std::vector<bool> castShadows;
+
+    /// \brief Size of the cells of the grid, or 0 if there is no grid.
+    double cellSize = 0;
+
+    /// \brief Coordinates of each cell of the grid that holds lights, in
+    /// the order of their first light.
+    std::vector<std::array<int32_t, 3>> cells;
+
+    /// \brief Position of the first light of each cell in cellLights,
+    /// followed by the size of cellLights.
+    std::vector<std::size_t> cellOffsets;
+
+    /// \brief Position in the light arrays of the lights of each cell.
+    std::vector<uint32_t> cellLights;
+
+    /// \brief Get the number of lights.
+    /// \return Number of lights.
+    std::size_t LightCount() const
+    {
+      return this->types.size();
+    }
+
+    /// \brief Get the number of cells of the grid that hold lights.
+    /// \return Number of cells.
+    std::size_t CellCount() const
+    {
+      return this->cells.size();
+    }
+
+    /// \brief Get the position of the first light of a cell in cellLights.
+    /// \param[in] _cell The cell.
+    /// \return Position in cellLights.
+    std::size_t CellBegin(const std::size_t _cell) const
+    {
+      return this->cellOffsets[_cell];
+    }
+
+    /// \brief Get the position after the last light of a cell in
+    /// cellLights.
+    /// \param[in] _cell The cell.
+    /// \return Position in cellLights.
+    std::size_t CellEnd(const std::size_t _cell) const
+    {
+      return this->cellOffsets[_cell + 1];
+    }
+  };
+  }
+}
+#endif
@@ -17,8 +17,10 @@
 #ifndef SDF_LINK_HH_
 #define SDF_LINK_HH_
 
+#include <cstddef>
 #include <memory>
 #include <string>
+#include <string_view>
 #include <ignition/math/Pose3.hh>
 #include "sdf/Element.hh"
 #include "sdf/SemanticPose.hh"
@@ -34,6 +36,7 @@ namespace sdf
 
   // Forward declarations.
   class Collision;
+  struct CollisionGeometry;
   class Light;
   class LinkPrivate;
   class Sensor;
@@ -78,7 +81,7 @@ namespace sdf
     /// \brief Get the name of the link.
     /// The name of a link must be unique within the scope of a Model.
     /// \return Name of the link.
-    public: std::string Name() const;
+    public: const std::string &Name() const;
 
     /// \brief Set the name of the link.
     /// The name of a link must be unique within the scope of a Model.
@@ -99,12 +102,12 @@ namespace sdf
     /// \brief Get whether a visual name exists.
     /// \param[in] _name Name of the visual to check.
     /// \return True if there exists a visual with the given name.
-    public: bool VisualNameExists(const std::string &_name) const;
+    public: bool VisualNameExists(std::string_view _name) const;
 
     /// \brief Get a visual based on a name.
     /// \param[in] _name Name of the visual.
     /// \return Pointer to the visual. Nullptr if the name does not exist.
-    public: const Visual *VisualByName(const std::string &_name) const;
+    public: const Visual *VisualByName(std::string_view _name) const;
 
     /// \brief Get the number of collisions.
     /// \return Number of collisions contained in this Link object.
@@ -120,12 +123,12 @@ namespace sdf
     /// \brief Get whether a collision name exists.
     /// \param[in] _name Name of the collision to check.
     /// \return True if there exists a collision with the given name.
-    public: bool CollisionNameExists(const std::string &_name) const;
+    public: bool CollisionNameExists(std::string_view _name) const;
 
     /// \brief Get a collision based on a name.
     /// \param[in] _name Name of the collision.
     /// \return Pointer to the collision. Nullptr if the name does not exist.
-    public: const Collision *CollisionByName(const std::string &_name) const;
+    public: const Collision *CollisionByName(std::string_view _name) const;
 
     /// \brief Get the number of lights.
     /// \return Number of lights contained in this Link object.
@@ -141,12 +144,12 @@ namespace sdf
     /// \brief Get whether a light name exists.
     /// \param[in] _name Name of the light to check.
     /// \return True if there exists a light with the given name.
-    public: bool LightNameExists(const std::string &_name) const;
+    public: bool LightNameExists(std::string_view _name) const;
 
     /// \brief Get a light based on a name.
     /// \param[in] _name Name of the light.
     /// \return Pointer to the light. Nullptr if the name does not exist.
-    public: const Light *LightByName(const std::string &_name) const;
+    public: const Light *LightByName(std::string_view _name) const;
 
     /// \brief Get the number of sensors.
     /// \return Number of sensors contained in this Link object.
@@ -162,14 +165,40 @@ namespace sdf
     /// \brief Get whether a sensor name exists.
     /// \param[in] _name Name of the sensor to check.
     /// \return True if there exists a sensor with the given name.
-    public: bool SensorNameExists(const std::string &_name) const;
+    public: bool SensorNameExists(std::string_view _name) const;
 
     /// \brief Get a sensor based on a name.
     /// \param[in] _name Name of the sensor.
     /// \return Pointer to the sensor. Nullptr if a sensor with the given name
     ///  does not exist.
-    /// \sa bool SensorNameExists(const std::string &_name) const
-    public: const Sensor *SensorByName(const std::string &_name) const;
+    /// \sa bool SensorNameExists(std::string_view _name) const
+    public: const Sensor *SensorByName(std::string_view _name) const;
+
+    /// \brief Add a visual to a link that is built programmatically. The
+    /// name index is updated in place instead of being rebuilt, and the
+    /// visual is given the pose graph of the link.
+    /// \param[in] _visual The visual, which is moved into the link only if
+    /// its name is not used by another visual of the link.
+    /// \return True if the visual was added.
+    public: bool AddVisual(Visual &&_visual);
+
+    /// \brief Add a collision to a link, in the same way as AddVisual.
+    /// \param[in] _collision The collision, which is moved into the link
+    /// only if its name is not used by another collision of the link.
+    /// \return True if the collision was added.
+    public: bool AddCollision(Collision &&_collision);
+
+    /// \brief Add a light to a link, in the same way as AddVisual.
+    /// \param[in] _light The light, which is moved into the link only if
+    /// its name is not used by another light of the link.
+    /// \return True if the light was added.
+    public: bool AddLight(Light &&_light);
+
+    /// \brief Add a sensor to a link, in the same way as AddVisual.
+    /// \param[in] _sensor The sensor, which is moved into the link only if
+    /// its name is not used by another sensor of the link.
+    /// \return True if the sensor was added.
+    public: bool AddSensor(Sensor &&_sensor);
 
     /// \brief Get the inertial value for this link. The inertial object
     /// consists of the link's mass, a 3x3 rotational inertia matrix, and
@@ -255,6 +284,17 @@ namespace sdf
     /// \return SemanticPose object for this link.
     public: sdf::SemanticPose SemanticPose() const;
 
+    /// \brief Export the collisions of this link as contiguous arrays, with
+    /// their bounding boxes, volumes and inertias computed from their
+    /// shapes, as described in CollisionGeometry. The poses of collisions
+    /// that are expressed in the link frame are used as is, and the others
+    /// are resolved through the pose graph.
+    /// \param[out] _geometry The arrays, in CollisionByIndex order. They
+    /// are not changed if there are errors.
+    /// \return Errors.
+    public: Errors ResolveCollisionGeometry(
+        CollisionGeometry &_geometry) const;
+
     /// \brief Give a weak pointer to the PoseRelativeToGraph to be used
     /// for resolving poses. This is private and is intended to be called by
     /// Model::Load.
@@ -262,6 +302,12 @@ namespace sdf
     private: void SetPoseRelativeToGraph(
         std::weak_ptr<const PoseRelativeToGraph> _graph);
 
+    /// \brief Release the capacity that the vectors of this link keep for
+    /// growth. This is private and is intended to be called by
+    /// Model::Compact.
+    /// \return Number of bytes released.
+    private: std::size_t Compact();
+
     /// \brief Allow Model::Load to call SetPoseRelativeToGraph.
     friend class Model;
 
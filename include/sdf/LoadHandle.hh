@@ -0,0 +1,108 @@
+/*
+ * Copyright 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef SDF_LOADHANDLE_HH_
+#define SDF_LOADHANDLE_HH_
+
+#include <chrono>
+
+#include "sdf/Error.hh"
+#include "sdf/Types.hh"
+#include "sdf/sdf_config.h"
+#include "sdf/system_util.hh"
+
+namespace sdf
+{
+  // Inline bracket to help doxygen filtering.
+  inline namespace SDF_VERSION_NAMESPACE {
+  //
+
+  // Forward declare private data class.
+  class LoadHandlePrivate;
+  class Root;
+
+  /// \brief A load started by Root::LoadAsync, which runs on another
+  /// thread. The handle waits for the load to finish, cancels it, and
+  /// gets its errors.
+  ///
+  /// The root that is loaded must not be used or destroyed until the load
+  /// is finished, that is until Wait returns or Ready returns true. The
+  /// destructor of the handle waits for the load to finish, so that a root
+  /// that outlives its handle is never loaded concurrently with its use.
+  class SDFORMAT_VISIBLE LoadHandle
+  {
+    /// \brief Default constructor. The handle does not refer to a load.
+    public: LoadHandle();
+
+    /// \brief Move constructor.
+    /// \param[in] _handle Handle to move, which no longer refers to a load.
+    public: LoadHandle(LoadHandle &&_handle) noexcept;
+
+    /// \brief Move assignment operator. Waits for the load of this handle
+    /// to finish first, if any.
+    /// \param[in] _handle Handle to move, which no longer refers to a load.
+    /// \return Reference to this handle.
+    public: LoadHandle &operator=(LoadHandle &&_handle) noexcept;
+
+    /// \brief Copy constructor is explicitly deleted.
+    public: LoadHandle(const LoadHandle &) = delete;
+
+    /// \brief Copy assignment is explicitly deleted.
+    public: LoadHandle &operator=(const LoadHandle &) = delete;
+
+    /// \brief Destructor. Waits for the load to finish, if any.
+    public: ~LoadHandle();
+
+    /// \brief Get whether the handle refers to a load.
+    /// \return True if the handle was returned by Root::LoadAsync and was
+    /// not moved from.
+    public: bool Valid() const;
+
+    /// \brief Ask the load to stop. The elements and DOM objects that are
+    /// not read yet are skipped, and the errors of the load include an
+    /// ErrorCode::LOAD_CANCELLED error, unless it finished before. This
+    /// does not wait for the load to stop.
+    public: void Cancel();
+
+    /// \brief Get whether the load is finished.
+    /// \return True if the load is finished, false if it is running or the
+    /// handle does not refer to a load.
+    public: bool Ready() const;
+
+    /// \brief Wait for the load to finish, for at most a duration.
+    /// \param[in] _timeout The longest time to wait.
+    /// \return True if the load is finished.
+    public: bool WaitFor(std::chrono::steady_clock::duration _timeout) const;
+
+    /// \brief Wait for the load to finish, and get its errors. It may be
+    /// called several times.
+    /// \return The errors returned by Root::Load, or no errors if the
+    /// handle does not refer to a load.
+    public: Errors Wait() const;
+
+    /// \brief Constructor used by Root::LoadAsync.
+    /// \param[in] _dataPtr The state of the load, owned by the handle.
+    private: explicit LoadHandle(LoadHandlePrivate *_dataPtr);
+
+    /// \brief Root creates handles.
+    friend class Root;
+
+    /// \brief Private data pointer.
+    private: LoadHandlePrivate *dataPtr = nullptr;
+  };
+  }
+}
+#endif
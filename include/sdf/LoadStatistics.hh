@@ -0,0 +1,95 @@
+/*
+ * Copyright 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef SDF_LOADSTATISTICS_HH_
+#define SDF_LOADSTATISTICS_HH_
+
+#include <chrono>
+#include <cstddef>
+#include <ostream>
+
+#include "sdf/sdf_config.h"
+#include "sdf/system_util.hh"
+
+namespace sdf
+{
+  // Inline bracket to help doxygen filtering.
+  inline namespace SDF_VERSION_NAMESPACE {
+  //
+
+  /// \brief Counters of the work done by a load of a root, as reported by
+  /// Root::LoadStatistics, to watch the efficiency of loading without a
+  /// profiler. The work of every thread of the load is counted, including
+  /// the files it includes.
+  struct LoadStatistics
+  {
+    /// \brief Number of elements created, including the clones of element
+    /// descriptions that the elements are read into.
+    std::size_t elementsCreated = 0;
+
+    /// \brief Number of calls to Element::Clone. The elements of cloned
+    /// trees are also counted in elementsCreated.
+    std::size_t elementClones = 0;
+
+    /// \brief Number of params, which are the values and attributes of the
+    /// elements, set from strings.
+    std::size_t paramsSet = 0;
+
+    /// \brief Number of <include> elements resolved.
+    std::size_t includesResolved = 0;
+
+    /// \brief Number of the includes resolved whose file was found in the
+    /// include cache instead of being read.
+    std::size_t includeCacheHits = 0;
+
+    /// \brief Number of documents converted to the version of the
+    /// specification that they are read as.
+    std::size_t conversions = 0;
+
+    /// \brief Number of calls to sdf::findFile.
+    std::size_t findFileCalls = 0;
+
+    /// \brief Number of bytes of the files parsed, or of the string parsed
+    /// by Root::LoadSdfString.
+    std::size_t bytesRead = 0;
+
+    /// \brief Time spent reading the document into an element tree, on
+    /// the thread that called the load.
+    std::chrono::nanoseconds readTime{0};
+
+    /// \brief Time spent loading the DOM objects from the element tree, on
+    /// the thread that called the load.
+    std::chrono::nanoseconds domLoadTime{0};
+
+    /// \brief Time spent parsing XML, summed over the files and the
+    /// threads.
+    std::chrono::nanoseconds parseXmlTime{0};
+
+    /// \brief Time spent converting documents to the version they are read
+    /// as, summed over the files and the threads.
+    std::chrono::nanoseconds convertTime{0};
+  };
+
+  /// \brief Print statistics as one counter per line.
+  /// \param[in] _out Output stream.
+  /// \param[in] _statistics The statistics.
+  /// \return The output stream.
+  SDFORMAT_VISIBLE
+  std::ostream &operator<<(std::ostream &_out,
+                           const LoadStatistics &_statistics);
+  }
+}
+#endif
@@ -142,7 +142,7 @@ namespace sdf
     /// \brief Get the URI of the material script, if one has been set.
     /// \return The URI of the material script, or empty string if one has
     /// not been set.
-    public: std::string ScriptUri() const;
+    public: const std::string &ScriptUri() const;
 
     /// \brief Set the URI of the material script.
     /// \param[in] _uri The URI of the material script.
@@ -153,7 +153,7 @@ namespace sdf
     /// script element in the script located at the ScriptUri().
     /// \return The name of the material script, or empty string if one has
     /// not been set.
-    public: std::string ScriptName() const;
+    public: const std::string &ScriptName() const;
 
     /// \brief Set the name of the material script. The name should match an
     /// script element in the script located at the ScriptUri().
@@ -172,7 +172,7 @@ namespace sdf
     /// a normal map has not been set.
     /// \return Filename of the normal map, or empty string if a normal map
     /// has not been specified.
-    public: std::string NormalMap() const;
+    public: const std::string &NormalMap() const;
 
     /// \brief Set the normal map filename.
     /// \param[in] _map Filename of the normal map.
@@ -0,0 +1,85 @@
+/*
+ * Copyright 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef SDF_MEMORYFOOTPRINT_HH_
+#define SDF_MEMORYFOOTPRINT_HH_
+
+#include <cstddef>
+#include <map>
+#include <ostream>
+#include <string>
+
+#include "sdf/sdf_config.h"
+#include "sdf/system_util.hh"
+
+namespace sdf
+{
+  // Inline bracket to help doxygen filtering.
+  inline namespace SDF_VERSION_NAMESPACE {
+  //
+
+  /// \brief Approximate memory used by a group of elements, such as the
+  /// elements of a tree that have the same name.
+  struct ElementFootprint
+  {
+    /// \brief Number of elements.
+    std::size_t elementCount = 0;
+
+    /// \brief Number of params, which are the values and attributes of the
+    /// elements.
+    std::size_t paramCount = 0;
+
+    /// \brief Approximate number of bytes used by the elements and their
+    /// params, including the strings they own on the heap. Data shared
+    /// between elements, such as the schema of the element descriptions and
+    /// the interned names, is not counted.
+    std::size_t bytes = 0;
+
+    /// \brief Add the footprint of other elements to this one.
+    /// \param[in] _other The other footprint.
+    /// \return This footprint.
+    ElementFootprint &operator+=(const ElementFootprint &_other)
+    {
+      this->elementCount += _other.elementCount;
+      this->paramCount += _other.paramCount;
+      this->bytes += _other.bytes;
+      return *this;
+    }
+  };
+
+  /// \brief Approximate memory used by an element tree, as reported by
+  /// Element::MemoryFootprint and Root::MemoryFootprint.
+  struct TreeFootprint
+  {
+    /// \brief Footprint of the whole tree.
+    ElementFootprint total;
+
+    /// \brief Footprint of the elements with each name, such as "model",
+    /// "link" or "plugin".
+    std::map<std::string, ElementFootprint> byName;
+  };
+
+  /// \brief Print a footprint as one line per element name, sorted by name,
+  /// followed by the total.
+  /// \param[in] _out Output stream.
+  /// \param[in] _footprint The footprint.
+  /// \return The output stream.
+  SDFORMAT_VISIBLE
+  std::ostream &operator<<(std::ostream &_out,
+                           const TreeFootprint &_footprint);
+  }
+}
+#endif
@@ -70,7 +70,7 @@ namespace sdf
 
     /// \brief Get the mesh's URI.
     /// \return The URI of the mesh data.
-    public: std::string Uri() const;
+    public: const std::string &Uri() const;
 
     /// \brief Set the mesh's URI.
     /// \param[in] _uri The URI of the mesh.
@@ -96,7 +96,7 @@ namespace sdf
     /// optionally be specified. If specified, this submesh should be used
     /// instead of the entire mesh.
     /// \return The name of the submesh within the mesh at the specified URI.
-    public: std::string Submesh() const;
+    public: const std::string &Submesh() const;
 
     /// \brief Set the mesh's submesh. See Submesh() for more information.
     /// \param[in] _submesh Name of the submesh. The name should match a submesh
@@ -17,9 +17,13 @@
 #ifndef SDF_MODEL_HH_
 #define SDF_MODEL_HH_
 
+#include <cstddef>
 #include <memory>
 #include <string>
+#include <string_view>
+#include <vector>
 #include <ignition/math/Pose3.hh>
+#include <ignition/math/Vector3.hh>
 #include "sdf/Element.hh"
 #include "sdf/SemanticPose.hh"
 #include "sdf/Types.hh"
@@ -33,11 +37,19 @@ namespace sdf
   //
 
   // Forward declarations.
+  struct CollisionFilter;
+  struct CollisionGeometry;
   class Frame;
   class Joint;
+  struct KinematicTree;
   class Link;
   class ModelPrivate;
+  struct ModelKinematics;
+  struct ModelMassProperties;
   struct PoseRelativeToGraph;
+  struct RenderBatches;
+  struct SelfCollisionExclusions;
+  struct SurfaceMaterials;
 
   class SDFORMAT_VISIBLE Model
   {
@@ -76,7 +88,7 @@ namespace sdf
     /// \brief Get the name of the model.
     /// The name of the model should be unique within the scope of a World.
     /// \return Name of the model.
-    public: std::string Name() const;
+    public: const std::string &Name() const;
 
     /// \brief Set the name of the model.
     /// The name of the model should be unique within the scope of a World.
@@ -145,12 +157,12 @@ namespace sdf
     /// \brief Get a link based on a name.
     /// \param[in] _name Name of the link.
     /// \return Pointer to the link. Nullptr if the name does not exist.
-    public: const Link *LinkByName(const std::string &_name) const;
+    public: const Link *LinkByName(std::string_view _name) const;
 
     /// \brief Get whether a link name exists.
     /// \param[in] _name Name of the link to check.
     /// \return True if there exists a link with the given name.
-    public: bool LinkNameExists(const std::string &_name) const;
+    public: bool LinkNameExists(std::string_view _name) const;
 
     /// \brief Get the number of joints.
     /// \return Number of joints contained in this Model object.
@@ -166,14 +178,14 @@ namespace sdf
     /// \brief Get whether a joint name exists.
     /// \param[in] _name Name of the joint to check.
     /// \return True if there exists a joint with the given name.
-    public: bool JointNameExists(const std::string &_name) const;
+    public: bool JointNameExists(std::string_view _name) const;
 
     /// \brief Get a joint based on a name.
     /// \param[in] _name Name of the joint.
     /// \return Pointer to the joint. Nullptr if a joint with the given name
     ///  does not exist.
-    /// \sa bool JointNameExists(const std::string &_name) const
-    public: const Joint *JointByName(const std::string &_name) const;
+    /// \sa bool JointNameExists(std::string_view _name) const
+    public: const Joint *JointByName(std::string_view _name) const;
 
     /// \brief Get the number of explicit frames.
     /// \return Number of explicit frames contained in this Model object.
@@ -191,12 +203,40 @@ namespace sdf
     /// \param[in] _name Name of the explicit frame.
     /// \return Pointer to the explicit frame. Nullptr if the name does not
     /// exist.
-    public: const Frame *FrameByName(const std::string &_name) const;
+    public: const Frame *FrameByName(std::string_view _name) const;
 
     /// \brief Get whether an explicit frame name exists.
     /// \param[in] _name Name of the explicit frame to check.
     /// \return True if there exists an explicit frame with the given name.
-    public: bool FrameNameExists(const std::string &_name) const;
+    public: bool FrameNameExists(std::string_view _name) const;
+
+    /// \brief Add a link to a model that is built programmatically. The
+    /// name index and the frame graphs are updated in place instead of
+    /// being rebuilt, so building a model of N links costs O(N). The frames
+    /// that the pose of the link is relative to must already be in the
+    /// model. The graphs are created by the first addition to a model that
+    /// was not loaded.
+    /// \param[in] _link The link, which is moved into the model only if
+    /// there are no errors.
+    /// \return Errors, which include a DUPLICATE_NAME error if the name of
+    /// the link is already used by a link, joint or frame of the model.
+    public: Errors AddLink(Link &&_link);
+
+    /// \brief Add a joint to a model that is built programmatically, in the
+    /// same way as AddLink. The child link of the joint must already be in
+    /// the model.
+    /// \param[in] _joint The joint, which is moved into the model only if
+    /// there are no errors.
+    /// \return Errors.
+    public: Errors AddJoint(Joint &&_joint);
+
+    /// \brief Add an explicit frame to a model that is built
+    /// programmatically, in the same way as AddLink. The frame that it is
+    /// attached to must already be in the model.
+    /// \param[in] _frame The frame, which is moved into the model only if
+    /// there are no errors.
+    /// \return Errors.
+    public: Errors AddFrame(Frame &&_frame);
 
     /// \brief Get the pose of the model. This is the pose of the model
     /// as specified in SDF (<model> <pose> ... </pose></model>), and is
@@ -279,6 +319,125 @@ namespace sdf
     /// \return SemanticPose object for this link.
     public: sdf::SemanticPose SemanticPose() const;
 
+    /// \brief Resolve the poses of all the frames of this model relative to
+    /// one frame of this model, in a single pass over the pose graph. This
+    /// gives the same poses as resolving the SemanticPose of each link,
+    /// joint and frame to _relativeTo, without walking the graph once for
+    /// each of them.
+    /// \param[out] _poses Resolved poses. The first pose is that of the
+    /// implicit model frame, followed by the links in LinkByIndex order, the
+    /// joints in JointByIndex order and the frames in FrameByIndex order. It
+    /// is not changed if there are errors.
+    /// \param[in] _relativeTo Name of the frame relative to which the poses
+    /// are resolved. The implicit model frame is used if it is empty.
+    /// \return Errors.
+    public: Errors ResolveFramePoses(
+        std::vector<ignition::math::Pose3d> &_poses,
+        const std::string &_relativeTo = "") const;
+
+    /// \brief Resolve the xyz unit vectors of the axes of all the joints of
+    /// this model in the coordinates of one frame, in a single pass over the
+    /// pose graph. This gives the same vectors as JointAxis::ResolveXyz,
+    /// without walking the graph once for each axis.
+    /// \param[out] _axes Resolved vectors, two per joint in JointByIndex
+    /// order, so that axis i of joint j is _axes[2 * j + i]. The vector of
+    /// an axis that the joint does not have is zero. It is not changed if
+    /// there are errors.
+    /// \param[in] _resolveTo Name of the frame in whose coordinates the
+    /// vectors are resolved. The implicit model frame is used if it is
+    /// empty.
+    /// \return Errors.
+    public: Errors ResolveJointAxes(
+        std::vector<ignition::math::Vector3d> &_axes,
+        const std::string &_resolveTo = "") const;
+
+    /// \brief Get the tree formed by the links and joints of this model, as
+    /// described in KinematicTree. It is built when the model is loaded and
+    /// rebuilt by AddLink and AddJoint, so that controllers, solvers and
+    /// physics engines can share it instead of looking up the parent and
+    /// child links of every joint by name.
+    /// \return The tree.
+    public: const sdf::KinematicTree &KinematicTree() const;
+
+    /// \brief Get the pairs of links of this model that are not checked for
+    /// collision with each other, as described in SelfCollisionExclusions:
+    /// the links attached by a joint, and optionally the links a few joints
+    /// apart. The exclusions are shared with the models that have the same
+    /// links, joints and self collision flag, so that they are computed once
+    /// for all the copies of a robot.
+    /// \param[in] _hops Largest number of joints between two links of an
+    /// excluded pair. 0 excludes no pair.
+    /// \return The exclusions.
+    public: std::shared_ptr<const sdf::SelfCollisionExclusions>
+        SelfCollisionExclusions(const uint64_t _hops = 1) const;
+
+    /// \brief Export the links and joints of this model as contiguous
+    /// arrays, with links in topological order, as described in
+    /// ModelKinematics. The poses are resolved in a single pass over the pose
+    /// graph, as in ResolveFramePoses.
+    /// \param[out] _kinematics The arrays. They are not changed if there
+    /// are errors.
+    /// \return Errors.
+    public: Errors ResolveKinematics(ModelKinematics &_kinematics) const;
+
+    /// \brief Compute the mass, center of mass and inertia of this model and
+    /// of each subtree of its kinematic tree, as described in
+    /// ModelMassProperties, in a single pass over the links with poses
+    /// resolved as in ResolveFramePoses. The result only depends on the
+    /// links, joints and poses of the model, so it may be kept and shared by
+    /// the copies of a model until they change.
+    /// \param[out] _properties The mass properties. They are not changed if
+    /// there are errors.
+    /// \return Errors.
+    public: Errors ResolveMassProperties(
+        ModelMassProperties &_properties) const;
+
+    /// \brief Export the collisions of all the links of this model as
+    /// contiguous arrays, as in Link::ResolveCollisionGeometry, in
+    /// LinkByIndex order and then in CollisionByIndex order.
+    /// \param[out] _geometry The arrays. They are not changed if there are
+    /// errors.
+    /// \return Errors.
+    public: Errors ResolveCollisionGeometry(
+        CollisionGeometry &_geometry) const;
+
+    /// \brief Group the collisions of all the links of this model by their
+    /// category and collide bitmasks, and compute which groups collide, as
+    /// described in CollisionFilter. The collisions are in LinkByIndex order
+    /// and then in CollisionByIndex order.
+    /// \param[out] _filter The filter.
+    public: void ResolveCollisionFilter(CollisionFilter &_filter) const;
+
+    /// \brief Collect the distinct surface parameters of the collisions of
+    /// all the links of this model, as described in SurfaceMaterials. The
+    /// collisions are in LinkByIndex order and then in CollisionByIndex
+    /// order.
+    /// \param[out] _materials The materials.
+    public: void ResolveSurfaceMaterials(SurfaceMaterials &_materials) const;
+
+    /// \brief Group the visuals of all the links of this model into
+    /// instancing batches, as described in RenderBatches, with their poses
+    /// in the model frame resolved as in ResolveFramePoses. The visuals of
+    /// each batch are in LinkByIndex order and then in VisualByIndex order.
+    /// \param[out] _batches The batches. They are not changed if there are
+    /// errors.
+    /// \return Errors.
+    public: Errors ResolveRenderBatches(RenderBatches &_batches) const;
+
+    /// \brief Set the raw pose and relative_to frame of a link, joint or
+    /// frame of this model, and update the pose graph of the model in place
+    /// instead of rebuilding it. The change is checked for graph cycles and
+    /// only the poses that depend on it are recomputed, so the SemanticPose
+    /// of every object of the model reflects it.
+    /// \param[in] _name Name of the link, joint or frame.
+    /// \param[in] _pose New raw pose.
+    /// \param[in] _relativeTo New relative_to frame. If it is empty, the
+    /// default frame of the object is used, as when loading.
+    /// \return Errors. Nothing is changed if there are errors.
+    public: Errors UpdateFramePose(const std::string &_name,
+        const ignition::math::Pose3d &_pose,
+        const std::string &_relativeTo = "");
+
     /// \brief Give a weak pointer to the PoseRelativeToGraph to be used
     /// for resolving poses. This is private and is intended to be called by
     /// World::Load.
@@ -286,9 +445,21 @@ namespace sdf
     private: void SetPoseRelativeToGraph(
         std::weak_ptr<const PoseRelativeToGraph> _graph);
 
+    /// \brief Give the graphs of the model to its links, joints and frames.
+    private: void SetChildGraphs();
+
+    /// \brief Release the capacity that the vectors of this model and of
+    /// its links keep for growth. This is private and is intended to be
+    /// called by World::Compact and Root::Compact.
+    /// \return Number of bytes released.
+    private: std::size_t Compact();
+
     /// \brief Allow World::Load to call SetPoseRelativeToGraph.
     friend class World;
 
+    /// \brief Allow Root::Compact to call Compact.
+    friend class Root;
+
     /// \brief Private data pointer.
     private: ModelPrivate *dataPtr = nullptr;
   };
@@ -0,0 +1,125 @@
+/*
+ * Copyright 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef SDF_MODELINDEX_HH_
+#define SDF_MODELINDEX_HH_
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "sdf/sdf_config.h"
+#include "sdf/system_util.hh"
+
+namespace sdf
+{
+  // Inline bracket to help doxygen filtering.
+  inline namespace SDF_VERSION_NAMESPACE {
+  //
+
+  // Forward declare private data class.
+  class ModelIndexPrivate;
+
+  /// \brief Index of the models of model repositories, so that
+  /// `model://name` URIs are resolved without searching the repositories.
+  ///
+  /// A repository is a root directory whose subdirectories with a
+  /// model.config, or a deprecated manifest.xml, are models named after the
+  /// subdirectory. Scanning the roots records the directory of each model
+  /// and the model file chosen from its config, like getModelFilePath.
+  /// When several roots have a model with the same name, the first root
+  /// wins, like the search order of findFile.
+  ///
+  /// An index can be saved to a file and loaded again by later processes.
+  /// Loading revalidates the index by modification times: the roots whose
+  /// directory changed are scanned again, and the models whose directory
+  /// or config changed are read again, so that only a few directories are
+  /// queried instead of every root being listed.
+  ///
+  /// Once set with setModelIndex, findFile resolves `model://name` URIs of
+  /// indexed models, and getModelFilePath the model files of indexed
+  /// directories, from the index. Other files are searched as usual.
+  ///
+  /// All functions are safe to call from several threads at once.
+  class SDFORMAT_VISIBLE ModelIndex
+  {
+    /// \brief Default constructor, for an empty index.
+    public: ModelIndex();
+
+    /// \brief Copy constructor is explicitly deleted.
+    public: ModelIndex(const ModelIndex &_index) = delete;
+
+    /// \brief Assignment operator is explicitly deleted.
+    public: ModelIndex &operator=(const ModelIndex &_index) = delete;
+
+    /// \brief Destructor
+    public: ~ModelIndex();
+
+    /// \brief Replace the index with the models of model repositories.
+    /// \param[in] _roots Root directories of the repositories, in the
+    /// order of precedence. Roots that are not directories are skipped.
+    /// \param[in] _threadCount Maximum number of threads that scan the
+    /// roots and read the configs of the models, or 0 for one per hardware
+    /// thread.
+    public: void Scan(const std::vector<std::string> &_roots,
+                      unsigned int _threadCount = 1);
+
+    /// \brief Replace the index with one saved by Save, revalidated as
+    /// described above.
+    /// \param[in] _filename Path of the index file.
+    /// \param[in] _threadCount Maximum number of threads that scan the
+    /// changed roots and read the changed configs, or 0 for one per
+    /// hardware thread.
+    /// \return False if the file could not be read or is not an index, in
+    /// which case the index is unchanged.
+    public: bool Load(const std::string &_filename,
+                      unsigned int _threadCount = 1);
+
+    /// \brief Save the index to a file. The file is written next to its
+    /// path and then renamed, so that concurrent readers never see a
+    /// partial index.
+    /// \param[in] _filename Path of the index file.
+    /// \return False if the file could not be written.
+    public: bool Save(const std::string &_filename) const;
+
+    /// \brief Get the directory of a model.
+    /// \param[in] _name Name of the model, as in `model://name`.
+    /// \return Path of the directory, or an empty string if the model is
+    /// not indexed.
+    public: std::string FindModelDirectory(const std::string &_name) const;
+
+    /// \brief Get the model file chosen for a model directory.
+    /// \param[in] _modelDirPath Path of the model directory, as returned by
+    /// FindModelDirectory.
+    /// \return Path of the model file, or an empty string if the directory
+    /// is not indexed.
+    public: std::string FindModelFile(const std::string &_modelDirPath) const;
+
+    /// \brief Get the root directories of the index.
+    /// \return The roots, in the order of precedence.
+    public: std::vector<std::string> Roots() const;
+
+    /// \brief Get the number of indexed models.
+    /// \return Number of models, including those hidden by a model with
+    /// the same name in an earlier root.
+    public: std::size_t Size() const;
+
+    /// \brief Private data pointer.
+    private: ModelIndexPrivate *dataPtr = nullptr;
+  };
+  }
+}
+#endif
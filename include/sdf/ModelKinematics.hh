@@ -0,0 +1,105 @@
+/*
+ * Copyright 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef SDF_MODELKINEMATICS_HH_
+#define SDF_MODELKINEMATICS_HH_
+
+#include <cstdint>
+#include <vector>
+#include <ignition/math/Matrix3.hh>
+#include <ignition/math/Pose3.hh>
+#include <ignition/math/Vector3.hh>
+
+#include "sdf/Joint.hh"
+#include "sdf/sdf_config.h"
+
+namespace sdf
+{
+  // Inline bracket to help doxygen filtering.
+  inline namespace SDF_VERSION_NAMESPACE {
+  //
+
+  /// \brief The links and joints of a model stored as contiguous arrays, one
+  /// array per property, for physics engines that consume a whole model at
+  /// once. It is filled by Model::ResolveKinematics.
+  ///
+  /// The link arrays are in topological order: every link comes after the
+  /// link it is attached to by its parent joint, unless the joints form a
+  /// loop. The joint arrays are in the order of their child link, followed
+  /// by the joints that close loops. Links and joints are referred to by
+  /// their position in these arrays, and -1 refers to the world or to no
+  /// object.
+  struct ModelKinematics
+  {
+    /// \brief Index of each link in Model::LinkByIndex.
+    std::vector<uint64_t> linkIndices;
+
+    /// \brief Position of the parent link of each link, or -1 for a link
+    /// that is not the child of a joint or whose parent is the world.
+    std::vector<int64_t> linkParents;
+
+    /// \brief Position of the joint of which each link is the child, or -1.
+    std::vector<int64_t> linkJoints;
+
+    /// \brief Pose of each link relative to the model frame.
+    std::vector<ignition::math::Pose3d> linkPoses;
+
+    /// \brief Mass of each link.
+    std::vector<double> masses;
+
+    /// \brief Moment of inertia matrix of each link, about its center of
+    /// mass and in the coordinates of its inertial frame.
+    std::vector<ignition::math::Matrix3d> inertias;
+
+    /// \brief Pose of the inertial frame of each link relative to the link.
+    std::vector<ignition::math::Pose3d> inertialPoses;
+
+    /// \brief Index of each joint in Model::JointByIndex.
+    std::vector<uint64_t> jointIndices;
+
+    /// \brief Type of each joint.
+    std::vector<JointType> jointTypes;
+
+    /// \brief Position of the parent link of each joint, or -1 for the
+    /// world.
+    std::vector<int64_t> jointParents;
+
+    /// \brief Position of the child link of each joint.
+    std::vector<int64_t> jointChildren;
+
+    /// \brief Pose of each joint relative to the model frame.
+    std::vector<ignition::math::Pose3d> jointPoses;
+
+    /// \brief Unit vector of the first axis of each joint, in the
+    /// coordinates of the joint frame. It is zero for a joint without axis.
+    std::vector<ignition::math::Vector3d> axes;
+
+    /// \brief Lower limit of the first axis of each joint. The limits of a
+    /// joint without axis are those of a default JointAxis.
+    std::vector<double> lowerLimits;
+
+    /// \brief Upper limit of the first axis of each joint.
+    std::vector<double> upperLimits;
+
+    /// \brief Effort limit of the first axis of each joint.
+    std::vector<double> effortLimits;
+
+    /// \brief Velocity limit of the first axis of each joint.
+    std::vector<double> velocityLimits;
+  };
+  }
+}
+#endif
@@ -0,0 +1,64 @@
+/*
+ * Copyright 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef SDF_MODELMASSPROPERTIES_HH_
+#define SDF_MODELMASSPROPERTIES_HH_
+
+#include <vector>
+#include <ignition/math/Matrix3.hh>
+#include <ignition/math/Vector3.hh>
+
+#include "sdf/sdf_config.h"
+
+namespace sdf
+{
+  // Inline bracket to help doxygen filtering.
+  inline namespace SDF_VERSION_NAMESPACE {
+  //
+
+  /// \brief The mass, center of mass and inertia of a model as a whole
+  /// and of each subtree of its kinematic tree, in the model frame. It is
+  /// filled by Model::ResolveMassProperties.
+  ///
+  /// The subtree of a link is the link and the links that descend from it
+  /// through parent joints, as described in KinematicTree. The subtree of a
+  /// link on a loop of parent joints is the link alone.
+  struct ModelMassProperties
+  {
+    /// \brief Total mass of the links.
+    double mass = 0.0;
+
+    /// \brief Center of mass of the links. It is zero if the mass is zero.
+    ignition::math::Vector3d centerOfMass = ignition::math::Vector3d::Zero;
+
+    /// \brief Moment of inertia matrix of the links about their center of
+    /// mass, in the coordinates of the model frame.
+    ignition::math::Matrix3d inertia = ignition::math::Matrix3d::Zero;
+
+    /// \brief Mass of the subtree of each link, in Model::LinkByIndex
+    /// order.
+    std::vector<double> subtreeMasses;
+
+    /// \brief Center of mass of the subtree of each link.
+    std::vector<ignition::math::Vector3d> subtreeCentersOfMass;
+
+    /// \brief Moment of inertia matrix of the subtree of each link about
+    /// its center of mass, in the coordinates of the model frame.
+    std::vector<ignition::math::Matrix3d> subtreeInertias;
+  };
+  }
+}
+#endif
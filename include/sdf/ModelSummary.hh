@@ -0,0 +1,79 @@
+/*
+ * Copyright 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef SDF_MODELSUMMARY_HH_
+#define SDF_MODELSUMMARY_HH_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "sdf/Error.hh"
+#include "sdf/Types.hh"
+#include "sdf/sdf_config.h"
+#include "sdf/system_util.hh"
+
+namespace sdf
+{
+  // Inline bracket to help doxygen filtering.
+  inline namespace SDF_VERSION_NAMESPACE {
+  //
+
+  /// \brief Metadata of a model, read by peekModel without loading the
+  /// model.
+  struct ModelSummary
+  {
+    /// \brief Path of the SDF file of the model.
+    std::string filePath;
+
+    /// \brief Name of the model, from the name attribute of its <model>
+    /// element.
+    std::string name;
+
+    /// \brief Version of the file, from the version attribute of its <sdf>
+    /// element. The file is not converted to the latest version.
+    std::string sdfVersion;
+
+    /// \brief Number of links of the model and of its nested models.
+    uint64_t linkCount = 0;
+
+    /// \brief Number of joints of the model and of its nested models.
+    uint64_t jointCount = 0;
+
+    /// \brief Number of sensors of the links and joints counted in
+    /// linkCount and jointCount.
+    uint64_t sensorCount = 0;
+
+    /// \brief URIs of the <include> elements of the model and of its
+    /// nested models, in document order and without duplicates. They are
+    /// not resolved, and the included models are not read.
+    std::vector<std::string> includes;
+  };
+
+  /// \brief Read the metadata of a model, much faster than Root::Load, for
+  /// listing large model libraries. Only the XML of the model file is
+  /// parsed: the file is neither converted nor validated, no Element tree
+  /// or DOM object is created, and included models are not read.
+  /// \param[in] _path Path of a model directory, whose model.config selects
+  /// the model file like getModelFilePath, or of a model file.
+  /// \param[out] _summary The metadata of the first <model> of the file.
+  /// \return Errors, which is a vector of Error objects. Each Error includes
+  /// an error code and message. An empty vector indicates no error.
+  SDFORMAT_VISIBLE
+  Errors peekModel(const std::string &_path, ModelSummary &_summary);
+  }
+}
+#endif
@@ -0,0 +1,117 @@
+/*
+ * Copyright 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef SDF_NOISESAMPLER_HH_
+#define SDF_NOISESAMPLER_HH_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "sdf/Noise.hh"
+#include "sdf/sdf_config.h"
+#include "sdf/system_util.hh"
+
+namespace sdf
+{
+  // Inline bracket to help doxygen filtering.
+  inline namespace SDF_VERSION_NAMESPACE {
+  //
+
+  /// \brief Adds the noise described by a Noise to whole buffers of
+  /// measurements, such as image rows, lidar ranges or batches of IMU
+  /// readings.
+  ///
+  /// The random numbers come from a counter-based generator: the noise of a
+  /// measurement is a function of the seed, a stream and the position of
+  /// the measurement in the stream only. Results are thus the same however
+  /// a buffer is split among threads or calls, and no state is updated, so
+  /// a sampler may be shared by threads. The buffers are processed in
+  /// blocks with loops that the compiler vectorizes.
+  ///
+  /// A stream is typically a sensor, or a channel of a sensor. Its bias is
+  /// drawn once from the bias mean and standard deviation, with a random
+  /// sign. The dynamic bias of Noise is a random process with state, which
+  /// is left to the sensors.
+  class SDFORMAT_VISIBLE NoiseSampler
+  {
+    /// \brief Constructor.
+    /// \param[in] _noise The noise.
+    /// \param[in] _seed Seed of the random numbers.
+    public: explicit NoiseSampler(const Noise &_noise, uint64_t _seed = 0);
+
+    /// \brief Get the bias of a stream.
+    /// \param[in] _stream The stream.
+    /// \return The bias, or 0 for NoiseType::NONE.
+    public: double Bias(uint64_t _stream) const;
+
+    /// \brief Get the noise of one measurement, without quantization.
+    /// \param[in] _stream The stream.
+    /// \param[in] _counter Position of the measurement in the stream.
+    /// \return The noise, including the bias of the stream.
+    public: double Sample(uint64_t _stream, uint64_t _counter) const;
+
+    /// \brief Add noise to measurements, and round them to the precision of
+    /// the noise for NoiseType::GAUSSIAN_QUANTIZED.
+    /// \param[in,out] _values The measurements.
+    /// \param[in] _count Number of measurements.
+    /// \param[in] _stream The stream.
+    /// \param[in] _counter Position of the first measurement in the stream.
+    public: void Apply(double *_values, std::size_t _count,
+                       uint64_t _stream, uint64_t _counter) const;
+
+    /// \brief Add noise to single precision measurements, as the double
+    /// precision Apply.
+    /// \param[in,out] _values The measurements.
+    /// \param[in] _count Number of measurements.
+    /// \param[in] _stream The stream.
+    /// \param[in] _counter Position of the first measurement in the stream.
+    public: void Apply(float *_values, std::size_t _count,
+                       uint64_t _stream, uint64_t _counter) const;
+
+    /// \brief Fill a buffer with standard normal numbers, as used for the
+    /// noise.
+    /// \param[out] _values The numbers.
+    /// \param[in] _count Number of numbers.
+    /// \param[in] _stream The stream.
+    /// \param[in] _counter Position of the first number in the stream.
+    public: void FillStandardNormal(double *_values, std::size_t _count,
+                                    uint64_t _stream,
+                                    uint64_t _counter) const;
+
+    /// \brief The noise type.
+    private: NoiseType type = NoiseType::NONE;
+
+    /// \brief Gaussian mean.
+    private: double mean = 0.0;
+
+    /// \brief Gaussian standard deviation.
+    private: double stdDev = 0.0;
+
+    /// \brief Mean of the bias.
+    private: double biasMean = 0.0;
+
+    /// \brief Standard deviation of the bias.
+    private: double biasStdDev = 0.0;
+
+    /// \brief Precision of quantization, or 0.
+    private: double precision = 0.0;
+
+    /// \brief Seed of the random numbers.
+    private: uint64_t seed = 0;
+  };
+  }
+}
+#endif
@@ -21,11 +21,14 @@
 #include <any>
 #include <algorithm>
 #include <cctype>
+#include <cstddef>
 #include <cstdint>
 #include <functional>
+#include <limits>
 #include <memory>
 #include <sstream>
 #include <string>
+#include <type_traits>
 #include <typeinfo>
 #include <variant>
 #include <vector>
@@ -33,6 +36,7 @@
 #include <ignition/math.hh>
 
 #include "sdf/Console.hh"
+#include "sdf/InternedString.hh"
 #include "sdf/sdf_config.h"
 #include "sdf/system_util.hh"
 #include "sdf/Types.hh"
@@ -61,7 +65,7 @@ namespace sdf
   typedef std::vector<ParamPtr> Param_V;
 
   /// \internal
-  class ParamPrivate;
+  class SDFORMAT_VISIBLE ParamPrivate;
 
   template<class T>
   struct ParamStreamer
@@ -71,6 +75,17 @@ namespace sdf
 
   template<class T> ParamStreamer(T) -> ParamStreamer<T>;
 
+  /// \internal
+  /// \brief Check whether T is one of the alternatives of a std::variant.
+  template<class T, class Variant>
+  struct IsVariantAlternative;
+
+  template<class T, class... Ts>
+  struct IsVariantAlternative<T, std::variant<Ts...>>
+    : std::disjunction<std::is_same<T, Ts>...>
+  {
+  };
+
   template<class T>
   std::ostream& operator<<(std::ostream &os, ParamStreamer<T> s)
   {
@@ -108,10 +123,27 @@ namespace sdf
     /// \brief Destructor
     public: virtual ~Param();
 
+    /// \brief Allocate memory for a parameter. While a document is read
+    /// with ParserConfig::SetArenaAllocation enabled, parameters are
+    /// allocated from an arena that is shared by the whole element tree.
+    /// \param[in] _size Size of the parameter.
+    /// \return Memory for the parameter.
+    public: static void *operator new(std::size_t _size);
+
+    /// \brief Free memory allocated by operator new.
+    /// \param[in] _ptr Memory of the parameter.
+    public: static void operator delete(void *_ptr);
+
     /// \brief Get the value as a string.
     /// \return String containing the value of the parameter.
     public: std::string GetAsString() const;
 
+    /// \brief Append the value, formatted as by GetAsString, to a string.
+    /// Numbers are formatted without a stream, so this is faster than
+    /// GetAsString when writing many values to one buffer.
+    /// \param[in,out] _out String to append the value to.
+    public: void AppendAsString(std::string &_out) const;
+
     /// \brief Get the default value as a string.
     /// \return String containing the default value of the parameter.
     public: std::string GetDefaultAsString() const;
@@ -120,6 +152,14 @@ namespace sdf
     /// \param[in] _value New value for the parameter in string form.
     public: bool SetFromString(const std::string &_value);
 
+    /// \brief Set the parameter value from a string, which the parameter
+    /// takes ownership of. The value of a string parameter is moved instead
+    /// of copied, so that large values, such as inline data, are not copied
+    /// again.
+    /// \param[in] _value New value for the parameter in string form.
+    /// \return True if the value was set.
+    public: bool SetFromString(std::string &&_value);
+
     /// \brief Reset the parameter to the default value.
     public: void Reset();
 
@@ -151,10 +191,18 @@ namespace sdf
 
     /// \brief Set the update function. The updateFunc will be used to
     /// set the parameter's value when Param::Update is called.
+    /// A function that returns the type of the parameter, or a number, is
+    /// called through a typed invoker that assigns its result directly.
+    /// Other functions must return a std::any that holds the type of the
+    /// parameter.
     /// \param[in] _updateFunc Function pointer to an update function.
     public: template<typename T>
             void SetUpdateFunc(T _updateFunc);
 
+    /// \brief Get whether an update function is set.
+    /// \return True if SetUpdateFunc was called with a function.
+    public: bool HasUpdateFunc() const;
+
     /// \brief Set the parameter's value using the updateFunc.
     /// \sa Param::SetUpdateFunc
     public: void Update();
@@ -200,6 +248,13 @@ namespace sdf
     /// \return The description of the parameter.
     public: std::string GetDescription() const;
 
+    /// \brief Get the approximate number of bytes used by the parameter,
+    /// including the strings it owns on the heap. The key, type name,
+    /// description and default value are shared with the clones of the
+    /// parameter, so they are not counted.
+    /// \return Number of bytes.
+    public: std::size_t MemoryFootprint() const;
+
     /// \brief Ostream operator. Outputs the parameter's value.
     /// \param[in] _out Output stream.
     /// \param[in] _p The parameter to output.
@@ -211,32 +266,39 @@ namespace sdf
       return _out;
     }
 
+    /// \brief Constructor of an empty parameter, used by Clone to copy the
+    /// private data of another parameter.
+    private: Param();
+
     /// \brief Private method to set the Element from a passed-in string.
     /// \param[in] _value Value to set the parameter to.
     private: bool ValueFromString(const std::string &_value);
 
+    /// \brief Notify the element trees that the update function of this
+    /// parameter changed, so that Element::Update collects it.
+    private: void UpdateFuncChanged();
+
     /// \brief Private data
     private: std::unique_ptr<ParamPrivate> dataPtr;
   };
 
   /// \internal
   /// \brief Private data for the param class
-  class ParamPrivate
+  class SDFORMAT_VISIBLE ParamPrivate
   {
-    /// \brief Key value
-    public: std::string key;
+    /// \brief Allocate memory for the private data, from the same arena as
+    /// its parameter.
+    /// \param[in] _size Size of the private data.
+    /// \return Memory for the private data.
+    /// \sa Param::operator new
+    public: static void *operator new(std::size_t _size);
 
-    /// \brief True if the parameter is required.
-    public: bool required;
+    /// \brief Free memory allocated by operator new.
+    /// \param[in] _ptr Memory of the private data.
+    public: static void operator delete(void *_ptr);
 
     /// \brief True if the parameter is set.
-    public: bool set;
-
-    //// \brief Name of the type.
-    public: std::string typeName;
-
-    /// \brief Description of the parameter.
-    public: std::string description;
+    public: bool set = false;
 
     /// \brief Update function pointer.
     public: std::function<std::any ()> updateFunc;
@@ -253,24 +315,183 @@ namespace sdf
                                    ignition::math::Quaterniond,
                                    ignition::math::Pose3d> ParamVariant;
 
+    /// \brief The parts of a parameter that come from its description and
+    /// never change per instance. They are shared by a parameter and its
+    /// clones, and replaced rather than modified.
+    public: struct Schema
+    {
+      /// \brief Key value
+      InternedString key;
+
+      //// \brief Name of the type.
+      InternedString typeName;
+
+      /// \brief Description of the parameter.
+      InternedString description;
+
+      /// \brief This parameter's default value
+      ParamVariant defaultValue;
+
+      /// \brief True if the parameter is required.
+      bool required = false;
+    };
+
     /// \brief This parameter's value
     public: ParamVariant value;
 
-    /// \brief This parameter's default value
-    public: ParamVariant defaultValue;
+    /// \brief The shared schema of this parameter.
+    public: std::shared_ptr<const Schema> schema;
+
+    /// \brief Update function that assigns its result to the value
+    /// directly, set instead of updateFunc for functions that do not return
+    /// a std::any. It returns false if the result does not fit the type of
+    /// the parameter.
+    public: std::function<bool (ParamVariant &)> typedUpdateFunc;
+
+    /// \brief Convert between two numeric types that can be stored in a
+    /// ParamVariant, without formatting and parsing a string.
+    /// \param[in] _from Value to convert.
+    /// \param[out] _to Converted value.
+    /// \return True if both types are integral or floating point types,
+    /// other than bool and char, and _from is within the range of T.
+    /// False if the conversion has to go through a string.
+    public: template<typename T, typename U>
+            static bool NumericCast(const U &_from, T &_to);
   };
 
+  ///////////////////////////////////////////////
+  template<typename T, typename U>
+  bool ParamPrivate::NumericCast(const U &_from, T &_to)
+  {
+    if constexpr (!std::is_arithmetic_v<T> || !std::is_arithmetic_v<U> ||
+        std::is_same_v<T, bool> || std::is_same_v<U, bool> ||
+        std::is_same_v<T, char> || std::is_same_v<U, char>)
+    {
+      return false;
+    }
+    else if constexpr (std::is_floating_point_v<T>)
+    {
+      if constexpr (std::is_floating_point_v<U> && sizeof(U) > sizeof(T))
+      {
+        if (_from < std::numeric_limits<T>::lowest() ||
+            _from > std::numeric_limits<T>::max())
+        {
+          return false;
+        }
+      }
+      _to = static_cast<T>(_from);
+      return true;
+    }
+    else if constexpr (std::is_floating_point_v<U>)
+    {
+      // Fails for NaN as well.
+      if (!(_from >= static_cast<U>(std::numeric_limits<T>::lowest()) &&
+            _from < static_cast<U>(std::numeric_limits<T>::max())))
+      {
+        return false;
+      }
+      _to = static_cast<T>(_from);
+      return true;
+    }
+    else
+    {
+      if constexpr (std::is_signed_v<U>)
+      {
+        if constexpr (std::is_unsigned_v<T>)
+        {
+          if (_from < 0 || static_cast<std::make_unsigned_t<U>>(_from) >
+              std::numeric_limits<T>::max())
+          {
+            return false;
+          }
+        }
+        else if (_from < std::numeric_limits<T>::lowest() ||
+                 _from > std::numeric_limits<T>::max())
+        {
+          return false;
+        }
+      }
+      else if (_from > static_cast<std::make_unsigned_t<T>>(
+                 std::numeric_limits<T>::max()))
+      {
+        return false;
+      }
+      _to = static_cast<T>(_from);
+      return true;
+    }
+  }
+
   ///////////////////////////////////////////////
   template<typename T>
   void Param::SetUpdateFunc(T _updateFunc)
   {
-    this->dataPtr->updateFunc = _updateFunc;
+    using Result = std::decay_t<std::invoke_result_t<T &>>;
+    if constexpr (
+        IsVariantAlternative<Result, ParamPrivate::ParamVariant>::value ||
+        std::is_arithmetic_v<Result>)
+    {
+      // Skip boxing the result in a std::any.
+      this->dataPtr->updateFunc = nullptr;
+      this->dataPtr->typedUpdateFunc =
+          [_updateFunc](ParamPrivate::ParamVariant &_value) mutable
+          {
+            Result result = _updateFunc();
+            if constexpr (
+                IsVariantAlternative<Result, ParamPrivate::ParamVariant>::value)
+            {
+              Result *held = std::get_if<Result>(&_value);
+              if (held)
+              {
+                *held = std::move(result);
+                return true;
+              }
+            }
+            return std::visit([&result](auto &_held)
+                {
+                  return ParamPrivate::NumericCast(result, _held);
+                }, _value);
+          };
+    }
+    else
+    {
+      this->dataPtr->typedUpdateFunc = nullptr;
+      this->dataPtr->updateFunc = _updateFunc;
+    }
+    this->UpdateFuncChanged();
   }
 
   ///////////////////////////////////////////////
   template<typename T>
   bool Param::Set(const T &_value)
   {
+    // Assign values of the stored type, and numeric values that can be
+    // converted to it, directly. Strings are still set through
+    // SetFromString, which trims them and handles empty strings.
+    if constexpr (!std::is_same_v<T, std::string> &&
+        IsVariantAlternative<T, ParamPrivate::ParamVariant>::value)
+    {
+      T *value = std::get_if<T>(&this->dataPtr->value);
+      if (value)
+      {
+        *value = _value;
+        this->dataPtr->set = true;
+        return true;
+      }
+    }
+
+    if constexpr (std::is_arithmetic_v<T>)
+    {
+      const bool converted = std::visit([&_value](auto &_held)
+          {
+            return ParamPrivate::NumericCast(_value, _held);
+          }, this->dataPtr->value);
+      if (converted)
+      {
+        this->dataPtr->set = true;
+        return true;
+      }
+    }
+
     try
     {
       std::stringstream ss;
@@ -280,7 +501,7 @@ namespace sdf
     catch(...)
     {
       sdferr << "Unable to set parameter["
-             << this->dataPtr->key << "]."
+             << this->dataPtr->schema->key << "]."
              << "Type used must have a stream input and output operator,"
              << "which allows proper functioning of Param.\n";
       return false;
@@ -293,7 +514,8 @@ namespace sdf
   {
     try
     {
-      if (typeid(T) == typeid(bool) && this->dataPtr->typeName == "string")
+      if (typeid(T) == typeid(bool) &&
+          this->dataPtr->schema->typeName == "string")
       {
         std::string strValue = std::get<std::string>(this->dataPtr->value);
         std::transform(strValue.begin(), strValue.end(), strValue.begin(),
@@ -315,10 +537,19 @@ namespace sdf
       }
       else
       {
-        T *value = std::get_if<T>(&this->dataPtr->value);
+        const T *value = nullptr;
+        if constexpr (
+            IsVariantAlternative<T, ParamPrivate::ParamVariant>::value)
+        {
+          value = std::get_if<T>(&this->dataPtr->value);
+        }
+
         if (value)
           _value = *value;
-        else
+        else if (!std::visit([&_value](const auto &_held)
+              {
+                return ParamPrivate::NumericCast(_held, _value);
+              }, this->dataPtr->value))
         {
           std::stringstream ss;
           ss << ParamStreamer{this->dataPtr->value};
@@ -329,9 +560,9 @@ namespace sdf
     catch(...)
     {
       sdferr << "Unable to convert parameter["
-             << this->dataPtr->key << "] "
+             << this->dataPtr->schema->key << "] "
              << "whose type is["
-             << this->dataPtr->typeName << "], to "
+             << this->dataPtr->schema->typeName << "], to "
              << "type[" << typeid(T).name() << "]\n";
       return false;
     }
@@ -342,19 +573,37 @@ namespace sdf
   template<typename T>
   bool Param::GetDefault(T &_value) const
   {
+    if constexpr (IsVariantAlternative<T, ParamPrivate::ParamVariant>::value)
+    {
+      const T *value = std::get_if<T>(&this->dataPtr->schema->defaultValue);
+      if (value)
+      {
+        _value = *value;
+        return true;
+      }
+    }
+
+    if (std::visit([&_value](const auto &_held)
+          {
+            return ParamPrivate::NumericCast(_held, _value);
+          }, this->dataPtr->schema->defaultValue))
+    {
+      return true;
+    }
+
     std::stringstream ss;
 
     try
     {
-      ss << ParamStreamer{this->dataPtr->defaultValue};
+      ss << ParamStreamer{this->dataPtr->schema->defaultValue};
       ss >> _value;
     }
     catch(...)
     {
       sdferr << "Unable to convert parameter["
-             << this->dataPtr->key << "] "
+             << this->dataPtr->schema->key << "] "
              << "whose type is["
-             << this->dataPtr->typeName << "], to "
+             << this->dataPtr->schema->typeName << "], to "
              << "type[" << typeid(T).name() << "]\n";
       return false;
     }
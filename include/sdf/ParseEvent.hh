@@ -0,0 +1,136 @@
+/*
+ * Copyright 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef SDF_PARSEEVENT_HH_
+#define SDF_PARSEEVENT_HH_
+
+#include <cstddef>
+#include <functional>
+#include <string>
+
+#include "sdf/sdf_config.h"
+#include "sdf/system_util.hh"
+
+namespace sdf
+{
+  // Inline bracket to help doxygen filtering.
+  inline namespace SDF_VERSION_NAMESPACE {
+  //
+
+  /// \enum ParseStage
+  /// \brief The stages of parsing that are reported through the
+  /// ParseEventCallback.
+  enum class ParseStage
+  {
+    /// \brief sdf::readFile, from looking up the file to the final element
+    /// tree.
+    READ_FILE,
+
+    /// \brief Resolving a file name or URI to a path with sdf::findFile.
+    FIND_FILE,
+
+    /// \brief Parsing the XML of a file with TinyXML.
+    PARSE_XML,
+
+    /// \brief sdf::readDoc, which converts an XML document and reads it
+    /// into an element tree.
+    READ_DOC,
+
+    /// \brief Converting an XML document to another SDFormat version.
+    CONVERT,
+
+    /// \brief Resolving and reading an `<include>` element.
+    INCLUDE,
+
+    /// \brief sdf::Root::Load, which builds the DOM objects from an
+    /// element tree.
+    ROOT_LOAD,
+
+    /// \brief One of the validation passes of parser.hh, such as
+    /// sdf::checkPoseRelativeToGraph.
+    CHECK,
+  };
+
+  /// \brief Whether a ParseEvent marks the beginning or the end of a stage.
+  enum class ParseEventType
+  {
+    /// \brief The stage is starting.
+    BEGIN,
+
+    /// \brief The stage has finished, successfully or not.
+    END,
+  };
+
+  /// \brief An event reported through the ParseEventCallback. Every BEGIN
+  /// event is followed by an END event for the same stage on the same
+  /// thread, and stages nest, so that the events of a thread form a call
+  /// tree suitable for a tracing system.
+  struct ParseEvent
+  {
+    /// \brief The type of the event.
+    ParseEventType type = ParseEventType::BEGIN;
+
+    /// \brief The stage of parsing.
+    ParseStage stage = ParseStage::READ_FILE;
+
+    /// \brief Name of the function that implements the stage, such as
+    /// "sdf::checkPoseRelativeToGraph".
+    const char *name = "";
+
+    /// \brief Path of the file, or URI, being processed. When parsing a
+    /// string it is empty or a description of the source, such as
+    /// "data-string", and END events of file lookups hold the resolved
+    /// path.
+    std::string path;
+
+    /// \brief Number of XML or SDF elements produced, loaded or validated
+    /// by the stage. Only set in END events, and 0 if the stage does not
+    /// process elements or failed before producing them.
+    std::size_t elementCount = 0;
+
+    /// \brief URI of an `<include>` element, as written in the document.
+    /// Only set in END events of INCLUDE stages, whose path is the
+    /// resolved model file.
+    std::string uri;
+
+    /// \brief Size in bytes of the file parsed. Only set in END events of
+    /// PARSE_XML stages of files.
+    std::size_t bytes = 0;
+  };
+
+  /// \brief Callback that receives parse events.
+  using ParseEventCallback = std::function<void(const ParseEvent &)>;
+
+  /// \brief Set the callback that receives the parse events of all
+  /// threads, to profile where the time of a load is spent. The callback
+  /// may be called concurrently from several threads. Element counts are
+  /// only computed while a callback is set.
+  /// \param[in] _cb The callback, or an empty function to stop reporting
+  /// events, which is the default.
+  SDFORMAT_VISIBLE
+  void setParseEventCallback(ParseEventCallback _cb);
+
+  /// \brief Get the callback that the parse events of the calling thread
+  /// are reported to: the one of the ParserConfig of the load in progress
+  /// on the thread, if it sets one, or else the one set with
+  /// setParseEventCallback.
+  /// \return The callback, or an empty function if none is set.
+  /// \sa ParserConfig::SetParseEventCallback
+  SDFORMAT_VISIBLE
+  ParseEventCallback parseEventCallback();
+  }
+}
+#endif
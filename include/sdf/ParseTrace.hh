@@ -0,0 +1,130 @@
+/*
+ * Copyright 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef SDF_PARSETRACE_HH_
+#define SDF_PARSETRACE_HH_
+
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "sdf/ParseEvent.hh"
+#include "sdf/sdf_config.h"
+#include "sdf/system_util.hh"
+
+namespace sdf
+{
+  // Inline bracket to help doxygen filtering.
+  inline namespace SDF_VERSION_NAMESPACE {
+  //
+
+  // Forward declare private data class.
+  class ParseTracePrivate;
+
+  /// \brief A file of the include tree recorded by a ParseTrace: either a
+  /// file read with sdf::readFile, or a file included by an `<include>`
+  /// element.
+  struct IncludeTraceNode
+  {
+    /// \brief URI of the `<include>` element, or the file name passed to
+    /// sdf::readFile.
+    std::string uri;
+
+    /// \brief Resolved path of the file.
+    std::string path;
+
+    /// \brief Size of the file in bytes, or 0 if it was not parsed, such as
+    /// an included file found in the include cache.
+    std::size_t bytes = 0;
+
+    /// \brief Time spent on the file, including its own includes.
+    std::chrono::nanoseconds duration{0};
+
+    /// \brief Time spent parsing the XML of the file.
+    std::chrono::nanoseconds parseTime{0};
+
+    /// \brief Time spent converting the file to the latest version.
+    std::chrono::nanoseconds conversionTime{0};
+
+    /// \brief Number of elements read from the file, including those of its
+    /// own includes.
+    std::size_t elementCount = 0;
+
+    /// \brief The files included by this one, in document order.
+    std::vector<IncludeTraceNode> children;
+  };
+
+  /// \brief Records the parse events of all threads while its callback is
+  /// set with setParseEventCallback, to find which file of a slow load is
+  /// responsible. The events can be exported as the include tree of the
+  /// loaded files, or as a trace in the Chrome trace event format, which
+  /// chrome://tracing and Perfetto display.
+  ///
+  ///     sdf::ParseTrace trace;
+  ///     sdf::setParseEventCallback(trace.Callback());
+  ///     root.Load(filename);
+  ///     sdf::setParseEventCallback(nullptr);
+  ///     std::ofstream("load.json") << trace.ChromeTraceJson();
+  class SDFORMAT_VISIBLE ParseTrace
+  {
+    /// \brief Default constructor.
+    public: ParseTrace();
+
+    /// \brief Copy constructor is explicitly deleted.
+    public: ParseTrace(const ParseTrace &) = delete;
+
+    /// \brief Copy assignment is explicitly deleted.
+    public: ParseTrace &operator=(const ParseTrace &) = delete;
+
+    /// \brief Destructor.
+    public: ~ParseTrace();
+
+    /// \brief Get a callback that records the events it receives in this
+    /// trace. This trace must outlive the use of the callback.
+    /// \return The callback, to pass to setParseEventCallback.
+    public: ParseEventCallback Callback();
+
+    /// \brief Record an event.
+    /// \param[in] _event The event.
+    public: void Record(const ParseEvent &_event);
+
+    /// \brief Remove the recorded events.
+    public: void Clear();
+
+    /// \brief Get the number of recorded events.
+    /// \return Number of events.
+    public: std::size_t EventCount() const;
+
+    /// \brief Get the include tree of the recorded events. Files read on
+    /// other threads, such as the includes prefetched with
+    /// ParserConfig::SetIncludeThreadCount, are roots of the tree, and the
+    /// includes that then find them in the include cache have no bytes.
+    /// \return The files read outside of an include, each with its include
+    /// tree, in the order they were read.
+    public: std::vector<IncludeTraceNode> IncludeTree() const;
+
+    /// \brief Get the recorded events in the Chrome trace event format,
+    /// with one track per thread.
+    /// \return A JSON document.
+    public: std::string ChromeTraceJson() const;
+
+    /// \brief Private data pointer.
+    private: ParseTracePrivate *dataPtr = nullptr;
+  };
+  }
+}
+#endif
@@ -0,0 +1,683 @@
+/*
+ * Copyright 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef SDF_PARSERCONFIG_HH_
+#define SDF_PARSERCONFIG_HH_
+
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include <ignition/math/Pose3.hh>
+
+#include "sdf/Error.hh"
+#include "sdf/IncludeCache.hh"
+#include "sdf/ParseEvent.hh"
+#include "sdf/sdf_config.h"
+#include "sdf/system_util.hh"
+
+namespace sdf
+{
+  // Inline bracket to help doxygen filtering.
+  inline namespace SDF_VERSION_NAMESPACE {
+  //
+
+  // Forward declare private data class.
+  class ParserConfigPrivate;
+  class Model;
+  class World;
+
+  /// \enum ValidationLevel
+  /// \brief Checks run by sdf::Root::Load while building DOM objects.
+  enum class ValidationLevel
+  {
+    /// \brief Run every check, which is the default.
+    FULL = 0,
+
+    /// \brief Build the frame graphs of models and worlds, which reports
+    /// references to unknown frames, but do not validate them, and do not
+    /// warn about elements with the same name. For documents that are known
+    /// to be valid.
+    STRUCTURAL = 1,
+
+    /// \brief Also skip building the attached-to graphs of models and
+    /// worlds, which are only used by sdf::Frame::ResolveAttachedToBody.
+    /// It then returns an error.
+    NONE = 2
+  };
+
+  /// \enum ParseScope
+  /// \brief Parts of a document read by sdf::readFile and sdf::readString
+  /// and loaded by sdf::Root::Load. The parts outside of the scope are
+  /// removed from the XML before they are read, so that their includes are
+  /// not resolved and no element or DOM object is created for them.
+  enum class ParseScope
+  {
+    /// \brief Read the whole document, which is the default.
+    FULL = 0,
+
+    /// \brief Read the first <world> without its entities, for its name,
+    /// gravity, physics and other properties. The other worlds, and the
+    /// <model>, <include>, <actor>, <light>, <frame>, <joint>, <population>
+    /// and <road> children of the world, are skipped.
+    WORLD_HEADER = 1,
+
+    /// \brief Only read the names of the worlds and of their top level
+    /// entities. The <model>, <actor> and <light> children of the worlds
+    /// and of the <sdf> element keep their attributes but none of their
+    /// children, and the other children of the worlds are skipped. An
+    /// <include> is replaced with the element of the included entity,
+    /// with only its attributes and the name given by the include, and the
+    /// included file is parsed but not converted or read. sdf::Root::Load
+    /// loads no DOM object in this scope, and the names are read from the
+    /// elements of sdf::Root::Element.
+    TOP_LEVEL_NAMES = 2,
+
+    /// \brief Read the first ParserConfig::ScopeModelCount <model> and
+    /// <include> children of each world. The <model>, <include>, <actor>,
+    /// <light>, <frame>, <joint>, <population> and <road> children that
+    /// come after the last of them are skipped.
+    FIRST_MODELS = 3
+  };
+
+  /// \enum LoadProgressType
+  /// \brief The steps of a load reported through
+  /// ParserConfig::ProgressCallback.
+  enum class LoadProgressType
+  {
+    /// \brief A file to read was found, by sdf::readFile or for an
+    /// <include> element.
+    FILE_RESOLVED = 0,
+
+    /// \brief The XML of a file was parsed.
+    FILE_PARSED = 1,
+
+    /// \brief A model was loaded by sdf::Root::Load.
+    MODEL_LOADED = 2,
+
+    /// \brief A world was loaded by sdf::Root::Load, including its models.
+    WORLD_LOADED = 3
+  };
+
+  /// \brief A step of a load, reported through
+  /// ParserConfig::ProgressCallback.
+  struct LoadProgress
+  {
+    /// \brief The step.
+    LoadProgressType type = LoadProgressType::FILE_RESOLVED;
+
+    /// \brief Path of the resolved or parsed file, or name of the loaded
+    /// model or world.
+    std::string name;
+
+    /// \brief Size of the parsed file in bytes, for FILE_PARSED.
+    std::size_t bytes = 0;
+
+    /// \brief The loaded model, for MODEL_LOADED. It is only valid during
+    /// the callback, and the callback may copy it to use it before the load
+    /// finishes.
+    const Model *model = nullptr;
+
+    /// \brief The loaded world, for WORLD_LOADED. It is only valid during
+    /// the callback, like model.
+    const World *world = nullptr;
+  };
+
+  /// \brief A <model> or <include> child of a <world> element, passed to
+  /// ParserConfig::ModelFilter before it is read.
+  struct ModelCandidate
+  {
+    /// \brief Name of the world.
+    std::string worldName;
+
+    /// \brief The name attribute of a <model>, or the <name> of an
+    /// <include>, which is empty if the include does not override the name
+    /// of the included model.
+    std::string name;
+
+    /// \brief The <uri> of an <include>, or empty for a <model>.
+    std::string uri;
+
+    /// \brief True if the element has a <pose>.
+    bool hasPose = false;
+
+    /// \brief The <pose> of the element, as written.
+    ignition::math::Pose3d pose;
+
+    /// \brief The relative_to attribute of the <pose>, which is empty if
+    /// the pose is relative to the world.
+    std::string poseRelativeTo;
+  };
+
+  /// \brief Options that control how SDF files and strings are parsed.
+  ///
+  /// A default constructed ParserConfig parses exactly like the overloads of
+  /// sdf::readFile, sdf::readString and sdf::Root::Load that do not take a
+  /// ParserConfig.
+  class SDFORMAT_VISIBLE ParserConfig
+  {
+    /// \brief Default constructor
+    public: ParserConfig();
+
+    /// \brief Copy constructor
+    /// \param[in] _config ParserConfig to copy.
+    public: ParserConfig(const ParserConfig &_config);
+
+    /// \brief Move constructor
+    /// \param[in] _config ParserConfig to move.
+    public: ParserConfig(ParserConfig &&_config) noexcept;
+
+    /// \brief Destructor
+    public: ~ParserConfig();
+
+    /// \brief Assignment operator.
+    /// \param[in] _config The config to set values from.
+    /// \return *this
+    public: ParserConfig &operator=(const ParserConfig &_config);
+
+    /// \brief Move assignment operator.
+    /// \param[in] _config The config to set values from.
+    /// \return *this
+    public: ParserConfig &operator=(ParserConfig &&_config);
+
+    /// \brief Set the cache used for files read through `<include>`
+    /// elements. Copies of this ParserConfig share the same cache.
+    /// \param[in] _cache The cache to use, or nullptr to read every
+    /// included file from disk, which is the default.
+    public: void SetIncludeCache(std::shared_ptr<sdf::IncludeCache> _cache);
+
+    /// \brief Get the cache used for files read through `<include>`
+    /// elements.
+    /// \return The cache, or nullptr if included files are not cached.
+    public: std::shared_ptr<sdf::IncludeCache> IncludeCache() const;
+
+    /// \brief Set whether sdf::Root builds its DOM objects lazily.
+    ///
+    /// When enabled, sdf::Root::Load only reads the element tree and checks
+    /// that the names of the top level worlds, models, lights and actors are
+    /// unique. Each World, Model, Light and Actor is then built the first
+    /// time it is accessed through sdf::Root, and its load errors are only
+    /// reported by sdf::Root::LoadDeferred. Unlike eager loading, worlds
+    /// that fail to load are still counted and returned.
+    /// \param[in] _lazy True to build DOM objects on first access, false to
+    /// build them all in sdf::Root::Load, which is the default.
+    public: void SetLazyDomLoading(bool _lazy);
+
+    /// \brief Get whether sdf::Root builds its DOM objects lazily.
+    /// \return True if DOM objects are built on first access.
+    /// \sa SetLazyDomLoading
+    public: bool LazyDomLoading() const;
+
+    /// \brief Set whether URDF files and strings are converted directly to
+    /// an element tree.
+    ///
+    /// By default, a URDF document is converted to SDFormat XML, which is
+    /// then read like any other SDFormat document. When enabled, the element
+    /// tree is built from the parsed URDF model instead, with typed values
+    /// that are not printed to and parsed from text. Values can differ from
+    /// the default conversion in their last digits, because they are not
+    /// rounded to text. URDF documents with <gazebo> extensions always use
+    /// the default conversion.
+    /// \param[in] _direct True to convert URDF directly to elements, false
+    /// to convert it through SDFormat XML, which is the default.
+    public: void SetDirectUrdfConversion(bool _direct);
+
+    /// \brief Get whether URDF is converted directly to an element tree.
+    /// \return True if URDF is converted directly to elements.
+    /// \sa SetDirectUrdfConversion
+    public: bool DirectUrdfConversion() const;
+
+    /// \brief Set the number of threads that sdf::World::Load uses to load
+    /// the models of a world, which includes building and validating their
+    /// frame graphs. Models only depend on each other through the graphs of
+    /// the world, which are built after all of them are loaded. Errors are
+    /// reported in document order for any number of threads. sdf::Root::Load
+    /// uses this value for its worlds and models unless LazyDomLoading is
+    /// enabled. A model that is not loaded concurrently with other models,
+    /// such as the only model of a world, loads its links on the same number
+    /// of threads instead.
+    /// \param[in] _count Number of threads. 1 loads the models on the
+    /// calling thread, which is the default, and 0 uses one thread per
+    /// hardware thread.
+    public: void SetModelLoadThreadCount(unsigned int _count);
+
+    /// \brief Get the number of threads used to load the models of a world.
+    /// \return Number of threads, or 0 for one per hardware thread.
+    /// \sa SetModelLoadThreadCount
+    public: unsigned int ModelLoadThreadCount() const;
+
+    /// \brief Set the number of threads that sdf::readFile and
+    /// sdf::readString use to prefetch the files included by an element.
+    /// Before the <include> children of an element are read in order, their
+    /// unique URIs are resolved and the included files are read and
+    /// converted concurrently. The results are stored in the IncludeCache,
+    /// or in a cache that only lasts while the element is read if none is
+    /// set, and the in-order pass uses them. Errors are reported by the
+    /// in-order pass, as without prefetching. Prefetching calls the
+    /// callback of sdf::setFindCallback from several threads, so the
+    /// callback must be thread-safe.
+    /// \param[in] _count Number of threads. 1 reads includes one at a time
+    /// in document order, which is the default, and 0 uses one thread per
+    /// hardware thread.
+    public: void SetIncludeThreadCount(unsigned int _count);
+
+    /// \brief Get the number of threads used to prefetch included files.
+    /// \return Number of threads, or 0 for one per hardware thread.
+    /// \sa SetIncludeThreadCount
+    public: unsigned int IncludeThreadCount() const;
+
+    /// \brief Set the number of threads that sdf::readFile and
+    /// sdf::readString use to read the <model>, <actor> and <light>
+    /// children of a <world> that are written in the document. They are
+    /// independent subtrees, so each is read into its own element tree
+    /// concurrently, and the trees are added to the world in document order
+    /// by the in-order pass, which reads the <include> children. Errors are
+    /// reported in document order, as when reading on one thread, but
+    /// warnings may be printed in a different order.
+    /// \param[in] _count Number of threads. 1 reads the children one at a
+    /// time in document order, which is the default, and 0 uses one thread
+    /// per hardware thread.
+    public: void SetReadThreadCount(unsigned int _count);
+
+    /// \brief Get the number of threads used to read the children of a
+    /// world.
+    /// \return Number of threads, or 0 for one per hardware thread.
+    /// \sa SetReadThreadCount
+    public: unsigned int ReadThreadCount() const;
+
+    /// \brief Set whether the elements and params of the trees read by
+    /// sdf::readFile and sdf::readString, including the documents they
+    /// include, are allocated from an arena. The memory of an arena is
+    /// allocated in large blocks and freed at once when the last element
+    /// allocated from it is deleted, which makes reading and deleting large
+    /// trees faster. Elements allocated from an arena can be used and
+    /// deleted like any other element, but memory of deleted elements is
+    /// only reclaimed with the whole arena, so long lived trees that are
+    /// modified a lot should not use it. sdf::Root also allocates the
+    /// private data of its links, visuals, collisions, joints, frames,
+    /// sensors and their geometries, materials, surfaces and noises from an
+    /// arena of its own.
+    /// \param[in] _arena True to allocate from an arena, false to allocate
+    /// each object from the heap, which is the default.
+    public: void SetArenaAllocation(bool _arena);
+
+    /// \brief Get whether element trees are allocated from an arena.
+    /// \return True if element trees are allocated from an arena.
+    /// \sa SetArenaAllocation
+    public: bool ArenaAllocation() const;
+
+    /// \brief Set whether sdf::Root releases the element tree once the DOM
+    /// objects are generated, so that only the objects stay in memory. The
+    /// Element accessors of the root and of every DOM object then return
+    /// nullptr, and sdf::Root::SaveBinary fails. With LazyDomLoading, the
+    /// tree is kept until sdf::Root::LoadDeferred generates the remaining
+    /// objects.
+    /// \param[in] _release True to release the elements, false to keep
+    /// them, which is the default.
+    public: void SetReleaseElements(bool _release);
+
+    /// \brief Get whether sdf::Root releases the element tree after
+    /// generating the DOM objects.
+    /// \return True if the elements are released.
+    /// \sa SetReleaseElements
+    public: bool ReleaseElements() const;
+
+    /// \brief Set whether the visuals loaded by sdf::Root share one
+    /// instance of each distinct material, instead of each holding its own
+    /// copy. Materials are shared across every document loaded with this
+    /// setting, so worlds with many copies of the same models keep a single
+    /// material of each kind in memory, and renderers can batch visuals by
+    /// sdf::Visual::MaterialId. A shared material must not be modified
+    /// through sdf::Visual::Material; sdf::Visual::SetMaterial replaces it
+    /// with a material of the visual's own.
+    /// \param[in] _share True to share materials, false to give each visual
+    /// its own material, which is the default.
+    public: void SetShareMaterials(bool _share);
+
+    /// \brief Get whether the visuals loaded by sdf::Root share materials.
+    /// \return True if identical materials are shared.
+    /// \sa SetShareMaterials
+    public: bool ShareMaterials() const;
+
+    /// \brief Set whether the parser keeps the body of each `<plugin>`
+    /// element, and of each element outside of the SDF spec such as a
+    /// namespaced element, as XML text until it is first accessed, instead
+    /// of copying it into a tree of elements. Plugins often carry large
+    /// configurations that the parser itself never reads. The elements are
+    /// read the first time the child elements of a plugin or custom element
+    /// are accessed, for example with sdf::Element::GetElement,
+    /// sdf::Element::GetFirstElement or sdf::Element::ToString, and are then
+    /// the same as without this setting.
+    /// \param[in] _defer True to defer the copied elements, false to copy
+    /// them while parsing, which is the default.
+    /// \sa sdf::Element::ElementsDeferred
+    public: void SetDeferCopiedElements(bool _defer);
+
+    /// \brief Get whether the parser defers the elements copied from
+    /// plugins and custom elements.
+    /// \return True if the copied elements are deferred.
+    /// \sa SetDeferCopiedElements
+    public: bool DeferCopiedElements() const;
+
+    /// \brief Set the checks run by sdf::Root::Load while building the DOM
+    /// objects. Skipping checks makes loading faster, but invalid documents
+    /// then load without errors.
+    /// \param[in] _level The checks to run. The default is
+    /// ValidationLevel::FULL.
+    public: void SetValidation(ValidationLevel _level);
+
+    /// \brief Get the checks run by sdf::Root::Load.
+    /// \return The validation level.
+    /// \sa SetValidation
+    public: ValidationLevel Validation() const;
+
+    /// \brief Set the number of errors after which sdf::Root::Load stops
+    /// loading DOM objects. The objects that are not loaded yet when the
+    /// limit is reached are skipped, along with the errors they would have
+    /// reported, and at most this many errors are reported. This keeps
+    /// malformed documents with many objects from building and collecting
+    /// errors that would not be read.
+    /// \param[in] _count Number of errors, or 0 to load every object and
+    /// report every error, which is the default.
+    public: void SetMaxErrors(std::size_t _count);
+
+    /// \brief Get the number of errors after which sdf::Root::Load stops
+    /// loading DOM objects.
+    /// \return Number of errors, or 0 for no limit.
+    /// \sa SetMaxErrors
+    public: std::size_t MaxErrors() const;
+
+    /// \brief Set the number of times the same warning is printed while
+    /// reading a file, such as a deprecated element or an unknown attribute
+    /// that occurs in every copy of a model. Further occurrences are only
+    /// counted, and reported by a single line with the number of
+    /// occurrences once the file is read.
+    /// \param[in] _count Number of times, or 0 to print every occurrence.
+    /// The default is 1.
+    public: void SetWarningRepeatLimit(std::size_t _count);
+
+    /// \brief Get the number of times the same warning is printed while
+    /// reading a file.
+    /// \return Number of times, or 0 for no limit.
+    /// \sa SetWarningRepeatLimit
+    public: std::size_t WarningRepeatLimit() const;
+
+    /// \brief Set the number of different warnings of the same kind, such
+    /// as unknown attributes, that are printed while reading a file. The
+    /// other warnings of that kind are only counted, and reported by a
+    /// single line once the file is read.
+    /// \param[in] _count Number of warnings, or 0 for no limit, which is
+    /// the default.
+    public: void SetWarningSiteLimit(std::size_t _count);
+
+    /// \brief Get the number of different warnings of the same kind that
+    /// are printed while reading a file.
+    /// \return Number of warnings, or 0 for no limit.
+    /// \sa SetWarningSiteLimit
+    public: std::size_t WarningSiteLimit() const;
+
+    /// \brief Set a function that is called by sdf::Root::Load with each
+    /// error, in the order they are returned by default, instead of
+    /// returning them. Errors are then not collected in the returned vector,
+    /// which is empty.
+    /// \param[in] _callback The function, or nullptr to return the errors,
+    /// which is the default.
+    public: void SetErrorCallback(
+        std::function<void(const sdf::Error &)> _callback);
+
+    /// \brief Get the function called with each error by sdf::Root::Load.
+    /// \return The function, or nullptr if errors are returned.
+    /// \sa SetErrorCallback
+    public: const std::function<void(const sdf::Error &)> &
+        ErrorCallback() const;
+
+    /// \brief Set a function that is called with the progress of
+    /// sdf::readFile, sdf::readString and sdf::Root::Load, such as each
+    /// file that is resolved and parsed, and each model and world that is
+    /// loaded. It is called from the threads that do the work, so it may be
+    /// called concurrently when ModelLoadThreadCount, IncludeThreadCount or
+    /// ReadThreadCount is not 1.
+    /// \param[in] _callback The function, or nullptr to not report progress,
+    /// which is the default.
+    public: void SetProgressCallback(
+        std::function<void(const LoadProgress &)> _callback);
+
+    /// \brief Get the function called with the progress of a load.
+    /// \return The function, or nullptr.
+    /// \sa SetProgressCallback
+    public: const std::function<void(const LoadProgress &)> &
+        ProgressCallback() const;
+
+    /// \brief Set a function that tells whether a load should stop. It is
+    /// checked for each element read by sdf::readFile and sdf::readString,
+    /// and before each DOM object loaded by sdf::Root::Load. Once it returns
+    /// true, reading fails and the DOM objects that are not loaded yet are
+    /// skipped, with an ErrorCode::LOAD_CANCELLED error. It may be called
+    /// concurrently, like the progress callback.
+    /// \param[in] _callback The function, or nullptr to never stop, which
+    /// is the default.
+    /// \sa Root::LoadAsync
+    public: void SetCancelCallback(std::function<bool()> _callback);
+
+    /// \brief Get the function that tells whether a load should stop.
+    /// \return The function, or nullptr.
+    /// \sa SetCancelCallback
+    public: const std::function<bool()> &CancelCallback() const;
+
+    /// \brief Set a function that runs the tasks of the parallel stages of
+    /// sdf::readFile, sdf::readString and sdf::Root::Load on threads of the
+    /// application, such as the executor of a simulator, instead of the
+    /// threads of the library. The thread counts of the stages, such as
+    /// ModelLoadThreadCount, are the most tasks a stage runs at once. Every
+    /// stage shares the same threads, so that stages that run inside each
+    /// other do not start more threads than the hardware has. The calling
+    /// thread also runs tasks, so reading completes even if the executor
+    /// runs the tasks late or one at a time.
+    /// \param[in] _executor The function, which is called with each task
+    /// and must run it once on any thread, or nullptr to use a pool of
+    /// threads shared by the library, which is the default.
+    public: void SetExecutor(
+        std::function<void(std::function<void()>)> _executor);
+
+    /// \brief Get the function that runs the tasks of the parallel stages.
+    /// \return The function, or nullptr.
+    /// \sa SetExecutor
+    public: const std::function<void(std::function<void()>)> &
+        Executor() const;
+
+    /// \brief Set a function that selects the models of worlds to read.
+    /// It is called by sdf::readFile and sdf::readString with each <model>
+    /// and <include> child of a <world> element, before the includes of the
+    /// world are resolved. The elements for which it returns false are
+    /// skipped, so that their files are neither found nor parsed, and no
+    /// DOM object is loaded for them. An <include> of a light or an actor
+    /// is also passed to the function. It may be called concurrently, like
+    /// the progress callback.
+    /// \param[in] _filter The function, or nullptr to read every model,
+    /// which is the default.
+    public: void SetModelFilter(
+        std::function<bool(const ModelCandidate &)> _filter);
+
+    /// \brief Get the function that selects the models of worlds to read.
+    /// \return The function, or nullptr.
+    /// \sa SetModelFilter
+    public: const std::function<bool(const ModelCandidate &)> &
+        ModelFilter() const;
+
+    /// \brief Set a function that selects the worlds to read by name. It
+    /// is called by sdf::readFile and sdf::readString with the name of each
+    /// <world> child of the <sdf> element, in document order, before any of
+    /// them is read. The worlds for which it returns false are skipped, so
+    /// that none of their includes is resolved.
+    /// \param[in] _filter The function, or nullptr to read every world,
+    /// which is the default.
+    public: void SetWorldFilter(
+        std::function<bool(const std::string &)> _filter);
+
+    /// \brief Get the function that selects the worlds to read.
+    /// \return The function, or nullptr.
+    /// \sa SetWorldFilter
+    public: const std::function<bool(const std::string &)> &
+        WorldFilter() const;
+
+    /// \brief Set whether sdf::Root::Load reads the worlds of a file only
+    /// when they are first accessed, so that a file with many worlds, such
+    /// as a set of scenarios, is not read in full to use one of them. The
+    /// load only reads the names of the worlds. Each world is read from the
+    /// file on its own the first time it is accessed, or with
+    /// sdf::Root::LoadWorld, and its errors are reported by LoadWorld and
+    /// sdf::Root::LoadDeferred. The worlds share the include cache of the
+    /// configuration, or one that the root keeps if there is none, so that
+    /// the models they include from the same file are read once. This only
+    /// applies to loading a file.
+    /// \param[in] _onDemand True to read the worlds on demand. The default
+    /// is false.
+    public: void SetWorldsOnDemand(bool _onDemand);
+
+    /// \brief Get whether the worlds of a file are read on demand.
+    /// \return True if the worlds are read on demand.
+    /// \sa SetWorldsOnDemand
+    public: bool WorldsOnDemand() const;
+
+    /// \brief Set the version of the specification that sdf::init,
+    /// sdf::readFile and sdf::readString initialize documents with and
+    /// convert them to. Documents read with different versions can be read
+    /// concurrently, since the version is carried by the read instead of
+    /// being taken from SDF::Version.
+    /// \param[in] _version The version, such as "1.6", or an empty string
+    /// to use SDF::Version, which is the default.
+    public: void SetSpecVersion(const std::string &_version);
+
+    /// \brief Get the version of the specification that documents are read
+    /// as.
+    /// \return The version, or an empty string for SDF::Version.
+    /// \sa SetSpecVersion
+    public: const std::string &SpecVersion() const;
+
+    /// \brief Set the <physics> profile of each world that sdf::World::Load
+    /// loads into an sdf::Physics object, so that tools that use one of
+    /// many profiles don't load the others. The other profiles stay in the
+    /// element tree of the world, unless the elements are released, and can
+    /// be loaded later with sdf::Physics::Load. A world with no profile of
+    /// that name gets a default sdf::Physics object and an error.
+    /// \param[in] _name Name of the profile, "__default__" to load the
+    /// profile that the world uses by default, as in
+    /// sdf::World::PhysicsDefault, or an empty string to load every profile,
+    /// which is the default.
+    public: void SetPhysicsProfile(const std::string &_name);
+
+    /// \brief Get the <physics> profile of each world that is loaded.
+    /// \return Name of the profile, "__default__" for the default profile,
+    /// or an empty string for every profile.
+    /// \sa SetPhysicsProfile
+    public: const std::string &PhysicsProfile() const;
+
+    /// \brief Set the parts of a document that are read and loaded, so
+    /// that tools that only need the header of a world or the names of its
+    /// models do not read the whole document. The scope applies to the
+    /// document itself, not to the files it includes, which are read in
+    /// full when they are read.
+    /// \param[in] _scope The scope. The default is ParseScope::FULL.
+    public: void SetParseScope(sdf::ParseScope _scope);
+
+    /// \brief Get the parts of a document that are read and loaded.
+    /// \return The scope.
+    /// \sa SetParseScope
+    public: sdf::ParseScope ParseScope() const;
+
+    /// \brief Set the number of models of each world read with
+    /// ParseScope::FIRST_MODELS.
+    /// \param[in] _count Number of models. The default is 1.
+    public: void SetScopeModelCount(std::size_t _count);
+
+    /// \brief Get the number of models of each world read with
+    /// ParseScope::FIRST_MODELS.
+    /// \return Number of models.
+    /// \sa SetScopeModelCount
+    public: std::size_t ScopeModelCount() const;
+
+    /// \brief Set the deepest nesting of elements that sdf::readFile and
+    /// sdf::readString read, so that a malformed or hostile document, such
+    /// as one with thousands of nested models, fails with an
+    /// ErrorCode::ELEMENT_NESTING_TOO_DEEP error instead of overflowing the
+    /// call stack. The <sdf> element of a document has a depth of 1, and
+    /// the elements of a file included on the same thread are counted from
+    /// the element that includes it. The elements that are not part of the
+    /// spec, such as the contents of plugins, are not counted, since they
+    /// are copied without recursion, except in the binary documents read
+    /// by Root::LoadBinary, where every element is counted.
+    /// \param[in] _depth The deepest nesting, or 0 for no limit. The
+    /// default is 256.
+    public: void SetMaxNestingDepth(std::size_t _depth);
+
+    /// \brief Get the deepest nesting of elements that is read.
+    /// \return The deepest nesting, or 0 for no limit.
+    /// \sa SetMaxNestingDepth
+    public: std::size_t MaxNestingDepth() const;
+
+    /// \brief Associate paths to a URI for the loads that use this
+    /// configuration, like sdf::addURIPath does for every load. The paths
+    /// of the configuration are searched by sdf::findFile before the global
+    /// ones while sdf::readFile, sdf::readString or sdf::Root::Load run
+    /// with this configuration, so that two loads in one process can find
+    /// models in different places.
+    /// \param[in] _uri URI that will be mapped to _path, such as
+    /// "model://".
+    /// \param[in] _path Colon separated set of paths.
+    public: void AddURIPath(const std::string &_uri, const std::string &_path);
+
+    /// \brief Get the paths associated to URIs with AddURIPath.
+    /// \return The paths of each URI, in the order they were added.
+    public: const std::map<std::string, std::vector<std::string>> &
+        URIPathMap() const;
+
+    /// \brief Set the callback that sdf::findFile uses when it can't find a
+    /// file during the loads that use this configuration. It is called
+    /// before the callback of sdf::setFindCallback, which is only called if
+    /// this one does not find the file.
+    /// \param[in] _callback The callback, which returns the complete path
+    /// to the requested file or an empty string, or nullptr to only use the
+    /// global callback, which is the default.
+    public: void SetFindFileCallback(
+        std::function<std::string(const std::string &)> _callback);
+
+    /// \brief Get the callback used when sdf::findFile can't find a file.
+    /// \return The callback, or nullptr.
+    /// \sa SetFindFileCallback
+    public: const std::function<std::string(const std::string &)> &
+        FindFileCallback() const;
+
+    /// \brief Set the callback that the events of the loads that use this
+    /// configuration are reported to, instead of the callback of
+    /// sdf::setParseEventCallback.
+    /// \param[in] _callback The callback, or nullptr to use the global
+    /// callback, which is the default.
+    public: void SetParseEventCallback(sdf::ParseEventCallback _callback);
+
+    /// \brief Get the callback that the events of the loads are reported
+    /// to.
+    /// \return The callback, or nullptr.
+    /// \sa SetParseEventCallback
+    public: const sdf::ParseEventCallback &ParseEventCallback() const;
+
+    /// \brief Private data pointer.
+    private: ParserConfigPrivate *dataPtr = nullptr;
+  };
+  }
+}
+#endif
@@ -71,7 +71,7 @@ namespace sdf
 
     /// \brief Get the name of this set of physics parameters.
     /// \return Name of the physics profile.
-    public: std::string Name() const;
+    public: const std::string &Name() const;
 
     /// \brief Set the name of this set of physics parameters.
     /// \param[in] _name Name of the physics profile.
@@ -99,7 +99,7 @@ namespace sdf
     /// Current options are ode, bullet, simbody and dart. Defaults to ode if
     /// left unspecified.
     /// \return The type of dynamics engine.
-    public: std::string EngineType() const;
+    public: const std::string &EngineType() const;
 
     /// \brief Set the physics profile dynamics engine type.
     /// \param[in] _type The type of dynamics engine.
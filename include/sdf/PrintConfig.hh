@@ -0,0 +1,101 @@
+/*
+ * Copyright 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef SDF_PRINTCONFIG_HH_
+#define SDF_PRINTCONFIG_HH_
+
+#include "sdf/sdf_config.h"
+#include "sdf/system_util.hh"
+
+namespace sdf
+{
+  // Inline bracket to help doxygen filtering.
+  inline namespace SDF_VERSION_NAMESPACE {
+  //
+
+  // Forward declare private data class.
+  class PrintConfigPrivate;
+
+  /// \brief Options that control how element trees are printed by
+  /// Element::ToString, Element::Write, SDF::ToString and SDF::Write.
+  ///
+  /// A default constructed PrintConfig prints exactly like the overloads
+  /// that do not take a PrintConfig.
+  class SDFORMAT_VISIBLE PrintConfig
+  {
+    /// \brief Default constructor
+    public: PrintConfig();
+
+    /// \brief Copy constructor
+    /// \param[in] _config PrintConfig to copy.
+    public: PrintConfig(const PrintConfig &_config);
+
+    /// \brief Move constructor
+    /// \param[in] _config PrintConfig to move.
+    public: PrintConfig(PrintConfig &&_config) noexcept;
+
+    /// \brief Destructor
+    public: ~PrintConfig();
+
+    /// \brief Assignment operator.
+    /// \param[in] _config The config to set values from.
+    /// \return *this
+    public: PrintConfig &operator=(const PrintConfig &_config);
+
+    /// \brief Move assignment operator.
+    /// \param[in] _config The config to set values from.
+    /// \return *this
+    public: PrintConfig &operator=(PrintConfig &&_config);
+
+    /// \brief Set whether models, actors and lights that were read through
+    /// `<include>` elements are printed as those `<include>` elements while
+    /// they are unmodified, instead of being printed in full. This keeps
+    /// the output of worlds that include many models small, and fast to
+    /// write and read again. Elements that were modified after they were
+    /// included, as told by Element::Hash, are printed in full.
+    /// \param[in] _preserve True to print the `<include>` elements. The
+    /// default is false.
+    /// \sa Element::SetIncludeXml
+    public: void SetPreserveIncludes(bool _preserve);
+
+    /// \brief Get whether unmodified included elements are printed as
+    /// their `<include>` elements.
+    /// \return True if they are.
+    /// \sa SetPreserveIncludes
+    public: bool PreserveIncludes() const;
+
+    /// \brief Set the number of threads that Element::ToString,
+    /// Element::Write and SDF::Write use. Elements with many children, such
+    /// as the models of a world, have their children printed concurrently
+    /// into separate buffers that are then appended in document order, so
+    /// the output is the same for any number of threads. Element::Write
+    /// prints the children in batches, so that the output of a large world
+    /// is still never held in memory whole.
+    /// \param[in] _count Number of threads. 1 prints on the calling thread,
+    /// which is the default, and 0 uses one thread per hardware thread.
+    public: void SetThreadCount(unsigned int _count);
+
+    /// \brief Get the number of threads used to print.
+    /// \return Number of threads, or 0 for one per hardware thread.
+    /// \sa SetThreadCount
+    public: unsigned int ThreadCount() const;
+
+    /// \brief Private data pointer.
+    private: PrintConfigPrivate *dataPtr = nullptr;
+  };
+  }
+}
+#endif
@@ -0,0 +1,114 @@
+/*
+ * Copyright 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef SDF_RENDERBATCHES_HH_
+#define SDF_RENDERBATCHES_HH_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <ignition/math/Pose3.hh>
+
+#include "sdf/sdf_config.h"
+
+namespace sdf
+{
+  // Inline bracket to help doxygen filtering.
+  inline namespace SDF_VERSION_NAMESPACE {
+  //
+
+  class Geometry;
+  class Material;
+
+  /// \brief The visuals of a world or model grouped into instancing
+  /// batches, so that a renderer builds its draw lists in one pass instead
+  /// of comparing the geometry and material of every visual. It is filled
+  /// by Model::ResolveRenderBatches and World::ResolveRenderBatches.
+  ///
+  /// The visuals of a batch have identical geometries, the same material,
+  /// and the same cast shadows flag and transparency, so they can be drawn
+  /// as instances of the first one. Geometries are identical if they have
+  /// the same type and dimensions, or for meshes the same resolved file,
+  /// submesh and scale, as listed by Root::Assets. Materials are the same
+  /// if they are shared, as with ParserConfig::SetShareMaterials, so that
+  /// visuals that have their own material are in batches of their own.
+  /// Visuals with an empty geometry are left out.
+  ///
+  /// The visuals of batch b are at positions [BatchBegin(b), BatchEnd(b))
+  /// of the instance arrays, in the order of their ByIndex functions. The
+  /// batches are in the order of their first visual.
+  struct RenderBatches
+  {
+    /// \brief Geometry of the first visual of each batch.
+    std::vector<const Geometry *> geometries;
+
+    /// \brief Material of the first visual of each batch, or nullptr if
+    /// the visuals have none.
+    std::vector<const Material *> materials;
+
+    /// \brief Whether the visuals of each batch cast shadows.
+    std::vector<bool> castShadows;
+
+    /// \brief Transparency of the visuals of each batch.
+    std::vector<float> transparencies;
+
+    /// \brief Position of the first instance of each batch in the instance
+    /// arrays, followed by the number of instances.
+    std::vector<std::size_t> batchOffsets;
+
+    /// \brief Index of the model of each instance in World::ModelByIndex,
+    /// or 0 when filled by Model::ResolveRenderBatches.
+    std::vector<uint64_t> modelIndices;
+
+    /// \brief Index of the link of each instance in Model::LinkByIndex.
+    std::vector<uint64_t> linkIndices;
+
+    /// \brief Index of each instance in Link::VisualByIndex.
+    std::vector<uint64_t> visualIndices;
+
+    /// \brief Pose of each instance in the world frame, or in the model
+    /// frame when filled by Model::ResolveRenderBatches.
+    std::vector<ignition::math::Pose3d> poses;
+
+    /// \brief Visibility flags of each instance.
+    std::vector<uint32_t> visibilityFlags;
+
+    /// \brief Get the number of batches.
+    /// \return Number of batches.
+    std::size_t BatchCount() const
+    {
+      return this->geometries.size();
+    }
+
+    /// \brief Get the position of the first instance of a batch.
+    /// \param[in] _batch The batch.
+    /// \return Position in the instance arrays.
+    std::size_t BatchBegin(const std::size_t _batch) const
+    {
+      return this->batchOffsets[_batch];
+    }
+
+    /// \brief Get the position after the last instance of a batch.
+    /// \param[in] _batch The batch.
+    /// \return Position in the instance arrays.
+    std::size_t BatchEnd(const std::size_t _batch) const
+    {
+      return this->batchOffsets[_batch + 1];
+    }
+  };
+  }
+}
+#endif
@@ -17,8 +17,15 @@
 #ifndef SDF_ROOT_HH_
 #define SDF_ROOT_HH_
 
+#include <cstddef>
 #include <string>
+#include <string_view>
 
+#include "sdf/AssetManifest.hh"
+#include "sdf/LoadHandle.hh"
+#include "sdf/LoadStatistics.hh"
+#include "sdf/MemoryFootprint.hh"
+#include "sdf/ParserConfig.hh"
 #include "sdf/SDFImpl.hh"
 #include "sdf/Types.hh"
 #include "sdf/sdf_config.h"
@@ -32,7 +39,11 @@ namespace sdf
 
   // Forward declarations.
   class Actor;
+  class Frame;
+  class Joint;
   class Light;
+  struct LightCulling;
+  class Link;
   class Model;
   class RootPrivate;
   class World;
@@ -51,6 +62,23 @@ namespace sdf
   ///
   /// \snippet examples/dom.cc rootUsage
   ///
+  /// # Thread safety
+  ///
+  /// Once loaded, a root may be read from several threads at once through
+  /// the const methods of the root and of the DOM objects that it returns,
+  /// such as name lookups and SemanticPose::Resolve. The objects that are
+  /// generated on first access, with ParserConfig::LazyDomLoading or
+  /// ParserConfig::WorldsOnDemand, are generated once, by the first thread
+  /// that accesses them, and accessing them afterwards takes no lock. The
+  /// element trees may be read with the const methods of Element that read
+  /// without copying, which are Element::Get, Element::HasElement,
+  /// Element::HasAttribute, Element::ToString and Element::Visit. The
+  /// other methods, such as Element::FindElement and
+  /// Element::GetFirstElement, may copy the content that a copy-on-write
+  /// clone shares, as described in Element::CopyOnWriteClone, and
+  /// Element::GetElement adds missing children. Loading, the non-const
+  /// methods, and LoadDeferred when the elements are released, must not
+  /// run while other threads read the root.
   class SDFORMAT_VISIBLE Root
   {
     /// \brief Default constructor
@@ -66,6 +94,77 @@ namespace sdf
     /// an error code and message. An empty vector indicates no error.
     public: Errors Load(const std::string &_filename);
 
+    /// \brief Parse the given SDF file, and generate objects based on types
+    /// specified in the SDF file.
+    /// \param[in] _filename Name of the SDF file to parse.
+    /// \param[in] _config Custom parser configuration
+    /// \return Errors, which is a vector of Error objects. Each Error includes
+    /// an error code and message. An empty vector indicates no error.
+    public: Errors Load(const std::string &_filename,
+                        const ParserConfig &_config);
+
+    /// \brief Load the file given to the last call of
+    /// Load(_filename, _config) again, if any of the files it was read
+    /// from changed, as told by their modification time. The configuration
+    /// of that call is used again.
+    ///
+    /// The file is read again, but the files it includes that did not
+    /// change are taken from the include cache of the configuration, if it
+    /// has one, see ParserConfig::SetIncludeCache. When the loaded file
+    /// itself did not change, only the top level worlds, models, lights and
+    /// actors whose included files changed are loaded again, including
+    /// their frame graphs. The other objects are kept, and keep referring
+    /// to the elements of the previous document. Otherwise, or if the
+    /// previous load had errors, or if a reloaded object was renamed, the
+    /// whole document is loaded again.
+    /// \return Errors, which is a vector of Error objects. Each Error includes
+    /// an error code and message. An empty vector indicates no error, or
+    /// that no file changed.
+    public: Errors Reload();
+
+    /// \brief Apply a patch to a loaded world, updating only the models
+    /// that the patch changes, their elements and the pose graph of the
+    /// world, instead of loading the world again. The patch is an SDFormat
+    /// fragment such as:
+    ///
+    ///     <patch world="default">
+    ///       <add><model name="box">...</model></add>
+    ///       <replace><model name="robot">...</model></replace>
+    ///       <remove name="table"/>
+    ///       <pose name="robot" relative_to="world">1 0 0 0 0 0</pose>
+    ///     </patch>
+    ///
+    /// The operations are applied in order. <add> adds its models to the
+    /// world, <replace> replaces the models with the same names, <remove>
+    /// removes a model, and <pose> sets the pose of a model or frame of the
+    /// world, as World::UpdateFramePose. The world attribute may be omitted
+    /// if there is a single world. Models are read with the version of
+    /// this root, and their includes are resolved with _config.
+    /// \param[in] _patch The patch.
+    /// \param[in] _config Custom parser configuration.
+    /// \return Errors, which is a vector of Error objects. Each Error includes
+    /// an error code and message. An empty vector indicates no error. The
+    /// operations before the first one with errors are applied, and the
+    /// others are not.
+    public: Errors ApplyPatch(const std::string &_patch,
+                              const ParserConfig &_config = ParserConfig());
+
+    /// \brief Start loading the given SDF file on another thread, like
+    /// Load(_filename, _config). The returned handle waits for the load,
+    /// cancels it and gets its errors. This root must not be used or
+    /// destroyed until the load is finished, and the handle waits for it
+    /// when destroyed.
+    ///
+    /// The progress of the load is reported through
+    /// ParserConfig::ProgressCallback, on the loading threads. The load
+    /// stops when LoadHandle::Cancel is called or when
+    /// ParserConfig::CancelCallback returns true.
+    /// \param[in] _filename Name of the SDF file to parse.
+    /// \param[in] _config Custom parser configuration, which is copied.
+    /// \return The handle of the load.
+    public: LoadHandle LoadAsync(const std::string &_filename,
+                                 const ParserConfig &_config = ParserConfig());
+
     /// \brief Parse the given SDF string, and generate objects based on types
     /// specified in the SDF file.
     /// \param[in] _sdf SDF string to parse.
@@ -73,6 +172,66 @@ namespace sdf
     /// an error code and message. An empty vector indicates no error.
     public: Errors LoadSdfString(const std::string &_sdf);
 
+    /// \brief Parse the given SDF string, and generate objects based on types
+    /// specified in the SDF file.
+    /// \param[in] _sdf SDF string to parse.
+    /// \param[in] _config Custom parser configuration
+    /// \return Errors, which is a vector of Error objects. Each Error includes
+    /// an error code and message. An empty vector indicates no error.
+    public: Errors LoadSdfString(const std::string &_sdf,
+                                 const ParserConfig &_config);
+
+    /// \brief Parse SDF from a buffer that is not held by a std::string,
+    /// such as a shared memory segment, and generate objects based on types
+    /// specified in it. The buffer is parsed in place if its last byte is a
+    /// null character, as described in sdf::readString.
+    /// \param[in] _data SDF to parse.
+    /// \param[in] _size Size of _data in bytes.
+    /// \param[in] _config Custom parser configuration
+    /// \return Errors, which is a vector of Error objects. Each Error includes
+    /// an error code and message. An empty vector indicates no error.
+    public: Errors LoadSdfString(const char *_data, std::size_t _size,
+                                 const ParserConfig &_config = ParserConfig());
+
+    /// \brief Load a binary SDFormat file written by SaveBinary, and generate
+    /// objects based on types specified in it. The file already contains
+    /// the converted elements, with the included models expanded, so it is
+    /// loaded without parsing xml, converting it or resolving includes.
+    /// The file is mapped in memory when possible.
+    /// \param[in] _filename Name of the binary file.
+    /// \return Errors, which is a vector of Error objects. Each Error includes
+    /// an error code and message. An empty vector indicates no error.
+    public: Errors LoadBinary(const std::string &_filename);
+
+    /// \brief Load a binary SDFormat file written by SaveBinary, and generate
+    /// objects based on types specified in it.
+    /// \param[in] _filename Name of the binary file.
+    /// \param[in] _config Custom parser configuration. Only the options of
+    /// generating the objects, such as ParserConfig::LazyDomLoading, apply.
+    /// \return Errors, which is a vector of Error objects. Each Error includes
+    /// an error code and message. An empty vector indicates no error.
+    public: Errors LoadBinary(const std::string &_filename,
+                              const ParserConfig &_config);
+
+    /// \brief Write the elements of the loaded document to a binary file,
+    /// which can be loaded faster than the SDFormat file with LoadBinary.
+    /// The file can only be loaded by the same version of this library, on
+    /// a machine with the same byte order.
+    /// \param[in] _filename Name of the binary file.
+    /// \return Errors, which is a vector of Error objects. Each Error includes
+    /// an error code and message. An empty vector indicates no error.
+    public: Errors SaveBinary(const std::string &_filename) const;
+
+    /// \brief Write the worlds and models of this root, with their links,
+    /// joints and sensors and their resolved poses, to a flat buffer. Other
+    /// processes read the buffer in place with FlatRoot, without parsing
+    /// it, after receiving it through shared memory or a file that they
+    /// map in memory.
+    /// \param[out] _buffer The buffer.
+    /// \return Errors of resolving poses. A pose that cannot be resolved is
+    /// written as its raw pose.
+    public: Errors WriteFlat(std::string &_buffer) const;
+
     /// \brief Parse the given SDF pointer, and generate objects based on types
     /// specified in the SDF file.
     /// \param[in] _sdf SDF pointer to parse.
@@ -80,6 +239,45 @@ namespace sdf
     /// an error code and message. An empty vector indicates no error.
     public: Errors Load(const SDFPtr _sdf);
 
+    /// \brief Parse the given SDF pointer, and generate objects based on types
+    /// specified in the SDF file.
+    /// \param[in] _sdf SDF pointer to parse.
+    /// \param[in] _config Custom parser configuration. When
+    /// ParserConfig::LazyDomLoading is true, the objects are generated the
+    /// first time they are accessed.
+    /// \return Errors, which is a vector of Error objects. Each Error includes
+    /// an error code and message. An empty vector indicates no error.
+    public: Errors Load(const SDFPtr _sdf, const ParserConfig &_config);
+
+    /// \brief Generate the objects that have not been accessed yet, when
+    /// loaded with ParserConfig::LazyDomLoading, and read the worlds that
+    /// were not read yet, when loaded with ParserConfig::WorldsOnDemand.
+    /// This can be used to validate the whole document on demand.
+    /// \return The errors of generating every world, model, light and
+    /// actor, including the ones generated before this call. The vector is
+    /// empty if there are no errors, or if the objects were generated by
+    /// Load, which already returned their errors. With
+    /// ParserConfig::ReleaseElements, this releases the element tree, so it
+    /// must not be called while other threads read the root.
+    public: Errors LoadDeferred() const;
+
+    /// \brief Read and load a world that was not accessed yet, when loaded
+    /// from a file with ParserConfig::WorldsOnDemand, so that only the
+    /// worlds that are used are read. Otherwise the world was already
+    /// loaded, and its errors were returned by Load.
+    /// \param[in] _index Index of the world.
+    /// \return The errors of reading and loading the world, including when
+    /// it was read before this call, or an error if the world does not
+    /// exist.
+    public: Errors LoadWorld(const uint64_t _index) const;
+
+    /// \brief Read and load a world that was not accessed yet, as
+    /// LoadWorld(uint64_t).
+    /// \param[in] _name Name of the world.
+    /// \return The errors of reading and loading the world, or an error if
+    /// the world does not exist.
+    public: Errors LoadWorld(const std::string &_name) const;
+
     /// \brief Get the SDF version specified in the parsed file or SDF
     /// pointer.
     /// \return SDF version string.
@@ -105,7 +303,7 @@ namespace sdf
     /// \brief Get whether a world name exists.
     /// \param[in] _name Name of the world to check.
     /// \return True if there exists a world with the given name.
-    public: bool WorldNameExists(const std::string &_name) const;
+    public: bool WorldNameExists(std::string_view _name) const;
 
     /// \brief Get the number of models.
     /// \return Number of models contained in this Root object.
@@ -121,7 +319,7 @@ namespace sdf
     /// \brief Get whether a model name exists.
     /// \param[in] _name Name of the model to check.
     /// \return True if there exists a model with the given name.
-    public: bool ModelNameExists(const std::string &_name) const;
+    public: bool ModelNameExists(std::string_view _name) const;
 
     /// \brief Get the number of lights.
     /// \return Number of lights contained in this Root object.
@@ -137,7 +335,16 @@ namespace sdf
     /// \brief Get whether a light name exists.
     /// \param[in] _name Name of the light to check.
     /// \return True if there exists a light with the given name.
-    public: bool LightNameExists(const std::string &_name) const;
+    public: bool LightNameExists(std::string_view _name) const;
+
+    /// \brief Collect the lights of this root for culling, as described in
+    /// LightCulling. The lights of a root are not part of a world, so their
+    /// raw poses are taken to be in the world frame.
+    /// \param[out] _culling The light culling.
+    /// \param[in] _cellSize Size of the cells of the grid that the lights
+    /// are assigned to, or 0 for no grid.
+    public: void ResolveLightCulling(LightCulling &_culling,
+                                     double _cellSize = 0) const;
 
     /// \brief Get the number of actors.
     /// \return Number of actors contained in this Root object.
@@ -153,14 +360,86 @@ namespace sdf
     /// \brief Get whether an actor name exists.
     /// \param[in] _name Name of the actor to check.
     /// \return True if there exists an actor with the given name.
-    public: bool ActorNameExists(const std::string &_name) const;
+    public: bool ActorNameExists(std::string_view _name) const;
+
+    /// \brief Get a link based on its fully scoped name. The first part of
+    /// the name is the name of a world, in which case the rest is resolved
+    /// by World::LinkByScopedName, or else the name of a model, such as
+    /// "robot::arm::gripper::finger_link". Each part is found in constant
+    /// time.
+    /// \param[in] _name Scoped name of the link.
+    /// \return Pointer to the link. Nullptr if the name does not exist.
+    public: const Link *LinkByScopedName(const std::string &_name) const;
+
+    /// \brief Get a joint based on its fully scoped name, as in
+    /// LinkByScopedName.
+    /// \param[in] _name Scoped name of the joint.
+    /// \return Pointer to the joint. Nullptr if the name does not exist.
+    public: const Joint *JointByScopedName(const std::string &_name) const;
+
+    /// \brief Get an explicit frame based on its fully scoped name, as in
+    /// LinkByScopedName. A world name followed by the name of one of its
+    /// frames refers to that frame.
+    /// \param[in] _name Scoped name of the frame.
+    /// \return Pointer to the frame. Nullptr if the name does not exist.
+    public: const Frame *FrameByScopedName(const std::string &_name) const;
 
     /// \brief Get a pointer to the SDF element that was generated during
     /// load.
     /// \return SDF element pointer. The value will be nullptr if Load has
-    /// not been called.
+    /// not been called, or if the elements were released as enabled by
+    /// ParserConfig::ReleaseElements.
     public: sdf::ElementPtr Element() const;
 
+    /// \brief Get the approximate memory used by the element tree of the
+    /// loaded document, in total and by element name. The memory of the DOM
+    /// objects is not included.
+    /// \return The footprint, which is empty if there is no element tree.
+    /// \sa Element::MemoryFootprint
+    public: TreeFootprint MemoryFootprint() const;
+
+    /// \brief Release the memory that the loaded document keeps for
+    /// growth, for long-lived processes that keep it after loading: the
+    /// capacity of the vectors of the DOM objects and of the element tree,
+    /// and the caches that are built again on use, such as the spatial
+    /// indices of the worlds. DOM objects generated lazily or read on
+    /// demand, as enabled by ParserConfig::SetLazyDomLoading and
+    /// ParserConfig::SetWorldsOnDemand, are not compacted. To also keep the
+    /// private data of the DOM objects in contiguous blocks, load them with
+    /// ParserConfig::SetArenaAllocation.
+    ///
+    /// It must not be called while other threads use this root, and the
+    /// pointers to its DOM objects are invalidated, as by Load.
+    /// \return Approximate number of bytes released: the decrease of
+    /// MemoryFootprint, plus the capacity released by the DOM objects.
+    public: std::size_t Compact();
+
+    /// \brief Get the counters of the work done by the last call to Load or
+    /// LoadSdfString, such as the number of elements created and the time
+    /// spent parsing XML, to watch the efficiency of loading in production.
+    /// \return The statistics, which are all 0 if nothing was loaded.
+    public: sdf::LoadStatistics LoadStatistics() const;
+
+    /// \brief Resolve the meshes, material textures and actor animations
+    /// referenced by the DOM objects, each once, and list the objects that
+    /// reference each of them. Relative URIs are first looked up next to
+    /// the file that references them, and the others are resolved with
+    /// sdf::findFile, including its callbacks. The URIs left to findFile
+    /// are requested with sdf::requestFiles before they are resolved, so
+    /// that a batch callback can fetch them concurrently.
+    /// \param[in] _threadCount Number of threads resolving URIs, or 0 for
+    /// one per hardware thread.
+    /// \return The assets, which are listed once per resolved path.
+    public: AssetManifest Assets(unsigned int _threadCount = 1) const;
+
+    /// \brief Load DOM objects from an element tree, without applying
+    /// ParserConfig::MaxErrors and ParserConfig::ErrorCallback, which are
+    /// applied once by the public Load functions.
+    /// \param[in] _sdf SDF Element pointer.
+    /// \param[in] _config Parser configuration.
+    /// \return Errors.
+    private: Errors LoadDom(SDFPtr _sdf, const ParserConfig &_config);
+
     /// \brief Private data pointer
     private: RootPrivate *dataPtr = nullptr;
   };
@@ -17,12 +17,18 @@
 #ifndef SDFIMPL_HH_
 #define SDFIMPL_HH_
 
+#include <chrono>
+#include <cstddef>
 #include <functional>
+#include <future>
 #include <memory>
+#include <ostream>
 #include <string>
+#include <vector>
 
 #include "sdf/Param.hh"
 #include "sdf/Element.hh"
+#include "sdf/PrintConfig.hh"
 #include "sdf/sdf_config.h"
 #include "sdf/system_util.hh"
 #include "sdf/Types.hh"
@@ -44,6 +50,7 @@ namespace sdf
 
   class SDFORMAT_VISIBLE SDF;
   class SDFPrivate;
+  class ModelIndex;
 
   /// \def SDFPtr
   /// \brief Shared pointer to SDF
@@ -53,6 +60,20 @@ namespace sdf
   /// \{
 
   /// \brief Find the absolute path of a file.
+  ///
+  /// The result of searching the URI paths, install paths, SDF_PATH and
+  /// the working directory is cached, including files that were not found,
+  /// so that a file is only searched once. The cache is cleared by
+  /// addURIPath, setFindCallback, setFindBatchCallback and
+  /// clearFindFileCache. The callback of setFindCallback itself is called on
+  /// every lookup that does not find a file.
+  ///
+  /// The URI paths and the SDF_PATH environment variable are parsed once,
+  /// and again after each of the functions above and setModelIndex, so
+  /// changes to SDF_PATH are only seen after clearFindFileCache. These
+  /// functions can be called while files are found on other threads, which
+  /// do not wait for them: a lookup uses the paths and callbacks that were
+  /// registered when it started.
   /// \param[in] _filename Name of the file to find.
   /// \param[in] _searchLocalPath True to search for the file in the current
   /// working directory.
@@ -66,11 +87,37 @@ namespace sdf
 
   /// \brief Associate paths to a URI.
   /// Example paramters: "model://", "/usr/share/models:~/.gazebo/models"
+  ///
+  /// A path can also be a zip or tar archive, such as a packaged library of
+  /// models, which is mounted instead of being extracted: its members are
+  /// read from the memory-mapped archive through the index of the archive,
+  /// at paths below the path of the archive, as if it was a directory.
+  /// findFile, getModelFilePath, readFile and the functions of
+  /// sdf::filesystem see these paths, so that `model://box` resolves to
+  /// "/path/models.zip/box" for an archive with a box/model.config member.
+  /// Zip members can be stored or compressed with deflate, which needs
+  /// libsdformat to be built with zlib. Tar archives cannot be compressed
+  /// as a whole. Archives stay mounted for the life of the process.
   /// \param[in] _uri URI that will be mapped to _path
   /// \param[in] _path Colon separated set of paths.
   SDFORMAT_VISIBLE
   void addURIPath(const std::string &_uri, const std::string &_path);
 
+  /// \brief Set the model repository index that findFile and
+  /// getModelFilePath consult before searching the filesystem. findFile
+  /// resolves the `model://name` URIs of the indexed models, before the URI
+  /// paths of addURIPath. Clears the cache of findFile, which should also
+  /// be cleared after the index is scanned or loaded again.
+  /// \param[in] _index The index, or nullptr to not use one, which is the
+  /// default.
+  SDFORMAT_VISIBLE
+  void setModelIndex(std::shared_ptr<ModelIndex> _index);
+
+  /// \brief Get the model repository index set with setModelIndex.
+  /// \return The index, or nullptr.
+  SDFORMAT_VISIBLE
+  std::shared_ptr<ModelIndex> modelIndex();
+
   /// \brief Set the callback to use when SDF can't find a file.
   /// The callback should return a complete path to the requested file, or
   /// and empty string if the file was not found in the callback.
@@ -78,6 +125,76 @@ namespace sdf
   SDFORMAT_VISIBLE
   void setFindCallback(std::function<std::string (const std::string &)> _cb);
 
+  /// \brief Callback that resolves several files that findFile did not
+  /// find at once. It receives the file names, and returns one future per
+  /// file name, in the same order, whose value is the complete path of the
+  /// file or an empty string if it was not found. It should return without
+  /// waiting for the files, so that it can resolve them concurrently, for
+  /// example by downloading them in parallel.
+  using FindBatchCallback = std::function<
+      std::vector<std::shared_future<std::string>>(
+          const std::vector<std::string> &)>;
+
+  /// \brief Set the callback used to resolve files that SDF can't find,
+  /// several at a time. The parser gives it the URIs of all the <include>
+  /// elements of an element before reading them, and findFile only waits
+  /// for the result of a file when it is asked for it. A file that findFile
+  /// is asked for without being requested first is resolved in a batch of
+  /// its own. The callback of setFindCallback is still used for the files
+  /// that this callback does not find.
+  ///
+  /// Results are kept like the other results of findFile, so a file is
+  /// only requested once until the cache is cleared or times out.
+  /// \param[in] _cb The callback function, or nullptr to not use one,
+  /// which is the default.
+  /// \sa requestFiles
+  SDFORMAT_VISIBLE
+  void setFindBatchCallback(FindBatchCallback _cb);
+
+  /// \brief Start resolving files with the callback of setFindBatchCallback,
+  /// without waiting for them. The files that findFile finds without
+  /// callbacks, and those that are already requested, are skipped. Does
+  /// nothing if there is no batch callback.
+  /// \param[in] _filenames Names of the files that findFile will be asked
+  /// for.
+  SDFORMAT_VISIBLE
+  void requestFiles(const std::vector<std::string> &_filenames);
+
+  /// \brief Clear the cached results of findFile, for example after files
+  /// were added to or removed from the search paths, and read the SDF_PATH
+  /// environment variable again.
+  SDFORMAT_VISIBLE
+  void clearFindFileCache();
+
+  /// \brief Set how long findFile uses a cached result before searching
+  /// for the file again. The default of zero keeps results until the cache
+  /// is cleared.
+  /// \param[in] _timeout Time after which a cached result is revalidated.
+  SDFORMAT_VISIBLE
+  void setFindFileCacheTimeout(std::chrono::steady_clock::duration _timeout);
+
+  /// \brief Set a directory in which sdf::readFile caches converted
+  /// documents.
+  ///
+  /// When set, sdf::readFile stores the result of converting a URDF file or
+  /// an SDFormat file older than SDF::Version() in this directory, keyed by
+  /// a hash of the file content and the version of libsdformat. A later
+  /// read of a file with the same content loads the converted document
+  /// instead of running the URDF and version converters again. Included
+  /// files are cached separately, since <include> elements are resolved
+  /// after the conversion. The cache is disabled by default.
+  /// \param[in] _path Directory of the cache. It is created if its parent
+  /// exists. An empty string disables the cache.
+  SDFORMAT_VISIBLE
+  void setConversionCacheDirectory(const std::string &_path);
+
+  /// \brief Get the directory in which sdf::readFile caches converted
+  /// documents.
+  /// \return The directory, or an empty string if the cache is disabled.
+  /// \sa setConversionCacheDirectory
+  SDFORMAT_VISIBLE
+  std::string conversionCacheDirectory();
+
 
   /// \brief Base SDF class
   class SDFORMAT_VISIBLE SDF
@@ -86,14 +203,45 @@ namespace sdf
     /// \brief Destructor
     public: ~SDF();
     public: void PrintDescription();
+
+    /// \brief Write the description of the specification to a stream, as
+    /// it is printed by PrintDescription.
+    /// \param[out] _out Stream to write to.
+    public: void PrintDescription(std::ostream &_out);
+
     public: void PrintValues();
     public: void PrintDoc();
+
+    /// \brief Write the html documentation of the specification to a
+    /// stream, as it is printed by PrintDoc, without building the panes in
+    /// memory first.
+    /// \param[out] _out Stream to write to.
+    public: void PrintDoc(std::ostream &_out);
+
     public: void Write(const std::string &_filename);
+
+    /// \brief Write the document to a file.
+    /// \param[in] _filename Path of the file.
+    /// \param[in] _config Options that control the representation.
+    public: void Write(const std::string &_filename,
+                       const PrintConfig &_config);
+
     public: std::string ToString() const;
 
+    /// \brief Convert the document to a string.
+    /// \param[in] _config Options that control the representation.
+    /// \return The string representation.
+    public: std::string ToString(const PrintConfig &_config) const;
+
     /// \brief Set SDF values from a string
     public: void SetFromString(const std::string &_sdfData);
 
+    /// \brief Set SDF values from a buffer, which is parsed in place if its
+    /// last byte is a null character, as described in sdf::readString.
+    /// \param[in] _data SDF to parse.
+    /// \param[in] _size Size of _data in bytes.
+    public: void SetFromString(const char *_data, std::size_t _size);
+
     /// \brief Clear the data in this object.
     public: void Clear();
 
@@ -121,11 +269,15 @@ namespace sdf
     /// \return Spec version string.
     public: const std::string &OriginalVersion() const;
 
-    /// \brief Get the version
+    /// \brief Get the version that documents are read as on the calling
+    /// thread. It is the version of the ParserConfig of a read in progress
+    /// on the thread, if it sets one, or else the process-wide version.
     /// \return The version as a string
+    /// \sa ParserConfig::SetSpecVersion
     public: static std::string Version();
 
-    /// \brief Set the version string
+    /// \brief Set the process-wide version string. It may be called while
+    /// other threads read documents, which then use either version.
     /// \param[in] _version SDF version string.
     public: static void Version(const std::string &_version);
 
@@ -153,10 +305,6 @@ namespace sdf
     /// \internal
     /// \brief Pointer to private data.
     private: std::unique_ptr<SDFPrivate> dataPtr;
-
-    /// \brief The SDF version. Set to SDF_VERSION by default, or through
-    /// the Version function at runtime.
-    private: static std::string version;
   };
   /// \}
   }
@@ -41,6 +41,7 @@ namespace sdf
 
   // Forward declare private data class.
   class SemanticPosePrivate;
+  struct FrameIds;
   struct PoseRelativeToGraph;
 
   /// \brief SemanticPose is a data structure that can be used by different
@@ -79,11 +80,15 @@ namespace sdf
     /// \param[in] _defaultResolveTo Default frame to resolve-to in Resolve()
     /// if no frame is specified.
     /// \param[in] _graph Weak pointer to PoseRelativeToGraph.
+    /// \param[in] _frameIds Vertex ids in _graph of the relative-to frame,
+    /// or of _defaultResolveTo if _relativeTo is empty, and of
+    /// _defaultResolveTo, as found by the DOM object when its graph was set.
     private: SemanticPose(
         const ignition::math::Pose3d &_pose,
         const std::string &_relativeTo,
         const std::string &_defaultResolveTo,
-        std::weak_ptr<const sdf::PoseRelativeToGraph> _graph);
+        std::weak_ptr<const sdf::PoseRelativeToGraph> _graph,
+        const FrameIds &_frameIds);
 
     /// \brief Destructor
     public: ~SemanticPose();
@@ -140,7 +140,7 @@ namespace sdf
     /// \brief Get the name of the sensor.
     /// The name of the sensor should be unique within the scope of a World.
     /// \return Name of the sensor.
-    public: std::string Name() const;
+    public: const std::string &Name() const;
 
     /// \brief Set the name of the sensor.
     /// The name of the sensor should be unique within the scope of a World.
@@ -149,7 +149,7 @@ namespace sdf
 
     /// \brief Get the topic on which sensor data should be published.
     /// \return Topic for this sensor's data.
-    public: std::string Topic() const;
+    public: const std::string &Topic() const;
 
     /// \brief Set the topic on which sensor data should be published.
     /// \param[in] _topic Topic for this sensor's data.
@@ -0,0 +1,101 @@
+/*
+ * Copyright 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef SDF_SENSORSCHEDULE_HH_
+#define SDF_SENSORSCHEDULE_HH_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "sdf/sdf_config.h"
+
+namespace sdf
+{
+  // Inline bracket to help doxygen filtering.
+  inline namespace SDF_VERSION_NAMESPACE {
+  //
+
+  /// \brief The sensors of a world grouped by their update rate, so that a
+  /// simulator updates the sensors that are due at a step by visiting the
+  /// due groups only, instead of checking the rate of each sensor. It is
+  /// filled by World::ResolveSensorSchedule.
+  ///
+  /// The sensors of group g are at positions [GroupBegin(g), GroupEnd(g))
+  /// of the index arrays. The groups are sorted by rate, and the first group
+  /// has rate 0 if there are sensors without update rate, which are
+  /// updated at every step.
+  struct SensorSchedule
+  {
+    /// \brief Index of the model of each sensor in World::ModelByIndex.
+    std::vector<uint64_t> modelIndices;
+
+    /// \brief Index of the link of each sensor in Model::LinkByIndex.
+    std::vector<uint64_t> linkIndices;
+
+    /// \brief Index of each sensor in Link::SensorByIndex.
+    std::vector<uint64_t> sensorIndices;
+
+    /// \brief Update rate of each group in Hz.
+    std::vector<double> rates;
+
+    /// \brief Position of the first sensor of each group in the index
+    /// arrays, followed by the number of sensors.
+    std::vector<std::size_t> groupOffsets;
+
+    /// \brief Get the number of groups.
+    /// \return Number of groups.
+    std::size_t GroupCount() const
+    {
+      return this->rates.size();
+    }
+
+    /// \brief Get the position of the first sensor of a group.
+    /// \param[in] _group The group.
+    /// \return Position in the index arrays.
+    std::size_t GroupBegin(const std::size_t _group) const
+    {
+      return this->groupOffsets[_group];
+    }
+
+    /// \brief Get the position after the last sensor of a group.
+    /// \param[in] _group The group.
+    /// \return Position in the index arrays.
+    std::size_t GroupEnd(const std::size_t _group) const
+    {
+      return this->groupOffsets[_group + 1];
+    }
+
+    /// \brief Get whether the sensors of a group are due in a step, which is
+    /// when a multiple of their update period falls in (_prevTime, _time].
+    /// Groups of rate 0 are due at every step.
+    /// \param[in] _group The group.
+    /// \param[in] _prevTime Simulation time of the previous step in seconds.
+    /// \param[in] _time Simulation time of the step in seconds.
+    /// \return True if the group is due.
+    bool GroupDue(const std::size_t _group, const double _prevTime,
+                  const double _time) const
+    {
+      const double rate = this->rates[_group];
+      if (rate <= 0)
+        return true;
+      return static_cast<int64_t>(_time * rate) >
+          static_cast<int64_t>(_prevTime * rate);
+    }
+  };
+  }
+}
+#endif
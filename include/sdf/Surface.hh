@@ -17,6 +17,7 @@
 #ifndef SDF_SURFACE_HH_
 #define SDF_SURFACE_HH_
 
+#include <ignition/math/Vector3.hh>
 #include "sdf/Element.hh"
 #include "sdf/Types.hh"
 #include "sdf/sdf_config.h"
@@ -31,6 +32,60 @@ namespace sdf
   class ContactPrivate;
   class SurfacePrivate;
 
+  /// \brief Friction and bounce parameters of a surface, from the
+  /// <friction> and <bounce> elements, with the defaults of the
+  /// specification for the values that are not set.
+  struct SurfaceParameters
+  {
+    /// \brief Coefficient of friction in the first friction direction,
+    /// from <friction><ode><mu>.
+    double mu = 1.0;
+
+    /// \brief Coefficient of friction in the second friction direction,
+    /// from <friction><ode><mu2>.
+    double mu2 = 1.0;
+
+    /// \brief First friction direction in the collision frame, from
+    /// <friction><ode><fdir1>. A zero vector means the world frame.
+    ignition::math::Vector3d fdir1 = ignition::math::Vector3d::Zero;
+
+    /// \brief Force dependent slip in the first friction direction, from
+    /// <friction><ode><slip1>.
+    double slip1 = 0.0;
+
+    /// \brief Force dependent slip in the second friction direction, from
+    /// <friction><ode><slip2>.
+    double slip2 = 0.0;
+
+    /// \brief Torsional friction coefficient, from
+    /// <friction><torsional><coefficient>.
+    double torsionalCoefficient = 1.0;
+
+    /// \brief Whether the torsional friction uses patchRadius instead of
+    /// surfaceRadius, from <friction><torsional><use_patch_radius>.
+    bool usePatchRadius = true;
+
+    /// \brief Radius of the contact patch for torsional friction, from
+    /// <friction><torsional><patch_radius>.
+    double patchRadius = 0.0;
+
+    /// \brief Radius of the surface for torsional friction, from
+    /// <friction><torsional><surface_radius>.
+    double surfaceRadius = 0.0;
+
+    /// \brief Force dependent slip for torsional friction, from
+    /// <friction><torsional><ode><slip>.
+    double torsionalSlip = 0.0;
+
+    /// \brief Coefficient of restitution, from
+    /// <bounce><restitution_coefficient>.
+    double restitutionCoefficient = 0.0;
+
+    /// \brief Velocity below which there is no bounce, from
+    /// <bounce><threshold>.
+    double bounceThreshold = 100000.0;
+  };
+
   /// \brief Contact information for a surface.
   class SDFORMAT_VISIBLE Contact
   {
@@ -79,6 +134,17 @@ namespace sdf
     /// \brief Set the collide bitmask parameter.
     public: void SetCollideBitmask(const uint16_t _bitmask);
 
+    /// \brief Get the category bitmask parameter. Two collisions collide
+    /// if the category bitmask of either one shares a bit with the collide
+    /// bitmask of the other.
+    /// \return The category bitmask, which is the collide bitmask if it was
+    /// not set.
+    public: uint16_t CategoryBitmask() const;
+
+    /// \brief Set the category bitmask parameter.
+    /// \param[in] _bitmask The category bitmask.
+    public: void SetCategoryBitmask(const uint16_t _bitmask);
+
     /// \brief Private data pointer.
     private: ContactPrivate *dataPtr;
   };
@@ -133,6 +199,14 @@ namespace sdf
     /// \param[in] _cont The contact object.
     public: void SetContact(const sdf::Contact &_contact);
 
+    /// \brief Get the friction and bounce parameters.
+    /// \return The parameters.
+    public: const SurfaceParameters &Parameters() const;
+
+    /// \brief Set the friction and bounce parameters.
+    /// \param[in] _parameters The parameters.
+    public: void SetParameters(const SurfaceParameters &_parameters);
+
     /// \brief Private data pointer.
     private: SurfacePrivate *dataPtr;
   };
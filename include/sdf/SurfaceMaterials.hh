@@ -0,0 +1,107 @@
+/*
+ * Copyright 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef SDF_SURFACEMATERIALS_HH_
+#define SDF_SURFACEMATERIALS_HH_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <ignition/math/Vector3.hh>
+
+#include "sdf/sdf_config.h"
+
+namespace sdf
+{
+  // Inline bracket to help doxygen filtering.
+  inline namespace SDF_VERSION_NAMESPACE {
+  //
+
+  /// \brief The distinct friction and bounce parameters of the collisions
+  /// of a world or model, so that engines compute their pairwise friction
+  /// and restitution tables over the distinct materials instead of over
+  /// the collisions. It is filled by Model::ResolveSurfaceMaterials and
+  /// World::ResolveSurfaceMaterials.
+  ///
+  /// Collisions whose Surface::Parameters are equal share a material. The
+  /// parameter arrays have one entry per material, with the fields of
+  /// SurfaceParameters, and the materials are in the order of their first
+  /// collision.
+  struct SurfaceMaterials
+  {
+    /// \brief Index of the model of each collision in World::ModelByIndex,
+    /// or 0 when filled by Model::ResolveSurfaceMaterials.
+    std::vector<uint64_t> modelIndices;
+
+    /// \brief Index of the link of each collision in Model::LinkByIndex.
+    std::vector<uint64_t> linkIndices;
+
+    /// \brief Index of each collision in Link::CollisionByIndex.
+    std::vector<uint64_t> collisionIndices;
+
+    /// \brief Material of each collision.
+    std::vector<uint32_t> materials;
+
+    /// \brief Coefficient of friction in the first friction direction of
+    /// each material.
+    std::vector<double> mu;
+
+    /// \brief Coefficient of friction in the second friction direction of
+    /// each material.
+    std::vector<double> mu2;
+
+    /// \brief First friction direction of each material, in the frame of
+    /// its collisions.
+    std::vector<ignition::math::Vector3d> fdir1;
+
+    /// \brief Slip in the first friction direction of each material.
+    std::vector<double> slip1;
+
+    /// \brief Slip in the second friction direction of each material.
+    std::vector<double> slip2;
+
+    /// \brief Torsional friction coefficient of each material.
+    std::vector<double> torsionalCoefficients;
+
+    /// \brief Whether the torsional friction of each material uses its
+    /// patch radius instead of its surface radius.
+    std::vector<bool> usePatchRadius;
+
+    /// \brief Torsional patch radius of each material.
+    std::vector<double> patchRadii;
+
+    /// \brief Torsional surface radius of each material.
+    std::vector<double> surfaceRadii;
+
+    /// \brief Torsional slip of each material.
+    std::vector<double> torsionalSlips;
+
+    /// \brief Coefficient of restitution of each material.
+    std::vector<double> restitutionCoefficients;
+
+    /// \brief Bounce velocity threshold of each material.
+    std::vector<double> bounceThresholds;
+
+    /// \brief Get the number of materials.
+    /// \return Number of materials.
+    std::size_t MaterialCount() const
+    {
+      return this->mu.size();
+    }
+  };
+  }
+}
+#endif
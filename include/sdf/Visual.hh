@@ -79,7 +79,7 @@ namespace sdf
     /// \brief Get the name of the visual.
     /// The name of the visual must be unique within the scope of a Link.
     /// \return Name of the visual.
-    public: std::string Name() const;
+    public: const std::string &Name() const;
 
     /// \brief Set the name of the visual.
     /// The name of the visual must be unique within the scope of a Link.
@@ -176,15 +176,26 @@ namespace sdf
     public: sdf::ElementPtr Element() const;
 
     /// \brief Get a pointer to the visual's material properties. This can
-    /// be a nullptr if material properties have not been set.
+    /// be a nullptr if material properties have not been set. If
+    /// MaterialId is not 0, the material is shared with other visuals and
+    /// must not be modified.
     /// \return Pointer to the visual's material properties. Nullptr
     /// indicates that material properties have not been set.
     public: sdf::Material *Material() const;
 
-    /// \brief Set the visual's material
+    /// \brief Set the visual's material. The visual then has its own
+    /// material, even if it shared one before.
     /// \param[in] _material The material of the visual object
     public: void SetMaterial(const sdf::Material &_material);
 
+    /// \brief Get the identifier of the visual's material, when it is
+    /// shared with the other visuals that loaded an identical material, as
+    /// with ParserConfig::SetShareMaterials. Visuals with the same
+    /// identifier point to the same material, so renderers can batch them.
+    /// \return The identifier, unique in the process, or 0 if the visual
+    /// has its own material or none.
+    public: uint64_t MaterialId() const;
+
     /// \brief Get the visibility flags of a visual
     /// \return visibility flags
     public: uint32_t VisibilityFlags() const;
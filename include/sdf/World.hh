@@ -17,12 +17,17 @@
 #ifndef SDF_WORLD_HH_
 #define SDF_WORLD_HH_
 
+#include <cstddef>
 #include <string>
+#include <string_view>
+#include <vector>
+#include <ignition/math/Pose3.hh>
 #include <ignition/math/Vector3.hh>
 
 #include "sdf/Atmosphere.hh"
 #include "sdf/Element.hh"
 #include "sdf/Gui.hh"
+#include "sdf/ParserConfig.hh"
 #include "sdf/Scene.hh"
 #include "sdf/Types.hh"
 #include "sdf/sdf_config.h"
@@ -36,11 +41,35 @@ namespace sdf
 
   // Forward declare private data class.
   class Actor;
+  struct CollisionFilter;
   class Frame;
+  class Joint;
   class Light;
+  struct LightCulling;
+  class Link;
   class Model;
   class Physics;
+  struct RenderBatches;
+  struct SensorSchedule;
+  struct SurfaceMaterials;
   class WorldPrivate;
+  struct WorldPoses;
+
+  /// \enum ModelBoundsType
+  /// \brief The bounds of the models of a world used by World::ModelsInBox
+  /// and World::ModelsNear.
+  enum class ModelBoundsType
+  {
+    /// \brief The origin of the model frame.
+    ORIGIN = 0,
+
+    /// \brief The axis-aligned bounding box, in the world frame, of the
+    /// collisions of the links of the model, as in
+    /// Model::ResolveCollisionGeometry. A model without collisions is
+    /// bounded by its origin, and a model with an unbounded collision, such
+    /// as a plane, is in every region.
+    COLLISION = 1,
+  };
 
   class SDFORMAT_VISIBLE World
   {
@@ -76,9 +105,20 @@ namespace sdf
     /// an error code and message. An empty vector indicates no error.
     public: Errors Load(ElementPtr _sdf);
 
+    /// \brief Load the world based on a element pointer. This is *not* the
+    /// usual entry point. Typical usage of the SDF DOM is through the Root
+    /// object.
+    /// \param[in] _sdf The SDF Element pointer
+    /// \param[in] _config Parser configuration. Its ModelLoadThreadCount
+    /// sets the number of threads used to load the models, and its
+    /// Validation sets the checks that are run.
+    /// \return Errors, which is a vector of Error objects. Each Error includes
+    /// an error code and message. An empty vector indicates no error.
+    public: Errors Load(ElementPtr _sdf, const ParserConfig &_config);
+
     /// \brief Get the name of the world.
     /// \return Name of the world.
-    public: std::string Name() const;
+    public: const std::string &Name() const;
 
     /// \brief Set the name of the world.
     /// \param[in] _name Name of the world.
@@ -88,7 +128,7 @@ namespace sdf
     /// playback audio files. A value of "default" or an empty string
     /// indicates that the system's default audio device should be used.
     /// \return Audio device name.
-    public: std::string AudioDevice() const;
+    public: const std::string &AudioDevice() const;
 
     /// \brief Set the audio device name. See std::string AudioDevice() const
     /// for more information.
@@ -150,12 +190,33 @@ namespace sdf
     /// \brief Get a model based on a name.
     /// \param[in] _name Name of the model.
     /// \return Pointer to the model. Nullptr if the name does not exist.
-    public: const Model *ModelByName(const std::string &_name) const;
+    public: const Model *ModelByName(std::string_view _name) const;
+
+    /// \brief Get a link based on its name scoped by the name of its model,
+    /// such as "robot::arm::gripper::finger_link" for a link of a model
+    /// nested in the model "robot". The model and the link are each found
+    /// in constant time.
+    /// \param[in] _name Scoped name of the link.
+    /// \return Pointer to the link. Nullptr if the name does not exist.
+    public: const Link *LinkByScopedName(const std::string &_name) const;
+
+    /// \brief Get a joint based on its name scoped by the name of its
+    /// model, as in LinkByScopedName.
+    /// \param[in] _name Scoped name of the joint.
+    /// \return Pointer to the joint. Nullptr if the name does not exist.
+    public: const Joint *JointByScopedName(const std::string &_name) const;
+
+    /// \brief Get an explicit frame based on its scoped name. A name without
+    /// scope refers to a frame of this world, and a scoped name to a frame
+    /// of a model, as in LinkByScopedName.
+    /// \param[in] _name Scoped name of the frame.
+    /// \return Pointer to the frame. Nullptr if the name does not exist.
+    public: const Frame *FrameByScopedName(const std::string &_name) const;
 
     /// \brief Get whether a model name exists.
     /// \param[in] _name Name of the model to check.
     /// \return True if there exists a model with the given name.
-    public: bool ModelNameExists(const std::string &_name) const;
+    public: bool ModelNameExists(std::string_view _name) const;
 
     /// \brief Get the number of actors.
     /// \return Number of actors contained in this World object.
@@ -171,7 +232,7 @@ namespace sdf
     /// \brief Get whether an actor name exists.
     /// \param[in] _name Name of the actor to check.
     /// \return True if there exists an actor with the given name.
-    public: bool ActorNameExists(const std::string &_name) const;
+    public: bool ActorNameExists(std::string_view _name) const;
 
     /// \brief Get the number of explicit frames.
     /// \return Number of explicit frames contained in this World object.
@@ -189,12 +250,12 @@ namespace sdf
     /// \param[in] _name Name of the explicit frame.
     /// \return Pointer to the explicit frame. Nullptr if the name does not
     /// exist.
-    public: const Frame *FrameByName(const std::string &_name) const;
+    public: const Frame *FrameByName(std::string_view _name) const;
 
     /// \brief Get whether an explicit frame name exists.
     /// \param[in] _name Name of the explicit frame to check.
     /// \return True if there exists an explicit frame with the given name.
-    public: bool FrameNameExists(const std::string &_name) const;
+    public: bool FrameNameExists(std::string_view _name) const;
 
     /// \brief Get the number of lights.
     /// \return Number of lights contained in this World object.
@@ -210,7 +271,60 @@ namespace sdf
     /// \brief Get whether a light name exists.
     /// \param[in] _name Name of the light to check.
     /// \return True if there exists a light with the given name.
-    public: bool LightNameExists(const std::string &_name) const;
+    public: bool LightNameExists(std::string_view _name) const;
+
+    /// \brief Add a model to a world that is built programmatically. The
+    /// name index and the frame graphs are updated in place instead of
+    /// being rebuilt, so building a world of N models costs O(N). The frame
+    /// that the pose of the model is relative to must already be in the
+    /// world. The graphs are created by the first addition to a world that
+    /// was not loaded.
+    /// \param[in] _model The model, which is moved into the world only if
+    /// there are no errors.
+    /// \return Errors, which include a DUPLICATE_NAME error if the name of
+    /// the model is already used by a model or frame of the world.
+    public: Errors AddModel(Model &&_model);
+
+    /// \brief Replace the model of this world that has the same name as
+    /// another model, such as a new version of it. Only the pose of the
+    /// model is updated in the pose graph of the world, so the other models
+    /// and frames are not affected.
+    /// \param[in] _model The new model, which is moved into the world only
+    /// if there are no errors.
+    /// \return Errors, which include an ELEMENT_MISSING error if the world
+    /// has no model with the name of _model.
+    public: Errors ReplaceModel(Model &&_model);
+
+    /// \brief Remove a model from this world, and its frame from the graphs
+    /// of the world, without rebuilding them. The models that follow it in
+    /// ModelByIndex order are shifted.
+    /// \param[in] _name Name of the model.
+    /// \return Errors, which include an ELEMENT_MISSING error if the world
+    /// has no model with the name, or an error if the pose of another frame
+    /// is relative to the model or another frame is attached to it. The
+    /// model is not removed if there are errors.
+    public: Errors RemoveModel(const std::string &_name);
+
+    /// \brief Add an explicit frame to a world that is built
+    /// programmatically, in the same way as AddModel. The frame that it is
+    /// attached to must already be in the world.
+    /// \param[in] _frame The frame, which is moved into the world only if
+    /// there are no errors.
+    /// \return Errors.
+    public: Errors AddFrame(Frame &&_frame);
+
+    /// \brief Add a light to a world that is built programmatically. The
+    /// light is given the pose graph of the world.
+    /// \param[in] _light The light, which is moved into the world only if
+    /// its name is not used by another light of the world.
+    /// \return True if the light was added.
+    public: bool AddLight(Light &&_light);
+
+    /// \brief Add an actor to a world that is built programmatically.
+    /// \param[in] _actor The actor, which is moved into the world only if
+    /// its name is not used by another actor of the world.
+    /// \return True if the actor was added.
+    public: bool AddActor(Actor &&_actor);
 
     /// \brief Get a pointer to the atmosphere model associated with this
     /// world. A nullptr indicates that an atmosphere model has not been set.
@@ -260,14 +374,135 @@ namespace sdf
     ///// \sa uint64_t PhysicsCount() const
     public: const Physics *PhysicsByIndex(const uint64_t _index) const;
 
-    /// \brief Get the default physics profile.
+    /// \brief Get the default physics profile, which is the first profile
+    /// that is marked as default, or the first profile. It is found when
+    /// the world is loaded, so this does not search the profiles. Only the
+    /// profile selected by ParserConfig::SetPhysicsProfile is loaded, if
+    /// any.
     /// \return Pointer to the default physics profile.
     public: const Physics *PhysicsDefault() const;
 
     /// \brief Get whether a physics profile name exists.
     /// \param[in] _name Name of the physics profile to check.
     /// \return True if there exists a physics profile with the given name.
-    public: bool PhysicsNameExists(const std::string &_name) const;
+    public: bool PhysicsNameExists(std::string_view _name) const;
+
+    /// \brief Resolve the poses of all the frames of this world relative to
+    /// one frame of this world, in a single pass over the pose graph. This
+    /// gives the same poses as resolving the SemanticPose of each model and
+    /// frame to _relativeTo, without walking the graph once for each of them.
+    /// \param[out] _poses Resolved poses. The first pose is that of the
+    /// world frame, followed by the models in ModelByIndex order and the
+    /// frames in FrameByIndex order. It is not changed if there are errors.
+    /// \param[in] _relativeTo Name of the frame relative to which the poses
+    /// are resolved. The world frame is used if it is empty.
+    /// \return Errors.
+    public: Errors ResolveFramePoses(
+        std::vector<ignition::math::Pose3d> &_poses,
+        const std::string &_relativeTo = "") const;
+
+    /// \brief Resolve the poses in the world frame of all the models,
+    /// links, visuals, collisions, sensors and lights of this world, as
+    /// described in WorldPoses. This gives the same poses as resolving the
+    /// SemanticPose of each of them to the world frame, with one pass over
+    /// the pose graph of the world and one over that of each model instead
+    /// of one walk across both graphs per object.
+    /// \param[out] _poses The arrays. They are not changed if there are
+    /// errors.
+    /// \return Errors.
+    public: Errors ResolveObjectPoses(WorldPoses &_poses) const;
+
+    /// \brief Group the collisions of all the models of this world by their
+    /// category and collide bitmasks, and compute which groups collide, as
+    /// described in CollisionFilter. The collisions are in ModelByIndex
+    /// order, then in LinkByIndex order and then in CollisionByIndex order.
+    /// \param[out] _filter The filter.
+    public: void ResolveCollisionFilter(CollisionFilter &_filter) const;
+
+    /// \brief Collect the distinct surface parameters of the collisions of
+    /// the links of all the models of this world, as described in
+    /// SurfaceMaterials. The collisions are in ModelByIndex order, then in
+    /// LinkByIndex order and then in CollisionByIndex order.
+    /// \param[out] _materials The materials.
+    public: void ResolveSurfaceMaterials(SurfaceMaterials &_materials) const;
+
+    /// \brief Group the sensors of the links of all the models of this world
+    /// by their update rate, as described in SensorSchedule. The sensors of
+    /// each group are in ModelByIndex order, then in LinkByIndex order and
+    /// then in SensorByIndex order. Sensors whose update rate is not a
+    /// positive number are in the group of rate 0.
+    /// \param[out] _schedule The schedule.
+    public: void ResolveSensorSchedule(SensorSchedule &_schedule) const;
+
+    /// \brief Group the visuals of the links of all the models of this
+    /// world into instancing batches, as described in RenderBatches, with
+    /// their poses in the world frame resolved as in ResolveObjectPoses.
+    /// The visuals of each batch are in ModelByIndex order, then in
+    /// LinkByIndex order and then in VisualByIndex order.
+    /// \param[out] _batches The batches. They are not changed if there are
+    /// errors.
+    /// \return Errors.
+    public: Errors ResolveRenderBatches(RenderBatches &_batches) const;
+
+    /// \brief Collect the lights of the links of all the models of this
+    /// world and the lights of this world for culling, as described in
+    /// LightCulling, with their poses in the world frame resolved as in
+    /// ResolveObjectPoses. The lights are in the order of WorldPoses.
+    /// \param[out] _culling The light culling. It is not changed if there
+    /// are errors.
+    /// \param[in] _cellSize Size of the cells of the grid that the lights
+    /// are assigned to, or 0 for no grid.
+    /// \return Errors.
+    public: Errors ResolveLightCulling(LightCulling &_culling,
+                                       double _cellSize = 0) const;
+
+    /// \brief Set the raw pose and relative_to frame of a model or frame of
+    /// this world, and update the pose graph of the world in place instead
+    /// of rebuilding it. The change is checked for graph cycles and only the
+    /// poses that depend on it are recomputed, so the SemanticPose of every
+    /// model and frame of the world reflects it.
+    /// \param[in] _name Name of the model or frame.
+    /// \param[in] _pose New raw pose.
+    /// \param[in] _relativeTo New relative_to frame. If it is empty, the
+    /// default frame of the object is used, as when loading.
+    /// \return Errors. Nothing is changed if there are errors.
+    public: Errors UpdateFramePose(const std::string &_name,
+        const ignition::math::Pose3d &_pose,
+        const std::string &_relativeTo = "");
+
+    /// \brief Get the models of this world whose bounds intersect an
+    /// axis-aligned box of the world frame. The first query of each bounds
+    /// type builds a bounding volume hierarchy over the resolved poses of
+    /// the models, which later queries share until the models or their
+    /// poses change. Models whose pose can't be resolved are not found.
+    /// \param[in] _min Minimum corner of the box.
+    /// \param[in] _max Maximum corner of the box.
+    /// \param[in] _bounds The bounds of the models.
+    /// \return The models, in ModelByIndex order.
+    public: std::vector<const Model *> ModelsInBox(
+        const ignition::math::Vector3d &_min,
+        const ignition::math::Vector3d &_max,
+        const ModelBoundsType _bounds = ModelBoundsType::ORIGIN) const;
+
+    /// \brief Get the models of this world whose bounds are within a
+    /// distance of a point of the world frame, as in ModelsInBox.
+    /// \param[in] _point The point.
+    /// \param[in] _radius The distance.
+    /// \param[in] _bounds The bounds of the models.
+    /// \return The models, in ModelByIndex order.
+    public: std::vector<const Model *> ModelsNear(
+        const ignition::math::Vector3d &_point, const double _radius,
+        const ModelBoundsType _bounds = ModelBoundsType::ORIGIN) const;
+
+    /// \brief Release the capacity that the vectors of this world and of
+    /// its models keep for growth, and the spatial indices, which the next
+    /// query builds again. This is private and is intended to be called by
+    /// Root::Compact.
+    /// \return Number of bytes released.
+    private: std::size_t Compact();
+
+    /// \brief Allow Root::Compact to call Compact.
+    friend class Root;
 
     /// \brief Private data pointer.
     private: WorldPrivate *dataPtr = nullptr;
@@ -0,0 +1,93 @@
+/*
+ * Copyright 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef SDF_WORLDPOSES_HH_
+#define SDF_WORLDPOSES_HH_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <ignition/math/Pose3.hh>
+
+#include "sdf/sdf_config.h"
+
+namespace sdf
+{
+  // Inline bracket to help doxygen filtering.
+  inline namespace SDF_VERSION_NAMESPACE {
+  //
+
+  /// \enum WorldPoseType
+  /// \brief The kinds of object of WorldPoses.
+  enum class WorldPoseType
+  {
+    /// \brief A model of the world.
+    MODEL = 0,
+
+    /// \brief A link of a model.
+    LINK = 1,
+
+    /// \brief A visual of a link.
+    VISUAL = 2,
+
+    /// \brief A collision of a link.
+    COLLISION = 3,
+
+    /// \brief A sensor of a link.
+    SENSOR = 4,
+
+    /// \brief A light of a link or of the world.
+    LIGHT = 5,
+  };
+
+  /// \brief The poses in the world frame of the models, links, visuals,
+  /// collisions, sensors and lights of a world stored as contiguous arrays,
+  /// one array per property, for renderers and simulators that place a
+  /// whole world at once. It is filled by World::ResolveObjectPoses.
+  ///
+  /// Objects are referred to by their position in these arrays, which is
+  /// stable as long as the world does not change: each model of
+  /// World::ModelByIndex is followed by its links in Model::LinkByIndex
+  /// order, and each link is followed by its visuals, collisions, sensors
+  /// and lights in the order of their ByIndex functions. The lights of the
+  /// world come last, in World::LightByIndex order.
+  struct WorldPoses
+  {
+    /// \brief Kind of each object.
+    std::vector<WorldPoseType> types;
+
+    /// \brief Index of the model of each object in World::ModelByIndex, or
+    /// -1 for a light of the world.
+    std::vector<int64_t> modelIndices;
+
+    /// \brief Index of the link of each object in Model::LinkByIndex, or -1
+    /// for a model or a light of the world.
+    std::vector<int64_t> linkIndices;
+
+    /// \brief Index of each object among the objects of the same kind of
+    /// its parent, as in VisualByIndex for a visual of a link.
+    std::vector<uint64_t> indices;
+
+    /// \brief Name of each object, scoped by the names of its model and
+    /// link, such as "model::link::visual".
+    std::vector<std::string> names;
+
+    /// \brief Pose of each object relative to the world frame.
+    std::vector<ignition::math::Pose3d> poses;
+  };
+  }
+}
+#endif
@@ -17,8 +17,12 @@
 #ifndef SDF_PARSER_HH_
 #define SDF_PARSER_HH_
 
+#include <cstddef>
+#include <iosfwd>
 #include <string>
+#include <vector>
 
+#include "sdf/ParserConfig.hh"
 #include "sdf/SDFImpl.hh"
 #include "sdf/sdf_config.h"
 #include "sdf/system_util.hh"
@@ -44,6 +48,15 @@ namespace sdf
   SDFORMAT_VISIBLE
   bool init(SDFPtr _sdf);
 
+  /// \brief Init based on the installed sdf_format.xml file of the version
+  /// of a parser configuration.
+  /// \param[in] _sdf The SDF to initialize.
+  /// \param[in] _config Parser configuration, whose SpecVersion is used.
+  /// \return True if successful.
+  /// \sa ParserConfig::SetSpecVersion
+  SDFORMAT_VISIBLE
+  bool init(SDFPtr _sdf, const ParserConfig &_config);
+
   /// \brief Initialize the SDF interface using a file
   SDFORMAT_VISIBLE
   bool initFile(const std::string &_filename, SDFPtr _sdf);
@@ -56,6 +69,18 @@ namespace sdf
   SDFORMAT_VISIBLE
   bool initString(const std::string &_xmlString, SDFPtr _sdf);
 
+  /// \brief Build the parser state that is otherwise built on first use:
+  /// the specification that documents read for <include> elements are
+  /// cloned from, the interned strings table, and the parsed conversion
+  /// recipes from every older version to the latest one. Nothing is
+  /// modified afterwards, so a process that calls this before forking
+  /// workers shares these structures with them copy-on-write, instead of
+  /// each worker building its own copy.
+  /// \param[in] _uris URIs and file names to resolve with sdf::findFile,
+  /// so that their paths are cached as well.
+  SDFORMAT_VISIBLE
+  void warmup(const std::vector<std::string> &_uris = {});
+
   /// \brief Populate the SDF values from a file
   ///
   /// This populates the given sdf pointer from a file. If the file is a URDF
@@ -77,6 +102,19 @@ namespace sdf
   SDFORMAT_VISIBLE
   sdf::SDFPtr readFile(const std::string &_filename, Errors &_errors);
 
+  /// \brief Populate the SDF values from a file
+  ///
+  /// This populates the given sdf pointer from a file. If the file is a URDF
+  /// file it is converted to SDF first. All files are converted to the latest
+  /// SDF version
+  /// \param[in] _filename Name of the SDF file
+  /// \param[in] _config Custom parser configuration
+  /// \param[out] _errors Parsing errors will be appended to this variable.
+  /// \return Populated SDF pointer.
+  SDFORMAT_VISIBLE
+  sdf::SDFPtr readFile(const std::string &_filename,
+                       const ParserConfig &_config, Errors &_errors);
+
   /// \brief Populate the SDF values from a file
   ///
   /// This populates the given sdf pointer from a file. If the file is a URDF
@@ -89,6 +127,20 @@ namespace sdf
   SDFORMAT_VISIBLE
   bool readFile(const std::string &_filename, SDFPtr _sdf, Errors &_errors);
 
+  /// \brief Populate the SDF values from a file
+  ///
+  /// This populates the given sdf pointer from a file. If the file is a URDF
+  /// file it is converted to SDF first. All files are converted to the latest
+  /// SDF version
+  /// \param[in] _filename Name of the SDF file
+  /// \param[in] _config Custom parser configuration
+  /// \param[in] _sdf Pointer to an SDF object.
+  /// \param[out] _errors Parsing errors will be appended to this variable.
+  /// \return True if successful.
+  SDFORMAT_VISIBLE
+  bool readFile(const std::string &_filename, const ParserConfig &_config,
+                SDFPtr _sdf, Errors &_errors);
+
   /// \brief Populate the SDF values from a file without converting to the
   /// latest SDF version
   ///
@@ -115,6 +167,29 @@ namespace sdf
   SDFORMAT_VISIBLE
   bool readFile(const std::string &_filename, SDFPtr _sdf);
 
+  /// \brief Print a file converted to the version that documents are read
+  /// as, like printing the SDF read by readFile with SDF::PrintValues, but
+  /// reading, converting and printing the children of its <world> elements,
+  /// and its other top level elements, one at a time. The file is mapped
+  /// instead of loaded, so that the memory used is bounded by its largest
+  /// such element instead of the whole document, for printing or upgrading
+  /// very large generated worlds. The default elements of a world are
+  /// printed after its other children. Compressed files and the files of
+  /// mounted archives are loaded whole before they are split, and other
+  /// documents, such as URDF, are read and printed whole.
+  /// \param[in] _filename Name of the file.
+  /// \param[out] _out Stream the document is printed to.
+  /// \param[in] _expandIncludes True to read each element like readFile,
+  /// which expands its includes and adds default values. False to only
+  /// convert its XML, which keeps the includes as written, for migrating
+  /// files to a newer version.
+  /// \param[in] _config Custom parser configuration.
+  /// \param[out] _errors Parsing errors will be appended to this variable.
+  /// \return True if the whole document was printed.
+  SDFORMAT_VISIBLE
+  bool printFileStreaming(const std::string &_filename, std::ostream &_out,
+      bool _expandIncludes, const ParserConfig &_config, Errors &_errors);
+
   /// \brief Populate the SDF values from a string
   ///
   /// This populates the sdf pointer from a string. If the string is a URDF
@@ -127,6 +202,20 @@ namespace sdf
   SDFORMAT_VISIBLE
   bool readString(const std::string &_xmlString, SDFPtr _sdf, Errors &_errors);
 
+  /// \brief Populate the SDF values from a string
+  ///
+  /// This populates the sdf pointer from a string. If the string is a URDF
+  /// string it is converted to SDF first. All string are converted to the
+  /// latest SDF version
+  /// \param[in] _xmlString XML string to be parsed.
+  /// \param[in] _config Custom parser configuration
+  /// \param[in] _sdf Pointer to an SDF object.
+  /// \param[out] _errors Parsing errors will be appended to this variable.
+  /// \return True if successful.
+  SDFORMAT_VISIBLE
+  bool readString(const std::string &_xmlString, const ParserConfig &_config,
+                  SDFPtr _sdf, Errors &_errors);
+
   /// \brief Populate the SDF values from a string
   ///
   /// This populates the sdf pointer from a string. If the string is a URDF
@@ -151,6 +240,43 @@ namespace sdf
   bool readString(const std::string &_xmlString, ElementPtr _sdf,
       Errors &_errors);
 
+  /// \brief Populate the SDF values from a buffer of XML that is not held
+  /// by a std::string, such as a shared memory segment, as readString does
+  /// from a string. The buffer is parsed in place if its last byte is a null
+  /// character, which is then included in _size. Otherwise it is copied
+  /// once, since the XML parser reads null-terminated strings.
+  /// \param[in] _data XML to be parsed.
+  /// \param[in] _size Size of _data in bytes.
+  /// \param[in] _sdf Pointer to an SDF object.
+  /// \param[out] _errors Parsing errors will be appended to this variable.
+  /// \return True if successful.
+  SDFORMAT_VISIBLE
+  bool readString(const char *_data, std::size_t _size, SDFPtr _sdf,
+      Errors &_errors);
+
+  /// \brief Populate the SDF values from a buffer of XML, as in the
+  /// overload without a parser configuration.
+  /// \param[in] _data XML to be parsed.
+  /// \param[in] _size Size of _data in bytes.
+  /// \param[in] _config Custom parser configuration
+  /// \param[in] _sdf Pointer to an SDF object.
+  /// \param[out] _errors Parsing errors will be appended to this variable.
+  /// \return True if successful.
+  SDFORMAT_VISIBLE
+  bool readString(const char *_data, std::size_t _size,
+      const ParserConfig &_config, SDFPtr _sdf, Errors &_errors);
+
+  /// \brief Populate the SDF values of an element from a buffer of XML, as
+  /// in the overload that takes an SDF object.
+  /// \param[in] _data XML to be parsed.
+  /// \param[in] _size Size of _data in bytes.
+  /// \param[in] _sdf Pointer to an sdf Element object.
+  /// \param[out] _errors Parsing errors will be appended to this variable.
+  /// \return True if successful.
+  SDFORMAT_VISIBLE
+  bool readString(const char *_data, std::size_t _size, ElementPtr _sdf,
+      Errors &_errors);
+
   /// \brief Populate the SDF values from a string without converting to the
   /// latest SDF version
   ///
@@ -228,6 +354,17 @@ namespace sdf
   bool convertString(const std::string &_sdfString,
                      const std::string &_version, SDFPtr _sdf);
 
+  /// \brief Convert the element tree of an SDF document to a specific SDF
+  /// version in place, without writing it to and parsing it from XML. This
+  /// upgrades trees that were read without conversion, such as with a
+  /// ParserConfig::SetSpecVersion of the version of the document.
+  /// \param[in,out] _sdf The <sdf> element of the document, whose version
+  /// attribute is the version of the tree.
+  /// \param[in] _version Version to convert _sdf to.
+  /// \return True on success.
+  SDFORMAT_VISIBLE
+  bool convertElement(ElementPtr _sdf, const std::string &_version);
+
   /// \brief Check that for each model, the canonical_link attribute value
   /// matches the name of a link in the model if the attribute is set and
   /// not empty.
@@ -281,6 +418,16 @@ namespace sdf
   SDFORMAT_VISIBLE
   bool checkPoseRelativeToGraph(const sdf::Root *_root);
 
+  /// \brief Run checkCanonicalLinkNames, checkJointParentChildLinkNames,
+  /// checkFrameAttachedToGraph and checkPoseRelativeToGraph in a single
+  /// pass over the models and worlds, and recursiveSiblingUniqueNames on the
+  /// element tree if the root has one. The same errors are printed as by
+  /// those functions, grouped by model and world instead of by check.
+  /// \param[in] _root sdf Root object to check recursively.
+  /// \return True if all the checks pass.
+  SDFORMAT_VISIBLE
+  bool checkRoot(const sdf::Root *_root);
+
   /// \brief Check that all sibling elements of the same type have unique names.
   /// This checks recursively and should check the files exhaustively
   /// rather than terminating early when the first duplicate name is found.
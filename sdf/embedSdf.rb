@@ -8,38 +8,352 @@ supportedSdfVersions = ['1.8', '1.7', '1.6', '1.5', '1.4', '1.3', '1.2']
 # a user can convert an existing SDF version to.
 supportedSdfConversions = ['1.8', '1.7', '1.6', '1.5', '1.4', '1.3']
 
+# With --compress, the contents of the files are embedded compressed with
+# zlib, which the library must then be linked with.
+compress = ARGV.include?('--compress')
+
+puts %q!
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string_view>
+!
+puts '#include <zlib.h>' if compress
 puts %q!
 #include "EmbeddedSdf.hh"
 
 namespace sdf {
 inline namespace SDF_VERSION_NAMESPACE {
-
-const std::map<std::string, std::string> &GetEmbeddedSdf() {
-  static const std::map<std::string, std::string> result{
 !
 
-# Stores the contents of the file in the map.
-def embed(pathname)
-  puts "{\"#{pathname}\", R\"__sdf_literal__("
-  infile = File.open(pathname)
-  puts infile.read
-  puts ")__sdf_literal__\"},"
+# The files to embed, sorted by version and then by name, which is the
+# order of the file table that the lookups binary search.
+embeddedFiles = []
+supportedSdfVersions.each do |version|
+  Dir.glob("#{version}/*.sdf").sort.each { |file| embeddedFiles.push(file) }
+end
+supportedSdfConversions.each do |version|
+  Dir.glob("#{version}/*.convert").sort.each do |file|
+    embeddedFiles.push(file)
+  end
 end
+embeddedFiles.sort_by! { |file| File.split(file) }
+
+# Precompile the element descriptions of the supported *.sdf files into
+# static tables, so that sdf::init does not need to parse XML at runtime.
+# The tables must produce the same descriptions as parser.cc:initXml does
+# when it parses the files with TinyXML.
+require 'rexml/document'
+
+# Escape a string as a C++ string literal, or return nullptr for nil.
+def cString(str)
+  return 'nullptr' if str.nil?
+  out = '"'
+  str.each_byte do |b|
+    case b
+    when 0x5c then out << '\\\\'
+    when 0x22 then out << '\\"'
+    when 0x0a then out << '\\n'
+    when 0x09 then out << '\\t'
+    when 0x0d then out << '\\r'
+    when 0x20..0x7e then out << b.chr
+    else out << format('\\%03o', b)
+    end
+  end
+  out << '"'
+end
+
+# Get the text of an element the way TiXmlElement::GetText does with the
+# default whitespace condensing: the text of the first non-blank child node,
+# or nil if that node is not text.
+def tinyXmlText(elem)
+  return nil if elem.nil?
+  elem.children.each do |child|
+    if child.is_a?(REXML::CData)
+      return child.value
+    elsif child.is_a?(REXML::Text)
+      text = child.value.strip.gsub(/\s+/, ' ')
+      next if text.empty?
+      return text
+    else
+      return nil
+    end
+  end
+  nil
+end
+
+$elements = []
+$attributes = []
+$children = []
+
+# Append the description of an XML element to the tables, and return its
+# index in the element table.
+def compileElement(xml)
+  index = $elements.size
+  entry = {}
+  $elements.push(entry)
+
+  if xml.attributes['name'].nil? || xml.attributes['required'].nil?
+    raise "Element is missing the name or required attribute:\n#{xml}"
+  end
 
-# Embed the supported *.sdf files.
+  description = tinyXmlText(xml.elements['description'])
+  entry[:name] = xml.attributes['name']
+  entry[:required] = xml.attributes['required']
+  entry[:type] = xml.attributes['type']
+  entry[:default] = xml.attributes['default']
+  entry[:description] = description
+  entry[:ref] = xml.attributes['ref']
+  entry[:copy] = false
+
+  entry[:firstAttribute] = $attributes.size
+  xml.each_element('attribute') do |attr|
+    ['name', 'type', 'default', 'required'].each do |key|
+      if attr.attributes[key].nil?
+        raise "Attribute is missing the #{key} attribute:\n#{attr}"
+      end
+    end
+    $attributes.push({
+      :name => attr.attributes['name'],
+      :type => attr.attributes['type'],
+      :default => attr.attributes['default'],
+      :required => attr.attributes['required'].to_s.strip == '1',
+      :description => tinyXmlText(attr.elements['description'])})
+  end
+  entry[:attributeCount] = $attributes.size - entry[:firstAttribute]
+
+  childElements = []
+  xml.each_element('element') do |child|
+    copyData = child.attributes['copy_data']
+    if copyData == 'true' || copyData == '1'
+      entry[:copy] = true
+    else
+      childElements.push(compileElement(child))
+    end
+  end
+
+  entry[:firstChild] = $children.size
+  childElements.each do |childIndex|
+    $children.push({:element => childIndex})
+  end
+  xml.each_element('include') do |child|
+    $children.push({
+      :element => -1,
+      :filename => child.attributes['filename'],
+      :description => child.elements['description'].nil? ? nil :
+        tinyXmlText(child.elements['description']).to_s})
+  end
+  entry[:childCount] = $children.size - entry[:firstChild]
+
+  index
+end
+
+files = {}
 supportedSdfVersions.each do |version|
-  Dir.glob("#{version}/*.sdf").sort.each { |file| embed(file) }
+  Dir.glob("#{version}/*.sdf").sort.each do |file|
+    doc = REXML::Document.new(File.read(file))
+    root = doc.elements['element']
+    files[file] = compileElement(root) unless root.nil?
+  end
 end
 
-# Embed the supported *.convert files.
-supportedSdfConversions.each do |version|
-  Dir.glob("#{version}/*.convert").sort.each { |file| embed(file) }
+puts 'static const EmbeddedSdfElement kEmbeddedSdfElements[] = {'
+$elements.each do |e|
+  puts "  {#{cString(e[:name])}, #{cString(e[:required])}, " +
+       "#{cString(e[:type])}, #{cString(e[:default])},\n" +
+       "   #{cString(e[:description])},\n" +
+       "   #{cString(e[:ref])}, #{e[:copy]}, #{e[:firstAttribute]}, " +
+       "#{e[:attributeCount]}, #{e[:firstChild]}, #{e[:childCount]}},"
 end
+puts '};'
+
+puts 'static const EmbeddedSdfAttribute kEmbeddedSdfAttributes[] = {'
+$attributes.each do |a|
+  puts "  {#{cString(a[:name])}, #{cString(a[:type])}, " +
+       "#{cString(a[:default])}, #{a[:required]},\n" +
+       "   #{cString(a[:description])}},"
+end
+puts '  {nullptr, nullptr, nullptr, false, nullptr}'
+puts '};'
+
+puts 'static const EmbeddedSdfChild kEmbeddedSdfChildren[] = {'
+$children.each do |c|
+  puts "  {#{c[:element]}, #{cString(c[:filename])}, " +
+       "#{cString(c[:description])}},"
+end
+puts '  {-1, nullptr, nullptr}'
+puts '};'
+
 puts %q!
+const EmbeddedSdfDescriptions &GetEmbeddedSdfDescriptions() {
+  static constexpr EmbeddedSdfDescriptions result{
+    kEmbeddedSdfElements,
+    kEmbeddedSdfAttributes,
+    kEmbeddedSdfChildren
   };
   return result;
 }
+!
 
+# The contents of the files are stored in groups, one for the *.sdf files
+# and one for the *.convert files of each version, so that using a version
+# only decompresses the contents of that version. The contents of a group
+# are the contents of its files, each followed by a null character. The
+# content of a file starts with a newline and ends with one.
+groups = []
+groupIndex = {}
+fileEntries = []
+embeddedFiles.each do |file|
+  version, name = File.split(file)
+  key = [version, File.extname(name)]
+  unless groupIndex.key?(key)
+    groupIndex[key] = groups.size
+    groups.push(String.new)
+  end
+  group = groups[groupIndex[key]]
+  content = "\n" + File.read(file)
+  content << "\n" unless content.end_with?("\n")
+  fileEntries.push([version, name, groupIndex[key], group.bytesize,
+    content.bytesize, files.fetch(file, -1)])
+  group << content << "\0"
+end
+
+require 'zlib' if compress
+groups.each_with_index do |group, index|
+  data = compress ? Zlib::Deflate.deflate(group, Zlib::BEST_COMPRESSION) :
+    group
+  puts "static constexpr unsigned char kEmbeddedSdfGroup#{index}[] = {"
+  data.bytes.each_slice(20) { |bytes| puts "  #{bytes.join(',')}," }
+  puts '};'
+end
+
+puts 'static constexpr EmbeddedSdfGroup kEmbeddedSdfGroups[] = {'
+groups.each_with_index do |group, index|
+  puts "  {kEmbeddedSdfGroup#{index}, sizeof(kEmbeddedSdfGroup#{index}), " +
+       "#{group.bytesize}, #{compress}},"
+end
+puts '};'
+
+puts 'static constexpr EmbeddedSdfFile kEmbeddedSdfFiles[] = {'
+fileEntries.each do |version, name, group, offset, size, description|
+  puts "  {\"#{version}\", \"#{name}\", #{group}, #{offset}, #{size}, " +
+       "#{description}},"
+end
+puts '};'
+
+# The recipes that upgrade each version, sorted by the version they
+# upgrade from. The recipe named, e.g., "1.8/1_7.convert" upgrades from
+# 1.7 to 1.8.
+conversions = []
+embeddedFiles.each_with_index do |file, index|
+  version, name = File.split(file)
+  next unless name.end_with?('.convert')
+  conversions.push([name.chomp('.convert').tr('_', '.'), index])
+end
+conversions.sort!
+
+puts 'static constexpr EmbeddedSdfConversion kEmbeddedSdfConversions[] = {'
+conversions.each do |from, index|
+  puts "  {\"#{from}\", #{index}},"
+end
+puts '};'
+
+if compress
+  puts <<'CPP'
+/// \brief Decompress the contents of a group.
+/// \param[in] _group The group.
+/// \return The contents, or nullptr if they could not be decompressed.
+static std::unique_ptr<char[]> decompressGroup(const EmbeddedSdfGroup &_group)
+{
+  auto text = std::make_unique<char[]>(_group.size);
+  uLongf size = static_cast<uLongf>(_group.size);
+  if (uncompress(reinterpret_cast<Bytef *>(text.get()), &size,
+        _group.data, static_cast<uLong>(_group.dataSize)) != Z_OK ||
+      size != _group.size)
+  {
+    return nullptr;
+  }
+  return text;
 }
+CPP
+else
+  puts <<'CPP'
+/// \brief Decompress the contents of a group, which are never compressed
+/// when the library is built without zlib.
+/// \return nullptr.
+static std::unique_ptr<char[]> decompressGroup(const EmbeddedSdfGroup &)
+{
+  return nullptr;
 }
-!
+CPP
+end
+
+puts <<'CPP'
+static constexpr std::size_t kEmbeddedSdfGroupCount =
+    sizeof(kEmbeddedSdfGroups) / sizeof(kEmbeddedSdfGroups[0]);
+
+/// \brief Flag of each compressed group, set once it is decompressed.
+static std::once_flag g_groupDecompressed[kEmbeddedSdfGroupCount];
+
+/// \brief The decompressed contents of each compressed group, or nullptr
+/// until the group is first used.
+static std::unique_ptr<char[]> g_groupText[kEmbeddedSdfGroupCount];
+
+std::string_view EmbeddedSdfFile::Content() const {
+  const EmbeddedSdfGroup &group = kEmbeddedSdfGroups[this->group];
+  const char *text = reinterpret_cast<const char *>(group.data);
+  if (group.compressed) {
+    std::call_once(g_groupDecompressed[this->group], [&group, this]()
+        {
+          g_groupText[this->group] = decompressGroup(group);
+        });
+    text = g_groupText[this->group].get();
+    if (text == nullptr) {
+      return std::string_view("");
+    }
+  }
+  return std::string_view(text + this->offset, this->size);
+}
+
+const EmbeddedSdfFiles &GetEmbeddedSdfFiles() {
+  static constexpr EmbeddedSdfFiles result{kEmbeddedSdfFiles,
+    sizeof(kEmbeddedSdfFiles) / sizeof(kEmbeddedSdfFiles[0])};
+  return result;
+}
+
+const EmbeddedSdfFile *FindEmbeddedSdf(std::string_view _version,
+    std::string_view _name) {
+  const EmbeddedSdfFiles &files = GetEmbeddedSdfFiles();
+  auto iter = std::lower_bound(files.begin(), files.end(), _version,
+      [&_name](const EmbeddedSdfFile &_file, std::string_view _v)
+      {
+        return _file.version < _v ||
+            (_file.version == _v && _file.name < _name);
+      });
+  if (iter == files.end() || iter->version != _version ||
+      iter->name != _name) {
+    return nullptr;
+  }
+  return iter;
+}
+
+const EmbeddedSdfFile *FindEmbeddedSdfConversion(
+    std::string_view _fromVersion) {
+  const EmbeddedSdfConversion *begin = kEmbeddedSdfConversions;
+  const EmbeddedSdfConversion *end = begin +
+      sizeof(kEmbeddedSdfConversions) / sizeof(kEmbeddedSdfConversions[0]);
+  auto iter = std::lower_bound(begin, end, _fromVersion,
+      [](const EmbeddedSdfConversion &_c, std::string_view _v)
+      {
+        return _c.fromVersion < _v;
+      });
+  if (iter == end || iter->fromVersion != _fromVersion) {
+    return nullptr;
+  }
+  return &kEmbeddedSdfFiles[iter->file];
+}
+
+}
+}
+CPP
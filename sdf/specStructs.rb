@@ -0,0 +1,217 @@
+#!/usr/bin/env ruby
+
+# Generate SpecStructs.hh, which contains a typed C++ struct for every
+# element description of the latest SDF specification that has attributes
+# or child elements with a value of a basic type. Each struct has one field
+# per such attribute or child element, initialized with the default value of
+# the specification, and a Load function that fills the fields from a
+# parsed element through ElementField.
+#
+# Usage: specStructs.rb <spec directory>
+require 'rexml/document'
+
+specDir = ARGV[0] || '1.8'
+
+# C++ type and default value formatting of each supported value type.
+# Values of other types, such as pose and time, are not generated, since
+# their DOM classes read them with extra semantics.
+$types = {
+  'double' => 'double',
+  'int' => 'int',
+  'unsigned int' => 'unsigned int',
+  'bool' => 'bool',
+  'string' => 'std::string',
+  'vector2d' => 'ignition::math::Vector2d',
+  'vector3' => 'ignition::math::Vector3d',
+  'color' => 'ignition::math::Color',
+}
+
+$keywords = %w(alignas alignof and asm auto bool break case catch char class
+  const constexpr continue default delete do double else enum explicit export
+  extern false float for friend goto if inline int long mutable namespace new
+  noexcept not nullptr operator or private protected public register return
+  short signed sizeof static struct switch template this throw true try
+  typedef typeid typename union unsigned using virtual void volatile while)
+
+# Escape a string as a C++ string literal.
+def cString(str)
+  out = '"'
+  str.each_byte do |b|
+    case b
+    when 0x5c then out << '\\\\'
+    when 0x22 then out << '\\"'
+    when 0x20..0x7e then out << b.chr
+    else out << format('\\%03o', b)
+    end
+  end
+  out << '"'
+end
+
+# Convert an SDF name such as "spring_reference" to "SpringReference".
+def camelCase(name)
+  name.split(/[^A-Za-z0-9]+/).map { |part| part[0].upcase + part[1..-1] }.join
+end
+
+# Convert an SDF name to a C++ field name.
+def fieldName(name)
+  field = name.gsub(/[^A-Za-z0-9_]/, '_')
+  field = '_' + field if field =~ /\A[0-9]/
+  field += '_' if $keywords.include?(field)
+  field
+end
+
+# Get the C++ initializer of a default value, or nil if the default value
+# is not a literal of the type.
+def initializer(type, value)
+  return nil if value.nil?
+  value = value.strip
+  case type
+  when 'double'
+    Float(value, exception: false).nil? ? nil : value
+  when 'int'
+    value =~ /\A[-+]?[0-9]+\z/ ? value : nil
+  when 'unsigned int'
+    value =~ /\A\+?[0-9]+\z/ ? value.delete('+') + 'u' : nil
+  when 'bool'
+    case value.downcase
+    when 'true', '1' then 'true'
+    when 'false', '0' then 'false'
+    end
+  when 'string'
+    cString(value)
+  when 'vector2d', 'vector3', 'color'
+    parts = value.split
+    count = {'vector2d' => 2, 'vector3' => 3, 'color' => 4}[type]
+    unless parts.size == count || (type == 'color' && parts.size == 3)
+      return nil
+    end
+    return nil if parts.any? { |p| Float(p, exception: false).nil? }
+    '{' + parts.join(', ') + '}'
+  end
+end
+
+$structs = []
+
+# Collect the struct of an element description and of its child element
+# descriptions.
+def collect(xml, path)
+  fields = []
+  names = {}
+
+  xml.each_element('attribute') do |attr|
+    type = attr.attributes['type']
+    next unless $types.key?(type)
+    name = attr.attributes['name']
+    next if names.key?(name)
+    names[name] = true
+    fields.push({:name => name, :type => type, :attribute => true,
+                 :default => attr.attributes['default']})
+  end
+
+  xml.each_element('element') do |child|
+    type = child.attributes['type']
+    name = child.attributes['name']
+    if $types.key?(type) && child.elements['element'].nil? &&
+       child.elements['attribute'].nil? && child.elements['include'].nil?
+      next if names.key?(name)
+      names[name] = true
+      fields.push({:name => name, :type => type,
+                   :default => child.attributes['default']})
+    elsif child.attributes['copy_data'].nil?
+      collect(child, path + [name])
+    end
+  end
+
+  unless fields.empty?
+    $structs.push({:name => path.map { |p| camelCase(p) }.join,
+                   :element => xml.attributes['name'],
+                   :path => path.join('/'),
+                   :fields => fields})
+  end
+end
+
+Dir.glob("#{specDir}/*.sdf").sort.each do |file|
+  doc = REXML::Document.new(File.read(file))
+  root = doc.elements['element']
+  collect(root, [root.attributes['name']]) unless root.nil?
+end
+
+# Elements with the same path in several files, such as the root elements
+# of a file that is included twice, only get one struct.
+seen = {}
+$structs.select! do |s|
+  keep = !seen.key?(s[:name])
+  seen[s[:name]] = true
+  keep
+end
+
+puts %q!/*
+ * Generated by sdf/specStructs.rb from the SDF specification. Do not edit.
+ */
+#ifndef SDF_SPECSTRUCTS_HH_
+#define SDF_SPECSTRUCTS_HH_
+
+#include <string>
+#include <ignition/math/Color.hh>
+#include <ignition/math/Vector2.hh>
+#include <ignition/math/Vector3.hh>
+
+#include "sdf/Element.hh"
+#include "sdf/sdf_config.h"
+#include "ElementField.hh"
+
+namespace sdf
+{
+  // Inline bracket to help doxygen filtering.
+  inline namespace SDF_VERSION_NAMESPACE {
+  //
+  /// \internal
+  /// \brief Typed structs of the element descriptions of the specification.
+  namespace spec
+  {!
+
+$structs.each do |s|
+  puts
+  puts "  /// \\brief Values of the <#{s[:path]}> element."
+  puts "  struct #{s[:name]}"
+  puts '  {'
+  puts "    /// \\brief Name of the element."
+  puts '    static constexpr const char *kElementName = ' +
+       "#{cString(s[:element])};"
+  s[:fields].each do |f|
+    init = initializer(f[:type], f[:default])
+    puts
+    if f[:attribute]
+      puts "    /// \\brief Value of the #{f[:name]} attribute."
+    else
+      puts "    /// \\brief Value of <#{f[:name]}>."
+    end
+    if init.nil?
+      puts "    #{$types[f[:type]]} #{fieldName(f[:name])}{};"
+    else
+      puts "    #{$types[f[:type]]} #{fieldName(f[:name])} = #{init};"
+    end
+  end
+  puts
+  puts '    /// \brief Read the fields from an element. A field that the'
+  puts '    /// element does not have keeps the default value of its'
+  puts '    /// description.'
+  puts '    /// \param[in] _sdf The element, which must not be null.'
+  puts '    void Load(const ElementPtr &_sdf)'
+  puts '    {'
+  s[:fields].each_with_index do |f, i|
+    puts "      static const ElementField<#{$types[f[:type]]}> k#{i}(" +
+         "#{cString(f[:name])});"
+  end
+  s[:fields].each_with_index do |f, i|
+    field = fieldName(f[:name])
+    puts "      this->#{field} = k#{i}.Get(_sdf, this->#{field}).first;"
+  end
+  puts '    }'
+  puts '  };'
+end
+
+puts %q!  }
+  }
+}
+#endif!
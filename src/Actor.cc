@@ -14,6 +14,9 @@
  * limitations under the License.
  *
 */
+#include <algorithm>
+#include <atomic>
+#include <mutex>
 #include <string>
 #include <vector>
 #include <ignition/math/Pose3.hh>
@@ -23,17 +26,29 @@
 
 using namespace sdf;
 
+/////////////////////////////////////////////////
+/// \brief Get the default name and file name of an animation.
+/// \return The shared "__default__" string.
+static const SharedString &defaultAnimationString()
+{
+  static const SharedString value(std::string("__default__"));
+  return value;
+}
+
 /// \brief Animation private data.
 class sdf::AnimationPrivate
 {
+  // The strings are shared, since the actors of a crowd usually use the
+  // same few animations, which are then stored once and copied cheaply.
+
   /// \brief Unique name for animation.
-  public: std::string name = "__default__";
+  public: SharedString name = defaultAnimationString();
 
   /// \brief Path to animation file.
-  public: std::string filename = "__default__";
+  public: SharedString filename = defaultAnimationString();
 
   /// \brief The path to the file where this animation was defined.
-  public: std::string filePath = "";
+  public: SharedString filePath;
 
   /// \brief Scale for animation skeleton.
   public: double scale = 1.0;
@@ -64,10 +79,81 @@ class sdf::TrajectoryPrivate
     /// \brief Tension of the trajectory spline.
     public: double tension = 0.0;
 
-    /// \brief Each points in the trajectory.
-    public: std::vector<Waypoint> waypoints;
+    /// \brief Times of the waypoints, in increasing order. Waypoints with
+    /// the same time are in the order they were added. The waypoints are
+    /// stored in these packed arrays, and only copied into Waypoint objects
+    /// when they are accessed as such.
+    public: std::vector<double> times;
+
+    /// \brief Poses of the waypoints, in the order of times.
+    public: std::vector<ignition::math::Pose3d> poses;
+
+    /// \brief Index in times and poses of each waypoint, in the order they
+    /// were added.
+    public: std::vector<std::size_t> documentOrder;
+
+    /// \brief Each points in the trajectory, in the order they were added,
+    /// once waypointsReady is true.
+    public: mutable std::vector<Waypoint> waypoints;
+
+    /// \brief True if waypoints holds every waypoint.
+    public: mutable std::atomic<bool> waypointsReady{true};
+
+    /// \brief Mutex protecting the creation of the waypoints.
+    public: mutable std::mutex waypointsMutex;
 };
 
+/////////////////////////////////////////////////
+/// \brief Add a waypoint to the packed arrays of a trajectory.
+/// \param[in,out] _data Private data of the trajectory.
+/// \param[in] _time Time of the waypoint.
+/// \param[in] _pose Pose of the waypoint.
+static void indexWaypoint(TrajectoryPrivate &_data, double _time,
+    const ignition::math::Pose3d &_pose)
+{
+  const auto it = std::upper_bound(_data.times.begin(), _data.times.end(),
+      _time);
+  const std::size_t index = static_cast<std::size_t>(it - _data.times.begin());
+  _data.times.insert(it, _time);
+  _data.poses.insert(_data.poses.begin() + index, _pose);
+  for (std::size_t &position : _data.documentOrder)
+  {
+    if (position >= index)
+      ++position;
+  }
+  _data.documentOrder.push_back(index);
+}
+
+/////////////////////////////////////////////////
+/// \brief Read the time and pose of a <waypoint> element.
+/// \param[in] _sdf The <waypoint> element.
+/// \param[in,out] _time Time of the waypoint, kept if it is missing.
+/// \param[in,out] _pose Pose of the waypoint, kept if it is missing.
+/// \return Errors of the missing elements.
+static Errors loadWaypoint(ElementPtr _sdf, double &_time,
+    ignition::math::Pose3d &_pose)
+{
+  Errors errors;
+
+  std::pair timeValue = _sdf->Get<double>("time", _time);
+  if (!timeValue.second)
+  {
+    errors.push_back({ErrorCode::ELEMENT_MISSING,
+          "A <waypoint> requires a <time>."});
+  }
+  _time = timeValue.first;
+
+  std::pair posePair = _sdf->Get<ignition::math::Pose3d>("pose", _pose);
+  if (!posePair.second)
+  {
+    errors.push_back({ErrorCode::ELEMENT_MISSING,
+          "A <waypoint> requires a <pose>."});
+  }
+  _pose = posePair.first;
+
+  return errors;
+}
+
 /// \brief Actor private data.
 class sdf::ActorPrivate
 {
@@ -110,6 +196,15 @@ class sdf::ActorPrivate
   /// \brief Joints for the actor.
   public: std::vector<Joint> joints;
 
+  /// \brief Index of the animations by name.
+  public: NameIndex animationIndex;
+
+  /// \brief Index of the links by name.
+  public: NameIndex linkIndex;
+
+  /// \brief Index of the joints by name.
+  public: NameIndex jointIndex;
+
   /// \brief The SDF element pointer used during load.
   public: sdf::ElementPtr sdf;
 };
@@ -168,16 +263,18 @@ Errors Animation::Load(ElementPtr _sdf)
 {
   Errors errors;
 
-  if (!loadName(_sdf, this->dataPtr->name))
+  std::string name;
+  if (!loadName(_sdf, name))
   {
     errors.push_back({ErrorCode::ATTRIBUTE_MISSING,
           "An <animation> requires a name attribute."});
   }
+  this->dataPtr->name = name;
 
   this->dataPtr->filePath = _sdf->FilePath();
 
   std::pair filenameValue = _sdf->Get<std::string>("filename",
-        this->dataPtr->filename);
+        this->dataPtr->filename.Str());
 
   if (!filenameValue.second)
   {
@@ -204,6 +301,7 @@ const std::string &Animation::Name() const
 void Animation::SetName(const std::string &_name)
 {
   this->dataPtr->name = _name;
+  NameIndex::NameChanged();
 }
 
 /////////////////////////////////////////////////
@@ -303,26 +401,7 @@ void Waypoint::CopyFrom(const Waypoint &_waypoint)
 /////////////////////////////////////////////////
 Errors Waypoint::Load(ElementPtr _sdf)
 {
-  Errors errors;
-
-  std::pair timeValue = _sdf->Get<double>("time", this->dataPtr->time);
-  if (!timeValue.second)
-  {
-    errors.push_back({ErrorCode::ELEMENT_MISSING,
-          "A <waypoint> requires a <time>."});
-  }
-  this->dataPtr->time = timeValue.first;
-
-  std::pair posePair = _sdf->Get<ignition::math::Pose3d>
-                        ("pose", this->dataPtr->pose);
-  if (!posePair.second)
-  {
-    errors.push_back({ErrorCode::ELEMENT_MISSING,
-          "A <waypoint> requires a <pose>."});
-  }
-  this->dataPtr->pose = posePair.first;
-
-  return errors;
+  return loadWaypoint(_sdf, this->dataPtr->time, this->dataPtr->pose);
 }
 
 /////////////////////////////////////////////////
@@ -394,7 +473,11 @@ void Trajectory::CopyFrom(const Trajectory &_trajectory)
   this->dataPtr->id = _trajectory.dataPtr->id;
   this->dataPtr->type = _trajectory.dataPtr->type;
   this->dataPtr->tension = _trajectory.dataPtr->tension;
-  this->dataPtr->waypoints = _trajectory.dataPtr->waypoints;
+  this->dataPtr->times = _trajectory.dataPtr->times;
+  this->dataPtr->poses = _trajectory.dataPtr->poses;
+  this->dataPtr->documentOrder = _trajectory.dataPtr->documentOrder;
+  this->dataPtr->waypoints.clear();
+  this->dataPtr->waypointsReady = this->dataPtr->times.empty();
 }
 
 /////////////////////////////////////////////////
@@ -421,11 +504,23 @@ Errors Trajectory::Load(ElementPtr _sdf)
   this->dataPtr->tension = _sdf->Get<double>
           ("tension", this->dataPtr->tension).first;
 
-  Errors waypointLoadErrors = loadRepeated<Waypoint>(_sdf, "waypoint",
-    this->dataPtr->waypoints);
-
-  errors.insert(errors.end(), waypointLoadErrors.begin(),
-                    waypointLoadErrors.end());
+  // The waypoints are only read into the packed arrays, since crowds of
+  // actors have many long trajectories that are sampled rather than
+  // accessed as Waypoint objects.
+  if (_sdf->HasElement("waypoint"))
+  {
+    for (const ElementPtr &elem : _sdf->Children("waypoint"))
+    {
+      double time = 0.0;
+      ignition::math::Pose3d pose = ignition::math::Pose3d::Zero;
+      Errors waypointErrors = loadWaypoint(elem, time, pose);
+      errors.insert(errors.end(), waypointErrors.begin(),
+          waypointErrors.end());
+      indexWaypoint(*this->dataPtr, time, pose);
+    }
+    this->dataPtr->waypoints.clear();
+    this->dataPtr->waypointsReady = false;
+  }
 
   return errors;
 }
@@ -469,21 +564,106 @@ void Trajectory::SetTension(double _tension)
 /////////////////////////////////////////////////
 uint64_t Trajectory::WaypointCount() const
 {
-  return this->dataPtr->waypoints.size();
+  return this->dataPtr->times.size();
 }
 
 /////////////////////////////////////////////////
 const Waypoint *Trajectory::WaypointByIndex(uint64_t _index) const
 {
-  if (_index < this->dataPtr->waypoints.size())
-    return &this->dataPtr->waypoints[_index];
-  return nullptr;
+  if (_index >= this->dataPtr->times.size())
+    return nullptr;
+
+  if (!this->dataPtr->waypointsReady.load(std::memory_order_acquire))
+  {
+    std::lock_guard<std::mutex> lock(this->dataPtr->waypointsMutex);
+    if (!this->dataPtr->waypointsReady.load(std::memory_order_relaxed))
+    {
+      this->dataPtr->waypoints.clear();
+      this->dataPtr->waypoints.reserve(this->dataPtr->times.size());
+      for (std::size_t index : this->dataPtr->documentOrder)
+      {
+        Waypoint waypoint;
+        waypoint.SetTime(this->dataPtr->times[index]);
+        waypoint.SetPose(this->dataPtr->poses[index]);
+        this->dataPtr->waypoints.push_back(std::move(waypoint));
+      }
+      this->dataPtr->waypointsReady.store(true, std::memory_order_release);
+    }
+  }
+  return &this->dataPtr->waypoints[_index];
 }
 
 /////////////////////////////////////////////////
 void Trajectory::AddWaypoint(const Waypoint &_waypoint)
 {
-  this->dataPtr->waypoints.push_back(_waypoint);
+  indexWaypoint(*this->dataPtr, _waypoint.Time(), _waypoint.Pose());
+  if (this->dataPtr->waypointsReady)
+    this->dataPtr->waypoints.push_back(_waypoint);
+}
+
+/////////////////////////////////////////////////
+ignition::math::Pose3d Trajectory::PoseAt(double _time,
+    TrajectoryInterpolation _interpolation) const
+{
+  const std::vector<double> &times = this->dataPtr->times;
+  const std::vector<ignition::math::Pose3d> &poses = this->dataPtr->poses;
+  if (times.empty())
+    return ignition::math::Pose3d::Zero;
+  if (_time <= times.front())
+    return poses.front();
+  if (_time >= times.back())
+    return poses.back();
+
+  // The waypoints before and after the time. The one after is strictly
+  // later, so that the interval between them is never empty.
+  const std::size_t next = static_cast<std::size_t>(
+      std::upper_bound(times.begin(), times.end(), _time) - times.begin());
+  const std::size_t prev = next - 1;
+  const double t = (_time - times[prev]) / (times[next] - times[prev]);
+
+  const ignition::math::Vector3d &p1 = poses[prev].Pos();
+  const ignition::math::Vector3d &p2 = poses[next].Pos();
+  ignition::math::Vector3d position;
+  if (_interpolation == TrajectoryInterpolation::LINEAR)
+  {
+    position = p1 + (p2 - p1) * t;
+  }
+  else
+  {
+    // Cubic Hermite spline, whose tangents at the waypoints go from the
+    // waypoint before to the waypoint after, the first and last waypoints
+    // being their own neighbors.
+    const ignition::math::Vector3d &p0 = poses[prev > 0 ? prev - 1 : 0].Pos();
+    const ignition::math::Vector3d &p3 =
+        poses[next + 1 < poses.size() ? next + 1 : next].Pos();
+    const double scale = (1.0 - this->dataPtr->tension) / 2.0;
+    const ignition::math::Vector3d m1 = (p2 - p0) * scale;
+    const ignition::math::Vector3d m2 = (p3 - p1) * scale;
+    const double t2 = t * t;
+    const double t3 = t2 * t;
+    position = p1 * (2 * t3 - 3 * t2 + 1) + m1 * (t3 - 2 * t2 + t) +
+        p2 * (-2 * t3 + 3 * t2) + m2 * (t3 - t2);
+  }
+
+  return ignition::math::Pose3d(position,
+      ignition::math::Quaterniond::Slerp(t, poses[prev].Rot(),
+          poses[next].Rot(), true));
+}
+
+/////////////////////////////////////////////////
+void Trajectory::PosesAt(const std::vector<const Trajectory *> &_trajectories,
+    const std::vector<double> &_times,
+    std::vector<ignition::math::Pose3d> &_poses,
+    TrajectoryInterpolation _interpolation)
+{
+  _poses.resize(_trajectories.size());
+  for (std::size_t i = 0; i < _trajectories.size(); ++i)
+  {
+    if (_trajectories[i] && i < _times.size())
+      _poses[i] = _trajectories[i]->PoseAt(_times[i], _interpolation);
+    else
+      _poses[i] = ignition::math::Pose3d::Zero;
+  }
 }
 
 /////////////////////////////////////////////////
@@ -546,7 +726,7 @@ Errors Actor::Load(ElementPtr _sdf)
 {
   Errors errors;
 
-  this->dataPtr->sdf = _sdf;
+  this->dataPtr->sdf = retainedElement(_sdf);
   this->dataPtr->filePath = _sdf->FilePath();
 
   if (_sdf->GetName() != "actor")
@@ -565,7 +745,7 @@ Errors Actor::Load(ElementPtr _sdf)
 
   loadPose(_sdf, this->dataPtr->pose, this->dataPtr->poseRelativeTo);
 
-  sdf::ElementPtr skinElem = _sdf->GetElement("skin");
+  sdf::ElementPtr skinElem = _sdf->FindElement("skin");
 
   if (skinElem)
   {
@@ -589,8 +769,9 @@ Errors Actor::Load(ElementPtr _sdf)
 
   errors.insert(errors.end(), animationLoadErrors.begin(),
                     animationLoadErrors.end());
+  this->dataPtr->animationIndex.Build(this->dataPtr->animations);
 
-  sdf::ElementPtr scriptElem = _sdf->GetElement("script");
+  sdf::ElementPtr scriptElem = _sdf->FindElement("script");
 
   if (!scriptElem)
   {
@@ -620,12 +801,14 @@ Errors Actor::Load(ElementPtr _sdf)
 
   errors.insert(errors.end(), linkLoadErrors.begin(),
                     linkLoadErrors.end());
+  this->dataPtr->linkIndex.Build(this->dataPtr->links);
 
   Errors jointLoadErrors = loadRepeated<Joint>(_sdf, "joint",
     this->dataPtr->joints);
 
   errors.insert(errors.end(), jointLoadErrors.begin(),
                     jointLoadErrors.end());
+  this->dataPtr->jointIndex.Build(this->dataPtr->joints);
 
   return errors;
 }
@@ -640,6 +823,7 @@ std::string &Actor::Name() const
 void Actor::SetName(const std::string &_name)
 {
   this->dataPtr->name = _name;
+  NameIndex::NameChanged();
 }
 
 /////////////////////////////////////////////////
@@ -735,20 +919,17 @@ const Animation *Actor::AnimationByIndex(uint64_t _index) const
 }
 
 /////////////////////////////////////////////////
-bool Actor::AnimationNameExists(const std::string &_name) const
+bool Actor::AnimationNameExists(std::string_view _name) const
 {
-  for (const auto &a : this->dataPtr->animations)
-  {
-    if (a.Name() == _name)
-      return true;
-  }
-  return false;
+  return this->dataPtr->animationIndex.Find(this->dataPtr->animations,
+      _name) != nullptr;
 }
 
 /////////////////////////////////////////////////
 void Actor::AddAnimation(const Animation &_anim)
 {
   this->dataPtr->animations.push_back(_anim);
+  this->dataPtr->animationIndex.AddLast(this->dataPtr->animations);
 }
 
 /////////////////////////////////////////////////
@@ -833,14 +1014,10 @@ const Link *Actor::LinkByIndex(uint64_t _index) const
 }
 
 /////////////////////////////////////////////////
-bool Actor::LinkNameExists(const std::string &_name) const
+bool Actor::LinkNameExists(std::string_view _name) const
 {
-  for (const auto &l : this->dataPtr->links)
-  {
-    if (l.Name() == _name)
-      return true;
-  }
-  return false;
+  return this->dataPtr->linkIndex.Find(this->dataPtr->links, _name) !=
+      nullptr;
 }
 
 /////////////////////////////////////////////////
@@ -858,14 +1035,10 @@ const Joint *Actor::JointByIndex(uint64_t _index) const
 }
 
 /////////////////////////////////////////////////
-bool Actor::JointNameExists(const std::string &_name) const
+bool Actor::JointNameExists(std::string_view _name) const
 {
-  for (const auto &j : this->dataPtr->joints)
-  {
-    if (j.Name() == _name)
-      return true;
-  }
-  return false;
+  return this->dataPtr->jointIndex.Find(this->dataPtr->joints, _name) !=
+      nullptr;
 }
 
 //////////////////////////////////////////////////
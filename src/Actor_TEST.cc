@@ -380,3 +380,108 @@ TEST(DOMActor, Add)
   EXPECT_EQ(456u, actor.TrajectoryByIndex(1)->Id());
   EXPECT_EQ("trajectory2", actor.TrajectoryByIndex(1)->Type());
 }
+
+/////////////////////////////////////////////////
+TEST(DOMActor, TrajectoryPoseAt)
+{
+  sdf::Trajectory traj;
+  EXPECT_EQ(ignition::math::Pose3d::Zero, traj.PoseAt(1.0));
+
+  // Waypoints added out of order are sampled in the order of their times.
+  sdf::Waypoint way;
+  way.SetTime(2.0);
+  way.SetPose(ignition::math::Pose3d(2, 0, 0, 0, 0, 0));
+  traj.AddWaypoint(way);
+  way.SetTime(0.0);
+  way.SetPose(ignition::math::Pose3d(0, 0, 0, 0, 0, 0));
+  traj.AddWaypoint(way);
+  way.SetTime(1.0);
+  way.SetPose(ignition::math::Pose3d(1, 0, 0, 0, 0, IGN_PI_2));
+  traj.AddWaypoint(way);
+  way.SetTime(3.0);
+  way.SetPose(ignition::math::Pose3d(3, 0, 0, 0, 0, 0));
+  traj.AddWaypoint(way);
+  EXPECT_DOUBLE_EQ(2.0, traj.WaypointByIndex(0)->Time());
+
+  // The poses before the first and after the last waypoints are theirs.
+  EXPECT_EQ(ignition::math::Pose3d(0, 0, 0, 0, 0, 0), traj.PoseAt(-1.0));
+  EXPECT_EQ(ignition::math::Pose3d(3, 0, 0, 0, 0, 0), traj.PoseAt(4.0));
+
+  const ignition::math::Pose3d linear =
+      traj.PoseAt(0.5, sdf::TrajectoryInterpolation::LINEAR);
+  EXPECT_NEAR(0.5, linear.Pos().X(), 1e-6);
+  EXPECT_NEAR(IGN_PI_2 / 2, linear.Rot().Yaw(), 1e-6);
+  EXPECT_EQ(ignition::math::Pose3d(1, 0, 0, 0, 0, IGN_PI_2),
+            traj.PoseAt(1.0, sdf::TrajectoryInterpolation::LINEAR));
+
+  // The waypoints are evenly spaced on a line, so the spline is at the
+  // middle of the segment between the two inner waypoints halfway through.
+  const ignition::math::Pose3d spline = traj.PoseAt(1.5);
+  EXPECT_NEAR(1.5, spline.Pos().X(), 1e-6);
+
+  // With a tension of 1, the spline stops at each waypoint, so it is
+  // behind the linear interpolation in the first half of a segment.
+  traj.SetTension(1.0);
+  EXPECT_LT(traj.PoseAt(1.25).Pos().X(),
+            traj.PoseAt(1.25, sdf::TrajectoryInterpolation::LINEAR).Pos().X());
+
+  // The copies keep the time index.
+  sdf::Trajectory traj2(traj);
+  EXPECT_EQ(traj.PoseAt(0.75), traj2.PoseAt(0.75));
+
+  std::vector<ignition::math::Pose3d> poses;
+  sdf::Trajectory::PosesAt({&traj, nullptr, &traj2}, {0.5, 0.5, 1.0}, poses,
+      sdf::TrajectoryInterpolation::LINEAR);
+  ASSERT_EQ(3u, poses.size());
+  EXPECT_EQ(linear, poses[0]);
+  EXPECT_EQ(ignition::math::Pose3d::Zero, poses[1]);
+  EXPECT_EQ(ignition::math::Pose3d(1, 0, 0, 0, 0, IGN_PI_2), poses[2]);
+}
+
+/////////////////////////////////////////////////
+TEST(DOMActor, TrajectoryWaypoints)
+{
+  sdf::Trajectory traj;
+  for (int i = 0; i < 4; ++i)
+  {
+    // Added out of order of time.
+    sdf::Waypoint way;
+    way.SetTime(3 - i);
+    way.SetPose(ignition::math::Pose3d(i, 0, 0, 0, 0, 0));
+    traj.AddWaypoint(way);
+  }
+
+  // The waypoints of a copy are created when they are first accessed, in
+  // the order they were added.
+  sdf::Trajectory traj2(traj);
+  EXPECT_EQ(4u, traj2.WaypointCount());
+  for (uint64_t i = 0; i < 4; ++i)
+  {
+    const sdf::Waypoint *way = traj2.WaypointByIndex(i);
+    ASSERT_NE(nullptr, way);
+    EXPECT_DOUBLE_EQ(3.0 - i, way->Time());
+    EXPECT_EQ(ignition::math::Pose3d(i, 0, 0, 0, 0, 0), way->Pose());
+  }
+  EXPECT_EQ(nullptr, traj2.WaypointByIndex(4));
+
+  sdf::Waypoint way;
+  way.SetTime(1.5);
+  traj2.AddWaypoint(way);
+  EXPECT_EQ(5u, traj2.WaypointCount());
+  ASSERT_NE(nullptr, traj2.WaypointByIndex(4));
+  EXPECT_DOUBLE_EQ(1.5, traj2.WaypointByIndex(4)->Time());
+  EXPECT_EQ(ignition::math::Pose3d(2, 0, 0, 0, 0, 0), traj2.PoseAt(1.0));
+}
+
+/////////////////////////////////////////////////
+TEST(DOMActor, AnimationSharedStrings)
+{
+  sdf::Animation anim1;
+  anim1.SetFilename("walk.dae");
+  sdf::Animation anim2;
+  anim2.SetFilename(std::string("walk") + ".dae");
+
+  // Animations with the same file share its name.
+  EXPECT_EQ(&anim1.Filename(), &anim2.Filename());
+  EXPECT_EQ("walk.dae", anim2.Filename());
+}
@@ -17,6 +17,7 @@
 #include <array>
 #include <string>
 #include "sdf/AirPressure.hh"
+#include "Utils.hh"
 
 using namespace sdf;
 
@@ -78,7 +79,7 @@ Errors AirPressure::Load(ElementPtr _sdf)
 {
   Errors errors;
 
-  this->dataPtr->sdf = _sdf;
+  this->dataPtr->sdf = retainedElement(_sdf);
 
   // Check that the provided SDF element is a <airPressure> element.
   // This is an error that cannot be recovered, so return an error.
@@ -93,9 +94,9 @@ Errors AirPressure::Load(ElementPtr _sdf)
   // Load the noise values.
   if (_sdf->HasElement("pressure"))
   {
-    sdf::ElementPtr elem = _sdf->GetElement("pressure");
+    sdf::ElementPtr elem = _sdf->FindElement("pressure");
     if (elem->HasElement("noise"))
-      this->dataPtr->noise.Load(elem->GetElement("noise"));
+      this->dataPtr->noise.Load(elem->FindElement("noise"));
   }
 
   this->dataPtr->referenceAltitude = _sdf->Get<double>("reference_altitude",
@@ -17,6 +17,7 @@
 #include <array>
 #include <string>
 #include "sdf/Altimeter.hh"
+#include "Utils.hh"
 
 using namespace sdf;
 
@@ -76,7 +77,7 @@ Errors Altimeter::Load(ElementPtr _sdf)
 {
   Errors errors;
 
-  this->dataPtr->sdf = _sdf;
+  this->dataPtr->sdf = retainedElement(_sdf);
 
   // Check that the provided SDF element is a <altimeter> element.
   // This is an error that cannot be recovered, so return an error.
@@ -91,16 +92,16 @@ Errors Altimeter::Load(ElementPtr _sdf)
   // Load the noise values.
   if (_sdf->HasElement("vertical_position"))
   {
-    sdf::ElementPtr elem = _sdf->GetElement("vertical_position");
+    sdf::ElementPtr elem = _sdf->FindElement("vertical_position");
     if (elem->HasElement("noise"))
-      this->dataPtr->verticalPositionNoise.Load(elem->GetElement("noise"));
+      this->dataPtr->verticalPositionNoise.Load(elem->FindElement("noise"));
   }
 
   if (_sdf->HasElement("vertical_velocity"))
   {
-    sdf::ElementPtr elem = _sdf->GetElement("vertical_velocity");
+    sdf::ElementPtr elem = _sdf->FindElement("vertical_velocity");
     if (elem->HasElement("noise"))
-      this->dataPtr->verticalVelocityNoise.Load(elem->GetElement("noise"));
+      this->dataPtr->verticalVelocityNoise.Load(elem->FindElement("noise"));
   }
 
   return errors;
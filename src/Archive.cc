@@ -0,0 +1,530 @@
+/*
+ * Copyright 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#ifdef SDFORMAT_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+#include "sdf/Console.hh"
+#include "sdf/Filesystem.hh"
+#include "Archive.hh"
+#include "MappedFile.hh"
+
+namespace sdf
+{
+inline namespace SDF_VERSION_NAMESPACE {
+
+/// \brief Size of a zip end of central directory record, without comment.
+static const std::size_t kZipEndSize = 22;
+
+/// \brief Size of a zip central directory header, without variable fields.
+static const std::size_t kZipCentralSize = 46;
+
+/// \brief Size of a zip local header, without variable fields.
+static const std::size_t kZipLocalSize = 30;
+
+/// \brief Size of the headers and blocks of a tar archive.
+static const std::size_t kTarBlockSize = 512;
+
+/////////////////////////////////////////////////
+/// \brief Read a little-endian 16-bit integer.
+/// \param[in] _data The bytes.
+/// \return The integer.
+static uint16_t readUint16(const char *_data)
+{
+  const unsigned char *bytes = reinterpret_cast<const unsigned char *>(_data);
+  return static_cast<uint16_t>(bytes[0] | (bytes[1] << 8));
+}
+
+/////////////////////////////////////////////////
+/// \brief Read a little-endian 32-bit integer.
+/// \param[in] _data The bytes.
+/// \return The integer.
+static uint32_t readUint32(const char *_data)
+{
+  const unsigned char *bytes = reinterpret_cast<const unsigned char *>(_data);
+  return static_cast<uint32_t>(bytes[0]) |
+      (static_cast<uint32_t>(bytes[1]) << 8) |
+      (static_cast<uint32_t>(bytes[2]) << 16) |
+      (static_cast<uint32_t>(bytes[3]) << 24);
+}
+
+/////////////////////////////////////////////////
+/// \brief Read a null-terminated field of a tar header.
+/// \param[in] _data The field.
+/// \param[in] _size Size of the field.
+/// \return The field, up to its first null character.
+static std::string tarField(const char *_data, const std::size_t _size)
+{
+  return std::string(_data, std::find(_data, _data + _size, '\0'));
+}
+
+/////////////////////////////////////////////////
+/// \brief Read an octal number of a tar header.
+/// \param[in] _data The field.
+/// \param[in] _size Size of the field.
+/// \param[out] _value The number.
+/// \return False if the field is not an octal number.
+static bool tarOctal(const char *_data, const std::size_t _size,
+                     std::size_t &_value)
+{
+  _value = 0;
+  std::size_t i = 0;
+  while (i < _size && _data[i] == ' ')
+    ++i;
+  bool digits = false;
+  for (; i < _size && _data[i] >= '0' && _data[i] <= '7'; ++i)
+  {
+    if (_value > (std::numeric_limits<std::size_t>::max() >> 3))
+      return false;
+    _value = (_value << 3) | static_cast<std::size_t>(_data[i] - '0');
+    digits = true;
+  }
+  return digits && (i == _size || _data[i] == ' ' || _data[i] == '\0');
+}
+
+/////////////////////////////////////////////////
+/// \brief Normalize the path of a member: separators are forward slashes,
+/// and leading "./" and separators, repeated separators and trailing
+/// separators are removed.
+/// \param[in] _name The path.
+/// \return The normalized path.
+static std::string memberPath(const std::string &_name)
+{
+  std::string path;
+  path.reserve(_name.size());
+  std::size_t start = 0;
+  while (start < _name.size())
+  {
+    std::size_t end = _name.find_first_of("/\\", start);
+    if (end == std::string::npos)
+      end = _name.size();
+    const std::size_t length = end - start;
+    if (length > 0 && !(length == 1 && _name[start] == '.'))
+    {
+      if (!path.empty())
+        path += '/';
+      path.append(_name, start, length);
+    }
+    start = end + 1;
+  }
+  return path;
+}
+
+/////////////////////////////////////////////////
+Archive::Archive(const std::string &_path)
+  : file(new MappedFile(_path))
+{
+  this->writeTime = filesystem::last_write_time(_path);
+  if (!this->file->Valid())
+    return;
+
+  this->directories.insert(std::string());
+  this->valid = this->IndexTar() || this->IndexZip();
+}
+
+/////////////////////////////////////////////////
+Archive::~Archive() = default;
+
+/////////////////////////////////////////////////
+bool Archive::Valid() const
+{
+  return this->valid;
+}
+
+/////////////////////////////////////////////////
+std::size_t Archive::FileCount() const
+{
+  return this->files.size();
+}
+
+/////////////////////////////////////////////////
+void Archive::AddFile(std::string _name, const Entry &_entry)
+{
+  _name = memberPath(_name);
+  if (_name.empty())
+    return;
+
+  const std::size_t slash = _name.rfind('/');
+  if (slash != std::string::npos)
+    this->AddDirectory(_name.substr(0, slash));
+  this->files[std::move(_name)] = _entry;
+}
+
+/////////////////////////////////////////////////
+void Archive::AddDirectory(std::string _name)
+{
+  _name = memberPath(_name);
+  while (!_name.empty() && this->directories.insert(_name).second)
+  {
+    const std::size_t slash = _name.rfind('/');
+    _name.resize(slash == std::string::npos ? 0 : slash);
+  }
+}
+
+/////////////////////////////////////////////////
+bool Archive::IndexZip()
+{
+  const char *data = this->file->Data();
+  const std::size_t size = this->file->Size();
+  if (size < kZipEndSize)
+    return false;
+
+  // The end of central directory record is followed by a comment of at
+  // most 65535 bytes.
+  std::size_t end = size - kZipEndSize;
+  const std::size_t first = end > 0xFFFF ? end - 0xFFFF : 0;
+  while (readUint32(data + end) != 0x06054b50)
+  {
+    if (end == first)
+      return false;
+    --end;
+  }
+
+  const std::size_t count = readUint16(data + end + 10);
+  const std::size_t directorySize = readUint32(data + end + 12);
+  const std::size_t directoryOffset = readUint32(data + end + 16);
+  if (directoryOffset == 0xFFFFFFFF || directorySize == 0xFFFFFFFF)
+  {
+    sdferr << "Zip64 archives are not supported.\n";
+    return false;
+  }
+  if (directoryOffset > end || directorySize > end - directoryOffset)
+    return false;
+
+  std::size_t pos = directoryOffset;
+  const std::size_t directoryEnd = directoryOffset + directorySize;
+  for (std::size_t i = 0; i < count; ++i)
+  {
+    if (directoryEnd - pos < kZipCentralSize ||
+        readUint32(data + pos) != 0x02014b50)
+    {
+      return false;
+    }
+    const char *header = data + pos;
+    const uint16_t flags = readUint16(header + 8);
+    Entry entry;
+    entry.zip = true;
+    entry.method = readUint16(header + 10);
+    entry.storedSize = readUint32(header + 20);
+    entry.size = readUint32(header + 24);
+    const std::size_t nameSize = readUint16(header + 28);
+    const std::size_t variableSize =
+        nameSize + readUint16(header + 30) + readUint16(header + 32);
+    entry.offset = readUint32(header + 42);
+    if (directoryEnd - pos - kZipCentralSize < variableSize)
+      return false;
+
+    std::string name(header + kZipCentralSize, nameSize);
+    if (!name.empty() && name.back() == '/')
+      this->AddDirectory(std::move(name));
+    else if (!(flags & 1))
+      this->AddFile(std::move(name), entry);
+    pos += kZipCentralSize + variableSize;
+  }
+  return true;
+}
+
+/////////////////////////////////////////////////
+bool Archive::IndexTar()
+{
+  const char *data = this->file->Data();
+  const std::size_t size = this->file->Size();
+  if (size < kTarBlockSize || std::memcmp(data + 257, "ustar", 5) != 0)
+    return false;
+
+  // Names longer than the fields of the headers are given by a GNU long
+  // name member, or a pax extended header, before the member.
+  std::string longName;
+  std::size_t pos = 0;
+  while (size - pos >= kTarBlockSize)
+  {
+    const char *header = data + pos;
+    if (header[0] == '\0')
+      break;
+
+    std::size_t memberSize = 0;
+    if (!tarOctal(header + 124, 12, memberSize))
+      return false;
+    const std::size_t dataPos = pos + kTarBlockSize;
+    if (memberSize > size - dataPos)
+      return false;
+
+    std::string name;
+    if (!longName.empty())
+    {
+      name = std::move(longName);
+      longName.clear();
+    }
+    else
+    {
+      name = tarField(header, 100);
+      const std::string prefix = tarField(header + 345, 155);
+      if (!prefix.empty())
+        name = prefix + '/' + name;
+    }
+
+    const char type = header[156];
+    if (type == 'L')
+    {
+      longName = tarField(data + dataPos, memberSize);
+    }
+    else if (type == 'x')
+    {
+      // Records of the form "<length> <key>=<value>\n".
+      std::size_t record = dataPos;
+      const std::size_t recordsEnd = dataPos + memberSize;
+      while (record < recordsEnd)
+      {
+        const char *space = static_cast<const char *>(
+            std::memchr(data + record, ' ', recordsEnd - record));
+        if (!space)
+          break;
+        const std::size_t length = std::strtoul(
+            std::string(data + record, space).c_str(), nullptr, 10);
+        if (length <= static_cast<std::size_t>(space - data) - record + 1 ||
+            length > recordsEnd - record)
+        {
+          break;
+        }
+        const std::string keyValue(space + 1, data + record + length - 1);
+        if (keyValue.compare(0, 5, "path=") == 0)
+          longName = keyValue.substr(5);
+        record += length;
+      }
+    }
+    else if (type == '5')
+    {
+      this->AddDirectory(std::move(name));
+    }
+    else if (type == '0' || type == '\0' || type == '7')
+    {
+      Entry entry;
+      entry.offset = dataPos;
+      entry.storedSize = memberSize;
+      entry.size = memberSize;
+      this->AddFile(std::move(name), entry);
+    }
+
+    pos = dataPos + (memberSize + kTarBlockSize - 1) / kTarBlockSize *
+        kTarBlockSize;
+    if (pos > size)
+      break;
+  }
+  return true;
+}
+
+/////////////////////////////////////////////////
+filesystem::file_status Archive::Status(const std::string &_member) const
+{
+  filesystem::file_status status;
+  if (!this->valid)
+    return status;
+
+  const std::string path = memberPath(_member);
+  if (this->files.count(path))
+    status.type = filesystem::file_type::regular;
+  else if (this->directories.count(path))
+    status.type = filesystem::file_type::directory;
+  else
+    return status;
+  status.write_time = this->writeTime;
+  return status;
+}
+
+/////////////////////////////////////////////////
+bool Archive::Read(const std::string &_member, std::string &_content) const
+{
+  auto iter = this->valid ? this->files.find(memberPath(_member)) :
+      this->files.end();
+  if (iter == this->files.end())
+    return false;
+
+  const Entry &entry = iter->second;
+  const char *data = this->file->Data();
+  const std::size_t size = this->file->Size();
+  std::size_t offset = entry.offset;
+  if (entry.zip)
+  {
+    if (offset > size || size - offset < kZipLocalSize ||
+        readUint32(data + offset) != 0x04034b50)
+    {
+      return false;
+    }
+    offset += kZipLocalSize + readUint16(data + offset + 26) +
+        readUint16(data + offset + 28);
+  }
+  if (offset > size || entry.storedSize > size - offset)
+    return false;
+
+  if (entry.method == 0)
+  {
+    _content.assign(data + offset, entry.storedSize);
+    return true;
+  }
+
+  if (entry.method != 8)
+  {
+    sdferr << "Unsupported compression method [" << entry.method
+           << "] of archive member [" << _member << "].\n";
+    return false;
+  }
+
+#ifdef SDFORMAT_HAVE_ZLIB
+  if (entry.storedSize > std::numeric_limits<uInt>::max() ||
+      entry.size > std::numeric_limits<uInt>::max())
+  {
+    return false;
+  }
+
+  z_stream stream;
+  std::memset(&stream, 0, sizeof(stream));
+  // Negative window bits for raw deflate data, without zlib header.
+  if (inflateInit2(&stream, -MAX_WBITS) != Z_OK)
+    return false;
+  _content.resize(entry.size);
+  stream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(
+      data + offset));
+  stream.avail_in = static_cast<uInt>(entry.storedSize);
+  stream.next_out = reinterpret_cast<Bytef *>(&_content[0]);
+  stream.avail_out = static_cast<uInt>(entry.size);
+  const int result = inflate(&stream, Z_FINISH);
+  inflateEnd(&stream);
+  return result == Z_STREAM_END && stream.avail_out == 0;
+#else
+  sdferr << "Unable to read compressed archive member [" << _member
+         << "], because libsdformat was built without zlib.\n";
+  return false;
+#endif
+}
+
+/// \brief A mounted archive.
+struct MountedArchive
+{
+  /// \brief Path of the archive, without trailing separators.
+  std::string path;
+
+  /// \brief The archive.
+  std::shared_ptr<const Archive> archive;
+};
+
+/// \brief The mounted archives.
+static std::vector<MountedArchive> g_archives;
+
+/// \brief True once an archive is mounted, so that the filesystem
+/// functions skip the archives until then.
+static std::atomic<bool> g_archivesMounted{false};
+
+/// \brief Guards g_archives.
+static std::mutex g_archivesMutex;
+
+/////////////////////////////////////////////////
+/// \brief Remove the trailing separators of a path.
+/// \param[in] _path The path.
+/// \return The path without trailing separators, except for a root path.
+static std::string trimSeparators(std::string _path)
+{
+  while (_path.size() > 1 && (_path.back() == '/' || _path.back() == '\\'))
+    _path.pop_back();
+  return _path;
+}
+
+/////////////////////////////////////////////////
+/// \brief Find the mounted archive of a path.
+/// \param[in] _path The path.
+/// \param[out] _member Path of the member in the archive.
+/// \return The archive, or nullptr if the path is not in a mounted
+/// archive.
+static std::shared_ptr<const Archive> findArchive(const std::string &_path,
+    std::string &_member)
+{
+  if (!g_archivesMounted.load(std::memory_order_acquire))
+    return nullptr;
+
+  std::lock_guard<std::mutex> lock(g_archivesMutex);
+  for (const MountedArchive &mounted : g_archives)
+  {
+    const std::string &path = mounted.path;
+    if (_path.compare(0, path.size(), path) != 0)
+      continue;
+    if (_path.size() == path.size())
+    {
+      _member.clear();
+      return mounted.archive;
+    }
+    if (_path[path.size()] == '/' || _path[path.size()] == '\\')
+    {
+      _member = _path.substr(path.size() + 1);
+      return mounted.archive;
+    }
+  }
+  return nullptr;
+}
+
+/////////////////////////////////////////////////
+bool mountArchive(const std::string &_path)
+{
+  const std::string path = trimSeparators(_path);
+  {
+    std::lock_guard<std::mutex> lock(g_archivesMutex);
+    for (const MountedArchive &mounted : g_archives)
+    {
+      if (mounted.path == path)
+        return true;
+    }
+  }
+
+  auto archive = std::make_shared<const Archive>(path);
+  if (!archive->Valid())
+    return false;
+
+  std::lock_guard<std::mutex> lock(g_archivesMutex);
+  g_archives.push_back({path, std::move(archive)});
+  g_archivesMounted.store(true, std::memory_order_release);
+  return true;
+}
+
+/////////////////////////////////////////////////
+bool archiveStatus(const std::string &_path,
+                   filesystem::file_status &_status)
+{
+  std::string member;
+  const std::shared_ptr<const Archive> archive = findArchive(_path, member);
+  if (!archive)
+    return false;
+  _status = archive->Status(member);
+  return true;
+}
+
+/////////////////////////////////////////////////
+bool readArchiveFile(const std::string &_path, std::string &_content)
+{
+  std::string member;
+  const std::shared_ptr<const Archive> archive = findArchive(_path, member);
+  return archive && archive->Read(member, _content);
+}
+}
+}
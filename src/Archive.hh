@@ -0,0 +1,167 @@
+/*
+ * Copyright 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#ifndef SDF_ARCHIVE_HH_
+#define SDF_ARCHIVE_HH_
+
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "sdf/Filesystem.hh"
+#include "sdf/sdf_config.h"
+
+namespace sdf
+{
+  // Inline bracket to help doxygen filtering.
+  inline namespace SDF_VERSION_NAMESPACE {
+  //
+
+  class MappedFile;
+
+  /// \brief A zip or tar archive of files, such as a library of models,
+  /// mapped into memory with an index of its members, so that the members
+  /// are read without extracting the archive.
+  ///
+  /// The index of a zip archive is read from its central directory, and
+  /// that of a tar archive from the headers of its members, which are
+  /// skipped over without reading the members. Zip members are stored or
+  /// compressed with deflate, which needs zlib. Tar archives are ustar or
+  /// GNU archives, and cannot be compressed as a whole, since the members
+  /// of a compressed tar archive cannot be found without decompressing it.
+  class Archive
+  {
+    /// \brief Constructor. Maps the archive and reads its index.
+    /// \param[in] _path Path of the archive.
+    public: explicit Archive(const std::string &_path);
+
+    /// \brief Copy constructor is explicitly deleted.
+    public: Archive(const Archive &) = delete;
+
+    /// \brief Copy assignment is explicitly deleted.
+    public: Archive &operator=(const Archive &) = delete;
+
+    /// \brief Destructor. Unmaps the archive.
+    public: ~Archive();
+
+    /// \brief Get whether the file is a zip or tar archive whose index was
+    /// read.
+    /// \return True if the archive is valid.
+    public: bool Valid() const;
+
+    /// \brief Get the status of a member, like filesystem::status. The
+    /// directories of the archive are those listed in it and those that
+    /// hold members, and the write time of the members is that of the
+    /// archive.
+    /// \param[in] _member Path of the member in the archive, without
+    /// leading separator. An empty path is the root directory.
+    /// \return The status of the member.
+    public: filesystem::file_status Status(const std::string &_member) const;
+
+    /// \brief Read a file of the archive.
+    /// \param[in] _member Path of the file in the archive.
+    /// \param[out] _content The content of the file.
+    /// \return False if the member is not a file, or cannot be read.
+    public: bool Read(const std::string &_member,
+                      std::string &_content) const;
+
+    /// \brief Get the number of files of the archive.
+    /// \return Number of files.
+    public: std::size_t FileCount() const;
+
+    /// \brief A file of the archive.
+    private: struct Entry
+    {
+      /// \brief Offset of the zip local header, or of the tar data.
+      std::size_t offset = 0;
+
+      /// \brief Number of stored bytes.
+      std::size_t storedSize = 0;
+
+      /// \brief Number of bytes of the file.
+      std::size_t size = 0;
+
+      /// \brief Zip compression method, 0 when stored and 8 for deflate.
+      uint16_t method = 0;
+
+      /// \brief True if offset is that of a zip local header.
+      bool zip = false;
+    };
+
+    /// \brief Read the central directory of a zip archive.
+    /// \return False if the file is not a zip archive.
+    private: bool IndexZip();
+
+    /// \brief Read the headers of a tar archive.
+    /// \return False if the file is not a tar archive.
+    private: bool IndexTar();
+
+    /// \brief Add a file to the index, and its parents to the directories.
+    /// \param[in] _name Path of the file in the archive.
+    /// \param[in] _entry The file.
+    private: void AddFile(std::string _name, const Entry &_entry);
+
+    /// \brief Add a directory and its parents to the directories.
+    /// \param[in] _name Path of the directory in the archive.
+    private: void AddDirectory(std::string _name);
+
+    /// \brief The mapped archive.
+    private: std::unique_ptr<MappedFile> file;
+
+    /// \brief The files, by path.
+    private: std::unordered_map<std::string, Entry> files;
+
+    /// \brief The paths of the directories, including the root directory,
+    /// which is empty.
+    private: std::unordered_set<std::string> directories;
+
+    /// \brief Time at which the archive was last modified.
+    private: std::time_t writeTime = static_cast<std::time_t>(-1);
+
+    /// \brief True if the index was read.
+    private: bool valid = false;
+  };
+
+  /// \brief Mount an archive, so that its members are found by findFile,
+  /// reported by the functions of sdf::filesystem, and read by loadXmlFile
+  /// at paths below the path of the archive, as if the archive was a
+  /// directory. Mounting an archive again does nothing.
+  /// \param[in] _path Path of the archive.
+  /// \return False if the file is not a valid archive.
+  bool mountArchive(const std::string &_path);
+
+  /// \brief Get the status of a path if it is a mounted archive or is
+  /// below one, which the filesystem functions check first.
+  /// \param[in] _path The path.
+  /// \param[out] _status The status of the member, which is not found if
+  /// the archive has no such member.
+  /// \return False if the path is not in a mounted archive.
+  bool archiveStatus(const std::string &_path,
+                     filesystem::file_status &_status);
+
+  /// \brief Read a file of a mounted archive.
+  /// \param[in] _path Path of the file, below the path of its archive.
+  /// \param[out] _content The content of the file.
+  /// \return False if the path is not a file of a mounted archive, or the
+  /// file cannot be read.
+  bool readArchiveFile(const std::string &_path, std::string &_content);
+  }
+}
+#endif
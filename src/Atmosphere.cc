@@ -15,12 +15,22 @@
  *
  */
 
+#include <cmath>
 #include <string>
 #include <ignition/math/Helpers.hh>
 #include "sdf/Atmosphere.hh"
 
 using namespace sdf;
 
+/// \brief Standard gravity in m/s^2.
+constexpr double kGravity = 9.80665;
+
+/// \brief Molar mass of dry air in kg/mol.
+constexpr double kMolarMass = 0.0289644;
+
+/// \brief Universal gas constant in J/(mol K).
+constexpr double kGasConstant = 8.3144598;
+
 class sdf::AtmospherePrivate
 {
   /// \brief The type of the atmosphere engine.
@@ -180,3 +190,55 @@ bool Atmosphere::operator==(const Atmosphere &_atmosphere)
     ignition::math::equal(this->dataPtr->pressure,
                           _atmosphere.dataPtr->pressure);
 }
+
+//////////////////////////////////////////////////
+double Atmosphere::TemperatureAt(const double _altitude) const
+{
+  return this->dataPtr->temperature.Kelvin() +
+      this->dataPtr->temperatureGradient * _altitude;
+}
+
+//////////////////////////////////////////////////
+double Atmosphere::PressureAt(const double _altitude) const
+{
+  const double seaLevelTemperature = this->dataPtr->temperature.Kelvin();
+  const double gradient = this->dataPtr->temperatureGradient;
+  if (ignition::math::equal(gradient, 0.0))
+  {
+    return this->dataPtr->pressure * std::exp(
+        -kGravity * kMolarMass * _altitude /
+        (kGasConstant * seaLevelTemperature));
+  }
+  const double temperature = this->TemperatureAt(_altitude);
+  if (temperature <= 0.0)
+    return 0.0;
+  return this->dataPtr->pressure * std::pow(
+      temperature / seaLevelTemperature,
+      -kGravity * kMolarMass / (kGasConstant * gradient));
+}
+
+//////////////////////////////////////////////////
+AtmosphereTable Atmosphere::Table(const double _minAltitude,
+    const double _maxAltitude, const double _resolution) const
+{
+  AtmosphereTable table;
+  if (!(_resolution > 0.0) || !(_maxAltitude >= _minAltitude) ||
+      !std::isfinite(_maxAltitude - _minAltitude))
+  {
+    return table;
+  }
+
+  table.minAltitude = _minAltitude;
+  table.resolution = _resolution;
+  const std::size_t count = static_cast<std::size_t>(
+      std::ceil((_maxAltitude - _minAltitude) / _resolution)) + 1;
+  table.temperatures.reserve(count);
+  table.pressures.reserve(count);
+  for (std::size_t i = 0; i < count; ++i)
+  {
+    const double altitude = _minAltitude + static_cast<double>(i) * _resolution;
+    table.temperatures.push_back(this->TemperatureAt(altitude));
+    table.pressures.push_back(this->PressureAt(altitude));
+  }
+  return table;
+}
@@ -130,3 +130,39 @@ TEST(DOMAtmosphere, CopyAssignmentAfterMove)
   EXPECT_DOUBLE_EQ(200.0, atmosphere1.Temperature().Kelvin());
   EXPECT_DOUBLE_EQ(100.0, atmosphere2.Temperature().Kelvin());
 }
+
+/////////////////////////////////////////////////
+TEST(DOMAtmosphere, Table)
+{
+  sdf::Atmosphere atmosphere;
+  EXPECT_DOUBLE_EQ(288.15, atmosphere.TemperatureAt(0));
+  EXPECT_DOUBLE_EQ(288.15 - 65, atmosphere.TemperatureAt(1000));
+  EXPECT_DOUBLE_EQ(101325, atmosphere.PressureAt(0));
+  EXPECT_LT(atmosphere.PressureAt(1000), atmosphere.PressureAt(0));
+  EXPECT_DOUBLE_EQ(0.0, atmosphere.PressureAt(10000));
+
+  const sdf::AtmosphereTable table = atmosphere.Table(-100, 1005, 10);
+  EXPECT_DOUBLE_EQ(-100, table.minAltitude);
+  ASSERT_EQ(112u, table.pressures.size());
+  ASSERT_EQ(112u, table.temperatures.size());
+  for (double altitude = -100; altitude < 1000; altitude += 3.7)
+  {
+    EXPECT_NEAR(atmosphere.TemperatureAt(altitude),
+        table.Temperature(altitude), 1e-9);
+    EXPECT_NEAR(atmosphere.PressureAt(altitude),
+        table.Pressure(altitude), 0.05);
+  }
+
+  // Altitudes outside of the table are clamped.
+  EXPECT_DOUBLE_EQ(table.pressures.front(), table.Pressure(-500));
+  EXPECT_DOUBLE_EQ(table.pressures.back(), table.Pressure(5000));
+
+  // Without gradient, the pressure decreases exponentially.
+  atmosphere.SetTemperatureGradient(0);
+  EXPECT_DOUBLE_EQ(288.15, atmosphere.TemperatureAt(1000));
+  EXPECT_NEAR(89997, atmosphere.PressureAt(1000), 1);
+
+  EXPECT_TRUE(atmosphere.Table(0, 100, 0).pressures.empty());
+  EXPECT_TRUE(atmosphere.Table(100, 0, 1).pressures.empty());
+  EXPECT_DOUBLE_EQ(0.0, sdf::AtmosphereTable().Pressure(0));
+}
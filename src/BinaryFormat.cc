@@ -0,0 +1,798 @@
+/*
+ * Copyright 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <variant>
+#include <vector>
+
+#include <ignition/math/Angle.hh>
+#include <ignition/math/Color.hh>
+#include <ignition/math/Pose3.hh>
+#include <ignition/math/Quaternion.hh>
+#include <ignition/math/Vector2.hh>
+#include <ignition/math/Vector3.hh>
+
+#include "sdf/Param.hh"
+#include "BinaryFormat.hh"
+
+using namespace sdf;
+
+namespace
+{
+  /// \brief Type of the values of a Param.
+  using ParamVariant = ParamPrivate::ParamVariant;
+
+  /// \brief First bytes of a binary document.
+  const char kMagic[4] = {'S', 'D', 'F', 'B'};
+
+  /// \brief Version of the binary format, which is increased whenever the
+  /// layout of the records changes.
+  const std::uint32_t kFormatVersion = 1;
+
+  /// \brief Written in native byte order, to detect documents written on a
+  /// machine with another byte order.
+  const std::uint32_t kByteOrderMark = 0x01020304;
+
+  /// \brief The element is a copy of an element description of its parent.
+  const std::uint8_t kElementDescribed = 0x1;
+
+  /// \brief The element copies its unknown children.
+  const std::uint8_t kElementCopyChildren = 0x2;
+
+  /// \brief The element has a value.
+  const std::uint8_t kElementHasValue = 0x4;
+
+  /// \brief The parameter is required.
+  const std::uint8_t kParamRequired = 0x1;
+
+  /// \brief The parameter is set, and its value follows.
+  const std::uint8_t kParamSet = 0x2;
+
+  /// \brief Builds a binary document.
+  class BinaryWriter
+  {
+    /// \brief Get the index of a string in the string table, adding it if
+    /// it is a new string.
+    /// \param[in] _str The string.
+    /// \return Index of _str.
+    public: std::uint32_t Intern(const std::string &_str)
+    {
+      auto inserted = this->stringIds.emplace(_str,
+          static_cast<std::uint32_t>(this->strings.size()));
+      if (inserted.second)
+        this->strings.push_back(&inserted.first->first);
+      return inserted.first->second;
+    }
+
+    /// \brief Append a number to the element tree.
+    /// \param[in] _value The number.
+    public: template<typename T>
+            void Put(const T _value)
+    {
+      static_assert(std::is_arithmetic_v<T>, "Only numbers are written");
+      char bytes[sizeof(T)];
+      std::memcpy(bytes, &_value, sizeof(T));
+      this->tree.append(bytes, sizeof(T));
+    }
+
+    /// \brief Overwrite a number written earlier.
+    /// \param[in] _offset Offset of the number in the element tree.
+    /// \param[in] _value The number.
+    public: void Patch(const std::size_t _offset, const std::uint32_t _value)
+    {
+      std::memcpy(&this->tree[_offset], &_value, sizeof(_value));
+    }
+
+    /// \brief Append the index of a string to the element tree.
+    /// \param[in] _str The string.
+    public: void PutString(const std::string &_str)
+    {
+      this->Put(this->Intern(_str));
+    }
+
+    /// \brief Append the value of a Param, preceded by its variant index.
+    /// \param[in] _param The Param.
+    public: template<std::size_t I = 0>
+            void PutValue(const Param &_param)
+    {
+      if constexpr (I < std::variant_size_v<ParamVariant>)
+      {
+        using T = std::variant_alternative_t<I, ParamVariant>;
+        T value;
+        if (_param.IsType<T>() && _param.Get(value))
+        {
+          this->Put(static_cast<std::uint8_t>(I));
+          this->PutPayload(value);
+        }
+        else
+        {
+          this->PutValue<I + 1>(_param);
+        }
+      }
+      else
+      {
+        // Every type of ParamVariant is handled above, so this is only
+        // reached if Get fails. The string is parsed by the reader.
+        this->Put(static_cast<std::uint8_t>(
+              ParamVariant(std::string()).index()));
+        this->PutString(_param.GetAsString());
+      }
+    }
+
+    /// \brief Append a number.
+    /// \param[in] _value The number.
+    public: template<typename T>
+            void PutPayload(const T &_value)
+    {
+      this->Put(_value);
+    }
+
+    /// \brief Append a string.
+    /// \param[in] _value The string.
+    public: void PutPayload(const std::string &_value)
+    {
+      this->PutString(_value);
+    }
+
+    /// \brief Append a time.
+    /// \param[in] _value The time.
+    public: void PutPayload(const Time &_value)
+    {
+      this->Put(_value.sec);
+      this->Put(_value.nsec);
+    }
+
+    /// \brief Append an angle.
+    /// \param[in] _value The angle.
+    public: void PutPayload(const ignition::math::Angle &_value)
+    {
+      this->Put(_value.Radian());
+    }
+
+    /// \brief Append a color.
+    /// \param[in] _value The color.
+    public: void PutPayload(const ignition::math::Color &_value)
+    {
+      this->Put(_value.R());
+      this->Put(_value.G());
+      this->Put(_value.B());
+      this->Put(_value.A());
+    }
+
+    /// \brief Append a 2D vector.
+    /// \param[in] _value The vector.
+    public: template<typename T>
+            void PutPayload(const ignition::math::Vector2<T> &_value)
+    {
+      this->Put(_value.X());
+      this->Put(_value.Y());
+    }
+
+    /// \brief Append a 3D vector.
+    /// \param[in] _value The vector.
+    public: void PutPayload(const ignition::math::Vector3d &_value)
+    {
+      this->Put(_value.X());
+      this->Put(_value.Y());
+      this->Put(_value.Z());
+    }
+
+    /// \brief Append a quaternion.
+    /// \param[in] _value The quaternion.
+    public: void PutPayload(const ignition::math::Quaterniond &_value)
+    {
+      this->Put(_value.W());
+      this->Put(_value.X());
+      this->Put(_value.Y());
+      this->Put(_value.Z());
+    }
+
+    /// \brief Append a pose.
+    /// \param[in] _value The pose.
+    public: void PutPayload(const ignition::math::Pose3d &_value)
+    {
+      this->PutPayload(_value.Pos());
+      this->PutPayload(_value.Rot());
+    }
+
+    /// \brief Append a Param. The type name and default value are only
+    /// used by the reader when the Param is not part of a description.
+    /// \param[in] _param The Param.
+    public: void PutParam(const Param &_param)
+    {
+      this->PutString(_param.GetKey());
+      this->PutString(_param.GetTypeName());
+      this->PutString(_param.GetDefaultAsString());
+
+      std::uint8_t flags = 0;
+      if (_param.GetRequired())
+        flags |= kParamRequired;
+      if (_param.GetSet())
+        flags |= kParamSet;
+      this->Put(flags);
+
+      if (_param.GetSet())
+        this->PutValue(_param);
+    }
+
+    /// \brief Append an element and its descendants.
+    /// \param[in] _elem The element.
+    /// \param[in] _described True if _elem is a copy of an element
+    /// description of its parent.
+    public: void PutElement(const ElementPtr &_elem, const bool _described)
+    {
+      const std::size_t start = this->tree.size();
+      this->Put(std::uint32_t(0));
+
+      this->PutString(_elem->GetName());
+
+      std::uint8_t flags = 0;
+      if (_described)
+        flags |= kElementDescribed;
+      if (_elem->GetCopyChildren())
+        flags |= kElementCopyChildren;
+      if (_elem->GetValue())
+        flags |= kElementHasValue;
+      this->Put(flags);
+
+      this->PutString(_elem->FilePath());
+      this->PutString(_elem->OriginalVersion());
+      this->PutString(_elem->GetInclude());
+
+      const std::size_t attributeCount = _elem->GetAttributeCount();
+      this->Put(static_cast<std::uint32_t>(attributeCount));
+      for (std::size_t i = 0; i < attributeCount; ++i)
+      {
+        this->PutParam(*_elem->GetAttribute(static_cast<unsigned int>(i)));
+      }
+
+      if (_elem->GetValue())
+        this->PutParam(*_elem->GetValue());
+
+      const std::size_t countOffset = this->tree.size();
+      this->Put(std::uint32_t(0));
+      std::uint32_t childCount = 0;
+      for (const ElementPtr &child : _elem->Children())
+      {
+        this->PutElement(child,
+            _elem->HasElementDescription(child->GetName()));
+        ++childCount;
+      }
+      this->Patch(countOffset, childCount);
+
+      this->Patch(start, static_cast<std::uint32_t>(this->tree.size() - start));
+    }
+
+    /// \brief Get the whole document.
+    /// \param[out] _out The document.
+    public: void Finish(std::string &_out)
+    {
+      // The schema version is interned before the table is written.
+      const std::uint32_t versionId = this->Intern(SDF::Version());
+
+      std::string header(kMagic, sizeof(kMagic));
+      this->tree.swap(header);
+      this->Put(kFormatVersion);
+      this->Put(kByteOrderMark);
+      this->Put(versionId);
+      this->Put(static_cast<std::uint32_t>(this->strings.size()));
+      for (const std::string *str : this->strings)
+      {
+        this->Put(static_cast<std::uint32_t>(str->size()));
+        this->tree.append(*str);
+      }
+      this->tree.swap(header);
+
+      _out.clear();
+      _out.reserve(header.size() + this->tree.size());
+      _out.append(header);
+      _out.append(this->tree);
+    }
+
+    /// \brief Index of each string in the string table.
+    private: std::unordered_map<std::string, std::uint32_t> stringIds;
+
+    /// \brief The string table, which points to the keys of stringIds.
+    private: std::vector<const std::string *> strings;
+
+    /// \brief The element tree.
+    private: std::string tree;
+  };
+
+  /// \brief Reads a binary document. Every read checks the bounds of the
+  /// document, so a truncated document fails to load instead of crashing.
+  class BinaryReader
+  {
+    /// \brief Constructor.
+    /// \param[in] _data The document.
+    /// \param[in] _size Number of bytes of the document.
+    public: BinaryReader(const char *_data, const std::size_t _size)
+      : data(_data), end(_data + _size)
+    {
+    }
+
+    /// \brief Read a number.
+    /// \param[out] _value The number.
+    /// \return False if the document is too short.
+    public: template<typename T>
+            bool Get(T &_value)
+    {
+      static_assert(std::is_arithmetic_v<T>, "Only numbers are read");
+      if (static_cast<std::size_t>(this->end - this->data) < sizeof(T))
+        return false;
+      std::memcpy(&_value, this->data, sizeof(T));
+      this->data += sizeof(T);
+      return true;
+    }
+
+    /// \brief Read the string table.
+    /// \return False if the table is truncated.
+    public: bool GetStrings()
+    {
+      std::uint32_t count = 0;
+      if (!this->Get(count))
+        return false;
+
+      // Each string takes at least 4 bytes, which bounds the reservation
+      // for a corrupt count.
+      if (count > static_cast<std::size_t>(this->end - this->data) / 4)
+        return false;
+
+      this->strings.reserve(count);
+      for (std::uint32_t i = 0; i < count; ++i)
+      {
+        std::uint32_t size = 0;
+        if (!this->Get(size) ||
+            static_cast<std::size_t>(this->end - this->data) < size)
+        {
+          return false;
+        }
+        this->strings.emplace_back(this->data, size);
+        this->data += size;
+      }
+      return true;
+    }
+
+    /// \brief Read a string index.
+    /// \param[out] _value The string.
+    /// \return False if the document is too short or the index is invalid.
+    public: bool GetString(const std::string *&_value)
+    {
+      std::uint32_t id = 0;
+      if (!this->Get(id) || id >= this->strings.size())
+        return false;
+      _value = &this->strings[id];
+      return true;
+    }
+
+    /// \brief Read a number.
+    /// \param[out] _value The number.
+    /// \return False if the document is too short.
+    public: template<typename T>
+            bool GetPayload(T &_value)
+    {
+      return this->Get(_value);
+    }
+
+    /// \brief Read a string.
+    /// \param[out] _value The string.
+    /// \return False if the document is too short.
+    public: bool GetPayload(std::string &_value)
+    {
+      const std::string *str = nullptr;
+      if (!this->GetString(str))
+        return false;
+      _value = *str;
+      return true;
+    }
+
+    /// \brief Read a time.
+    /// \param[out] _value The time.
+    /// \return False if the document is too short.
+    public: bool GetPayload(Time &_value)
+    {
+      return this->Get(_value.sec) && this->Get(_value.nsec);
+    }
+
+    /// \brief Read an angle.
+    /// \param[out] _value The angle.
+    /// \return False if the document is too short.
+    public: bool GetPayload(ignition::math::Angle &_value)
+    {
+      double radian = 0;
+      if (!this->Get(radian))
+        return false;
+      _value = ignition::math::Angle(radian);
+      return true;
+    }
+
+    /// \brief Read a color.
+    /// \param[out] _value The color.
+    /// \return False if the document is too short.
+    public: bool GetPayload(ignition::math::Color &_value)
+    {
+      float r = 0, g = 0, b = 0, a = 0;
+      if (!this->Get(r) || !this->Get(g) || !this->Get(b) || !this->Get(a))
+        return false;
+      _value = ignition::math::Color(r, g, b, a);
+      return true;
+    }
+
+    /// \brief Read a 2D vector.
+    /// \param[out] _value The vector.
+    /// \return False if the document is too short.
+    public: template<typename T>
+            bool GetPayload(ignition::math::Vector2<T> &_value)
+    {
+      T x = 0, y = 0;
+      if (!this->Get(x) || !this->Get(y))
+        return false;
+      _value = ignition::math::Vector2<T>(x, y);
+      return true;
+    }
+
+    /// \brief Read a 3D vector.
+    /// \param[out] _value The vector.
+    /// \return False if the document is too short.
+    public: bool GetPayload(ignition::math::Vector3d &_value)
+    {
+      double x = 0, y = 0, z = 0;
+      if (!this->Get(x) || !this->Get(y) || !this->Get(z))
+        return false;
+      _value = ignition::math::Vector3d(x, y, z);
+      return true;
+    }
+
+    /// \brief Read a quaternion.
+    /// \param[out] _value The quaternion.
+    /// \return False if the document is too short.
+    public: bool GetPayload(ignition::math::Quaterniond &_value)
+    {
+      double w = 0, x = 0, y = 0, z = 0;
+      if (!this->Get(w) || !this->Get(x) || !this->Get(y) || !this->Get(z))
+        return false;
+      _value = ignition::math::Quaterniond(w, x, y, z);
+      return true;
+    }
+
+    /// \brief Read a pose.
+    /// \param[out] _value The pose.
+    /// \return False if the document is too short.
+    public: bool GetPayload(ignition::math::Pose3d &_value)
+    {
+      ignition::math::Vector3d pos;
+      ignition::math::Quaterniond rot;
+      if (!this->GetPayload(pos) || !this->GetPayload(rot))
+        return false;
+      _value = ignition::math::Pose3d(pos, rot);
+      return true;
+    }
+
+    /// \brief Read a value of a Param and set it.
+    /// \param[in] _index Variant index of the value.
+    /// \param[in] _param The Param.
+    /// \return False if the document is too short, or the index is
+    /// invalid.
+    public: template<std::size_t I = 0>
+            bool GetValue(const std::uint8_t _index, Param &_param)
+    {
+      if constexpr (I < std::variant_size_v<ParamVariant>)
+      {
+        if (_index != I)
+          return this->GetValue<I + 1>(_index, _param);
+
+        std::variant_alternative_t<I, ParamVariant> value;
+        return this->GetPayload(value) && _param.Set(value);
+      }
+      else
+      {
+        return false;
+      }
+    }
+
+    /// \brief Read a Param of an element.
+    /// \param[in] _elem The element.
+    /// \param[in] _isValue True to read the value of the element, false to
+    /// read an attribute.
+    /// \return False if the record is invalid.
+    public: bool GetParam(const ElementPtr &_elem, const bool _isValue)
+    {
+      const std::string *key = nullptr;
+      const std::string *typeName = nullptr;
+      const std::string *defaultValue = nullptr;
+      std::uint8_t flags = 0;
+      if (!this->GetString(key) || !this->GetString(typeName) ||
+          !this->GetString(defaultValue) || !this->Get(flags))
+      {
+        return false;
+      }
+
+      ParamPtr param = _isValue ? _elem->GetValue() : _elem->GetAttribute(*key);
+      if (!param)
+      {
+        // Parameters that are not part of the description, such as the
+        // values of unknown elements copied from the xml.
+        const bool required = (flags & kParamRequired) != 0;
+        if (_isValue)
+        {
+          _elem->AddValue(*typeName, *defaultValue, required);
+          param = _elem->GetValue();
+        }
+        else
+        {
+          _elem->AddAttribute(*key, *typeName, *defaultValue, required);
+          param = _elem->GetAttribute(*key);
+        }
+        if (!param)
+          return false;
+      }
+
+      if ((flags & kParamSet) == 0)
+        return true;
+
+      std::uint8_t index = 0;
+      return this->Get(index) && this->GetValue(index, *param);
+    }
+
+    /// \brief Read an element record into an element.
+    /// \param[in] _elem The element, which is a copy of the description
+    /// named in the record, or a new element for an element that is not
+    /// described.
+    /// \param[in] _flags Flags of the record.
+    /// \param[in] _recordEnd End of the record.
+    /// \return False if the record is invalid.
+    public: bool GetElementContents(const ElementPtr &_elem,
+                                    const std::uint8_t _flags,
+                                    const char *_recordEnd)
+    {
+      const std::string *path = nullptr;
+      const std::string *originalVersion = nullptr;
+      const std::string *include = nullptr;
+      if (!this->GetString(path) || !this->GetString(originalVersion) ||
+          !this->GetString(include))
+      {
+        return false;
+      }
+      if (!path->empty())
+        _elem->SetFilePath(*path);
+      if (!originalVersion->empty())
+        _elem->SetOriginalVersion(*originalVersion);
+      if (!include->empty())
+        _elem->SetInclude(*include);
+      if ((_flags & kElementCopyChildren) != 0)
+        _elem->SetCopyChildren(true);
+
+      std::uint32_t attributeCount = 0;
+      if (!this->Get(attributeCount))
+        return false;
+      for (std::uint32_t i = 0; i < attributeCount; ++i)
+      {
+        if (!this->GetParam(_elem, false))
+          return false;
+      }
+
+      if ((_flags & kElementHasValue) != 0 && !this->GetParam(_elem, true))
+        return false;
+
+      std::uint32_t childCount = 0;
+      if (!this->Get(childCount))
+        return false;
+      for (std::uint32_t i = 0; i < childCount; ++i)
+      {
+        if (!this->GetChild(_elem))
+          return false;
+      }
+
+      return this->data == _recordEnd;
+    }
+
+    /// \brief Read the header of an element record.
+    /// \param[out] _name Name of the element.
+    /// \param[out] _flags Flags of the record.
+    /// \param[out] _recordEnd End of the record.
+    /// \return False if the header is invalid.
+    public: bool GetElementHeader(const std::string *&_name,
+                                  std::uint8_t &_flags,
+                                  const char *&_recordEnd)
+    {
+      const char *start = this->data;
+      std::uint32_t size = 0;
+      if (!this->Get(size) ||
+          size > static_cast<std::size_t>(this->end - start))
+      {
+        return false;
+      }
+      _recordEnd = start + size;
+      return this->GetString(_name) && this->Get(_flags);
+    }
+
+    /// \brief Read the record of a child element, and add the child to its
+    /// parent.
+    /// \param[in] _parent The parent element.
+    /// \return False if the record is invalid.
+    public: bool GetChild(const ElementPtr &_parent)
+    {
+      const std::string *name = nullptr;
+      std::uint8_t flags = 0;
+      const char *recordEnd = nullptr;
+      if (!this->GetElementHeader(name, flags, recordEnd))
+        return false;
+
+      ElementPtr elem;
+      if ((flags & kElementDescribed) != 0)
+      {
+        ElementPtr desc = _parent->GetElementDescription(*name);
+        if (!desc)
+        {
+          this->errorElement = name;
+          return false;
+        }
+        elem = desc->Clone();
+      }
+      else
+      {
+        elem.reset(new Element);
+        elem->SetName(*name);
+      }
+      elem->SetParent(_parent);
+
+      // Elements are read recursively, so a document nested too deeply
+      // would overflow the call stack.
+      if (this->maxNestingDepth > 0 && this->depth >= this->maxNestingDepth)
+      {
+        this->deepElement = name;
+        return false;
+      }
+
+      ++this->depth;
+      const bool read = this->GetElementContents(elem, flags, recordEnd);
+      --this->depth;
+      if (!read)
+        return false;
+
+      _parent->InsertElement(elem);
+      return true;
+    }
+
+    /// \brief Position of the next byte to read.
+    public: const char *data;
+
+    /// \brief End of the document.
+    public: const char *end;
+
+    /// \brief The string table.
+    public: std::vector<std::string> strings;
+
+    /// \brief Name of an element that is not part of the description of its
+    /// parent, which is the case if the document was written with another
+    /// version of the spec.
+    public: const std::string *errorElement = nullptr;
+
+    /// \brief Deepest nesting of elements that is read, or 0 for no limit.
+    public: std::size_t maxNestingDepth = 0;
+
+    /// \brief Depth of the element whose contents are read, where the root
+    /// element has a depth of 1.
+    public: std::size_t depth = 1;
+
+    /// \brief Name of an element that is nested deeper than
+    /// maxNestingDepth, if any.
+    public: const std::string *deepElement = nullptr;
+  };
+}
+
+/////////////////////////////////////////////////
+void sdf::writeBinary(const ElementPtr &_root, std::string &_out)
+{
+  BinaryWriter writer;
+  writer.PutElement(_root, true);
+  writer.Finish(_out);
+}
+
+/////////////////////////////////////////////////
+bool sdf::isBinary(const char *_data, const std::size_t _size)
+{
+  return _size >= sizeof(kMagic) &&
+      std::memcmp(_data, kMagic, sizeof(kMagic)) == 0;
+}
+
+/////////////////////////////////////////////////
+bool sdf::readBinary(const char *_data, const std::size_t _size, SDFPtr _sdf,
+                     const ParserConfig &_config, Errors &_errors)
+{
+  if (!isBinary(_data, _size))
+  {
+    _errors.push_back({ErrorCode::FILE_READ,
+        "Data is not a binary SDFormat document."});
+    return false;
+  }
+
+  BinaryReader reader(_data + sizeof(kMagic), _size - sizeof(kMagic));
+  std::uint32_t formatVersion = 0;
+  std::uint32_t byteOrderMark = 0;
+  std::uint32_t versionId = 0;
+  if (!reader.Get(formatVersion) || !reader.Get(byteOrderMark) ||
+      !reader.Get(versionId))
+  {
+    _errors.push_back({ErrorCode::FILE_READ,
+        "Binary SDFormat document is truncated."});
+    return false;
+  }
+
+  if (formatVersion != kFormatVersion || byteOrderMark != kByteOrderMark)
+  {
+    _errors.push_back({ErrorCode::FILE_READ,
+        "Binary SDFormat document has format version[" +
+        std::to_string(formatVersion) + "] or byte order that is not "
+        "supported. Write it again from the SDFormat file."});
+    return false;
+  }
+
+  if (!reader.GetStrings() || versionId >= reader.strings.size())
+  {
+    _errors.push_back({ErrorCode::FILE_READ,
+        "Binary SDFormat document is truncated."});
+    return false;
+  }
+
+  const std::string &version = reader.strings[versionId];
+  if (version != SDF::Version())
+  {
+    _errors.push_back({ErrorCode::FILE_READ,
+        "Binary SDFormat document was written for SDFormat version[" +
+        version + "], but this library reads version[" + SDF::Version() +
+        "]. Write it again from the SDFormat file."});
+    return false;
+  }
+
+  reader.maxNestingDepth = _config.MaxNestingDepth();
+  ElementPtr root = _sdf->Root();
+  const std::string *name = nullptr;
+  std::uint8_t flags = 0;
+  const char *recordEnd = nullptr;
+  if (!reader.GetElementHeader(name, flags, recordEnd) ||
+      *name != root->GetName() ||
+      !reader.GetElementContents(root, flags, recordEnd))
+  {
+    if (reader.deepElement)
+    {
+      _errors.push_back({ErrorCode::ELEMENT_NESTING_TOO_DEEP,
+          "SDF Element<" + *reader.deepElement + "> is nested deeper than "
+          "the " + std::to_string(reader.maxNestingDepth) +
+          " elements allowed."});
+    }
+    else if (reader.errorElement)
+    {
+      _errors.push_back({ErrorCode::ELEMENT_INVALID,
+          "Binary SDFormat document has element <" + *reader.errorElement +
+          ">, which is not part of the SDFormat spec."});
+    }
+    else
+    {
+      _errors.push_back({ErrorCode::FILE_READ,
+          "Binary SDFormat document is truncated or invalid."});
+    }
+    return false;
+  }
+
+  _sdf->SetFilePath(root->FilePath());
+  _sdf->SetOriginalVersion(root->OriginalVersion());
+  return true;
+}
@@ -0,0 +1,76 @@
+/*
+ * Copyright 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef SDF_BINARYFORMAT_HH_
+#define SDF_BINARYFORMAT_HH_
+
+#include <cstddef>
+#include <string>
+
+#include "sdf/Element.hh"
+#include "sdf/ParserConfig.hh"
+#include "sdf/SDFImpl.hh"
+#include "sdf/Types.hh"
+#include "sdf/sdf_config.h"
+
+/// \file BinaryFormat.hh
+/// \brief Binary serialization of a parsed element tree.
+///
+/// A binary document starts with the 4 bytes "SDFB", the format version and
+/// a byte order mark. It is followed by a table of every distinct string
+/// of the document, such as element names, attribute keys and string
+/// values, and by the element tree, which refers to strings by their index
+/// in the table. Elements are stored depth first. Each element record
+/// starts with its size in bytes, which is the offset of its next sibling.
+/// Values are stored with the type they have in Param, so loading a
+/// document does not parse any number.
+///
+/// A binary document is only read by the library version that wrote it,
+/// since the elements are matched against the descriptions of the SDFormat
+/// spec of that version.
+
+namespace sdf
+{
+  // Inline bracket to help doxygen filtering.
+  inline namespace SDF_VERSION_NAMESPACE {
+  //
+
+  /// \brief Write an element tree in the binary format.
+  /// \param[in] _root The root <sdf> element, usually read by readFile.
+  /// \param[out] _out The binary document.
+  void writeBinary(const ElementPtr &_root, std::string &_out);
+
+  /// \brief Get whether bytes start like a binary document.
+  /// \param[in] _data The bytes.
+  /// \param[in] _size Number of bytes.
+  /// \return True if _data starts with the magic bytes of the format.
+  bool isBinary(const char *_data, std::size_t _size);
+
+  /// \brief Read an element tree written by writeBinary.
+  /// \param[in] _data The binary document.
+  /// \param[in] _size Number of bytes of the document.
+  /// \param[in] _sdf SDF initialized by sdf::init. The elements are added
+  /// to its root element, and its file path and original version are set.
+  /// \param[in] _config Parser configuration. Documents whose elements are
+  /// nested deeper than ParserConfig::MaxNestingDepth are not read, and
+  /// every element counts, including those that are not part of the spec.
+  /// \param[out] _errors Errors of a truncated or invalid document.
+  /// \return True if the document was read.
+  bool readBinary(const char *_data, std::size_t _size, SDFPtr _sdf,
+                  const ParserConfig &_config, Errors &_errors);
+  }
+}
+#endif
@@ -16,6 +16,7 @@
 */
 #include <ignition/math/Vector3.hh>
 #include "sdf/Box.hh"
+#include "Utils.hh"
 
 using namespace sdf;
 
@@ -75,7 +76,7 @@ Errors Box::Load(ElementPtr _sdf)
 {
   Errors errors;
 
-  this->dataPtr->sdf = _sdf;
+  this->dataPtr->sdf = retainedElement(_sdf);
 
   // Check that sdf is a valid pointer
   if (!_sdf)
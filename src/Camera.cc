@@ -14,36 +14,46 @@
  * limitations under the License.
  *
 */
-#include <array>
+#include <cmath>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <vector>
 #include "sdf/Camera.hh"
+#include "EnumNames.hh"
 #include "Utils.hh"
 
 using namespace sdf;
 
-/// \brief String names for the pixel formats.
+/// \brief String names for the pixel formats, followed by the names of
+/// older formats.
 /// \sa Image::PixelFormat.
-static std::array<std::string, 19> kPixelFormatNames =
-{
-  "UNKNOWN_PIXEL_FORMAT",
-  "L_INT8",
-  "L_INT16",
-  "RGB_INT8",
-  "RGBA_INT8",
-  "BGRA_INT8",
-  "RGB_INT16",
-  "RGB_INT32",
-  "BGR_INT8",
-  "BGR_INT16",
-  "BGR_INT32",
-  "R_FLOAT16",
-  "RGB_FLOAT16",
-  "R_FLOAT32",
-  "RGB_FLOAT32",
-  "BAYER_RGGB8",
-  "BAYER_BGGR8",
-  "BAYER_GBRG8",
-  "BAYER_GRBG8"
-};
+constexpr auto kPixelFormats = makeEnumNames<PixelFormatType>({
+    {"UNKNOWN_PIXEL_FORMAT", PixelFormatType::UNKNOWN_PIXEL_FORMAT},
+    {"L_INT8", PixelFormatType::L_INT8},
+    {"L_INT16", PixelFormatType::L_INT16},
+    {"RGB_INT8", PixelFormatType::RGB_INT8},
+    {"RGBA_INT8", PixelFormatType::RGBA_INT8},
+    {"BGRA_INT8", PixelFormatType::BGRA_INT8},
+    {"RGB_INT16", PixelFormatType::RGB_INT16},
+    {"RGB_INT32", PixelFormatType::RGB_INT32},
+    {"BGR_INT8", PixelFormatType::BGR_INT8},
+    {"BGR_INT16", PixelFormatType::BGR_INT16},
+    {"BGR_INT32", PixelFormatType::BGR_INT32},
+    {"R_FLOAT16", PixelFormatType::R_FLOAT16},
+    {"RGB_FLOAT16", PixelFormatType::RGB_FLOAT16},
+    {"R_FLOAT32", PixelFormatType::R_FLOAT32},
+    {"RGB_FLOAT32", PixelFormatType::RGB_FLOAT32},
+    {"BAYER_RGGB8", PixelFormatType::BAYER_RGGB8},
+    {"BAYER_BGGR8", PixelFormatType::BAYER_BGGR8},
+    {"BAYER_GBRG8", PixelFormatType::BAYER_GBRG8},
+    {"BAYER_GRBG8", PixelFormatType::BAYER_GRBG8},
+    {"R8G8B8", PixelFormatType::RGB_INT8},
+    {"L8", PixelFormatType::L_INT8},
+    {"B8G8R8", PixelFormatType::BGR_INT8}});
 
 // Private data class
 class sdf::CameraPrivate
@@ -164,8 +174,91 @@ class sdf::CameraPrivate
 
   /// \brief Visibility mask of a camera. Defaults to 0xFFFFFFFF
   public: uint32_t visibilityMask{4294967295u};
+
+  /// \brief True if the lens intrinsics were loaded or set.
+  public: bool hasLensIntrinsics{false};
+
+  /// \brief The distortion map, or null if it was not requested since the
+  /// camera was last modified. It is only accessed atomically, since it is
+  /// set by the const DistortionMap function.
+  public: std::shared_ptr<const CameraDistortionMap> distortionMap;
+};
+
+/// \brief Parameters of a distortion map: the image width and height, the
+/// focal lengths fx and fy, the distortion center in pixels, and the
+/// distortion coefficients k1, k2, k3, p1 and p2.
+using DistortionMapKey = std::tuple<uint32_t, uint32_t, double, double,
+    double, double, double, double, double, double, double>;
+
+/// \brief The distortion maps in use, shared by all cameras with the same
+/// parameters.
+struct DistortionMapCache
+{
+  /// \brief The maps, which expire when no camera uses them anymore.
+  std::map<DistortionMapKey, std::weak_ptr<const CameraDistortionMap>> maps;
+
+  /// \brief Mutex protecting the maps.
+  std::mutex mutex;
 };
 
+//////////////////////////////////////////////////
+/// \brief Get the cache of distortion maps of the process.
+/// \return The cache.
+static DistortionMapCache &distortionMapCache()
+{
+  static DistortionMapCache cache;
+  return cache;
+}
+
+//////////////////////////////////////////////////
+/// \brief Compute a distortion map.
+/// \param[in] _key Parameters of the map.
+/// \return The map.
+static std::shared_ptr<const CameraDistortionMap> computeDistortionMap(
+    const DistortionMapKey &_key)
+{
+  auto map = std::make_shared<CameraDistortionMap>();
+  map->width = std::get<0>(_key);
+  map->height = std::get<1>(_key);
+  const double fx = std::get<2>(_key);
+  const double fy = std::get<3>(_key);
+  const double cx = std::get<4>(_key);
+  const double cy = std::get<5>(_key);
+  const double k1 = std::get<6>(_key);
+  const double k2 = std::get<7>(_key);
+  const double k3 = std::get<8>(_key);
+  const double p1 = std::get<9>(_key);
+  const double p2 = std::get<10>(_key);
+
+  const std::size_t count =
+      static_cast<std::size_t>(map->width) * map->height;
+  map->x.resize(count);
+  map->y.resize(count);
+  for (uint32_t v = 0; v < map->height; ++v)
+  {
+    const std::size_t offset = static_cast<std::size_t>(v) * map->width;
+    float *mapX = map->x.data() + offset;
+    float *mapY = map->y.data() + offset;
+    const double yn = (v - cy) / fy;
+
+    // Only arithmetic, without branches, so that the compiler vectorizes
+    // the computation of a row.
+    for (uint32_t u = 0; u < map->width; ++u)
+    {
+      const double xn = (u - cx) / fx;
+      const double r2 = xn * xn + yn * yn;
+      const double radial = 1.0 + r2 * (k1 + r2 * (k2 + r2 * k3));
+      const double xd = xn * radial + 2.0 * p1 * xn * yn +
+          p2 * (r2 + 2.0 * xn * xn);
+      const double yd = yn * radial + p1 * (r2 + 2.0 * yn * yn) +
+          2.0 * p2 * xn * yn;
+      mapX[u] = static_cast<float>(xd * fx + cx);
+      mapY[u] = static_cast<float>(yd * fy + cy);
+    }
+  }
+  return map;
+}
+
 /////////////////////////////////////////////////
 Camera::Camera()
   : dataPtr(new CameraPrivate)
@@ -209,7 +302,8 @@ Errors Camera::Load(ElementPtr _sdf)
 {
   Errors errors;
 
-  this->dataPtr->sdf = _sdf;
+  this->dataPtr->sdf = retainedElement(_sdf);
+  std::atomic_store(&this->dataPtr->distortionMap, {});
 
   // Check that sdf is a valid pointer
   if (!_sdf)
@@ -238,7 +332,7 @@ Errors Camera::Load(ElementPtr _sdf)
   // Read the distortion
   if (_sdf->HasElement("distortion"))
   {
-    sdf::ElementPtr elem = _sdf->GetElement("distortion");
+    sdf::ElementPtr elem = _sdf->FindElement("distortion");
     this->dataPtr->distortionK1 = elem->Get<double>("k1",
       this->dataPtr->distortionK1).first;
     this->dataPtr->distortionK2 = elem->Get<double>("k2",
@@ -257,7 +351,7 @@ Errors Camera::Load(ElementPtr _sdf)
 
   if (_sdf->HasElement("image"))
   {
-    sdf::ElementPtr elem = _sdf->GetElement("image");
+    sdf::ElementPtr elem = _sdf->FindElement("image");
     this->dataPtr->imageWidth = elem->Get<uint32_t>("width",
         this->dataPtr->imageWidth).first;
     this->dataPtr->imageHeight = elem->Get<uint32_t>("height",
@@ -279,11 +373,11 @@ Errors Camera::Load(ElementPtr _sdf)
 
   if (_sdf->HasElement("depth_camera"))
   {
-    sdf::ElementPtr elem = _sdf->GetElement("depth_camera");
+    sdf::ElementPtr elem = _sdf->FindElement("depth_camera");
     this->dataPtr->hasDepthCamera = true;
     if (elem->HasElement("clip"))
     {
-      sdf::ElementPtr func = elem->GetElement("clip");
+      sdf::ElementPtr func = elem->FindElement("clip");
       if (func->HasElement("near"))
       {
         this->SetDepthNearClip(func->Get<double>("near"));
@@ -297,7 +391,7 @@ Errors Camera::Load(ElementPtr _sdf)
 
   if (_sdf->HasElement("clip"))
   {
-    sdf::ElementPtr elem = _sdf->GetElement("clip");
+    sdf::ElementPtr elem = _sdf->FindElement("clip");
     this->dataPtr->nearClip = elem->Get<double>("near",
         this->dataPtr->nearClip).first;
     this->dataPtr->farClip = elem->Get<double>("far",
@@ -311,7 +405,7 @@ Errors Camera::Load(ElementPtr _sdf)
 
   if (_sdf->HasElement("save"))
   {
-    sdf::ElementPtr elem = _sdf->GetElement("save");
+    sdf::ElementPtr elem = _sdf->FindElement("save");
     this->dataPtr->save = elem->Get<bool>("enabled", this->dataPtr->save).first;
     if (this->dataPtr->save)
     {
@@ -328,7 +422,8 @@ Errors Camera::Load(ElementPtr _sdf)
   // Load the noise values.
   if (_sdf->HasElement("noise"))
   {
-    Errors noiseErr = this->dataPtr->imageNoise.Load(_sdf->GetElement("noise"));
+    Errors noiseErr =
+        this->dataPtr->imageNoise.Load(_sdf->FindElement("noise"));
     errors.insert(errors.end(), noiseErr.begin(), noiseErr.end());
   }
 
@@ -338,7 +433,7 @@ Errors Camera::Load(ElementPtr _sdf)
   // Load the lens values.
   if (_sdf->HasElement("lens"))
   {
-    sdf::ElementPtr elem = _sdf->GetElement("lens");
+    sdf::ElementPtr elem = _sdf->FindElement("lens");
 
     this->dataPtr->lensType = elem->Get<std::string>("type",
         this->dataPtr->lensType).first;
@@ -351,7 +446,7 @@ Errors Camera::Load(ElementPtr _sdf)
 
     if (elem->HasElement("custom_function"))
     {
-      sdf::ElementPtr func = elem->GetElement("custom_function");
+      sdf::ElementPtr func = elem->FindElement("custom_function");
       this->dataPtr->lensC1 = func->Get<double>("c1",
           this->dataPtr->lensC1).first;
       this->dataPtr->lensC2 = func->Get<double>("c2",
@@ -366,7 +461,8 @@ Errors Camera::Load(ElementPtr _sdf)
 
     if (elem->HasElement("intrinsics"))
     {
-      sdf::ElementPtr intrinsics = elem->GetElement("intrinsics");
+      sdf::ElementPtr intrinsics = elem->FindElement("intrinsics");
+      this->dataPtr->hasLensIntrinsics = true;
       this->dataPtr->lensIntrinsicsFx = intrinsics->Get<double>("fx",
           this->dataPtr->lensIntrinsicsFx).first;
       this->dataPtr->lensIntrinsicsFy = intrinsics->Get<double>("fy",
@@ -396,7 +492,7 @@ sdf::ElementPtr Camera::Element() const
 }
 
 /////////////////////////////////////////////////
-std::string Camera::Name() const
+const std::string &Camera::Name() const
 {
   return this->dataPtr->name;
 }
@@ -417,6 +513,7 @@ ignition::math::Angle Camera::HorizontalFov() const
 void Camera::SetHorizontalFov(const ignition::math::Angle &_hfov)
 {
   this->dataPtr->hfov = _hfov;
+  std::atomic_store(&this->dataPtr->distortionMap, {});
 }
 
 //////////////////////////////////////////////////
@@ -429,6 +526,7 @@ uint32_t Camera::ImageWidth() const
 void Camera::SetImageWidth(uint32_t _width)
 {
   this->dataPtr->imageWidth = _width;
+  std::atomic_store(&this->dataPtr->distortionMap, {});
 }
 
 //////////////////////////////////////////////////
@@ -441,6 +539,7 @@ uint32_t Camera::ImageHeight() const
 void Camera::SetImageHeight(uint32_t _height)
 {
   this->dataPtr->imageHeight = _height;
+  std::atomic_store(&this->dataPtr->distortionMap, {});
 }
 
 //////////////////////////////////////////////////
@@ -621,6 +720,7 @@ double Camera::DistortionK1() const
 void Camera::SetDistortionK1(double _k1)
 {
   this->dataPtr->distortionK1 = _k1;
+  std::atomic_store(&this->dataPtr->distortionMap, {});
 }
 
 //////////////////////////////////////////////////
@@ -633,6 +733,7 @@ double Camera::DistortionK2() const
 void Camera::SetDistortionK2(double _k2)
 {
   this->dataPtr->distortionK2 = _k2;
+  std::atomic_store(&this->dataPtr->distortionMap, {});
 }
 
 //////////////////////////////////////////////////
@@ -645,6 +746,7 @@ double Camera::DistortionK3() const
 void Camera::SetDistortionK3(double _k3)
 {
   this->dataPtr->distortionK3 = _k3;
+  std::atomic_store(&this->dataPtr->distortionMap, {});
 }
 
 //////////////////////////////////////////////////
@@ -657,6 +759,7 @@ double Camera::DistortionP1() const
 void Camera::SetDistortionP1(double _p1)
 {
   this->dataPtr->distortionP1 = _p1;
+  std::atomic_store(&this->dataPtr->distortionMap, {});
 }
 
 //////////////////////////////////////////////////
@@ -669,6 +772,7 @@ double Camera::DistortionP2() const
 void Camera::SetDistortionP2(double _p2)
 {
   this->dataPtr->distortionP2 = _p2;
+  std::atomic_store(&this->dataPtr->distortionMap, {});
 }
 
 //////////////////////////////////////////////////
@@ -682,6 +786,7 @@ void Camera::SetDistortionCenter(
                 const ignition::math::Vector2d &_center) const
 {
   this->dataPtr->distortionCenter = _center;
+  std::atomic_store(&this->dataPtr->distortionMap, {});
 }
 
 /////////////////////////////////////////////////
@@ -733,7 +838,7 @@ void Camera::SetPoseRelativeTo(const std::string &_frame)
 }
 
 /////////////////////////////////////////////////
-std::string Camera::LensType() const
+const std::string &Camera::LensType() const
 {
   return this->dataPtr->lensType;
 }
@@ -850,6 +955,8 @@ double Camera::LensIntrinsicsFx() const
 void Camera::SetLensIntrinsicsFx(double _fx)
 {
   this->dataPtr->lensIntrinsicsFx = _fx;
+  this->dataPtr->hasLensIntrinsics = true;
+  std::atomic_store(&this->dataPtr->distortionMap, {});
 }
 
 /////////////////////////////////////////////////
@@ -862,6 +969,8 @@ double Camera::LensIntrinsicsFy() const
 void Camera::SetLensIntrinsicsFy(double _fy)
 {
   this->dataPtr->lensIntrinsicsFy = _fy;
+  this->dataPtr->hasLensIntrinsics = true;
+  std::atomic_store(&this->dataPtr->distortionMap, {});
 }
 
 /////////////////////////////////////////////////
@@ -874,6 +983,8 @@ double Camera::LensIntrinsicsCx() const
 void Camera::SetLensIntrinsicsCx(double _cx)
 {
   this->dataPtr->lensIntrinsicsCx = _cx;
+  this->dataPtr->hasLensIntrinsics = true;
+  std::atomic_store(&this->dataPtr->distortionMap, {});
 }
 
 /////////////////////////////////////////////////
@@ -886,6 +997,8 @@ double Camera::LensIntrinsicsCy() const
 void Camera::SetLensIntrinsicsCy(double _cy)
 {
   this->dataPtr->lensIntrinsicsCy = _cy;
+  this->dataPtr->hasLensIntrinsics = true;
+  std::atomic_store(&this->dataPtr->distortionMap, {});
 }
 
 /////////////////////////////////////////////////
@@ -898,46 +1011,101 @@ double Camera::LensIntrinsicsSkew() const
 void Camera::SetLensIntrinsicsSkew(double _s)
 {
   this->dataPtr->lensIntrinsicsS = _s;
+  this->dataPtr->hasLensIntrinsics = true;
+  std::atomic_store(&this->dataPtr->distortionMap, {});
 }
 
 /////////////////////////////////////////////////
 std::string Camera::ConvertPixelFormat(PixelFormatType _type)
 {
-  unsigned int index = static_cast<int>(_type);
-  if (index < kPixelFormatNames.size())
-    return kPixelFormatNames[static_cast<int>(_type)];
+  const std::string_view name = kPixelFormats.Name(_type);
+  return std::string(name.empty() ?
+      kPixelFormats.Name(PixelFormatType::UNKNOWN_PIXEL_FORMAT) : name);
+}
 
-  return kPixelFormatNames[0];
+/////////////////////////////////////////////////
+ignition::math::Matrix3d Camera::ProjectionMatrix() const
+{
+  if (this->dataPtr->hasLensIntrinsics)
+  {
+    return ignition::math::Matrix3d(
+        this->dataPtr->lensIntrinsicsFx, this->dataPtr->lensIntrinsicsS,
+        this->dataPtr->lensIntrinsicsCx,
+        0, this->dataPtr->lensIntrinsicsFy, this->dataPtr->lensIntrinsicsCy,
+        0, 0, 1);
+  }
+
+  // A pinhole camera whose image spans the horizontal field of view, with
+  // square pixels.
+  const double width = this->dataPtr->imageWidth;
+  const double height = this->dataPtr->imageHeight;
+  const double f = width / (2.0 * std::tan(this->dataPtr->hfov.Radian() / 2));
+  return ignition::math::Matrix3d(
+      f, 0, width / 2,
+      0, f, height / 2,
+      0, 0, 1);
 }
 
 /////////////////////////////////////////////////
-PixelFormatType Camera::ConvertPixelFormat(const std::string &_format)
+std::shared_ptr<const CameraDistortionMap> Camera::DistortionMap() const
 {
-  for (unsigned int i = 0; i < kPixelFormatNames.size(); ++i)
+  if (ignition::math::equal(this->dataPtr->distortionK1, 0.0) &&
+      ignition::math::equal(this->dataPtr->distortionK2, 0.0) &&
+      ignition::math::equal(this->dataPtr->distortionK3, 0.0) &&
+      ignition::math::equal(this->dataPtr->distortionP1, 0.0) &&
+      ignition::math::equal(this->dataPtr->distortionP2, 0.0))
+  {
+    return nullptr;
+  }
+
+  auto map = std::atomic_load(&this->dataPtr->distortionMap);
+  if (map)
+    return map;
+
+  const ignition::math::Matrix3d projection = this->ProjectionMatrix();
+  const DistortionMapKey key(
+      this->dataPtr->imageWidth, this->dataPtr->imageHeight,
+      projection(0, 0), projection(1, 1),
+      this->dataPtr->distortionCenter.X() * this->dataPtr->imageWidth,
+      this->dataPtr->distortionCenter.Y() * this->dataPtr->imageHeight,
+      this->dataPtr->distortionK1, this->dataPtr->distortionK2,
+      this->dataPtr->distortionK3, this->dataPtr->distortionP1,
+      this->dataPtr->distortionP2);
+
+  DistortionMapCache &cache = distortionMapCache();
   {
-    if (kPixelFormatNames[i] == _format)
+    std::lock_guard<std::mutex> lock(cache.mutex);
+    auto it = cache.maps.find(key);
+    if (it != cache.maps.end())
+      map = it->second.lock();
+    if (!map)
     {
-      return static_cast<PixelFormatType>(i);
+      // Computed with the lock held, so that cameras loaded concurrently
+      // with the same parameters compute their map once.
+      map = computeDistortionMap(key);
+
+      // Remove the maps that are no longer used before adding this one.
+      for (auto expired = cache.maps.begin(); expired != cache.maps.end();)
+      {
+        if (expired->second.expired())
+          expired = cache.maps.erase(expired);
+        else
+          ++expired;
+      }
+      cache.maps[key] = map;
     }
   }
 
-  // Handle older formats
-  if (_format == "R8G8B8")
-    return PixelFormatType::RGB_INT8;
-  else if (_format == "L8")
-    return PixelFormatType::L_INT8;
-  else if (_format == "B8G8R8")
-    return PixelFormatType::BGR_INT8;
-  else if (_format == "BAYER_RGGB8")
-    return PixelFormatType::BAYER_RGGB8;
-  else if (_format == "BAYER_BGGR8")
-    return PixelFormatType::BAYER_BGGR8;
-  else if (_format == "BAYER_GBRG8")
-    return PixelFormatType::BAYER_GBRG8;
-  else if (_format == "BAYER_GRBG8")
-    return PixelFormatType::BAYER_GRBG8;
-
-  return PixelFormatType::UNKNOWN_PIXEL_FORMAT;
+  std::atomic_store(&this->dataPtr->distortionMap, map);
+  return map;
+}
+
+/////////////////////////////////////////////////
+PixelFormatType Camera::ConvertPixelFormat(const std::string &_format)
+{
+  PixelFormatType format = PixelFormatType::UNKNOWN_PIXEL_FORMAT;
+  kPixelFormats.Find(_format, format);
+  return format;
 }
 
 /////////////////////////////////////////////////
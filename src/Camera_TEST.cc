@@ -193,3 +193,74 @@ TEST(DOMCamera, Construction)
   // The Camera::Load function is tested more thoroughly in the
   // link_dom.cc integration test.
 }
+
+/////////////////////////////////////////////////
+TEST(DOMCamera, ProjectionMatrix)
+{
+  sdf::Camera cam;
+  cam.SetImageWidth(320);
+  cam.SetImageHeight(240);
+  cam.SetHorizontalFov(IGN_PI_2);
+
+  // Without lens intrinsics, from the field of view and the image size.
+  ignition::math::Matrix3d projection = cam.ProjectionMatrix();
+  EXPECT_NEAR(160.0, projection(0, 0), 1e-6);
+  EXPECT_NEAR(0.0, projection(0, 1), 1e-6);
+  EXPECT_NEAR(160.0, projection(0, 2), 1e-6);
+  EXPECT_NEAR(160.0, projection(1, 1), 1e-6);
+  EXPECT_NEAR(120.0, projection(1, 2), 1e-6);
+  EXPECT_NEAR(1.0, projection(2, 2), 1e-6);
+
+  cam.SetLensIntrinsicsFx(300);
+  cam.SetLensIntrinsicsFy(310);
+  cam.SetLensIntrinsicsCx(150);
+  cam.SetLensIntrinsicsCy(110);
+  cam.SetLensIntrinsicsSkew(0.5);
+  projection = cam.ProjectionMatrix();
+  EXPECT_DOUBLE_EQ(300.0, projection(0, 0));
+  EXPECT_DOUBLE_EQ(0.5, projection(0, 1));
+  EXPECT_DOUBLE_EQ(150.0, projection(0, 2));
+  EXPECT_DOUBLE_EQ(310.0, projection(1, 1));
+  EXPECT_DOUBLE_EQ(110.0, projection(1, 2));
+}
+
+/////////////////////////////////////////////////
+TEST(DOMCamera, DistortionMap)
+{
+  sdf::Camera cam;
+  cam.SetImageWidth(320);
+  cam.SetImageHeight(240);
+  cam.SetHorizontalFov(IGN_PI_2);
+  EXPECT_EQ(nullptr, cam.DistortionMap());
+
+  cam.SetDistortionK1(0.1);
+  auto map = cam.DistortionMap();
+  ASSERT_NE(nullptr, map);
+  EXPECT_EQ(320u, map->width);
+  EXPECT_EQ(240u, map->height);
+  ASSERT_EQ(320u * 240u, map->x.size());
+  ASSERT_EQ(320u * 240u, map->y.size());
+
+  // The distortion center does not move, and the radial distortion moves
+  // the other pixels away from it.
+  const std::size_t center = 120 * 320 + 160;
+  EXPECT_FLOAT_EQ(160.0f, map->x[center]);
+  EXPECT_FLOAT_EQ(120.0f, map->y[center]);
+  const std::size_t corner = 0;
+  EXPECT_LT(map->x[corner], 0.0f);
+  EXPECT_LT(map->y[corner], 0.0f);
+
+  // The map is computed once, and shared by the cameras with the same
+  // parameters.
+  EXPECT_EQ(map, cam.DistortionMap());
+  sdf::Camera cam2(cam);
+  EXPECT_EQ(map, cam2.DistortionMap());
+
+  // Modifying the camera computes another map.
+  cam.SetImageWidth(640);
+  auto map2 = cam.DistortionMap();
+  ASSERT_NE(nullptr, map2);
+  EXPECT_NE(map, map2);
+  EXPECT_EQ(640u, map2->width);
+  EXPECT_EQ(640u * 240u, map2->x.size());
+}
@@ -22,11 +22,13 @@
 #include "sdf/Geometry.hh"
 #include "sdf/Surface.hh"
 #include "sdf/Types.hh"
+#include "ElementArena.hh"
+#include "FrameSemantics.hh"
 #include "Utils.hh"
 
 using namespace sdf;
 
-class sdf::CollisionPrivate
+class sdf::CollisionPrivate : public ArenaAllocated
 {
   /// \brief Name of the collision.
   public: std::string name = "";
@@ -51,8 +53,22 @@ class sdf::CollisionPrivate
 
   /// \brief Weak pointer to model's Pose Relative-To Graph.
   public: std::weak_ptr<const sdf::PoseRelativeToGraph> poseRelativeToGraph;
+
+  /// \brief Vertex ids of the frames of SemanticPose in the graph.
+  public: FrameIds frameIds;
 };
 
+/////////////////////////////////////////////////
+/// \brief Find the vertex ids of the frames of the SemanticPose of a
+/// collision again, after its graph or the names of the frames changed.
+/// \param[in,out] _data Private data of the collision.
+static void updateFrameIds(CollisionPrivate &_data)
+{
+  _data.frameIds = findFrameIds(_data.poseRelativeToGraph,
+      _data.poseRelativeTo.empty() ? _data.xmlParentName : _data.poseRelativeTo,
+      _data.xmlParentName);
+}
+
 /////////////////////////////////////////////////
 Collision::Collision()
   : dataPtr(new CollisionPrivate)
@@ -96,7 +112,7 @@ Errors Collision::Load(ElementPtr _sdf)
 {
   Errors errors;
 
-  this->dataPtr->sdf = _sdf;
+  this->dataPtr->sdf = retainedElement(_sdf);
 
   // Check that the provided SDF element is a <collision>
   // This is an error that cannot be recovered, so return an error.
@@ -127,20 +143,20 @@ Errors Collision::Load(ElementPtr _sdf)
   loadPose(_sdf, this->dataPtr->pose, this->dataPtr->poseRelativeTo);
 
   // Load the geometry
-  Errors geomErr = this->dataPtr->geom.Load(_sdf->GetElement("geometry"));
+  Errors geomErr = this->dataPtr->geom.Load(_sdf->FindElement("geometry"));
   errors.insert(errors.end(), geomErr.begin(), geomErr.end());
 
   // Load the surface parameters if they are given
   if (_sdf->HasElement("surface"))
   {
-    this->dataPtr->surface.Load(_sdf->GetElement("surface"));
+    this->dataPtr->surface.Load(_sdf->FindElement("surface"));
   }
 
   return errors;
 }
 
 /////////////////////////////////////////////////
-std::string Collision::Name() const
+const std::string &Collision::Name() const
 {
   return this->dataPtr->name;
 }
@@ -149,6 +165,7 @@ std::string Collision::Name() const
 void Collision::SetName(const std::string &_name) const
 {
   this->dataPtr->name = _name;
+  NameIndex::NameChanged();
 }
 
 /////////////////////////////////////////////////
@@ -221,12 +238,14 @@ void Collision::SetPoseFrame(const std::string &_frame)
 void Collision::SetPoseRelativeTo(const std::string &_frame)
 {
   this->dataPtr->poseRelativeTo = _frame;
+  updateFrameIds(*this->dataPtr);
 }
 
 /////////////////////////////////////////////////
 void Collision::SetXmlParentName(const std::string &_xmlParentName)
 {
   this->dataPtr->xmlParentName = _xmlParentName;
+  updateFrameIds(*this->dataPtr);
 }
 
 /////////////////////////////////////////////////
@@ -234,6 +253,7 @@ void Collision::SetPoseRelativeToGraph(
     std::weak_ptr<const PoseRelativeToGraph> _graph)
 {
   this->dataPtr->poseRelativeToGraph = _graph;
+  updateFrameIds(*this->dataPtr);
 }
 
 /////////////////////////////////////////////////
@@ -243,7 +263,8 @@ sdf::SemanticPose Collision::SemanticPose() const
       this->dataPtr->pose,
       this->dataPtr->poseRelativeTo,
       this->dataPtr->xmlParentName,
-      this->dataPtr->poseRelativeToGraph);
+      this->dataPtr->poseRelativeToGraph,
+      this->dataPtr->frameIds);
 }
 
 /////////////////////////////////////////////////
@@ -15,11 +15,22 @@
  *
  */
 
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
 #include <cstdlib>
 #include <memory>
 #include <mutex>
 #include <sstream>
 #include <string>
+#include <thread>
+#include <utility>
+
+#ifndef _WIN32
+#include <unistd.h>
+#else
+#include <process.h>
+#endif
 
 #include "sdf/Console.hh"
 #include "sdf/Filesystem.hh"
@@ -27,24 +38,36 @@
 
 using namespace sdf;
 
-/// Static pointer to the console.
-static std::shared_ptr<Console> myself;
-static std::mutex g_instance_mutex;
+/// \brief A piece of output queued by an asynchronous console.
+struct ConsoleRecord
+{
+  /// \brief Terminal stream of the output, or nullptr.
+  std::ostream *stream = nullptr;
 
-/// \todo Output disabled for windows, to allow tests to pass. We should
-/// disable output just for tests on windows.
-#ifndef _WIN32
-static bool g_quiet = false;
-#else
-static bool g_quiet = true;
-#endif
+  /// \brief The output.
+  std::string text;
 
-static Console::ConsoleStream g_NullStream(nullptr);
+  /// \brief The output for the log file, if hasLogText is true.
+  std::string logText;
 
-//////////////////////////////////////////////////
-Console::Console()
-  : dataPtr(new ConsolePrivate)
+  /// \brief True if the log file gets logText instead of text.
+  bool hasLogText = false;
+};
+
+/// \brief Open the log file of the log sink of a console, if it is a log
+/// file sink that was not opened yet. The caller must hold logFileMutex.
+/// \param[in] _console Private data of the console.
+static void openLogFile(ConsolePrivate *_console)
 {
+  const ConsoleLogSink sink = _console->logSink.load();
+  if (_console->logFileOpened ||
+      (sink != ConsoleLogSink::LOG_FILE &&
+       sink != ConsoleLogSink::PROCESS_LOG_FILE))
+  {
+    return;
+  }
+  _console->logFileOpened = true;
+
   // Set up the file that we'll log to.
 #ifndef _WIN32
   const char *home = std::getenv("HOME");
@@ -70,13 +93,322 @@ Console::Console()
               << std::endl;
     return;
   }
-  std::string logFile = sdf::filesystem::append(logDir, "sdformat.log");
-  this->dataPtr->logFileStream.open(logFile.c_str(), std::ios::out);
+
+  std::string logName = "sdformat.log";
+  if (sink == ConsoleLogSink::PROCESS_LOG_FILE)
+  {
+#ifndef _WIN32
+    logName = "sdformat-" + std::to_string(getpid()) + ".log";
+#else
+    logName = "sdformat-" + std::to_string(_getpid()) + ".log";
+#endif
+  }
+  std::string logFile = sdf::filesystem::append(logDir, logName);
+  _console->logFileStream.open(logFile.c_str(), std::ios::out);
+}
+
+/// \brief Log output to the log sink of a console. The caller must hold
+/// logFileMutex.
+/// \param[in] _console Private data of the console.
+/// \param[in] _text The output.
+/// \param[in] _flush True to flush the log file.
+static void writeLog(ConsolePrivate *_console, const std::string &_text,
+    bool _flush)
+{
+  switch (_console->logSink.load())
+  {
+    case ConsoleLogSink::LOG_FILE:
+    case ConsoleLogSink::PROCESS_LOG_FILE:
+      openLogFile(_console);
+      if (_console->logFileStream.is_open())
+      {
+        _console->logFileStream << _text;
+        if (_flush)
+          _console->logFileStream.flush();
+      }
+      break;
+    case ConsoleLogSink::CALLBACK:
+      if (_console->logCallback)
+        _console->logCallback(_text);
+      break;
+    case ConsoleLogSink::NONE:
+    default:
+      break;
+  }
+}
+
+/// \brief The bounded queue of an asynchronous console, and the thread
+/// that writes its output. Any thread may push output without locking, and
+/// only the background thread pops it. Each cell of the ring has a sequence
+/// number that tells whether it is free for the push of a position, or
+/// holds the output pushed at a position, as in the bounded queue of
+/// Dmitry Vyukov.
+class sdf::ConsoleQueue
+{
+  /// \brief Constructor. Starts the background thread.
+  /// \param[in] _console Private data of the console, which must outlive
+  /// the queue.
+  /// \param[in] _capacity Minimum number of cells.
+  /// \param[in] _policy What to do with output when the queue is full.
+  public: ConsoleQueue(ConsolePrivate *_console, std::size_t _capacity,
+                       ConsoleDropPolicy _policy)
+    : console(_console), policy(_policy)
+  {
+    std::size_t capacity = 2;
+    while (capacity < _capacity)
+      capacity *= 2;
+    this->mask = capacity - 1;
+    this->cells.reset(new Cell[capacity]);
+    for (std::size_t i = 0; i < capacity; ++i)
+      this->cells[i].sequence.store(i, std::memory_order_relaxed);
+
+    this->thread = std::thread(&ConsoleQueue::Run, this);
+  }
+
+  /// \brief Destructor. Writes the queued output, and stops the thread.
+  public: ~ConsoleQueue()
+  {
+    {
+      std::lock_guard<std::mutex> lock(this->mutex);
+      this->stop = true;
+    }
+    this->condition.notify_one();
+    this->thread.join();
+  }
+
+  /// \brief Push output, following the drop policy if the queue is full.
+  /// \param[in] _record The output.
+  public: void Push(ConsoleRecord &&_record)
+  {
+    while (!this->TryPush(_record))
+    {
+      if (this->policy == ConsoleDropPolicy::DROP_NEWEST)
+      {
+        this->console->droppedCount.fetch_add(1, std::memory_order_relaxed);
+        return;
+      }
+      this->Wake();
+      std::this_thread::yield();
+    }
+    this->Wake();
+  }
+
+  /// \brief Wait until the output pushed so far is written.
+  public: void Flush()
+  {
+    const std::size_t target =
+        this->enqueuePos.load(std::memory_order_acquire);
+    while (this->written.load(std::memory_order_acquire) < target)
+    {
+      this->Wake();
+      std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+  }
+
+  /// \brief A cell of the ring.
+  private: struct Cell
+  {
+    /// \brief Sequence number of the cell.
+    std::atomic<std::size_t> sequence{0};
+
+    /// \brief The output held by the cell.
+    ConsoleRecord record;
+  };
+
+  /// \brief Push output if there is room.
+  /// \param[in,out] _record The output, which is moved into the queue on
+  /// success.
+  /// \return False if the queue is full.
+  private: bool TryPush(ConsoleRecord &_record)
+  {
+    std::size_t pos = this->enqueuePos.load(std::memory_order_relaxed);
+    Cell *cell = nullptr;
+    while (true)
+    {
+      cell = &this->cells[pos & this->mask];
+      const std::size_t sequence =
+          cell->sequence.load(std::memory_order_acquire);
+      const std::intptr_t diff = static_cast<std::intptr_t>(sequence) -
+          static_cast<std::intptr_t>(pos);
+      if (diff == 0)
+      {
+        if (this->enqueuePos.compare_exchange_weak(pos, pos + 1,
+              std::memory_order_relaxed))
+        {
+          break;
+        }
+      }
+      else if (diff < 0)
+      {
+        return false;
+      }
+      else
+      {
+        pos = this->enqueuePos.load(std::memory_order_relaxed);
+      }
+    }
+
+    cell->record = std::move(_record);
+    cell->sequence.store(pos + 1, std::memory_order_release);
+    return true;
+  }
+
+  /// \brief Pop output. Only called by the background thread.
+  /// \param[out] _record The output.
+  /// \return False if the queue is empty.
+  private: bool TryPop(ConsoleRecord &_record)
+  {
+    Cell *cell = &this->cells[this->dequeuePos & this->mask];
+    if (cell->sequence.load(std::memory_order_acquire) !=
+        this->dequeuePos + 1)
+    {
+      return false;
+    }
+
+    _record = std::move(cell->record);
+    cell->record = ConsoleRecord();
+    cell->sequence.store(this->dequeuePos + this->mask + 1,
+        std::memory_order_release);
+    ++this->dequeuePos;
+    return true;
+  }
+
+  /// \brief Wake the background thread if it waits for output.
+  private: void Wake()
+  {
+    if (this->waiting.load(std::memory_order_acquire))
+      this->condition.notify_one();
+  }
+
+  /// \brief Write the queued output. Only called by the background thread.
+  /// \return True if there was output to write.
+  private: bool Drain()
+  {
+    ConsoleRecord record;
+    std::size_t count = 0;
+    std::ostream *lastStream = nullptr;
+    std::lock_guard<std::mutex> lock(this->console->logFileMutex);
+    while (this->TryPop(record))
+    {
+      if (record.stream)
+      {
+        *record.stream << record.text;
+        lastStream = record.stream;
+      }
+      writeLog(this->console,
+          record.hasLogText ? record.logText : record.text, false);
+      ++count;
+    }
+
+    if (count == 0)
+      return false;
+
+    if (lastStream)
+      lastStream->flush();
+    if (this->console->logFileStream.is_open())
+      this->console->logFileStream.flush();
+    this->written.fetch_add(count, std::memory_order_release);
+    return true;
+  }
+
+  /// \brief Body of the background thread.
+  private: void Run()
+  {
+    while (true)
+    {
+      if (this->Drain())
+        continue;
+
+      std::unique_lock<std::mutex> lock(this->mutex);
+      if (this->stop)
+        break;
+      this->waiting.store(true, std::memory_order_release);
+      // Pushes do not lock the mutex, so a wake up can be missed, and the
+      // wait is bounded.
+      this->condition.wait_for(lock, std::chrono::milliseconds(10));
+      this->waiting.store(false, std::memory_order_release);
+    }
+
+    // Write what was pushed before the queue was stopped.
+    this->Drain();
+  }
+
+  /// \brief Private data of the console.
+  private: ConsolePrivate *console;
+
+  /// \brief What to do with output when the queue is full.
+  private: ConsoleDropPolicy policy;
+
+  /// \brief The ring, whose size is a power of two.
+  private: std::unique_ptr<Cell[]> cells;
+
+  /// \brief Size of the ring minus one.
+  private: std::size_t mask = 0;
+
+  /// \brief Position of the next push.
+  private: alignas(64) std::atomic<std::size_t> enqueuePos{0};
+
+  /// \brief Position of the next pop.
+  private: alignas(64) std::size_t dequeuePos = 0;
+
+  /// \brief Number of pieces of output written.
+  private: std::atomic<std::size_t> written{0};
+
+  /// \brief True while the background thread waits for output.
+  private: std::atomic<bool> waiting{false};
+
+  /// \brief Mutex of condition and stop.
+  private: std::mutex mutex;
+
+  /// \brief Condition the background thread waits on.
+  private: std::condition_variable condition;
+
+  /// \brief True when the background thread must stop.
+  private: bool stop = false;
+
+  /// \brief The background thread.
+  private: std::thread thread;
+};
+
+/// Static pointer to the console.
+static std::shared_ptr<Console> myself;
+static std::mutex g_instance_mutex;
+
+/// \todo Output disabled for windows, to allow tests to pass. We should
+/// disable output just for tests on windows.
+#ifndef _WIN32
+static bool g_quiet = false;
+#else
+static bool g_quiet = true;
+#endif
+
+static Console::ConsoleStream g_NullStream(nullptr);
+
+//////////////////////////////////////////////////
+Console::Console()
+  : dataPtr(new ConsolePrivate)
+{
+  // The log file is opened when the first output is logged.
+  const char *sink = std::getenv("SDF_CONSOLE_LOG");
+  if (sink)
+  {
+    const std::string value = sink;
+    if (value == "none")
+      this->dataPtr->logSink = ConsoleLogSink::NONE;
+    else if (value == "process")
+      this->dataPtr->logSink = ConsoleLogSink::PROCESS_LOG_FILE;
+    else if (!value.empty() && value != "file")
+    {
+      std::cerr << "Unknown SDF_CONSOLE_LOG value[" << value
+                << "], expected file, process or none." << std::endl;
+    }
+  }
 }
 
 //////////////////////////////////////////////////
 Console::~Console()
 {
+  this->SetAsync(false);
 }
 
 //////////////////////////////////////////////////
@@ -130,6 +462,119 @@ Console::ConsoleStream &Console::Log(const std::string &lbl,
   return this->dataPtr->logStream;
 }
 
+//////////////////////////////////////////////////
+void Console::SetLogSink(ConsoleLogSink _sink)
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->logFileMutex);
+  if (this->dataPtr->logFileStream.is_open())
+    this->dataPtr->logFileStream.close();
+  this->dataPtr->logFileOpened = false;
+  this->dataPtr->logSink = _sink;
+}
+
+//////////////////////////////////////////////////
+ConsoleLogSink Console::LogSink() const
+{
+  return this->dataPtr->logSink.load();
+}
+
+//////////////////////////////////////////////////
+void Console::SetLogCallback(
+    std::function<void(const std::string &)> _callback)
+{
+  const bool none = !_callback;
+  {
+    std::lock_guard<std::mutex> lock(this->dataPtr->logFileMutex);
+    this->dataPtr->logCallback = std::move(_callback);
+  }
+  this->SetLogSink(none ? ConsoleLogSink::NONE : ConsoleLogSink::CALLBACK);
+}
+
+//////////////////////////////////////////////////
+bool Console::Logging() const
+{
+  return this->dataPtr->logSink.load() != ConsoleLogSink::NONE;
+}
+
+//////////////////////////////////////////////////
+void Console::WriteLog(const std::string &_text)
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->logFileMutex);
+  writeLog(this->dataPtr.get(), _text, true);
+}
+
+//////////////////////////////////////////////////
+void Console::SetAsync(bool _async, std::size_t _capacity,
+                       ConsoleDropPolicy _policy)
+{
+  // Stop the previous queue once no thread pushes into it, which writes
+  // its output.
+  ConsoleQueue *previous = this->dataPtr->queue.exchange(nullptr);
+  if (previous)
+  {
+    while (this->dataPtr->queueUsers.load() != 0)
+      std::this_thread::yield();
+    delete previous;
+  }
+
+  if (_async)
+  {
+    this->dataPtr->queue.store(
+        new ConsoleQueue(this->dataPtr.get(), _capacity, _policy));
+  }
+}
+
+//////////////////////////////////////////////////
+bool Console::Async() const
+{
+  return this->dataPtr->queue.load(std::memory_order_acquire) != nullptr;
+}
+
+//////////////////////////////////////////////////
+void Console::Flush()
+{
+  this->dataPtr->queueUsers.fetch_add(1);
+  ConsoleQueue *queue = this->dataPtr->queue.load();
+  if (queue)
+    queue->Flush();
+  this->dataPtr->queueUsers.fetch_sub(1);
+}
+
+//////////////////////////////////////////////////
+uint64_t Console::DroppedCount() const
+{
+  return this->dataPtr->droppedCount.load(std::memory_order_relaxed);
+}
+
+//////////////////////////////////////////////////
+void Console::Enqueue(std::ostream *_stream, std::string _text,
+                      std::string _logText, bool _hasLogText)
+{
+  this->dataPtr->queueUsers.fetch_add(1);
+  ConsoleQueue *queue = this->dataPtr->queue.load();
+  if (queue)
+  {
+    ConsoleRecord record;
+    record.stream = _stream;
+    record.text = std::move(_text);
+    record.logText = std::move(_logText);
+    record.hasLogText = _hasLogText;
+    queue->Push(std::move(record));
+    this->dataPtr->queueUsers.fetch_sub(1);
+    return;
+  }
+  this->dataPtr->queueUsers.fetch_sub(1);
+
+  // The console stopped being asynchronous meanwhile.
+  if (_stream)
+    *_stream << _text;
+  if (this->Logging())
+  {
+    std::lock_guard<std::mutex> lock(this->dataPtr->logFileMutex);
+    writeLog(this->dataPtr.get(), _hasLogText ? _logText : _text, true);
+  }
+}
+
 //////////////////////////////////////////////////
 void Console::ConsoleStream::Prefix(const std::string &_lbl,
                                     const std::string &_file,
@@ -138,6 +583,29 @@ void Console::ConsoleStream::Prefix(const std::string &_lbl,
 {
   size_t index = _file.find_last_of("/") + 1;
 
+  ConsolePtr console = Console::Instance();
+  if (console->Async())
+  {
+    std::ostringstream logText;
+    logText << _lbl << " [" <<
+      _file.substr(index , _file.size() - index)<< ":" << _line << "] ";
+    std::string text;
+    if (this->stream)
+    {
+#ifndef _WIN32
+      std::ostringstream terminalText;
+      terminalText << "\033[1;" << _color << "m" << _lbl << " [" <<
+        _file.substr(index , _file.size() - index) << ":" << _line <<
+        "]\033[0m ";
+      text = terminalText.str();
+#else
+      text = logText.str();
+#endif
+    }
+    console->Enqueue(this->stream, std::move(text), logText.str(), true);
+    return;
+  }
+
   (void)_color;
   if (this->stream)
   {
@@ -151,9 +619,12 @@ void Console::ConsoleStream::Prefix(const std::string &_lbl,
 #endif
   }
 
-  if (Console::Instance()->dataPtr->logFileStream.is_open())
+  if (console->Logging())
   {
-    Console::Instance()->dataPtr->logFileStream << _lbl << " [" <<
+    std::ostringstream logText;
+    logText << _lbl << " [" <<
       _file.substr(index , _file.size() - index)<< ":" << _line << "] ";
+    std::lock_guard<std::mutex> lock(console->dataPtr->logFileMutex);
+    writeLog(console->dataPtr.get(), logText.str(), false);
   }
 }
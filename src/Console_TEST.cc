@@ -15,16 +15,22 @@
  *
  */
 
+#include <fstream>
+#include <sstream>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include <gtest/gtest.h>
 
 #ifndef _WIN32
 #include <stdio.h>
 #include <stdlib.h>
+#include <unistd.h>
 #endif
 
 #include "sdf/Console.hh"
+#include "sdf/Filesystem.hh"
 
 #ifndef _WIN32
 bool create_new_temp_dir(std::string &_new_temp_path)
@@ -94,6 +100,117 @@ TEST(Console, logdir_doesnt_exist)
   sdferr << "Error.\n";
 }
 
+////////////////////////////////////////////////////
+TEST(Console, Async)
+{
+  sdf::Console::Clear();
+
+  std::string temp_dir;
+  ASSERT_TRUE(create_new_temp_dir(temp_dir));
+  ASSERT_EQ(setenv("HOME", temp_dir.c_str(), 1), 0);
+
+  sdf::ConsolePtr con = sdf::Console::Instance();
+  EXPECT_FALSE(con->Async());
+
+  // A blocking queue much smaller than the output keeps all of it, and
+  // the output of each thread in order.
+  con->SetAsync(true, 4, sdf::ConsoleDropPolicy::BLOCK);
+  EXPECT_TRUE(con->Async());
+
+  const int threadCount = 4;
+  const int messageCount = 100;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < threadCount; ++t)
+  {
+    threads.emplace_back([t]()
+        {
+          for (int i = 0; i < messageCount; ++i)
+          {
+            sdfdbg << "Message " + std::to_string(t) + "-" +
+                std::to_string(i) + ".\n";
+          }
+        });
+  }
+  for (auto &thread : threads)
+    thread.join();
+  con->Flush();
+  EXPECT_EQ(0u, con->DroppedCount());
+
+  std::ifstream logFile(temp_dir + "/.sdformat/sdformat.log");
+  std::stringstream log;
+  log << logFile.rdbuf();
+  for (int t = 0; t < threadCount; ++t)
+  {
+    std::size_t pos = 0;
+    for (int i = 0; i < messageCount; ++i)
+    {
+      const std::string message =
+          "Message " + std::to_string(t) + "-" + std::to_string(i) + ".\n";
+      const std::size_t next = log.str().find(message, pos);
+      ASSERT_NE(std::string::npos, next) << message;
+      pos = next + message.size();
+    }
+  }
+
+  // Disabling the queue writes the rest of the output.
+  sdfdbg << "Last message.\n";
+  con->SetAsync(false);
+  EXPECT_FALSE(con->Async());
+  logFile.close();
+  logFile.open(temp_dir + "/.sdformat/sdformat.log");
+  log.str("");
+  log << logFile.rdbuf();
+  EXPECT_NE(std::string::npos, log.str().find("Last message.\n"));
+
+  sdf::Console::Clear();
+}
+
+////////////////////////////////////////////////////
+TEST(Console, LogSink)
+{
+  sdf::Console::Clear();
+
+  std::string temp_dir;
+  ASSERT_TRUE(create_new_temp_dir(temp_dir));
+  ASSERT_EQ(setenv("HOME", temp_dir.c_str(), 1), 0);
+  const std::string logDir = temp_dir + "/.sdformat";
+
+  // The log file is not created until output is logged.
+  sdf::ConsolePtr con = sdf::Console::Instance();
+  EXPECT_EQ(sdf::ConsoleLogSink::LOG_FILE, con->LogSink());
+  EXPECT_FALSE(sdf::filesystem::exists(logDir));
+
+  con->SetLogSink(sdf::ConsoleLogSink::NONE);
+  EXPECT_EQ(sdf::ConsoleLogSink::NONE, con->LogSink());
+  sdferr << "Not logged.\n";
+  EXPECT_FALSE(sdf::filesystem::exists(logDir));
+
+  std::string logged;
+  con->SetLogCallback([&logged](const std::string &_text)
+      {
+        logged += _text;
+      });
+  EXPECT_EQ(sdf::ConsoleLogSink::CALLBACK, con->LogSink());
+  sdfdbg << "Logged " << 1 << ".\n";
+  EXPECT_NE(std::string::npos, logged.find("Logged 1.\n"));
+  EXPECT_FALSE(sdf::filesystem::exists(logDir));
+
+  con->SetLogCallback(nullptr);
+  EXPECT_EQ(sdf::ConsoleLogSink::NONE, con->LogSink());
+
+  con->SetLogSink(sdf::ConsoleLogSink::PROCESS_LOG_FILE);
+  sdfdbg << "Process log.\n";
+  const std::string logFile = logDir + "/sdformat-" +
+      std::to_string(getpid()) + ".log";
+  std::ifstream logStream(logFile);
+  std::stringstream log;
+  log << logStream.rdbuf();
+  EXPECT_NE(std::string::npos, log.str().find("Process log.\n"));
+  EXPECT_FALSE(sdf::filesystem::exists(logDir + "/sdformat.log"));
+
+  sdf::Console::Clear();
+}
+
 #endif  // _WIN32
 
 ////////////////////////////////////////////////////
@@ -16,10 +16,15 @@
  */
 
 #include <algorithm>
+#include <cstddef>
+#include <deque>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <set>
 #include <sstream>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 
@@ -30,15 +35,583 @@
 
 #include "Converter.hh"
 #include "EmbeddedSdf.hh"
+#include "ScopedParseEvent.hh"
+#include "Utils.hh"
 
 using namespace sdf;
 
 namespace {
-bool EndsWith(const std::string& _a, const std::string& _b)
+bool EndsWith(std::string_view _a, std::string_view _b)
 {
   return (_a.size() >= _b.size()) &&
       (_a.compare(_a.size() - _b.size(), _b.size(), _b) == 0);
 }
+
+/// \brief The conversion recipes that upgrade a document from one version
+/// towards another, parsed once.
+struct ConversionChain
+{
+  /// \brief The parsed recipes, in the order they are applied. They are
+  /// only read while converting, so they can be shared between threads.
+  std::vector<std::shared_ptr<TiXmlDocument>> recipes;
+
+  /// \brief Descendant names of the elements of the version each recipe
+  /// upgrades from, in the order of the recipes. A pointer is null if that
+  /// version has no precompiled description.
+  std::vector<std::shared_ptr<const DescendantNames>> descendantNames;
+
+  /// \brief The version reached after applying all the recipes.
+  std::string finalVersion;
+
+  /// \brief False if a recipe of the chain failed to parse.
+  bool valid = true;
+};
+
+/// \brief Guards the recipe and chain caches below.
+std::mutex g_conversionMutex;
+
+/// \brief Parsed recipes, by their embedded file.
+std::map<const EmbeddedSdfFile *, std::shared_ptr<TiXmlDocument>>
+    g_recipeCache;
+
+/// \brief Recipe chains, by version converted from and version converted
+/// to.
+std::map<std::pair<std::string, std::string>,
+    std::shared_ptr<const ConversionChain>> g_chainCache;
+
+/// \brief Descendant names of the elements of each version, built from
+/// its precompiled description.
+std::map<std::string, std::shared_ptr<const DescendantNames>>
+    g_descendantNamesCache;
+
+/// \brief Collect the names of the children of an element description and
+/// of the descriptions nested in it.
+/// \param[in] _descriptions The precompiled description tables.
+/// \param[in] _version Version of the description.
+/// \param[in] _index Index of the description in the element table.
+/// \param[in,out] _children Names of the children, by element name.
+/// \param[in,out] _open Names of the elements that may have children
+/// which are not described.
+void childNames(const EmbeddedSdfDescriptions &_descriptions,
+    std::string_view _version, unsigned int _index,
+    std::map<std::string, std::set<std::string>> &_children,
+    std::set<std::string> &_open)
+{
+  const EmbeddedSdfElement &desc = _descriptions.elements[_index];
+
+  // The descendants of a <plugin> are never converted, whatever they are.
+  if (desc.copyChildren && std::string_view(desc.name) != "plugin")
+    _open.insert(desc.name);
+
+  std::set<std::string> &children = _children[desc.name];
+  for (unsigned int i = 0; i < desc.childCount; ++i)
+  {
+    const EmbeddedSdfChild &child =
+        _descriptions.children[desc.firstChild + i];
+    if (child.element >= 0)
+    {
+      const auto childIndex = static_cast<unsigned int>(child.element);
+      children.insert(_descriptions.elements[childIndex].name);
+      childNames(_descriptions, _version, childIndex, _children, _open);
+      continue;
+    }
+
+    const EmbeddedSdfFile *file = FindEmbeddedSdf(_version, child.filename);
+    if (file == nullptr || file->description < 0)
+    {
+      _open.insert(desc.name);
+      continue;
+    }
+    children.insert(_descriptions.elements[file->description].name);
+  }
+}
+
+/// \brief Get the descendant names of the elements of a version, building
+/// and caching them on first use. The caller must hold g_conversionMutex.
+/// \param[in] _version The version.
+/// \return The descendant names, or nullptr if the version has no
+/// precompiled description.
+std::shared_ptr<const DescendantNames> descendantNames(
+    const std::string &_version)
+{
+  auto &cached = g_descendantNamesCache[_version];
+  if (cached)
+    return cached;
+
+  const EmbeddedSdfDescriptions &descriptions = GetEmbeddedSdfDescriptions();
+  std::map<std::string, std::set<std::string>> children;
+  std::set<std::string> open;
+  for (const EmbeddedSdfFile &file : GetEmbeddedSdfFiles())
+  {
+    if (file.version == _version && file.description >= 0)
+    {
+      childNames(descriptions, _version,
+          static_cast<unsigned int>(file.description), children, open);
+    }
+  }
+  if (children.empty())
+    return nullptr;
+
+  auto names = std::make_shared<DescendantNames>();
+  for (const auto &entry : children)
+  {
+    std::set<std::string> descendants;
+    std::vector<std::string> stack(entry.second.begin(), entry.second.end());
+    bool closed = open.count(entry.first) == 0;
+    while (closed && !stack.empty())
+    {
+      const std::string name = std::move(stack.back());
+      stack.pop_back();
+      if (!descendants.insert(name).second)
+        continue;
+
+      closed = open.count(name) == 0;
+      auto iter = children.find(name);
+      if (iter != children.end())
+        stack.insert(stack.end(), iter->second.begin(), iter->second.end());
+    }
+
+    if (closed)
+      (*names)[entry.first] = std::move(descendants);
+  }
+
+  cached = names;
+  return cached;
+}
+
+/// \brief Collect the names of the elements and attributes that a convert
+/// rule can match, read or modify, which are the attribute values of the
+/// rule and of its children, split at the '/' and "::" path separators and
+/// without the '@' that marks attributes in paths.
+/// \param[in] _rule The convert rule.
+/// \param[in,out] _names The names are inserted in this set.
+void ruleNames(const TiXmlElement *_rule, std::set<std::string> &_names)
+{
+  for (const TiXmlAttribute *attr = _rule->FirstAttribute(); attr;
+       attr = attr->Next())
+  {
+    std::string path = attr->ValueStr();
+    for (std::size_t pos = path.find("::"); pos != std::string::npos;
+         pos = path.find("::", pos))
+    {
+      path.replace(pos, 2, "/");
+    }
+
+    std::stringstream stream(path);
+    std::string name;
+    while (std::getline(stream, name, '/'))
+    {
+      if (!name.empty() && name[0] == '@')
+        name.erase(0, 1);
+      _names.insert(name);
+    }
+  }
+
+  for (const TiXmlElement *child = _rule->FirstChildElement(); child;
+       child = child->NextSiblingElement())
+  {
+    ruleNames(child, _names);
+  }
+}
+
+/// \brief Get the descendant conversions that are applied in the same
+/// walk of the tree as a descendant conversion.
+/// \param[in] _convert A convert rule with a descendant_name attribute.
+/// \return _convert followed by the consecutive descendant conversions that
+/// are applied with it.
+std::vector<TiXmlElement *> descendantGroup(TiXmlElement *_convert)
+{
+  // Each descendant conversion walks the whole tree, so consecutive
+  // ones are applied in a single walk when they can't affect each
+  // other. A conversion only changes the subtree of the element it
+  // matches, and only through the names it mentions, so this is the
+  // case when the conversions mention disjoint sets of names.
+  std::vector<TiXmlElement *> group = {_convert};
+  std::set<std::string> groupNames;
+  ruleNames(_convert, groupNames);
+  for (TiXmlElement *next = _convert->NextSiblingElement("convert");
+       next && !next->Attribute("name") &&
+       next->Attribute("descendant_name");
+       next = next->NextSiblingElement("convert"))
+  {
+    std::set<std::string> names;
+    ruleNames(next, names);
+    if (std::any_of(names.begin(), names.end(),
+          [&groupNames](const std::string &_name)
+          {
+            return groupNames.count(_name) > 0;
+          }))
+    {
+      break;
+    }
+    groupNames.insert(names.begin(), names.end());
+    group.push_back(next);
+  }
+  return group;
+}
+
+/// \brief Get the names of the elements whose descendants a walk of
+/// descendant conversions doesn't visit.
+/// \param[in] _group The descendant conversions applied in the walk.
+/// \param[in] _names Descendant names of the elements of the version of
+/// the tree, or nullptr.
+/// \return The names.
+std::set<std::string> skippedNames(const std::vector<TiXmlElement *> &_group,
+    const DescendantNames *_names)
+{
+  // Most subtrees, such as those of visuals, can't contain any of the
+  // converted elements according to the specification, so they are
+  // not walked.
+  std::set<std::string> skip;
+  if (!_names)
+    return skip;
+
+  std::set<std::string> targets;
+  for (const TiXmlElement *convert : _group)
+    targets.insert(convert->Attribute("descendant_name"));
+
+  for (const auto &entry : *_names)
+  {
+    if (std::none_of(targets.begin(), targets.end(),
+          [&entry](const std::string &_target)
+          {
+            return entry.second.count(_target) > 0;
+          }))
+    {
+      skip.insert(entry.first);
+    }
+  }
+  return skip;
+}
+
+/// \brief Read the values and the paths of a map rule.
+/// \param[in] _mapElem The map rule.
+/// \param[out] _valueMap The values to map, by value mapped from.
+/// \param[out] _fromTokens Path of the element or attribute mapped from.
+/// \param[out] _toTokens Path of the element or attribute mapped to.
+/// \return False if the rule is invalid, which is reported.
+bool readMap(TiXmlElement *_mapElem,
+    std::map<std::string, std::string> &_valueMap,
+    std::vector<std::string> &_fromTokens,
+    std::vector<std::string> &_toTokens)
+{
+  TiXmlElement *fromConvertElem = _mapElem->FirstChildElement("from");
+  TiXmlElement *toConvertElem = _mapElem->FirstChildElement("to");
+
+  if (!fromConvertElem)
+  {
+    sdferr << "<map> element requires a <from> child element.\n";
+    return false;
+  }
+  if (!toConvertElem)
+  {
+    sdferr << "<map> element requires a <to> child element.\n";
+    return false;
+  }
+
+  const char *fromNameStr = fromConvertElem->Attribute("name");
+  const char *toNameStr = toConvertElem->Attribute("name");
+
+  if (!fromNameStr || fromNameStr[0] == '\0')
+  {
+    sdferr << "Map: <from> element requires a non-empty name attribute.\n";
+    return false;
+  }
+  if (!toNameStr || toNameStr[0] == '\0')
+  {
+    sdferr << "Map: <to> element requires a non-empty name attribute.\n";
+    return false;
+  }
+
+  // create map of input and output values
+  TiXmlElement *fromValueElem = fromConvertElem->FirstChildElement("value");
+  TiXmlElement *toValueElem = toConvertElem->FirstChildElement("value");
+  if (!fromValueElem)
+  {
+    sdferr << "Map: <from> element requires at least one <value> element.\n";
+    return false;
+  }
+  if (!toValueElem)
+  {
+    sdferr << "Map: <to> element requires at least one <value> element.\n";
+    return false;
+  }
+  if (!fromValueElem->GetText())
+  {
+    sdferr << "Map: from value must not be empty.\n";
+    return false;
+  }
+  if (!toValueElem->GetText())
+  {
+    sdferr << "Map: to value must not be empty.\n";
+    return false;
+  }
+  _valueMap[fromValueElem->GetText()] = toValueElem->GetText();
+  while (fromValueElem->NextSiblingElement("value"))
+  {
+    fromValueElem = fromValueElem->NextSiblingElement("value");
+    if (toValueElem->NextSiblingElement("value"))
+    {
+      toValueElem = toValueElem->NextSiblingElement("value");
+    }
+    if (!fromValueElem->GetText())
+    {
+      sdferr << "Map: from value must not be empty.\n";
+      return false;
+    }
+    if (!toValueElem->GetText())
+    {
+      sdferr << "Map: to value must not be empty.\n";
+      return false;
+    }
+    _valueMap[fromValueElem->GetText()] = toValueElem->GetText();
+  }
+
+  // tokenize 'from' and 'to' name attributes
+  _fromTokens = split(fromNameStr, "/");
+  _toTokens = split(toNameStr, "/");
+
+  // split() always returns at least one element, even with the
+  // empty string.  Thus we don't check if the fromTokens or toTokens are empty.
+  return true;
+}
+
+/// \brief Split the paths of a <move> or <copy> rule at "::".
+/// \param[in] _moveElem The rule, which has <from> and <to> children.
+/// \param[out] _fromTokens Path of the element or attribute moved from.
+/// \param[out] _toTokens Path of the element or attribute moved to.
+void readMove(TiXmlElement *_moveElem, std::vector<std::string> &_fromTokens,
+    std::vector<std::string> &_toTokens)
+{
+  TiXmlElement *fromConvertElem = _moveElem->FirstChildElement("from");
+  TiXmlElement *toConvertElem = _moveElem->FirstChildElement("to");
+
+  const char *fromStr = fromConvertElem->Attribute("element");
+  if (!fromStr)
+    fromStr = fromConvertElem->Attribute("attribute");
+  const char *toStr = toConvertElem->Attribute("element");
+  if (!toStr)
+    toStr = toConvertElem->Attribute("attribute");
+
+  // split() always returns at least one element, even with the
+  // empty string.  Thus we don't check if the fromTokens or toTokens are empty.
+  _fromTokens = split(fromStr ? fromStr : "", "::");
+  _toTokens = split(toStr ? toStr : "", "::");
+}
+
+/// \brief The paths of a <map>, <move> or <copy> rule, split once when its
+/// recipe is parsed instead of each time the rule is applied. The rule
+/// points to its paths through its user data.
+struct RulePaths
+{
+  /// \brief The values to map, for a <map> rule.
+  std::map<std::string, std::string> valueMap;
+
+  /// \brief Path of the element or attribute the rule reads.
+  std::vector<std::string> fromTokens;
+
+  /// \brief Path of the element or attribute the rule writes.
+  std::vector<std::string> toTokens;
+};
+
+/// \brief A parsed recipe, with the paths of its rules.
+struct CompiledRecipe
+{
+  /// \brief The recipe.
+  TiXmlDocument doc;
+
+  /// \brief The paths of the rules of the recipe. A deque keeps the paths
+  /// at the addresses stored in the rules.
+  std::deque<RulePaths> rulePaths;
+};
+
+/// \brief Split the paths of the <map>, <move> and <copy> rules of a
+/// recipe, and point the rules to them. Invalid rules are left alone, so
+/// that applying them reports the error as before.
+/// \param[in] _node The recipe, or a <convert> element of it.
+/// \param[in,out] _paths The paths are appended to this deque.
+void compileRules(TiXmlNode *_node, std::deque<RulePaths> &_paths)
+{
+  for (TiXmlElement *rule = _node->FirstChildElement(); rule;
+       rule = rule->NextSiblingElement())
+  {
+    const std::string &name = rule->ValueStr();
+    if (name == "convert")
+    {
+      compileRules(rule, _paths);
+    }
+    else if (name == "map")
+    {
+      RulePaths paths;
+      if (readMap(rule, paths.valueMap, paths.fromTokens, paths.toTokens))
+      {
+        _paths.push_back(std::move(paths));
+        rule->SetUserData(&_paths.back());
+      }
+    }
+    else if ((name == "move" || name == "copy") &&
+             rule->FirstChildElement("from") && rule->FirstChildElement("to"))
+    {
+      _paths.emplace_back();
+      readMove(rule, _paths.back().fromTokens, _paths.back().toTokens);
+      rule->SetUserData(&_paths.back());
+    }
+  }
+}
+
+/// \brief Get the paths of a <map>, <move> or <copy> rule.
+/// \param[in] _rule The rule.
+/// \param[out] _local The paths are split into this object if the rule
+/// is not part of a compiled recipe.
+/// \return The paths, or nullptr if the <map> rule is invalid, which is
+/// reported.
+const RulePaths *rulePaths(TiXmlElement *_rule, RulePaths &_local)
+{
+  if (const void *paths = _rule->GetUserData())
+    return static_cast<const RulePaths *>(paths);
+
+  if (_rule->ValueStr() == "map")
+  {
+    if (!readMap(_rule, _local.valueMap, _local.fromTokens, _local.toTokens))
+      return nullptr;
+  }
+  else
+  {
+    readMove(_rule, _local.fromTokens, _local.toTokens);
+  }
+  return &_local;
+}
+
+/// \brief Get the chain of recipes that converts a document towards a
+/// version, building and caching it on first use.
+/// \param[in] _fromVersion Version of the document.
+/// \param[in] _toVersion Version to convert to.
+/// \return The chain. It stops early if there is no recipe to upgrade one
+/// of the intermediate versions. Chains are never removed from the cache,
+/// so the reference stays valid, and returning it instead of a copy of the
+/// shared pointer leaves the reference count of a cached chain untouched.
+const ConversionChain &conversionChain(
+    const std::string &_fromVersion, const std::string &_toVersion)
+{
+  std::lock_guard<std::mutex> lock(g_conversionMutex);
+
+  auto &chain = g_chainCache[{_fromVersion, _toVersion}];
+  if (chain)
+    return *chain;
+
+  auto newChain = std::make_shared<ConversionChain>();
+  std::string curVersion = _fromVersion;
+  while (curVersion != _toVersion)
+  {
+    // The recipe that upgrades from, e.g., 1.7 is "1.8/1_7.convert".
+    const EmbeddedSdfFile *convert = FindEmbeddedSdfConversion(curVersion);
+    if (convert == nullptr)
+    {
+      break;
+    }
+    newChain->descendantNames.push_back(descendantNames(curVersion));
+    curVersion = std::string(convert->version);
+
+    auto &recipe = g_recipeCache[convert];
+    if (!recipe)
+    {
+      auto compiled = std::make_shared<CompiledRecipe>();
+      compiled->doc.Parse(convert->Content().data());
+      if (compiled->doc.Error())
+      {
+        sdferr << "Error parsing XML from string: "
+               << compiled->doc.ErrorDesc() << '\n';
+        newChain->valid = false;
+        break;
+      }
+      compileRules(&compiled->doc, compiled->rulePaths);
+      // The document shares ownership of the paths its rules point to.
+      recipe = std::shared_ptr<TiXmlDocument>(compiled, &compiled->doc);
+    }
+    newChain->recipes.push_back(recipe);
+  }
+  newChain->finalVersion = curVersion;
+
+  chain = newChain;
+  return *chain;
+}
+
+/// \brief Get the value of an element of an element tree, or of one of its
+/// attributes, if it was read from the document or set by a conversion.
+/// Values that the parser only initialized to their defaults are not set,
+/// as if they were missing from the document.
+/// \param[in] _elem The element.
+/// \param[in] _attribute Name of the attribute, or nullptr for the value
+/// of the element.
+/// \param[out] _value The value.
+/// \return True if the value is set.
+bool readValue(const ElementPtr &_elem, const char *_attribute,
+    std::string &_value)
+{
+  ParamPtr param = _attribute ? _elem->GetAttribute(_attribute) :
+      _elem->GetValue();
+  if (!param || !param->GetSet())
+    return false;
+
+  _value = param->GetAsString();
+  return true;
+}
+
+/// \brief Set an attribute of an element of an element tree. An attribute
+/// that isn't described, or whose type doesn't accept the value, is
+/// replaced with a string attribute.
+/// \param[in] _elem The element.
+/// \param[in] _key Key of the attribute.
+/// \param[in] _value The value.
+void writeAttribute(const ElementPtr &_elem, const std::string &_key,
+    const std::string &_value)
+{
+  ParamPtr param = _elem->GetAttribute(_key);
+  if (param && param->SetFromString(_value))
+    return;
+
+  _elem->RemoveAttribute(_key);
+  _elem->AddAttribute(_key, "string", "", false);
+  _elem->GetAttribute(_key)->SetFromString(_value);
+}
+
+/// \brief Set the value of an element of an element tree. A value that
+/// isn't described, or whose type doesn't accept the value, is replaced
+/// with a string value.
+/// \param[in] _elem The element.
+/// \param[in] _value The value.
+void writeText(const ElementPtr &_elem, const std::string &_value)
+{
+  ParamPtr param = _elem->GetValue();
+  if (param && param->SetFromString(_value))
+    return;
+
+  _elem->AddValue("string", "", false);
+  _elem->GetValue()->SetFromString(_value);
+}
+
+/// \brief Append a child to an element of an element tree. The child is
+/// created from its description if the element has one.
+/// \param[in] _elem The element.
+/// \param[in] _name Name of the child.
+/// \return The child.
+ElementPtr addChild(const ElementPtr &_elem, const std::string &_name)
+{
+  ElementPtr child;
+  ElementPtr desc = _elem->GetElementDescription(_name);
+  if (desc)
+  {
+    child = desc->Clone();
+  }
+  else
+  {
+    child.reset(new Element);
+    child->SetName(_name);
+  }
+  child->SetParent(_elem);
+  _elem->InsertElement(child);
+  return child;
+}
 }
 
 /////////////////////////////////////////////////
@@ -47,6 +620,10 @@ bool Converter::Convert(TiXmlDocument *_doc, const std::string &_toVersion,
 {
   SDF_ASSERT(_doc != nullptr, "SDF XML doc is NULL");
 
+  // The value of a document loaded from a file is the file name.
+  ScopedParseEvent convertEvent(ParseStage::CONVERT,
+      "sdf::Converter::Convert", _doc->Value());
+
   TiXmlElement *elem = _doc->FirstChildElement("sdf");
 
   // Check that the <sdf> element exists
@@ -79,101 +656,712 @@ bool Converter::Convert(TiXmlDocument *_doc, const std::string &_toVersion,
 
   elem->SetAttribute("version", _toVersion);
 
-  // The conversion recipes within the embedded files database are named, e.g.,
-  // "1.8/1_7.convert" to upgrade from 1.7 to 1.8.
-  const std::map<std::string, std::string> &embedded = GetEmbeddedSdf();
-
   // Apply the conversions one at a time until we reach the desired _toVersion.
-  std::string curVersion = origVersion;
-  while (curVersion != _toVersion)
+  // The recipes are parsed once, and the chain of recipes between two
+  // versions is reused by later conversions.
+  const ConversionChain &chain = conversionChain(origVersion, _toVersion);
+  for (std::size_t i = 0; i < chain.recipes.size(); ++i)
   {
-    // Find the (at most one) file named, e.g., ".../1_7.convert".
-    std::string snakeVersion = curVersion;
-    std::replace(snakeVersion.begin(), snakeVersion.end(), '.', '_');
-    const std::string suffix = "/" + snakeVersion + ".convert";
-    const char* convertXml = nullptr;
-    for (const auto& [pathname, data] : embedded)
-    {
-      if (EndsWith(pathname, suffix))
-      {
-        curVersion = pathname.substr(0, pathname.size() - suffix.size());
-        convertXml = data.c_str();
-        break;
-      }
-    }
-    if (convertXml == nullptr)
-    {
-      break;
-    }
+    ConvertImpl(elem, chain.recipes[i]->FirstChildElement("convert"),
+        chain.descendantNames[i].get());
+  }
 
-    // Parse and apply the conversion XML.
-    TiXmlDocument xmlDoc;
-    xmlDoc.Parse(convertXml);
-    if (xmlDoc.Error())
-    {
-      sdferr << "Error parsing XML from string: "
-             << xmlDoc.ErrorDesc() << '\n';
-      return false;
-    }
-    ConvertImpl(elem, xmlDoc.FirstChildElement("convert"));
+  if (!chain.valid)
+  {
+    return false;
   }
 
   // Check that we actually converted to the desired final version.
-  if (curVersion != _toVersion)
+  if (chain.finalVersion != _toVersion)
   {
     sdferr << "Unable to convert from SDF version " << origVersion
            << " to " << _toVersion << "\n";
     return false;
   }
 
+  convertEvent.SetElements(_doc);
   return true;
 }
 
 /////////////////////////////////////////////////
-void Converter::Convert(TiXmlDocument *_doc, TiXmlDocument *_convertDoc)
+bool Converter::Convert(ElementPtr _elem, const std::string &_toVersion,
+                        bool _quiet)
 {
-  SDF_ASSERT(_doc != NULL, "SDF XML doc is NULL");
-  SDF_ASSERT(_convertDoc != NULL, "Convert XML doc is NULL");
+  SDF_ASSERT(_elem != nullptr, "SDF element is nullptr");
+
+  ScopedParseEvent convertEvent(ParseStage::CONVERT,
+      "sdf::Converter::Convert", _elem->FilePath());
+
+  if (_elem->GetName() != "sdf")
+  {
+    sdferr << "<sdf> element does not exist.\n";
+    return false;
+  }
+
+  std::string origVersion;
+  if (!readValue(_elem, "version", origVersion) || origVersion.empty())
+  {
+    sdferr << "  Unable to determine original SDF version\n";
+    return false;
+  }
+
+  if (origVersion == _toVersion)
+  {
+    return true;
+  }
+
+  if (!_quiet)
+  {
+    sdfdbg << "Version[" << origVersion << "] to Version[" << _toVersion
+           << "]\n";
+  }
+
+  writeAttribute(_elem, "version", _toVersion);
+
+  const ConversionChain &chain = conversionChain(origVersion, _toVersion);
+  for (std::size_t i = 0; i < chain.recipes.size(); ++i)
+  {
+    ConvertImpl(_elem, chain.recipes[i]->FirstChildElement("convert"),
+        chain.descendantNames[i].get());
+  }
+
+  if (!chain.valid)
+  {
+    return false;
+  }
+
+  if (chain.finalVersion != _toVersion)
+  {
+    sdferr << "Unable to convert from SDF version " << origVersion
+           << " to " << _toVersion << "\n";
+    return false;
+  }
+
+  convertEvent.SetElements(_elem);
+  return true;
+}
+
+/////////////////////////////////////////////////
+void Converter::CompileRecipes(const std::string &_toVersion)
+{
+  // Every recipe is named after the version it upgrades from, e.g.
+  // "1.8/1_7.convert", so building the chain from each of those versions
+  // parses every recipe.
+  const std::string_view suffix = ".convert";
+  for (const EmbeddedSdfFile &file : GetEmbeddedSdfFiles())
+  {
+    if (!EndsWith(file.name, suffix))
+      continue;
+
+    std::string fromVersion(file.name.substr(0,
+        file.name.size() - suffix.size()));
+    std::replace(fromVersion.begin(), fromVersion.end(), '_', '.');
+    if (fromVersion != _toVersion)
+      conversionChain(fromVersion, _toVersion);
+  }
+}
+
+/////////////////////////////////////////////////
+void Converter::Convert(TiXmlDocument *_doc, TiXmlDocument *_convertDoc)
+{
+  SDF_ASSERT(_doc != NULL, "SDF XML doc is NULL");
+  SDF_ASSERT(_convertDoc != NULL, "Convert XML doc is NULL");
+
+  ConvertImpl(_doc->FirstChildElement(), _convertDoc->FirstChildElement(),
+      nullptr);
+}
+
+/////////////////////////////////////////////////
+void Converter::ConvertDescendantsImpl(TiXmlElement *_e,
+    const std::vector<TiXmlElement *> &_converts,
+    const std::set<std::string> &_skip,
+    const DescendantNames *_names)
+{
+  if (_e->ValueStr() == "plugin")
+  {
+    return;
+  }
+
+  if (_e->ValueStr().find(":") != std::string::npos)
+  {
+    return;
+  }
+
+  TiXmlElement *e = _e->FirstChildElement();
+  while (e)
+  {
+    for (TiXmlElement *c : _converts)
+    {
+      if (e->ValueStr() == c->Attribute("descendant_name"))
+      {
+        ConvertImpl(e, c, _names);
+      }
+    }
+    if (_skip.count(e->ValueStr()) == 0)
+      ConvertDescendantsImpl(e, _converts, _skip, _names);
+    e = e->NextSiblingElement();
+  }
+}
+
+/////////////////////////////////////////////////
+void Converter::ConvertImpl(TiXmlElement *_elem, TiXmlElement *_convert,
+                            const DescendantNames *_names)
+{
+  SDF_ASSERT(_elem != NULL, "SDF element is NULL");
+  SDF_ASSERT(_convert != NULL, "Convert element is NULL");
+
+  CheckDeprecation(_elem, _convert);
+
+  for (TiXmlElement *convertElem = _convert->FirstChildElement("convert");
+       convertElem; convertElem = convertElem->NextSiblingElement("convert"))
+  {
+    if (convertElem->Attribute("name"))
+    {
+      TiXmlElement *elem = _elem->FirstChildElement(
+          convertElem->Attribute("name"));
+      while (elem)
+      {
+        ConvertImpl(elem, convertElem, _names);
+        elem = elem->NextSiblingElement(convertElem->Attribute("name"));
+      }
+    }
+    if (convertElem->Attribute("descendant_name"))
+    {
+      const std::vector<TiXmlElement *> group =
+          descendantGroup(convertElem);
+      const std::set<std::string> skip = skippedNames(group, _names);
+      ConvertDescendantsImpl(_elem, group, skip, _names);
+      convertElem = group.back();
+    }
+  }
+
+  for (TiXmlElement *childElem = _convert->FirstChildElement();
+       childElem; childElem = childElem->NextSiblingElement())
+  {
+    if (childElem->ValueStr() == "rename")
+    {
+      Rename(_elem, childElem);
+    }
+    else if (childElem->ValueStr() == "copy")
+    {
+      Move(_elem, childElem, true);
+    }
+    else if (childElem->ValueStr() == "map")
+    {
+      Map(_elem, childElem);
+    }
+    else if (childElem->ValueStr() == "move")
+    {
+      Move(_elem, childElem, false);
+    }
+    else if (childElem->ValueStr() == "add")
+    {
+      Add(_elem, childElem);
+    }
+    else if (childElem->ValueStr() == "remove")
+    {
+      Remove(_elem, childElem);
+    }
+    else if (childElem->ValueStr() != "convert")
+    {
+      sdferr << "Unknown convert element[" << childElem->ValueStr() << "]\n";
+    }
+  }
+}
+
+/////////////////////////////////////////////////
+void Converter::Rename(TiXmlElement *_elem, TiXmlElement *_renameElem)
+{
+  SDF_ASSERT(_elem != NULL, "SDF element is NULL");
+  SDF_ASSERT(_renameElem != NULL, "Rename element is NULL");
+
+  TiXmlElement *fromConvertElem = _renameElem->FirstChildElement("from");
+  TiXmlElement *toConvertElem = _renameElem->FirstChildElement("to");
+
+  const char *fromElemName = fromConvertElem->Attribute("element");
+  const char *fromAttrName = fromConvertElem->Attribute("attribute");
+
+  const char *toElemName = toConvertElem->Attribute("element");
+  const char *toAttrName = toConvertElem->Attribute("attribute");
+
+  const char *value = GetValue(fromElemName, fromAttrName, _elem);
+  if (!value)
+  {
+    return;
+  }
+
+  if (!toElemName)
+  {
+    sdferr << "No 'to' element name specified\n";
+    return;
+  }
+
+  TiXmlElement *replaceTo = new TiXmlElement(toElemName);
+  if (toAttrName)
+  {
+    replaceTo->SetAttribute(toAttrName, value);
+  }
+  else
+  {
+    TiXmlText *text = new TiXmlText(value);
+    // The tinyxml function LinkEndChild takes the pointer and takes ownership
+    // of the memory, so it is responsible for freeing it later.
+    replaceTo->LinkEndChild(text);
+  }
+
+  if (fromElemName)
+  {
+    TiXmlElement *replaceFrom = _elem->FirstChildElement(fromElemName);
+    if (_elem->ReplaceChild(replaceFrom, *replaceTo) == nullptr)
+    {
+      sdferr << "Failed to rename element\n";
+      // fall through so we can reclaim memory
+    }
+
+    // In this case, the tinyxml function ReplaceChild does a deep copy of the
+    // node that is passed in, so we want to free it here.
+    delete replaceTo;
+  }
+  else if (fromAttrName)
+  {
+    _elem->RemoveAttribute(fromAttrName);
+    // In this case, the tinyxml function LinkEndChild just takes the pointer
+    // and takes ownership of the memory, so it is responsible for freeing it
+    // later.
+    _elem->LinkEndChild(replaceTo);
+  }
+}
+
+/////////////////////////////////////////////////
+void Converter::Add(TiXmlElement *_elem, TiXmlElement *_addElem)
+{
+  SDF_ASSERT(_elem != NULL, "SDF element is NULL");
+  SDF_ASSERT(_addElem != NULL, "Add element is NULL");
+
+  const char *attributeName = _addElem->Attribute("attribute");
+  const char *elementName = _addElem->Attribute("element");
+  const char *value = _addElem->Attribute("value");
+
+  if (!((attributeName == nullptr) ^ (elementName == nullptr)))
+  {
+    sdferr << "Exactly one 'element' or 'attribute'"
+           << " must be specified in <add>\n";
+    return;
+  }
+
+  if (attributeName)
+  {
+    if (value)
+    {
+      _elem->SetAttribute(attributeName, value);
+    }
+    else
+    {
+      sdferr << "No 'value' specified in <add>\n";
+      return;
+    }
+  }
+  else
+  {
+    TiXmlElement *addElem = new TiXmlElement(elementName);
+    if (value)
+    {
+      TiXmlText *addText = new TiXmlText(value);
+      addElem->LinkEndChild(addText);
+    }
+    _elem->LinkEndChild(addElem);
+  }
+}
+
+/////////////////////////////////////////////////
+void Converter::Remove(TiXmlElement *_elem, TiXmlElement *_removeElem)
+{
+  SDF_ASSERT(_elem != NULL, "SDF element is NULL");
+  SDF_ASSERT(_removeElem != NULL, "Move element is NULL");
+
+  const char *attributeName = _removeElem->Attribute("attribute");
+  const char *elementName = _removeElem->Attribute("element");
+
+  if (!((attributeName == nullptr) ^ (elementName == nullptr)))
+  {
+    sdferr << "Exactly one 'element' or 'attribute'"
+           << " must be specified in <remove>\n";
+    return;
+  }
+
+  if (attributeName)
+  {
+    _elem->RemoveAttribute(attributeName);
+  }
+  else
+  {
+    TiXmlElement *childElem = _elem->FirstChildElement(elementName);
+    while (childElem)
+    {
+      _elem->RemoveChild(childElem);
+      childElem = _elem->FirstChildElement(elementName);
+    }
+  }
+}
+
+/////////////////////////////////////////////////
+void Converter::Map(TiXmlElement *_elem, TiXmlElement *_mapElem)
+{
+  SDF_ASSERT(_elem != nullptr, "SDF element is nullptr");
+  SDF_ASSERT(_mapElem != nullptr, "Map element is nullptr");
+
+  RulePaths localPaths;
+  const RulePaths *paths = rulePaths(_mapElem, localPaths);
+  if (!paths)
+  {
+    return;
+  }
+  const std::map<std::string, std::string> &valueMap = paths->valueMap;
+  const std::vector<std::string> &fromTokens = paths->fromTokens;
+  const std::vector<std::string> &toTokens = paths->toTokens;
+
+  // get value of the 'from' element/attribute
+  TiXmlElement *fromElem = _elem;
+  for (unsigned int i = 0; i < fromTokens.size()-1; ++i)
+  {
+    fromElem = fromElem->FirstChildElement(fromTokens[i]);
+    if (!fromElem)
+    {
+      // Return when the tokens don't match. Don't output an error message
+      // because it spams the console.
+      return;
+    }
+  }
+
+  const char *fromLeaf = fromTokens.back().c_str();
+  if (fromLeaf[0] == '\0' ||
+      (fromLeaf[0] == '@' && fromLeaf[1] == '\0'))
+  {
+    sdferr << "Map: <from> has invalid name attribute\n";
+    return;
+  }
+  const char *fromValue = nullptr;
+  if (fromLeaf[0] == '@')
+  {
+    // from an attribute
+    fromValue = GetValue(nullptr, fromLeaf+1, fromElem);
+  }
+  else
+  {
+    // from an element
+    fromValue = GetValue(fromLeaf, nullptr, fromElem);
+  }
+
+  auto valueIter = fromValue ? valueMap.find(fromValue) : valueMap.end();
+  if (valueIter == valueMap.end())
+  {
+    // No match, no message to avoid spam.
+    return;
+  }
+  const char *toValue = valueIter->second.c_str();
+  // sdfdbg << "Map from [" << fromValue << "] to [" << toValue << "]\n";
+
+  // check if destination elements before leaf exist and create if necessary
+  unsigned int newDirIndex = 0;
+  TiXmlElement *toElem = _elem;
+  TiXmlElement *childElem = NULL;
+  for (unsigned int i = 0; i < toTokens.size()-1; ++i)
+  {
+    childElem = toElem->FirstChildElement(toTokens[i]);
+    if (!childElem)
+    {
+      newDirIndex = i;
+      break;
+    }
+    toElem = childElem;
+  }
+
+  // get the destination leaf name
+  const char *toLeaf = toTokens.back().c_str();
+  if (toLeaf[0] == '\0' ||
+      (toLeaf[0] == '@' && toLeaf[1] == '\0'))
+  {
+    sdferr << "Map: <to> has invalid name attribute\n";
+    return;
+  }
+  bool toAttribute = toLeaf[0] == '@';
+
+  // found elements in 'to' string that are not present, so create new
+  // elements if they aren't empty
+  if (!childElem)
+  {
+    int offset = toAttribute ? 1 : 0;
+    while (newDirIndex < (toTokens.size()-offset))
+    {
+      if (toTokens[newDirIndex].empty())
+      {
+        sdferr << "Map: <to> has invalid name attribute\n";
+        return;
+      }
+
+      TiXmlElement *newElem = new TiXmlElement(toTokens[newDirIndex]);
+      toElem->LinkEndChild(newElem);
+      toElem = newElem;
+      newDirIndex++;
+    }
+  }
+
+  if (toAttribute)
+  {
+    toElem->SetAttribute(toLeaf+1, toValue);
+  }
+  else
+  {
+    TiXmlText *text = new TiXmlText(toValue);
+    toElem->LinkEndChild(text);
+  }
+}
+
+/////////////////////////////////////////////////
+void Converter::Move(TiXmlElement *_elem, TiXmlElement *_moveElem,
+                     const bool _copy)
+{
+  SDF_ASSERT(_elem != NULL, "SDF element is NULL");
+  SDF_ASSERT(_moveElem != NULL, "Move element is NULL");
+
+  TiXmlElement *fromConvertElem = _moveElem->FirstChildElement("from");
+  TiXmlElement *toConvertElem = _moveElem->FirstChildElement("to");
+
+  const char *fromElemStr = fromConvertElem->Attribute("element");
+  const char *fromAttrStr = fromConvertElem->Attribute("attribute");
+
+  const char *toElemStr = toConvertElem->Attribute("element");
+  const char *toAttrStr = toConvertElem->Attribute("attribute");
+
+  RulePaths localPaths;
+  const RulePaths *paths = rulePaths(_moveElem, localPaths);
+  const std::vector<std::string> &fromTokens = paths->fromTokens;
+  const std::vector<std::string> &toTokens = paths->toTokens;
+
+  // get value of the 'from' element/attribute
+  TiXmlElement *fromElem = _elem;
+  for (unsigned int i = 0; i < fromTokens.size()-1; ++i)
+  {
+    fromElem = fromElem->FirstChildElement(fromTokens[i]);
+    if (!fromElem)
+    {
+      // Return when the tokens don't match. Don't output an error message
+      // because it spams the console.
+      return;
+    }
+  }
+
+  const char *fromName = fromTokens.back().c_str();
+  const char *value = NULL;
+
+  unsigned int newDirIndex = 0;
+  // get the new element/attribute name
+  const char *toName = toTokens.back().c_str();
+  TiXmlElement *toElem = _elem;
+  TiXmlElement *childElem = NULL;
+  for (unsigned int i = 0; i < toTokens.size()-1; ++i)
+  {
+    childElem = toElem->FirstChildElement(toTokens[i]);
+    if (!childElem)
+    {
+      newDirIndex = i;
+      break;
+    }
+    toElem = childElem;
+  }
+
+  // found elements in 'to' string that are not present, so create new
+  // elements
+  if (!childElem)
+  {
+    int offset = toElemStr != NULL && toAttrStr != NULL ? 0 : 1;
+    while (newDirIndex < (toTokens.size()-offset))
+    {
+      TiXmlElement *newElem = new TiXmlElement(toTokens[newDirIndex]);
+      toElem->LinkEndChild(newElem);
+      toElem = newElem;
+      newDirIndex++;
+    }
+  }
+
+  // Get value, or return if no element/attribute found as they don't have to
+  // be specified in the sdf.
+  if (fromElemStr)
+  {
+    TiXmlElement *moveFrom = fromElem->FirstChildElement(fromName);
+
+    // No matching element, so return.
+    if (!moveFrom)
+    {
+      return;
+    }
+
+    if (toElemStr && !toAttrStr)
+    {
+      TiXmlElement *moveTo = static_cast<TiXmlElement*>(moveFrom->Clone());
+      moveTo->SetValue(toName);
+      toElem->LinkEndChild(moveTo);
+    }
+    else
+    {
+      value = GetValue(fromName, NULL, fromElem);
+      if (!value)
+      {
+        return;
+      }
+      std::string valueStr = value;
+
+      toElem->SetAttribute(toAttrStr, valueStr);
+    }
+
+    if (!_copy)
+    {
+      fromElem->RemoveChild(moveFrom);
+    }
+  }
+  else if (fromAttrStr)
+  {
+    value = GetValue(NULL, fromName, fromElem);
+
+    if (!value)
+    {
+      return;
+    }
+
+    std::string valueStr = value;
+
+    if (toElemStr)
+    {
+      TiXmlElement *moveTo = new TiXmlElement(toName);
+      TiXmlText *text = new TiXmlText(valueStr);
+      moveTo->LinkEndChild(text);
+      toElem->LinkEndChild(moveTo);
+    }
+    else if (toAttrStr)
+    {
+      toElem->SetAttribute(toName, valueStr);
+    }
+
+    if (!_copy && fromAttrStr)
+    {
+      fromElem->RemoveAttribute(fromName);
+    }
+  }
+}
+
+/////////////////////////////////////////////////
+const char *Converter::GetValue(const char *_valueElem, const char *_valueAttr,
+                                TiXmlElement *_elem)
+{
+  if (_valueElem)
+  {
+    // Check to see if the element that is being converted has the value
+    if (!_elem->FirstChildElement(_valueElem))
+    {
+      return NULL;
+    }
+
+    if (_valueAttr)
+    {
+      return _elem->FirstChildElement(_valueElem)->Attribute(_valueAttr);
+    }
+    else
+    {
+      return _elem->FirstChildElement(_valueElem)->GetText();
+    }
+  }
+  else if (_valueAttr)
+  {
+    return _elem->Attribute(_valueAttr);
+  }
+
+  return NULL;
+}
+
+/////////////////////////////////////////////////
+void Converter::CheckDeprecation(TiXmlElement *_elem, TiXmlElement *_convert)
+{
+  // Process deprecated elements
+  for (TiXmlElement *deprecatedElem = _convert->FirstChildElement("deprecated");
+       deprecatedElem;
+       deprecatedElem = deprecatedElem->NextSiblingElement("deprecated"))
+  {
+    std::string value = deprecatedElem->GetText();
+    std::vector<std::string> valueSplit = split(value, "/");
+
+    bool found = false;
+    TiXmlElement *e = _elem;
+    std::ostringstream stream;
+
+    std::string prefix = "";
+    for (unsigned int i = 0; i < valueSplit.size() && !found; ++i)
+    {
+      if (e->FirstChildElement(valueSplit[i]))
+      {
+        if (stream.str().size() != 0)
+        {
+          stream << ">\n";
+          prefix += "  ";
+        }
+
+        stream << prefix << "<" << valueSplit[i];
+        e = e->FirstChildElement(valueSplit[i]);
+      }
+      else if (e->Attribute(valueSplit[i]))
+      {
+        stream << " " << valueSplit[i] << "='"
+               << e->Attribute(valueSplit[i].c_str()) << "'";
+        found = true;
+      }
+    }
 
-  ConvertImpl(_doc->FirstChildElement(), _convertDoc->FirstChildElement());
+    const std::string message =
+        "Deprecated SDF Values in original file:\n" + stream.str() + "\n\n";
+    if (warningAllowed("deprecated value", message))
+      sdfwarn << message;
+  }
 }
 
 /////////////////////////////////////////////////
-void Converter::ConvertDescendantsImpl(TiXmlElement *_e, TiXmlElement *_c)
+void Converter::ConvertDescendantsImpl(const ElementPtr &_e,
+    const std::vector<TiXmlElement *> &_converts,
+    const std::set<std::string> &_skip,
+    const DescendantNames *_names)
 {
-  if (!_c->Attribute("descendant_name"))
-  {
-    return;
-  }
-
-  if (_e->ValueStr() == "plugin")
+  if (_e->GetName() == "plugin")
   {
     return;
   }
 
-  if (_e->ValueStr().find(":") != std::string::npos)
+  if (_e->GetName().find(":") != std::string::npos)
   {
     return;
   }
 
-  std::string name = _c->Attribute("descendant_name");
-  TiXmlElement *e = _e->FirstChildElement();
-  while (e)
+  // A conversion only changes the subtree of the element it matches, so
+  // the children can be collected before converting them.
+  const Element::ChildRange range = _e->Children();
+  const std::vector<ElementPtr> children(range.begin(), range.end());
+  for (const ElementPtr &e : children)
   {
-    if (name == e->ValueStr())
+    for (TiXmlElement *c : _converts)
     {
-      ConvertImpl(e, _c);
+      if (e->GetName() == c->Attribute("descendant_name"))
+      {
+        ConvertImpl(e, c, _names);
+      }
     }
-    ConvertDescendantsImpl(e, _c);
-    e = e->NextSiblingElement();
+    if (_skip.count(e->GetName()) == 0)
+      ConvertDescendantsImpl(e, _converts, _skip, _names);
   }
 }
 
 /////////////////////////////////////////////////
-void Converter::ConvertImpl(TiXmlElement *_elem, TiXmlElement *_convert)
+void Converter::ConvertImpl(const ElementPtr &_elem, TiXmlElement *_convert,
+                            const DescendantNames *_names)
 {
-  SDF_ASSERT(_elem != NULL, "SDF element is NULL");
-  SDF_ASSERT(_convert != NULL, "Convert element is NULL");
+  SDF_ASSERT(_elem != nullptr, "SDF element is nullptr");
+  SDF_ASSERT(_convert != nullptr, "Convert element is nullptr");
 
   CheckDeprecation(_elem, _convert);
 
@@ -182,17 +1370,21 @@ void Converter::ConvertImpl(TiXmlElement *_elem, TiXmlElement *_convert)
   {
     if (convertElem->Attribute("name"))
     {
-      TiXmlElement *elem = _elem->FirstChildElement(
-          convertElem->Attribute("name"));
-      while (elem)
+      const Element::ChildRange range =
+          _elem->Children(convertElem->Attribute("name"));
+      const std::vector<ElementPtr> children(range.begin(), range.end());
+      for (const ElementPtr &elem : children)
       {
-        ConvertImpl(elem, convertElem);
-        elem = elem->NextSiblingElement(convertElem->Attribute("name"));
+        ConvertImpl(elem, convertElem, _names);
       }
     }
     if (convertElem->Attribute("descendant_name"))
     {
-      ConvertDescendantsImpl(_elem, convertElem);
+      const std::vector<TiXmlElement *> group =
+          descendantGroup(convertElem);
+      const std::set<std::string> skip = skippedNames(group, _names);
+      ConvertDescendantsImpl(_elem, group, skip, _names);
+      convertElem = group.back();
     }
   }
 
@@ -231,10 +1423,10 @@ void Converter::ConvertImpl(TiXmlElement *_elem, TiXmlElement *_convert)
 }
 
 /////////////////////////////////////////////////
-void Converter::Rename(TiXmlElement *_elem, TiXmlElement *_renameElem)
+void Converter::Rename(const ElementPtr &_elem, TiXmlElement *_renameElem)
 {
-  SDF_ASSERT(_elem != NULL, "SDF element is NULL");
-  SDF_ASSERT(_renameElem != NULL, "Rename element is NULL");
+  SDF_ASSERT(_elem != nullptr, "SDF element is nullptr");
+  SDF_ASSERT(_renameElem != nullptr, "Rename element is nullptr");
 
   TiXmlElement *fromConvertElem = _renameElem->FirstChildElement("from");
   TiXmlElement *toConvertElem = _renameElem->FirstChildElement("to");
@@ -245,8 +1437,8 @@ void Converter::Rename(TiXmlElement *_elem, TiXmlElement *_renameElem)
   const char *toElemName = toConvertElem->Attribute("element");
   const char *toAttrName = toConvertElem->Attribute("attribute");
 
-  const char *value = GetValue(fromElemName, fromAttrName, _elem);
-  if (!value)
+  std::string value;
+  if (!GetValue(fromElemName, fromAttrName, _elem, value))
   {
     return;
   }
@@ -257,47 +1449,33 @@ void Converter::Rename(TiXmlElement *_elem, TiXmlElement *_renameElem)
     return;
   }
 
-  TiXmlElement *replaceTo = new TiXmlElement(toElemName);
-  if (toAttrName)
+  // Unlike with XML, the new element is appended instead of taking the
+  // place of the renamed one, which doesn't matter to the parser.
+  if (fromElemName)
   {
-    replaceTo->SetAttribute(toAttrName, value);
+    _elem->RemoveChild(_elem->GetElementImpl(fromElemName));
   }
-  else
+  else if (fromAttrName)
   {
-    TiXmlText *text = new TiXmlText(value);
-    // The tinyxml function LinkEndChild takes the pointer and takes ownership
-    // of the memory, so it is responsible for freeing it later.
-    replaceTo->LinkEndChild(text);
+    _elem->RemoveAttribute(fromAttrName);
   }
 
-  if (fromElemName)
+  ElementPtr replaceTo = addChild(_elem, toElemName);
+  if (toAttrName)
   {
-    TiXmlElement *replaceFrom = _elem->FirstChildElement(fromElemName);
-    if (_elem->ReplaceChild(replaceFrom, *replaceTo) == nullptr)
-    {
-      sdferr << "Failed to rename element\n";
-      // fall through so we can reclaim memory
-    }
-
-    // In this case, the tinyxml function ReplaceChild does a deep copy of the
-    // node that is passed in, so we want to free it here.
-    delete replaceTo;
+    writeAttribute(replaceTo, toAttrName, value);
   }
-  else if (fromAttrName)
+  else
   {
-    _elem->RemoveAttribute(fromAttrName);
-    // In this case, the tinyxml function LinkEndChild just takes the pointer
-    // and takes ownership of the memory, so it is responsible for freeing it
-    // later.
-    _elem->LinkEndChild(replaceTo);
+    writeText(replaceTo, value);
   }
 }
 
 /////////////////////////////////////////////////
-void Converter::Add(TiXmlElement *_elem, TiXmlElement *_addElem)
+void Converter::Add(const ElementPtr &_elem, TiXmlElement *_addElem)
 {
-  SDF_ASSERT(_elem != NULL, "SDF element is NULL");
-  SDF_ASSERT(_addElem != NULL, "Add element is NULL");
+  SDF_ASSERT(_elem != nullptr, "SDF element is nullptr");
+  SDF_ASSERT(_addElem != nullptr, "Add element is nullptr");
 
   const char *attributeName = _addElem->Attribute("attribute");
   const char *elementName = _addElem->Attribute("element");
@@ -314,7 +1492,7 @@ void Converter::Add(TiXmlElement *_elem, TiXmlElement *_addElem)
   {
     if (value)
     {
-      _elem->SetAttribute(attributeName, value);
+      writeAttribute(_elem, attributeName, value);
     }
     else
     {
@@ -324,21 +1502,19 @@ void Converter::Add(TiXmlElement *_elem, TiXmlElement *_addElem)
   }
   else
   {
-    TiXmlElement *addElem = new TiXmlElement(elementName);
+    ElementPtr addElem = addChild(_elem, elementName);
     if (value)
     {
-      TiXmlText *addText = new TiXmlText(value);
-      addElem->LinkEndChild(addText);
+      writeText(addElem, value);
     }
-    _elem->LinkEndChild(addElem);
   }
 }
 
 /////////////////////////////////////////////////
-void Converter::Remove(TiXmlElement *_elem, TiXmlElement *_removeElem)
+void Converter::Remove(const ElementPtr &_elem, TiXmlElement *_removeElem)
 {
-  SDF_ASSERT(_elem != NULL, "SDF element is NULL");
-  SDF_ASSERT(_removeElem != NULL, "Move element is NULL");
+  SDF_ASSERT(_elem != nullptr, "SDF element is nullptr");
+  SDF_ASSERT(_removeElem != nullptr, "Move element is nullptr");
 
   const char *attributeName = _removeElem->Attribute("attribute");
   const char *elementName = _removeElem->Attribute("element");
@@ -356,151 +1532,67 @@ void Converter::Remove(TiXmlElement *_elem, TiXmlElement *_removeElem)
   }
   else
   {
-    TiXmlElement *childElem = _elem->FirstChildElement(elementName);
+    ElementPtr childElem = _elem->GetElementImpl(elementName);
     while (childElem)
     {
       _elem->RemoveChild(childElem);
-      childElem = _elem->FirstChildElement(elementName);
+      childElem = _elem->GetElementImpl(elementName);
     }
   }
 }
 
 /////////////////////////////////////////////////
-void Converter::Map(TiXmlElement *_elem, TiXmlElement *_mapElem)
+void Converter::Map(const ElementPtr &_elem, TiXmlElement *_mapElem)
 {
   SDF_ASSERT(_elem != nullptr, "SDF element is nullptr");
   SDF_ASSERT(_mapElem != nullptr, "Map element is nullptr");
 
-  TiXmlElement *fromConvertElem = _mapElem->FirstChildElement("from");
-  TiXmlElement *toConvertElem = _mapElem->FirstChildElement("to");
-
-  if (!fromConvertElem)
-  {
-    sdferr << "<map> element requires a <from> child element.\n";
-    return;
-  }
-  if (!toConvertElem)
-  {
-    sdferr << "<map> element requires a <to> child element.\n";
-    return;
-  }
-
-  const char *fromNameStr = fromConvertElem->Attribute("name");
-  const char *toNameStr = toConvertElem->Attribute("name");
-
-  if (!fromNameStr || fromNameStr[0] == '\0')
-  {
-    sdferr << "Map: <from> element requires a non-empty name attribute.\n";
-    return;
-  }
-  if (!toNameStr || toNameStr[0] == '\0')
-  {
-    sdferr << "Map: <to> element requires a non-empty name attribute.\n";
-    return;
-  }
-
-  // create map of input and output values
-  std::map<std::string, std::string> valueMap;
-  TiXmlElement *fromValueElem = fromConvertElem->FirstChildElement("value");
-  TiXmlElement *toValueElem = toConvertElem->FirstChildElement("value");
-  if (!fromValueElem)
-  {
-    sdferr << "Map: <from> element requires at least one <value> element.\n";
-    return;
-  }
-  if (!toValueElem)
-  {
-    sdferr << "Map: <to> element requires at least one <value> element.\n";
-    return;
-  }
-  if (!fromValueElem->GetText())
-  {
-    sdferr << "Map: from value must not be empty.\n";
-    return;
-  }
-  if (!toValueElem->GetText())
+  RulePaths localPaths;
+  const RulePaths *paths = rulePaths(_mapElem, localPaths);
+  if (!paths)
   {
-    sdferr << "Map: to value must not be empty.\n";
     return;
   }
-  valueMap[fromValueElem->GetText()] = toValueElem->GetText();
-  while (fromValueElem->NextSiblingElement("value"))
-  {
-    fromValueElem = fromValueElem->NextSiblingElement("value");
-    if (toValueElem->NextSiblingElement("value"))
-    {
-      toValueElem = toValueElem->NextSiblingElement("value");
-    }
-    if (!fromValueElem->GetText())
-    {
-      sdferr << "Map: from value must not be empty.\n";
-      return;
-    }
-    if (!toValueElem->GetText())
-    {
-      sdferr << "Map: to value must not be empty.\n";
-      return;
-    }
-    valueMap[fromValueElem->GetText()] = toValueElem->GetText();
-  }
-
-  // tokenize 'from' and 'to' name attributes
-  std::string fromStr = fromNameStr;
-  std::string toStr = toNameStr;
-
-  std::vector<std::string> fromTokens = split(fromStr, "/");
-  std::vector<std::string> toTokens = split(toStr, "/");
-
-  // split() always returns at least one element, even with the
-  // empty string.  Thus we don't check if the fromTokens or toTokens are empty.
+  const std::map<std::string, std::string> &valueMap = paths->valueMap;
+  const std::vector<std::string> &fromTokens = paths->fromTokens;
+  const std::vector<std::string> &toTokens = paths->toTokens;
 
   // get value of the 'from' element/attribute
-  TiXmlElement *fromElem = _elem;
+  ElementPtr fromElem = _elem;
   for (unsigned int i = 0; i < fromTokens.size()-1; ++i)
   {
-    fromElem = fromElem->FirstChildElement(fromTokens[i]);
+    fromElem = fromElem->GetElementImpl(fromTokens[i]);
     if (!fromElem)
     {
-      // Return when the tokens don't match. Don't output an error message
-      // because it spams the console.
       return;
     }
   }
 
-  const char *fromLeaf = fromTokens.back().c_str();
-  if (fromLeaf[0] == '\0' ||
-      (fromLeaf[0] == '@' && fromLeaf[1] == '\0'))
+  const std::string &fromLeaf = fromTokens.back();
+  if (fromLeaf.empty() || fromLeaf == "@")
   {
     sdferr << "Map: <from> has invalid name attribute\n";
     return;
   }
-  const char *fromValue = nullptr;
-  if (fromLeaf[0] == '@')
-  {
-    // from an attribute
-    fromValue = GetValue(nullptr, fromLeaf+1, fromElem);
-  }
-  else
-  {
-    // from an element
-    fromValue = GetValue(fromLeaf, nullptr, fromElem);
-  }
+  std::string fromValue;
+  const bool found = fromLeaf[0] == '@' ?
+      GetValue(nullptr, fromLeaf.c_str() + 1, fromElem, fromValue) :
+      GetValue(fromLeaf.c_str(), nullptr, fromElem, fromValue);
 
-  if (!fromValue || valueMap.end() == valueMap.find(std::string(fromValue)))
+  auto valueIter = valueMap.find(fromValue);
+  if (!found || valueIter == valueMap.end())
   {
-    // No match, no message to avoid spam.
     return;
   }
-  const char *toValue = valueMap[std::string(fromValue)].c_str();
-  // sdfdbg << "Map from [" << fromValue << "] to [" << toValue << "]\n";
+  const std::string &toValue = valueIter->second;
 
   // check if destination elements before leaf exist and create if necessary
   unsigned int newDirIndex = 0;
-  TiXmlElement *toElem = _elem;
-  TiXmlElement *childElem = NULL;
+  ElementPtr toElem = _elem;
+  ElementPtr childElem;
   for (unsigned int i = 0; i < toTokens.size()-1; ++i)
   {
-    childElem = toElem->FirstChildElement(toTokens[i]);
+    childElem = toElem->GetElementImpl(toTokens[i]);
     if (!childElem)
     {
       newDirIndex = i;
@@ -509,18 +1601,14 @@ void Converter::Map(TiXmlElement *_elem, TiXmlElement *_mapElem)
     toElem = childElem;
   }
 
-  // get the destination leaf name
-  const char *toLeaf = toTokens.back().c_str();
-  if (toLeaf[0] == '\0' ||
-      (toLeaf[0] == '@' && toLeaf[1] == '\0'))
+  const std::string &toLeaf = toTokens.back();
+  if (toLeaf.empty() || toLeaf == "@")
   {
     sdferr << "Map: <to> has invalid name attribute\n";
     return;
   }
   bool toAttribute = toLeaf[0] == '@';
 
-  // found elements in 'to' string that are not present, so create new
-  // elements if they aren't empty
   if (!childElem)
   {
     int offset = toAttribute ? 1 : 0;
@@ -532,30 +1620,27 @@ void Converter::Map(TiXmlElement *_elem, TiXmlElement *_mapElem)
         return;
       }
 
-      TiXmlElement *newElem = new TiXmlElement(toTokens[newDirIndex]);
-      toElem->LinkEndChild(newElem);
-      toElem = newElem;
+      toElem = addChild(toElem, toTokens[newDirIndex]);
       newDirIndex++;
     }
   }
 
   if (toAttribute)
   {
-    toElem->SetAttribute(toLeaf+1, toValue);
+    writeAttribute(toElem, toLeaf.substr(1), toValue);
   }
   else
   {
-    TiXmlText *text = new TiXmlText(toValue);
-    toElem->LinkEndChild(text);
+    writeText(toElem, toValue);
   }
 }
 
 /////////////////////////////////////////////////
-void Converter::Move(TiXmlElement *_elem, TiXmlElement *_moveElem,
+void Converter::Move(const ElementPtr &_elem, TiXmlElement *_moveElem,
                      const bool _copy)
 {
-  SDF_ASSERT(_elem != NULL, "SDF element is NULL");
-  SDF_ASSERT(_moveElem != NULL, "Move element is NULL");
+  SDF_ASSERT(_elem != nullptr, "SDF element is nullptr");
+  SDF_ASSERT(_moveElem != nullptr, "Move element is nullptr");
 
   TiXmlElement *fromConvertElem = _moveElem->FirstChildElement("from");
   TiXmlElement *toConvertElem = _moveElem->FirstChildElement("to");
@@ -566,56 +1651,32 @@ void Converter::Move(TiXmlElement *_elem, TiXmlElement *_moveElem,
   const char *toElemStr = toConvertElem->Attribute("element");
   const char *toAttrStr = toConvertElem->Attribute("attribute");
 
-  // tokenize 'from' and 'to' strs
-  std::string fromStr = "";
-  if (fromElemStr)
-  {
-    fromStr = fromElemStr;
-  }
-  else if (fromAttrStr)
-  {
-    fromStr = fromAttrStr;
-  }
-  std::string toStr = "";
-  if (toElemStr)
-  {
-    toStr = toElemStr;
-  }
-  else if (toAttrStr)
-  {
-    toStr = toAttrStr;
-  }
-
-  std::vector<std::string> fromTokens = split(fromStr, "::");
-  std::vector<std::string> toTokens = split(toStr, "::");
-
-  // split() always returns at least one element, even with the
-  // empty string.  Thus we don't check if the fromTokens or toTokens are empty.
+  RulePaths localPaths;
+  const RulePaths *paths = rulePaths(_moveElem, localPaths);
+  const std::vector<std::string> &fromTokens = paths->fromTokens;
+  const std::vector<std::string> &toTokens = paths->toTokens;
 
   // get value of the 'from' element/attribute
-  TiXmlElement *fromElem = _elem;
+  ElementPtr fromElem = _elem;
   for (unsigned int i = 0; i < fromTokens.size()-1; ++i)
   {
-    fromElem = fromElem->FirstChildElement(fromTokens[i]);
+    fromElem = fromElem->GetElementImpl(fromTokens[i]);
     if (!fromElem)
     {
-      // Return when the tokens don't match. Don't output an error message
-      // because it spams the console.
       return;
     }
   }
 
-  const char *fromName = fromTokens.back().c_str();
-  const char *value = NULL;
+  const std::string &fromName = fromTokens.back();
 
   unsigned int newDirIndex = 0;
   // get the new element/attribute name
-  const char *toName = toTokens.back().c_str();
-  TiXmlElement *toElem = _elem;
-  TiXmlElement *childElem = NULL;
+  const std::string &toName = toTokens.back();
+  ElementPtr toElem = _elem;
+  ElementPtr childElem;
   for (unsigned int i = 0; i < toTokens.size()-1; ++i)
   {
-    childElem = toElem->FirstChildElement(toTokens[i]);
+    childElem = toElem->GetElementImpl(toTokens[i]);
     if (!childElem)
     {
       newDirIndex = i;
@@ -628,21 +1689,20 @@ void Converter::Move(TiXmlElement *_elem, TiXmlElement *_moveElem,
   // elements
   if (!childElem)
   {
-    int offset = toElemStr != NULL && toAttrStr != NULL ? 0 : 1;
+    int offset = toElemStr != nullptr && toAttrStr != nullptr ? 0 : 1;
     while (newDirIndex < (toTokens.size()-offset))
     {
-      TiXmlElement *newElem = new TiXmlElement(toTokens[newDirIndex]);
-      toElem->LinkEndChild(newElem);
-      toElem = newElem;
+      toElem = addChild(toElem, toTokens[newDirIndex]);
       newDirIndex++;
     }
   }
 
   // Get value, or return if no element/attribute found as they don't have to
   // be specified in the sdf.
+  std::string value;
   if (fromElemStr)
   {
-    TiXmlElement *moveFrom = fromElem->FirstChildElement(fromName);
+    ElementPtr moveFrom = fromElem->GetElementImpl(fromName);
 
     // No matching element, so return.
     if (!moveFrom)
@@ -652,20 +1712,18 @@ void Converter::Move(TiXmlElement *_elem, TiXmlElement *_moveElem,
 
     if (toElemStr && !toAttrStr)
     {
-      TiXmlElement *moveTo = static_cast<TiXmlElement*>(moveFrom->Clone());
-      moveTo->SetValue(toName);
-      toElem->LinkEndChild(moveTo);
+      ElementPtr moveTo = moveFrom->Clone();
+      moveTo->SetName(toName);
+      moveTo->SetParent(toElem);
+      toElem->InsertElement(moveTo);
     }
     else
     {
-      value = GetValue(fromName, NULL, fromElem);
-      if (!value)
+      if (!GetValue(fromName.c_str(), nullptr, fromElem, value))
       {
         return;
       }
-      std::string valueStr = value;
-
-      toElem->SetAttribute(toAttrStr, valueStr);
+      writeAttribute(toElem, toAttrStr, value);
     }
 
     if (!_copy)
@@ -675,28 +1733,21 @@ void Converter::Move(TiXmlElement *_elem, TiXmlElement *_moveElem,
   }
   else if (fromAttrStr)
   {
-    value = GetValue(NULL, fromName, fromElem);
-
-    if (!value)
+    if (!GetValue(nullptr, fromName.c_str(), fromElem, value))
     {
       return;
     }
 
-    std::string valueStr = value;
-
     if (toElemStr)
     {
-      TiXmlElement *moveTo = new TiXmlElement(toName);
-      TiXmlText *text = new TiXmlText(valueStr);
-      moveTo->LinkEndChild(text);
-      toElem->LinkEndChild(moveTo);
+      writeText(addChild(toElem, toName), value);
     }
     else if (toAttrStr)
     {
-      toElem->SetAttribute(toName, valueStr);
+      writeAttribute(toElem, toName, value);
     }
 
-    if (!_copy && fromAttrStr)
+    if (!_copy)
     {
       fromElem->RemoveAttribute(fromName);
     }
@@ -704,36 +1755,26 @@ void Converter::Move(TiXmlElement *_elem, TiXmlElement *_moveElem,
 }
 
 /////////////////////////////////////////////////
-const char *Converter::GetValue(const char *_valueElem, const char *_valueAttr,
-                                TiXmlElement *_elem)
+bool Converter::GetValue(const char *_valueElem, const char *_valueAttr,
+                         const ElementPtr &_elem, std::string &_value)
 {
   if (_valueElem)
   {
     // Check to see if the element that is being converted has the value
-    if (!_elem->FirstChildElement(_valueElem))
-    {
-      return NULL;
-    }
-
-    if (_valueAttr)
-    {
-      return _elem->FirstChildElement(_valueElem)->Attribute(_valueAttr);
-    }
-    else
-    {
-      return _elem->FirstChildElement(_valueElem)->GetText();
-    }
+    ElementPtr valueElem = _elem->GetElementImpl(_valueElem);
+    return valueElem && readValue(valueElem, _valueAttr, _value);
   }
   else if (_valueAttr)
   {
-    return _elem->Attribute(_valueAttr);
+    return readValue(_elem, _valueAttr, _value);
   }
 
-  return NULL;
+  return false;
 }
 
 /////////////////////////////////////////////////
-void Converter::CheckDeprecation(TiXmlElement *_elem, TiXmlElement *_convert)
+void Converter::CheckDeprecation(const ElementPtr &_elem,
+                                 TiXmlElement *_convert)
 {
   // Process deprecated elements
   for (TiXmlElement *deprecatedElem = _convert->FirstChildElement("deprecated");
@@ -744,13 +1785,14 @@ void Converter::CheckDeprecation(TiXmlElement *_elem, TiXmlElement *_convert)
     std::vector<std::string> valueSplit = split(value, "/");
 
     bool found = false;
-    TiXmlElement *e = _elem;
+    ElementPtr e = _elem;
     std::ostringstream stream;
 
     std::string prefix = "";
     for (unsigned int i = 0; i < valueSplit.size() && !found; ++i)
     {
-      if (e->FirstChildElement(valueSplit[i]))
+      std::string attribute;
+      if (e->GetElementImpl(valueSplit[i]))
       {
         if (stream.str().size() != 0)
         {
@@ -759,17 +1801,18 @@ void Converter::CheckDeprecation(TiXmlElement *_elem, TiXmlElement *_convert)
         }
 
         stream << prefix << "<" << valueSplit[i];
-        e = e->FirstChildElement(valueSplit[i]);
+        e = e->GetElementImpl(valueSplit[i]);
       }
-      else if (e->Attribute(valueSplit[i]))
+      else if (readValue(e, valueSplit[i].c_str(), attribute))
       {
-        stream << " " << valueSplit[i] << "='"
-               << e->Attribute(valueSplit[i].c_str()) << "'";
+        stream << " " << valueSplit[i] << "='" << attribute << "'";
         found = true;
       }
     }
 
-    sdfwarn << "Deprecated SDF Values in original file:\n"
-            << stream.str() << "\n\n";
+    const std::string message =
+        "Deprecated SDF Values in original file:\n" + stream.str() + "\n\n";
+    if (warningAllowed("deprecated value", message))
+      sdfwarn << message;
   }
 }
@@ -19,9 +19,13 @@
 
 #include <tinyxml.h>
 
+#include <map>
+#include <set>
 #include <string>
+#include <vector>
 
 #include <sdf/sdf_config.h>
+#include "sdf/Element.hh"
 #include "sdf/system_util.hh"
 
 namespace sdf
@@ -30,6 +34,12 @@ namespace sdf
   inline namespace SDF_VERSION_NAMESPACE {
   //
 
+  /// \brief Names of the elements that the specification of a version
+  /// allows below an element at any depth, by name of the element. Elements
+  /// that may have children which are not described, and the elements that
+  /// may contain them, are not listed.
+  using DescendantNames = std::map<std::string, std::set<std::string>>;
+
   /// \brief Convert from one version of SDF to another
   class Converter
   {
@@ -41,6 +51,26 @@ namespace sdf
                                 const std::string &_toVersion,
                                 bool _quiet = false);
 
+    /// \brief Convert the element tree of an SDF document to the specified
+    /// version in place, with the same recipes as the conversion of XML
+    /// documents, so that a tree that is already parsed isn't written to and
+    /// parsed from XML again. Elements and attributes that a recipe creates
+    /// and that the tree doesn't describe are added as strings.
+    /// \param[in] _elem The <sdf> element, whose version attribute is the
+    /// version of the tree.
+    /// \param[in] _toVersion Version number in string format.
+    /// \param[in] _quiet False to be more verbose.
+    /// \return True if the tree was converted to _toVersion.
+    public: static bool Convert(ElementPtr _elem,
+                                const std::string &_toVersion,
+                                bool _quiet = false);
+
+    /// \brief Parse every conversion recipe and build the chains of recipes
+    /// that convert each older version to a version, so that later calls to
+    /// Convert only read them.
+    /// \param[in] _toVersion Version number in string format.
+    public: static void CompileRecipes(const std::string &_toVersion);
+
     /// \cond
     /// This is an internal function.
     /// \brief Generic convert function that converts the SDF based on the
@@ -54,15 +84,49 @@ namespace sdf
     /// \brief Implementation of Convert functionality.
     /// \param[in] _elem SDF xml element tree to convert.
     /// \param[in] _convert Convert xml element tree.
+    /// \param[in] _names Descendant names of the elements of the version
+    /// of _elem, used to skip the subtrees that can't contain an element
+    /// named by a descendant_name attribute, or nullptr to walk every
+    /// subtree.
     private: static void ConvertImpl(TiXmlElement *_elem,
-                                     TiXmlElement *_convert);
+                                     TiXmlElement *_convert,
+                                     const DescendantNames *_names);
 
     /// \brief Recursive helper function for ConvertImpl that converts
-    /// elements named by the descendant_name attribute.
+    /// elements named by the descendant_name attribute. Several
+    /// conversions are applied in a single walk of the tree, and at each
+    /// element the matching conversions are applied in order.
     /// \param[in] _e SDF xml element tree to convert.
-    /// \param[in] _c Convert xml element tree.
+    /// \param[in] _converts Convert xml element trees, which all have a
+    /// descendant_name attribute and must not affect each other.
+    /// \param[in] _skip Names of the elements whose descendants are not
+    /// walked, because none of them can be converted.
+    /// \param[in] _names Descendant names passed to ConvertImpl.
     private: static void ConvertDescendantsImpl(TiXmlElement *_e,
-                                                TiXmlElement *_c);
+                 const std::vector<TiXmlElement *> &_converts,
+                 const std::set<std::string> &_skip,
+                 const DescendantNames *_names);
+
+    /// \brief Implementation of Convert functionality for element trees.
+    /// \param[in] _elem SDF element tree to convert.
+    /// \param[in] _convert Convert xml element tree.
+    /// \param[in] _names Descendant names of the elements of the version
+    /// of _elem, or nullptr.
+    private: static void ConvertImpl(const ElementPtr &_elem,
+                                     TiXmlElement *_convert,
+                                     const DescendantNames *_names);
+
+    /// \brief Recursive helper function for ConvertImpl that converts
+    /// elements of an element tree named by the descendant_name attribute.
+    /// \param[in] _e SDF element tree to convert.
+    /// \param[in] _converts Convert xml element trees.
+    /// \param[in] _skip Names of the elements whose descendants are not
+    /// walked.
+    /// \param[in] _names Descendant names passed to ConvertImpl.
+    private: static void ConvertDescendantsImpl(const ElementPtr &_e,
+                 const std::vector<TiXmlElement *> &_converts,
+                 const std::set<std::string> &_skip,
+                 const DescendantNames *_names);
 
     /// \brief Rename an element or attribute.
     /// \param[in] _elem The element to be renamed, or the element which
@@ -108,6 +172,65 @@ namespace sdf
 
     private: static void CheckDeprecation(TiXmlElement *_elem,
                                           TiXmlElement *_convert);
+
+    /// \brief Rename an element or attribute of an element tree.
+    /// \param[in] _elem The element to be renamed, or the element which
+    /// has the attribute to be renamed.
+    /// \param[in] _renameElem A 'convert' element that describes the rename
+    /// operation.
+    private: static void Rename(const ElementPtr &_elem,
+                                TiXmlElement *_renameElem);
+
+    /// \brief Map values from one element or attribute of an element tree
+    /// to another.
+    /// \param[in] _elem Ancestor element of the element or attribute to
+    /// be mapped.
+    /// \param[in] _mapElem A 'convert' element that describes the map
+    /// operation.
+    private: static void Map(const ElementPtr &_elem,
+                             TiXmlElement *_mapElem);
+
+    /// \brief Move an element or attribute of an element tree within a
+    /// common ancestor element.
+    /// \param[in] _elem Ancestor element of the element or attribute to
+    /// be moved.
+    /// \param[in] _moveElem A 'convert' element that describes the move
+    /// operation.
+    /// \param[in] _copy True to copy the element
+    private: static void Move(const ElementPtr &_elem,
+                              TiXmlElement *_moveElem,
+                              const bool _copy);
+
+    /// \brief Add an element or attribute to an element of an element
+    /// tree.
+    /// \param[in] _elem The element to receive the value.
+    /// \param[in] _addElem A 'convert' element that describes the add
+    /// operation.
+    private: static void Add(const ElementPtr &_elem,
+                             TiXmlElement *_addElem);
+
+    /// \brief Remove an element or attribute of an element tree.
+    /// \param[in] _elem The element that has the _removeElem child.
+    /// \param[in] _removeElem The element to remove.
+    private: static void Remove(const ElementPtr &_elem,
+                                TiXmlElement *_removeElem);
+
+    /// \brief Get the value of an element or attribute of an element tree
+    /// that was read from the document or set by a conversion.
+    /// \param[in] _valueElem Name of the child that has the value, or
+    /// nullptr for _elem itself.
+    /// \param[in] _valueAttr Name of the attribute that has the value, or
+    /// nullptr for the value of the element.
+    /// \param[in] _elem The element.
+    /// \param[out] _value The value.
+    /// \return True if the value is set.
+    private: static bool GetValue(const char *_valueElem,
+                                  const char *_valueAttr,
+                                  const ElementPtr &_elem,
+                                  std::string &_value);
+
+    private: static void CheckDeprecation(const ElementPtr &_elem,
+                                          TiXmlElement *_convert);
   };
   }
 }
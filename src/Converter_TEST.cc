@@ -18,6 +18,9 @@
 #include <gtest/gtest.h>
 #include <array>
 #include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
 #include "sdf/Exception.hh"
 #include "sdf/Filesystem.hh"
 
@@ -567,6 +570,70 @@ TEST(Converter, RemoveElement)
   ASSERT_TRUE(convertedElem == nullptr);
 }
 
+////////////////////////////////////////////////////
+/// Consecutive descendant conversions are applied in a single walk only
+/// when they can't affect each other, so the result is the same as applying
+/// them one after the other.
+TEST(Converter, MultipleDescendantConversions)
+{
+  const std::string xmlString = getXmlString();
+
+  // The second conversion reads the attribute added by the first one to an
+  // element nested in the element it matches.
+  TiXmlDocument xmlDoc;
+  xmlDoc.Parse(xmlString.c_str());
+  std::stringstream convertStream;
+  convertStream << "<convert name='elemA'>"
+                << "  <convert descendant_name='elemC'>"
+                << "    <add attribute='attrX' value='X'/>"
+                << "  </convert>"
+                << "  <convert descendant_name='elemB'>"
+                << "    <copy>"
+                << "      <from attribute='elemC::attrX'/>"
+                << "      <to attribute='attrY'/>"
+                << "    </copy>"
+                << "  </convert>"
+                << "</convert>";
+  TiXmlDocument convertXmlDoc;
+  convertXmlDoc.Parse(convertStream.str().c_str());
+  sdf::Converter::Convert(&xmlDoc, &convertXmlDoc);
+
+  TiXmlElement *elemB = xmlDoc.FirstChildElement("elemA")->FirstChildElement(
+      "elemB");
+  ASSERT_NE(nullptr, elemB);
+  EXPECT_STREQ("X", elemB->Attribute("attrY"));
+  ASSERT_NE(nullptr, elemB->FirstChildElement("elemC"));
+  EXPECT_STREQ("X", elemB->FirstChildElement("elemC")->Attribute("attrX"));
+
+  // Independent conversions.
+  TiXmlDocument xmlDoc2;
+  xmlDoc2.Parse(xmlString.c_str());
+  std::stringstream convertStream2;
+  convertStream2 << "<convert name='elemA'>"
+                 << "  <convert descendant_name='elemC'>"
+                 << "    <add attribute='attrX' value='X'/>"
+                 << "  </convert>"
+                 << "  <convert descendant_name='elemB'>"
+                 << "    <add attribute='attrZ' value='Z'/>"
+                 << "  </convert>"
+                 << "  <convert descendant_name='elemD'>"
+                 << "    <add attribute='attrW' value='W'/>"
+                 << "  </convert>"
+                 << "</convert>";
+  TiXmlDocument convertXmlDoc2;
+  convertXmlDoc2.Parse(convertStream2.str().c_str());
+  sdf::Converter::Convert(&xmlDoc2, &convertXmlDoc2);
+
+  elemB = xmlDoc2.FirstChildElement("elemA")->FirstChildElement("elemB");
+  ASSERT_NE(nullptr, elemB);
+  EXPECT_STREQ("Z", elemB->Attribute("attrZ"));
+  TiXmlElement *elemC = elemB->FirstChildElement("elemC");
+  ASSERT_NE(nullptr, elemC);
+  EXPECT_STREQ("X", elemC->Attribute("attrX"));
+  ASSERT_NE(nullptr, elemC->FirstChildElement("elemD"));
+  EXPECT_STREQ("W", elemC->FirstChildElement("elemD")->Attribute("attrW"));
+}
+
 ////////////////////////////////////////////////////
 /// Ensure that Converter::Remove function is working with descendant_name
 /// Test removing element
@@ -1885,6 +1952,58 @@ TEST(Converter, MuchNewerVersion)
   ASSERT_TRUE(sdf::Converter::Convert(&xmlDoc, "1.6"));
 }
 
+////////////////////////////////////////////////////
+/// The recipes are parsed once and shared, so repeated and concurrent
+/// conversions must give the same result as the first one.
+TEST(Converter, RepeatedAndConcurrent)
+{
+  const std::string xmlString = R"(
+<sdf version='1.4'>
+  <model name='model'>
+    <link name='link'>
+      <sensor name='imu' type='imu'>
+        <imu><noise><type>gaussian</type></noise></imu>
+      </sensor>
+    </link>
+    <joint name='joint' type='revolute'>
+      <parent>world</parent>
+      <child>link</child>
+      <axis><xyz>0 0 1</xyz></axis>
+    </joint>
+  </model>
+</sdf>)";
+
+  auto convert = [&xmlString]()
+  {
+    TiXmlDocument xmlDoc;
+    xmlDoc.Parse(xmlString.c_str());
+    EXPECT_TRUE(sdf::Converter::Convert(&xmlDoc, "1.8", true));
+    std::ostringstream stream;
+    stream << xmlDoc;
+    return stream.str();
+  };
+
+  const std::string expected = convert();
+  EXPECT_NE(std::string::npos, expected.find("version=\"1.8\""));
+  EXPECT_EQ(expected, convert());
+
+  std::vector<std::string> results(4);
+  std::vector<std::thread> threads;
+  for (auto &result : results)
+  {
+    threads.emplace_back([&result, &convert]()
+    {
+      for (int i = 0; i < 10; ++i)
+        result = convert();
+    });
+  }
+  for (auto &thread : threads)
+    thread.join();
+
+  for (const auto &result : results)
+    EXPECT_EQ(expected, result);
+}
+
 const std::string CONVERT_DOC_15_16 =
   sdf::filesystem::append(PROJECT_SOURCE_PATH, "sdf", "1.6", "1_5.convert");
 const std::string CONVERT_DOC_16_17 =
@@ -2003,6 +2122,54 @@ TEST(Converter, IMU_15_to_16)
   }
 }
 
+/////////////////////////////////////////////////
+/// Test that the embedded recipes, whose rule paths are split when they are
+/// parsed, convert as the recipe file does.
+TEST(Converter, CompiledRulePaths_15_to_16)
+{
+  const std::string xmlString = R"(
+<sdf version="1.5">
+  <world name="default">
+    <physics type="ode">
+      <gravity>0 0 -9.8</gravity>
+      <magnetic_field>0 0 1</magnetic_field>
+    </physics>
+    <model name="model">
+      <link name="link">
+        <sensor name='imu_sensor' type='imu'>
+          <imu>
+            <noise>
+              <type>gaussian</type>
+              <rate><mean>0</mean><stddev>0.0002</stddev></rate>
+              <accel><mean>0</mean><stddev>0.017</stddev></accel>
+            </noise>
+          </imu>
+        </sensor>
+      </link>
+    </model>
+  </world>
+</sdf>)";
+
+  TiXmlDocument compiledDoc;
+  compiledDoc.Parse(xmlString.c_str());
+  EXPECT_TRUE(sdf::Converter::Convert(&compiledDoc, "1.6", true));
+
+  TiXmlDocument fileDoc;
+  fileDoc.Parse(xmlString.c_str());
+  TiXmlDocument convertXmlDoc;
+  convertXmlDoc.LoadFile(CONVERT_DOC_15_16);
+  sdf::Converter::Convert(&fileDoc, &convertXmlDoc);
+  fileDoc.FirstChildElement("sdf")->SetAttribute("version", "1.6");
+
+  std::ostringstream compiled;
+  compiled << compiledDoc;
+  std::ostringstream file;
+  file << fileDoc;
+  EXPECT_EQ(file.str(), compiled.str());
+  EXPECT_NE(std::string::npos, compiled.str().find("<gravity>"));
+  EXPECT_NE(std::string::npos, compiled.str().find("angular_velocity"));
+}
+
 /////////////////////////////////////////////////
 /// Test conversion of gravity, magnetic_field in 1.5 to 1.6
 TEST(Converter, World_15_to_16)
@@ -2127,6 +2294,57 @@ TEST(Converter, Pose_16_to_17)
   EXPECT_STREQ("parent", jointLinkPoseElem->Attribute("relative_to"));
 }
 
+/////////////////////////////////////////////////
+/// Descendant conversions of a version conversion only walk the subtrees
+/// that the specification allows to contain the converted elements.
+TEST(Converter, DescendantSubtreesPruned)
+{
+  std::string xmlString = R"(
+<sdf version="1.6">
+  <model name="model">
+    <link name="link">
+      <visual name="visual">
+        <pose frame="link">0 0 0 0 0 0</pose>
+        <material>
+          <pose frame="link">0 0 0 0 0 0</pose>
+        </material>
+      </visual>
+      <custom>
+        <pose frame="link">0 0 0 0 0 0</pose>
+      </custom>
+    </link>
+  </model>
+</sdf>)";
+
+  TiXmlDocument xmlDoc;
+  xmlDoc.Parse(xmlString.c_str());
+  ASSERT_TRUE(sdf::Converter::Convert(&xmlDoc, "1.7", true));
+
+  TiXmlElement *linkElem = xmlDoc.FirstChildElement("sdf")
+      ->FirstChildElement("model")->FirstChildElement("link");
+  ASSERT_NE(nullptr, linkElem);
+  TiXmlElement *visualElem = linkElem->FirstChildElement("visual");
+  ASSERT_NE(nullptr, visualElem);
+
+  TiXmlElement *poseElem = visualElem->FirstChildElement("pose");
+  ASSERT_NE(nullptr, poseElem);
+  EXPECT_EQ(nullptr, poseElem->Attribute("frame"));
+  EXPECT_STREQ("link", poseElem->Attribute("relative_to"));
+
+  // A <material> can't have a <pose>, so it isn't walked.
+  poseElem = visualElem->FirstChildElement("material")
+      ->FirstChildElement("pose");
+  ASSERT_NE(nullptr, poseElem);
+  EXPECT_STREQ("link", poseElem->Attribute("frame"));
+  EXPECT_EQ(nullptr, poseElem->Attribute("relative_to"));
+
+  // Elements that are not in the specification are still walked.
+  poseElem = linkElem->FirstChildElement("custom")->FirstChildElement("pose");
+  ASSERT_NE(nullptr, poseElem);
+  EXPECT_EQ(nullptr, poseElem->Attribute("frame"));
+  EXPECT_STREQ("link", poseElem->Attribute("relative_to"));
+}
+
 /////////////////////////////////////////////////
 /// Main
 int main(int argc, char **argv)
@@ -16,99 +16,458 @@
  */
 
 #include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <ostream>
 #include <sstream>
 #include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include <tinyxml.h>
 
 #include "sdf/Assert.hh"
 #include "sdf/Element.hh"
 #include "sdf/Filesystem.hh"
+#include "ElementArena.hh"
+#include "Utils.hh"
 
 using namespace sdf;
 
+/// \brief Number of child elements from which an element indexes its
+/// children by name. Smaller elements are searched linearly, which is as
+/// fast and does not cost any memory.
+static const std::size_t elementIndexThreshold = 8;
+
+/////////////////////////////////////////////////
+/// \brief Find the first element with a name in an index of elements by
+/// hash of their name, such as ElementPrivate::elementIndex.
+/// \param[in] _index The index.
+/// \param[in] _elements The elements that the index was built from.
+/// \param[in] _name Name of the element.
+/// \return Position of the element, or the number of elements if it is not
+/// in the index.
+static std::size_t findIndexedElement(
+    const std::unordered_multimap<std::size_t, std::size_t> &_index,
+    const ElementPtr_V &_elements, std::string_view _name)
+{
+  auto range = _index.equal_range(std::hash<std::string_view>()(_name));
+  for (auto iter = range.first; iter != range.second; ++iter)
+  {
+    if (iter->second < _elements.size() &&
+        _elements[iter->second]->GetName() == _name)
+    {
+      return iter->second;
+    }
+  }
+  return _elements.size();
+}
+
+/////////////////////////////////////////////////
+/// \brief Add an element to an index of elements by hash of their name,
+/// unless an element with the same name is already in it.
+/// \param[in,out] _index The index.
+/// \param[in] _elements The elements.
+/// \param[in] _pos Position of the element.
+static void indexElement(
+    std::unordered_multimap<std::size_t, std::size_t> &_index,
+    const ElementPtr_V &_elements, const std::size_t _pos)
+{
+  const std::string &name = _elements[_pos]->GetName();
+  if (findIndexedElement(_index, _elements, name) == _elements.size())
+    _index.emplace(std::hash<std::string_view>()(name), _pos);
+}
+
+/// \brief Mutex held while deferred elements are read, since const
+/// accessors read them. It is recursive because reading them inserts
+/// elements, which checks for deferred elements again.
+static std::recursive_mutex &deferredElementsMutex()
+{
+  static std::recursive_mutex mutex;
+  return mutex;
+}
+
+/////////////////////////////////////////////////
+/// \brief Get the parent of an element without locking it. Checking that
+/// the parent has not expired is a load of its use count, where locking it
+/// is an atomic increment and decrement, which dominate walks up and
+/// across large trees.
+/// \param[in] _data The private data of the element.
+/// \return The parent, or nullptr if the element has no parent.
+static Element *parentOf(const ElementPrivate &_data)
+{
+  return _data.parent.expired() ? nullptr : _data.parentElement;
+}
+
+/////////////////////////////////////////////////
+/// \brief Get the provenance of an element.
+/// \param[in] _record The provenance record of the element, or nullptr.
+/// \return The record, or an empty record for nullptr.
+static const ElementProvenance &provenanceOf(
+    const std::shared_ptr<const ElementProvenance> &_record)
+{
+  static const ElementProvenance empty;
+  return _record ? *_record : empty;
+}
+
+/////////////////////////////////////////////////
+/// \brief Set the provenance record of an element. The record of the
+/// parent is shared if it matches, then the record of the element is kept
+/// if it matches, and a new record is made otherwise.
+/// \param[in,out] _record The provenance record of the element.
+/// \param[in] _parentRecord The provenance record of the parent.
+/// \param[in] _provenance The new provenance of the element.
+static void setProvenance(std::shared_ptr<const ElementProvenance> &_record,
+    const std::shared_ptr<const ElementProvenance> &_parentRecord,
+    ElementProvenance &&_provenance)
+{
+  auto matches = [&](const std::shared_ptr<const ElementProvenance> &_other)
+  {
+    const ElementProvenance &other = provenanceOf(_other);
+    return other.path == _provenance.path &&
+        other.originalVersion == _provenance.originalVersion &&
+        other.includeFilename == _provenance.includeFilename &&
+        other.includeXml == _provenance.includeXml &&
+        other.includeHash == _provenance.includeHash;
+  };
+
+  if (matches(_parentRecord))
+  {
+    _record = _parentRecord;
+  }
+  else if (!matches(_record))
+  {
+    _record = std::make_shared<ElementProvenance>(std::move(_provenance));
+  }
+}
+
+/////////////////////////////////////////////////
+/// \brief Copy the child elements of an XML element into an element, the
+/// way the parser copies elements that are not in the SDF spec.
+/// \param[in] _elem Element to add the child elements to.
+/// \param[in] _xml The XML element.
+static void readCopiedElements(const ElementPtr &_elem,
+    const TiXmlElement *_xml)
+{
+  for (const TiXmlElement *elemXml = _xml->FirstChildElement(); elemXml;
+       elemXml = elemXml->NextSiblingElement())
+  {
+    ElementPtr element(new Element);
+    element->SetParent(_elem);
+    element->SetName(elemXml->ValueStr());
+    if (elemXml->GetText() != nullptr)
+    {
+      element->AddValue("string", elemXml->GetText(), true);
+    }
+
+    for (const TiXmlAttribute *attribute = elemXml->FirstAttribute();
+         attribute; attribute = attribute->Next())
+    {
+      element->AddAttribute(attribute->Name(), "string", "", true, "");
+      element->GetAttribute(attribute->Name())->SetFromString(
+        attribute->ValueStr());
+    }
+
+    readCopiedElements(element, elemXml);
+    _elem->InsertElement(element);
+  }
+}
+
 /////////////////////////////////////////////////
 Element::Element()
   : dataPtr(new ElementPrivate)
 {
-  this->dataPtr->copyChildren = false;
-  this->dataPtr->referenceSDF = "";
+  this->dataPtr->schema = std::make_shared<ElementSchema>();
+  LoadCounters::Add(&LoadCounters::elementsCreated);
+}
+
+/////////////////////////////////////////////////
+Element::Element(std::shared_ptr<ElementSchema> _schema)
+  : dataPtr(new ElementPrivate)
+{
+  this->dataPtr->schema = std::move(_schema);
+  LoadCounters::Add(&LoadCounters::elementsCreated);
+}
+
+/////////////////////////////////////////////////
+void *Element::operator new(std::size_t _size)
+{
+  return ElementArena::Allocate(_size);
+}
+
+/////////////////////////////////////////////////
+void Element::operator delete(void *_ptr)
+{
+  ElementArena::Deallocate(_ptr);
+}
+
+/////////////////////////////////////////////////
+void *ElementPrivate::operator new(std::size_t _size)
+{
+  return ElementArena::Allocate(_size);
+}
+
+/////////////////////////////////////////////////
+void ElementPrivate::operator delete(void *_ptr)
+{
+  ElementArena::Deallocate(_ptr);
 }
 
 /////////////////////////////////////////////////
 Element::~Element()
 {
+  // The descendants that only this element holds are destroyed with an
+  // explicit stack instead of recursion, so that destroying deeply nested
+  // elements does not overflow the call stack. Only the stack holds a
+  // reference to an element when use_count is 1, so its children can be
+  // moved to the stack before it is destroyed.
+  ElementPtr_V stack;
+  stack.swap(this->dataPtr->elements);
+  while (!stack.empty())
+  {
+    ElementPtr elem = std::move(stack.back());
+    stack.pop_back();
+    if (elem.use_count() == 1)
+    {
+      for (ElementPtr &child : elem->dataPtr->elements)
+        stack.push_back(std::move(child));
+      elem->dataPtr->elements.clear();
+    }
+  }
 }
 
 /////////////////////////////////////////////////
-ElementPtr Element::GetParent() const
+ElementSchema &Element::MutableSchema()
 {
-  return this->dataPtr->parent.lock();
+  // Only this element holds a reference when use_count is 1, and no other
+  // element can start sharing it concurrently without reading this element.
+  if (this->dataPtr->schema.use_count() > 1)
+  {
+    this->dataPtr->schema =
+        std::make_shared<ElementSchema>(*this->dataPtr->schema);
+  }
+  // The schema is about to change, and only this element refers to it.
+  this->dataPtr->schema->readTable.reset();
+  return *this->dataPtr->schema;
 }
 
 /////////////////////////////////////////////////
-void Element::SetParent(const ElementPtr _parent)
+const ElementPrivate &Element::Content() const
 {
-  this->dataPtr->parent = _parent;
+  if (this->dataPtr->copyOnWriteSource)
+    return *this->dataPtr->copyOnWriteSource->dataPtr;
+  return *this->dataPtr;
+}
+
+/////////////////////////////////////////////////
+void Element::CopySharedContent(bool _copyElements) const
+{
+  if (!this->dataPtr->copyOnWriteSource)
+  {
+    // Deferred elements that are about to be cleared are never read.
+    if (!_copyElements && this->dataPtr->elementsDeferred)
+    {
+      this->dataPtr->deferredXml.reset();
+      this->dataPtr->elementsDeferred = false;
+    }
+    return;
+  }
+
+  if (_copyElements)
+    this->ReadDeferredElements();
+
+  const ElementPtr source = std::move(this->dataPtr->copyOnWriteSource);
+  advanceParamUpdateGeneration();
 
-  // If this element doesn't have a path, get it from the parent
-  if (nullptr != _parent && (this->FilePath().empty() ||
-      this->FilePath() == "data-string"))
+  for (const ParamPtr &attribute : source->dataPtr->attributes)
+    this->dataPtr->attributes.push_back(attribute->Clone());
+
+  if (source->dataPtr->value)
+    this->dataPtr->value = source->dataPtr->value->Clone();
+
+  if (_copyElements)
   {
-    this->SetFilePath(_parent->FilePath());
+    // This function is const so that const accessors can hand out child
+    // elements, but the element itself is not const.
+    const ElementPtr self =
+        std::const_pointer_cast<Element>(this->shared_from_this());
+    for (const ElementPtr &child : source->dataPtr->elements)
+    {
+      this->dataPtr->elements.push_back(child->CopyOnWriteClone());
+      this->dataPtr->elements.back()->SetParent(self);
+    }
+    self->RebuildElementIndex();
   }
+}
 
-  // If this element doesn't have an original version, get it from the parent
-  if (nullptr != _parent && this->OriginalVersion().empty())
+/////////////////////////////////////////////////
+void Element::ReadDeferredElements() const
+{
+  const Element *owner = this->dataPtr->copyOnWriteSource ?
+      this->dataPtr->copyOnWriteSource.get() : this;
+  if (!owner->dataPtr->elementsDeferred.load(std::memory_order_acquire))
+    return;
+
+  std::lock_guard<std::recursive_mutex> lock(deferredElementsMutex());
+  // Another thread may have read the elements while this one waited, and
+  // inserting the elements below calls this function again.
+  const std::shared_ptr<const std::string> xml =
+      std::move(owner->dataPtr->deferredXml);
+  if (!xml)
+    return;
+
+  TiXmlDocument xmlDoc;
+  xmlDoc.Parse(("<deferred>" + *xml + "</deferred>").c_str());
+  if (xmlDoc.RootElement())
   {
-    this->SetOriginalVersion(_parent->OriginalVersion());
+    readCopiedElements(
+        std::const_pointer_cast<Element>(owner->shared_from_this()),
+        xmlDoc.RootElement());
   }
+  owner->dataPtr->elementsDeferred.store(false, std::memory_order_release);
+}
+
+/////////////////////////////////////////////////
+void Element::SetDeferredElements(const std::string &_xml)
+{
+  this->ClearElements();
+  this->dataPtr->deferredXml = std::make_shared<const std::string>(_xml);
+  this->dataPtr->elementsDeferred = true;
+}
+
+/////////////////////////////////////////////////
+bool Element::ElementsDeferred() const
+{
+  const Element *owner = this->dataPtr->copyOnWriteSource ?
+      this->dataPtr->copyOnWriteSource.get() : this;
+  return owner->dataPtr->elementsDeferred.load(std::memory_order_acquire);
+}
+
+/////////////////////////////////////////////////
+void Element::IndexLastElement()
+{
+  if (this->dataPtr->elementIndex.empty())
+  {
+    if (this->dataPtr->elements.size() >= elementIndexThreshold)
+      this->RebuildElementIndex();
+  }
+  else
+  {
+    // Only the first element with this name is indexed.
+    indexElement(this->dataPtr->elementIndex, this->dataPtr->elements,
+        this->dataPtr->elements.size() - 1);
+  }
+}
+
+/////////////////////////////////////////////////
+void Element::RebuildElementIndex()
+{
+  this->dataPtr->elementIndex.clear();
+  if (this->dataPtr->elements.size() < elementIndexThreshold)
+    return;
+
+  for (std::size_t i = 0; i < this->dataPtr->elements.size(); ++i)
+    indexElement(this->dataPtr->elementIndex, this->dataPtr->elements, i);
+}
+
+/////////////////////////////////////////////////
+void Element::UpdateParentElementIndex()
+{
+  Element *parent = parentOf(*this->dataPtr);
+  if (!parent || parent->dataPtr->elementIndex.empty())
+    return;
+
+  if (std::find_if(parent->dataPtr->elements.begin(),
+        parent->dataPtr->elements.end(),
+        [this](const ElementPtr &_elem) {return _elem.get() == this;}) !=
+      parent->dataPtr->elements.end())
+  {
+    parent->RebuildElementIndex();
+  }
+}
+
+/////////////////////////////////////////////////
+ElementPtr Element::GetParent() const
+{
+  return this->dataPtr->parent.lock();
+}
+
+/////////////////////////////////////////////////
+void Element::SetParent(const ElementPtr _parent)
+{
+  this->dataPtr->parent = _parent;
+  this->dataPtr->parentElement = _parent.get();
+  if (nullptr == _parent)
+    return;
+
+  // If this element doesn't have a path or an original version, get them
+  // from the parent.
+  ElementProvenance provenance = provenanceOf(this->dataPtr->provenance);
+  if (provenance.path.empty() || provenance.path == "data-string")
+    provenance.path = _parent->FilePath();
+  if (provenance.originalVersion.empty())
+    provenance.originalVersion = _parent->OriginalVersion();
+  setProvenance(this->dataPtr->provenance, _parent->dataPtr->provenance,
+      std::move(provenance));
 }
 
 /////////////////////////////////////////////////
 void Element::SetName(const std::string &_name)
 {
-  this->dataPtr->name = _name;
+  if (this->dataPtr->schema->name == _name)
+    return;
+
+  this->MutableSchema().name = _name;
+  this->ResetHash();
+  this->UpdateParentElementIndex();
 }
 
 /////////////////////////////////////////////////
 const std::string &Element::GetName() const
 {
-  return this->dataPtr->name;
+  return this->dataPtr->schema->name;
 }
 
 /////////////////////////////////////////////////
 void Element::SetRequired(const std::string &_req)
 {
-  this->dataPtr->required = _req;
+  this->MutableSchema().required = _req;
 }
 
 /////////////////////////////////////////////////
 const std::string &Element::GetRequired() const
 {
-  return this->dataPtr->required;
+  return this->dataPtr->schema->required;
 }
 
 /////////////////////////////////////////////////
 void Element::SetCopyChildren(bool _value)
 {
-  this->dataPtr->copyChildren = _value;
+  this->MutableSchema().copyChildren = _value;
 }
 
 /////////////////////////////////////////////////
 bool Element::GetCopyChildren() const
 {
-  return this->dataPtr->copyChildren;
+  return this->dataPtr->schema->copyChildren;
 }
 
 /////////////////////////////////////////////////
 void Element::SetReferenceSDF(const std::string &_value)
 {
-  this->dataPtr->referenceSDF = _value;
+  this->MutableSchema().referenceSDF = _value;
 }
 
 /////////////////////////////////////////////////
 std::string Element::ReferenceSDF() const
 {
-  return this->dataPtr->referenceSDF;
+  return this->dataPtr->schema->referenceSDF;
 }
 
 /////////////////////////////////////////////////
@@ -117,8 +476,11 @@ void Element::AddValue(const std::string &_type,
                        bool _required,
                        const std::string &_description)
 {
-  this->dataPtr->value = this->CreateParam(this->dataPtr->name,
+  this->CopySharedContent();
+  this->dataPtr->value = this->CreateParam(this->dataPtr->schema->name,
       _type, _defaultValue, _required, _description);
+  advanceParamUpdateGeneration();
+  this->ResetHash();
 }
 
 /////////////////////////////////////////////////
@@ -128,7 +490,7 @@ ParamPtr Element::CreateParam(const std::string &_key,
                               bool _required,
                               const std::string &_description)
 {
-  return ParamPtr(
+  return makeArenaShared(
       new Param(_key, _type, _defaultValue, _required, _description));
 }
 
@@ -139,66 +501,122 @@ void Element::AddAttribute(const std::string &_key,
                            bool _required,
                            const std::string &_description)
 {
+  this->CopySharedContent();
   this->dataPtr->attributes.push_back(
       this->CreateParam(_key, _type, _defaultValue, _required, _description));
+  this->ResetHash();
 }
 
 /////////////////////////////////////////////////
-ElementPtr Element::Clone() const
+void Element::RemoveAttribute(const std::string &_key)
 {
-  ElementPtr clone(new Element);
-  clone->dataPtr->description = this->dataPtr->description;
-  clone->dataPtr->name = this->dataPtr->name;
-  clone->dataPtr->required = this->dataPtr->required;
-  clone->dataPtr->copyChildren = this->dataPtr->copyChildren;
-  clone->dataPtr->includeFilename = this->dataPtr->includeFilename;
-  clone->dataPtr->referenceSDF = this->dataPtr->referenceSDF;
-  clone->dataPtr->path = this->dataPtr->path;
-  clone->dataPtr->originalVersion = this->dataPtr->originalVersion;
+  this->CopySharedContent();
+  Param_V &attributes = this->dataPtr->attributes;
+  attributes.erase(std::remove_if(attributes.begin(), attributes.end(),
+      [&_key](const ParamPtr &_attribute)
+      {
+        return _attribute->GetKey() == _key;
+      }), attributes.end());
+  this->ResetHash();
+}
 
-  Param_V::const_iterator aiter;
-  for (aiter = this->dataPtr->attributes.begin();
-       aiter != this->dataPtr->attributes.end(); ++aiter)
+/////////////////////////////////////////////////
+ElementPtr Element::Clone() const
+{
+  // Clone an element without its child elements.
+  auto cloneNode = [](const Element &_elem)
   {
-    clone->dataPtr->attributes.push_back((*aiter)->Clone());
-  }
+    ElementPtr clone = makeArenaShared(new Element(_elem.dataPtr->schema));
+    clone->dataPtr->provenance = _elem.dataPtr->provenance;
+
+    const ElementPrivate &content = _elem.Content();
+    for (const ParamPtr &attribute : content.attributes)
+      clone->dataPtr->attributes.push_back(attribute->Clone());
+
+    // Deferred elements are shared by the clone instead of being read.
+    if (content.elementsDeferred.load(std::memory_order_acquire))
+    {
+      std::lock_guard<std::recursive_mutex> lock(deferredElementsMutex());
+      clone->dataPtr->deferredXml = content.deferredXml;
+      clone->dataPtr->elementsDeferred = content.deferredXml != nullptr;
+    }
 
-  ElementPtr_V::const_iterator eiter;
-  for (eiter = this->dataPtr->elementDescriptions.begin();
-      eiter != this->dataPtr->elementDescriptions.end(); ++eiter)
+    if (content.value)
+      clone->dataPtr->value = content.value->Clone();
+    return clone;
+  };
+
+  // The tree is cloned with an explicit stack instead of recursion, so
+  // that deeply nested elements do not overflow the call stack.
+  LoadCounters::Add(&LoadCounters::elementClones);
+  ElementPtr clone = cloneNode(*this);
+  std::vector<std::pair<const Element *, ElementPtr>> stack;
+  stack.emplace_back(this, clone);
+  while (!stack.empty())
   {
-    clone->dataPtr->elementDescriptions.push_back((*eiter)->Clone());
+    const Element *source = stack.back().first;
+    const ElementPtr target = std::move(stack.back().second);
+    stack.pop_back();
+    if (target->dataPtr->elementsDeferred)
+      continue;
+
+    for (const ElementPtr &child : source->Content().elements)
+    {
+      target->dataPtr->elements.push_back(cloneNode(*child));
+      target->dataPtr->elements.back()->SetParent(target);
+      stack.emplace_back(child.get(), target->dataPtr->elements.back());
+    }
+    target->RebuildElementIndex();
   }
 
-  for (eiter = this->dataPtr->elements.begin();
-       eiter != this->dataPtr->elements.end(); ++eiter)
+  return clone;
+}
+
+/////////////////////////////////////////////////
+ElementPtr Element::CopyOnWriteClone() const
+{
+  ElementPtr clone = makeArenaShared(new Element(this->dataPtr->schema));
+  clone->dataPtr->provenance = this->dataPtr->provenance;
+
+  // Share the content of the source of this element if it has not been
+  // copied yet, so that clones never form chains.
+  if (this->dataPtr->copyOnWriteSource)
   {
-    clone->dataPtr->elements.push_back((*eiter)->Clone());
-    clone->dataPtr->elements.back()->SetParent(clone);
+    clone->dataPtr->copyOnWriteSource = this->dataPtr->copyOnWriteSource;
   }
-
-  if (this->dataPtr->value)
+  else
   {
-    clone->dataPtr->value = this->dataPtr->value->Clone();
+    clone->dataPtr->copyOnWriteSource =
+        std::const_pointer_cast<Element>(this->shared_from_this());
   }
 
+  // The clone has the content of this element, so it has its hash too.
+  // Otherwise the children that a hashed clone gets from CopySharedContent
+  // would have no hash, and ResetHash would not reach the clone when they
+  // change.
+  clone->dataPtr->hash.store(
+      this->dataPtr->hash.load(std::memory_order_acquire),
+      std::memory_order_relaxed);
+
   return clone;
 }
 
 /////////////////////////////////////////////////
 void Element::Copy(const ElementPtr _elem)
 {
-  this->dataPtr->name = _elem->GetName();
-  this->dataPtr->description = _elem->GetDescription();
-  this->dataPtr->required = _elem->GetRequired();
-  this->dataPtr->copyChildren = _elem->GetCopyChildren();
-  this->dataPtr->includeFilename = _elem->dataPtr->includeFilename;
-  this->dataPtr->referenceSDF = _elem->ReferenceSDF();
-  this->dataPtr->originalVersion = _elem->OriginalVersion();
-  this->dataPtr->path = _elem->FilePath();
-
-  for (Param_V::iterator iter = _elem->dataPtr->attributes.begin();
-       iter != _elem->dataPtr->attributes.end(); ++iter)
+  // The child elements are replaced below, so they are not copied.
+  this->CopySharedContent(false);
+  _elem->ReadDeferredElements();
+  const ElementPrivate &source = _elem->Content();
+
+  const bool renamed = this->GetName() != _elem->GetName();
+  this->dataPtr->schema = _elem->dataPtr->schema;
+  if (renamed)
+    this->UpdateParentElementIndex();
+  this->dataPtr->provenance = _elem->dataPtr->provenance;
+
+  for (Param_V::const_iterator iter = source.attributes.begin();
+       iter != source.attributes.end(); ++iter)
   {
     if (!this->HasAttribute((*iter)->GetKey()))
     {
@@ -208,90 +626,88 @@ void Element::Copy(const ElementPtr _elem)
     (*param) = (**iter);
   }
 
-  if (_elem->GetValue())
+  if (source.value)
   {
     if (!this->dataPtr->value)
     {
-      this->dataPtr->value = _elem->GetValue()->Clone();
+      this->dataPtr->value = source.value->Clone();
     }
     else
     {
-      *(this->dataPtr->value) = *(_elem->GetValue());
+      *(this->dataPtr->value) = *(source.value);
     }
   }
 
-  this->dataPtr->elementDescriptions.clear();
-  for (ElementPtr_V::const_iterator iter =
-       _elem->dataPtr->elementDescriptions.begin();
-       iter != _elem->dataPtr->elementDescriptions.end(); ++iter)
-  {
-    this->dataPtr->elementDescriptions.push_back((*iter)->Clone());
-  }
-
   this->dataPtr->elements.clear();
-  for (ElementPtr_V::iterator iter = _elem->dataPtr->elements.begin();
-       iter != _elem->dataPtr->elements.end(); ++iter)
+  for (ElementPtr_V::const_iterator iter = source.elements.begin();
+       iter != source.elements.end(); ++iter)
   {
     ElementPtr elem = (*iter)->Clone();
     elem->Copy(*iter);
     elem->SetParent(shared_from_this());
     this->dataPtr->elements.push_back(elem);
   }
+  this->RebuildElementIndex();
+  advanceParamUpdateGeneration();
+  this->ResetHash();
 }
 
 /////////////////////////////////////////////////
 void Element::PrintDescription(const std::string &_prefix) const
 {
-  std::cout << _prefix << "<element name ='" << this->dataPtr->name
-            << "' required ='" << this->dataPtr->required << "'";
+  this->PrintDescription(std::cout, _prefix);
+}
+
+/////////////////////////////////////////////////
+void Element::PrintDescription(std::ostream &_out,
+                               const std::string &_prefix) const
+{
+  _out << _prefix << "<element name ='" << this->dataPtr->schema->name
+       << "' required ='" << this->dataPtr->schema->required << "'";
 
   if (this->dataPtr->value)
   {
-    std::cout << " type ='" << this->dataPtr->value->GetTypeName()
-              << "'"
-              << " default ='" << this->dataPtr->value->GetDefaultAsString()
-              << "'";
+    _out << " type ='" << this->dataPtr->value->GetTypeName()
+         << "'"
+         << " default ='" << this->dataPtr->value->GetDefaultAsString()
+         << "'";
   }
 
-  std::cout << ">\n";
+  _out << ">\n";
 
-  std::cout << _prefix << "  <description>" << this->dataPtr->description
-            << "</description>\n";
+  _out << _prefix << "  <description>"
+       << this->dataPtr->schema->description << "</description>\n";
 
-  Param_V::iterator aiter;
-  for (aiter = this->dataPtr->attributes.begin();
-      aiter != this->dataPtr->attributes.end(); ++aiter)
+  for (const ParamPtr &attribute : this->dataPtr->attributes)
   {
-    std::cout << _prefix << "  <attribute name ='"
-              << (*aiter)->GetKey() << "' type ='" << (*aiter)->GetTypeName()
-              << "' default ='" << (*aiter)->GetDefaultAsString()
-              << "' required ='" << (*aiter)->GetRequired() << "'>\n";
-    std::cout << _prefix << "    <description>" << (*aiter)->GetDescription()
-              << "</description>\n";
-    std::cout << _prefix << "  </attribute>\n";
+    _out << _prefix << "  <attribute name ='"
+         << attribute->GetKey() << "' type ='" << attribute->GetTypeName()
+         << "' default ='" << attribute->GetDefaultAsString()
+         << "' required ='" << attribute->GetRequired() << "'>\n";
+    _out << _prefix << "    <description>" << attribute->GetDescription()
+         << "</description>\n";
+    _out << _prefix << "  </attribute>\n";
   }
 
   if (this->GetCopyChildren())
   {
-    std::cout << _prefix << "  <element copy_data ='true' required ='*'/>\n";
+    _out << _prefix << "  <element copy_data ='true' required ='*'/>\n";
   }
 
-
-  std::string refSDF = this->ReferenceSDF();
+  const std::string &refSDF = this->dataPtr->schema->referenceSDF;
   if (!refSDF.empty())
   {
-    std::cout << _prefix << "  <element ref ='" << refSDF
-              << "' required ='*'/>\n";
+    _out << _prefix << "  <element ref ='" << refSDF
+         << "' required ='*'/>\n";
   }
 
-  ElementPtr_V::iterator eiter;
-  for (eiter = this->dataPtr->elementDescriptions.begin();
-      eiter != this->dataPtr->elementDescriptions.end(); ++eiter)
+  const std::string childPrefix = _prefix + "  ";
+  for (const ElementPtr &child : this->dataPtr->schema->elementDescriptions)
   {
-    (*eiter)->PrintDescription(_prefix + "  ");
+    child->PrintDescription(_out, childPrefix);
   }
 
-  std::cout << _prefix << "</element>\n";
+  _out << _prefix << "</element>\n";
 }
 
 /////////////////////////////////////////////////
@@ -299,95 +715,97 @@ void Element::PrintDocRightPane(std::string &_html, int _spacing,
                                 int &_index) const
 {
   std::ostringstream stream;
-  ElementPtr_V::iterator eiter;
+  this->PrintDocRightPane(stream, _spacing, _index);
+  _html += stream.str();
+}
 
+/////////////////////////////////////////////////
+void Element::PrintDocRightPane(std::ostream &_out, int _spacing,
+                                int &_index) const
+{
   int start = _index++;
 
-  std::string childHTML;
-  for (eiter = this->dataPtr->elementDescriptions.begin();
-      eiter != this->dataPtr->elementDescriptions.end(); ++eiter)
-  {
-    (*eiter)->PrintDocRightPane(childHTML, _spacing + 4, _index);
-  }
+  _out << "<a name=\"" << this->dataPtr->schema->name << start
+       << "\">&lt" << this->dataPtr->schema->name << "&gt</a>";
 
-  stream << "<a name=\"" << this->dataPtr->name << start
-         << "\">&lt" << this->dataPtr->name << "&gt</a>";
+  _out << "<div style='padding-left:" << _spacing << "px;'>\n";
 
-  stream << "<div style='padding-left:" << _spacing << "px;'>\n";
+  _out << "<div style='background-color: #ffffff'>\n";
 
-  stream << "<div style='background-color: #ffffff'>\n";
-
-  stream << "<font style='font-weight:bold'>Description: </font>";
-  if (!this->dataPtr->description.empty())
+  _out << "<font style='font-weight:bold'>Description: </font>";
+  if (!this->dataPtr->schema->description.Empty())
   {
-    stream << this->dataPtr->description << "<br>\n";
+    _out << this->dataPtr->schema->description << "<br>\n";
   }
   else
   {
-    stream << "none<br>\n";
+    _out << "none<br>\n";
   }
 
-  stream << "<font style='font-weight:bold'>Required: </font>"
-         << this->dataPtr->required << "&nbsp;&nbsp;&nbsp;\n";
+  _out << "<font style='font-weight:bold'>Required: </font>"
+       << this->dataPtr->schema->required << "&nbsp;&nbsp;&nbsp;\n";
 
-  stream << "<font style='font-weight:bold'>Type: </font>";
+  _out << "<font style='font-weight:bold'>Type: </font>";
   if (this->dataPtr->value)
   {
-    stream << this->dataPtr->value->GetTypeName()
-           << "&nbsp;&nbsp;&nbsp;\n"
-           << "<font style='font-weight:bold'>Default: </font>"
-           << this->dataPtr->value->GetDefaultAsString() << '\n';
+    _out << this->dataPtr->value->GetTypeName()
+         << "&nbsp;&nbsp;&nbsp;\n"
+         << "<font style='font-weight:bold'>Default: </font>"
+         << this->dataPtr->value->GetDefaultAsString() << '\n';
   }
   else
   {
-    stream << "n/a\n";
+    _out << "n/a\n";
   }
 
-  stream << "</div>";
+  _out << "</div>";
 
   if (this->dataPtr->attributes.size() > 0)
   {
-    stream << "<div style='background-color: #dedede; padding-left:10px; "
-           << "display:inline-block;'>\n";
-    stream << "<font style='font-weight:bold'>Attributes</font><br>";
+    _out << "<div style='background-color: #dedede; padding-left:10px; "
+         << "display:inline-block;'>\n";
+    _out << "<font style='font-weight:bold'>Attributes</font><br>";
 
-    Param_V::iterator aiter;
-    for (aiter = this->dataPtr->attributes.begin();
-        aiter != this->dataPtr->attributes.end(); ++aiter)
+    for (const ParamPtr &attribute : this->dataPtr->attributes)
     {
-      stream << "<div style='display: inline-block;padding-bottom: 4px;'>\n";
+      _out << "<div style='display: inline-block;padding-bottom: 4px;'>\n";
 
-      stream << "<div style='float:left; width: 80px;'>\n";
-      stream << "<font style='font-style: italic;'>" << (*aiter)->GetKey()
-        << "</font>: ";
-      stream << "</div>\n";
+      _out << "<div style='float:left; width: 80px;'>\n";
+      _out << "<font style='font-style: italic;'>" << attribute->GetKey()
+           << "</font>: ";
+      _out << "</div>\n";
 
-      stream << "<div style='float:left; padding-left: 4px; width: 300px;'>\n";
+      _out << "<div style='float:left; padding-left: 4px; width: 300px;'>\n";
 
-      if (!(*aiter)->GetDescription().empty())
+      if (!attribute->GetDescription().empty())
       {
-          stream << (*aiter)->GetDescription() << "<br>\n";
+        _out << attribute->GetDescription() << "<br>\n";
       }
       else
       {
-          stream << "no description<br>\n";
+        _out << "no description<br>\n";
       }
 
-      stream << "<font style='font-weight:bold'>Type: </font>"
-             << (*aiter)->GetTypeName() << "&nbsp;&nbsp;&nbsp;"
-             << "<font style='font-weight:bold'>Default: </font>"
-             << (*aiter)->GetDefaultAsString() << "<br>";
-      stream << "</div>\n";
+      _out << "<font style='font-weight:bold'>Type: </font>"
+           << attribute->GetTypeName() << "&nbsp;&nbsp;&nbsp;"
+           << "<font style='font-weight:bold'>Default: </font>"
+           << attribute->GetDefaultAsString() << "<br>";
+      _out << "</div>\n";
 
-      stream << "</div>\n";
+      _out << "</div>\n";
     }
-    stream << "</div>\n";
-    stream << "<br>\n";
+    _out << "</div>\n";
+    _out << "<br>\n";
   }
 
-  _html += stream.str();
-  _html += childHTML;
-  _html += "</div>\n";
+  // The children are numbered after this element, in document order, so
+  // they are written as they are numbered.
+  for (const ElementPtr &child : this->dataPtr->schema->elementDescriptions)
+  {
+    child->PrintDocRightPane(_out, _spacing + 4, _index);
+  }
+
+  _out << "</div>\n";
 }
 
 /////////////////////////////////////////////////
@@ -395,116 +813,575 @@ void Element::PrintDocLeftPane(std::string &_html, int _spacing,
                                int &_index) const
 {
   std::ostringstream stream;
-  ElementPtr_V::iterator eiter;
+  this->PrintDocLeftPane(stream, _spacing, _index);
+  _html += stream.str();
+}
 
+/////////////////////////////////////////////////
+void Element::PrintDocLeftPane(std::ostream &_out, int _spacing,
+                               int &_index) const
+{
   int start = _index++;
 
-  std::string childHTML;
-  for (eiter = this->dataPtr->elementDescriptions.begin();
-      eiter != this->dataPtr->elementDescriptions.end(); ++eiter)
+  _out << "<a id='" << start << "' onclick='highlight(" << start
+       << ");' href=\"#" << this->dataPtr->schema->name << start
+       << "\">&lt" << this->dataPtr->schema->name << "&gt</a>";
+
+  _out << "<div style='padding-left:" << _spacing << "px;'>\n";
+
+  for (const ElementPtr &child : this->dataPtr->schema->elementDescriptions)
   {
-    (*eiter)->PrintDocLeftPane(childHTML, _spacing + 4, _index);
+    child->PrintDocLeftPane(_out, _spacing + 4, _index);
   }
 
-  stream << "<a id='" << start << "' onclick='highlight(" << start
-         << ");' href=\"#" << this->dataPtr->name << start
-         << "\">&lt" << this->dataPtr->name << "&gt</a>";
+  _out << "</div>\n";
+}
 
-  stream << "<div style='padding-left:" << _spacing << "px;'>\n";
+/////////////////////////////////////////////////
+/// \brief Size at which Element::Write writes its buffer to the stream.
+static const std::size_t kWriteBufferSize = 64 * 1024;
 
-  _html += stream.str();
-  _html += childHTML;
-  _html += "</div>\n";
+/// \brief Number of children from which the children of an element are
+/// printed concurrently, when the print configuration has several
+/// threads.
+static const std::size_t kParallelPrintChildren = 16;
+
+/// \brief Number of children printed concurrently before their output is
+/// appended to the buffer, which bounds the memory of Element::Write.
+static const std::size_t kParallelPrintBatch = 256;
+
+/// \brief Number of levels below the printed element that are searched for
+/// elements with many children, enough to reach the models of the worlds
+/// of an <sdf> element.
+static const int kParallelPrintDepth = 3;
+
+/////////////////////////////////////////////////
+/// \brief Print an element as the <include> it was read from, if it is
+/// printed so (see Element::ToString).
+/// \param[in] _elem The element.
+/// \param[in] _provenance Provenance of the element.
+/// \param[in] _prefix Prefix of the element.
+/// \param[in,out] _buffer String to append the output to.
+/// \param[in] _config Options that control the representation.
+/// \return True if the element was printed as an include.
+static bool printInclude(const Element &_elem,
+                         const ElementProvenance &_provenance,
+                         const std::string &_prefix, std::string &_buffer,
+                         const PrintConfig &_config)
+{
+  if (!_provenance.includeFilename.empty())
+  {
+    _buffer += _prefix;
+    _buffer += "<include filename='";
+    _buffer += _provenance.includeFilename;
+    _buffer += "'/>\n";
+    return true;
+  }
+
+  if (_config.PreserveIncludes() && !_provenance.includeXml.empty() &&
+      _provenance.includeHash == _elem.Hash())
+  {
+    _buffer += _prefix;
+    _buffer += _provenance.includeXml;
+    _buffer += '\n';
+    return true;
+  }
+  return false;
 }
 
-void Element::PrintValuesImpl(const std::string &_prefix,
-                              std::ostringstream &_out) const
+/////////////////////////////////////////////////
+/// \brief Print the start of the start tag of an element, up to and
+/// including its attributes, which is shared by all the printers of
+/// element values.
+/// \param[in] _name Name of the element.
+/// \param[in] _content Content of the element.
+/// \param[in] _prefix Prefix of the element.
+/// \param[in,out] _buffer String to append the output to.
+static void appendTagAttributes(const std::string &_name,
+                                const ElementPrivate &_content,
+                                const std::string &_prefix,
+                                std::string &_buffer)
 {
-  _out << _prefix << "<" << this->dataPtr->name;
+  _buffer += _prefix;
+  _buffer += '<';
+  _buffer += _name;
 
-  Param_V::const_iterator aiter;
-  for (aiter = this->dataPtr->attributes.begin();
-       aiter != this->dataPtr->attributes.end(); ++aiter)
+  for (const ParamPtr &attribute : _content.attributes)
   {
     // Only print attribute values if they were set
-    // TODO(anyone): GetRequired is added here to support up-conversions where a
-    // new required attribute with a default value is added. We would have
-    // better separation of concerns if the conversion process set the required
-    // attributes with their default values.
-    if ((*aiter)->GetSet() || (*aiter)->GetRequired())
+    // TODO(anyone): GetRequired is added here to support up-conversions
+    // where a new required attribute with a default value is added. We
+    // would have better separation of concerns if the conversion process
+    // set the required attributes with their default values.
+    if (attribute->GetSet() || attribute->GetRequired())
     {
-      _out << " " << (*aiter)->GetKey() << "='"
-           << (*aiter)->GetAsString() << "'";
+      _buffer += ' ';
+      _buffer += attribute->GetKey();
+      _buffer += "='";
+      attribute->AppendAsString(_buffer);
+      _buffer += '\'';
     }
   }
+}
+
+/////////////////////////////////////////////////
+/// \brief Print the start tag of an element, or the whole element if it
+/// has no child elements.
+/// \param[in] _name Name of the element.
+/// \param[in] _content Content of the element.
+/// \param[in] _prefix Prefix of the element.
+/// \param[in,out] _buffer String to append the output to.
+/// \return True if the element has child elements.
+static bool appendStartTag(const std::string &_name,
+                           const ElementPrivate &_content,
+                           const std::string &_prefix, std::string &_buffer)
+{
+  appendTagAttributes(_name, _content, _prefix, _buffer);
 
-  if (this->dataPtr->elements.size() > 0)
+  if (!_content.elements.empty())
   {
-    _out << ">\n";
-    ElementPtr_V::const_iterator eiter;
-    for (eiter = this->dataPtr->elements.begin();
-         eiter != this->dataPtr->elements.end(); ++eiter)
-    {
-      (*eiter)->ToString(_prefix + "  ", _out);
-    }
-    _out << _prefix << "</" << this->dataPtr->name << ">\n";
+    _buffer += ">\n";
+    return true;
+  }
+
+  if (_content.value)
+  {
+    _buffer += '>';
+    _content.value->AppendAsString(_buffer);
+    _buffer += "</";
+    _buffer += _name;
+    _buffer += ">\n";
   }
   else
   {
-    if (this->dataPtr->value)
+    _buffer += "/>\n";
+  }
+  return false;
+}
+
+/////////////////////////////////////////////////
+void Element::AppendStartTag(const std::string &_prefix,
+                             std::string &_buffer) const
+{
+  appendTagAttributes(this->dataPtr->schema->name, this->Content(), _prefix,
+                      _buffer);
+  _buffer += ">\n";
+}
+
+/////////////////////////////////////////////////
+/// \brief Write a buffer of Element::Write to its stream once it is large.
+/// \param[in,out] _buffer The buffer, which is cleared if it is written.
+/// \param[out] _out The stream, or nullptr to keep the whole output in
+/// the buffer.
+static void flushWriteBuffer(std::string &_buffer, std::ostream *_out)
+{
+  if (_out && _buffer.size() >= kWriteBufferSize)
+  {
+    _out->write(_buffer.data(), _buffer.size());
+    _buffer.clear();
+  }
+}
+
+/////////////////////////////////////////////////
+void Element::PrintValuesImpl(const std::string &_prefix,
+                              std::string &_buffer, std::ostream *_out,
+                              const PrintConfig &_config) const
+{
+  // Print the start tag of an element, or the whole element if it has no
+  // child elements, and return whether it has child elements.
+  auto printStartTag = [&_buffer](const Element &_elem,
+                                  const std::string &_elemPrefix)
+  {
+    _elem.ReadDeferredElements();
+    return appendStartTag(_elem.dataPtr->schema->name, _elem.Content(),
+                          _elemPrefix, _buffer);
+  };
+
+  // The tree is printed with an explicit stack of the elements whose
+  // children are being printed, and of the index of their next child,
+  // instead of recursion, so that deeply nested elements do not overflow
+  // the call stack. The prefix is that of the element on top of the stack.
+  std::string prefix = _prefix;
+  std::vector<std::pair<const Element *, std::size_t>> stack;
+  if (printStartTag(*this, prefix))
+    stack.emplace_back(this, 0);
+
+  while (!stack.empty())
+  {
+    const Element *elem = stack.back().first;
+    const ElementPtr_V &children = elem->Content().elements;
+    if (stack.back().second < children.size())
     {
-      _out << ">" << this->dataPtr->value->GetAsString()
-           << "</" << this->dataPtr->name << ">\n";
+      const Element &child = *children[stack.back().second++];
+      prefix += "  ";
+      if (!printInclude(child, provenanceOf(child.dataPtr->provenance),
+                        prefix, _buffer, _config) &&
+          printStartTag(child, prefix))
+      {
+        stack.emplace_back(&child, 0);
+      }
+      else
+      {
+        prefix.resize(prefix.size() - 2);
+      }
     }
     else
     {
-      _out << "/>\n";
+      _buffer += prefix;
+      _buffer += "</";
+      _buffer += elem->dataPtr->schema->name;
+      _buffer += ">\n";
+      stack.pop_back();
+      if (!stack.empty())
+        prefix.resize(prefix.size() - 2);
+    }
+
+    flushWriteBuffer(_buffer, _out);
+  }
+
+  flushWriteBuffer(_buffer, _out);
+}
+
+/////////////////////////////////////////////////
+void Element::PrintValuesParallel(const std::string &_prefix,
+                                  std::string &_buffer, std::ostream *_out,
+                                  const PrintConfig &_config,
+                                  int _depth) const
+{
+  this->ReadDeferredElements();
+  const ElementPrivate &content = this->Content();
+  if (_depth <= 0 || content.elements.empty())
+  {
+    this->PrintValuesImpl(_prefix, _buffer, _out, _config);
+    return;
+  }
+
+  appendStartTag(this->dataPtr->schema->name, content, _prefix, _buffer);
+  const std::string childPrefix = _prefix + "  ";
+  const ElementPtr_V &children = content.elements;
+  if (children.size() < kParallelPrintChildren)
+  {
+    for (const ElementPtr &child : children)
+    {
+      if (!printInclude(*child, provenanceOf(child->dataPtr->provenance),
+                        childPrefix, _buffer, _config))
+      {
+        child->PrintValuesParallel(childPrefix, _buffer, _out, _config,
+                                   _depth - 1);
+      }
+      flushWriteBuffer(_buffer, _out);
+    }
+  }
+  else
+  {
+    // Each child is printed into its own buffer, a batch at a time, and the
+    // buffers are appended in order.
+    PrintConfig childConfig(_config);
+    childConfig.SetThreadCount(1);
+    std::vector<std::string> chunks(
+        std::min(children.size(), kParallelPrintBatch));
+    for (std::size_t start = 0; start < children.size();
+         start += chunks.size())
+    {
+      const std::size_t count =
+          std::min(chunks.size(), children.size() - start);
+      parallelFor(count, _config.ThreadCount(), [&](std::size_t _i)
+      {
+        chunks[_i].clear();
+        children[start + _i]->ToString(childPrefix, chunks[_i], nullptr,
+                                       childConfig);
+      });
+      for (std::size_t i = 0; i < count; ++i)
+      {
+        _buffer += chunks[i];
+        flushWriteBuffer(_buffer, _out);
+      }
     }
   }
+
+  _buffer += _prefix;
+  _buffer += "</";
+  _buffer += this->dataPtr->schema->name;
+  _buffer += ">\n";
+  flushWriteBuffer(_buffer, _out);
 }
 
 /////////////////////////////////////////////////
 void Element::PrintValues(std::string _prefix) const
 {
-  std::ostringstream ss;
-  PrintValuesImpl(_prefix, ss);
-  std::cout << ss.str();
+  std::string buffer;
+  this->PrintValuesImpl(_prefix, buffer, nullptr, PrintConfig());
+  std::cout << buffer;
 }
 
 /////////////////////////////////////////////////
 std::string Element::ToString(const std::string &_prefix) const
 {
-  std::ostringstream out;
-  this->ToString(_prefix, out);
-  return out.str();
+  return this->ToString(_prefix, PrintConfig());
+}
+
+/////////////////////////////////////////////////
+std::string Element::ToString(const std::string &_prefix,
+                              const PrintConfig &_config) const
+{
+  std::string buffer;
+  this->ToString(_prefix, buffer, nullptr, _config);
+  return buffer;
+}
+
+/////////////////////////////////////////////////
+void Element::Write(std::ostream &_out, const std::string &_prefix) const
+{
+  this->Write(_out, _prefix, PrintConfig());
+}
+
+/////////////////////////////////////////////////
+void Element::Write(std::ostream &_out, const std::string &_prefix,
+                    const PrintConfig &_config) const
+{
+  std::string buffer;
+  buffer.reserve(kWriteBufferSize + kWriteBufferSize / 4);
+  this->ToString(_prefix, buffer, &_out, _config);
+  _out.write(buffer.data(), buffer.size());
+}
+
+/////////////////////////////////////////////////
+TreeFootprint Element::MemoryFootprint() const
+{
+  TreeFootprint footprint;
+  std::unordered_set<const ElementPrivate *> counted;
+  this->AddMemoryFootprint(footprint, counted);
+  return footprint;
+}
+
+/////////////////////////////////////////////////
+void Element::Compact()
+{
+  this->Visit(
+      [](const Element &_elem)
+      {
+        ElementPrivate &data = *_elem.dataPtr;
+        data.updateParams.clear();
+        data.updateParams.shrink_to_fit();
+        data.updateParamsGeneration = 0;
+
+        // The children of a copy-on-write clone belong to its source.
+        if (data.copyOnWriteSource ||
+            data.elementsDeferred.load(std::memory_order_acquire))
+        {
+          return false;
+        }
+        data.attributes.shrink_to_fit();
+        data.elements.shrink_to_fit();
+        data.elementIndex.rehash(0);
+        return true;
+      },
+      nullptr);
+}
+
+/////////////////////////////////////////////////
+/// \brief Add bytes to a 64-bit FNV-1a hash.
+/// \param[in,out] _hash The hash.
+/// \param[in] _data The bytes.
+/// \param[in] _size Number of bytes.
+static void hashBytes(uint64_t &_hash, const void *_data,
+    const std::size_t _size)
+{
+  const unsigned char *bytes = static_cast<const unsigned char *>(_data);
+  for (std::size_t i = 0; i < _size; ++i)
+  {
+    _hash ^= bytes[i];
+    _hash *= 1099511628211ull;
+  }
+}
+
+/////////////////////////////////////////////////
+uint64_t Element::Hash() const
+{
+  uint64_t hash = this->dataPtr->hash.load(std::memory_order_acquire);
+  if (hash != 0)
+    return hash;
+
+  // Hash an element whose children have their hash.
+  auto hashNode = [](const Element &_elem)
+  {
+    const ElementPrivate &content = _elem.Content();
+
+    // Names, keys and values are followed by a null character, so that
+    // their concatenation is unambiguous.
+    std::string buffer(_elem.GetName());
+    buffer.push_back('\0');
+    for (const ParamPtr &attribute : content.attributes)
+    {
+      buffer.append(attribute->GetKey());
+      buffer.push_back('\0');
+      attribute->AppendAsString(buffer);
+      buffer.push_back('\0');
+    }
+    if (content.value)
+      content.value->AppendAsString(buffer);
+
+    uint64_t nodeHash = 14695981039346656037ull;
+    hashBytes(nodeHash, buffer.data(), buffer.size());
+    for (const ElementPtr &child : content.elements)
+    {
+      const uint64_t childHash =
+          child->dataPtr->hash.load(std::memory_order_acquire);
+      hashBytes(nodeHash, &childHash, sizeof(childHash));
+    }
+
+    // 0 marks a hash that is not computed.
+    if (nodeHash == 0)
+      nodeHash = 1;
+    _elem.dataPtr->hash.store(nodeHash, std::memory_order_release);
+  };
+
+  // The descendants without hash are hashed first, with an explicit stack
+  // of the elements and of the index of their next child instead of
+  // recursion, so that deeply nested elements do not overflow the call
+  // stack.
+  std::vector<std::pair<const Element *, std::size_t>> stack;
+  this->ReadDeferredElements();
+  stack.emplace_back(this, 0);
+  while (!stack.empty())
+  {
+    const Element *elem = stack.back().first;
+    const ElementPtr_V &children = elem->Content().elements;
+    std::size_t &next = stack.back().second;
+    while (next < children.size() &&
+           children[next]->dataPtr->hash.load(std::memory_order_acquire) != 0)
+    {
+      ++next;
+    }
+
+    if (next < children.size())
+    {
+      const Element *child = children[next].get();
+      child->ReadDeferredElements();
+      stack.emplace_back(child, 0);
+    }
+    else
+    {
+      hashNode(*elem);
+      stack.pop_back();
+    }
+  }
+
+  return this->dataPtr->hash.load(std::memory_order_acquire);
+}
+
+/////////////////////////////////////////////////
+void Element::ResetHash() const
+{
+  // The hash of an element is computed after those of its descendants, so
+  // the ancestors of an element without hash have none either.
+  const Element *elem = this;
+  while (elem && elem->dataPtr->hash.load(std::memory_order_relaxed) != 0)
+  {
+    elem->dataPtr->hash.store(0, std::memory_order_relaxed);
+    elem = parentOf(*elem->dataPtr);
+  }
+}
+
+/////////////////////////////////////////////////
+void Element::AddMemoryFootprint(TreeFootprint &_footprint,
+    std::unordered_set<const ElementPrivate *> &_counted) const
+{
+  ElementFootprint own;
+  own.elementCount = 1;
+  own.bytes = sizeof(Element) + sizeof(ElementPrivate);
+
+  // A provenance record shared with the parent belongs to the parent.
+  const Element *parent = parentOf(*this->dataPtr);
+  const std::shared_ptr<const ElementProvenance> &provenance =
+      this->dataPtr->provenance;
+  if (provenance && (!parent || parent->dataPtr->provenance != provenance))
+  {
+    own.bytes += sizeof(ElementProvenance) + heapBytes(provenance->path) +
+        heapBytes(provenance->originalVersion) +
+        heapBytes(provenance->includeFilename) +
+        heapBytes(provenance->includeXml);
+  }
+
+  // The content of a copy-on-write clone belongs to its source, which may
+  // be shared by other clones in the tree.
+  const ElementPrivate &content = this->Content();
+  const bool countContent = !this->dataPtr->copyOnWriteSource ||
+      _counted.insert(&content).second;
+  bool countElements = countContent;
+  if (countContent)
+  {
+    own.bytes += content.attributes.capacity() * sizeof(ParamPtr) +
+        content.elements.capacity() * sizeof(ElementPtr) +
+        content.elementIndex.bucket_count() * sizeof(void *) +
+        content.elementIndex.size() *
+        (sizeof(std::pair<const std::size_t, std::size_t>) + sizeof(void *));
+
+    for (const ParamPtr &attribute : content.attributes)
+    {
+      ++own.paramCount;
+      own.bytes += attribute->MemoryFootprint();
+    }
+    if (content.value)
+    {
+      ++own.paramCount;
+      own.bytes += content.value->MemoryFootprint();
+    }
+
+    // Deferred elements are counted as their XML, without reading them.
+    if (content.elementsDeferred.load(std::memory_order_acquire))
+    {
+      std::lock_guard<std::recursive_mutex> lock(deferredElementsMutex());
+      if (content.deferredXml)
+      {
+        own.bytes += sizeof(std::string) + heapBytes(*content.deferredXml);
+        countElements = false;
+      }
+    }
+  }
+
+  _footprint.byName[this->dataPtr->schema->name] += own;
+  _footprint.total += own;
+
+  if (countElements)
+  {
+    for (const ElementPtr &child : content.elements)
+      child->AddMemoryFootprint(_footprint, _counted);
+  }
 }
 
 /////////////////////////////////////////////////
-void Element::ToString(const std::string &_prefix,
-                       std::ostringstream &_out) const
+void Element::ToString(const std::string &_prefix, std::string &_buffer,
+                       std::ostream *_out, const PrintConfig &_config) const
 {
-  if (this->dataPtr->includeFilename.empty())
+  if (printInclude(*this, provenanceOf(this->dataPtr->provenance), _prefix,
+                   _buffer, _config))
+  {
+    return;
+  }
+
+  if (_config.ThreadCount() != 1)
   {
-    PrintValuesImpl(_prefix, _out);
+    this->PrintValuesParallel(_prefix, _buffer, _out, _config,
+                              kParallelPrintDepth);
   }
   else
   {
-    _out << _prefix << "<include filename='"
-         << this->dataPtr->includeFilename << "'/>\n";
+    this->PrintValuesImpl(_prefix, _buffer, _out, _config);
   }
 }
 
 /////////////////////////////////////////////////
-bool Element::HasAttribute(const std::string &_key) const
+bool Element::HasAttribute(std::string_view _key) const
 {
-  return this->GetAttribute(_key) != nullptr;
+  return this->SharedAttribute(_key) != nullptr;
 }
 
 /////////////////////////////////////////////////
 bool Element::GetAttributeSet(const std::string &_key) const
 {
   bool result = false;
-  ParamPtr p = this->GetAttribute(_key);
+  ParamPtr p = this->SharedAttribute(_key);
   if (p)
   {
     result = p->GetSet();
@@ -514,11 +1391,20 @@ bool Element::GetAttributeSet(const std::string &_key) const
 }
 
 /////////////////////////////////////////////////
-ParamPtr Element::GetAttribute(const std::string &_key) const
+ParamPtr Element::GetAttribute(std::string_view _key) const
 {
+  this->CopySharedContent();
+  this->ResetHash();
+  return this->SharedAttribute(_key);
+}
+
+/////////////////////////////////////////////////
+ParamPtr Element::SharedAttribute(std::string_view _key) const
+{
+  const ElementPrivate &content = this->Content();
   Param_V::const_iterator iter;
-  for (iter = this->dataPtr->attributes.begin();
-      iter != this->dataPtr->attributes.end(); ++iter)
+  for (iter = content.attributes.begin();
+      iter != content.attributes.end(); ++iter)
   {
     if ((*iter)->GetKey() == _key)
     {
@@ -531,12 +1417,14 @@ ParamPtr Element::GetAttribute(const std::string &_key) const
 /////////////////////////////////////////////////
 size_t Element::GetAttributeCount() const
 {
-  return this->dataPtr->attributes.size();
+  return this->Content().attributes.size();
 }
 
 /////////////////////////////////////////////////
 ParamPtr Element::GetAttribute(unsigned int _index) const
 {
+  this->CopySharedContent();
+  this->ResetHash();
   ParamPtr result;
   if (_index < this->dataPtr->attributes.size())
   {
@@ -549,26 +1437,34 @@ ParamPtr Element::GetAttribute(unsigned int _index) const
 /////////////////////////////////////////////////
 size_t Element::GetElementDescriptionCount() const
 {
-  return this->dataPtr->elementDescriptions.size();
+  return this->dataPtr->schema->elementDescriptions.size();
 }
 
 /////////////////////////////////////////////////
 ElementPtr Element::GetElementDescription(unsigned int _index) const
 {
   ElementPtr result;
-  if (_index < this->dataPtr->elementDescriptions.size())
+  if (_index < this->dataPtr->schema->elementDescriptions.size())
   {
-    result = this->dataPtr->elementDescriptions[_index];
+    result = this->dataPtr->schema->elementDescriptions[_index];
   }
   return result;
 }
 
 /////////////////////////////////////////////////
-ElementPtr Element::GetElementDescription(const std::string &_key) const
+ElementPtr Element::GetElementDescription(std::string_view _key) const
 {
+  const ElementSchema &schema = *this->dataPtr->schema;
+  const std::size_t pos = findIndexedElement(schema.elementDescriptionIndex,
+      schema.elementDescriptions, _key);
+  if (pos < schema.elementDescriptions.size())
+    return schema.elementDescriptions[pos];
+
+  // A description may have been renamed after it was added, so fall back
+  // to searching all of them.
   ElementPtr_V::const_iterator iter;
-  for (iter = this->dataPtr->elementDescriptions.begin();
-       iter != this->dataPtr->elementDescriptions.end(); ++iter)
+  for (iter = this->dataPtr->schema->elementDescriptions.begin();
+       iter != this->dataPtr->schema->elementDescriptions.end(); ++iter)
   {
     if ((*iter)->GetName() == _key)
     {
@@ -582,21 +1478,47 @@ ElementPtr Element::GetElementDescription(const std::string &_key) const
 /////////////////////////////////////////////////
 ParamPtr Element::GetValue() const
 {
+  this->CopySharedContent();
+  this->ResetHash();
   return this->dataPtr->value;
 }
 
 /////////////////////////////////////////////////
-bool Element::HasElement(const std::string &_name) const
+ParamPtr Element::SharedValue() const
+{
+  return this->Content().value;
+}
+
+/////////////////////////////////////////////////
+bool Element::HasElement(std::string_view _name) const
 {
-  return this->GetElementImpl(_name) != ElementPtr();
+  return this->SharedElement(_name) != ElementPtr();
 }
 
 /////////////////////////////////////////////////
 ElementPtr Element::GetElementImpl(const std::string &_name) const
 {
+  this->CopySharedContent();
+  return this->SharedElement(_name);
+}
+
+/////////////////////////////////////////////////
+ElementPtr Element::SharedElement(std::string_view _name) const
+{
+  this->ReadDeferredElements();
+  const ElementPrivate &content = this->Content();
+  if (!content.elementIndex.empty())
+  {
+    const std::size_t pos =
+        findIndexedElement(content.elementIndex, content.elements, _name);
+    if (pos == content.elements.size())
+      return ElementPtr();
+    return content.elements[pos];
+  }
+
   ElementPtr_V::const_iterator iter;
-  for (iter = this->dataPtr->elements.begin();
-       iter != this->dataPtr->elements.end(); ++iter)
+  for (iter = content.elements.begin();
+       iter != content.elements.end(); ++iter)
   {
     if ((*iter)->GetName() == _name)
     {
@@ -607,9 +1529,33 @@ ElementPtr Element::GetElementImpl(const std::string &_name) const
   return ElementPtr();
 }
 
+/////////////////////////////////////////////////
+bool Element::ResolveParam(const std::string &_key, ParamPtr &_param) const
+{
+  if (_key.empty())
+  {
+    _param = this->SharedValue();
+    return _param != nullptr;
+  }
+
+  _param = this->SharedAttribute(_key);
+  if (_param)
+    return true;
+
+  ElementPtr elem = this->SharedElement(_key);
+  if (!elem)
+    elem = this->GetElementDescription(_key);
+  if (!elem)
+    return false;
+  _param = elem->SharedValue();
+  return true;
+}
+
 /////////////////////////////////////////////////
 ElementPtr Element::GetFirstElement() const
 {
+  this->CopySharedContent();
+  this->ReadDeferredElements();
   if (this->dataPtr->elements.empty())
   {
     return ElementPtr();
@@ -623,12 +1569,12 @@ ElementPtr Element::GetFirstElement() const
 /////////////////////////////////////////////////
 ElementPtr Element::GetNextElement(const std::string &_name) const
 {
-  auto parent = this->dataPtr->parent.lock();
+  const Element *parent = parentOf(*this->dataPtr);
   if (parent)
   {
-    ElementPtr_V::const_iterator iter;
-    iter = std::find(parent->dataPtr->elements.begin(),
-        parent->dataPtr->elements.end(), shared_from_this());
+    ElementPtr_V::const_iterator iter = std::find_if(
+        parent->dataPtr->elements.begin(), parent->dataPtr->elements.end(),
+        [this](const ElementPtr &_elem) {return _elem.get() == this;});
 
     if (iter == parent->dataPtr->elements.end())
     {
@@ -660,29 +1606,162 @@ ElementPtr Element::GetNextElement(const std::string &_name) const
 }
 
 /////////////////////////////////////////////////
-std::set<std::string> Element::GetElementTypeNames() const
+Element::ChildRange Element::Children(const std::string &_name) const
 {
-  std::set<std::string> result;
-  auto elem = this->GetFirstElement();
-  while (elem)
+  this->CopySharedContent();
+  this->ReadDeferredElements();
+  return ChildRange(
+      std::const_pointer_cast<Element>(this->shared_from_this()), _name);
+}
+
+/////////////////////////////////////////////////
+Element::ChildRange::ChildRange(ElementPtr _parent, const std::string &_name)
+  : parent(std::move(_parent)), name(_name)
+{
+}
+
+/////////////////////////////////////////////////
+Element::ChildRange::Iterator Element::ChildRange::begin() const
+{
+  return Iterator(&this->parent->dataPtr->elements, 0, this->name);
+}
+
+/////////////////////////////////////////////////
+Element::ChildRange::Iterator Element::ChildRange::end() const
+{
+  const ElementPtr_V &elements = this->parent->dataPtr->elements;
+  return Iterator(&elements, elements.size(), this->name);
+}
+
+/////////////////////////////////////////////////
+bool Element::ChildRange::Empty() const
+{
+  return this->begin() == this->end();
+}
+
+/////////////////////////////////////////////////
+Element::ChildRange::Iterator::Iterator(const ElementPtr_V *_elements,
+    std::size_t _index, InternedString _name)
+  : elements(_elements), index(_index), name(_name)
+{
+  this->SkipOtherNames();
+}
+
+/////////////////////////////////////////////////
+const ElementPtr &Element::ChildRange::Iterator::operator*() const
+{
+  return (*this->elements)[this->index];
+}
+
+/////////////////////////////////////////////////
+const ElementPtr *Element::ChildRange::Iterator::operator->() const
+{
+  return &(*this->elements)[this->index];
+}
+
+/////////////////////////////////////////////////
+Element::ChildRange::Iterator &Element::ChildRange::Iterator::operator++()
+{
+  ++this->index;
+  this->SkipOtherNames();
+  return *this;
+}
+
+/////////////////////////////////////////////////
+Element::ChildRange::Iterator Element::ChildRange::Iterator::operator++(int)
+{
+  Iterator result = *this;
+  ++(*this);
+  return result;
+}
+
+/////////////////////////////////////////////////
+bool Element::ChildRange::Iterator::operator==(const Iterator &_other) const
+{
+  return this->index == _other.index;
+}
+
+/////////////////////////////////////////////////
+bool Element::ChildRange::Iterator::operator!=(const Iterator &_other) const
+{
+  return this->index != _other.index;
+}
+
+/////////////////////////////////////////////////
+void Element::ChildRange::Iterator::SkipOtherNames()
+{
+  if (this->name.Empty())
+    return;
+
+  const std::size_t size = this->elements->size();
+  while (this->index < size &&
+         (*this->elements)[this->index]->dataPtr->schema->name != this->name)
   {
-    std::string typeName = elem->GetName();
-    result.insert(typeName);
-    elem = elem->GetNextElement();
+    ++this->index;
   }
+}
+
+/////////////////////////////////////////////////
+void Element::Visit(const std::function<bool(const Element &)> &_preOrder,
+    const std::function<void(const Element &)> &_postOrder) const
+{
+  // The tree is walked with an explicit stack of the elements whose
+  // children are being visited, and of the index of their next child,
+  // instead of recursion, so that deeply nested elements do not overflow
+  // the call stack. Elements whose descendants are skipped have no
+  // children to visit.
+  auto enter = [&_preOrder](const Element &_elem)
+  {
+    const bool visitChildren = !_preOrder || _preOrder(_elem);
+    if (visitChildren)
+      _elem.ReadDeferredElements();
+    return visitChildren;
+  };
+
+  std::vector<std::pair<const Element *, std::size_t>> stack;
+  stack.emplace_back(this, enter(*this) ? 0 : SIZE_MAX);
+  while (!stack.empty())
+  {
+    const Element *elem = stack.back().first;
+    std::size_t &next = stack.back().second;
+    if (next != SIZE_MAX && next < elem->Content().elements.size())
+    {
+      const Element *child = elem->Content().elements[next++].get();
+      stack.emplace_back(child, enter(*child) ? 0 : SIZE_MAX);
+    }
+    else
+    {
+      stack.pop_back();
+      if (_postOrder)
+        _postOrder(*elem);
+    }
+  }
+}
+
+/////////////////////////////////////////////////
+std::set<std::string> Element::GetElementTypeNames() const
+{
+  std::set<std::string> result;
+  this->ReadDeferredElements();
+  for (const ElementPtr &elem : this->Content().elements)
+    result.insert(elem->GetName());
   return result;
 }
 
 /////////////////////////////////////////////////
 bool Element::HasUniqueChildNames(const std::string &_type) const
 {
-  auto namedElementsCount = this->CountNamedElements(_type);
-  for (auto &iter : namedElementsCount)
+  // Unlike CountNamedElements, stop at the first duplicate.
+  std::unordered_set<std::string> names;
+  this->ReadDeferredElements();
+  for (const ElementPtr &elem : this->Content().elements)
   {
-    if (iter.second > 1)
-    {
+    if (!_type.empty() && elem->GetName() != _type)
+      continue;
+
+    ParamPtr name = elem->SharedAttribute("name");
+    if (name && !names.insert(name->GetAsString()).second)
       return false;
-    }
   }
   return true;
 }
@@ -692,36 +1771,15 @@ std::map<std::string, std::size_t>
 Element::CountNamedElements(const std::string &_type) const
 {
   std::map<std::string, std::size_t> result;
-
-  sdf::ElementPtr elem;
-  if (_type.empty())
-  {
-    elem = this->GetFirstElement();
-  }
-  else
+  this->ReadDeferredElements();
+  for (const ElementPtr &elem : this->Content().elements)
   {
-    elem = this->GetElementImpl(_type);
-  }
+    if (!_type.empty() && elem->GetName() != _type)
+      continue;
 
-  while (elem)
-  {
-    if (elem->HasAttribute("name"))
-    {
-      // Get("name") returns attribute value if it exists before checking
-      // for the value of a child element <name>, so it's safe to use
-      // here since we've checked HasAttribute("name").
-      std::string childNameAttributeValue = elem->Get<std::string>("name");
-      if (result.find(childNameAttributeValue) == result.end())
-      {
-        result[childNameAttributeValue] = 1;
-      }
-      else
-      {
-        ++result[childNameAttributeValue];
-      }
-    }
-
-    elem = elem->GetNextElement(_type);
+    ParamPtr name = elem->SharedAttribute("name");
+    if (name)
+      ++result[name->GetAsString()];
   }
 
   return result;
@@ -739,14 +1797,25 @@ ElementPtr Element::GetElement(const std::string &_name)
   return result;
 }
 
+/////////////////////////////////////////////////
+ElementPtr Element::FindElement(const std::string &_name) const
+{
+  return this->GetElementImpl(_name);
+}
+
 /////////////////////////////////////////////////
 void Element::InsertElement(ElementPtr _elem)
 {
+  this->CopySharedContent();
+  this->ReadDeferredElements();
   this->dataPtr->elements.push_back(_elem);
+  this->IndexLastElement();
+  advanceParamUpdateGeneration();
+  this->ResetHash();
 }
 
 /////////////////////////////////////////////////
-bool Element::HasElementDescription(const std::string &_name) const
+bool Element::HasElementDescription(std::string_view _name) const
 {
   return this->GetElementDescription(_name) != ElementPtr();
 }
@@ -754,43 +1823,45 @@ bool Element::HasElementDescription(const std::string &_name) const
 /////////////////////////////////////////////////
 ElementPtr Element::AddElement(const std::string &_name)
 {
+  this->CopySharedContent();
+  this->ReadDeferredElements();
+
   // if this element is a reference sdf and does not have any element
   // descriptions then get them from its parent
-  auto parent = this->dataPtr->parent.lock();
-  if (!this->dataPtr->referenceSDF.empty() &&
-      this->dataPtr->elementDescriptions.empty() && parent &&
-      parent->GetName() == this->dataPtr->name)
+  const Element *parent = parentOf(*this->dataPtr);
+  if (!this->dataPtr->schema->referenceSDF.empty() &&
+      this->dataPtr->schema->elementDescriptions.empty() && parent &&
+      parent->GetName() == this->dataPtr->schema->name)
   {
-    for (unsigned int i = 0; i < parent->GetElementDescriptionCount(); ++i)
-    {
-      this->dataPtr->elementDescriptions.push_back(
-          parent->GetElementDescription(i)->Clone());
-    }
+    ElementSchema &schema = this->MutableSchema();
+    schema.elementDescriptions = parent->dataPtr->schema->elementDescriptions;
+    schema.elementDescriptionIndex =
+        parent->dataPtr->schema->elementDescriptionIndex;
   }
 
-  ElementPtr_V::const_iterator iter, iter2;
-  for (iter = this->dataPtr->elementDescriptions.begin();
-      iter != this->dataPtr->elementDescriptions.end(); ++iter)
+  // Instances share the schema of their description, so that only the
+  // attributes and value of the description are copied.
+  ElementPtr desc = this->GetElementDescription(_name);
+  if (desc)
   {
-    if ((*iter)->dataPtr->name == _name)
-    {
-      ElementPtr elem = (*iter)->Clone();
-      elem->SetParent(shared_from_this());
-      this->dataPtr->elements.push_back(elem);
+    this->ResetHash();
+    ElementPtr elem = desc->Clone();
+    elem->SetParent(shared_from_this());
+    this->dataPtr->elements.push_back(elem);
+    this->IndexLastElement();
 
-      // Add all child elements.
-      for (iter2 = elem->dataPtr->elementDescriptions.begin();
-           iter2 != elem->dataPtr->elementDescriptions.end(); ++iter2)
+    // Add only required child elements. Optional ones are added when they
+    // are read or requested through GetElement.
+    for (const ElementPtr &childDesc :
+         elem->dataPtr->schema->elementDescriptions)
+    {
+      if (childDesc->GetRequired() == "1")
       {
-        // Add only required child element
-        if ((*iter2)->GetRequired() == "1")
-        {
-          elem->AddElement((*iter2)->dataPtr->name);
-        }
+        elem->AddElement(childDesc->dataPtr->schema->name);
       }
-
-      return this->dataPtr->elements.back();
     }
+
+    return elem;
   }
 
   sdferr << "Missing element description for [" << _name << "]\n";
@@ -801,46 +1872,92 @@ ElementPtr Element::AddElement(const std::string &_name)
 void Element::Clear()
 {
   this->ClearElements();
-  this->dataPtr->originalVersion.clear();
-  this->dataPtr->path.clear();
+  ElementProvenance provenance = provenanceOf(this->dataPtr->provenance);
+  provenance.path.clear();
+  provenance.originalVersion.clear();
+  const Element *parent = parentOf(*this->dataPtr);
+  setProvenance(this->dataPtr->provenance,
+      parent ? parent->dataPtr->provenance : nullptr, std::move(provenance));
 }
 
 /////////////////////////////////////////////////
 void Element::ClearElements()
 {
-  for (sdf::ElementPtr_V::iterator iter = this->dataPtr->elements.begin();
-      iter != this->dataPtr->elements.end(); ++iter)
+  // The descendants are cleared with an explicit stack instead of
+  // recursion, so that destroying deeply nested elements does not
+  // overflow the call stack. Each element is destroyed after its children
+  // are moved to the stack.
+  this->CopySharedContent(false);
+  ElementPtr_V stack;
+  stack.swap(this->dataPtr->elements);
+  while (!stack.empty())
   {
-    (*iter)->ClearElements();
+    const ElementPtr elem = std::move(stack.back());
+    stack.pop_back();
+    elem->CopySharedContent(false);
+    for (ElementPtr &child : elem->dataPtr->elements)
+      stack.push_back(std::move(child));
+    elem->dataPtr->elements.clear();
+    elem->dataPtr->elementIndex.clear();
+    elem->ResetHash();
   }
 
-  this->dataPtr->elements.clear();
+  this->dataPtr->elementIndex.clear();
+  advanceParamUpdateGeneration();
+  this->ResetHash();
 }
 
 /////////////////////////////////////////////////
 void Element::Update()
 {
-  for (sdf::Param_V::iterator iter = this->dataPtr->attributes.begin();
-      iter != this->dataPtr->attributes.end(); ++iter)
+  // Walk the tree only when an update function was set or a tree was
+  // modified since the parameters were collected.
+  if (this->dataPtr->updateParamsGeneration != paramUpdateGeneration())
   {
-    (*iter)->Update();
+    std::vector<ParamPtr> params;
+    this->CollectUpdateParams(params);
+    this->dataPtr->updateParams = std::move(params);
+    this->dataPtr->updateParamsGeneration = paramUpdateGeneration();
   }
 
-  for (sdf::ElementPtr_V::iterator iter = this->dataPtr->elements.begin();
-      iter != this->dataPtr->elements.end(); ++iter)
-  {
-    (*iter)->Update();
-  }
+  if (this->dataPtr->updateParams.empty())
+    return;
 
-  if (this->dataPtr->value)
+  for (const ParamPtr &param : this->dataPtr->updateParams)
+    param->Update();
+
+  // The updated parameters may belong to any element of the tree.
+  this->Visit([](const Element &_elem)
+      {
+        _elem.dataPtr->hash = 0;
+        return true;
+      });
+  this->ResetHash();
+}
+
+/////////////////////////////////////////////////
+void Element::CollectUpdateParams(std::vector<ParamPtr> &_params)
+{
+  this->CopySharedContent();
+  this->ReadDeferredElements();
+  for (const ParamPtr &attribute : this->dataPtr->attributes)
   {
-    this->dataPtr->value->Update();
+    if (attribute->HasUpdateFunc())
+      _params.push_back(attribute);
   }
+
+  for (const ElementPtr &child : this->dataPtr->elements)
+    child->CollectUpdateParams(_params);
+
+  if (this->dataPtr->value && this->dataPtr->value->HasUpdateFunc())
+    _params.push_back(this->dataPtr->value);
 }
 
 /////////////////////////////////////////////////
 void Element::Reset()
 {
+  this->ResetHash();
+  this->CopySharedContent(false);
   for (ElementPtr_V::iterator iter = this->dataPtr->elements.begin();
       iter != this->dataPtr->elements.end(); ++iter)
   {
@@ -851,91 +1968,123 @@ void Element::Reset()
     (*iter).reset();
   }
 
-  for (ElementPtr_V::iterator iter = this->dataPtr->elementDescriptions.begin();
-      iter != this->dataPtr->elementDescriptions.end(); ++iter)
-  {
-    if (*iter)
-    {
-      (*iter)->Reset();
-    }
-    (*iter).reset();
-  }
+  // The element descriptions may be shared with other elements, so only
+  // drop this element's references to them.
   this->dataPtr->elements.clear();
-  this->dataPtr->elementDescriptions.clear();
+  this->dataPtr->elementIndex.clear();
+  ElementSchema &schema = this->MutableSchema();
+  schema.elementDescriptions.clear();
+  schema.elementDescriptionIndex.clear();
 
   this->dataPtr->value.reset();
 
   this->dataPtr->parent.reset();
+  this->dataPtr->parentElement = nullptr;
+  advanceParamUpdateGeneration();
 }
 
 /////////////////////////////////////////////////
 void Element::AddElementDescription(ElementPtr _elem)
 {
-  this->dataPtr->elementDescriptions.push_back(_elem);
+  ElementSchema &schema = this->MutableSchema();
+  schema.elementDescriptions.push_back(_elem);
+  indexElement(schema.elementDescriptionIndex, schema.elementDescriptions,
+      schema.elementDescriptions.size() - 1);
 }
 
 /////////////////////////////////////////////////
 void Element::SetInclude(const std::string &_filename)
 {
-  this->dataPtr->includeFilename = _filename;
+  ElementProvenance provenance = provenanceOf(this->dataPtr->provenance);
+  provenance.includeFilename = _filename;
+  const Element *parent = parentOf(*this->dataPtr);
+  setProvenance(this->dataPtr->provenance,
+      parent ? parent->dataPtr->provenance : nullptr, std::move(provenance));
 }
 
 /////////////////////////////////////////////////
 std::string Element::GetInclude() const
 {
-  return this->dataPtr->includeFilename;
+  return provenanceOf(this->dataPtr->provenance).includeFilename;
+}
+
+/////////////////////////////////////////////////
+void Element::SetIncludeXml(const std::string &_xml)
+{
+  ElementProvenance provenance = provenanceOf(this->dataPtr->provenance);
+  provenance.includeXml = _xml;
+  provenance.includeHash = _xml.empty() ? 0 : this->Hash();
+  const Element *parent = parentOf(*this->dataPtr);
+  setProvenance(this->dataPtr->provenance,
+      parent ? parent->dataPtr->provenance : nullptr, std::move(provenance));
+}
+
+/////////////////////////////////////////////////
+const std::string &Element::IncludeXml() const
+{
+  return provenanceOf(this->dataPtr->provenance).includeXml;
 }
 
 /////////////////////////////////////////////////
 void Element::SetFilePath(const std::string &_path)
 {
-  this->dataPtr->path = _path;
+  ElementProvenance provenance = provenanceOf(this->dataPtr->provenance);
+  provenance.path = _path;
+  const Element *parent = parentOf(*this->dataPtr);
+  setProvenance(this->dataPtr->provenance,
+      parent ? parent->dataPtr->provenance : nullptr, std::move(provenance));
 }
 
 /////////////////////////////////////////////////
 const std::string &Element::FilePath() const
 {
-  return this->dataPtr->path;
+  return provenanceOf(this->dataPtr->provenance).path;
 }
 
 /////////////////////////////////////////////////
 void Element::SetOriginalVersion(const std::string &_version)
 {
-  this->dataPtr->originalVersion = _version;
+  ElementProvenance provenance = provenanceOf(this->dataPtr->provenance);
+  provenance.originalVersion = _version;
+  const Element *parent = parentOf(*this->dataPtr);
+  setProvenance(this->dataPtr->provenance,
+      parent ? parent->dataPtr->provenance : nullptr, std::move(provenance));
 }
 
 /////////////////////////////////////////////////
 const std::string &Element::OriginalVersion() const
 {
-  return this->dataPtr->originalVersion;
+  return provenanceOf(this->dataPtr->provenance).originalVersion;
 }
 
 /////////////////////////////////////////////////
 std::string Element::GetDescription() const
 {
-  return this->dataPtr->description;
+  return this->dataPtr->schema->description;
 }
 
 /////////////////////////////////////////////////
 void Element::SetDescription(const std::string &_desc)
 {
-  this->dataPtr->description = _desc;
+  this->MutableSchema().description = _desc;
 }
 
 /////////////////////////////////////////////////
 void Element::RemoveFromParent()
 {
-  auto parent = this->dataPtr->parent.lock();
+  Element *parent = parentOf(*this->dataPtr);
   if (parent)
   {
-    ElementPtr_V::iterator iter;
-    iter = std::find(parent->dataPtr->elements.begin(),
-        parent->dataPtr->elements.end(), shared_from_this());
+    ElementPtr_V::iterator iter = std::find_if(
+        parent->dataPtr->elements.begin(), parent->dataPtr->elements.end(),
+        [this](const ElementPtr &_elem) {return _elem.get() == this;});
 
     if (iter != parent->dataPtr->elements.end())
     {
       parent->dataPtr->elements.erase(iter);
-      parent.reset();
+      parent->RebuildElementIndex();
+      parent->ResetHash();
+      advanceParamUpdateGeneration();
     }
   }
 }
@@ -944,6 +2093,8 @@ void Element::RemoveFromParent()
 void Element::RemoveChild(ElementPtr _child)
 {
   SDF_ASSERT(_child, "Cannot remove a nullptr child pointer");
+  this->CopySharedContent();
+  this->ReadDeferredElements();
 
   ElementPtr_V::iterator iter;
   iter = std::find(this->dataPtr->elements.begin(),
@@ -953,6 +2104,9 @@ void Element::RemoveChild(ElementPtr _child)
   {
     _child->SetParent(ElementPtr());
     this->dataPtr->elements.erase(iter);
+    this->RebuildElementIndex();
+    this->ResetHash();
+    advanceParamUpdateGeneration();
   }
 }
 
@@ -960,9 +2114,10 @@ void Element::RemoveChild(ElementPtr _child)
 std::any Element::GetAny(const std::string &_key) const
 {
   std::any result;
-  if (_key.empty() && this->dataPtr->value)
+  ParamPtr value = this->SharedValue();
+  if (_key.empty() && value)
   {
-    if (!this->dataPtr->value->GetAny(result))
+    if (!value->GetAny(result))
     {
       sdferr << "Couldn't get element [" << this->GetName()
              << "] as std::any\n";
@@ -970,17 +2125,17 @@ std::any Element::GetAny(const std::string &_key) const
   }
   else if (!_key.empty())
   {
-    ParamPtr param = this->GetAttribute(_key);
+    ParamPtr param = this->SharedAttribute(_key);
     if (param)
     {
-      if (!this->GetAttribute(_key)->GetAny(result))
+      if (!param->GetAny(result))
       {
         sdferr << "Couldn't get attribute [" << _key << "] as std::any\n";
       }
     }
     else
     {
-      ElementPtr tmp = this->GetElementImpl(_key);
+      ElementPtr tmp = this->SharedElement(_key);
       if (tmp != ElementPtr())
       {
         result = tmp->GetAny();
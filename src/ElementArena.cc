@@ -0,0 +1,156 @@
+/*
+ * Copyright 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#include <algorithm>
+#include <cstddef>
+#include <new>
+
+#include "ElementArena.hh"
+
+using namespace sdf;
+
+/// \brief Size of the header in front of each allocation, which holds the
+/// arena that the allocation comes from. It keeps the allocations aligned
+/// for any type.
+static const std::size_t kHeaderSize = alignof(std::max_align_t);
+
+/// \brief Size of the blocks that an arena takes from the heap.
+static const std::size_t kBlockSize = 64 * 1024;
+
+/// \brief Arena of the calling thread.
+static thread_local ElementArena *g_currentArena = nullptr;
+
+/////////////////////////////////////////////////
+ElementArena::ElementArena()
+{
+}
+
+/////////////////////////////////////////////////
+ElementArena::~ElementArena()
+{
+}
+
+/////////////////////////////////////////////////
+void ElementArena::Release()
+{
+  this->Unref();
+}
+
+/////////////////////////////////////////////////
+void ElementArena::Unref()
+{
+  if (this->refCount.fetch_sub(1, std::memory_order_acq_rel) == 1)
+    delete this;
+}
+
+/////////////////////////////////////////////////
+ElementArena *ElementArena::Current()
+{
+  return g_currentArena;
+}
+
+/////////////////////////////////////////////////
+std::size_t ElementArena::Capacity() const
+{
+  return this->capacity;
+}
+
+/////////////////////////////////////////////////
+char *ElementArena::AllocateBytes(std::size_t _size)
+{
+  _size = (_size + kHeaderSize - 1) / kHeaderSize * kHeaderSize;
+  if (static_cast<std::size_t>(this->end - this->next) < _size)
+  {
+    // Large objects get a block of their own, so that the rest of the
+    // current block is not wasted.
+    const std::size_t blockSize = std::max(_size, kBlockSize);
+    this->blocks.emplace_back(new char[blockSize]);
+    this->capacity += blockSize;
+    char *block = this->blocks.back().get();
+    if (_size >= kBlockSize)
+      return block;
+
+    this->next = block;
+    this->end = block + blockSize;
+  }
+
+  char *result = this->next;
+  this->next += _size;
+  return result;
+}
+
+/////////////////////////////////////////////////
+void *ElementArena::Allocate(const std::size_t _size)
+{
+  ElementArena *arena = g_currentArena;
+  char *memory = nullptr;
+  if (arena)
+  {
+    memory = arena->AllocateBytes(kHeaderSize + _size);
+    arena->refCount.fetch_add(1, std::memory_order_relaxed);
+  }
+  else
+  {
+    memory = static_cast<char *>(::operator new(kHeaderSize + _size));
+  }
+
+  *reinterpret_cast<ElementArena **>(memory) = arena;
+  return memory + kHeaderSize;
+}
+
+/////////////////////////////////////////////////
+void ElementArena::Deallocate(void *_ptr)
+{
+  if (!_ptr)
+    return;
+
+  char *memory = static_cast<char *>(_ptr) - kHeaderSize;
+  ElementArena *arena = *reinterpret_cast<ElementArena **>(memory);
+  if (arena)
+    arena->Unref();
+  else
+    ::operator delete(memory);
+}
+
+/////////////////////////////////////////////////
+ScopedElementArena::ScopedElementArena(const bool _enable)
+  : previous(g_currentArena)
+{
+  if (!_enable)
+  {
+    g_currentArena = nullptr;
+  }
+  else if (!g_currentArena)
+  {
+    this->created = new ElementArena;
+    g_currentArena = this->created;
+  }
+}
+
+/////////////////////////////////////////////////
+ScopedElementArena::ScopedElementArena(ElementArena *_arena)
+  : previous(g_currentArena)
+{
+  g_currentArena = _arena;
+}
+
+/////////////////////////////////////////////////
+ScopedElementArena::~ScopedElementArena()
+{
+  g_currentArena = this->previous;
+  if (this->created)
+    this->created->Release();
+}
@@ -0,0 +1,230 @@
+/*
+ * Copyright 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef SDF_ELEMENTARENA_HH_
+#define SDF_ELEMENTARENA_HH_
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include "sdf/sdf_config.h"
+#include "sdf/system_util.hh"
+
+namespace sdf
+{
+  // Inline bracket to help doxygen filtering.
+  inline namespace SDF_VERSION_NAMESPACE {
+  //
+
+  /// \brief Monotonic memory arena for the Element, ElementPrivate, Param
+  /// and ParamPrivate objects of one element tree.
+  ///
+  /// Those classes allocate themselves through ElementArena::Allocate,
+  /// which takes memory from the arena that is current on the calling
+  /// thread, or from the heap if there is none. Memory of an arena is never
+  /// reused; it is freed in bulk when the arena is released and the last
+  /// object allocated from it is deleted. Objects can therefore outlive the
+  /// parse that created them, like objects allocated from the heap, and can
+  /// be deleted from any thread.
+  ///
+  /// An arena is only allocated from by the thread on which it is current.
+  class SDFORMAT_VISIBLE ElementArena
+  {
+    /// \brief Constructor. The new arena holds one reference, which is
+    /// given up with Release.
+    public: ElementArena();
+
+    /// \brief Copy constructor is explicitly deleted.
+    public: ElementArena(const ElementArena &) = delete;
+
+    /// \brief Copy assignment is explicitly deleted.
+    public: ElementArena &operator=(const ElementArena &) = delete;
+
+    /// \brief Give up the reference that the creator of the arena holds.
+    /// The arena deletes itself once no allocated object is left.
+    public: void Release();
+
+    /// \brief Get the arena that is current on the calling thread.
+    /// \return The arena, or nullptr if objects are allocated from the
+    /// heap.
+    public: static ElementArena *Current();
+
+    /// \brief Allocate memory for an object, from the current arena if
+    /// there is one.
+    /// \param[in] _size Size of the object.
+    /// \return Memory aligned for any object type.
+    /// \throws std::bad_alloc if the memory cannot be allocated.
+    public: static void *Allocate(std::size_t _size);
+
+    /// \brief Free memory returned by Allocate.
+    /// \param[in] _ptr The memory, or nullptr.
+    public: static void Deallocate(void *_ptr);
+
+    /// \brief Get the number of bytes that the arena has taken from the
+    /// heap, which includes the unused end of its blocks.
+    /// \return Number of bytes.
+    public: std::size_t Capacity() const;
+
+    /// \brief Destructor, which frees the blocks of the arena.
+    private: ~ElementArena();
+
+    /// \brief Allocate memory from this arena.
+    /// \param[in] _size Number of bytes, including the header.
+    /// \return The memory.
+    private: char *AllocateBytes(std::size_t _size);
+
+    /// \brief Give up one reference, and delete the arena if it was the
+    /// last one.
+    private: void Unref();
+
+    /// \brief The reference of the creator, plus one per live object.
+    private: std::atomic<std::size_t> refCount{1};
+
+    /// \brief Blocks of memory taken from the heap.
+    private: std::vector<std::unique_ptr<char[]>> blocks;
+
+    /// \brief Next free byte of the last block.
+    private: char *next = nullptr;
+
+    /// \brief End of the last block.
+    private: char *end = nullptr;
+
+    /// \brief Total size of the blocks.
+    private: std::size_t capacity = 0;
+  };
+
+  /// \brief Allocator that allocates from the current arena, like the
+  /// operator new of Element and Param. It is used for the control blocks of
+  /// the shared pointers to them.
+  template<typename T>
+  class ElementArenaAllocator
+  {
+    /// \brief Type of the allocated objects.
+    public: using value_type = T;
+
+    /// \brief Default constructor.
+    public: ElementArenaAllocator() = default;
+
+    /// \brief Converting constructor, used to allocate control blocks.
+    public: template<typename U>
+            ElementArenaAllocator(const ElementArenaAllocator<U> &)
+    {
+    }
+
+    /// \brief Allocate memory for objects.
+    /// \param[in] _count Number of objects.
+    /// \return The memory.
+    public: T *allocate(const std::size_t _count)
+    {
+      return static_cast<T *>(ElementArena::Allocate(_count * sizeof(T)));
+    }
+
+    /// \brief Free memory returned by allocate.
+    /// \param[in] _ptr The memory.
+    public: void deallocate(T *_ptr, std::size_t)
+    {
+      ElementArena::Deallocate(_ptr);
+    }
+  };
+
+  /// \brief All allocators are equal, since memory is freed through the
+  /// header of each allocation.
+  template<typename T, typename U>
+  bool operator==(const ElementArenaAllocator<T> &,
+                  const ElementArenaAllocator<U> &)
+  {
+    return true;
+  }
+
+  /// \brief All allocators are equal.
+  template<typename T, typename U>
+  bool operator!=(const ElementArenaAllocator<T> &,
+                  const ElementArenaAllocator<U> &)
+  {
+    return false;
+  }
+
+  /// \brief Own an object allocated with new by a shared pointer whose
+  /// control block is allocated from the current arena.
+  /// \param[in] _ptr The object.
+  /// \return The shared pointer.
+  template<typename T>
+  std::shared_ptr<T> makeArenaShared(T *_ptr)
+  {
+    return std::shared_ptr<T>(_ptr, std::default_delete<T>(),
+        ElementArenaAllocator<T>());
+  }
+
+  /// \brief Base class of the private data of the DOM objects that a
+  /// document has many of, so that it is allocated from the current arena
+  /// like elements are, instead of one heap allocation each.
+  class ArenaAllocated
+  {
+    /// \brief Allocate memory for the private data.
+    /// \param[in] _size Size of the private data.
+    /// \return The memory.
+    public: static void *operator new(std::size_t _size)
+    {
+      return ElementArena::Allocate(_size);
+    }
+
+    /// \brief Free memory allocated by operator new.
+    /// \param[in] _ptr The memory.
+    public: static void operator delete(void *_ptr)
+    {
+      ElementArena::Deallocate(_ptr);
+    }
+  };
+
+  /// \brief Makes an arena current on the calling thread for its lifetime,
+  /// and restores the previous one when destroyed.
+  class SDFORMAT_VISIBLE ScopedElementArena
+  {
+    /// \brief Constructor.
+    /// \param[in] _enable True to allocate from an arena. If an arena is
+    /// already current, it remains current, so that the documents included
+    /// by a document share its arena. Otherwise a new arena is created,
+    /// which is released when this object is destroyed. False to allocate
+    /// from the heap.
+    public: explicit ScopedElementArena(bool _enable);
+
+    /// \brief Constructor that makes a given arena current, such as the
+    /// arena of the DOM objects of a sdf::Root.
+    /// \param[in] _arena The arena, which must outlive this object, or
+    /// nullptr to allocate from the heap.
+    public: explicit ScopedElementArena(ElementArena *_arena);
+
+    /// \brief Copy constructor is explicitly deleted.
+    public: ScopedElementArena(const ScopedElementArena &) = delete;
+
+    /// \brief Copy assignment is explicitly deleted.
+    public: ScopedElementArena &operator=(const ScopedElementArena &) =
+            delete;
+
+    /// \brief Destructor.
+    public: ~ScopedElementArena();
+
+    /// \brief The arena that was current before this object was created.
+    private: ElementArena *previous = nullptr;
+
+    /// \brief The arena created by this object, if any.
+    private: ElementArena *created = nullptr;
+  };
+  }
+}
+#endif
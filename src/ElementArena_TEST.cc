@@ -0,0 +1,190 @@
+/*
+ * Copyright 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "sdf/Element.hh"
+#include "sdf/Link.hh"
+#include "sdf/Model.hh"
+#include "sdf/ParserConfig.hh"
+#include "sdf/Root.hh"
+#include "sdf/SDFImpl.hh"
+#include "sdf/parser.hh"
+#include "ElementArena.hh"
+
+/////////////////////////////////////////////////
+TEST(ElementArena, Heap)
+{
+  EXPECT_EQ(nullptr, sdf::ElementArena::Current());
+  void *memory = sdf::ElementArena::Allocate(24);
+  ASSERT_NE(nullptr, memory);
+  EXPECT_EQ(0u, reinterpret_cast<std::uintptr_t>(memory) %
+      alignof(std::max_align_t));
+  sdf::ElementArena::Deallocate(memory);
+  sdf::ElementArena::Deallocate(nullptr);
+}
+
+/////////////////////////////////////////////////
+TEST(ElementArena, Scope)
+{
+  void *small = nullptr;
+  void *large = nullptr;
+  {
+    sdf::ScopedElementArena scope(true);
+    sdf::ElementArena *arena = sdf::ElementArena::Current();
+    ASSERT_NE(nullptr, arena);
+    EXPECT_EQ(0u, arena->Capacity());
+
+    small = sdf::ElementArena::Allocate(8);
+    ASSERT_NE(nullptr, small);
+    EXPECT_EQ(0u, reinterpret_cast<std::uintptr_t>(small) %
+        alignof(std::max_align_t));
+    const std::size_t capacity = arena->Capacity();
+    EXPECT_GT(capacity, 0u);
+
+    // Small allocations share a block.
+    void *small2 = sdf::ElementArena::Allocate(8);
+    EXPECT_NE(small, small2);
+    EXPECT_EQ(capacity, arena->Capacity());
+    sdf::ElementArena::Deallocate(small2);
+
+    // Large allocations get a block of their own.
+    large = sdf::ElementArena::Allocate(1024 * 1024);
+    EXPECT_GT(arena->Capacity(), capacity + 1024 * 1024);
+
+    {
+      // A nested arena scope keeps the current arena.
+      sdf::ScopedElementArena nested(true);
+      EXPECT_EQ(arena, sdf::ElementArena::Current());
+    }
+    {
+      // Disabling the arena allocates from the heap.
+      sdf::ScopedElementArena nested(false);
+      EXPECT_EQ(nullptr, sdf::ElementArena::Current());
+    }
+    {
+      // A given arena is made current, even if there is none.
+      sdf::ScopedElementArena nested(nullptr);
+      EXPECT_EQ(nullptr, sdf::ElementArena::Current());
+      sdf::ScopedElementArena given(arena);
+      EXPECT_EQ(arena, sdf::ElementArena::Current());
+    }
+    EXPECT_EQ(arena, sdf::ElementArena::Current());
+  }
+  EXPECT_EQ(nullptr, sdf::ElementArena::Current());
+
+  // The allocations outlive the scope.
+  static_cast<char *>(small)[0] = 'a';
+  static_cast<char *>(large)[1024 * 1024 - 1] = 'b';
+  sdf::ElementArena::Deallocate(large);
+  sdf::ElementArena::Deallocate(small);
+}
+
+/////////////////////////////////////////////////
+TEST(ElementArena, Elements)
+{
+  sdf::ElementPtr root;
+  {
+    sdf::ScopedElementArena scope(true);
+    root = std::make_shared<sdf::Element>();
+    root->SetName("root");
+    root->AddAttribute("name", "string", "default", false);
+    sdf::ElementPtr child = std::make_shared<sdf::Element>();
+    child->SetName("child");
+    child->AddValue("double", "1.5", false);
+    root->InsertElement(child);
+
+    sdf::ElementPtr clone = root->Clone();
+    EXPECT_EQ(root->ToString(""), clone->ToString(""));
+  }
+
+  EXPECT_EQ("child", root->GetFirstElement()->GetName());
+  EXPECT_DOUBLE_EQ(1.5, root->GetFirstElement()->Get<double>());
+
+  sdf::ElementPtr clone = root->Clone();
+  root.reset();
+  EXPECT_EQ("child", clone->GetFirstElement()->GetName());
+}
+
+/////////////////////////////////////////////////
+TEST(ElementArena, ReadString)
+{
+  const std::string sdfString = R"(
+<sdf version='1.8'>
+  <model name='m'>
+    <link name='l'>
+      <pose>1 2 3 0 0 0</pose>
+      <collision name='c'>
+        <geometry><box><size>1 2 3</size></box></geometry>
+      </collision>
+    </link>
+  </model>
+</sdf>)";
+
+  sdf::SDFPtr heapSdf(new sdf::SDF());
+  sdf::init(heapSdf);
+  ASSERT_TRUE(sdf::readString(sdfString, heapSdf));
+
+  sdf::ParserConfig config;
+  config.SetArenaAllocation(true);
+  sdf::SDFPtr arenaSdf(new sdf::SDF());
+  sdf::init(arenaSdf);
+  sdf::Errors errors;
+  ASSERT_TRUE(sdf::readString(sdfString, config, arenaSdf, errors));
+  EXPECT_TRUE(errors.empty());
+  EXPECT_EQ(nullptr, sdf::ElementArena::Current());
+
+  EXPECT_EQ(heapSdf->Root()->ToString(""), arenaSdf->Root()->ToString(""));
+}
+
+/////////////////////////////////////////////////
+TEST(ElementArena, DomObjects)
+{
+  sdf::Link link;
+  {
+    sdf::ScopedElementArena scope(true);
+    sdf::ElementArena *arena = sdf::ElementArena::Current();
+    sdf::Link arenaLink;
+    arenaLink.SetName("arena_link");
+    EXPECT_GT(arena->Capacity(), 0u);
+    link = arenaLink;
+  }
+
+  // Objects allocated from the arena outlive its scope.
+  EXPECT_EQ("arena_link", link.Name());
+
+  const std::string sdfString = R"(
+<sdf version='1.8'>
+  <model name='m'>
+    <link name='l1'/>
+    <link name='l2'/>
+  </model>
+</sdf>)";
+
+  sdf::ParserConfig config;
+  config.SetArenaAllocation(true);
+  sdf::Root root;
+  EXPECT_TRUE(root.LoadSdfString(sdfString, config).empty());
+  EXPECT_EQ(nullptr, sdf::ElementArena::Current());
+  ASSERT_NE(nullptr, root.ModelByIndex(0));
+  EXPECT_EQ(2u, root.ModelByIndex(0)->LinkCount());
+  EXPECT_EQ("l2", root.ModelByIndex(0)->LinkByIndex(1)->Name());
+}
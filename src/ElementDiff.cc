@@ -0,0 +1,207 @@
+/*
+ * Copyright 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "sdf/ElementDiff.hh"
+#include "sdf/Param.hh"
+#include "sdf/Root.hh"
+
+using namespace sdf;
+
+namespace
+{
+  /// \brief Get the key that matches a child of the old tree with a child
+  /// of the new tree, as described in ElementChange::path.
+  /// \param[in] _child The child.
+  /// \param[in,out] _unnamedCounts Number of children without name
+  /// attribute seen so far among their siblings, by element name.
+  /// \return The key.
+  std::string childKey(const ElementPtr &_child,
+      std::unordered_map<std::string, std::size_t> &_unnamedCounts)
+  {
+    const std::string &name = _child->GetName();
+    if (_child->HasAttribute("name"))
+    {
+      const std::string value = _child->Get<std::string>("name");
+      if (!value.empty())
+        return name + "[" + value + "]";
+    }
+    return name + "#" + std::to_string(_unnamedCounts[name]++);
+  }
+
+  /// \brief Computes the changes between two trees.
+  class ElementDiffer
+  {
+    /// \brief Compare two matching elements and their descendants.
+    /// \param[in] _old The element of the old tree.
+    /// \param[in] _new The element of the new tree.
+    /// \param[in] _path Path of the elements.
+    public: void Diff(const ElementPtr &_old, const ElementPtr &_new,
+                      const std::string &_path)
+    {
+      this->DiffAttributes(_old, _new, _path);
+
+      const ParamPtr oldValue = _old->GetValue();
+      const ParamPtr newValue = _new->GetValue();
+      if (oldValue || newValue)
+      {
+        ElementChange change;
+        change.oldValue = oldValue ? oldValue->GetAsString() : "";
+        change.newValue = newValue ? newValue->GetAsString() : "";
+        if (change.oldValue != change.newValue)
+        {
+          change.type = ElementChangeType::VALUE_CHANGED;
+          change.path = _path;
+          change.element = _new;
+          this->changes.push_back(std::move(change));
+        }
+      }
+
+      // Index the old children by key, keeping their order for reporting
+      // the removed ones.
+      std::vector<std::pair<std::string, ElementPtr>> oldChildren;
+      std::unordered_map<std::string, std::size_t> oldIndex;
+      std::unordered_map<std::string, std::size_t> unnamedCounts;
+      for (const ElementPtr &child : _old->Children())
+      {
+        std::string key = childKey(child, unnamedCounts);
+        oldIndex.emplace(key, oldChildren.size());
+        oldChildren.emplace_back(std::move(key), child);
+      }
+      std::vector<bool> matched(oldChildren.size(), false);
+
+      unnamedCounts.clear();
+      for (const ElementPtr &child : _new->Children())
+      {
+        const std::string key = childKey(child, unnamedCounts);
+        const std::string path = _path.empty() ? key : _path + "/" + key;
+        auto iter = oldIndex.find(key);
+        if (iter == oldIndex.end() || matched[iter->second])
+        {
+          this->Add(ElementChangeType::ADDED, path, child);
+          continue;
+        }
+
+        matched[iter->second] = true;
+        const ElementPtr &oldChild = oldChildren[iter->second].second;
+        if (oldChild->Hash() != child->Hash())
+        {
+          this->Diff(oldChild, child, path);
+        }
+      }
+
+      for (std::size_t i = 0; i < oldChildren.size(); ++i)
+      {
+        if (!matched[i])
+        {
+          this->Add(ElementChangeType::REMOVED,
+              _path.empty() ? oldChildren[i].first :
+              _path + "/" + oldChildren[i].first, oldChildren[i].second);
+        }
+      }
+    }
+
+    /// \brief Compare the attributes of two matching elements.
+    /// \param[in] _old The element of the old tree.
+    /// \param[in] _new The element of the new tree.
+    /// \param[in] _path Path of the elements.
+    private: void DiffAttributes(const ElementPtr &_old,
+                                 const ElementPtr &_new,
+                                 const std::string &_path)
+    {
+      for (std::size_t i = 0; i < _new->GetAttributeCount(); ++i)
+      {
+        const ParamPtr attribute =
+            _new->GetAttribute(static_cast<unsigned int>(i));
+        const ParamPtr oldAttribute = _old->GetAttribute(attribute->GetKey());
+        ElementChange change;
+        change.oldValue = oldAttribute ? oldAttribute->GetAsString() : "";
+        change.newValue = attribute->GetAsString();
+        if (!oldAttribute || change.oldValue != change.newValue)
+        {
+          change.type = ElementChangeType::ATTRIBUTE_CHANGED;
+          change.path = _path;
+          change.attribute = attribute->GetKey();
+          change.element = _new;
+          this->changes.push_back(std::move(change));
+        }
+      }
+
+      for (std::size_t i = 0; i < _old->GetAttributeCount(); ++i)
+      {
+        const ParamPtr attribute =
+            _old->GetAttribute(static_cast<unsigned int>(i));
+        if (!_new->HasAttribute(attribute->GetKey()))
+        {
+          ElementChange change;
+          change.type = ElementChangeType::ATTRIBUTE_CHANGED;
+          change.path = _path;
+          change.attribute = attribute->GetKey();
+          change.oldValue = attribute->GetAsString();
+          change.element = _new;
+          this->changes.push_back(std::move(change));
+        }
+      }
+    }
+
+    /// \brief Add a change of a whole subtree.
+    /// \param[in] _type ADDED or REMOVED.
+    /// \param[in] _path Path of the subtree.
+    /// \param[in] _elem Root of the subtree.
+    public: void Add(const ElementChangeType _type, const std::string &_path,
+                     const ElementPtr &_elem)
+    {
+      ElementChange change;
+      change.type = _type;
+      change.path = _path;
+      change.element = _elem;
+      this->changes.push_back(std::move(change));
+    }
+
+    /// \brief The changes found so far.
+    public: std::vector<ElementChange> changes;
+  };
+}
+
+/////////////////////////////////////////////////
+std::vector<ElementChange> sdf::diffElements(const ElementPtr &_old,
+                                             const ElementPtr &_new)
+{
+  ElementDiffer differ;
+  if (!_old || !_new || _old->GetName() != _new->GetName())
+  {
+    if (_new)
+      differ.Add(ElementChangeType::ADDED, "", _new);
+    if (_old)
+      differ.Add(ElementChangeType::REMOVED, "", _old);
+    return differ.changes;
+  }
+
+  if (_old->Hash() != _new->Hash())
+    differ.Diff(_old, _new, "");
+  return differ.changes;
+}
+
+/////////////////////////////////////////////////
+std::vector<ElementChange> sdf::diffRoots(const Root &_old, const Root &_new)
+{
+  return diffElements(_old.Element(), _new.Element());
+}
@@ -0,0 +1,134 @@
+/*
+ * Copyright 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+#include "sdf/ElementDiff.hh"
+#include "sdf/Root.hh"
+
+/////////////////////////////////////////////////
+/// \brief Load a world with two models.
+/// \param[in] _boxPose Pose of the first model.
+/// \param[in] _extra Extra elements of the world.
+/// \param[out] _root The root.
+void loadWorld(const std::string &_boxPose, const std::string &_extra,
+    sdf::Root &_root)
+{
+  const std::string sdf =
+    "<sdf version='1.8'>"
+    "  <world name='default'>"
+    "    <model name='box'>"
+    "      <pose>" + _boxPose + "</pose>"
+    "      <link name='link'/>"
+    "    </model>"
+    "    <model name='sphere'>"
+    "      <link name='link'/>"
+    "    </model>" + _extra +
+    "  </world>"
+    "</sdf>";
+  ASSERT_TRUE(_root.LoadSdfString(sdf).empty());
+}
+
+/////////////////////////////////////////////////
+TEST(ElementDiff, Identical)
+{
+  sdf::Root oldRoot;
+  sdf::Root newRoot;
+  loadWorld("1 2 3 0 0 0", "", oldRoot);
+  loadWorld("1 2 3 0 0 0", "", newRoot);
+  EXPECT_TRUE(sdf::diffRoots(oldRoot, newRoot).empty());
+}
+
+/////////////////////////////////////////////////
+TEST(ElementDiff, ValueChanged)
+{
+  sdf::Root oldRoot;
+  sdf::Root newRoot;
+  loadWorld("1 2 3 0 0 0", "", oldRoot);
+  loadWorld("4 5 6 0 0 0", "", newRoot);
+
+  const std::vector<sdf::ElementChange> changes =
+      sdf::diffRoots(oldRoot, newRoot);
+  ASSERT_EQ(1u, changes.size());
+  EXPECT_EQ(sdf::ElementChangeType::VALUE_CHANGED, changes[0].type);
+  EXPECT_EQ("world[default]/model[box]/pose", changes[0].path);
+  EXPECT_EQ(0u, changes[0].oldValue.find("1 2 3"));
+  EXPECT_EQ(0u, changes[0].newValue.find("4 5 6"));
+  ASSERT_NE(nullptr, changes[0].element);
+  EXPECT_EQ("pose", changes[0].element->GetName());
+}
+
+/////////////////////////////////////////////////
+TEST(ElementDiff, AddedAndRemoved)
+{
+  sdf::Root oldRoot;
+  sdf::Root newRoot;
+  loadWorld("0 0 0 0 0 0",
+      "<model name='cylinder'><link name='link'/></model>", oldRoot);
+  loadWorld("0 0 0 0 0 0",
+      "<model name='capsule'><link name='link'/></model>", newRoot);
+
+  const std::vector<sdf::ElementChange> changes =
+      sdf::diffRoots(oldRoot, newRoot);
+  ASSERT_EQ(2u, changes.size());
+  EXPECT_EQ(sdf::ElementChangeType::ADDED, changes[0].type);
+  EXPECT_EQ("world[default]/model[capsule]", changes[0].path);
+  EXPECT_EQ(sdf::ElementChangeType::REMOVED, changes[1].type);
+  EXPECT_EQ("world[default]/model[cylinder]", changes[1].path);
+  EXPECT_EQ("model", changes[1].element->GetName());
+}
+
+/////////////////////////////////////////////////
+TEST(ElementDiff, AttributeChanged)
+{
+  sdf::ElementPtr oldElem(new sdf::Element);
+  oldElem->SetName("plugin");
+  oldElem->AddAttribute("filename", "string", "", true);
+  oldElem->GetAttribute("filename")->SetFromString("a.so");
+
+  sdf::ElementPtr newElem = oldElem->Clone();
+  EXPECT_TRUE(sdf::diffElements(oldElem, newElem).empty());
+
+  newElem->GetAttribute("filename")->SetFromString("b.so");
+  std::vector<sdf::ElementChange> changes =
+      sdf::diffElements(oldElem, newElem);
+  ASSERT_EQ(1u, changes.size());
+  EXPECT_EQ(sdf::ElementChangeType::ATTRIBUTE_CHANGED, changes[0].type);
+  EXPECT_TRUE(changes[0].path.empty());
+  EXPECT_EQ("filename", changes[0].attribute);
+  EXPECT_EQ("a.so", changes[0].oldValue);
+  EXPECT_EQ("b.so", changes[0].newValue);
+
+  // Children without name attribute are matched by position.
+  sdf::ElementPtr param(new sdf::Element);
+  param->SetName("param");
+  oldElem->InsertElement(param);
+  newElem = oldElem->Clone();
+  newElem->InsertElement(param->Clone());
+  changes = sdf::diffElements(oldElem, newElem);
+  ASSERT_EQ(1u, changes.size());
+  EXPECT_EQ(sdf::ElementChangeType::ADDED, changes[0].type);
+  EXPECT_EQ("param#1", changes[0].path);
+
+  // Whole trees.
+  changes = sdf::diffElements(nullptr, newElem);
+  ASSERT_EQ(1u, changes.size());
+  EXPECT_EQ(sdf::ElementChangeType::ADDED, changes[0].type);
+  EXPECT_EQ(newElem, changes[0].element);
+}
@@ -0,0 +1,240 @@
+/*
+ * Copyright 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef SDF_ELEMENTFIELD_HH_
+#define SDF_ELEMENTFIELD_HH_
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "sdf/Element.hh"
+#include "sdf/Param.hh"
+#include "sdf/sdf_config.h"
+
+namespace sdf
+{
+  // Inline bracket to help doxygen filtering.
+  inline namespace SDF_VERSION_NAMESPACE {
+  //
+
+  /// \brief A field of an element type, that is an attribute or a child
+  /// element with a value, read as a value of type T. Reading a field
+  /// gives the same result as Element::Get<T>(name, default), but the
+  /// position of the attribute and the value of the child element
+  /// description are resolved once per element schema, instead of being
+  /// searched by name and converted from a string on every read.
+  ///
+  /// DOM loaders declare their fields as function-local constants:
+  ///
+  ///     static const ElementField<double> kMass("mass");
+  ///     mass = kMass.Get(inertialElem, 1.0).first;
+  ///
+  /// A field may be read from several threads at once. The schemas that it
+  /// was resolved for are not kept alive by the field, and must not be
+  /// modified while elements of the document are read.
+  template <typename T>
+  class ElementField
+  {
+    /// \brief Constructor.
+    /// \param[in] _name Name of the attribute or child element.
+    public: explicit ElementField(const std::string &_name);
+
+    /// \brief Get the name of the field.
+    /// \return Name of the attribute or child element.
+    public: const std::string &Name() const;
+
+    /// \brief Read the field of an element, like Element::Get<T>(_key,
+    /// _defaultValue).
+    /// \param[in] _elem Element to read, which must not be null.
+    /// \param[in] _defaultValue Value returned if the element has neither
+    /// the field nor a description of it.
+    /// \return The value of the field, and true if the element has the
+    /// field or a description of it.
+    public: std::pair<T, bool> Get(const ElementPtr &_elem,
+                                   const T &_defaultValue) const;
+
+    /// \brief Read the field of an element, like Element::Get<T>(_key).
+    /// \param[in] _elem Element to read, which must not be null.
+    /// \return The value of the field, or a default constructed value.
+    public: T Get(const ElementPtr &_elem) const;
+
+    /// \brief The field resolved for one element schema.
+    private: struct Slot
+    {
+      /// \brief The schema. It is only compared, never dereferenced.
+      const ElementSchema *schema = nullptr;
+
+      /// \brief The schema, to tell whether it still exists. A slot whose
+      /// schema expired is not used again, even if a new schema is
+      /// allocated at the same address.
+      std::weak_ptr<ElementSchema> schemaRef;
+
+      /// \brief Position of the attribute in the attributes of elements of
+      /// the schema, or npos if the field was not an attribute.
+      std::size_t attribute = std::string::npos;
+
+      /// \brief True if the schema has a description of a child element
+      /// with the name of the field.
+      bool hasDescription = false;
+
+      /// \brief Value of the child element description.
+      T descriptionValue = T();
+    };
+
+    /// \brief Find or create the slot of the schema of an element.
+    /// \param[in] _elem The element.
+    /// \return The slot.
+    private: std::shared_ptr<const Slot> Resolve(const Element &_elem) const;
+
+    /// \brief Name of the attribute or child element.
+    private: std::string name;
+
+    /// \brief Slot used by the last read, accessed atomically.
+    private: mutable std::shared_ptr<const Slot> last;
+
+    /// \brief Slots of all the schemas that have not expired.
+    private: mutable std::vector<std::shared_ptr<const Slot>> slots;
+
+    /// \brief Mutex protecting slots.
+    private: mutable std::mutex mutex;
+  };
+
+  ///////////////////////////////////////////////
+  template <typename T>
+  ElementField<T>::ElementField(const std::string &_name)
+    : name(_name)
+  {
+  }
+
+  ///////////////////////////////////////////////
+  template <typename T>
+  const std::string &ElementField<T>::Name() const
+  {
+    return this->name;
+  }
+
+  ///////////////////////////////////////////////
+  template <typename T>
+  T ElementField<T>::Get(const ElementPtr &_elem) const
+  {
+    return this->Get(_elem, T()).first;
+  }
+
+  ///////////////////////////////////////////////
+  template <typename T>
+  std::pair<T, bool> ElementField<T>::Get(const ElementPtr &_elem,
+                                          const T &_defaultValue) const
+  {
+    std::pair<T, bool> result(_defaultValue, true);
+    const Element &elem = *_elem;
+
+    std::shared_ptr<const Slot> slot = std::atomic_load(&this->last);
+    if (!slot || slot->schema != elem.dataPtr->schema.get() ||
+        slot->schemaRef.expired())
+    {
+      slot = this->Resolve(elem);
+    }
+
+    // Elements of a schema have their attributes in the order of the
+    // description, so the resolved position is checked before searching.
+    const Param_V &attributes = elem.Content().attributes;
+    if (slot->attribute < attributes.size() &&
+        attributes[slot->attribute]->GetKey() == this->name)
+    {
+      attributes[slot->attribute]->Get(result.first);
+    }
+    else if (ParamPtr param = elem.SharedAttribute(this->name))
+    {
+      param->Get(result.first);
+    }
+    else if (ElementPtr child = elem.SharedElement(this->name))
+    {
+      result.first = child->Get<T>();
+    }
+    else if (slot->hasDescription)
+    {
+      result.first = slot->descriptionValue;
+    }
+    else
+    {
+      result.second = false;
+    }
+
+    return result;
+  }
+
+  ///////////////////////////////////////////////
+  template <typename T>
+  std::shared_ptr<const typename ElementField<T>::Slot>
+  ElementField<T>::Resolve(const Element &_elem) const
+  {
+    const std::shared_ptr<ElementSchema> &schema = _elem.dataPtr->schema;
+
+    std::lock_guard<std::mutex> lock(this->mutex);
+
+    this->slots.erase(std::remove_if(this->slots.begin(), this->slots.end(),
+        [](const std::shared_ptr<const Slot> &_slot)
+        {
+          return _slot->schemaRef.expired();
+        }), this->slots.end());
+
+    std::shared_ptr<const Slot> result;
+    for (const std::shared_ptr<const Slot> &slot : this->slots)
+    {
+      if (slot->schema == schema.get())
+      {
+        result = slot;
+        break;
+      }
+    }
+
+    if (!result)
+    {
+      auto slot = std::make_shared<Slot>();
+      slot->schema = schema.get();
+      slot->schemaRef = schema;
+
+      const Param_V &attributes = _elem.Content().attributes;
+      for (std::size_t i = 0; i < attributes.size(); ++i)
+      {
+        if (attributes[i]->GetKey() == this->name)
+        {
+          slot->attribute = i;
+          break;
+        }
+      }
+
+      if (ElementPtr description = _elem.GetElementDescription(this->name))
+      {
+        slot->hasDescription = true;
+        slot->descriptionValue = description->Get<T>();
+      }
+
+      result = slot;
+      this->slots.push_back(result);
+    }
+
+    std::atomic_store(&this->last, result);
+    return result;
+  }
+  }
+}
+#endif
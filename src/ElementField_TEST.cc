@@ -0,0 +1,135 @@
+/*
+ * Copyright 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+
+#include <gtest/gtest.h>
+#include <string>
+#include <thread>
+#include <vector>
+#include "sdf/Element.hh"
+#include "ElementField.hh"
+
+/////////////////////////////////////////////////
+/// \brief Create the description of an element with a "name" attribute and
+/// a "mass" child element.
+static sdf::ElementPtr linkDescription()
+{
+  sdf::ElementPtr desc(new sdf::Element);
+  desc->SetName("link");
+  desc->AddAttribute("name", "string", "__default__", false);
+
+  sdf::ElementPtr mass(new sdf::Element);
+  mass->SetName("mass");
+  mass->AddValue("double", "2.5", false);
+  desc->AddElementDescription(mass);
+  return desc;
+}
+
+/////////////////////////////////////////////////
+TEST(ElementField, Get)
+{
+  sdf::ElementPtr desc = linkDescription();
+  const sdf::ElementField<std::string> name("name");
+  const sdf::ElementField<double> mass("mass");
+  const sdf::ElementField<double> missing("missing");
+  EXPECT_EQ("mass", mass.Name());
+
+  sdf::ElementPtr elem = desc->Clone();
+  elem->GetAttribute("name")->SetFromString("base");
+
+  // The child element is absent, so the value of its description is read.
+  for (int i = 0; i < 2; ++i)
+  {
+    EXPECT_EQ("base", name.Get(elem));
+    std::pair<double, bool> value = mass.Get(elem, 1.0);
+    EXPECT_DOUBLE_EQ(2.5, value.first);
+    EXPECT_TRUE(value.second);
+    value = missing.Get(elem, 1.0);
+    EXPECT_DOUBLE_EQ(1.0, value.first);
+    EXPECT_FALSE(value.second);
+  }
+
+  elem->AddElement("mass")->Set(4.0);
+  EXPECT_DOUBLE_EQ(4.0, mass.Get(elem));
+  EXPECT_EQ(elem->Get<double>("mass", 1.0), mass.Get(elem, 1.0));
+  EXPECT_EQ(elem->Get<double>("missing", 1.0), missing.Get(elem, 1.0));
+
+  // Elements of the same schema with attributes in different positions.
+  sdf::ElementPtr bare(new sdf::Element);
+  bare->SetName("frame");
+  sdf::ElementPtr first = bare->Clone();
+  first->AddAttribute("name", "string", "first", false);
+  sdf::ElementPtr second = bare->Clone();
+  second->AddAttribute("pose", "string", "", false);
+  second->AddAttribute("name", "string", "second", false);
+  EXPECT_EQ("first", name.Get(first));
+  EXPECT_EQ("second", name.Get(second));
+  EXPECT_EQ("base", name.Get(elem));
+}
+
+/////////////////////////////////////////////////
+TEST(ElementField, Schemas)
+{
+  const sdf::ElementField<double> mass("mass");
+
+  // Each description has its own schema.
+  for (int i = 0; i < 3; ++i)
+  {
+    sdf::ElementPtr desc = linkDescription();
+    desc->GetElementDescription("mass")->GetValue()->Set(1.0 + i);
+    sdf::ElementPtr elem = desc->Clone();
+    EXPECT_DOUBLE_EQ(1.0 + i, mass.Get(elem));
+  }
+
+  sdf::ElementPtr first = linkDescription()->Clone();
+  sdf::ElementPtr second(new sdf::Element);
+  second->SetName("inertial");
+  sdf::ElementPtr secondMass(new sdf::Element);
+  secondMass->SetName("mass");
+  secondMass->AddValue("double", "7", false);
+  second->InsertElement(secondMass);
+  EXPECT_DOUBLE_EQ(2.5, mass.Get(first));
+  EXPECT_DOUBLE_EQ(7.0, mass.Get(second));
+  EXPECT_DOUBLE_EQ(2.5, mass.Get(first));
+}
+
+/////////////////////////////////////////////////
+TEST(ElementField, Threads)
+{
+  const sdf::ElementField<double> mass("mass");
+  sdf::ElementPtr desc = linkDescription();
+
+  std::vector<sdf::ElementPtr> elems;
+  for (int i = 0; i < 8; ++i)
+    elems.push_back(desc->Clone());
+
+  std::vector<std::thread> threads;
+  std::vector<double> sums(elems.size(), 0.0);
+  for (std::size_t i = 0; i < elems.size(); ++i)
+  {
+    threads.emplace_back([&, i]()
+    {
+      for (int j = 0; j < 1000; ++j)
+        sums[i] += mass.Get(elems[i]);
+    });
+  }
+  for (std::thread &thread : threads)
+    thread.join();
+
+  for (double sum : sums)
+    EXPECT_DOUBLE_EQ(2500.0, sum);
+}
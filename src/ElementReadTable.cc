@@ -0,0 +1,84 @@
+/*
+ * Copyright 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#include <memory>
+#include <string>
+
+#include "sdf/Param.hh"
+
+#include "ElementReadTable.hh"
+
+using namespace sdf;
+
+/////////////////////////////////////////////////
+std::shared_ptr<const ElementReadTable> ElementReadTable::Get(
+    const Element &_elem)
+{
+  const ElementSchema &schema = *_elem.dataPtr->schema;
+  std::shared_ptr<const ElementReadTable> table =
+      std::atomic_load(&schema.readTable);
+  if (table)
+    return table;
+
+  auto result = std::make_shared<ElementReadTable>();
+  const Param_V &attributes = _elem.Content().attributes;
+  result->attributeCount = attributes.size();
+  for (std::size_t i = 0; i < attributes.size(); ++i)
+  {
+    result->attributes.emplace(attributes[i]->GetKey(), i);
+    if (attributes[i]->GetRequired())
+      result->requiredAttributes.push_back(i);
+  }
+
+  for (std::size_t i = 0; i < schema.elementDescriptions.size(); ++i)
+  {
+    const ElementPtr &desc = schema.elementDescriptions[i];
+    result->elementDescriptions.emplace(desc->GetName(), i);
+    const std::string &required = desc->GetRequired();
+    if (required == "1" || required == "+")
+      result->requiredElements.push_back(i);
+  }
+
+  // Threads that build the table at the same time build the same table.
+  table = result;
+  std::atomic_store(&schema.readTable, table);
+  return table;
+}
+
+/////////////////////////////////////////////////
+ParamPtr ElementReadTable::Attribute(const Element &_elem,
+                                     const std::string &_key) const
+{
+  auto iter = this->attributes.find(_key);
+  if (iter != this->attributes.end() &&
+      iter->second < _elem.GetAttributeCount())
+  {
+    ParamPtr param =
+        _elem.GetAttribute(static_cast<unsigned int>(iter->second));
+    if (param->GetKey() == _key)
+      return param;
+  }
+  return _elem.GetAttribute(_key);
+}
+
+/////////////////////////////////////////////////
+std::size_t ElementReadTable::ElementDescription(
+    const std::string &_name) const
+{
+  auto iter = this->elementDescriptions.find(_name);
+  return iter != this->elementDescriptions.end() ?
+      iter->second : std::string::npos;
+}
@@ -0,0 +1,90 @@
+/*
+ * Copyright 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef SDF_ELEMENTREADTABLE_HH_
+#define SDF_ELEMENTREADTABLE_HH_
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "sdf/Element.hh"
+#include "sdf/sdf_config.h"
+#include "sdf/system_util.hh"
+
+namespace sdf
+{
+  // Inline bracket to help doxygen filtering.
+  inline namespace SDF_VERSION_NAMESPACE {
+  //
+
+  /// \brief Positions of the attributes and child element descriptions of
+  /// an element schema, by name, and the ones that are required, so that
+  /// readXml reads each XML element in one pass over its attributes and
+  /// children instead of searching the attributes and descriptions for
+  /// each of them. It is built once per schema, and is read only
+  /// afterwards.
+  ///
+  /// Like ElementField, the positions of the attributes are those of the
+  /// element that the table was built from, and are checked before use.
+  /// The descriptions of a schema must not be modified while elements of
+  /// the schema are read.
+  class SDFORMAT_VISIBLE ElementReadTable
+  {
+    /// \brief Get the table of the schema of an element, building it if
+    /// needed. It may be called from several threads at once.
+    /// \param[in] _elem The element.
+    /// \return The table.
+    public: static std::shared_ptr<const ElementReadTable> Get(
+                const Element &_elem);
+
+    /// \brief Find an attribute of an element of the schema.
+    /// \param[in] _elem The element.
+    /// \param[in] _key Key of the attribute.
+    /// \return The attribute, or nullptr if the element has none with
+    /// this key.
+    public: ParamPtr Attribute(const Element &_elem,
+                               const std::string &_key) const;
+
+    /// \brief Get the position of a child element description.
+    /// \param[in] _name Name of the child element.
+    /// \return Index of the first description with this name, as in
+    /// Element::GetElementDescription, or npos if there is none.
+    public: std::size_t ElementDescription(const std::string &_name) const;
+
+    /// \brief Position of each attribute, by key.
+    public: std::unordered_map<std::string, std::size_t> attributes;
+
+    /// \brief Number of attributes of the element the table was built
+    /// from.
+    public: std::size_t attributeCount = 0;
+
+    /// \brief Positions of the required attributes.
+    public: std::vector<std::size_t> requiredAttributes;
+
+    /// \brief Position of the first child element description with each
+    /// name.
+    public: std::unordered_map<std::string, std::size_t> elementDescriptions;
+
+    /// \brief Positions of the child element descriptions that are
+    /// required, that is with required "1" or "+".
+    public: std::vector<std::size_t> requiredElements;
+  };
+  }
+}
+#endif
@@ -0,0 +1,76 @@
+/*
+ * Copyright 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+#include <string>
+#include "sdf/Element.hh"
+#include "sdf/Param.hh"
+#include "ElementReadTable.hh"
+
+/////////////////////////////////////////////////
+TEST(ElementReadTable, Get)
+{
+  sdf::ElementPtr desc(new sdf::Element);
+  desc->SetName("joint");
+  desc->AddAttribute("name", "string", "__default__", true);
+  desc->AddAttribute("type", "string", "revolute", false);
+
+  sdf::ElementPtr parent(new sdf::Element);
+  parent->SetName("parent");
+  parent->SetRequired("1");
+  desc->AddElementDescription(parent);
+  sdf::ElementPtr pose(new sdf::Element);
+  pose->SetName("pose");
+  pose->SetRequired("0");
+  desc->AddElementDescription(pose);
+  sdf::ElementPtr axis(new sdf::Element);
+  axis->SetName("axis");
+  axis->SetRequired("+");
+  desc->AddElementDescription(axis);
+
+  // Elements created from the description share its table.
+  sdf::ElementPtr elem = desc->Clone();
+  auto table = sdf::ElementReadTable::Get(*elem);
+  EXPECT_EQ(table, sdf::ElementReadTable::Get(*desc));
+  EXPECT_EQ(2u, table->attributeCount);
+  ASSERT_EQ(1u, table->requiredAttributes.size());
+  EXPECT_EQ(0u, table->requiredAttributes[0]);
+  EXPECT_EQ(1u, table->ElementDescription("pose"));
+  EXPECT_EQ(std::string::npos, table->ElementDescription("child"));
+  ASSERT_EQ(2u, table->requiredElements.size());
+  EXPECT_EQ(0u, table->requiredElements[0]);
+  EXPECT_EQ(2u, table->requiredElements[1]);
+
+  EXPECT_EQ(elem->GetAttribute("type"), table->Attribute(*elem, "type"));
+  EXPECT_EQ(nullptr, table->Attribute(*elem, "missing"));
+
+  // Attributes added to an element are still found.
+  elem->AddAttribute("xmlns:custom", "string", "", false);
+  EXPECT_EQ(elem->GetAttribute("xmlns:custom"),
+            table->Attribute(*elem, "xmlns:custom"));
+
+  // Modifying the description gives it a new table.
+  sdf::ElementPtr child(new sdf::Element);
+  child->SetName("child");
+  child->SetRequired("1");
+  desc->AddElementDescription(child);
+  auto modified = sdf::ElementReadTable::Get(*desc);
+  EXPECT_NE(table, modified);
+  EXPECT_EQ(3u, modified->ElementDescription("child"));
+  EXPECT_EQ(3u, modified->requiredElements.size());
+  EXPECT_EQ(table, sdf::ElementReadTable::Get(*elem));
+}
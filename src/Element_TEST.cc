@@ -16,6 +16,10 @@
  */
 
 #include <gtest/gtest.h>
+#include <algorithm>
+#include <sstream>
+#include <string>
+#include <vector>
 
 #include "sdf/Element.hh"
 #include "sdf/Filesystem.hh"
@@ -48,6 +52,50 @@ TEST(Element, Child)
   EXPECT_EQ("1.5", child.OriginalVersion());
 }
 
+/////////////////////////////////////////////////
+TEST(Element, SharedProvenance)
+{
+  sdf::ElementPtr model = std::make_shared<sdf::Element>();
+  model->SetName("model");
+  const std::string path = "/" + std::string(10000, 'a') + "/model.sdf";
+  model->SetFilePath(path);
+  model->SetOriginalVersion("1.5");
+
+  // Elements of the same file share the record of their parent, so the
+  // path is only counted once.
+  for (int i = 0; i < 3; ++i)
+  {
+    sdf::ElementPtr link = std::make_shared<sdf::Element>();
+    link->SetName("link");
+    link->SetFilePath(path);
+    link->SetParent(model);
+    model->InsertElement(link);
+    EXPECT_EQ(path, link->FilePath());
+    EXPECT_EQ("1.5", link->OriginalVersion());
+  }
+  sdf::TreeFootprint footprint = model->MemoryFootprint();
+  EXPECT_LT(footprint.byName["link"].bytes, path.size());
+
+  // An element included from another file has its own record.
+  sdf::ElementPtr link = model->GetFirstElement();
+  link->SetInclude(std::string(1000, 'b'));
+  EXPECT_EQ(path, link->FilePath());
+  EXPECT_EQ("1.5", link->OriginalVersion());
+  EXPECT_EQ(std::string(1000, 'b'), link->GetInclude());
+  EXPECT_LE(footprint.total.bytes + 1000,
+      model->MemoryFootprint().total.bytes);
+
+  link->SetInclude("");
+  EXPECT_EQ(footprint.total.bytes, model->MemoryFootprint().total.bytes);
+
+  // Clearing an element clears its file path and original version.
+  sdf::ElementPtr clone = model->Clone();
+  clone->Clear();
+  EXPECT_TRUE(clone->FilePath().empty());
+  EXPECT_TRUE(clone->OriginalVersion().empty());
+  EXPECT_EQ(path, model->GetFirstElement()->FilePath());
+}
+
 /////////////////////////////////////////////////
 TEST(Element, Name)
 {
@@ -140,6 +188,23 @@ TEST(Element, AddAttribute)
   ASSERT_EQ(param->GetDescription(), "float description");
 }
 
+/////////////////////////////////////////////////
+TEST(Element, RemoveAttribute)
+{
+  sdf::Element elem;
+  elem.AddAttribute("test", "string", "foo", false, "foo description");
+  elem.AddAttribute("attr", "float", "0.0", false, "float description");
+  ASSERT_EQ(elem.GetAttributeCount(), 2UL);
+
+  elem.RemoveAttribute("test");
+  ASSERT_EQ(elem.GetAttributeCount(), 1UL);
+  EXPECT_FALSE(elem.HasAttribute("test"));
+  EXPECT_TRUE(elem.HasAttribute("attr"));
+
+  elem.RemoveAttribute("missing");
+  EXPECT_EQ(elem.GetAttributeCount(), 1UL);
+}
+
 /////////////////////////////////////////////////
 TEST(Element, GetAttributeSet)
 {
@@ -253,6 +318,23 @@ TEST(Element, GetTemplates)
   bool found = elem->Get<std::string>("test", out, "def");
   ASSERT_EQ(out, "foo");
   ASSERT_EQ(found, true);
+
+  // Children are read before their descriptions, and children without
+  // value read as a default constructed value.
+  sdf::ElementPtr desc = std::make_shared<sdf::Element>();
+  desc->SetName("child");
+  desc->AddValue("double", "2.5", false);
+  elem->AddElementDescription(desc);
+  sdf::ElementPtr empty = std::make_shared<sdf::Element>();
+  empty->SetName("empty");
+  elem->AddElementDescription(empty);
+  EXPECT_EQ(std::make_pair(2.5, true), elem->Get<double>("child", 1.0));
+  elem->AddElement("child")->Set(3.5);
+  EXPECT_EQ(std::make_pair(3.5, true), elem->Get<double>("child", 1.0));
+  EXPECT_EQ(std::make_pair(0.0, true), elem->Get<double>("empty", 1.0));
+  EXPECT_EQ(std::make_pair(1.0, false), elem->Get<double>("missing", 1.0));
+  EXPECT_EQ(std::make_pair(1.0, false), elem->Get<double>("", 1.0));
+  EXPECT_DOUBLE_EQ(0.0, elem->Get<double>("missing"));
 }
 
 /////////////////////////////////////////////////
@@ -285,6 +367,169 @@ TEST(Element, Clone)
   ASSERT_EQ(newelem->GetAttributeCount(), 1UL);
 }
 
+/////////////////////////////////////////////////
+TEST(Element, CopyOnWriteClone)
+{
+  sdf::ElementPtr parent = std::make_shared<sdf::Element>();
+  parent->SetName("parent");
+  parent->AddAttribute("name", "string", "__default__", true);
+  parent->GetAttribute("name")->Set<std::string>("original");
+  parent->SetFilePath("/path/to/file.sdf");
+  sdf::ElementPtr childDesc = std::make_shared<sdf::Element>();
+  childDesc->SetName("child");
+  childDesc->AddValue("double", "0", false);
+  parent->AddElementDescription(childDesc);
+  sdf::ElementPtr child = parent->AddElement("child");
+  child->Set(1.5);
+  sdf::ElementPtr other = parent->AddElement("child");
+  other->Set(2.5);
+
+  sdf::ElementPtr clone = parent->CopyOnWriteClone();
+  EXPECT_EQ("/path/to/file.sdf", clone->FilePath());
+  EXPECT_EQ(parent->ToString(""), clone->ToString(""));
+
+  // Reading values does not hand out the shared elements.
+  EXPECT_EQ("original", clone->Get<std::string>("name"));
+  EXPECT_DOUBLE_EQ(1.5, clone->Get<double>("child"));
+  EXPECT_TRUE(clone->HasElement("child"));
+  EXPECT_TRUE(clone->HasAttribute("name"));
+  EXPECT_EQ(1u, clone->GetAttributeCount());
+
+  // Child elements handed out by the clone are its own.
+  sdf::ElementPtr cloneChild = clone->GetFirstElement();
+  ASSERT_NE(nullptr, cloneChild);
+  EXPECT_NE(child, cloneChild);
+  EXPECT_EQ(clone, cloneChild->GetParent());
+  EXPECT_EQ(child, parent->GetFirstElement());
+  sdf::ElementPtr cloneOther = cloneChild->GetNextElement("child");
+  ASSERT_NE(nullptr, cloneOther);
+  EXPECT_NE(other, cloneOther);
+  EXPECT_DOUBLE_EQ(2.5, cloneOther->Get<double>());
+
+  // Modifying the clone does not affect the source.
+  clone->GetAttribute("name")->Set<std::string>("clone");
+  cloneChild->Set(3.5);
+  clone->RemoveChild(cloneOther);
+  clone->AddElement("child");
+  EXPECT_EQ("clone", clone->Get<std::string>("name"));
+  EXPECT_DOUBLE_EQ(3.5, clone->Get<double>("child"));
+  EXPECT_EQ("original", parent->Get<std::string>("name"));
+  EXPECT_DOUBLE_EQ(1.5, parent->Get<double>("child"));
+  EXPECT_DOUBLE_EQ(1.5, child->Get<double>());
+  EXPECT_EQ(other, child->GetNextElement("child"));
+  EXPECT_EQ(nullptr, other->GetNextElement("child"));
+
+  // Clones of an unmodified clone share the content of the source.
+  sdf::ElementPtr clone2 = parent->CopyOnWriteClone();
+  sdf::ElementPtr clone3 = clone2->CopyOnWriteClone();
+  clone2->GetFirstElement()->Set(4.5);
+  EXPECT_DOUBLE_EQ(4.5, clone2->Get<double>("child"));
+  EXPECT_DOUBLE_EQ(1.5, clone3->Get<double>("child"));
+  EXPECT_EQ(parent->ToString(""), clone3->ToString(""));
+
+  // A deep clone of a copy-on-write clone copies the shared content.
+  sdf::ElementPtr deep = parent->CopyOnWriteClone()->Clone();
+  EXPECT_EQ(parent->ToString(""), deep->ToString(""));
+  EXPECT_NE(child, deep->GetFirstElement());
+
+  // Clearing the clone does not clear the source.
+  sdf::ElementPtr clone4 = parent->CopyOnWriteClone();
+  clone4->ClearElements();
+  EXPECT_EQ(nullptr, clone4->GetFirstElement());
+  EXPECT_EQ("original", clone4->Get<std::string>("name"));
+  EXPECT_EQ(child, parent->GetFirstElement());
+  EXPECT_DOUBLE_EQ(1.5, child->Get<double>());
+}
+
+/////////////////////////////////////////////////
+TEST(Element, SharedDescriptions)
+{
+  sdf::ElementPtr parent = std::make_shared<sdf::Element>();
+  parent->SetName("parent");
+  parent->SetDescription("parent description");
+
+  sdf::ElementPtr desc = std::make_shared<sdf::Element>();
+  desc->SetName("child");
+  desc->AddAttribute("name", "string", "", true, "name description");
+  sdf::ElementPtr grandchildDesc = std::make_shared<sdf::Element>();
+  grandchildDesc->SetName("grandchild");
+  desc->AddElementDescription(grandchildDesc);
+  parent->AddElementDescription(desc);
+
+  // Elements created from the same description share its child
+  // descriptions instead of holding copies of them.
+  sdf::ElementPtr child1 = parent->AddElement("child");
+  sdf::ElementPtr child2 = parent->AddElement("child");
+  ASSERT_NE(nullptr, child1);
+  ASSERT_NE(nullptr, child2);
+  EXPECT_EQ(grandchildDesc, child1->GetElementDescription("grandchild"));
+  EXPECT_EQ(grandchildDesc, child2->GetElementDescription("grandchild"));
+
+  sdf::ElementPtr clone = parent->Clone();
+  EXPECT_EQ(desc, clone->GetElementDescription("child"));
+  EXPECT_EQ("parent description", clone->GetDescription());
+
+  // Values are not shared.
+  child1->GetAttribute("name")->Set<std::string>("one");
+  child2->GetAttribute("name")->Set<std::string>("two");
+  EXPECT_EQ("one", child1->Get<std::string>("name"));
+  EXPECT_EQ("two", child2->Get<std::string>("name"));
+
+  // Changing the description of one element does not affect the others.
+  child1->SetDescription("child1 description");
+  child1->AddElementDescription(std::make_shared<sdf::Element>());
+  EXPECT_EQ("child1 description", child1->GetDescription());
+  EXPECT_EQ(2UL, child1->GetElementDescriptionCount());
+  EXPECT_TRUE(child2->GetDescription().empty());
+  EXPECT_EQ(1UL, child2->GetElementDescriptionCount());
+  EXPECT_TRUE(desc->GetDescription().empty());
+  EXPECT_EQ(1UL, desc->GetElementDescriptionCount());
+
+  clone->SetName("clone");
+  EXPECT_EQ("clone", clone->GetName());
+  EXPECT_EQ("parent", parent->GetName());
+
+  // Resetting an element keeps the shared descriptions intact.
+  child2->Reset();
+  EXPECT_EQ(0UL, child2->GetElementDescriptionCount());
+  EXPECT_EQ(1UL, desc->GetElementDescriptionCount());
+  EXPECT_EQ("grandchild", desc->GetElementDescription(0)->GetName());
+}
+
+/////////////////////////////////////////////////
+TEST(Element, AddElementRequiredChildren)
+{
+  sdf::ElementPtr parent = std::make_shared<sdf::Element>();
+  parent->SetName("parent");
+
+  sdf::ElementPtr desc = std::make_shared<sdf::Element>();
+  desc->SetName("child");
+  sdf::ElementPtr requiredDesc = std::make_shared<sdf::Element>();
+  requiredDesc->SetName("required");
+  requiredDesc->SetRequired("1");
+  sdf::ElementPtr optionalDesc = std::make_shared<sdf::Element>();
+  optionalDesc->SetName("optional");
+  optionalDesc->SetRequired("0");
+  desc->AddElementDescription(optionalDesc);
+  desc->AddElementDescription(requiredDesc);
+  parent->AddElementDescription(desc);
+
+  // Only required children are added with the element.
+  sdf::ElementPtr child = parent->AddElement("child");
+  ASSERT_NE(nullptr, child);
+  EXPECT_TRUE(child->HasElement("required"));
+  EXPECT_FALSE(child->HasElement("optional"));
+
+  // Optional children are added when they are requested.
+  sdf::ElementPtr optional = child->GetElement("optional");
+  ASSERT_NE(nullptr, optional);
+  EXPECT_TRUE(child->HasElement("optional"));
+  EXPECT_EQ(optionalDesc->GetElementDescriptionCount(),
+            optional->GetElementDescriptionCount());
+
+  EXPECT_EQ(nullptr, child->AddElement("missing"));
+}
+
 /////////////////////////////////////////////////
 TEST(Element, ClearElements)
 {
@@ -448,6 +693,128 @@ TEST(Element, ToStringInclude)
   ASSERT_EQ(stringval, "myprefix<include filename='foo.txt'/>\n");
 }
 
+/////////////////////////////////////////////////
+TEST(Element, ToStringPreserveIncludes)
+{
+  sdf::ElementPtr model = std::make_shared<sdf::Element>();
+  model->SetName("model");
+  model->AddAttribute("name", "string", "", true);
+  model->GetAttribute("name")->Set<std::string>("box");
+  const std::string expanded = model->ToString("  ");
+  EXPECT_EQ("  <model name='box'/>\n", expanded);
+
+  const std::string include = "<include><uri>model://box</uri></include>";
+  model->SetIncludeXml(include);
+  EXPECT_EQ(include, model->IncludeXml());
+  EXPECT_EQ(expanded, model->ToString("  "));
+
+  sdf::PrintConfig config;
+  config.SetPreserveIncludes(true);
+  EXPECT_EQ("  " + include + "\n", model->ToString("  ", config));
+
+  std::ostringstream stream;
+  model->Write(stream, "  ", config);
+  EXPECT_EQ("  " + include + "\n", stream.str());
+
+  // Clones are printed as the include too, until they are modified.
+  sdf::ElementPtr clone = model->Clone();
+  EXPECT_EQ("  " + include + "\n", clone->ToString("  ", config));
+  clone->GetAttribute("name")->Set<std::string>("other");
+  EXPECT_EQ("  <model name='other'/>\n", clone->ToString("  ", config));
+  EXPECT_EQ("  " + include + "\n", model->ToString("  ", config));
+
+  model->SetIncludeXml("");
+  EXPECT_EQ(expanded, model->ToString("  ", config));
+}
+
+/////////////////////////////////////////////////
+TEST(Element, Write)
+{
+  sdf::ElementPtr parent = std::make_shared<sdf::Element>();
+  parent->SetName("parent");
+  parent->AddAttribute("name", "string", "", true, "name");
+  parent->GetAttribute("name")->Set<std::string>("p");
+
+  // Enough children for the buffer to be written in several blocks.
+  for (int i = 0; i < 5000; ++i)
+  {
+    sdf::ElementPtr child = std::make_shared<sdf::Element>();
+    child->SetName("child");
+    child->AddAttribute("index", "int", "0", false, "index");
+    child->GetAttribute("index")->Set(i);
+    child->AddValue("pose", "0 0 0 0 0 0", false, "pose");
+    child->GetValue()->Set(ignition::math::Pose3d(i, 0.5, 0, 0, 0, 0.25));
+    child->SetParent(parent);
+    parent->InsertElement(child);
+  }
+
+  sdf::ElementPtr include = std::make_shared<sdf::Element>();
+  include->SetInclude("foo.txt");
+  include->SetParent(parent);
+  parent->InsertElement(include);
+
+  std::ostringstream stream;
+  parent->Write(stream, "myprefix");
+  EXPECT_EQ(parent->ToString("myprefix"), stream.str());
+  EXPECT_NE(std::string::npos,
+      stream.str().find("myprefix  <child index='4999'>4999 0.5 "));
+
+  std::ostringstream noPrefix;
+  parent->Write(noPrefix);
+  EXPECT_EQ(parent->ToString(""), noPrefix.str());
+}
+
+/////////////////////////////////////////////////
+TEST(Element, WriteParallel)
+{
+  auto makeElement = [](const std::string &_name,
+                        const sdf::ElementPtr &_parent)
+  {
+    sdf::ElementPtr elem = std::make_shared<sdf::Element>();
+    elem->SetName(_name);
+    elem->AddAttribute("name", "string", "", false, "name");
+    if (_parent)
+    {
+      elem->SetParent(_parent);
+      _parent->InsertElement(elem);
+    }
+    return elem;
+  };
+
+  sdf::ElementPtr root = makeElement("sdf", nullptr);
+  sdf::ElementPtr world = makeElement("world", root);
+  world->GetAttribute("name")->Set<std::string>("default");
+  makeElement("gravity", world);
+
+  // More models than are printed in one batch.
+  for (int i = 0; i < 600; ++i)
+  {
+    sdf::ElementPtr model = makeElement("model", world);
+    model->GetAttribute("name")->Set("model_" + std::to_string(i));
+    sdf::ElementPtr link = makeElement("link", model);
+    link->GetAttribute("name")->Set<std::string>("link");
+    link->AddValue("pose", "0 0 0 0 0 0", false, "pose");
+    link->GetValue()->Set(ignition::math::Pose3d(i, 0.5, 0, 0, 0, 0.25));
+  }
+  sdf::ElementPtr included = makeElement("model", world);
+  included->SetInclude("foo.txt");
+
+  const std::string expected = root->ToString("myprefix");
+  for (unsigned int threads : {0u, 2u, 4u})
+  {
+    sdf::PrintConfig config;
+    config.SetThreadCount(threads);
+    EXPECT_EQ(expected, root->ToString("myprefix", config));
+
+    std::ostringstream stream;
+    root->Write(stream, "myprefix", config);
+    EXPECT_EQ(expected, stream.str());
+
+    // Elements with few children are printed as without threads.
+    EXPECT_EQ(included->ToString(""), included->ToString("", config));
+  }
+}
+
 /////////////////////////////////////////////////
 TEST(Element, DocLeftPane)
 {
@@ -612,6 +979,27 @@ TEST(Element, GetNextElement)
   ASSERT_EQ(child->GetNextElement("foo"), nullptr);
 }
 
+/////////////////////////////////////////////////
+TEST(Element, FindElement)
+{
+  sdf::ElementPtr childDesc = std::make_shared<sdf::Element>();
+  childDesc->SetName("child");
+  sdf::ElementPtr parent = std::make_shared<sdf::Element>();
+  parent->SetName("parent");
+  parent->AddElementDescription(childDesc);
+
+  // FindElement does not add a missing child, unlike GetElement.
+  const sdf::ElementPtr constParent = parent;
+  EXPECT_EQ(nullptr, constParent->FindElement("child"));
+  EXPECT_FALSE(parent->HasElement("child"));
+  EXPECT_EQ(nullptr, parent->GetFirstElement());
+
+  sdf::ElementPtr child = parent->GetElement("child");
+  ASSERT_NE(nullptr, child);
+  EXPECT_EQ(child, constParent->FindElement("child"));
+  EXPECT_EQ(nullptr, constParent->FindElement("other"));
+}
+
 /////////////////////////////////////////////////
 TEST(Element, GetNextElementMultiple)
 {
@@ -629,6 +1017,169 @@ TEST(Element, GetNextElementMultiple)
   ASSERT_EQ(child2->GetNextElement(""), nullptr);
 }
 
+/////////////////////////////////////////////////
+TEST(Element, ExpiredParent)
+{
+  sdf::ElementPtr child1 = std::make_shared<sdf::Element>();
+  sdf::ElementPtr child2 = std::make_shared<sdf::Element>();
+  {
+    sdf::ElementPtr parent = std::make_shared<sdf::Element>();
+    child1->SetParent(parent);
+    child2->SetParent(parent);
+    parent->InsertElement(child1);
+    parent->InsertElement(child2);
+    EXPECT_EQ(child2, child1->GetNextElement(""));
+  }
+
+  // The walks through the parent must not use it once it is destroyed.
+  EXPECT_EQ(nullptr, child1->GetParent());
+  EXPECT_EQ(nullptr, child1->GetNextElement(""));
+  child1->SetFilePath("/tmp/model.sdf");
+  EXPECT_EQ("/tmp/model.sdf", child1->FilePath());
+  child2->RemoveFromParent();
+  EXPECT_EQ(nullptr, child2->GetParent());
+}
+
+/////////////////////////////////////////////////
+TEST(Element, Children)
+{
+  sdf::ElementPtr parent = std::make_shared<sdf::Element>();
+  parent->SetName("parent");
+  EXPECT_TRUE(parent->Children().Empty());
+
+  std::vector<sdf::ElementPtr> children;
+  for (const std::string name : {"a", "b", "a", "c", "a"})
+  {
+    sdf::ElementPtr child = std::make_shared<sdf::Element>();
+    child->SetName(name);
+    child->SetParent(parent);
+    parent->InsertElement(child);
+    children.push_back(child);
+  }
+
+  std::vector<sdf::ElementPtr> all;
+  for (const sdf::ElementPtr &child : parent->Children())
+    all.push_back(child);
+  EXPECT_EQ(children, all);
+
+  std::vector<sdf::ElementPtr> named;
+  for (const sdf::ElementPtr &child : parent->Children("a"))
+    named.push_back(child);
+  EXPECT_EQ(std::vector<sdf::ElementPtr>(
+      {children[0], children[2], children[4]}), named);
+
+  auto range = parent->Children("c");
+  auto iter = range.begin();
+  ASSERT_NE(range.end(), iter);
+  EXPECT_EQ(children[3], *iter);
+  EXPECT_EQ("c", (*iter)->GetName());
+  EXPECT_EQ(range.end(), ++iter);
+  EXPECT_TRUE(parent->Children("d").Empty());
+
+  // The children of a copy-on-write clone are its own.
+  sdf::ElementPtr clone = parent->CopyOnWriteClone();
+  std::size_t count = 0;
+  for (const sdf::ElementPtr &child : clone->Children("a"))
+  {
+    EXPECT_EQ(clone, child->GetParent());
+    ++count;
+  }
+  EXPECT_EQ(3u, count);
+}
+
+/////////////////////////////////////////////////
+TEST(Element, Visit)
+{
+  // root(a(b, c), d)
+  sdf::ElementPtr root = std::make_shared<sdf::Element>();
+  root->SetName("root");
+  auto addChild = [](const sdf::ElementPtr &_parent, const std::string &_name)
+  {
+    sdf::ElementPtr child = std::make_shared<sdf::Element>();
+    child->SetName(_name);
+    child->SetParent(_parent);
+    _parent->InsertElement(child);
+    return child;
+  };
+  sdf::ElementPtr a = addChild(root, "a");
+  addChild(a, "b");
+  addChild(a, "c");
+  addChild(root, "d");
+
+  std::string pre;
+  std::string post;
+  root->Visit(
+      [&pre](const sdf::Element &_elem)
+      {
+        pre += _elem.GetName() + " ";
+        return true;
+      },
+      [&post](const sdf::Element &_elem)
+      {
+        post += _elem.GetName() + " ";
+      });
+  EXPECT_EQ("root a b c d ", pre);
+  EXPECT_EQ("b c a d root ", post);
+
+  // Returning false skips the descendants, but not the post-order call.
+  pre.clear();
+  post.clear();
+  root->Visit(
+      [&pre](const sdf::Element &_elem)
+      {
+        pre += _elem.GetName() + " ";
+        return _elem.GetName() != "a";
+      },
+      [&post](const sdf::Element &_elem)
+      {
+        post += _elem.GetName() + " ";
+      });
+  EXPECT_EQ("root a d ", pre);
+  EXPECT_EQ("a d root ", post);
+
+  // Visiting a copy-on-write clone does not copy its shared content.
+  sdf::ElementPtr clone = root->CopyOnWriteClone();
+  const std::size_t bytes = clone->MemoryFootprint().total.bytes;
+  std::size_t count = 0;
+  clone->Visit(nullptr, [&count](const sdf::Element &)
+      {
+        ++count;
+      });
+  EXPECT_EQ(5u, count);
+  EXPECT_EQ(bytes, clone->MemoryFootprint().total.bytes);
+}
+
+/////////////////////////////////////////////////
+TEST(Element, UpdateCollectsParams)
+{
+  sdf::ElementPtr parent = std::make_shared<sdf::Element>();
+  parent->SetName("parent");
+  sdf::ElementPtr childDesc = std::make_shared<sdf::Element>();
+  childDesc->SetName("child");
+  childDesc->AddValue("int", "0", false);
+  parent->AddElementDescription(childDesc);
+  sdf::ElementPtr first = parent->AddElement("child");
+  sdf::ElementPtr second = parent->AddElement("child");
+
+  int calls = 0;
+  first->GetValue()->SetUpdateFunc([&calls]() { return ++calls; });
+  parent->Update();
+  parent->Update();
+  EXPECT_EQ(2, calls);
+  EXPECT_EQ(2, first->Get<int>());
+
+  // Update functions set after the first update are collected.
+  second->GetValue()->SetUpdateFunc([]() { return 5; });
+  parent->Update();
+  EXPECT_EQ(3, first->Get<int>());
+  EXPECT_EQ(5, second->Get<int>());
+
+  // Removed elements are no longer updated.
+  parent->RemoveChild(first);
+  parent->Update();
+  EXPECT_EQ(3, calls);
+}
+
 /////////////////////////////////////////////////
 TEST(Element, CountNamedElements)
 {
@@ -718,6 +1269,368 @@ TEST(Element, CountNamedElements)
   EXPECT_EQ(allMap.at("child3"), 1u);
 }
 
+/////////////////////////////////////////////////
+TEST(Element, DeferredElements)
+{
+  sdf::ElementPtr parent = std::make_shared<sdf::Element>();
+  parent->SetName("plugin");
+  parent->SetDeferredElements("<a b='1'>text</a><c><d/></c>");
+  EXPECT_TRUE(parent->ElementsDeferred());
+
+  // Clones share the deferred elements, and read them independently.
+  sdf::ElementPtr clone = parent->Clone();
+  EXPECT_TRUE(clone->ElementsDeferred());
+
+  sdf::ElementPtr a = parent->GetFirstElement();
+  ASSERT_NE(nullptr, a);
+  EXPECT_FALSE(parent->ElementsDeferred());
+  EXPECT_EQ("a", a->GetName());
+  EXPECT_EQ("1", a->GetAttribute("b")->GetAsString());
+  EXPECT_EQ("text", a->Get<std::string>(""));
+  EXPECT_EQ(parent, a->GetParent());
+  sdf::ElementPtr c = a->GetNextElement();
+  ASSERT_NE(nullptr, c);
+  EXPECT_TRUE(c->HasElement("d"));
+  EXPECT_EQ(nullptr, c->GetNextElement());
+
+  EXPECT_TRUE(clone->ElementsDeferred());
+  EXPECT_EQ(parent->ToString(""), clone->ToString(""));
+  EXPECT_FALSE(clone->ElementsDeferred());
+
+  // Deferred elements that are cleared are never read.
+  parent->SetDeferredElements("<e/>");
+  parent->ClearElements();
+  EXPECT_FALSE(parent->ElementsDeferred());
+  EXPECT_EQ(nullptr, parent->GetFirstElement());
+}
+
+/////////////////////////////////////////////////
+TEST(Element, WideElementLookup)
+{
+  sdf::ElementPtr desc = std::make_shared<sdf::Element>();
+  desc->SetName("child");
+  desc->AddAttribute("name", "string", "", true, "name description");
+
+  sdf::ElementPtr otherDesc = std::make_shared<sdf::Element>();
+  otherDesc->SetName("other");
+
+  sdf::ElementPtr parent = std::make_shared<sdf::Element>();
+  parent->SetName("parent");
+  parent->AddElementDescription(desc);
+  parent->AddElementDescription(otherDesc);
+
+  const int count = 100;
+  sdf::ElementPtr_V children;
+  for (int i = 0; i < count; ++i)
+  {
+    sdf::ElementPtr child = parent->AddElement("child");
+    ASSERT_NE(nullptr, child);
+    child->GetAttribute("name")->Set("child" + std::to_string(i));
+    children.push_back(child);
+  }
+
+  EXPECT_EQ(desc, parent->GetElementDescription("child"));
+  EXPECT_EQ(otherDesc, parent->GetElementDescription("other"));
+  EXPECT_EQ(nullptr, parent->GetElementDescription("missing"));
+
+  // The first child with a name is returned.
+  EXPECT_EQ(children[0], parent->GetElementImpl("child"));
+  EXPECT_FALSE(parent->HasElement("other"));
+  EXPECT_FALSE(parent->HasElement("missing"));
+
+  sdf::ElementPtr other = parent->AddElement("other");
+  EXPECT_EQ(other, parent->GetElementImpl("other"));
+
+  sdf::ElementPtr inserted = std::make_shared<sdf::Element>();
+  inserted->SetName("inserted");
+  inserted->SetParent(parent);
+  parent->InsertElement(inserted);
+  EXPECT_EQ(inserted, parent->GetElementImpl("inserted"));
+
+  // Removing the first child makes the next one with that name the first.
+  parent->RemoveChild(children[0]);
+  EXPECT_EQ(children[1], parent->GetElementImpl("child"));
+  children[1]->RemoveFromParent();
+  EXPECT_EQ(children[2], parent->GetElementImpl("child"));
+  EXPECT_EQ(other, parent->GetElementImpl("other"));
+
+  // Renaming a child updates the lookup.
+  inserted->SetName("renamed");
+  EXPECT_FALSE(parent->HasElement("inserted"));
+  EXPECT_EQ(inserted, parent->GetElementImpl("renamed"));
+
+  sdf::ElementPtr clone = parent->Clone();
+  ASSERT_NE(nullptr, clone->GetElementImpl("child"));
+  EXPECT_EQ("child2", clone->GetElementImpl("child")->Get<std::string>("name"));
+  EXPECT_TRUE(clone->HasElement("renamed"));
+  EXPECT_TRUE(clone->HasElement("other"));
+
+  sdf::ElementPtr copy = std::make_shared<sdf::Element>();
+  copy->Copy(parent);
+  ASSERT_NE(nullptr, copy->GetElementImpl("child"));
+  EXPECT_EQ("child2", copy->GetElementImpl("child")->Get<std::string>("name"));
+  EXPECT_TRUE(copy->HasElement("renamed"));
+
+  parent->ClearElements();
+  EXPECT_FALSE(parent->HasElement("child"));
+  EXPECT_FALSE(parent->HasElement("other"));
+  EXPECT_EQ(nullptr, parent->GetFirstElement());
+
+  sdf::ElementPtr added = parent->GetElement("other");
+  EXPECT_EQ(added, parent->GetElementImpl("other"));
+}
+
+/////////////////////////////////////////////////
+TEST(Element, MemoryFootprint)
+{
+  sdf::ElementPtr model = std::make_shared<sdf::Element>();
+  model->SetName("model");
+  model->AddAttribute("name", "string", "__default__", true);
+  sdf::ElementPtr linkDesc = std::make_shared<sdf::Element>();
+  linkDesc->SetName("link");
+  linkDesc->AddAttribute("name", "string", "__default__", true);
+  linkDesc->AddValue("double", "0", false);
+  model->AddElementDescription(linkDesc);
+  model->AddElement("link");
+  model->AddElement("link");
+
+  sdf::TreeFootprint footprint = model->MemoryFootprint();
+  EXPECT_EQ(3u, footprint.total.elementCount);
+  EXPECT_EQ(5u, footprint.total.paramCount);
+  ASSERT_EQ(2u, footprint.byName.size());
+  EXPECT_EQ(1u, footprint.byName["model"].elementCount);
+  EXPECT_EQ(1u, footprint.byName["model"].paramCount);
+  EXPECT_EQ(2u, footprint.byName["link"].elementCount);
+  EXPECT_EQ(4u, footprint.byName["link"].paramCount);
+  EXPECT_LT(footprint.byName["model"].bytes, footprint.byName["link"].bytes);
+  EXPECT_EQ(footprint.total.bytes,
+      footprint.byName["model"].bytes + footprint.byName["link"].bytes);
+
+  // Long string values are counted.
+  sdf::ElementPtr link = model->GetFirstElement();
+  link->GetAttribute("name")->Set(std::string(1000, 'a'));
+  EXPECT_LE(footprint.total.bytes + 1000, model->MemoryFootprint().total.bytes);
+
+  // Copy-on-write clones of the same source share its content, which is
+  // only counted once.
+  sdf::ElementPtr world = std::make_shared<sdf::Element>();
+  world->SetName("world");
+  sdf::ElementPtr first = model->CopyOnWriteClone();
+  sdf::ElementPtr second = model->CopyOnWriteClone();
+  world->InsertElement(first);
+  world->InsertElement(second);
+  sdf::TreeFootprint worldFootprint = world->MemoryFootprint();
+  EXPECT_EQ(5u, worldFootprint.total.elementCount);
+  EXPECT_EQ(2u, worldFootprint.byName["model"].elementCount);
+  EXPECT_EQ(2u, worldFootprint.byName["link"].elementCount);
+  EXPECT_EQ(5u, worldFootprint.total.paramCount);
+
+  std::ostringstream stream;
+  stream << worldFootprint;
+  EXPECT_EQ(0u, stream.str().find("element"));
+  EXPECT_NE(std::string::npos, stream.str().find("\nlink "));
+  EXPECT_NE(std::string::npos, stream.str().find("\ntotal "));
+}
+
+/////////////////////////////////////////////////
+TEST(Element, Compact)
+{
+  sdf::ElementPtr model = std::make_shared<sdf::Element>();
+  model->SetName("model");
+  sdf::ElementPtr linkDesc = std::make_shared<sdf::Element>();
+  linkDesc->SetName("link");
+  linkDesc->AddAttribute("name", "string", "__default__", true);
+  model->AddElementDescription(linkDesc);
+  for (int i = 0; i < 5; ++i)
+    model->AddElement("link")->GetAttribute("name")->Set(std::to_string(i));
+
+  const std::string before = model->ToString("");
+  const std::size_t bytes = model->MemoryFootprint().total.bytes;
+  model->Compact();
+  EXPECT_GT(bytes, model->MemoryFootprint().total.bytes);
+  EXPECT_EQ(before, model->ToString(""));
+
+  // The content of copy-on-write clones is left to their source.
+  sdf::ElementPtr clone = model->CopyOnWriteClone();
+  clone->Compact();
+  EXPECT_EQ(before, clone->ToString(""));
+
+  // Children can be added after compacting.
+  model->AddElement("link");
+  EXPECT_EQ(6u, model->MemoryFootprint().byName["link"].elementCount);
+}
+
+/////////////////////////////////////////////////
+TEST(Element, Hash)
+{
+  sdf::ElementPtr model = std::make_shared<sdf::Element>();
+  model->SetName("model");
+  model->AddAttribute("name", "string", "__default__", true);
+  sdf::ElementPtr linkDesc = std::make_shared<sdf::Element>();
+  linkDesc->SetName("link");
+  linkDesc->AddAttribute("name", "string", "__default__", true);
+  linkDesc->AddValue("double", "0", false);
+  model->AddElementDescription(linkDesc);
+  sdf::ElementPtr first = model->AddElement("link");
+  sdf::ElementPtr second = model->AddElement("link");
+
+  // Identical subtrees have equal hashes, and clones of a tree have the
+  // hash of the tree.
+  const uint64_t hash = model->Hash();
+  EXPECT_EQ(hash, model->Hash());
+  EXPECT_EQ(first->Hash(), second->Hash());
+  EXPECT_EQ(hash, model->Clone()->Hash());
+  EXPECT_EQ(hash, model->CopyOnWriteClone()->Hash());
+
+  // Changing a value changes the hashes of the element and its ancestors.
+  EXPECT_TRUE(second->Set(2.0));
+  EXPECT_NE(first->Hash(), second->Hash());
+  EXPECT_NE(hash, model->Hash());
+  EXPECT_TRUE(second->Set(0.0));
+  EXPECT_EQ(hash, model->Hash());
+
+  // So do attributes, names and child elements.
+  first->GetAttribute("name")->Set<std::string>("base");
+  EXPECT_NE(hash, model->Hash());
+  first->GetAttribute("name")->Set<std::string>("__default__");
+  EXPECT_EQ(hash, model->Hash());
+
+  second->SetName("other");
+  EXPECT_NE(hash, model->Hash());
+  second->SetName("link");
+  EXPECT_EQ(hash, model->Hash());
+
+  model->RemoveChild(second);
+  const uint64_t oneLinkHash = model->Hash();
+  EXPECT_NE(hash, oneLinkHash);
+  model->InsertElement(second);
+  second->SetParent(model);
+  EXPECT_EQ(hash, model->Hash());
+  model->AddElement("link");
+  EXPECT_NE(hash, model->Hash());
+  model->ClearElements();
+  EXPECT_NE(oneLinkHash, model->Hash());
+
+  // The order of children matters.
+  sdf::ElementPtr a = std::make_shared<sdf::Element>();
+  a->SetName("a");
+  sdf::ElementPtr b = std::make_shared<sdf::Element>();
+  b->SetName("b");
+  sdf::ElementPtr ab = std::make_shared<sdf::Element>();
+  ab->SetName("parent");
+  ab->InsertElement(a);
+  ab->InsertElement(b);
+  sdf::ElementPtr ba = std::make_shared<sdf::Element>();
+  ba->SetName("parent");
+  ba->InsertElement(b->Clone());
+  ba->InsertElement(a->Clone());
+  EXPECT_NE(ab->Hash(), ba->Hash());
+}
+
+/////////////////////////////////////////////////
+/// \brief Make a chain of nested elements, with a value in the deepest.
+/// \param[in] _depth Number of elements.
+/// \return The outermost element.
+sdf::ElementPtr makeElementChain(int _depth)
+{
+  sdf::ElementPtr root(new sdf::Element);
+  root->SetName("a");
+  sdf::ElementPtr leaf = root;
+  for (int i = 1; i < _depth; ++i)
+  {
+    sdf::ElementPtr child(new sdf::Element);
+    child->SetName("a");
+    child->SetParent(leaf);
+    leaf->InsertElement(child);
+    leaf = child;
+  }
+  leaf->AddValue("string", "leaf", false);
+  return root;
+}
+
+/////////////////////////////////////////////////
+TEST(Element, CopyOnWriteCloneHash)
+{
+  sdf::ElementPtr source = makeElementChain(3);
+  sdf::ElementPtr clone = source->CopyOnWriteClone();
+  const uint64_t hash = clone->Hash();
+  EXPECT_EQ(source->Hash(), hash);
+
+  // Editing a grandchild that the clone got after it was hashed changes
+  // the hash of the clone, but not that of its source.
+  sdf::ElementPtr grandchild = clone->GetFirstElement()->GetFirstElement();
+  ASSERT_NE(nullptr, grandchild);
+  EXPECT_EQ(source->GetFirstElement()->GetFirstElement()->Hash(),
+            grandchild->Hash());
+  grandchild->GetValue()->Set<std::string>("edited");
+  EXPECT_NE(hash, clone->Hash());
+  EXPECT_EQ(clone->Clone()->Hash(), clone->Hash());
+  EXPECT_EQ(hash, source->Hash());
+}
+
+/////////////////////////////////////////////////
+TEST(Element, DeepNesting)
+{
+  // Deep enough to overflow the call stack of recursive traversals.
+  const int depth = 200000;
+  sdf::ElementPtr root = makeElementChain(depth);
+
+  int visited = 0;
+  int maxDepth = 0;
+  int current = 0;
+  root->Visit([&](const sdf::Element &)
+      {
+        ++visited;
+        maxDepth = std::max(maxDepth, ++current);
+        return true;
+      },
+      [&](const sdf::Element &)
+      {
+        --current;
+      });
+  EXPECT_EQ(depth, visited);
+  EXPECT_EQ(depth, maxDepth);
+  EXPECT_EQ(0, current);
+
+  sdf::ElementPtr clone = root->Clone();
+  EXPECT_EQ(root->Hash(), clone->Hash());
+  clone->ClearElements();
+  EXPECT_EQ("<a/>\n", clone->ToString(""));
+
+  // The output of ToString grows with the square of the depth, because of
+  // the indentation.
+  const std::string str = makeElementChain(2000)->ToString("");
+  EXPECT_EQ(0u, str.find("<a>\n  <a>\n"));
+  EXPECT_NE(std::string::npos, str.find("<a>leaf</a>\n"));
+  EXPECT_EQ(str.size() - 5u, str.rfind("</a>\n"));
+}
+
+/////////////////////////////////////////////////
+TEST(Element, AppendStartTag)
+{
+  sdf::ElementPtr parent = std::make_shared<sdf::Element>();
+  parent->SetName("parent");
+  parent->AddAttribute("name", "string", "", true, "name description");
+  parent->AddAttribute("unset", "string", "x", false, "unset description");
+  parent->GetAttribute("name")->Set<std::string>("p");
+
+  sdf::ElementPtr child = std::make_shared<sdf::Element>();
+  child->SetName("child");
+  child->AddValue("string", "value", false, "child description");
+  parent->InsertElement(child);
+
+  // The start tag has the attributes that ToString prints, and is printed
+  // whether or not the element has children.
+  std::string buffer = "x";
+  parent->AppendStartTag("  ", buffer);
+  EXPECT_EQ("x  <parent name='p'>\n", buffer);
+  EXPECT_EQ(0u, parent->ToString("  ").find(buffer.substr(1)));
+
+  buffer.clear();
+  child->AppendStartTag("", buffer);
+  EXPECT_EQ("<child>\n", buffer);
+}
+
 /////////////////////////////////////////////////
 /// Main
 int main(int argc, char **argv)
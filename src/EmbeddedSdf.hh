@@ -18,8 +18,8 @@
 #ifndef SDF_EMBEDDEDSDF_HH_
 #define SDF_EMBEDDEDSDF_HH_
 
-#include <map>
-#include <string>
+#include <cstddef>
+#include <string_view>
 
 #include "sdf/Types.hh"
 
@@ -30,11 +30,216 @@ namespace sdf
   //
 
   /// \internal
+  /// \brief The contents of the *.sdf files or of the *.convert files of
+  /// one version, embedded in the library. When the library is built with
+  /// zlib, the contents are compressed, and decompressed the first time a
+  /// file of the group is read, so that only the versions that are used
+  /// take memory.
+  struct EmbeddedSdfGroup
+  {
+    /// \brief The contents, compressed or not.
+    const unsigned char *data;
 
-  /// A map where the keys are a source-relative pathnames within the "sdf"
-  /// directory such as "1.8/root.sdf", and the values are the contents of
-  /// that source file.
-  const std::map<std::string, std::string> &GetEmbeddedSdf();
+    /// \brief Number of bytes of data.
+    std::size_t dataSize;
+
+    /// \brief Number of bytes of the decompressed contents.
+    std::size_t size;
+
+    /// \brief True if the data is compressed with zlib.
+    bool compressed;
+  };
+
+  /// \internal
+  /// \brief A file of the "sdf" source directory embedded in the library.
+  /// The files are constant data, so nothing is built or allocated for them
+  /// at startup, and the files of unused versions are never paged in.
+  struct EmbeddedSdfFile
+  {
+    /// \brief Get the content of the file, decompressing its group if it
+    /// was not read before. The content is followed by a null character,
+    /// so Content().data() can be passed to functions that take a C
+    /// string. It may be called from several threads at once.
+    /// \return The content, which lives as long as the library, or an
+    /// empty string if the group could not be decompressed.
+    std::string_view Content() const;
+
+    /// \brief Version directory of the file, such as "1.8".
+    std::string_view version;
+
+    /// \brief Name of the file, such as "root.sdf" or "1_7.convert".
+    std::string_view name;
+
+    /// \brief Index of the group of the file.
+    std::size_t group;
+
+    /// \brief Position of the content of the file in its group.
+    std::size_t offset;
+
+    /// \brief Number of bytes of the content of the file.
+    std::size_t size;
+
+    /// \brief Index of the root element of the precompiled description of
+    /// the file in the element table, or -1 if it is not a *.sdf file.
+    int description;
+  };
+
+  /// \internal
+  /// \brief The embedded files, sorted by version and then by name.
+  struct EmbeddedSdfFiles
+  {
+    /// \brief The first file.
+    const EmbeddedSdfFile *first;
+
+    /// \brief Number of files.
+    std::size_t count;
+
+    /// \brief Get the first file, for range-based for loops.
+    /// \return The first file.
+    constexpr const EmbeddedSdfFile *begin() const
+    {
+      return this->first;
+    }
+
+    /// \brief Get the end of the files, for range-based for loops.
+    /// \return One past the last file.
+    constexpr const EmbeddedSdfFile *end() const
+    {
+      return this->first + this->count;
+    }
+  };
+
+  /// \internal
+  /// \brief A recipe that upgrades documents of one version to the next.
+  struct EmbeddedSdfConversion
+  {
+    /// \brief The version the recipe upgrades from, such as "1.7".
+    std::string_view fromVersion;
+
+    /// \brief Index of the recipe in the file table.
+    std::size_t file;
+  };
+
+  /// \internal
+  /// \brief Get all the embedded files.
+  /// \return The files.
+  const EmbeddedSdfFiles &GetEmbeddedSdfFiles();
+
+  /// \internal
+  /// \brief Find an embedded file with a binary search.
+  /// \param[in] _version Version directory of the file, such as "1.8".
+  /// \param[in] _name Name of the file, such as "root.sdf".
+  /// \return The file, or nullptr if it is not embedded.
+  const EmbeddedSdfFile *FindEmbeddedSdf(std::string_view _version,
+      std::string_view _name);
+
+  /// \internal
+  /// \brief Find the recipe that upgrades documents of a version to the
+  /// next version, with a binary search.
+  /// \param[in] _fromVersion The version, such as "1.7".
+  /// \return The recipe, such as the file "1_7.convert" of version "1.8",
+  /// or nullptr if there is none.
+  const EmbeddedSdfFile *FindEmbeddedSdfConversion(
+      std::string_view _fromVersion);
+
+  /// \internal
+  /// \brief An attribute of a precompiled element description.
+  struct EmbeddedSdfAttribute
+  {
+    /// \brief Name of the attribute.
+    const char *name;
+
+    /// \brief Type of the attribute.
+    const char *type;
+
+    /// \brief Default value of the attribute.
+    const char *defaultValue;
+
+    /// \brief True if the attribute is required.
+    bool required;
+
+    /// \brief Description of the attribute, or nullptr if it has none.
+    const char *description;
+  };
+
+  /// \internal
+  /// \brief A child of a precompiled element description. The child is
+  /// either another element description or the root element of an included
+  /// description file.
+  struct EmbeddedSdfChild
+  {
+    /// \brief Index of the child in the element table, or -1 if the child
+    /// is an included file.
+    int element;
+
+    /// \brief File name of the included file, or nullptr.
+    const char *filename;
+
+    /// \brief Description that overrides the one of the included file,
+    /// or nullptr.
+    const char *description;
+  };
+
+  /// \internal
+  /// \brief An element description, precompiled from one of the
+  /// description files of the specification.
+  struct EmbeddedSdfElement
+  {
+    /// \brief Name of the element.
+    const char *name;
+
+    /// \brief Required string of the element, such as "0", "1" or "*".
+    const char *required;
+
+    /// \brief Type of the element value, or nullptr if it has no value.
+    const char *type;
+
+    /// \brief Default value of the element value, or nullptr.
+    const char *defaultValue;
+
+    /// \brief Description of the element, or nullptr if it has none.
+    const char *description;
+
+    /// \brief Name of the reference SDF, or nullptr.
+    const char *ref;
+
+    /// \brief True if the element copies its children.
+    bool copyChildren;
+
+    /// \brief Index of the first attribute in the attribute table.
+    unsigned int firstAttribute;
+
+    /// \brief Number of attributes.
+    unsigned int attributeCount;
+
+    /// \brief Index of the first child in the child table.
+    unsigned int firstChild;
+
+    /// \brief Number of children.
+    unsigned int childCount;
+  };
+
+  /// \internal
+  /// \brief Tables holding every precompiled element description.
+  struct EmbeddedSdfDescriptions
+  {
+    /// \brief All element descriptions.
+    const EmbeddedSdfElement *elements;
+
+    /// \brief All attributes, referenced by EmbeddedSdfElement.
+    const EmbeddedSdfAttribute *attributes;
+
+    /// \brief All children, referenced by EmbeddedSdfElement. The root
+    /// element of each file is referenced by EmbeddedSdfFile::description.
+    const EmbeddedSdfChild *children;
+  };
+
+  /// \internal
+  /// \brief Get the element descriptions of all the embedded *.sdf files,
+  /// precompiled when the library is built. They are equivalent to the
+  /// descriptions obtained by parsing the files of GetEmbeddedSdfFiles(),
+  /// without having to parse XML at runtime.
+  const EmbeddedSdfDescriptions &GetEmbeddedSdfDescriptions();
 }
 }
 #endif
@@ -0,0 +1,236 @@
+/*
+ * Copyright 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+#include <tinyxml.h>
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "sdf/Element.hh"
+#include "sdf/Param.hh"
+#include "sdf/SDFImpl.hh"
+#include "sdf/Types.hh"
+#include "sdf/parser.hh"
+#include "EmbeddedSdf.hh"
+
+/////////////////////////////////////////////////
+/// \brief Build an element description by parsing the embedded XML of the
+/// given version, following the same rules as parser.cc:initXml. Used as
+/// the reference for the precompiled descriptions.
+void initXmlReference(const std::string &_version, TiXmlElement *_xml,
+    sdf::ElementPtr _sdf)
+{
+  const char *ref = _xml->Attribute("ref");
+  if (ref)
+    _sdf->SetReferenceSDF(ref);
+
+  ASSERT_NE(nullptr, _xml->Attribute("name"));
+  ASSERT_NE(nullptr, _xml->Attribute("required"));
+  _sdf->SetName(_xml->Attribute("name"));
+  _sdf->SetRequired(_xml->Attribute("required"));
+
+  std::string description;
+  TiXmlElement *descChild = _xml->FirstChildElement("description");
+  if (descChild && descChild->GetText())
+    description = descChild->GetText();
+
+  const char *type = _xml->Attribute("type");
+  if (type)
+  {
+    const char *defaultValue = _xml->Attribute("default");
+    _sdf->AddValue(type, defaultValue ? defaultValue : "",
+        std::string(_xml->Attribute("required")) == "1", description);
+  }
+
+  for (TiXmlElement *child = _xml->FirstChildElement("attribute");
+       child; child = child->NextSiblingElement("attribute"))
+  {
+    std::string attrDescription;
+    TiXmlElement *attrDesc = child->FirstChildElement("description");
+    if (attrDesc && attrDesc->GetText())
+      attrDescription = attrDesc->GetText();
+
+    _sdf->AddAttribute(child->Attribute("name"), child->Attribute("type"),
+        child->Attribute("default"),
+        sdf::trim(child->Attribute("required")) == "1", attrDescription);
+  }
+
+  if (!description.empty())
+    _sdf->SetDescription(description);
+
+  for (TiXmlElement *child = _xml->FirstChildElement("element");
+       child; child = child->NextSiblingElement("element"))
+  {
+    const char *copyData = child->Attribute("copy_data");
+    if (copyData &&
+        (std::string(copyData) == "true" || std::string(copyData) == "1"))
+    {
+      _sdf->SetCopyChildren(true);
+    }
+    else
+    {
+      sdf::ElementPtr element(new sdf::Element);
+      initXmlReference(_version, child, element);
+      _sdf->AddElementDescription(element);
+    }
+  }
+
+  for (TiXmlElement *child = _xml->FirstChildElement("include");
+       child; child = child->NextSiblingElement("include"))
+  {
+    const std::string pathname =
+        _version + "/" + child->Attribute("filename");
+    const sdf::EmbeddedSdfFile *file =
+        sdf::FindEmbeddedSdf(_version, child->Attribute("filename"));
+    ASSERT_NE(nullptr, file) << pathname;
+
+    TiXmlDocument xmlDoc;
+    xmlDoc.Parse(file->Content().data());
+    ASSERT_FALSE(xmlDoc.Error()) << pathname;
+
+    sdf::ElementPtr element(new sdf::Element);
+    initXmlReference(_version, xmlDoc.FirstChildElement("element"), element);
+
+    TiXmlElement *includeDesc = child->FirstChildElement("description");
+    if (includeDesc)
+      element->SetDescription(includeDesc->GetText());
+
+    _sdf->AddElementDescription(element);
+  }
+}
+
+/////////////////////////////////////////////////
+/// \brief Check that two parameter descriptions are identical.
+void expectSameParam(sdf::ParamPtr _expected, sdf::ParamPtr _actual,
+    const std::string &_path)
+{
+  ASSERT_NE(nullptr, _actual) << _path;
+  EXPECT_EQ(_expected->GetKey(), _actual->GetKey()) << _path;
+  EXPECT_EQ(_expected->GetTypeName(), _actual->GetTypeName()) << _path;
+  EXPECT_EQ(_expected->GetDefaultAsString(), _actual->GetDefaultAsString())
+    << _path;
+  EXPECT_EQ(_expected->GetRequired(), _actual->GetRequired()) << _path;
+  EXPECT_EQ(_expected->GetDescription(), _actual->GetDescription()) << _path;
+}
+
+/////////////////////////////////////////////////
+/// \brief Check that two element descriptions are identical.
+void expectSameDescription(sdf::ElementPtr _expected, sdf::ElementPtr _actual,
+    const std::string &_path)
+{
+  const std::string path = _path + "/" + _expected->GetName();
+  ASSERT_NE(nullptr, _actual) << path;
+  EXPECT_EQ(_expected->GetName(), _actual->GetName()) << path;
+  EXPECT_EQ(_expected->GetRequired(), _actual->GetRequired()) << path;
+  EXPECT_EQ(_expected->GetDescription(), _actual->GetDescription()) << path;
+  EXPECT_EQ(_expected->ReferenceSDF(), _actual->ReferenceSDF()) << path;
+  EXPECT_EQ(_expected->GetCopyChildren(), _actual->GetCopyChildren()) << path;
+
+  ASSERT_EQ(nullptr == _expected->GetValue(), nullptr == _actual->GetValue())
+    << path;
+  if (_expected->GetValue())
+    expectSameParam(_expected->GetValue(), _actual->GetValue(), path);
+
+  ASSERT_EQ(_expected->GetAttributeCount(), _actual->GetAttributeCount())
+    << path;
+  for (unsigned int i = 0; i < _expected->GetAttributeCount(); ++i)
+  {
+    expectSameParam(_expected->GetAttribute(i), _actual->GetAttribute(i),
+        path);
+  }
+
+  ASSERT_EQ(_expected->GetElementDescriptionCount(),
+      _actual->GetElementDescriptionCount()) << path;
+  for (unsigned int i = 0; i < _expected->GetElementDescriptionCount(); ++i)
+  {
+    expectSameDescription(_expected->GetElementDescription(i),
+        _actual->GetElementDescription(i), path);
+  }
+}
+
+/////////////////////////////////////////////////
+/// Check that the precompiled description of every supported version is
+/// identical to the one obtained by parsing the embedded XML.
+TEST(EmbeddedSdf, PrecompiledDescriptions)
+{
+  std::vector<std::string> versions;
+  for (const sdf::EmbeddedSdfFile &file : sdf::GetEmbeddedSdfFiles())
+  {
+    if (file.name == "root.sdf" && file.description >= 0)
+    {
+      versions.push_back(std::string(file.version));
+    }
+  }
+  EXPECT_FALSE(versions.empty());
+
+  const std::string originalVersion = sdf::SDF::Version();
+  for (const auto &version : versions)
+  {
+    sdf::SDF::Version(version);
+
+    TiXmlDocument xmlDoc;
+    xmlDoc.Parse(sdf::FindEmbeddedSdf(version, "root.sdf")->Content().data());
+    ASSERT_FALSE(xmlDoc.Error()) << version;
+
+    sdf::ElementPtr expected(new sdf::Element);
+    initXmlReference(version, xmlDoc.FirstChildElement("element"), expected);
+
+    sdf::SDFPtr actual(new sdf::SDF);
+    EXPECT_TRUE(sdf::init(actual));
+
+    expectSameDescription(expected, actual->Root(), version);
+  }
+  sdf::SDF::Version(originalVersion);
+}
+
+/////////////////////////////////////////////////
+TEST(EmbeddedSdf, FindFiles)
+{
+  const sdf::EmbeddedSdfFiles &files = sdf::GetEmbeddedSdfFiles();
+  ASSERT_GT(files.count, 0u);
+
+  const sdf::EmbeddedSdfFile *previous = nullptr;
+  for (const sdf::EmbeddedSdfFile &file : files)
+  {
+    if (previous)
+    {
+      EXPECT_TRUE(previous->version < file.version ||
+          (previous->version == file.version && previous->name < file.name))
+        << file.version << "/" << file.name;
+    }
+    previous = &file;
+
+    EXPECT_EQ(&file, sdf::FindEmbeddedSdf(file.version, file.name));
+    const std::string_view content = file.Content();
+    ASSERT_FALSE(content.empty()) << file.version << "/" << file.name;
+    EXPECT_EQ('\n', content.front());
+    EXPECT_EQ('\n', content.back());
+    EXPECT_EQ('\0', content.data()[content.size()]);
+    EXPECT_EQ(content.data(), file.Content().data());
+  }
+
+  EXPECT_EQ(nullptr, sdf::FindEmbeddedSdf("1.8", "missing.sdf"));
+  EXPECT_EQ(nullptr, sdf::FindEmbeddedSdf("0.0", "root.sdf"));
+
+  const sdf::EmbeddedSdfFile *convert = sdf::FindEmbeddedSdfConversion("1.7");
+  ASSERT_NE(nullptr, convert);
+  EXPECT_EQ("1.8", convert->version);
+  EXPECT_EQ("1_7.convert", convert->name);
+  EXPECT_EQ(nullptr, sdf::FindEmbeddedSdfConversion(SDF_VERSION));
+}
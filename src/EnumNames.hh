@@ -0,0 +1,185 @@
+/*
+ * Copyright 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef SDF_ENUMNAMES_HH_
+#define SDF_ENUMNAMES_HH_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string_view>
+
+#include "sdf/sdf_config.h"
+
+namespace sdf
+{
+  // Inline bracket to help doxygen filtering.
+  inline namespace SDF_VERSION_NAMESPACE {
+  //
+
+  /// \brief A name of a value of an enum, for EnumNames.
+  template <typename EnumT>
+  struct EnumName
+  {
+    /// \brief The name.
+    std::string_view name;
+
+    /// \brief The value.
+    EnumT value;
+  };
+
+  /// \brief A mapping between the values of an enum and their names, such
+  /// as the sensor types and their type attributes, with a perfect hash of
+  /// the names computed at compile time. Finding the value of a name costs
+  /// one hash and one string comparison, instead of comparing the name with
+  /// each of the names, and finding the name of a value is an array access.
+  ///
+  /// The mappings are namespace scope constants of the DOM sources:
+  ///
+  ///     constexpr auto kLightTypes = makeEnumNames<LightType>({
+  ///         {"point", LightType::POINT},
+  ///         {"spot", LightType::SPOT},
+  ///         {"directional", LightType::DIRECTIONAL}});
+  ///
+  /// The names must be distinct. A value may have several names, in which
+  /// case the first one is the name of the value and the others are
+  /// aliases. The values must be between 0 and four times the number of
+  /// names.
+  template <typename EnumT, std::size_t N>
+  class EnumNames
+  {
+    /// \brief Constructor, which finds a perfect hash of the names.
+    /// \param[in] _names The names, as described above.
+    /// \throws std::invalid_argument if the names are not valid, which is a
+    /// compile error for constexpr mappings.
+    public: constexpr explicit EnumNames(const EnumName<EnumT> (&_names)[N])
+    {
+      for (std::size_t i = 0; i < N; ++i)
+      {
+        this->names[i] = _names[i].name;
+        this->values[i] = _names[i].value;
+        const std::size_t value = static_cast<std::size_t>(_names[i].value);
+        if (value >= kSlotCount)
+          throw std::invalid_argument("enum value out of range");
+        if (this->byValue[value].empty())
+          this->byValue[value] = _names[i].name;
+      }
+
+      // Try seeds until the names hash to distinct slots. With four slots
+      // per name, a few seeds are usually enough.
+      for (this->seed = 0; this->seed < kMaxSeed; ++this->seed)
+      {
+        if (this->FillSlots())
+          return;
+      }
+      throw std::invalid_argument("no perfect hash of the enum names");
+    }
+
+    /// \brief Find the value of a name.
+    /// \param[in] _name The name.
+    /// \param[out] _value The value, if the name is found.
+    /// \return True if the name is found.
+    public: constexpr bool Find(std::string_view _name, EnumT &_value) const
+    {
+      const std::uint8_t index = this->slots[this->Slot(_name)];
+      if (index == kEmpty || this->names[index] != _name)
+        return false;
+      _value = this->values[index];
+      return true;
+    }
+
+    /// \brief Get the name of a value, which is its first name.
+    /// \param[in] _value The value.
+    /// \return The name, or an empty string if the value has no name.
+    public: constexpr std::string_view Name(EnumT _value) const
+    {
+      const std::size_t value = static_cast<std::size_t>(_value);
+      return value < this->byValue.size() ? this->byValue[value] :
+          std::string_view();
+    }
+
+    /// \brief Get the slot of a name, with the current seed.
+    /// \param[in] _name The name.
+    /// \return The slot.
+    private: constexpr std::size_t Slot(std::string_view _name) const
+    {
+      // FNV-1a, with the seed mixed into the offset basis.
+      std::uint32_t hash = 2166136261u ^ this->seed;
+      for (char c : _name)
+      {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 16777619u;
+      }
+      return hash % kSlotCount;
+    }
+
+    /// \brief Fill the slots with the indices of the names, with the
+    /// current seed.
+    /// \return False if two names have the same slot.
+    private: constexpr bool FillSlots()
+    {
+      for (std::uint8_t &slot : this->slots)
+        slot = kEmpty;
+      for (std::size_t i = 0; i < N; ++i)
+      {
+        std::uint8_t &slot = this->slots[this->Slot(this->names[i])];
+        if (slot != kEmpty)
+          return false;
+        slot = static_cast<std::uint8_t>(i);
+      }
+      return true;
+    }
+
+    /// \brief Number of slots of the hash table.
+    private: static constexpr std::size_t kSlotCount = 4 * N + 1;
+
+    /// \brief Index of an empty slot.
+    private: static constexpr std::uint8_t kEmpty = 0xFF;
+
+    /// \brief Number of seeds tried before giving up.
+    private: static constexpr std::uint32_t kMaxSeed = 4096;
+
+    static_assert(N > 0 && N < kEmpty, "unsupported number of enum names");
+
+    /// \brief The names.
+    private: std::array<std::string_view, N> names{};
+
+    /// \brief The values of the names.
+    private: std::array<EnumT, N> values{};
+
+    /// \brief The name of each value.
+    private: std::array<std::string_view, kSlotCount> byValue{};
+
+    /// \brief Index of the name of each slot, or kEmpty.
+    private: std::array<std::uint8_t, kSlotCount> slots{};
+
+    /// \brief Seed of the hash.
+    private: std::uint32_t seed = 0;
+  };
+
+  /// \brief Make a mapping between the values of an enum and their names.
+  /// \param[in] _names The names, as described in EnumNames.
+  /// \return The mapping.
+  template <typename EnumT, std::size_t N>
+  constexpr EnumNames<EnumT, N> makeEnumNames(
+      const EnumName<EnumT> (&_names)[N])
+  {
+    return EnumNames<EnumT, N>(_names);
+  }
+  }
+}
+#endif
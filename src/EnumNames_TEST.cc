@@ -0,0 +1,82 @@
+/*
+ * Copyright 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+#include <string>
+
+#include "sdf/Sensor.hh"
+#include "EnumNames.hh"
+
+/////////////////////////////////////////////////
+TEST(EnumNames, FindAndName)
+{
+  constexpr auto names = sdf::makeEnumNames<sdf::SensorType>({
+      {"lidar", sdf::SensorType::LIDAR},
+      {"imu", sdf::SensorType::IMU},
+      {"camera", sdf::SensorType::CAMERA},
+      {"ray", sdf::SensorType::LIDAR}});
+  static_assert(names.Name(sdf::SensorType::IMU) == "imu");
+
+  sdf::SensorType type = sdf::SensorType::NONE;
+  EXPECT_TRUE(names.Find("camera", type));
+  EXPECT_EQ(sdf::SensorType::CAMERA, type);
+
+  // An alias finds its value, which is named after its first name.
+  EXPECT_TRUE(names.Find("ray", type));
+  EXPECT_EQ(sdf::SensorType::LIDAR, type);
+  EXPECT_EQ("lidar", names.Name(type));
+
+  // Unknown names leave the value unchanged.
+  EXPECT_FALSE(names.Find("lidar2", type));
+  EXPECT_FALSE(names.Find("", type));
+  EXPECT_FALSE(names.Find("Camera", type));
+  EXPECT_EQ(sdf::SensorType::LIDAR, type);
+
+  // Values without name.
+  EXPECT_TRUE(names.Name(sdf::SensorType::NONE).empty());
+  EXPECT_TRUE(names.Name(sdf::SensorType::THERMAL_CAMERA).empty());
+}
+
+/////////////////////////////////////////////////
+TEST(EnumNames, ManyNames)
+{
+  enum class Index { FIRST = 0, LAST = 40 };
+  constexpr auto names = sdf::makeEnumNames<Index>({
+      {"n0", Index{0}}, {"n1", Index{1}}, {"n2", Index{2}},
+      {"n3", Index{3}}, {"n4", Index{4}}, {"n5", Index{5}},
+      {"n6", Index{6}}, {"n7", Index{7}}, {"n8", Index{8}},
+      {"n9", Index{9}}, {"n10", Index{10}}, {"n11", Index{11}},
+      {"n12", Index{12}}, {"n13", Index{13}}, {"n14", Index{14}},
+      {"n15", Index{15}}, {"n16", Index{16}}, {"n17", Index{17}},
+      {"n18", Index{18}}, {"n19", Index{19}}, {"n20", Index{20}},
+      {"n21", Index{21}}, {"n22", Index{22}}, {"n23", Index{23}},
+      {"n24", Index{24}}, {"n25", Index{25}}, {"n26", Index{26}},
+      {"n27", Index{27}}, {"n28", Index{28}}, {"n29", Index{29}},
+      {"n30", Index{30}}, {"n31", Index{31}}, {"n32", Index{32}},
+      {"n33", Index{33}}, {"n34", Index{34}}, {"n35", Index{35}},
+      {"n36", Index{36}}, {"n37", Index{37}}, {"n38", Index{38}},
+      {"n39", Index{39}}, {"n40", Index{40}}});
+
+  for (int i = 0; i <= 40; ++i)
+  {
+    const std::string name = "n" + std::to_string(i);
+    Index index = Index::FIRST;
+    EXPECT_TRUE(names.Find(name, index)) << name;
+    EXPECT_EQ(i, static_cast<int>(index));
+    EXPECT_EQ(name, names.Name(index));
+  }
+}
@@ -16,6 +16,7 @@
 */
 
 #include "sdf/Error.hh"
+#include "Utils.hh"
 
 using namespace sdf;
 
@@ -24,6 +25,9 @@ Error::Error(const ErrorCode _code, const std::string &_message)
 {
   this->code = _code;
   this->message = _message;
+
+  if (ErrorLimit *limit = ErrorLimit::Current())
+    limit->Count();
 }
 
 /////////////////////////////////////////////////
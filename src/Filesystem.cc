@@ -49,11 +49,14 @@
 #include <sys/types.h>
 #include <unistd.h>
 #else
+#include <sys/stat.h>
+#include <sys/types.h>
 #include <windows.h>
 #include <winnt.h>
 #endif
 
 #include "sdf/Filesystem.hh"
+#include "Archive.hh"
 
 namespace sdf
 {
@@ -89,6 +92,12 @@ static const char preferred_separator = '/';
 //////////////////////////////////////////////////
 bool exists(const std::string &_path)
 {
+  file_status archived;
+  if (archiveStatus(_path, archived))
+  {
+    return archived.exists();
+  }
+
   struct stat path_stat;
 
   return ::stat(_path.c_str(), &path_stat) == 0;
@@ -97,6 +106,12 @@ bool exists(const std::string &_path)
 //////////////////////////////////////////////////
 bool is_directory(const std::string &_path)
 {
+  file_status archived;
+  if (archiveStatus(_path, archived))
+  {
+    return archived.is_directory();
+  }
+
   struct stat path_stat;
 
   if (::stat(_path.c_str(), &path_stat) != 0)
@@ -107,6 +122,57 @@ bool is_directory(const std::string &_path)
   return S_ISDIR(path_stat.st_mode);
 }
 
+//////////////////////////////////////////////////
+std::time_t last_write_time(const std::string &_path)
+{
+  file_status archived;
+  if (archiveStatus(_path, archived))
+  {
+    return archived.write_time;
+  }
+
+  struct stat path_stat;
+
+  if (::stat(_path.c_str(), &path_stat) != 0)
+  {
+    return static_cast<std::time_t>(-1);
+  }
+
+  return path_stat.st_mtime;
+}
+
+//////////////////////////////////////////////////
+file_status status(const std::string &_path)
+{
+  file_status result;
+  if (archiveStatus(_path, result))
+  {
+    return result;
+  }
+
+  struct stat path_stat;
+
+  if (::stat(_path.c_str(), &path_stat) != 0)
+  {
+    return result;
+  }
+
+  if (S_ISDIR(path_stat.st_mode))
+  {
+    result.type = file_type::directory;
+  }
+  else if (S_ISREG(path_stat.st_mode))
+  {
+    result.type = file_type::regular;
+  }
+  else
+  {
+    result.type = file_type::other;
+  }
+  result.write_time = path_stat.st_mtime;
+  return result;
+}
+
 //////////////////////////////////////////////////
 bool create_directory(const std::string &_path)
 {
@@ -381,6 +447,12 @@ bool internal_check_path(const std::string &_path, DWORD &attr)
 //////////////////////////////////////////////////
 bool exists(const std::string &_path)
 {
+  file_status archived;
+  if (archiveStatus(_path, archived))
+  {
+    return archived.exists();
+  }
+
   DWORD attr;
 
   return internal_check_path(_path, attr);
@@ -389,6 +461,12 @@ bool exists(const std::string &_path)
 //////////////////////////////////////////////////
 bool is_directory(const std::string &_path)
 {
+  file_status archived;
+  if (archiveStatus(_path, archived))
+  {
+    return archived.is_directory();
+  }
+
   DWORD attr;
 
   if (internal_check_path(_path, attr))
@@ -399,6 +477,57 @@ bool is_directory(const std::string &_path)
   return false;
 }
 
+//////////////////////////////////////////////////
+std::time_t last_write_time(const std::string &_path)
+{
+  file_status archived;
+  if (archiveStatus(_path, archived))
+  {
+    return archived.write_time;
+  }
+
+  struct _stat64 path_stat;
+
+  if (::_stat64(_path.c_str(), &path_stat) != 0)
+  {
+    return static_cast<std::time_t>(-1);
+  }
+
+  return static_cast<std::time_t>(path_stat.st_mtime);
+}
+
+//////////////////////////////////////////////////
+file_status status(const std::string &_path)
+{
+  file_status result;
+  if (archiveStatus(_path, result))
+  {
+    return result;
+  }
+
+  DWORD attr;
+
+  if (!internal_check_path(_path, attr))
+  {
+    return result;
+  }
+
+  if (attr & FILE_ATTRIBUTE_DIRECTORY)
+  {
+    result.type = file_type::directory;
+  }
+  else if (attr & FILE_ATTRIBUTE_DEVICE)
+  {
+    result.type = file_type::other;
+  }
+  else
+  {
+    result.type = file_type::regular;
+  }
+  result.write_time = last_write_time(_path);
+  return result;
+}
+
 //////////////////////////////////////////////////
 bool create_directory(const std::string &_path)
 {
@@ -196,6 +196,49 @@ TEST(Filesystem, exists)
   EXPECT_FALSE(sdf::filesystem::is_directory("newfile"));
 }
 
+/////////////////////////////////////////////////
+TEST(Filesystem, last_write_time)
+{
+  std::string new_temp_dir;
+  ASSERT_TRUE(create_and_switch_to_temp_dir(new_temp_dir));
+  ASSERT_TRUE(create_new_empty_file("newfile"));
+
+  EXPECT_NE(static_cast<std::time_t>(-1),
+      sdf::filesystem::last_write_time("newfile"));
+  EXPECT_EQ(static_cast<std::time_t>(-1),
+      sdf::filesystem::last_write_time("notcreated"));
+}
+
+/////////////////////////////////////////////////
+TEST(Filesystem, status)
+{
+  std::string new_temp_dir;
+  ASSERT_TRUE(create_and_switch_to_temp_dir(new_temp_dir));
+  ASSERT_TRUE(create_new_empty_file("newfile"));
+  ASSERT_TRUE(sdf::filesystem::create_directory("fsteststatus"));
+
+  sdf::filesystem::file_status fileStatus =
+    sdf::filesystem::status("newfile");
+  EXPECT_EQ(sdf::filesystem::file_type::regular, fileStatus.type);
+  EXPECT_TRUE(fileStatus.exists());
+  EXPECT_FALSE(fileStatus.is_directory());
+  EXPECT_EQ(sdf::filesystem::last_write_time("newfile"),
+      fileStatus.write_time);
+
+  sdf::filesystem::file_status dirStatus =
+    sdf::filesystem::status("fsteststatus");
+  EXPECT_EQ(sdf::filesystem::file_type::directory, dirStatus.type);
+  EXPECT_TRUE(dirStatus.exists());
+  EXPECT_TRUE(dirStatus.is_directory());
+
+  sdf::filesystem::file_status missingStatus =
+    sdf::filesystem::status("notcreated");
+  EXPECT_EQ(sdf::filesystem::file_type::not_found, missingStatus.type);
+  EXPECT_FALSE(missingStatus.exists());
+  EXPECT_FALSE(missingStatus.is_directory());
+  EXPECT_EQ(static_cast<std::time_t>(-1), missingStatus.write_time);
+}
+
 #ifndef _MSC_VER
 /////////////////////////////////////////////////
 TEST(Filesystem, symlink_exists)
@@ -0,0 +1,54 @@
+/*
+ * Copyright 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef SDF_FLATFORMAT_HH_
+#define SDF_FLATFORMAT_HH_
+
+#include <string>
+
+#include "sdf/Root.hh"
+#include "sdf/Types.hh"
+#include "sdf/sdf_config.h"
+
+/// \file FlatFormat.hh
+/// \brief Flat serialization of the typed DOM, read in place by FlatRoot.
+///
+/// A flat buffer starts with a header record holding the 4 bytes "SDFF",
+/// the format version, a byte order mark, the size of the buffer, the
+/// SDFormat version and the arrays of worlds and of models that are not in
+/// a world. Every other record is reached from the header. Records have a
+/// fixed size and are aligned to 8 bytes. A record refers to an array of
+/// child records, such as the links of a model, by the offset of its first
+/// element and the number of elements, and to a string by its offset and
+/// size. Strings are stored once each, followed by a null character.
+/// Offsets are counted from the start of the buffer, so the buffer can be
+/// mapped at any address.
+
+namespace sdf
+{
+  // Inline bracket to help doxygen filtering.
+  inline namespace SDF_VERSION_NAMESPACE {
+  //
+
+  /// \brief Write the worlds and models of a root to a flat buffer.
+  /// \param[in] _root The root.
+  /// \param[out] _out The buffer.
+  /// \return Errors of resolving poses. The poses that cannot be resolved
+  /// are written as raw poses.
+  Errors writeFlat(const Root &_root, std::string &_out);
+  }
+}
+#endif
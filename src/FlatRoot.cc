@@ -0,0 +1,1030 @@
+/*
+ * Copyright 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#include <ignition/math/Inertial.hh>
+
+#include "sdf/FlatRoot.hh"
+#include "sdf/JointAxis.hh"
+#include "sdf/KinematicTree.hh"
+#include "sdf/Link.hh"
+#include "sdf/Model.hh"
+#include "sdf/World.hh"
+#include "FlatFormat.hh"
+
+using namespace sdf;
+
+namespace
+{
+  /// \brief First bytes of a flat buffer.
+  const char kMagic[4] = {'S', 'D', 'F', 'F'};
+
+  /// \brief Version of the flat format, which is increased whenever the
+  /// layout of the records changes.
+  const std::uint32_t kFormatVersion = 1;
+
+  /// \brief Written in native byte order, to detect buffers written on a
+  /// machine with another byte order.
+  const std::uint32_t kByteOrderMark = 0x01020304;
+
+  /// \brief A string: offset of its first character, and its size without
+  /// the null character that follows it.
+  struct StringRecord
+  {
+    std::uint64_t offset;
+    std::uint64_t size;
+  };
+
+  /// \brief An array of records: offset of its first record, and its
+  /// number of records.
+  struct ArrayRecord
+  {
+    std::uint64_t offset;
+    std::uint64_t count;
+  };
+
+  /// \brief A pose: position, then orientation as w, x, y and z.
+  struct PoseRecord
+  {
+    double position[3];
+    double orientation[4];
+  };
+
+  /// \brief First record of a buffer.
+  struct HeaderRecord
+  {
+    char magic[4];
+    std::uint32_t formatVersion;
+    std::uint32_t byteOrderMark;
+    std::uint32_t reserved;
+    std::uint64_t size;
+    StringRecord version;
+    ArrayRecord worlds;
+    ArrayRecord models;
+  };
+
+  /// \brief A world, with an array of ModelRecord.
+  struct WorldRecord
+  {
+    StringRecord name;
+    double gravity[3];
+    double magneticField[3];
+    double windLinearVelocity[3];
+    ArrayRecord models;
+  };
+
+  /// \brief Flags of ModelRecord.
+  const std::uint64_t kModelStatic = 0x1;
+  const std::uint64_t kModelSelfCollide = 0x2;
+  const std::uint64_t kModelAllowAutoDisable = 0x4;
+  const std::uint64_t kModelEnableWind = 0x8;
+
+  /// \brief A model, with arrays of LinkRecord and JointRecord.
+  struct ModelRecord
+  {
+    StringRecord name;
+    StringRecord canonicalLinkName;
+    StringRecord poseRelativeTo;
+    PoseRecord rawPose;
+    PoseRecord pose;
+    std::uint64_t flags;
+    ArrayRecord links;
+    ArrayRecord joints;
+  };
+
+  /// \brief A link, with an array of SensorRecord. The moment of inertia
+  /// matrix is stored row by row.
+  struct LinkRecord
+  {
+    StringRecord name;
+    StringRecord poseRelativeTo;
+    PoseRecord rawPose;
+    PoseRecord pose;
+    double mass;
+    double moi[9];
+    PoseRecord inertialPose;
+    std::uint64_t enableWind;
+    ArrayRecord sensors;
+  };
+
+  /// \brief A joint. The axes that the joint does not have are zero.
+  struct JointRecord
+  {
+    StringRecord name;
+    StringRecord parentLinkName;
+    StringRecord childLinkName;
+    StringRecord poseRelativeTo;
+    PoseRecord rawPose;
+    PoseRecord pose;
+    std::int64_t parentLinkIndex;
+    std::int64_t childLinkIndex;
+    std::uint32_t type;
+    std::uint32_t axisCount;
+    double axisXyz[2][3];
+    double axisLower[2];
+    double axisUpper[2];
+    double axisEffort[2];
+    double axisMaxVelocity[2];
+  };
+
+  /// \brief A sensor.
+  struct SensorRecord
+  {
+    StringRecord name;
+    StringRecord topic;
+    StringRecord poseRelativeTo;
+    PoseRecord rawPose;
+    PoseRecord pose;
+    double updateRate;
+    std::uint64_t type;
+  };
+
+  /// \brief Records are copied as bytes, and are read in place from
+  /// buffers aligned to 8 bytes, so they must not have padding that
+  /// depends on the compiler.
+  template<typename T>
+  constexpr bool isFlatRecord()
+  {
+    return std::is_trivially_copyable_v<T> && alignof(T) <= 8 &&
+        sizeof(T) % 8 == 0;
+  }
+  static_assert(isFlatRecord<HeaderRecord>(), "Invalid header record");
+  static_assert(isFlatRecord<WorldRecord>(), "Invalid world record");
+  static_assert(isFlatRecord<ModelRecord>(), "Invalid model record");
+  static_assert(isFlatRecord<LinkRecord>(), "Invalid link record");
+  static_assert(isFlatRecord<JointRecord>(), "Invalid joint record");
+  static_assert(isFlatRecord<SensorRecord>(), "Invalid sensor record");
+
+  /// \brief Convert a pose to a record.
+  /// \param[in] _pose The pose.
+  /// \return The record.
+  PoseRecord poseRecord(const ignition::math::Pose3d &_pose)
+  {
+    return {{_pose.Pos().X(), _pose.Pos().Y(), _pose.Pos().Z()},
+            {_pose.Rot().W(), _pose.Rot().X(), _pose.Rot().Y(),
+             _pose.Rot().Z()}};
+  }
+
+  /// \brief Convert a record to a pose.
+  /// \param[in] _record The record.
+  /// \return The pose.
+  ignition::math::Pose3d pose(const PoseRecord &_record)
+  {
+    return ignition::math::Pose3d(
+        _record.position[0], _record.position[1], _record.position[2],
+        _record.orientation[0], _record.orientation[1],
+        _record.orientation[2], _record.orientation[3]);
+  }
+
+  /// \brief Convert a vector to a record.
+  /// \param[in] _vector The vector.
+  /// \param[out] _record The x, y and z coordinates.
+  void vectorRecord(const ignition::math::Vector3d &_vector,
+      double _record[3])
+  {
+    _record[0] = _vector.X();
+    _record[1] = _vector.Y();
+    _record[2] = _vector.Z();
+  }
+
+  /// \brief Convert a record to a vector.
+  /// \param[in] _record The x, y and z coordinates.
+  /// \return The vector.
+  ignition::math::Vector3d vector(const double _record[3])
+  {
+    return ignition::math::Vector3d(_record[0], _record[1], _record[2]);
+  }
+
+  /// \brief Builds a flat buffer.
+  class FlatWriter
+  {
+    /// \brief Constructor.
+    /// \param[out] _out The buffer, which is cleared.
+    public: explicit FlatWriter(std::string &_out)
+      : out(_out)
+    {
+      this->out.clear();
+    }
+
+    /// \brief Append an array of zeroed records, aligned to 8 bytes, to be
+    /// filled with Set once their children are written.
+    /// \param[in] _count Number of records.
+    /// \return The array.
+    public: template<typename T>
+            ArrayRecord Reserve(const std::uint64_t _count)
+    {
+      this->out.append((8 - this->out.size() % 8) % 8, '\0');
+      ArrayRecord array{this->out.size(), _count};
+      this->out.append(sizeof(T) * _count, '\0');
+      return array;
+    }
+
+    /// \brief Fill a record appended by Reserve.
+    /// \param[in] _array The array of the record.
+    /// \param[in] _index Index of the record in the array.
+    /// \param[in] _record The record.
+    public: template<typename T>
+            void Set(const ArrayRecord &_array, const std::uint64_t _index,
+                     const T &_record)
+    {
+      std::memcpy(&this->out[_array.offset + _index * sizeof(T)], &_record,
+          sizeof(T));
+    }
+
+    /// \brief Get a string record, appending the string if it was not
+    /// appended before.
+    /// \param[in] _str The string.
+    /// \return The record.
+    public: StringRecord String(const std::string &_str)
+    {
+      auto inserted = this->strings.emplace(_str, StringRecord{});
+      if (inserted.second)
+      {
+        inserted.first->second = {this->out.size(), _str.size()};
+        this->out.append(_str);
+        this->out.push_back('\0');
+      }
+      return inserted.first->second;
+    }
+
+    /// \brief The buffer.
+    public: std::string &out;
+
+    /// \brief The strings appended so far.
+    public: std::unordered_map<std::string, StringRecord> strings;
+  };
+
+  /// \brief Append the records of a model.
+  /// \param[in,out] _writer The writer.
+  /// \param[in] _model The model.
+  /// \param[in] _pose The resolved pose of the model.
+  /// \param[out] _errors Errors of resolving poses.
+  /// \return The record of the model.
+  ModelRecord writeModel(FlatWriter &_writer, const Model &_model,
+      const ignition::math::Pose3d &_pose, Errors &_errors)
+  {
+    ModelRecord record{};
+    record.name = _writer.String(_model.Name());
+    record.canonicalLinkName = _writer.String(_model.CanonicalLinkName());
+    record.poseRelativeTo = _writer.String(_model.PoseRelativeTo());
+    record.rawPose = poseRecord(_model.RawPose());
+    record.pose = poseRecord(_pose);
+    record.flags = (_model.Static() ? kModelStatic : 0) |
+        (_model.SelfCollide() ? kModelSelfCollide : 0) |
+        (_model.AllowAutoDisable() ? kModelAllowAutoDisable : 0) |
+        (_model.EnableWind() ? kModelEnableWind : 0);
+
+    // The poses of the links and joints, and the joint axes, are resolved
+    // in one pass each, as for ResolveKinematics.
+    std::vector<ignition::math::Pose3d> poses;
+    Errors poseErrors = _model.ResolveFramePoses(poses);
+    _errors.insert(_errors.end(), poseErrors.begin(), poseErrors.end());
+    std::vector<ignition::math::Vector3d> axes;
+    Errors axisErrors = _model.ResolveJointAxes(axes);
+    _errors.insert(_errors.end(), axisErrors.begin(), axisErrors.end());
+    const KinematicTree &tree = _model.KinematicTree();
+
+    record.links = _writer.Reserve<LinkRecord>(_model.LinkCount());
+    for (uint64_t l = 0; l < _model.LinkCount(); ++l)
+    {
+      const Link *link = _model.LinkByIndex(l);
+      LinkRecord linkRecord{};
+      linkRecord.name = _writer.String(link->Name());
+      linkRecord.poseRelativeTo = _writer.String(link->PoseRelativeTo());
+      linkRecord.rawPose = poseRecord(link->RawPose());
+      linkRecord.pose = poseRecord(
+          poses.empty() ? link->RawPose() : poses[1 + l]);
+      const ignition::math::Inertiald &inertial = link->Inertial();
+      linkRecord.mass = inertial.MassMatrix().Mass();
+      const ignition::math::Matrix3d moi = inertial.MassMatrix().Moi();
+      for (int i = 0; i < 9; ++i)
+        linkRecord.moi[i] = moi(i / 3, i % 3);
+      linkRecord.inertialPose = poseRecord(inertial.Pose());
+      linkRecord.enableWind = link->EnableWind() ? 1 : 0;
+
+      linkRecord.sensors = _writer.Reserve<SensorRecord>(link->SensorCount());
+      for (uint64_t s = 0; s < link->SensorCount(); ++s)
+      {
+        const Sensor *sensor = link->SensorByIndex(s);
+        SensorRecord sensorRecord{};
+        sensorRecord.name = _writer.String(sensor->Name());
+        sensorRecord.topic = _writer.String(sensor->Topic());
+        sensorRecord.poseRelativeTo =
+            _writer.String(sensor->PoseRelativeTo());
+        sensorRecord.rawPose = poseRecord(sensor->RawPose());
+        ignition::math::Pose3d sensorPose = sensor->RawPose();
+        Errors sensorErrors = sensor->SemanticPose().Resolve(sensorPose);
+        _errors.insert(_errors.end(), sensorErrors.begin(),
+            sensorErrors.end());
+        sensorRecord.pose = poseRecord(sensorPose);
+        sensorRecord.updateRate = sensor->UpdateRate();
+        sensorRecord.type = static_cast<std::uint64_t>(sensor->Type());
+        _writer.Set(linkRecord.sensors, s, sensorRecord);
+      }
+      _writer.Set(record.links, l, linkRecord);
+    }
+
+    record.joints = _writer.Reserve<JointRecord>(_model.JointCount());
+    for (uint64_t j = 0; j < _model.JointCount(); ++j)
+    {
+      const Joint *joint = _model.JointByIndex(j);
+      JointRecord jointRecord{};
+      jointRecord.name = _writer.String(joint->Name());
+      jointRecord.parentLinkName = _writer.String(joint->ParentLinkName());
+      jointRecord.childLinkName = _writer.String(joint->ChildLinkName());
+      jointRecord.poseRelativeTo = _writer.String(joint->PoseRelativeTo());
+      jointRecord.rawPose = poseRecord(joint->RawPose());
+      jointRecord.pose = poseRecord(poses.empty() ? joint->RawPose() :
+          poses[1 + _model.LinkCount() + j]);
+      jointRecord.parentLinkIndex = tree.jointParents[j];
+      jointRecord.childLinkIndex = tree.jointChildren[j];
+      jointRecord.type = static_cast<std::uint32_t>(joint->Type());
+      for (unsigned int i = 0; i < 2; ++i)
+      {
+        const JointAxis *axis = joint->Axis(i);
+        if (!axis)
+          continue;
+        jointRecord.axisCount = i + 1;
+        vectorRecord(axes.empty() ? axis->Xyz() : axes[2 * j + i],
+            jointRecord.axisXyz[i]);
+        jointRecord.axisLower[i] = axis->Lower();
+        jointRecord.axisUpper[i] = axis->Upper();
+        jointRecord.axisEffort[i] = axis->Effort();
+        jointRecord.axisMaxVelocity[i] = axis->MaxVelocity();
+      }
+      _writer.Set(record.joints, j, jointRecord);
+    }
+    return record;
+  }
+
+  /// \brief Checks that the records of a buffer are within the buffer.
+  class FlatChecker
+  {
+    /// \brief Constructor.
+    /// \param[in] _data The buffer.
+    /// \param[in] _size Size of the buffer.
+    public: FlatChecker(const char *_data, const std::uint64_t _size)
+      : data(_data), size(_size)
+    {
+    }
+
+    /// \brief Check a string.
+    /// \param[in] _str The string record.
+    /// \return True if the string and its null character are in the buffer.
+    public: bool Check(const StringRecord &_str) const
+    {
+      return _str.offset <= this->size &&
+          _str.size < this->size - _str.offset &&
+          this->data[_str.offset + _str.size] == '\0';
+    }
+
+    /// \brief Check an array and its records.
+    /// \param[in] _array The array record.
+    /// \return True if the array is aligned and in the buffer, and its
+    /// records are valid.
+    public: template<typename T>
+            bool Check(const ArrayRecord &_array) const
+    {
+      if (_array.offset % 8 != 0 || _array.offset > this->size ||
+          _array.count > (this->size - _array.offset) / sizeof(T))
+      {
+        return false;
+      }
+      const T *records =
+          reinterpret_cast<const T *>(this->data + _array.offset);
+      for (std::uint64_t i = 0; i < _array.count; ++i)
+      {
+        if (!this->Check(records[i]))
+          return false;
+      }
+      return true;
+    }
+
+    /// \brief Check a world.
+    /// \param[in] _world The world record.
+    /// \return True if the world is valid.
+    public: bool Check(const WorldRecord &_world) const
+    {
+      return this->Check(_world.name) &&
+          this->Check<ModelRecord>(_world.models);
+    }
+
+    /// \brief Check a model.
+    /// \param[in] _model The model record.
+    /// \return True if the model is valid.
+    public: bool Check(const ModelRecord &_model) const
+    {
+      if (!this->Check(_model.name) ||
+          !this->Check(_model.canonicalLinkName) ||
+          !this->Check(_model.poseRelativeTo) ||
+          !this->Check<LinkRecord>(_model.links) ||
+          !this->Check<JointRecord>(_model.joints))
+      {
+        return false;
+      }
+
+      // Link indices are checked here, since joints do not know the number
+      // of links of their model.
+      const std::int64_t linkCount =
+          static_cast<std::int64_t>(_model.links.count);
+      const JointRecord *joints =
+          reinterpret_cast<const JointRecord *>(
+              this->data + _model.joints.offset);
+      for (std::uint64_t j = 0; j < _model.joints.count; ++j)
+      {
+        if (joints[j].parentLinkIndex < -1 ||
+            joints[j].parentLinkIndex >= linkCount ||
+            joints[j].childLinkIndex < -1 ||
+            joints[j].childLinkIndex >= linkCount)
+        {
+          return false;
+        }
+      }
+      return true;
+    }
+
+    /// \brief Check a link.
+    /// \param[in] _link The link record.
+    /// \return True if the link is valid.
+    public: bool Check(const LinkRecord &_link) const
+    {
+      return this->Check(_link.name) && this->Check(_link.poseRelativeTo) &&
+          this->Check<SensorRecord>(_link.sensors);
+    }
+
+    /// \brief Check a joint.
+    /// \param[in] _joint The joint record.
+    /// \return True if the joint is valid.
+    public: bool Check(const JointRecord &_joint) const
+    {
+      return this->Check(_joint.name) &&
+          this->Check(_joint.parentLinkName) &&
+          this->Check(_joint.childLinkName) &&
+          this->Check(_joint.poseRelativeTo) && _joint.axisCount <= 2;
+    }
+
+    /// \brief Check a sensor.
+    /// \param[in] _sensor The sensor record.
+    /// \return True if the sensor is valid.
+    public: bool Check(const SensorRecord &_sensor) const
+    {
+      return this->Check(_sensor.name) && this->Check(_sensor.topic) &&
+          this->Check(_sensor.poseRelativeTo);
+    }
+
+    /// \brief The buffer.
+    private: const char *data;
+
+    /// \brief Size of the buffer.
+    private: std::uint64_t size;
+  };
+
+  /// \brief Get a record of a buffer that was checked by FlatRoot::Open.
+  /// \param[in] _data The buffer.
+  /// \param[in] _offset Offset of the record.
+  /// \return The record.
+  template<typename T>
+  const T &at(const char *_data, const std::uint64_t _offset)
+  {
+    return *reinterpret_cast<const T *>(_data + _offset);
+  }
+
+  /// \brief Get the offset of a record of an array.
+  /// \param[in] _array The array.
+  /// \param[in] _index Index of the record.
+  /// \return Offset of the record.
+  template<typename T>
+  std::uint64_t element(const ArrayRecord &_array, const std::uint64_t _index)
+  {
+    return _array.offset + _index * sizeof(T);
+  }
+
+  /// \brief Get a string of a buffer.
+  /// \param[in] _data The buffer.
+  /// \param[in] _str The string record.
+  /// \return The string.
+  std::string_view text(const char *_data, const StringRecord &_str)
+  {
+    return std::string_view(_data + _str.offset, _str.size);
+  }
+}
+
+/////////////////////////////////////////////////
+Errors sdf::writeFlat(const Root &_root, std::string &_out)
+{
+  Errors errors;
+  FlatWriter writer(_out);
+
+  const ArrayRecord headerArray = writer.Reserve<HeaderRecord>(1);
+  HeaderRecord header{};
+  std::memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.formatVersion = kFormatVersion;
+  header.byteOrderMark = kByteOrderMark;
+  header.version = writer.String(_root.Version());
+
+  header.worlds = writer.Reserve<WorldRecord>(_root.WorldCount());
+  for (uint64_t w = 0; w < _root.WorldCount(); ++w)
+  {
+    const World *world = _root.WorldByIndex(w);
+    WorldRecord record{};
+    record.name = writer.String(world->Name());
+    vectorRecord(world->Gravity(), record.gravity);
+    vectorRecord(world->MagneticField(), record.magneticField);
+    vectorRecord(world->WindLinearVelocity(), record.windLinearVelocity);
+
+    std::vector<ignition::math::Pose3d> poses;
+    Errors poseErrors = world->ResolveFramePoses(poses);
+    errors.insert(errors.end(), poseErrors.begin(), poseErrors.end());
+
+    record.models = writer.Reserve<ModelRecord>(world->ModelCount());
+    for (uint64_t m = 0; m < world->ModelCount(); ++m)
+    {
+      const Model *model = world->ModelByIndex(m);
+      writer.Set(record.models, m, writeModel(writer, *model,
+          poses.empty() ? model->RawPose() : poses[1 + m], errors));
+    }
+    writer.Set(header.worlds, w, record);
+  }
+
+  header.models = writer.Reserve<ModelRecord>(_root.ModelCount());
+  for (uint64_t m = 0; m < _root.ModelCount(); ++m)
+  {
+    const Model *model = _root.ModelByIndex(m);
+    writer.Set(header.models, m,
+        writeModel(writer, *model, model->RawPose(), errors));
+  }
+
+  // Pad the end, so that buffers can be concatenated and stay aligned.
+  writer.Reserve<HeaderRecord>(0);
+  header.size = _out.size();
+  writer.Set(headerArray, 0, header);
+  return errors;
+}
+
+/////////////////////////////////////////////////
+FlatSensor::FlatSensor(const char *_data, uint64_t _record)
+  : data(_data), record(_record)
+{
+}
+
+/////////////////////////////////////////////////
+std::string_view FlatSensor::Name() const
+{
+  return text(this->data, at<SensorRecord>(this->data, this->record).name);
+}
+
+/////////////////////////////////////////////////
+SensorType FlatSensor::Type() const
+{
+  return static_cast<SensorType>(
+      at<SensorRecord>(this->data, this->record).type);
+}
+
+/////////////////////////////////////////////////
+std::string_view FlatSensor::Topic() const
+{
+  return text(this->data, at<SensorRecord>(this->data, this->record).topic);
+}
+
+/////////////////////////////////////////////////
+double FlatSensor::UpdateRate() const
+{
+  return at<SensorRecord>(this->data, this->record).updateRate;
+}
+
+/////////////////////////////////////////////////
+ignition::math::Pose3d FlatSensor::RawPose() const
+{
+  return pose(at<SensorRecord>(this->data, this->record).rawPose);
+}
+
+/////////////////////////////////////////////////
+std::string_view FlatSensor::PoseRelativeTo() const
+{
+  return text(this->data,
+      at<SensorRecord>(this->data, this->record).poseRelativeTo);
+}
+
+/////////////////////////////////////////////////
+ignition::math::Pose3d FlatSensor::Pose() const
+{
+  return pose(at<SensorRecord>(this->data, this->record).pose);
+}
+
+/////////////////////////////////////////////////
+FlatLink::FlatLink(const char *_data, uint64_t _record)
+  : data(_data), record(_record)
+{
+}
+
+/////////////////////////////////////////////////
+std::string_view FlatLink::Name() const
+{
+  return text(this->data, at<LinkRecord>(this->data, this->record).name);
+}
+
+/////////////////////////////////////////////////
+ignition::math::Pose3d FlatLink::RawPose() const
+{
+  return pose(at<LinkRecord>(this->data, this->record).rawPose);
+}
+
+/////////////////////////////////////////////////
+std::string_view FlatLink::PoseRelativeTo() const
+{
+  return text(this->data,
+      at<LinkRecord>(this->data, this->record).poseRelativeTo);
+}
+
+/////////////////////////////////////////////////
+ignition::math::Pose3d FlatLink::Pose() const
+{
+  return pose(at<LinkRecord>(this->data, this->record).pose);
+}
+
+/////////////////////////////////////////////////
+double FlatLink::Mass() const
+{
+  return at<LinkRecord>(this->data, this->record).mass;
+}
+
+/////////////////////////////////////////////////
+ignition::math::Matrix3d FlatLink::Moi() const
+{
+  const double *moi = at<LinkRecord>(this->data, this->record).moi;
+  return ignition::math::Matrix3d(moi[0], moi[1], moi[2],
+                                  moi[3], moi[4], moi[5],
+                                  moi[6], moi[7], moi[8]);
+}
+
+/////////////////////////////////////////////////
+ignition::math::Pose3d FlatLink::InertialPose() const
+{
+  return pose(at<LinkRecord>(this->data, this->record).inertialPose);
+}
+
+/////////////////////////////////////////////////
+bool FlatLink::EnableWind() const
+{
+  return at<LinkRecord>(this->data, this->record).enableWind != 0;
+}
+
+/////////////////////////////////////////////////
+uint64_t FlatLink::SensorCount() const
+{
+  return at<LinkRecord>(this->data, this->record).sensors.count;
+}
+
+/////////////////////////////////////////////////
+FlatSensor FlatLink::SensorByIndex(const uint64_t _index) const
+{
+  return FlatSensor(this->data, element<SensorRecord>(
+        at<LinkRecord>(this->data, this->record).sensors, _index));
+}
+
+/////////////////////////////////////////////////
+FlatJoint::FlatJoint(const char *_data, uint64_t _record)
+  : data(_data), record(_record)
+{
+}
+
+/////////////////////////////////////////////////
+std::string_view FlatJoint::Name() const
+{
+  return text(this->data, at<JointRecord>(this->data, this->record).name);
+}
+
+/////////////////////////////////////////////////
+JointType FlatJoint::Type() const
+{
+  return static_cast<JointType>(
+      at<JointRecord>(this->data, this->record).type);
+}
+
+/////////////////////////////////////////////////
+std::string_view FlatJoint::ParentLinkName() const
+{
+  return text(this->data,
+      at<JointRecord>(this->data, this->record).parentLinkName);
+}
+
+/////////////////////////////////////////////////
+std::string_view FlatJoint::ChildLinkName() const
+{
+  return text(this->data,
+      at<JointRecord>(this->data, this->record).childLinkName);
+}
+
+/////////////////////////////////////////////////
+int64_t FlatJoint::ParentLinkIndex() const
+{
+  return at<JointRecord>(this->data, this->record).parentLinkIndex;
+}
+
+/////////////////////////////////////////////////
+int64_t FlatJoint::ChildLinkIndex() const
+{
+  return at<JointRecord>(this->data, this->record).childLinkIndex;
+}
+
+/////////////////////////////////////////////////
+ignition::math::Pose3d FlatJoint::RawPose() const
+{
+  return pose(at<JointRecord>(this->data, this->record).rawPose);
+}
+
+/////////////////////////////////////////////////
+std::string_view FlatJoint::PoseRelativeTo() const
+{
+  return text(this->data,
+      at<JointRecord>(this->data, this->record).poseRelativeTo);
+}
+
+/////////////////////////////////////////////////
+ignition::math::Pose3d FlatJoint::Pose() const
+{
+  return pose(at<JointRecord>(this->data, this->record).pose);
+}
+
+/////////////////////////////////////////////////
+unsigned int FlatJoint::AxisCount() const
+{
+  return at<JointRecord>(this->data, this->record).axisCount;
+}
+
+/////////////////////////////////////////////////
+ignition::math::Vector3d FlatJoint::AxisXyz(const unsigned int _index) const
+{
+  if (_index > 1)
+    return ignition::math::Vector3d::Zero;
+  return vector(at<JointRecord>(this->data, this->record).axisXyz[_index]);
+}
+
+/////////////////////////////////////////////////
+double FlatJoint::AxisLower(const unsigned int _index) const
+{
+  return _index > 1 ? 0.0 :
+      at<JointRecord>(this->data, this->record).axisLower[_index];
+}
+
+/////////////////////////////////////////////////
+double FlatJoint::AxisUpper(const unsigned int _index) const
+{
+  return _index > 1 ? 0.0 :
+      at<JointRecord>(this->data, this->record).axisUpper[_index];
+}
+
+/////////////////////////////////////////////////
+double FlatJoint::AxisEffort(const unsigned int _index) const
+{
+  return _index > 1 ? 0.0 :
+      at<JointRecord>(this->data, this->record).axisEffort[_index];
+}
+
+/////////////////////////////////////////////////
+double FlatJoint::AxisMaxVelocity(const unsigned int _index) const
+{
+  return _index > 1 ? 0.0 :
+      at<JointRecord>(this->data, this->record).axisMaxVelocity[_index];
+}
+
+/////////////////////////////////////////////////
+FlatModel::FlatModel(const char *_data, uint64_t _record)
+  : data(_data), record(_record)
+{
+}
+
+/////////////////////////////////////////////////
+std::string_view FlatModel::Name() const
+{
+  return text(this->data, at<ModelRecord>(this->data, this->record).name);
+}
+
+/////////////////////////////////////////////////
+bool FlatModel::Static() const
+{
+  return at<ModelRecord>(this->data, this->record).flags & kModelStatic;
+}
+
+/////////////////////////////////////////////////
+bool FlatModel::SelfCollide() const
+{
+  return at<ModelRecord>(this->data, this->record).flags & kModelSelfCollide;
+}
+
+/////////////////////////////////////////////////
+bool FlatModel::AllowAutoDisable() const
+{
+  return at<ModelRecord>(this->data, this->record).flags &
+      kModelAllowAutoDisable;
+}
+
+/////////////////////////////////////////////////
+bool FlatModel::EnableWind() const
+{
+  return at<ModelRecord>(this->data, this->record).flags & kModelEnableWind;
+}
+
+/////////////////////////////////////////////////
+std::string_view FlatModel::CanonicalLinkName() const
+{
+  return text(this->data,
+      at<ModelRecord>(this->data, this->record).canonicalLinkName);
+}
+
+/////////////////////////////////////////////////
+ignition::math::Pose3d FlatModel::RawPose() const
+{
+  return pose(at<ModelRecord>(this->data, this->record).rawPose);
+}
+
+/////////////////////////////////////////////////
+std::string_view FlatModel::PoseRelativeTo() const
+{
+  return text(this->data,
+      at<ModelRecord>(this->data, this->record).poseRelativeTo);
+}
+
+/////////////////////////////////////////////////
+ignition::math::Pose3d FlatModel::Pose() const
+{
+  return pose(at<ModelRecord>(this->data, this->record).pose);
+}
+
+/////////////////////////////////////////////////
+uint64_t FlatModel::LinkCount() const
+{
+  return at<ModelRecord>(this->data, this->record).links.count;
+}
+
+/////////////////////////////////////////////////
+FlatLink FlatModel::LinkByIndex(const uint64_t _index) const
+{
+  return FlatLink(this->data, element<LinkRecord>(
+        at<ModelRecord>(this->data, this->record).links, _index));
+}
+
+/////////////////////////////////////////////////
+uint64_t FlatModel::JointCount() const
+{
+  return at<ModelRecord>(this->data, this->record).joints.count;
+}
+
+/////////////////////////////////////////////////
+FlatJoint FlatModel::JointByIndex(const uint64_t _index) const
+{
+  return FlatJoint(this->data, element<JointRecord>(
+        at<ModelRecord>(this->data, this->record).joints, _index));
+}
+
+/////////////////////////////////////////////////
+FlatWorld::FlatWorld(const char *_data, uint64_t _record)
+  : data(_data), record(_record)
+{
+}
+
+/////////////////////////////////////////////////
+std::string_view FlatWorld::Name() const
+{
+  return text(this->data, at<WorldRecord>(this->data, this->record).name);
+}
+
+/////////////////////////////////////////////////
+ignition::math::Vector3d FlatWorld::Gravity() const
+{
+  return vector(at<WorldRecord>(this->data, this->record).gravity);
+}
+
+/////////////////////////////////////////////////
+ignition::math::Vector3d FlatWorld::MagneticField() const
+{
+  return vector(at<WorldRecord>(this->data, this->record).magneticField);
+}
+
+/////////////////////////////////////////////////
+ignition::math::Vector3d FlatWorld::WindLinearVelocity() const
+{
+  return vector(
+      at<WorldRecord>(this->data, this->record).windLinearVelocity);
+}
+
+/////////////////////////////////////////////////
+uint64_t FlatWorld::ModelCount() const
+{
+  return at<WorldRecord>(this->data, this->record).models.count;
+}
+
+/////////////////////////////////////////////////
+FlatModel FlatWorld::ModelByIndex(const uint64_t _index) const
+{
+  return FlatModel(this->data, element<ModelRecord>(
+        at<WorldRecord>(this->data, this->record).models, _index));
+}
+
+/////////////////////////////////////////////////
+Errors FlatRoot::Open(const void *_data, std::size_t _size)
+{
+  Errors errors;
+  this->data = nullptr;
+
+  const char *data = static_cast<const char *>(_data);
+  if (reinterpret_cast<std::uintptr_t>(data) % 8 != 0)
+  {
+    errors.push_back({ErrorCode::FILE_READ,
+        "Flat buffer is not aligned to 8 bytes."});
+    return errors;
+  }
+  if (_size < sizeof(HeaderRecord) ||
+      std::memcmp(data, kMagic, sizeof(kMagic)) != 0)
+  {
+    errors.push_back({ErrorCode::FILE_READ, "Not a flat buffer."});
+    return errors;
+  }
+
+  const HeaderRecord &header = at<HeaderRecord>(data, 0);
+  if (header.byteOrderMark != kByteOrderMark)
+  {
+    errors.push_back({ErrorCode::FILE_READ,
+        "Flat buffer was written on a machine with another byte order."});
+    return errors;
+  }
+  if (header.formatVersion != kFormatVersion)
+  {
+    errors.push_back({ErrorCode::FILE_READ,
+        "Flat buffer has format version " +
+        std::to_string(header.formatVersion) + ", but version " +
+        std::to_string(kFormatVersion) + " is expected."});
+    return errors;
+  }
+  if (header.size > _size)
+  {
+    errors.push_back({ErrorCode::FILE_READ, "Flat buffer is truncated."});
+    return errors;
+  }
+
+  const FlatChecker checker(data, header.size);
+  if (!checker.Check(header.version) ||
+      !checker.Check<WorldRecord>(header.worlds) ||
+      !checker.Check<ModelRecord>(header.models))
+  {
+    errors.push_back({ErrorCode::FILE_READ,
+        "Flat buffer has a record outside of the buffer."});
+    return errors;
+  }
+
+  this->data = data;
+  return errors;
+}
+
+/////////////////////////////////////////////////
+std::string_view FlatRoot::Version() const
+{
+  if (!this->data)
+    return std::string_view();
+  return text(this->data, at<HeaderRecord>(this->data, 0).version);
+}
+
+/////////////////////////////////////////////////
+uint64_t FlatRoot::WorldCount() const
+{
+  return this->data ? at<HeaderRecord>(this->data, 0).worlds.count : 0;
+}
+
+/////////////////////////////////////////////////
+FlatWorld FlatRoot::WorldByIndex(const uint64_t _index) const
+{
+  return FlatWorld(this->data, element<WorldRecord>(
+        at<HeaderRecord>(this->data, 0).worlds, _index));
+}
+
+/////////////////////////////////////////////////
+uint64_t FlatRoot::ModelCount() const
+{
+  return this->data ? at<HeaderRecord>(this->data, 0).models.count : 0;
+}
+
+/////////////////////////////////////////////////
+FlatModel FlatRoot::ModelByIndex(const uint64_t _index) const
+{
+  return FlatModel(this->data, element<ModelRecord>(
+        at<HeaderRecord>(this->data, 0).models, _index));
+}
@@ -19,12 +19,13 @@
 #include "sdf/Frame.hh"
 #include "sdf/Error.hh"
 #include "sdf/Types.hh"
+#include "ElementArena.hh"
 #include "FrameSemantics.hh"
 #include "Utils.hh"
 
 using namespace sdf;
 
-class sdf::FramePrivate
+class sdf::FramePrivate : public ArenaAllocated
 {
   /// \brief Name of the frame.
   public: std::string name = "";
@@ -49,8 +50,30 @@ class sdf::FramePrivate
 
   /// \brief Weak pointer to model's or world's Pose Relative-To Graph.
   public: std::weak_ptr<const sdf::PoseRelativeToGraph> poseRelativeToGraph;
+
+  /// \brief Vertex ids of the frames of SemanticPose in the graph.
+  public: FrameIds frameIds;
 };
 
+/////////////////////////////////////////////////
+/// \brief Find the vertex ids of the frames of the SemanticPose of a
+/// frame again, after its graph or the names of the frames changed.
+/// \param[in,out] _data Private data of the frame.
+static void updateFrameIds(FramePrivate &_data)
+{
+  std::string relativeTo = _data.poseRelativeTo;
+  if (relativeTo.empty())
+  {
+    relativeTo = _data.attachedTo;
+  }
+  if (relativeTo.empty())
+  {
+    relativeTo = _data.graphSourceName;
+  }
+  _data.frameIds = findFrameIds(_data.poseRelativeToGraph, relativeTo,
+      _data.graphSourceName);
+}
+
 /////////////////////////////////////////////////
 Frame::Frame()
   : dataPtr(new FramePrivate)
@@ -102,7 +125,7 @@ Errors Frame::Load(ElementPtr _sdf)
 {
   Errors errors;
 
-  this->dataPtr->sdf = _sdf;
+  this->dataPtr->sdf = retainedElement(_sdf);
 
   // Check that the provided SDF element is a <frame>
   // This is an error that cannot be recovered, so return an error.
@@ -155,6 +178,7 @@ const std::string &Frame::Name() const
 void Frame::SetName(const std::string &_name) const
 {
   this->dataPtr->name = _name;
+  NameIndex::NameChanged();
 }
 
 /////////////////////////////////////////////////
@@ -179,6 +203,7 @@ const std::string &Frame::PoseRelativeTo() const
 void Frame::SetAttachedTo(const std::string &_frame)
 {
   this->dataPtr->attachedTo = _frame;
+  updateFrameIds(*this->dataPtr);
 }
 
 /////////////////////////////////////////////////
@@ -191,6 +216,7 @@ void Frame::SetRawPose(const ignition::math::Pose3d &_pose)
 void Frame::SetPoseRelativeTo(const std::string &_frame)
 {
   this->dataPtr->poseRelativeTo = _frame;
+  updateFrameIds(*this->dataPtr);
 }
 
 /////////////////////////////////////////////////
@@ -210,6 +236,7 @@ void Frame::SetPoseRelativeToGraph(
   {
     this->dataPtr->graphSourceName = graph->sourceName;
   }
+  updateFrameIds(*this->dataPtr);
 }
 
 /////////////////////////////////////////////////
@@ -246,7 +273,8 @@ sdf::SemanticPose Frame::SemanticPose() const
       this->dataPtr->pose,
       relativeTo,
       this->dataPtr->graphSourceName,
-      this->dataPtr->poseRelativeToGraph);
+      this->dataPtr->poseRelativeToGraph,
+      this->dataPtr->frameIds);
 }
 
 /////////////////////////////////////////////////
@@ -14,7 +14,11 @@
  * limitations under the License.
  *
 */
+#include <mutex>
 #include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include "sdf/Element.hh"
 #include "sdf/Error.hh"
@@ -164,6 +168,296 @@ FindSinkVertex(
   return PairType(vertex, edges);
 }
 
+/// \brief How a walk that follows the only outgoing (or incoming) edge of
+/// each vertex ends, as in FindSinkVertex (or FindSourceVertex).
+enum class EdgeWalkEndType
+{
+  /// \brief A vertex without edges to follow was reached.
+  END_VERTEX,
+
+  /// \brief A vertex with multiple edges to follow was reached.
+  MULTIPLE_EDGES,
+
+  /// \brief A vertex was visited twice.
+  CYCLE
+};
+
+/// \brief End of a walk that starts at a given vertex.
+struct EdgeWalkEnd
+{
+  /// \brief How the walk ends.
+  EdgeWalkEndType type;
+
+  /// \brief The vertex without edges to follow, the vertex with multiple
+  /// edges to follow, or the first vertex visited twice.
+  ignition::math::graph::VertexId vertex;
+
+  /// \brief True if the starting vertex is part of a cycle.
+  bool onCycle;
+};
+
+/// \brief Find where the walks of FindSinkVertex (or FindSourceVertex)
+/// starting from each of the given vertices end, in a single pass over the
+/// graph. Each vertex is visited once: a walk stops at the first vertex
+/// whose end is already known, and the vertices on its path then share
+/// that end.
+/// \param[in] _graph A directed graph.
+/// \param[in] _ids VertexIds of the starting vertices. Invalid ids are
+/// skipped.
+/// \param[in] _outgoing True to follow outgoing edges as FindSinkVertex
+/// does, false to follow incoming edges as FindSourceVertex does.
+/// \return Map from each valid VertexId to the end of the walk starting
+/// from it.
+template<typename V, typename E>
+std::unordered_map<ignition::math::graph::VertexId, EdgeWalkEnd>
+FindEdgeWalkEnds(
+    const ignition::math::graph::DirectedGraph<V, E> &_graph,
+    const std::vector<ignition::math::graph::VertexId> &_ids,
+    const bool _outgoing)
+{
+  using VertexId = ignition::math::graph::VertexId;
+  std::unordered_map<VertexId, EdgeWalkEnd> ends;
+  std::unordered_map<VertexId, std::size_t> pathIndex;
+  std::vector<VertexId> path;
+
+  for (auto const startId : _ids)
+  {
+    if (ends.count(startId) > 0 || !_graph.VertexFromId(startId).Valid())
+    {
+      continue;
+    }
+
+    // Follow edges until the end of the walk from the current vertex is
+    // known. The vertices before it on the path are stored in path.
+    VertexId id = startId;
+    while (ends.count(id) == 0)
+    {
+      auto indexIt = pathIndex.find(id);
+      if (indexIt != pathIndex.end())
+      {
+        // The vertices from id to the end of the path form a cycle.
+        for (std::size_t i = indexIt->second; i < path.size(); ++i)
+        {
+          ends[path[i]] = {EdgeWalkEndType::CYCLE, path[i], true};
+        }
+        path.resize(indexIt->second);
+        break;
+      }
+
+      auto edges =
+          _outgoing ? _graph.IncidentsFrom(id) : _graph.IncidentsTo(id);
+      if (edges.empty())
+      {
+        ends[id] = {EdgeWalkEndType::END_VERTEX, id, false};
+        break;
+      }
+      else if (edges.size() > 1)
+      {
+        ends[id] = {EdgeWalkEndType::MULTIPLE_EDGES, id, false};
+        break;
+      }
+
+      pathIndex[id] = path.size();
+      path.push_back(id);
+      auto const &vertices = edges.begin()->second.get().Vertices();
+      id = _outgoing ? vertices.second : vertices.first;
+    }
+
+    // Walk back along the path. A walk that enters a cycle ends at the
+    // first vertex of the cycle that it reaches.
+    for (auto pathIt = path.rbegin(); pathIt != path.rend(); ++pathIt)
+    {
+      EdgeWalkEnd end = ends.at(id);
+      if (end.type == EdgeWalkEndType::CYCLE && end.onCycle)
+      {
+        end.vertex = id;
+      }
+      end.onCycle = false;
+      ends[*pathIt] = end;
+      id = *pathIt;
+    }
+    path.clear();
+    pathIndex.clear();
+  }
+
+  return ends;
+}
+
+/////////////////////////////////////////////////
+/// \brief Check the sink vertex found in a FrameAttachedToGraph when
+/// starting from a given vertex.
+/// \param[out] _attachedToBody Name of the sink vertex if it is valid.
+/// \param[in] _in FrameAttachedToGraph containing the vertices.
+/// \param[in] _sinkVertex Sink vertex that was found.
+/// \param[in] _vertexName Name of the starting vertex.
+/// \return Errors.
+static Errors checkFrameAttachedToSink(
+    std::string &_attachedToBody,
+    const FrameAttachedToGraph &_in,
+    const ignition::math::graph::Vertex<FrameType> &_sinkVertex,
+    const std::string &_vertexName)
+{
+  Errors errors;
+
+  if (!_sinkVertex.Valid())
+  {
+    errors.push_back({ErrorCode::FRAME_ATTACHED_TO_GRAPH_ERROR,
+        "FrameAttachedToGraph unable to find sink vertex when starting "
+        "from vertex with name [" + _vertexName + "]."});
+    return errors;
+  }
+
+  if (_in.scopeName == "world" &&
+      !(_sinkVertex.Data() == FrameType::WORLD ||
+        _sinkVertex.Data() == FrameType::MODEL))
+  {
+    errors.push_back({ErrorCode::FRAME_ATTACHED_TO_GRAPH_ERROR,
+        "Graph has world scope but sink vertex named [" +
+        _sinkVertex.Name() + "] does not have FrameType WORLD or MODEL "
+        "when starting from vertex with name [" + _vertexName + "]."});
+    return errors;
+  }
+
+  if (_in.scopeName == "__model__" && _sinkVertex.Data() != FrameType::LINK)
+  {
+    errors.push_back({ErrorCode::FRAME_ATTACHED_TO_GRAPH_ERROR,
+        "Graph has __model__ scope but sink vertex named [" +
+        _sinkVertex.Name() + "] does not have FrameType LINK "
+        "when starting from vertex with name [" + _vertexName + "]."});
+    return errors;
+  }
+
+  _attachedToBody = _sinkVertex.Name();
+
+  return errors;
+}
+
+/////////////////////////////////////////////////
+/// \brief Check the source vertex found in a PoseRelativeToGraph when
+/// starting from a given vertex.
+/// \param[in] _graph PoseRelativeToGraph containing the vertices.
+/// \param[in] _sourceVertex Source vertex that was found.
+/// \param[in] _vertexName Name of the starting vertex.
+/// \return Errors.
+static Errors checkPoseRelativeToSource(
+    const PoseRelativeToGraph &_graph,
+    const ignition::math::graph::Vertex<FrameType> &_sourceVertex,
+    const std::string &_vertexName)
+{
+  Errors errors;
+
+  if (!_sourceVertex.Valid())
+  {
+    errors.push_back({ErrorCode::POSE_RELATIVE_TO_GRAPH_ERROR,
+        "PoseRelativeToGraph unable to find path to source vertex "
+        "when starting from vertex with name [" + _vertexName + "]."});
+  }
+  else if (_sourceVertex.Name() != _graph.sourceName)
+  {
+    errors.push_back({ErrorCode::POSE_RELATIVE_TO_GRAPH_ERROR,
+        "PoseRelativeToGraph frame with name [" + _vertexName + "] "
+        "is disconnected; its source vertex has name [" +
+        _sourceVertex.Name() +
+        "], but its source name should be " + _graph.sourceName + "."});
+  }
+
+  return errors;
+}
+
+/////////////////////////////////////////////////
+/// \brief Store the attached-to bodies found by FindEdgeWalkEnds in the
+/// cache of a FrameAttachedToGraph. Only the walks that end at a valid body
+/// for the scope of the graph are stored.
+/// \param[in] _in Graph to update. The caller must lock
+/// attachedToBodiesMutex.
+/// \param[in] _ends Ends of the walks from every vertex of the graph.
+static void storeAttachedToBodies(
+    const FrameAttachedToGraph &_in,
+    const std::unordered_map<ignition::math::graph::VertexId, EdgeWalkEnd>
+        &_ends)
+{
+  _in.attachedToBodies.clear();
+  _in.attachedToBodiesValid = true;
+  _in.attachedToBodiesMapSize = _in.map.size();
+
+  for (auto const &endPair : _ends)
+  {
+    if (endPair.second.type != EdgeWalkEndType::END_VERTEX)
+    {
+      continue;
+    }
+
+    auto const type = _in.graph.VertexFromId(endPair.second.vertex).Data();
+    const bool validBody = _in.scopeName == "world" ?
+        (type == FrameType::WORLD || type == FrameType::MODEL) :
+        (_in.scopeName == "__model__" && type == FrameType::LINK);
+    if (validBody)
+    {
+      _in.attachedToBodies[endPair.first] = endPair.second.vertex;
+    }
+  }
+}
+
+/////////////////////////////////////////////////
+/// \brief Compute the attached-to body of every vertex of a
+/// FrameAttachedToGraph, following each edge once.
+/// \param[in] _in Graph to update. The caller must lock
+/// attachedToBodiesMutex.
+static void computeAttachedToBodies(const FrameAttachedToGraph &_in)
+{
+  std::vector<ignition::math::graph::VertexId> ids;
+  ids.reserve(_in.map.size());
+  for (auto const &namePair : _in.map)
+  {
+    ids.push_back(namePair.second);
+  }
+  storeAttachedToBodies(_in, FindEdgeWalkEnds(_in.graph, ids, true));
+}
+
+/////////////////////////////////////////////////
+FrameAttachedToGraph::FrameAttachedToGraph(const FrameAttachedToGraph &_graph)
+  : graph(_graph.graph), map(_graph.map), scopeName(_graph.scopeName)
+{
+}
+
+/////////////////////////////////////////////////
+FrameAttachedToGraph &FrameAttachedToGraph::operator=(
+    const FrameAttachedToGraph &_graph)
+{
+  if (this != &_graph)
+  {
+    this->graph = _graph.graph;
+    this->map = _graph.map;
+    this->scopeName = _graph.scopeName;
+    std::lock_guard<std::mutex> lock(this->attachedToBodiesMutex);
+    this->attachedToBodies.clear();
+    this->attachedToBodiesValid = false;
+  }
+  return *this;
+}
+
+/////////////////////////////////////////////////
+PoseRelativeToGraph::PoseRelativeToGraph(const PoseRelativeToGraph &_graph)
+  : graph(_graph.graph), map(_graph.map), sourceName(_graph.sourceName)
+{
+}
+
+/////////////////////////////////////////////////
+PoseRelativeToGraph &PoseRelativeToGraph::operator=(
+    const PoseRelativeToGraph &_graph)
+{
+  if (this != &_graph)
+  {
+    this->graph = _graph.graph;
+    this->map = _graph.map;
+    this->sourceName = _graph.sourceName;
+    std::lock_guard<std::mutex> lock(this->rootPosesMutex);
+    this->rootPoses.clear();
+    this->rootPosesValid = false;
+  }
+  return *this;
+}
+
 /////////////////////////////////////////////////
 Errors buildFrameAttachedToGraph(
             FrameAttachedToGraph &_out, const Model *_model)
@@ -173,6 +467,7 @@ Errors buildFrameAttachedToGraph(
   // add implicit model frame vertex first
   const std::string scopeName = "__model__";
   _out.scopeName = scopeName;
+  _out.attachedToBodiesValid = false;
   auto modelFrameId =
       _out.graph.AddVertex(scopeName, sdf::FrameType::MODEL).Id();
   _out.map[scopeName] = modelFrameId;
@@ -297,7 +592,8 @@ Errors buildFrameAttachedToGraph(
       // if the attached-to name is empty, use the scope name
       attachedTo = scopeName;
     }
-    if (_out.map.count(attachedTo) != 1)
+    auto attachedToIt = _out.map.find(attachedTo);
+    if (attachedToIt == _out.map.end())
     {
       errors.push_back({ErrorCode::FRAME_ATTACHED_TO_INVALID,
           "attached_to name[" + attachedTo +
@@ -306,7 +602,7 @@ Errors buildFrameAttachedToGraph(
           "in model with name[" + _model->Name() + "]."});
       continue;
     }
-    auto attachedToId = _out.map[attachedTo];
+    auto attachedToId = attachedToIt->second;
     bool edgeData = true;
     if (frame->Name() == frame->AttachedTo())
     {
@@ -333,6 +629,7 @@ Errors buildFrameAttachedToGraph(
   // add implicit world frame vertex first
   const std::string scopeName = "world";
   _out.scopeName = scopeName;
+  _out.attachedToBodiesValid = false;
   auto worldFrameId =
       _out.graph.AddVertex(scopeName, sdf::FrameType::WORLD).Id();
   _out.map[scopeName] = worldFrameId;
@@ -404,7 +701,8 @@ Errors buildFrameAttachedToGraph(
         continue;
       }
     }
-    if (_out.map.count(attachedTo) != 1)
+    auto attachedToIt = _out.map.find(attachedTo);
+    if (attachedToIt == _out.map.end())
     {
       errors.push_back({ErrorCode::FRAME_ATTACHED_TO_INVALID,
           "attached_to name[" + attachedTo +
@@ -413,7 +711,7 @@ Errors buildFrameAttachedToGraph(
           "in world with name[" + _world->Name() + "]."});
       continue;
     }
-    auto attachedToId = _out.map[attachedTo];
+    auto attachedToId = attachedToIt->second;
     bool edgeData = true;
     if (frame->Name() == frame->AttachedTo())
     {
@@ -453,6 +751,7 @@ Errors buildPoseRelativeToGraph(
   // add implicit model frame vertex first
   const std::string sourceName = "__model__";
   _out.sourceName = sourceName;
+  _out.rootPosesValid = false;
   auto modelFrameId =
       _out.graph.AddVertex(sourceName, sdf::FrameType::MODEL).Id();
   _out.map[sourceName] = modelFrameId;
@@ -554,7 +853,8 @@ Errors buildPoseRelativeToGraph(
     auto linkId = _out.map.at(link->Name());
 
     // look for vertex in graph that matches relative_to value
-    if (_out.map.count(relativeTo) != 1)
+    auto relativeToIt = _out.map.find(relativeTo);
+    if (relativeToIt == _out.map.end())
     {
       errors.push_back({ErrorCode::POSE_RELATIVE_TO_INVALID,
           "relative_to name[" + relativeTo +
@@ -563,7 +863,7 @@ Errors buildPoseRelativeToGraph(
           "in model with name[" + _model->Name() + "]."});
       continue;
     }
-    auto relativeToId = _out.map[relativeTo];
+    auto relativeToId = relativeToIt->second;
     if (link->Name() == relativeTo)
     {
       errors.push_back({ErrorCode::POSE_RELATIVE_TO_CYCLE,
@@ -589,7 +889,8 @@ Errors buildPoseRelativeToGraph(
     auto jointId = _out.map.at(joint->Name());
 
     // look for vertex in graph that matches relative_to value
-    if (_out.map.count(relativeTo) != 1)
+    auto relativeToIt = _out.map.find(relativeTo);
+    if (relativeToIt == _out.map.end())
     {
       errors.push_back({ErrorCode::POSE_RELATIVE_TO_INVALID,
           "relative_to name[" + relativeTo +
@@ -598,7 +899,7 @@ Errors buildPoseRelativeToGraph(
           "in model with name[" + _model->Name() + "]."});
       continue;
     }
-    auto relativeToId = _out.map[relativeTo];
+    auto relativeToId = relativeToIt->second;
     if (joint->Name() == relativeTo)
     {
       errors.push_back({ErrorCode::POSE_RELATIVE_TO_CYCLE,
@@ -638,7 +939,8 @@ Errors buildPoseRelativeToGraph(
     }
 
     // look for vertex in graph that matches relative_to value
-    if (_out.map.count(relativeTo) != 1)
+    auto relativeToIt = _out.map.find(relativeTo);
+    if (relativeToIt == _out.map.end())
     {
       errors.push_back({errorCode,
           typeForErrorMsg + " name[" + relativeTo +
@@ -647,7 +949,7 @@ Errors buildPoseRelativeToGraph(
           "in model with name[" + _model->Name() + "]."});
       continue;
     }
-    auto relativeToId = _out.map[relativeTo];
+    auto relativeToId = relativeToIt->second;
     if (frame->Name() == relativeTo)
     {
       errors.push_back({ErrorCode::POSE_RELATIVE_TO_CYCLE,
@@ -684,6 +986,7 @@ Errors buildPoseRelativeToGraph(
   // add implicit world frame vertex first
   const std::string sourceName = "world";
   _out.sourceName = sourceName;
+  _out.rootPosesValid = false;
   auto worldFrameId =
       _out.graph.AddVertex(sourceName, sdf::FrameType::WORLD).Id();
   _out.map[sourceName] = worldFrameId;
@@ -752,7 +1055,8 @@ Errors buildPoseRelativeToGraph(
     auto modelId = _out.map.at(model->Name());
 
     // look for vertex in graph that matches relative_to value
-    if (_out.map.count(relativeTo) != 1)
+    auto relativeToIt = _out.map.find(relativeTo);
+    if (relativeToIt == _out.map.end())
     {
       errors.push_back({ErrorCode::POSE_RELATIVE_TO_INVALID,
           "relative_to name[" + relativeTo +
@@ -761,7 +1065,7 @@ Errors buildPoseRelativeToGraph(
           "in world with name[" + _world->Name() + "]."});
       continue;
     }
-    auto relativeToId = _out.map[relativeTo];
+    auto relativeToId = relativeToIt->second;
     if (model->Name() == relativeTo)
     {
       errors.push_back({ErrorCode::POSE_RELATIVE_TO_CYCLE,
@@ -801,7 +1105,8 @@ Errors buildPoseRelativeToGraph(
     }
 
     // look for vertex in graph that matches relative_to value
-    if (_out.map.count(relativeTo) != 1)
+    auto relativeToIt = _out.map.find(relativeTo);
+    if (relativeToIt == _out.map.end())
     {
       errors.push_back({errorCode,
           typeForErrorMsg + " name[" + relativeTo +
@@ -810,7 +1115,7 @@ Errors buildPoseRelativeToGraph(
           "in world with name[" + _world->Name() + "]."});
       continue;
     }
-    auto relativeToId = _out.map[relativeTo];
+    auto relativeToId = relativeToIt->second;
     if (frame->Name() == relativeTo)
     {
       errors.push_back({ErrorCode::POSE_RELATIVE_TO_CYCLE,
@@ -973,12 +1278,54 @@ Errors validateFrameAttachedToGraph(const FrameAttachedToGraph &_in)
     }
   }
 
-  // check graph for cycles by finding sink from each vertex
+  // check graph for cycles by finding sink from each vertex, following
+  // the edges of each vertex only once
+  std::vector<ignition::math::graph::VertexId> ids;
+  ids.reserve(_in.map.size());
   for (auto const &namePair : _in.map)
   {
-    std::string resolvedBody;
-    Errors e = resolveFrameAttachedToBody(resolvedBody, _in, namePair.first);
-    errors.insert(errors.end(), e.begin(), e.end());
+    ids.push_back(namePair.second);
+  }
+  auto ends = FindEdgeWalkEnds(_in.graph, ids, true);
+  {
+    // Keep the bodies for later calls to resolveFrameAttachedToBody.
+    std::lock_guard<std::mutex> lock(_in.attachedToBodiesMutex);
+    storeAttachedToBodies(_in, ends);
+  }
+  for (auto const &namePair : _in.map)
+  {
+    auto endIt = ends.find(namePair.second);
+    if (endIt == ends.end())
+    {
+      std::string resolvedBody;
+      Errors e =
+          resolveFrameAttachedToBody(resolvedBody, _in, namePair.first);
+      errors.insert(errors.end(), e.begin(), e.end());
+      continue;
+    }
+
+    auto const &vertex = _in.graph.VertexFromId(endIt->second.vertex);
+    switch (endIt->second.type)
+    {
+      case EdgeWalkEndType::MULTIPLE_EDGES:
+        errors.push_back({ErrorCode::FRAME_ATTACHED_TO_GRAPH_ERROR,
+            "FrameAttachedToGraph error: multiple outgoing edges from "
+            "current vertex [" + vertex.Name() + "]."});
+        break;
+      case EdgeWalkEndType::CYCLE:
+        errors.push_back({ErrorCode::FRAME_ATTACHED_TO_CYCLE,
+            "FrameAttachedToGraph cycle detected, already visited vertex [" +
+            vertex.Name() + "]."});
+        break;
+      default:
+      {
+        std::string resolvedBody;
+        Errors e = checkFrameAttachedToSink(
+            resolvedBody, _in, vertex, namePair.first);
+        errors.insert(errors.end(), e.begin(), e.end());
+        break;
+      }
+    }
   }
 
   return errors;
@@ -1143,12 +1490,46 @@ Errors validatePoseRelativeToGraph(const PoseRelativeToGraph &_in)
     }
   }
 
-  // check graph for cycles by resolving pose of each vertex relative to root
+  // check graph for cycles by finding the source of each vertex, following
+  // the edges of each vertex only once
+  std::vector<ignition::math::graph::VertexId> ids;
+  ids.reserve(_in.map.size());
   for (auto const &namePair : _in.map)
   {
-    ignition::math::Pose3d pose;
-    Errors e = resolvePoseRelativeToRoot(pose, _in, namePair.first);
-    errors.insert(errors.end(), e.begin(), e.end());
+    ids.push_back(namePair.second);
+  }
+  auto ends = FindEdgeWalkEnds(_in.graph, ids, false);
+  for (auto const &namePair : _in.map)
+  {
+    auto endIt = ends.find(namePair.second);
+    if (endIt == ends.end())
+    {
+      ignition::math::Pose3d pose;
+      Errors e = resolvePoseRelativeToRoot(pose, _in, namePair.first);
+      errors.insert(errors.end(), e.begin(), e.end());
+      continue;
+    }
+
+    auto const &vertex = _in.graph.VertexFromId(endIt->second.vertex);
+    switch (endIt->second.type)
+    {
+      case EdgeWalkEndType::MULTIPLE_EDGES:
+        errors.push_back({ErrorCode::POSE_RELATIVE_TO_GRAPH_ERROR,
+            "PoseRelativeToGraph error: multiple incoming edges to "
+            "current vertex [" + vertex.Name() + "]."});
+        break;
+      case EdgeWalkEndType::CYCLE:
+        errors.push_back({ErrorCode::POSE_RELATIVE_TO_CYCLE,
+            "PoseRelativeToGraph cycle detected, already visited vertex [" +
+            vertex.Name() + "]."});
+        break;
+      default:
+      {
+        Errors e = checkPoseRelativeToSource(_in, vertex, namePair.first);
+        errors.insert(errors.end(), e.begin(), e.end());
+        break;
+      }
+    }
   }
 
   return errors;
@@ -1170,14 +1551,30 @@ Errors resolveFrameAttachedToBody(
     return errors;
   }
 
-  if (_in.map.count(_vertexName) != 1)
+  auto vertexIt = _in.map.find(_vertexName);
+  if (vertexIt == _in.map.end())
   {
     errors.push_back({ErrorCode::FRAME_ATTACHED_TO_INVALID,
         "FrameAttachedToGraph unable to find unique frame with name [" +
         _vertexName + "] in graph."});
     return errors;
   }
-  auto vertexId = _in.map.at(_vertexName);
+  auto vertexId = vertexIt->second;
+
+  {
+    std::lock_guard<std::mutex> lock(_in.attachedToBodiesMutex);
+    if (!_in.attachedToBodiesValid ||
+        _in.attachedToBodiesMapSize != _in.map.size())
+    {
+      computeAttachedToBodies(_in);
+    }
+    auto bodyIt = _in.attachedToBodies.find(vertexId);
+    if (bodyIt != _in.attachedToBodies.end())
+    {
+      _attachedToBody = _in.graph.VertexFromId(bodyIt->second).Name();
+      return errors;
+    }
+  }
 
   auto sinkVertexEdges = FindSinkVertex(_in.graph, vertexId, errors);
   auto sinkVertex = sinkVertexEdges.first;
@@ -1187,37 +1584,107 @@ Errors resolveFrameAttachedToBody(
     return errors;
   }
 
-  if (!sinkVertex.Valid())
+  return checkFrameAttachedToSink(_attachedToBody, _in, sinkVertex,
+      _vertexName);
+}
+
+/////////////////////////////////////////////////
+/// \brief Check whether a vertex is the frame of a nested model, which
+/// addNestedModel names <model>::__model__.
+/// \param[in] _graph Graph of the vertex.
+/// \param[in] _id Id of the vertex.
+/// \return True if the vertex is a nested model frame.
+static bool isNestedModelFrame(const PoseRelativeToGraph &_graph,
+    ignition::math::graph::VertexId _id)
+{
+  static const std::string kSuffix = "::__model__";
+  const std::string &name = _graph.graph.VertexFromId(_id).Name();
+  return name.size() > kSuffix.size() &&
+      name.compare(name.size() - kSuffix.size(), kSuffix.size(), kSuffix) == 0;
+}
+
+/////////////////////////////////////////////////
+/// \brief Compute the cached pose of a vertex from the cached pose of the
+/// vertex its pose is relative to.
+/// \param[in] _graph Graph of the vertices.
+/// \param[in] _parentId Id of the vertex the pose is relative to.
+/// \param[in] _parentPose Cached pose of that vertex.
+/// \param[in] _pose Pose of the vertex relative to that vertex.
+/// \return The cached pose of the vertex.
+static PoseRelativeToGraph::ScopePose childScopePose(
+    const PoseRelativeToGraph &_graph,
+    ignition::math::graph::VertexId _parentId,
+    const PoseRelativeToGraph::ScopePose &_parentPose,
+    const ignition::math::Pose3d &_pose)
+{
+  if (_parentPose.scope == ignition::math::graph::kNullId ||
+      isNestedModelFrame(_graph, _parentId))
   {
-    errors.push_back({ErrorCode::FRAME_ATTACHED_TO_GRAPH_ERROR,
-        "FrameAttachedToGraph unable to find sink vertex when starting "
-        "from vertex with name [" + _vertexName + "]."});
-    return errors;
+    return {_parentId, _pose};
   }
+  return {_parentPose.scope, _parentPose.pose * _pose};
+}
 
-  if (_in.scopeName == "world" &&
-      !(sinkVertex.Data() == FrameType::WORLD ||
-        sinkVertex.Data() == FrameType::MODEL))
+/////////////////////////////////////////////////
+/// \brief Compose a cached pose with the cached poses of its nested model
+/// frames, up to the source vertex.
+/// \param[in] _graph Graph of the pose. The caller must lock rootPosesMutex.
+/// \param[in] _scopePose Cached pose.
+/// \return Pose relative to the source vertex.
+static ignition::math::Pose3d composeRootPose(
+    const PoseRelativeToGraph &_graph,
+    const PoseRelativeToGraph::ScopePose &_scopePose)
+{
+  ignition::math::Pose3d pose = _scopePose.pose;
+  auto scope = _scopePose.scope;
+  while (scope != ignition::math::graph::kNullId)
   {
-    errors.push_back({ErrorCode::FRAME_ATTACHED_TO_GRAPH_ERROR,
-        "Graph has world scope but sink vertex named [" +
-        sinkVertex.Name() + "] does not have FrameType WORLD or MODEL "
-        "when starting from vertex with name [" + _vertexName + "]."});
-    return errors;
+    const auto &scopePose = _graph.rootPoses.at(scope);
+    pose = scopePose.pose * pose;
+    scope = scopePose.scope;
   }
+  return pose;
+}
 
-  if (_in.scopeName == "__model__" && sinkVertex.Data() != FrameType::LINK)
+/////////////////////////////////////////////////
+/// \brief Compute the cached poses of every vertex in the tree rooted at
+/// the source vertex, visiting each edge once. A vertex is part of that tree
+/// if it and each vertex on its path to the source have one incoming edge,
+/// and the source has none, which are the vertices that FindSourceVertex
+/// resolves without errors.
+/// \param[in] _graph Graph to update. The caller must lock rootPosesMutex.
+static void computeRootPoses(const PoseRelativeToGraph &_graph)
+{
+  _graph.rootPoses.clear();
+  _graph.rootPosesValid = true;
+  _graph.rootPosesMapSize = _graph.map.size();
+
+  auto sourceIt = _graph.map.find(_graph.sourceName);
+  if (sourceIt == _graph.map.end() ||
+      !_graph.graph.VertexFromId(sourceIt->second).Valid() ||
+      _graph.graph.InDegree(sourceIt->second) != 0)
   {
-    errors.push_back({ErrorCode::FRAME_ATTACHED_TO_GRAPH_ERROR,
-        "Graph has __model__ scope but sink vertex named [" +
-        sinkVertex.Name() + "] does not have FrameType LINK "
-        "when starting from vertex with name [" + _vertexName + "]."});
-    return errors;
+    return;
   }
 
-  _attachedToBody = sinkVertex.Name();
-
-  return errors;
+  std::vector<ignition::math::graph::VertexId> stack = {sourceIt->second};
+  _graph.rootPoses[sourceIt->second] = {};
+  while (!stack.empty())
+  {
+    auto id = stack.back();
+    stack.pop_back();
+    const auto parentPose = _graph.rootPoses.at(id);
+    for (auto const &edgePair : _graph.graph.IncidentsFrom(id))
+    {
+      auto const &edge = edgePair.second.get();
+      auto childId = edge.Vertices().second;
+      if (_graph.graph.InDegree(childId) != 1)
+        continue;
+      _graph.rootPoses[childId] =
+          childScopePose(_graph, id, parentPose, edge.Data());
+      stack.push_back(childId);
+    }
+  }
 }
 
 /////////////////////////////////////////////////
@@ -1228,14 +1695,31 @@ Errors resolvePoseRelativeToRoot(
 {
   Errors errors;
 
-  if (_graph.map.count(_vertexName) != 1)
+  auto vertexIt = _graph.map.find(_vertexName);
+  if (vertexIt == _graph.map.end())
   {
     errors.push_back({ErrorCode::POSE_RELATIVE_TO_INVALID,
         "PoseRelativeToGraph unable to find unique frame with name [" +
         _vertexName + "] in graph."});
     return errors;
   }
-  auto vertexId = _graph.map.at(_vertexName);
+  auto vertexId = vertexIt->second;
+
+  {
+    std::lock_guard<std::mutex> lock(_graph.rootPosesMutex);
+    if (!_graph.rootPosesValid ||
+        _graph.rootPosesMapSize != _graph.map.size())
+    {
+      computeRootPoses(_graph);
+    }
+
+    auto poseIt = _graph.rootPoses.find(vertexId);
+    if (poseIt != _graph.rootPoses.end())
+    {
+      _pose = composeRootPose(_graph, poseIt->second);
+      return errors;
+    }
+  }
 
   auto incomingVertexEdges = FindSourceVertex(_graph.graph, vertexId, errors);
 
@@ -1243,20 +1727,11 @@ Errors resolvePoseRelativeToRoot(
   {
     return errors;
   }
-  else if (!incomingVertexEdges.first.Valid())
-  {
-    errors.push_back({ErrorCode::POSE_RELATIVE_TO_GRAPH_ERROR,
-        "PoseRelativeToGraph unable to find path to source vertex "
-        "when starting from vertex with name [" + _vertexName + "]."});
-    return errors;
-  }
-  else if (incomingVertexEdges.first.Name() != _graph.sourceName)
+
+  errors = checkPoseRelativeToSource(
+      _graph, incomingVertexEdges.first, _vertexName);
+  if (!errors.empty())
   {
-    errors.push_back({ErrorCode::POSE_RELATIVE_TO_GRAPH_ERROR,
-        "PoseRelativeToGraph frame with name [" + _vertexName + "] "
-        "is disconnected; its source vertex has name [" +
-        incomingVertexEdges.first.Name() +
-        "], but its source name should be " + _graph.sourceName + "."});
     return errors;
   }
 
@@ -1274,6 +1749,64 @@ Errors resolvePoseRelativeToRoot(
   return errors;
 }
 
+/////////////////////////////////////////////////
+FrameIds findFrameIds(
+    const std::weak_ptr<const PoseRelativeToGraph> &_graph,
+    const std::string &_relativeTo,
+    const std::string &_resolveTo)
+{
+  FrameIds ids;
+  auto graph = _graph.lock();
+  if (!graph)
+  {
+    return ids;
+  }
+
+  auto relativeToIt = graph->map.find(_relativeTo);
+  if (relativeToIt != graph->map.end())
+  {
+    ids.relativeTo = relativeToIt->second;
+  }
+  auto resolveToIt = graph->map.find(_resolveTo);
+  if (resolveToIt != graph->map.end())
+  {
+    ids.resolveTo = resolveToIt->second;
+  }
+  return ids;
+}
+
+/////////////////////////////////////////////////
+bool resolveCachedPose(
+    ignition::math::Pose3d &_pose,
+    const PoseRelativeToGraph &_graph,
+    const FrameIds &_ids)
+{
+  if (_ids.relativeTo == ignition::math::graph::kNullId ||
+      _ids.resolveTo == ignition::math::graph::kNullId)
+  {
+    return false;
+  }
+
+  std::lock_guard<std::mutex> lock(_graph.rootPosesMutex);
+  if (!_graph.rootPosesValid ||
+      _graph.rootPosesMapSize != _graph.map.size())
+  {
+    computeRootPoses(_graph);
+  }
+
+  // A removed vertex has no cached pose, so stale ids are resolved by name.
+  auto poseIt = _graph.rootPoses.find(_ids.relativeTo);
+  auto poseRIt = _graph.rootPoses.find(_ids.resolveTo);
+  if (poseIt == _graph.rootPoses.end() || poseRIt == _graph.rootPoses.end())
+  {
+    return false;
+  }
+
+  _pose = composeRootPose(_graph, poseRIt->second).Inverse() *
+      composeRootPose(_graph, poseIt->second);
+  return true;
+}
+
 /////////////////////////////////////////////////
 Errors resolvePose(
     ignition::math::Pose3d &_pose,
@@ -1294,5 +1827,364 @@ Errors resolvePose(
 
   return errors;
 }
+
+/////////////////////////////////////////////////
+Errors resolvePoses(
+    std::vector<ignition::math::Pose3d> &_poses,
+    const PoseRelativeToGraph &_graph,
+    const std::vector<std::string> &_frameNames,
+    const std::string &_resolveTo)
+{
+  ignition::math::Pose3d poseR;
+  Errors errors = resolvePoseRelativeToRoot(poseR, _graph, _resolveTo);
+  const ignition::math::Pose3d inverseR = poseR.Inverse();
+
+  std::vector<ignition::math::Pose3d> poses(_frameNames.size());
+  for (std::size_t i = 0; i < _frameNames.size(); ++i)
+  {
+    Errors e = resolvePoseRelativeToRoot(poses[i], _graph, _frameNames[i]);
+    errors.insert(errors.end(), e.begin(), e.end());
+    poses[i] = inverseR * poses[i];
+  }
+
+  if (errors.empty())
+  {
+    _poses = std::move(poses);
+  }
+
+  return errors;
+}
+/////////////////////////////////////////////////
+Errors updatePoseRelativeToGraph(
+    PoseRelativeToGraph &_graph,
+    const std::string &_frameName,
+    const std::string &_relativeTo,
+    const ignition::math::Pose3d &_pose)
+{
+  Errors errors;
+
+  auto frameIt = _graph.map.find(_frameName);
+  if (frameIt == _graph.map.end())
+  {
+    errors.push_back({ErrorCode::POSE_RELATIVE_TO_INVALID,
+        "PoseRelativeToGraph unable to find unique frame with name [" +
+        _frameName + "] in graph."});
+    return errors;
+  }
+  auto frameId = frameIt->second;
+
+  auto relativeToIt = _graph.map.find(_relativeTo);
+  if (relativeToIt == _graph.map.end())
+  {
+    errors.push_back({ErrorCode::POSE_RELATIVE_TO_INVALID,
+        "relative_to name[" + _relativeTo +
+        "] specified by frame with name[" + _frameName +
+        "] does not match a frame name in PoseRelativeToGraph."});
+    return errors;
+  }
+  auto relativeToId = relativeToIt->second;
+
+  auto incidentsTo = _graph.graph.IncidentsTo(frameId);
+  if (_frameName == _graph.sourceName || incidentsTo.size() != 1)
+  {
+    errors.push_back({ErrorCode::POSE_RELATIVE_TO_GRAPH_ERROR,
+        "PoseRelativeToGraph error: frame with name [" + _frameName +
+        "] has " + std::to_string(incidentsTo.size()) +
+        " incoming edges; only a frame with 1 incoming edge can be "
+        "updated."});
+    return errors;
+  }
+
+  // The new edge makes a cycle if the pose of _relativeTo depends on the
+  // pose of the frame. The walk stops after visiting every vertex once in
+  // case the graph already has a cycle that does not contain the frame.
+  auto id = relativeToId;
+  for (std::size_t i = 0; i <= _graph.map.size(); ++i)
+  {
+    if (id == frameId)
+    {
+      errors.push_back({ErrorCode::POSE_RELATIVE_TO_CYCLE,
+          "relative_to name[" + _relativeTo +
+          "] specified by frame with name[" + _frameName +
+          "] depends on the pose of that frame, causing a graph cycle."});
+      return errors;
+    }
+    auto incidents = _graph.graph.IncidentsTo(id);
+    if (incidents.size() != 1)
+    {
+      break;
+    }
+    id = incidents.begin()->second.get().Vertices().first;
+  }
+
+  auto edgeId = incidentsTo.begin()->first;
+  if (_graph.graph.EdgeFromId(edgeId).Vertices().first == relativeToId)
+  {
+    _graph.graph.EdgeFromId(edgeId).Data() = _pose;
+  }
+  else
+  {
+    _graph.graph.RemoveEdge(edgeId);
+    _graph.graph.AddEdge({relativeToId, frameId}, _pose);
+  }
+
+  // Update the cached poses of the frame and of the frames whose poses
+  // depend on it. The poses of the frames of a nested model are relative
+  // to its frame, so they are kept unless the frame was disconnected from
+  // the source vertex before. They are removed if _relativeTo is not
+  // connected to the source vertex.
+  std::lock_guard<std::mutex> lock(_graph.rootPosesMutex);
+  if (!_graph.rootPosesValid)
+  {
+    return errors;
+  }
+
+  auto parentPoseIt = _graph.rootPoses.find(relativeToId);
+  const bool connected = parentPoseIt != _graph.rootPoses.end();
+  const bool wasConnected = _graph.rootPoses.count(frameId) > 0;
+  const bool allFrames = !connected || !wasConnected;
+  if (connected)
+  {
+    _graph.rootPoses[frameId] =
+        childScopePose(_graph, relativeToId, parentPoseIt->second, _pose);
+  }
+  else
+  {
+    _graph.rootPoses.erase(frameId);
+  }
+
+  std::vector<ignition::math::graph::VertexId> stack;
+  if (allFrames || !isNestedModelFrame(_graph, frameId))
+  {
+    stack.push_back(frameId);
+  }
+  while (!stack.empty())
+  {
+    auto parentId = stack.back();
+    stack.pop_back();
+    for (auto const &edgePair : _graph.graph.IncidentsFrom(parentId))
+    {
+      auto const &edge = edgePair.second.get();
+      auto childId = edge.Vertices().second;
+      if (_graph.graph.InDegree(childId) != 1)
+      {
+        continue;
+      }
+      if (connected)
+      {
+        _graph.rootPoses[childId] = childScopePose(_graph, parentId,
+            _graph.rootPoses.at(parentId), edge.Data());
+      }
+      else
+      {
+        _graph.rootPoses.erase(childId);
+      }
+      if (allFrames || !isNestedModelFrame(_graph, childId))
+      {
+        stack.push_back(childId);
+      }
+    }
+  }
+
+  return errors;
+}
+
+/////////////////////////////////////////////////
+void addScopeVertex(
+    FrameAttachedToGraph *_attachedToGraph,
+    PoseRelativeToGraph &_poseGraph,
+    const std::string &_scopeName,
+    FrameType _type)
+{
+  if (_attachedToGraph)
+  {
+    _attachedToGraph->scopeName = _scopeName;
+    _attachedToGraph->attachedToBodiesValid = false;
+    _attachedToGraph->map[_scopeName] =
+        _attachedToGraph->graph.AddVertex(_scopeName, _type).Id();
+  }
+
+  _poseGraph.sourceName = _scopeName;
+  _poseGraph.rootPosesValid = false;
+  _poseGraph.map[_scopeName] =
+      _poseGraph.graph.AddVertex(_scopeName, _type).Id();
+}
+
+/////////////////////////////////////////////////
+Errors addFrameToGraphs(
+    FrameAttachedToGraph *_attachedToGraph,
+    PoseRelativeToGraph &_poseGraph,
+    const std::string &_frameName,
+    FrameType _type,
+    const std::string &_attachedTo,
+    const std::string &_relativeTo,
+    const ignition::math::Pose3d &_pose,
+    bool _attachScope)
+{
+  Errors errors;
+
+  if (_poseGraph.map.count(_frameName) > 0 ||
+      (_attachedToGraph && _attachedToGraph->map.count(_frameName) > 0))
+  {
+    errors.push_back({ErrorCode::DUPLICATE_NAME,
+        "Frame with non-unique name [" + _frameName +
+        "] detected in graphs with scope [" + _poseGraph.sourceName +
+        "]."});
+    return errors;
+  }
+
+  auto relativeToIt = _poseGraph.map.find(_relativeTo);
+  if (relativeToIt == _poseGraph.map.end())
+  {
+    errors.push_back({ErrorCode::POSE_RELATIVE_TO_INVALID,
+        "relative_to name[" + _relativeTo +
+        "] specified by frame with name[" + _frameName +
+        "] does not match a frame name in PoseRelativeToGraph."});
+  }
+
+  ignition::math::graph::VertexId attachedToId = 0;
+  if (_attachedToGraph && !_attachedTo.empty())
+  {
+    auto attachedToIt = _attachedToGraph->map.find(_attachedTo);
+    if (attachedToIt == _attachedToGraph->map.end())
+    {
+      errors.push_back({ErrorCode::FRAME_ATTACHED_TO_INVALID,
+          "attached_to name[" + _attachedTo +
+          "] specified by frame with name[" + _frameName +
+          "] does not match a frame name in FrameAttachedToGraph."});
+    }
+    else
+    {
+      attachedToId = attachedToIt->second;
+    }
+  }
+
+  if (!errors.empty())
+  {
+    return errors;
+  }
+
+  if (_attachedToGraph)
+  {
+    FrameAttachedToGraph &graph = *_attachedToGraph;
+    auto frameId = graph.graph.AddVertex(_frameName, _type).Id();
+    graph.map[_frameName] = frameId;
+    if (!_attachedTo.empty())
+    {
+      graph.graph.AddEdge({frameId, attachedToId}, true);
+    }
+
+    auto scopeIt = graph.map.find(graph.scopeName);
+    if (_attachScope && scopeIt != graph.map.end() &&
+        graph.graph.OutDegree(scopeIt->second) == 0)
+    {
+      graph.graph.AddEdge({scopeIt->second, frameId}, true);
+    }
+    // The cache of attached-to bodies is recomputed since the map grew.
+  }
+
+  auto relativeToId = relativeToIt->second;
+  auto frameId = _poseGraph.graph.AddVertex(_frameName, _type).Id();
+  _poseGraph.map[_frameName] = frameId;
+  _poseGraph.graph.AddEdge({relativeToId, frameId}, _pose);
+
+  // Extend the cached root poses if they were up to date before the frame
+  // was added. Otherwise they are recomputed on the next resolve.
+  std::lock_guard<std::mutex> lock(_poseGraph.rootPosesMutex);
+  if (_poseGraph.rootPosesValid &&
+      _poseGraph.rootPosesMapSize + 1 == _poseGraph.map.size())
+  {
+    auto parentPoseIt = _poseGraph.rootPoses.find(relativeToId);
+    if (parentPoseIt != _poseGraph.rootPoses.end())
+    {
+      _poseGraph.rootPoses[frameId] = childScopePose(
+          _poseGraph, relativeToId, parentPoseIt->second, _pose);
+    }
+    _poseGraph.rootPosesMapSize = _poseGraph.map.size();
+  }
+
+  return errors;
+}
+
+/////////////////////////////////////////////////
+Errors removeFrameFromGraphs(
+    FrameAttachedToGraph *_attachedToGraph,
+    PoseRelativeToGraph &_poseGraph,
+    const std::string &_frameName)
+{
+  Errors errors;
+
+  auto poseIt = _poseGraph.map.find(_frameName);
+  if (poseIt == _poseGraph.map.end() || _frameName == _poseGraph.sourceName)
+  {
+    errors.push_back({ErrorCode::POSE_RELATIVE_TO_INVALID,
+        "No frame with name[" + _frameName + "] to remove from graphs with "
+        "scope [" + _poseGraph.sourceName + "]."});
+    return errors;
+  }
+
+  // Edges of the PoseRelativeToGraph point from the relative_to frame to
+  // the frame, and edges of the FrameAttachedToGraph from the frame to its
+  // attached_to frame, so other frames depend on this one through its
+  // outgoing and incoming edges respectively.
+  if (_poseGraph.graph.OutDegree(poseIt->second) > 0)
+  {
+    errors.push_back({ErrorCode::POSE_RELATIVE_TO_INVALID,
+        "Frame with name[" + _frameName + "] cannot be removed, since the "
+        "pose of another frame is relative to it."});
+  }
+
+  FrameAttachedToGraph::MapType::iterator attachedIt;
+  if (_attachedToGraph)
+  {
+    attachedIt = _attachedToGraph->map.find(_frameName);
+    if (attachedIt != _attachedToGraph->map.end() &&
+        _attachedToGraph->graph.InDegree(attachedIt->second) > 0)
+    {
+      errors.push_back({ErrorCode::FRAME_ATTACHED_TO_INVALID,
+          "Frame with name[" + _frameName + "] cannot be removed, since "
+          "another frame is attached to it."});
+    }
+  }
+
+  if (!errors.empty())
+  {
+    return errors;
+  }
+
+  if (_attachedToGraph && attachedIt != _attachedToGraph->map.end())
+  {
+    std::lock_guard<std::mutex> lock(_attachedToGraph->attachedToBodiesMutex);
+    const ignition::math::graph::VertexId id = attachedIt->second;
+    _attachedToGraph->graph.RemoveVertex(id);
+    _attachedToGraph->map.erase(attachedIt);
+
+    // No frame is attached to the removed one, so the cached bodies of the
+    // other frames stay valid.
+    if (_attachedToGraph->attachedToBodiesValid &&
+        _attachedToGraph->attachedToBodiesMapSize ==
+        _attachedToGraph->map.size() + 1)
+    {
+      _attachedToGraph->attachedToBodies.erase(id);
+      _attachedToGraph->attachedToBodiesMapSize =
+          _attachedToGraph->map.size();
+    }
+  }
+
+  // No pose is relative to the removed frame, so the cached root poses of
+  // the other frames stay valid.
+  const ignition::math::graph::VertexId id = poseIt->second;
+  _poseGraph.graph.RemoveVertex(id);
+  _poseGraph.map.erase(poseIt);
+  std::lock_guard<std::mutex> lock(_poseGraph.rootPosesMutex);
+  if (_poseGraph.rootPosesValid &&
+      _poseGraph.rootPosesMapSize == _poseGraph.map.size() + 1)
+  {
+    _poseGraph.rootPoses.erase(id);
+    _poseGraph.rootPosesMapSize = _poseGraph.map.size();
+  }
+
+  return errors;
+}
 }
 }
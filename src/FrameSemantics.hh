@@ -17,14 +17,20 @@
 #ifndef SDF_FRAMESEMANTICS_HH_
 #define SDF_FRAMESEMANTICS_HH_
 
+#include <cstddef>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 #include <ignition/math/Pose3.hh>
 #include <ignition/math/graph/Graph.hh>
 
 #include "sdf/Error.hh"
 #include "sdf/Types.hh"
+#include "ScopedNameMap.hh"
 
 /// \ingroup sdf_frame_semantics
 /// \brief namespace for Simulation Description Format Frame Semantics Utilities
@@ -65,23 +71,69 @@ namespace sdf
   /// \brief Data structure for frame attached_to graphs for Model or World.
   struct FrameAttachedToGraph
   {
+    /// \brief Default constructor.
+    FrameAttachedToGraph() = default;
+
+    /// \brief Copy constructor. The cache of attached-to bodies is not
+    /// copied.
+    /// \param[in] _graph Graph to copy.
+    FrameAttachedToGraph(const FrameAttachedToGraph &_graph);
+
+    /// \brief Copy assignment. The cache of attached-to bodies is not
+    /// copied.
+    /// \param[in] _graph Graph to copy.
+    /// \return Reference to this graph.
+    FrameAttachedToGraph &operator=(const FrameAttachedToGraph &_graph);
+
     /// \brief A DirectedGraph with a vertex for each frame and edges pointing
     /// to the frame to which another frame is attached. Each vertex stores
     /// its FrameType and each edge can store a boolean value.
     using GraphType = ignition::math::graph::DirectedGraph<FrameType, bool>;
     GraphType graph;
 
-    /// \brief A Map from Vertex names to Vertex Ids.
-    using MapType = std::map<std::string, ignition::math::graph::VertexId>;
+    /// \brief A Map from Vertex names to Vertex Ids, which stores the
+    /// scopes of the names of nested model frames once.
+    using MapType = ScopedNameMap<ignition::math::graph::VertexId>;
     MapType map;
 
     /// \brief Name of scope vertex, either __model__ or world.
     std::string scopeName;
+
+    /// \brief VertexId of the attached-to body of each vertex whose edges
+    /// lead to a valid body, by VertexId. It is computed in one pass by
+    /// validateFrameAttachedToGraph or by the first call to
+    /// resolveFrameAttachedToBody. Other vertices are resolved by walking
+    /// the graph, which reports errors.
+    mutable std::unordered_map<ignition::math::graph::VertexId,
+        ignition::math::graph::VertexId> attachedToBodies;
+
+    /// \brief True if attachedToBodies has been computed.
+    mutable bool attachedToBodiesValid = false;
+
+    /// \brief Size of map when attachedToBodies was computed. The cache is
+    /// recomputed if vertices are added after it.
+    mutable std::size_t attachedToBodiesMapSize = 0;
+
+    /// \brief Mutex protecting the attachedToBodies cache, since a graph is
+    /// shared by const pointer between DOM objects.
+    mutable std::mutex attachedToBodiesMutex;
   };
 
   /// \brief Data structure for pose relative_to graphs for Model or World.
   struct PoseRelativeToGraph
   {
+    /// \brief Default constructor.
+    PoseRelativeToGraph() = default;
+
+    /// \brief Copy constructor. The cache of root poses is not copied.
+    /// \param[in] _graph Graph to copy.
+    PoseRelativeToGraph(const PoseRelativeToGraph &_graph);
+
+    /// \brief Copy assignment. The cache of root poses is not copied.
+    /// \param[in] _graph Graph to copy.
+    /// \return Reference to this graph.
+    PoseRelativeToGraph &operator=(const PoseRelativeToGraph &_graph);
+
     /// \brief A DirectedGraph with a vertex for each explicit or implicit
     /// frame and edges pointing to a given frame from its relative-to frame.
     /// When well-formed, it should form a directed tree with a root vertex
@@ -91,12 +143,49 @@ namespace sdf
     using GraphType = ignition::math::graph::DirectedGraph<FrameType, Pose3d>;
     GraphType graph;
 
-    /// \brief A Map from Vertex names to Vertex Ids.
-    using MapType = std::map<std::string, ignition::math::graph::VertexId>;
+    /// \brief A Map from Vertex names to Vertex Ids, which stores the
+    /// scopes of the names of nested model frames once.
+    using MapType = ScopedNameMap<ignition::math::graph::VertexId>;
     MapType map;
 
     /// \brief Name of source vertex, either __model__ or world.
     std::string sourceName;
+
+    /// \brief Pose of a vertex relative to the nearest nested model frame
+    /// on its path to the source vertex.
+    struct ScopePose
+    {
+      /// \brief Id of the nested model frame, such as a::b::__model__ for
+      /// a model included in a model included in this one, or of the source
+      /// vertex. It is kNullId for the source vertex itself.
+      ignition::math::graph::VertexId scope = ignition::math::graph::kNullId;
+
+      /// \brief Pose relative to the scope vertex.
+      Pose3d pose;
+    };
+
+    /// \brief Poses of each vertex in the tree rooted at the source vertex,
+    /// by VertexId, relative to their nested model frame. Nested models are
+    /// flattened into this graph by addNestedModel, so a pose relative to
+    /// the source vertex is composed at query time from one cached pose per
+    /// nesting level. Moving a nested model then only updates the poses in
+    /// its own scope instead of every frame of the models nested in it. It
+    /// is computed in one pass by the first call to
+    /// resolvePoseRelativeToRoot. Vertices outside of that tree are resolved
+    /// by walking the graph, which reports errors.
+    mutable std::unordered_map<ignition::math::graph::VertexId, ScopePose>
+        rootPoses;
+
+    /// \brief True if rootPoses has been computed.
+    mutable bool rootPosesValid = false;
+
+    /// \brief Size of map when rootPoses was computed. The cache is
+    /// recomputed if vertices are added after it.
+    mutable std::size_t rootPosesMapSize = 0;
+
+    /// \brief Mutex protecting the rootPoses cache, since a graph is shared
+    /// by const pointer between DOM objects.
+    mutable std::mutex rootPosesMutex;
   };
 
   /// \brief Build a FrameAttachedToGraph for a model.
@@ -178,6 +267,145 @@ namespace sdf
       const PoseRelativeToGraph &_graph,
       const std::string &_frameName,
       const std::string &_resolveTo);
+
+  /// \brief Resolve poses of several frames relative to the same named
+  /// frame. The poses relative to the source vertex are shared by all the
+  /// frames, so this is one pass over the graph instead of one walk to the
+  /// source vertex per frame.
+  /// \param[out] _poses Poses of the frames in _frameNames, in the same
+  /// order. It is not changed if there are errors.
+  /// \param[in] _graph PoseRelativeToGraph to read from.
+  /// \param[in] _frameNames Names of frames whose poses are to be resolved.
+  /// \param[in] _resolveTo Name of frame relative to which the poses are
+  /// to be resolved.
+  /// \return Errors.
+  Errors resolvePoses(
+      std::vector<ignition::math::Pose3d> &_poses,
+      const PoseRelativeToGraph &_graph,
+      const std::vector<std::string> &_frameNames,
+      const std::string &_resolveTo);
+
+  /// \brief Vertex ids of the frame that the pose of a DOM object is
+  /// relative to and of the frame it is resolved to by default. DOM objects
+  /// find them once, when their PoseRelativeToGraph or the names are set,
+  /// so that resolving their pose to the default frame needs neither string
+  /// operations nor map lookups by name.
+  struct FrameIds
+  {
+    /// \brief Id of the frame that the pose is relative to, or kNullId if
+    /// it is not in the graph.
+    ignition::math::graph::VertexId relativeTo =
+        ignition::math::graph::kNullId;
+
+    /// \brief Id of the default frame to resolve to, or kNullId if it is
+    /// not in the graph.
+    ignition::math::graph::VertexId resolveTo =
+        ignition::math::graph::kNullId;
+  };
+
+  /// \brief Find the vertex ids of two frames of a PoseRelativeToGraph.
+  /// \param[in] _graph The graph. The ids are kNullId if it is expired.
+  /// \param[in] _relativeTo Name of the frame that the pose is relative to.
+  /// \param[in] _resolveTo Name of the default frame to resolve to.
+  /// \return The ids.
+  FrameIds findFrameIds(
+      const std::weak_ptr<const PoseRelativeToGraph> &_graph,
+      const std::string &_relativeTo,
+      const std::string &_resolveTo);
+
+  /// \brief Resolve the pose of a frame relative to another frame from
+  /// the cached root poses of the graph, by their vertex ids. This gives
+  /// the same pose as resolvePose, without looking the frames up by name.
+  /// \param[out] _pose Pose of _ids.relativeTo relative to _ids.resolveTo.
+  /// It is not changed if false is returned.
+  /// \param[in] _graph PoseRelativeToGraph to read from.
+  /// \param[in] _ids Ids of the frames.
+  /// \return True if both frames have a cached pose, or false if they must
+  /// be resolved by name with resolvePose, which reports the errors, such
+  /// as for frames that are not in the graph or not connected to its
+  /// source vertex.
+  bool resolveCachedPose(
+      ignition::math::Pose3d &_pose,
+      const PoseRelativeToGraph &_graph,
+      const FrameIds &_ids);
+
+  /// \brief Update the edge of a PoseRelativeToGraph that points to a
+  /// frame, without rebuilding the graph. The new edge is checked for cycles
+  /// by following edges from _relativeTo towards the source vertex, and only
+  /// the cached poses of the frame and of the frames of the same nested
+  /// model whose poses depend on it are updated.
+  /// \param[in,out] _graph PoseRelativeToGraph to update.
+  /// \param[in] _frameName Name of the frame whose pose is updated.
+  /// \param[in] _relativeTo Name of the frame relative to which _pose is
+  /// expressed. Default relative_to values must already be resolved.
+  /// \param[in] _pose Pose of the frame relative to _relativeTo.
+  /// \return Errors. The graph is not changed if there are errors.
+  Errors updatePoseRelativeToGraph(
+      PoseRelativeToGraph &_graph,
+      const std::string &_frameName,
+      const std::string &_relativeTo,
+      const ignition::math::Pose3d &_pose);
+
+  /// \brief Add the implicit scope vertex, __model__ or world, to empty
+  /// graphs, for a model or world that is built without being loaded.
+  /// \param[in,out] _attachedToGraph FrameAttachedToGraph to start, or
+  /// nullptr if it is not built, such as for a static model.
+  /// \param[in,out] _poseGraph PoseRelativeToGraph to start.
+  /// \param[in] _scopeName Name of the scope vertex.
+  /// \param[in] _type Type of the scope vertex, MODEL or WORLD.
+  void addScopeVertex(
+      FrameAttachedToGraph *_attachedToGraph,
+      PoseRelativeToGraph &_poseGraph,
+      const std::string &_scopeName,
+      FrameType _type);
+
+  /// \brief Add a frame to the graphs of a model or world without
+  /// rebuilding them, for a link, joint, model or frame added after the
+  /// graphs were built. The new frame has no incoming edge in the
+  /// FrameAttachedToGraph and no outgoing edge in the PoseRelativeToGraph,
+  /// so it cannot make a cycle, and the cached root poses are extended with
+  /// its own pose only.
+  /// \param[in,out] _attachedToGraph FrameAttachedToGraph to update, or
+  /// nullptr if it is not built.
+  /// \param[in,out] _poseGraph PoseRelativeToGraph to update.
+  /// \param[in] _frameName Name of the new frame.
+  /// \param[in] _type Type of the new frame.
+  /// \param[in] _attachedTo Name of the frame to which the new frame is
+  /// attached, or an empty string for a link or model, which is not
+  /// attached to another frame. Default attached_to values must already be
+  /// resolved.
+  /// \param[in] _relativeTo Name of the frame relative to which _pose is
+  /// expressed. Default relative_to values must already be resolved.
+  /// \param[in] _pose Pose of the new frame relative to _relativeTo.
+  /// \param[in] _attachScope True to attach the scope vertex to the new
+  /// frame if it is not attached yet, for the canonical link of a model.
+  /// \return Errors. The graphs are not changed if there are errors.
+  Errors addFrameToGraphs(
+      FrameAttachedToGraph *_attachedToGraph,
+      PoseRelativeToGraph &_poseGraph,
+      const std::string &_frameName,
+      FrameType _type,
+      const std::string &_attachedTo,
+      const std::string &_relativeTo,
+      const ignition::math::Pose3d &_pose,
+      bool _attachScope);
+
+  /// \brief Remove a frame from the graphs of a model or world without
+  /// rebuilding them, for a model or frame removed after the graphs were
+  /// built. Only a frame that no other frame depends on can be removed, so
+  /// the cached root poses and attached-to bodies of the other frames are
+  /// kept.
+  /// \param[in,out] _attachedToGraph FrameAttachedToGraph to update, or
+  /// nullptr if it is not built.
+  /// \param[in,out] _poseGraph PoseRelativeToGraph to update.
+  /// \param[in] _frameName Name of the frame.
+  /// \return Errors if the frame is not in the graphs, or if the pose of
+  /// another frame is relative to it or another frame is attached to it.
+  /// The graphs are not changed if there are errors.
+  Errors removeFrameFromGraphs(
+      FrameAttachedToGraph *_attachedToGraph,
+      PoseRelativeToGraph &_poseGraph,
+      const std::string &_frameName);
   }
 }
 #endif
@@ -15,6 +15,7 @@
  *
  */
 
+#include <memory>
 #include <sstream>
 #include <string>
 
@@ -286,3 +287,296 @@ TEST(FrameSemantics, buildPoseRelativeToGraph)
         "PoseRelativeToGraph unable to find unique frame with name ["
         "invalid] in graph."));
 }
+
+/////////////////////////////////////////////////
+TEST(FrameSemantics, resolvePoseRelativeToRootCache)
+{
+  // Build a long chain of frames relative to each other.
+  sdf::PoseRelativeToGraph graph;
+  graph.sourceName = "__model__";
+  auto parentId =
+      graph.graph.AddVertex("__model__", sdf::FrameType::MODEL).Id();
+  graph.map["__model__"] = parentId;
+  const int frameCount = 1000;
+  for (int i = 0; i < frameCount; ++i)
+  {
+    const std::string name = "F" + std::to_string(i);
+    auto id = graph.graph.AddVertex(name, sdf::FrameType::FRAME).Id();
+    graph.map[name] = id;
+    graph.graph.AddEdge({parentId, id}, {0, 0, 1, 0, 0, 0});
+    parentId = id;
+  }
+
+  EXPECT_TRUE(sdf::validatePoseRelativeToGraph(graph).empty());
+
+  ignition::math::Pose3d pose;
+  for (int i = 0; i < frameCount; ++i)
+  {
+    const std::string name = "F" + std::to_string(i);
+    EXPECT_TRUE(sdf::resolvePoseRelativeToRoot(pose, graph, name).empty());
+    EXPECT_NEAR(i + 1.0, pose.Pos().Z(), 1e-9);
+  }
+  EXPECT_TRUE(sdf::resolvePose(pose, graph, "F10", "F999").empty());
+  EXPECT_NEAR(-989.0, pose.Pos().Z(), 1e-9);
+
+  // Vertices added after poses were resolved are found, and vertices
+  // outside of the tree still report their errors.
+  auto extendedId = graph.graph.AddVertex("E", sdf::FrameType::FRAME).Id();
+  graph.map["E"] = extendedId;
+  graph.graph.AddEdge({parentId, extendedId}, {1, 0, 0, 0, 0, 0});
+  EXPECT_TRUE(sdf::resolvePoseRelativeToRoot(pose, graph, "E").empty());
+  EXPECT_EQ(ignition::math::Pose3d(1, 0, frameCount, 0, 0, 0), pose);
+
+  auto disconnectedId =
+      graph.graph.AddVertex("D", sdf::FrameType::FRAME).Id();
+  graph.map["D"] = disconnectedId;
+  auto errors = sdf::resolvePoseRelativeToRoot(pose, graph, "D");
+  ASSERT_EQ(1u, errors.size());
+  EXPECT_EQ(errors[0].Code(), sdf::ErrorCode::POSE_RELATIVE_TO_GRAPH_ERROR);
+  EXPECT_NE(std::string::npos,
+      errors[0].Message().find("is disconnected"));
+}
+
+/////////////////////////////////////////////////
+TEST(FrameSemantics, resolvePoseRelativeToRootNestedModels)
+{
+  // Build the frames of models nested in each other, as flattened by
+  // addNestedModel, with a link in each model.
+  sdf::PoseRelativeToGraph graph;
+  graph.sourceName = "__model__";
+  auto addFrame = [&graph](const std::string &_name,
+      const std::string &_relativeTo, const ignition::math::Pose3d &_pose)
+  {
+    auto id = graph.graph.AddVertex(_name, sdf::FrameType::FRAME).Id();
+    graph.map[_name] = id;
+    graph.graph.AddEdge({graph.map.at(_relativeTo), id}, _pose);
+  };
+  graph.map["__model__"] =
+      graph.graph.AddVertex("__model__", sdf::FrameType::MODEL).Id();
+  addFrame("link", "__model__", {0, 0, 1, 0, 0, 0});
+  addFrame("a::__model__", "link", {1, 0, 0, 0, 0, 0});
+  addFrame("a::link", "a::__model__", {0, 0, 1, 0, 0, 0});
+  addFrame("a::b::__model__", "a::link", {1, 0, 0, 0, 0, 0});
+  addFrame("a::b::link", "a::b::__model__", {0, 0, 1, 0, 0, 0});
+  EXPECT_TRUE(sdf::validatePoseRelativeToGraph(graph).empty());
+
+  ignition::math::Pose3d pose;
+  EXPECT_TRUE(
+      sdf::resolvePoseRelativeToRoot(pose, graph, "a::b::link").empty());
+  EXPECT_EQ(ignition::math::Pose3d(2, 0, 3, 0, 0, 0), pose);
+  EXPECT_TRUE(sdf::resolvePose(pose, graph, "a::b::link", "a::link").empty());
+  EXPECT_EQ(ignition::math::Pose3d(1, 0, 1, 0, 0, 0), pose);
+
+  // Moving a nested model moves the models nested in it.
+  EXPECT_TRUE(sdf::updatePoseRelativeToGraph(
+      graph, "a::__model__", "link", {0, 1, 0, 0, 0, 0}).empty());
+  EXPECT_TRUE(
+      sdf::resolvePoseRelativeToRoot(pose, graph, "a::b::link").empty());
+  EXPECT_EQ(ignition::math::Pose3d(1, 1, 3, 0, 0, 0), pose);
+  EXPECT_TRUE(
+      sdf::resolvePoseRelativeToRoot(pose, graph, "a::link").empty());
+  EXPECT_EQ(ignition::math::Pose3d(0, 1, 2, 0, 0, 0), pose);
+
+  // Moving a frame that a nested model is relative to moves that model.
+  EXPECT_TRUE(sdf::updatePoseRelativeToGraph(
+      graph, "a::link", "a::__model__", {0, 0, 2, 0, 0, 0}).empty());
+  EXPECT_TRUE(
+      sdf::resolvePoseRelativeToRoot(pose, graph, "a::b::link").empty());
+  EXPECT_EQ(ignition::math::Pose3d(1, 1, 4, 0, 0, 0), pose);
+
+  // A nested model made relative to a disconnected frame is not resolved,
+  // and is resolved again once it is connected.
+  auto disconnectedId =
+      graph.graph.AddVertex("D", sdf::FrameType::FRAME).Id();
+  graph.map["D"] = disconnectedId;
+  EXPECT_TRUE(sdf::updatePoseRelativeToGraph(
+      graph, "a::b::__model__", "D", {}).empty());
+  EXPECT_FALSE(
+      sdf::resolvePoseRelativeToRoot(pose, graph, "a::b::link").empty());
+  EXPECT_TRUE(sdf::updatePoseRelativeToGraph(
+      graph, "a::b::__model__", "__model__", {5, 0, 0, 0, 0, 0}).empty());
+  EXPECT_TRUE(
+      sdf::resolvePoseRelativeToRoot(pose, graph, "a::b::link").empty());
+  EXPECT_EQ(ignition::math::Pose3d(5, 0, 1, 0, 0, 0), pose);
+}
+
+/////////////////////////////////////////////////
+TEST(FrameSemantics, resolveCachedPose)
+{
+  auto graph = std::make_shared<sdf::PoseRelativeToGraph>();
+  graph->sourceName = "__model__";
+  auto addFrame = [&graph](const std::string &_name,
+      const std::string &_relativeTo, const ignition::math::Pose3d &_pose)
+  {
+    auto id = graph->graph.AddVertex(_name, sdf::FrameType::FRAME).Id();
+    graph->map[_name] = id;
+    graph->graph.AddEdge({graph->map.at(_relativeTo), id}, _pose);
+  };
+  graph->map["__model__"] =
+      graph->graph.AddVertex("__model__", sdf::FrameType::MODEL).Id();
+  addFrame("A", "__model__", {0, 0, 1, 0, 0, 0});
+  addFrame("B", "A", {1, 0, 0, 0, 0, IGN_PI_2});
+  std::weak_ptr<const sdf::PoseRelativeToGraph> weakGraph = graph;
+
+  // The cached pose matches the pose resolved by name.
+  sdf::FrameIds ids = sdf::findFrameIds(weakGraph, "B", "A");
+  EXPECT_EQ(graph->map.at("B"), ids.relativeTo);
+  EXPECT_EQ(graph->map.at("A"), ids.resolveTo);
+  ignition::math::Pose3d cachedPose;
+  ignition::math::Pose3d pose;
+  EXPECT_TRUE(sdf::resolveCachedPose(cachedPose, *graph, ids));
+  EXPECT_TRUE(sdf::resolvePose(pose, *graph, "B", "A").empty());
+  EXPECT_EQ(pose, cachedPose);
+
+  ids = sdf::findFrameIds(weakGraph, "__model__", "B");
+  EXPECT_TRUE(sdf::resolveCachedPose(cachedPose, *graph, ids));
+  EXPECT_TRUE(sdf::resolvePose(pose, *graph, "__model__", "B").empty());
+  EXPECT_EQ(pose, cachedPose);
+
+  // Frames that are not in the graph have no id.
+  ids = sdf::findFrameIds(weakGraph, "C", "A");
+  EXPECT_EQ(ignition::math::graph::kNullId, ids.relativeTo);
+  EXPECT_FALSE(sdf::resolveCachedPose(cachedPose, *graph, ids));
+  EXPECT_EQ(ignition::math::graph::kNullId,
+      sdf::findFrameIds({}, "A", "B").relativeTo);
+
+  // A disconnected frame is not resolved.
+  graph->map["D"] = graph->graph.AddVertex("D", sdf::FrameType::FRAME).Id();
+  ids = sdf::findFrameIds(weakGraph, "D", "A");
+  EXPECT_FALSE(sdf::resolveCachedPose(cachedPose, *graph, ids));
+
+  // The ids of a removed frame are not resolved, even though the vertex
+  // ids of the other frames are unchanged.
+  ids = sdf::findFrameIds(weakGraph, "B", "A");
+  graph->graph.RemoveVertex(graph->map.at("B"));
+  graph->map.erase(graph->map.find("B"));
+  EXPECT_FALSE(sdf::resolveCachedPose(cachedPose, *graph, ids));
+  ids = sdf::findFrameIds(weakGraph, "A", "__model__");
+  EXPECT_TRUE(sdf::resolveCachedPose(cachedPose, *graph, ids));
+  EXPECT_EQ(ignition::math::Pose3d(0, 0, 1, 0, 0, 0), cachedPose);
+}
+
+/////////////////////////////////////////////////
+TEST(FrameSemantics, resolveFrameAttachedToBodyCache)
+{
+  // Build a long chain of frames attached to each other and to a link.
+  sdf::FrameAttachedToGraph graph;
+  graph.scopeName = "__model__";
+  graph.map["__model__"] =
+      graph.graph.AddVertex("__model__", sdf::FrameType::MODEL).Id();
+  auto linkId = graph.graph.AddVertex("L", sdf::FrameType::LINK).Id();
+  graph.map["L"] = linkId;
+  graph.graph.AddEdge({graph.map["__model__"], linkId}, true);
+  auto childId = linkId;
+  const int frameCount = 1000;
+  for (int i = 0; i < frameCount; ++i)
+  {
+    const std::string name = "F" + std::to_string(i);
+    auto id = graph.graph.AddVertex(name, sdf::FrameType::FRAME).Id();
+    graph.map[name] = id;
+    graph.graph.AddEdge({id, childId}, true);
+    childId = id;
+  }
+
+  std::string body;
+  for (int i = 0; i < frameCount; i += 100)
+  {
+    body.clear();
+    const std::string name = "F" + std::to_string(i);
+    EXPECT_TRUE(sdf::resolveFrameAttachedToBody(body, graph, name).empty());
+    EXPECT_EQ("L", body);
+  }
+
+  // Validation computes the bodies again.
+  EXPECT_TRUE(sdf::validateFrameAttachedToGraph(graph).empty());
+  body.clear();
+  EXPECT_TRUE(sdf::resolveFrameAttachedToBody(body, graph, "F999").empty());
+  EXPECT_EQ("L", body);
+
+  // Vertices added after bodies were resolved are found, and vertices
+  // without a valid body still report their errors.
+  auto extendedId = graph.graph.AddVertex("E", sdf::FrameType::FRAME).Id();
+  graph.map["E"] = extendedId;
+  graph.graph.AddEdge({extendedId, childId}, true);
+  body.clear();
+  EXPECT_TRUE(sdf::resolveFrameAttachedToBody(body, graph, "E").empty());
+  EXPECT_EQ("L", body);
+
+  auto disconnectedId =
+      graph.graph.AddVertex("D", sdf::FrameType::FRAME).Id();
+  graph.map["D"] = disconnectedId;
+  auto errors = sdf::resolveFrameAttachedToBody(body, graph, "D");
+  ASSERT_EQ(1u, errors.size());
+  EXPECT_EQ(errors[0].Code(), sdf::ErrorCode::FRAME_ATTACHED_TO_GRAPH_ERROR);
+  EXPECT_NE(std::string::npos,
+      errors[0].Message().find("does not have FrameType LINK"));
+
+  // A copy does not share the cache.
+  sdf::FrameAttachedToGraph copy = graph;
+  body.clear();
+  EXPECT_TRUE(sdf::resolveFrameAttachedToBody(body, copy, "E").empty());
+  EXPECT_EQ("L", body);
+}
+
+/////////////////////////////////////////////////
+TEST(FrameSemantics, validatePoseRelativeToGraphCycles)
+{
+  // The source has one child, L. Frames C -> D -> E -> C form a cycle and
+  // E -> F -> G is a chain leaving it, so C, D, E, F and G have errors.
+  sdf::PoseRelativeToGraph graph;
+  graph.sourceName = "__model__";
+  auto addVertex = [&graph](const std::string &_name, sdf::FrameType _type)
+  {
+    auto id = graph.graph.AddVertex(_name, _type).Id();
+    graph.map[_name] = id;
+    return id;
+  };
+  auto modelId = addVertex("__model__", sdf::FrameType::MODEL);
+  auto linkId = addVertex("L", sdf::FrameType::LINK);
+  auto cId = addVertex("C", sdf::FrameType::FRAME);
+  auto dId = addVertex("D", sdf::FrameType::FRAME);
+  auto eId = addVertex("E", sdf::FrameType::FRAME);
+  auto fId = addVertex("F", sdf::FrameType::FRAME);
+  auto gId = addVertex("G", sdf::FrameType::FRAME);
+  graph.graph.AddEdge({modelId, linkId}, {});
+  graph.graph.AddEdge({cId, dId}, {});
+  graph.graph.AddEdge({dId, eId}, {});
+  graph.graph.AddEdge({eId, cId}, {});
+  graph.graph.AddEdge({eId, fId}, {});
+  graph.graph.AddEdge({fId, gId}, {});
+
+  auto errors = sdf::validatePoseRelativeToGraph(graph);
+  std::vector<std::string> cycleErrors;
+  for (auto const &error : errors)
+  {
+    if (error.Code() == sdf::ErrorCode::POSE_RELATIVE_TO_CYCLE)
+    {
+      cycleErrors.push_back(error.Message());
+    }
+  }
+
+  // Errors are reported in the order of the vertex names, each naming the
+  // first vertex that is visited twice when starting from that vertex.
+  ASSERT_EQ(5u, cycleErrors.size());
+  const std::string prefix =
+      "PoseRelativeToGraph cycle detected, already visited vertex [";
+  EXPECT_EQ(prefix + "C].", cycleErrors[0]);
+  EXPECT_EQ(prefix + "D].", cycleErrors[1]);
+  EXPECT_EQ(prefix + "E].", cycleErrors[2]);
+  EXPECT_EQ(prefix + "E].", cycleErrors[3]);
+  EXPECT_EQ(prefix + "E].", cycleErrors[4]);
+
+  // The same errors are found when resolving each vertex.
+  for (const std::string name : {"C", "D", "E", "F", "G"})
+  {
+    ignition::math::Pose3d pose;
+    auto resolveErrors = sdf::resolvePoseRelativeToRoot(pose, graph, name);
+    ASSERT_EQ(1u, resolveErrors.size());
+    EXPECT_EQ(sdf::ErrorCode::POSE_RELATIVE_TO_CYCLE,
+        resolveErrors[0].Code());
+  }
+  ignition::math::Pose3d pose;
+  auto resolveErrors = sdf::resolvePoseRelativeToRoot(pose, graph, "G");
+  ASSERT_EQ(1u, resolveErrors.size());
+  EXPECT_EQ(prefix + "E].", resolveErrors[0].Message());
+}
@@ -14,35 +14,30 @@
  * limitations under the License.
  *
 */
+#include <variant>
+
 #include "sdf/Geometry.hh"
 #include "sdf/Box.hh"
 #include "sdf/Cylinder.hh"
 #include "sdf/Mesh.hh"
 #include "sdf/Plane.hh"
 #include "sdf/Sphere.hh"
+#include "ElementArena.hh"
+#include "Utils.hh"
 
 using namespace sdf;
 
 // Private data class
-class sdf::GeometryPrivate
+class sdf::GeometryPrivate : public ArenaAllocated
 {
   // \brief The geometry type.
   public: GeometryType type = GeometryType::EMPTY;
 
-  /// \brief Pointer to a box.
-  public: std::unique_ptr<Box> box;
-
-  /// \brief Pointer to a cylinder.
-  public: std::unique_ptr<Cylinder> cylinder;
-
-  /// \brief Pointer to a plane.
-  public: std::unique_ptr<Plane> plane;
-
-  /// \brief Pointer to a sphere.
-  public: std::unique_ptr<Sphere> sphere;
-
-  /// \brief Pointer to a mesh.
-  public: std::unique_ptr<Mesh> mesh;
+  /// \brief The shape of the geometry, if it has one. It is stored
+  /// inline, instead of one pointer per shape, since a geometry only has
+  /// the shape of its own type.
+  public: std::variant<std::monostate, Box, Cylinder, Plane, Sphere, Mesh>
+      shape;
 
   /// \brief The SDF element pointer used during load.
   public: sdf::ElementPtr sdf;
@@ -63,39 +58,8 @@ Geometry::~Geometry()
 
 //////////////////////////////////////////////////
 Geometry::Geometry(const Geometry &_geometry)
-  : dataPtr(new GeometryPrivate)
+  : dataPtr(new GeometryPrivate(*_geometry.dataPtr))
 {
-  this->dataPtr->type = _geometry.dataPtr->type;
-
-  if (_geometry.dataPtr->box)
-  {
-    this->dataPtr->box = std::make_unique<sdf::Box>(*_geometry.dataPtr->box);
-  }
-
-  if (_geometry.dataPtr->cylinder)
-  {
-    this->dataPtr->cylinder = std::make_unique<sdf::Cylinder>(
-        *_geometry.dataPtr->cylinder);
-  }
-
-  if (_geometry.dataPtr->plane)
-  {
-    this->dataPtr->plane = std::make_unique<sdf::Plane>(
-        *_geometry.dataPtr->plane);
-  }
-
-  if (_geometry.dataPtr->sphere)
-  {
-    this->dataPtr->sphere = std::make_unique<sdf::Sphere>(
-        *_geometry.dataPtr->sphere);
-  }
-
-  if (_geometry.dataPtr->mesh)
-  {
-    this->dataPtr->mesh = std::make_unique<sdf::Mesh>(*_geometry.dataPtr->mesh);
-  }
-
-  this->dataPtr->sdf = _geometry.dataPtr->sdf;
 }
 
 //////////////////////////////////////////////////
@@ -122,7 +86,7 @@ Errors Geometry::Load(ElementPtr _sdf)
 {
   Errors errors;
 
-  this->dataPtr->sdf = _sdf;
+  this->dataPtr->sdf = retainedElement(_sdf);
 
   // Check that sdf is a valid pointer
   if (!_sdf)
@@ -146,36 +110,36 @@ Errors Geometry::Load(ElementPtr _sdf)
   if (_sdf->HasElement("box"))
   {
     this->dataPtr->type = GeometryType::BOX;
-    this->dataPtr->box.reset(new Box());
-    Errors err = this->dataPtr->box->Load(_sdf->GetElement("box"));
+    Box &box = this->dataPtr->shape.emplace<Box>();
+    Errors err = box.Load(_sdf->FindElement("box"));
     errors.insert(errors.end(), err.begin(), err.end());
   }
   else if (_sdf->HasElement("cylinder"))
   {
     this->dataPtr->type = GeometryType::CYLINDER;
-    this->dataPtr->cylinder.reset(new Cylinder());
-    Errors err = this->dataPtr->cylinder->Load(_sdf->GetElement("cylinder"));
+    Cylinder &cylinder = this->dataPtr->shape.emplace<Cylinder>();
+    Errors err = cylinder.Load(_sdf->FindElement("cylinder"));
     errors.insert(errors.end(), err.begin(), err.end());
   }
   else if (_sdf->HasElement("plane"))
   {
     this->dataPtr->type = GeometryType::PLANE;
-    this->dataPtr->plane.reset(new Plane());
-    Errors err = this->dataPtr->plane->Load(_sdf->GetElement("plane"));
+    Plane &plane = this->dataPtr->shape.emplace<Plane>();
+    Errors err = plane.Load(_sdf->FindElement("plane"));
     errors.insert(errors.end(), err.begin(), err.end());
   }
   else if (_sdf->HasElement("sphere"))
   {
     this->dataPtr->type = GeometryType::SPHERE;
-    this->dataPtr->sphere.reset(new Sphere());
-    Errors err = this->dataPtr->sphere->Load(_sdf->GetElement("sphere"));
+    Sphere &sphere = this->dataPtr->shape.emplace<Sphere>();
+    Errors err = sphere.Load(_sdf->FindElement("sphere"));
     errors.insert(errors.end(), err.begin(), err.end());
   }
   else if (_sdf->HasElement("mesh"))
   {
     this->dataPtr->type = GeometryType::MESH;
-    this->dataPtr->mesh.reset(new Mesh());
-    Errors err = this->dataPtr->mesh->Load(_sdf->GetElement("mesh"));
+    Mesh &mesh = this->dataPtr->shape.emplace<Mesh>();
+    Errors err = mesh.Load(_sdf->FindElement("mesh"));
     errors.insert(errors.end(), err.begin(), err.end());
   }
 
@@ -197,61 +161,61 @@ void Geometry::SetType(const GeometryType _type)
 /////////////////////////////////////////////////
 const Box *Geometry::BoxShape() const
 {
-  return this->dataPtr->box.get();
+  return std::get_if<Box>(&this->dataPtr->shape);
 }
 
 /////////////////////////////////////////////////
 void Geometry::SetBoxShape(const Box &_box)
 {
-  this->dataPtr->box = std::make_unique<Box>(_box);
+  this->dataPtr->shape.emplace<Box>(_box);
 }
 
 /////////////////////////////////////////////////
 const Sphere *Geometry::SphereShape() const
 {
-  return this->dataPtr->sphere.get();
+  return std::get_if<Sphere>(&this->dataPtr->shape);
 }
 
 /////////////////////////////////////////////////
 void Geometry::SetSphereShape(const Sphere &_sphere)
 {
-  this->dataPtr->sphere = std::make_unique<Sphere>(_sphere);
+  this->dataPtr->shape.emplace<Sphere>(_sphere);
 }
 
 /////////////////////////////////////////////////
 const Cylinder *Geometry::CylinderShape() const
 {
-  return this->dataPtr->cylinder.get();
+  return std::get_if<Cylinder>(&this->dataPtr->shape);
 }
 
 /////////////////////////////////////////////////
 void Geometry::SetCylinderShape(const Cylinder &_cylinder)
 {
-  this->dataPtr->cylinder = std::make_unique<Cylinder>(_cylinder);
+  this->dataPtr->shape.emplace<Cylinder>(_cylinder);
 }
 
 /////////////////////////////////////////////////
 const Plane *Geometry::PlaneShape() const
 {
-  return this->dataPtr->plane.get();
+  return std::get_if<Plane>(&this->dataPtr->shape);
 }
 
 /////////////////////////////////////////////////
 void Geometry::SetPlaneShape(const Plane &_plane)
 {
-  this->dataPtr->plane = std::make_unique<Plane>(_plane);
+  this->dataPtr->shape.emplace<Plane>(_plane);
 }
 
 /////////////////////////////////////////////////
 const Mesh *Geometry::MeshShape() const
 {
-  return this->dataPtr->mesh.get();
+  return std::get_if<Mesh>(&this->dataPtr->shape);
 }
 
 /////////////////////////////////////////////////
 void Geometry::SetMeshShape(const Mesh &_mesh)
 {
-  this->dataPtr->mesh = std::make_unique<Mesh>(_mesh);
+  this->dataPtr->shape.emplace<Mesh>(_mesh);
 }
 
 /////////////////////////////////////////////////
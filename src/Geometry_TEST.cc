@@ -218,3 +218,30 @@ TEST(DOMGeometry, Plane)
   EXPECT_EQ(ignition::math::Vector3d::UnitX, geom.PlaneShape()->Normal());
   EXPECT_EQ(ignition::math::Vector2d(9, 8), geom.PlaneShape()->Size());
 }
+
+/////////////////////////////////////////////////
+TEST(DOMGeometry, ReplaceShape)
+{
+  sdf::Geometry geom;
+  geom.SetType(sdf::GeometryType::BOX);
+  sdf::Box boxShape;
+  boxShape.SetSize(ignition::math::Vector3d(1, 2, 3));
+  geom.SetBoxShape(boxShape);
+  ASSERT_NE(nullptr, geom.BoxShape());
+
+  // A geometry has a single shape, so setting another one replaces it.
+  // Before libsdformat 11, BoxShape() still returned the box.
+  geom.SetType(sdf::GeometryType::SPHERE);
+  sdf::Sphere sphereShape;
+  sphereShape.SetRadius(0.5);
+  geom.SetSphereShape(sphereShape);
+  EXPECT_EQ(nullptr, geom.BoxShape());
+  ASSERT_NE(nullptr, geom.SphereShape());
+  EXPECT_DOUBLE_EQ(0.5, geom.SphereShape()->Radius());
+
+  sdf::Geometry geom2(geom);
+  EXPECT_EQ(sdf::GeometryType::SPHERE, geom2.Type());
+  EXPECT_EQ(nullptr, geom2.BoxShape());
+  ASSERT_NE(nullptr, geom2.SphereShape());
+  EXPECT_DOUBLE_EQ(0.5, geom2.SphereShape()->Radius());
+}
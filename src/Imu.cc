@@ -17,6 +17,7 @@
 #include <array>
 #include <string>
 #include "sdf/Imu.hh"
+#include "Utils.hh"
 
 using namespace sdf;
 
@@ -109,7 +110,7 @@ Errors Imu::Load(ElementPtr _sdf)
 {
   Errors errors;
 
-  this->dataPtr->sdf = _sdf;
+  this->dataPtr->sdf = retainedElement(_sdf);
 
   // Check that the provided SDF element is a <imu> element.
   // This is an error that cannot be recovered, so return an error.
@@ -124,31 +125,31 @@ Errors Imu::Load(ElementPtr _sdf)
   // Load the linear acceleration noise values.
   if (_sdf->HasElement("linear_acceleration"))
   {
-    sdf::ElementPtr elem = _sdf->GetElement("linear_acceleration");
+    sdf::ElementPtr elem = _sdf->FindElement("linear_acceleration");
     if (elem->HasElement("x"))
     {
-      if (elem->GetElement("x")->HasElement("noise"))
+      if (elem->FindElement("x")->HasElement("noise"))
       {
         this->dataPtr->linearAccelXNoise.Load(
-            elem->GetElement("x")->GetElement("noise"));
+            elem->FindElement("x")->FindElement("noise"));
       }
     }
 
     if (elem->HasElement("y"))
     {
-      if (elem->GetElement("y")->HasElement("noise"))
+      if (elem->FindElement("y")->HasElement("noise"))
       {
         this->dataPtr->linearAccelYNoise.Load(
-            elem->GetElement("y")->GetElement("noise"));
+            elem->FindElement("y")->FindElement("noise"));
       }
     }
 
     if (elem->HasElement("z"))
     {
-      if (elem->GetElement("z")->HasElement("noise"))
+      if (elem->FindElement("z")->HasElement("noise"))
       {
         this->dataPtr->linearAccelZNoise.Load(
-            elem->GetElement("z")->GetElement("noise"));
+            elem->FindElement("z")->FindElement("noise"));
       }
     }
   }
@@ -156,38 +157,38 @@ Errors Imu::Load(ElementPtr _sdf)
   // Load the angular velocity noise values.
   if (_sdf->HasElement("angular_velocity"))
   {
-    sdf::ElementPtr elem = _sdf->GetElement("angular_velocity");
+    sdf::ElementPtr elem = _sdf->FindElement("angular_velocity");
     if (elem->HasElement("x"))
     {
-      if (elem->GetElement("x")->HasElement("noise"))
+      if (elem->FindElement("x")->HasElement("noise"))
       {
         this->dataPtr->angularVelXNoise.Load(
-            elem->GetElement("x")->GetElement("noise"));
+            elem->FindElement("x")->FindElement("noise"));
       }
     }
 
     if (elem->HasElement("y"))
     {
-      if (elem->GetElement("y")->HasElement("noise"))
+      if (elem->FindElement("y")->HasElement("noise"))
       {
         this->dataPtr->angularVelYNoise.Load(
-            elem->GetElement("y")->GetElement("noise"));
+            elem->FindElement("y")->FindElement("noise"));
       }
     }
 
     if (elem->HasElement("z"))
     {
-      if (elem->GetElement("z")->HasElement("noise"))
+      if (elem->FindElement("z")->HasElement("noise"))
       {
         this->dataPtr->angularVelZNoise.Load(
-            elem->GetElement("z")->GetElement("noise"));
+            elem->FindElement("z")->FindElement("noise"));
       }
     }
   }
 
   if (_sdf->HasElement("orientation_reference_frame"))
   {
-    sdf::ElementPtr elem = _sdf->GetElement("orientation_reference_frame");
+    sdf::ElementPtr elem = _sdf->FindElement("orientation_reference_frame");
     this->dataPtr->localization = elem->Get<std::string>("localization",
         this->dataPtr->localization).first;
 
@@ -196,7 +197,7 @@ Errors Imu::Load(ElementPtr _sdf)
       this->dataPtr->gravityDirX = elem->Get<ignition::math::Vector3d>(
           "grav_dir_x", this->dataPtr->gravityDirX).first;
       this->dataPtr->gravityDirXParentFrame =
-        elem->GetElement("grav_dir_x")->Get<std::string>("parent_frame",
+        elem->FindElement("grav_dir_x")->Get<std::string>("parent_frame",
             this->dataPtr->gravityDirXParentFrame).first;
     }
 
@@ -205,7 +206,7 @@ Errors Imu::Load(ElementPtr _sdf)
       this->dataPtr->customRpy = elem->Get<ignition::math::Vector3d>(
           "custom_rpy", this->dataPtr->customRpy).first;
       this->dataPtr->customRpyParentFrame =
-        elem->GetElement("custom_rpy")->Get<std::string>("parent_frame",
+        elem->FindElement("custom_rpy")->Get<std::string>("parent_frame",
             this->dataPtr->customRpyParentFrame).first;
     }
   }
@@ -0,0 +1,381 @@
+/*
+ * Copyright 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <cstdint>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <string>
+
+#include "sdf/Console.hh"
+#include "sdf/Filesystem.hh"
+#include "sdf/IncludeCache.hh"
+#include "sdf/ParserConfig.hh"
+#include "sdf/SDFImpl.hh"
+#include "sdf/parser.hh"
+#include "BinaryFormat.hh"
+#include "MappedFile.hh"
+#include "Utils.hh"
+
+using namespace sdf;
+
+/// \brief A cached element tree and the file time it was read at.
+struct IncludeCacheEntry
+{
+  /// \brief Modification time of the file when the entry was stored.
+  std::time_t writeTime;
+
+  /// \brief Element tree read from the file.
+  ElementPtr elem;
+};
+
+/// \brief The model file chosen for a model directory.
+struct ModelFileCacheEntry
+{
+  /// \brief Path of the config file the model file was chosen from.
+  std::string configPath;
+
+  /// \brief Modification time of the config file when the entry was
+  /// stored.
+  std::time_t writeTime;
+
+  /// \brief Path of the model file.
+  std::string modelFilePath;
+};
+
+/// \brief Private data for IncludeCache.
+class sdf::IncludeCachePrivate
+{
+  /// \brief Cache entries, keyed by resolved file path.
+  public: std::map<std::string, IncludeCacheEntry> entries;
+
+  /// \brief Model files, keyed by model directory path.
+  public: std::map<std::string, ModelFileCacheEntry> modelFiles;
+
+  /// \brief Directory of the entries shared with other processes, empty
+  /// if disabled.
+  public: std::string sharedDirectory;
+
+  /// \brief Mutex that protects entries, modelFiles and sharedDirectory.
+  public: mutable std::mutex mutex;
+};
+
+/////////////////////////////////////////////////
+/// \brief Get the path of the shared entry of a file.
+/// \param[in] _directory The shared directory.
+/// \param[in] _filename Resolved path of the file.
+/// \return Path of the entry.
+static std::string sharedEntryPath(const std::string &_directory,
+    const std::string &_filename)
+{
+  // 64-bit FNV-1a hash of the path, which is the same in every process,
+  // unlike std::hash.
+  std::uint64_t hash = 14695981039346656037ull;
+  for (const char c : _filename)
+  {
+    hash ^= static_cast<unsigned char>(c);
+    hash *= 1099511628211ull;
+  }
+
+  std::ostringstream name;
+  name << "sdformat-" << SDF_VERSION_FULL << "-" << std::hex
+       << std::setw(16) << std::setfill('0') << hash << ".sdfb";
+  return filesystem::append(_directory, name.str());
+}
+
+/////////////////////////////////////////////////
+/// \brief Get the header of a shared entry, which identifies the file and
+/// its modification time, since paths may collide in the hash.
+/// \param[in] _filename Resolved path of the file.
+/// \param[in] _writeTime Modification time of the file.
+/// \return The header, which is followed by the binary document.
+static std::string sharedEntryHeader(const std::string &_filename,
+    const std::time_t _writeTime)
+{
+  return _filename + '\n' + std::to_string(_writeTime) + '\n';
+}
+
+/////////////////////////////////////////////////
+/// \brief Read the element tree of a shared entry.
+/// \param[in] _entryPath Path of the entry.
+/// \param[in] _header Header that the entry must start with.
+/// \return The root element, or nullptr if there is no valid entry.
+static ElementPtr readSharedEntry(const std::string &_entryPath,
+    const std::string &_header)
+{
+  MappedFile file(_entryPath);
+  if (!file.Valid() || file.Size() < _header.size() ||
+      _header.compare(0, _header.size(), file.Data(), _header.size()) != 0)
+  {
+    return nullptr;
+  }
+
+  // sdf::init is expensive, so the documents are cloned from a template.
+  static const SDFPtr sdfTemplate = []()
+  {
+    SDFPtr result(new SDF);
+    init(result);
+    return result;
+  }();
+
+  // An entry may be corrupt, so it is read with the nesting limit of the
+  // load in progress, or with the default one.
+  static const ParserConfig defaultConfig;
+  const ParserConfig *config = currentParserConfig();
+
+  SDFPtr sdfParsed(new SDF);
+  sdfParsed->Root(sdfTemplate->Root()->Clone());
+  Errors errors;
+  if (!readBinary(file.Data() + _header.size(),
+        file.Size() - _header.size(), sdfParsed,
+        config ? *config : defaultConfig, errors) || !errors.empty())
+  {
+    sdfdbg << "Ignoring invalid shared include cache entry[" << _entryPath
+           << "].\n";
+    return nullptr;
+  }
+  return sdfParsed->Root();
+}
+
+/////////////////////////////////////////////////
+/// \brief Write the element tree of a shared entry.
+/// \param[in] _entryPath Path of the entry.
+/// \param[in] _header Header of the entry.
+/// \param[in] _elem The root element.
+static void writeSharedEntry(const std::string &_entryPath,
+    const std::string &_header, const ElementPtr &_elem)
+{
+  std::string data;
+  writeBinary(_elem, data);
+
+  // Concurrent readers never see a partial entry.
+  if (!replaceFile(_entryPath, [&](const std::string &_tmpPath)
+      {
+        std::ofstream out(_tmpPath, std::ios::binary);
+        out.write(_header.data(),
+            static_cast<std::streamsize>(_header.size()));
+        out.write(data.data(), static_cast<std::streamsize>(data.size()));
+        out.close();
+        return static_cast<bool>(out);
+      }))
+  {
+    sdfdbg << "Unable to write shared include cache entry[" << _entryPath
+           << "].\n";
+  }
+}
+
+/////////////////////////////////////////////////
+IncludeCache::IncludeCache()
+  : dataPtr(new IncludeCachePrivate)
+{
+}
+
+/////////////////////////////////////////////////
+IncludeCache::~IncludeCache()
+{
+  delete this->dataPtr;
+  this->dataPtr = nullptr;
+}
+
+/////////////////////////////////////////////////
+ElementPtr IncludeCache::Find(const std::string &_filename) const
+{
+  const std::time_t writeTime = filesystem::last_write_time(_filename);
+
+  std::string sharedDirectory;
+  {
+    std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+    auto iter = this->dataPtr->entries.find(_filename);
+    if (iter != this->dataPtr->entries.end())
+    {
+      if (writeTime != static_cast<std::time_t>(-1) &&
+          writeTime == iter->second.writeTime)
+      {
+        // Stored trees are never modified, so copies can share them.
+        return iter->second.elem->CopyOnWriteClone();
+      }
+      this->dataPtr->entries.erase(iter);
+    }
+    sharedDirectory = this->dataPtr->sharedDirectory;
+  }
+
+  if (sharedDirectory.empty() || writeTime == static_cast<std::time_t>(-1))
+    return nullptr;
+
+  ElementPtr elem = readSharedEntry(
+      sharedEntryPath(sharedDirectory, _filename),
+      sharedEntryHeader(_filename, writeTime));
+  if (!elem)
+    return nullptr;
+
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  this->dataPtr->entries[_filename] = {writeTime, elem};
+  return elem->CopyOnWriteClone();
+}
+
+/////////////////////////////////////////////////
+void IncludeCache::Insert(const std::string &_filename, const ElementPtr _elem)
+{
+  if (!_elem)
+    return;
+
+  const std::time_t writeTime = filesystem::last_write_time(_filename);
+  if (writeTime == static_cast<std::time_t>(-1))
+    return;
+
+  ElementPtr clone = _elem->Clone();
+
+  std::string sharedDirectory;
+  {
+    std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+    this->dataPtr->entries[_filename] = {writeTime, clone};
+    sharedDirectory = this->dataPtr->sharedDirectory;
+  }
+
+  if (!sharedDirectory.empty())
+  {
+    writeSharedEntry(sharedEntryPath(sharedDirectory, _filename),
+        sharedEntryHeader(_filename, writeTime), clone);
+  }
+}
+
+/////////////////////////////////////////////////
+ElementPtr IncludeCache::Share(const std::string &_filename,
+    const ElementPtr _elem)
+{
+  if (!_elem)
+    return _elem;
+
+  const std::time_t writeTime = filesystem::last_write_time(_filename);
+  if (writeTime == static_cast<std::time_t>(-1))
+    return _elem;
+
+  std::string sharedDirectory;
+  {
+    std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+    this->dataPtr->entries[_filename] = {writeTime, _elem};
+    sharedDirectory = this->dataPtr->sharedDirectory;
+  }
+
+  if (!sharedDirectory.empty())
+  {
+    writeSharedEntry(sharedEntryPath(sharedDirectory, _filename),
+        sharedEntryHeader(_filename, writeTime), _elem);
+  }
+  return _elem->CopyOnWriteClone();
+}
+
+/////////////////////////////////////////////////
+std::string IncludeCache::FindModelFile(
+    const std::string &_modelDirPath) const
+{
+  std::string configPath;
+  {
+    std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+    auto iter = this->dataPtr->modelFiles.find(_modelDirPath);
+    if (iter == this->dataPtr->modelFiles.end())
+      return std::string();
+    configPath = iter->second.configPath;
+  }
+
+  const std::time_t writeTime = filesystem::last_write_time(configPath);
+
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  auto iter = this->dataPtr->modelFiles.find(_modelDirPath);
+  if (iter == this->dataPtr->modelFiles.end())
+    return std::string();
+
+  if (writeTime == static_cast<std::time_t>(-1) ||
+      writeTime != iter->second.writeTime ||
+      configPath != iter->second.configPath)
+  {
+    this->dataPtr->modelFiles.erase(iter);
+    return std::string();
+  }
+
+  return iter->second.modelFilePath;
+}
+
+/////////////////////////////////////////////////
+void IncludeCache::InsertModelFile(const std::string &_modelDirPath,
+                                   const std::string &_modelFilePath)
+{
+  if (_modelFilePath.empty())
+    return;
+
+  // Same precedence as getModelFilePath.
+  std::string configPath =
+    filesystem::append(_modelDirPath, "model.config");
+  filesystem::file_status configStatus = filesystem::status(configPath);
+  if (!configStatus.exists())
+  {
+    configPath = filesystem::append(_modelDirPath, "manifest.xml");
+    configStatus = filesystem::status(configPath);
+  }
+
+  const std::time_t writeTime = configStatus.write_time;
+  if (writeTime == static_cast<std::time_t>(-1))
+    return;
+
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  this->dataPtr->modelFiles[_modelDirPath] =
+    {configPath, writeTime, _modelFilePath};
+}
+
+/////////////////////////////////////////////////
+bool IncludeCache::SetSharedDirectory(const std::string &_path)
+{
+  bool result = true;
+  std::string path = _path;
+  if (!path.empty() && !filesystem::is_directory(path) &&
+      !filesystem::create_directory(path))
+  {
+    sdferr << "Unable to create shared include cache directory[" << path
+           << "], trees are not shared.\n";
+    path.clear();
+    result = false;
+  }
+
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  this->dataPtr->sharedDirectory = path;
+  return result;
+}
+
+/////////////////////////////////////////////////
+std::string IncludeCache::SharedDirectory() const
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  return this->dataPtr->sharedDirectory;
+}
+
+/////////////////////////////////////////////////
+std::size_t IncludeCache::Size() const
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  return this->dataPtr->entries.size();
+}
+
+/////////////////////////////////////////////////
+void IncludeCache::Clear()
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  this->dataPtr->entries.clear();
+  this->dataPtr->modelFiles.clear();
+}
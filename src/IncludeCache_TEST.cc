@@ -0,0 +1,183 @@
+/*
+ * Copyright 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "sdf/Element.hh"
+#include "sdf/Filesystem.hh"
+#include "sdf/IncludeCache.hh"
+#include "sdf/SDFImpl.hh"
+#include "sdf/parser.hh"
+#include "test_config.h"
+
+/////////////////////////////////////////////////
+TEST(IncludeCache, FindInsert)
+{
+  const std::string filename = sdf::filesystem::append(PROJECT_SOURCE_PATH,
+      "test", "integration", "model", "box", "model.sdf");
+
+  sdf::IncludeCache cache;
+  EXPECT_EQ(0u, cache.Size());
+  EXPECT_EQ(nullptr, cache.Find(filename));
+
+  sdf::ElementPtr elem(new sdf::Element);
+  elem->SetName("sdf");
+  sdf::ElementPtr model(new sdf::Element);
+  model->SetName("model");
+  elem->InsertElement(model);
+
+  cache.Insert(filename, elem);
+  EXPECT_EQ(1u, cache.Size());
+
+  // Changes to the inserted tree do not affect the cache.
+  elem->SetName("changed");
+
+  sdf::ElementPtr found = cache.Find(filename);
+  ASSERT_NE(nullptr, found);
+  EXPECT_NE(elem, found);
+  EXPECT_EQ("sdf", found->GetName());
+  ASSERT_NE(nullptr, found->GetFirstElement());
+  EXPECT_EQ("model", found->GetFirstElement()->GetName());
+
+  // Each lookup returns a new copy.
+  found->SetName("changed");
+  sdf::ElementPtr found2 = cache.Find(filename);
+  ASSERT_NE(nullptr, found2);
+  EXPECT_NE(found, found2);
+  EXPECT_EQ("sdf", found2->GetName());
+
+  // Copies share the stored tree until they are modified.
+  found->GetFirstElement()->SetName("changed_model");
+  found->AddElementDescription(std::make_shared<sdf::Element>());
+  found->InsertElement(std::make_shared<sdf::Element>());
+  ASSERT_NE(nullptr, found2->GetFirstElement());
+  EXPECT_EQ("model", found2->GetFirstElement()->GetName());
+  EXPECT_EQ(nullptr, found2->GetFirstElement()->GetNextElement());
+  EXPECT_EQ(0u, found2->GetElementDescriptionCount());
+
+  // Files that don't exist are not cached.
+  cache.Insert("/this/file/does/not/exist.sdf", elem);
+  EXPECT_EQ(1u, cache.Size());
+  EXPECT_EQ(nullptr, cache.Find("/this/file/does/not/exist.sdf"));
+
+  // Null elements are not cached.
+  cache.Insert(filename, nullptr);
+  EXPECT_EQ(1u, cache.Size());
+
+  cache.Clear();
+  EXPECT_EQ(0u, cache.Size());
+  EXPECT_EQ(nullptr, cache.Find(filename));
+}
+
+/////////////////////////////////////////////////
+TEST(IncludeCache, Share)
+{
+  const std::string filename = sdf::filesystem::append(PROJECT_SOURCE_PATH,
+      "test", "integration", "model", "box", "model.sdf");
+
+  sdf::IncludeCache cache;
+  sdf::ElementPtr elem(new sdf::Element);
+  elem->SetName("sdf");
+  sdf::ElementPtr model(new sdf::Element);
+  model->SetName("model");
+  elem->InsertElement(model);
+
+  // The shared tree is stored as it is, and the caller gets a copy.
+  sdf::ElementPtr copy = cache.Share(filename, elem);
+  EXPECT_EQ(1u, cache.Size());
+  ASSERT_NE(nullptr, copy);
+  EXPECT_NE(elem, copy);
+  copy->GetFirstElement()->SetName("override");
+  EXPECT_EQ("model", model->GetName());
+
+  sdf::ElementPtr found = cache.Find(filename);
+  ASSERT_NE(nullptr, found);
+  ASSERT_NE(nullptr, found->GetFirstElement());
+  EXPECT_EQ("model", found->GetFirstElement()->GetName());
+
+  // Trees that are not stored are returned as they are.
+  EXPECT_EQ(elem, cache.Share("/this/file/does/not/exist.sdf", elem));
+  EXPECT_EQ(nullptr, cache.Share(filename, nullptr));
+  EXPECT_EQ(1u, cache.Size());
+}
+
+/////////////////////////////////////////////////
+TEST(IncludeCache, ModelFile)
+{
+  const std::string modelDir = sdf::filesystem::append(PROJECT_SOURCE_PATH,
+      "test", "integration", "model", "box");
+  const std::string filename =
+    sdf::filesystem::append(modelDir, "model.sdf");
+
+  sdf::IncludeCache cache;
+  EXPECT_TRUE(cache.FindModelFile(modelDir).empty());
+
+  cache.InsertModelFile(modelDir, filename);
+  EXPECT_EQ(filename, cache.FindModelFile(modelDir));
+
+  // Model files are not counted as stored files.
+  EXPECT_EQ(0u, cache.Size());
+
+  // Directories without a config file are not cached.
+  cache.InsertModelFile("/this/dir/does/not/exist", filename);
+  EXPECT_TRUE(cache.FindModelFile("/this/dir/does/not/exist").empty());
+
+  cache.Clear();
+  EXPECT_TRUE(cache.FindModelFile(modelDir).empty());
+}
+
+/////////////////////////////////////////////////
+TEST(IncludeCache, SharedDirectory)
+{
+  const std::string filename = sdf::filesystem::append(PROJECT_SOURCE_PATH,
+      "test", "integration", "model", "box", "model.sdf");
+  const std::string sharedDir = sdf::filesystem::append(PROJECT_BINARY_DIR,
+      "test", "include_cache_shared");
+
+  sdf::SDFPtr sdfParsed(new sdf::SDF);
+  sdf::init(sdfParsed);
+  ASSERT_TRUE(sdf::readFile(filename, sdfParsed));
+
+  // A tree inserted in one cache is found by another cache, as if it was
+  // in another process.
+  sdf::IncludeCache writer;
+  EXPECT_TRUE(writer.SharedDirectory().empty());
+  ASSERT_TRUE(writer.SetSharedDirectory(sharedDir));
+  EXPECT_EQ(sharedDir, writer.SharedDirectory());
+  writer.Insert(filename, sdfParsed->Root());
+
+  sdf::IncludeCache reader;
+  EXPECT_EQ(nullptr, reader.Find(filename));
+  ASSERT_TRUE(reader.SetSharedDirectory(sharedDir));
+  sdf::ElementPtr found = reader.Find(filename);
+  ASSERT_NE(nullptr, found);
+  EXPECT_EQ(sdfParsed->Root()->ToString(""), found->ToString(""));
+  EXPECT_EQ(1u, reader.Size());
+
+  // Disabling sharing leaves the trees that were already read.
+  EXPECT_TRUE(reader.SetSharedDirectory(""));
+  EXPECT_TRUE(reader.SharedDirectory().empty());
+  EXPECT_NE(nullptr, reader.Find(filename));
+  reader.Clear();
+  EXPECT_EQ(nullptr, reader.Find(filename));
+
+  // Directories that cannot be created disable sharing.
+  EXPECT_FALSE(reader.SetSharedDirectory("/this/dir/does/not/exist"));
+  EXPECT_TRUE(reader.SharedDirectory().empty());
+}
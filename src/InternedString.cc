@@ -0,0 +1,143 @@
+/*
+ * Copyright 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <unordered_set>
+
+#include "sdf/InternedString.hh"
+
+using namespace sdf;
+
+namespace
+{
+  /// \brief The global symbol table. Nodes of an unordered_set are never
+  /// moved by a rehash, so pointers to its strings stay valid.
+  class SymbolTable
+  {
+    /// \brief Get the single instance of the table. It is never destroyed,
+    /// so that interned strings can be used by static objects.
+    /// \return The table.
+    public: static SymbolTable &Instance()
+    {
+      static SymbolTable *table = new SymbolTable;
+      return *table;
+    }
+
+    /// \brief Intern a string.
+    /// \param[in] _str The string.
+    /// \return The interned copy of the string.
+    public: const std::string *Intern(const std::string &_str)
+    {
+      {
+        std::shared_lock<std::shared_mutex> lock(this->mutex);
+        auto it = this->strings.find(_str);
+        if (it != this->strings.end())
+          return &*it;
+      }
+
+      std::unique_lock<std::shared_mutex> lock(this->mutex);
+      auto result = this->strings.insert(_str);
+      if (result.second)
+        this->bytes += _str.size();
+      return &*result.first;
+    }
+
+    /// \brief Get the number of strings in the table.
+    /// \return Number of strings.
+    public: std::size_t Size()
+    {
+      std::shared_lock<std::shared_mutex> lock(this->mutex);
+      return this->strings.size();
+    }
+
+    /// \brief Get the total size of the strings in the table.
+    /// \return Number of bytes.
+    public: std::size_t Bytes()
+    {
+      std::shared_lock<std::shared_mutex> lock(this->mutex);
+      return this->bytes;
+    }
+
+    /// \brief Mutex that protects the table.
+    private: std::shared_mutex mutex;
+
+    /// \brief The interned strings.
+    private: std::unordered_set<std::string> strings;
+
+    /// \brief Total size of the interned strings.
+    private: std::size_t bytes = 0;
+  };
+
+  /// \brief Get the interned empty string. It is looked up once, since
+  /// most optional descriptions and requirements are empty.
+  /// \return The interned empty string.
+  const std::string *emptyString()
+  {
+    static const std::string *empty =
+        SymbolTable::Instance().Intern(std::string());
+    return empty;
+  }
+}
+
+/////////////////////////////////////////////////
+InternedString::InternedString()
+  : str(emptyString())
+{
+}
+
+/////////////////////////////////////////////////
+InternedString::InternedString(const std::string &_str)
+  : str(_str.empty() ? emptyString() : SymbolTable::Instance().Intern(_str))
+{
+}
+
+/////////////////////////////////////////////////
+InternedString::InternedString(const char *_str)
+  : InternedString(std::string(_str ? _str : ""))
+{
+}
+
+/////////////////////////////////////////////////
+const std::string &InternedString::Str() const
+{
+  return *this->str;
+}
+
+/////////////////////////////////////////////////
+InternedString::operator const std::string &() const
+{
+  return *this->str;
+}
+
+/////////////////////////////////////////////////
+bool InternedString::Empty() const
+{
+  return this->str->empty();
+}
+
+/////////////////////////////////////////////////
+std::size_t InternedString::TableSize()
+{
+  return SymbolTable::Instance().Size();
+}
+
+/////////////////////////////////////////////////
+std::size_t InternedString::TableBytes()
+{
+  return SymbolTable::Instance().Bytes();
+}
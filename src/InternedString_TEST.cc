@@ -0,0 +1,134 @@
+/*
+ * Copyright 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "sdf/Element.hh"
+#include "sdf/InternedString.hh"
+#include "sdf/Param.hh"
+
+/////////////////////////////////////////////////
+TEST(InternedString, Construction)
+{
+  sdf::InternedString empty;
+  EXPECT_TRUE(empty.Empty());
+  EXPECT_EQ("", empty.Str());
+  EXPECT_EQ(empty, sdf::InternedString(""));
+  EXPECT_EQ(empty, sdf::InternedString(std::string()));
+  EXPECT_EQ(empty, sdf::InternedString(nullptr));
+
+  sdf::InternedString link("link");
+  EXPECT_FALSE(link.Empty());
+  EXPECT_EQ("link", link.Str());
+  const std::string &str = link;
+  EXPECT_EQ(&link.Str(), &str);
+
+  std::ostringstream stream;
+  stream << link;
+  EXPECT_EQ("link", stream.str());
+}
+
+/////////////////////////////////////////////////
+TEST(InternedString, Equality)
+{
+  sdf::InternedString a("interned_string_equality");
+  sdf::InternedString b(std::string("interned_string_equality"));
+  sdf::InternedString c("interned_string_other");
+
+  // Equal strings share a single copy.
+  EXPECT_EQ(&a.Str(), &b.Str());
+  EXPECT_TRUE(a == b);
+  EXPECT_FALSE(a != b);
+  EXPECT_NE(&a.Str(), &c.Str());
+  EXPECT_TRUE(a != c);
+  EXPECT_FALSE(a == c);
+
+  EXPECT_TRUE(a == std::string("interned_string_equality"));
+  EXPECT_TRUE(std::string("interned_string_equality") == a);
+  EXPECT_TRUE(a == "interned_string_equality");
+  EXPECT_TRUE(a != std::string("other"));
+  EXPECT_TRUE(std::string("other") != a);
+  EXPECT_TRUE(a != "other");
+}
+
+/////////////////////////////////////////////////
+TEST(InternedString, Table)
+{
+  sdf::InternedString first("interned_string_table");
+  const std::size_t size = sdf::InternedString::TableSize();
+  const std::size_t bytes = sdf::InternedString::TableBytes();
+
+  // Interning a string again does not grow the table.
+  sdf::InternedString second("interned_string_table");
+  EXPECT_EQ(size, sdf::InternedString::TableSize());
+  EXPECT_EQ(bytes, sdf::InternedString::TableBytes());
+
+  sdf::InternedString third("interned_string_table_2");
+  EXPECT_EQ(size + 1, sdf::InternedString::TableSize());
+  EXPECT_EQ(bytes + third.Str().size(), sdf::InternedString::TableBytes());
+}
+
+/////////////////////////////////////////////////
+TEST(InternedString, Threads)
+{
+  const int threadCount = 8;
+  const int stringCount = 200;
+  std::vector<std::vector<const std::string *>> results(threadCount);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < threadCount; ++t)
+  {
+    threads.emplace_back([&results, t]()
+    {
+      for (int i = 0; i < stringCount; ++i)
+      {
+        sdf::InternedString str("interned_thread_" + std::to_string(i));
+        results[t].push_back(&str.Str());
+      }
+    });
+  }
+  for (auto &thread : threads)
+    thread.join();
+
+  // Every thread gets the same copy of each string.
+  for (int t = 1; t < threadCount; ++t)
+    EXPECT_EQ(results[0], results[t]);
+}
+
+/////////////////////////////////////////////////
+TEST(InternedString, ElementAndParam)
+{
+  sdf::ElementPtr first(new sdf::Element);
+  first->SetName("interned_element");
+  first->AddAttribute("interned_key", "string", "", false, "description");
+  sdf::ElementPtr second = first->Clone();
+  second->SetName("interned_element");
+
+  // Names of separate elements share a single copy.
+  EXPECT_EQ(&first->GetName(), &second->GetName());
+  EXPECT_EQ(&first->GetAttribute("interned_key")->GetKey(),
+            &second->GetAttribute("interned_key")->GetKey());
+
+  sdf::Param param("interned_key", "string", "", false, "description");
+  EXPECT_EQ(&first->GetAttribute("interned_key")->GetKey(), &param.GetKey());
+  EXPECT_EQ(&first->GetAttribute("interned_key")->GetTypeName(),
+            &param.GetTypeName());
+}
@@ -24,11 +24,26 @@
 #include "sdf/Joint.hh"
 #include "sdf/JointAxis.hh"
 #include "sdf/Types.hh"
+#include "ElementArena.hh"
+#include "EnumNames.hh"
+#include "FrameSemantics.hh"
 #include "Utils.hh"
 
 using namespace sdf;
 
-class sdf::JointPrivate
+/// \brief Joint type strings, in lowercase.
+constexpr auto kJointTypes = makeEnumNames<JointType>({
+    {"ball", JointType::BALL},
+    {"continuous", JointType::CONTINUOUS},
+    {"fixed", JointType::FIXED},
+    {"gearbox", JointType::GEARBOX},
+    {"prismatic", JointType::PRISMATIC},
+    {"revolute", JointType::REVOLUTE},
+    {"revolute2", JointType::REVOLUTE2},
+    {"screw", JointType::SCREW},
+    {"universal", JointType::UNIVERSAL}});
+
+class sdf::JointPrivate : public ArenaAllocated
 {
   public: JointPrivate()
   {
@@ -75,8 +90,22 @@ class sdf::JointPrivate
 
   /// \brief Weak pointer to model's Pose Relative-To Graph.
   public: std::weak_ptr<const sdf::PoseRelativeToGraph> poseRelativeToGraph;
+
+  /// \brief Vertex ids of the frames of SemanticPose in the graph.
+  public: FrameIds frameIds;
 };
 
+/////////////////////////////////////////////////
+/// \brief Find the vertex ids of the frames of the SemanticPose of a
+/// joint again, after its graph or the names of the frames changed.
+/// \param[in,out] _data Private data of the joint.
+static void updateFrameIds(JointPrivate &_data)
+{
+  _data.frameIds = findFrameIds(_data.poseRelativeToGraph,
+      _data.poseRelativeTo.empty() ? _data.childLinkName : _data.poseRelativeTo,
+      _data.childLinkName);
+}
+
 /////////////////////////////////////////////////
 JointPrivate::JointPrivate(const JointPrivate &_jointPrivate)
     : name(_jointPrivate.name),
@@ -87,7 +116,8 @@ JointPrivate::JointPrivate(const JointPrivate &_jointPrivate)
       poseRelativeTo(_jointPrivate.poseRelativeTo),
       threadPitch(_jointPrivate.threadPitch),
       sdf(_jointPrivate.sdf),
-      poseRelativeToGraph(_jointPrivate.poseRelativeToGraph)
+      poseRelativeToGraph(_jointPrivate.poseRelativeToGraph),
+      frameIds(_jointPrivate.frameIds)
 {
   for (std::size_t i = 0; i < _jointPrivate.axis.size(); ++i)
   {
@@ -141,7 +171,7 @@ Errors Joint::Load(ElementPtr _sdf)
 {
   Errors errors;
 
-  this->dataPtr->sdf = _sdf;
+  this->dataPtr->sdf = retainedElement(_sdf);
 
   // Check that the provided SDF element is a <joint>
   // This is an error that cannot be recovered, so return an error.
@@ -215,14 +245,16 @@ Errors Joint::Load(ElementPtr _sdf)
   if (_sdf->HasElement("axis"))
   {
     this->dataPtr->axis[0].reset(new JointAxis());
-    Errors axisErrors = this->dataPtr->axis[0]->Load(_sdf->GetElement("axis"));
+    Errors axisErrors =
+        this->dataPtr->axis[0]->Load(_sdf->FindElement("axis"));
     errors.insert(errors.end(), axisErrors.begin(), axisErrors.end());
   }
 
   if (_sdf->HasElement("axis2"))
   {
     this->dataPtr->axis[1].reset(new JointAxis());
-    Errors axisErrors = this->dataPtr->axis[1]->Load(_sdf->GetElement("axis2"));
+    Errors axisErrors =
+        this->dataPtr->axis[1]->Load(_sdf->FindElement("axis2"));
     errors.insert(errors.end(), axisErrors.begin(), axisErrors.end());
   }
 
@@ -233,25 +265,7 @@ Errors Joint::Load(ElementPtr _sdf)
   if (typePair.second)
   {
     typePair.first = lowercase(typePair.first);
-    if (typePair.first == "ball")
-      this->dataPtr->type = JointType::BALL;
-    else if (typePair.first == "continuous")
-      this->dataPtr->type = JointType::CONTINUOUS;
-    else if (typePair.first == "fixed")
-      this->dataPtr->type = JointType::FIXED;
-    else if (typePair.first == "gearbox")
-      this->dataPtr->type = JointType::GEARBOX;
-    else if (typePair.first == "prismatic")
-      this->dataPtr->type = JointType::PRISMATIC;
-    else if (typePair.first == "revolute")
-      this->dataPtr->type = JointType::REVOLUTE;
-    else if (typePair.first == "revolute2")
-      this->dataPtr->type = JointType::REVOLUTE2;
-    else if (typePair.first == "screw")
-      this->dataPtr->type = JointType::SCREW;
-    else if (typePair.first == "universal")
-      this->dataPtr->type = JointType::UNIVERSAL;
-    else
+    if (!kJointTypes.Find(typePair.first, this->dataPtr->type))
     {
       this->dataPtr->type = JointType::INVALID;
       errors.push_back({ErrorCode::ATTRIBUTE_INVALID,
@@ -279,6 +293,7 @@ const std::string &Joint::Name() const
 void Joint::SetName(const std::string &_name)
 {
   this->dataPtr->name = _name;
+  NameIndex::NameChanged();
 }
 
 /////////////////////////////////////////////////
@@ -315,6 +330,7 @@ const std::string &Joint::ChildLinkName() const
 void Joint::SetChildLinkName(const std::string &_name)
 {
   this->dataPtr->childLinkName = _name;
+  updateFrameIds(*this->dataPtr);
 }
 
 /////////////////////////////////////////////////
@@ -376,6 +392,7 @@ void Joint::SetPoseFrame(const std::string &_frame)
 void Joint::SetPoseRelativeTo(const std::string &_frame)
 {
   this->dataPtr->poseRelativeTo = _frame;
+  updateFrameIds(*this->dataPtr);
 }
 
 /////////////////////////////////////////////////
@@ -383,6 +400,7 @@ void Joint::SetPoseRelativeToGraph(
     std::weak_ptr<const PoseRelativeToGraph> _graph)
 {
   this->dataPtr->poseRelativeToGraph = _graph;
+  updateFrameIds(*this->dataPtr);
 
   for (auto& axis : this->dataPtr->axis)
   {
@@ -401,7 +419,8 @@ sdf::SemanticPose Joint::SemanticPose() const
       this->dataPtr->pose,
       this->dataPtr->poseRelativeTo,
       this->ChildLinkName(),
-      this->dataPtr->poseRelativeToGraph);
+      this->dataPtr->poseRelativeToGraph,
+      this->dataPtr->frameIds);
 }
 
 /////////////////////////////////////////////////
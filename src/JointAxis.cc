@@ -18,11 +18,14 @@
 #include <ignition/math/Vector3.hh>
 #include "sdf/Error.hh"
 #include "sdf/JointAxis.hh"
+#include "ElementArena.hh"
 #include "FrameSemantics.hh"
+#include "SpecStructs.hh"
+#include "Utils.hh"
 
 using namespace sdf;
 
-class sdf::JointAxisPrivate
+class sdf::JointAxisPrivate : public ArenaAllocated
 {
   /// \brief Default joint position for this joint axis.
   public: double initialPosition = 0.0;
@@ -82,8 +85,23 @@ class sdf::JointAxisPrivate
 
   /// \brief Weak pointer to model's Pose Relative-To Graph.
   public: std::weak_ptr<const sdf::PoseRelativeToGraph> poseRelativeToGraph;
+
+  /// \brief Vertex ids of the expressed-in and xml parent frames in the
+  /// graph.
+  public: FrameIds frameIds;
 };
 
+/////////////////////////////////////////////////
+/// \brief Find the vertex ids of the frames of ResolveXyz again, after the
+/// graph or the names of the frames of a joint axis changed.
+/// \param[in,out] _data Private data of the joint axis.
+static void updateFrameIds(JointAxisPrivate &_data)
+{
+  _data.frameIds = findFrameIds(_data.poseRelativeToGraph,
+      _data.xyzExpressedIn.empty() ? _data.xmlParentName : _data.xyzExpressedIn,
+      _data.xmlParentName);
+}
+
 /////////////////////////////////////////////////
 JointAxis::JointAxis()
   : dataPtr(new JointAxisPrivate)
@@ -127,7 +145,7 @@ Errors JointAxis::Load(ElementPtr _sdf)
 {
   Errors errors;
 
-  this->dataPtr->sdf = _sdf;
+  this->dataPtr->sdf = retainedElement(_sdf);
 
   // Read the initial position. This is optional, with a default value of 0.
   this->dataPtr->initialPosition = _sdf->Get<double>(
@@ -138,7 +156,7 @@ Errors JointAxis::Load(ElementPtr _sdf)
   {
     this->dataPtr->xyz = _sdf->Get<ignition::math::Vector3d>("xyz",
         ignition::math::Vector3d::UnitZ).first;
-    auto e = _sdf->GetElement("xyz");
+    auto e = _sdf->FindElement("xyz");
     if (e->HasAttribute("expressed_in"))
     {
       this->dataPtr->xyzExpressedIn = e->Get<std::string>("expressed_in");
@@ -157,30 +175,27 @@ Errors JointAxis::Load(ElementPtr _sdf)
   // Load dynamic values, if present
   if (_sdf->HasElement("dynamics"))
   {
-    sdf::ElementPtr dynElement = _sdf->GetElement("dynamics");
-
-    this->dataPtr->damping = dynElement->Get<double>("damping", 0.0).first;
-    this->dataPtr->friction = dynElement->Get<double>("friction", 0.0).first;
-    this->dataPtr->springReference =
-      dynElement->Get<double>("spring_reference", 0.0).first;
-    this->dataPtr->springStiffness =
-      dynElement->Get<double>("spring_stiffness", 0.0).first;
+    spec::JointAxisDynamics dynamics;
+    dynamics.Load(_sdf->FindElement("dynamics"));
+
+    this->dataPtr->damping = dynamics.damping;
+    this->dataPtr->friction = dynamics.friction;
+    this->dataPtr->springReference = dynamics.spring_reference;
+    this->dataPtr->springStiffness = dynamics.spring_stiffness;
   }
 
   // Load limit values
   if (_sdf->HasElement("limit"))
   {
-    sdf::ElementPtr limitElement = _sdf->GetElement("limit");
-
-    this->dataPtr->lower = limitElement->Get<double>("lower", -1e16).first;
-    this->dataPtr->upper = limitElement->Get<double>("upper", 1e16).first;
-    this->dataPtr->effort = limitElement->Get<double>("effort", -1).first;
-    this->dataPtr->maxVelocity = limitElement->Get<double>(
-        "velocity", -1).first;
-    this->dataPtr->stiffness = limitElement->Get<double>(
-        "stiffness", 1e8).first;
-    this->dataPtr->dissipation = limitElement->Get<double>(
-        "dissipation", 1.0).first;
+    spec::JointAxisLimit limit;
+    limit.Load(_sdf->FindElement("limit"));
+
+    this->dataPtr->lower = limit.lower;
+    this->dataPtr->upper = limit.upper;
+    this->dataPtr->effort = limit.effort;
+    this->dataPtr->maxVelocity = limit.velocity;
+    this->dataPtr->stiffness = limit.stiffness;
+    this->dataPtr->dissipation = limit.dissipation;
   }
   else
   {
@@ -354,12 +369,14 @@ const std::string &JointAxis::XyzExpressedIn() const
 void JointAxis::SetXyzExpressedIn(const std::string &_frame)
 {
   this->dataPtr->xyzExpressedIn = _frame;
+  updateFrameIds(*this->dataPtr);
 }
 
 /////////////////////////////////////////////////
 void JointAxis::SetXmlParentName(const std::string &_xmlParentName)
 {
   this->dataPtr->xmlParentName = _xmlParentName;
+  updateFrameIds(*this->dataPtr);
 }
 
 /////////////////////////////////////////////////
@@ -367,6 +384,7 @@ void JointAxis::SetPoseRelativeToGraph(
     std::weak_ptr<const PoseRelativeToGraph> _graph)
 {
   this->dataPtr->poseRelativeToGraph = _graph;
+  updateFrameIds(*this->dataPtr);
 }
 
 /////////////////////////////////////////////////
@@ -389,6 +407,15 @@ Errors JointAxis::ResolveXyz(
     return errors;
   }
 
+  // The frames are found by vertex id when resolving to the xml parent.
+  ignition::math::Pose3d pose;
+  if ((_resolveTo.empty() || _resolveTo == this->dataPtr->xmlParentName) &&
+      resolveCachedPose(pose, *graph, this->dataPtr->frameIds))
+  {
+    _xyz = pose.Rot() * this->Xyz();
+    return errors;
+  }
+
   // JointAxis is not in the graph, but its XyzExpressedIn() name should be.
   // If XyzExpressedIn() is empty, use the name of the xml parent object.
   std::string axisExpressedIn = this->XyzExpressedIn();
@@ -403,7 +430,6 @@ Errors JointAxis::ResolveXyz(
     resolveTo = this->dataPtr->xmlParentName;
   }
 
-  ignition::math::Pose3d pose;
   errors = resolvePose(pose, *graph, axisExpressedIn, resolveTo);
 
   if (errors.empty())
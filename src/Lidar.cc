@@ -14,7 +14,15 @@
  * limitations under the License.
  *
  */
+#include <cmath>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <tuple>
+#include <vector>
+
 #include "sdf/Lidar.hh"
+#include "Utils.hh"
 
 using namespace sdf;
 using namespace ignition;
@@ -60,8 +68,104 @@ class sdf::LidarPrivate
 
   /// \brief The SDF element pointer used during load.
   public: sdf::ElementPtr sdf{nullptr};
+
+  /// \brief The ray directions of the scans, or null if they were not
+  /// requested since the scans were last modified. It is only accessed
+  /// atomically, since it is set by the const RayDirections function.
+  public: std::shared_ptr<const LidarRayDirections> rayDirections;
 };
 
+/// \brief Scan samples and angles of a table of ray directions: the
+/// horizontal samples, minimum and maximum angles, followed by the
+/// vertical ones.
+using RayDirectionsKey =
+    std::tuple<unsigned int, double, double, unsigned int, double, double>;
+
+/// \brief The tables of ray directions in use, shared by all lidars with
+/// the same scans.
+struct RayDirectionsCache
+{
+  /// \brief The tables, which expire when no lidar uses them anymore.
+  std::map<RayDirectionsKey, std::weak_ptr<const LidarRayDirections>> tables;
+
+  /// \brief Mutex protecting the tables.
+  std::mutex mutex;
+};
+
+//////////////////////////////////////////////////
+/// \brief Get the cache of ray direction tables of the process.
+/// \return The cache.
+static RayDirectionsCache &rayDirectionsCache()
+{
+  static RayDirectionsCache cache;
+  return cache;
+}
+
+//////////////////////////////////////////////////
+/// \brief Compute the cosines and sines of the angles of a scan.
+/// \param[in] _count Number of samples.
+/// \param[in] _min Minimum angle.
+/// \param[in] _max Maximum angle.
+/// \param[out] _cos Cosine of each angle.
+/// \param[out] _sin Sine of each angle.
+static void scanAngles(unsigned int _count, double _min, double _max,
+    std::vector<double> &_cos, std::vector<double> &_sin)
+{
+  const double step = _count > 1 ? (_max - _min) / (_count - 1) : 0.0;
+  _cos.resize(_count);
+  _sin.resize(_count);
+  for (unsigned int i = 0; i < _count; ++i)
+  {
+    const double angle = _min + i * step;
+    _cos[i] = std::cos(angle);
+    _sin[i] = std::sin(angle);
+  }
+}
+
+//////////////////////////////////////////////////
+/// \brief Compute a table of ray directions.
+/// \param[in] _key Scan samples and angles of the table.
+/// \return The table.
+static std::shared_ptr<const LidarRayDirections> computeRayDirections(
+    const RayDirectionsKey &_key)
+{
+  auto table = std::make_shared<LidarRayDirections>();
+  table->horizontalCount = std::get<0>(_key);
+  table->verticalCount = std::get<3>(_key);
+
+  std::vector<double> hCos, hSin, vCos, vSin;
+  scanAngles(table->horizontalCount, std::get<1>(_key), std::get<2>(_key),
+      hCos, hSin);
+  scanAngles(table->verticalCount, std::get<4>(_key), std::get<5>(_key),
+      vCos, vSin);
+
+  // Each row of rays is the product of the trigonometric functions of its
+  // vertical angle with those of the horizontal angles, which only takes
+  // multiplications that the compiler vectorizes.
+  const std::size_t count =
+      static_cast<std::size_t>(table->horizontalCount) * table->verticalCount;
+  table->x.resize(count);
+  table->y.resize(count);
+  table->z.resize(count);
+  for (unsigned int v = 0; v < table->verticalCount; ++v)
+  {
+    const std::size_t offset =
+        static_cast<std::size_t>(v) * table->horizontalCount;
+    double *x = table->x.data() + offset;
+    double *y = table->y.data() + offset;
+    double *z = table->z.data() + offset;
+    const double cosV = vCos[v];
+    const double sinV = vSin[v];
+    for (unsigned int h = 0; h < table->horizontalCount; ++h)
+    {
+      x[h] = cosV * hCos[h];
+      y[h] = cosV * hSin[h];
+      z[h] = sinV;
+    }
+  }
+  return table;
+}
+
 //////////////////////////////////////////////////
 Lidar::Lidar()
   : dataPtr(new LidarPrivate)
@@ -111,7 +215,8 @@ Errors Lidar::Load(ElementPtr _sdf)
 {
   Errors errors;
 
-  this->dataPtr->sdf = _sdf;
+  this->dataPtr->sdf = retainedElement(_sdf);
+  std::atomic_store(&this->dataPtr->rayDirections, {});
 
   // Check that sdf is a valid pointer
   if (!_sdf)
@@ -136,10 +241,10 @@ Errors Lidar::Load(ElementPtr _sdf)
   // Load lidar sensor properties
   if (_sdf->HasElement("scan"))
   {
-    sdf::ElementPtr elem = _sdf->GetElement("scan");
+    sdf::ElementPtr elem = _sdf->FindElement("scan");
     if (elem->HasElement("horizontal"))
     {
-      sdf::ElementPtr subElem = elem->GetElement("horizontal");
+      sdf::ElementPtr subElem = elem->FindElement("horizontal");
       if (subElem->HasElement("samples"))
         this->dataPtr->horizontalScanSamples = subElem->Get<unsigned int>(
           "samples");
@@ -162,7 +267,7 @@ Errors Lidar::Load(ElementPtr _sdf)
 
     if (elem->HasElement("vertical"))
     {
-      sdf::ElementPtr subElem = elem->GetElement("vertical");
+      sdf::ElementPtr subElem = elem->FindElement("vertical");
       if (subElem->HasElement("samples"))
         this->dataPtr->verticalScanSamples = subElem->Get<unsigned int>(
           "samples");
@@ -186,7 +291,7 @@ Errors Lidar::Load(ElementPtr _sdf)
 
   if (_sdf->HasElement("range"))
   {
-    sdf::ElementPtr elem = _sdf->GetElement("range");
+    sdf::ElementPtr elem = _sdf->FindElement("range");
     if (elem->HasElement("min"))
       this->dataPtr->minRange = elem->Get<double>("min");
     if (elem->HasElement("max"))
@@ -202,7 +307,7 @@ Errors Lidar::Load(ElementPtr _sdf)
   }
 
   if (_sdf->HasElement("noise"))
-    this->dataPtr->lidarNoise.Load(_sdf->GetElement("noise"));
+    this->dataPtr->lidarNoise.Load(_sdf->FindElement("noise"));
 
   return errors;
 }
@@ -223,6 +328,7 @@ unsigned int Lidar::HorizontalScanSamples() const
 void Lidar::SetHorizontalScanSamples(unsigned int _samples)
 {
   this->dataPtr->horizontalScanSamples = _samples;
+  std::atomic_store(&this->dataPtr->rayDirections, {});
 }
 
 //////////////////////////////////////////////////
@@ -247,6 +353,7 @@ math::Angle Lidar::HorizontalScanMinAngle() const
 void Lidar::SetHorizontalScanMinAngle(const math::Angle &_min)
 {
   this->dataPtr->horizontalScanMinAngle = _min;
+  std::atomic_store(&this->dataPtr->rayDirections, {});
 }
 
 //////////////////////////////////////////////////
@@ -259,6 +366,7 @@ math::Angle Lidar::HorizontalScanMaxAngle() const
 void Lidar::SetHorizontalScanMaxAngle(const math::Angle &_max)
 {
   this->dataPtr->horizontalScanMaxAngle = _max;
+  std::atomic_store(&this->dataPtr->rayDirections, {});
 }
 
 //////////////////////////////////////////////////
@@ -271,6 +379,7 @@ unsigned int Lidar::VerticalScanSamples() const
 void Lidar::SetVerticalScanSamples(unsigned int _samples)
 {
   this->dataPtr->verticalScanSamples = _samples;
+  std::atomic_store(&this->dataPtr->rayDirections, {});
 }
 
 //////////////////////////////////////////////////
@@ -295,6 +404,7 @@ math::Angle Lidar::VerticalScanMinAngle() const
 void Lidar::SetVerticalScanMinAngle(const math::Angle &_min)
 {
   this->dataPtr->verticalScanMinAngle = _min;
+  std::atomic_store(&this->dataPtr->rayDirections, {});
 }
 
 //////////////////////////////////////////////////
@@ -307,6 +417,51 @@ math::Angle Lidar::VerticalScanMaxAngle() const
 void Lidar::SetVerticalScanMaxAngle(const math::Angle &_max)
 {
   this->dataPtr->verticalScanMaxAngle = _max;
+  std::atomic_store(&this->dataPtr->rayDirections, {});
+}
+
+//////////////////////////////////////////////////
+std::shared_ptr<const LidarRayDirections> Lidar::RayDirections() const
+{
+  auto table = std::atomic_load(&this->dataPtr->rayDirections);
+  if (table)
+    return table;
+
+  const RayDirectionsKey key(
+      this->dataPtr->horizontalScanSamples,
+      this->dataPtr->horizontalScanMinAngle.Radian(),
+      this->dataPtr->horizontalScanMaxAngle.Radian(),
+      this->dataPtr->verticalScanSamples,
+      this->dataPtr->verticalScanMinAngle.Radian(),
+      this->dataPtr->verticalScanMaxAngle.Radian());
+
+  RayDirectionsCache &cache = rayDirectionsCache();
+  {
+    std::lock_guard<std::mutex> lock(cache.mutex);
+    auto it = cache.tables.find(key);
+    if (it != cache.tables.end())
+      table = it->second.lock();
+    if (!table)
+    {
+      // Computed with the lock held, so that lidars loaded concurrently
+      // with the same scans compute their table once.
+      table = computeRayDirections(key);
+
+      // Remove the tables that are no longer used before adding this one.
+      for (auto expired = cache.tables.begin();
+           expired != cache.tables.end();)
+      {
+        if (expired->second.expired())
+          expired = cache.tables.erase(expired);
+        else
+          ++expired;
+      }
+      cache.tables[key] = table;
+    }
+  }
+
+  std::atomic_store(&this->dataPtr->rayDirections, table);
+  return table;
 }
 
 //////////////////////////////////////////////////
@@ -118,3 +118,69 @@ TEST(DOMLidar, Load)
   // The Lidar::Load function is tested more thouroughly in the
   // link_dom.cc integration test.
 }
+
+/////////////////////////////////////////////////
+TEST(DOMLidar, RayDirections)
+{
+  sdf::Lidar lidar;
+  lidar.SetHorizontalScanSamples(3);
+  lidar.SetHorizontalScanMinAngle(-IGN_PI_2);
+  lidar.SetHorizontalScanMaxAngle(IGN_PI_2);
+  lidar.SetVerticalScanSamples(2);
+  lidar.SetVerticalScanMinAngle(0.0);
+  lidar.SetVerticalScanMaxAngle(IGN_PI_2);
+
+  auto rays = lidar.RayDirections();
+  ASSERT_NE(nullptr, rays);
+  EXPECT_EQ(3u, rays->horizontalCount);
+  EXPECT_EQ(2u, rays->verticalCount);
+  ASSERT_EQ(6u, rays->x.size());
+  ASSERT_EQ(6u, rays->y.size());
+  ASSERT_EQ(6u, rays->z.size());
+
+  // Horizontal rays, from right to left.
+  EXPECT_NEAR(0.0, rays->x[0], 1e-9);
+  EXPECT_NEAR(-1.0, rays->y[0], 1e-9);
+  EXPECT_NEAR(1.0, rays->x[1], 1e-9);
+  EXPECT_NEAR(0.0, rays->y[1], 1e-9);
+  EXPECT_NEAR(0.0, rays->x[2], 1e-9);
+  EXPECT_NEAR(1.0, rays->y[2], 1e-9);
+  for (std::size_t i = 0; i < 3; ++i)
+    EXPECT_NEAR(0.0, rays->z[i], 1e-9);
+
+  // Vertical rays.
+  for (std::size_t i = 3; i < 6; ++i)
+  {
+    EXPECT_NEAR(0.0, rays->x[i], 1e-9);
+    EXPECT_NEAR(0.0, rays->y[i], 1e-9);
+    EXPECT_NEAR(1.0, rays->z[i], 1e-9);
+  }
+
+  // The table is computed once, and shared by the lidars with the same
+  // scans.
+  EXPECT_EQ(rays, lidar.RayDirections());
+  sdf::Lidar lidar2(lidar);
+  EXPECT_EQ(rays, lidar2.RayDirections());
+  sdf::Lidar lidar3;
+  lidar3.SetHorizontalScanSamples(3);
+  lidar3.SetHorizontalScanMinAngle(-IGN_PI_2);
+  lidar3.SetHorizontalScanMaxAngle(IGN_PI_2);
+  lidar3.SetVerticalScanSamples(2);
+  lidar3.SetVerticalScanMinAngle(0.0);
+  lidar3.SetVerticalScanMaxAngle(IGN_PI_2);
+  EXPECT_EQ(rays, lidar3.RayDirections());
+
+  // Modifying the scans computes another table.
+  lidar.SetHorizontalScanSamples(1);
+  auto rays2 = lidar.RayDirections();
+  ASSERT_NE(nullptr, rays2);
+  EXPECT_NE(rays, rays2);
+  EXPECT_EQ(1u, rays2->horizontalCount);
+  ASSERT_EQ(2u, rays2->x.size());
+  EXPECT_NEAR(0.0, rays2->x[0], 1e-9);
+  EXPECT_NEAR(-1.0, rays2->y[0], 1e-9);
+
+  // A lidar without samples has no rays.
+  lidar.SetVerticalScanSamples(0);
+  EXPECT_TRUE(lidar.RayDirections()->x.empty());
+}
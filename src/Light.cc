@@ -18,10 +18,18 @@
 #include <ignition/math/Pose3.hh>
 #include "sdf/Error.hh"
 #include "sdf/Light.hh"
+#include "EnumNames.hh"
+#include "FrameSemantics.hh"
 #include "Utils.hh"
 
 using namespace sdf;
 
+/// \brief Light type strings.
+constexpr auto kLightTypes = makeEnumNames<LightType>({
+    {"point", LightType::POINT},
+    {"spot", LightType::SPOT},
+    {"directional", LightType::DIRECTIONAL}});
+
 /// \brief Light private data.
 class sdf::LightPrivate
 {
@@ -46,6 +54,9 @@ class sdf::LightPrivate
   /// \brief Weak pointer to model's Pose Relative-To Graph.
   public: std::weak_ptr<const sdf::PoseRelativeToGraph> poseRelativeToGraph;
 
+  /// \brief Vertex ids of the frames of SemanticPose in the graph.
+  public: FrameIds frameIds;
+
   /// \brief True if the light should cast shadows.
   public: bool castShadows = false;
 
@@ -80,6 +91,17 @@ class sdf::LightPrivate
   public: double spotFalloff = 0.0;
 };
 
+/////////////////////////////////////////////////
+/// \brief Find the vertex ids of the frames of the SemanticPose of a
+/// light again, after its graph or the names of the frames changed.
+/// \param[in,out] _data Private data of the light.
+static void updateFrameIds(LightPrivate &_data)
+{
+  _data.frameIds = findFrameIds(_data.poseRelativeToGraph,
+      _data.poseRelativeTo.empty() ? _data.xmlParentName : _data.poseRelativeTo,
+      _data.xmlParentName);
+}
+
 /////////////////////////////////////////////////
 Light::Light()
   : dataPtr(new LightPrivate)
@@ -145,7 +167,7 @@ Errors Light::Load(ElementPtr _sdf)
 {
   Errors errors;
 
-  this->dataPtr->sdf = _sdf;
+  this->dataPtr->sdf = retainedElement(_sdf);
 
   // Check that the provided SDF element is a <light>
   // This is an error that cannot be recovered, so return an error.
@@ -159,13 +181,7 @@ Errors Light::Load(ElementPtr _sdf)
 
   std::string typeString = _sdf->Get<std::string>("type",
       std::string("point")).first;
-  if (typeString == "point")
-    this->dataPtr->type = LightType::POINT;
-  else if (typeString == "spot")
-    this->dataPtr->type = LightType::SPOT;
-  else if (typeString == "directional")
-    this->dataPtr->type = LightType::DIRECTIONAL;
-  else
+  if (!kLightTypes.Find(typeString, this->dataPtr->type))
   {
     this->dataPtr->type = LightType::INVALID;
     errors.push_back({ErrorCode::ATTRIBUTE_INVALID,
@@ -199,7 +215,7 @@ Errors Light::Load(ElementPtr _sdf)
   this->dataPtr->specular = _sdf->Get<ignition::math::Color>("specular",
       this->dataPtr->specular).first;
 
-  sdf::ElementPtr attenuationElem = _sdf->GetElement("attenuation");
+  sdf::ElementPtr attenuationElem = _sdf->FindElement("attenuation");
   if (attenuationElem)
   {
     std::pair<double, bool> doubleValue = attenuationElem->Get<double>(
@@ -237,7 +253,7 @@ Errors Light::Load(ElementPtr _sdf)
     this->dataPtr->direction = dirPair.first;
   }
 
-  sdf::ElementPtr spotElem = _sdf->GetElement("spot");
+  sdf::ElementPtr spotElem = _sdf->FindElement("spot");
   if (this->dataPtr->type == LightType::SPOT && spotElem)
   {
     // Check for and set inner_angle
@@ -274,7 +290,7 @@ Errors Light::Load(ElementPtr _sdf)
 }
 
 /////////////////////////////////////////////////
-std::string Light::Name() const
+const std::string &Light::Name() const
 {
   return this->dataPtr->name;
 }
@@ -283,6 +299,7 @@ std::string Light::Name() const
 void Light::SetName(const std::string &_name) const
 {
   this->dataPtr->name = _name;
+  NameIndex::NameChanged();
 }
 
 /////////////////////////////////////////////////
@@ -331,12 +348,14 @@ void Light::SetPoseFrame(const std::string &_frame)
 void Light::SetPoseRelativeTo(const std::string &_frame)
 {
   this->dataPtr->poseRelativeTo = _frame;
+  updateFrameIds(*this->dataPtr);
 }
 
 /////////////////////////////////////////////////
 void Light::SetXmlParentName(const std::string &_xmlParentName)
 {
   this->dataPtr->xmlParentName = _xmlParentName;
+  updateFrameIds(*this->dataPtr);
 }
 
 /////////////////////////////////////////////////
@@ -344,6 +363,7 @@ void Light::SetPoseRelativeToGraph(
     std::weak_ptr<const PoseRelativeToGraph> _graph)
 {
   this->dataPtr->poseRelativeToGraph = _graph;
+  updateFrameIds(*this->dataPtr);
 }
 
 /////////////////////////////////////////////////
@@ -353,7 +373,8 @@ sdf::SemanticPose Light::SemanticPose() const
       this->dataPtr->pose,
       this->dataPtr->poseRelativeTo,
       this->dataPtr->xmlParentName,
-      this->dataPtr->poseRelativeToGraph);
+      this->dataPtr->poseRelativeToGraph,
+      this->dataPtr->frameIds);
 }
 
 /////////////////////////////////////////////////
@@ -14,25 +14,34 @@
  * limitations under the License.
  *
 */
+#include <algorithm>
+#include <cmath>
+#include <limits>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 #include <ignition/math/Inertial.hh>
+#include <ignition/math/Matrix3.hh>
 #include <ignition/math/Pose3.hh>
 #include <ignition/math/Vector3.hh>
 
 #include "sdf/Collision.hh"
+#include "sdf/CollisionGeometry.hh"
 #include "sdf/Error.hh"
 #include "sdf/Light.hh"
 #include "sdf/Link.hh"
 #include "sdf/Sensor.hh"
 #include "sdf/Types.hh"
 #include "sdf/Visual.hh"
+#include "ElementArena.hh"
+#include "FrameSemantics.hh"
+#include "SpecStructs.hh"
 #include "Utils.hh"
 
 using namespace sdf;
 
-class sdf::LinkPrivate
+class sdf::LinkPrivate : public ArenaAllocated
 {
   /// \brief Name of the link.
   public: std::string name = "";
@@ -55,6 +64,18 @@ class sdf::LinkPrivate
   /// \brief The sensors specified in this link.
   public: std::vector<Sensor> sensors;
 
+  /// \brief Index of the visuals by name.
+  public: NameIndex visualIndex;
+
+  /// \brief Index of the lights by name.
+  public: NameIndex lightIndex;
+
+  /// \brief Index of the collisions by name.
+  public: NameIndex collisionIndex;
+
+  /// \brief Index of the sensors by name.
+  public: NameIndex sensorIndex;
+
   /// \brief The inertial information for this link.
   public: ignition::math::Inertiald inertial {{1.0,
             ignition::math::Vector3d::One, ignition::math::Vector3d::Zero},
@@ -68,8 +89,22 @@ class sdf::LinkPrivate
 
   /// \brief Weak pointer to model's Pose Relative-To Graph.
   public: std::weak_ptr<const sdf::PoseRelativeToGraph> poseRelativeToGraph;
+
+  /// \brief Vertex ids of the frames of SemanticPose in the graph.
+  public: FrameIds frameIds;
 };
 
+/////////////////////////////////////////////////
+/// \brief Find the vertex ids of the frames of the SemanticPose of a
+/// link again, after its graph or the name of its frame changed.
+/// \param[in,out] _data Private data of the link.
+static void updateFrameIds(LinkPrivate &_data)
+{
+  _data.frameIds = findFrameIds(_data.poseRelativeToGraph,
+      _data.poseRelativeTo.empty() ? "__model__" : _data.poseRelativeTo,
+      "__model__");
+}
+
 /////////////////////////////////////////////////
 Link::Link()
   : dataPtr(new LinkPrivate)
@@ -113,7 +148,7 @@ Errors Link::Load(ElementPtr _sdf)
 {
   Errors errors;
 
-  this->dataPtr->sdf = _sdf;
+  this->dataPtr->sdf = retainedElement(_sdf);
 
   // Check that the provided SDF element is a <link>
   // This is an error that cannot be recovered, so return an error.
@@ -147,21 +182,25 @@ Errors Link::Load(ElementPtr _sdf)
   Errors visLoadErrors = loadUniqueRepeated<Visual>(_sdf, "visual",
       this->dataPtr->visuals);
   errors.insert(errors.end(), visLoadErrors.begin(), visLoadErrors.end());
+  this->dataPtr->visualIndex.Build(this->dataPtr->visuals);
 
   // Load all the collisions.
   Errors collLoadErrors = loadUniqueRepeated<Collision>(_sdf, "collision",
       this->dataPtr->collisions);
   errors.insert(errors.end(), collLoadErrors.begin(), collLoadErrors.end());
+  this->dataPtr->collisionIndex.Build(this->dataPtr->collisions);
 
   // Load all the lights.
   Errors lightLoadErrors = loadUniqueRepeated<Light>(_sdf, "light",
       this->dataPtr->lights);
   errors.insert(errors.end(), lightLoadErrors.begin(), lightLoadErrors.end());
+  this->dataPtr->lightIndex.Build(this->dataPtr->lights);
 
   // Load all the sensors.
   Errors sensorLoadErrors = loadUniqueRepeated<Sensor>(_sdf, "sensor",
       this->dataPtr->sensors);
   errors.insert(errors.end(), sensorLoadErrors.begin(), sensorLoadErrors.end());
+  this->dataPtr->sensorIndex.Build(this->dataPtr->sensors);
 
   ignition::math::Vector3d xxyyzz = ignition::math::Vector3d::One;
   ignition::math::Vector3d xyxzyz = ignition::math::Vector3d::Zero;
@@ -171,25 +210,23 @@ Errors Link::Load(ElementPtr _sdf)
 
   if (_sdf->HasElement("inertial"))
   {
-    sdf::ElementPtr inertialElem = _sdf->GetElement("inertial");
+    sdf::ElementPtr inertialElem = _sdf->FindElement("inertial");
 
     if (inertialElem->HasElement("pose"))
-      loadPose(inertialElem->GetElement("pose"), inertiaPose, inertiaFrame);
+      loadPose(inertialElem->FindElement("pose"), inertiaPose, inertiaFrame);
 
     // Get the mass.
-    mass = inertialElem->Get<double>("mass", 1.0).first;
+    spec::Inertial inertial;
+    inertial.Load(inertialElem);
+    mass = inertial.mass;
 
     if (inertialElem->HasElement("inertia"))
     {
-      sdf::ElementPtr inertiaElem = inertialElem->GetElement("inertia");
+      spec::InertialInertia inertia;
+      inertia.Load(inertialElem->FindElement("inertia"));
 
-      xxyyzz.X(inertiaElem->Get<double>("ixx", 1.0).first);
-      xxyyzz.Y(inertiaElem->Get<double>("iyy", 1.0).first);
-      xxyyzz.Z(inertiaElem->Get<double>("izz", 1.0).first);
-
-      xyxzyz.X(inertiaElem->Get<double>("ixy", 0.0).first);
-      xyxzyz.Y(inertiaElem->Get<double>("ixz", 0.0).first);
-      xyxzyz.Z(inertiaElem->Get<double>("iyz", 0.0).first);
+      xxyyzz.Set(inertia.ixx, inertia.iyy, inertia.izz);
+      xyxzyz.Set(inertia.ixy, inertia.ixz, inertia.iyz);
     }
   }
   if (!this->dataPtr->inertial.SetMassMatrix(
@@ -211,7 +248,7 @@ Errors Link::Load(ElementPtr _sdf)
 }
 
 /////////////////////////////////////////////////
-std::string Link::Name() const
+const std::string &Link::Name() const
 {
   return this->dataPtr->name;
 }
@@ -220,6 +257,7 @@ std::string Link::Name() const
 void Link::SetName(const std::string &_name) const
 {
   this->dataPtr->name = _name;
+  NameIndex::NameChanged();
 }
 
 /////////////////////////////////////////////////
@@ -237,16 +275,9 @@ const Visual *Link::VisualByIndex(const uint64_t _index) const
 }
 
 /////////////////////////////////////////////////
-bool Link::VisualNameExists(const std::string &_name) const
+bool Link::VisualNameExists(std::string_view _name) const
 {
-  for (auto const &v : this->dataPtr->visuals)
-  {
-    if (v.Name() == _name)
-    {
-      return true;
-    }
-  }
-  return false;
+  return this->VisualByName(_name) != nullptr;
 }
 
 /////////////////////////////////////////////////
@@ -264,16 +295,9 @@ const Collision *Link::CollisionByIndex(const uint64_t _index) const
 }
 
 /////////////////////////////////////////////////
-bool Link::CollisionNameExists(const std::string &_name) const
+bool Link::CollisionNameExists(std::string_view _name) const
 {
-  for (auto const &c : this->dataPtr->collisions)
-  {
-    if (c.Name() == _name)
-    {
-      return true;
-    }
-  }
-  return false;
+  return this->CollisionByName(_name) != nullptr;
 }
 
 /////////////////////////////////////////////////
@@ -291,7 +315,7 @@ const Light *Link::LightByIndex(const uint64_t _index) const
 }
 
 /////////////////////////////////////////////////
-bool Link::LightNameExists(const std::string &_name) const
+bool Link::LightNameExists(std::string_view _name) const
 {
   return this->LightByName(_name) != nullptr;
 }
@@ -311,29 +335,15 @@ const Sensor *Link::SensorByIndex(const uint64_t _index) const
 }
 
 /////////////////////////////////////////////////
-bool Link::SensorNameExists(const std::string &_name) const
+bool Link::SensorNameExists(std::string_view _name) const
 {
-  for (auto const &s : this->dataPtr->sensors)
-  {
-    if (s.Name() == _name)
-    {
-      return true;
-    }
-  }
-  return false;
+  return this->SensorByName(_name) != nullptr;
 }
 
 /////////////////////////////////////////////////
-const Sensor *Link::SensorByName(const std::string &_name) const
+const Sensor *Link::SensorByName(std::string_view _name) const
 {
-  for (auto const &s : this->dataPtr->sensors)
-  {
-    if (s.Name() == _name)
-    {
-      return &s;
-    }
-  }
-  return nullptr;
+  return this->dataPtr->sensorIndex.Find(this->dataPtr->sensors, _name);
 }
 
 /////////////////////////////////////////////////
@@ -395,6 +405,7 @@ void Link::SetPoseFrame(const std::string &_frame)
 void Link::SetPoseRelativeTo(const std::string &_frame)
 {
   this->dataPtr->poseRelativeTo = _frame;
+  updateFrameIds(*this->dataPtr);
 }
 
 /////////////////////////////////////////////////
@@ -402,6 +413,7 @@ void Link::SetPoseRelativeToGraph(
     std::weak_ptr<const PoseRelativeToGraph> _graph)
 {
   this->dataPtr->poseRelativeToGraph = _graph;
+  updateFrameIds(*this->dataPtr);
 
   // Pass graph to child elements.
   for (auto &collision : this->dataPtr->collisions)
@@ -426,6 +438,15 @@ void Link::SetPoseRelativeToGraph(
   }
 }
 
+/////////////////////////////////////////////////
+std::size_t Link::Compact()
+{
+  return shrinkToFit(this->dataPtr->visuals) +
+      shrinkToFit(this->dataPtr->lights) +
+      shrinkToFit(this->dataPtr->collisions) +
+      shrinkToFit(this->dataPtr->sensors);
+}
+
 /////////////////////////////////////////////////
 sdf::SemanticPose Link::SemanticPose() const
 {
@@ -433,46 +454,240 @@ sdf::SemanticPose Link::SemanticPose() const
       this->dataPtr->pose,
       this->dataPtr->poseRelativeTo,
       "__model__",
-      this->dataPtr->poseRelativeToGraph);
+      this->dataPtr->poseRelativeToGraph,
+      this->dataPtr->frameIds);
 }
 
 /////////////////////////////////////////////////
-const Visual *Link::VisualByName(const std::string &_name) const
+Errors Link::ResolveCollisionGeometry(CollisionGeometry &_geometry) const
 {
-  for (auto const &v : this->dataPtr->visuals)
+  Errors errors;
+  const auto &collisions = this->dataPtr->collisions;
+
+  // Poses expressed in the link frame, which is the default, do not need
+  // the pose graph.
+  std::vector<ignition::math::Pose3d> poses(collisions.size());
+  for (std::size_t i = 0; i < collisions.size(); ++i)
   {
-    if (v.Name() == _name)
+    if (collisions[i].PoseRelativeTo().empty())
     {
-      return &v;
+      poses[i] = collisions[i].RawPose();
+      continue;
     }
+    Errors poseErrors = collisions[i].SemanticPose().Resolve(poses[i]);
+    errors.insert(errors.end(), poseErrors.begin(), poseErrors.end());
   }
-  return nullptr;
+  if (!errors.empty())
+    return errors;
+
+  const double inf = std::numeric_limits<double>::infinity();
+  CollisionGeometry geometry;
+  geometry.linkIndices.assign(collisions.size(), 0);
+  geometry.collisionIndices.reserve(collisions.size());
+  geometry.types.reserve(collisions.size());
+  geometry.minCorners.reserve(collisions.size());
+  geometry.maxCorners.reserve(collisions.size());
+  geometry.volumes.reserve(collisions.size());
+  geometry.inertias.reserve(collisions.size());
+  for (std::size_t i = 0; i < collisions.size(); ++i)
+  {
+    const Geometry *geom = collisions[i].Geom();
+    const ignition::math::Pose3d &pose = poses[i];
+    geometry.collisionIndices.push_back(i);
+    geometry.types.push_back(geom->Type());
+
+    // Half size of the shape along its axes, and its principal moments of
+    // inertia for a density of 1.
+    double half[3] = {0, 0, 0};
+    double volume = 0;
+    double moments[3] = {0, 0, 0};
+    bool bounded = true;
+    switch (geom->Type())
+    {
+      case GeometryType::BOX:
+      {
+        const ignition::math::Vector3d size = geom->BoxShape()->Size();
+        const double x2 = size.X() * size.X();
+        const double y2 = size.Y() * size.Y();
+        const double z2 = size.Z() * size.Z();
+        half[0] = size.X() / 2;
+        half[1] = size.Y() / 2;
+        half[2] = size.Z() / 2;
+        volume = size.X() * size.Y() * size.Z();
+        moments[0] = volume * (y2 + z2) / 12;
+        moments[1] = volume * (x2 + z2) / 12;
+        moments[2] = volume * (x2 + y2) / 12;
+        break;
+      }
+      case GeometryType::CYLINDER:
+      {
+        const double r = geom->CylinderShape()->Radius();
+        const double l = geom->CylinderShape()->Length();
+        half[0] = half[1] = r;
+        half[2] = l / 2;
+        volume = IGN_PI * r * r * l;
+        moments[0] = moments[1] = volume * (3 * r * r + l * l) / 12;
+        moments[2] = volume * r * r / 2;
+        break;
+      }
+      case GeometryType::SPHERE:
+      {
+        const double r = geom->SphereShape()->Radius();
+        half[0] = half[1] = half[2] = r;
+        volume = 4 * IGN_PI * r * r * r / 3;
+        moments[0] = moments[1] = moments[2] = 2 * volume * r * r / 5;
+        break;
+      }
+      default:
+        bounded = false;
+        break;
+    }
+
+    geometry.volumes.push_back(volume);
+    if (!bounded)
+    {
+      geometry.minCorners.emplace_back(-inf, -inf, -inf);
+      geometry.maxCorners.emplace_back(inf, inf, inf);
+      geometry.inertias.push_back(ignition::math::Matrix3d::Zero);
+      continue;
+    }
+
+    // Extent of the rotated shape along each axis of the link frame. The
+    // sides of a cylinder are round, so their extent along an axis depends
+    // on the sine of its angle with the cylinder axis.
+    const ignition::math::Matrix3d rot(pose.Rot());
+    double extent[3];
+    for (int r = 0; r < 3; ++r)
+    {
+      if (geom->Type() == GeometryType::SPHERE)
+      {
+        extent[r] = half[0];
+      }
+      else if (geom->Type() == GeometryType::CYLINDER)
+      {
+        const double cosine = std::abs(rot(r, 2));
+        extent[r] = half[0] * std::sqrt(std::max(0.0, 1 - cosine * cosine)) +
+            half[2] * cosine;
+      }
+      else
+      {
+        extent[r] = std::abs(rot(r, 0)) * half[0] +
+            std::abs(rot(r, 1)) * half[1] + std::abs(rot(r, 2)) * half[2];
+      }
+    }
+    const ignition::math::Vector3d extents(extent[0], extent[1], extent[2]);
+    geometry.minCorners.push_back(pose.Pos() - extents);
+    geometry.maxCorners.push_back(pose.Pos() + extents);
+
+    const ignition::math::Matrix3d principal(
+        moments[0], 0, 0,
+        0, moments[1], 0,
+        0, 0, moments[2]);
+    geometry.inertias.push_back(rot * principal * rot.Transposed());
+  }
+  geometry.poses = std::move(poses);
+
+  _geometry = std::move(geometry);
+  return errors;
+}
+
+/////////////////////////////////////////////////
+const Visual *Link::VisualByName(std::string_view _name) const
+{
+  return this->dataPtr->visualIndex.Find(this->dataPtr->visuals, _name);
+}
+
+/////////////////////////////////////////////////
+const Collision *Link::CollisionByName(std::string_view _name) const
+{
+  return this->dataPtr->collisionIndex.Find(this->dataPtr->collisions,
+      _name);
 }
 
 /////////////////////////////////////////////////
-const Collision *Link::CollisionByName(const std::string &_name) const
+const Light *Link::LightByName(std::string_view _name) const
 {
-  for (auto const &c : this->dataPtr->collisions)
+  return this->dataPtr->lightIndex.Find(this->dataPtr->lights, _name);
+}
+
+/////////////////////////////////////////////////
+/// \brief Add a child to a link, unless its name is already used.
+/// \param[in,out] _objs The children of the link of the same type.
+/// \param[in,out] _index Index of _objs by name.
+/// \param[in] _obj The child to move into _objs.
+/// \return The added child, or nullptr if its name is already used.
+template<typename Class>
+static Class *addChild(std::vector<Class> &_objs, NameIndex &_index,
+    Class &&_obj)
+{
+  if (_index.Find(_objs, _obj.Name()))
   {
-    if (c.Name() == _name)
-    {
-      return &c;
-    }
+    return nullptr;
   }
-  return nullptr;
+
+  _objs.push_back(std::move(_obj));
+  _index.AddLast(_objs);
+  return &_objs.back();
 }
 
 /////////////////////////////////////////////////
-const Light *Link::LightByName(const std::string &_name) const
+bool Link::AddVisual(Visual &&_visual)
 {
-  for (auto const &c : this->dataPtr->lights)
+  auto *added = addChild(this->dataPtr->visuals,
+      this->dataPtr->visualIndex, std::move(_visual));
+  if (!added)
   {
-    if (c.Name() == _name)
-    {
-      return &c;
-    }
+    return false;
   }
-  return nullptr;
+
+  added->SetXmlParentName(this->dataPtr->name);
+  added->SetPoseRelativeToGraph(this->dataPtr->poseRelativeToGraph);
+  return true;
+}
+
+/////////////////////////////////////////////////
+bool Link::AddCollision(Collision &&_collision)
+{
+  auto *added = addChild(this->dataPtr->collisions,
+      this->dataPtr->collisionIndex, std::move(_collision));
+  if (!added)
+  {
+    return false;
+  }
+
+  added->SetXmlParentName(this->dataPtr->name);
+  added->SetPoseRelativeToGraph(this->dataPtr->poseRelativeToGraph);
+  return true;
+}
+
+/////////////////////////////////////////////////
+bool Link::AddLight(Light &&_light)
+{
+  auto *added = addChild(this->dataPtr->lights,
+      this->dataPtr->lightIndex, std::move(_light));
+  if (!added)
+  {
+    return false;
+  }
+
+  added->SetXmlParentName(this->dataPtr->name);
+  added->SetPoseRelativeToGraph(this->dataPtr->poseRelativeToGraph);
+  return true;
+}
+
+/////////////////////////////////////////////////
+bool Link::AddSensor(Sensor &&_sensor)
+{
+  auto *added = addChild(this->dataPtr->sensors,
+      this->dataPtr->sensorIndex, std::move(_sensor));
+  if (!added)
+  {
+    return false;
+  }
+
+  added->SetXmlParentName(this->dataPtr->name);
+  added->SetPoseRelativeToGraph(this->dataPtr->poseRelativeToGraph);
+  return true;
 }
 
 /////////////////////////////////////////////////
@@ -203,3 +203,37 @@ TEST(DOMLink, InvalidInertia)
   EXPECT_DOUBLE_EQ(3.4, link.Inertial().MassMatrix().OffDiagonalMoments().Z());
   EXPECT_FALSE(link.Inertial().MassMatrix().IsValid());
 }
+
+/////////////////////////////////////////////////
+TEST(DOMLink, AddChildren)
+{
+  sdf::Link link;
+  link.SetName("link");
+
+  sdf::Visual visual;
+  visual.SetName("visual");
+  EXPECT_TRUE(link.AddVisual(std::move(visual)));
+  sdf::Visual otherVisual;
+  otherVisual.SetName("visual");
+  EXPECT_FALSE(link.AddVisual(std::move(otherVisual)));
+  EXPECT_EQ("visual", otherVisual.Name());
+  EXPECT_EQ(1u, link.VisualCount());
+  EXPECT_NE(nullptr, link.VisualByName("visual"));
+
+  // Children of different types can have the same name.
+  sdf::Collision collision;
+  collision.SetName("visual");
+  EXPECT_TRUE(link.AddCollision(std::move(collision)));
+  EXPECT_NE(nullptr, link.CollisionByName("visual"));
+
+  sdf::Light light;
+  light.SetName("lamp");
+  EXPECT_TRUE(link.AddLight(std::move(light)));
+  EXPECT_NE(nullptr, link.LightByName("lamp"));
+
+  sdf::Sensor sensor;
+  sensor.SetName("camera");
+  EXPECT_TRUE(link.AddSensor(std::move(sensor)));
+  EXPECT_NE(nullptr, link.SensorByName("camera"));
+  EXPECT_EQ(1u, link.SensorCount());
+}
@@ -0,0 +1,99 @@
+/*
+ * Copyright 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <chrono>
+#include <future>
+
+#include "sdf/LoadHandle.hh"
+#include "LoadHandlePrivate.hh"
+
+using namespace sdf;
+
+/////////////////////////////////////////////////
+LoadHandle::LoadHandle() = default;
+
+/////////////////////////////////////////////////
+LoadHandle::LoadHandle(LoadHandlePrivate *_dataPtr)
+  : dataPtr(_dataPtr)
+{
+}
+
+/////////////////////////////////////////////////
+LoadHandle::LoadHandle(LoadHandle &&_handle) noexcept
+  : dataPtr(_handle.dataPtr)
+{
+  _handle.dataPtr = nullptr;
+}
+
+/////////////////////////////////////////////////
+LoadHandle &LoadHandle::operator=(LoadHandle &&_handle) noexcept
+{
+  if (this != &_handle)
+  {
+    if (this->Valid())
+      this->dataPtr->result.wait();
+    delete this->dataPtr;
+    this->dataPtr = _handle.dataPtr;
+    _handle.dataPtr = nullptr;
+  }
+  return *this;
+}
+
+/////////////////////////////////////////////////
+LoadHandle::~LoadHandle()
+{
+  if (this->Valid())
+    this->dataPtr->result.wait();
+  delete this->dataPtr;
+}
+
+/////////////////////////////////////////////////
+bool LoadHandle::Valid() const
+{
+  return this->dataPtr && this->dataPtr->result.valid();
+}
+
+/////////////////////////////////////////////////
+void LoadHandle::Cancel()
+{
+  if (this->dataPtr)
+    *this->dataPtr->cancelled = true;
+}
+
+/////////////////////////////////////////////////
+bool LoadHandle::Ready() const
+{
+  return this->WaitFor(std::chrono::steady_clock::duration::zero());
+}
+
+/////////////////////////////////////////////////
+bool LoadHandle::WaitFor(const std::chrono::steady_clock::duration _timeout)
+    const
+{
+  if (!this->Valid())
+    return false;
+  return this->dataPtr->result.wait_for(_timeout) ==
+      std::future_status::ready;
+}
+
+/////////////////////////////////////////////////
+Errors LoadHandle::Wait() const
+{
+  if (!this->Valid())
+    return Errors();
+  return this->dataPtr->result.get();
+}
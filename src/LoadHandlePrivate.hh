@@ -0,0 +1,48 @@
+/*
+ * Copyright 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef SDF_LOADHANDLEPRIVATE_HH_
+#define SDF_LOADHANDLEPRIVATE_HH_
+
+#include <atomic>
+#include <future>
+#include <memory>
+
+#include "sdf/Error.hh"
+#include "sdf/LoadHandle.hh"
+#include "sdf/sdf_config.h"
+
+namespace sdf
+{
+  // Inline bracket to help doxygen filtering.
+  inline namespace SDF_VERSION_NAMESPACE {
+  //
+
+  /// \internal
+  /// \brief Private data for LoadHandle.
+  class LoadHandlePrivate
+  {
+    /// \brief The errors of the load, available once it finishes.
+    public: std::shared_future<Errors> result;
+
+    /// \brief Set by LoadHandle::Cancel, and read by the cancel callback of
+    /// the load, which may outlive the handle.
+    public: std::shared_ptr<std::atomic<bool>> cancelled =
+        std::make_shared<std::atomic<bool>>(false);
+  };
+  }
+}
+#endif
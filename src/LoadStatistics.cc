@@ -0,0 +1,50 @@
+/*
+ * Copyright 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#include <chrono>
+#include <ostream>
+
+#include "sdf/LoadStatistics.hh"
+
+namespace sdf
+{
+inline namespace SDF_VERSION_NAMESPACE {
+
+/////////////////////////////////////////////////
+std::ostream &operator<<(std::ostream &_out,
+                         const LoadStatistics &_statistics)
+{
+  auto ms = [](std::chrono::nanoseconds _time)
+  {
+    return std::chrono::duration<double, std::milli>(_time).count();
+  };
+
+  _out << "elements created:   " << _statistics.elementsCreated << "\n"
+       << "element clones:     " << _statistics.elementClones << "\n"
+       << "params set:         " << _statistics.paramsSet << "\n"
+       << "includes resolved:  " << _statistics.includesResolved << "\n"
+       << "include cache hits: " << _statistics.includeCacheHits << "\n"
+       << "conversions:        " << _statistics.conversions << "\n"
+       << "findFile calls:     " << _statistics.findFileCalls << "\n"
+       << "bytes read:         " << _statistics.bytesRead << "\n"
+       << "read time:          " << ms(_statistics.readTime) << " ms\n"
+       << "DOM load time:      " << ms(_statistics.domLoadTime) << " ms\n"
+       << "XML parse time:     " << ms(_statistics.parseXmlTime) << " ms\n"
+       << "convert time:       " << ms(_statistics.convertTime) << " ms\n";
+  return _out;
+}
+}
+}
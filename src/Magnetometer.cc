@@ -17,6 +17,7 @@
 #include <array>
 #include <string>
 #include "sdf/Magnetometer.hh"
+#include "Utils.hh"
 
 using namespace sdf;
 
@@ -73,7 +74,7 @@ Errors Magnetometer::Load(ElementPtr _sdf)
 {
   Errors errors;
 
-  this->dataPtr->sdf = _sdf;
+  this->dataPtr->sdf = retainedElement(_sdf);
 
   // Check that the provided SDF element is a <magnetometer> element.
   // This is an error that cannot be recovered, so return an error.
@@ -92,9 +93,9 @@ Errors Magnetometer::Load(ElementPtr _sdf)
   {
     if (_sdf->HasElement(names[i]))
     {
-      sdf::ElementPtr elem = _sdf->GetElement(names[i]);
+      sdf::ElementPtr elem = _sdf->FindElement(names[i]);
       if (elem->HasElement("noise"))
-        this->dataPtr->noise[i].Load(elem->GetElement("noise"));
+        this->dataPtr->noise[i].Load(elem->FindElement("noise"));
     }
   }
 
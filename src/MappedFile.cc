@@ -0,0 +1,429 @@
+/*
+ * Copyright 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <algorithm>
+#include <cstring>
+#include <initializer_list>
+#include <limits>
+#include <string>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#include <windows.h>
+#endif
+
+#ifdef SDFORMAT_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+#ifdef SDFORMAT_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+#include "sdf/Console.hh"
+#include "sdf/Filesystem.hh"
+#include "Archive.hh"
+#include "MappedFile.hh"
+
+namespace sdf
+{
+inline namespace SDF_VERSION_NAMESPACE {
+
+#ifndef _WIN32
+
+/////////////////////////////////////////////////
+MappedFile::MappedFile(const std::string &_filename)
+{
+  int fd = open(_filename.c_str(), O_RDONLY);
+  if (fd < 0)
+    return;
+
+  struct stat fileStat;
+  if (fstat(fd, &fileStat) == 0 && S_ISREG(fileStat.st_mode) &&
+      fileStat.st_size > 0)
+  {
+    const std::size_t fileSize = static_cast<std::size_t>(fileStat.st_size);
+    void *mapped = mmap(nullptr, fileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapped != MAP_FAILED)
+    {
+      // The file is parsed from start to end.
+      madvise(mapped, fileSize, MADV_SEQUENTIAL);
+      this->data = static_cast<const char *>(mapped);
+      this->size = fileSize;
+      this->pageSize = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+    }
+  }
+
+  // The mapping stays valid after the file is closed.
+  close(fd);
+}
+
+/////////////////////////////////////////////////
+MappedFile::~MappedFile()
+{
+  if (this->data)
+    munmap(const_cast<char *>(this->data), this->size);
+}
+
+#else
+
+/////////////////////////////////////////////////
+MappedFile::MappedFile(const std::string &_filename)
+{
+  HANDLE file = CreateFileA(_filename.c_str(), GENERIC_READ, FILE_SHARE_READ,
+      nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+  if (file == INVALID_HANDLE_VALUE)
+    return;
+
+  LARGE_INTEGER fileSize;
+  if (GetFileSizeEx(file, &fileSize) && fileSize.QuadPart > 0)
+  {
+    this->mappingHandle =
+        CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (this->mappingHandle)
+    {
+      void *mapped =
+          MapViewOfFile(this->mappingHandle, FILE_MAP_READ, 0, 0, 0);
+      if (mapped)
+      {
+        SYSTEM_INFO info;
+        GetSystemInfo(&info);
+        this->data = static_cast<const char *>(mapped);
+        this->size = static_cast<std::size_t>(fileSize.QuadPart);
+        this->pageSize = info.dwPageSize;
+      }
+      else
+      {
+        CloseHandle(this->mappingHandle);
+        this->mappingHandle = nullptr;
+      }
+    }
+  }
+
+  // The mapping stays valid after the file is closed.
+  CloseHandle(file);
+}
+
+/////////////////////////////////////////////////
+MappedFile::~MappedFile()
+{
+  if (this->data)
+    UnmapViewOfFile(this->data);
+  if (this->mappingHandle)
+    CloseHandle(this->mappingHandle);
+}
+
+#endif  // _WIN32
+
+/////////////////////////////////////////////////
+bool MappedFile::Valid() const
+{
+  return this->data != nullptr;
+}
+
+/////////////////////////////////////////////////
+const char *MappedFile::Data() const
+{
+  return this->data;
+}
+
+/////////////////////////////////////////////////
+std::size_t MappedFile::Size() const
+{
+  return this->size;
+}
+
+/////////////////////////////////////////////////
+bool MappedFile::NullTerminated() const
+{
+  return this->data && this->pageSize > 0 &&
+      this->size % this->pageSize != 0;
+}
+
+/// \brief Compression formats of files read by loadXmlFile.
+enum class Compression
+{
+  /// \brief The file is not compressed.
+  NONE,
+
+  /// \brief The file is compressed with gzip or zlib.
+  GZIP,
+
+  /// \brief The file is compressed with Zstandard.
+  ZSTD
+};
+
+/// \brief Size of the blocks by which decompressed text grows.
+static const std::size_t kDecompressBlockSize = 256 * 1024;
+
+/////////////////////////////////////////////////
+/// \brief Detect the compression of a file from its first bytes.
+/// \param[in] _data The bytes of the file.
+/// \param[in] _size Number of bytes.
+/// \return The compression format.
+static Compression compression(const char *_data, const std::size_t _size)
+{
+  const unsigned char *bytes = reinterpret_cast<const unsigned char *>(_data);
+  if (_size >= 2 && bytes[0] == 0x1f && bytes[1] == 0x8b)
+    return Compression::GZIP;
+  if (_size >= 4 && bytes[0] == 0x28 && bytes[1] == 0xb5 &&
+      bytes[2] == 0x2f && bytes[3] == 0xfd)
+  {
+    return Compression::ZSTD;
+  }
+  return Compression::NONE;
+}
+
+/////////////////////////////////////////////////
+/// \brief Decompress a gzip file.
+/// \param[in] _data The compressed bytes.
+/// \param[in] _size Number of compressed bytes.
+/// \param[out] _text The decompressed text.
+/// \return True if the whole file was decompressed.
+static bool gunzip(const char *_data, std::size_t _size, std::string &_text)
+{
+#ifdef SDFORMAT_HAVE_ZLIB
+  z_stream stream;
+  std::memset(&stream, 0, sizeof(stream));
+  // 32 enables the detection of gzip and zlib headers.
+  if (inflateInit2(&stream, 15 + 32) != Z_OK)
+    return false;
+
+  const std::size_t maxChunk = std::numeric_limits<uInt>::max();
+  std::size_t textSize = 0;
+  int result = Z_OK;
+  // Gzip files can contain several members, which are concatenated.
+  while (result != Z_STREAM_END || _size > 0 || stream.avail_in > 0)
+  {
+    if (result == Z_STREAM_END)
+    {
+      if (inflateReset(&stream) != Z_OK)
+        break;
+    }
+
+    if (stream.avail_in == 0)
+    {
+      const std::size_t chunk = std::min(_size, maxChunk);
+      stream.next_in =
+          reinterpret_cast<Bytef *>(const_cast<char *>(_data));
+      stream.avail_in = static_cast<uInt>(chunk);
+      _data += chunk;
+      _size -= chunk;
+    }
+
+    if (_text.size() - textSize < kDecompressBlockSize)
+      _text.resize(textSize + kDecompressBlockSize);
+    stream.next_out = reinterpret_cast<Bytef *>(&_text[textSize]);
+    stream.avail_out = static_cast<uInt>(_text.size() - textSize);
+
+    result = inflate(&stream, Z_NO_FLUSH);
+    textSize = _text.size() - stream.avail_out;
+    if (result != Z_OK && result != Z_STREAM_END)
+      break;
+    if (result == Z_OK && stream.avail_in == 0 && _size == 0 &&
+        stream.avail_out > 0)
+    {
+      // The input ended before the end of the stream.
+      break;
+    }
+  }
+  inflateEnd(&stream);
+  _text.resize(textSize);
+  return result == Z_STREAM_END;
+#else
+  (void)_data;
+  (void)_size;
+  (void)_text;
+  sdferr << "Unable to read a gzip compressed file, because libsdformat "
+         << "was built without zlib.\n";
+  return false;
+#endif
+}
+
+/////////////////////////////////////////////////
+/// \brief Decompress a Zstandard file.
+/// \param[in] _data The compressed bytes.
+/// \param[in] _size Number of compressed bytes.
+/// \param[out] _text The decompressed text.
+/// \return True if the whole file was decompressed.
+static bool unzstd(const char *_data, const std::size_t _size,
+                   std::string &_text)
+{
+#ifdef SDFORMAT_HAVE_ZSTD
+  ZSTD_DStream *stream = ZSTD_createDStream();
+  if (!stream)
+    return false;
+
+  ZSTD_inBuffer input = {_data, _size, 0};
+  std::size_t textSize = 0;
+  std::size_t result = 0;
+  while (input.pos < input.size)
+  {
+    if (_text.size() - textSize < kDecompressBlockSize)
+      _text.resize(textSize + kDecompressBlockSize);
+    ZSTD_outBuffer output = {&_text[textSize], _text.size() - textSize, 0};
+    result = ZSTD_decompressStream(stream, &output, &input);
+    textSize += output.pos;
+    if (ZSTD_isError(result))
+      break;
+  }
+
+  // Flush the data that is buffered by the decoder.
+  while (!ZSTD_isError(result) && result != 0)
+  {
+    if (_text.size() - textSize < kDecompressBlockSize)
+      _text.resize(textSize + kDecompressBlockSize);
+    ZSTD_outBuffer output = {&_text[textSize], _text.size() - textSize, 0};
+    result = ZSTD_decompressStream(stream, &output, &input);
+    textSize += output.pos;
+    if (output.pos == 0)
+      break;
+  }
+  ZSTD_freeDStream(stream);
+  _text.resize(textSize);
+  return result == 0;
+#else
+  (void)_data;
+  (void)_size;
+  (void)_text;
+  sdferr << "Unable to read a Zstandard compressed file, because "
+         << "libsdformat was built without libzstd.\n";
+  return false;
+#endif
+}
+
+/////////////////////////////////////////////////
+/// \brief Normalize line endings to \\n, as TiXmlDocument::LoadFile does.
+/// \param[in,out] _text The text.
+static void normalizeLineEndings(std::string &_text)
+{
+  std::size_t pos = _text.find('\r');
+  if (pos == std::string::npos)
+    return;
+
+  std::size_t out = pos;
+  for (; pos < _text.size(); ++pos)
+  {
+    if (_text[pos] == '\r')
+    {
+      _text[out++] = '\n';
+      if (pos + 1 < _text.size() && _text[pos + 1] == '\n')
+        ++pos;
+    }
+    else
+    {
+      _text[out++] = _text[pos];
+    }
+  }
+  _text.resize(out);
+}
+
+/////////////////////////////////////////////////
+/// \brief Load an XML document from bytes that are not null-terminated,
+/// such as those of a compressed file or of an archive member.
+/// \param[out] _doc Document to load.
+/// \param[in] _filename Path of the file.
+/// \param[in] _data The bytes of the file.
+/// \param[in] _size Number of bytes.
+/// \return True if the document was loaded without errors.
+static bool loadXmlBytes(TiXmlDocument &_doc, const std::string &_filename,
+    const char *_data, const std::size_t _size)
+{
+  _doc.Clear();
+  _doc.ClearError();
+  _doc.SetValue(_filename);
+
+  std::string text;
+  const Compression fileCompression = compression(_data, _size);
+  if (fileCompression == Compression::NONE)
+  {
+    text.assign(_data, _size);
+  }
+  else if (!(fileCompression == Compression::GZIP ?
+      gunzip(_data, _size, text) : unzstd(_data, _size, text)))
+  {
+    sdferr << "Unable to decompress file [" << _filename << "].\n";
+    _doc.SetError(TiXmlBase::TIXML_ERROR_OPENING_FILE, nullptr, nullptr,
+        TIXML_ENCODING_UNKNOWN);
+    return false;
+  }
+
+  normalizeLineEndings(text);
+  _doc.Parse(text.c_str(), nullptr, TIXML_DEFAULT_ENCODING);
+  return !_doc.Error();
+}
+
+/////////////////////////////////////////////////
+std::string findXmlFile(const std::string &_filename)
+{
+  if (filesystem::exists(_filename))
+    return _filename;
+
+  for (const char *extension : {".gz", ".zst"})
+  {
+    const std::string compressed = _filename + extension;
+    if (filesystem::exists(compressed))
+      return compressed;
+  }
+  return _filename;
+}
+
+/////////////////////////////////////////////////
+bool loadXmlFile(TiXmlDocument &_doc, const std::string &_filename,
+                 std::size_t *_size)
+{
+  MappedFile file(_filename);
+  if (_size)
+    *_size = file.Size();
+
+  // Members of mounted archives are read from the mapped archive.
+  std::string member;
+  if (!file.Valid() && readArchiveFile(_filename, member))
+  {
+    if (_size)
+      *_size = member.size();
+    return loadXmlBytes(_doc, _filename, member.data(), member.size());
+  }
+
+  if (compression(file.Data(), file.Size()) != Compression::NONE)
+  {
+    return loadXmlBytes(_doc, _filename, file.Data(), file.Size());
+  }
+
+  // TiXmlDocument::Parse reads up to a null character, and does not
+  // normalize line endings as LoadFile does. A null character in the file
+  // would also make Parse stop early.
+  if (!file.NullTerminated() ||
+      std::memchr(file.Data(), '\r', file.Size()) != nullptr ||
+      std::memchr(file.Data(), '\0', file.Size()) != nullptr)
+  {
+    return _doc.LoadFile(_filename);
+  }
+
+  // Match the state that LoadFile leaves in the document.
+  _doc.Clear();
+  _doc.ClearError();
+  _doc.SetValue(_filename);
+  _doc.Parse(file.Data(), nullptr, TIXML_DEFAULT_ENCODING);
+  return !_doc.Error();
+}
+}
+}
@@ -0,0 +1,112 @@
+/*
+ * Copyright 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#ifndef SDF_MAPPEDFILE_HH_
+#define SDF_MAPPEDFILE_HH_
+
+#include <tinyxml.h>
+
+#include <cstddef>
+#include <string>
+
+#include "sdf/sdf_config.h"
+
+namespace sdf
+{
+  // Inline bracket to help doxygen filtering.
+  inline namespace SDF_VERSION_NAMESPACE {
+  //
+
+  /// \brief A read-only memory mapping of a whole file, which is unmapped
+  /// when destroyed.
+  class MappedFile
+  {
+    /// \brief Constructor. Maps the file, if it can.
+    /// \param[in] _filename Path of the file.
+    public: explicit MappedFile(const std::string &_filename);
+
+    /// \brief Copy constructor is explicitly deleted.
+    public: MappedFile(const MappedFile &) = delete;
+
+    /// \brief Copy assignment is explicitly deleted.
+    public: MappedFile &operator=(const MappedFile &) = delete;
+
+    /// \brief Destructor. Unmaps the file.
+    public: ~MappedFile();
+
+    /// \brief Get whether the file is mapped. Empty files, and files that
+    /// cannot be opened, are not mapped.
+    /// \return True if the file is mapped.
+    public: bool Valid() const;
+
+    /// \brief Get the mapped bytes of the file.
+    /// \return Pointer to the first byte, or nullptr if not valid.
+    public: const char *Data() const;
+
+    /// \brief Get the size of the file.
+    /// \return Number of mapped bytes, or 0 if not valid.
+    public: std::size_t Size() const;
+
+    /// \brief Get whether the mapping is followed by a null character, which
+    /// is the case when the size of the file is not a multiple of the page
+    /// size, since the rest of the last page is filled with zeros.
+    /// \return True if Data() is a null-terminated string.
+    public: bool NullTerminated() const;
+
+    /// \brief Mapped bytes.
+    private: const char *data = nullptr;
+
+    /// \brief Size of the file.
+    private: std::size_t size = 0;
+
+    /// \brief Size of a page of memory.
+    private: std::size_t pageSize = 0;
+
+#ifdef _WIN32
+    /// \brief Handle of the file mapping object.
+    private: void *mappingHandle = nullptr;
+#endif
+  };
+
+  /// \brief Load an XML document from a file, like TiXmlDocument::LoadFile,
+  /// but by parsing the mapped bytes of the file directly, without copying
+  /// them to a buffer. It falls back to TiXmlDocument::LoadFile for files
+  /// that cannot be mapped, that are not null-terminated when mapped, or
+  /// that contain carriage returns, which LoadFile normalizes.
+  ///
+  /// Files compressed with gzip or Zstandard, which are detected from their
+  /// first bytes, are decompressed in memory from the mapped bytes, when
+  /// the library is built with zlib or libzstd.
+  ///
+  /// Files of the archives mounted with mountArchive are read from the
+  /// mapped archive.
+  /// \param[out] _doc Document to load.
+  /// \param[in] _filename Path of the file.
+  /// \param[out] _size If not null, set to the size of the file in bytes,
+  /// before decompression.
+  /// \return True if the document was loaded without errors.
+  bool loadXmlFile(TiXmlDocument &_doc, const std::string &_filename,
+                   std::size_t *_size = nullptr);
+
+  /// \brief Get the path of an XML file, or of a compressed copy of it.
+  /// \param[in] _filename Path of the file.
+  /// \return _filename if it exists. Otherwise _filename followed by the
+  /// first of the extensions .gz and .zst for which a file exists, or
+  /// _filename if there is none.
+  std::string findXmlFile(const std::string &_filename);
+  }
+}
+#endif
@@ -0,0 +1,215 @@
+/*
+ * Copyright 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <gtest/gtest.h>
+#include <unistd.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string>
+
+#ifdef SDFORMAT_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+#include "MappedFile.hh"
+
+/////////////////////////////////////////////////
+/// \brief Write a file in a new temporary directory.
+/// \param[in] _contents Contents of the file.
+/// \return Path of the file, or an empty string on failure.
+std::string writeTempFile(const std::string &_contents)
+{
+  const char *tmp = getenv("TMPDIR");
+  std::string tmppath = std::string(tmp ? tmp : "/tmp") + "/XXXXXX";
+  if (mkdtemp(const_cast<char *>(tmppath.c_str())) == nullptr)
+    return "";
+
+  const std::string filename = tmppath + "/file.sdf";
+  std::ofstream out(filename, std::ios::binary);
+  out << _contents;
+  return out ? filename : "";
+}
+
+/////////////////////////////////////////////////
+/// \brief Print a document to a string.
+/// \param[in] _doc The document.
+/// \return The printed document.
+std::string print(const TiXmlDocument &_doc)
+{
+  TiXmlPrinter printer;
+  _doc.Accept(&printer);
+  return printer.Str();
+}
+
+/////////////////////////////////////////////////
+TEST(MappedFile, Map)
+{
+  const std::string contents = "<sdf version='1.8'><model name='m'/></sdf>";
+  const std::string filename = writeTempFile(contents);
+  ASSERT_FALSE(filename.empty());
+
+  sdf::MappedFile file(filename);
+  ASSERT_TRUE(file.Valid());
+  EXPECT_TRUE(file.NullTerminated());
+  ASSERT_EQ(contents.size(), file.Size());
+  EXPECT_EQ(contents, std::string(file.Data(), file.Size()));
+
+  sdf::MappedFile missing(filename + ".missing");
+  EXPECT_FALSE(missing.Valid());
+  EXPECT_FALSE(missing.NullTerminated());
+  EXPECT_EQ(nullptr, missing.Data());
+  EXPECT_EQ(0u, missing.Size());
+
+  sdf::MappedFile empty(writeTempFile(""));
+  EXPECT_FALSE(empty.Valid());
+}
+
+/////////////////////////////////////////////////
+TEST(MappedFile, LoadXmlFile)
+{
+  // A document parsed from the mapped file matches the one loaded by
+  // TiXmlDocument::LoadFile, including for files that fall back to it
+  // because of carriage returns, or because their size is a multiple of the
+  // page size.
+  const std::string pageSizeText(sysconf(_SC_PAGESIZE) - 11, ' ');
+  for (const std::string &contents : {
+      std::string("<?xml version='1.0'?>\n<sdf version='1.8'>\n"
+                  "  <model name='m'><static>true</static></model>\n</sdf>"),
+      std::string("<sdf version='1.8'>\r\n<model name='m'/>\r\n</sdf>\r\n"),
+      "<sdf>" + pageSizeText + "</sdf>"})
+  {
+    const std::string filename = writeTempFile(contents);
+    ASSERT_FALSE(filename.empty());
+
+    TiXmlDocument expected;
+    EXPECT_TRUE(expected.LoadFile(filename));
+    TiXmlDocument doc;
+    EXPECT_TRUE(sdf::loadXmlFile(doc, filename));
+    EXPECT_EQ(print(expected), print(doc));
+    EXPECT_EQ(filename, doc.Value());
+  }
+
+  // Errors are reported as by LoadFile.
+  const std::string invalid = writeTempFile("<sdf><model></sdf>");
+  ASSERT_FALSE(invalid.empty());
+  TiXmlDocument doc;
+  EXPECT_FALSE(sdf::loadXmlFile(doc, invalid));
+  EXPECT_TRUE(doc.Error());
+
+  TiXmlDocument missing;
+  EXPECT_FALSE(sdf::loadXmlFile(missing, invalid + ".missing"));
+  EXPECT_TRUE(missing.Error());
+}
+
+#ifdef SDFORMAT_HAVE_ZLIB
+/////////////////////////////////////////////////
+/// \brief Compress a string with gzip.
+/// \param[in] _text The string.
+/// \return The gzip file.
+std::string gzip(const std::string &_text)
+{
+  z_stream stream;
+  std::memset(&stream, 0, sizeof(stream));
+  // 16 selects the gzip header.
+  EXPECT_EQ(Z_OK, deflateInit2(&stream, Z_BEST_COMPRESSION, Z_DEFLATED,
+        15 + 16, 8, Z_DEFAULT_STRATEGY));
+
+  std::string compressed(deflateBound(&stream, _text.size()), '\0');
+  stream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(_text.data()));
+  stream.avail_in = static_cast<uInt>(_text.size());
+  stream.next_out = reinterpret_cast<Bytef *>(&compressed[0]);
+  stream.avail_out = static_cast<uInt>(compressed.size());
+  EXPECT_EQ(Z_STREAM_END, deflate(&stream, Z_FINISH));
+  compressed.resize(stream.total_out);
+  deflateEnd(&stream);
+  return compressed;
+}
+
+/////////////////////////////////////////////////
+TEST(MappedFile, LoadGzipXmlFile)
+{
+  // Large enough to take several blocks of decompressed text.
+  std::string models;
+  for (int i = 0; i < 20000; ++i)
+  {
+    models += "  <model name='m" + std::to_string(i) + "'>"
+              "<static>true</static></model>\r\n";
+  }
+  const std::string contents =
+    "<?xml version='1.0'?>\r\n<sdf version='1.8'>\r\n" + models + "</sdf>";
+
+  const std::string plain = writeTempFile(contents);
+  ASSERT_FALSE(plain.empty());
+  TiXmlDocument expected;
+  ASSERT_TRUE(expected.LoadFile(plain));
+
+  const std::string compressed = gzip(contents);
+  const std::string filename = writeTempFile(compressed);
+  ASSERT_FALSE(filename.empty());
+  TiXmlDocument doc;
+  EXPECT_TRUE(sdf::loadXmlFile(doc, filename));
+  EXPECT_EQ(print(expected), print(doc));
+  EXPECT_EQ(filename, doc.Value());
+
+  // Gzip files can have several members.
+  const std::string half = writeTempFile(
+      gzip(contents.substr(0, contents.size() / 2)) +
+      gzip(contents.substr(contents.size() / 2)));
+  ASSERT_FALSE(half.empty());
+  TiXmlDocument concatenated;
+  EXPECT_TRUE(sdf::loadXmlFile(concatenated, half));
+  EXPECT_EQ(print(expected), print(concatenated));
+
+  // A truncated file is an error.
+  const std::string truncated =
+    writeTempFile(compressed.substr(0, compressed.size() / 2));
+  ASSERT_FALSE(truncated.empty());
+  TiXmlDocument truncatedDoc;
+  EXPECT_FALSE(sdf::loadXmlFile(truncatedDoc, truncated));
+  EXPECT_TRUE(truncatedDoc.Error());
+}
+#endif
+
+#ifndef SDFORMAT_HAVE_ZSTD
+/////////////////////////////////////////////////
+TEST(MappedFile, LoadZstdXmlFileUnsupported)
+{
+  const std::string filename = writeTempFile("\x28\xb5\x2f\xfd\x00\x00");
+  ASSERT_FALSE(filename.empty());
+  TiXmlDocument doc;
+  EXPECT_FALSE(sdf::loadXmlFile(doc, filename));
+  EXPECT_TRUE(doc.Error());
+}
+#endif
+
+/////////////////////////////////////////////////
+TEST(MappedFile, FindXmlFile)
+{
+  const std::string filename = writeTempFile("<sdf/>");
+  ASSERT_FALSE(filename.empty());
+  EXPECT_EQ(filename, sdf::findXmlFile(filename));
+
+  const std::string missing = filename + ".missing";
+  EXPECT_EQ(missing, sdf::findXmlFile(missing));
+
+  std::ofstream(missing + ".zst", std::ios::binary) << "zst";
+  EXPECT_EQ(missing + ".zst", sdf::findXmlFile(missing));
+  std::ofstream(missing + ".gz", std::ios::binary) << "gz";
+  EXPECT_EQ(missing + ".gz", sdf::findXmlFile(missing));
+}
@@ -21,11 +21,20 @@
 #include "sdf/Types.hh"
 #include "sdf/Material.hh"
 #include "sdf/Pbr.hh"
+#include "ElementArena.hh"
+#include "EnumNames.hh"
 #include "Utils.hh"
 
 using namespace sdf;
 
-class sdf::MaterialPrivate
+/// \brief Shader type strings.
+constexpr auto kShaderTypes = makeEnumNames<ShaderType>({
+    {"pixel", ShaderType::PIXEL},
+    {"vertex", ShaderType::VERTEX},
+    {"normal_map_objectspace", ShaderType::NORMAL_MAP_OBJECTSPACE},
+    {"normal_map_tangentspace", ShaderType::NORMAL_MAP_TANGENTSPACE}});
+
+class sdf::MaterialPrivate : public ArenaAllocated
 {
   /// \brief Script URI
   public: std::string scriptUri = "";
@@ -116,7 +125,7 @@ Errors Material::Load(sdf::ElementPtr _sdf)
 {
   Errors errors;
 
-  this->dataPtr->sdf = _sdf;
+  this->dataPtr->sdf = retainedElement(_sdf);
 
   // Check that the provided SDF element is a <material>
   // This is an error that cannot be recovered, so return an error.
@@ -131,7 +140,7 @@ Errors Material::Load(sdf::ElementPtr _sdf)
   // Load the script information
   if (_sdf->HasElement("script"))
   {
-    sdf::ElementPtr elem = _sdf->GetElement("script");
+    sdf::ElementPtr elem = _sdf->FindElement("script");
     std::pair<std::string, bool> uriPair = elem->Get<std::string>("uri", "");
     if (uriPair.first == "__default__")
       uriPair.first = "";
@@ -160,19 +169,11 @@ Errors Material::Load(sdf::ElementPtr _sdf)
   // Load the shader information
   if (_sdf->HasElement("shader"))
   {
-    sdf::ElementPtr elem = _sdf->GetElement("shader");
+    sdf::ElementPtr elem = _sdf->FindElement("shader");
 
     std::pair<std::string, bool> typePair =
       elem->Get<std::string>("type", "pixel");
-    if (typePair.first == "pixel")
-      this->dataPtr->shader = ShaderType::PIXEL;
-    else if (typePair.first == "vertex")
-      this->dataPtr->shader = ShaderType::VERTEX;
-    else if (typePair.first == "normal_map_objectspace")
-      this->dataPtr->shader = ShaderType::NORMAL_MAP_OBJECTSPACE;
-    else if (typePair.first == "normal_map_tangentspace")
-      this->dataPtr->shader = ShaderType::NORMAL_MAP_TANGENTSPACE;
-    else
+    if (!kShaderTypes.Find(typePair.first, this->dataPtr->shader))
     {
       errors.push_back({ErrorCode::ELEMENT_INVALID,
           "The value[" + typePair.first + "] for a <shader><type> element is "
@@ -209,7 +210,7 @@ Errors Material::Load(sdf::ElementPtr _sdf)
   if (_sdf->HasElement("pbr"))
   {
     this->dataPtr->pbr.reset(new sdf::Pbr());
-    Errors pbrErrors = this->dataPtr->pbr->Load(_sdf->GetElement("pbr"));
+    Errors pbrErrors = this->dataPtr->pbr->Load(_sdf->FindElement("pbr"));
     errors.insert(errors.end(), pbrErrors.begin(), pbrErrors.end());
   }
 
@@ -283,7 +284,7 @@ sdf::ElementPtr Material::Element() const
 }
 
 //////////////////////////////////////////////////
-std::string Material::ScriptUri() const
+const std::string &Material::ScriptUri() const
 {
   return this->dataPtr->scriptUri;
 }
@@ -295,7 +296,7 @@ void Material::SetScriptUri(const std::string &_uri)
 }
 
 //////////////////////////////////////////////////
-std::string Material::ScriptName() const
+const std::string &Material::ScriptName() const
 {
   return this->dataPtr->scriptName;
 }
@@ -319,7 +320,7 @@ void Material::SetShader(const ShaderType &_type)
 }
 
 //////////////////////////////////////////////////
-std::string Material::NormalMap() const
+const std::string &Material::NormalMap() const
 {
   return this->dataPtr->normalMap;
 }
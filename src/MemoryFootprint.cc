@@ -0,0 +1,62 @@
+/*
+ * Copyright 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#include <algorithm>
+#include <iomanip>
+#include <ostream>
+#include <string>
+
+#include "sdf/MemoryFootprint.hh"
+
+namespace sdf
+{
+inline namespace SDF_VERSION_NAMESPACE {
+
+/////////////////////////////////////////////////
+std::ostream &operator<<(std::ostream &_out,
+                         const TreeFootprint &_footprint)
+{
+  const std::string totalName = "total";
+  std::size_t nameWidth = totalName.size();
+  for (const auto &entry : _footprint.byName)
+    nameWidth = std::max(nameWidth, entry.first.size());
+
+  auto printRow = [&](const std::string &_name,
+                      const std::string &_elements,
+                      const std::string &_params,
+                      const std::string &_bytes)
+  {
+    _out << std::left << std::setw(static_cast<int>(nameWidth)) << _name
+         << std::right
+         << std::setw(10) << _elements
+         << std::setw(10) << _params
+         << std::setw(14) << _bytes << "\n";
+  };
+
+  printRow("element", "count", "params", "bytes");
+  for (const auto &entry : _footprint.byName)
+  {
+    printRow(entry.first, std::to_string(entry.second.elementCount),
+        std::to_string(entry.second.paramCount),
+        std::to_string(entry.second.bytes));
+  }
+  printRow(totalName, std::to_string(_footprint.total.elementCount),
+      std::to_string(_footprint.total.paramCount),
+      std::to_string(_footprint.total.bytes));
+  return _out;
+}
+}
+}
@@ -15,6 +15,7 @@
  *
 */
 #include "sdf/Mesh.hh"
+#include "Utils.hh"
 
 using namespace sdf;
 
@@ -89,7 +90,7 @@ Errors Mesh::Load(ElementPtr _sdf)
 {
   Errors errors;
 
-  this->dataPtr->sdf = _sdf;
+  this->dataPtr->sdf = retainedElement(_sdf);
 
   // Check that sdf is a valid pointer
   if (!_sdf)
@@ -122,7 +123,7 @@ Errors Mesh::Load(ElementPtr _sdf)
 
   if (_sdf->HasElement("submesh"))
   {
-    sdf::ElementPtr subMesh = _sdf->GetElement("submesh");
+    sdf::ElementPtr subMesh = _sdf->FindElement("submesh");
 
     std::pair<std::string, bool> subMeshNamePair =
       subMesh->Get<std::string>("name", this->dataPtr->submesh);
@@ -156,7 +157,7 @@ sdf::ElementPtr Mesh::Element() const
 }
 
 //////////////////////////////////////////////////
-std::string Mesh::Uri() const
+const std::string &Mesh::Uri() const
 {
   return this->dataPtr->uri;
 }
@@ -192,7 +193,7 @@ void Mesh::SetScale(const ignition::math::Vector3d &_scale)
 }
 
 //////////////////////////////////////////////////
-std::string Mesh::Submesh() const
+const std::string &Mesh::Submesh() const
 {
   return this->dataPtr->submesh;
 }
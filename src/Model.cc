@@ -14,18 +14,34 @@
  * limitations under the License.
  *
 */
+#include <algorithm>
+#include <iterator>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <unordered_map>
 #include <unordered_set>
+#include <utility>
 #include <vector>
 #include <ignition/math/Pose3.hh>
 #include <ignition/math/SemanticVersion.hh>
+#include "sdf/Collision.hh"
+#include "sdf/CollisionFilter.hh"
+#include "sdf/CollisionGeometry.hh"
 #include "sdf/Error.hh"
 #include "sdf/Frame.hh"
 #include "sdf/Joint.hh"
+#include "sdf/JointAxis.hh"
+#include "sdf/KinematicTree.hh"
 #include "sdf/Link.hh"
 #include "sdf/Model.hh"
+#include "sdf/ModelKinematics.hh"
+#include "sdf/ModelMassProperties.hh"
+#include "sdf/RenderBatches.hh"
+#include "sdf/Surface.hh"
+#include "sdf/SurfaceMaterials.hh"
 #include "sdf/Types.hh"
+#include "sdf/Visual.hh"
 #include "FrameSemantics.hh"
 #include "Utils.hh"
 
@@ -52,6 +68,10 @@ class sdf::ModelPrivate
   /// \brief Name of the canonical link.
   public: std::string canonicalLink = "";
 
+  /// \brief Index of the canonical link in links, or -1 if it does not
+  /// exist. It is resolved again when the links or canonicalLink change.
+  public: int64_t canonicalLinkIndex = -1;
+
   /// \brief Pose of the model
   public: ignition::math::Pose3d pose = ignition::math::Pose3d::Zero;
 
@@ -67,6 +87,18 @@ class sdf::ModelPrivate
   /// \brief The frames specified in this model.
   public: std::vector<Frame> frames;
 
+  /// \brief Index of the links by name.
+  public: NameIndex linkIndex;
+
+  /// \brief Index of the joints by name.
+  public: NameIndex jointIndex;
+
+  /// \brief Index of the frames by name.
+  public: NameIndex frameIndex;
+
+  /// \brief Tree formed by the links and joints, rebuilt when they change.
+  public: sdf::KinematicTree kinematicTree;
+
   /// \brief The SDF element pointer used during load.
   public: sdf::ElementPtr sdf;
 
@@ -78,12 +110,280 @@ class sdf::ModelPrivate
 
   /// \brief Pose Relative-To Graph in parent (world) scope.
   public: std::weak_ptr<const sdf::PoseRelativeToGraph> parentPoseGraph;
+
+  /// \brief True if the Frame Attached-To Graph can be shared with other
+  /// models that have the same structure, in which case it must be copied
+  /// before changing it.
+  public: bool frameAttachedToGraphShared = false;
+
+  /// \brief True if the Pose Relative-To Graph can be shared with other
+  /// models that have the same structure, in which case it must be copied
+  /// before changing it.
+  public: bool poseGraphShared = false;
+
+  /// \brief Vertex ids of the frames of SemanticPose in the parent graph.
+  public: FrameIds frameIds;
+};
+
+/////////////////////////////////////////////////
+/// \brief Find the vertex ids of the frames of the SemanticPose of a
+/// model again, after its parent graph or the name of its frame changed.
+/// \param[in,out] _data Private data of the model.
+static void updateFrameIds(ModelPrivate &_data)
+{
+  _data.frameIds = findFrameIds(_data.parentPoseGraph,
+      _data.poseRelativeTo.empty() ? "world" : _data.poseRelativeTo, "world");
+}
+
+/// \brief Frame graphs of a loaded model, which are shared with the models
+/// loaded later whose graphs would be identical.
+struct SharedFrameGraphs
+{
+  /// \brief Frame Attached-To Graph, which is not built for static models.
+  std::weak_ptr<sdf::FrameAttachedToGraph> frameAttachedToGraph;
+
+  /// \brief Pose Relative-To Graph.
+  std::weak_ptr<sdf::PoseRelativeToGraph> poseGraph;
 };
 
+/// \brief Frame graphs of loaded models, by frameGraphKey.
+static std::unordered_map<std::string, SharedFrameGraphs> g_sharedFrameGraphs;
+
+/// \brief Number of entries in g_sharedFrameGraphs after its expired
+/// entries were last removed.
+static std::size_t g_sharedFrameGraphsCleanSize = 0;
+
+/// \brief Mutex protecting g_sharedFrameGraphs, since models can be loaded
+/// on several threads.
+static std::mutex g_sharedFrameGraphsMutex;
+
+/// \brief Self collision exclusions of models, by the key built by
+/// Model::SelfCollisionExclusions.
+static std::unordered_map<std::string,
+    std::weak_ptr<const SelfCollisionExclusions>> g_sharedExclusions;
+
+/// \brief Number of entries in g_sharedExclusions after its expired entries
+/// were last removed.
+static std::size_t g_sharedExclusionsCleanSize = 0;
+
+/// \brief Mutex protecting g_sharedExclusions.
+static std::mutex g_sharedExclusionsMutex;
+
+/////////////////////////////////////////////////
+/// \brief Append a pose to a key, with the exact bits of its values.
+/// \param[in,out] _key Key to append to.
+/// \param[in] _pose Pose to append.
+static void appendKeyPose(
+    std::string &_key, const ignition::math::Pose3d &_pose)
+{
+  const double values[] = {
+      _pose.Pos().X(), _pose.Pos().Y(), _pose.Pos().Z(),
+      _pose.Rot().W(), _pose.Rot().X(), _pose.Rot().Y(), _pose.Rot().Z()};
+  _key.append(reinterpret_cast<const char *>(values), sizeof(values));
+}
+
+/////////////////////////////////////////////////
+/// \brief Append a name to a key. Names cannot contain null characters,
+/// so one terminates each name.
+/// \param[in,out] _key Key to append to.
+/// \param[in] _name Name to append.
+static void appendKeyName(std::string &_key, const std::string &_name)
+{
+  _key.append(_name);
+  _key.push_back('\0');
+}
+
+/////////////////////////////////////////////////
+/// \brief Get a key that is equal for two models if and only if
+/// buildFrameAttachedToGraph and buildPoseRelativeToGraph build identical
+/// graphs for them. It contains everything that these functions read, except
+/// for the model name, which only appears in error messages.
+/// \param[in] _model The model.
+/// \return The key.
+static std::string frameGraphKey(const Model &_model)
+{
+  std::string key;
+  key.push_back(_model.Static() ? 'S' : 'D');
+  appendKeyName(key, _model.CanonicalLinkName());
+  for (uint64_t l = 0; l < _model.LinkCount(); ++l)
+  {
+    auto link = _model.LinkByIndex(l);
+    key.push_back('L');
+    appendKeyName(key, link->Name());
+    appendKeyName(key, link->PoseRelativeTo());
+    appendKeyPose(key, link->RawPose());
+  }
+  for (uint64_t j = 0; j < _model.JointCount(); ++j)
+  {
+    auto joint = _model.JointByIndex(j);
+    key.push_back('J');
+    appendKeyName(key, joint->Name());
+    appendKeyName(key, joint->ChildLinkName());
+    appendKeyName(key, joint->PoseRelativeTo());
+    appendKeyPose(key, joint->RawPose());
+  }
+  for (uint64_t f = 0; f < _model.FrameCount(); ++f)
+  {
+    auto frame = _model.FrameByIndex(f);
+    key.push_back('F');
+    appendKeyName(key, frame->Name());
+    appendKeyName(key, frame->AttachedTo());
+    appendKeyName(key, frame->PoseRelativeTo());
+    appendKeyPose(key, frame->RawPose());
+  }
+  return key;
+}
+
+/////////////////////////////////////////////////
+/// \brief Prepare the graphs of a model for a frame to be added to them:
+/// copy them if they are shared with other models, or create them if the
+/// model was not loaded.
+/// \param[in,out] _data Private data of the model.
+/// \return True if the graphs were replaced, in which case the children of
+/// the model must be given the new graphs.
+static bool prepareGraphs(ModelPrivate &_data)
+{
+  if (!_data.poseGraph)
+  {
+    if (!_data.isStatic)
+    {
+      _data.frameAttachedToGraph = std::make_shared<FrameAttachedToGraph>();
+    }
+    _data.poseGraph = std::make_shared<PoseRelativeToGraph>();
+    addScopeVertex(_data.frameAttachedToGraph.get(), *_data.poseGraph,
+        "__model__", FrameType::MODEL);
+    _data.frameAttachedToGraphShared = false;
+    _data.poseGraphShared = false;
+    return true;
+  }
+
+  if (!_data.frameAttachedToGraphShared && !_data.poseGraphShared)
+  {
+    return false;
+  }
+
+  // UpdateFramePose may already have copied the pose graph, so each graph
+  // is only copied if it is still shared.
+  if (_data.frameAttachedToGraphShared && _data.frameAttachedToGraph)
+  {
+    _data.frameAttachedToGraph = std::make_shared<FrameAttachedToGraph>(
+        *_data.frameAttachedToGraph);
+  }
+  if (_data.poseGraphShared)
+  {
+    _data.poseGraph = std::make_shared<PoseRelativeToGraph>(*_data.poseGraph);
+  }
+  _data.frameAttachedToGraphShared = false;
+  _data.poseGraphShared = false;
+  return true;
+}
+
+/////////////////////////////////////////////////
+/// \brief Build the tree formed by the links and joints of a model, in time
+/// linear in their number.
+/// \param[in] _data Private data of the model, with its link index built.
+/// \param[out] _tree The tree.
+static void buildKinematicTree(const ModelPrivate &_data,
+    sdf::KinematicTree &_tree)
+{
+  const auto &links = _data.links;
+  const auto &joints = _data.joints;
+  const std::size_t linkCount = links.size();
+
+  auto linkIndex = [&](const std::string &_name) -> int64_t
+  {
+    const Link *link = _data.linkIndex.Find(links, _name);
+    return link ? link - links.data() : -1;
+  };
+
+  sdf::KinematicTree tree;
+  tree.parentJoints.assign(linkCount, -1);
+  tree.parentLinks.assign(linkCount, -1);
+  tree.depths.assign(linkCount, -1);
+  tree.jointParents.reserve(joints.size());
+  tree.jointChildren.reserve(joints.size());
+  for (std::size_t j = 0; j < joints.size(); ++j)
+  {
+    const int64_t parent = linkIndex(joints[j].ParentLinkName());
+    const int64_t child = linkIndex(joints[j].ChildLinkName());
+    tree.jointParents.push_back(parent);
+    tree.jointChildren.push_back(child);
+    if (child >= 0 && tree.parentJoints[child] < 0)
+    {
+      tree.parentJoints[child] = static_cast<int64_t>(j);
+      tree.parentLinks[child] = parent;
+    }
+  }
+
+  // Group the children by parent link with a counting sort, which keeps
+  // siblings in index order.
+  tree.childOffsets.assign(linkCount + 1, 0);
+  for (std::size_t l = 0; l < linkCount; ++l)
+  {
+    if (tree.parentLinks[l] >= 0)
+      ++tree.childOffsets[tree.parentLinks[l] + 1];
+  }
+  for (std::size_t l = 0; l < linkCount; ++l)
+    tree.childOffsets[l + 1] += tree.childOffsets[l];
+  tree.childLinks.resize(tree.childOffsets[linkCount]);
+  std::vector<uint64_t> next(tree.childOffsets.begin(),
+                             tree.childOffsets.end() - 1);
+  for (std::size_t l = 0; l < linkCount; ++l)
+  {
+    if (tree.parentLinks[l] >= 0)
+      tree.childLinks[next[tree.parentLinks[l]]++] = l;
+  }
+
+  // Depth-first order from the roots, keeping siblings in index order.
+  // Links on a loop of parent joints are not reached from a root, and are
+  // added in index order after the others.
+  tree.linkOrder.reserve(linkCount);
+  std::vector<uint64_t> stack;
+  for (std::size_t l = linkCount; l-- > 0;)
+  {
+    if (tree.parentLinks[l] < 0)
+      stack.push_back(l);
+  }
+  while (!stack.empty())
+  {
+    const uint64_t l = stack.back();
+    stack.pop_back();
+    const int64_t parent = tree.parentLinks[l];
+    tree.depths[l] = parent < 0 ? 0 : tree.depths[parent] + 1;
+    tree.linkOrder.push_back(l);
+    for (uint64_t c = tree.childOffsets[l + 1]; c > tree.childOffsets[l];)
+      stack.push_back(tree.childLinks[--c]);
+  }
+  for (std::size_t l = 0; l < linkCount; ++l)
+  {
+    if (tree.depths[l] < 0)
+      tree.linkOrder.push_back(l);
+  }
+
+  _tree = std::move(tree);
+}
+
+/////////////////////////////////////////////////
+/// \brief Resolve the index of the canonical link of a model, which is the
+/// first link if the name of the canonical link is empty.
+/// \param[in,out] _data Private data of the model, with its link index
+/// built.
+static void resolveCanonicalLink(ModelPrivate &_data)
+{
+  if (_data.canonicalLink.empty())
+  {
+    _data.canonicalLinkIndex = _data.links.empty() ? -1 : 0;
+    return;
+  }
+  const Link *link = _data.linkIndex.Find(_data.links, _data.canonicalLink);
+  _data.canonicalLinkIndex = link ? link - _data.links.data() : -1;
+}
+
 /////////////////////////////////////////////////
 Model::Model()
   : dataPtr(new ModelPrivate)
 {
+  buildKinematicTree(*this->dataPtr, this->dataPtr->kinematicTree);
 }
 
 /////////////////////////////////////////////////
@@ -97,30 +397,20 @@ Model::~Model()
 Model::Model(const Model &_model)
   : dataPtr(new ModelPrivate(*_model.dataPtr))
 {
-  if (_model.dataPtr->frameAttachedToGraph)
+  // Shared graphs are only copied when they are changed.
+  if (!this->dataPtr->frameAttachedToGraphShared &&
+      _model.dataPtr->frameAttachedToGraph)
   {
     this->dataPtr->frameAttachedToGraph =
         std::make_shared<sdf::FrameAttachedToGraph>(
             *_model.dataPtr->frameAttachedToGraph);
   }
-  if (_model.dataPtr->poseGraph)
+  if (!this->dataPtr->poseGraphShared && _model.dataPtr->poseGraph)
   {
     this->dataPtr->poseGraph = std::make_shared<sdf::PoseRelativeToGraph>(
         *_model.dataPtr->poseGraph);
   }
-  for (auto &link : this->dataPtr->links)
-  {
-    link.SetPoseRelativeToGraph(this->dataPtr->poseGraph);
-  }
-  for (auto &joint : this->dataPtr->joints)
-  {
-    joint.SetPoseRelativeToGraph(this->dataPtr->poseGraph);
-  }
-  for (auto &frame : this->dataPtr->frames)
-  {
-    frame.SetFrameAttachedToGraph(this->dataPtr->frameAttachedToGraph);
-    frame.SetPoseRelativeToGraph(this->dataPtr->poseGraph);
-  }
+  this->SetChildGraphs();
 }
 
 /////////////////////////////////////////////////
@@ -205,7 +495,8 @@ Errors Model::Load(ElementPtr _sdf)
                      "skipping model [" + this->dataPtr->name + "]."});
   }
 
-  if (!_sdf->HasUniqueChildNames())
+  const ValidationLevel validation = validationLevel();
+  if (validation == ValidationLevel::FULL && !_sdf->HasUniqueChildNames())
   {
     sdfwarn << "Non-unique names detected in XML children of model with name["
             << this->Name() << "].\n";
@@ -215,10 +506,14 @@ Errors Model::Load(ElementPtr _sdf)
   // name collisions
   std::unordered_set<std::string> frameNames;
 
-  // Load all the links.
+  // Load all the links, on several threads if the models are loaded with
+  // ParserConfig::ModelLoadThreadCount and this one is not loaded
+  // concurrently with its siblings.
   Errors linkLoadErrors = loadUniqueRepeated<Link>(_sdf, "link",
-    this->dataPtr->links);
+    this->dataPtr->links, loadThreadCount());
   errors.insert(errors.end(), linkLoadErrors.begin(), linkLoadErrors.end());
+  this->dataPtr->linkIndex.Build(this->dataPtr->links);
+  resolveCanonicalLink(*this->dataPtr);
 
   // Links are loaded first, and loadUniqueRepeated ensures there are no
   // duplicate names, so these names can be added to frameNames without
@@ -273,6 +568,8 @@ Errors Model::Load(ElementPtr _sdf)
     }
     frameNames.insert(jointName);
   }
+  this->dataPtr->jointIndex.Build(this->dataPtr->joints);
+  buildKinematicTree(*this->dataPtr, this->dataPtr->kinematicTree);
 
   // Load all the frames.
   Errors frameLoadErrors = loadUniqueRepeated<Frame>(_sdf, "frame",
@@ -310,27 +607,57 @@ Errors Model::Load(ElementPtr _sdf)
     }
     frameNames.insert(frameName);
   }
+  this->dataPtr->frameIndex.Build(this->dataPtr->frames);
 
-  // Build the graphs.
+  // Build the graphs, unless a model with the same structure was loaded
+  // before, such as another copy of an included model. Graphs without
+  // errors are shared by these models. Model::UpdateFramePose copies the
+  // pose graph before changing it if it is shared.
+  const std::string graphKey = frameGraphKey(*this);
+  {
+    std::lock_guard<std::mutex> lock(g_sharedFrameGraphsMutex);
+    auto sharedIt = g_sharedFrameGraphs.find(graphKey);
+    if (sharedIt != g_sharedFrameGraphs.end())
+    {
+      this->dataPtr->frameAttachedToGraph =
+          sharedIt->second.frameAttachedToGraph.lock();
+      this->dataPtr->poseGraph = sharedIt->second.poseGraph.lock();
+      if (this->dataPtr->poseGraph &&
+          (this->Static() || this->dataPtr->frameAttachedToGraph))
+      {
+        this->dataPtr->frameAttachedToGraphShared = true;
+        this->dataPtr->poseGraphShared = true;
+        this->SetChildGraphs();
+        this->dataPtr->sdf = retainedElement(this->dataPtr->sdf);
+        return errors;
+      }
+      this->dataPtr->frameAttachedToGraph.reset();
+      this->dataPtr->poseGraph.reset();
+    }
+  }
+
+  this->dataPtr->frameAttachedToGraphShared = false;
+  this->dataPtr->poseGraphShared = false;
+  Errors graphErrors;
 
   // Build the FrameAttachedToGraph if the model is not static.
   // Re-enable this when the buildFrameAttachedToGraph implementation handles
   // static models.
-  if (!this->Static())
+  if (!this->Static() && validation != ValidationLevel::NONE)
   {
     this->dataPtr->frameAttachedToGraph
         = std::make_shared<FrameAttachedToGraph>();
     Errors frameAttachedToGraphErrors =
     buildFrameAttachedToGraph(*this->dataPtr->frameAttachedToGraph, this);
-    errors.insert(errors.end(), frameAttachedToGraphErrors.begin(),
+    graphErrors.insert(graphErrors.end(), frameAttachedToGraphErrors.begin(),
                                 frameAttachedToGraphErrors.end());
-    Errors validateFrameAttachedGraphErrors =
-      validateFrameAttachedToGraph(*this->dataPtr->frameAttachedToGraph);
-    errors.insert(errors.end(), validateFrameAttachedGraphErrors.begin(),
-                                validateFrameAttachedGraphErrors.end());
-    for (auto &frame : this->dataPtr->frames)
+    if (validation == ValidationLevel::FULL)
     {
-      frame.SetFrameAttachedToGraph(this->dataPtr->frameAttachedToGraph);
+      Errors validateFrameAttachedGraphErrors =
+        validateFrameAttachedToGraph(*this->dataPtr->frameAttachedToGraph);
+      graphErrors.insert(graphErrors.end(),
+          validateFrameAttachedGraphErrors.begin(),
+          validateFrameAttachedGraphErrors.end());
     }
   }
 
@@ -338,30 +665,64 @@ Errors Model::Load(ElementPtr _sdf)
   this->dataPtr->poseGraph = std::make_shared<PoseRelativeToGraph>();
   Errors poseGraphErrors =
   buildPoseRelativeToGraph(*this->dataPtr->poseGraph, this);
-  errors.insert(errors.end(), poseGraphErrors.begin(),
+  graphErrors.insert(graphErrors.end(), poseGraphErrors.begin(),
                               poseGraphErrors.end());
-  Errors validatePoseGraphErrors =
-    validatePoseRelativeToGraph(*this->dataPtr->poseGraph);
-  errors.insert(errors.end(), validatePoseGraphErrors.begin(),
-                              validatePoseGraphErrors.end());
-  for (auto &link : this->dataPtr->links)
+  if (validation == ValidationLevel::FULL)
   {
-    link.SetPoseRelativeToGraph(this->dataPtr->poseGraph);
+    Errors validatePoseGraphErrors =
+      validatePoseRelativeToGraph(*this->dataPtr->poseGraph);
+    graphErrors.insert(graphErrors.end(), validatePoseGraphErrors.begin(),
+                                validatePoseGraphErrors.end());
   }
-  for (auto &joint : this->dataPtr->joints)
+  this->SetChildGraphs();
+
+  // Only validated graphs are shared, so that models loaded with every check
+  // do not reuse graphs that were not checked.
+  if (graphErrors.empty() && validation == ValidationLevel::FULL)
   {
-    joint.SetPoseRelativeToGraph(this->dataPtr->poseGraph);
+    std::lock_guard<std::mutex> lock(g_sharedFrameGraphsMutex);
+
+    // Remove the graphs that are no longer used when the number of entries
+    // doubles, so that the time spent removing them stays proportional to
+    // the number of models loaded.
+    if (g_sharedFrameGraphs.size() >= 2 * g_sharedFrameGraphsCleanSize)
+    {
+      for (auto it = g_sharedFrameGraphs.begin();
+           it != g_sharedFrameGraphs.end();)
+      {
+        if (it->second.poseGraph.expired())
+          it = g_sharedFrameGraphs.erase(it);
+        else
+          ++it;
+      }
+      g_sharedFrameGraphsCleanSize = g_sharedFrameGraphs.size();
+    }
+
+    g_sharedFrameGraphs[graphKey] = {
+        this->dataPtr->frameAttachedToGraph, this->dataPtr->poseGraph};
+    this->dataPtr->frameAttachedToGraphShared = true;
+    this->dataPtr->poseGraphShared = true;
   }
-  for (auto &frame : this->dataPtr->frames)
+  errors.insert(errors.end(), graphErrors.begin(), graphErrors.end());
+
+  // The element is only needed to build the graphs.
+  this->dataPtr->sdf = retainedElement(this->dataPtr->sdf);
+
+  const LoadMonitor *monitor = LoadMonitor::Current();
+  if (monitor && monitor->Reporting())
   {
-    frame.SetPoseRelativeToGraph(this->dataPtr->poseGraph);
+    LoadProgress progress;
+    progress.type = LoadProgressType::MODEL_LOADED;
+    progress.name = this->Name();
+    progress.model = this;
+    monitor->Report(progress);
   }
 
   return errors;
 }
 
 /////////////////////////////////////////////////
-std::string Model::Name() const
+const std::string &Model::Name() const
 {
   return this->dataPtr->name;
 }
@@ -370,6 +731,7 @@ std::string Model::Name() const
 void Model::SetName(const std::string &_name)
 {
   this->dataPtr->name = _name;
+  NameIndex::NameChanged();
 }
 
 /////////////////////////////////////////////////
@@ -435,16 +797,9 @@ const Link *Model::LinkByIndex(const uint64_t _index) const
 }
 
 /////////////////////////////////////////////////
-bool Model::LinkNameExists(const std::string &_name) const
+bool Model::LinkNameExists(std::string_view _name) const
 {
-  for (auto const &l : this->dataPtr->links)
-  {
-    if (l.Name() == _name)
-    {
-      return true;
-    }
-  }
-  return false;
+  return this->LinkByName(_name) != nullptr;
 }
 
 /////////////////////////////////////////////////
@@ -462,29 +817,15 @@ const Joint *Model::JointByIndex(const uint64_t _index) const
 }
 
 /////////////////////////////////////////////////
-bool Model::JointNameExists(const std::string &_name) const
+bool Model::JointNameExists(std::string_view _name) const
 {
-  for (auto const &j : this->dataPtr->joints)
-  {
-    if (j.Name() == _name)
-    {
-      return true;
-    }
-  }
-  return false;
+  return this->JointByName(_name) != nullptr;
 }
 
 /////////////////////////////////////////////////
-const Joint *Model::JointByName(const std::string &_name) const
+const Joint *Model::JointByName(std::string_view _name) const
 {
-  for (auto const &j : this->dataPtr->joints)
-  {
-    if (j.Name() == _name)
-    {
-      return &j;
-    }
-  }
-  return nullptr;
+  return this->dataPtr->jointIndex.Find(this->dataPtr->joints, _name);
 }
 
 /////////////////////////////////////////////////
@@ -502,42 +843,117 @@ const Frame *Model::FrameByIndex(const uint64_t _index) const
 }
 
 /////////////////////////////////////////////////
-bool Model::FrameNameExists(const std::string &_name) const
+bool Model::FrameNameExists(std::string_view _name) const
+{
+  return this->FrameByName(_name) != nullptr;
+}
+
+/////////////////////////////////////////////////
+const Frame *Model::FrameByName(std::string_view _name) const
+{
+  return this->dataPtr->frameIndex.Find(this->dataPtr->frames, _name);
+}
+
+/////////////////////////////////////////////////
+Errors Model::AddLink(Link &&_link)
 {
-  for (auto const &f : this->dataPtr->frames)
+  if (prepareGraphs(*this->dataPtr))
   {
-    if (f.Name() == _name)
-    {
-      return true;
-    }
+    this->SetChildGraphs();
+  }
+
+  // Use the same default relative_to frame as buildPoseRelativeToGraph, and
+  // attach the model frame to the canonical link.
+  const std::string &canonicalLink = this->dataPtr->canonicalLink;
+  const bool canonical = canonicalLink.empty() ?
+      this->dataPtr->links.empty() : canonicalLink == _link.Name();
+  Errors errors = addFrameToGraphs(this->dataPtr->frameAttachedToGraph.get(),
+      *this->dataPtr->poseGraph, _link.Name(), FrameType::LINK, "",
+      _link.PoseRelativeTo().empty() ? "__model__" : _link.PoseRelativeTo(),
+      _link.RawPose(), canonical);
+  if (!errors.empty())
+  {
+    return errors;
   }
-  return false;
+
+  this->dataPtr->links.push_back(std::move(_link));
+  this->dataPtr->linkIndex.AddLast(this->dataPtr->links);
+  resolveCanonicalLink(*this->dataPtr);
+  this->dataPtr->links.back().SetPoseRelativeToGraph(this->dataPtr->poseGraph);
+  buildKinematicTree(*this->dataPtr, this->dataPtr->kinematicTree);
+  return errors;
 }
 
 /////////////////////////////////////////////////
-const Frame *Model::FrameByName(const std::string &_name) const
+Errors Model::AddJoint(Joint &&_joint)
 {
-  for (auto const &f : this->dataPtr->frames)
+  Errors errors;
+  if (!this->LinkByName(_joint.ChildLinkName()))
   {
-    if (f.Name() == _name)
-    {
-      return &f;
-    }
+    errors.push_back({ErrorCode::JOINT_CHILD_LINK_INVALID,
+      "Child link with name[" + _joint.ChildLinkName() +
+      "] specified by joint with name[" + _joint.Name() +
+      "] not found in model with name[" + this->Name() + "]."});
+    return errors;
   }
-  return nullptr;
+
+  if (prepareGraphs(*this->dataPtr))
+  {
+    this->SetChildGraphs();
+  }
+
+  errors = addFrameToGraphs(this->dataPtr->frameAttachedToGraph.get(),
+      *this->dataPtr->poseGraph, _joint.Name(), FrameType::JOINT,
+      _joint.ChildLinkName(), _joint.PoseRelativeTo().empty() ?
+      _joint.ChildLinkName() : _joint.PoseRelativeTo(),
+      _joint.RawPose(), false);
+  if (!errors.empty())
+  {
+    return errors;
+  }
+
+  this->dataPtr->joints.push_back(std::move(_joint));
+  this->dataPtr->jointIndex.AddLast(this->dataPtr->joints);
+  this->dataPtr->joints.back().SetPoseRelativeToGraph(
+      this->dataPtr->poseGraph);
+  buildKinematicTree(*this->dataPtr, this->dataPtr->kinematicTree);
+  return errors;
 }
 
 /////////////////////////////////////////////////
-const Link *Model::CanonicalLink() const
+Errors Model::AddFrame(Frame &&_frame)
 {
-  if (this->CanonicalLinkName().empty())
+  if (prepareGraphs(*this->dataPtr))
   {
-    return this->LinkByIndex(0);
+    this->SetChildGraphs();
   }
-  else
+
+  // Use the same default attached_to and relative_to frames as
+  // buildFrameAttachedToGraph and buildPoseRelativeToGraph.
+  const std::string attachedTo =
+      _frame.AttachedTo().empty() ? "__model__" : _frame.AttachedTo();
+  Errors errors = addFrameToGraphs(this->dataPtr->frameAttachedToGraph.get(),
+      *this->dataPtr->poseGraph, _frame.Name(), FrameType::FRAME, attachedTo,
+      _frame.PoseRelativeTo().empty() ? attachedTo : _frame.PoseRelativeTo(),
+      _frame.RawPose(), false);
+  if (!errors.empty())
   {
-    return this->LinkByName(this->CanonicalLinkName());
+    return errors;
   }
+
+  this->dataPtr->frames.push_back(std::move(_frame));
+  this->dataPtr->frameIndex.AddLast(this->dataPtr->frames);
+  Frame &frame = this->dataPtr->frames.back();
+  frame.SetFrameAttachedToGraph(this->dataPtr->frameAttachedToGraph);
+  frame.SetPoseRelativeToGraph(this->dataPtr->poseGraph);
+  return errors;
+}
+
+/////////////////////////////////////////////////
+const Link *Model::CanonicalLink() const
+{
+  const int64_t index = this->dataPtr->canonicalLinkIndex;
+  return index < 0 ? nullptr : &this->dataPtr->links[index];
 }
 
 /////////////////////////////////////////////////
@@ -550,6 +966,7 @@ const std::string &Model::CanonicalLinkName() const
 void Model::SetCanonicalLinkName(const std::string &_canonicalLink)
 {
   this->dataPtr->canonicalLink = _canonicalLink;
+  resolveCanonicalLink(*this->dataPtr);
 }
 
 /////////////////////////////////////////////////
@@ -598,6 +1015,7 @@ void Model::SetPoseFrame(const std::string &_frame)
 void Model::SetPoseRelativeTo(const std::string &_frame)
 {
   this->dataPtr->poseRelativeTo = _frame;
+  updateFrameIds(*this->dataPtr);
 }
 
 /////////////////////////////////////////////////
@@ -605,6 +1023,7 @@ void Model::SetPoseRelativeToGraph(
     std::weak_ptr<const PoseRelativeToGraph> _graph)
 {
   this->dataPtr->parentPoseGraph = _graph;
+  updateFrameIds(*this->dataPtr);
 }
 
 /////////////////////////////////////////////////
@@ -614,20 +1033,647 @@ sdf::SemanticPose Model::SemanticPose() const
       this->dataPtr->pose,
       this->dataPtr->poseRelativeTo,
       "world",
-      this->dataPtr->parentPoseGraph);
+      this->dataPtr->parentPoseGraph,
+      this->dataPtr->frameIds);
+}
+
+/////////////////////////////////////////////////
+Errors Model::ResolveFramePoses(std::vector<ignition::math::Pose3d> &_poses,
+    const std::string &_relativeTo) const
+{
+  Errors errors;
+
+  if (!this->dataPtr->poseGraph)
+  {
+    errors.push_back({ErrorCode::ELEMENT_INVALID,
+        "Model has invalid pointer to PoseRelativeToGraph."});
+    return errors;
+  }
+
+  std::vector<std::string> frameNames;
+  frameNames.reserve(1 + this->dataPtr->links.size() +
+      this->dataPtr->joints.size() + this->dataPtr->frames.size());
+  frameNames.push_back("__model__");
+  for (auto const &link : this->dataPtr->links)
+  {
+    frameNames.push_back(link.Name());
+  }
+  for (auto const &joint : this->dataPtr->joints)
+  {
+    frameNames.push_back(joint.Name());
+  }
+  for (auto const &frame : this->dataPtr->frames)
+  {
+    frameNames.push_back(frame.Name());
+  }
+
+  return resolvePoses(_poses, *this->dataPtr->poseGraph, frameNames,
+      _relativeTo.empty() ? "__model__" : _relativeTo);
 }
 
 /////////////////////////////////////////////////
-const Link *Model::LinkByName(const std::string &_name) const
+Errors Model::ResolveJointAxes(std::vector<ignition::math::Vector3d> &_axes,
+    const std::string &_resolveTo) const
 {
-  for (auto const &l : this->dataPtr->links)
+  Errors errors;
+
+  if (!this->dataPtr->poseGraph)
+  {
+    errors.push_back({ErrorCode::ELEMENT_INVALID,
+        "Model has invalid pointer to PoseRelativeToGraph."});
+    return errors;
+  }
+
+  // The xyz of an axis is expressed in the joint frame unless it names
+  // another frame, as in JointAxis::ResolveXyz.
+  const auto &joints = this->dataPtr->joints;
+  std::vector<std::string> frameNames;
+  std::vector<const JointAxis *> axes;
+  frameNames.reserve(2 * joints.size());
+  axes.reserve(2 * joints.size());
+  for (const auto &joint : joints)
   {
-    if (l.Name() == _name)
+    for (uint64_t i = 0; i < 2; ++i)
     {
-      return &l;
+      const JointAxis *axis = joint.Axis(i);
+      axes.push_back(axis);
+      if (axis)
+      {
+        frameNames.push_back(axis->XyzExpressedIn().empty() ?
+            joint.Name() : axis->XyzExpressedIn());
+      }
     }
   }
-  return nullptr;
+
+  std::vector<ignition::math::Pose3d> poses;
+  errors = resolvePoses(poses, *this->dataPtr->poseGraph, frameNames,
+      _resolveTo.empty() ? "__model__" : _resolveTo);
+  if (!errors.empty())
+    return errors;
+
+  _axes.assign(axes.size(), ignition::math::Vector3d::Zero);
+  auto pose = poses.begin();
+  for (std::size_t a = 0; a < axes.size(); ++a)
+  {
+    if (axes[a])
+      _axes[a] = (pose++)->Rot() * axes[a]->Xyz();
+  }
+  return errors;
+}
+
+/////////////////////////////////////////////////
+const sdf::KinematicTree &Model::KinematicTree() const
+{
+  return this->dataPtr->kinematicTree;
+}
+
+/////////////////////////////////////////////////
+/// \brief Find the pairs of links at most a number of joints apart.
+/// \param[in] _tree Tree of the links and joints.
+/// \param[in] _hops Largest number of joints between two links of a pair.
+/// \param[out] _exclusions The exclusions, whose pairs are filled.
+static void buildExclusionPairs(const sdf::KinematicTree &_tree,
+    const uint64_t _hops, sdf::SelfCollisionExclusions &_exclusions)
+{
+  const std::size_t linkCount = _tree.parentJoints.size();
+
+  // Links adjacent to each link through a joint, including the joints that
+  // close loops, grouped by link with a counting sort.
+  std::vector<uint64_t> offsets(linkCount + 1, 0);
+  for (std::size_t j = 0; j < _tree.jointParents.size(); ++j)
+  {
+    const int64_t parent = _tree.jointParents[j];
+    const int64_t child = _tree.jointChildren[j];
+    if (parent >= 0 && child >= 0 && parent != child)
+    {
+      ++offsets[parent + 1];
+      ++offsets[child + 1];
+    }
+  }
+  for (std::size_t l = 0; l < linkCount; ++l)
+    offsets[l + 1] += offsets[l];
+  std::vector<uint64_t> neighbors(offsets[linkCount]);
+  std::vector<uint64_t> next(offsets.begin(), offsets.end() - 1);
+  for (std::size_t j = 0; j < _tree.jointParents.size(); ++j)
+  {
+    const int64_t parent = _tree.jointParents[j];
+    const int64_t child = _tree.jointChildren[j];
+    if (parent >= 0 && child >= 0 && parent != child)
+    {
+      neighbors[next[parent]++] = child;
+      neighbors[next[child]++] = parent;
+    }
+  }
+
+  // Breadth-first search of the links within _hops joints of each link,
+  // keeping the greater ones. The visit marks hold the link the search
+  // started from, so they are not cleared between searches.
+  std::vector<uint64_t> visited(linkCount, linkCount);
+  std::vector<uint64_t> frontier;
+  std::vector<uint64_t> nextFrontier;
+  std::vector<uint64_t> found;
+  for (std::size_t l = 0; l < linkCount; ++l)
+  {
+    visited[l] = l;
+    frontier.assign(1, l);
+    found.clear();
+    for (uint64_t hop = 0; hop < _hops && !frontier.empty(); ++hop)
+    {
+      nextFrontier.clear();
+      for (const uint64_t link : frontier)
+      {
+        for (uint64_t n = offsets[link]; n < offsets[link + 1]; ++n)
+        {
+          const uint64_t neighbor = neighbors[n];
+          if (visited[neighbor] == l)
+            continue;
+          visited[neighbor] = l;
+          nextFrontier.push_back(neighbor);
+          if (neighbor > l)
+            found.push_back(neighbor);
+        }
+      }
+      frontier.swap(nextFrontier);
+    }
+    std::sort(found.begin(), found.end());
+    for (const uint64_t link : found)
+    {
+      _exclusions.firstLinks.push_back(l);
+      _exclusions.secondLinks.push_back(link);
+    }
+  }
+}
+
+/////////////////////////////////////////////////
+std::shared_ptr<const sdf::SelfCollisionExclusions>
+    Model::SelfCollisionExclusions(const uint64_t _hops) const
+{
+  // The exclusions only depend on the joints between the links, so models
+  // with the same key share them.
+  const sdf::KinematicTree &tree = this->dataPtr->kinematicTree;
+  const uint64_t header[] = {
+      _hops, this->SelfCollide() ? 1u : 0u,
+      static_cast<uint64_t>(tree.parentJoints.size())};
+  std::string key(reinterpret_cast<const char *>(header), sizeof(header));
+  key.append(reinterpret_cast<const char *>(tree.jointParents.data()),
+      tree.jointParents.size() * sizeof(int64_t));
+  key.append(reinterpret_cast<const char *>(tree.jointChildren.data()),
+      tree.jointChildren.size() * sizeof(int64_t));
+
+  std::lock_guard<std::mutex> lock(g_sharedExclusionsMutex);
+  auto it = g_sharedExclusions.find(key);
+  if (it != g_sharedExclusions.end())
+  {
+    if (auto exclusions = it->second.lock())
+      return exclusions;
+  }
+
+  auto exclusions = std::make_shared<sdf::SelfCollisionExclusions>();
+  exclusions->linkCount = tree.parentJoints.size();
+  exclusions->selfCollide = this->SelfCollide();
+  buildExclusionPairs(tree, _hops, *exclusions);
+
+  // Remove the exclusions that are no longer used when the number of
+  // entries doubles, as for g_sharedFrameGraphs.
+  if (g_sharedExclusions.size() >= 2 * g_sharedExclusionsCleanSize)
+  {
+    for (auto entry = g_sharedExclusions.begin();
+         entry != g_sharedExclusions.end();)
+    {
+      if (entry->second.expired())
+        entry = g_sharedExclusions.erase(entry);
+      else
+        ++entry;
+    }
+    g_sharedExclusionsCleanSize = g_sharedExclusions.size();
+  }
+  g_sharedExclusions[key] = exclusions;
+  return exclusions;
+}
+
+/////////////////////////////////////////////////
+Errors Model::ResolveKinematics(ModelKinematics &_kinematics) const
+{
+  std::vector<ignition::math::Pose3d> poses;
+  Errors errors = this->ResolveFramePoses(poses);
+  if (!errors.empty())
+    return errors;
+
+  const auto &links = this->dataPtr->links;
+  const auto &joints = this->dataPtr->joints;
+  const int64_t linkCount = static_cast<int64_t>(links.size());
+  const int64_t jointCount = static_cast<int64_t>(joints.size());
+
+  const sdf::KinematicTree &tree = this->dataPtr->kinematicTree;
+  const std::vector<int64_t> &parentJoint = tree.parentJoints;
+  const std::vector<int64_t> &jointParent = tree.jointParents;
+  const std::vector<int64_t> &jointChild = tree.jointChildren;
+  const std::vector<uint64_t> &order = tree.linkOrder;
+  std::vector<int64_t> position(links.size(), -1);
+  for (std::size_t p = 0; p < order.size(); ++p)
+    position[order[p]] = static_cast<int64_t>(p);
+
+  // Joints in the order of their child link, then the joints closing loops.
+  std::vector<int64_t> jointOrder;
+  std::vector<int64_t> jointPosition(joints.size(), -1);
+  jointOrder.reserve(joints.size());
+  for (const uint64_t l : order)
+  {
+    if (parentJoint[l] >= 0)
+    {
+      jointPosition[parentJoint[l]] = static_cast<int64_t>(jointOrder.size());
+      jointOrder.push_back(parentJoint[l]);
+    }
+  }
+  for (int64_t j = 0; j < jointCount; ++j)
+  {
+    if (jointPosition[j] < 0)
+    {
+      jointPosition[j] = static_cast<int64_t>(jointOrder.size());
+      jointOrder.push_back(j);
+    }
+  }
+
+  ModelKinematics kin;
+  kin.linkIndices.reserve(links.size());
+  kin.linkParents.reserve(links.size());
+  kin.linkJoints.reserve(links.size());
+  kin.linkPoses.reserve(links.size());
+  kin.masses.reserve(links.size());
+  kin.inertias.reserve(links.size());
+  kin.inertialPoses.reserve(links.size());
+  for (const uint64_t l : order)
+  {
+    const ignition::math::Inertiald &inertial = links[l].Inertial();
+    const int64_t joint = parentJoint[l];
+    const int64_t parent = joint < 0 ? -1 : jointParent[joint];
+    kin.linkIndices.push_back(l);
+    kin.linkParents.push_back(parent < 0 ? -1 : position[parent]);
+    kin.linkJoints.push_back(joint < 0 ? -1 : jointPosition[joint]);
+    kin.linkPoses.push_back(poses[1 + l]);
+    kin.masses.push_back(inertial.MassMatrix().Mass());
+    kin.inertias.push_back(inertial.MassMatrix().Moi());
+    kin.inertialPoses.push_back(inertial.Pose());
+  }
+
+  const JointAxis defaultAxis;
+  kin.jointIndices.reserve(joints.size());
+  kin.jointTypes.reserve(joints.size());
+  kin.jointParents.reserve(joints.size());
+  kin.jointChildren.reserve(joints.size());
+  kin.jointPoses.reserve(joints.size());
+  kin.axes.reserve(joints.size());
+  kin.lowerLimits.reserve(joints.size());
+  kin.upperLimits.reserve(joints.size());
+  kin.effortLimits.reserve(joints.size());
+  kin.velocityLimits.reserve(joints.size());
+  for (const int64_t j : jointOrder)
+  {
+    const Joint &joint = joints[j];
+    const JointAxis *axis = joint.Axis(0);
+    ignition::math::Vector3d xyz = ignition::math::Vector3d::Zero;
+    if (axis)
+    {
+      Errors axisErrors = axis->ResolveXyz(xyz);
+      errors.insert(errors.end(), axisErrors.begin(), axisErrors.end());
+    }
+    else
+    {
+      axis = &defaultAxis;
+    }
+
+    kin.jointIndices.push_back(static_cast<uint64_t>(j));
+    kin.jointTypes.push_back(joint.Type());
+    kin.jointParents.push_back(
+        jointParent[j] < 0 ? -1 : position[jointParent[j]]);
+    kin.jointChildren.push_back(
+        jointChild[j] < 0 ? -1 : position[jointChild[j]]);
+    kin.jointPoses.push_back(poses[1 + linkCount + j]);
+    kin.axes.push_back(xyz);
+    kin.lowerLimits.push_back(axis->Lower());
+    kin.upperLimits.push_back(axis->Upper());
+    kin.effortLimits.push_back(axis->Effort());
+    kin.velocityLimits.push_back(axis->MaxVelocity());
+  }
+
+  if (errors.empty())
+    _kinematics = std::move(kin);
+  return errors;
+}
+
+/////////////////////////////////////////////////
+Errors Model::ResolveMassProperties(ModelMassProperties &_properties) const
+{
+  std::vector<ignition::math::Pose3d> poses;
+  Errors errors = this->ResolveFramePoses(poses);
+  if (!errors.empty())
+    return errors;
+
+  // The moments of each link about the model origin: mass, first moment and
+  // the six components of the inertia matrix, one array each. They add up
+  // over subtrees, and are converted to the center of mass at the end.
+  const auto &links = this->dataPtr->links;
+  const std::size_t linkCount = links.size();
+  std::vector<double> m(linkCount), mx(linkCount), my(linkCount),
+      mz(linkCount), ixx(linkCount), iyy(linkCount), izz(linkCount),
+      ixy(linkCount), ixz(linkCount), iyz(linkCount);
+  for (std::size_t l = 0; l < linkCount; ++l)
+  {
+    const ignition::math::Inertiald &inertial = links[l].Inertial();
+    const ignition::math::Pose3d pose = poses[1 + l] * inertial.Pose();
+    const ignition::math::Matrix3d rot(pose.Rot());
+    const ignition::math::Matrix3d moi =
+        rot * inertial.MassMatrix().Moi() * rot.Transposed();
+    const double mass = inertial.MassMatrix().Mass();
+    const ignition::math::Vector3d &c = pose.Pos();
+    m[l] = mass;
+    mx[l] = mass * c.X();
+    my[l] = mass * c.Y();
+    mz[l] = mass * c.Z();
+    ixx[l] = moi(0, 0) + mass * (c.Y() * c.Y() + c.Z() * c.Z());
+    iyy[l] = moi(1, 1) + mass * (c.X() * c.X() + c.Z() * c.Z());
+    izz[l] = moi(2, 2) + mass * (c.X() * c.X() + c.Y() * c.Y());
+    ixy[l] = moi(0, 1) - mass * c.X() * c.Y();
+    ixz[l] = moi(0, 2) - mass * c.X() * c.Z();
+    iyz[l] = moi(1, 2) - mass * c.Y() * c.Z();
+  }
+
+  // Convert moments about the origin to a center of mass and an inertia
+  // about it, with the parallel axis theorem.
+  auto toCenter = [](double _m, double _mx, double _my, double _mz,
+      double _ixx, double _iyy, double _izz, double _ixy, double _ixz,
+      double _iyz, ignition::math::Vector3d &_center,
+      ignition::math::Matrix3d &_inertia)
+  {
+    _center = ignition::math::Vector3d::Zero;
+    if (_m > 0)
+      _center.Set(_mx / _m, _my / _m, _mz / _m);
+    const double x = _center.X();
+    const double y = _center.Y();
+    const double z = _center.Z();
+    const double xy = _ixy + _m * x * y;
+    const double xz = _ixz + _m * x * z;
+    const double yz = _iyz + _m * y * z;
+    _inertia = ignition::math::Matrix3d(
+        _ixx - _m * (y * y + z * z), xy, xz,
+        xy, _iyy - _m * (x * x + z * z), yz,
+        xz, yz, _izz - _m * (x * x + y * y));
+  };
+
+  ModelMassProperties props;
+  double sums[10] = {0};
+  for (std::size_t l = 0; l < linkCount; ++l)
+  {
+    sums[0] += m[l];
+    sums[1] += mx[l];
+    sums[2] += my[l];
+    sums[3] += mz[l];
+    sums[4] += ixx[l];
+    sums[5] += iyy[l];
+    sums[6] += izz[l];
+    sums[7] += ixy[l];
+    sums[8] += ixz[l];
+    sums[9] += iyz[l];
+  }
+  props.mass = sums[0];
+  toCenter(sums[0], sums[1], sums[2], sums[3], sums[4], sums[5], sums[6],
+      sums[7], sums[8], sums[9], props.centerOfMass, props.inertia);
+
+  // Add each subtree to the subtree of its parent link, children first.
+  const sdf::KinematicTree &tree = this->dataPtr->kinematicTree;
+  for (std::size_t p = linkCount; p-- > 0;)
+  {
+    const uint64_t l = tree.linkOrder[p];
+    const int64_t parent = tree.parentLinks[l];
+    if (parent < 0 || tree.depths[l] < 0)
+      continue;
+    m[parent] += m[l];
+    mx[parent] += mx[l];
+    my[parent] += my[l];
+    mz[parent] += mz[l];
+    ixx[parent] += ixx[l];
+    iyy[parent] += iyy[l];
+    izz[parent] += izz[l];
+    ixy[parent] += ixy[l];
+    ixz[parent] += ixz[l];
+    iyz[parent] += iyz[l];
+  }
+
+  props.subtreeMasses = m;
+  props.subtreeCentersOfMass.resize(linkCount);
+  props.subtreeInertias.resize(linkCount);
+  for (std::size_t l = 0; l < linkCount; ++l)
+  {
+    toCenter(m[l], mx[l], my[l], mz[l], ixx[l], iyy[l], izz[l], ixy[l],
+        ixz[l], iyz[l], props.subtreeCentersOfMass[l],
+        props.subtreeInertias[l]);
+  }
+
+  _properties = std::move(props);
+  return errors;
+}
+
+/////////////////////////////////////////////////
+Errors Model::ResolveCollisionGeometry(CollisionGeometry &_geometry) const
+{
+  Errors errors;
+  CollisionGeometry geometry;
+  const auto &links = this->dataPtr->links;
+  for (std::size_t l = 0; l < links.size(); ++l)
+  {
+    CollisionGeometry linkGeometry;
+    Errors linkErrors = links[l].ResolveCollisionGeometry(linkGeometry);
+    if (!linkErrors.empty())
+    {
+      errors.insert(errors.end(), linkErrors.begin(), linkErrors.end());
+      continue;
+    }
+
+    auto append = [](auto &_to, auto &_from)
+    {
+      _to.insert(_to.end(), std::make_move_iterator(_from.begin()),
+          std::make_move_iterator(_from.end()));
+    };
+    geometry.linkIndices.insert(geometry.linkIndices.end(),
+        linkGeometry.collisionIndices.size(), l);
+    append(geometry.collisionIndices, linkGeometry.collisionIndices);
+    append(geometry.types, linkGeometry.types);
+    append(geometry.poses, linkGeometry.poses);
+    append(geometry.minCorners, linkGeometry.minCorners);
+    append(geometry.maxCorners, linkGeometry.maxCorners);
+    append(geometry.volumes, linkGeometry.volumes);
+    append(geometry.inertias, linkGeometry.inertias);
+  }
+  if (!errors.empty())
+    return errors;
+
+  _geometry = std::move(geometry);
+  return errors;
+}
+
+/////////////////////////////////////////////////
+void Model::ResolveCollisionFilter(CollisionFilter &_filter) const
+{
+  CollisionFilterBuilder builder;
+  const auto &links = this->dataPtr->links;
+  for (std::size_t l = 0; l < links.size(); ++l)
+  {
+    for (uint64_t c = 0; c < links[l].CollisionCount(); ++c)
+    {
+      const Contact *contact =
+          links[l].CollisionByIndex(c)->Surface()->Contact();
+      builder.Add(0, l, c, contact->CategoryBitmask(),
+          contact->CollideBitmask());
+    }
+  }
+  builder.Finish(_filter);
+}
+
+/////////////////////////////////////////////////
+void Model::ResolveSurfaceMaterials(SurfaceMaterials &_materials) const
+{
+  SurfaceMaterialBuilder builder;
+  const auto &links = this->dataPtr->links;
+  for (std::size_t l = 0; l < links.size(); ++l)
+  {
+    for (uint64_t c = 0; c < links[l].CollisionCount(); ++c)
+    {
+      builder.Add(0, l, c,
+          links[l].CollisionByIndex(c)->Surface()->Parameters());
+    }
+  }
+  builder.Finish(_materials);
+}
+
+/////////////////////////////////////////////////
+Errors Model::ResolveRenderBatches(RenderBatches &_batches) const
+{
+  std::vector<ignition::math::Pose3d> framePoses;
+  Errors errors = this->ResolveFramePoses(framePoses);
+  if (!errors.empty())
+    return errors;
+
+  RenderBatchBuilder builder;
+  const auto &links = this->dataPtr->links;
+  for (std::size_t l = 0; l < links.size(); ++l)
+  {
+    for (uint64_t v = 0; v < links[l].VisualCount(); ++v)
+    {
+      // Poses expressed in the link frame, which is the default, do not
+      // need the pose graph.
+      const Visual *visual = links[l].VisualByIndex(v);
+      ignition::math::Pose3d pose = visual->RawPose();
+      if (!visual->PoseRelativeTo().empty())
+      {
+        Errors poseErrors = visual->SemanticPose().Resolve(pose);
+        if (!poseErrors.empty())
+        {
+          errors.insert(errors.end(), poseErrors.begin(), poseErrors.end());
+          continue;
+        }
+      }
+      builder.Add(0, l, v, *visual, framePoses[1 + l] * pose);
+    }
+  }
+  if (!errors.empty())
+    return errors;
+
+  builder.Finish(_batches);
+  return errors;
+}
+
+/////////////////////////////////////////////////
+Errors Model::UpdateFramePose(const std::string &_name,
+    const ignition::math::Pose3d &_pose, const std::string &_relativeTo)
+{
+  Errors errors;
+
+  if (!this->dataPtr->poseGraph)
+  {
+    errors.push_back({ErrorCode::ELEMENT_INVALID,
+        "Model has invalid pointer to PoseRelativeToGraph."});
+    return errors;
+  }
+
+  Link *link = this->dataPtr->linkIndex.Find(this->dataPtr->links, _name);
+  Joint *joint = nullptr;
+  Frame *frame = nullptr;
+  if (!link)
+    joint = this->dataPtr->jointIndex.Find(this->dataPtr->joints, _name);
+  if (!link && !joint)
+    frame = this->dataPtr->frameIndex.Find(this->dataPtr->frames, _name);
+
+  // Use the same default relative_to frames as buildPoseRelativeToGraph.
+  std::string relativeTo = _relativeTo;
+  if (link)
+  {
+    if (relativeTo.empty())
+      relativeTo = "__model__";
+  }
+  else if (joint)
+  {
+    if (relativeTo.empty())
+      relativeTo = joint->ChildLinkName();
+  }
+  else if (frame)
+  {
+    if (relativeTo.empty())
+      relativeTo = frame->AttachedTo().empty() ? "__model__" :
+          frame->AttachedTo();
+  }
+  else
+  {
+    errors.push_back({ErrorCode::POSE_RELATIVE_TO_INVALID,
+        "No link, joint or frame with name[" + _name +
+        "] in model with name[" + this->Name() + "]."});
+    return errors;
+  }
+
+  // Update a copy of the pose graph if it can be shared with other models.
+  auto poseGraph = this->dataPtr->poseGraph;
+  if (this->dataPtr->poseGraphShared)
+  {
+    poseGraph = std::make_shared<PoseRelativeToGraph>(*poseGraph);
+  }
+
+  errors = updatePoseRelativeToGraph(*poseGraph, _name, relativeTo, _pose);
+  if (!errors.empty())
+  {
+    return errors;
+  }
+
+  if (this->dataPtr->poseGraphShared)
+  {
+    // The Frame Attached-To Graph is not changed, so it stays shared until
+    // a frame is added to it.
+    this->dataPtr->poseGraph = poseGraph;
+    this->dataPtr->poseGraphShared = false;
+    this->SetChildGraphs();
+  }
+
+  if (link)
+  {
+    link->SetRawPose(_pose);
+    link->SetPoseRelativeTo(_relativeTo);
+  }
+  else if (joint)
+  {
+    joint->SetRawPose(_pose);
+    joint->SetPoseRelativeTo(_relativeTo);
+  }
+  else
+  {
+    frame->SetRawPose(_pose);
+    frame->SetPoseRelativeTo(_relativeTo);
+  }
+
+  return errors;
+}
+
+/////////////////////////////////////////////////
+const Link *Model::LinkByName(std::string_view _name) const
+{
+  return this->dataPtr->linkIndex.Find(this->dataPtr->links, _name);
 }
 
 /////////////////////////////////////////////////
@@ -635,3 +1681,32 @@ sdf::ElementPtr Model::Element() const
 {
   return this->dataPtr->sdf;
 }
+
+/////////////////////////////////////////////////
+void Model::SetChildGraphs()
+{
+  for (auto &link : this->dataPtr->links)
+  {
+    link.SetPoseRelativeToGraph(this->dataPtr->poseGraph);
+  }
+  for (auto &joint : this->dataPtr->joints)
+  {
+    joint.SetPoseRelativeToGraph(this->dataPtr->poseGraph);
+  }
+  for (auto &frame : this->dataPtr->frames)
+  {
+    frame.SetFrameAttachedToGraph(this->dataPtr->frameAttachedToGraph);
+    frame.SetPoseRelativeToGraph(this->dataPtr->poseGraph);
+  }
+}
+
+/////////////////////////////////////////////////
+std::size_t Model::Compact()
+{
+  std::size_t bytes = shrinkToFit(this->dataPtr->links) +
+      shrinkToFit(this->dataPtr->joints) +
+      shrinkToFit(this->dataPtr->frames);
+  for (Link &link : this->dataPtr->links)
+    bytes += link.Compact();
+  return bytes;
+}
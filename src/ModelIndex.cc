@@ -0,0 +1,373 @@
+/*
+ * Copyright 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <algorithm>
+#include <cstddef>
+#include <ctime>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "sdf/Console.hh"
+#include "sdf/Filesystem.hh"
+#include "sdf/ModelIndex.hh"
+#include "Utils.hh"
+
+using namespace sdf;
+
+/// \brief First line of an index file, which identifies its format.
+static const char kModelIndexHeader[] = "sdformat-model-index 1";
+
+/// \brief A model of a model repository.
+struct ModelIndexEntry
+{
+  /// \brief Path of the model directory.
+  std::string directory;
+
+  /// \brief Modification time of the directory when it was indexed.
+  std::time_t directoryTime;
+
+  /// \brief Path of the config file the model file was chosen from.
+  std::string configPath;
+
+  /// \brief Modification time of the config file when it was indexed.
+  std::time_t configTime;
+
+  /// \brief Path of the model file.
+  std::string modelFile;
+};
+
+/// \brief A root directory of a model repository and its models.
+struct ModelIndexRoot
+{
+  /// \brief Path of the root directory.
+  std::string path;
+
+  /// \brief Modification time of the root directory when it was scanned.
+  std::time_t writeTime;
+
+  /// \brief The models, sorted by directory.
+  std::vector<ModelIndexEntry> models;
+};
+
+/// \brief Private data for ModelIndex.
+class sdf::ModelIndexPrivate
+{
+  /// \brief Replace the roots and index their models.
+  /// \param[in] _roots The new roots.
+  public: void Reset(std::vector<ModelIndexRoot> &&_roots)
+  {
+    std::unordered_map<std::string, std::string> newDirectories;
+    std::unordered_map<std::string, std::string> newModelFiles;
+    for (const ModelIndexRoot &root : _roots)
+    {
+      for (const ModelIndexEntry &model : root.models)
+      {
+        newDirectories.emplace(filesystem::basename(model.directory),
+            model.directory);
+        newModelFiles.emplace(model.directory, model.modelFile);
+      }
+    }
+
+    std::lock_guard<std::mutex> lock(this->mutex);
+    this->roots = std::move(_roots);
+    this->directories = std::move(newDirectories);
+    this->modelFiles = std::move(newModelFiles);
+  }
+
+  /// \brief The roots, in the order of precedence.
+  public: std::vector<ModelIndexRoot> roots;
+
+  /// \brief Model directories, by model name.
+  public: std::unordered_map<std::string, std::string> directories;
+
+  /// \brief Model files, by model directory.
+  public: std::unordered_map<std::string, std::string> modelFiles;
+
+  /// \brief Mutex that protects roots, directories and modelFiles.
+  public: mutable std::mutex mutex;
+};
+
+/////////////////////////////////////////////////
+/// \brief Read the model of a directory.
+/// \param[in] _directory Path of the directory.
+/// \param[out] _entry The model.
+/// \return False if the directory is not a model.
+static bool readModelEntry(const std::string &_directory,
+    ModelIndexEntry &_entry)
+{
+  const filesystem::file_status directoryStatus =
+      filesystem::status(_directory);
+  if (!directoryStatus.is_directory())
+    return false;
+
+  std::string configPath = filesystem::append(_directory, "model.config");
+  filesystem::file_status configStatus = filesystem::status(configPath);
+  if (!configStatus.exists())
+  {
+    configPath = filesystem::append(_directory, "manifest.xml");
+    configStatus = filesystem::status(configPath);
+    if (!configStatus.exists())
+      return false;
+  }
+
+  _entry.modelFile = readModelFilePath(_directory);
+  if (_entry.modelFile.empty())
+    return false;
+  _entry.directory = _directory;
+  _entry.directoryTime = directoryStatus.write_time;
+  _entry.configPath = configPath;
+  _entry.configTime = configStatus.write_time;
+  return true;
+}
+
+/////////////////////////////////////////////////
+/// \brief Scan roots again, replacing their models.
+/// \param[in,out] _roots The roots.
+/// \param[in] _indices Indices of the roots to scan.
+/// \param[in] _threadCount Maximum number of threads.
+static void scanRoots(std::vector<ModelIndexRoot> &_roots,
+    const std::vector<std::size_t> &_indices, unsigned int _threadCount)
+{
+  // List the subdirectories of the roots, which are the candidate models.
+  std::vector<std::vector<std::string>> candidates(_indices.size());
+  parallelFor(_indices.size(), _threadCount, [&](std::size_t _i)
+  {
+    ModelIndexRoot &root = _roots[_indices[_i]];
+    root.models.clear();
+    root.writeTime = filesystem::last_write_time(root.path);
+    filesystem::DirIter endIter;
+    for (filesystem::DirIter dirIter(root.path); dirIter != endIter;
+         ++dirIter)
+    {
+      candidates[_i].push_back(*dirIter);
+    }
+    std::sort(candidates[_i].begin(), candidates[_i].end());
+  });
+
+  // Read the configs of all the candidates at once.
+  std::vector<std::pair<std::size_t, std::string>> directories;
+  for (std::size_t i = 0; i < _indices.size(); ++i)
+  {
+    for (std::string &candidate : candidates[i])
+      directories.emplace_back(_indices[i], std::move(candidate));
+  }
+  std::vector<ModelIndexEntry> entries(directories.size());
+  std::vector<char> found(directories.size(), 0);
+  parallelFor(directories.size(), _threadCount, [&](std::size_t _i)
+  {
+    found[_i] = readModelEntry(directories[_i].second, entries[_i]);
+  });
+
+  for (std::size_t i = 0; i < directories.size(); ++i)
+  {
+    if (found[i])
+      _roots[directories[i].first].models.push_back(std::move(entries[i]));
+  }
+}
+
+/////////////////////////////////////////////////
+ModelIndex::ModelIndex()
+  : dataPtr(new ModelIndexPrivate)
+{
+}
+
+/////////////////////////////////////////////////
+ModelIndex::~ModelIndex()
+{
+  delete this->dataPtr;
+  this->dataPtr = nullptr;
+}
+
+/////////////////////////////////////////////////
+void ModelIndex::Scan(const std::vector<std::string> &_roots,
+    unsigned int _threadCount)
+{
+  std::vector<ModelIndexRoot> roots;
+  std::vector<std::size_t> indices;
+  for (const std::string &path : _roots)
+  {
+    if (!filesystem::is_directory(path))
+      continue;
+    indices.push_back(roots.size());
+    roots.push_back({path, 0, {}});
+  }
+
+  scanRoots(roots, indices, _threadCount);
+  this->dataPtr->Reset(std::move(roots));
+}
+
+/////////////////////////////////////////////////
+bool ModelIndex::Load(const std::string &_filename,
+    unsigned int _threadCount)
+{
+  std::ifstream in(_filename);
+  std::string line;
+  if (!in || !std::getline(in, line) || line != kModelIndexHeader)
+    return false;
+
+  std::vector<ModelIndexRoot> roots;
+  while (std::getline(in, line))
+  {
+    std::istringstream rootLine(line);
+    std::string keyword;
+    std::size_t modelCount = 0;
+    ModelIndexRoot root;
+    if (!(rootLine >> keyword >> root.writeTime >> modelCount) ||
+        keyword != "root" || !std::getline(in, root.path))
+    {
+      return false;
+    }
+
+    for (std::size_t i = 0; i < modelCount; ++i)
+    {
+      ModelIndexEntry model;
+      if (!std::getline(in, line))
+        return false;
+      std::istringstream modelLine(line);
+      if (!(modelLine >> keyword >> model.directoryTime >> model.configTime)
+          || keyword != "model" || !std::getline(in, model.directory) ||
+          !std::getline(in, model.configPath) ||
+          !std::getline(in, model.modelFile))
+      {
+        return false;
+      }
+      root.models.push_back(std::move(model));
+    }
+    roots.push_back(std::move(root));
+  }
+
+  // Roots whose directory changed are scanned again, since models may have
+  // been added or removed. In the other roots, the models whose directory
+  // or config changed are read again.
+  std::vector<std::size_t> changedRoots;
+  std::vector<std::pair<std::size_t, std::size_t>> models;
+  for (std::size_t i = 0; i < roots.size(); ++i)
+  {
+    if (filesystem::last_write_time(roots[i].path) != roots[i].writeTime)
+    {
+      changedRoots.push_back(i);
+      continue;
+    }
+    for (std::size_t j = 0; j < roots[i].models.size(); ++j)
+      models.emplace_back(i, j);
+  }
+
+  std::vector<char> valid(models.size(), 1);
+  parallelFor(models.size(), _threadCount, [&](std::size_t _i)
+  {
+    ModelIndexEntry &model = roots[models[_i].first].models[models[_i].second];
+    if (filesystem::last_write_time(model.directory) != model.directoryTime ||
+        filesystem::last_write_time(model.configPath) != model.configTime)
+    {
+      ModelIndexEntry entry;
+      valid[_i] = readModelEntry(model.directory, entry);
+      model = std::move(entry);
+    }
+  });
+  for (std::size_t i = models.size(); i-- > 0;)
+  {
+    if (!valid[i])
+    {
+      auto &rootModels = roots[models[i].first].models;
+      rootModels.erase(rootModels.begin() +
+          static_cast<std::ptrdiff_t>(models[i].second));
+    }
+  }
+
+  scanRoots(roots, changedRoots, _threadCount);
+
+  // Roots that no longer exist are kept without models, so that they are
+  // scanned again once they exist.
+  this->dataPtr->Reset(std::move(roots));
+  return true;
+}
+
+/////////////////////////////////////////////////
+bool ModelIndex::Save(const std::string &_filename) const
+{
+  std::ostringstream data;
+  data << kModelIndexHeader << '\n';
+  {
+    std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+    for (const ModelIndexRoot &root : this->dataPtr->roots)
+    {
+      data << "root " << root.writeTime << ' ' << root.models.size() << '\n'
+           << root.path << '\n';
+      for (const ModelIndexEntry &model : root.models)
+      {
+        data << "model " << model.directoryTime << ' ' << model.configTime
+             << '\n' << model.directory << '\n' << model.configPath << '\n'
+             << model.modelFile << '\n';
+      }
+    }
+  }
+
+  // Concurrent readers never see a partial index.
+  const std::string str = data.str();
+  if (!replaceFile(_filename, [&str](const std::string &_tmpPath)
+      {
+        std::ofstream out(_tmpPath, std::ios::binary);
+        out.write(str.data(), static_cast<std::streamsize>(str.size()));
+        out.close();
+        return static_cast<bool>(out);
+      }))
+  {
+    sdferr << "Unable to write model index[" << _filename << "].\n";
+    return false;
+  }
+  return true;
+}
+
+/////////////////////////////////////////////////
+std::string ModelIndex::FindModelDirectory(const std::string &_name) const
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  auto iter = this->dataPtr->directories.find(_name);
+  return iter != this->dataPtr->directories.end() ?
+      iter->second : std::string();
+}
+
+/////////////////////////////////////////////////
+std::string ModelIndex::FindModelFile(const std::string &_modelDirPath) const
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  auto iter = this->dataPtr->modelFiles.find(_modelDirPath);
+  return iter != this->dataPtr->modelFiles.end() ?
+      iter->second : std::string();
+}
+
+/////////////////////////////////////////////////
+std::vector<std::string> ModelIndex::Roots() const
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  std::vector<std::string> result;
+  for (const ModelIndexRoot &root : this->dataPtr->roots)
+    result.push_back(root.path);
+  return result;
+}
+
+/////////////////////////////////////////////////
+std::size_t ModelIndex::Size() const
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  return this->dataPtr->modelFiles.size();
+}
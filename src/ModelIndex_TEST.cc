@@ -0,0 +1,134 @@
+/*
+ * Copyright 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "sdf/Filesystem.hh"
+#include "sdf/ModelIndex.hh"
+#include "sdf/SDFImpl.hh"
+#include "sdf/parser.hh"
+#include "test_config.h"
+
+/// \brief Root directory of the test models.
+static const std::string g_modelsRoot = sdf::filesystem::append(
+    PROJECT_SOURCE_PATH, "test", "integration", "model");
+
+/////////////////////////////////////////////////
+/// \brief Check that an index holds the test models.
+/// \param[in] _index The index.
+void expectTestModels(const sdf::ModelIndex &_index)
+{
+  EXPECT_EQ(std::vector<std::string>{g_modelsRoot}, _index.Roots());
+
+  const std::string boxDir = sdf::filesystem::append(g_modelsRoot, "box");
+  EXPECT_EQ(boxDir, _index.FindModelDirectory("box"));
+  EXPECT_EQ(sdf::filesystem::append(boxDir, "model.sdf"),
+      _index.FindModelFile(boxDir));
+  EXPECT_NE("", _index.FindModelDirectory("test_model"));
+
+  // Files, and directories with an invalid config, are not models.
+  EXPECT_EQ("", _index.FindModelDirectory("double_pendulum.sdf"));
+  EXPECT_EQ("", _index.FindModelDirectory("cococan_malformed"));
+  EXPECT_EQ("", _index.FindModelFile(g_modelsRoot));
+}
+
+/////////////////////////////////////////////////
+TEST(ModelIndex, Scan)
+{
+  sdf::ModelIndex index;
+  EXPECT_EQ(0u, index.Size());
+  EXPECT_EQ("", index.FindModelDirectory("box"));
+
+  index.Scan({g_modelsRoot, "/this/dir/does/not/exist"}, 4);
+  expectTestModels(index);
+  EXPECT_LT(1u, index.Size());
+
+  index.Scan({});
+  EXPECT_EQ(0u, index.Size());
+  EXPECT_TRUE(index.Roots().empty());
+}
+
+/////////////////////////////////////////////////
+TEST(ModelIndex, SaveLoad)
+{
+  const std::string filename = sdf::filesystem::append(PROJECT_BINARY_DIR,
+      "test", "model_index.txt");
+
+  sdf::ModelIndex index;
+  index.Scan({g_modelsRoot});
+  ASSERT_TRUE(index.Save(filename));
+
+  sdf::ModelIndex loaded;
+  ASSERT_TRUE(loaded.Load(filename));
+  expectTestModels(loaded);
+  EXPECT_EQ(index.Size(), loaded.Size());
+
+  // A root that changed is scanned again.
+  std::string data;
+  {
+    std::ifstream in(filename);
+    std::ostringstream stream;
+    stream << in.rdbuf();
+    data = stream.str();
+  }
+  const std::size_t rootLine = data.find("\nroot ");
+  ASSERT_NE(std::string::npos, rootLine);
+  data.replace(rootLine, data.find(' ', rootLine + 6) - rootLine,
+      "\nroot 0");
+  {
+    std::ofstream out(filename);
+    out << data;
+  }
+  sdf::ModelIndex rescanned;
+  ASSERT_TRUE(rescanned.Load(filename, 2));
+  expectTestModels(rescanned);
+  EXPECT_EQ(index.Size(), rescanned.Size());
+
+  // Files that are not indices are rejected.
+  EXPECT_FALSE(loaded.Load("/this/file/does/not/exist"));
+  EXPECT_FALSE(loaded.Load(
+      sdf::filesystem::append(g_modelsRoot, "box", "model.sdf")));
+  expectTestModels(loaded);
+}
+
+/////////////////////////////////////////////////
+TEST(ModelIndex, FindFile)
+{
+  auto index = std::make_shared<sdf::ModelIndex>();
+  index->Scan({g_modelsRoot});
+  sdf::setModelIndex(index);
+  EXPECT_EQ(index, sdf::modelIndex());
+
+  const std::string boxDir = sdf::filesystem::append(g_modelsRoot, "box");
+  const std::string boxFile = sdf::filesystem::append(boxDir, "model.sdf");
+  EXPECT_EQ(boxDir, sdf::findFile("model://box", false, false));
+  EXPECT_EQ(boxDir, sdf::findFile("model://box/", false, false));
+  EXPECT_EQ(boxFile, sdf::findFile("model://box/model.sdf", false, false));
+  EXPECT_EQ("", sdf::findFile("model://box/missing.sdf", false, false));
+  EXPECT_EQ(boxFile, sdf::getModelFilePath(boxDir));
+
+  sdf::setModelIndex(nullptr);
+  EXPECT_EQ(nullptr, sdf::modelIndex());
+  EXPECT_EQ("", sdf::findFile("model://box", false, false));
+  EXPECT_EQ(boxFile, sdf::getModelFilePath(boxDir));
+}
@@ -0,0 +1,134 @@
+/*
+ * Copyright 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <set>
+#include <string>
+
+#include <tinyxml.h>
+
+#include "sdf/Filesystem.hh"
+#include "sdf/ModelSummary.hh"
+#include "sdf/parser.hh"
+#include "MappedFile.hh"
+
+using namespace sdf;
+
+/////////////////////////////////////////////////
+/// \brief Count the sensors that are children of an element.
+/// \param[in] _xml The element.
+/// \return Number of <sensor> children.
+static uint64_t sensorCount(const TiXmlElement *_xml)
+{
+  uint64_t count = 0;
+  for (const TiXmlElement *sensorXml = _xml->FirstChildElement("sensor");
+       sensorXml; sensorXml = sensorXml->NextSiblingElement("sensor"))
+  {
+    ++count;
+  }
+  return count;
+}
+
+/////////////////////////////////////////////////
+/// \brief Add the children of a <model> element, and of its nested
+/// models, to a summary.
+/// \param[in] _xml The <model> element.
+/// \param[in,out] _summary The summary.
+/// \param[in,out] _uris The URIs already in _summary.includes.
+static void summarizeModel(const TiXmlElement *_xml, ModelSummary &_summary,
+    std::set<std::string> &_uris)
+{
+  for (const TiXmlElement *childXml = _xml->FirstChildElement(); childXml;
+       childXml = childXml->NextSiblingElement())
+  {
+    const std::string &value = childXml->ValueStr();
+    if (value == "link")
+    {
+      ++_summary.linkCount;
+      _summary.sensorCount += sensorCount(childXml);
+    }
+    else if (value == "joint")
+    {
+      ++_summary.jointCount;
+      _summary.sensorCount += sensorCount(childXml);
+    }
+    else if (value == "model")
+    {
+      summarizeModel(childXml, _summary, _uris);
+    }
+    else if (value == "include")
+    {
+      const TiXmlElement *uriXml = childXml->FirstChildElement("uri");
+      if (uriXml && uriXml->GetText() &&
+          _uris.insert(uriXml->GetText()).second)
+      {
+        _summary.includes.push_back(uriXml->GetText());
+      }
+    }
+  }
+}
+
+/////////////////////////////////////////////////
+Errors sdf::peekModel(const std::string &_path, ModelSummary &_summary)
+{
+  Errors errors;
+  _summary = ModelSummary();
+
+  std::string filename = _path;
+  if (filesystem::is_directory(_path))
+  {
+    filename = getModelFilePath(_path);
+    if (filename.empty())
+    {
+      errors.push_back({ErrorCode::FILE_READ,
+          "Unable to find the model file of directory[" + _path + "]."});
+      return errors;
+    }
+  }
+  _summary.filePath = filename;
+
+  TiXmlDocument doc;
+  if (!loadXmlFile(doc, filename))
+  {
+    errors.push_back({ErrorCode::FILE_READ,
+        "Unable to read file[" + filename + "]: " + doc.ErrorDesc()});
+    return errors;
+  }
+
+  const TiXmlElement *sdfXml = doc.FirstChildElement("sdf");
+  if (!sdfXml)
+  {
+    errors.push_back({ErrorCode::ELEMENT_MISSING,
+        "File[" + filename + "] has no <sdf> element."});
+    return errors;
+  }
+  if (const char *version = sdfXml->Attribute("version"))
+    _summary.sdfVersion = version;
+
+  const TiXmlElement *modelXml = sdfXml->FirstChildElement("model");
+  if (!modelXml)
+  {
+    errors.push_back({ErrorCode::ELEMENT_MISSING,
+        "File[" + filename + "] has no <model> element."});
+    return errors;
+  }
+  if (const char *name = modelXml->Attribute("name"))
+    _summary.name = name;
+
+  std::set<std::string> uris;
+  summarizeModel(modelXml, _summary, uris);
+  return errors;
+}
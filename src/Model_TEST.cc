@@ -17,6 +17,7 @@
 
 #include <gtest/gtest.h>
 #include <ignition/math/Pose3.hh>
+#include "sdf/Frame.hh"
 #include "sdf/Joint.hh"
 #include "sdf/Link.hh"
 #include "sdf/Model.hh"
@@ -157,3 +158,123 @@ TEST(DOMModel, CopyAssignmentAfterMove)
   EXPECT_EQ("model2", model1.Name());
   EXPECT_EQ("model1", model2.Name());
 }
+
+/////////////////////////////////////////////////
+TEST(DOMModel, RenameLink)
+{
+  sdf::Model model;
+  sdf::Link base;
+  base.SetName("base");
+  EXPECT_TRUE(model.AddLink(std::move(base)).empty());
+  sdf::Link arm;
+  arm.SetName("arm");
+  EXPECT_TRUE(model.AddLink(std::move(arm)).empty());
+
+  // A link renamed through its model is found by its new name only.
+  const sdf::Link *link = model.LinkByName("base");
+  ASSERT_NE(nullptr, link);
+  link->SetName("renamed");
+  EXPECT_TRUE(model.LinkNameExists("renamed"));
+  EXPECT_FALSE(model.LinkNameExists("base"));
+  EXPECT_EQ(link, model.LinkByName("renamed"));
+  EXPECT_EQ(nullptr, model.LinkByName("base"));
+  EXPECT_EQ(model.LinkByIndex(1), model.LinkByName("arm"));
+}
+
+/////////////////////////////////////////////////
+TEST(DOMModel, AddFrames)
+{
+  using Pose = ignition::math::Pose3d;
+
+  sdf::Model model;
+  model.SetName("built");
+
+  sdf::Link base;
+  base.SetName("base");
+  base.SetRawPose(Pose(1, 0, 0, 0, 0, 0));
+  EXPECT_TRUE(model.AddLink(std::move(base)).empty());
+
+  sdf::Link arm;
+  arm.SetName("arm");
+  arm.SetRawPose(Pose(0, 2, 0, 0, 0, 0));
+  arm.SetPoseRelativeTo("base");
+  EXPECT_TRUE(model.AddLink(std::move(arm)).empty());
+
+  // The duplicate is rejected and left intact.
+  sdf::Link duplicate;
+  duplicate.SetName("arm");
+  sdf::Errors errors = model.AddLink(std::move(duplicate));
+  ASSERT_EQ(1u, errors.size());
+  EXPECT_EQ(sdf::ErrorCode::DUPLICATE_NAME, errors[0].Code());
+  EXPECT_EQ("arm", duplicate.Name());
+  EXPECT_EQ(2u, model.LinkCount());
+
+  // The relative_to frame must already be in the model.
+  sdf::Link early;
+  early.SetName("early");
+  early.SetPoseRelativeTo("later");
+  errors = model.AddLink(std::move(early));
+  ASSERT_EQ(1u, errors.size());
+  EXPECT_EQ(sdf::ErrorCode::POSE_RELATIVE_TO_INVALID, errors[0].Code());
+  EXPECT_EQ(nullptr, model.LinkByName("early"));
+
+  sdf::Joint joint;
+  joint.SetName("elbow");
+  joint.SetChildLinkName("missing");
+  errors = model.AddJoint(std::move(joint));
+  ASSERT_EQ(1u, errors.size());
+  EXPECT_EQ(sdf::ErrorCode::JOINT_CHILD_LINK_INVALID, errors[0].Code());
+  joint.SetChildLinkName("arm");
+  joint.SetParentLinkName("base");
+  joint.SetRawPose(Pose(0, 0, 3, 0, 0, 0));
+  EXPECT_TRUE(model.AddJoint(std::move(joint)).empty());
+
+  sdf::Frame frame;
+  frame.SetName("tool");
+  frame.SetAttachedTo("arm");
+  frame.SetRawPose(Pose(0, 0, 4, 0, 0, 0));
+  EXPECT_TRUE(model.AddFrame(std::move(frame)).empty());
+
+  ASSERT_NE(nullptr, model.LinkByName("arm"));
+  ASSERT_NE(nullptr, model.JointByName("elbow"));
+  ASSERT_NE(nullptr, model.FrameByName("tool"));
+  EXPECT_EQ("base", model.CanonicalLink()->Name());
+
+  Pose pose;
+  EXPECT_TRUE(model.LinkByName("arm")->SemanticPose().Resolve(pose).empty());
+  EXPECT_EQ(Pose(1, 2, 0, 0, 0, 0), pose);
+  EXPECT_TRUE(
+      model.JointByName("elbow")->SemanticPose().Resolve(pose).empty());
+  EXPECT_EQ(Pose(1, 2, 3, 0, 0, 0), pose);
+  EXPECT_TRUE(
+      model.FrameByName("tool")->SemanticPose().Resolve(pose).empty());
+  EXPECT_EQ(Pose(1, 2, 4, 0, 0, 0), pose);
+
+  std::string body;
+  EXPECT_TRUE(model.FrameByName("tool")->ResolveAttachedToBody(body).empty());
+  EXPECT_EQ("arm", body);
+
+  // Frames added after poses were resolved are resolved too.
+  sdf::Link tip;
+  tip.SetName("tip");
+  tip.SetRawPose(Pose(0, 0, 5, 0, 0, 0));
+  tip.SetPoseRelativeTo("tool");
+  EXPECT_TRUE(model.AddLink(std::move(tip)).empty());
+
+  // The canonical link follows its name.
+  const std::string canonicalLink = model.CanonicalLinkName();
+  model.SetCanonicalLinkName("tip");
+  ASSERT_NE(nullptr, model.CanonicalLink());
+  EXPECT_EQ("tip", model.CanonicalLink()->Name());
+  model.SetCanonicalLinkName("missing");
+  EXPECT_EQ(nullptr, model.CanonicalLink());
+  model.SetCanonicalLinkName(canonicalLink);
+  EXPECT_EQ("base", model.CanonicalLink()->Name());
+  EXPECT_TRUE(model.LinkByName("tip")->SemanticPose().Resolve(pose).empty());
+  EXPECT_EQ(Pose(1, 2, 9, 0, 0, 0), pose);
+
+  // Copies have their own graphs.
+  sdf::Model copy(model);
+  EXPECT_TRUE(copy.LinkByName("tip")->SemanticPose().Resolve(pose).empty());
+  EXPECT_EQ(Pose(1, 2, 9, 0, 0, 0), pose);
+}
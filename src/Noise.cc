@@ -18,11 +18,21 @@
 #include <algorithm>
 #include "sdf/Noise.hh"
 #include "sdf/Types.hh"
+#include "ElementArena.hh"
+#include "ElementField.hh"
+#include "EnumNames.hh"
+#include "Utils.hh"
 
 using namespace sdf;
 
+/// \brief Noise type strings, in lowercase.
+constexpr auto kNoiseTypes = makeEnumNames<NoiseType>({
+    {"none", NoiseType::NONE},
+    {"gaussian", NoiseType::GAUSSIAN},
+    {"gaussian_quantized", NoiseType::GAUSSIAN_QUANTIZED}});
+
 /// \brief Private noise data.
-class sdf::NoisePrivate
+class sdf::NoisePrivate : public ArenaAllocated
 {
   /// \brief The noise type.
   public: NoiseType type = NoiseType::NONE;
@@ -97,7 +107,7 @@ Errors Noise::Load(ElementPtr _sdf)
 {
   Errors errors;
 
-  this->dataPtr->sdf = _sdf;
+  this->dataPtr->sdf = retainedElement(_sdf);
 
   // Check that the provided SDF element is a <noise> element.
   // This is an error that cannot be recovered, so return an error.
@@ -118,13 +128,7 @@ Errors Noise::Load(ElementPtr _sdf)
 
   std::string typeLower = lowercase(type.first);
 
-  if (typeLower == "none")
-    this->dataPtr->type = NoiseType::NONE;
-  else if (typeLower == "gaussian")
-    this->dataPtr->type = NoiseType::GAUSSIAN;
-  else if (typeLower == "gaussian_quantized")
-    this->dataPtr->type =NoiseType::GAUSSIAN_QUANTIZED;
-  else
+  if (!kNoiseTypes.Find(typeLower, this->dataPtr->type))
   {
     errors.push_back({ErrorCode::ELEMENT_MISSING,
         "Noise 'type' attribute is invalid with a value of [" +
@@ -133,26 +137,34 @@ Errors Noise::Load(ElementPtr _sdf)
     this->dataPtr->type = NoiseType::NONE;
   }
 
-  this->dataPtr->mean = _sdf->Get<double>("mean",
-      this->dataPtr->mean).first;
+  static const ElementField<double> kMean("mean");
+  static const ElementField<double> kStdDev("stddev");
+  static const ElementField<double> kBiasMean("bias_mean");
+  static const ElementField<double> kBiasStdDev("bias_stddev");
+  static const ElementField<double> kPrecision("precision");
+  static const ElementField<double> kDynamicBiasStdDev(
+      "dynamic_bias_stddev");
+  static const ElementField<double> kDynamicBiasCorrelationTime(
+      "dynamic_bias_correlation_time");
+
+  this->dataPtr->mean = kMean.Get(_sdf, this->dataPtr->mean).first;
 
-  this->dataPtr->stdDev = _sdf->Get<double>("stddev",
-      this->dataPtr->stdDev).first;
+  this->dataPtr->stdDev = kStdDev.Get(_sdf, this->dataPtr->stdDev).first;
 
-  this->dataPtr->biasMean = _sdf->Get<double>("bias_mean",
+  this->dataPtr->biasMean = kBiasMean.Get(_sdf,
       this->dataPtr->biasMean).first;
 
-  this->dataPtr->biasStdDev = _sdf->Get<double>("bias_stddev",
+  this->dataPtr->biasStdDev = kBiasStdDev.Get(_sdf,
       this->dataPtr->biasStdDev).first;
 
-  this->dataPtr->precision = _sdf->Get<double>("precision",
+  this->dataPtr->precision = kPrecision.Get(_sdf,
       this->dataPtr->precision).first;
 
-  this->dataPtr->dynamicBiasStdDev = _sdf->Get<double>("dynamic_bias_stddev",
+  this->dataPtr->dynamicBiasStdDev = kDynamicBiasStdDev.Get(_sdf,
       this->dataPtr->dynamicBiasStdDev).first;
 
-  this->dataPtr->dynamicBiasCorrelationTime = _sdf->Get<double>(
-      "dynamic_bias_correlation_time",
+  this->dataPtr->dynamicBiasCorrelationTime =
+      kDynamicBiasCorrelationTime.Get(_sdf,
       this->dataPtr->dynamicBiasCorrelationTime).first;
 
   return errors;
@@ -0,0 +1,198 @@
+/*
+ * Copyright 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#include <algorithm>
+#include <cmath>
+
+#include "sdf/NoiseSampler.hh"
+
+using namespace sdf;
+
+namespace
+{
+  /// \brief Number of measurements processed together.
+  constexpr std::size_t kBlockSize = 64;
+
+  /// \brief 2 pi.
+  constexpr double kTwoPi = 6.283185307179586476925286766559;
+
+  /// \brief Mix the bits of a number, with the finalizer of SplitMix64.
+  /// \param[in] _x The number.
+  /// \return The mixed number.
+  inline uint64_t mix(uint64_t _x)
+  {
+    _x = (_x ^ (_x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    _x = (_x ^ (_x >> 27)) * 0x94D049BB133111EBull;
+    return _x ^ (_x >> 31);
+  }
+
+  /// \brief Get the key of a stream.
+  /// \param[in] _seed Seed of the random numbers.
+  /// \param[in] _stream The stream.
+  /// \return The key.
+  inline uint64_t streamKey(uint64_t _seed, uint64_t _stream)
+  {
+    return mix(_seed ^ mix(_stream + 0x9E3779B97F4A7C15ull));
+  }
+
+  /// \brief Get a uniform number in (0, 1] from the position of a number in
+  /// a stream.
+  /// \param[in] _key Key of the stream.
+  /// \param[in] _counter The position.
+  /// \return The number.
+  inline double uniform(uint64_t _key, uint64_t _counter)
+  {
+    const uint64_t bits = mix(_key + _counter * 0x9E3779B97F4A7C15ull);
+    return (static_cast<double>(bits >> 11) + 1.0) * 0x1.0p-53;
+  }
+
+  /// \brief Fill a block with standard normal numbers, by the Box-Muller
+  /// transform of two uniform numbers per number.
+  /// \param[in] _key Key of the stream.
+  /// \param[in] _counter Position of the first number in the stream.
+  /// \param[in] _count Number of numbers, at most kBlockSize.
+  /// \param[out] _out The numbers.
+  void normalBlock(uint64_t _key, uint64_t _counter, std::size_t _count,
+                   double *_out)
+  {
+    double radius[kBlockSize];
+    double angle[kBlockSize];
+    for (std::size_t i = 0; i < _count; ++i)
+    {
+      const uint64_t counter = 2 * (_counter + i);
+      radius[i] = uniform(_key, counter);
+      angle[i] = uniform(_key, counter + 1);
+    }
+    for (std::size_t i = 0; i < _count; ++i)
+    {
+      _out[i] = std::sqrt(-2.0 * std::log(radius[i])) *
+          std::cos(kTwoPi * angle[i]);
+    }
+  }
+
+  /// \brief Add noise to measurements.
+  /// \param[in,out] _values The measurements.
+  /// \param[in] _count Number of measurements.
+  /// \param[in] _key Key of the stream.
+  /// \param[in] _counter Position of the first measurement in the stream.
+  /// \param[in] _offset Mean of the noise plus the bias.
+  /// \param[in] _stdDev Standard deviation of the noise.
+  /// \param[in] _precision Precision of quantization, or 0.
+  template <typename T>
+  void addNoise(T *_values, std::size_t _count, uint64_t _key,
+                uint64_t _counter, double _offset, double _stdDev,
+                double _precision)
+  {
+    double normal[kBlockSize];
+    for (std::size_t start = 0; start < _count; start += kBlockSize)
+    {
+      const std::size_t count = std::min(kBlockSize, _count - start);
+      T *values = _values + start;
+      if (_stdDev != 0.0)
+      {
+        normalBlock(_key, _counter + start, count, normal);
+        for (std::size_t i = 0; i < count; ++i)
+        {
+          values[i] = static_cast<T>(values[i] + _offset +
+              _stdDev * normal[i]);
+        }
+      }
+      else
+      {
+        for (std::size_t i = 0; i < count; ++i)
+          values[i] = static_cast<T>(values[i] + _offset);
+      }
+
+      if (_precision > 0.0)
+      {
+        for (std::size_t i = 0; i < count; ++i)
+        {
+          values[i] = static_cast<T>(
+              std::round(values[i] / _precision) * _precision);
+        }
+      }
+    }
+  }
+}
+
+/////////////////////////////////////////////////
+NoiseSampler::NoiseSampler(const Noise &_noise, uint64_t _seed)
+  : type(_noise.Type()), mean(_noise.Mean()), stdDev(_noise.StdDev()),
+    biasMean(_noise.BiasMean()), biasStdDev(_noise.BiasStdDev()),
+    precision(_noise.Type() == NoiseType::GAUSSIAN_QUANTIZED ?
+        _noise.Precision() : 0.0),
+    seed(_seed)
+{
+}
+
+/////////////////////////////////////////////////
+double NoiseSampler::Bias(uint64_t _stream) const
+{
+  if (this->type == NoiseType::NONE)
+    return 0.0;
+
+  // The bias has its own key, so that it is not correlated with the noise
+  // of the measurements.
+  const uint64_t key = mix(streamKey(this->seed, _stream) ^
+      0xD1B54A32D192ED03ull);
+  double normal;
+  normalBlock(key, 0, 1, &normal);
+  const double bias = this->biasMean + this->biasStdDev * normal;
+  return uniform(key, 2) < 0.5 ? -bias : bias;
+}
+
+/////////////////////////////////////////////////
+double NoiseSampler::Sample(uint64_t _stream, uint64_t _counter) const
+{
+  if (this->type == NoiseType::NONE)
+    return 0.0;
+
+  double normal;
+  normalBlock(streamKey(this->seed, _stream), _counter, 1, &normal);
+  return this->mean + this->Bias(_stream) + this->stdDev * normal;
+}
+
+/////////////////////////////////////////////////
+void NoiseSampler::Apply(double *_values, std::size_t _count,
+    uint64_t _stream, uint64_t _counter) const
+{
+  if (this->type == NoiseType::NONE)
+    return;
+  addNoise(_values, _count, streamKey(this->seed, _stream), _counter,
+      this->mean + this->Bias(_stream), this->stdDev, this->precision);
+}
+
+/////////////////////////////////////////////////
+void NoiseSampler::Apply(float *_values, std::size_t _count,
+    uint64_t _stream, uint64_t _counter) const
+{
+  if (this->type == NoiseType::NONE)
+    return;
+  addNoise(_values, _count, streamKey(this->seed, _stream), _counter,
+      this->mean + this->Bias(_stream), this->stdDev, this->precision);
+}
+
+/////////////////////////////////////////////////
+void NoiseSampler::FillStandardNormal(double *_values, std::size_t _count,
+    uint64_t _stream, uint64_t _counter) const
+{
+  const uint64_t key = streamKey(this->seed, _stream);
+  for (std::size_t start = 0; start < _count; start += kBlockSize)
+  {
+    normalBlock(key, _counter + start,
+        std::min(kBlockSize, _count - start), _values + start);
+  }
+}
@@ -0,0 +1,101 @@
+/*
+ * Copyright 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include <vector>
+
+#include "sdf/Noise.hh"
+#include "sdf/NoiseSampler.hh"
+
+/////////////////////////////////////////////////
+TEST(DOMNoiseSampler, None)
+{
+  sdf::Noise noise;
+  sdf::NoiseSampler sampler(noise);
+  std::vector<double> values(10, 1.5);
+  sampler.Apply(values.data(), values.size(), 0, 0);
+  EXPECT_EQ(std::vector<double>(10, 1.5), values);
+  EXPECT_DOUBLE_EQ(0.0, sampler.Sample(0, 0));
+  EXPECT_DOUBLE_EQ(0.0, sampler.Bias(0));
+}
+
+/////////////////////////////////////////////////
+TEST(DOMNoiseSampler, Gaussian)
+{
+  sdf::Noise noise;
+  noise.SetType(sdf::NoiseType::GAUSSIAN);
+  noise.SetMean(0.5);
+  noise.SetStdDev(2.0);
+  sdf::NoiseSampler sampler(noise, 42);
+
+  const std::size_t count = 100000;
+  std::vector<double> values(count, 0.0);
+  sampler.Apply(values.data(), count, 7, 0);
+  double sum = 0;
+  double sumSq = 0;
+  for (double value : values)
+  {
+    sum += value;
+    sumSq += value * value;
+  }
+  const double mean = sum / count;
+  EXPECT_NEAR(0.5, mean, 0.05);
+  EXPECT_NEAR(2.0, std::sqrt(sumSq / count - mean * mean), 0.05);
+
+  // Values only depend on their position in the stream, so that a buffer
+  // split in parts gets the same noise.
+  std::vector<double> parts(count, 0.0);
+  sampler.Apply(parts.data(), 1000, 7, 0);
+  sampler.Apply(parts.data() + 1000, 33, 7, 1000);
+  sampler.Apply(parts.data() + 1033, count - 1033, 7, 1033);
+  EXPECT_EQ(values, parts);
+  EXPECT_DOUBLE_EQ(values[1234], sampler.Sample(7, 1234));
+
+  std::vector<double> normal(100);
+  sampler.FillStandardNormal(normal.data(), normal.size(), 7, 0);
+  EXPECT_DOUBLE_EQ(0.5 + 2.0 * normal[5], values[5]);
+
+  // Other streams and seeds get other noise.
+  EXPECT_NE(values[0], sampler.Sample(8, 0));
+  EXPECT_NE(values[0], sdf::NoiseSampler(noise, 43).Sample(7, 0));
+
+  std::vector<float> floats(100, 0.0f);
+  sampler.Apply(floats.data(), floats.size(), 7, 0);
+  EXPECT_FLOAT_EQ(static_cast<float>(values[10]), floats[10]);
+}
+
+/////////////////////////////////////////////////
+TEST(DOMNoiseSampler, BiasAndQuantization)
+{
+  sdf::Noise noise;
+  noise.SetType(sdf::NoiseType::GAUSSIAN_QUANTIZED);
+  noise.SetBiasMean(3.0);
+  noise.SetPrecision(0.25);
+  sdf::NoiseSampler sampler(noise);
+
+  // Without bias deviation, the bias is the bias mean with a random sign.
+  const double bias = sampler.Bias(0);
+  EXPECT_DOUBLE_EQ(3.0, std::abs(bias));
+  EXPECT_DOUBLE_EQ(bias, sampler.Bias(0));
+
+  std::vector<double> values = {0.1, 0.2, 1.0};
+  sampler.Apply(values.data(), values.size(), 0, 0);
+  EXPECT_DOUBLE_EQ(std::round((0.1 + bias) * 4) / 4, values[0]);
+  EXPECT_DOUBLE_EQ(std::round((0.2 + bias) * 4) / 4, values[1]);
+  EXPECT_DOUBLE_EQ(1.0 + bias, values[2]);
+}
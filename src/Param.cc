@@ -16,25 +16,42 @@
  */
 
 #include <algorithm>
+#include <array>
 #include <cctype>
+#include <cerrno>
+#include <charconv>
 #include <cstdint>
+#include <cstdlib>
+#include <cstring>
 #include <locale>
 #include <sstream>
+#include <stdexcept>
 #include <string>
+#include <system_error>
+#include <type_traits>
+#include <utility>
 
 #include <locale.h>
 #include <math.h>
+#ifdef __APPLE__
+#include <xlocale.h>
+#endif
 
 #include "sdf/Assert.hh"
 #include "sdf/Param.hh"
 #include "sdf/Types.hh"
+#include "ElementArena.hh"
+#include "Utils.hh"
 
 using namespace sdf;
 
 // For some locale, the decimal separator is not a point, but a
 // comma. To avoid that the SDF parsing is influenced by the current
-// global C or C++ locale, we define a custom std::stringstream variant
-// that always uses the std::locale::classic() locale.
+// global C or C++ locale, values are formatted and parsed with
+// std::to_chars and std::from_chars, which do not use locales. The
+// ignition::math types whose text is defined by their stream operators are
+// formatted with this custom std::stringstream variant, that always uses
+// the std::locale::classic() locale.
 // See issues https://github.com/osrf/sdformat/issues/60
 // and https://github.com/osrf/sdformat/issues/207 for more details.
 namespace sdf
@@ -56,20 +73,176 @@ namespace sdf
   }
 }
 
+#ifdef _WIN32
+using CLocale = _locale_t;
+#else
+using CLocale = locale_t;
+#endif
+
+//////////////////////////////////////////////////
+/// \brief Get a "C" numeric locale, created once and never modified, so
+/// that floating point values can be parsed without calling setlocale.
+/// setlocale changes the locale of the whole process, which is not safe
+/// while other threads are parsing.
+/// \return The "C" locale.
+static CLocale CNumericLocale()
+{
+#ifdef _WIN32
+  static const CLocale locale = _create_locale(LC_NUMERIC, "C");
+#else
+  static const CLocale locale =
+      newlocale(LC_NUMERIC_MASK, "C", static_cast<locale_t>(0));
+#endif
+  return locale;
+}
+
+//////////////////////////////////////////////////
+/// \brief Equivalent of std::stod and std::stof that always uses the "C"
+/// locale, regardless of the global locale.
+/// \param[in] _str String to parse.
+/// \param[out] _length If not null, set to the number of characters that
+/// were parsed.
+/// \return The parsed value.
+/// \throws std::invalid_argument if no conversion could be performed.
+/// \throws std::out_of_range if the value is out of the range of T.
+template <typename T>
+T StringToFloatClassicLocale(const std::string &_str,
+    std::size_t *_length = nullptr)
+{
+  const char *begin = _str.c_str();
+  char *end = nullptr;
+  const int savedErrno = errno;
+  errno = 0;
+
+  T result;
+  if constexpr (std::is_same_v<T, float>)
+  {
+#ifdef _WIN32
+    result = _strtof_l(begin, &end, CNumericLocale());
+#else
+    result = strtof_l(begin, &end, CNumericLocale());
+#endif
+  }
+  else
+  {
+#ifdef _WIN32
+    result = _strtod_l(begin, &end, CNumericLocale());
+#else
+    result = strtod_l(begin, &end, CNumericLocale());
+#endif
+  }
+
+  const bool outOfRange = errno == ERANGE;
+  errno = savedErrno;
+
+  if (end == begin)
+    throw std::invalid_argument("StringToFloatClassicLocale");
+  if (outOfRange)
+    throw std::out_of_range("StringToFloatClassicLocale");
+  if (_length)
+    *_length = static_cast<std::size_t>(end - begin);
+  return result;
+}
+
+//////////////////////////////////////////////////
+/// \brief Get whether two values are exactly the same. Unlike the
+/// equality operators of ignition::math, which compare floating point
+/// values within a tolerance, this compares them exactly.
+/// \param[in] _a The first value.
+/// \param[in] _b The second value.
+/// \return True if both values hold the same type and the same value.
+static bool identicalValues(const ParamPrivate::ParamVariant &_a,
+    const ParamPrivate::ParamVariant &_b)
+{
+  if (_a.index() != _b.index())
+    return false;
+
+  return std::visit([&_b](const auto &_held) -> bool
+    {
+      using T = std::decay_t<decltype(_held)>;
+      const T &other = std::get<T>(_b);
+      if constexpr (std::is_same_v<T, ignition::math::Angle>)
+      {
+        return _held.Radian() == other.Radian();
+      }
+      else if constexpr (std::is_same_v<T, ignition::math::Color>)
+      {
+        return _held.R() == other.R() && _held.G() == other.G() &&
+               _held.B() == other.B() && _held.A() == other.A();
+      }
+      else if constexpr (std::is_same_v<T, ignition::math::Vector2d>)
+      {
+        return _held.X() == other.X() && _held.Y() == other.Y();
+      }
+      else if constexpr (std::is_same_v<T, ignition::math::Vector3d>)
+      {
+        return _held.X() == other.X() && _held.Y() == other.Y() &&
+               _held.Z() == other.Z();
+      }
+      else if constexpr (std::is_same_v<T, ignition::math::Quaterniond>)
+      {
+        return _held.W() == other.W() && _held.X() == other.X() &&
+               _held.Y() == other.Y() && _held.Z() == other.Z();
+      }
+      else if constexpr (std::is_same_v<T, ignition::math::Pose3d>)
+      {
+        const auto &p = _held.Pos();
+        const auto &q = _held.Rot();
+        const auto &otherP = other.Pos();
+        const auto &otherQ = other.Rot();
+        return p.X() == otherP.X() && p.Y() == otherP.Y() &&
+               p.Z() == otherP.Z() && q.W() == otherQ.W() &&
+               q.X() == otherQ.X() && q.Y() == otherQ.Y() &&
+               q.Z() == otherQ.Z();
+      }
+      else
+      {
+        return _held == other;
+      }
+    }, _a);
+}
+
+//////////////////////////////////////////////////
+/// \brief Get a schema with a given default value.
+/// \param[in] _schema The schema to start from.
+/// \param[in] _default The default value.
+/// \return _schema if it already has the default value, or a copy of it
+/// with the default value.
+static std::shared_ptr<const ParamPrivate::Schema> schemaWithDefault(
+    const std::shared_ptr<const ParamPrivate::Schema> &_schema,
+    const ParamPrivate::ParamVariant &_default)
+{
+  if (identicalValues(_schema->defaultValue, _default))
+    return _schema;
+
+  auto schema = std::make_shared<ParamPrivate::Schema>(*_schema);
+  schema->defaultValue = _default;
+  return schema;
+}
+
 //////////////////////////////////////////////////
 Param::Param(const std::string &_key, const std::string &_typeName,
              const std::string &_default, bool _required,
              const std::string &_description)
   : dataPtr(new ParamPrivate)
 {
-  this->dataPtr->key = _key;
-  this->dataPtr->required = _required;
-  this->dataPtr->typeName = _typeName;
-  this->dataPtr->description = _description;
-  this->dataPtr->set = false;
+  auto schema = std::make_shared<ParamPrivate::Schema>();
+  schema->key = _key;
+  schema->required = _required;
+  schema->typeName = _typeName;
+  schema->description = _description;
+  this->dataPtr->schema = schema;
 
   SDF_ASSERT(this->ValueFromString(_default), "Invalid parameter");
-  this->dataPtr->defaultValue = this->dataPtr->value;
+  schema->defaultValue = this->dataPtr->value;
+}
+
+//////////////////////////////////////////////////
+Param::Param()
+  : dataPtr(new ParamPrivate)
+{
+  static const auto emptySchema = std::make_shared<ParamPrivate::Schema>();
+  this->dataPtr->schema = emptySchema;
 }
 
 //////////////////////////////////////////////////
@@ -77,11 +250,36 @@ Param::~Param()
 {
 }
 
+//////////////////////////////////////////////////
+void *Param::operator new(std::size_t _size)
+{
+  return ElementArena::Allocate(_size);
+}
+
+//////////////////////////////////////////////////
+void Param::operator delete(void *_ptr)
+{
+  ElementArena::Deallocate(_ptr);
+}
+
+//////////////////////////////////////////////////
+void *ParamPrivate::operator new(std::size_t _size)
+{
+  return ElementArena::Allocate(_size);
+}
+
+//////////////////////////////////////////////////
+void ParamPrivate::operator delete(void *_ptr)
+{
+  ElementArena::Deallocate(_ptr);
+}
+
 /////////////////////////////////////////////////
 Param &Param::operator=(const Param &_param)
 {
   this->dataPtr->value = _param.dataPtr->value;
-  this->dataPtr->defaultValue  = _param.dataPtr->defaultValue;
+  this->dataPtr->schema = schemaWithDefault(this->dataPtr->schema,
+      _param.dataPtr->schema->defaultValue);
   this->dataPtr->set  = _param.dataPtr->set;
   return *this;
 }
@@ -232,10 +430,38 @@ bool Param::GetAny(std::any &_anyVal) const
   return true;
 }
 
+//////////////////////////////////////////////////
+bool Param::HasUpdateFunc() const
+{
+  return this->dataPtr->typedUpdateFunc || this->dataPtr->updateFunc;
+}
+
+//////////////////////////////////////////////////
+void Param::UpdateFuncChanged()
+{
+  advanceParamUpdateGeneration();
+}
+
 //////////////////////////////////////////////////
 void Param::Update()
 {
-  if (this->dataPtr->updateFunc)
+  if (this->dataPtr->typedUpdateFunc)
+  {
+    bool updated = false;
+    try
+    {
+      updated = this->dataPtr->typedUpdateFunc(this->dataPtr->value);
+    }
+    catch(...)
+    {
+    }
+    if (!updated)
+    {
+      sdferr << "Unable to set value using Update for key["
+             << this->dataPtr->schema->key << "]\n";
+    }
+  }
+  else if (this->dataPtr->updateFunc)
   {
     try
     {
@@ -249,27 +475,429 @@ void Param::Update()
     catch(...)
     {
       sdferr << "Unable to set value using Update for key["
-             << this->dataPtr->key << "]\n";
+             << this->dataPtr->schema->key << "]\n";
     }
   }
 }
 
+//////////////////////////////////////////////////
+/// \brief Append a number to a string with std::to_chars, formatted like
+/// std::ostream does with its default flags and precision.
+/// \param[in,out] _out String to append the number to.
+/// \param[in] _value The number.
+/// \return False if the number could not be formatted without a stream.
+template <typename T>
+static bool AppendNumber(std::string &_out, const T _value)
+{
+  // Large enough for any integer and for floating point values with 6
+  // significant digits.
+  char buffer[32];
+  std::to_chars_result result;
+  if constexpr (std::is_floating_point_v<T>)
+  {
+#ifdef __cpp_lib_to_chars
+    // The default precision of 6 with general formatting matches "%g".
+    result = std::to_chars(buffer, buffer + sizeof(buffer), _value,
+        std::chars_format::general, 6);
+#else
+    return false;
+#endif
+  }
+  else
+  {
+    result = std::to_chars(buffer, buffer + sizeof(buffer), _value);
+  }
+  if (result.ec != std::errc())
+    return false;
+  _out.append(buffer, result.ptr);
+  return true;
+}
+
+//////////////////////////////////////////////////
+/// \brief Append a value to a string, as its stream insertion operator
+/// writes it with the classic locale. Strings, numbers, times, angles and
+/// integer vectors are formatted with std::to_chars. The other
+/// ignition::math types, whose stream operators round their components,
+/// are written with a stream of the calling thread that is imbued with the
+/// classic locale once, instead of constructing and imbuing a stream for
+/// each value, which contends on the reference count of the global locale
+/// when several threads load.
+/// \param[in,out] _out String to append the value to.
+/// \param[in] _value The value.
+static void AppendValue(std::string &_out,
+    const ParamPrivate::ParamVariant &_value)
+{
+  const std::size_t size = _out.size();
+  const bool appended = std::visit([&_out](const auto &_held)
+    {
+      using T = std::decay_t<decltype(_held)>;
+      if constexpr (std::is_same_v<T, std::string>)
+      {
+        _out += _held;
+        return true;
+      }
+      else if constexpr (std::is_same_v<T, bool> || std::is_same_v<T, char>)
+      {
+        // Streams print a bool as 1 or 0 by default.
+        _out += std::is_same_v<T, bool> ? static_cast<char>('0' + _held) :
+            static_cast<char>(_held);
+        return true;
+      }
+      else if constexpr (std::is_arithmetic_v<T>)
+      {
+        return AppendNumber(_out, _held);
+      }
+      else if constexpr (std::is_same_v<T, sdf::Time>)
+      {
+        if (!AppendNumber(_out, _held.sec))
+          return false;
+        _out += ' ';
+        return AppendNumber(_out, _held.nsec);
+      }
+      else if constexpr (std::is_same_v<T, ignition::math::Angle>)
+      {
+        return AppendNumber(_out, _held.Radian());
+      }
+      else if constexpr (std::is_same_v<T, ignition::math::Vector2i>)
+      {
+        if (!AppendNumber(_out, _held.X()))
+          return false;
+        _out += ' ';
+        return AppendNumber(_out, _held.Y());
+      }
+      else
+      {
+        return false;
+      }
+    }, _value);
+
+  if (!appended)
+  {
+    _out.resize(size);
+    thread_local StringStreamClassicLocale stream;
+    stream.str(std::string());
+    stream.clear();
+    stream << ParamStreamer{_value};
+    _out += stream.str();
+  }
+}
+
 //////////////////////////////////////////////////
 std::string Param::GetAsString() const
 {
-  StringStreamClassicLocale ss;
+  std::string result;
+  AppendValue(result, this->dataPtr->value);
+  return result;
+}
 
-  ss << ParamStreamer{ this->dataPtr->value };
-  return ss.str();
+//////////////////////////////////////////////////
+void Param::AppendAsString(std::string &_out) const
+{
+  AppendValue(_out, this->dataPtr->value);
 }
 
 //////////////////////////////////////////////////
 std::string Param::GetDefaultAsString() const
 {
-  StringStreamClassicLocale ss;
+  std::string result;
+  AppendValue(result, this->dataPtr->schema->defaultValue);
+  return result;
+}
+
+//////////////////////////////////////////////////
+/// \brief Wrapper around std::from_chars.
+/// \param[in] _first Start of the text to parse.
+/// \param[in] _last End of the text to parse.
+/// \param[out] _value The parsed number.
+/// \return Pointer to the first character after the number, or nullptr
+/// if no number could be parsed or it is out of the range of T.
+template <typename T>
+static const char *FromChars(const char *_first, const char *_last,
+    T &_value)
+{
+#ifndef __cpp_lib_to_chars
+  if constexpr (std::is_floating_point_v<T>)
+  {
+    // Without floating point support in std::from_chars, fall back to
+    // strtod_l with the "C" locale.
+    std::size_t length = 0;
+    try
+    {
+      _value = StringToFloatClassicLocale<T>(std::string(_first, _last),
+          &length);
+    }
+    catch(...)
+    {
+      return nullptr;
+    }
+    return _first + length;
+  }
+  else
+#endif
+  {
+    const std::from_chars_result result =
+        std::from_chars(_first, _last, _value);
+    if (result.ec != std::errc())
+      return nullptr;
+    return result.ptr;
+  }
+}
+
+//////////////////////////////////////////////////
+/// \brief Parse a number the way std::istream extracts it with the
+/// classic locale: leading whitespace and a leading '+' are skipped, and
+/// parsing stops at the first character that is not part of the number.
+/// Floating point values are only accepted in decimal form, since
+/// std::istream does not parse "inf", "nan" or hexadecimal values either.
+/// \param[in,out] _first Start of the text to parse. On success, it is set
+/// to the first character after the number.
+/// \param[in] _last End of the text to parse.
+/// \param[out] _value The parsed number.
+/// \return True if a number was parsed and it is within the range of T.
+template <typename T>
+static bool ParseNumber(const char *&_first, const char *_last, T &_value)
+{
+  const char *first = _first;
+  while (first != _last && std::isspace(static_cast<unsigned char>(*first)))
+    ++first;
+
+  // std::from_chars does not accept a leading '+'.
+  if (first != _last && *first == '+')
+  {
+    ++first;
+    if (first != _last && *first == '-')
+      return false;
+  }
 
-  ss << ParamStreamer{ this->dataPtr->defaultValue };
-  return ss.str();
+  if constexpr (std::is_floating_point_v<T>)
+  {
+    const char *digits = first;
+    if (digits != _last && *digits == '-')
+      ++digits;
+    if (digits == _last ||
+        !(std::isdigit(static_cast<unsigned char>(*digits)) || *digits == '.'))
+    {
+      return false;
+    }
+  }
+
+  const char *end = FromChars(first, _last, _value);
+  if (!end)
+    return false;
+
+  _first = end;
+  return true;
+}
+
+//////////////////////////////////////////////////
+/// \brief Parse whitespace separated numbers, the way std::istream would
+/// extract them one after the other. Text after the last number is
+/// ignored.
+/// \param[in] _input Text to parse.
+/// \param[out] _values The parsed numbers.
+/// \return True if all the numbers were parsed.
+template <typename T, std::size_t N>
+static bool ParseNumbers(const std::string &_input, std::array<T, N> &_values)
+{
+  const char *first = _input.data();
+  const char *last = _input.data() + _input.size();
+  for (T &value : _values)
+  {
+    if (!ParseNumber(first, last, value))
+      return false;
+  }
+  return true;
+}
+
+//////////////////////////////////////////////////
+/// \brief Parse an integer or floating point scalar the way std::stoi,
+/// std::stoul and std::strtod do with the "C" locale, but with
+/// std::from_chars: leading whitespace and a sign are skipped, a "0x"
+/// prefix selects hexadecimal digits, floating point values may be "inf" or
+/// "nan", and text after the number is ignored. As with std::stoul, a
+/// negative unsigned value wraps around.
+/// \param[in] _input Text to parse.
+/// \param[out] _value The parsed value.
+/// \return std::errc() on success, std::errc::invalid_argument if the text
+/// does not start with a number, or std::errc::result_out_of_range if the
+/// number is out of the range of T.
+template <typename T>
+static std::errc ParseScalar(const std::string &_input, T &_value)
+{
+  const char *first = _input.data();
+  const char *last = _input.data() + _input.size();
+  while (first != last && std::isspace(static_cast<unsigned char>(*first)))
+    ++first;
+
+  bool negative = false;
+  if (first != last && (*first == '+' || *first == '-'))
+  {
+    negative = *first == '-';
+    ++first;
+  }
+  if (first == last || *first == '+' || *first == '-')
+    return std::errc::invalid_argument;
+
+  bool hex = false;
+  if (last - first >= 2 && first[0] == '0' &&
+      (first[1] == 'x' || first[1] == 'X'))
+  {
+    hex = true;
+    first += 2;
+  }
+
+  if constexpr (std::is_integral_v<T>)
+  {
+    std::uint64_t magnitude = 0;
+    const std::from_chars_result result =
+        std::from_chars(first, last, magnitude, hex ? 16 : 10);
+    // Like strtol, "0x" without digits is the number 0 followed by text.
+    if (hex && result.ec == std::errc::invalid_argument)
+      magnitude = 0;
+    else if (result.ec != std::errc())
+      return result.ec;
+
+    if constexpr (std::is_signed_v<T>)
+    {
+      const std::uint64_t limit =
+          static_cast<std::uint64_t>(std::numeric_limits<T>::max()) +
+          (negative ? 1u : 0u);
+      if (magnitude > limit)
+        return std::errc::result_out_of_range;
+      _value = negative ?
+          static_cast<T>(-static_cast<std::int64_t>(magnitude)) :
+          static_cast<T>(magnitude);
+    }
+    else
+    {
+      if (magnitude > std::numeric_limits<T>::max())
+        return std::errc::result_out_of_range;
+      _value = static_cast<T>(negative ? 0u - magnitude : magnitude);
+    }
+    return std::errc();
+  }
+  else
+  {
+#ifdef __cpp_lib_to_chars
+    const std::from_chars_result result = std::from_chars(first, last,
+        _value, hex ? std::chars_format::hex : std::chars_format::general);
+    if (hex && result.ec == std::errc::invalid_argument)
+      _value = 0;
+    else if (result.ec != std::errc())
+      return result.ec;
+    if (negative)
+      _value = -_value;
+    return std::errc();
+#else
+    // Without floating point support in std::from_chars, fall back to
+    // strtod_l with the "C" locale.
+    try
+    {
+      _value = StringToFloatClassicLocale<T>(_input);
+    }
+    catch(std::out_of_range &)
+    {
+      return std::errc::result_out_of_range;
+    }
+    catch(...)
+    {
+      return std::errc::invalid_argument;
+    }
+    return std::errc();
+#endif
+  }
+}
+
+//////////////////////////////////////////////////
+/// \brief Parse a value of one of the numeric and ignition::math types
+/// without a std::stringstream. The text is read the same way as by the
+/// stream extraction operator of the type.
+/// \param[in] _input Text to parse.
+/// \param[out] _value The parsed value.
+/// \return True if parsing succeeded.
+template <typename T>
+static bool ParseValue(const std::string &_input, T &_value)
+{
+  if constexpr (std::is_arithmetic_v<T>)
+  {
+    std::array<T, 1> values;
+    if (!ParseNumbers(_input, values))
+      return false;
+    _value = values[0];
+  }
+  else if constexpr (std::is_same_v<T, sdf::Time>)
+  {
+    std::array<int32_t, 2> values;
+    if (!ParseNumbers(_input, values))
+      return false;
+    _value = sdf::Time(values[0], values[1]);
+  }
+  else if constexpr (std::is_same_v<T, ignition::math::Color>)
+  {
+    // The alpha value is optional.
+    const char *first = _input.data();
+    const char *last = _input.data() + _input.size();
+    std::array<float, 4> values = {0, 0, 0, ignition::math::Color().A()};
+    for (std::size_t i = 0; i < 3; ++i)
+    {
+      if (!ParseNumber(first, last, values[i]))
+        return false;
+    }
+    while (first != last && std::isspace(static_cast<unsigned char>(*first)))
+      ++first;
+    if (first != last && !ParseNumber(first, last, values[3]))
+      return false;
+
+    // Set the components directly, like the stream extraction operator,
+    // which does not clamp them.
+    _value.R(values[0]);
+    _value.G(values[1]);
+    _value.B(values[2]);
+    _value.A(values[3]);
+  }
+  else if constexpr (std::is_same_v<T, ignition::math::Vector2i>)
+  {
+    std::array<int, 2> values;
+    if (!ParseNumbers(_input, values))
+      return false;
+    _value.Set(values[0], values[1]);
+  }
+  else if constexpr (std::is_same_v<T, ignition::math::Vector2d>)
+  {
+    std::array<double, 2> values;
+    if (!ParseNumbers(_input, values))
+      return false;
+    _value.Set(values[0], values[1]);
+  }
+  else if constexpr (std::is_same_v<T, ignition::math::Vector3d>)
+  {
+    std::array<double, 3> values;
+    if (!ParseNumbers(_input, values))
+      return false;
+    _value.Set(values[0], values[1], values[2]);
+  }
+  else if constexpr (std::is_same_v<T, ignition::math::Quaterniond>)
+  {
+    // Quaternions are written as roll, pitch and yaw angles.
+    std::array<double, 3> values;
+    if (!ParseNumbers(_input, values))
+      return false;
+    _value = ignition::math::Quaterniond(values[0], values[1], values[2]);
+  }
+  else if constexpr (std::is_same_v<T, ignition::math::Pose3d>)
+  {
+    // Poses are written as a position followed by roll, pitch and yaw.
+    std::array<double, 6> values;
+    if (!ParseNumbers(_input, values))
+      return false;
+    _value.Set(ignition::math::Vector3d(values[0], values[1], values[2]),
+        ignition::math::Quaterniond(values[3], values[4], values[5]));
+  }
+  else
+  {
+    static_assert(std::is_arithmetic_v<T>, "Unsupported type");
+  }
+  return true;
 }
 
 //////////////////////////////////////////////////
@@ -279,30 +907,162 @@ std::string Param::GetDefaultAsString() const
 /// \param[out] _value This will be set with the parsed value.
 /// \return True if parsing succeeded.
 template <typename T>
-bool ParseUsingStringStream(const std::string &_input, const std::string &_key,
-                            ParamPrivate::ParamVariant &_value)
+bool ParseUsingFromChars(const std::string &_input, const std::string &_key,
+                         ParamPrivate::ParamVariant &_value)
 {
-  StringStreamClassicLocale ss(_input);
-  T _val;
-  ss >> _val;
-  if (ss.fail())
+  T val;
+  if (!ParseValue(_input, val))
   {
     sdferr << "Unknown error. Unable to set value [" << _input << " ] for key["
            << _key << "]\n";
     return false;
   }
-  _value = _val;
+  _value = val;
+  return true;
+}
+
+//////////////////////////////////////////////////
+/// \brief Helper function for Param::ValueFromString, for integer and
+/// floating point scalars.
+/// \param[in] _input Input string.
+/// \param[in] _original The string given to Param::ValueFromString, used
+/// for error messages.
+/// \param[in] _key Key of the parameter, used for error message.
+/// \param[out] _value This will be set with the parsed value.
+/// \return True if parsing succeeded.
+template <typename T>
+static bool ParseScalarValue(const std::string &_input,
+    const std::string &_original, const std::string &_key,
+    ParamPrivate::ParamVariant &_value)
+{
+  T val;
+  const std::errc result = ParseScalar(_input, val);
+  if (result == std::errc::result_out_of_range)
+  {
+    sdferr << "Out of range. Unable to set value ["
+           << _original << " ] for key["
+           << _key << "].\n";
+    return false;
+  }
+  if (result != std::errc())
+  {
+    sdferr << "Invalid argument. Unable to set value ["
+           << _original << " ] for key["
+           << _key << "].\n";
+    return false;
+  }
+  _value = val;
   return true;
 }
 
+//////////////////////////////////////////////////
+/// \brief Interned names of the types supported by Param, so that the
+/// type name of a parameter can be compared by pointer.
+struct ParamTypeNames
+{
+  InternedString boolType{"bool"};
+  InternedString charType{"char"};
+  InternedString stdString{"std::string"};
+  InternedString string{"string"};
+  InternedString intType{"int"};
+  InternedString uint64{"uint64_t"};
+  InternedString unsignedInt{"unsigned int"};
+  InternedString doubleType{"double"};
+  InternedString floatType{"float"};
+  InternedString sdfTime{"sdf::Time"};
+  InternedString time{"time"};
+  InternedString mathColor{"ignition::math::Color"};
+  InternedString color{"color"};
+  InternedString mathVector2i{"ignition::math::Vector2i"};
+  InternedString vector2i{"vector2i"};
+  InternedString mathVector2d{"ignition::math::Vector2d"};
+  InternedString vector2d{"vector2d"};
+  InternedString mathVector3d{"ignition::math::Vector3d"};
+  InternedString vector3{"vector3"};
+  InternedString mathPose3d{"ignition::math::Pose3d"};
+  InternedString pose{"pose"};
+  InternedString capitalPose{"Pose"};
+  InternedString mathQuaterniond{"ignition::math::Quaterniond"};
+  InternedString quaternion{"quaternion"};
+};
+
+//////////////////////////////////////////////////
+/// \brief Get the interned type names, which are created once.
+/// \return The interned type names.
+static const ParamTypeNames &paramTypeNames()
+{
+  static const ParamTypeNames names;
+  return names;
+}
+
+//////////////////////////////////////////////////
+/// \brief Remove the leading and trailing spaces and tabs of a string in
+/// place, as sdf::trim does, without copying it.
+/// \param[in,out] _str The string.
+static void trimInPlace(std::string &_str)
+{
+  const std::size_t end = _str.find_last_not_of(" \t");
+  if (end == std::string::npos)
+  {
+    _str.clear();
+    return;
+  }
+  _str.erase(end + 1);
+  _str.erase(0, _str.find_first_not_of(" \t"));
+}
+
+//////////////////////////////////////////////////
+/// \brief Store a trimmed string in the value of a string parameter, by
+/// move. As for the other types, "true" and "false" are stored as "1" and
+/// "0", in any case.
+/// \param[in] _str The trimmed string.
+/// \param[out] _value The value.
+static void setStringValue(std::string &&_str,
+                           ParamPrivate::ParamVariant &_value)
+{
+  auto equalsLower = [&_str](const char *_lower)
+  {
+    const std::size_t size = std::strlen(_lower);
+    if (_str.size() != size)
+      return false;
+    for (std::size_t i = 0; i < size; ++i)
+    {
+      if (std::tolower(static_cast<unsigned char>(_str[i])) != _lower[i])
+        return false;
+    }
+    return true;
+  };
+
+  if (equalsLower("true"))
+    _value = std::string("1");
+  else if (equalsLower("false"))
+    _value = std::string("0");
+  else
+    _value = std::move(_str);
+}
+
 //////////////////////////////////////////////////
 bool Param::ValueFromString(const std::string &_value)
 {
+  const ParamTypeNames &names = paramTypeNames();
+  const InternedString &typeName = this->dataPtr->schema->typeName;
+  const InternedString &key = this->dataPtr->schema->key;
+
   // Under some circumstances, latin locales (es_ES or pt_BR) will return a
   // comma for decimal position instead of a dot, making the conversion
-  // to fail. See bug #60 for more information. Force to use always C
-  setlocale(LC_NUMERIC, "C");
+  // to fail. See bug #60 for more information. Values are therefore parsed
+  // with std::from_chars, which does not use locales.
   std::string trimmed = sdf::trim(_value);
+
+  // Strings, which may be large, such as inline data, are neither copied
+  // nor converted to lower case.
+  if (typeName == names.stdString ||
+      typeName == names.string)
+  {
+    setStringValue(std::move(trimmed), this->dataPtr->value);
+    return true;
+  }
+
   std::string tmp(trimmed);
   std::string lowerTmp = lowercase(trimmed);
 
@@ -316,145 +1076,101 @@ bool Param::ValueFromString(const std::string &_value)
     tmp = "0";
   }
 
-  bool isHex = lowerTmp.compare(0, 2, "0x") == 0;
-
-  try
+  if (typeName == names.boolType)
   {
-    // Try to use stoi and stoul for integers, and
-    // stof and stod for scalar floating point values.
-    int numericBase = 10;
-    if (isHex)
-    {
-      numericBase = 16;
-    }
-
-    if (this->dataPtr->typeName == "bool")
-    {
-      if (lowerTmp == "true" || lowerTmp == "1")
-      {
-        this->dataPtr->value = true;
-      }
-      else if (lowerTmp == "false" || lowerTmp == "0")
-      {
-        this->dataPtr->value = false;
-      }
-      else
-      {
-        sdferr << "Invalid boolean value\n";
-        return false;
-      }
-    }
-    else if (this->dataPtr->typeName == "char")
+    if (lowerTmp == "true" || lowerTmp == "1")
     {
-      this->dataPtr->value = tmp[0];
+      this->dataPtr->value = true;
     }
-    else if (this->dataPtr->typeName == "std::string" ||
-             this->dataPtr->typeName == "string")
+    else if (lowerTmp == "false" || lowerTmp == "0")
     {
-      this->dataPtr->value = tmp;
-    }
-    else if (this->dataPtr->typeName == "int")
-    {
-      this->dataPtr->value = std::stoi(tmp, nullptr, numericBase);
-    }
-    else if (this->dataPtr->typeName == "uint64_t")
-    {
-      return ParseUsingStringStream<std::uint64_t>(tmp, this->dataPtr->key,
-                                                   this->dataPtr->value);
-    }
-    else if (this->dataPtr->typeName == "unsigned int")
-    {
-      this->dataPtr->value = static_cast<unsigned int>(
-          std::stoul(tmp, nullptr, numericBase));
-    }
-    else if (this->dataPtr->typeName == "double")
-    {
-      this->dataPtr->value = std::stod(tmp);
-    }
-    else if (this->dataPtr->typeName == "float")
-    {
-      this->dataPtr->value = std::stof(tmp);
-    }
-    else if (this->dataPtr->typeName == "sdf::Time" ||
-             this->dataPtr->typeName == "time")
-    {
-      return ParseUsingStringStream<sdf::Time>(tmp, this->dataPtr->key,
-                                               this->dataPtr->value);
-    }
-    else if (this->dataPtr->typeName == "ignition::math::Color" ||
-             this->dataPtr->typeName == "color")
-    {
-      // The insertion operator (>>) expects 4 values, but the last value (the
-      // alpha) is optional. We first try to parse assuming the alpha is
-      // specified. If that fails, we append the default value of alpha to the
-      // string and try to parse again.
-      bool result = ParseUsingStringStream<ignition::math::Color>(
-          tmp, this->dataPtr->key, this->dataPtr->value);
-
-      if (!result)
-      {
-        ignition::math::Color colortmp;
-        return ParseUsingStringStream<ignition::math::Color>(
-            tmp + " " + std::to_string(colortmp.A()), this->dataPtr->key,
-            this->dataPtr->value);
-      }
-      else
-        return true;
-    }
-    else if (this->dataPtr->typeName == "ignition::math::Vector2i" ||
-             this->dataPtr->typeName == "vector2i")
-    {
-      return ParseUsingStringStream<ignition::math::Vector2i>(
-          tmp, this->dataPtr->key, this->dataPtr->value);
-    }
-    else if (this->dataPtr->typeName == "ignition::math::Vector2d" ||
-             this->dataPtr->typeName == "vector2d")
-    {
-      return ParseUsingStringStream<ignition::math::Vector2d>(
-          tmp, this->dataPtr->key, this->dataPtr->value);
-    }
-    else if (this->dataPtr->typeName == "ignition::math::Vector3d" ||
-             this->dataPtr->typeName == "vector3")
-    {
-      return ParseUsingStringStream<ignition::math::Vector3d>(
-          tmp, this->dataPtr->key, this->dataPtr->value);
-    }
-    else if (this->dataPtr->typeName == "ignition::math::Pose3d" ||
-             this->dataPtr->typeName == "pose" ||
-             this->dataPtr->typeName == "Pose")
-    {
-      if (!tmp.empty())
-      {
-        return ParseUsingStringStream<ignition::math::Pose3d>(
-            tmp, this->dataPtr->key, this->dataPtr->value);
-      }
-    }
-    else if (this->dataPtr->typeName == "ignition::math::Quaterniond" ||
-             this->dataPtr->typeName == "quaternion")
-    {
-      return ParseUsingStringStream<ignition::math::Quaterniond>(
-          tmp, this->dataPtr->key, this->dataPtr->value);
+      this->dataPtr->value = false;
     }
     else
     {
-      sdferr << "Unknown parameter type[" << this->dataPtr->typeName << "]\n";
+      sdferr << "Invalid boolean value\n";
       return false;
     }
   }
-  // Catch invalid argument exception from std::stoi/stoul/stod/stof
-  catch(std::invalid_argument &)
+  else if (typeName == names.charType)
   {
-    sdferr << "Invalid argument. Unable to set value ["
-           << _value << " ] for key["
-           << this->dataPtr->key << "].\n";
-    return false;
+    this->dataPtr->value = tmp[0];
   }
-  // Catch out of range exception from std::stoi/stoul/stod/stof
-  catch(std::out_of_range &)
+  else if (typeName == names.intType)
   {
-    sdferr << "Out of range. Unable to set value ["
-           << _value << " ] for key["
-           << this->dataPtr->key << "].\n";
+    return ParseScalarValue<int>(tmp, _value, key,
+                                 this->dataPtr->value);
+  }
+  else if (typeName == names.uint64)
+  {
+    return ParseUsingFromChars<std::uint64_t>(tmp, key,
+                                              this->dataPtr->value);
+  }
+  else if (typeName == names.unsignedInt)
+  {
+    return ParseScalarValue<unsigned int>(tmp, _value, key,
+                                          this->dataPtr->value);
+  }
+  else if (typeName == names.doubleType)
+  {
+    return ParseScalarValue<double>(tmp, _value, key,
+                                    this->dataPtr->value);
+  }
+  else if (typeName == names.floatType)
+  {
+    return ParseScalarValue<float>(tmp, _value, key,
+                                   this->dataPtr->value);
+  }
+  else if (typeName == names.sdfTime ||
+           typeName == names.time)
+  {
+    return ParseUsingFromChars<sdf::Time>(tmp, key,
+                                          this->dataPtr->value);
+  }
+  else if (typeName == names.mathColor ||
+           typeName == names.color)
+  {
+    // The last value (the alpha) is optional.
+    return ParseUsingFromChars<ignition::math::Color>(
+        tmp, key, this->dataPtr->value);
+  }
+  else if (typeName == names.mathVector2i ||
+           typeName == names.vector2i)
+  {
+    return ParseUsingFromChars<ignition::math::Vector2i>(
+        tmp, key, this->dataPtr->value);
+  }
+  else if (typeName == names.mathVector2d ||
+           typeName == names.vector2d)
+  {
+    return ParseUsingFromChars<ignition::math::Vector2d>(
+        tmp, key, this->dataPtr->value);
+  }
+  else if (typeName == names.mathVector3d ||
+           typeName == names.vector3)
+  {
+    return ParseUsingFromChars<ignition::math::Vector3d>(
+        tmp, key, this->dataPtr->value);
+  }
+  else if (typeName == names.mathPose3d ||
+           typeName == names.pose ||
+           typeName == names.capitalPose)
+  {
+    if (!tmp.empty())
+    {
+      return ParseUsingFromChars<ignition::math::Pose3d>(
+          tmp, key, this->dataPtr->value);
+    }
+  }
+  else if (typeName == names.mathQuaterniond ||
+           typeName == names.quaternion)
+  {
+    return ParseUsingFromChars<ignition::math::Quaterniond>(
+        tmp, key, this->dataPtr->value);
+  }
+  else
+  {
+    sdferr << "Unknown parameter type[" << typeName << "]\n";
     return false;
   }
 
@@ -464,25 +1180,36 @@ bool Param::ValueFromString(const std::string &_value)
 //////////////////////////////////////////////////
 bool Param::SetFromString(const std::string &_value)
 {
-  std::string str = sdf::trim(_value.c_str());
+  return this->SetFromString(std::string(_value));
+}
+
+//////////////////////////////////////////////////
+bool Param::SetFromString(std::string &&_value)
+{
+  trimInPlace(_value);
 
-  if (str.empty() && this->dataPtr->required)
+  if (_value.empty() && this->dataPtr->schema->required)
   {
     sdferr << "Empty string used when setting a required parameter. Key["
            << this->GetKey() << "]\n";
     return false;
   }
-  else if (str.empty())
+  else if (_value.empty())
   {
-    this->dataPtr->value = this->dataPtr->defaultValue;
+    this->dataPtr->value = this->dataPtr->schema->defaultValue;
     return true;
   }
 
-  if (!this->ValueFromString(str))
-  {
+  // String values are moved into the parameter instead of being copied by
+  // ValueFromString.
+  const ParamTypeNames &names = paramTypeNames();
+  const InternedString &typeName = this->dataPtr->schema->typeName;
+  if (typeName == names.stdString || typeName == names.string)
+    setStringValue(std::move(_value), this->dataPtr->value);
+  else if (!this->ValueFromString(_value))
     return false;
-  }
 
+  LoadCounters::Add(&LoadCounters::paramsSet);
   this->dataPtr->set = true;
   return this->dataPtr->set;
 }
@@ -490,48 +1217,67 @@ bool Param::SetFromString(const std::string &_value)
 //////////////////////////////////////////////////
 void Param::Reset()
 {
-  this->dataPtr->value = this->dataPtr->defaultValue;
+  this->dataPtr->value = this->dataPtr->schema->defaultValue;
   this->dataPtr->set = false;
 }
 
 //////////////////////////////////////////////////
 ParamPtr Param::Clone() const
 {
-  ParamPtr clone(new Param(this->dataPtr->key, this->dataPtr->typeName,
-                            this->GetAsString(), this->dataPtr->required,
-                            this->dataPtr->description));
+  // Copy the private data directly instead of formatting the value as a
+  // string and parsing it again. As before, the current value becomes the
+  // default value of the clone, so the schema is shared unless the value
+  // differs from the default value.
+  ParamPtr clone = makeArenaShared(new Param);
   clone->dataPtr->set = this->dataPtr->set;
+  clone->dataPtr->value = this->dataPtr->value;
+  clone->dataPtr->schema =
+      schemaWithDefault(this->dataPtr->schema, this->dataPtr->value);
   return clone;
 }
 
 //////////////////////////////////////////////////
 const std::string &Param::GetTypeName() const
 {
-  return this->dataPtr->typeName;
+  return this->dataPtr->schema->typeName;
 }
 
 /////////////////////////////////////////////////
 void Param::SetDescription(const std::string &_desc)
 {
-  this->dataPtr->description = _desc;
+  if (this->dataPtr->schema->description == _desc)
+    return;
+
+  auto schema = std::make_shared<ParamPrivate::Schema>(*this->dataPtr->schema);
+  schema->description = _desc;
+  this->dataPtr->schema = schema;
 }
 
 /////////////////////////////////////////////////
 std::string Param::GetDescription() const
 {
-  return this->dataPtr->description;
+  return this->dataPtr->schema->description;
+}
+
+/////////////////////////////////////////////////
+std::size_t Param::MemoryFootprint() const
+{
+  std::size_t bytes = sizeof(Param) + sizeof(ParamPrivate);
+  if (const std::string *str = std::get_if<std::string>(&this->dataPtr->value))
+    bytes += heapBytes(*str);
+  return bytes;
 }
 
 /////////////////////////////////////////////////
 const std::string &Param::GetKey() const
 {
-  return this->dataPtr->key;
+  return this->dataPtr->schema->key;
 }
 
 /////////////////////////////////////////////////
 bool Param::GetRequired() const
 {
-  return this->dataPtr->required;
+  return this->dataPtr->schema->required;
 }
 
 /////////////////////////////////////////////////
@@ -17,6 +17,10 @@
 
 #include <any>
 #include <cstdint>
+#include <limits>
+#include <string>
+#include <utility>
+#include <vector>
 
 #include <gtest/gtest.h>
 
@@ -211,6 +215,82 @@ TEST(Param, HexDouble)
   EXPECT_DOUBLE_EQ(value, 0.123456789);
 }
 
+////////////////////////////////////////////////////
+/// Test that clones keep their own default value and description, although
+/// they share them with the original parameter until they change.
+TEST(Param, CloneSchema)
+{
+  sdf::Param param("key", "double", "1.5", true, "description");
+  sdf::ParamPtr clone = param.Clone();
+  EXPECT_EQ("key", clone->GetKey());
+  EXPECT_EQ("double", clone->GetTypeName());
+  EXPECT_EQ("1.5", clone->GetDefaultAsString());
+  EXPECT_TRUE(clone->GetRequired());
+
+  clone->SetDescription("other description");
+  EXPECT_EQ("other description", clone->GetDescription());
+  EXPECT_EQ("description", param.GetDescription());
+
+  // The current value of a parameter is the default value of its clones.
+  EXPECT_TRUE(param.Set(2.5));
+  sdf::ParamPtr setClone = param.Clone();
+  EXPECT_EQ("2.5", setClone->GetDefaultAsString());
+  EXPECT_EQ("1.5", param.GetDefaultAsString());
+  EXPECT_EQ("1.5", clone->GetDefaultAsString());
+  setClone->Reset();
+  EXPECT_EQ("2.5", setClone->GetAsString());
+
+  // Assignment copies the value and default value, but keeps the key.
+  sdf::Param other("other", "double", "0", false, "");
+  other = *setClone;
+  EXPECT_EQ("other", other.GetKey());
+  EXPECT_EQ("2.5", other.GetDefaultAsString());
+  EXPECT_FALSE(other.GetRequired());
+  param.Reset();
+  EXPECT_EQ("1.5", param.GetAsString());
+}
+
+////////////////////////////////////////////////////
+/// Test parsing scalars the way std::stoi, std::stoul and std::strtod do.
+TEST(Param, ScalarFromString)
+{
+  sdf::Param intParam("key", "int", "0", false, "description");
+  int intValue = 0;
+  EXPECT_TRUE(intParam.SetFromString("+12abc"));
+  EXPECT_TRUE(intParam.Get<int>(intValue));
+  EXPECT_EQ(12, intValue);
+  EXPECT_TRUE(intParam.SetFromString("-2147483648"));
+  EXPECT_TRUE(intParam.Get<int>(intValue));
+  EXPECT_EQ(std::numeric_limits<int>::min(), intValue);
+  EXPECT_FALSE(intParam.SetFromString("2147483648"));
+  EXPECT_FALSE(intParam.SetFromString("abc"));
+  EXPECT_FALSE(intParam.SetFromString("--1"));
+  EXPECT_TRUE(intParam.Get<int>(intValue));
+  EXPECT_EQ(std::numeric_limits<int>::min(), intValue);
+
+  // Negative unsigned values wrap around, as with std::stoul.
+  sdf::Param uintParam("key", "unsigned int", "0", false, "description");
+  unsigned int uintValue = 0;
+  EXPECT_TRUE(uintParam.SetFromString("-1"));
+  EXPECT_TRUE(uintParam.Get<unsigned int>(uintValue));
+  EXPECT_EQ(std::numeric_limits<unsigned int>::max(), uintValue);
+
+  sdf::Param doubleParam("key", "double", "0", false, "description");
+  double doubleValue = 0;
+  EXPECT_TRUE(doubleParam.SetFromString("-1.5e2 m"));
+  EXPECT_TRUE(doubleParam.Get<double>(doubleValue));
+  EXPECT_DOUBLE_EQ(-150.0, doubleValue);
+  EXPECT_EQ("-150", doubleParam.GetAsString());
+  EXPECT_TRUE(doubleParam.SetFromString("inf"));
+  EXPECT_TRUE(doubleParam.Get<double>(doubleValue));
+  EXPECT_EQ(std::numeric_limits<double>::infinity(), doubleValue);
+  EXPECT_TRUE(doubleParam.SetFromString("-Infinity"));
+  EXPECT_TRUE(doubleParam.Get<double>(doubleValue));
+  EXPECT_EQ(-std::numeric_limits<double>::infinity(), doubleValue);
+  EXPECT_FALSE(doubleParam.SetFromString(".e1"));
+  EXPECT_EQ("0", doubleParam.GetDefaultAsString());
+}
+
 ////////////////////////////////////////////////////
 /// Test setting and reading uint64_t values.
 TEST(Param, uint64t)
@@ -391,6 +471,277 @@ TEST(Param, SetTemplate)
   EXPECT_DOUBLE_EQ(value, 25.456);
 }
 
+////////////////////////////////////////////////////
+TEST(Param, SetGetTyped)
+{
+  // Values are stored without going through a string, so they keep their
+  // full precision.
+  sdf::Param doubleParam("key", "double", "1.0", false, "description");
+  EXPECT_FALSE(doubleParam.GetSet());
+  EXPECT_TRUE(doubleParam.Set(0.123456789012345));
+  EXPECT_TRUE(doubleParam.GetSet());
+  double doubleValue = 0;
+  EXPECT_TRUE(doubleParam.Get(doubleValue));
+  EXPECT_DOUBLE_EQ(0.123456789012345, doubleValue);
+
+  const ignition::math::Pose3d pose(1.123456789, 2, 3, 0.1, 0.2, 0.3);
+  sdf::Param poseParam("key", "pose", "0 0 0 0 0 0", false, "description");
+  EXPECT_TRUE(poseParam.Set(pose));
+  ignition::math::Pose3d poseValue;
+  EXPECT_TRUE(poseParam.Get(poseValue));
+  EXPECT_EQ(pose.Pos(), poseValue.Pos());
+  EXPECT_EQ(pose.Rot(), poseValue.Rot());
+
+  // Compatible numeric types are converted directly.
+  EXPECT_TRUE(doubleParam.Set(3));
+  EXPECT_TRUE(doubleParam.Get(doubleValue));
+  EXPECT_DOUBLE_EQ(3.0, doubleValue);
+  int intValue = 0;
+  EXPECT_TRUE(doubleParam.Get(intValue));
+  EXPECT_EQ(3, intValue);
+  float floatValue = 0;
+  EXPECT_TRUE(doubleParam.Get(floatValue));
+  EXPECT_FLOAT_EQ(3.0f, floatValue);
+
+  sdf::Param intParam("key", "int", "0", false, "description");
+  EXPECT_TRUE(intParam.Set(2.5));
+  EXPECT_TRUE(intParam.Get(intValue));
+  EXPECT_EQ(2, intValue);
+  std::uint64_t uint64Value = 0;
+  EXPECT_TRUE(intParam.Set(1234567));
+  EXPECT_TRUE(intParam.Get(uint64Value));
+  EXPECT_EQ(1234567u, uint64Value);
+  EXPECT_TRUE(intParam.Get(doubleValue));
+  EXPECT_DOUBLE_EQ(1234567.0, doubleValue);
+
+  sdf::Param uintParam("key", "unsigned int", "0", false, "description");
+  EXPECT_TRUE(uintParam.Set(std::uint64_t{42}));
+  unsigned int uintValue = 0;
+  EXPECT_TRUE(uintParam.Get(uintValue));
+  EXPECT_EQ(42u, uintValue);
+
+  // Strings are still parsed.
+  EXPECT_TRUE(intParam.Set(std::string(" 7 ")));
+  EXPECT_TRUE(intParam.Get(intValue));
+  EXPECT_EQ(7, intValue);
+  std::string stringValue;
+  EXPECT_TRUE(intParam.Get(stringValue));
+  EXPECT_EQ("7", stringValue);
+
+  // The default value is returned directly too.
+  sdf::Param defaultParam("key", "double", "0.5", false, "description");
+  EXPECT_TRUE(defaultParam.GetDefault(doubleValue));
+  EXPECT_DOUBLE_EQ(0.5, doubleValue);
+  EXPECT_TRUE(defaultParam.GetDefault(floatValue));
+  EXPECT_FLOAT_EQ(0.5f, floatValue);
+}
+
+////////////////////////////////////////////////////
+TEST(Param, CloneKeepsPrecision)
+{
+  sdf::Param doubleParam("key", "double", "1.0", true, "description");
+  EXPECT_TRUE(doubleParam.Set(0.123456789012345));
+
+  sdf::ParamPtr clone = doubleParam.Clone();
+  ASSERT_NE(nullptr, clone);
+  double value = 0;
+  EXPECT_TRUE(clone->Get(value));
+  EXPECT_DOUBLE_EQ(0.123456789012345, value);
+  EXPECT_TRUE(clone->GetDefault(value));
+  EXPECT_DOUBLE_EQ(0.123456789012345, value);
+  EXPECT_TRUE(clone->GetSet());
+  EXPECT_TRUE(clone->GetRequired());
+  EXPECT_EQ("key", clone->GetKey());
+  EXPECT_EQ("double", clone->GetTypeName());
+  EXPECT_EQ("description", clone->GetDescription());
+}
+
+////////////////////////////////////////////////////
+TEST(Param, ParseMathTypes)
+{
+  sdf::Param vectorParam("key", "vector3", "0 0 0", false, "description");
+  ignition::math::Vector3d vector;
+  EXPECT_TRUE(vectorParam.SetFromString(" +1.5\t-2e1\n.25 "));
+  EXPECT_TRUE(vectorParam.Get(vector));
+  EXPECT_EQ(ignition::math::Vector3d(1.5, -20, 0.25), vector);
+
+  // Text after the last value is ignored.
+  EXPECT_TRUE(vectorParam.SetFromString("1 2 3 4"));
+  EXPECT_TRUE(vectorParam.Get(vector));
+  EXPECT_EQ(ignition::math::Vector3d(1, 2, 3), vector);
+
+  EXPECT_FALSE(vectorParam.SetFromString("1 2"));
+  EXPECT_FALSE(vectorParam.SetFromString("1,2,3"));
+  EXPECT_FALSE(vectorParam.SetFromString("1 nan 3"));
+  EXPECT_FALSE(vectorParam.SetFromString("1 inf 3"));
+  EXPECT_FALSE(vectorParam.SetFromString("1 +-2 3"));
+  EXPECT_FALSE(vectorParam.SetFromString("1 1e400 3"));
+  EXPECT_TRUE(vectorParam.Get(vector));
+  EXPECT_EQ(ignition::math::Vector3d(1, 2, 3), vector);
+
+  sdf::Param vector2iParam("key", "vector2i", "0 0", false, "description");
+  ignition::math::Vector2i vector2i;
+  EXPECT_TRUE(vector2iParam.SetFromString("-3 4"));
+  EXPECT_TRUE(vector2iParam.Get(vector2i));
+  EXPECT_EQ(ignition::math::Vector2i(-3, 4), vector2i);
+  EXPECT_FALSE(vector2iParam.SetFromString("1.5 4"));
+
+  sdf::Param poseParam("key", "pose", "0 0 0 0 0 0", false, "description");
+  ignition::math::Pose3d pose;
+  EXPECT_TRUE(poseParam.SetFromString("1 2 3 0 0 1.5707"));
+  EXPECT_TRUE(poseParam.Get(pose));
+  EXPECT_EQ(ignition::math::Pose3d(1, 2, 3, 0, 0, 1.5707), pose);
+  EXPECT_FALSE(poseParam.SetFromString("1 2 3 0 0"));
+
+  sdf::Param quatParam("key", "quaternion", "0 0 0", false, "description");
+  ignition::math::Quaterniond quat;
+  EXPECT_TRUE(quatParam.SetFromString("0.1 0.2 0.3"));
+  EXPECT_TRUE(quatParam.Get(quat));
+  EXPECT_EQ(ignition::math::Quaterniond(0.1, 0.2, 0.3), quat);
+
+  // The alpha value of a color is optional.
+  sdf::Param colorParam("key", "color", "0 0 0 1", false, "description");
+  ignition::math::Color color;
+  EXPECT_TRUE(colorParam.SetFromString("0.1 0.2 0.3"));
+  EXPECT_TRUE(colorParam.Get(color));
+  EXPECT_EQ(ignition::math::Color(0.1f, 0.2f, 0.3f, 1.0f), color);
+  EXPECT_TRUE(colorParam.SetFromString("0.1 0.2 0.3 0.4"));
+  EXPECT_TRUE(colorParam.Get(color));
+  EXPECT_EQ(ignition::math::Color(0.1f, 0.2f, 0.3f, 0.4f), color);
+  EXPECT_FALSE(colorParam.SetFromString("0.1 0.2"));
+  EXPECT_FALSE(colorParam.SetFromString("0.1 0.2 0.3 x"));
+
+  sdf::Param timeParam("key", "time", "0 0", false, "description");
+  sdf::Time time;
+  EXPECT_TRUE(timeParam.SetFromString("12 345"));
+  EXPECT_TRUE(timeParam.Get(time));
+  EXPECT_EQ(sdf::Time(12, 345), time);
+  EXPECT_FALSE(timeParam.SetFromString("12"));
+  EXPECT_FALSE(timeParam.SetFromString("12 3000000000"));
+
+  sdf::Param uint64Param("key", "uint64_t", "0", false, "description");
+  std::uint64_t uint64Value = 0;
+  EXPECT_TRUE(uint64Param.SetFromString("+42"));
+  EXPECT_TRUE(uint64Param.Get(uint64Value));
+  EXPECT_EQ(42u, uint64Value);
+  EXPECT_FALSE(uint64Param.SetFromString("18446744073709551616"));
+  EXPECT_FALSE(uint64Param.SetFromString("abc"));
+}
+
+/////////////////////////////////////////////////
+TEST(Param, AppendAsString)
+{
+  // AppendAsString formats values exactly like GetAsString.
+  const std::vector<std::pair<std::string, std::vector<std::string>>> values =
+  {
+    {"bool", {"true", "false", "1", "0"}},
+    {"char", {"a", "Z"}},
+    {"string", {"", "some text"}},
+    {"int", {"0", "-1", "2147483647", "-2147483648"}},
+    {"unsigned int", {"0", "4294967295"}},
+    {"uint64_t", {"18446744073709551615"}},
+    {"double", {"0", "-0", "1", "0.1", "1e-7", "123456789", "3.14159265358979",
+                "-2.5e+300", "1e6", "100000", "0.0001", "0.00001"}},
+    {"float", {"0", "0.1", "1.5e-20", "-3.40282e+38", "16777216"}},
+    {"vector3", {"0.1 0.2 0.3"}},
+    {"pose", {"1 2 3 0.1 0.2 0.3"}},
+    {"color", {"0.1 0.2 0.3 1"}},
+    {"time", {"12 345"}},
+  };
+  for (const auto &typeValues : values)
+  {
+    for (const auto &value : typeValues.second)
+    {
+      sdf::Param param("key", typeValues.first, value, false, "description");
+      std::string appended = "prefix";
+      param.AppendAsString(appended);
+      EXPECT_EQ("prefix" + param.GetAsString(), appended)
+        << typeValues.first << " " << value;
+    }
+  }
+
+  sdf::Param doubleParam("key", "double", "0", false, "description");
+  for (const double value : {std::numeric_limits<double>::infinity(),
+        -std::numeric_limits<double>::infinity(),
+        std::numeric_limits<double>::quiet_NaN(),
+        std::numeric_limits<double>::min(),
+        std::numeric_limits<double>::max(),
+        std::numeric_limits<double>::denorm_min()})
+  {
+    EXPECT_TRUE(doubleParam.Set(value));
+    std::string appended;
+    doubleParam.AppendAsString(appended);
+    EXPECT_EQ(doubleParam.GetAsString(), appended);
+  }
+}
+
+/////////////////////////////////////////////////
+TEST(Param, SetFromStringMove)
+{
+  // A large string value is moved into the parameter, and trimmed like
+  // values set from a copied string.
+  sdf::Param stringParam("key", "string", "default", false, "description");
+  const std::string large(1 << 20, 'x');
+  EXPECT_TRUE(stringParam.SetFromString(" \t" + large + " "));
+  EXPECT_TRUE(stringParam.GetSet());
+  EXPECT_EQ(large, stringParam.GetAsString());
+
+  EXPECT_TRUE(stringParam.SetFromString(std::string(" TRUE ")));
+  EXPECT_EQ("1", stringParam.GetAsString());
+  EXPECT_TRUE(stringParam.SetFromString(std::string("False")));
+  EXPECT_EQ("0", stringParam.GetAsString());
+
+  EXPECT_TRUE(stringParam.SetFromString(std::string(" \t ")));
+  EXPECT_EQ("default", stringParam.GetAsString());
+
+  sdf::Param requiredParam("key", "string", "", true, "description");
+  EXPECT_FALSE(requiredParam.SetFromString(std::string("  ")));
+
+  // Other types are parsed as before.
+  sdf::Param intParam("key", "int", "0", false, "description");
+  EXPECT_TRUE(intParam.SetFromString(std::string(" 42 ")));
+  int value = 0;
+  EXPECT_TRUE(intParam.Get(value));
+  EXPECT_EQ(42, value);
+  EXPECT_FALSE(intParam.SetFromString(std::string("forty-two")));
+}
+
+/////////////////////////////////////////////////
+TEST(Param, UpdateFunc)
+{
+  sdf::Param doubleParam("key", "double", "0", false, "description");
+  EXPECT_FALSE(doubleParam.HasUpdateFunc());
+
+  // A function returning the type of the parameter is called directly.
+  double source = 1.5;
+  doubleParam.SetUpdateFunc([&source]() { return source; });
+  EXPECT_TRUE(doubleParam.HasUpdateFunc());
+  doubleParam.Update();
+  double value = 0;
+  EXPECT_TRUE(doubleParam.Get(value));
+  EXPECT_DOUBLE_EQ(1.5, value);
+
+  // Numbers are converted to the type of the parameter.
+  doubleParam.SetUpdateFunc([]() { return 3; });
+  doubleParam.Update();
+  EXPECT_TRUE(doubleParam.Get(value));
+  EXPECT_DOUBLE_EQ(3.0, value);
+
+  // Results that do not fit leave the value unchanged.
+  sdf::Param intParam("key", "int", "2", false, "description");
+  intParam.SetUpdateFunc([]() { return std::string("text"); });
+  intParam.Update();
+  int intValue = 0;
+  EXPECT_TRUE(intParam.Get(intValue));
+  EXPECT_EQ(2, intValue);
+
+  // Functions returning a std::any are still supported.
+  intParam.SetUpdateFunc([]() { return std::any(7); });
+  intParam.Update();
+  EXPECT_TRUE(intParam.Get(intValue));
+  EXPECT_EQ(7, intValue);
+}
+
 /////////////////////////////////////////////////
 /// Main
 int main(int argc, char **argv)
@@ -0,0 +1,53 @@
+/*
+ * Copyright 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <mutex>
+#include <utility>
+
+#include "sdf/ParseEvent.hh"
+#include "sdf/ParserConfig.hh"
+#include "Utils.hh"
+
+namespace sdf
+{
+inline namespace SDF_VERSION_NAMESPACE
+{
+/// \brief The callback set with setParseEventCallback.
+static ParseEventCallback g_parseEventCB;
+
+/// \brief Guards g_parseEventCB.
+static std::mutex g_parseEventMutex;
+
+/////////////////////////////////////////////////
+void setParseEventCallback(ParseEventCallback _cb)
+{
+  std::lock_guard<std::mutex> lock(g_parseEventMutex);
+  g_parseEventCB = std::move(_cb);
+}
+
+/////////////////////////////////////////////////
+ParseEventCallback parseEventCallback()
+{
+  const ParserConfig *config = currentParserConfig();
+  if (config && config->ParseEventCallback())
+    return config->ParseEventCallback();
+
+  std::lock_guard<std::mutex> lock(g_parseEventMutex);
+  return g_parseEventCB;
+}
+}
+}
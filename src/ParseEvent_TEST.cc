@@ -0,0 +1,189 @@
+/*
+ * Copyright 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "sdf/Filesystem.hh"
+#include "sdf/ParseEvent.hh"
+#include "sdf/Root.hh"
+#include "sdf/SDFImpl.hh"
+#include "sdf/parser.hh"
+#include "test_config.h"
+
+/////////////////////////////////////////////////
+/// \brief Records the parse events while it exists.
+class EventRecorder
+{
+  public: EventRecorder()
+  {
+    sdf::setParseEventCallback([this](const sdf::ParseEvent &_event)
+    {
+      this->events.push_back(_event);
+    });
+  }
+
+  public: ~EventRecorder()
+  {
+    sdf::setParseEventCallback(nullptr);
+  }
+
+  /// \brief Get the END events of a stage.
+  public: std::vector<sdf::ParseEvent> Ends(sdf::ParseStage _stage) const
+  {
+    std::vector<sdf::ParseEvent> result;
+    for (const auto &event : this->events)
+    {
+      if (event.stage == _stage && event.type == sdf::ParseEventType::END)
+        result.push_back(event);
+    }
+    return result;
+  }
+
+  /// \brief Check that every BEGIN event is followed by a matching END
+  /// event, and that stages nest.
+  public: void ExpectNested() const
+  {
+    std::vector<sdf::ParseEvent> stack;
+    for (const auto &event : this->events)
+    {
+      if (event.type == sdf::ParseEventType::BEGIN)
+      {
+        stack.push_back(event);
+        continue;
+      }
+      ASSERT_FALSE(stack.empty());
+      EXPECT_EQ(stack.back().stage, event.stage);
+      EXPECT_STREQ(stack.back().name, event.name);
+      stack.pop_back();
+    }
+    EXPECT_TRUE(stack.empty());
+  }
+
+  public: std::vector<sdf::ParseEvent> events;
+};
+
+/////////////////////////////////////////////////
+TEST(ParseEvent, SetCallback)
+{
+  EXPECT_FALSE(sdf::parseEventCallback());
+
+  int count = 0;
+  sdf::setParseEventCallback([&count](const sdf::ParseEvent &)
+  {
+    ++count;
+  });
+  ASSERT_TRUE(sdf::parseEventCallback());
+  sdf::parseEventCallback()(sdf::ParseEvent());
+  EXPECT_EQ(1, count);
+
+  sdf::setParseEventCallback(nullptr);
+  EXPECT_FALSE(sdf::parseEventCallback());
+
+  // No events are reported without a callback.
+  sdf::Root root;
+  EXPECT_TRUE(root.Load(sdf::filesystem::append(PROJECT_SOURCE_PATH, "test",
+      "integration", "model", "box", "model.sdf")).empty());
+  EXPECT_EQ(1, count);
+}
+
+/////////////////////////////////////////////////
+TEST(ParseEvent, LoadFile)
+{
+  const std::string filename = sdf::filesystem::append(PROJECT_SOURCE_PATH,
+      "test", "integration", "model", "box", "model.sdf");
+
+  EventRecorder recorder;
+  sdf::Root root;
+  EXPECT_TRUE(root.Load(filename).empty());
+  EXPECT_TRUE(sdf::checkPoseRelativeToGraph(&root));
+  recorder.ExpectNested();
+
+  auto readFile = recorder.Ends(sdf::ParseStage::READ_FILE);
+  ASSERT_EQ(1u, readFile.size());
+  EXPECT_EQ(filename, readFile[0].path);
+  EXPECT_STREQ("sdf::readFile", readFile[0].name);
+  EXPECT_LT(0u, readFile[0].elementCount);
+
+  auto findFile = recorder.Ends(sdf::ParseStage::FIND_FILE);
+  ASSERT_EQ(1u, findFile.size());
+  EXPECT_EQ(filename, findFile[0].path);
+
+  auto parseXml = recorder.Ends(sdf::ParseStage::PARSE_XML);
+  ASSERT_EQ(1u, parseXml.size());
+  EXPECT_LT(0u, parseXml[0].elementCount);
+
+  // The file is version 1.5, so it is converted.
+  auto convert = recorder.Ends(sdf::ParseStage::CONVERT);
+  ASSERT_EQ(1u, convert.size());
+  EXPECT_EQ(filename, convert[0].path);
+  EXPECT_LT(0u, convert[0].elementCount);
+
+  auto readDoc = recorder.Ends(sdf::ParseStage::READ_DOC);
+  ASSERT_EQ(1u, readDoc.size());
+  EXPECT_EQ(readFile[0].elementCount, readDoc[0].elementCount);
+
+  auto rootLoad = recorder.Ends(sdf::ParseStage::ROOT_LOAD);
+  ASSERT_EQ(1u, rootLoad.size());
+  EXPECT_EQ(filename, rootLoad[0].path);
+  EXPECT_EQ(readFile[0].elementCount, rootLoad[0].elementCount);
+
+  auto check = recorder.Ends(sdf::ParseStage::CHECK);
+  ASSERT_EQ(1u, check.size());
+  EXPECT_STREQ("sdf::checkPoseRelativeToGraph", check[0].name);
+  EXPECT_EQ(filename, check[0].path);
+  EXPECT_EQ(readFile[0].elementCount, check[0].elementCount);
+
+  EXPECT_TRUE(recorder.Ends(sdf::ParseStage::INCLUDE).empty());
+}
+
+/////////////////////////////////////////////////
+TEST(ParseEvent, Include)
+{
+  const std::string modelDir = sdf::filesystem::append(PROJECT_SOURCE_PATH,
+      "test", "integration", "model");
+  sdf::addURIPath("model://", modelDir);
+
+  const std::string sdfString =
+    "<sdf version='" SDF_VERSION "'>"
+    "  <world name='default'>"
+    "    <include><uri>model://box</uri></include>"
+    "  </world>"
+    "</sdf>";
+
+  EventRecorder recorder;
+  sdf::Root root;
+  EXPECT_TRUE(root.LoadSdfString(sdfString).empty());
+  recorder.ExpectNested();
+
+  auto include = recorder.Ends(sdf::ParseStage::INCLUDE);
+  ASSERT_EQ(1u, include.size());
+  EXPECT_STREQ("sdf::readXml", include[0].name);
+  EXPECT_EQ(sdf::filesystem::append(modelDir, "box", "model.sdf"),
+      include[0].path);
+  EXPECT_LT(0u, include[0].elementCount);
+  EXPECT_EQ("model://box", include[0].uri);
+
+  // The string and the included file are each parsed and read once.
+  EXPECT_EQ(2u, recorder.Ends(sdf::ParseStage::PARSE_XML).size());
+  EXPECT_EQ(2u, recorder.Ends(sdf::ParseStage::READ_DOC).size());
+  EXPECT_EQ(1u, recorder.Ends(sdf::ParseStage::READ_FILE).size());
+  EXPECT_EQ(2u, recorder.Ends(sdf::ParseStage::FIND_FILE).size());
+  EXPECT_EQ(1u, recorder.Ends(sdf::ParseStage::ROOT_LOAD).size());
+}
@@ -0,0 +1,312 @@
+/*
+ * Copyright 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "sdf/ParseTrace.hh"
+
+using namespace sdf;
+
+/// \brief An event recorded by a ParseTrace.
+struct TraceRecord
+{
+  /// \brief The event.
+  ParseEvent event;
+
+  /// \brief Time of the event.
+  std::chrono::steady_clock::time_point time;
+
+  /// \brief Index of the thread of the event, in the order the threads
+  /// were first seen.
+  std::size_t thread = 0;
+};
+
+/// \brief Private data for ParseTrace.
+class sdf::ParseTracePrivate
+{
+  /// \brief The recorded events, in the order they were recorded.
+  public: std::vector<TraceRecord> records;
+
+  /// \brief Index of each thread that recorded events.
+  public: std::map<std::thread::id, std::size_t> threads;
+
+  /// \brief Time of the first event, from which times are exported.
+  public: std::chrono::steady_clock::time_point start;
+
+  /// \brief Mutex protecting the other members.
+  public: mutable std::mutex mutex;
+};
+
+/////////////////////////////////////////////////
+/// \brief Get the name of a stage in a trace.
+/// \param[in] _stage The stage.
+/// \return The name.
+static const char *stageName(ParseStage _stage)
+{
+  switch (_stage)
+  {
+    case ParseStage::READ_FILE:
+      return "read_file";
+    case ParseStage::FIND_FILE:
+      return "find_file";
+    case ParseStage::PARSE_XML:
+      return "parse_xml";
+    case ParseStage::READ_DOC:
+      return "read_doc";
+    case ParseStage::CONVERT:
+      return "convert";
+    case ParseStage::INCLUDE:
+      return "include";
+    case ParseStage::ROOT_LOAD:
+      return "root_load";
+    case ParseStage::CHECK:
+      return "check";
+    default:
+      return "unknown";
+  }
+}
+
+/////////////////////////////////////////////////
+/// \brief Write a string as a JSON string.
+/// \param[in,out] _out Stream to write to.
+/// \param[in] _str The string.
+static void writeJsonString(std::ostream &_out, const std::string &_str)
+{
+  _out << '"';
+  for (char c : _str)
+  {
+    if (c == '"' || c == '\\')
+      _out << '\\' << c;
+    else if (static_cast<unsigned char>(c) < 0x20)
+    {
+      _out << "\\u" << std::hex << std::setw(4) << std::setfill('0')
+           << static_cast<int>(c) << std::dec << std::setfill(' ');
+    }
+    else
+      _out << c;
+  }
+  _out << '"';
+}
+
+/////////////////////////////////////////////////
+ParseTrace::ParseTrace()
+  : dataPtr(new ParseTracePrivate)
+{
+}
+
+/////////////////////////////////////////////////
+ParseTrace::~ParseTrace()
+{
+  delete this->dataPtr;
+  this->dataPtr = nullptr;
+}
+
+/////////////////////////////////////////////////
+ParseEventCallback ParseTrace::Callback()
+{
+  return [this](const ParseEvent &_event)
+  {
+    this->Record(_event);
+  };
+}
+
+/////////////////////////////////////////////////
+void ParseTrace::Record(const ParseEvent &_event)
+{
+  TraceRecord record;
+  record.event = _event;
+  record.time = std::chrono::steady_clock::now();
+
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  if (this->dataPtr->records.empty())
+    this->dataPtr->start = record.time;
+  record.thread = this->dataPtr->threads.emplace(std::this_thread::get_id(),
+      this->dataPtr->threads.size()).first->second;
+  this->dataPtr->records.push_back(std::move(record));
+}
+
+/////////////////////////////////////////////////
+void ParseTrace::Clear()
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  this->dataPtr->records.clear();
+  this->dataPtr->threads.clear();
+}
+
+/////////////////////////////////////////////////
+std::size_t ParseTrace::EventCount() const
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  return this->dataPtr->records.size();
+}
+
+/////////////////////////////////////////////////
+std::vector<IncludeTraceNode> ParseTrace::IncludeTree() const
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+
+  // The nodes are built in a flat list, in the order they begin, and
+  // linked to their parent by index.
+  struct FlatNode
+  {
+    IncludeTraceNode node;
+    int parent = -1;
+    bool hasFile = false;
+  };
+  std::vector<FlatNode> nodes;
+
+  // An open stage of a thread, and the node it belongs to.
+  struct Frame
+  {
+    ParseStage stage;
+    int node;
+    bool ownsNode;
+    std::chrono::steady_clock::time_point begin;
+  };
+  std::map<std::size_t, std::vector<Frame>> stacks;
+
+  for (const TraceRecord &record : this->dataPtr->records)
+  {
+    const ParseEvent &event = record.event;
+    std::vector<Frame> &stack = stacks[record.thread];
+    const int current = stack.empty() ? -1 : stack.back().node;
+
+    if (event.type == ParseEventType::BEGIN)
+    {
+      Frame frame{event.stage, current, false, record.time};
+      if (event.stage == ParseStage::INCLUDE ||
+          (event.stage == ParseStage::READ_FILE &&
+           (current < 0 || nodes[current].hasFile)))
+      {
+        // A new file, unless it is the file of an include that did not
+        // read one yet.
+        FlatNode flat;
+        flat.parent = current;
+        flat.node.uri = event.path;
+        nodes.push_back(flat);
+        frame.node = static_cast<int>(nodes.size()) - 1;
+        frame.ownsNode = true;
+      }
+      if (event.stage == ParseStage::READ_FILE && frame.node >= 0)
+        nodes[frame.node].hasFile = true;
+      stack.push_back(frame);
+      continue;
+    }
+
+    // Ignore unbalanced events, such as those of stages that began before
+    // the callback was set.
+    if (stack.empty() || stack.back().stage != event.stage)
+      continue;
+
+    const Frame frame = stack.back();
+    stack.pop_back();
+    if (frame.node < 0)
+      continue;
+
+    IncludeTraceNode &node = nodes[frame.node].node;
+    const auto duration =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            record.time - frame.begin);
+    switch (event.stage)
+    {
+      case ParseStage::PARSE_XML:
+        node.parseTime += duration;
+        node.bytes += event.bytes;
+        break;
+      case ParseStage::CONVERT:
+        node.conversionTime += duration;
+        break;
+      case ParseStage::READ_FILE:
+        node.path = event.path;
+        node.elementCount = event.elementCount;
+        break;
+      case ParseStage::INCLUDE:
+        if (!event.uri.empty())
+          node.uri = event.uri;
+        if (node.path.empty())
+          node.path = event.path;
+        break;
+      default:
+        break;
+    }
+    if (frame.ownsNode)
+      node.duration = duration;
+  }
+
+  // Link the nodes, from the last one so that each is complete before it
+  // is moved into its parent, and then restore the document order.
+  std::vector<IncludeTraceNode> roots;
+  for (int i = static_cast<int>(nodes.size()) - 1; i >= 0; --i)
+  {
+    IncludeTraceNode &node = nodes[i].node;
+    std::reverse(node.children.begin(), node.children.end());
+    if (nodes[i].parent >= 0)
+      nodes[nodes[i].parent].node.children.push_back(std::move(node));
+    else
+      roots.push_back(std::move(node));
+  }
+  std::reverse(roots.begin(), roots.end());
+  return roots;
+}
+
+/////////////////////////////////////////////////
+std::string ParseTrace::ChromeTraceJson() const
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+
+  std::ostringstream out;
+  out << "{\"traceEvents\": [";
+  bool first = true;
+  for (const TraceRecord &record : this->dataPtr->records)
+  {
+    const ParseEvent &event = record.event;
+    const auto micros = std::chrono::duration_cast<std::chrono::microseconds>(
+        record.time - this->dataPtr->start).count();
+
+    out << (first ? "\n" : ",\n") << "{\"name\": ";
+    first = false;
+    writeJsonString(out, event.name);
+    out << ", \"cat\": \"" << stageName(event.stage) << "\", \"ph\": \""
+        << (event.type == ParseEventType::BEGIN ? 'B' : 'E')
+        << "\", \"ts\": " << micros << ", \"pid\": 1, \"tid\": "
+        << record.thread << ", \"args\": {\"path\": ";
+    writeJsonString(out, event.path);
+    if (event.type == ParseEventType::END)
+    {
+      out << ", \"elements\": " << event.elementCount;
+      if (!event.uri.empty())
+      {
+        out << ", \"uri\": ";
+        writeJsonString(out, event.uri);
+      }
+      if (event.bytes > 0)
+        out << ", \"bytes\": " << event.bytes;
+    }
+    out << "}}";
+  }
+  out << "\n], \"displayTimeUnit\": \"ms\"}\n";
+  return out.str();
+}
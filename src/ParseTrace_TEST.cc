@@ -0,0 +1,162 @@
+/*
+ * Copyright 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "sdf/Filesystem.hh"
+#include "sdf/ParseTrace.hh"
+#include "sdf/Root.hh"
+#include "sdf/SDFImpl.hh"
+#include "sdf/parser.hh"
+#include "test_config.h"
+
+/////////////////////////////////////////////////
+/// \brief Record an event in a trace.
+/// \param[in,out] _trace The trace.
+/// \param[in] _type Type of the event.
+/// \param[in] _stage Stage of the event.
+/// \param[in] _path Path of the event.
+/// \param[in] _elementCount Number of elements of the event.
+/// \param[in] _bytes Size of the file of the event.
+/// \param[in] _uri URI of the event.
+void record(sdf::ParseTrace &_trace, sdf::ParseEventType _type,
+    sdf::ParseStage _stage, const std::string &_path = "",
+    std::size_t _elementCount = 0, std::size_t _bytes = 0,
+    const std::string &_uri = "")
+{
+  sdf::ParseEvent event;
+  event.type = _type;
+  event.stage = _stage;
+  event.name = "name";
+  event.path = _path;
+  event.elementCount = _elementCount;
+  event.bytes = _bytes;
+  event.uri = _uri;
+  _trace.Record(event);
+}
+
+/////////////////////////////////////////////////
+TEST(ParseTrace, IncludeTree)
+{
+  using sdf::ParseEventType;
+  using sdf::ParseStage;
+
+  sdf::ParseTrace trace;
+  EXPECT_TRUE(trace.IncludeTree().empty());
+
+  // A world file with an include that is read, and one that is cached.
+  record(trace, ParseEventType::BEGIN, ParseStage::READ_FILE, "world.sdf");
+  record(trace, ParseEventType::BEGIN, ParseStage::PARSE_XML, "/w/world.sdf");
+  record(trace, ParseEventType::END, ParseStage::PARSE_XML, "/w/world.sdf",
+      30, 1000);
+  record(trace, ParseEventType::BEGIN, ParseStage::INCLUDE);
+  record(trace, ParseEventType::BEGIN, ParseStage::FIND_FILE, "model://m");
+  record(trace, ParseEventType::END, ParseStage::FIND_FILE, "/m");
+  record(trace, ParseEventType::BEGIN, ParseStage::READ_FILE, "/m/model.sdf");
+  record(trace, ParseEventType::BEGIN, ParseStage::PARSE_XML, "/m/model.sdf");
+  record(trace, ParseEventType::END, ParseStage::PARSE_XML, "/m/model.sdf",
+      5, 200);
+  record(trace, ParseEventType::BEGIN, ParseStage::CONVERT);
+  record(trace, ParseEventType::END, ParseStage::CONVERT);
+  record(trace, ParseEventType::END, ParseStage::READ_FILE, "/m/model.sdf",
+      6);
+  record(trace, ParseEventType::END, ParseStage::INCLUDE, "/m/model.sdf", 6,
+      0, "model://m");
+  record(trace, ParseEventType::BEGIN, ParseStage::INCLUDE);
+  record(trace, ParseEventType::END, ParseStage::INCLUDE, "/m/model.sdf", 6,
+      0, "model://m");
+  record(trace, ParseEventType::END, ParseStage::READ_FILE, "/w/world.sdf",
+      40);
+  EXPECT_EQ(16u, trace.EventCount());
+
+  std::vector<sdf::IncludeTraceNode> tree = trace.IncludeTree();
+  ASSERT_EQ(1u, tree.size());
+  const sdf::IncludeTraceNode &world = tree[0];
+  EXPECT_EQ("world.sdf", world.uri);
+  EXPECT_EQ("/w/world.sdf", world.path);
+  EXPECT_EQ(1000u, world.bytes);
+  EXPECT_EQ(40u, world.elementCount);
+  EXPECT_LE(world.parseTime, world.duration);
+  ASSERT_EQ(2u, world.children.size());
+
+  const sdf::IncludeTraceNode &model = world.children[0];
+  EXPECT_EQ("model://m", model.uri);
+  EXPECT_EQ("/m/model.sdf", model.path);
+  EXPECT_EQ(200u, model.bytes);
+  EXPECT_EQ(6u, model.elementCount);
+  EXPECT_LE(model.parseTime + model.conversionTime, model.duration);
+  EXPECT_LE(model.duration, world.duration);
+  EXPECT_TRUE(model.children.empty());
+
+  const sdf::IncludeTraceNode &cached = world.children[1];
+  EXPECT_EQ("model://m", cached.uri);
+  EXPECT_EQ("/m/model.sdf", cached.path);
+  EXPECT_EQ(0u, cached.bytes);
+
+  // The events are exported as pairs of begin and end events.
+  const std::string json = trace.ChromeTraceJson();
+  EXPECT_EQ(0u, json.find("{\"traceEvents\": ["));
+  std::size_t begins = 0;
+  std::size_t ends = 0;
+  for (std::size_t pos = json.find("\"ph\": \""); pos != std::string::npos;
+       pos = json.find("\"ph\": \"", pos + 1))
+  {
+    const char phase = json[pos + 7];
+    begins += phase == 'B';
+    ends += phase == 'E';
+  }
+  EXPECT_EQ(8u, begins);
+  EXPECT_EQ(8u, ends);
+  EXPECT_NE(std::string::npos, json.find("\"uri\": \"model://m\""));
+  EXPECT_NE(std::string::npos, json.find("\"bytes\": 200"));
+
+  trace.Clear();
+  EXPECT_EQ(0u, trace.EventCount());
+}
+
+/////////////////////////////////////////////////
+TEST(ParseTrace, LoadInclude)
+{
+  const std::string modelDir = sdf::filesystem::append(PROJECT_SOURCE_PATH,
+      "test", "integration", "model");
+  sdf::addURIPath("model://", modelDir);
+
+  const std::string sdfString =
+    "<sdf version='" SDF_VERSION "'>"
+    "  <world name='default'>"
+    "    <include><uri>model://box</uri></include>"
+    "  </world>"
+    "</sdf>";
+
+  sdf::ParseTrace trace;
+  sdf::setParseEventCallback(trace.Callback());
+  sdf::Root root;
+  EXPECT_TRUE(root.LoadSdfString(sdfString).empty());
+  sdf::setParseEventCallback(nullptr);
+
+  // The string is not a file, so the include is the root of the tree.
+  std::vector<sdf::IncludeTraceNode> tree = trace.IncludeTree();
+  ASSERT_EQ(1u, tree.size());
+  EXPECT_EQ("model://box", tree[0].uri);
+  EXPECT_EQ(sdf::filesystem::append(modelDir, "box", "model.sdf"),
+      tree[0].path);
+  EXPECT_LT(0u, tree[0].bytes);
+  EXPECT_LT(0u, tree[0].elementCount);
+}
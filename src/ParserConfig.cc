@@ -0,0 +1,525 @@
+/*
+ * Copyright 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "sdf/Filesystem.hh"
+#include "sdf/ParserConfig.hh"
+#include "sdf/Types.hh"
+
+using namespace sdf;
+
+/// \brief Private data for ParserConfig.
+class sdf::ParserConfigPrivate
+{
+  /// \brief Cache for files read through <include> elements.
+  public: std::shared_ptr<sdf::IncludeCache> includeCache;
+
+  /// \brief True if sdf::Root builds its DOM objects on first access.
+  public: bool lazyDomLoading = false;
+
+  /// \brief True if URDF is converted directly to an element tree.
+  public: bool directUrdfConversion = false;
+
+  /// \brief Number of threads used to load the models of a world.
+  public: unsigned int modelLoadThreadCount = 1;
+
+  /// \brief Number of threads used to prefetch included files.
+  public: unsigned int includeThreadCount = 1;
+
+  /// \brief Number of threads used to read the children of a world.
+  public: unsigned int readThreadCount = 1;
+
+  /// \brief True if element trees are allocated from an arena.
+  public: bool arenaAllocation = false;
+
+  /// \brief True if sdf::Root releases the elements after loading.
+  public: bool releaseElements = false;
+
+  /// \brief True if visuals share identical materials.
+  public: bool shareMaterials = false;
+
+  /// \brief True if copied elements are kept as XML until accessed.
+  public: bool deferCopiedElements = false;
+
+  /// \brief Checks run by sdf::Root while building DOM objects.
+  public: ValidationLevel validation = ValidationLevel::FULL;
+
+  /// \brief Number of errors after which sdf::Root stops loading, or 0.
+  public: std::size_t maxErrors = 0;
+
+  /// \brief Number of times the same warning is printed, or 0.
+  public: std::size_t warningRepeatLimit = 1;
+
+  /// \brief Number of different warnings of a kind printed, or 0.
+  public: std::size_t warningSiteLimit = 0;
+
+  /// \brief Function called with each error by sdf::Root, if any.
+  public: std::function<void(const Error &)> errorCallback;
+
+  /// \brief Function called with the progress of a load, if any.
+  public: std::function<void(const LoadProgress &)> progressCallback;
+
+  /// \brief Function that tells whether a load should stop, if any.
+  public: std::function<bool()> cancelCallback;
+
+  /// \brief Function that runs the tasks of parallel stages, if any.
+  public: std::function<void(std::function<void()>)> executor;
+
+  /// \brief Function that selects the models of worlds to read, if any.
+  public: std::function<bool(const ModelCandidate &)> modelFilter;
+
+  /// \brief Function that selects the worlds to read, if any.
+  public: std::function<bool(const std::string &)> worldFilter;
+
+  /// \brief True if sdf::Root::Load reads worlds on demand.
+  public: bool worldsOnDemand = false;
+
+  /// \brief Version documents are read as, or empty for SDF::Version.
+  public: std::string specVersion;
+
+  /// \brief Physics profile loaded by worlds, or empty for all of them.
+  public: std::string physicsProfile;
+
+  /// \brief Parts of a document that are read and loaded.
+  public: ParseScope parseScope = ParseScope::FULL;
+
+  /// \brief Number of models of each world read with FIRST_MODELS.
+  public: std::size_t scopeModelCount = 1;
+
+  /// \brief Deepest nesting of elements that is read, or 0 for no limit.
+  public: std::size_t maxNestingDepth = 256;
+
+  /// \brief Paths associated to URIs.
+  public: std::map<std::string, std::vector<std::string>> uriPaths;
+
+  /// \brief Function used when a file is not found, if any.
+  public: std::function<std::string(const std::string &)> findFileCallback;
+
+  /// \brief Function the parse events are reported to, if any.
+  public: sdf::ParseEventCallback parseEventCallback;
+};
+
+/////////////////////////////////////////////////
+ParserConfig::ParserConfig()
+  : dataPtr(new ParserConfigPrivate)
+{
+}
+
+/////////////////////////////////////////////////
+ParserConfig::~ParserConfig()
+{
+  delete this->dataPtr;
+  this->dataPtr = nullptr;
+}
+
+/////////////////////////////////////////////////
+ParserConfig::ParserConfig(const ParserConfig &_config)
+  : dataPtr(new ParserConfigPrivate(*_config.dataPtr))
+{
+}
+
+/////////////////////////////////////////////////
+ParserConfig::ParserConfig(ParserConfig &&_config) noexcept
+  : dataPtr(std::exchange(_config.dataPtr, nullptr))
+{
+}
+
+/////////////////////////////////////////////////
+ParserConfig &ParserConfig::operator=(const ParserConfig &_config)
+{
+  return *this = ParserConfig(_config);
+}
+
+/////////////////////////////////////////////////
+ParserConfig &ParserConfig::operator=(ParserConfig &&_config)
+{
+  std::swap(this->dataPtr, _config.dataPtr);
+  return *this;
+}
+
+/////////////////////////////////////////////////
+void ParserConfig::SetIncludeCache(std::shared_ptr<sdf::IncludeCache> _cache)
+{
+  this->dataPtr->includeCache = std::move(_cache);
+}
+
+/////////////////////////////////////////////////
+std::shared_ptr<sdf::IncludeCache> ParserConfig::IncludeCache() const
+{
+  return this->dataPtr->includeCache;
+}
+
+/////////////////////////////////////////////////
+void ParserConfig::SetLazyDomLoading(bool _lazy)
+{
+  this->dataPtr->lazyDomLoading = _lazy;
+}
+
+/////////////////////////////////////////////////
+bool ParserConfig::LazyDomLoading() const
+{
+  return this->dataPtr->lazyDomLoading;
+}
+
+/////////////////////////////////////////////////
+void ParserConfig::SetDirectUrdfConversion(bool _direct)
+{
+  this->dataPtr->directUrdfConversion = _direct;
+}
+
+/////////////////////////////////////////////////
+bool ParserConfig::DirectUrdfConversion() const
+{
+  return this->dataPtr->directUrdfConversion;
+}
+
+/////////////////////////////////////////////////
+void ParserConfig::SetModelLoadThreadCount(unsigned int _count)
+{
+  this->dataPtr->modelLoadThreadCount = _count;
+}
+
+/////////////////////////////////////////////////
+unsigned int ParserConfig::ModelLoadThreadCount() const
+{
+  return this->dataPtr->modelLoadThreadCount;
+}
+
+/////////////////////////////////////////////////
+void ParserConfig::SetIncludeThreadCount(unsigned int _count)
+{
+  this->dataPtr->includeThreadCount = _count;
+}
+
+/////////////////////////////////////////////////
+unsigned int ParserConfig::IncludeThreadCount() const
+{
+  return this->dataPtr->includeThreadCount;
+}
+
+/////////////////////////////////////////////////
+void ParserConfig::SetReadThreadCount(unsigned int _count)
+{
+  this->dataPtr->readThreadCount = _count;
+}
+
+/////////////////////////////////////////////////
+unsigned int ParserConfig::ReadThreadCount() const
+{
+  return this->dataPtr->readThreadCount;
+}
+
+/////////////////////////////////////////////////
+void ParserConfig::SetArenaAllocation(bool _arena)
+{
+  this->dataPtr->arenaAllocation = _arena;
+}
+
+/////////////////////////////////////////////////
+bool ParserConfig::ArenaAllocation() const
+{
+  return this->dataPtr->arenaAllocation;
+}
+
+/////////////////////////////////////////////////
+void ParserConfig::SetReleaseElements(bool _release)
+{
+  this->dataPtr->releaseElements = _release;
+}
+
+/////////////////////////////////////////////////
+bool ParserConfig::ReleaseElements() const
+{
+  return this->dataPtr->releaseElements;
+}
+
+/////////////////////////////////////////////////
+void ParserConfig::SetShareMaterials(bool _share)
+{
+  this->dataPtr->shareMaterials = _share;
+}
+
+/////////////////////////////////////////////////
+bool ParserConfig::ShareMaterials() const
+{
+  return this->dataPtr->shareMaterials;
+}
+
+/////////////////////////////////////////////////
+void ParserConfig::SetDeferCopiedElements(bool _defer)
+{
+  this->dataPtr->deferCopiedElements = _defer;
+}
+
+/////////////////////////////////////////////////
+bool ParserConfig::DeferCopiedElements() const
+{
+  return this->dataPtr->deferCopiedElements;
+}
+
+/////////////////////////////////////////////////
+void ParserConfig::SetValidation(ValidationLevel _level)
+{
+  this->dataPtr->validation = _level;
+}
+
+/////////////////////////////////////////////////
+ValidationLevel ParserConfig::Validation() const
+{
+  return this->dataPtr->validation;
+}
+
+/////////////////////////////////////////////////
+void ParserConfig::SetMaxErrors(std::size_t _count)
+{
+  this->dataPtr->maxErrors = _count;
+}
+
+/////////////////////////////////////////////////
+std::size_t ParserConfig::MaxErrors() const
+{
+  return this->dataPtr->maxErrors;
+}
+
+/////////////////////////////////////////////////
+void ParserConfig::SetWarningRepeatLimit(std::size_t _count)
+{
+  this->dataPtr->warningRepeatLimit = _count;
+}
+
+/////////////////////////////////////////////////
+std::size_t ParserConfig::WarningRepeatLimit() const
+{
+  return this->dataPtr->warningRepeatLimit;
+}
+
+/////////////////////////////////////////////////
+void ParserConfig::SetWarningSiteLimit(std::size_t _count)
+{
+  this->dataPtr->warningSiteLimit = _count;
+}
+
+/////////////////////////////////////////////////
+std::size_t ParserConfig::WarningSiteLimit() const
+{
+  return this->dataPtr->warningSiteLimit;
+}
+
+/////////////////////////////////////////////////
+void ParserConfig::SetErrorCallback(
+    std::function<void(const Error &)> _callback)
+{
+  this->dataPtr->errorCallback = std::move(_callback);
+}
+
+/////////////////////////////////////////////////
+const std::function<void(const Error &)> &ParserConfig::ErrorCallback() const
+{
+  return this->dataPtr->errorCallback;
+}
+
+/////////////////////////////////////////////////
+void ParserConfig::SetProgressCallback(
+    std::function<void(const LoadProgress &)> _callback)
+{
+  this->dataPtr->progressCallback = std::move(_callback);
+}
+
+/////////////////////////////////////////////////
+const std::function<void(const LoadProgress &)> &
+ParserConfig::ProgressCallback() const
+{
+  return this->dataPtr->progressCallback;
+}
+
+/////////////////////////////////////////////////
+void ParserConfig::SetCancelCallback(std::function<bool()> _callback)
+{
+  this->dataPtr->cancelCallback = std::move(_callback);
+}
+
+/////////////////////////////////////////////////
+const std::function<bool()> &ParserConfig::CancelCallback() const
+{
+  return this->dataPtr->cancelCallback;
+}
+
+/////////////////////////////////////////////////
+void ParserConfig::SetExecutor(
+    std::function<void(std::function<void()>)> _executor)
+{
+  this->dataPtr->executor = std::move(_executor);
+}
+
+/////////////////////////////////////////////////
+const std::function<void(std::function<void()>)> &
+ParserConfig::Executor() const
+{
+  return this->dataPtr->executor;
+}
+
+/////////////////////////////////////////////////
+void ParserConfig::SetModelFilter(
+    std::function<bool(const ModelCandidate &)> _filter)
+{
+  this->dataPtr->modelFilter = std::move(_filter);
+}
+
+/////////////////////////////////////////////////
+const std::function<bool(const ModelCandidate &)> &
+ParserConfig::ModelFilter() const
+{
+  return this->dataPtr->modelFilter;
+}
+
+/////////////////////////////////////////////////
+void ParserConfig::SetWorldFilter(
+    std::function<bool(const std::string &)> _filter)
+{
+  this->dataPtr->worldFilter = std::move(_filter);
+}
+
+/////////////////////////////////////////////////
+const std::function<bool(const std::string &)> &
+ParserConfig::WorldFilter() const
+{
+  return this->dataPtr->worldFilter;
+}
+
+/////////////////////////////////////////////////
+void ParserConfig::SetWorldsOnDemand(bool _onDemand)
+{
+  this->dataPtr->worldsOnDemand = _onDemand;
+}
+
+/////////////////////////////////////////////////
+bool ParserConfig::WorldsOnDemand() const
+{
+  return this->dataPtr->worldsOnDemand;
+}
+
+/////////////////////////////////////////////////
+void ParserConfig::SetSpecVersion(const std::string &_version)
+{
+  this->dataPtr->specVersion = _version;
+}
+
+/////////////////////////////////////////////////
+const std::string &ParserConfig::SpecVersion() const
+{
+  return this->dataPtr->specVersion;
+}
+
+/////////////////////////////////////////////////
+void ParserConfig::SetPhysicsProfile(const std::string &_name)
+{
+  this->dataPtr->physicsProfile = _name;
+}
+
+/////////////////////////////////////////////////
+const std::string &ParserConfig::PhysicsProfile() const
+{
+  return this->dataPtr->physicsProfile;
+}
+
+/////////////////////////////////////////////////
+void ParserConfig::SetParseScope(sdf::ParseScope _scope)
+{
+  this->dataPtr->parseScope = _scope;
+}
+
+/////////////////////////////////////////////////
+sdf::ParseScope ParserConfig::ParseScope() const
+{
+  return this->dataPtr->parseScope;
+}
+
+/////////////////////////////////////////////////
+void ParserConfig::SetScopeModelCount(std::size_t _count)
+{
+  this->dataPtr->scopeModelCount = _count;
+}
+
+/////////////////////////////////////////////////
+std::size_t ParserConfig::ScopeModelCount() const
+{
+  return this->dataPtr->scopeModelCount;
+}
+
+/////////////////////////////////////////////////
+void ParserConfig::SetMaxNestingDepth(std::size_t _depth)
+{
+  this->dataPtr->maxNestingDepth = _depth;
+}
+
+/////////////////////////////////////////////////
+std::size_t ParserConfig::MaxNestingDepth() const
+{
+  return this->dataPtr->maxNestingDepth;
+}
+
+/////////////////////////////////////////////////
+void ParserConfig::AddURIPath(const std::string &_uri,
+                              const std::string &_path)
+{
+  // Only valid paths are added, like sdf::addURIPath does.
+  for (const std::string &part : sdf::split(_path, ":"))
+  {
+    if (!part.empty() && sdf::filesystem::is_directory(part))
+      this->dataPtr->uriPaths[_uri].push_back(part);
+  }
+}
+
+/////////////////////////////////////////////////
+const std::map<std::string, std::vector<std::string>> &
+ParserConfig::URIPathMap() const
+{
+  return this->dataPtr->uriPaths;
+}
+
+/////////////////////////////////////////////////
+void ParserConfig::SetFindFileCallback(
+    std::function<std::string(const std::string &)> _callback)
+{
+  this->dataPtr->findFileCallback = std::move(_callback);
+}
+
+/////////////////////////////////////////////////
+const std::function<std::string(const std::string &)> &
+ParserConfig::FindFileCallback() const
+{
+  return this->dataPtr->findFileCallback;
+}
+
+/////////////////////////////////////////////////
+void ParserConfig::SetParseEventCallback(sdf::ParseEventCallback _callback)
+{
+  this->dataPtr->parseEventCallback = std::move(_callback);
+}
+
+/////////////////////////////////////////////////
+const sdf::ParseEventCallback &ParserConfig::ParseEventCallback() const
+{
+  return this->dataPtr->parseEventCallback;
+}
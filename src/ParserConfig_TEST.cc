@@ -0,0 +1,300 @@
+/*
+ * Copyright 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <memory>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "sdf/Filesystem.hh"
+#include "sdf/IncludeCache.hh"
+#include "sdf/ParserConfig.hh"
+#include "test_config.h"
+
+/////////////////////////////////////////////////
+TEST(ParserConfig, Construction)
+{
+  sdf::ParserConfig config;
+  EXPECT_EQ(nullptr, config.IncludeCache());
+
+  auto cache = std::make_shared<sdf::IncludeCache>();
+  config.SetIncludeCache(cache);
+  EXPECT_EQ(cache, config.IncludeCache());
+
+  config.SetIncludeCache(nullptr);
+  EXPECT_EQ(nullptr, config.IncludeCache());
+
+  EXPECT_FALSE(config.LazyDomLoading());
+  config.SetLazyDomLoading(true);
+  EXPECT_TRUE(config.LazyDomLoading());
+
+  EXPECT_FALSE(config.DirectUrdfConversion());
+  config.SetDirectUrdfConversion(true);
+  EXPECT_TRUE(config.DirectUrdfConversion());
+
+  EXPECT_EQ(1u, config.ModelLoadThreadCount());
+  config.SetModelLoadThreadCount(0);
+  EXPECT_EQ(0u, config.ModelLoadThreadCount());
+
+  EXPECT_EQ(1u, config.IncludeThreadCount());
+  config.SetIncludeThreadCount(8);
+  EXPECT_EQ(8u, config.IncludeThreadCount());
+
+  EXPECT_EQ(1u, config.ReadThreadCount());
+  config.SetReadThreadCount(0);
+  EXPECT_EQ(0u, config.ReadThreadCount());
+
+  EXPECT_FALSE(config.ArenaAllocation());
+  config.SetArenaAllocation(true);
+  EXPECT_TRUE(config.ArenaAllocation());
+
+  EXPECT_FALSE(config.ReleaseElements());
+  config.SetReleaseElements(true);
+  EXPECT_TRUE(config.ReleaseElements());
+
+  EXPECT_FALSE(config.ShareMaterials());
+  config.SetShareMaterials(true);
+  EXPECT_TRUE(config.ShareMaterials());
+
+  EXPECT_FALSE(config.DeferCopiedElements());
+  config.SetDeferCopiedElements(true);
+  EXPECT_TRUE(config.DeferCopiedElements());
+
+  EXPECT_EQ(sdf::ValidationLevel::FULL, config.Validation());
+  config.SetValidation(sdf::ValidationLevel::NONE);
+  EXPECT_EQ(sdf::ValidationLevel::NONE, config.Validation());
+
+  EXPECT_EQ(0u, config.MaxErrors());
+  config.SetMaxErrors(10);
+  EXPECT_EQ(10u, config.MaxErrors());
+
+  EXPECT_EQ(1u, config.WarningRepeatLimit());
+  config.SetWarningRepeatLimit(3);
+  EXPECT_EQ(3u, config.WarningRepeatLimit());
+
+  EXPECT_EQ(0u, config.WarningSiteLimit());
+  config.SetWarningSiteLimit(5);
+  EXPECT_EQ(5u, config.WarningSiteLimit());
+
+  EXPECT_FALSE(config.ErrorCallback());
+  std::size_t called = 0;
+  config.SetErrorCallback([&](const sdf::Error &)
+      {
+        ++called;
+      });
+  ASSERT_TRUE(config.ErrorCallback());
+  config.ErrorCallback()(sdf::Error());
+  EXPECT_EQ(1u, called);
+
+  EXPECT_FALSE(config.ProgressCallback());
+  sdf::LoadProgress reported;
+  config.SetProgressCallback([&](const sdf::LoadProgress &_progress)
+      {
+        reported = _progress;
+      });
+  ASSERT_TRUE(config.ProgressCallback());
+  sdf::LoadProgress progress;
+  progress.type = sdf::LoadProgressType::FILE_PARSED;
+  progress.name = "file.sdf";
+  progress.bytes = 42;
+  config.ProgressCallback()(progress);
+  EXPECT_EQ(sdf::LoadProgressType::FILE_PARSED, reported.type);
+  EXPECT_EQ("file.sdf", reported.name);
+  EXPECT_EQ(42u, reported.bytes);
+
+  EXPECT_FALSE(config.CancelCallback());
+  config.SetCancelCallback([]()
+      {
+        return true;
+      });
+  ASSERT_TRUE(config.CancelCallback());
+  EXPECT_TRUE(config.CancelCallback()());
+
+  EXPECT_FALSE(config.Executor());
+  int executed = 0;
+  config.SetExecutor([&executed](std::function<void()> _task)
+      {
+        ++executed;
+        _task();
+      });
+  ASSERT_TRUE(config.Executor());
+  config.Executor()([](){});
+  EXPECT_EQ(1, executed);
+
+  // Only existing directories are added.
+  EXPECT_TRUE(config.URIPathMap().empty());
+  config.AddURIPath("model://", "/nonexistent:" + sdf::filesystem::append(
+      PROJECT_SOURCE_PATH, "test") + ":");
+  ASSERT_EQ(1u, config.URIPathMap().size());
+  EXPECT_EQ(1u, config.URIPathMap().at("model://").size());
+
+  EXPECT_FALSE(config.FindFileCallback());
+  config.SetFindFileCallback([](const std::string &_name)
+      {
+        return "/models/" + _name;
+      });
+  ASSERT_TRUE(config.FindFileCallback());
+  EXPECT_EQ("/models/box", config.FindFileCallback()("box"));
+
+  EXPECT_FALSE(config.ParseEventCallback());
+  config.SetParseEventCallback([](const sdf::ParseEvent &){});
+  EXPECT_TRUE(config.ParseEventCallback());
+
+  EXPECT_FALSE(config.ModelFilter());
+  config.SetModelFilter([](const sdf::ModelCandidate &_candidate)
+      {
+        return _candidate.name == "kept";
+      });
+  ASSERT_TRUE(config.ModelFilter());
+  sdf::ModelCandidate candidate;
+  candidate.name = "kept";
+  EXPECT_TRUE(config.ModelFilter()(candidate));
+  candidate.name = "skipped";
+  EXPECT_FALSE(config.ModelFilter()(candidate));
+
+  EXPECT_FALSE(config.WorldFilter());
+  config.SetWorldFilter([](const std::string &_name)
+      {
+        return _name == "kept";
+      });
+  ASSERT_TRUE(config.WorldFilter());
+  EXPECT_TRUE(config.WorldFilter()("kept"));
+  EXPECT_FALSE(config.WorldFilter()("skipped"));
+
+  EXPECT_FALSE(config.WorldsOnDemand());
+  config.SetWorldsOnDemand(true);
+  EXPECT_TRUE(config.WorldsOnDemand());
+
+  EXPECT_TRUE(config.SpecVersion().empty());
+  config.SetSpecVersion("1.6");
+  EXPECT_EQ("1.6", config.SpecVersion());
+
+  EXPECT_TRUE(config.PhysicsProfile().empty());
+  config.SetPhysicsProfile("fast");
+  EXPECT_EQ("fast", config.PhysicsProfile());
+
+  EXPECT_EQ(sdf::ParseScope::FULL, config.ParseScope());
+  config.SetParseScope(sdf::ParseScope::WORLD_HEADER);
+  EXPECT_EQ(sdf::ParseScope::WORLD_HEADER, config.ParseScope());
+
+  EXPECT_EQ(1u, config.ScopeModelCount());
+  config.SetScopeModelCount(3);
+  EXPECT_EQ(3u, config.ScopeModelCount());
+
+  EXPECT_EQ(256u, config.MaxNestingDepth());
+  config.SetMaxNestingDepth(16);
+  EXPECT_EQ(16u, config.MaxNestingDepth());
+}
+
+/////////////////////////////////////////////////
+TEST(ParserConfig, CopyConstructor)
+{
+  auto cache = std::make_shared<sdf::IncludeCache>();
+  sdf::ParserConfig config;
+  config.SetIncludeCache(cache);
+
+  config.SetLazyDomLoading(true);
+  config.SetDirectUrdfConversion(true);
+  config.SetModelLoadThreadCount(4);
+  config.SetIncludeThreadCount(3);
+  config.SetReadThreadCount(2);
+  config.SetArenaAllocation(true);
+  config.SetReleaseElements(true);
+  config.SetShareMaterials(true);
+  config.SetDeferCopiedElements(true);
+  config.SetValidation(sdf::ValidationLevel::STRUCTURAL);
+  config.SetMaxErrors(10);
+  config.SetWarningRepeatLimit(3);
+  config.SetWarningSiteLimit(5);
+  config.SetErrorCallback([](const sdf::Error &){});
+  config.SetProgressCallback([](const sdf::LoadProgress &){});
+  config.SetCancelCallback([](){ return false; });
+  config.SetExecutor([](std::function<void()> _task){ _task(); });
+  config.SetFindFileCallback([](const std::string &){ return ""; });
+  config.SetParseEventCallback([](const sdf::ParseEvent &){});
+  config.SetModelFilter([](const sdf::ModelCandidate &){ return true; });
+  config.SetWorldFilter([](const std::string &){ return true; });
+  config.SetWorldsOnDemand(true);
+  config.SetSpecVersion("1.6");
+  config.SetPhysicsProfile("fast");
+  config.SetParseScope(sdf::ParseScope::FIRST_MODELS);
+  config.SetScopeModelCount(3);
+
+  sdf::ParserConfig config2(config);
+  EXPECT_EQ(cache, config2.IncludeCache());
+  EXPECT_TRUE(config2.LazyDomLoading());
+  EXPECT_TRUE(config2.DirectUrdfConversion());
+  EXPECT_EQ(4u, config2.ModelLoadThreadCount());
+  EXPECT_EQ(3u, config2.IncludeThreadCount());
+  EXPECT_EQ(2u, config2.ReadThreadCount());
+  EXPECT_TRUE(config2.ArenaAllocation());
+  EXPECT_TRUE(config2.ReleaseElements());
+  EXPECT_TRUE(config2.ShareMaterials());
+  EXPECT_TRUE(config2.DeferCopiedElements());
+  EXPECT_EQ(sdf::ValidationLevel::STRUCTURAL, config2.Validation());
+  EXPECT_EQ(10u, config2.MaxErrors());
+  EXPECT_EQ(3u, config2.WarningRepeatLimit());
+  EXPECT_EQ(5u, config2.WarningSiteLimit());
+  EXPECT_TRUE(config2.ErrorCallback());
+  EXPECT_TRUE(config2.ProgressCallback());
+  EXPECT_TRUE(config2.CancelCallback());
+  EXPECT_TRUE(config2.Executor());
+  EXPECT_TRUE(config2.FindFileCallback());
+  EXPECT_TRUE(config2.ParseEventCallback());
+  EXPECT_TRUE(config2.ModelFilter());
+  EXPECT_TRUE(config2.WorldFilter());
+  EXPECT_TRUE(config2.WorldsOnDemand());
+  EXPECT_EQ("1.6", config2.SpecVersion());
+  EXPECT_EQ("fast", config2.PhysicsProfile());
+  EXPECT_EQ(sdf::ParseScope::FIRST_MODELS, config2.ParseScope());
+  EXPECT_EQ(3u, config2.ScopeModelCount());
+}
+
+/////////////////////////////////////////////////
+TEST(ParserConfig, CopyAssignmentOperator)
+{
+  auto cache = std::make_shared<sdf::IncludeCache>();
+  sdf::ParserConfig config;
+  config.SetIncludeCache(cache);
+
+  sdf::ParserConfig config2;
+  config2 = config;
+  EXPECT_EQ(cache, config2.IncludeCache());
+}
+
+/////////////////////////////////////////////////
+TEST(ParserConfig, MoveConstructor)
+{
+  auto cache = std::make_shared<sdf::IncludeCache>();
+  sdf::ParserConfig config;
+  config.SetIncludeCache(cache);
+
+  sdf::ParserConfig config2(std::move(config));
+  EXPECT_EQ(cache, config2.IncludeCache());
+}
+
+/////////////////////////////////////////////////
+TEST(ParserConfig, MoveAssignmentOperator)
+{
+  auto cache = std::make_shared<sdf::IncludeCache>();
+  sdf::ParserConfig config;
+  config.SetIncludeCache(cache);
+
+  sdf::ParserConfig config2;
+  config2 = std::move(config);
+  EXPECT_EQ(cache, config2.IncludeCache());
+}
@@ -155,7 +155,7 @@ Errors PbrWorkflow::Load(sdf::ElementPtr _sdf)
 {
   Errors errors;
 
-  this->dataPtr->sdf = _sdf;
+  this->dataPtr->sdf = retainedElement(_sdf);
 
   // Load the workflow element
   sdf::ElementPtr workflowElem;
@@ -428,7 +428,7 @@ Errors Pbr::Load(sdf::ElementPtr _sdf)
 {
   Errors errors;
 
-  this->dataPtr->sdf = _sdf;
+  this->dataPtr->sdf = retainedElement(_sdf);
 
   // Check that the provided SDF element is a <pbr>
   // This is an error that cannot be recovered, so return an error.
@@ -441,8 +441,7 @@ Errors Pbr::Load(sdf::ElementPtr _sdf)
   }
 
   // load all workflows
-  sdf::ElementPtr workflowElem = _sdf->GetFirstElement();
-  while (workflowElem)
+  for (const sdf::ElementPtr &workflowElem : _sdf->Children())
   {
     PbrWorkflow workflow;
     Errors workflowErrors = workflow.Load(workflowElem);
@@ -450,7 +449,6 @@ Errors Pbr::Load(sdf::ElementPtr _sdf)
       this->dataPtr->workflows[workflow.Type()] = workflow;
     else
       errors.insert(errors.end(), workflowErrors.begin(), workflowErrors.end());
-    workflowElem = workflowElem->GetNextElement();
   }
 
   return errors;
@@ -86,7 +86,7 @@ Errors Physics::Load(sdf::ElementPtr _sdf)
 {
   Errors errors;
 
-  this->dataPtr->sdf = _sdf;
+  this->dataPtr->sdf = retainedElement(_sdf);
 
   // Check that the provided SDF element is a <physics>
   // This is an error that cannot be recovered, so return an error.
@@ -149,7 +149,7 @@ Errors Physics::Load(sdf::ElementPtr _sdf)
 }
 
 /////////////////////////////////////////////////
-std::string Physics::Name() const
+const std::string &Physics::Name() const
 {
   return this->dataPtr->name;
 }
@@ -158,6 +158,7 @@ std::string Physics::Name() const
 void Physics::SetName(const std::string &_name) const
 {
   this->dataPtr->name = _name;
+  NameIndex::NameChanged();
 }
 
 /////////////////////////////////////////////////
@@ -179,7 +180,7 @@ void Physics::SetDefault(const bool _default) const
 }
 
 /////////////////////////////////////////////////
-std::string Physics::EngineType() const
+const std::string &Physics::EngineType() const
 {
   return this->dataPtr->type;
 }
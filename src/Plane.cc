@@ -17,6 +17,7 @@
 #include <ignition/math/Vector2.hh>
 #include <ignition/math/Vector3.hh>
 #include "sdf/Plane.hh"
+#include "Utils.hh"
 
 using namespace sdf;
 
@@ -77,7 +78,7 @@ Errors Plane::Load(ElementPtr _sdf)
 {
   Errors errors;
 
-  this->dataPtr->sdf = _sdf;
+  this->dataPtr->sdf = retainedElement(_sdf);
 
   // Check that sdf is a valid pointer
   if (!_sdf)
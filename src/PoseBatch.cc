@@ -0,0 +1,173 @@
+/*
+ * Copyright 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#include <algorithm>
+#include <cstddef>
+#include <ignition/math/Quaternion.hh>
+#include <ignition/math/Vector3.hh>
+
+#include "PoseBatch.hh"
+
+using namespace sdf;
+
+/////////////////////////////////////////////////
+void PoseBatch::Resize(std::size_t _size)
+{
+  this->x.resize(_size, 0.0);
+  this->y.resize(_size, 0.0);
+  this->z.resize(_size, 0.0);
+  this->qw.resize(_size, 1.0);
+  this->qx.resize(_size, 0.0);
+  this->qy.resize(_size, 0.0);
+  this->qz.resize(_size, 0.0);
+}
+
+/////////////////////////////////////////////////
+std::size_t PoseBatch::Size() const
+{
+  return this->x.size();
+}
+
+/////////////////////////////////////////////////
+void PoseBatch::Add(const ignition::math::Pose3d &_pose)
+{
+  this->x.push_back(_pose.Pos().X());
+  this->y.push_back(_pose.Pos().Y());
+  this->z.push_back(_pose.Pos().Z());
+  this->qw.push_back(_pose.Rot().W());
+  this->qx.push_back(_pose.Rot().X());
+  this->qy.push_back(_pose.Rot().Y());
+  this->qz.push_back(_pose.Rot().Z());
+}
+
+/////////////////////////////////////////////////
+void PoseBatch::Set(std::size_t _index, const ignition::math::Pose3d &_pose)
+{
+  this->x[_index] = _pose.Pos().X();
+  this->y[_index] = _pose.Pos().Y();
+  this->z[_index] = _pose.Pos().Z();
+  this->qw[_index] = _pose.Rot().W();
+  this->qx[_index] = _pose.Rot().X();
+  this->qy[_index] = _pose.Rot().Y();
+  this->qz[_index] = _pose.Rot().Z();
+}
+
+/////////////////////////////////////////////////
+ignition::math::Pose3d PoseBatch::Pose(std::size_t _index) const
+{
+  return ignition::math::Pose3d(
+      ignition::math::Vector3d(this->x[_index], this->y[_index],
+                               this->z[_index]),
+      ignition::math::Quaterniond(this->qw[_index], this->qx[_index],
+                                  this->qy[_index], this->qz[_index]));
+}
+
+/////////////////////////////////////////////////
+/// \brief Number of poses composed into local arrays before they are
+/// copied to the output. The output may be the children, so writing it
+/// directly would make the compiler check the 21 arrays for overlap
+/// before vectorizing, which it gives up on.
+static constexpr std::size_t kBlockSize = 64;
+
+/////////////////////////////////////////////////
+/// \brief Compose poses, as described in composePoses. The loop has no
+/// branches and reads each component from its own array, so that it is
+/// vectorized.
+/// \tparam kStride 1 to read one parent per child, or 0 to read the first
+/// parent for all the children.
+/// \param[in] _parents Poses of the parent frames.
+/// \param[in] _children Poses of the children.
+/// \param[out] _out Composed poses, already resized.
+template<std::size_t kStride>
+static void composePoseArrays(const PoseBatch &_parents,
+    const PoseBatch &_children, PoseBatch &_out)
+{
+  double ox[kBlockSize], oy[kBlockSize], oz[kBlockSize];
+  double oqw[kBlockSize], oqx[kBlockSize], oqy[kBlockSize], oqz[kBlockSize];
+
+  const std::size_t size = _children.Size();
+  for (std::size_t start = 0; start < size; start += kBlockSize)
+  {
+    const std::size_t count = std::min(kBlockSize, size - start);
+    const double *px = _parents.x.data() + start * kStride;
+    const double *py = _parents.y.data() + start * kStride;
+    const double *pz = _parents.z.data() + start * kStride;
+    const double *pqw = _parents.qw.data() + start * kStride;
+    const double *pqx = _parents.qx.data() + start * kStride;
+    const double *pqy = _parents.qy.data() + start * kStride;
+    const double *pqz = _parents.qz.data() + start * kStride;
+    const double *cx = _children.x.data() + start;
+    const double *cy = _children.y.data() + start;
+    const double *cz = _children.z.data() + start;
+    const double *cqw = _children.qw.data() + start;
+    const double *cqx = _children.qx.data() + start;
+    const double *cqy = _children.qy.data() + start;
+    const double *cqz = _children.qz.data() + start;
+
+    for (std::size_t i = 0; i < count; ++i)
+    {
+      const std::size_t p = i * kStride;
+      const double w = pqw[p];
+      const double ux = pqx[p];
+      const double uy = pqy[p];
+      const double uz = pqz[p];
+      const double vx = cx[i];
+      const double vy = cy[i];
+      const double vz = cz[i];
+
+      // Rotate the child position by the parent rotation, as q * v * q^-1,
+      // which is v + 2 (w (u x v) + u x (u x v)) / |q|^2.
+      const double scale = 2.0 / (w * w + ux * ux + uy * uy + uz * uz);
+      const double tx = uy * vz - uz * vy;
+      const double ty = uz * vx - ux * vz;
+      const double tz = ux * vy - uy * vx;
+      const double rx = vx + scale * (w * tx + uy * tz - uz * ty);
+      const double ry = vy + scale * (w * ty + uz * tx - ux * tz);
+      const double rz = vz + scale * (w * tz + ux * ty - uy * tx);
+
+      const double qw = cqw[i];
+      const double qx = cqx[i];
+      const double qy = cqy[i];
+      const double qz = cqz[i];
+      ox[i] = px[p] + rx;
+      oy[i] = py[p] + ry;
+      oz[i] = pz[p] + rz;
+      oqw[i] = w * qw - ux * qx - uy * qy - uz * qz;
+      oqx[i] = w * qx + ux * qw + uy * qz - uz * qy;
+      oqy[i] = w * qy - ux * qz + uy * qw + uz * qx;
+      oqz[i] = w * qz + ux * qy - uy * qx + uz * qw;
+    }
+
+    std::copy(ox, ox + count, _out.x.begin() + start);
+    std::copy(oy, oy + count, _out.y.begin() + start);
+    std::copy(oz, oz + count, _out.z.begin() + start);
+    std::copy(oqw, oqw + count, _out.qw.begin() + start);
+    std::copy(oqx, oqx + count, _out.qx.begin() + start);
+    std::copy(oqy, oqy + count, _out.qy.begin() + start);
+    std::copy(oqz, oqz + count, _out.qz.begin() + start);
+  }
+}
+
+/////////////////////////////////////////////////
+void sdf::composePoses(const PoseBatch &_parents, const PoseBatch &_children,
+    PoseBatch &_out)
+{
+  _out.Resize(_children.Size());
+  if (_parents.Size() == 1)
+    composePoseArrays<0>(_parents, _children, _out);
+  else
+    composePoseArrays<1>(_parents, _children, _out);
+}
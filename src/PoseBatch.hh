@@ -0,0 +1,83 @@
+/*
+ * Copyright 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef SDF_POSEBATCH_HH_
+#define SDF_POSEBATCH_HH_
+
+#include <cstddef>
+#include <vector>
+#include <ignition/math/Pose3.hh>
+
+#include "sdf/sdf_config.h"
+#include "sdf/system_util.hh"
+
+namespace sdf
+{
+  // Inline bracket to help doxygen filtering.
+  inline namespace SDF_VERSION_NAMESPACE {
+  //
+
+  /// \brief Poses stored as one array per component, so that many
+  /// independent poses can be composed by composePoses with loops that the
+  /// compiler vectorizes, instead of one Pose3d product at a time.
+  class SDFORMAT_VISIBLE PoseBatch
+  {
+    /// \brief Change the number of poses. New poses are identities.
+    /// \param[in] _size Number of poses.
+    public: void Resize(std::size_t _size);
+
+    /// \brief Get the number of poses.
+    /// \return Number of poses.
+    public: std::size_t Size() const;
+
+    /// \brief Add a pose at the end.
+    /// \param[in] _pose The pose.
+    public: void Add(const ignition::math::Pose3d &_pose);
+
+    /// \brief Set a pose.
+    /// \param[in] _index Index of the pose, less than Size().
+    /// \param[in] _pose The pose.
+    public: void Set(std::size_t _index, const ignition::math::Pose3d &_pose);
+
+    /// \brief Get a pose.
+    /// \param[in] _index Index of the pose, less than Size().
+    /// \return The pose.
+    public: ignition::math::Pose3d Pose(std::size_t _index) const;
+
+    /// \brief Position components.
+    public: std::vector<double> x, y, z;
+
+    /// \brief Rotation quaternion components.
+    public: std::vector<double> qw, qx, qy, qz;
+  };
+
+  /// \brief Compose poses element by element, so that _out[i] is
+  /// _parents[i] * _children[i] as Pose3d computes it. The rotations are
+  /// applied with the expanded quaternion product instead of the two
+  /// quaternion products of Pose3d, so results agree with Pose3d within a
+  /// relative tolerance of 1e-12 rather than bit for bit.
+  /// \param[in] _parents Poses of the parent frames, one per child. It may
+  /// instead have a single pose, which is then the parent of all the
+  /// children.
+  /// \param[in] _children Poses of the children relative to their parents.
+  /// \param[out] _out Composed poses, with the size of _children. It may be
+  /// _children itself.
+  SDFORMAT_VISIBLE
+  void composePoses(const PoseBatch &_parents, const PoseBatch &_children,
+      PoseBatch &_out);
+  }
+}
+#endif
@@ -0,0 +1,108 @@
+/*
+ * Copyright 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include <vector>
+#include <ignition/math/Pose3.hh>
+
+#include "PoseBatch.hh"
+
+using ignition::math::Pose3d;
+
+/////////////////////////////////////////////////
+/// \brief Check that a pose matches the Pose3d product within the
+/// tolerance documented by composePoses.
+/// \param[in] _expected The Pose3d product.
+/// \param[in] _actual The pose computed by composePoses.
+void expectPoseNear(const Pose3d &_expected, const Pose3d &_actual)
+{
+  const double tol = 1e-12;
+  EXPECT_NEAR(_expected.Pos().X(), _actual.Pos().X(), tol);
+  EXPECT_NEAR(_expected.Pos().Y(), _actual.Pos().Y(), tol);
+  EXPECT_NEAR(_expected.Pos().Z(), _actual.Pos().Z(), tol);
+  EXPECT_NEAR(_expected.Rot().W(), _actual.Rot().W(), tol);
+  EXPECT_NEAR(_expected.Rot().X(), _actual.Rot().X(), tol);
+  EXPECT_NEAR(_expected.Rot().Y(), _actual.Rot().Y(), tol);
+  EXPECT_NEAR(_expected.Rot().Z(), _actual.Rot().Z(), tol);
+}
+
+/////////////////////////////////////////////////
+TEST(PoseBatch, SetAndGet)
+{
+  sdf::PoseBatch batch;
+  EXPECT_EQ(0u, batch.Size());
+  batch.Resize(2);
+  EXPECT_EQ(2u, batch.Size());
+  EXPECT_EQ(Pose3d::Zero, batch.Pose(1));
+
+  const Pose3d pose(1, 2, 3, 0.1, 0.2, 0.3);
+  batch.Set(1, pose);
+  batch.Add(pose);
+  EXPECT_EQ(3u, batch.Size());
+  EXPECT_EQ(pose, batch.Pose(1));
+  EXPECT_EQ(pose, batch.Pose(2));
+}
+
+/////////////////////////////////////////////////
+TEST(PoseBatch, Compose)
+{
+  std::vector<Pose3d> parents;
+  std::vector<Pose3d> children;
+  for (int i = 0; i < 150; ++i)
+  {
+    parents.emplace_back(i, -0.5 * i, 2, 0.1 * i, -0.3, 0.05 * i);
+    children.emplace_back(1, 0.25 * i, -i, 0.7, 0.02 * i, -0.1 * i);
+  }
+
+  sdf::PoseBatch parentBatch;
+  sdf::PoseBatch childBatch;
+  for (std::size_t i = 0; i < parents.size(); ++i)
+  {
+    parentBatch.Add(parents[i]);
+    childBatch.Add(children[i]);
+  }
+
+  sdf::PoseBatch out;
+  sdf::composePoses(parentBatch, childBatch, out);
+  ASSERT_EQ(parents.size(), out.Size());
+  for (std::size_t i = 0; i < parents.size(); ++i)
+    expectPoseNear(parents[i] * children[i], out.Pose(i));
+
+  // A single parent is shared by all the children, and the output may be
+  // the children.
+  sdf::PoseBatch single;
+  single.Add(parents[5]);
+  sdf::composePoses(single, childBatch, childBatch);
+  ASSERT_EQ(children.size(), childBatch.Size());
+  for (std::size_t i = 0; i < children.size(); ++i)
+    expectPoseNear(parents[5] * children[i], childBatch.Pose(i));
+
+  // Quaternions that are not normalized rotate as their unit quaternion.
+  sdf::PoseBatch scaled;
+  scaled.Add(parents[3]);
+  for (double *q : {&scaled.qw[0], &scaled.qx[0], &scaled.qy[0],
+                    &scaled.qz[0]})
+  {
+    *q *= 2.0;
+  }
+  sdf::PoseBatch child;
+  child.Add(Pose3d(1, 2, 3, 0, 0, 0));
+  sdf::composePoses(scaled, child, out);
+  expectPoseNear(parents[3] * child.Pose(0),
+      Pose3d(out.Pose(0).Pos(), parents[3].Rot()));
+}
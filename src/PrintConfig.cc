@@ -0,0 +1,96 @@
+/*
+ * Copyright 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <utility>
+
+#include "sdf/PrintConfig.hh"
+
+using namespace sdf;
+
+/// \brief Private data for PrintConfig.
+class sdf::PrintConfigPrivate
+{
+  /// \brief True if unmodified included elements are printed as their
+  /// <include> elements.
+  public: bool preserveIncludes = false;
+
+  /// \brief Number of threads used to print, or 0 for one per hardware
+  /// thread.
+  public: unsigned int threadCount = 1;
+};
+
+/////////////////////////////////////////////////
+PrintConfig::PrintConfig()
+  : dataPtr(new PrintConfigPrivate)
+{
+}
+
+/////////////////////////////////////////////////
+PrintConfig::~PrintConfig()
+{
+  delete this->dataPtr;
+  this->dataPtr = nullptr;
+}
+
+/////////////////////////////////////////////////
+PrintConfig::PrintConfig(const PrintConfig &_config)
+  : dataPtr(new PrintConfigPrivate(*_config.dataPtr))
+{
+}
+
+/////////////////////////////////////////////////
+PrintConfig::PrintConfig(PrintConfig &&_config) noexcept
+  : dataPtr(std::exchange(_config.dataPtr, nullptr))
+{
+}
+
+/////////////////////////////////////////////////
+PrintConfig &PrintConfig::operator=(const PrintConfig &_config)
+{
+  return *this = PrintConfig(_config);
+}
+
+/////////////////////////////////////////////////
+PrintConfig &PrintConfig::operator=(PrintConfig &&_config)
+{
+  std::swap(this->dataPtr, _config.dataPtr);
+  return *this;
+}
+
+/////////////////////////////////////////////////
+void PrintConfig::SetPreserveIncludes(bool _preserve)
+{
+  this->dataPtr->preserveIncludes = _preserve;
+}
+
+/////////////////////////////////////////////////
+bool PrintConfig::PreserveIncludes() const
+{
+  return this->dataPtr->preserveIncludes;
+}
+
+/////////////////////////////////////////////////
+void PrintConfig::SetThreadCount(unsigned int _count)
+{
+  this->dataPtr->threadCount = _count;
+}
+
+/////////////////////////////////////////////////
+unsigned int PrintConfig::ThreadCount() const
+{
+  return this->dataPtr->threadCount;
+}
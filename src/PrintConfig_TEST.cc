@@ -0,0 +1,61 @@
+/*
+ * Copyright 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <utility>
+
+#include <gtest/gtest.h>
+
+#include "sdf/PrintConfig.hh"
+
+/////////////////////////////////////////////////
+TEST(PrintConfig, Construction)
+{
+  sdf::PrintConfig config;
+  EXPECT_FALSE(config.PreserveIncludes());
+  config.SetPreserveIncludes(true);
+  EXPECT_TRUE(config.PreserveIncludes());
+
+  EXPECT_EQ(1u, config.ThreadCount());
+  config.SetThreadCount(0);
+  EXPECT_EQ(0u, config.ThreadCount());
+}
+
+/////////////////////////////////////////////////
+TEST(PrintConfig, CopyMove)
+{
+  sdf::PrintConfig config;
+  config.SetPreserveIncludes(true);
+
+  config.SetThreadCount(4);
+
+  sdf::PrintConfig copy(config);
+  EXPECT_TRUE(copy.PreserveIncludes());
+  EXPECT_EQ(4u, copy.ThreadCount());
+  copy.SetPreserveIncludes(false);
+  EXPECT_TRUE(config.PreserveIncludes());
+
+  sdf::PrintConfig assigned;
+  assigned = config;
+  EXPECT_TRUE(assigned.PreserveIncludes());
+  EXPECT_EQ(4u, assigned.ThreadCount());
+
+  sdf::PrintConfig moved(std::move(assigned));
+  EXPECT_TRUE(moved.PreserveIncludes());
+
+  copy = std::move(moved);
+  EXPECT_TRUE(copy.PreserveIncludes());
+}
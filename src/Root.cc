@@ -14,107 +14,1271 @@
  * limitations under the License.
  *
 */
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <ctime>
+#include <fstream>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
 #include <string>
+#include <string_view>
+#include <unordered_map>
 #include <vector>
 #include <utility>
 
+#include <tinyxml.h>
+
 #include "sdf/Actor.hh"
+#include "sdf/Collision.hh"
+#include "sdf/Filesystem.hh"
+#include "sdf/Frame.hh"
+#include "sdf/Geometry.hh"
+#include "sdf/IncludeCache.hh"
+#include "sdf/Joint.hh"
 #include "sdf/Light.hh"
+#include "sdf/LightCulling.hh"
+#include "sdf/Link.hh"
+#include "sdf/Material.hh"
+#include "sdf/Mesh.hh"
 #include "sdf/Model.hh"
+#include "sdf/Param.hh"
+#include "sdf/Pbr.hh"
 #include "sdf/Root.hh"
 #include "sdf/Types.hh"
+#include "sdf/Visual.hh"
 #include "sdf/World.hh"
 #include "sdf/parser.hh"
 #include "sdf/sdf_config.h"
+#include "BinaryFormat.hh"
+#include "ElementArena.hh"
+#include "FlatFormat.hh"
+#include "LoadHandlePrivate.hh"
+#include "MappedFile.hh"
+#include "ScopedParseEvent.hh"
+#include "TaskPool.hh"
 #include "Utils.hh"
 
-using namespace sdf;
+using namespace sdf;
+
+/// \brief DOM objects of one type that are generated from their elements
+/// the first time they are accessed, for lazy DOM loading.
+template <typename T>
+class LazyDomObjects
+{
+  /// \brief Collect the child elements with the given name that have a
+  /// unique name attribute.
+  /// \param[in] _sdf The parent element.
+  /// \param[in] _sdfName Name of the child elements.
+  /// \param[in] _release True if the objects release their element, as
+  /// in ParserConfig::ReleaseElements.
+  /// \param[in] _validation Checks run by the objects, as in
+  /// ParserConfig::Validation.
+  /// \param[in] _share True if the visuals of the objects share identical
+  /// materials, as in ParserConfig::ShareMaterials.
+  /// \param[in] _arena True if the objects are allocated from an arena,
+  /// as in ParserConfig::ArenaAllocation.
+  /// \param[in] _physicsProfile Physics profile loaded by worlds, as in
+  /// ParserConfig::PhysicsProfile.
+  /// \return Errors for the elements with a duplicate name.
+  public: Errors Collect(ElementPtr _sdf, const std::string &_sdfName,
+                         const bool _release,
+                         const ValidationLevel _validation,
+                         const bool _share,
+                         const bool _arena,
+                         const std::string &_physicsProfile)
+  {
+    Errors errors;
+    this->release = _release;
+    this->share = _share;
+    this->arena = _arena;
+    this->validation = _validation;
+    this->physicsProfile = _physicsProfile;
+    this->elements.clear();
+    this->names.clear();
+    this->objects.clear();
+    this->loadErrors.clear();
+
+    for (const ElementPtr &elem : _sdf->Children(_sdfName))
+    {
+      // Errors of the name attribute are reported when the object is
+      // generated.
+      std::string name;
+      loadName(elem, name);
+
+      if (!this->names.emplace(name, this->elements.size()).second)
+      {
+        errors.push_back({ErrorCode::DUPLICATE_NAME,
+            _sdfName + " with name[" + name + "] already exists."});
+        continue;
+      }
+
+      this->elements.push_back(elem);
+    }
+
+    this->objects.resize(this->elements.size());
+    this->loadErrors.resize(this->elements.size());
+    this->generated = std::make_unique<std::once_flag[]>(
+        this->elements.size());
+    return errors;
+  }
+
+  /// \brief Get the number of objects.
+  /// \return Number of objects.
+  public: uint64_t Count() const
+  {
+    return this->objects.size();
+  }
+
+  /// \brief Get an object, generating it if it was not accessed before.
+  /// Several threads may get objects at once. Each object is generated by
+  /// the first thread that gets it, while the other threads that get it
+  /// wait, and getting an object that was generated takes no lock. An
+  /// arena is only allocated from by one thread, so each object is
+  /// allocated from its own arena rather than from the arena of the root.
+  /// \param[in] _index Index of the object.
+  /// \return The object, or nullptr if the index does not exist.
+  public: const T *ByIndex(const uint64_t _index) const
+  {
+    if (_index >= this->objects.size())
+      return nullptr;
+
+    std::call_once(this->generated[_index], [this, _index]()
+        {
+          ScopedElementRelease scope(this->release);
+          ScopedMaterialSharing materialScope(this->share);
+          ScopedElementArena arenaScope(this->arena);
+          ScopedValidationLevel validationScope(this->validation);
+          ScopedPhysicsProfile physicsScope(this->physicsProfile);
+          auto object = std::make_unique<T>();
+          this->loadErrors[_index] = object->Load(this->elements[_index]);
+          this->objects[_index] = std::move(object);
+        });
+    return this->objects[_index].get();
+  }
+
+  /// \brief Get whether an object name exists, without generating it.
+  /// \param[in] _name Name of the object.
+  /// \return True if there exists an object with the given name.
+  public: bool NameExists(std::string_view _name) const
+  {
+    return this->names.count(std::string(_name)) > 0;
+  }
+
+  /// \brief Get an object based on its name, generating it if it was not
+  /// accessed before.
+  /// \param[in] _name Name of the object.
+  /// \return The object, or nullptr if the name does not exist.
+  public: const T *ByName(const std::string &_name) const
+  {
+    auto iter = this->names.find(_name);
+    if (iter == this->names.end())
+      return nullptr;
+    return this->ByIndex(iter->second);
+  }
+
+  /// \brief Generate all the objects.
+  /// \param[out] _errors The errors of generating every object are
+  /// appended to this vector.
+  public: void LoadAll(Errors &_errors) const
+  {
+    for (uint64_t i = 0; i < this->objects.size(); ++i)
+    {
+      this->ByIndex(i);
+      _errors.insert(_errors.end(), this->loadErrors[i].begin(),
+          this->loadErrors[i].end());
+    }
+  }
+
+  /// \brief Drop the elements once all the objects are generated. It must
+  /// not be called while other threads get objects.
+  public: void ReleaseElements() const
+  {
+    this->elements.clear();
+  }
+
+  /// \brief The elements of the objects, which are dropped by
+  /// ReleaseElements.
+  private: mutable std::vector<ElementPtr> elements;
+
+  /// \brief The indices of the objects by name.
+  private: std::unordered_map<std::string, std::size_t> names;
+
+  /// \brief The objects, which are null until they are first accessed.
+  private: mutable std::vector<std::unique_ptr<T>> objects;
+
+  /// \brief The errors of generating each object.
+  private: mutable std::vector<Errors> loadErrors;
+
+  /// \brief Flag of each object, set once the object is generated.
+  private: mutable std::unique_ptr<std::once_flag[]> generated;
+
+  /// \brief True if the objects release their element.
+  private: bool release = false;
+
+  /// \brief Checks run by the objects.
+  private: ValidationLevel validation = ValidationLevel::FULL;
+
+  /// \brief True if the visuals of the objects share identical materials.
+  private: bool share = false;
+
+  /// \brief True if the objects are allocated from an arena.
+  private: bool arena = false;
+
+  /// \brief Physics profile loaded by worlds.
+  private: std::string physicsProfile;
+};
+
+/// \brief Worlds of a file that are read from the file the first time they
+/// are accessed, as set by ParserConfig::SetWorldsOnDemand.
+class OnDemandWorlds
+{
+  /// \brief Set the worlds to read on demand.
+  /// \param[in] _filename The file name given to Root::Load.
+  /// \param[in] _config The configuration to read the worlds with, which
+  /// has an include cache. Its world filter is not used.
+  /// \param[in] _worlds Name and position among the <world> elements of
+  /// the file of each world, in document order.
+  /// \param[in] _arena True if the worlds are allocated from an arena,
+  /// as in ParserConfig::ArenaAllocation.
+  /// \return Errors for the worlds with a duplicate name.
+  public: Errors Collect(const std::string &_filename,
+                         const ParserConfig &_config,
+                         const std::vector<std::pair<std::string,
+                             std::size_t>> &_worlds,
+                         const bool _arena)
+  {
+    Errors errors;
+    this->filename = _filename;
+    this->config = _config;
+    this->config.SetWorldFilter(nullptr);
+    this->config.SetWorldsOnDemand(false);
+    this->arena = _arena;
+    this->positions.clear();
+    this->names.clear();
+    this->worlds.clear();
+    this->loadErrors.clear();
+
+    for (const auto &world : _worlds)
+    {
+      if (!this->names.emplace(world.first, this->positions.size()).second)
+      {
+        errors.push_back({ErrorCode::DUPLICATE_NAME,
+            "world with name[" + world.first + "] already exists."});
+        continue;
+      }
+      this->positions.push_back(world.second);
+    }
+
+    this->worlds.resize(this->positions.size());
+    this->loadErrors.resize(this->positions.size());
+    this->read = std::make_unique<std::once_flag[]>(this->positions.size());
+    return errors;
+  }
+
+  /// \brief Get the number of worlds.
+  /// \return Number of worlds.
+  public: uint64_t Count() const
+  {
+    return this->worlds.size();
+  }
+
+  /// \brief Get whether a world name exists, without reading the world.
+  /// \param[in] _name Name of the world.
+  /// \return True if there exists a world with the given name.
+  public: bool NameExists(std::string_view _name) const
+  {
+    return this->names.count(std::string(_name)) > 0;
+  }
+
+  /// \brief Get the index of a world.
+  /// \param[in] _name Name of the world.
+  /// \return Index of the world, or Count() if the name does not exist.
+  public: uint64_t Index(const std::string &_name) const
+  {
+    auto iter = this->names.find(_name);
+    return iter == this->names.end() ? this->Count() : iter->second;
+  }
+
+  /// \brief Get a world, reading it from the file if it was not accessed
+  /// before. Only this world is read, with its includes, which are taken
+  /// from the include cache if another world included them. Several
+  /// threads may get worlds at once, as in LazyDomObjects::ByIndex, and
+  /// each world is allocated from its own arena.
+  /// \param[in] _index Index of the world.
+  /// \return The world, or nullptr if the index does not exist.
+  public: const World *ByIndex(const uint64_t _index) const
+  {
+    if (_index >= this->worlds.size())
+      return nullptr;
+    std::call_once(this->read[_index], [this, _index]()
+        {
+          this->Read(_index);
+        });
+    return this->worlds[_index].get();
+  }
+
+  /// \brief Read a world from the file, for ByIndex.
+  /// \param[in] _index Index of the world, which must exist.
+  private: void Read(const uint64_t _index) const
+  {
+    Errors &errors = this->loadErrors[_index];
+    this->worlds[_index] = std::make_unique<World>();
+
+    ParserConfig worldConfig = this->config;
+    const std::size_t position = this->positions[_index];
+    std::size_t visited = 0;
+    worldConfig.SetWorldFilter([&](const std::string &)
+        {
+          return visited++ == position;
+        });
+
+    SDFPtr sdfParsed = readFile(this->filename, worldConfig, errors);
+    ElementPtr worldElem;
+    if (sdfParsed && sdfParsed->Root()->HasElement("world"))
+      worldElem = sdfParsed->Root()->GetElement("world");
+    if (!worldElem)
+    {
+      errors.push_back({ErrorCode::FILE_READ,
+          "Unable to read world[" + std::to_string(_index) + "] of file:" +
+          this->filename});
+      return;
+    }
+
+    ScopedElementRelease release(this->config.ReleaseElements());
+    ScopedMaterialSharing materials(this->config.ShareMaterials());
+    ScopedElementArena arenaScope(this->arena);
+    ScopedLoadThreadCount threads(this->config.ModelLoadThreadCount());
+    ScopedValidationLevel validation(this->config.Validation());
+    ScopedTaskExecutor executor(this->config);
+    ScopedParserConfig configScope(this->config);
+    LoadMonitor monitor(this->config);
+    ScopedLoadMonitor monitorScope(&monitor);
+    Errors worldErrors = this->worlds[_index]->Load(worldElem, this->config);
+    errors.insert(errors.end(), worldErrors.begin(), worldErrors.end());
+  }
+
+  /// \brief Get a world based on its name, reading it if it was not
+  /// accessed before.
+  /// \param[in] _name Name of the world.
+  /// \return The world, or nullptr if the name does not exist.
+  public: const World *ByName(const std::string &_name) const
+  {
+    return this->ByIndex(this->Index(_name));
+  }
+
+  /// \brief Get the errors of reading and loading a world, reading it if
+  /// it was not accessed before.
+  /// \param[in] _index Index of the world, which must exist.
+  /// \return The errors.
+  public: const Errors &LoadErrors(const uint64_t _index) const
+  {
+    this->ByIndex(_index);
+    return this->loadErrors[_index];
+  }
+
+  /// \brief Read all the worlds.
+  /// \param[out] _errors The errors of reading every world are appended
+  /// to this vector.
+  public: void LoadAll(Errors &_errors) const
+  {
+    for (uint64_t i = 0; i < this->worlds.size(); ++i)
+    {
+      const Errors &errors = this->LoadErrors(i);
+      _errors.insert(_errors.end(), errors.begin(), errors.end());
+    }
+  }
+
+  /// \brief The file name given to Root::Load.
+  private: std::string filename;
+
+  /// \brief The configuration to read the worlds with.
+  private: ParserConfig config;
+
+  /// \brief Position of each world among the <world> elements of the file.
+  private: std::vector<std::size_t> positions;
+
+  /// \brief The indices of the worlds by name.
+  private: std::unordered_map<std::string, std::size_t> names;
+
+  /// \brief The worlds, which are null until they are first accessed.
+  private: mutable std::vector<std::unique_ptr<World>> worlds;
+
+  /// \brief The errors of reading and loading each world.
+  private: mutable std::vector<Errors> loadErrors;
+
+  /// \brief Flag of each world, set once the world is read.
+  private: mutable std::unique_ptr<std::once_flag[]> read;
+
+  /// \brief True if the worlds are allocated from an arena.
+  private: bool arena = false;
+};
+
+/// \brief The files that a document loaded from a file was read from, so
+/// that Root::Reload only reloads what changed.
+struct RootSources
+{
+  /// \brief The file name given to Root::Load.
+  std::string filename;
+
+  /// \brief The configuration given to Root::Load.
+  ParserConfig config;
+
+  /// \brief Resolved path of the file given to Root::Load.
+  std::string rootPath;
+
+  /// \brief Modification time of every file of the document, by path.
+  std::map<std::string, std::time_t> writeTimes;
+
+  /// \brief Files of the elements of each top level object, by element
+  /// name, in document order.
+  std::map<std::string, std::vector<std::set<std::string>>> objectFiles;
+
+  /// \brief True if the DOM objects of each type match their elements one
+  /// to one, which is the case when the load had no errors.
+  bool incremental = false;
+};
+
+/// \brief Add the files of the elements of a tree to a set.
+/// \param[in] _elem Root of the tree.
+/// \param[in] _parentPath File path of the parent of _elem, since only
+/// the elements of an included file differ from their parent.
+/// \param[in,out] _files The set of files.
+static void collectFiles(const ElementPtr &_elem,
+    const std::string &_parentPath, std::set<std::string> &_files)
+{
+  // Paths of the elements being visited, from _elem to the current one.
+  std::vector<const std::string *> paths = {&_parentPath};
+  _elem->Visit(
+      [&](const Element &_visited)
+      {
+        const std::string &path = _visited.FilePath();
+        if (path != *paths.back() && !path.empty() && path != "data-string")
+          _files.insert(path);
+        paths.push_back(&path);
+        // Deferred elements were copied from the same file.
+        return !_visited.ElementsDeferred();
+      },
+      [&](const Element &)
+      {
+        paths.pop_back();
+      });
+}
+
+/// \brief Record the files of a document read from a file.
+/// \param[in] _filename The file name given to Root::Load.
+/// \param[in] _config The configuration given to Root::Load.
+/// \param[in] _root The root element of the document.
+/// \return The files.
+static std::unique_ptr<RootSources> recordSources(
+    const std::string &_filename, const ParserConfig &_config,
+    const ElementPtr &_root)
+{
+  auto sources = std::make_unique<RootSources>();
+  sources->filename = _filename;
+  sources->config = _config;
+  sources->rootPath = _root->FilePath();
+
+  std::set<std::string> files;
+  if (!sources->rootPath.empty())
+    files.insert(sources->rootPath);
+
+  for (const ElementPtr &elem : _root->Children())
+  {
+    std::set<std::string> elemFiles;
+    collectFiles(elem, sources->rootPath, elemFiles);
+    files.insert(elemFiles.begin(), elemFiles.end());
+    sources->objectFiles[elem->GetName()].push_back(std::move(elemFiles));
+  }
+
+  for (const std::string &file : files)
+    sources->writeTimes[file] = filesystem::status(file).write_time;
+  return sources;
+}
+
+/// \brief Reload the top level objects of one type whose files changed.
+/// \param[in] _root Root element of the new document.
+/// \param[in] _sdfName Name of the elements of the objects.
+/// \param[in] _objs The loaded objects.
+/// \param[in] _sources Files of the loaded document.
+/// \param[in] _changed Files that changed.
+/// \param[in] _load Function that loads an object from an element.
+/// \param[out] _reloaded The reloaded objects, by index in _objs.
+/// \param[out] _errors Errors of the reloaded objects are appended to this.
+/// \return False if the objects no longer match their elements, such as
+/// when an object was renamed, in which case the whole document must be
+/// loaded again.
+template <typename T>
+static bool reloadChanged(const ElementPtr &_root, const std::string &_sdfName,
+    const std::vector<T> &_objs, const RootSources &_sources,
+    const std::set<std::string> &_changed,
+    const std::function<Errors(T &, ElementPtr)> &_load,
+    std::vector<std::pair<std::size_t, T>> &_reloaded, Errors &_errors)
+{
+  static const std::vector<std::set<std::string>> kNoFiles;
+  auto filesIter = _sources.objectFiles.find(_sdfName);
+  const std::vector<std::set<std::string>> &files =
+      filesIter != _sources.objectFiles.end() ? filesIter->second : kNoFiles;
+  if (files.size() != _objs.size())
+    return false;
+
+  std::size_t i = 0;
+  for (const ElementPtr &elem : _root->Children(_sdfName))
+  {
+    if (i >= _objs.size())
+      return false;
+
+    const bool changed = std::any_of(files[i].begin(), files[i].end(),
+        [&](const std::string &_file)
+        {
+          return _changed.count(_file) > 0;
+        });
+    if (!changed)
+    {
+      ++i;
+      continue;
+    }
+
+    T obj;
+    Errors loadErrors = _load(obj, elem);
+    if (obj.Name() != _objs[i].Name())
+      return false;
+    _errors.insert(_errors.end(), loadErrors.begin(), loadErrors.end());
+    _reloaded.emplace_back(i, std::move(obj));
+    ++i;
+  }
+  return i == _objs.size();
+}
+
+/// \brief Private data for sdf::Root
+class sdf::RootPrivate
+{
+  /// \brief Destructor. The objects allocated from the arena keep it
+  /// alive until they are destroyed.
+  public: ~RootPrivate()
+  {
+    this->ResetArena(false);
+  }
+
+  /// \brief Replace the arena the DOM objects are allocated from.
+  /// \param[in] _enable True to create a new arena, as with
+  /// ParserConfig::ArenaAllocation, false to allocate from the heap.
+  public: void ResetArena(const bool _enable)
+  {
+    if (this->arena)
+      this->arena->Release();
+    this->arena = _enable ? new ElementArena : nullptr;
+  }
+
+  /// \brief Version string
+  public: std::string version = "";
+
+  /// \brief Statistics of the last load.
+  public: sdf::LoadStatistics loadStatistics;
+
+  /// \brief The worlds specified under the root SDF element
+  public: std::vector<World> worlds;
+
+  /// \brief The models specified under the root SDF element
+  public: std::vector<Model> models;
+
+  /// \brief The lights specified under the root SDF element
+  public: std::vector<Light> lights;
+
+  /// \brief The actors specified under the root SDF element
+  public: std::vector<Actor> actors;
+
+  /// \brief Index of the worlds by name.
+  public: NameIndex worldIndex;
+
+  /// \brief Index of the models by name.
+  public: NameIndex modelIndex;
+
+  /// \brief Index of the lights by name.
+  public: NameIndex lightIndex;
+
+  /// \brief Index of the actors by name.
+  public: NameIndex actorIndex;
+
+  /// \brief The SDF element pointer generated during load.
+  public: sdf::ElementPtr sdf;
+
+  /// \brief True if the DOM objects are generated on first access, in
+  /// which case the lazy objects below are used instead of the vectors
+  /// above.
+  public: bool lazy = false;
+
+  /// \brief The worlds, when loading lazily.
+  public: LazyDomObjects<World> lazyWorlds;
+
+  /// \brief The models, when loading lazily.
+  public: LazyDomObjects<Model> lazyModels;
+
+  /// \brief The lights, when loading lazily.
+  public: LazyDomObjects<Light> lazyLights;
+
+  /// \brief The actors, when loading lazily.
+  public: LazyDomObjects<Actor> lazyActors;
+
+  /// \brief True if the elements are released once the objects are
+  /// generated.
+  public: bool releaseElements = false;
+
+  /// \brief Serializes the release of the elements by LoadDeferred. The
+  /// lazy objects themselves are generated once each, without lock.
+  public: mutable std::mutex releaseMutex;
+
+  /// \brief Arena that the private data of the DOM objects is allocated
+  /// from, or nullptr.
+  public: ElementArena *arena = nullptr;
+
+  /// \brief The files of the document, if it was loaded from a file.
+  public: std::unique_ptr<RootSources> sources;
+
+  /// \brief True if the worlds are read on demand, in which case the
+  /// worlds below are used instead of the worlds above.
+  public: bool worldsOnDemand = false;
+
+  /// \brief The worlds, when reading them on demand.
+  public: OnDemandWorlds onDemandWorlds;
+
+  /// \brief Get a world based on its name.
+  /// \param[in] _name Name of the world.
+  /// \return Pointer to the world. Nullptr if the name does not exist.
+  public: const World *WorldByName(const std::string &_name) const
+  {
+    if (this->worldsOnDemand)
+      return this->onDemandWorlds.ByName(_name);
+    if (this->lazy)
+      return this->lazyWorlds.ByName(_name);
+    return this->worldIndex.Find(this->worlds, _name);
+  }
+
+  /// \brief Get a model based on its name.
+  /// \param[in] _name Name of the model.
+  /// \return Pointer to the model. Nullptr if the name does not exist.
+  public: const Model *ModelByName(const std::string &_name) const
+  {
+    if (this->lazy)
+      return this->lazyModels.ByName(_name);
+    return this->modelIndex.Find(this->models, _name);
+  }
+};
+
+/// \brief Report the errors of loading a root as set by
+/// ParserConfig::MaxErrors and ParserConfig::ErrorCallback.
+/// \param[in] _errors The errors.
+/// \param[in] _config The parser configuration.
+/// \return The errors to return, which are empty if they were passed to
+/// the error callback.
+static Errors reportErrors(Errors _errors, const ParserConfig &_config)
+{
+  if (_config.MaxErrors() > 0 && _errors.size() > _config.MaxErrors())
+    _errors.resize(_config.MaxErrors());
+
+  const auto &callback = _config.ErrorCallback();
+  if (!callback)
+    return _errors;
+
+  for (const Error &error : _errors)
+    callback(error);
+  return Errors();
+}
+
+/// \brief Counts the work of a load of a root on the threads of the load,
+/// and records it as the statistics of the root when destroyed.
+class ScopedRootStatistics
+{
+  /// \brief Constructor.
+  /// \param[out] _statistics Statistics of the root.
+  public: explicit ScopedRootStatistics(LoadStatistics &_statistics)
+    : statistics(_statistics), scope(&counters)
+  {
+  }
+
+  /// \brief Destructor, which records the statistics.
+  public: ~ScopedRootStatistics()
+  {
+    this->statistics = this->counters.Statistics();
+  }
+
+  /// \brief Statistics of the root.
+  private: LoadStatistics &statistics;
+
+  /// \brief The counters of the load.
+  private: LoadCounters counters;
+
+  /// \brief Makes the load count its work in the counters.
+  private: ScopedLoadCounters scope;
+};
+
+/////////////////////////////////////////////////
+Root::Root()
+  : dataPtr(new RootPrivate)
+{
+}
+
+/////////////////////////////////////////////////
+Root::~Root()
+{
+  delete this->dataPtr;
+  this->dataPtr = nullptr;
+}
+
+/////////////////////////////////////////////////
+Errors Root::Load(const std::string &_filename)
+{
+  return this->Load(_filename, ParserConfig());
+}
+
+/////////////////////////////////////////////////
+/// \brief Get the configuration that a root reads a document with, which
+/// reads included files through an include cache, so that the worlds and
+/// models of the document that include the same file read it once.
+/// \param[in] _config The configuration given to the root.
+/// \return A copy of _config, with an include cache that only lasts for
+/// the load if it has none.
+static ParserConfig sharedIncludeConfig(const ParserConfig &_config)
+{
+  ParserConfig config = _config;
+  if (!config.IncludeCache())
+    config.SetIncludeCache(std::make_shared<IncludeCache>());
+  return config;
+}
+
+/////////////////////////////////////////////////
+Errors Root::Load(const std::string &_filename, const ParserConfig &_config)
+{
+  ScopedRootStatistics statistics(this->dataPtr->loadStatistics);
+  ErrorLimit limit(_config.MaxErrors());
+  ScopedErrorLimit errorScope(&limit);
+  Errors errors;
+
+  // When the worlds are read on demand, only their names are read now.
+  ParserConfig config = sharedIncludeConfig(_config);
+  std::vector<std::pair<std::string, std::size_t>> onDemandWorlds;
+  if (_config.WorldsOnDemand())
+  {
+    std::size_t position = 0;
+    config.SetWorldFilter(
+        [&onDemandWorlds, &position, &_config](const std::string &_name)
+        {
+          if (!_config.WorldFilter() || _config.WorldFilter()(_name))
+            onDemandWorlds.emplace_back(_name, position);
+          ++position;
+          return false;
+        });
+  }
+
+  // Read an SDF file, and store the result in sdfParsed.
+  SDFPtr sdfParsed;
+  {
+    ScopedLoadTimer readTimer(&LoadCounters::readNanoseconds);
+    sdfParsed = readFile(_filename, config, errors);
+  }
+
+  // Return if we were not able to read the file.
+  if (!sdfParsed)
+  {
+    errors.push_back(
+        {ErrorCode::FILE_READ, "Unable to read file:" + _filename});
+    return reportErrors(std::move(errors), _config);
+  }
+
+  std::unique_ptr<RootSources> sources =
+      recordSources(_filename, _config, sdfParsed->Root());
+
+  Errors loadErrors = this->LoadDom(sdfParsed, config);
+  errors.insert(errors.end(), loadErrors.begin(), loadErrors.end());
+
+  if (_config.WorldsOnDemand() && !this->dataPtr->version.empty())
+  {
+    Errors collectErrors = this->dataPtr->onDemandWorlds.Collect(_filename,
+        config, onDemandWorlds, this->dataPtr->arena != nullptr);
+    errors.insert(errors.end(), collectErrors.begin(), collectErrors.end());
+    this->dataPtr->worldsOnDemand = true;
+  }
+
+  sources->incremental = errors.empty() && !this->dataPtr->lazy &&
+      !this->dataPtr->worldsOnDemand;
+  this->dataPtr->sources = std::move(sources);
+
+  return reportErrors(std::move(errors), _config);
+}
+
+/////////////////////////////////////////////////
+/// \brief Load a model of a patch, as Root::ApplyPatch.
+/// \param[in] _xml The <model> element of the patch.
+/// \param[in] _version Version of the root that the patch is applied to.
+/// \param[in] _config The parser configuration.
+/// \param[out] _model The model.
+/// \return Errors.
+static Errors loadPatchModel(const TiXmlElement *_xml,
+    const std::string &_version, const ParserConfig &_config, Model &_model)
+{
+  Errors errors;
+  std::string xml = "<sdf version='" + _version + "'>";
+  xml << *_xml;
+  xml += "</sdf>";
+
+  SDFPtr sdfParsed(new SDF());
+  init(sdfParsed, _config);
+  if (!readString(xml, _config, sdfParsed, errors))
+  {
+    errors.push_back({ErrorCode::STRING_READ,
+        "Unable to read model of patch: " + xml});
+    return errors;
+  }
+
+  ElementPtr modelElem = sdfParsed->Root()->FindElement("model");
+  if (!modelElem)
+  {
+    errors.push_back({ErrorCode::ELEMENT_MISSING,
+        "Model of patch was not read: " + xml});
+    return errors;
+  }
+  return _model.Load(modelElem);
+}
+
+/////////////////////////////////////////////////
+Errors Root::ApplyPatch(const std::string &_patch, const ParserConfig &_config)
+{
+  ErrorLimit limit(_config.MaxErrors());
+  ScopedErrorLimit errorScope(&limit);
+  Errors errors;
+
+  TiXmlDocument doc;
+  doc.Parse(_patch.c_str());
+  const TiXmlElement *patchXml = doc.FirstChildElement("patch");
+  if (doc.Error() || !patchXml)
+  {
+    errors.push_back({ErrorCode::STRING_READ,
+        "Unable to read patch: " + _patch});
+    return reportErrors(std::move(errors), _config);
+  }
+
+  // The worlds are owned by this root, and only their const accessors
+  // handle lazy loading.
+  const char *worldName = patchXml->Attribute("world");
+  const World *constWorld = worldName ?
+      this->dataPtr->WorldByName(worldName) :
+      (this->WorldCount() == 1 ? this->WorldByIndex(0) : nullptr);
+  if (!constWorld)
+  {
+    errors.push_back({ErrorCode::ELEMENT_MISSING, std::string(
+        worldName ? "No world with name[" + std::string(worldName) + "]" :
+        "No single world") + " to apply the patch to."});
+    return reportErrors(std::move(errors), _config);
+  }
+  World *world = const_cast<World *>(constWorld);
+  ElementPtr worldElem = world->Element();
+
+  for (const TiXmlElement *op = patchXml->FirstChildElement(); op;
+       op = op->NextSiblingElement())
+  {
+    const std::string opName = op->ValueStr();
+    if (opName == "add" || opName == "replace")
+    {
+      for (const TiXmlElement *modelXml = op->FirstChildElement("model");
+           modelXml; modelXml = modelXml->NextSiblingElement("model"))
+      {
+        Model model;
+        errors = loadPatchModel(modelXml, this->dataPtr->version, _config,
+            model);
+        if (!errors.empty())
+          return reportErrors(std::move(errors), _config);
+
+        ElementPtr modelElem = model.Element();
+        ElementPtr oldElem;
+        if (opName == "add")
+        {
+          errors = world->AddModel(std::move(model));
+        }
+        else
+        {
+          const Model *oldModel = world->ModelByName(model.Name());
+          oldElem = oldModel ? oldModel->Element() : nullptr;
+          errors = world->ReplaceModel(std::move(model));
+        }
+        if (!errors.empty())
+          return reportErrors(std::move(errors), _config);
+
+        if (worldElem)
+        {
+          if (oldElem)
+            worldElem->RemoveChild(oldElem);
+          modelElem->SetParent(worldElem);
+          worldElem->InsertElement(modelElem);
+        }
+      }
+    }
+    else if (opName == "remove")
+    {
+      const char *name = op->Attribute("name");
+      const Model *model = name ? world->ModelByName(name) : nullptr;
+      ElementPtr modelElem = model ? model->Element() : nullptr;
+      errors = world->RemoveModel(name ? name : "");
+      if (!errors.empty())
+        return reportErrors(std::move(errors), _config);
+
+      if (worldElem && modelElem)
+        worldElem->RemoveChild(modelElem);
+    }
+    else if (opName == "pose")
+    {
+      const char *name = op->Attribute("name");
+      const char *relativeTo = op->Attribute("relative_to");
+      Param poseParam("pose", "pose", "0 0 0 0 0 0", false);
+      ignition::math::Pose3d pose;
+      if (!name || !poseParam.SetFromString(op->GetText() ? op->GetText() :
+            "") || !poseParam.Get(pose))
+      {
+        errors.push_back({ErrorCode::ELEMENT_INVALID,
+            "Invalid <pose> element in patch."});
+        return reportErrors(std::move(errors), _config);
+      }
+
+      errors = world->UpdateFramePose(name, pose,
+          relativeTo ? relativeTo : "");
+      if (!errors.empty())
+        return reportErrors(std::move(errors), _config);
+
+      const Model *model = world->ModelByName(name);
+      const Frame *frame = model ? nullptr : world->FrameByName(name);
+      ElementPtr elem = model ? model->Element() :
+          (frame ? frame->Element() : nullptr);
+      if (elem)
+      {
+        ElementPtr poseElem = elem->GetElement("pose");
+        poseElem->Set(pose);
+        poseElem->GetAttribute("relative_to")->Set(
+            std::string(relativeTo ? relativeTo : ""));
+      }
+    }
+    else
+    {
+      errors.push_back({ErrorCode::ELEMENT_INVALID,
+          "Unknown operation <" + opName + "> in patch."});
+      return reportErrors(std::move(errors), _config);
+    }
+  }
+
+  return reportErrors(std::move(errors), _config);
+}
+
+/////////////////////////////////////////////////
+Errors Root::Reload()
+{
+  Errors errors;
+  if (!this->dataPtr->sources)
+  {
+    errors.push_back({ErrorCode::FILE_READ,
+        "Unable to reload, since no file was loaded by Root::Load."});
+    return errors;
+  }
+
+  const RootSources &sources = *this->dataPtr->sources;
+  const ParserConfig config = sources.config;
+  ErrorLimit limit(config.MaxErrors());
+  ScopedErrorLimit errorScope(&limit);
+
+  std::set<std::string> changed;
+  for (const auto &file : sources.writeTimes)
+  {
+    if (filesystem::status(file.first).write_time != file.second)
+      changed.insert(file.first);
+  }
+  if (changed.empty())
+    return errors;
+
+  // The worlds read on demand are read from the new file again.
+  if (config.WorldsOnDemand())
+    return this->Load(std::string(sources.filename), config);
+
+  // Included files that did not change are taken from the include cache
+  // of the configuration, if any.
+  SDFPtr sdfParsed = readFile(sources.filename, config, errors);
+  if (!sdfParsed)
+  {
+    errors.push_back(
+        {ErrorCode::FILE_READ, "Unable to read file:" + sources.filename});
+    return reportErrors(std::move(errors), config);
+  }
+
+  std::unique_ptr<RootSources> newSources =
+      recordSources(sources.filename, config, sdfParsed->Root());
+
+  // The top level objects can only be matched to their elements if the
+  // file that lists them did not change.
+  bool incremental = sources.incremental &&
+      changed.count(sources.rootPath) == 0 &&
+      newSources->rootPath == sources.rootPath &&
+      newSources->objectFiles.size() == sources.objectFiles.size();
+
+  std::vector<std::pair<std::size_t, World>> worlds;
+  std::vector<std::pair<std::size_t, Model>> models;
+  std::vector<std::pair<std::size_t, Light>> lights;
+  std::vector<std::pair<std::size_t, Actor>> actors;
+  Errors reloadErrors;
+  if (incremental)
+  {
+    ScopedElementRelease release(this->dataPtr->releaseElements);
+    ScopedMaterialSharing materials(config.ShareMaterials());
+    ScopedElementArena arena(this->dataPtr->arena);
+    ScopedLoadThreadCount threads(config.ModelLoadThreadCount());
+    ScopedValidationLevel validation(config.Validation());
+    ScopedTaskExecutor executor(config);
+    ScopedParserConfig configScope(config);
+    LoadMonitor monitor(config);
+    ScopedLoadMonitor monitorScope(&monitor);
+
+    const ElementPtr root = sdfParsed->Root();
+    incremental =
+        reloadChanged<World>(root, "world", this->dataPtr->worlds, sources,
+            changed, [&config](World &_world, ElementPtr _elem)
+            {
+              return _world.Load(_elem, config);
+            }, worlds, reloadErrors) &&
+        reloadChanged<Model>(root, "model", this->dataPtr->models, sources,
+            changed, [](Model &_model, ElementPtr _elem)
+            {
+              return _model.Load(_elem);
+            }, models, reloadErrors) &&
+        reloadChanged<Light>(root, "light", this->dataPtr->lights, sources,
+            changed, [](Light &_light, ElementPtr _elem)
+            {
+              return _light.Load(_elem);
+            }, lights, reloadErrors) &&
+        reloadChanged<Actor>(root, "actor", this->dataPtr->actors, sources,
+            changed, [](Actor &_actor, ElementPtr _elem)
+            {
+              return _actor.Load(_elem);
+            }, actors, reloadErrors);
+  }
+
+  if (!incremental)
+  {
+    // Load the whole document into new objects.
+    std::unique_ptr<RootPrivate> previous(this->dataPtr);
+    this->dataPtr = new RootPrivate;
+    Errors loadErrors = this->LoadDom(sdfParsed, config);
+    errors.insert(errors.end(), loadErrors.begin(), loadErrors.end());
+    newSources->incremental = errors.empty() && !this->dataPtr->lazy;
+    this->dataPtr->sources = std::move(newSources);
+    return reportErrors(std::move(errors), config);
+  }
+
+  // The names did not change, so the name indices are still valid.
+  for (auto &world : worlds)
+    this->dataPtr->worlds[world.first] = std::move(world.second);
+  for (auto &model : models)
+    this->dataPtr->models[model.first] = std::move(model.second);
+  for (auto &light : lights)
+    this->dataPtr->lights[light.first] = std::move(light.second);
+  for (auto &actor : actors)
+    this->dataPtr->actors[actor.first] = std::move(actor.second);
+
+  this->dataPtr->sdf = this->dataPtr->releaseElements ?
+      ElementPtr() : sdfParsed->Root();
+  errors.insert(errors.end(), reloadErrors.begin(), reloadErrors.end());
+  newSources->incremental = errors.empty();
+  this->dataPtr->sources = std::move(newSources);
+  return reportErrors(std::move(errors), config);
+}
+
+/////////////////////////////////////////////////
+LoadHandle Root::LoadAsync(const std::string &_filename,
+    const ParserConfig &_config)
+{
+  LoadHandle handle(new LoadHandlePrivate);
+
+  // The load stops when the handle is cancelled, or when the callback of
+  // the caller says so.
+  ParserConfig config = _config;
+  std::shared_ptr<std::atomic<bool>> cancelled = handle.dataPtr->cancelled;
+  std::function<bool()> cancel = _config.CancelCallback();
+  config.SetCancelCallback([cancelled, cancel]()
+      {
+        return *cancelled || (cancel && cancel());
+      });
+
+  handle.dataPtr->result = std::async(std::launch::async,
+      [this, _filename, config]()
+      {
+        return this->Load(_filename, config);
+      }).share();
+
+  return handle;
+}
 
-/// \brief Private data for sdf::Root
-class sdf::RootPrivate
+/////////////////////////////////////////////////
+Errors Root::LoadSdfString(const std::string &_sdf)
 {
-  /// \brief Version string
-  public: std::string version = "";
-
-  /// \brief The worlds specified under the root SDF element
-  public: std::vector<World> worlds;
+  return this->LoadSdfString(_sdf, ParserConfig());
+}
 
-  /// \brief The models specified under the root SDF element
-  public: std::vector<Model> models;
+/////////////////////////////////////////////////
+Errors Root::LoadSdfString(const std::string &_sdf,
+    const ParserConfig &_config)
+{
+  ScopedRootStatistics statistics(this->dataPtr->loadStatistics);
+  ErrorLimit limit(_config.MaxErrors());
+  ScopedErrorLimit errorScope(&limit);
+  Errors errors;
+  SDFPtr sdfParsed(new SDF());
+  init(sdfParsed, _config);
 
-  /// \brief The lights specified under the root SDF element
-  public: std::vector<Light> lights;
+  // Read an SDF string, and store the result in sdfParsed.
+  bool read = false;
+  {
+    ScopedLoadTimer readTimer(&LoadCounters::readNanoseconds);
+    read = readString(_sdf, sharedIncludeConfig(_config), sdfParsed, errors);
+  }
+  if (!read)
+  {
+    errors.push_back(
+        {ErrorCode::STRING_READ, "Unable to SDF string: " + _sdf});
+    return reportErrors(std::move(errors), _config);
+  }
 
-  /// \brief The actors specified under the root SDF element
-  public: std::vector<Actor> actors;
+  Errors loadErrors = this->LoadDom(sdfParsed, _config);
+  errors.insert(errors.end(), loadErrors.begin(), loadErrors.end());
 
-  /// \brief The SDF element pointer generated during load.
-  public: sdf::ElementPtr sdf;
-};
+  return reportErrors(std::move(errors), _config);
+}
 
 /////////////////////////////////////////////////
-Root::Root()
-  : dataPtr(new RootPrivate)
+Errors Root::LoadSdfString(const char *_data, std::size_t _size,
+    const ParserConfig &_config)
 {
+  ScopedRootStatistics statistics(this->dataPtr->loadStatistics);
+  ErrorLimit limit(_config.MaxErrors());
+  ScopedErrorLimit errorScope(&limit);
+  Errors errors;
+  SDFPtr sdfParsed(new SDF());
+  init(sdfParsed, _config);
+
+  // Read the buffer, and store the result in sdfParsed.
+  bool read = false;
+  {
+    ScopedLoadTimer readTimer(&LoadCounters::readNanoseconds);
+    read = readString(_data, _size, sharedIncludeConfig(_config), sdfParsed,
+        errors);
+  }
+  if (!read)
+  {
+    errors.push_back({ErrorCode::STRING_READ, "Unable to SDF string: " +
+        std::string(_data, std::find(_data, _data + _size, '\0'))});
+    return reportErrors(std::move(errors), _config);
+  }
+
+  Errors loadErrors = this->LoadDom(sdfParsed, _config);
+  errors.insert(errors.end(), loadErrors.begin(), loadErrors.end());
+
+  return reportErrors(std::move(errors), _config);
 }
 
 /////////////////////////////////////////////////
-Root::~Root()
+Errors Root::LoadBinary(const std::string &_filename)
 {
-  delete this->dataPtr;
-  this->dataPtr = nullptr;
+  return this->LoadBinary(_filename, ParserConfig());
 }
 
 /////////////////////////////////////////////////
-Errors Root::Load(const std::string &_filename)
+Errors Root::LoadBinary(const std::string &_filename,
+    const ParserConfig &_config)
 {
+  ErrorLimit limit(_config.MaxErrors());
+  ScopedErrorLimit errorScope(&limit);
   Errors errors;
 
-  // Read an SDF file, and store the result in sdfParsed.
-  SDFPtr sdfParsed = readFile(_filename, errors);
-
-  // Return if we were not able to read the file.
-  if (!sdfParsed)
+  MappedFile file(_filename);
+  if (!file.Valid())
   {
     errors.push_back(
         {ErrorCode::FILE_READ, "Unable to read file:" + _filename});
-    return errors;
+    return reportErrors(std::move(errors), _config);
+  }
+
+  SDFPtr sdfParsed(new SDF());
+  init(sdfParsed);
+
+  if (!readBinary(file.Data(), file.Size(), sdfParsed, _config, errors))
+  {
+    errors.push_back(
+        {ErrorCode::FILE_READ, "Unable to read binary file:" + _filename});
+    return reportErrors(std::move(errors), _config);
   }
 
-  Errors loadErrors = this->Load(sdfParsed);
+  Errors loadErrors = this->LoadDom(sdfParsed, _config);
   errors.insert(errors.end(), loadErrors.begin(), loadErrors.end());
 
-  return errors;
+  return reportErrors(std::move(errors), _config);
 }
 
 /////////////////////////////////////////////////
-Errors Root::LoadSdfString(const std::string &_sdf)
+Errors Root::SaveBinary(const std::string &_filename) const
 {
   Errors errors;
-  SDFPtr sdfParsed(new SDF());
-  init(sdfParsed);
-
-  // Read an SDF string, and store the result in sdfParsed.
-  if (!readString(_sdf, sdfParsed, errors))
+  if (!this->dataPtr->sdf)
   {
-    errors.push_back(
-        {ErrorCode::STRING_READ, "Unable to SDF string: " + _sdf});
+    errors.push_back({ErrorCode::ELEMENT_MISSING,
+        "Unable to write binary file:" + _filename + ", since nothing is "
+        "loaded."});
     return errors;
   }
 
-  Errors loadErrors = this->Load(sdfParsed);
-  errors.insert(errors.end(), loadErrors.begin(), loadErrors.end());
+  std::string data;
+  writeBinary(this->dataPtr->sdf, data);
 
+  std::ofstream out(_filename, std::ios::binary);
+  out.write(data.data(), static_cast<std::streamsize>(data.size()));
+  out.close();
+  if (!out)
+  {
+    errors.push_back(
+        {ErrorCode::FILE_WRITE, "Unable to write file:" + _filename});
+  }
   return errors;
 }
 
+/////////////////////////////////////////////////
+Errors Root::WriteFlat(std::string &_buffer) const
+{
+  return writeFlat(*this, _buffer);
+}
+
 /////////////////////////////////////////////////
 Errors Root::Load(SDFPtr _sdf)
 {
+  return this->Load(_sdf, ParserConfig());
+}
+
+/////////////////////////////////////////////////
+Errors Root::Load(SDFPtr _sdf, const ParserConfig &_config)
+{
+  ScopedRootStatistics statistics(this->dataPtr->loadStatistics);
+  ErrorLimit limit(_config.MaxErrors());
+  ScopedErrorLimit errorScope(&limit);
+  return reportErrors(this->LoadDom(_sdf, _config), _config);
+}
+
+/////////////////////////////////////////////////
+Errors Root::LoadDom(SDFPtr _sdf, const ParserConfig &_config)
+{
+  ScopedLoadTimer domTimer(&LoadCounters::domLoadNanoseconds);
   Errors errors;
 
   this->dataPtr->sdf = _sdf->Root();
 
+  ScopedParseEvent loadEvent(ParseStage::ROOT_LOAD, "sdf::Root::Load",
+      this->dataPtr->sdf->FilePath());
+  loadEvent.SetElements(this->dataPtr->sdf);
+
   // Get the SDF version.
   std::pair<std::string, bool> versionPair =
     this->dataPtr->sdf->Get<std::string>("version", SDF_VERSION);
@@ -142,15 +1306,63 @@ Errors Root::Load(SDFPtr _sdf)
 
   this->dataPtr->version = versionPair.first;
 
+  this->dataPtr->lazy = _config.LazyDomLoading();
+  this->dataPtr->worldsOnDemand = false;
+  this->dataPtr->releaseElements = _config.ReleaseElements();
+  this->dataPtr->ResetArena(_config.ArenaAllocation());
+
+  // The elements read for their names are not complete objects.
+  if (_config.ParseScope() == ParseScope::TOP_LEVEL_NAMES)
+  {
+    this->dataPtr->lazy = false;
+    return errors;
+  }
+
+  if (this->dataPtr->lazy)
+  {
+    // Only check the names of the objects, which are generated on first
+    // access.
+    const bool release = this->dataPtr->releaseElements;
+    const ValidationLevel validation = _config.Validation();
+    const bool share = _config.ShareMaterials();
+    const bool arena = this->dataPtr->arena != nullptr;
+    const std::string &physics = _config.PhysicsProfile();
+    for (const Errors &collectErrors : {
+          this->dataPtr->lazyWorlds.Collect(this->dataPtr->sdf, "world",
+              release, validation, share, arena, physics),
+          this->dataPtr->lazyModels.Collect(this->dataPtr->sdf, "model",
+              release, validation, share, arena, physics),
+          this->dataPtr->lazyLights.Collect(this->dataPtr->sdf, "light",
+              release, validation, share, arena, physics),
+          this->dataPtr->lazyActors.Collect(this->dataPtr->sdf, "actor",
+              release, validation, share, arena, physics)})
+    {
+      errors.insert(errors.end(), collectErrors.begin(), collectErrors.end());
+    }
+    return errors;
+  }
+
+  ScopedElementRelease release(this->dataPtr->releaseElements);
+  ScopedMaterialSharing materials(_config.ShareMaterials());
+  ScopedElementArena arena(this->dataPtr->arena);
+  ScopedLoadThreadCount threads(_config.ModelLoadThreadCount());
+  ScopedValidationLevel validation(_config.Validation());
+  ScopedTaskExecutor executor(_config);
+  ScopedParserConfig configScope(_config);
+  LoadMonitor monitor(_config);
+  ScopedLoadMonitor monitorScope(&monitor);
+
   // Read all the worlds
   if (this->dataPtr->sdf->HasElement("world"))
   {
-    ElementPtr elem = this->dataPtr->sdf->GetElement("world");
-    while (elem)
+    for (const ElementPtr &elem : this->dataPtr->sdf->Children("world"))
     {
+      if (loadStopped())
+        break;
+
       World world;
 
-      Errors worldErrors = world.Load(elem);
+      Errors worldErrors = world.Load(elem, _config);
       // Attempt to load the world
       if (worldErrors.empty())
       {
@@ -164,6 +1376,7 @@ Errors Root::Load(SDFPtr _sdf)
         else
         {
           this->dataPtr->worlds.push_back(std::move(world));
+          this->dataPtr->worldIndex.AddLast(this->dataPtr->worlds);
         }
       }
       else
@@ -173,24 +1386,38 @@ Errors Root::Load(SDFPtr _sdf)
         errors.push_back({ErrorCode::ELEMENT_INVALID,
                           "Failed to load a world."});
       }
-      elem = elem->GetNextElement("world");
     }
   }
 
   // Load all the models.
   Errors modelLoadErrors = loadUniqueRepeated<Model>(this->dataPtr->sdf,
-      "model", this->dataPtr->models);
+      "model", this->dataPtr->models, loadThreadCount());
   errors.insert(errors.end(), modelLoadErrors.begin(), modelLoadErrors.end());
+  this->dataPtr->modelIndex.Build(this->dataPtr->models);
 
   // Load all the lights.
   Errors lightLoadErrors = loadUniqueRepeated<Light>(this->dataPtr->sdf,
       "light", this->dataPtr->lights);
   errors.insert(errors.end(), lightLoadErrors.begin(), lightLoadErrors.end());
+  this->dataPtr->lightIndex.Build(this->dataPtr->lights);
 
   // Load all the actors.
   Errors actorLoadErrors = loadUniqueRepeated<Actor>(this->dataPtr->sdf,
       "actor", this->dataPtr->actors);
   errors.insert(errors.end(), actorLoadErrors.begin(), actorLoadErrors.end());
+  this->dataPtr->actorIndex.Build(this->dataPtr->actors);
+
+  if (monitor.Cancelled())
+  {
+    errors.push_back({ErrorCode::LOAD_CANCELLED,
+        "Loading was cancelled. The objects that were not loaded yet were "
+        "skipped."});
+  }
+
+  // The objects no longer refer to the elements, so the tree is deleted
+  // with the root.
+  if (this->dataPtr->releaseElements)
+    this->dataPtr->sdf.reset();
 
   return errors;
 }
@@ -210,113 +1437,515 @@ void Root::SetVersion(const std::string &_version)
 /////////////////////////////////////////////////
 uint64_t Root::WorldCount() const
 {
+  if (this->dataPtr->worldsOnDemand)
+    return this->dataPtr->onDemandWorlds.Count();
+  if (this->dataPtr->lazy)
+    return this->dataPtr->lazyWorlds.Count();
   return this->dataPtr->worlds.size();
 }
 
 /////////////////////////////////////////////////
 const World *Root::WorldByIndex(const uint64_t _index) const
 {
+  if (this->dataPtr->worldsOnDemand)
+    return this->dataPtr->onDemandWorlds.ByIndex(_index);
+
+  if (this->dataPtr->lazy)
+    return this->dataPtr->lazyWorlds.ByIndex(_index);
+
   if (_index < this->dataPtr->worlds.size())
     return &this->dataPtr->worlds[_index];
   return nullptr;
 }
 
 /////////////////////////////////////////////////
-bool Root::WorldNameExists(const std::string &_name) const
+bool Root::WorldNameExists(std::string_view _name) const
+{
+  if (this->dataPtr->worldsOnDemand)
+    return this->dataPtr->onDemandWorlds.NameExists(_name);
+  if (this->dataPtr->lazy)
+    return this->dataPtr->lazyWorlds.NameExists(_name);
+
+  return this->dataPtr->worldIndex.Find(this->dataPtr->worlds, _name) !=
+      nullptr;
+}
+
+/////////////////////////////////////////////////
+Errors Root::LoadWorld(const uint64_t _index) const
+{
+  Errors errors;
+  if (_index >= this->WorldCount())
+  {
+    errors.push_back({ErrorCode::ELEMENT_MISSING,
+        "No world with index[" + std::to_string(_index) + "]."});
+    return errors;
+  }
+
+  if (this->dataPtr->worldsOnDemand)
+  {
+    errors = this->dataPtr->onDemandWorlds.LoadErrors(_index);
+  }
+  else
+  {
+    this->WorldByIndex(_index);
+  }
+  return errors;
+}
+
+/////////////////////////////////////////////////
+Errors Root::LoadWorld(const std::string &_name) const
 {
-  for (auto const &w : this->dataPtr->worlds)
+  if (this->dataPtr->worldsOnDemand)
   {
-    if (w.Name() == _name)
-    {
-      return true;
-    }
+    const uint64_t index = this->dataPtr->onDemandWorlds.Index(_name);
+    if (index < this->dataPtr->onDemandWorlds.Count())
+      return this->LoadWorld(index);
+  }
+  else if (this->dataPtr->WorldByName(_name))
+  {
+    return Errors();
   }
-  return false;
+
+  Errors errors;
+  errors.push_back({ErrorCode::ELEMENT_MISSING,
+      "No world with name[" + _name + "]."});
+  return errors;
 }
 
 /////////////////////////////////////////////////
 uint64_t Root::ModelCount() const
 {
+  if (this->dataPtr->lazy)
+    return this->dataPtr->lazyModels.Count();
   return this->dataPtr->models.size();
 }
 
 /////////////////////////////////////////////////
 const Model *Root::ModelByIndex(const uint64_t _index) const
 {
+  if (this->dataPtr->lazy)
+    return this->dataPtr->lazyModels.ByIndex(_index);
+
   if (_index < this->dataPtr->models.size())
     return &this->dataPtr->models[_index];
   return nullptr;
 }
 
 /////////////////////////////////////////////////
-bool Root::ModelNameExists(const std::string &_name) const
+bool Root::ModelNameExists(std::string_view _name) const
 {
-  for (auto const &m : this->dataPtr->models)
-  {
-    if (m.Name() == _name)
-    {
-      return true;
-    }
-  }
-  return false;
+  if (this->dataPtr->lazy)
+    return this->dataPtr->lazyModels.NameExists(_name);
+
+  return this->dataPtr->modelIndex.Find(this->dataPtr->models, _name) !=
+      nullptr;
 }
 
 /////////////////////////////////////////////////
 uint64_t Root::LightCount() const
 {
+  if (this->dataPtr->lazy)
+    return this->dataPtr->lazyLights.Count();
   return this->dataPtr->lights.size();
 }
 
 /////////////////////////////////////////////////
 const Light *Root::LightByIndex(const uint64_t _index) const
 {
+  if (this->dataPtr->lazy)
+    return this->dataPtr->lazyLights.ByIndex(_index);
+
   if (_index < this->dataPtr->lights.size())
     return &this->dataPtr->lights[_index];
   return nullptr;
 }
 
 /////////////////////////////////////////////////
-bool Root::LightNameExists(const std::string &_name) const
+bool Root::LightNameExists(std::string_view _name) const
+{
+  if (this->dataPtr->lazy)
+    return this->dataPtr->lazyLights.NameExists(_name);
+
+  return this->dataPtr->lightIndex.Find(this->dataPtr->lights, _name) !=
+      nullptr;
+}
+
+/////////////////////////////////////////////////
+void Root::ResolveLightCulling(LightCulling &_culling,
+    const double _cellSize) const
 {
-  for (auto const &m : this->dataPtr->lights)
+  LightCullingBuilder builder;
+  const uint64_t count = this->LightCount();
+  for (uint64_t i = 0; i < count; ++i)
   {
-    if (m.Name() == _name)
-    {
-      return true;
-    }
+    const Light *light = this->LightByIndex(i);
+    builder.Add(-1, -1, i, *light, light->RawPose());
   }
-  return false;
+  builder.Finish(_cellSize, _culling);
 }
 
 /////////////////////////////////////////////////
 uint64_t Root::ActorCount() const
 {
+  if (this->dataPtr->lazy)
+    return this->dataPtr->lazyActors.Count();
   return this->dataPtr->actors.size();
 }
 
 /////////////////////////////////////////////////
 const Actor *Root::ActorByIndex(const uint64_t _index) const
 {
+  if (this->dataPtr->lazy)
+    return this->dataPtr->lazyActors.ByIndex(_index);
+
   if (_index < this->dataPtr->actors.size())
     return &this->dataPtr->actors[_index];
   return nullptr;
 }
 
 /////////////////////////////////////////////////
-bool Root::ActorNameExists(const std::string &_name) const
+bool Root::ActorNameExists(std::string_view _name) const
+{
+  if (this->dataPtr->lazy)
+    return this->dataPtr->lazyActors.NameExists(_name);
+
+  return this->dataPtr->actorIndex.Find(this->dataPtr->actors, _name) !=
+      nullptr;
+}
+
+/////////////////////////////////////////////////
+const Link *Root::LinkByScopedName(const std::string &_name) const
+{
+  std::string first, rest;
+  if (!splitScopedName(_name, first, rest))
+    return nullptr;
+
+  if (const World *world = this->dataPtr->WorldByName(first))
+    return world->LinkByScopedName(rest);
+
+  const Model *model = this->dataPtr->ModelByName(first);
+  return model ? model->LinkByName(rest) : nullptr;
+}
+
+/////////////////////////////////////////////////
+const Joint *Root::JointByScopedName(const std::string &_name) const
+{
+  std::string first, rest;
+  if (!splitScopedName(_name, first, rest))
+    return nullptr;
+
+  if (const World *world = this->dataPtr->WorldByName(first))
+    return world->JointByScopedName(rest);
+
+  const Model *model = this->dataPtr->ModelByName(first);
+  return model ? model->JointByName(rest) : nullptr;
+}
+
+/////////////////////////////////////////////////
+const Frame *Root::FrameByScopedName(const std::string &_name) const
+{
+  std::string first, rest;
+  if (!splitScopedName(_name, first, rest))
+    return nullptr;
+
+  if (const World *world = this->dataPtr->WorldByName(first))
+    return world->FrameByScopedName(rest);
+
+  const Model *model = this->dataPtr->ModelByName(first);
+  return model ? model->FrameByName(rest) : nullptr;
+}
+
+/////////////////////////////////////////////////
+sdf::ElementPtr Root::Element() const
+{
+  return this->dataPtr->sdf;
+}
+
+/////////////////////////////////////////////////
+TreeFootprint Root::MemoryFootprint() const
+{
+  if (!this->dataPtr->sdf)
+    return TreeFootprint();
+  return this->dataPtr->sdf->MemoryFootprint();
+}
+
+/////////////////////////////////////////////////
+std::size_t Root::Compact()
+{
+  std::size_t bytes = 0;
+  if (this->dataPtr->sdf)
+  {
+    const std::size_t before = this->MemoryFootprint().total.bytes;
+    this->dataPtr->sdf->Compact();
+    const std::size_t after = this->MemoryFootprint().total.bytes;
+    bytes += before > after ? before - after : 0;
+  }
+
+  bytes += shrinkToFit(this->dataPtr->worlds) +
+      shrinkToFit(this->dataPtr->models) +
+      shrinkToFit(this->dataPtr->lights) +
+      shrinkToFit(this->dataPtr->actors);
+  for (World &world : this->dataPtr->worlds)
+    bytes += world.Compact();
+  for (Model &model : this->dataPtr->models)
+    bytes += model.Compact();
+  return bytes;
+}
+
+/////////////////////////////////////////////////
+sdf::LoadStatistics Root::LoadStatistics() const
+{
+  return this->dataPtr->loadStatistics;
+}
+
+/// \brief A reference to an asset, before it is resolved.
+struct AssetUse
+{
+  /// \brief Kind of the asset.
+  AssetType type;
+
+  /// \brief URI of the asset.
+  std::string uri;
+
+  /// \brief Directory of the file that references the asset, or an empty
+  /// string if it is not known.
+  std::string directory;
+
+  /// \brief The object that references the asset.
+  AssetReference reference;
+};
+
+/////////////////////////////////////////////////
+/// \brief Add a reference to an asset, if it has a URI.
+/// \param[in,out] _uses The references.
+/// \param[in] _type Kind of the asset.
+/// \param[in] _uri URI of the asset.
+/// \param[in] _filePath Path of the file that references the asset.
+/// \param[in] _scopedName Scoped name of the object that references it.
+/// \param[in] _property Property of the object that references it.
+static void addAssetUse(std::vector<AssetUse> &_uses, const AssetType _type,
+    const std::string &_uri, const std::string &_filePath,
+    const std::string &_scopedName, const std::string &_property)
+{
+  if (_uri.empty())
+    return;
+
+  const std::size_t separator = _filePath.find_last_of("/\\");
+  _uses.push_back({_type, _uri,
+      separator == std::string::npos ? "" : _filePath.substr(0, separator),
+      {_scopedName, _property}});
+}
+
+/////////////////////////////////////////////////
+/// \brief Add the textures of a material.
+/// \param[in,out] _uses The references.
+/// \param[in] _material The material.
+/// \param[in] _scopedName Scoped name of the visual of the material.
+static void addMaterialUses(std::vector<AssetUse> &_uses,
+    const Material &_material, const std::string &_scopedName)
 {
-  for (auto const &m : this->dataPtr->actors)
+  const std::string filePath =
+      _material.Element() ? _material.Element()->FilePath() : "";
+  addAssetUse(_uses, AssetType::TEXTURE, _material.NormalMap(), filePath,
+      _scopedName, "normal_map");
+
+  const Pbr *pbr = _material.PbrMaterial();
+  if (!pbr)
+    return;
+
+  using MapGetter = std::string (PbrWorkflow::*)() const;
+  static const std::pair<const char *, MapGetter> kMaps[] = {
+    {"albedo_map", &PbrWorkflow::AlbedoMap},
+    {"normal_map", &PbrWorkflow::NormalMap},
+    {"environment_map", &PbrWorkflow::EnvironmentMap},
+    {"ambient_occlusion_map", &PbrWorkflow::AmbientOcclusionMap},
+    {"roughness_map", &PbrWorkflow::RoughnessMap},
+    {"metalness_map", &PbrWorkflow::MetalnessMap},
+    {"emissive_map", &PbrWorkflow::EmissiveMap},
+    {"glossiness_map", &PbrWorkflow::GlossinessMap},
+    {"specular_map", &PbrWorkflow::SpecularMap}};
+  for (PbrWorkflowType type :
+       {PbrWorkflowType::METAL, PbrWorkflowType::SPECULAR})
   {
-    if (m.Name() == _name)
+    const PbrWorkflow *workflow = pbr->Workflow(type);
+    if (!workflow)
+      continue;
+    for (const auto &map : kMaps)
     {
-      return true;
+      addAssetUse(_uses, AssetType::TEXTURE, (workflow->*map.second)(),
+          filePath, _scopedName, map.first);
     }
   }
-  return false;
 }
 
 /////////////////////////////////////////////////
-sdf::ElementPtr Root::Element() const
+/// \brief Add the meshes and textures of the links of a model.
+/// \param[in,out] _uses The references.
+/// \param[in] _model The model.
+/// \param[in] _prefix Scope of the model, such as "world::", or an empty
+/// string for a model of the root.
+static void addModelUses(std::vector<AssetUse> &_uses, const Model &_model,
+    const std::string &_prefix)
 {
-  return this->dataPtr->sdf;
+  const std::string modelName = _prefix + _model.Name() + "::";
+  for (uint64_t l = 0; l < _model.LinkCount(); ++l)
+  {
+    const Link *link = _model.LinkByIndex(l);
+    const std::string linkName = modelName + link->Name() + "::";
+    for (uint64_t v = 0; v < link->VisualCount(); ++v)
+    {
+      const Visual *visual = link->VisualByIndex(v);
+      const std::string name = linkName + visual->Name();
+      if (const Mesh *mesh = visual->Geom()->MeshShape())
+      {
+        addAssetUse(_uses, AssetType::MESH, mesh->Uri(), mesh->FilePath(),
+            name, "mesh");
+      }
+      if (const Material *material = visual->Material())
+        addMaterialUses(_uses, *material, name);
+    }
+    for (uint64_t c = 0; c < link->CollisionCount(); ++c)
+    {
+      const Collision *collision = link->CollisionByIndex(c);
+      if (const Mesh *mesh = collision->Geom()->MeshShape())
+      {
+        addAssetUse(_uses, AssetType::MESH, mesh->Uri(), mesh->FilePath(),
+            linkName + collision->Name(), "mesh");
+      }
+    }
+  }
+}
+
+/////////////////////////////////////////////////
+/// \brief Add the skin and animations of an actor.
+/// \param[in,out] _uses The references.
+/// \param[in] _actor The actor.
+/// \param[in] _prefix Scope of the actor, as in addModelUses.
+static void addActorUses(std::vector<AssetUse> &_uses, const Actor &_actor,
+    const std::string &_prefix)
+{
+  const std::string name = _prefix + _actor.Name();
+  addAssetUse(_uses, AssetType::MESH, _actor.SkinFilename(),
+      _actor.FilePath(), name, "skin");
+  for (uint64_t a = 0; a < _actor.AnimationCount(); ++a)
+  {
+    const Animation *animation = _actor.AnimationByIndex(a);
+    addAssetUse(_uses, AssetType::ANIMATION, animation->Filename(),
+        animation->FilePath(), name, animation->Name());
+  }
+}
+
+/////////////////////////////////////////////////
+AssetManifest Root::Assets(const unsigned int _threadCount) const
+{
+  std::vector<AssetUse> uses;
+  for (uint64_t w = 0; w < this->WorldCount(); ++w)
+  {
+    const World *world = this->WorldByIndex(w);
+    const std::string prefix = world->Name() + "::";
+    for (uint64_t m = 0; m < world->ModelCount(); ++m)
+      addModelUses(uses, *world->ModelByIndex(m), prefix);
+    for (uint64_t a = 0; a < world->ActorCount(); ++a)
+      addActorUses(uses, *world->ActorByIndex(a), prefix);
+  }
+  for (uint64_t m = 0; m < this->ModelCount(); ++m)
+    addModelUses(uses, *this->ModelByIndex(m), "");
+  for (uint64_t a = 0; a < this->ActorCount(); ++a)
+    addActorUses(uses, *this->ActorByIndex(a), "");
+
+  // Each URI is resolved once per directory it is referenced from, since
+  // relative URIs depend on it.
+  std::map<std::pair<std::string, std::string>, std::size_t> locationIndex;
+  std::vector<const AssetUse *> locations;
+  std::vector<std::size_t> useLocation(uses.size());
+  for (std::size_t i = 0; i < uses.size(); ++i)
+  {
+    auto inserted = locationIndex.emplace(
+        std::make_pair(uses[i].uri, uses[i].directory), locations.size());
+    if (inserted.second)
+      locations.push_back(&uses[i]);
+    useLocation[i] = inserted.first->second;
+  }
+
+  // Relative URIs are looked up next to the file that references them
+  // first, and the remaining URIs are requested at once before findFile
+  // waits for each of them.
+  std::vector<std::string> paths(locations.size());
+  parallelFor(locations.size(), _threadCount, [&](std::size_t _i)
+  {
+    const std::string &uri = locations[_i]->uri;
+    if (!locations[_i]->directory.empty() &&
+        uri.find("://") == std::string::npos && uri[0] != '/')
+    {
+      const std::string path =
+          sdf::filesystem::append(locations[_i]->directory, uri);
+      if (sdf::filesystem::exists(path))
+        paths[_i] = path;
+    }
+  });
+
+  std::vector<std::string> remaining;
+  for (std::size_t i = 0; i < locations.size(); ++i)
+  {
+    if (paths[i].empty())
+      remaining.push_back(locations[i]->uri);
+  }
+  requestFiles(remaining);
+
+  parallelFor(locations.size(), _threadCount, [&](std::size_t _i)
+  {
+    if (paths[_i].empty())
+      paths[_i] = findFile(locations[_i]->uri, true, true);
+  });
+
+  // Group the references by resolved path, or by location for the assets
+  // that were not found.
+  AssetManifest manifest;
+  std::map<std::pair<AssetType, std::string>, std::size_t> assetIndex;
+  for (std::size_t i = 0; i < uses.size(); ++i)
+  {
+    const std::size_t location = useLocation[i];
+    const std::string &path = paths[location];
+    const std::string key = path.empty() ?
+        '\n' + uses[i].uri + '\n' + uses[i].directory : path;
+    auto inserted = assetIndex.emplace(
+        std::make_pair(uses[i].type, key), manifest.assets.size());
+    if (inserted.second)
+    {
+      Asset asset;
+      asset.type = uses[i].type;
+      asset.uri = uses[i].uri;
+      asset.path = path;
+      manifest.assets.push_back(std::move(asset));
+    }
+    manifest.assets[inserted.first->second].references.push_back(
+        std::move(uses[i].reference));
+  }
+  return manifest;
+}
+
+/////////////////////////////////////////////////
+Errors Root::LoadDeferred() const
+{
+  Errors errors;
+  if (this->dataPtr->worldsOnDemand)
+    this->dataPtr->onDemandWorlds.LoadAll(errors);
+  if (!this->dataPtr->lazy)
+    return errors;
+
+  this->dataPtr->lazyWorlds.LoadAll(errors);
+  this->dataPtr->lazyModels.LoadAll(errors);
+  this->dataPtr->lazyLights.LoadAll(errors);
+  this->dataPtr->lazyActors.LoadAll(errors);
+
+  if (this->dataPtr->releaseElements)
+  {
+    std::lock_guard<std::mutex> lock(this->dataPtr->releaseMutex);
+    this->dataPtr->lazyWorlds.ReleaseElements();
+    this->dataPtr->lazyModels.ReleaseElements();
+    this->dataPtr->lazyLights.ReleaseElements();
+    this->dataPtr->lazyActors.ReleaseElements();
+    this->dataPtr->sdf.reset();
+  }
+  return errors;
 }
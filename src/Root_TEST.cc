@@ -15,6 +15,9 @@
  *
 */
 
+#include <memory>
+#include <sstream>
+#include <string>
 #include <gtest/gtest.h>
 #include "sdf/Actor.hh"
 #include "sdf/sdf_config.h"
@@ -23,7 +26,10 @@
 #include "sdf/Link.hh"
 #include "sdf/Light.hh"
 #include "sdf/Model.hh"
+#include "sdf/ParserConfig.hh"
 #include "sdf/Root.hh"
+#include "sdf/SDFImpl.hh"
+#include "sdf/World.hh"
 
 /////////////////////////////////////////////////
 TEST(DOMRoot, Construction)
@@ -132,6 +138,42 @@ TEST(DOMRoot, StringParse)
   EXPECT_NE(nullptr, actor->Element());
 }
 
+/////////////////////////////////////////////////
+TEST(DOMRoot, BufferParse)
+{
+  const std::string sdf =
+    "<?xml version=\"1.0\"?>"
+    "<sdf version=\"1.7\">"
+    "  <model name='box'>"
+    "    <link name='link'/>"
+    "  </model>"
+    "</sdf>";
+
+  // A buffer that is not null-terminated, followed by unrelated bytes.
+  const std::string buffer = sdf + "<model name='extra'/>";
+  sdf::Root root;
+  sdf::Errors errors = root.LoadSdfString(buffer.data(), sdf.size());
+  EXPECT_TRUE(errors.empty());
+  ASSERT_EQ(1u, root.ModelCount());
+  EXPECT_EQ("box", root.ModelByIndex(0)->Name());
+
+  // A buffer that includes its null terminator is parsed in place.
+  sdf::Root inPlace;
+  errors = inPlace.LoadSdfString(sdf.c_str(), sdf.size() + 1);
+  EXPECT_TRUE(errors.empty());
+  ASSERT_EQ(1u, inPlace.ModelCount());
+  EXPECT_EQ("box", inPlace.ModelByIndex(0)->Name());
+
+  sdf::SDF sdfObj;
+  sdfObj.SetFromString(sdf.c_str(), sdf.size() + 1);
+  ASSERT_NE(nullptr, sdfObj.Root());
+  EXPECT_TRUE(sdfObj.Root()->HasElement("model"));
+
+  sdf::Root invalid;
+  errors = invalid.LoadSdfString(sdf.data(), sdf.size() / 2);
+  EXPECT_FALSE(errors.empty());
+}
+
 /////////////////////////////////////////////////
 TEST(DOMRoot, Set)
 {
@@ -140,3 +182,304 @@ TEST(DOMRoot, Set)
   root.SetVersion(SDF_PROTOCOL_VERSION);
   EXPECT_STREQ(SDF_PROTOCOL_VERSION, root.Version().c_str());
 }
+
+/////////////////////////////////////////////////
+TEST(DOMRoot, LazyLoading)
+{
+  // The model without links fails to load, and the second model named m1 is
+  // a duplicate.
+  const std::string sdf = "<?xml version=\"1.0\"?>"
+    "<sdf version=\"" SDF_VERSION "\">"
+    "  <world name=\"w1\"/>"
+    "  <model name=\"m1\"><link name=\"link\"/></model>"
+    "  <model name=\"empty\"/>"
+    "  <model name=\"m1\"><link name=\"link\"/></model>"
+    "  <light type=\"point\" name=\"l1\"/>"
+    "</sdf>";
+
+  sdf::Root eager;
+  sdf::Errors eagerErrors = eager.LoadSdfString(sdf);
+  EXPECT_FALSE(eagerErrors.empty());
+  EXPECT_EQ(2u, eager.ModelCount());
+  EXPECT_TRUE(eager.LoadDeferred().empty());
+
+  sdf::ParserConfig config;
+  config.SetLazyDomLoading(true);
+
+  sdf::Root root;
+  sdf::Errors errors = root.LoadSdfString(sdf, config);
+
+  // Only the duplicate name is reported by Load.
+  ASSERT_EQ(1u, errors.size());
+  EXPECT_EQ(sdf::ErrorCode::DUPLICATE_NAME, errors[0].Code());
+
+  EXPECT_EQ(1u, root.WorldCount());
+  EXPECT_TRUE(root.WorldNameExists("w1"));
+  EXPECT_EQ(2u, root.ModelCount());
+  EXPECT_TRUE(root.ModelNameExists("m1"));
+  EXPECT_TRUE(root.ModelNameExists("empty"));
+  EXPECT_FALSE(root.ModelNameExists("m2"));
+  EXPECT_EQ(1u, root.LightCount());
+  EXPECT_TRUE(root.LightNameExists("l1"));
+  EXPECT_EQ(0u, root.ActorCount());
+
+  const sdf::Model *model = root.ModelByIndex(0);
+  ASSERT_NE(nullptr, model);
+  EXPECT_EQ("m1", model->Name());
+  EXPECT_EQ(1u, model->LinkCount());
+  EXPECT_EQ(model, root.ModelByIndex(0));
+  EXPECT_EQ(nullptr, root.ModelByIndex(2));
+
+  const sdf::World *world = root.WorldByIndex(0);
+  ASSERT_NE(nullptr, world);
+  EXPECT_EQ("w1", world->Name());
+
+  // The errors of generating the objects are reported on demand.
+  sdf::Errors deferredErrors = root.LoadDeferred();
+  EXPECT_FALSE(deferredErrors.empty());
+  EXPECT_EQ(eagerErrors.size(), errors.size() + deferredErrors.size());
+
+  ASSERT_NE(nullptr, root.ModelByIndex(1));
+  EXPECT_EQ("empty", root.ModelByIndex(1)->Name());
+  ASSERT_NE(nullptr, root.LightByIndex(0));
+  EXPECT_EQ("l1", root.LightByIndex(0)->Name());
+}
+
+/////////////////////////////////////////////////
+TEST(DOMRoot, ReleaseElements)
+{
+  const std::string sdf = "<?xml version=\"1.0\"?>"
+    "<sdf version=\"" SDF_VERSION "\">"
+    "  <world name=\"w1\">"
+    "    <model name=\"m1\"><link name=\"link\"/></model>"
+    "  </world>"
+    "  <model name=\"m2\"><link name=\"link\"/></model>"
+    "</sdf>";
+
+  sdf::ParserConfig config;
+  config.SetReleaseElements(true);
+
+  for (bool lazy : {false, true})
+  {
+    config.SetLazyDomLoading(lazy);
+
+    sdf::Root root;
+    EXPECT_TRUE(root.LoadSdfString(sdf, config).empty());
+    std::weak_ptr<sdf::Element> tree = root.Element();
+    EXPECT_EQ(lazy, !tree.expired());
+
+    EXPECT_TRUE(root.LoadDeferred().empty());
+    EXPECT_TRUE(tree.expired());
+    EXPECT_EQ(nullptr, root.Element());
+    EXPECT_EQ(0u, root.MemoryFootprint().total.elementCount);
+
+    // The objects keep their values, but not their elements.
+    const sdf::World *world = root.WorldByIndex(0);
+    ASSERT_NE(nullptr, world);
+    EXPECT_EQ("w1", world->Name());
+    EXPECT_EQ(nullptr, world->Element());
+    ASSERT_NE(nullptr, world->ModelByIndex(0));
+    EXPECT_EQ(nullptr, world->ModelByIndex(0)->Element());
+
+    const sdf::Model *model = root.ModelByIndex(0);
+    ASSERT_NE(nullptr, model);
+    EXPECT_EQ("m2", model->Name());
+    EXPECT_EQ(nullptr, model->Element());
+    ASSERT_NE(nullptr, model->LinkByIndex(0));
+    EXPECT_EQ(nullptr, model->LinkByIndex(0)->Element());
+    EXPECT_NE(nullptr, model->LinkByName("link"));
+  }
+}
+
+/////////////////////////////////////////////////
+TEST(DOMRoot, MemoryFootprint)
+{
+  sdf::Root empty;
+  EXPECT_TRUE(empty.MemoryFootprint().byName.empty());
+
+  const std::string sdf = "<?xml version=\"1.0\"?>"
+    "<sdf version=\"" SDF_VERSION "\">"
+    "  <model name=\"m1\">"
+    "    <link name=\"l1\"/>"
+    "    <link name=\"l2\"/>"
+    "  </model>"
+    "</sdf>";
+
+  sdf::Root root;
+  EXPECT_TRUE(root.LoadSdfString(sdf).empty());
+
+  sdf::TreeFootprint footprint = root.MemoryFootprint();
+  EXPECT_EQ(1u, footprint.byName["sdf"].elementCount);
+  EXPECT_EQ(1u, footprint.byName["model"].elementCount);
+  EXPECT_EQ(2u, footprint.byName["link"].elementCount);
+  EXPECT_LT(4u, footprint.total.elementCount);
+  EXPECT_LT(0u, footprint.total.paramCount);
+  EXPECT_LT(0u, footprint.total.bytes);
+  EXPECT_EQ(root.Element()->MemoryFootprint().total.bytes,
+            footprint.total.bytes);
+}
+
+/////////////////////////////////////////////////
+TEST(DOMRoot, Compact)
+{
+  sdf::Root empty;
+  EXPECT_EQ(0u, empty.Compact());
+
+  const std::string sdf = "<?xml version=\"1.0\"?>"
+    "<sdf version=\"" SDF_VERSION "\">"
+    "  <world name=\"w\">"
+    "    <model name=\"m1\">"
+    "      <link name=\"l1\"/><link name=\"l2\"/><link name=\"l3\"/>"
+    "    </model>"
+    "    <model name=\"m2\"><link name=\"l1\"/></model>"
+    "    <model name=\"m3\"><link name=\"l1\"/></model>"
+    "  </world>"
+    "</sdf>";
+
+  sdf::Root root;
+  EXPECT_TRUE(root.LoadSdfString(sdf).empty());
+  const std::size_t bytes = root.MemoryFootprint().total.bytes;
+  const std::size_t released = root.Compact();
+  EXPECT_LT(0u, released);
+  EXPECT_GE(bytes, root.MemoryFootprint().total.bytes);
+
+  const sdf::World *world = root.WorldByIndex(0);
+  ASSERT_NE(nullptr, world);
+  EXPECT_EQ(3u, world->ModelCount());
+  const sdf::Model *model = world->ModelByName("m1");
+  ASSERT_NE(nullptr, model);
+  EXPECT_EQ(3u, model->LinkCount());
+  EXPECT_NE(nullptr, model->LinkByName("l3"));
+
+  ignition::math::Pose3d pose;
+  EXPECT_TRUE(model->LinkByName("l3")->SemanticPose().Resolve(
+      pose, "world").empty());
+
+  // Nothing is left to release.
+  EXPECT_EQ(0u, root.Compact());
+}
+
+/////////////////////////////////////////////////
+TEST(DOMRoot, LoadStatistics)
+{
+  sdf::Root empty;
+  EXPECT_EQ(0u, empty.LoadStatistics().elementsCreated);
+
+  const std::string sdf = "<?xml version=\"1.0\"?>"
+    "<sdf version=\"1.6\">"
+    "  <model name=\"m1\">"
+    "    <link name=\"l1\"/>"
+    "    <link name=\"l2\"/>"
+    "  </model>"
+    "</sdf>";
+
+  sdf::Root root;
+  EXPECT_TRUE(root.LoadSdfString(sdf).empty());
+
+  const sdf::LoadStatistics statistics = root.LoadStatistics();
+  EXPECT_LT(4u, statistics.elementsCreated);
+  EXPECT_LT(0u, statistics.elementClones);
+  EXPECT_LT(0u, statistics.paramsSet);
+  EXPECT_EQ(0u, statistics.includesResolved);
+  EXPECT_EQ(1u, statistics.conversions);
+  EXPECT_EQ(sdf.size(), statistics.bytesRead);
+  EXPECT_LT(0, statistics.readTime.count());
+  EXPECT_LT(0, statistics.domLoadTime.count());
+  EXPECT_LE(statistics.parseXmlTime, statistics.readTime);
+
+  std::ostringstream stream;
+  stream << statistics;
+  EXPECT_NE(std::string::npos, stream.str().find("elements created:"));
+
+  // The statistics are those of the last load.
+  const std::string model = "<?xml version=\"1.0\"?>"
+    "<sdf version=\"" SDF_VERSION "\">"
+    "  <model name=\"m2\"><link name=\"l\"/></model>"
+    "</sdf>";
+  EXPECT_TRUE(root.LoadSdfString(model).empty());
+  EXPECT_EQ(0u, root.LoadStatistics().conversions);
+  EXPECT_EQ(model.size(), root.LoadStatistics().bytesRead);
+
+  // Loads outside of a root are not counted.
+  sdf::Root other;
+  EXPECT_TRUE(other.LoadSdfString(model).empty());
+  EXPECT_EQ(model.size(), root.LoadStatistics().bytesRead);
+}
+
+/////////////////////////////////////////////////
+TEST(DOMRoot, Assets)
+{
+  const std::string sdf = "<?xml version=\"1.0\"?>"
+    "<sdf version=\"" SDF_VERSION "\">"
+    "  <world name=\"w\">"
+    "    <model name=\"m\">"
+    "      <link name=\"l\">"
+    "        <visual name=\"v1\">"
+    "          <geometry><mesh>"
+    "            <uri>model://robot/meshes/arm.dae</uri>"
+    "          </mesh></geometry>"
+    "          <material><pbr><metal>"
+    "            <albedo_map>model://robot/textures/arm.png</albedo_map>"
+    "          </metal></pbr></material>"
+    "        </visual>"
+    "        <visual name=\"v2\">"
+    "          <geometry><mesh><uri>arm.dae</uri></mesh></geometry>"
+    "        </visual>"
+    "        <visual name=\"v3\">"
+    "          <geometry><mesh><uri>model://missing/x.dae</uri></mesh>"
+    "          </geometry>"
+    "        </visual>"
+    "        <collision name=\"c\">"
+    "          <geometry><mesh>"
+    "            <uri>model://robot/meshes/arm.dae</uri>"
+    "          </mesh></geometry>"
+    "        </collision>"
+    "      </link>"
+    "    </model>"
+    "  </world>"
+    "</sdf>";
+
+  sdf::Root root;
+  EXPECT_TRUE(root.LoadSdfString(sdf).empty());
+
+  // Both mesh URIs resolve to the same file.
+  sdf::setFindCallback([](const std::string &_uri) -> std::string
+  {
+    if (_uri == "model://robot/meshes/arm.dae" || _uri == "arm.dae")
+      return "/models/robot/meshes/arm.dae";
+    if (_uri == "model://robot/textures/arm.png")
+      return "/models/robot/textures/arm.png";
+    return "";
+  });
+
+  for (unsigned int threadCount : {1u, 4u})
+  {
+    const sdf::AssetManifest manifest = root.Assets(threadCount);
+    ASSERT_EQ(3u, manifest.assets.size());
+
+    const sdf::Asset &mesh = manifest.assets[0];
+    EXPECT_EQ(sdf::AssetType::MESH, mesh.type);
+    EXPECT_EQ("model://robot/meshes/arm.dae", mesh.uri);
+    EXPECT_EQ("/models/robot/meshes/arm.dae", mesh.path);
+    ASSERT_EQ(3u, mesh.references.size());
+    EXPECT_EQ("w::m::l::v1", mesh.references[0].scopedName);
+    EXPECT_EQ("mesh", mesh.references[0].property);
+    EXPECT_EQ("w::m::l::v2", mesh.references[1].scopedName);
+    EXPECT_EQ("w::m::l::c", mesh.references[2].scopedName);
+
+    const sdf::Asset &texture = manifest.assets[1];
+    EXPECT_EQ(sdf::AssetType::TEXTURE, texture.type);
+    EXPECT_EQ("/models/robot/textures/arm.png", texture.path);
+    ASSERT_EQ(1u, texture.references.size());
+    EXPECT_EQ("w::m::l::v1", texture.references[0].scopedName);
+    EXPECT_EQ("albedo_map", texture.references[0].property);
+
+    const sdf::Asset &missing = manifest.assets[2];
+    EXPECT_EQ("model://missing/x.dae", missing.uri);
+    EXPECT_EQ("", missing.path);
+    ASSERT_EQ(1u, missing.references.size());
+    EXPECT_EQ("w::m::l::v3", missing.references[0].scopedName);
+  }
+
+  sdf::setFindCallback(nullptr);
+}
@@ -15,23 +15,36 @@
  *
  */
 
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
 #include <cstdlib>
+#include <exception>
 #include <fstream>
 #include <sstream>
 #include <functional>
+#include <future>
 #include <list>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "sdf/parser.hh"
 #include "sdf/Assert.hh"
 #include "sdf/Console.hh"
 #include "sdf/Filesystem.hh"
+#include "sdf/ModelIndex.hh"
 #include "sdf/SDFImpl.hh"
 #include "SDFImplPrivate.hh"
 #include "sdf/sdf_config.h"
+#include "Archive.hh"
 #include "EmbeddedSdf.hh"
+#include "SpecVersion.hh"
+#include "Utils.hh"
 
 namespace sdf
 {
@@ -40,66 +53,391 @@ inline namespace SDF_VERSION_NAMESPACE
 typedef std::list<std::string> PathList;
 typedef std::map<std::string, PathList> URIPathMap;
 
-static URIPathMap g_uriPathMap;
+/// \brief A result of sdf::findFile before the callback is used.
+struct FindFileCacheEntry
+{
+  /// \brief Path of the file, or an empty string if it was not found.
+  std::string path;
+
+  /// \brief Time at which the file was searched.
+  std::chrono::steady_clock::time_point time;
+};
+
+/// \brief Results of sdf::findFile, by file name and search context.
+static std::unordered_map<std::string, FindFileCacheEntry> g_findFileCache;
+
+/// \brief Time after which a cached result is searched again, or zero to
+/// keep results until the cache is cleared.
+static std::chrono::steady_clock::duration g_findFileCacheTimeout =
+    std::chrono::steady_clock::duration::zero();
+
+/// \brief Incremented whenever the cache is cleared, so that searches
+/// that started before do not store their result.
+static uint64_t g_findFileCacheGeneration = 0;
+
+/// \brief A file requested from the batch callback.
+struct FindBatchEntry
+{
+  /// \brief Path of the file once it is resolved, or an empty string if
+  /// it was not found.
+  std::shared_future<std::string> path;
+
+  /// \brief Time at which the file was requested.
+  std::chrono::steady_clock::time_point time;
+};
+
+/// \brief Files requested from the batch callback, by file name. They are
+/// kept and cleared with the find file cache.
+static std::unordered_map<std::string, FindBatchEntry> g_findBatchResults;
+
+/// \brief The URI prefixes of addURIPath, as a trie of their characters,
+/// so that the prefixes of a file name are found in one walk of the name.
+class URIPathTrie
+{
+  /// \brief Add a URI prefix.
+  /// \param[in] _uri The URI prefix.
+  /// \param[in] _paths Paths associated to the URI.
+  public: void Insert(const std::string &_uri, const PathList &_paths)
+  {
+    std::size_t node = 0;
+    for (const char c : _uri)
+    {
+      auto child = this->nodes[node].children.find(c);
+      if (child != this->nodes[node].children.end())
+      {
+        node = child->second;
+        continue;
+      }
+
+      const std::size_t next = this->nodes.size();
+      this->nodes[node].children.emplace(c, next);
+      this->nodes.emplace_back();
+      node = next;
+    }
+    this->nodes[node].paths.assign(_paths.begin(), _paths.end());
+  }
+
+  /// \brief Find a file whose name starts with a URI prefix in the paths
+  /// associated to the prefix. Shorter prefixes are tried first.
+  /// \param[in] _filename Name of the file.
+  /// \return The path of the file, or an empty string.
+  public: std::string Find(const std::string &_filename) const
+  {
+    std::size_t node = 0;
+    for (std::size_t i = 0; i <= _filename.size(); ++i)
+    {
+      for (const std::string &uriPath : this->nodes[node].paths)
+      {
+        std::string path =
+            sdf::filesystem::append(uriPath, _filename.substr(i));
+        if (sdf::filesystem::exists(path))
+          return path;
+      }
+
+      if (i == _filename.size())
+        break;
+      auto child = this->nodes[node].children.find(_filename[i]);
+      if (child == this->nodes[node].children.end())
+        break;
+      node = child->second;
+    }
+    return std::string();
+  }
+
+  /// \brief A node of the trie.
+  private: struct Node
+  {
+    /// \brief Children of the node, by character.
+    std::map<char, std::size_t> children;
+
+    /// \brief Paths of the URI that ends at this node, if any.
+    std::vector<std::string> paths;
+  };
+
+  /// \brief The nodes, starting with the root.
+  private: std::vector<Node> nodes = std::vector<Node>(1);
+};
+
+/// \brief What addURIPath, setFindCallback, setFindBatchCallback and
+/// setModelIndex registered, with the search configuration of findFile
+/// parsed from it. A version is never modified once published: an update
+/// publishes a new version, so that findFile reads a consistent version
+/// without locking while paths are being registered from other threads.
+struct FindFileSearch
+{
+  /// \brief The URI paths of addURIPath.
+  URIPathMap uriPathMap;
+
+  /// \brief Callback set by setFindCallback.
+  std::function<std::string(const std::string &)> findFileCB;
+
+  /// \brief Callback set by setFindBatchCallback.
+  FindBatchCallback findBatchCB;
 
-static std::function<std::string(const std::string &)> g_findFileCB;
+  /// \brief The index of setModelIndex, or nullptr.
+  std::shared_ptr<ModelIndex> modelIndex;
 
-std::string SDF::version = SDF_VERSION;
+  /// \brief The URI paths of uriPathMap, as a trie.
+  URIPathTrie uriPaths;
+
+  /// \brief The paths of the SDF_PATH environment variable.
+  std::vector<std::string> sdfPaths;
+};
+
+/// \brief Current version of the search configuration of findFile, or
+/// nullptr until it is first used. Only accessed with std::atomic_load
+/// and std::atomic_store, and only stored with g_findFileMutex locked, so
+/// that it changes together with g_findFileCacheGeneration.
+static std::shared_ptr<const FindFileSearch> g_findFileSearch;
+
+/// \brief Serializes the updates of g_findFileSearch, so that concurrent
+/// updates are not lost. Readers do not lock it.
+static std::mutex g_findFileUpdateMutex;
+
+/// \brief Guards the find file caches.
+static std::mutex g_findFileMutex;
+
+/// \brief Directory of the conversion cache, empty if disabled.
+static std::string g_conversionCacheDirectory;
+
+/// \brief Guards g_conversionCacheDirectory.
+static std::mutex g_conversionCacheMutex;
+
+/////////////////////////////////////////////////
+/// \brief Clear the find file caches. g_findFileMutex must be locked.
+static void clearFindFileCacheLocked()
+{
+  g_findFileCache.clear();
+  g_findBatchResults.clear();
+  ++g_findFileCacheGeneration;
+}
+
+/////////////////////////////////////////////////
+/// \brief Publish a new version of the search configuration of findFile,
+/// and clear the find file caches.
+/// \param[in] _update Function that modifies the registered values of a
+/// copy of the current version. The search configuration is then parsed
+/// from them again, including the SDF_PATH environment variable.
+/// \return The new version.
+static std::shared_ptr<const FindFileSearch> updateFindFileSearch(
+    const std::function<void(FindFileSearch &)> &_update)
+{
+  std::lock_guard<std::mutex> updateLock(g_findFileUpdateMutex);
+  auto search = std::make_shared<FindFileSearch>();
+  if (const auto current = std::atomic_load(&g_findFileSearch))
+  {
+    search->uriPathMap = current->uriPathMap;
+    search->findFileCB = current->findFileCB;
+    search->findBatchCB = current->findBatchCB;
+    search->modelIndex = current->modelIndex;
+  }
+  _update(*search);
+
+  for (const auto &uriPaths : search->uriPathMap)
+    search->uriPaths.Insert(uriPaths.first, uriPaths.second);
+
+#ifndef _WIN32
+  const char *pathCStr = std::getenv("SDF_PATH");
+  const std::string sdfPath = pathCStr ? pathCStr : "";
+#else
+  char *pathCStr = nullptr;
+  size_t sz = 0;
+  _dupenv_s(&pathCStr, &sz, "SDF_PATH");
+  const std::string sdfPath = pathCStr ? pathCStr : "";
+  free(pathCStr);
+#endif
+  if (!sdfPath.empty())
+    search->sdfPaths = sdf::split(sdfPath, ":");
+
+  // The cached results were found with the previous version, so they are
+  // cleared as the new version is published.
+  std::shared_ptr<const FindFileSearch> published = std::move(search);
+  std::lock_guard<std::mutex> lock(g_findFileMutex);
+  std::atomic_store(&g_findFileSearch, published);
+  clearFindFileCacheLocked();
+  return published;
+}
+
+/////////////////////////////////////////////////
+/// \brief Get the current version of the search configuration of
+/// findFile, parsing it on first use.
+/// \return The search configuration.
+static std::shared_ptr<const FindFileSearch> findFileSearch()
+{
+  if (auto search = std::atomic_load(&g_findFileSearch))
+    return search;
+  return updateFindFileSearch([](FindFileSearch &) {});
+}
+
+/////////////////////////////////////////////////
+/// \brief Lock the find file caches and get the version of the search
+/// configuration of findFile that g_findFileCacheGeneration belongs to,
+/// so that results found with it are only cached if it is still current.
+/// \param[out] _lock Lock of g_findFileMutex, which is locked.
+/// \return The search configuration.
+static std::shared_ptr<const FindFileSearch> lockFindFileSearch(
+    std::unique_lock<std::mutex> &_lock)
+{
+  // Parsing the configuration on first use locks g_findFileMutex.
+  findFileSearch();
+  _lock = std::unique_lock<std::mutex>(g_findFileMutex);
+  return std::atomic_load(&g_findFileSearch);
+}
+
+/////////////////////////////////////////////////
+/// \brief Get whether a cached result is recent enough to be used.
+/// g_findFileMutex must be locked.
+/// \param[in] _time Time at which the result was stored.
+/// \param[in] _now The current time.
+/// \return True if the result can be used.
+static bool findFileCacheFresh(
+    const std::chrono::steady_clock::time_point _time,
+    const std::chrono::steady_clock::time_point _now)
+{
+  return g_findFileCacheTimeout == std::chrono::steady_clock::duration::zero()
+      || _now - _time < g_findFileCacheTimeout;
+}
 
 /////////////////////////////////////////////////
 // cppcheck-suppress passedByValue
 void setFindCallback(std::function<std::string(const std::string &)> _cb)
 {
-  g_findFileCB = _cb;
+  updateFindFileSearch([&](FindFileSearch &_search)
+  {
+    _search.findFileCB = _cb;
+  });
 }
 
 /////////////////////////////////////////////////
-std::string findFile(const std::string &_filename, bool _searchLocalPath,
-                          bool _useCallback)
+void setFindBatchCallback(FindBatchCallback _cb)
 {
-  std::string path = _filename;
+  updateFindFileSearch([&](FindFileSearch &_search)
+  {
+    _search.findBatchCB = std::move(_cb);
+  });
+}
 
-  // Check to see if _filename is URI. If so, resolve the URI path.
-  for (URIPathMap::iterator iter = g_uriPathMap.begin();
-       iter != g_uriPathMap.end(); ++iter)
+/////////////////////////////////////////////////
+void requestFiles(const std::vector<std::string> &_filenames)
+{
+  std::unique_lock<std::mutex> lock;
+  const auto findBatchCB = lockFindFileSearch(lock)->findBatchCB;
+  const uint64_t generation = g_findFileCacheGeneration;
+  lock.unlock();
+  if (!findBatchCB)
   {
-    // Check to see if the URI in the global map is the first part of the
-    // given filename
-    // cppcheck-suppress stlIfStrFind
-    if (_filename.find(iter->first) == 0)
+    return;
+  }
+
+  // The files that can be found without a callback are only searched, and
+  // the search results are cached for the reads that follow.
+  std::vector<std::string> unresolved;
+  for (const std::string &filename : _filenames)
+  {
+    if (std::find(unresolved.begin(), unresolved.end(), filename) ==
+        unresolved.end() && findFile(filename, true, false).empty())
     {
-      std::string suffix = _filename;
-      size_t index = suffix.find(iter->first);
-      if (index != std::string::npos)
-      {
-        suffix.replace(index, iter->first.length(), "");
-      }
+      unresolved.push_back(filename);
+    }
+  }
 
-      // Check each path in the list.
-      for (PathList::iterator pathIter = iter->second.begin();
-           pathIter != iter->second.end(); ++pathIter)
+  const auto now = std::chrono::steady_clock::now();
+  lock.lock();
+  unresolved.erase(std::remove_if(unresolved.begin(), unresolved.end(),
+      [&](const std::string &_filename)
       {
-        // Return the path string if the path + suffix exists.
-        std::string pathSuffix = sdf::filesystem::append(*pathIter, suffix);
-        if (sdf::filesystem::exists(pathSuffix))
-        {
-          return pathSuffix;
-        }
-      }
+        auto requested = g_findBatchResults.find(_filename);
+        return requested != g_findBatchResults.end() &&
+            findFileCacheFresh(requested->second.time, now);
+      }), unresolved.end());
+  lock.unlock();
+
+  if (unresolved.empty())
+  {
+    return;
+  }
+
+  const std::vector<std::shared_future<std::string>> paths =
+      findBatchCB(unresolved);
+
+  lock.lock();
+  if (generation == g_findFileCacheGeneration)
+  {
+    for (std::size_t i = 0; i < unresolved.size() && i < paths.size(); ++i)
+    {
+      if (paths[i].valid())
+        g_findBatchResults[unresolved[i]] = {paths[i], now};
     }
   }
+}
+
+/////////////////////////////////////////////////
+/// \brief Get the path of a file from the batch callback, requesting it
+/// first if needed, and wait for it.
+/// \param[in] _filename Name of the file.
+/// \param[out] _used True if there is a batch callback.
+/// \return Path of the file, or an empty string if it was not found.
+static std::string findBatchFile(const std::string &_filename, bool &_used)
+{
+  _used = static_cast<bool>(findFileSearch()->findBatchCB);
+  if (!_used)
+  {
+    return std::string();
+  }
+
+  std::unique_lock<std::mutex> lock(g_findFileMutex);
+
+  std::shared_future<std::string> path;
+  auto requested = g_findBatchResults.find(_filename);
+  if (requested != g_findBatchResults.end() &&
+      findFileCacheFresh(requested->second.time,
+                         std::chrono::steady_clock::now()))
+  {
+    path = requested->second.path;
+    lock.unlock();
+  }
+  else
+  {
+    lock.unlock();
+    requestFiles({_filename});
+
+    lock.lock();
+    requested = g_findBatchResults.find(_filename);
+    if (requested != g_findBatchResults.end())
+      path = requested->second.path;
+    lock.unlock();
+  }
 
-  // Strip scheme, if any
-  std::string filename = _filename;
-  std::string sep("://");
-  size_t idx = _filename.find(sep);
-  if (idx != std::string::npos)
+  if (!path.valid())
   {
-    filename = filename.substr(idx + sep.length());
+    return std::string();
   }
 
+  try
+  {
+    return path.get();
+  }
+  catch(const std::exception &_e)
+  {
+    sdferr << "The batch find callback failed to resolve [" << _filename
+           << "]: " << _e.what() << "\n";
+  }
+  return std::string();
+}
+
+/////////////////////////////////////////////////
+/// \brief Search for a file in the install paths, the current working
+/// directory and the SDF_PATH environment variable.
+/// \param[in] _filename Name of the file, with any URI scheme stripped.
+/// \param[in] _searchLocalPath True to search the current working
+/// directory.
+/// \param[in] _sdfPaths Paths of the SDF_PATH environment variable.
+/// \return Path of the file, or an empty string if it was not found.
+static std::string searchFile(const std::string &_filename,
+    bool _searchLocalPath, const std::vector<std::string> &_sdfPaths)
+{
   // Next check the install path.
-  path = sdf::filesystem::append(SDF_SHARE_PATH, filename);
+  std::string path = sdf::filesystem::append(SDF_SHARE_PATH, _filename);
   if (sdf::filesystem::exists(path))
   {
     return path;
@@ -108,87 +446,298 @@ std::string findFile(const std::string &_filename, bool _searchLocalPath,
   // Next check the versioned install path.
   path = sdf::filesystem::append(SDF_SHARE_PATH,
                                  "sdformat" SDF_MAJOR_VERSION_STR,
-                                 sdf::SDF::Version(), filename);
+                                 currentSpecVersion().version, _filename);
   if (sdf::filesystem::exists(path))
   {
     return path;
   }
 
   // Next check to see if the given file exists.
-  path = filename;
+  path = _filename;
   if (sdf::filesystem::exists(path))
   {
     return path;
   }
 
   // Next check SDF_PATH environment variable
-#ifndef _WIN32
-  const char *pathCStr = std::getenv("SDF_PATH");
-#else
-  char *pathCStr;
-  size_t sz = 0;
-  _dupenv_s(&pathCStr, &sz, "SDF_PATH");
-#endif
-
-  if (pathCStr)
+  for (const std::string &sdfPath : _sdfPaths)
   {
-    std::vector<std::string> paths = sdf::split(pathCStr, ":");
-    for (std::vector<std::string>::iterator iter = paths.begin();
-         iter != paths.end(); ++iter)
+    path = sdf::filesystem::append(sdfPath, _filename);
+    if (sdf::filesystem::exists(path))
     {
-      path = sdf::filesystem::append(*iter, filename);
-      if (sdf::filesystem::exists(path))
-      {
-        return path;
-      }
+      return path;
     }
   }
 
   // Finally check the local path, if the flag is set.
   if (_searchLocalPath)
   {
-    path = sdf::filesystem::append(sdf::filesystem::current_path(), filename);
+    path = sdf::filesystem::append(sdf::filesystem::current_path(),
+                                   _filename);
     if (sdf::filesystem::exists(path))
     {
       return path;
     }
   }
 
+  return std::string();
+}
+
+/////////////////////////////////////////////////
+/// \brief Find a file whose name starts with a URI in the paths associated
+/// to the URI.
+/// \param[in] _uriPaths Paths of each URI.
+/// \param[in] _filename Name of the file.
+/// \return The path of the file, or an empty string.
+template <typename PathMap>
+static std::string findURIFile(const PathMap &_uriPaths,
+                               const std::string &_filename)
+{
+  for (const auto &uriPaths : _uriPaths)
+  {
+    // Check to see if the URI in the map is the first part of the given
+    // filename
+    // cppcheck-suppress stlIfStrFind
+    if (_filename.find(uriPaths.first) != 0)
+      continue;
+
+    const std::string suffix = _filename.substr(uriPaths.first.length());
+
+    // Check each path in the list.
+    for (const std::string &uriPath : uriPaths.second)
+    {
+      // Use the path string if the path + suffix exists.
+      std::string pathSuffix = sdf::filesystem::append(uriPath, suffix);
+      if (sdf::filesystem::exists(pathSuffix))
+        return pathSuffix;
+    }
+  }
+  return std::string();
+}
+
+/////////////////////////////////////////////////
+/// \brief Find a file whose name is a model:// URI in a model index.
+/// \param[in] _index The index.
+/// \param[in] _filename Name of the file.
+/// \return The path of the file, or an empty string if the file name is
+/// not a URI of an indexed model or the file does not exist.
+static std::string findModelIndexFile(const ModelIndex &_index,
+                                      const std::string &_filename)
+{
+  const std::string scheme = "model://";
+  if (_filename.compare(0, scheme.size(), scheme) != 0)
+    return std::string();
+
+  const std::size_t nameEnd = _filename.find('/', scheme.size());
+  const std::string directory = _index.FindModelDirectory(
+      _filename.substr(scheme.size(), nameEnd - scheme.size()));
+  if (directory.empty())
+    return std::string();
+
+  // The directory of a model is known to exist, and the files in it are
+  // checked.
+  const std::size_t suffixStart =
+      _filename.find_first_not_of('/', std::min(nameEnd, _filename.size()));
+  if (suffixStart == std::string::npos)
+    return directory;
+  std::string path =
+      sdf::filesystem::append(directory, _filename.substr(suffixStart));
+  return sdf::filesystem::exists(path) ? path : std::string();
+}
+
+/////////////////////////////////////////////////
+std::string findFile(const std::string &_filename, bool _searchLocalPath,
+                          bool _useCallback)
+{
+  LoadCounters::Add(&LoadCounters::findFileCalls);
+  std::string path;
+
+  // The URI paths of the configuration of the load in progress come first.
+  // They differ between loads, so their results are not cached.
+  const ParserConfig *config = currentParserConfig();
+  if (config)
+  {
+    path = findURIFile(config->URIPathMap(), _filename);
+    if (!path.empty())
+      return path;
+  }
+
+  // Relative file names and the local path depend on the working
+  // directory, so it is part of the key of the cached result. The cache is
+  // cleared whenever the search configuration is parsed again.
+  const std::string cacheKey = _filename + '\n' +
+      (_searchLocalPath ? "1" : "0") + '\n' +
+      sdf::filesystem::current_path();
+
+  // The callback and the search come from the same version, and the
+  // callback may itself call findFile or addURIPath.
+  std::unique_lock<std::mutex> lock;
+  const std::shared_ptr<const FindFileSearch> search =
+      lockFindFileSearch(lock);
+  const auto &findFileCB = search->findFileCB;
+
+  const auto now = std::chrono::steady_clock::now();
+  auto cached = g_findFileCache.find(cacheKey);
+  if (cached != g_findFileCache.end() &&
+      findFileCacheFresh(cached->second.time, now))
+  {
+    path = cached->second.path;
+    lock.unlock();
+  }
+  else
+  {
+    const uint64_t generation = g_findFileCacheGeneration;
+    lock.unlock();
+
+    // Check to see if _filename is URI. If so, resolve the URI path.
+    if (search->modelIndex)
+      path = findModelIndexFile(*search->modelIndex, _filename);
+    if (path.empty())
+      path = search->uriPaths.Find(_filename);
+
+    if (path.empty())
+    {
+      // Strip scheme, if any
+      std::string filename = _filename;
+      std::string sep("://");
+      size_t idx = _filename.find(sep);
+      if (idx != std::string::npos)
+      {
+        filename = filename.substr(idx + sep.length());
+      }
+
+      path = searchFile(filename, _searchLocalPath, search->sdfPaths);
+    }
+
+    // Misses are cached too, since they are the most expensive lookups.
+    // A result is dropped if the cache was cleared during the search.
+    lock.lock();
+    if (generation == g_findFileCacheGeneration)
+    {
+      g_findFileCache[cacheKey] = {path, now};
+    }
+    lock.unlock();
+  }
+
+  if (!path.empty())
+  {
+    return path;
+  }
+
   // If we still haven't found the file, use the registered callback if the
   // flag has been set
   if (_useCallback)
   {
-    if (!g_findFileCB)
+    bool batched = false;
+    path = findBatchFile(_filename, batched);
+    if (!path.empty())
     {
-      sdferr << "Tried to use callback in sdf::findFile(), but the callback "
-        "is empty.  Did you call sdf::setFindCallback()?";
+      return path;
+    }
+
+    if (config && config->FindFileCallback())
+    {
+      path = config->FindFileCallback()(_filename);
+      if (!path.empty() || !findFileCB)
+        return path;
+    }
+
+    if (!findFileCB)
+    {
+      if (!batched)
+      {
+        sdferr << "Tried to use callback in sdf::findFile(), but the callback "
+          "is empty.  Did you call sdf::setFindCallback()?";
+      }
       return std::string();
     }
     else
     {
-      return g_findFileCB(_filename);
+      return findFileCB(_filename);
     }
   }
 
   return std::string();
 }
 
+/////////////////////////////////////////////////
+void clearFindFileCache()
+{
+  updateFindFileSearch([](FindFileSearch &) {});
+}
+
+/////////////////////////////////////////////////
+void setFindFileCacheTimeout(std::chrono::steady_clock::duration _timeout)
+{
+  std::lock_guard<std::mutex> lock(g_findFileMutex);
+  g_findFileCacheTimeout = _timeout;
+}
+
 /////////////////////////////////////////////////
 void addURIPath(const std::string &_uri, const std::string &_path)
 {
   // Split _path on colons.
   std::vector<std::string> parts = sdf::split(_path, ":");
 
-  // Add each part of the colon separated path to the global URI map.
-  for (std::vector<std::string>::iterator iter = parts.begin();
-       iter != parts.end(); ++iter)
+  // Only add valid paths. Archives are mounted, and searched like
+  // directories.
+  PathList paths;
+  for (const std::string &part : parts)
   {
-    // Only add valid paths
-    if (!(*iter).empty() && sdf::filesystem::is_directory(*iter))
+    if (!part.empty() &&
+        (sdf::filesystem::is_directory(part) || mountArchive(part)))
     {
-      g_uriPathMap[_uri].push_back(*iter);
+      paths.push_back(part);
     }
   }
+
+  // Add each part of the colon separated path to the global URI map.
+  updateFindFileSearch([&](FindFileSearch &_search)
+  {
+    if (paths.empty())
+      return;
+    PathList &uriPaths = _search.uriPathMap[_uri];
+    uriPaths.insert(uriPaths.end(), paths.begin(), paths.end());
+  });
+}
+
+/////////////////////////////////////////////////
+void setModelIndex(std::shared_ptr<ModelIndex> _index)
+{
+  updateFindFileSearch([&](FindFileSearch &_search)
+  {
+    _search.modelIndex = std::move(_index);
+  });
+}
+
+/////////////////////////////////////////////////
+std::shared_ptr<ModelIndex> modelIndex()
+{
+  return findFileSearch()->modelIndex;
+}
+
+/////////////////////////////////////////////////
+void setConversionCacheDirectory(const std::string &_path)
+{
+  if (!_path.empty() && !sdf::filesystem::is_directory(_path) &&
+      !sdf::filesystem::create_directory(_path))
+  {
+    sdferr << "Unable to create conversion cache directory[" << _path
+           << "], the cache is disabled.\n";
+    std::lock_guard<std::mutex> lock(g_conversionCacheMutex);
+    g_conversionCacheDirectory.clear();
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(g_conversionCacheMutex);
+  g_conversionCacheDirectory = _path;
+}
+
+/////////////////////////////////////////////////
+std::string conversionCacheDirectory()
+{
+  std::lock_guard<std::mutex> lock(g_conversionCacheMutex);
+  return g_conversionCacheDirectory;
 }
 
 /////////////////////////////////////////////////
@@ -205,7 +754,13 @@ SDF::~SDF()
 /////////////////////////////////////////////////
 void SDF::PrintDescription()
 {
-  this->Root()->PrintDescription("");
+  this->PrintDescription(std::cout);
+}
+
+/////////////////////////////////////////////////
+void SDF::PrintDescription(std::ostream &_out)
+{
+  this->Root()->PrintDescription(_out, "");
 }
 
 /////////////////////////////////////////////////
@@ -217,14 +772,13 @@ void SDF::PrintValues()
 /////////////////////////////////////////////////
 void SDF::PrintDoc()
 {
-  std::string html, html2;
-  int index = 0;
-  this->Root()->PrintDocLeftPane(html, 10, index);
-
-  index = 0;
-  this->Root()->PrintDocRightPane(html2, 10, index);
+  this->PrintDoc(std::cout);
+}
 
-  std::cout << "<!DOCTYPE HTML>\n"
+/////////////////////////////////////////////////
+void SDF::PrintDoc(std::ostream &_out)
+{
+  _out << "<!DOCTYPE HTML>\n"
   << "<html>\n"
   << "<head>\n"
   << "  <link href='style.css' rel='stylesheet' type='text/css'>\n"
@@ -266,64 +820,66 @@ void SDF::PrintDoc()
   << "  </style>\n"
   << "</head>\n<body>\n";
 
-  std::cout << "<div style='padding:4px'>\n"
-            << "<h1>SDF " << SDF::Version() << "</h1>\n";
-
-  std::cout << "<p>The Robot Modeling Language (SDF) is an XML file "
-            << "format used to describe all the elements in a simulation "
-            << "environment.\n</p>";
-  std::cout << "<h3>Usage</h3>\n";
-  std::cout << "<blockquote>";
-  std::cout << "<ul><li><b>Left Panel:</b> List of all the SDF elements.</li>";
-  std::cout << "<li><b>Right Panel:</b> Descriptions of all the SDF "
-            << "elements.</li>";
-  std::cout << "<li><b>Selection:</b> Clicking an element in the Left Panel "
-            << "moves the corresponding description to the top of the Right "
-            << "Panel.</li>";
-  std::cout << "<li><b>Search:</b> Use your web-browser's built in 'Find' "
-            << "function to locate a specific element."
-            << "</li></ul>";
-  std::cout << "</blockquote>";
-
-  std::cout << "</br>\n";
-
-  std::cout << "<h3>Meta-Tags</h3>\n";
-  std::cout << "<blockquote>";
-  std::cout << "Meta-tags are processed by the parser before the final "
-            << "SDF file is generated.";
-  std::cout << "<ul>";
-
-  std::cout << "<li><b>&ltinclude&gt</b>: Include an SDF model file "
-            << "within the current SDF file."
-            << "<ul style='margin-left:12px'>"
-            << "<li><b>&lt;uri&gt;</b>: URI of SDF model file to include.</li>"
-            << "<li><b>&lt;name&gt;</b>: Name of the included SDF model.</li>"
-            << "<li><b>&lt;pose&gt;</b>: Pose of the included SDF model, "
-            << "specified as &lt;pose&gt;x y z roll pitch yaw&lt;/pose&gt;, "
-            << "with x, y, and z representing a position in meters, and roll, "
-            << "pitch, and yaw representing Euler angles in radians.</li>"
-            << "</ul>"
-            << "</li>";
-
-  std::cout << "</ul>";
-  std::cout << "</blockquote>";
-
-
-  std::cout << "</div>\n";
-
-  std::cout << "<div id='my_splitter'>\n";
-
-  std::cout << "<div id='left_pane'>\n";
-  std::cout << html;
-  std::cout << "</div>\n";
-
-  std::cout << "<div id='right_pane'>\n";
-  std::cout << html2;
-  std::cout << "</div>\n";
-
-  std::cout << "</div>\n";
-
-  std::cout << "\
+  _out << "<div style='padding:4px'>\n"
+       << "<h1>SDF " << SDF::Version() << "</h1>\n";
+
+  _out << "<p>The Robot Modeling Language (SDF) is an XML file "
+       << "format used to describe all the elements in a simulation "
+       << "environment.\n</p>";
+  _out << "<h3>Usage</h3>\n";
+  _out << "<blockquote>";
+  _out << "<ul><li><b>Left Panel:</b> List of all the SDF elements.</li>";
+  _out << "<li><b>Right Panel:</b> Descriptions of all the SDF "
+       << "elements.</li>";
+  _out << "<li><b>Selection:</b> Clicking an element in the Left Panel "
+       << "moves the corresponding description to the top of the Right "
+       << "Panel.</li>";
+  _out << "<li><b>Search:</b> Use your web-browser's built in 'Find' "
+       << "function to locate a specific element."
+       << "</li></ul>";
+  _out << "</blockquote>";
+
+  _out << "</br>\n";
+
+  _out << "<h3>Meta-Tags</h3>\n";
+  _out << "<blockquote>";
+  _out << "Meta-tags are processed by the parser before the final "
+       << "SDF file is generated.";
+  _out << "<ul>";
+
+  _out << "<li><b>&ltinclude&gt</b>: Include an SDF model file "
+       << "within the current SDF file."
+       << "<ul style='margin-left:12px'>"
+       << "<li><b>&lt;uri&gt;</b>: URI of SDF model file to include.</li>"
+       << "<li><b>&lt;name&gt;</b>: Name of the included SDF model.</li>"
+       << "<li><b>&lt;pose&gt;</b>: Pose of the included SDF model, "
+       << "specified as &lt;pose&gt;x y z roll pitch yaw&lt;/pose&gt;, "
+       << "with x, y, and z representing a position in meters, and roll, "
+       << "pitch, and yaw representing Euler angles in radians.</li>"
+       << "</ul>"
+       << "</li>";
+
+  _out << "</ul>";
+  _out << "</blockquote>";
+
+
+  _out << "</div>\n";
+
+  _out << "<div id='my_splitter'>\n";
+
+  _out << "<div id='left_pane'>\n";
+  int index = 0;
+  this->Root()->PrintDocLeftPane(_out, 10, index);
+  _out << "</div>\n";
+
+  _out << "<div id='right_pane'>\n";
+  index = 0;
+  this->Root()->PrintDocRightPane(_out, 10, index);
+  _out << "</div>\n";
+
+  _out << "</div>\n";
+
+  _out << "\
     </body>\
     </html>\n";
 }
@@ -331,8 +887,12 @@ void SDF::PrintDoc()
 /////////////////////////////////////////////////
 void SDF::Write(const std::string &_filename)
 {
-  std::string string = this->Root()->ToString("");
+  this->Write(_filename, PrintConfig());
+}
 
+/////////////////////////////////////////////////
+void SDF::Write(const std::string &_filename, const PrintConfig &_config)
+{
   std::ofstream out(_filename.c_str(), std::ios::out);
 
   if (!out)
@@ -340,29 +900,33 @@ void SDF::Write(const std::string &_filename)
     sdferr << "Unable to open file[" << _filename << "] for writing\n";
     return;
   }
-  out << string;
+  this->Root()->Write(out, "", _config);
   out.close();
 }
 
 /////////////////////////////////////////////////
 std::string SDF::ToString() const
 {
-  std::ostringstream stream;
+  return this->ToString(PrintConfig());
+}
 
-  stream << "<?xml version='1.0'?>\n";
+/////////////////////////////////////////////////
+std::string SDF::ToString(const PrintConfig &_config) const
+{
+  std::string result = "<?xml version='1.0'?>\n";
   if (this->Root()->GetName() != "sdf")
   {
-    stream << "<sdf version='" << SDF::Version() << "'>\n";
+    result += "<sdf version='" + currentSpecVersion().version + "'>\n";
   }
 
-  stream << this->Root()->ToString("");
+  result += this->Root()->ToString("", _config);
 
   if (this->Root()->GetName() != "sdf")
   {
-    stream << "</sdf>";
+    result += "</sdf>";
   }
 
-  return stream.str();
+  return result;
 }
 
 /////////////////////////////////////////////////
@@ -375,6 +939,22 @@ void SDF::SetFromString(const std::string &_sdfData)
   }
 }
 
+/////////////////////////////////////////////////
+void SDF::SetFromString(const char *_data, std::size_t _size)
+{
+  sdf::initFile("root.sdf", this->Root());
+  Errors errors;
+  const bool result = sdf::readString(_data, _size, this->Root(), errors);
+  for (auto const &e : errors)
+    sdferr << e << '\n';
+  if (!result)
+  {
+    sdferr << "Unable to parse sdf string["
+           << std::string(_data, std::find(_data, _data + _size, '\0'))
+           << "]\n";
+  }
+}
+
 /////////////////////////////////////////////////
 void SDF::Clear()
 {
@@ -424,13 +1004,13 @@ const std::string &SDF::OriginalVersion() const
 /////////////////////////////////////////////////
 std::string SDF::Version()
 {
-  return version;
+  return currentSpecVersion().version;
 }
 
 /////////////////////////////////////////////////
 void SDF::Version(const std::string &_version)
 {
-  version = _version;
+  setDefaultSpecVersion(_version);
 }
 
 /////////////////////////////////////////////////
@@ -438,9 +1018,8 @@ ElementPtr SDF::WrapInRoot(const ElementPtr &_sdf)
 {
   ElementPtr root(new Element);
   root->SetName("sdf");
-  std::stringstream v;
-  v << Version();
-  root->AddAttribute("version", "string", v.str(), true, "version");
+  root->AddAttribute("version", "string", currentSpecVersion().version, true,
+      "version");
   root->InsertElement(_sdf->Clone());
   return root;
 }
@@ -449,19 +1028,30 @@ ElementPtr SDF::WrapInRoot(const ElementPtr &_sdf)
 const std::string &SDF::EmbeddedSpec(
     const std::string &_filename, const bool _quiet)
 {
-  try
+  const SpecVersion &spec = currentSpecVersion();
+  const EmbeddedSdfFile *file = FindEmbeddedSdf(spec.version, _filename);
+  if (file != nullptr)
   {
-    const std::string pathname = SDF::Version() + "/" + _filename;
-    return GetEmbeddedSdf().at(pathname);
+    // The embedded files are string views, so each one is copied into a
+    // string the first time it is returned by reference.
+    static std::mutex contentMutex;
+    static std::unordered_map<const EmbeddedSdfFile *, std::string> content;
+    std::lock_guard<std::mutex> lock(contentMutex);
+    auto iter = content.find(file);
+    if (iter == content.end())
+    {
+      iter = content.emplace(file, std::string(file->Content())).first;
+    }
+    return iter->second;
   }
-  catch(const std::out_of_range &)
+
+  if (!_quiet)
   {
-    if (!_quiet)
-      sdferr << "Unable to find SDF filename[" << _filename << "] with "
-        << "version " << SDF::Version() << "\n";
+    sdferr << "Unable to find SDF filename[" << _filename << "] with "
+      << "version " << spec.version << "\n";
   }
 
-  // An empty SDF string is returned if a query into the embeddedSdf map fails.
+  // An empty SDF string is returned if the embedded file is not found.
   static const std::string emptySdfString;
   return emptySdfString;
 }
@@ -17,6 +17,12 @@
 
 #include <gtest/gtest.h>
 #include <any>
+#include <chrono>
+#include <cstdlib>
+#include <future>
+#include <string>
+#include <thread>
+#include <vector>
 #include <ignition/math.hh>
 
 #include "sdf/sdf.hh"
@@ -597,6 +603,28 @@ TEST(SDF, PrintDescription)
   std::cout.rdbuf(old);
 }
 
+/////////////////////////////////////////////////
+TEST(SDF, PrintToStream)
+{
+  sdf::SDF sdf;
+  std::stringstream buffer;
+  auto old = std::cout.rdbuf(buffer.rdbuf());
+  sdf.PrintDescription();
+  const std::string description = buffer.str();
+  buffer.str("");
+  sdf.PrintDoc();
+  const std::string doc = buffer.str();
+  std::cout.rdbuf(old);
+
+  std::ostringstream descriptionStream;
+  sdf.PrintDescription(descriptionStream);
+  EXPECT_EQ(description, descriptionStream.str());
+
+  std::ostringstream docStream;
+  sdf.PrintDoc(docStream);
+  EXPECT_EQ(doc, docStream.str());
+}
+
 /////////////////////////////////////////////////
 TEST(SDF, PrintValues)
 {
@@ -710,8 +738,131 @@ TEST(SDF, WriteURIPath)
   ASSERT_EQ(std::remove(tempFile.c_str()), 0);
   ASSERT_EQ(rmdir(tempDir.c_str()), 0);
 }
+
+/////////////////////////////////////////////////
+TEST(SDF, FindFileCache)
+{
+  std::string tempDir;
+  ASSERT_TRUE(create_new_temp_dir(tempDir));
+  sdf::addURIPath("cache://", tempDir);
+  const std::string tempFile = tempDir + "/cached.sdf";
+
+  // A miss is cached until the cache is cleared.
+  EXPECT_EQ("", sdf::findFile("cache://cached.sdf"));
+  sdf::SDF sdf;
+  sdf.Write(tempFile);
+  EXPECT_EQ("", sdf::findFile("cache://cached.sdf"));
+  sdf::clearFindFileCache();
+  EXPECT_EQ(tempFile, sdf::findFile("cache://cached.sdf"));
+
+  // So is a hit.
+  ASSERT_EQ(std::remove(tempFile.c_str()), 0);
+  EXPECT_EQ(tempFile, sdf::findFile("cache://cached.sdf"));
+
+  // Results older than the timeout are searched again.
+  sdf::setFindFileCacheTimeout(std::chrono::nanoseconds(1));
+  std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  EXPECT_EQ("", sdf::findFile("cache://cached.sdf"));
+  sdf::setFindFileCacheTimeout(std::chrono::steady_clock::duration::zero());
+
+  // Adding a URI path clears the cache.
+  sdf.Write(tempFile);
+  sdf::addURIPath("other://", tempDir);
+  EXPECT_EQ(tempFile, sdf::findFile("cache://cached.sdf"));
+
+  ASSERT_EQ(std::remove(tempFile.c_str()), 0);
+  ASSERT_EQ(rmdir(tempDir.c_str()), 0);
+  sdf::clearFindFileCache();
+}
+
+/////////////////////////////////////////////////
+TEST(SDF, FindFileSearch)
+{
+  std::string tempDir;
+  ASSERT_TRUE(create_new_temp_dir(tempDir));
+  const std::string tempFile = tempDir + "/search.sdf";
+  sdf::SDF sdf;
+  sdf.Write(tempFile);
+
+  // The shorter of the URIs that prefix a file name is tried first, and
+  // the longer one is used if the file is not found with it.
+  sdf::addURIPath("search://", tempDir);
+  sdf::addURIPath("search://sub/", tempDir);
+  EXPECT_EQ(tempFile, sdf::findFile("search://search.sdf"));
+  EXPECT_EQ(tempFile, sdf::findFile("search://sub/search.sdf"));
+  EXPECT_EQ("", sdf::findFile("search://other/search.sdf"));
+
+  // SDF_PATH is read again when the cache is cleared.
+  const char *oldSdfPath = std::getenv("SDF_PATH");
+  const std::string sdfPath = oldSdfPath ? oldSdfPath : "";
+  ASSERT_EQ(0, setenv("SDF_PATH", ("/nonexistent:" + tempDir).c_str(), 1));
+  EXPECT_EQ("", sdf::findFile("search.sdf", false, false));
+  sdf::clearFindFileCache();
+  EXPECT_EQ(tempFile, sdf::findFile("search.sdf", false, false));
+
+  ASSERT_EQ(0, setenv("SDF_PATH", "/nonexistent", 1));
+  ASSERT_EQ(std::remove(tempFile.c_str()), 0);
+  ASSERT_EQ(rmdir(tempDir.c_str()), 0);
+  if (oldSdfPath)
+    setenv("SDF_PATH", sdfPath.c_str(), 1);
+  else
+    unsetenv("SDF_PATH");
+  sdf::clearFindFileCache();
+}
 #endif  // _WIN32
 
+/////////////////////////////////////////////////
+TEST(SDF, FindBatchCallback)
+{
+  std::vector<std::vector<std::string>> batches;
+  std::vector<std::promise<std::string>> promises;
+  sdf::setFindBatchCallback([&](const std::vector<std::string> &_files)
+      {
+        batches.push_back(_files);
+        std::vector<std::shared_future<std::string>> paths;
+        for (std::size_t i = 0; i < _files.size(); ++i)
+        {
+          promises.emplace_back();
+          paths.push_back(promises.back().get_future().share());
+        }
+        return paths;
+      });
+
+  // Files are requested together, without waiting for them.
+  sdf::requestFiles({"batch://a", "batch://b", "batch://a"});
+  ASSERT_EQ(1u, batches.size());
+  EXPECT_EQ(std::vector<std::string>({"batch://a", "batch://b"}),
+      batches[0]);
+  ASSERT_EQ(2u, promises.size());
+
+  // Requested files are not requested again.
+  sdf::requestFiles({"batch://b"});
+  EXPECT_EQ(1u, batches.size());
+
+  // findFile waits for the result of a requested file.
+  promises[1].set_value("/path/to/b");
+  EXPECT_EQ("/path/to/b", sdf::findFile("batch://b", true, true));
+  promises[0].set_value("");
+  EXPECT_EQ("", sdf::findFile("batch://a", true, true));
+  EXPECT_EQ("", sdf::findFile("batch://b", true, false));
+  EXPECT_EQ(1u, batches.size());
+
+  // Files found without callbacks are not requested.
+  sdf::requestFiles({__FILE__});
+  EXPECT_EQ(1u, batches.size());
+
+  // Clearing the cache clears the results.
+  sdf::clearFindFileCache();
+  sdf::requestFiles({"batch://b"});
+  ASSERT_EQ(2u, batches.size());
+  EXPECT_EQ(std::vector<std::string>({"batch://b"}), batches[1]);
+  ASSERT_EQ(3u, promises.size());
+  promises[2].set_value("/path/to/b2");
+  EXPECT_EQ("/path/to/b2", sdf::findFile("batch://b", true, true));
+
+  sdf::setFindBatchCallback(nullptr);
+}
+
 /////////////////////////////////////////////////
 /// Main
 int main(int argc, char **argv)
@@ -0,0 +1,422 @@
+/*
+ * Copyright 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef SDF_SCOPEDNAMEMAP_HH_
+#define SDF_SCOPEDNAMEMAP_HH_
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "sdf/sdf_config.h"
+
+namespace sdf
+{
+  // Inline bracket to help doxygen filtering.
+  inline namespace SDF_VERSION_NAMESPACE {
+  //
+
+  /// \brief A name split at its last "::" into its scope and its local
+  /// name, such as "a::b" and "link" for "a::b::link". The scope is held by
+  /// the table of a ScopedNameMap.
+  struct ScopedNameView
+  {
+    /// \brief The scope, or nullptr for a name without scope.
+    const std::string *scope = nullptr;
+
+    /// \brief The local name.
+    std::string_view local;
+
+    /// \brief Get the full name.
+    /// \return The scope and the local name joined by "::".
+    std::string Str() const
+    {
+      if (!this->scope)
+        return std::string(this->local);
+      std::string name;
+      name.reserve(this->scope->size() + 2 + this->local.size());
+      name += *this->scope;
+      name += "::";
+      name += this->local;
+      return name;
+    }
+
+    /// \brief Get the full name.
+    /// \return The scope and the local name joined by "::".
+    operator std::string() const
+    {
+      return this->Str();
+    }
+
+    /// \brief Compare two names in the order of their full names, without
+    /// building the full names.
+    /// \param[in] _a First name.
+    /// \param[in] _b Second name.
+    /// \return Negative, zero or positive, as std::string::compare.
+    static int Compare(const ScopedNameView &_a, const ScopedNameView &_b)
+    {
+      if (_a.scope == _b.scope)
+        return _a.local.compare(_b.local);
+
+      // The names are compared part by part: the scope, the separator and
+      // the local name.
+      const std::string_view a[3] = {
+          _a.scope ? std::string_view(*_a.scope) : std::string_view(),
+          _a.scope ? "::" : "", _a.local};
+      const std::string_view b[3] = {
+          _b.scope ? std::string_view(*_b.scope) : std::string_view(),
+          _b.scope ? "::" : "", _b.local};
+      std::size_t ai = 0, bi = 0, ap = 0, bp = 0;
+      while (true)
+      {
+        while (ai < 3 && ap == a[ai].size())
+        {
+          ++ai;
+          ap = 0;
+        }
+        while (bi < 3 && bp == b[bi].size())
+        {
+          ++bi;
+          bp = 0;
+        }
+        if (ai == 3 || bi == 3)
+          return (ai == 3 ? 0 : 1) - (bi == 3 ? 0 : 1);
+
+        const std::size_t n = std::min(a[ai].size() - ap, b[bi].size() - bp);
+        const int result = a[ai].substr(ap, n).compare(b[bi].substr(bp, n));
+        if (result != 0)
+          return result;
+        ap += n;
+        bp += n;
+      }
+    }
+  };
+
+  /// \brief A map from the names of the frames of a graph to values, for
+  /// FrameAttachedToGraph::map and PoseRelativeToGraph::map. Nested models
+  /// are flattened into their parent by addNestedModel, which prefixes the
+  /// names of their frames with their scope, such as "a::b::link". Each
+  /// scope is stored once in a table of the map, and the names are stored
+  /// as a scope and a local name, so that deep nesting does not store long
+  /// prefixes for every frame, and names of the same scope are compared by
+  /// their local name only. Iteration is in the order of the full names,
+  /// as with std::map, and full names are only built on request.
+  template <typename T>
+  class ScopedNameMap
+  {
+    /// \brief A name stored in the map.
+    private: struct Key
+    {
+      /// \brief The scope in the table of the map, or nullptr.
+      const std::string *scope;
+
+      /// \brief The local name.
+      std::string local;
+
+      /// \brief Get a view of the name.
+      /// \return The view.
+      ScopedNameView View() const
+      {
+        return {this->scope, this->local};
+      }
+    };
+
+    /// \brief Ordering of the keys by full name, which also compares keys
+    /// with views for lookups.
+    private: struct KeyLess
+    {
+      /// \brief Enables lookups by ScopedNameView.
+      using is_transparent = void;
+
+      /// \brief Compare keys or views.
+      /// \param[in] _a First name.
+      /// \param[in] _b Second name.
+      /// \return True if _a comes before _b.
+      bool operator()(const Key &_a, const Key &_b) const
+      {
+        return ScopedNameView::Compare(_a.View(), _b.View()) < 0;
+      }
+
+      /// \copydoc operator()
+      bool operator()(const Key &_a, const ScopedNameView &_b) const
+      {
+        return ScopedNameView::Compare(_a.View(), _b) < 0;
+      }
+
+      /// \copydoc operator()
+      bool operator()(const ScopedNameView &_a, const Key &_b) const
+      {
+        return ScopedNameView::Compare(_a, _b.View()) < 0;
+      }
+    };
+
+    /// \brief The underlying map.
+    private: using Entries = std::map<Key, T, KeyLess>;
+
+    /// \brief An entry of the map, as returned by its iterators.
+    public: struct Entry
+    {
+      /// \brief The name, which converts to the full name.
+      ScopedNameView first;
+
+      /// \brief The value.
+      T second;
+    };
+
+    /// \brief Iterator over the entries, in the order of their full names.
+    public: class iterator
+    {
+      /// \brief Default constructor.
+      public: iterator() = default;
+
+      /// \brief Constructor.
+      /// \param[in] _it Iterator of the underlying map.
+      public: explicit iterator(typename Entries::const_iterator _it)
+        : it(_it)
+      {
+      }
+
+      /// \brief Get the entry.
+      /// \return The entry.
+      public: Entry operator*() const
+      {
+        return {this->it->first.View(), this->it->second};
+      }
+
+      /// \brief Access a member of the entry.
+      /// \return Pointer to the entry.
+      public: const Entry *operator->() const
+      {
+        this->entry = **this;
+        return &this->entry;
+      }
+
+      /// \brief Advance to the next entry.
+      /// \return This iterator.
+      public: iterator &operator++()
+      {
+        ++this->it;
+        return *this;
+      }
+
+      /// \brief Equality operator.
+      /// \param[in] _other Other iterator.
+      /// \return True if both are at the same entry.
+      public: bool operator==(const iterator &_other) const
+      {
+        return this->it == _other.it;
+      }
+
+      /// \brief Inequality operator.
+      /// \param[in] _other Other iterator.
+      /// \return True if they are at different entries.
+      public: bool operator!=(const iterator &_other) const
+      {
+        return this->it != _other.it;
+      }
+
+      /// \brief Iterator of the underlying map.
+      private: typename Entries::const_iterator it;
+
+      /// \brief The entry returned by operator->.
+      private: mutable Entry entry;
+
+      friend class ScopedNameMap;
+    };
+
+    /// \brief Constructor.
+    public: ScopedNameMap() = default;
+
+    /// \brief Copy constructor, which copies the scopes into the table of
+    /// this map.
+    /// \param[in] _map Map to copy.
+    public: ScopedNameMap(const ScopedNameMap &_map)
+    {
+      *this = _map;
+    }
+
+    /// \brief Move constructor. The scopes move with their table.
+    /// \param[in] _map Map to move.
+    public: ScopedNameMap(ScopedNameMap &&_map) = default;
+
+    /// \brief Copy assignment.
+    /// \param[in] _map Map to copy.
+    /// \return This map.
+    public: ScopedNameMap &operator=(const ScopedNameMap &_map)
+    {
+      if (this == &_map)
+        return *this;
+      this->entries.clear();
+      this->scopes.clear();
+      for (const auto &entry : _map.entries)
+      {
+        const std::string *scope = entry.first.scope ?
+            &*this->scopes.insert(*entry.first.scope).first : nullptr;
+        this->entries.emplace_hint(this->entries.end(),
+            Key{scope, entry.first.local}, entry.second);
+      }
+      return *this;
+    }
+
+    /// \brief Move assignment.
+    /// \param[in] _map Map to move.
+    /// \return This map.
+    public: ScopedNameMap &operator=(ScopedNameMap &&_map) = default;
+
+    /// \brief Get the number of names.
+    /// \return Number of names.
+    public: std::size_t size() const
+    {
+      return this->entries.size();
+    }
+
+    /// \brief Get whether the map has no names.
+    /// \return True if it is empty.
+    public: bool empty() const
+    {
+      return this->entries.empty();
+    }
+
+    /// \brief Get the number of distinct scopes of the names.
+    /// \return Number of scopes in the table of the map.
+    public: std::size_t ScopeCount() const
+    {
+      return this->scopes.size();
+    }
+
+    /// \brief Get an iterator to the first entry.
+    /// \return The iterator.
+    public: iterator begin() const
+    {
+      return iterator(this->entries.begin());
+    }
+
+    /// \brief Get an iterator past the last entry.
+    /// \return The iterator.
+    public: iterator end() const
+    {
+      return iterator(this->entries.end());
+    }
+
+    /// \brief Find a name.
+    /// \param[in] _name The full name.
+    /// \return Iterator to its entry, or end().
+    public: iterator find(const std::string &_name) const
+    {
+      ScopedNameView view;
+      if (!this->Split(_name, view))
+        return this->end();
+      return iterator(this->entries.find(view));
+    }
+
+    /// \brief Count the entries of a name.
+    /// \param[in] _name The full name.
+    /// \return 1 if the name is in the map, 0 otherwise.
+    public: std::size_t count(const std::string &_name) const
+    {
+      return this->find(_name) != this->end() ? 1u : 0u;
+    }
+
+    /// \brief Get the value of a name.
+    /// \param[in] _name The full name.
+    /// \return The value.
+    /// \throws std::out_of_range if the name is not in the map.
+    public: const T &at(const std::string &_name) const
+    {
+      const iterator it = this->find(_name);
+      if (it == this->end())
+        throw std::out_of_range("ScopedNameMap::at");
+      return it.it->second;
+    }
+
+    /// \brief Get the value of a name, adding the name if it is not in the
+    /// map.
+    /// \param[in] _name The full name.
+    /// \return The value.
+    public: T &operator[](const std::string &_name)
+    {
+      const std::size_t separator = _name.rfind("::");
+      const std::string *scope = nullptr;
+      std::string_view local = _name;
+      if (separator != std::string::npos)
+      {
+        const std::string_view prefix =
+            std::string_view(_name).substr(0, separator);
+        auto scopeIt = this->scopes.find(prefix);
+        if (scopeIt == this->scopes.end())
+          scopeIt = this->scopes.emplace(prefix).first;
+        scope = &*scopeIt;
+        local = std::string_view(_name).substr(separator + 2);
+      }
+
+      auto it = this->entries.find(ScopedNameView{scope, local});
+      if (it == this->entries.end())
+        it = this->entries.emplace(Key{scope, std::string(local)}, T()).first;
+      return it->second;
+    }
+
+    /// \brief Remove an entry. The scope of its name stays in the table.
+    /// \param[in] _it Iterator to the entry.
+    public: void erase(const iterator &_it)
+    {
+      this->entries.erase(_it.it);
+    }
+
+    /// \brief Remove all the entries and scopes.
+    public: void clear()
+    {
+      this->entries.clear();
+      this->scopes.clear();
+    }
+
+    /// \brief Split a name into its scope in the table and its local name.
+    /// \param[in] _name The full name.
+    /// \param[out] _view The split name.
+    /// \return False if the scope is not in the table, in which case no
+    /// name of the map has that scope.
+    private: bool Split(const std::string &_name, ScopedNameView &_view) const
+    {
+      const std::size_t separator = _name.rfind("::");
+      if (separator == std::string::npos)
+      {
+        _view = {nullptr, _name};
+        return true;
+      }
+
+      auto scope = this->scopes.find(
+          std::string_view(_name).substr(0, separator));
+      if (scope == this->scopes.end())
+        return false;
+      _view = {&*scope, std::string_view(_name).substr(separator + 2)};
+      return true;
+    }
+
+    /// \brief The scopes of the names. Their addresses are stable, and the
+    /// keys of the entries point to them.
+    private: std::set<std::string, std::less<>> scopes;
+
+    /// \brief The entries.
+    private: Entries entries;
+  };
+  }
+}
+#endif
@@ -0,0 +1,97 @@
+/*
+ * Copyright 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "ScopedNameMap.hh"
+
+/////////////////////////////////////////////////
+TEST(ScopedNameMap, MatchesStdMap)
+{
+  const std::vector<std::string> names = {
+      "__model__", "a::__model__", "a::link", "a::b::__model__",
+      "a::b::link", "ab", "a", "b::c", "a::b", "a:b::x", "a::b::c::d::e"};
+
+  sdf::ScopedNameMap<int> map;
+  std::map<std::string, int> expected;
+  for (std::size_t i = 0; i < names.size(); ++i)
+  {
+    map[names[i]] = static_cast<int>(i);
+    expected[names[i]] = static_cast<int>(i);
+  }
+  EXPECT_EQ(expected.size(), map.size());
+
+  // Each scope is stored once.
+  EXPECT_EQ(5u, map.ScopeCount());
+
+  // Iteration is in the order of the full names.
+  std::vector<std::pair<std::string, int>> entries;
+  for (const auto &entry : map)
+    entries.emplace_back(entry.first, entry.second);
+  const std::vector<std::pair<std::string, int>> expectedEntries(
+      expected.begin(), expected.end());
+  EXPECT_EQ(expectedEntries, entries);
+
+  for (const std::string &name : names)
+  {
+    EXPECT_EQ(1u, map.count(name)) << name;
+    EXPECT_EQ(expected.at(name), map.at(name));
+    auto it = map.find(name);
+    ASSERT_NE(map.end(), it);
+    EXPECT_EQ(name, it->first.Str());
+  }
+  EXPECT_EQ(0u, map.count("c::link"));
+  EXPECT_EQ(0u, map.count("a::c"));
+  EXPECT_EQ(map.end(), map.find("a::b::c"));
+  EXPECT_THROW(map.at("missing"), std::out_of_range);
+}
+
+/////////////////////////////////////////////////
+TEST(ScopedNameMap, CopyMoveErase)
+{
+  sdf::ScopedNameMap<int> map;
+  map["a::b::link"] = 1;
+  map["a::b::joint"] = 2;
+  map["link"] = 3;
+
+  // The copy has its own scopes, which outlive the original.
+  auto original = std::make_unique<sdf::ScopedNameMap<int>>(map);
+  sdf::ScopedNameMap<int> copy(*original);
+  original.reset();
+  EXPECT_EQ(1, copy.at("a::b::link"));
+
+  copy.erase(copy.find("a::b::link"));
+  EXPECT_EQ(0u, copy.count("a::b::link"));
+  EXPECT_EQ(1u, map.count("a::b::link"));
+  EXPECT_EQ(2u, copy.size());
+
+  sdf::ScopedNameMap<int> moved(std::move(copy));
+  EXPECT_EQ(2, moved.at("a::b::joint"));
+  EXPECT_EQ(3, moved.at("link"));
+
+  moved = map;
+  EXPECT_EQ(3u, moved.size());
+  moved.clear();
+  EXPECT_TRUE(moved.empty());
+  EXPECT_EQ(0u, moved.ScopeCount());
+}
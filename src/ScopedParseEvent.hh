@@ -0,0 +1,177 @@
+/*
+ * Copyright 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef SDF_SCOPEDPARSEEVENT_HH_
+#define SDF_SCOPEDPARSEEVENT_HH_
+
+#include <tinyxml.h>
+
+#include <cstddef>
+#include <string>
+
+#include "sdf/Element.hh"
+#include "sdf/ParseEvent.hh"
+#include "sdf/sdf_config.h"
+
+namespace sdf
+{
+  // Inline bracket to help doxygen filtering.
+  inline namespace SDF_VERSION_NAMESPACE {
+  //
+
+  /// \brief Reports the BEGIN event of a parse stage when constructed and
+  /// the END event when destroyed, if a ParseEventCallback is set.
+  ///
+  /// This is header only, so that sources compiled into the unit tests,
+  /// such as Converter.cc, only depend on the public parseEventCallback.
+  class ScopedParseEvent
+  {
+    /// \brief Constructor. Reports the BEGIN event.
+    /// \param[in] _stage The stage of parsing.
+    /// \param[in] _name Name of the function that implements the stage.
+    /// It must outlive this object.
+    /// \param[in] _path Path of the file being processed.
+    public: ScopedParseEvent(ParseStage _stage, const char *_name,
+                const std::string &_path = "")
+      : callback(parseEventCallback())
+    {
+      if (!this->callback)
+        return;
+
+      this->event.type = ParseEventType::BEGIN;
+      this->event.stage = _stage;
+      this->event.name = _name;
+      this->event.path = _path;
+      this->event.elementCount = 0;
+      this->callback(this->event);
+    }
+
+    /// \brief Copy constructor is explicitly deleted.
+    public: ScopedParseEvent(const ScopedParseEvent &) = delete;
+
+    /// \brief Copy assignment is explicitly deleted.
+    public: ScopedParseEvent &operator=(const ScopedParseEvent &) = delete;
+
+    /// \brief Destructor. Reports the END event.
+    public: ~ScopedParseEvent()
+    {
+      if (!this->callback)
+        return;
+
+      this->event.type = ParseEventType::END;
+      if (this->elements)
+        this->event.elementCount = countElements(this->elements);
+      else if (this->xmlNode)
+        this->event.elementCount = countElements(this->xmlNode);
+      this->callback(this->event);
+    }
+
+    /// \brief Whether a callback receives the events of this stage.
+    /// \return True if events are reported.
+    public: bool Enabled() const
+    {
+      return static_cast<bool>(this->callback);
+    }
+
+    /// \brief Set the path reported in the END event.
+    /// \param[in] _path Path of the file, such as the resolved path of a
+    /// file lookup.
+    public: void SetPath(const std::string &_path)
+    {
+      if (this->callback)
+        this->event.path = _path;
+    }
+
+    /// \brief Set the URI reported in the END event of an INCLUDE stage.
+    /// \param[in] _uri The URI of the `<include>` element.
+    public: void SetUri(const std::string &_uri)
+    {
+      if (this->callback)
+        this->event.uri = _uri;
+    }
+
+    /// \brief Set the size of the file reported in the END event.
+    /// \param[in] _bytes Size of the file in bytes.
+    public: void SetBytes(std::size_t _bytes)
+    {
+      if (this->callback)
+        this->event.bytes = _bytes;
+    }
+
+    /// \brief Set the element tree produced or validated by the stage.
+    /// Its elements are counted when the END event is reported, so it must
+    /// outlive this object.
+    /// \param[in] _elem Root of the element tree.
+    public: void SetElements(ElementPtr _elem)
+    {
+      if (this->callback)
+        this->elements = _elem;
+    }
+
+    /// \brief Set the XML tree produced by the stage. Its elements are
+    /// counted when the END event is reported, so it must outlive this
+    /// object.
+    /// \param[in] _node Root of the XML tree.
+    public: void SetElements(const TiXmlNode *_node)
+    {
+      this->xmlNode = _node;
+    }
+
+    /// \brief Count the elements of an element tree, without reading the
+    /// deferred ones.
+    /// \param[in] _elem Root of the element tree.
+    /// \return Number of elements, including _elem.
+    private: static std::size_t countElements(const ElementPtr &_elem)
+    {
+      std::size_t count = 0;
+      _elem->Visit([&count](const Element &_visited)
+          {
+            ++count;
+            return !_visited.ElementsDeferred();
+          });
+      return count;
+    }
+
+    /// \brief Count the XML elements below a node.
+    /// \param[in] _node The node.
+    /// \return Number of elements, including _node if it is an element.
+    private: static std::size_t countElements(const TiXmlNode *_node)
+    {
+      std::size_t count = _node->ToElement() ? 1 : 0;
+      for (const TiXmlNode *child = _node->FirstChild(); child;
+           child = child->NextSibling())
+      {
+        count += countElements(child);
+      }
+      return count;
+    }
+
+    /// \brief The callback, copied when the stage begins so that both
+    /// events go to the same callback.
+    private: ParseEventCallback callback;
+
+    /// \brief The event passed to the callback.
+    private: ParseEvent event;
+
+    /// \brief Element tree to count in the END event.
+    private: ElementPtr elements;
+
+    /// \brief XML tree to count in the END event.
+    private: const TiXmlNode *xmlNode = nullptr;
+  };
+  }
+}
+#endif
@@ -41,6 +41,9 @@ class SemanticPosePrivate
 
   /// \brief Weak pointer to model's Pose Relative-To Graph.
   public: std::weak_ptr<const sdf::PoseRelativeToGraph> poseRelativeToGraph;
+
+  /// \brief Vertex ids of the relative-to and default resolve-to frames.
+  public: FrameIds frameIds;
 };
 
 /////////////////////////////////////////////////
@@ -48,13 +51,15 @@ SemanticPose::SemanticPose(
         const ignition::math::Pose3d &_pose,
         const std::string &_relativeTo,
         const std::string &_defaultResolveTo,
-        const std::weak_ptr<const sdf::PoseRelativeToGraph> _graph)
+        const std::weak_ptr<const sdf::PoseRelativeToGraph> _graph,
+        const FrameIds &_frameIds)
   : dataPtr(std::make_unique<SemanticPosePrivate>())
 {
   this->dataPtr->rawPose = _pose;
   this->dataPtr->relativeTo = _relativeTo;
   this->dataPtr->defaultResolveTo = _defaultResolveTo;
   this->dataPtr->poseRelativeToGraph = _graph;
+  this->dataPtr->frameIds = _frameIds;
 }
 
 /////////////////////////////////////////////////
@@ -111,6 +116,16 @@ Errors SemanticPose::Resolve(
     return errors;
   }
 
+  // The frames are found by the vertex ids of the DOM object when resolving
+  // to the default frame, including when it is named explicitly.
+  ignition::math::Pose3d pose;
+  if ((_resolveTo.empty() || _resolveTo == this->dataPtr->defaultResolveTo) &&
+      resolveCachedPose(pose, *graph, this->dataPtr->frameIds))
+  {
+    _pose = pose * this->RawPose();
+    return errors;
+  }
+
   std::string relativeTo = this->dataPtr->relativeTo;
   if (relativeTo.empty())
   {
@@ -123,7 +138,6 @@ Errors SemanticPose::Resolve(
     resolveTo = this->dataPtr->defaultResolveTo;
   }
 
-  ignition::math::Pose3d pose;
   errors = resolvePose(pose, *graph, relativeTo, resolveTo);
   pose *= this->RawPose();
 
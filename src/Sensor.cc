@@ -16,6 +16,8 @@
 */
 #include <memory>
 #include <string>
+#include <string_view>
+#include <variant>
 #include <vector>
 #include <ignition/math/Pose3.hh>
 #include "sdf/AirPressure.hh"
@@ -27,38 +29,44 @@
 #include "sdf/Lidar.hh"
 #include "sdf/Sensor.hh"
 #include "sdf/Types.hh"
+#include "ElementArena.hh"
+#include "EnumNames.hh"
+#include "FrameSemantics.hh"
 #include "Utils.hh"
 
 using namespace sdf;
 
-/// Sensor type strings. These should match the data in
-/// `enum class SensorType` located in Sensor.hh.
-const std::vector<std::string> sensorTypeStrs =
-{
-  "none",
-  "altimeter",
-  "camera",
-  "contact",
-  "depth_camera",
-  "force_torque",
-  "gps",
-  "gpu_lidar",
-  "imu",
-  "logical_camera",
-  "magnetometer",
-  "multicamera",
-  "lidar",
-  "rfid",
-  "rfidtag",
-  "sonar",
-  "wireless_receiver",
-  "wireless_transmitter",
-  "air_pressure",
-  "rgbd_camera",
-  "thermal_camera"
-};
-
-class sdf::SensorPrivate
+/// Sensor type strings. The first name of each type is the one of
+/// TypeStr, and the others are accepted when loading a sensor.
+constexpr auto kSensorTypes = makeEnumNames<SensorType>({
+    {"none", SensorType::NONE},
+    {"altimeter", SensorType::ALTIMETER},
+    {"camera", SensorType::CAMERA},
+    {"contact", SensorType::CONTACT},
+    {"depth_camera", SensorType::DEPTH_CAMERA},
+    {"force_torque", SensorType::FORCE_TORQUE},
+    {"gps", SensorType::GPS},
+    {"gpu_lidar", SensorType::GPU_LIDAR},
+    {"imu", SensorType::IMU},
+    {"logical_camera", SensorType::LOGICAL_CAMERA},
+    {"magnetometer", SensorType::MAGNETOMETER},
+    {"multicamera", SensorType::MULTICAMERA},
+    {"lidar", SensorType::LIDAR},
+    {"rfid", SensorType::RFID},
+    {"rfidtag", SensorType::RFIDTAG},
+    {"sonar", SensorType::SONAR},
+    {"wireless_receiver", SensorType::WIRELESS_RECEIVER},
+    {"wireless_transmitter", SensorType::WIRELESS_TRANSMITTER},
+    {"air_pressure", SensorType::AIR_PRESSURE},
+    {"rgbd_camera", SensorType::RGBD_CAMERA},
+    {"thermal_camera", SensorType::THERMAL_CAMERA},
+    {"depth", SensorType::DEPTH_CAMERA},
+    {"rgbd", SensorType::RGBD_CAMERA},
+    {"thermal", SensorType::THERMAL_CAMERA},
+    {"gpu_ray", SensorType::GPU_LIDAR},
+    {"ray", SensorType::LIDAR}});
+
+class sdf::SensorPrivate : public ArenaAllocated
 {
   /// \brief Default constructor
   public: SensorPrivate() = default;
@@ -71,35 +79,9 @@ class sdf::SensorPrivate
             pose(_sensor.pose),
             poseRelativeTo(_sensor.poseRelativeTo),
             sdf(_sensor.sdf),
-            updateRate(_sensor.updateRate)
-
+            updateRate(_sensor.updateRate),
+            payload(_sensor.payload)
   {
-    if (_sensor.magnetometer)
-    {
-      this->magnetometer = std::make_unique<sdf::Magnetometer>(
-          *_sensor.magnetometer);
-    }
-    if (_sensor.altimeter)
-    {
-      this->altimeter = std::make_unique<sdf::Altimeter>(*_sensor.altimeter);
-    }
-    if (_sensor.airPressure)
-    {
-      this->airPressure = std::make_unique<sdf::AirPressure>(
-          *_sensor.airPressure);
-    }
-    if (_sensor.camera)
-    {
-      this->camera = std::make_unique<sdf::Camera>(*_sensor.camera);
-    }
-    if (_sensor.imu)
-    {
-      this->imu = std::make_unique<sdf::Imu>(*_sensor.imu);
-    }
-    if (_sensor.lidar)
-    {
-      this->lidar = std::make_unique<sdf::Lidar>(*_sensor.lidar);
-    }
     // Developer note: If you add a new sensor type, make sure to also
     // update the Sensor::operator== function. Please bump this text down as
     // new sensors are added so that the next developer sees the message.
@@ -131,23 +113,8 @@ class sdf::SensorPrivate
   /// \brief Weak pointer to model's Pose Relative-To Graph.
   public: std::weak_ptr<const sdf::PoseRelativeToGraph> poseRelativeToGraph;
 
-  /// \brief Pointer to a magnetometer.
-  public: std::unique_ptr<Magnetometer> magnetometer;
-
-  /// \brief Pointer to an altimeter.
-  public: std::unique_ptr<Altimeter> altimeter;
-
-  /// \brief Pointer to an air pressure sensor.
-  public: std::unique_ptr<AirPressure> airPressure;
-
-  /// \brief Pointer to a camera.
-  public: std::unique_ptr<Camera> camera;
-
-  /// \brief Pointer to an IMU.
-  public: std::unique_ptr<Imu> imu;
-
-  /// \brief Pointer to a lidar.
-  public: std::unique_ptr<Lidar> lidar;
+  /// \brief Vertex ids of the frames of SemanticPose in the graph.
+  public: FrameIds frameIds;
 
   // Developer note: If you add a new sensor type, make sure to also
   // update the Sensor::operator== function. Please bump this text down as
@@ -156,8 +123,41 @@ class sdf::SensorPrivate
   /// \brief The frequency at which the sensor data is generated.
   /// If left unspecified (0.0), the sensor will generate data every cycle.
   public: double updateRate = 0.0;
+
+  /// \brief The configuration of the sensor type, if it has one. It is
+  /// stored inline, instead of one pointer per sensor type, since a
+  /// sensor only has the configuration of its own type.
+  public: std::variant<std::monostate, Magnetometer, Altimeter, AirPressure,
+                       Camera, Imu, Lidar> payload;
 };
 
+/////////////////////////////////////////////////
+/// \brief Find the vertex ids of the frames of the SemanticPose of a
+/// sensor again, after its graph or the names of the frames changed.
+/// \param[in,out] _data Private data of the sensor.
+static void updateFrameIds(SensorPrivate &_data)
+{
+  _data.frameIds = findFrameIds(_data.poseRelativeToGraph,
+      _data.poseRelativeTo.empty() ? _data.xmlParentName : _data.poseRelativeTo,
+      _data.xmlParentName);
+}
+
+/////////////////////////////////////////////////
+/// \brief Compare the configurations of two sensors.
+/// \param[in] _a Configuration of the first sensor.
+/// \param[in] _b Configuration of the second sensor.
+/// \return True if neither has a configuration of type T, or if both have
+/// one and they are equal.
+template<typename T, typename Payload>
+static bool payloadEqual(const Payload &_a, const Payload &_b)
+{
+  const T *a = std::get_if<T>(&_a);
+  const T *b = std::get_if<T>(&_b);
+  if (!a || !b)
+    return a == b;
+  return *a == *b;
+}
+
 /////////////////////////////////////////////////
 Sensor::Sensor()
   : dataPtr(new SensorPrivate)
@@ -214,20 +214,26 @@ bool Sensor::operator==(const Sensor &_sensor) const
   switch (this->Type())
   {
     case SensorType::ALTIMETER:
-      return *(this->dataPtr->altimeter) == *(_sensor.dataPtr->altimeter);
+      return payloadEqual<Altimeter>(this->dataPtr->payload,
+          _sensor.dataPtr->payload);
     case SensorType::MAGNETOMETER:
-      return *(this->dataPtr->magnetometer) == *(_sensor.dataPtr->magnetometer);
+      return payloadEqual<Magnetometer>(this->dataPtr->payload,
+          _sensor.dataPtr->payload);
     case SensorType::AIR_PRESSURE:
-      return *(this->dataPtr->airPressure) == *(_sensor.dataPtr->airPressure);
+      return payloadEqual<AirPressure>(this->dataPtr->payload,
+          _sensor.dataPtr->payload);
     case SensorType::IMU:
-      return *(this->dataPtr->imu) == *(_sensor.dataPtr->imu);
+      return payloadEqual<Imu>(this->dataPtr->payload,
+          _sensor.dataPtr->payload);
     case SensorType::CAMERA:
     case SensorType::DEPTH_CAMERA:
     case SensorType::RGBD_CAMERA:
     case SensorType::THERMAL_CAMERA:
-      return *(this->dataPtr->camera) == *(_sensor.dataPtr->camera);
+      return payloadEqual<Camera>(this->dataPtr->payload,
+          _sensor.dataPtr->payload);
     case SensorType::LIDAR:
-      return *(this->dataPtr->lidar) == *(_sensor.dataPtr->lidar);
+      return payloadEqual<Lidar>(this->dataPtr->payload,
+          _sensor.dataPtr->payload);
     case SensorType::NONE:
     default:
       return true;
@@ -245,7 +251,7 @@ Errors Sensor::Load(ElementPtr _sdf)
 {
   Errors errors;
 
-  this->dataPtr->sdf = _sdf;
+  this->dataPtr->sdf = retainedElement(_sdf);
 
   // Check that sdf is a valid pointer
   if (!_sdf)
@@ -289,128 +295,90 @@ Errors Sensor::Load(ElementPtr _sdf)
     this->dataPtr->topic = "";
 
   std::string type = _sdf->Get<std::string>("type");
-  if (type == "air_pressure")
-  {
-    this->dataPtr->type = SensorType::AIR_PRESSURE;
-    this->dataPtr->airPressure.reset(new AirPressure());
-    Errors err = this->dataPtr->airPressure->Load(
-        _sdf->GetElement("air_pressure"));
-    errors.insert(errors.end(), err.begin(), err.end());
-  }
-  else if (type == "altimeter")
-  {
-    this->dataPtr->type = SensorType::ALTIMETER;
-    this->dataPtr->altimeter.reset(new Altimeter());
-    Errors err = this->dataPtr->altimeter->Load(_sdf->GetElement("altimeter"));
-    errors.insert(errors.end(), err.begin(), err.end());
-  }
-  else if (type == "camera")
-  {
-    this->dataPtr->type = SensorType::CAMERA;
-    this->dataPtr->camera.reset(new Camera());
-    Errors err = this->dataPtr->camera->Load(_sdf->GetElement("camera"));
-    errors.insert(errors.end(), err.begin(), err.end());
-  }
-  else if (type == "contact")
-  {
-    this->dataPtr->type = SensorType::CONTACT;
-  }
-  else if (type == "depth" || type == "depth_camera")
-  {
-    this->dataPtr->type = SensorType::DEPTH_CAMERA;
-    this->dataPtr->camera.reset(new Camera());
-    Errors err = this->dataPtr->camera->Load(_sdf->GetElement("camera"));
-    errors.insert(errors.end(), err.begin(), err.end());
-  }
-  else if (type == "rgbd" || type == "rgbd_camera")
-  {
-    this->dataPtr->type = SensorType::RGBD_CAMERA;
-    this->dataPtr->camera.reset(new Camera());
-    Errors err = this->dataPtr->camera->Load(_sdf->GetElement("camera"));
-    errors.insert(errors.end(), err.begin(), err.end());
-  }
-  else if (type == "thermal" || type == "thermal_camera")
-  {
-    this->dataPtr->type = SensorType::THERMAL_CAMERA;
-    this->dataPtr->camera.reset(new Camera());
-    Errors err = this->dataPtr->camera->Load(_sdf->GetElement("camera"));
-    errors.insert(errors.end(), err.begin(), err.end());
-  }
-  else if (type == "force_torque")
-  {
-    this->dataPtr->type = SensorType::FORCE_TORQUE;
-  }
-  else if (type == "gps")
-  {
-    this->dataPtr->type = SensorType::GPS;
-  }
-  else if (type == "gpu_ray" || type == "gpu_lidar")
-  {
-    this->dataPtr->type = SensorType::GPU_LIDAR;
-    this->dataPtr->lidar.reset(new Lidar());
-    Errors err = this->dataPtr->lidar->Load(
-        _sdf->GetElement(_sdf->HasElement("lidar") ? "lidar" : "ray"));
-    errors.insert(errors.end(), err.begin(), err.end());
-  }
-  else if (type == "imu")
-  {
-    this->dataPtr->type = SensorType::IMU;
-    this->dataPtr->type = SensorType::IMU;
-    this->dataPtr->imu.reset(new Imu());
-    Errors err = this->dataPtr->imu->Load(_sdf->GetElement("imu"));
-    errors.insert(errors.end(), err.begin(), err.end());
-  }
-  else if (type == "logical_camera")
-  {
-    this->dataPtr->type = SensorType::LOGICAL_CAMERA;
-  }
-  else if (type == "magnetometer")
-  {
-    this->dataPtr->type = SensorType::MAGNETOMETER;
-    this->dataPtr->magnetometer.reset(new Magnetometer());
-    Errors err = this->dataPtr->magnetometer->Load(
-        _sdf->GetElement("magnetometer"));
-    errors.insert(errors.end(), err.begin(), err.end());
-  }
-  else if (type == "multicamera")
-  {
-    this->dataPtr->type = SensorType::MULTICAMERA;
-  }
-  else if (type == "ray" || type == "lidar")
-  {
-    this->dataPtr->type = SensorType::LIDAR;
-    this->dataPtr->lidar.reset(new Lidar());
-    Errors err = this->dataPtr->lidar->Load(
-        _sdf->GetElement(_sdf->HasElement("lidar") ? "lidar" : "ray"));
-    errors.insert(errors.end(), err.begin(), err.end());
-  }
-  else if (type == "rfid")
-  {
-    this->dataPtr->type = SensorType::RFID;
-  }
-  else if (type == "rfidtag")
-  {
-    this->dataPtr->type = SensorType::RFIDTAG;
-  }
-  else if (type == "sonar")
-  {
-    this->dataPtr->type = SensorType::SONAR;
-  }
-  else if (type == "wireless_receiver")
-  {
-    this->dataPtr->type = SensorType::WIRELESS_RECEIVER;
-  }
-  else if (type == "wireless_transmitter")
-  {
-    this->dataPtr->type = SensorType::WIRELESS_TRANSMITTER;
-  }
-  else
+  SensorType sensorType = SensorType::NONE;
+  if (!kSensorTypes.Find(type, sensorType) || sensorType == SensorType::NONE)
   {
     errors.push_back({ErrorCode::ATTRIBUTE_INVALID,
         "Attempting to load a Sensor, but the provided sensor type is missing "
         "or invalid."});
     return errors;
   }
+  this->dataPtr->type = sensorType;
+
+  switch (sensorType)
+  {
+    case SensorType::AIR_PRESSURE:
+    {
+      AirPressure &airPressure =
+          this->dataPtr->payload.emplace<AirPressure>();
+      if (_sdf->HasElement("air_pressure"))
+      {
+        Errors err = airPressure.Load(_sdf->FindElement("air_pressure"));
+        errors.insert(errors.end(), err.begin(), err.end());
+      }
+      break;
+    }
+    case SensorType::ALTIMETER:
+    {
+      Altimeter &altimeter = this->dataPtr->payload.emplace<Altimeter>();
+      if (_sdf->HasElement("altimeter"))
+      {
+        Errors err = altimeter.Load(_sdf->FindElement("altimeter"));
+        errors.insert(errors.end(), err.begin(), err.end());
+      }
+      break;
+    }
+    case SensorType::CAMERA:
+    case SensorType::DEPTH_CAMERA:
+    case SensorType::RGBD_CAMERA:
+    case SensorType::THERMAL_CAMERA:
+    {
+      Camera &camera = this->dataPtr->payload.emplace<Camera>();
+      if (_sdf->HasElement("camera"))
+      {
+        Errors err = camera.Load(_sdf->FindElement("camera"));
+        errors.insert(errors.end(), err.begin(), err.end());
+      }
+      break;
+    }
+    case SensorType::GPU_LIDAR:
+    case SensorType::LIDAR:
+    {
+      Lidar &lidar = this->dataPtr->payload.emplace<Lidar>();
+      if (_sdf->HasElement("lidar") || _sdf->HasElement("ray"))
+      {
+        Errors err = lidar.Load(
+            _sdf->FindElement(_sdf->HasElement("lidar") ? "lidar" : "ray"));
+        errors.insert(errors.end(), err.begin(), err.end());
+      }
+      break;
+    }
+    case SensorType::IMU:
+    {
+      Imu &imu = this->dataPtr->payload.emplace<Imu>();
+      if (_sdf->HasElement("imu"))
+      {
+        Errors err = imu.Load(_sdf->FindElement("imu"));
+        errors.insert(errors.end(), err.begin(), err.end());
+      }
+      break;
+    }
+    case SensorType::MAGNETOMETER:
+    {
+      Magnetometer &magnetometer =
+          this->dataPtr->payload.emplace<Magnetometer>();
+      if (_sdf->HasElement("magnetometer"))
+      {
+        Errors err = magnetometer.Load(
+            _sdf->FindElement("magnetometer"));
+        errors.insert(errors.end(), err.begin(), err.end());
+      }
+      break;
+    }
+    default:
+      // The other sensor types have no payload.
+      break;
+  }
 
   // Load the pose. Ignore the return value since the sensor pose is optional.
   loadPose(_sdf, this->dataPtr->pose, this->dataPtr->poseRelativeTo);
@@ -419,7 +387,7 @@ Errors Sensor::Load(ElementPtr _sdf)
 }
 
 /////////////////////////////////////////////////
-std::string Sensor::Name() const
+const std::string &Sensor::Name() const
 {
   return this->dataPtr->name;
 }
@@ -428,10 +396,11 @@ std::string Sensor::Name() const
 void Sensor::SetName(const std::string &_name)
 {
   this->dataPtr->name = _name;
+  NameIndex::NameChanged();
 }
 
 /////////////////////////////////////////////////
-std::string Sensor::Topic() const
+const std::string &Sensor::Topic() const
 {
   return this->dataPtr->topic;
 }
@@ -488,12 +457,14 @@ void Sensor::SetPoseFrame(const std::string &_frame)
 void Sensor::SetPoseRelativeTo(const std::string &_frame)
 {
   this->dataPtr->poseRelativeTo = _frame;
+  updateFrameIds(*this->dataPtr);
 }
 
 /////////////////////////////////////////////////
 void Sensor::SetXmlParentName(const std::string &_xmlParentName)
 {
   this->dataPtr->xmlParentName = _xmlParentName;
+  updateFrameIds(*this->dataPtr);
 }
 
 /////////////////////////////////////////////////
@@ -501,6 +472,7 @@ void Sensor::SetPoseRelativeToGraph(
     std::weak_ptr<const PoseRelativeToGraph> _graph)
 {
   this->dataPtr->poseRelativeToGraph = _graph;
+  updateFrameIds(*this->dataPtr);
 }
 
 /////////////////////////////////////////////////
@@ -510,7 +482,8 @@ sdf::SemanticPose Sensor::SemanticPose() const
       this->dataPtr->pose,
       this->dataPtr->poseRelativeTo,
       this->dataPtr->xmlParentName,
-      this->dataPtr->poseRelativeToGraph);
+      this->dataPtr->poseRelativeToGraph,
+      this->dataPtr->frameIds);
 }
 
 /////////////////////////////////////////////////
@@ -534,63 +507,63 @@ void Sensor::SetType(const SensorType _type)
 /////////////////////////////////////////////////
 bool Sensor::SetType(const std::string &_typeStr)
 {
-  for (size_t i = 0; i < sensorTypeStrs.size(); ++i)
+  // Only the names of TypeStr are accepted, not their aliases.
+  SensorType type = SensorType::NONE;
+  if (!kSensorTypes.Find(_typeStr, type) ||
+      kSensorTypes.Name(type) != _typeStr)
   {
-    if (_typeStr == sensorTypeStrs[i])
-    {
-      this->dataPtr->type = static_cast<SensorType>(i);
-      return true;
-    }
+    return false;
   }
-  return false;
+  this->dataPtr->type = type;
+  return true;
 }
 
 /////////////////////////////////////////////////
 const Magnetometer *Sensor::MagnetometerSensor() const
 {
-  return this->dataPtr->magnetometer.get();
+  return std::get_if<Magnetometer>(&this->dataPtr->payload);
 }
 
 /////////////////////////////////////////////////
 void Sensor::SetMagnetometerSensor(const Magnetometer &_mag)
 {
-  this->dataPtr->magnetometer = std::make_unique<Magnetometer>(_mag);
+  this->dataPtr->payload.emplace<Magnetometer>(_mag);
 }
 
 /////////////////////////////////////////////////
 const Altimeter *Sensor::AltimeterSensor() const
 {
-  return this->dataPtr->altimeter.get();
+  return std::get_if<Altimeter>(&this->dataPtr->payload);
 }
 
 /////////////////////////////////////////////////
 void Sensor::SetAltimeterSensor(const Altimeter &_alt)
 {
-  this->dataPtr->altimeter = std::make_unique<Altimeter>(_alt);
+  this->dataPtr->payload.emplace<Altimeter>(_alt);
 }
 
 /////////////////////////////////////////////////
 const AirPressure *Sensor::AirPressureSensor() const
 {
-  return this->dataPtr->airPressure.get();
+  return std::get_if<AirPressure>(&this->dataPtr->payload);
 }
 
 /////////////////////////////////////////////////
 void Sensor::SetAirPressureSensor(const AirPressure &_air)
 {
-  this->dataPtr->airPressure = std::make_unique<AirPressure>(_air);
+  this->dataPtr->payload.emplace<AirPressure>(_air);
 }
 
 /////////////////////////////////////////////////
 const Lidar *Sensor::LidarSensor() const
 {
-  return this->dataPtr->lidar.get();
+  return std::get_if<Lidar>(&this->dataPtr->payload);
 }
 
 /////////////////////////////////////////////////
 void Sensor::SetLidarSensor(const Lidar &_lidar)
 {
-  this->dataPtr->lidar = std::make_unique<Lidar>(_lidar);
+  this->dataPtr->payload.emplace<Lidar>(_lidar);
 }
 
 /////////////////////////////////////////////////
@@ -608,32 +581,30 @@ void Sensor::SetUpdateRate(double _hz)
 /////////////////////////////////////////////////
 std::string Sensor::TypeStr() const
 {
-  size_t index = static_cast<int>(this->dataPtr->type);
-  if (index > 0 && index < sensorTypeStrs.size())
-    return sensorTypeStrs[index];
-  return "none";
+  const std::string_view name = kSensorTypes.Name(this->dataPtr->type);
+  return name.empty() ? "none" : std::string(name);
 }
 
 /////////////////////////////////////////////////
 void Sensor::SetCameraSensor(const Camera &_cam)
 {
-  this->dataPtr->camera = std::make_unique<Camera>(_cam);
+  this->dataPtr->payload.emplace<Camera>(_cam);
 }
 
 /////////////////////////////////////////////////
 const Camera *Sensor::CameraSensor() const
 {
-  return this->dataPtr->camera.get();
+  return std::get_if<Camera>(&this->dataPtr->payload);
 }
 
 /////////////////////////////////////////////////
 void Sensor::SetImuSensor(const Imu &_imu)
 {
-  this->dataPtr->imu = std::make_unique<Imu>(_imu);
+  this->dataPtr->payload.emplace<Imu>(_imu);
 }
 
 /////////////////////////////////////////////////
 const Imu *Sensor::ImuSensor() const
 {
-  return this->dataPtr->imu.get();
+  return std::get_if<Imu>(&this->dataPtr->payload);
 }
@@ -16,6 +16,8 @@
 */
 
 #include <gtest/gtest.h>
+#include "sdf/Camera.hh"
+#include "sdf/Imu.hh"
 #include "sdf/Noise.hh"
 #include "sdf/Magnetometer.hh"
 #include "sdf/Sensor.hh"
@@ -302,3 +304,31 @@ TEST(DOMSensor, Type)
     EXPECT_EQ(typeStrs[i], sensor.TypeStr());
   }
 }
+
+/////////////////////////////////////////////////
+TEST(DOMSensor, ReplacePayload)
+{
+  sdf::Sensor sensor;
+  sdf::Camera cam;
+  cam.SetName("my_camera");
+  sensor.SetCameraSensor(cam);
+  ASSERT_NE(nullptr, sensor.CameraSensor());
+  EXPECT_EQ(nullptr, sensor.ImuSensor());
+
+  // Setting a payload of the same kind replaces its value.
+  cam.SetName("other_camera");
+  sensor.SetCameraSensor(cam);
+  ASSERT_NE(nullptr, sensor.CameraSensor());
+  EXPECT_EQ("other_camera", sensor.CameraSensor()->Name());
+
+  // A sensor has a single payload, so setting one of another kind replaces
+  // it. Before libsdformat 11, CameraSensor() still returned the camera.
+  sdf::Imu imu;
+  sensor.SetImuSensor(imu);
+  EXPECT_EQ(nullptr, sensor.CameraSensor());
+  EXPECT_NE(nullptr, sensor.ImuSensor());
+
+  sdf::Sensor copy(sensor);
+  EXPECT_EQ(nullptr, copy.CameraSensor());
+  EXPECT_NE(nullptr, copy.ImuSensor());
+}
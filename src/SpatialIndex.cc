@@ -0,0 +1,221 @@
+/*
+ * Copyright 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include "SpatialIndex.hh"
+
+using namespace sdf;
+
+/// \brief Maximum number of boxes in a leaf.
+static const uint32_t kLeafSize = 4;
+
+/////////////////////////////////////////////////
+/// \brief Get a component of a vector.
+/// \param[in] _v The vector.
+/// \param[in] _axis 0, 1 or 2 for x, y or z.
+/// \return The component.
+static double component(const ignition::math::Vector3d &_v, const int _axis)
+{
+  return _axis == 0 ? _v.X() : (_axis == 1 ? _v.Y() : _v.Z());
+}
+
+/////////////////////////////////////////////////
+/// \brief Check whether two boxes intersect, including when they touch.
+/// \param[in] _min1 Minimum corner of the first box.
+/// \param[in] _max1 Maximum corner of the first box.
+/// \param[in] _min2 Minimum corner of the second box.
+/// \param[in] _max2 Maximum corner of the second box.
+/// \return True if the boxes intersect.
+static bool overlap(const ignition::math::Vector3d &_min1,
+    const ignition::math::Vector3d &_max1,
+    const ignition::math::Vector3d &_min2,
+    const ignition::math::Vector3d &_max2)
+{
+  return _min1.X() <= _max2.X() && _min2.X() <= _max1.X() &&
+         _min1.Y() <= _max2.Y() && _min2.Y() <= _max1.Y() &&
+         _min1.Z() <= _max2.Z() && _min2.Z() <= _max1.Z();
+}
+
+/////////////////////////////////////////////////
+/// \brief Get the squared distance from a point to a box.
+/// \param[in] _point The point.
+/// \param[in] _min Minimum corner of the box.
+/// \param[in] _max Maximum corner of the box.
+/// \return The squared distance, which is 0 if the point is in the box.
+static double squaredDistance(const ignition::math::Vector3d &_point,
+    const ignition::math::Vector3d &_min,
+    const ignition::math::Vector3d &_max)
+{
+  double distance = 0;
+  for (int axis = 0; axis < 3; ++axis)
+  {
+    const double p = component(_point, axis);
+    const double d = std::max({component(_min, axis) - p, 0.0,
+        p - component(_max, axis)});
+    distance += d * d;
+  }
+  return distance;
+}
+
+/////////////////////////////////////////////////
+void SpatialIndex::Build(std::vector<Item> _items)
+{
+  this->items.clear();
+  this->nodes.clear();
+  this->unbounded.clear();
+  for (Item &item : _items)
+  {
+    const bool finite =
+        std::isfinite(item.min.X()) && std::isfinite(item.min.Y()) &&
+        std::isfinite(item.min.Z()) && std::isfinite(item.max.X()) &&
+        std::isfinite(item.max.Y()) && std::isfinite(item.max.Z());
+    (finite ? this->items : this->unbounded).push_back(std::move(item));
+  }
+
+  if (!this->items.empty())
+  {
+    this->nodes.reserve(2 * this->items.size() / kLeafSize + 1);
+    this->BuildNode(0, static_cast<uint32_t>(this->items.size()));
+  }
+}
+
+/////////////////////////////////////////////////
+void SpatialIndex::BuildNode(const uint32_t _begin, const uint32_t _end)
+{
+  const double inf = std::numeric_limits<double>::infinity();
+  ignition::math::Vector3d min(inf, inf, inf);
+  ignition::math::Vector3d max(-inf, -inf, -inf);
+  ignition::math::Vector3d centerMin(inf, inf, inf);
+  ignition::math::Vector3d centerMax(-inf, -inf, -inf);
+  for (uint32_t i = _begin; i < _end; ++i)
+  {
+    const Item &item = this->items[i];
+    const ignition::math::Vector3d center = (item.min + item.max) * 0.5;
+    min.Set(std::min(min.X(), item.min.X()), std::min(min.Y(), item.min.Y()),
+        std::min(min.Z(), item.min.Z()));
+    max.Set(std::max(max.X(), item.max.X()), std::max(max.Y(), item.max.Y()),
+        std::max(max.Z(), item.max.Z()));
+    centerMin.Set(std::min(centerMin.X(), center.X()),
+        std::min(centerMin.Y(), center.Y()),
+        std::min(centerMin.Z(), center.Z()));
+    centerMax.Set(std::max(centerMax.X(), center.X()),
+        std::max(centerMax.Y(), center.Y()),
+        std::max(centerMax.Z(), center.Z()));
+  }
+
+  const std::size_t nodeIndex = this->nodes.size();
+  this->nodes.push_back({min, max, _begin, _end - _begin});
+  if (_end - _begin <= kLeafSize)
+    return;
+
+  // Split at the median of the centers along the axis where they spread
+  // the most.
+  int axis = 0;
+  for (int a = 1; a < 3; ++a)
+  {
+    if (component(centerMax, a) - component(centerMin, a) >
+        component(centerMax, axis) - component(centerMin, axis))
+    {
+      axis = a;
+    }
+  }
+  const uint32_t middle = _begin + (_end - _begin) / 2;
+  std::nth_element(this->items.begin() + _begin,
+      this->items.begin() + middle, this->items.begin() + _end,
+      [axis](const Item &_a, const Item &_b)
+      {
+        return component(_a.min, axis) + component(_a.max, axis) <
+               component(_b.min, axis) + component(_b.max, axis);
+      });
+
+  this->nodes[nodeIndex].count = 0;
+  this->BuildNode(_begin, middle);
+  this->nodes[nodeIndex].first = static_cast<uint32_t>(this->nodes.size());
+  this->BuildNode(middle, _end);
+}
+
+/////////////////////////////////////////////////
+template<typename Test>
+std::vector<uint64_t> SpatialIndex::Find(const Test &_test) const
+{
+  std::vector<uint64_t> ids;
+  for (const Item &item : this->unbounded)
+  {
+    if (_test(item.min, item.max))
+      ids.push_back(item.id);
+  }
+
+  std::vector<uint32_t> stack;
+  if (!this->nodes.empty())
+    stack.push_back(0);
+  while (!stack.empty())
+  {
+    const uint32_t index = stack.back();
+    stack.pop_back();
+    const Node &node = this->nodes[index];
+    if (!_test(node.min, node.max))
+      continue;
+
+    if (node.count == 0)
+    {
+      stack.push_back(node.first);
+      stack.push_back(index + 1);
+      continue;
+    }
+    for (uint32_t i = node.first; i < node.first + node.count; ++i)
+    {
+      const Item &item = this->items[i];
+      if (_test(item.min, item.max))
+        ids.push_back(item.id);
+    }
+  }
+
+  std::sort(ids.begin(), ids.end());
+  return ids;
+}
+
+/////////////////////////////////////////////////
+std::vector<uint64_t> SpatialIndex::InBox(
+    const ignition::math::Vector3d &_min,
+    const ignition::math::Vector3d &_max) const
+{
+  return this->Find([&](const ignition::math::Vector3d &_boxMin,
+                        const ignition::math::Vector3d &_boxMax)
+      {
+        return overlap(_min, _max, _boxMin, _boxMax);
+      });
+}
+
+/////////////////////////////////////////////////
+std::vector<uint64_t> SpatialIndex::Near(
+    const ignition::math::Vector3d &_center, const double _radius) const
+{
+  if (_radius < 0)
+    return {};
+
+  const double squaredRadius = _radius * _radius;
+  return this->Find([&](const ignition::math::Vector3d &_boxMin,
+                        const ignition::math::Vector3d &_boxMax)
+      {
+        return squaredDistance(_center, _boxMin, _boxMax) <= squaredRadius;
+      });
+}
@@ -0,0 +1,116 @@
+/*
+ * Copyright 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef SDF_SPATIALINDEX_HH_
+#define SDF_SPATIALINDEX_HH_
+
+#include <cstdint>
+#include <vector>
+#include <ignition/math/Vector3.hh>
+
+#include "sdf/sdf_config.h"
+#include "sdf/system_util.hh"
+
+namespace sdf
+{
+  // Inline bracket to help doxygen filtering.
+  inline namespace SDF_VERSION_NAMESPACE {
+  //
+
+  /// \brief Bounding volume hierarchy over axis-aligned boxes, such as the
+  /// bounds of the models of a world, for finding the boxes in a region
+  /// without testing each of them. It is built once, and is read only
+  /// afterwards, so that it can be queried from several threads.
+  class SDFORMAT_VISIBLE SpatialIndex
+  {
+    /// \brief An indexed box.
+    public: struct Item
+    {
+      /// \brief Minimum corner. Components may be -infinity.
+      ignition::math::Vector3d min;
+
+      /// \brief Maximum corner. Components may be infinity.
+      ignition::math::Vector3d max;
+
+      /// \brief Identifier returned by the queries, such as an index in
+      /// World::ModelByIndex.
+      uint64_t id = 0;
+    };
+
+    /// \brief Build the hierarchy, replacing the previous one. Boxes that
+    /// are not finite, such as the bounds of a plane, are kept apart and
+    /// tested one by one.
+    /// \param[in] _items The boxes.
+    public: void Build(std::vector<Item> _items);
+
+    /// \brief Find the boxes that intersect a box.
+    /// \param[in] _min Minimum corner of the box.
+    /// \param[in] _max Maximum corner of the box.
+    /// \return Identifiers of the boxes, in increasing order.
+    public: std::vector<uint64_t> InBox(const ignition::math::Vector3d &_min,
+                const ignition::math::Vector3d &_max) const;
+
+    /// \brief Find the boxes that intersect a sphere.
+    /// \param[in] _center Center of the sphere.
+    /// \param[in] _radius Radius of the sphere.
+    /// \return Identifiers of the boxes, in increasing order.
+    public: std::vector<uint64_t> Near(
+                const ignition::math::Vector3d &_center,
+                const double _radius) const;
+
+    /// \brief Find the boxes accepted by a test of a box.
+    /// \param[in] _test Returns whether a box with given minimum and maximum
+    /// corners is in the region.
+    /// \return Identifiers of the boxes, in increasing order.
+    private: template<typename Test>
+             std::vector<uint64_t> Find(const Test &_test) const;
+
+    /// \brief A node of the hierarchy.
+    private: struct Node
+    {
+      /// \brief Minimum corner of the boxes under the node.
+      ignition::math::Vector3d min;
+
+      /// \brief Maximum corner of the boxes under the node.
+      ignition::math::Vector3d max;
+
+      /// \brief For a leaf, the index of its first box in items. Otherwise,
+      /// the index of its second child in nodes; its first child follows
+      /// it.
+      uint32_t first = 0;
+
+      /// \brief Number of boxes of a leaf, or 0 for an inner node.
+      uint32_t count = 0;
+    };
+
+    /// \brief Build the nodes over a range of items.
+    /// \param[in] _begin Index of the first item.
+    /// \param[in] _end Index past the last item.
+    private: void BuildNode(const uint32_t _begin, const uint32_t _end);
+
+    /// \brief The finite boxes, ordered so that the boxes of each leaf are
+    /// contiguous.
+    private: std::vector<Item> items;
+
+    /// \brief The nodes, with the root first, in depth-first order.
+    private: std::vector<Node> nodes;
+
+    /// \brief The boxes that are not finite.
+    private: std::vector<Item> unbounded;
+  };
+  }
+}
+#endif
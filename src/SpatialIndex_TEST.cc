@@ -0,0 +1,93 @@
+/*
+ * Copyright 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+#include <limits>
+#include <vector>
+
+#include "SpatialIndex.hh"
+
+using ignition::math::Vector3d;
+
+/////////////////////////////////////////////////
+TEST(SpatialIndex, Empty)
+{
+  sdf::SpatialIndex index;
+  EXPECT_TRUE(index.InBox(Vector3d(-1, -1, -1), Vector3d(1, 1, 1)).empty());
+  EXPECT_TRUE(index.Near(Vector3d::Zero, 10).empty());
+}
+
+/////////////////////////////////////////////////
+TEST(SpatialIndex, Grid)
+{
+  // Unit boxes centered on a 10x10 grid in the xy plane, spaced by 2.
+  std::vector<sdf::SpatialIndex::Item> items;
+  for (int i = 0; i < 10; ++i)
+  {
+    for (int j = 0; j < 10; ++j)
+    {
+      sdf::SpatialIndex::Item item;
+      item.min.Set(2 * i - 0.5, 2 * j - 0.5, -0.5);
+      item.max.Set(2 * i + 0.5, 2 * j + 0.5, 0.5);
+      item.id = 10 * i + j;
+      items.push_back(item);
+    }
+  }
+  sdf::SpatialIndex index;
+  index.Build(items);
+
+  EXPECT_EQ(std::vector<uint64_t>({0}),
+      index.InBox(Vector3d(-1, -1, -1), Vector3d(0, 0, 0)));
+  EXPECT_EQ(std::vector<uint64_t>({0, 1, 10, 11}),
+      index.InBox(Vector3d(0, 0, 0), Vector3d(2, 2, 0)));
+  EXPECT_TRUE(
+      index.InBox(Vector3d(0.6, 0.6, 0), Vector3d(1.4, 1.4, 0)).empty());
+  EXPECT_TRUE(index.InBox(Vector3d(0, 0, 1), Vector3d(2, 2, 2)).empty());
+  EXPECT_EQ(100u,
+      index.InBox(Vector3d(-100, -100, -1), Vector3d(100, 100, 1)).size());
+
+  EXPECT_EQ(std::vector<uint64_t>({55}), index.Near(Vector3d(10, 10, 0), 1));
+  EXPECT_EQ(std::vector<uint64_t>({45, 54, 55, 56, 65}),
+      index.Near(Vector3d(10, 10, 0), 1.5));
+  EXPECT_TRUE(index.Near(Vector3d(11, 11, 0), 0.5).empty());
+  EXPECT_TRUE(index.Near(Vector3d(10, 10, 0), -1).empty());
+
+  // Rebuilding replaces the boxes.
+  index.Build({items[0]});
+  EXPECT_EQ(1u,
+      index.InBox(Vector3d(-100, -100, -1), Vector3d(100, 100, 1)).size());
+}
+
+/////////////////////////////////////////////////
+TEST(SpatialIndex, Unbounded)
+{
+  const double inf = std::numeric_limits<double>::infinity();
+  std::vector<sdf::SpatialIndex::Item> items(2);
+  items[0].min.Set(-inf, -inf, -inf);
+  items[0].max.Set(inf, inf, inf);
+  items[0].id = 3;
+  items[1].min.Set(0, 0, 0);
+  items[1].max.Set(1, 1, 1);
+  items[1].id = 1;
+
+  sdf::SpatialIndex index;
+  index.Build(items);
+  EXPECT_EQ(std::vector<uint64_t>({3}),
+      index.InBox(Vector3d(5, 5, 5), Vector3d(6, 6, 6)));
+  EXPECT_EQ(std::vector<uint64_t>({1, 3}),
+      index.Near(Vector3d(0, 0, 0), 0.1));
+}
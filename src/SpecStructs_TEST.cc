@@ -0,0 +1,71 @@
+/*
+ * Copyright 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+
+#include <gtest/gtest.h>
+#include "sdf/Element.hh"
+#include "sdf/parser.hh"
+#include "SpecStructs.hh"
+
+/////////////////////////////////////////////////
+TEST(SpecStructs, Defaults)
+{
+  sdf::ElementPtr inertial(new sdf::Element);
+  ASSERT_TRUE(sdf::initFile("inertial.sdf", inertial));
+  sdf::ElementPtr inertia =
+    inertial->GetElementDescription("inertia")->Clone();
+
+  // The struct defaults are those of the description.
+  sdf::spec::InertialInertia values;
+  EXPECT_STREQ("inertia", sdf::spec::InertialInertia::kElementName);
+  EXPECT_DOUBLE_EQ(inertia->Get<double>("ixx"), values.ixx);
+  EXPECT_DOUBLE_EQ(inertia->Get<double>("ixy"), values.ixy);
+  EXPECT_DOUBLE_EQ(inertia->Get<double>("iyz"), values.iyz);
+
+  values.ixx = 5.0;
+  values.Load(inertia);
+  EXPECT_DOUBLE_EQ(inertia->Get<double>("ixx"), values.ixx);
+
+  inertia->GetElement("ixx")->Set(2.0);
+  inertia->GetElement("iyz")->Set(0.5);
+  values.Load(inertia);
+  EXPECT_DOUBLE_EQ(2.0, values.ixx);
+  EXPECT_DOUBLE_EQ(0.5, values.iyz);
+  EXPECT_DOUBLE_EQ(1.0, values.izz);
+}
+
+/////////////////////////////////////////////////
+TEST(SpecStructs, Attributes)
+{
+  sdf::ElementPtr joint(new sdf::Element);
+  ASSERT_TRUE(sdf::initFile("joint.sdf", joint));
+  sdf::ElementPtr limit = joint->GetElementDescription("axis")->
+    GetElementDescription("limit")->Clone();
+
+  sdf::spec::JointAxisLimit limitValues;
+  limitValues.Load(limit);
+  EXPECT_DOUBLE_EQ(limit->Get<double>("lower"), limitValues.lower);
+  EXPECT_DOUBLE_EQ(limit->Get<double>("effort"), limitValues.effort);
+
+  sdf::ElementPtr xyz = joint->GetElementDescription("axis")->
+    GetElementDescription("xyz")->Clone();
+  xyz->GetAttribute("expressed_in")->SetFromString("__model__");
+  sdf::spec::JointAxisXyz xyzValues;
+  EXPECT_TRUE(xyzValues.expressed_in.empty());
+  xyzValues.Load(xyz);
+  EXPECT_EQ("__model__", xyzValues.expressed_in);
+}
@@ -0,0 +1,123 @@
+/*
+ * Copyright 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "SpecVersion.hh"
+
+using namespace sdf;
+
+namespace
+{
+/// \brief Every version created so far, by name.
+struct SpecVersionTable
+{
+  /// \brief Get a version, creating it if needed. mutex must be locked.
+  /// \param[in] _version The version.
+  /// \return The version.
+  SpecVersion &Version(const std::string &_version)
+  {
+    auto &spec = this->versions[_version];
+    if (!spec)
+    {
+      spec.reset(new SpecVersion);
+      spec->version = _version;
+    }
+    return *spec;
+  }
+
+  /// \brief Guards versions.
+  std::mutex mutex;
+
+  /// \brief The versions. They are never removed.
+  std::map<std::string, std::unique_ptr<SpecVersion>> versions;
+};
+
+/// \brief Get the table of versions.
+/// \return The table.
+SpecVersionTable &specVersionTable()
+{
+  static SpecVersionTable table;
+  return table;
+}
+
+/// \brief Version used when no ScopedSpecVersion is active, or nullptr
+/// before it is first needed.
+std::atomic<const SpecVersion *> g_defaultSpecVersion{nullptr};
+
+/// \brief Version set by a ScopedSpecVersion on the calling thread.
+thread_local const SpecVersion *g_currentSpecVersion = nullptr;
+}
+
+/////////////////////////////////////////////////
+const SpecVersion &sdf::specVersion(const std::string &_version)
+{
+  SpecVersionTable &table = specVersionTable();
+  std::lock_guard<std::mutex> lock(table.mutex);
+  return table.Version(_version);
+}
+
+/////////////////////////////////////////////////
+const SpecVersion &sdf::currentSpecVersion()
+{
+  if (g_currentSpecVersion)
+    return *g_currentSpecVersion;
+
+  const SpecVersion *spec =
+      g_defaultSpecVersion.load(std::memory_order_acquire);
+  if (!spec)
+  {
+    // Threads that get here at the same time store the same version.
+    spec = &specVersion(SDF_VERSION);
+    const SpecVersion *expected = nullptr;
+    g_defaultSpecVersion.compare_exchange_strong(expected, spec,
+        std::memory_order_acq_rel);
+    spec = g_defaultSpecVersion.load(std::memory_order_acquire);
+  }
+  return *spec;
+}
+
+/////////////////////////////////////////////////
+void sdf::setDefaultSpecVersion(const std::string &_version)
+{
+  g_defaultSpecVersion.store(&specVersion(_version),
+      std::memory_order_release);
+}
+
+/////////////////////////////////////////////////
+ScopedSpecVersion::ScopedSpecVersion(const SpecVersion &_spec)
+  : previous(g_currentSpecVersion)
+{
+  g_currentSpecVersion = &_spec;
+}
+
+/////////////////////////////////////////////////
+ScopedSpecVersion::ScopedSpecVersion(const ParserConfig &_config)
+  : previous(g_currentSpecVersion)
+{
+  if (!_config.SpecVersion().empty())
+    g_currentSpecVersion = &specVersion(_config.SpecVersion());
+}
+
+/////////////////////////////////////////////////
+ScopedSpecVersion::~ScopedSpecVersion()
+{
+  g_currentSpecVersion = this->previous;
+}
@@ -0,0 +1,105 @@
+/*
+ * Copyright 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef SDF_SPECVERSION_HH_
+#define SDF_SPECVERSION_HH_
+
+#include <map>
+#include <mutex>
+#include <string>
+
+#include "sdf/ParserConfig.hh"
+#include "sdf/SDFImpl.hh"
+#include "sdf/sdf_config.h"
+
+namespace sdf
+{
+  // Inline bracket to help doxygen filtering.
+  inline namespace SDF_VERSION_NAMESPACE {
+  //
+
+  /// \brief A version of the specification that documents are read as.
+  /// Its embedded files are looked up with FindEmbeddedSdf. There is one
+  /// per version, created on first use and never destroyed, so that it can
+  /// be referred to by pointer.
+  struct SpecVersion
+  {
+    /// \brief The version, such as "1.8".
+    std::string version;
+
+    /// \brief Guards the creation of includeTemplate.
+    mutable std::once_flag includeTemplateOnce;
+
+    /// \brief The SDF that the documents read for <include> elements are
+    /// cloned from. It is built by the parser on first use, and only read
+    /// afterwards.
+    mutable SDFPtr includeTemplate;
+
+    /// \brief Guards referencedDescriptions.
+    mutable std::mutex referencedDescriptionsMutex;
+
+    /// \brief Descriptions of the spec files that elements refer to with
+    /// their ref attribute, such as "model" for nested models, by name of
+    /// the reference. Each is built by the parser on first use, and only
+    /// read afterwards.
+    mutable std::map<std::string, ElementPtr> referencedDescriptions;
+  };
+
+  /// \brief Get a version of the specification.
+  /// \param[in] _version The version.
+  /// \return The version.
+  const SpecVersion &specVersion(const std::string &_version);
+
+  /// \brief Get the version that documents are read as on the calling
+  /// thread: the one set by a ScopedSpecVersion, or else the one set with
+  /// SDF::Version.
+  /// \return The version.
+  const SpecVersion &currentSpecVersion();
+
+  /// \brief Set the version used when no ScopedSpecVersion is active.
+  /// Used for SDF::Version.
+  /// \param[in] _version The version.
+  void setDefaultSpecVersion(const std::string &_version);
+
+  /// \brief Sets the version that documents are read as on the calling
+  /// thread for its lifetime, and restores the previous version when
+  /// destroyed. Used for ParserConfig::SpecVersion.
+  class ScopedSpecVersion
+  {
+    /// \brief Constructor.
+    /// \param[in] _spec The version.
+    public: explicit ScopedSpecVersion(const SpecVersion &_spec);
+
+    /// \brief Constructor that sets the version of a parser configuration,
+    /// or keeps the current one if the configuration does not set one.
+    /// \param[in] _config The parser configuration.
+    public: explicit ScopedSpecVersion(const ParserConfig &_config);
+
+    /// \brief Copy constructor is explicitly deleted.
+    public: ScopedSpecVersion(const ScopedSpecVersion &) = delete;
+
+    /// \brief Copy assignment is explicitly deleted.
+    public: ScopedSpecVersion &operator=(const ScopedSpecVersion &) = delete;
+
+    /// \brief Destructor.
+    public: ~ScopedSpecVersion();
+
+    /// \brief The version before this object was created, or nullptr.
+    private: const SpecVersion *previous;
+  };
+  }
+}
+#endif
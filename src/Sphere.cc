@@ -15,6 +15,7 @@
  *
 */
 #include "sdf/Sphere.hh"
+#include "Utils.hh"
 
 using namespace sdf;
 
@@ -73,7 +74,7 @@ Errors Sphere::Load(ElementPtr _sdf)
 {
   Errors errors;
 
-  this->dataPtr->sdf = _sdf;
+  this->dataPtr->sdf = retainedElement(_sdf);
 
   // Check that sdf is a valid pointer
   if (!_sdf)
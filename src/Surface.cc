@@ -20,6 +20,8 @@
 #include "sdf/Types.hh"
 #include "sdf/sdf_config.h"
 #include "sdf/system_util.hh"
+#include "ElementArena.hh"
+#include "Utils.hh"
 
 using namespace sdf;
 
@@ -28,15 +30,25 @@ class sdf::ContactPrivate
   // \brief The bitmask used to filter collisions.
   public: uint16_t collideBitmask = 0xff;
 
+  /// \brief The category of the collision for filtering.
+  public: uint16_t categoryBitmask = 0xff;
+
+  /// \brief True if the category bitmask was set, instead of being that
+  /// of the collide bitmask.
+  public: bool hasCategoryBitmask = false;
+
   /// \brief The SDF element pointer used during load.
   public: sdf::ElementPtr sdf{nullptr};
 };
 
-class sdf::SurfacePrivate
+class sdf::SurfacePrivate : public ArenaAllocated
 {
   /// \brief The object storing contact parameters
   public: Contact contact;
 
+  /// \brief The friction and bounce parameters.
+  public: SurfaceParameters parameters;
+
   /// \brief The SDF element pointer used during load.
   public: sdf::ElementPtr sdf{nullptr};
 };
@@ -84,7 +96,7 @@ Errors Contact::Load(ElementPtr _sdf)
 {
   Errors errors;
 
-  this->dataPtr->sdf = _sdf;
+  this->dataPtr->sdf = retainedElement(_sdf);
 
   // Check that sdf is a valid pointer
   if (!_sdf)
@@ -111,6 +123,13 @@ Errors Contact::Load(ElementPtr _sdf)
         static_cast<uint16_t>(_sdf->Get<unsigned int>("collide_bitmask"));
   }
 
+  if (_sdf->HasElement("category_bitmask"))
+  {
+    this->dataPtr->categoryBitmask =
+        static_cast<uint16_t>(_sdf->Get<unsigned int>("category_bitmask"));
+    this->dataPtr->hasCategoryBitmask = true;
+  }
+
   return errors;
 }
 /////////////////////////////////////////////////
@@ -131,6 +150,20 @@ void Contact::SetCollideBitmask(const uint16_t _bitmask)
   this->dataPtr->collideBitmask = _bitmask;
 }
 
+/////////////////////////////////////////////////
+uint16_t Contact::CategoryBitmask() const
+{
+  return this->dataPtr->hasCategoryBitmask ?
+      this->dataPtr->categoryBitmask : this->dataPtr->collideBitmask;
+}
+
+/////////////////////////////////////////////////
+void Contact::SetCategoryBitmask(const uint16_t _bitmask)
+{
+  this->dataPtr->categoryBitmask = _bitmask;
+  this->dataPtr->hasCategoryBitmask = true;
+}
+
 /////////////////////////////////////////////////
 Surface::Surface()
   : dataPtr(new SurfacePrivate)
@@ -174,7 +207,7 @@ Errors Surface::Load(ElementPtr _sdf)
 {
   Errors errors;
 
-  this->dataPtr->sdf = _sdf;
+  this->dataPtr->sdf = retainedElement(_sdf);
 
   // Check that sdf is a valid pointer
   if (!_sdf)
@@ -197,10 +230,53 @@ Errors Surface::Load(ElementPtr _sdf)
 
   if (_sdf->HasElement("contact"))
   {
-    Errors err = this->dataPtr->contact.Load(_sdf->GetElement("contact"));
+    Errors err = this->dataPtr->contact.Load(_sdf->FindElement("contact"));
     errors.insert(errors.end(), err.begin(), err.end());
   }
 
+  SurfaceParameters &params = this->dataPtr->parameters;
+  if (_sdf->HasElement("friction"))
+  {
+    ElementPtr friction = _sdf->FindElement("friction");
+    if (friction->HasElement("ode"))
+    {
+      ElementPtr ode = friction->FindElement("ode");
+      params.mu = ode->Get<double>("mu", params.mu).first;
+      params.mu2 = ode->Get<double>("mu2", params.mu2).first;
+      params.fdir1 = ode->Get<ignition::math::Vector3d>(
+          "fdir1", params.fdir1).first;
+      params.slip1 = ode->Get<double>("slip1", params.slip1).first;
+      params.slip2 = ode->Get<double>("slip2", params.slip2).first;
+    }
+
+    if (friction->HasElement("torsional"))
+    {
+      ElementPtr torsional = friction->FindElement("torsional");
+      params.torsionalCoefficient = torsional->Get<double>(
+          "coefficient", params.torsionalCoefficient).first;
+      params.usePatchRadius = torsional->Get<bool>(
+          "use_patch_radius", params.usePatchRadius).first;
+      params.patchRadius = torsional->Get<double>(
+          "patch_radius", params.patchRadius).first;
+      params.surfaceRadius = torsional->Get<double>(
+          "surface_radius", params.surfaceRadius).first;
+      if (torsional->HasElement("ode"))
+      {
+        params.torsionalSlip = torsional->FindElement("ode")->Get<double>(
+            "slip", params.torsionalSlip).first;
+      }
+    }
+  }
+
+  if (_sdf->HasElement("bounce"))
+  {
+    ElementPtr bounce = _sdf->FindElement("bounce");
+    params.restitutionCoefficient = bounce->Get<double>(
+        "restitution_coefficient", params.restitutionCoefficient).first;
+    params.bounceThreshold = bounce->Get<double>(
+        "threshold", params.bounceThreshold).first;
+  }
+
   return errors;
 }
 /////////////////////////////////////////////////
@@ -220,3 +296,15 @@ void Surface::SetContact(const sdf::Contact &_contact)
 {
   this->dataPtr->contact = _contact;
 }
+
+/////////////////////////////////////////////////
+const SurfaceParameters &Surface::Parameters() const
+{
+  return this->dataPtr->parameters;
+}
+
+/////////////////////////////////////////////////
+void Surface::SetParameters(const SurfaceParameters &_parameters)
+{
+  this->dataPtr->parameters = _parameters;
+}
@@ -64,6 +64,26 @@ TEST(DOMsurface, CopyAssignmentAfterMove)
   EXPECT_EQ(surface1.Contact()->CollideBitmask(), 0x34);
 }
 
+/////////////////////////////////////////////////
+TEST(DOMsurface, Parameters)
+{
+  sdf::Surface surface;
+  EXPECT_DOUBLE_EQ(1.0, surface.Parameters().mu);
+  EXPECT_DOUBLE_EQ(1.0, surface.Parameters().mu2);
+  EXPECT_TRUE(surface.Parameters().usePatchRadius);
+  EXPECT_DOUBLE_EQ(0.0, surface.Parameters().restitutionCoefficient);
+  EXPECT_DOUBLE_EQ(100000.0, surface.Parameters().bounceThreshold);
+
+  sdf::SurfaceParameters params;
+  params.mu = 0.3;
+  params.restitutionCoefficient = 0.5;
+  surface.SetParameters(params);
+
+  sdf::Surface surface2(surface);
+  EXPECT_DOUBLE_EQ(0.3, surface2.Parameters().mu);
+  EXPECT_DOUBLE_EQ(0.5, surface2.Parameters().restitutionCoefficient);
+}
+
 /////////////////////////////////////////////////
 TEST(DOMcontact, DefaultConstruction)
 {
@@ -73,6 +93,22 @@ TEST(DOMcontact, DefaultConstruction)
   EXPECT_EQ(contact.Element(), nullptr);
 }
 
+/////////////////////////////////////////////////
+TEST(DOMcontact, CategoryBitmask)
+{
+  // The category follows the collide bitmask until it is set.
+  sdf::Contact contact;
+  EXPECT_EQ(0xFF, contact.CategoryBitmask());
+  contact.SetCollideBitmask(0x12);
+  EXPECT_EQ(0x12, contact.CategoryBitmask());
+  contact.SetCategoryBitmask(0x34);
+  EXPECT_EQ(0x34, contact.CategoryBitmask());
+  EXPECT_EQ(0x12, contact.CollideBitmask());
+
+  sdf::Contact copy(contact);
+  EXPECT_EQ(0x34, copy.CategoryBitmask());
+}
+
 /////////////////////////////////////////////////
 TEST(DOMcontact, CopyOperator)
 {
@@ -0,0 +1,170 @@
+/*
+ * Copyright 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+#include "TaskPool.hh"
+
+using namespace sdf;
+
+/// \brief The pool whose thread is the calling thread, if any.
+static thread_local const TaskPool *g_currentPool = nullptr;
+
+/// \brief Index of the calling thread in g_currentPool.
+static thread_local std::size_t g_currentThread = 0;
+
+/// \brief Executor set by a ScopedTaskExecutor on the calling thread.
+static thread_local std::shared_ptr<const TaskExecutor> g_taskExecutor;
+
+/////////////////////////////////////////////////
+TaskPool::TaskPool(unsigned int _threadCount)
+{
+  _threadCount = std::max(1u, _threadCount);
+  for (unsigned int i = 0; i < _threadCount; ++i)
+    this->queues.emplace_back(new Queue);
+  for (unsigned int i = 0; i < _threadCount; ++i)
+    this->threads.emplace_back(&TaskPool::Run, this, i);
+}
+
+/////////////////////////////////////////////////
+TaskPool::~TaskPool()
+{
+  {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    this->stop = true;
+  }
+  this->wake.notify_all();
+  for (std::thread &thread : this->threads)
+    thread.join();
+}
+
+/////////////////////////////////////////////////
+TaskPool &TaskPool::Default()
+{
+  static TaskPool pool(std::max(2u, std::thread::hardware_concurrency()) - 1);
+  return pool;
+}
+
+/////////////////////////////////////////////////
+unsigned int TaskPool::ThreadCount() const
+{
+  return static_cast<unsigned int>(this->threads.size());
+}
+
+/////////////////////////////////////////////////
+void TaskPool::Submit(std::function<void()> _task)
+{
+  const std::size_t index = g_currentPool == this ? g_currentThread :
+      this->nextQueue++ % this->queues.size();
+  {
+    std::lock_guard<std::mutex> lock(this->queues[index]->mutex);
+    this->queues[index]->tasks.push_back(std::move(_task));
+  }
+  {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    ++this->pending;
+  }
+  this->wake.notify_one();
+}
+
+/////////////////////////////////////////////////
+bool TaskPool::Take(std::size_t _index, std::function<void()> &_task)
+{
+  // The most recent task of the thread's own queue first, since it was
+  // submitted by the task that the thread ran last.
+  {
+    Queue &queue = *this->queues[_index];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (!queue.tasks.empty())
+    {
+      _task = std::move(queue.tasks.back());
+      queue.tasks.pop_back();
+      return true;
+    }
+  }
+
+  // Then the oldest task of another queue.
+  for (std::size_t i = 1; i < this->queues.size(); ++i)
+  {
+    Queue &queue = *this->queues[(_index + i) % this->queues.size()];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (!queue.tasks.empty())
+    {
+      _task = std::move(queue.tasks.front());
+      queue.tasks.pop_front();
+      return true;
+    }
+  }
+  return false;
+}
+
+/////////////////////////////////////////////////
+void TaskPool::Run(std::size_t _index)
+{
+  g_currentPool = this;
+  g_currentThread = _index;
+  while (true)
+  {
+    {
+      std::unique_lock<std::mutex> lock(this->mutex);
+      this->wake.wait(lock, [this]()
+      {
+        return this->pending > 0 || this->stop;
+      });
+      if (this->pending == 0)
+        return;
+      --this->pending;
+    }
+
+    // A task is counted as pending once it is queued, so one can be taken.
+    std::function<void()> task;
+    while (!this->Take(_index, task))
+      std::this_thread::yield();
+    task();
+  }
+}
+
+/////////////////////////////////////////////////
+ScopedTaskExecutor::ScopedTaskExecutor(const ParserConfig &_config)
+  : previous(g_taskExecutor)
+{
+  if (_config.Executor())
+    g_taskExecutor = std::make_shared<const TaskExecutor>(_config.Executor());
+}
+
+/////////////////////////////////////////////////
+ScopedTaskExecutor::ScopedTaskExecutor(
+    std::shared_ptr<const TaskExecutor> _executor)
+  : previous(g_taskExecutor)
+{
+  g_taskExecutor = std::move(_executor);
+}
+
+/////////////////////////////////////////////////
+ScopedTaskExecutor::~ScopedTaskExecutor()
+{
+  g_taskExecutor = std::move(this->previous);
+}
+
+/////////////////////////////////////////////////
+std::shared_ptr<const TaskExecutor> sdf::taskExecutor()
+{
+  return g_taskExecutor;
+}
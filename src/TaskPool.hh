@@ -0,0 +1,161 @@
+/*
+ * Copyright 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef SDF_TASKPOOL_HH_
+#define SDF_TASKPOOL_HH_
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "sdf/ParserConfig.hh"
+#include "sdf/sdf_config.h"
+#include "sdf/system_util.hh"
+
+namespace sdf
+{
+  // Inline bracket to help doxygen filtering.
+  inline namespace SDF_VERSION_NAMESPACE {
+  //
+
+  /// \brief Work-stealing pool of threads that runs the tasks of every
+  /// parallel stage of the library, such as prefetching includes and
+  /// loading models, so that stages that run at the same time or inside
+  /// each other share the same threads instead of each creating their own.
+  ///
+  /// Each thread has its own queue. A task submitted from a thread of the
+  /// pool goes to the queue of that thread, and the thread takes its most
+  /// recent task first. A thread without tasks takes the oldest task of
+  /// another queue. Tasks submitted from other threads are spread over the
+  /// queues.
+  class SDFORMAT_VISIBLE TaskPool
+  {
+    /// \brief Constructor that starts the threads.
+    /// \param[in] _threadCount Number of threads, at least 1.
+    public: explicit TaskPool(unsigned int _threadCount);
+
+    /// \brief Copy constructor is explicitly deleted.
+    public: TaskPool(const TaskPool &) = delete;
+
+    /// \brief Copy assignment is explicitly deleted.
+    public: TaskPool &operator=(const TaskPool &) = delete;
+
+    /// \brief Destructor. Runs the tasks that are still queued, and stops
+    /// the threads.
+    public: ~TaskPool();
+
+    /// \brief Get the pool used by parallelFor, with one thread less than
+    /// the hardware threads, since the calling thread also does work.
+    /// \return The pool.
+    public: static TaskPool &Default();
+
+    /// \brief Get the number of threads of the pool.
+    /// \return Number of threads.
+    public: unsigned int ThreadCount() const;
+
+    /// \brief Queue a task.
+    /// \param[in] _task The task. It must not throw.
+    public: void Submit(std::function<void()> _task);
+
+    /// \brief Take a task for a thread.
+    /// \param[in] _index Index of the thread.
+    /// \param[out] _task The task.
+    /// \return False if no queue has a task.
+    private: bool Take(std::size_t _index, std::function<void()> &_task);
+
+    /// \brief Run the tasks of a thread until the pool stops.
+    /// \param[in] _index Index of the thread.
+    private: void Run(std::size_t _index);
+
+    /// \brief Queue of tasks of a thread.
+    private: struct Queue
+    {
+      /// \brief Guards tasks.
+      std::mutex mutex;
+
+      /// \brief The tasks, oldest first.
+      std::deque<std::function<void()>> tasks;
+    };
+
+    /// \brief Queue of each thread.
+    private: std::vector<std::unique_ptr<Queue>> queues;
+
+    /// \brief The threads.
+    private: std::vector<std::thread> threads;
+
+    /// \brief Guards pending and stop, and is used with wake.
+    private: std::mutex mutex;
+
+    /// \brief Signaled when a task is queued or the pool stops.
+    private: std::condition_variable wake;
+
+    /// \brief Number of queued tasks that are not taken yet.
+    private: std::size_t pending = 0;
+
+    /// \brief True once the threads should stop.
+    private: bool stop = false;
+
+    /// \brief Queue that the next task from outside the pool goes to.
+    private: std::atomic<std::size_t> nextQueue{0};
+  };
+
+  /// \brief Function that runs a task on another thread, as set with
+  /// ParserConfig::SetExecutor.
+  using TaskExecutor = std::function<void(std::function<void()>)>;
+
+  /// \brief Sets the executor that parallelFor hands its tasks to on the
+  /// calling thread for its lifetime, and restores the previous one when
+  /// destroyed.
+  class ScopedTaskExecutor
+  {
+    /// \brief Constructor that sets the executor of a parser
+    /// configuration, or keeps the current one if the configuration does
+    /// not set one.
+    /// \param[in] _config The parser configuration.
+    public: explicit ScopedTaskExecutor(const ParserConfig &_config);
+
+    /// \brief Constructor that sets an executor.
+    /// \param[in] _executor The executor, or nullptr to use
+    /// TaskPool::Default.
+    public: explicit ScopedTaskExecutor(
+                std::shared_ptr<const TaskExecutor> _executor);
+
+    /// \brief Copy constructor is explicitly deleted.
+    public: ScopedTaskExecutor(const ScopedTaskExecutor &) = delete;
+
+    /// \brief Copy assignment is explicitly deleted.
+    public: ScopedTaskExecutor &operator=(const ScopedTaskExecutor &) =
+            delete;
+
+    /// \brief Destructor.
+    public: ~ScopedTaskExecutor();
+
+    /// \brief The executor before this object was created.
+    private: std::shared_ptr<const TaskExecutor> previous;
+  };
+
+  /// \brief Get the executor that parallelFor hands its tasks to on the
+  /// calling thread.
+  /// \return The executor, or nullptr to use TaskPool::Default.
+  std::shared_ptr<const TaskExecutor> taskExecutor();
+  }
+}
+#endif
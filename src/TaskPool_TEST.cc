@@ -0,0 +1,108 @@
+/*
+ * Copyright 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "TaskPool.hh"
+#include "Utils.hh"
+
+/////////////////////////////////////////////////
+TEST(TaskPool, Submit)
+{
+  std::atomic<int> count{0};
+  {
+    sdf::TaskPool pool(3);
+    EXPECT_EQ(3u, pool.ThreadCount());
+    for (int i = 0; i < 100; ++i)
+    {
+      pool.Submit([&count, &pool]()
+      {
+        // Tasks submitted by a task go to the queue of its thread.
+        pool.Submit([&count]() { ++count; });
+        ++count;
+      });
+    }
+  }
+
+  // The queued tasks are run before the pool stops.
+  EXPECT_EQ(200, count);
+}
+
+/////////////////////////////////////////////////
+TEST(TaskPool, NestedParallelFor)
+{
+  // Nested calls share the threads of the pool and do not wait for each
+  // other's tasks.
+  std::vector<std::atomic<int>> counts(20);
+  sdf::parallelFor(counts.size(), 0, [&](std::size_t _i)
+  {
+    sdf::parallelFor(50, 0, [&](std::size_t)
+    {
+      ++counts[_i];
+    });
+  });
+  for (const std::atomic<int> &count : counts)
+    EXPECT_EQ(50, count);
+
+  EXPECT_THROW(sdf::parallelFor(10, 4, [](std::size_t _i)
+  {
+    if (_i == 5)
+      throw std::runtime_error("error");
+  }), std::runtime_error);
+}
+
+/////////////////////////////////////////////////
+TEST(TaskPool, Executor)
+{
+  // An executor that runs the tasks on threads of its own.
+  std::mutex mutex;
+  std::vector<std::thread> threads;
+  std::atomic<int> tasks{0};
+  sdf::ParserConfig config;
+  config.SetExecutor([&](std::function<void()> _task)
+  {
+    ++tasks;
+    std::lock_guard<std::mutex> lock(mutex);
+    threads.emplace_back(std::move(_task));
+  });
+
+  std::atomic<int> count{0};
+  {
+    sdf::ScopedTaskExecutor executor(config);
+    ASSERT_NE(nullptr, sdf::taskExecutor());
+    sdf::parallelFor(8, 4, [&](std::size_t)
+    {
+      // Nested calls hand their tasks to the same executor.
+      EXPECT_NE(nullptr, sdf::taskExecutor());
+      sdf::parallelFor(2, 2, [&](std::size_t) { ++count; });
+    });
+  }
+  EXPECT_EQ(nullptr, sdf::taskExecutor());
+  EXPECT_EQ(16, count);
+  EXPECT_LE(3, tasks);
+
+  std::lock_guard<std::mutex> lock(mutex);
+  for (std::thread &thread : threads)
+    thread.join();
+}
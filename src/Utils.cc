@@ -14,14 +14,94 @@
  * limitations under the License.
  *
 */
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdio>
+#include <exception>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <sstream>
 #include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <unordered_map>
 #include <utility>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#endif
+
+#include "sdf/Box.hh"
+#include "sdf/Console.hh"
+#include "sdf/Cylinder.hh"
+#include "sdf/Geometry.hh"
+#include "sdf/Light.hh"
+#include "sdf/Material.hh"
+#include "sdf/Mesh.hh"
+#include "sdf/Plane.hh"
+#include "sdf/Sphere.hh"
+#include "sdf/Visual.hh"
+#include "TaskPool.hh"
 #include "Utils.hh"
 
 namespace sdf
 {
 inline namespace SDF_VERSION_NAMESPACE {
 
+/// \brief True if DOM objects loaded on this thread release their element.
+static thread_local bool g_releaseElements = false;
+
+/// \brief True if visuals loaded on this thread share identical materials.
+static thread_local bool g_shareMaterials = false;
+
+/// \brief Number of threads used to load the children of DOM objects on
+/// this thread, set by ScopedLoadThreadCount.
+static thread_local unsigned int g_loadThreadCount = 1;
+
+/// \brief Checks run by DOM objects loaded on this thread, set by
+/// ScopedValidationLevel.
+static thread_local ValidationLevel g_validationLevel = ValidationLevel::FULL;
+
+/// \brief Physics profile loaded by the worlds loaded on this thread, set
+/// by ScopedPhysicsProfile, or nullptr for every profile.
+static thread_local const std::string *g_physicsProfile = nullptr;
+
+/// \brief Configuration of the load in progress on this thread, set by
+/// ScopedParserConfig.
+static thread_local const ParserConfig *g_parserConfig = nullptr;
+
+/// \brief Stream of the messages of the checks of this thread, set by
+/// ScopedCheckOutput, or nullptr for std::cerr.
+static thread_local std::ostream *g_checkOutput = nullptr;
+
+/// \brief Error limit of this thread, set by ScopedErrorLimit.
+static thread_local ErrorLimit *g_errorLimit = nullptr;
+
+/// \brief Warning limit of this thread, set by ScopedWarningLimit.
+static thread_local WarningLimit *g_warningLimit = nullptr;
+
+/// \brief Load monitor of this thread, set by ScopedLoadMonitor.
+static thread_local const LoadMonitor *g_loadMonitor = nullptr;
+
+/// \brief Load counters of this thread, set by ScopedLoadCounters.
+static thread_local LoadCounters *g_loadCounters = nullptr;
+
+/// \brief Generation of the parameters with an update function, returned
+/// by paramUpdateGeneration. Element::Update collects its parameters at
+/// generation 0, so it starts at 1.
+static std::atomic<uint64_t> g_paramUpdateGeneration{1};
+
 /////////////////////////////////////////////////
 bool isReservedName(const std::string &_name)
 {
@@ -32,6 +112,19 @@ bool isReservedName(const std::string &_name)
        _name.compare(size-2, 2, "__") == 0);
 }
 
+/////////////////////////////////////////////////
+bool splitScopedName(const std::string &_name, std::string &_first,
+                     std::string &_rest)
+{
+  const std::size_t pos = _name.find("::");
+  if (pos == std::string::npos)
+    return false;
+
+  _first = _name.substr(0, pos);
+  _rest = _name.substr(pos + 2);
+  return true;
+}
+
 /////////////////////////////////////////////////
 bool loadName(sdf::ElementPtr _sdf, std::string &_name)
 {
@@ -50,7 +143,7 @@ bool loadPose(sdf::ElementPtr _sdf, ignition::math::Pose3d &_pose,
   if (_sdf->GetName() != "pose")
   {
     if (_sdf->HasElement("pose"))
-      sdf = _sdf->GetElement("pose");
+      sdf = _sdf->FindElement("pose");
     else
       return false;
   }
@@ -74,5 +167,1137 @@ bool loadPose(sdf::ElementPtr _sdf, ignition::math::Pose3d &_pose,
   // on the pose element value.
   return posePair.second;
 }
+
+/////////////////////////////////////////////////
+std::size_t heapBytes(const std::string &_str)
+{
+  const char *begin = reinterpret_cast<const char *>(&_str);
+  const char *data = _str.data();
+  if (data >= begin && data < begin + sizeof(_str))
+    return 0;
+  return _str.capacity() + 1;
+}
+
+/////////////////////////////////////////////////
+bool replaceFile(const std::string &_path,
+    const std::function<bool(const std::string &)> &_write)
+{
+  // The temporary file is unique, so that concurrent writers of the file
+  // do not write to the same temporary file.
+  static std::atomic<unsigned int> counter{0};
+  std::ostringstream tmpPath;
+  tmpPath << _path << ".tmp"
+          << std::chrono::steady_clock::now().time_since_epoch().count()
+          << "_" << counter++;
+  const std::string tmp = tmpPath.str();
+
+  bool replaced = _write(tmp);
+#ifndef _WIN32
+  replaced = replaced && std::rename(tmp.c_str(), _path.c_str()) == 0;
+#else
+  // std::rename fails on Windows if the file exists.
+  replaced = replaced && MoveFileExA(tmp.c_str(), _path.c_str(),
+      MOVEFILE_REPLACE_EXISTING) != 0;
+#endif
+  if (!replaced)
+    std::remove(tmp.c_str());
+  return replaced;
+}
+
+/////////////////////////////////////////////////
+void parallelFor(std::size_t _count, unsigned int _threadCount,
+    const std::function<void(std::size_t)> &_func)
+{
+  if (_threadCount == 0)
+  {
+    _threadCount = std::max(1u, std::thread::hardware_concurrency());
+  }
+  const std::size_t threadCount =
+      std::min(static_cast<std::size_t>(_threadCount), _count);
+  if (threadCount <= 1)
+  {
+    for (std::size_t i = 0; i < _count; ++i)
+    {
+      _func(i);
+    }
+    return;
+  }
+
+  // The state is shared with the tasks, since a task may only start after
+  // this call returned, in which case it finds no index left and does not
+  // call _func.
+  struct State
+  {
+    std::atomic<std::size_t> next{0};
+    std::atomic<std::size_t> done{0};
+    std::exception_ptr exception;
+    std::mutex mutex;
+    std::condition_variable finished;
+  };
+  auto state = std::make_shared<State>();
+  const std::function<void(std::size_t)> *func = &_func;
+  auto work = [state, func, _count]()
+  {
+    std::size_t done = 0;
+    for (std::size_t i = state->next++; i < _count; i = state->next++)
+    {
+      try
+      {
+        (*func)(i);
+      }
+      catch(...)
+      {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        if (!state->exception)
+          state->exception = std::current_exception();
+      }
+      ++done;
+    }
+
+    if (done > 0 && state->done.fetch_add(done) + done == _count)
+    {
+      std::lock_guard<std::mutex> lock(state->mutex);
+      state->finished.notify_all();
+    }
+  };
+
+  // The other threads come from the shared executor, so that nested and
+  // concurrent calls do not start more threads than the hardware has. The
+  // calling thread does all the work if none of them is free.
+  const std::shared_ptr<const TaskExecutor> executor = taskExecutor();
+  for (std::size_t t = 1; t < threadCount; ++t)
+  {
+    auto task = [executor, work]()
+    {
+      ScopedTaskExecutor executorScope(executor);
+      work();
+    };
+    if (executor)
+      (*executor)(task);
+    else
+      TaskPool::Default().Submit(task);
+  }
+  work();
+
+  std::unique_lock<std::mutex> lock(state->mutex);
+  state->finished.wait(lock, [&]()
+  {
+    return state->done == _count;
+  });
+
+  if (state->exception)
+  {
+    std::rethrow_exception(state->exception);
+  }
+}
+
+/////////////////////////////////////////////////
+ScopedElementRelease::ScopedElementRelease(const bool _enable)
+  : previous(g_releaseElements)
+{
+  g_releaseElements = _enable;
+}
+
+/////////////////////////////////////////////////
+ScopedElementRelease::~ScopedElementRelease()
+{
+  g_releaseElements = this->previous;
+}
+
+/////////////////////////////////////////////////
+bool releaseElements()
+{
+  return g_releaseElements;
+}
+
+/////////////////////////////////////////////////
+ElementPtr retainedElement(ElementPtr _sdf)
+{
+  return g_releaseElements ? nullptr : _sdf;
+}
+
+/////////////////////////////////////////////////
+uint64_t paramUpdateGeneration()
+{
+  return g_paramUpdateGeneration.load(std::memory_order_acquire);
+}
+
+/////////////////////////////////////////////////
+void advanceParamUpdateGeneration()
+{
+  g_paramUpdateGeneration.fetch_add(1, std::memory_order_acq_rel);
+}
+
+/////////////////////////////////////////////////
+ScopedMaterialSharing::ScopedMaterialSharing(const bool _enable)
+  : previous(g_shareMaterials)
+{
+  g_shareMaterials = _enable;
+}
+
+/////////////////////////////////////////////////
+ScopedMaterialSharing::~ScopedMaterialSharing()
+{
+  g_shareMaterials = this->previous;
+}
+
+/////////////////////////////////////////////////
+bool shareMaterials()
+{
+  return g_shareMaterials;
+}
+
+/////////////////////////////////////////////////
+ScopedLoadThreadCount::ScopedLoadThreadCount(const unsigned int _threadCount)
+  : previous(g_loadThreadCount)
+{
+  g_loadThreadCount = _threadCount;
+}
+
+/////////////////////////////////////////////////
+ScopedLoadThreadCount::~ScopedLoadThreadCount()
+{
+  g_loadThreadCount = this->previous;
+}
+
+/////////////////////////////////////////////////
+unsigned int loadThreadCount()
+{
+  return g_loadThreadCount;
+}
+
+/////////////////////////////////////////////////
+ScopedValidationLevel::ScopedValidationLevel(const ValidationLevel _level)
+  : previous(g_validationLevel)
+{
+  g_validationLevel = _level;
+}
+
+/////////////////////////////////////////////////
+ScopedValidationLevel::~ScopedValidationLevel()
+{
+  g_validationLevel = this->previous;
+}
+
+/////////////////////////////////////////////////
+ValidationLevel validationLevel()
+{
+  return g_validationLevel;
+}
+
+/////////////////////////////////////////////////
+ScopedPhysicsProfile::ScopedPhysicsProfile(const std::string &_name)
+  : previous(g_physicsProfile)
+{
+  g_physicsProfile = &_name;
+}
+
+/////////////////////////////////////////////////
+ScopedPhysicsProfile::~ScopedPhysicsProfile()
+{
+  g_physicsProfile = this->previous;
+}
+
+/////////////////////////////////////////////////
+const std::string &physicsProfile()
+{
+  static const std::string kEveryProfile;
+  return g_physicsProfile ? *g_physicsProfile : kEveryProfile;
+}
+
+/////////////////////////////////////////////////
+ScopedParserConfig::ScopedParserConfig(const ParserConfig &_config)
+  : previous(g_parserConfig)
+{
+  g_parserConfig = &_config;
+}
+
+/////////////////////////////////////////////////
+ScopedParserConfig::~ScopedParserConfig()
+{
+  g_parserConfig = this->previous;
+}
+
+/////////////////////////////////////////////////
+const ParserConfig *currentParserConfig()
+{
+  return g_parserConfig;
+}
+
+/////////////////////////////////////////////////
+ScopedCheckOutput::ScopedCheckOutput(std::ostream &_stream)
+  : previous(g_checkOutput)
+{
+  g_checkOutput = &_stream;
+}
+
+/////////////////////////////////////////////////
+ScopedCheckOutput::~ScopedCheckOutput()
+{
+  g_checkOutput = this->previous;
+}
+
+/////////////////////////////////////////////////
+std::ostream &checkOutput()
+{
+  return g_checkOutput ? *g_checkOutput : std::cerr;
+}
+
+/////////////////////////////////////////////////
+ErrorLimit::ErrorLimit(const std::size_t _max)
+  : max(_max)
+{
+}
+
+/////////////////////////////////////////////////
+void ErrorLimit::Count()
+{
+  ++this->count;
+}
+
+/////////////////////////////////////////////////
+bool ErrorLimit::Reached() const
+{
+  return this->max > 0 && this->count >= this->max;
+}
+
+/////////////////////////////////////////////////
+void ErrorLimit::Add(const std::size_t _count)
+{
+  this->count += _count;
+}
+
+/////////////////////////////////////////////////
+std::size_t ErrorLimit::Counted() const
+{
+  return this->count;
+}
+
+/////////////////////////////////////////////////
+std::size_t ErrorLimit::Max() const
+{
+  return this->max;
+}
+
+/////////////////////////////////////////////////
+ErrorLimit *ErrorLimit::Current()
+{
+  return g_errorLimit;
+}
+
+/////////////////////////////////////////////////
+ScopedErrorLimit::ScopedErrorLimit(ErrorLimit *_limit)
+  : previous(g_errorLimit)
+{
+  g_errorLimit = _limit;
+}
+
+/////////////////////////////////////////////////
+ScopedErrorLimit::~ScopedErrorLimit()
+{
+  g_errorLimit = this->previous;
+}
+
+/////////////////////////////////////////////////
+bool errorLimitReached()
+{
+  return g_errorLimit && g_errorLimit->Reached();
+}
+/////////////////////////////////////////////////
+WarningLimit::WarningLimit(const std::size_t _repeatLimit,
+    const std::size_t _siteLimit)
+  : repeatLimit(_repeatLimit), siteLimit(_siteLimit)
+{
+}
+
+/////////////////////////////////////////////////
+bool WarningLimit::Allow(const std::string &_site,
+    const std::string &_message, const bool _debug)
+{
+  std::lock_guard<std::mutex> lock(this->mutex);
+  Site &site = this->sites[_site];
+  site.debug = _debug;
+  Warning &warning = site.warnings[_message];
+  ++warning.count;
+
+  if (this->repeatLimit > 0 && warning.printed >= this->repeatLimit)
+    return false;
+  if (warning.printed == 0)
+  {
+    if (this->siteLimit > 0 && site.printed >= this->siteLimit)
+      return false;
+    ++site.printed;
+  }
+  ++warning.printed;
+  return true;
+}
+
+/////////////////////////////////////////////////
+void WarningLimit::Report() const
+{
+  std::lock_guard<std::mutex> lock(this->mutex);
+  for (const auto &site : this->sites)
+  {
+    std::size_t unprinted = 0;
+    for (const auto &warning : site.second.warnings)
+    {
+      if (warning.second.printed == 0)
+      {
+        unprinted += warning.second.count;
+        continue;
+      }
+      if (warning.second.count == warning.second.printed)
+        continue;
+
+      std::ostringstream line;
+      line << "Previous warning occurred " << warning.second.count
+           << " times: " << warning.first;
+      if (warning.first.empty() || warning.first.back() != '\n')
+        line << "\n";
+      if (site.second.debug)
+        sdfdbg << line.str();
+      else
+        sdfwarn << line.str();
+    }
+
+    if (unprinted > 0)
+    {
+      std::ostringstream line;
+      line << unprinted << " more warnings of kind [" << site.first
+           << "] were not printed.\n";
+      if (site.second.debug)
+        sdfdbg << line.str();
+      else
+        sdfwarn << line.str();
+    }
+  }
+}
+
+/////////////////////////////////////////////////
+WarningLimit *WarningLimit::Current()
+{
+  return g_warningLimit;
+}
+
+/////////////////////////////////////////////////
+ScopedWarningLimit::ScopedWarningLimit(const ParserConfig &_config)
+  : previous(g_warningLimit)
+{
+  if (!g_warningLimit &&
+      (_config.WarningRepeatLimit() > 0 || _config.WarningSiteLimit() > 0))
+  {
+    this->owned.reset(new WarningLimit(_config.WarningRepeatLimit(),
+        _config.WarningSiteLimit()));
+    g_warningLimit = this->owned.get();
+  }
+}
+
+/////////////////////////////////////////////////
+ScopedWarningLimit::ScopedWarningLimit(WarningLimit *_limit)
+  : previous(g_warningLimit)
+{
+  g_warningLimit = _limit;
+}
+
+/////////////////////////////////////////////////
+ScopedWarningLimit::~ScopedWarningLimit()
+{
+  g_warningLimit = this->previous;
+  if (this->owned)
+    this->owned->Report();
+}
+
+/////////////////////////////////////////////////
+bool warningAllowed(const std::string &_site, const std::string &_message,
+    const bool _debug)
+{
+  return !g_warningLimit || g_warningLimit->Allow(_site, _message, _debug);
+}
+
+/////////////////////////////////////////////////
+LoadMonitor::LoadMonitor(const ParserConfig &_config)
+  : progress(_config.ProgressCallback()),
+    cancel(_config.CancelCallback())
+{
+}
+
+/////////////////////////////////////////////////
+bool LoadMonitor::Reporting() const
+{
+  return static_cast<bool>(this->progress);
+}
+
+/////////////////////////////////////////////////
+void LoadMonitor::Report(const LoadProgress &_progress) const
+{
+  if (this->progress)
+    this->progress(_progress);
+}
+
+/////////////////////////////////////////////////
+bool LoadMonitor::Cancelled() const
+{
+  if (this->cancelled)
+    return true;
+  if (this->cancel && this->cancel())
+  {
+    this->cancelled = true;
+    return true;
+  }
+  return false;
+}
+
+/////////////////////////////////////////////////
+const LoadMonitor *LoadMonitor::Current()
+{
+  return g_loadMonitor;
+}
+
+/////////////////////////////////////////////////
+ScopedLoadMonitor::ScopedLoadMonitor(const LoadMonitor *_monitor)
+  : previous(g_loadMonitor)
+{
+  g_loadMonitor = _monitor;
+}
+
+/////////////////////////////////////////////////
+ScopedLoadMonitor::~ScopedLoadMonitor()
+{
+  g_loadMonitor = this->previous;
+}
+
+/////////////////////////////////////////////////
+LoadStatistics LoadCounters::Statistics() const
+{
+  auto count = [](const std::atomic<std::size_t> &_counter)
+  {
+    return _counter.load(std::memory_order_relaxed);
+  };
+  auto time = [](const std::atomic<int64_t> &_counter)
+  {
+    return std::chrono::nanoseconds(_counter.load(std::memory_order_relaxed));
+  };
+
+  LoadStatistics statistics;
+  statistics.elementsCreated = count(this->elementsCreated);
+  statistics.elementClones = count(this->elementClones);
+  statistics.paramsSet = count(this->paramsSet);
+  statistics.includesResolved = count(this->includesResolved);
+  statistics.includeCacheHits = count(this->includeCacheHits);
+  statistics.conversions = count(this->conversions);
+  statistics.findFileCalls = count(this->findFileCalls);
+  statistics.bytesRead = count(this->bytesRead);
+  statistics.readTime = time(this->readNanoseconds);
+  statistics.domLoadTime = time(this->domLoadNanoseconds);
+  statistics.parseXmlTime = time(this->parseXmlNanoseconds);
+  statistics.convertTime = time(this->convertNanoseconds);
+  return statistics;
+}
+
+/////////////////////////////////////////////////
+LoadCounters *LoadCounters::Current()
+{
+  return g_loadCounters;
+}
+
+/////////////////////////////////////////////////
+ScopedLoadCounters::ScopedLoadCounters(LoadCounters *_counters)
+  : previous(g_loadCounters)
+{
+  g_loadCounters = _counters;
+}
+
+/////////////////////////////////////////////////
+ScopedLoadCounters::~ScopedLoadCounters()
+{
+  g_loadCounters = this->previous;
+}
+
+/////////////////////////////////////////////////
+ScopedLoadTimer::ScopedLoadTimer(
+    std::atomic<int64_t> LoadCounters::*_counter)
+  : counters(g_loadCounters), counter(_counter)
+{
+  if (this->counters)
+    this->start = std::chrono::steady_clock::now();
+}
+
+/////////////////////////////////////////////////
+ScopedLoadTimer::~ScopedLoadTimer()
+{
+  if (!this->counters)
+    return;
+  const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now() - this->start);
+  (this->counters->*this->counter).fetch_add(elapsed.count(),
+      std::memory_order_relaxed);
+}
+
+/////////////////////////////////////////////////
+bool loadStopped()
+{
+  return errorLimitReached() || (g_loadMonitor && g_loadMonitor->Cancelled());
+}
+
+/////////////////////////////////////////////////
+std::size_t parallelForInOrder(const std::size_t _count,
+    const unsigned int _threadCount,
+    const std::function<bool(std::size_t)> &_func)
+{
+  ErrorLimit *limit = ErrorLimit::Current();
+  const std::size_t threadCount = _threadCount == 0 ?
+      std::max(1u, std::thread::hardware_concurrency()) : _threadCount;
+  if (threadCount == 1 || _count < 2 || loadStopped())
+  {
+    std::size_t i = 0;
+    while (i < _count && _func(i))
+      ++i;
+    return i;
+  }
+
+  // Each call has a limit of its own, so that the errors of the other
+  // calls do not change where it stops.
+  const std::size_t budget = (limit && limit->Max() > 0) ?
+      limit->Max() - limit->Counted() : 0;
+  std::vector<std::size_t> counted(_count, 0);
+  std::vector<char> done(_count, false);
+  parallelFor(_count, _threadCount, [&](std::size_t _i)
+  {
+    ErrorLimit taskLimit(budget);
+    ScopedErrorLimit errorScope(limit ? &taskLimit : nullptr);
+    done[_i] = _func(_i);
+    counted[_i] = taskLimit.Counted();
+  });
+
+  std::size_t i = 0;
+  for (; i < _count && done[i]; ++i)
+  {
+    if (limit && limit->Reached())
+      break;
+
+    // A call that reached a limit larger than what remains of the limit of
+    // the calling thread would have stopped earlier.
+    const std::size_t remaining =
+        budget > 0 ? limit->Max() - limit->Counted() : 0;
+    if (remaining < budget && counted[i] >= remaining)
+    {
+      if (!_func(i))
+        break;
+    }
+    else if (limit)
+    {
+      limit->Add(counted[i]);
+    }
+  }
+  return i;
+}
+
+/////////////////////////////////////////////////
+/// \brief The strings held by SharedString objects.
+struct SharedStringPool
+{
+  /// \brief Guards strings.
+  std::mutex mutex;
+
+  /// \brief The strings, keyed by a view of themselves. An entry is
+  /// erased by the deleter of its string.
+  std::unordered_map<std::string_view, std::weak_ptr<const std::string>>
+      strings;
+};
+
+/////////////////////////////////////////////////
+/// \brief Get the pool of the shared strings. It is never destroyed, so
+/// that shared strings can be held by static objects.
+/// \return The pool.
+static SharedStringPool &sharedStringPool()
+{
+  static SharedStringPool *pool = new SharedStringPool;
+  return *pool;
+}
+
+/////////////////////////////////////////////////
+SharedString::SharedString(const std::string &_str)
+{
+  if (_str.empty())
+    return;
+
+  SharedStringPool &pool = sharedStringPool();
+  std::lock_guard<std::mutex> lock(pool.mutex);
+  auto it = pool.strings.find(_str);
+  if (it != pool.strings.end())
+  {
+    this->str = it->second.lock();
+    if (this->str)
+      return;
+  }
+
+  // The entry of a string being released is replaced. Its deleter then
+  // finds the entry of another copy, which it leaves.
+  this->str = std::shared_ptr<const std::string>(new std::string(_str),
+      [](const std::string *_s)
+      {
+        SharedStringPool &sharedPool = sharedStringPool();
+        {
+          std::lock_guard<std::mutex> deleterLock(sharedPool.mutex);
+          auto entry = sharedPool.strings.find(*_s);
+          if (entry != sharedPool.strings.end() &&
+              entry->first.data() == _s->data())
+          {
+            sharedPool.strings.erase(entry);
+          }
+        }
+        delete _s;
+      });
+  if (it != pool.strings.end())
+    pool.strings.erase(it);
+  pool.strings.emplace(*this->str, this->str);
+}
+
+/////////////////////////////////////////////////
+const std::string &SharedString::Str() const
+{
+  static const std::string empty;
+  return this->str ? *this->str : empty;
+}
+
+/////////////////////////////////////////////////
+std::size_t SharedString::Count()
+{
+  SharedStringPool &pool = sharedStringPool();
+  std::lock_guard<std::mutex> lock(pool.mutex);
+  return pool.strings.size();
+}
+
+/////////////////////////////////////////////////
+/// \brief Number of calls to NameIndex::NameChanged.
+static std::atomic<std::uint64_t> g_nameGeneration{0};
+
+/////////////////////////////////////////////////
+void NameIndex::NameChanged()
+{
+  g_nameGeneration.fetch_add(1, std::memory_order_relaxed);
+}
+
+/////////////////////////////////////////////////
+std::uint64_t NameIndex::Generation()
+{
+  return g_nameGeneration.load(std::memory_order_relaxed);
+}
+
+/////////////////////////////////////////////////
+void CollisionFilterBuilder::Add(const uint64_t _model, const uint64_t _link,
+    const uint64_t _collision, const uint16_t _category,
+    const uint16_t _collide)
+{
+  const uint32_t key = (static_cast<uint32_t>(_category) << 16) | _collide;
+  auto inserted = this->groupIndex.emplace(key,
+      static_cast<uint32_t>(this->filter.categoryBitmasks.size()));
+  if (inserted.second)
+  {
+    this->filter.categoryBitmasks.push_back(_category);
+    this->filter.collideBitmasks.push_back(_collide);
+  }
+  this->filter.modelIndices.push_back(_model);
+  this->filter.linkIndices.push_back(_link);
+  this->filter.collisionIndices.push_back(_collision);
+  this->filter.groups.push_back(inserted.first->second);
+}
+
+/////////////////////////////////////////////////
+void CollisionFilterBuilder::Finish(CollisionFilter &_filter)
+{
+  const std::size_t groupCount = this->filter.categoryBitmasks.size();
+  const std::size_t words = this->filter.WordsPerRow();
+  const auto &categories = this->filter.categoryBitmasks;
+  const auto &collides = this->filter.collideBitmasks;
+  this->filter.matrix.assign(groupCount * words, 0);
+  for (std::size_t i = 0; i < groupCount; ++i)
+  {
+    uint64_t *row = this->filter.matrix.data() + i * words;
+    for (std::size_t j = 0; j < groupCount; ++j)
+    {
+      if ((categories[i] & collides[j]) || (categories[j] & collides[i]))
+        row[j / 64] |= uint64_t{1} << (j % 64);
+    }
+  }
+  _filter = std::move(this->filter);
+  this->filter = CollisionFilter();
+  this->groupIndex.clear();
+}
+
+/////////////////////////////////////////////////
+/// \brief Append the bytes of a value to a key.
+/// \param[in,out] _key The key.
+/// \param[in] _value The value.
+template <typename T>
+static void appendKey(std::string &_key, const T &_value)
+{
+  _key.append(reinterpret_cast<const char *>(&_value), sizeof(_value));
+}
+
+/////////////////////////////////////////////////
+/// \brief Append the components of a vector to a key.
+/// \param[in,out] _key The key.
+/// \param[in] _value The vector.
+static void appendKey(std::string &_key,
+    const ignition::math::Vector3d &_value)
+{
+  appendKey(_key, _value.X());
+  appendKey(_key, _value.Y());
+  appendKey(_key, _value.Z());
+}
+
+/////////////////////////////////////////////////
+/// \brief Append the components of a vector to a key.
+/// \param[in,out] _key The key.
+/// \param[in] _value The vector.
+static void appendKey(std::string &_key,
+    const ignition::math::Vector2d &_value)
+{
+  appendKey(_key, _value.X());
+  appendKey(_key, _value.Y());
+}
+
+/////////////////////////////////////////////////
+/// \brief Append a string and its size to a key.
+/// \param[in,out] _key The key.
+/// \param[in] _value The string.
+static void appendKey(std::string &_key, const std::string &_value)
+{
+  appendKey(_key, _value.size());
+  _key.append(_value);
+}
+
+/////////////////////////////////////////////////
+void RenderBatchBuilder::Add(const uint64_t _model, const uint64_t _link,
+    const uint64_t _index, const Visual &_visual,
+    const ignition::math::Pose3d &_pose)
+{
+  const Geometry *geometry = _visual.Geom();
+  if (geometry->Type() == GeometryType::EMPTY)
+    return;
+
+  // The key holds the values that make the visuals of a batch identical.
+  this->key.clear();
+  appendKey(this->key, geometry->Type());
+  switch (geometry->Type())
+  {
+    case GeometryType::BOX:
+      appendKey(this->key, geometry->BoxShape()->Size());
+      break;
+    case GeometryType::CYLINDER:
+      appendKey(this->key, geometry->CylinderShape()->Radius());
+      appendKey(this->key, geometry->CylinderShape()->Length());
+      break;
+    case GeometryType::PLANE:
+      appendKey(this->key, geometry->PlaneShape()->Normal());
+      appendKey(this->key, geometry->PlaneShape()->Size());
+      break;
+    case GeometryType::SPHERE:
+      appendKey(this->key, geometry->SphereShape()->Radius());
+      break;
+    case GeometryType::MESH:
+    {
+      // Meshes are identified by their resolved file, as in Root::Assets,
+      // or by their URI if it was not found.
+      const Mesh *mesh = geometry->MeshShape();
+      appendKey(this->key,
+          mesh->FilePath().empty() ? mesh->Uri() : mesh->FilePath());
+      appendKey(this->key, mesh->Submesh());
+      appendKey(this->key, mesh->CenterSubmesh());
+      appendKey(this->key, mesh->Scale());
+      break;
+    }
+    default:
+      appendKey(this->key, geometry);
+      break;
+  }
+
+  // Materials that are not shared are only the same as themselves.
+  const Material *material = _visual.Material();
+  const uint64_t materialId = _visual.MaterialId();
+  appendKey(this->key, materialId);
+  if (materialId == 0)
+    appendKey(this->key, material);
+  appendKey(this->key, _visual.CastShadows());
+  appendKey(this->key, _visual.Transparency());
+
+  auto inserted = this->batchIndex.emplace(this->key,
+      this->batches.geometries.size());
+  if (inserted.second)
+  {
+    this->batches.geometries.push_back(geometry);
+    this->batches.materials.push_back(material);
+    this->batches.castShadows.push_back(_visual.CastShadows());
+    this->batches.transparencies.push_back(_visual.Transparency());
+  }
+  this->instanceBatches.push_back(inserted.first->second);
+  this->batches.modelIndices.push_back(_model);
+  this->batches.linkIndices.push_back(_link);
+  this->batches.visualIndices.push_back(_index);
+  this->batches.poses.push_back(_pose);
+  this->batches.visibilityFlags.push_back(_visual.VisibilityFlags());
+}
+
+/////////////////////////////////////////////////
+void RenderBatchBuilder::Finish(RenderBatches &_batches)
+{
+  // Counting sort of the instances by batch, which keeps their order
+  // within each batch.
+  RenderBatches &batches = this->batches;
+  const std::size_t batchCount = batches.geometries.size();
+  batches.batchOffsets.assign(batchCount + 1, 0);
+  for (std::size_t batch : this->instanceBatches)
+    ++batches.batchOffsets[batch + 1];
+  for (std::size_t b = 0; b < batchCount; ++b)
+    batches.batchOffsets[b + 1] += batches.batchOffsets[b];
+
+  std::vector<std::size_t> next(batches.batchOffsets.begin(),
+      batches.batchOffsets.end() - 1);
+  std::vector<std::size_t> order(this->instanceBatches.size());
+  for (std::size_t i = 0; i < order.size(); ++i)
+    order[next[this->instanceBatches[i]]++] = i;
+
+  auto permute = [&order](auto &_values)
+  {
+    std::remove_reference_t<decltype(_values)> sorted;
+    sorted.reserve(order.size());
+    for (std::size_t i : order)
+      sorted.push_back(_values[i]);
+    _values = std::move(sorted);
+  };
+  permute(batches.modelIndices);
+  permute(batches.linkIndices);
+  permute(batches.visualIndices);
+  permute(batches.poses);
+  permute(batches.visibilityFlags);
+
+  _batches = std::move(batches);
+  this->batches = RenderBatches();
+  this->instanceBatches.clear();
+  this->batchIndex.clear();
+}
+
+/////////////////////////////////////////////////
+/// \brief Get the influence radius of a point or spot light, as described
+/// in LightCulling.
+/// \param[in] _light The light.
+/// \return The radius.
+static double influenceRadius(const Light &_light)
+{
+  // Attenuation below 1/256 does not change an 8-bit color.
+  constexpr double kCutoff = 256;
+  const double constant = _light.ConstantAttenuationFactor();
+  const double linear = _light.LinearAttenuationFactor();
+  const double quadratic = _light.QuadraticAttenuationFactor();
+  double distance = std::numeric_limits<double>::infinity();
+  if (constant >= kCutoff)
+  {
+    distance = 0;
+  }
+  else if (quadratic > 0)
+  {
+    distance = (-linear + std::sqrt(linear * linear +
+        4 * quadratic * (kCutoff - constant))) / (2 * quadratic);
+  }
+  else if (linear > 0)
+  {
+    distance = (kCutoff - constant) / linear;
+  }
+  return std::max(0.0, std::min(_light.AttenuationRange(), distance));
+}
+
+/////////////////////////////////////////////////
+void LightCullingBuilder::Add(const int64_t _model, const int64_t _link,
+    const uint64_t _index, const Light &_light,
+    const ignition::math::Pose3d &_pose)
+{
+  const LightType type = _light.Type();
+  ignition::math::Vector3d direction =
+      _pose.Rot().RotateVector(_light.Direction());
+  direction.Normalize();
+
+  const double radius = type == LightType::DIRECTIONAL ?
+      std::numeric_limits<double>::infinity() : influenceRadius(_light);
+  double cosInner = 1;
+  double cosOuter = -1;
+  ignition::math::Vector3d center = _pose.Pos();
+  double boundRadius = radius;
+  if (type == LightType::SPOT)
+  {
+    const double inner = std::clamp(
+        _light.SpotInnerAngle().Radian() / 2, 0.0, IGN_PI);
+    const double outer = std::clamp(
+        _light.SpotOuterAngle().Radian() / 2, 0.0, IGN_PI);
+    cosInner = std::cos(inner);
+    cosOuter = std::cos(outer);
+
+    // The smallest sphere around a cone narrower than a half space is the
+    // one through its apex and the rim of its cap for narrow cones, and the
+    // one around the rim of its cap otherwise.
+    if (std::isfinite(radius) && outer < IGN_PI / 2 &&
+        direction != ignition::math::Vector3d::Zero)
+    {
+      if (outer <= IGN_PI / 4)
+      {
+        boundRadius = radius / (2 * cosOuter);
+        center += direction * boundRadius;
+      }
+      else
+      {
+        boundRadius = radius * std::sin(outer);
+        center += direction * (radius * cosOuter);
+      }
+    }
+  }
+
+  LightCulling &c = this->culling;
+  c.types.push_back(type);
+  c.modelIndices.push_back(_model);
+  c.linkIndices.push_back(_link);
+  c.indices.push_back(_index);
+  c.poses.push_back(_pose);
+  c.directions.push_back(direction);
+  c.radii.push_back(radius);
+  c.spotCosInner.push_back(cosInner);
+  c.spotCosOuter.push_back(cosOuter);
+  c.boundCenters.push_back(center);
+  c.boundRadii.push_back(boundRadius);
+  c.castShadows.push_back(_light.CastShadows());
+}
+
+/////////////////////////////////////////////////
+void LightCullingBuilder::Finish(const double _cellSize,
+    LightCulling &_culling)
+{
+  LightCulling &c = this->culling;
+  c.cellSize = _cellSize > 0 ? _cellSize : 0;
+  c.cells.clear();
+  c.cellLights.clear();
+
+  using Cell = std::array<int32_t, 3>;
+  struct CellHash
+  {
+    std::size_t operator()(const Cell &_cell) const
+    {
+      return (static_cast<std::size_t>(static_cast<uint32_t>(_cell[0])) *
+          73856093u) ^
+          (static_cast<std::size_t>(static_cast<uint32_t>(_cell[1])) *
+          19349663u) ^
+          (static_cast<std::size_t>(static_cast<uint32_t>(_cell[2])) *
+          83492791u);
+    }
+  };
+  std::unordered_map<Cell, uint32_t, CellHash> cellIndex;
+
+  // The cell and light of each pair of a light and a cell that it
+  // overlaps, in light order.
+  std::vector<uint32_t> entryCells;
+  std::vector<uint32_t> entryLights;
+  constexpr double kMinCell = std::numeric_limits<int32_t>::min();
+  constexpr double kMaxCell = std::numeric_limits<int32_t>::max();
+  for (std::size_t i = 0; c.cellSize > 0 && i < c.types.size(); ++i)
+  {
+    const double r = c.boundRadii[i];
+    Cell lo;
+    Cell hi;
+    bool inGrid = std::isfinite(r);
+    for (int a = 0; a < 3 && inGrid; ++a)
+    {
+      const double low = std::floor((c.boundCenters[i][a] - r) / c.cellSize);
+      const double high =
+          std::floor((c.boundCenters[i][a] + r) / c.cellSize);
+      inGrid = low >= kMinCell && high <= kMaxCell;
+      lo[a] = inGrid ? static_cast<int32_t>(low) : 0;
+      hi[a] = inGrid ? static_cast<int32_t>(high) : 0;
+    }
+    if (!inGrid)
+      continue;
+
+    Cell cell;
+    for (int64_t x = lo[0]; x <= hi[0]; ++x)
+    {
+      cell[0] = static_cast<int32_t>(x);
+      for (int64_t y = lo[1]; y <= hi[1]; ++y)
+      {
+        cell[1] = static_cast<int32_t>(y);
+        for (int64_t z = lo[2]; z <= hi[2]; ++z)
+        {
+          cell[2] = static_cast<int32_t>(z);
+          auto inserted = cellIndex.emplace(cell,
+              static_cast<uint32_t>(c.cells.size()));
+          if (inserted.second)
+            c.cells.push_back(cell);
+          entryCells.push_back(inserted.first->second);
+          entryLights.push_back(static_cast<uint32_t>(i));
+        }
+      }
+    }
+  }
+
+  // Counting sort of the lights by cell, which keeps them in light order
+  // within each cell.
+  c.cellOffsets.assign(c.cells.size() + 1, 0);
+  for (uint32_t cell : entryCells)
+    ++c.cellOffsets[cell + 1];
+  for (std::size_t i = 0; i < c.cells.size(); ++i)
+    c.cellOffsets[i + 1] += c.cellOffsets[i];
+  std::vector<std::size_t> next(c.cellOffsets.begin(),
+      c.cellOffsets.end() - 1);
+  c.cellLights.resize(entryLights.size());
+  for (std::size_t i = 0; i < entryLights.size(); ++i)
+    c.cellLights[next[entryCells[i]]++] = entryLights[i];
+
+  _culling = std::move(c);
+  this->culling = LightCulling();
+}
+
+/////////////////////////////////////////////////
+void SurfaceMaterialBuilder::Add(const uint64_t _model, const uint64_t _link,
+    const uint64_t _collision, const SurfaceParameters &_parameters)
+{
+  // Adding 0 turns -0 into 0, so that equal parameters have equal keys.
+  const SurfaceParameters &p = _parameters;
+  this->key.clear();
+  for (double value : {p.mu, p.mu2, p.fdir1.X(), p.fdir1.Y(), p.fdir1.Z(),
+      p.slip1, p.slip2, p.torsionalCoefficient, p.patchRadius,
+      p.surfaceRadius, p.torsionalSlip, p.restitutionCoefficient,
+      p.bounceThreshold})
+  {
+    appendKey(this->key, value + 0.0);
+  }
+  appendKey(this->key, p.usePatchRadius);
+
+  SurfaceMaterials &m = this->materials;
+  auto inserted = this->materialIndex.emplace(this->key,
+      static_cast<uint32_t>(m.mu.size()));
+  if (inserted.second)
+  {
+    m.mu.push_back(p.mu);
+    m.mu2.push_back(p.mu2);
+    m.fdir1.push_back(p.fdir1);
+    m.slip1.push_back(p.slip1);
+    m.slip2.push_back(p.slip2);
+    m.torsionalCoefficients.push_back(p.torsionalCoefficient);
+    m.usePatchRadius.push_back(p.usePatchRadius);
+    m.patchRadii.push_back(p.patchRadius);
+    m.surfaceRadii.push_back(p.surfaceRadius);
+    m.torsionalSlips.push_back(p.torsionalSlip);
+    m.restitutionCoefficients.push_back(p.restitutionCoefficient);
+    m.bounceThresholds.push_back(p.bounceThreshold);
+  }
+  m.modelIndices.push_back(_model);
+  m.linkIndices.push_back(_link);
+  m.collisionIndices.push_back(_collision);
+  m.materials.push_back(inserted.first->second);
+}
+
+/////////////////////////////////////////////////
+void SurfaceMaterialBuilder::Finish(SurfaceMaterials &_materials)
+{
+  _materials = std::move(this->materials);
+  this->materials = SurfaceMaterials();
+  this->materialIndex.clear();
+}
 }
 }
@@ -18,11 +18,31 @@
 #define SDFORMAT_UTILS_HH
 
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
 #include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
+#include "sdf/CollisionFilter.hh"
 #include "sdf/Error.hh"
 #include "sdf/Element.hh"
+#include "sdf/LightCulling.hh"
+#include "sdf/LoadStatistics.hh"
+#include "sdf/ParserConfig.hh"
+#include "sdf/RenderBatches.hh"
+#include "sdf/Surface.hh"
+#include "sdf/SurfaceMaterials.hh"
 #include "sdf/Types.hh"
+#include "ElementArena.hh"
 
 namespace sdf
 {
@@ -30,6 +50,8 @@ namespace sdf
   inline namespace SDF_VERSION_NAMESPACE {
   //
 
+  class Visual;
+
   /// \brief Check if the passed string is a reserved name.
   /// This currently includes "world" and all strings that start
   /// and end with "__".
@@ -43,6 +65,16 @@ namespace sdf
   /// \return True when the "name" attribute exists.
   bool loadName(sdf::ElementPtr _sdf, std::string &_name);
 
+  /// \brief Split a name scoped with "::" after its first part, such as
+  /// "robot::arm::link" into "robot" and "arm::link".
+  /// \param[in] _name The scoped name.
+  /// \param[out] _first The first part of the name.
+  /// \param[out] _rest The rest of the name.
+  /// \return False if the name is not scoped, in which case the outputs
+  /// are not changed.
+  bool splitScopedName(const std::string &_name, std::string &_first,
+                       std::string &_rest);
+
   /// \brief Read a pose element from and SDF pointer, and return (via
   /// function parameters) the pose value and coordinate frame.
   /// \param[in] _sdf Pointer to an SDF element that is a pose element.
@@ -55,62 +87,758 @@ namespace sdf
   bool loadPose(sdf::ElementPtr _sdf, ignition::math::Pose3d &_pose,
                 std::string &_frame);
 
+  /// \brief Get the number of bytes that a string has allocated on the
+  /// heap, which is 0 for short strings stored in the object itself.
+  /// \param[in] _str The string.
+  /// \return Number of bytes.
+  std::size_t heapBytes(const std::string &_str);
+
+  /// \brief Release the capacity of a vector beyond its size, for
+  /// Root::Compact. The elements are moved if the storage is reallocated.
+  /// \param[in,out] _vec The vector.
+  /// \return Number of bytes released.
+  template<typename T>
+  std::size_t shrinkToFit(std::vector<T> &_vec)
+  {
+    const std::size_t capacity = _vec.capacity();
+    _vec.shrink_to_fit();
+    return (capacity - _vec.capacity()) * sizeof(T);
+  }
+
+  /// \brief Write a file to a temporary file next to it, and then replace
+  /// the file with it, so that concurrent readers of the file see either
+  /// its previous contents or its new ones, never a partial file. The file
+  /// is replaced if it exists, on every platform.
+  /// \param[in] _path Path of the file.
+  /// \param[in] _write Function that writes the contents to the path that
+  /// it is given. It returns false if the contents could not be written.
+  /// \return True if the file was replaced. The temporary file is removed
+  /// otherwise.
+  bool replaceFile(const std::string &_path,
+      const std::function<bool(const std::string &)> &_write);
+
+  /// \brief Call a function for each index in [0, _count), using up to
+  /// _threadCount threads. The calling thread is one of them, and the
+  /// others are tasks of the executor of the calling thread, which is
+  /// TaskPool::Default unless a ScopedTaskExecutor sets one. If the
+  /// function throws, the first exception is rethrown after all the
+  /// indices are done.
+  /// \param[in] _count Number of indices.
+  /// \param[in] _threadCount Maximum number of threads, or 0 for one per
+  /// hardware thread.
+  /// \param[in] _func Function to call with each index. It must be safe
+  /// to call concurrently with different indices.
+  void parallelFor(std::size_t _count, unsigned int _threadCount,
+      const std::function<void(std::size_t)> &_func);
+
+  /// \brief Makes DOM objects loaded on the calling thread release their
+  /// element for its lifetime, and restores the previous setting when
+  /// destroyed. Used for ParserConfig::ReleaseElements.
+  class ScopedElementRelease
+  {
+    /// \brief Constructor.
+    /// \param[in] _enable True if DOM objects release their element.
+    public: explicit ScopedElementRelease(bool _enable);
+
+    /// \brief Copy constructor is explicitly deleted.
+    public: ScopedElementRelease(const ScopedElementRelease &) = delete;
+
+    /// \brief Copy assignment is explicitly deleted.
+    public: ScopedElementRelease &operator=(const ScopedElementRelease &) =
+            delete;
+
+    /// \brief Destructor.
+    public: ~ScopedElementRelease();
+
+    /// \brief The setting before this object was created.
+    private: bool previous;
+  };
+
+  /// \brief Get whether DOM objects loaded on the calling thread release
+  /// their element.
+  /// \return True if a ScopedElementRelease enables it.
+  bool releaseElements();
+
+  /// \brief Get the element that a DOM object keeps for its Element
+  /// accessor once it is loaded.
+  /// \param[in] _sdf The element the object was loaded from.
+  /// \return _sdf, or nullptr if releaseElements() is true.
+  ElementPtr retainedElement(ElementPtr _sdf);
+
+  /// \brief Get the generation of the parameters that have an update
+  /// function. Element::Update reuses the parameters it collected while the
+  /// generation does not change.
+  /// \return The generation.
+  uint64_t paramUpdateGeneration();
+
+  /// \brief Change the generation of the parameters that have an update
+  /// function. Called when an update function is set, and when parameters
+  /// or elements are added to or removed from any element.
+  void advanceParamUpdateGeneration();
+
+  /// \brief Makes the visuals loaded on the calling thread share identical
+  /// materials for its lifetime, and restores the previous setting when
+  /// destroyed. Used for ParserConfig::ShareMaterials.
+  class ScopedMaterialSharing
+  {
+    /// \brief Constructor.
+    /// \param[in] _enable True if visuals share materials.
+    public: explicit ScopedMaterialSharing(bool _enable);
+
+    /// \brief Copy constructor is explicitly deleted.
+    public: ScopedMaterialSharing(const ScopedMaterialSharing &) = delete;
+
+    /// \brief Copy assignment is explicitly deleted.
+    public: ScopedMaterialSharing &operator=(const ScopedMaterialSharing &) =
+            delete;
+
+    /// \brief Destructor.
+    public: ~ScopedMaterialSharing();
+
+    /// \brief The setting before this object was created.
+    private: bool previous;
+  };
+
+  /// \brief Get whether the visuals loaded on the calling thread share
+  /// identical materials.
+  /// \return True if a ScopedMaterialSharing enables it.
+  bool shareMaterials();
+
+  /// \brief Sets the number of threads that DOM objects loaded on the
+  /// calling thread use to load their children, such as the links of a
+  /// model, for its lifetime, and restores the previous count when
+  /// destroyed. Used for ParserConfig::ModelLoadThreadCount.
+  class ScopedLoadThreadCount
+  {
+    /// \brief Constructor.
+    /// \param[in] _threadCount Number of threads, as in parallelFor.
+    public: explicit ScopedLoadThreadCount(unsigned int _threadCount);
+
+    /// \brief Copy constructor is explicitly deleted.
+    public: ScopedLoadThreadCount(const ScopedLoadThreadCount &) = delete;
+
+    /// \brief Copy assignment is explicitly deleted.
+    public: ScopedLoadThreadCount &operator=(const ScopedLoadThreadCount &) =
+            delete;
+
+    /// \brief Destructor.
+    public: ~ScopedLoadThreadCount();
+
+    /// \brief The count before this object was created.
+    private: unsigned int previous;
+  };
+
+  /// \brief Get the number of threads that DOM objects loaded on the
+  /// calling thread use to load their children.
+  /// \return Number of threads, as in parallelFor. 1 unless a
+  /// ScopedLoadThreadCount sets it.
+  unsigned int loadThreadCount();
+
+  /// \brief Sets the checks run by DOM objects loaded on the calling thread
+  /// for its lifetime, and restores the previous level when destroyed. Used
+  /// for ParserConfig::Validation.
+  class ScopedValidationLevel
+  {
+    /// \brief Constructor.
+    /// \param[in] _level The checks to run.
+    public: explicit ScopedValidationLevel(ValidationLevel _level);
+
+    /// \brief Copy constructor is explicitly deleted.
+    public: ScopedValidationLevel(const ScopedValidationLevel &) = delete;
+
+    /// \brief Copy assignment is explicitly deleted.
+    public: ScopedValidationLevel &operator=(const ScopedValidationLevel &) =
+            delete;
+
+    /// \brief Destructor.
+    public: ~ScopedValidationLevel();
+
+    /// \brief The level before this object was created.
+    private: ValidationLevel previous;
+  };
+
+  /// \brief Get the checks run by DOM objects loaded on the calling thread.
+  /// \return The validation level. ValidationLevel::FULL unless a
+  /// ScopedValidationLevel sets it.
+  ValidationLevel validationLevel();
+
+  /// \brief Sets the physics profile loaded by the worlds loaded on the
+  /// calling thread for its lifetime, and restores the previous profile
+  /// when destroyed. Used for ParserConfig::PhysicsProfile.
+  class ScopedPhysicsProfile
+  {
+    /// \brief Constructor.
+    /// \param[in] _name Name of the profile, as in
+    /// ParserConfig::SetPhysicsProfile. It must outlive this object.
+    public: explicit ScopedPhysicsProfile(const std::string &_name);
+
+    /// \brief Copy constructor is explicitly deleted.
+    public: ScopedPhysicsProfile(const ScopedPhysicsProfile &) = delete;
+
+    /// \brief Copy assignment is explicitly deleted.
+    public: ScopedPhysicsProfile &operator=(const ScopedPhysicsProfile &) =
+            delete;
+
+    /// \brief Destructor.
+    public: ~ScopedPhysicsProfile();
+
+    /// \brief The profile before this object was created.
+    private: const std::string *previous;
+  };
+
+  /// \brief Get the physics profile loaded by the worlds loaded on the
+  /// calling thread.
+  /// \return Name of the profile. Empty, for every profile, unless a
+  /// ScopedPhysicsProfile sets it.
+  const std::string &physicsProfile();
+
+  /// \brief Makes a parser configuration the one of the load in progress
+  /// on the calling thread for its lifetime, and restores the previous one
+  /// when destroyed. Functions without a configuration argument, such as
+  /// sdf::findFile, use its URI paths and callbacks.
+  class ScopedParserConfig
+  {
+    /// \brief Constructor.
+    /// \param[in] _config The configuration, which must outlive this
+    /// object.
+    public: explicit ScopedParserConfig(const ParserConfig &_config);
+
+    /// \brief Copy constructor is explicitly deleted.
+    public: ScopedParserConfig(const ScopedParserConfig &) = delete;
+
+    /// \brief Copy assignment is explicitly deleted.
+    public: ScopedParserConfig &operator=(const ScopedParserConfig &) =
+            delete;
+
+    /// \brief Destructor.
+    public: ~ScopedParserConfig();
+
+    /// \brief The configuration before this object was created.
+    private: const ParserConfig *previous;
+  };
+
+  /// \brief Choose the model file of a model directory from its config,
+  /// like getModelFilePath, without consulting the model index.
+  /// \param[in] _modelDirPath Path of the model directory.
+  /// \return Path of the model file, or an empty string on error.
+  std::string readModelFilePath(const std::string &_modelDirPath);
+
+  /// \brief Get the configuration of the load in progress on the calling
+  /// thread.
+  /// \return The configuration set by a ScopedParserConfig, or nullptr.
+  const ParserConfig *currentParserConfig();
+
+  /// \brief Makes the checks of sdf::checkRoot run on the calling thread
+  /// print their messages to a stream for its lifetime, instead of
+  /// std::cerr, and restores the previous stream when destroyed. Used to
+  /// check several files concurrently.
+  class ScopedCheckOutput
+  {
+    /// \brief Constructor.
+    /// \param[in] _stream The stream, which must outlive this object.
+    public: explicit ScopedCheckOutput(std::ostream &_stream);
+
+    /// \brief Copy constructor is explicitly deleted.
+    public: ScopedCheckOutput(const ScopedCheckOutput &) = delete;
+
+    /// \brief Copy assignment is explicitly deleted.
+    public: ScopedCheckOutput &operator=(const ScopedCheckOutput &) = delete;
+
+    /// \brief Destructor.
+    public: ~ScopedCheckOutput();
+
+    /// \brief The stream before this object was created.
+    private: std::ostream *previous;
+  };
+
+  /// \brief Get the stream that the checks run on the calling thread print
+  /// their messages to.
+  /// \return The stream. std::cerr unless a ScopedCheckOutput sets it.
+  std::ostream &checkOutput();
+
+  /// \brief Counts the errors created on the threads that use it through a
+  /// ScopedErrorLimit, so that loading can stop once there are too many.
+  /// Used for ParserConfig::MaxErrors.
+  class ErrorLimit
+  {
+    /// \brief Constructor.
+    /// \param[in] _max Number of errors after which loading stops, or 0
+    /// for no limit.
+    public: explicit ErrorLimit(std::size_t _max);
+
+    /// \brief Count one error. Called by the Error constructor.
+    public: void Count();
+
+    /// \brief Count errors that were counted by another limit, such as the
+    /// limits of the tasks of parallelForInOrder.
+    /// \param[in] _count Number of errors.
+    public: void Add(std::size_t _count);
+
+    /// \brief Get the number of errors counted.
+    /// \return Number of errors.
+    public: std::size_t Counted() const;
+
+    /// \brief Get the number of errors after which loading stops.
+    /// \return The limit, or 0 for no limit.
+    public: std::size_t Max() const;
+
+    /// \brief Get whether the limit is reached.
+    /// \return True if there is a limit and as many errors were counted.
+    public: bool Reached() const;
+
+    /// \brief Get the limit used by the calling thread.
+    /// \return The limit, or nullptr if no ScopedErrorLimit sets one.
+    public: static ErrorLimit *Current();
+
+    /// \brief Number of errors after which loading stops, or 0.
+    private: std::size_t max;
+
+    /// \brief Number of errors counted, from any thread.
+    private: std::atomic<std::size_t> count{0};
+  };
+
+  /// \brief Makes the errors created on the calling thread count towards
+  /// an ErrorLimit for its lifetime, and restores the previous limit when
+  /// destroyed.
+  class ScopedErrorLimit
+  {
+    /// \brief Constructor.
+    /// \param[in] _limit The limit, or nullptr for none.
+    public: explicit ScopedErrorLimit(ErrorLimit *_limit);
+
+    /// \brief Copy constructor is explicitly deleted.
+    public: ScopedErrorLimit(const ScopedErrorLimit &) = delete;
+
+    /// \brief Copy assignment is explicitly deleted.
+    public: ScopedErrorLimit &operator=(const ScopedErrorLimit &) = delete;
+
+    /// \brief Destructor.
+    public: ~ScopedErrorLimit();
+
+    /// \brief The limit before this object was created.
+    private: ErrorLimit *previous;
+  };
+
+  /// \brief Get whether the error limit of the calling thread is reached,
+  /// in which case DOM objects that are not loaded yet are skipped.
+  /// \return True if a ScopedErrorLimit sets a limit that is reached.
+  bool errorLimitReached();
+
+  /// \brief Deduplicates the warnings printed while reading files on the
+  /// threads that use it through a ScopedWarningLimit, so that a warning
+  /// repeated for every copy of an element is printed a few times, followed
+  /// by a single line with the number of occurrences. Used for
+  /// ParserConfig::WarningRepeatLimit and ParserConfig::WarningSiteLimit.
+  class WarningLimit
+  {
+    /// \brief Constructor.
+    /// \param[in] _repeatLimit Number of times each warning is printed, or
+    /// 0 for no limit.
+    /// \param[in] _siteLimit Number of different warnings printed by each
+    /// site, or 0 for no limit.
+    public: WarningLimit(std::size_t _repeatLimit, std::size_t _siteLimit);
+
+    /// \brief Count one occurrence of a warning, and get whether to print
+    /// it.
+    /// \param[in] _site Name of the code that prints the warning, such as
+    /// "unknown attribute".
+    /// \param[in] _message The warning.
+    /// \param[in] _debug True if the warning is printed with sdfdbg rather
+    /// than sdfwarn.
+    /// \return True if the warning is within the limits.
+    public: bool Allow(const std::string &_site, const std::string &_message,
+                       bool _debug);
+
+    /// \brief Print one line for each warning that occurred more often than
+    /// it was printed, with the number of occurrences, and one line for
+    /// each site with warnings that were never printed.
+    public: void Report() const;
+
+    /// \brief Get the limit used by the calling thread.
+    /// \return The limit, or nullptr if no ScopedWarningLimit sets one.
+    public: static WarningLimit *Current();
+
+    /// \brief Occurrences of a warning.
+    private: struct Warning
+    {
+      /// \brief Number of occurrences.
+      std::size_t count = 0;
+
+      /// \brief Number of times it was printed.
+      std::size_t printed = 0;
+    };
+
+    /// \brief Warnings of a site.
+    private: struct Site
+    {
+      /// \brief True if the warnings are printed with sdfdbg.
+      bool debug = false;
+
+      /// \brief Number of different warnings that were printed.
+      std::size_t printed = 0;
+
+      /// \brief Occurrences of each warning.
+      std::map<std::string, Warning> warnings;
+    };
+
+    /// \brief Number of times each warning is printed, or 0.
+    private: std::size_t repeatLimit;
+
+    /// \brief Number of different warnings printed by each site, or 0.
+    private: std::size_t siteLimit;
+
+    /// \brief Warnings of each site.
+    private: std::map<std::string, Site> sites;
+
+    /// \brief Mutex protecting sites.
+    private: mutable std::mutex mutex;
+  };
+
+  /// \brief Makes the warnings printed on the calling thread count towards
+  /// a WarningLimit for its lifetime, and restores the previous limit when
+  /// destroyed.
+  class ScopedWarningLimit
+  {
+    /// \brief Constructor that uses the limit of the calling thread, if
+    /// any, so that the warnings of nested reads are deduplicated together.
+    /// Otherwise, a limit is created from the configuration, and reported
+    /// when this object is destroyed.
+    /// \param[in] _config The configuration whose limits are used.
+    public: explicit ScopedWarningLimit(const ParserConfig &_config);
+
+    /// \brief Constructor that uses the limit of another thread.
+    /// \param[in] _limit The limit, or nullptr for none.
+    public: explicit ScopedWarningLimit(WarningLimit *_limit);
+
+    /// \brief Copy constructor is explicitly deleted.
+    public: ScopedWarningLimit(const ScopedWarningLimit &) = delete;
+
+    /// \brief Copy assignment is explicitly deleted.
+    public: ScopedWarningLimit &operator=(const ScopedWarningLimit &) =
+            delete;
+
+    /// \brief Destructor.
+    public: ~ScopedWarningLimit();
+
+    /// \brief The limit created by this object, if any.
+    private: std::unique_ptr<WarningLimit> owned;
+
+    /// \brief The limit before this object was created.
+    private: WarningLimit *previous;
+  };
+
+  /// \brief Count one occurrence of a warning towards the warning limit of
+  /// the calling thread, and get whether to print it.
+  /// \param[in] _site Name of the code that prints the warning.
+  /// \param[in] _message The warning.
+  /// \param[in] _debug True if the warning is printed with sdfdbg.
+  /// \return True if no ScopedWarningLimit sets a limit, or the warning is
+  /// within the limit.
+  bool warningAllowed(const std::string &_site, const std::string &_message,
+                      bool _debug = false);
+
+  /// \brief Reports the progress of the DOM objects loaded on the threads
+  /// that use it through a ScopedLoadMonitor, and tells them whether the
+  /// load was cancelled. Used for ParserConfig::ProgressCallback and
+  /// ParserConfig::CancelCallback.
+  class LoadMonitor
+  {
+    /// \brief Constructor.
+    /// \param[in] _config The configuration whose callbacks are used.
+    public: explicit LoadMonitor(const ParserConfig &_config);
+
+    /// \brief Get whether there is a progress callback, so that callers
+    /// only build a LoadProgress when it is used.
+    /// \return True if Report calls a callback.
+    public: bool Reporting() const;
+
+    /// \brief Call the progress callback, if any.
+    /// \param[in] _progress The step of the load.
+    public: void Report(const LoadProgress &_progress) const;
+
+    /// \brief Get whether the load was cancelled. Once the cancel callback
+    /// returns true, this returns true without calling it again.
+    /// \return True if the cancel callback returned true.
+    public: bool Cancelled() const;
+
+    /// \brief Get the monitor used by the calling thread.
+    /// \return The monitor, or nullptr if no ScopedLoadMonitor sets one.
+    public: static const LoadMonitor *Current();
+
+    /// \brief The progress callback.
+    private: std::function<void(const LoadProgress &)> progress;
+
+    /// \brief The cancel callback.
+    private: std::function<bool()> cancel;
+
+    /// \brief True once the cancel callback returned true.
+    private: mutable std::atomic<bool> cancelled{false};
+  };
+
+  /// \brief Makes the DOM objects loaded on the calling thread use a
+  /// LoadMonitor for its lifetime, and restores the previous monitor when
+  /// destroyed.
+  class ScopedLoadMonitor
+  {
+    /// \brief Constructor.
+    /// \param[in] _monitor The monitor, or nullptr for none.
+    public: explicit ScopedLoadMonitor(const LoadMonitor *_monitor);
+
+    /// \brief Copy constructor is explicitly deleted.
+    public: ScopedLoadMonitor(const ScopedLoadMonitor &) = delete;
+
+    /// \brief Copy assignment is explicitly deleted.
+    public: ScopedLoadMonitor &operator=(const ScopedLoadMonitor &) = delete;
+
+    /// \brief Destructor.
+    public: ~ScopedLoadMonitor();
+
+    /// \brief The monitor before this object was created.
+    private: const LoadMonitor *previous;
+  };
+
+  /// \brief Counters of the work of the loads that use them through a
+  /// ScopedLoadCounters, shared by the threads of a load. Used for
+  /// Root::LoadStatistics. The counters are relaxed atomics, so counting
+  /// costs an uncontended increment when there are counters and a thread
+  /// local read otherwise.
+  struct LoadCounters
+  {
+    /// \brief See LoadStatistics::elementsCreated.
+    std::atomic<std::size_t> elementsCreated{0};
+
+    /// \brief See LoadStatistics::elementClones.
+    std::atomic<std::size_t> elementClones{0};
+
+    /// \brief See LoadStatistics::paramsSet.
+    std::atomic<std::size_t> paramsSet{0};
+
+    /// \brief See LoadStatistics::includesResolved.
+    std::atomic<std::size_t> includesResolved{0};
+
+    /// \brief See LoadStatistics::includeCacheHits.
+    std::atomic<std::size_t> includeCacheHits{0};
+
+    /// \brief See LoadStatistics::conversions.
+    std::atomic<std::size_t> conversions{0};
+
+    /// \brief See LoadStatistics::findFileCalls.
+    std::atomic<std::size_t> findFileCalls{0};
+
+    /// \brief See LoadStatistics::bytesRead.
+    std::atomic<std::size_t> bytesRead{0};
+
+    /// \brief See LoadStatistics::readTime, in nanoseconds.
+    std::atomic<int64_t> readNanoseconds{0};
+
+    /// \brief See LoadStatistics::domLoadTime, in nanoseconds.
+    std::atomic<int64_t> domLoadNanoseconds{0};
+
+    /// \brief See LoadStatistics::parseXmlTime, in nanoseconds.
+    std::atomic<int64_t> parseXmlNanoseconds{0};
+
+    /// \brief See LoadStatistics::convertTime, in nanoseconds.
+    std::atomic<int64_t> convertNanoseconds{0};
+
+    /// \brief Get the statistics counted so far.
+    /// \return The statistics.
+    LoadStatistics Statistics() const;
+
+    /// \brief Get the counters used by the calling thread.
+    /// \return The counters, or nullptr if no ScopedLoadCounters sets any.
+    static LoadCounters *Current();
+
+    /// \brief Add to a counter of the calling thread, if it has counters.
+    /// \param[in] _counter The counter, such as &LoadCounters::paramsSet.
+    /// \param[in] _count Amount to add.
+    static void Add(std::atomic<std::size_t> LoadCounters::*_counter,
+                    std::size_t _count = 1)
+    {
+      if (LoadCounters *counters = Current())
+        (counters->*_counter).fetch_add(_count, std::memory_order_relaxed);
+    }
+  };
+
+  /// \brief Makes the loads on the calling thread count their work in
+  /// LoadCounters for its lifetime, and restores the previous counters
+  /// when destroyed.
+  class ScopedLoadCounters
+  {
+    /// \brief Constructor.
+    /// \param[in] _counters The counters, or nullptr for none.
+    public: explicit ScopedLoadCounters(LoadCounters *_counters);
+
+    /// \brief Copy constructor is explicitly deleted.
+    public: ScopedLoadCounters(const ScopedLoadCounters &) = delete;
+
+    /// \brief Copy assignment is explicitly deleted.
+    public: ScopedLoadCounters &operator=(const ScopedLoadCounters &) =
+            delete;
+
+    /// \brief Destructor.
+    public: ~ScopedLoadCounters();
+
+    /// \brief The counters before this object was created.
+    private: LoadCounters *previous;
+  };
+
+  /// \brief Adds the time of its lifetime to a time counter of the
+  /// LoadCounters of the calling thread, if it has counters.
+  class ScopedLoadTimer
+  {
+    /// \brief Constructor.
+    /// \param[in] _counter The counter, such as
+    /// &LoadCounters::parseXmlNanoseconds.
+    public: explicit ScopedLoadTimer(
+                std::atomic<int64_t> LoadCounters::*_counter);
+
+    /// \brief Copy constructor is explicitly deleted.
+    public: ScopedLoadTimer(const ScopedLoadTimer &) = delete;
+
+    /// \brief Copy assignment is explicitly deleted.
+    public: ScopedLoadTimer &operator=(const ScopedLoadTimer &) = delete;
+
+    /// \brief Destructor, which adds the time to the counter.
+    public: ~ScopedLoadTimer();
+
+    /// \brief The counters, or nullptr if the time is not counted.
+    private: LoadCounters *counters;
+
+    /// \brief The counter.
+    private: std::atomic<int64_t> LoadCounters::*counter;
+
+    /// \brief When this object was created.
+    private: std::chrono::steady_clock::time_point start;
+  };
+
+  /// \brief Get whether DOM objects that are not loaded yet on the calling
+  /// thread are skipped, because the error limit is reached or the load
+  /// was cancelled.
+  /// \return True if loading stopped.
+  bool loadStopped();
+
+  /// \brief Call a function for each index in [0, _count) as parallelFor
+  /// does, such that the errors of the calls and the calls that are skipped
+  /// are the same as when they are made one after the other in the order of
+  /// the indices, which is the document order of the objects they load.
+  ///
+  /// With more than one thread, each call counts its errors towards an
+  /// ErrorLimit of its own, whose limit is what remained of the limit of
+  /// the calling thread before the first call. A call thus stops at the
+  /// same point whatever the other calls do, and the errors it keeps are
+  /// bounded by that limit. The counts are then added to the limit of the
+  /// calling thread in the order of the indices. The calls after the one at
+  /// which the limit is reached are dropped, and that call is made again on
+  /// the calling thread if the calls before it used part of the limit, since
+  /// it would have stopped earlier. The function must therefore replace the
+  /// results of an index when called again, and keep its errors per index
+  /// so that the caller merges them in order.
+  /// \param[in] _count Number of indices.
+  /// \param[in] _threadCount Maximum number of threads, as in parallelFor.
+  /// \param[in] _func Function to call with each index. It returns false if
+  /// it skipped the index because loadStopped() returned true.
+  /// \return Number of indices whose results are kept. The calls of the
+  /// following indices were skipped or dropped.
+  std::size_t parallelForInOrder(std::size_t _count, unsigned int _threadCount,
+      const std::function<bool(std::size_t)> &_func);
+
   /// \brief Load all objects of a specific sdf element type. No error
   /// is returned if an element is not present. This function assumes that
-  /// an element has a "name" attribute that must be unique.
+  /// an element has a "name" attribute that must be unique, which the Load
+  /// function of the objects reads into their Name().
   /// \param[in] _sdf The SDF element that contains zero or more elements.
   /// \param[in] _sdfName Name of the sdf element, such as "model".
   /// \param[out] _objs Elements that match _sdfName in _sdf are added to this
   /// vector, unless an error is encountered during load or a duplicate name
   /// exists.
+  /// \param[in] _threadCount Number of threads used to load the objects, as
+  /// in parallelFor. The objects must only access their own elements while
+  /// loading if it is not 1. Objects loaded concurrently load their own
+  /// children on one thread, so that the threads are not multiplied at each
+  /// level. Once the error limit is reached or the load is cancelled, the
+  /// objects that are not loaded yet are skipped, and only the objects
+  /// before the first skipped one are added. The objects and errors are
+  /// those of a load on one thread, see parallelForInOrder, unless the load
+  /// is cancelled.
   /// \return The vector of errors. An empty vector indicates no errors were
   /// experienced.
   template<typename Class>
   sdf::Errors loadUniqueRepeated(sdf::ElementPtr _sdf,
-      const std::string &_sdfName, std::vector<Class> &_objs)
+      const std::string &_sdfName, std::vector<Class> &_objs,
+      unsigned int _threadCount = 1)
   {
     Errors errors;
 
-    std::vector<std::string> names;
-
     // Check that an element exists.
     if (_sdf->HasElement(_sdfName))
     {
       // Read all the elements.
-      sdf::ElementPtr elem = _sdf->GetElement(_sdfName);
-      while (elem)
-      {
-        Class obj;
+      std::vector<sdf::ElementPtr> elems;
+      for (const sdf::ElementPtr &elem : _sdf->Children(_sdfName))
+        elems.push_back(elem);
 
-        // Load the model and capture the errors.
-        Errors loadErrors = obj.Load(elem);
+      // Hashed, so that checking the names of many objects stays linear.
+      // The views refer to the names of the loaded objects, which stay in
+      // place when the objects are moved since they are in their private
+      // data.
+      std::unordered_set<std::string_view> names;
+      names.reserve(elems.size());
 
+      // Load the objects and capture the errors.
+      std::vector<Class> objs(elems.size());
+      std::vector<Errors> loadErrors(elems.size());
+      std::vector<char> started(elems.size(), false);
+      const bool release = releaseElements();
+      const bool share = shareMaterials();
+      const bool arena = ElementArena::Current() != nullptr;
+      const unsigned int childThreadCount =
+          (_threadCount != 1 && elems.size() > 1) ? 1 : loadThreadCount();
+      const LoadMonitor *monitor = LoadMonitor::Current();
+      LoadCounters *counters = LoadCounters::Current();
+      const ValidationLevel validation = validationLevel();
+      const std::size_t loaded = parallelForInOrder(elems.size(),
+          _threadCount, [&](std::size_t _i)
+      {
+        ScopedElementRelease scope(release);
+        ScopedMaterialSharing materialScope(share);
+        ScopedElementArena arenaScope(arena);
+        ScopedLoadThreadCount threads(childThreadCount);
+        ScopedLoadMonitor monitorScope(monitor);
+        ScopedLoadCounters countersScope(counters);
+        ScopedValidationLevel validationScope(validation);
+        if (loadStopped())
+          return false;
+        // An object loaded again starts from scratch.
+        if (started[_i])
+          objs[_i] = Class();
+        started[_i] = true;
+        loadErrors[_i] = objs[_i].Load(elems[_i]);
+        return true;
+      });
+
+      _objs.reserve(_objs.size() + loaded);
+      for (std::size_t i = 0; i < loaded; ++i)
+      {
         // keep processing even if there are loadErrors
-        {
-          std::string name;
-
-          // Read the name for uniqueness checks. Don't report errors here.
-          // Errors are captured in obj.Load(elem) above.
-          sdf::loadName(elem, name);
-
-          // Check that the name does not exist.
-          if (std::find(names.begin(), names.end(), name) != names.end())
-          {
-            errors.push_back({ErrorCode::DUPLICATE_NAME,
-                _sdfName + " with name[" + name + "] already exists."});
-          }
-          else
-          {
-            // Add the object to the result if no errors have been encountered.
-            _objs.push_back(std::move(obj));
-            names.push_back(name);
-          }
+        // The name for uniqueness checks was read by obj.Load(elem) above,
+        // which also reported its errors.
+        const std::string &name = objs[i].Name();
 
-          // Add the load errors to the master error list.
-          errors.insert(errors.end(), loadErrors.begin(), loadErrors.end());
+        // Check that the name does not exist.
+        if (!names.insert(name).second)
+        {
+          errors.push_back({ErrorCode::DUPLICATE_NAME,
+              _sdfName + " with name[" + name + "] already exists."});
+        }
+        else
+        {
+          // Add the object to the result if no errors have been encountered.
+          _objs.push_back(std::move(objs[i]));
         }
 
-        elem = elem->GetNextElement(_sdfName);
+        // Add the load errors to the master error list.
+        errors.insert(errors.end(), loadErrors[i].begin(),
+            loadErrors[i].end());
       }
     }
     // Do not add an error if the model tag is missing. This is an internal
@@ -138,8 +866,7 @@ namespace sdf
     if (_sdf->HasElement(_sdfName))
     {
       // Read all the elements.
-      sdf::ElementPtr elem = _sdf->GetElement(_sdfName);
-      while (elem)
+      for (const sdf::ElementPtr &elem : _sdf->Children(_sdfName))
       {
         Class obj;
 
@@ -153,8 +880,6 @@ namespace sdf
           // but keep object anyway
           _objs.push_back(std::move(obj));
         }
-
-        elem = elem->GetNextElement(_sdfName);
       }
     }
     // Do not add an error if the model tag is missing. This is an internal
@@ -163,6 +888,318 @@ namespace sdf
 
     return errors;
   }
+
+  /// \brief A string shared by the objects that hold equal strings, such
+  /// as the file names of the animations of a crowd of actors, so that it
+  /// is stored once and copied cheaply. Unlike InternedString, whose table
+  /// only grows and is meant for the vocabulary of the specification, a
+  /// string is released once no object holds it, so that the paths and
+  /// names read from many files do not accumulate.
+  class SharedString
+  {
+    /// \brief Constructor for the empty string.
+    public: SharedString() = default;
+
+    /// \brief Constructor, which shares the copy of an equal string held
+    /// by other objects, or makes one.
+    /// \param[in] _str The string.
+    // cppcheck-suppress noExplicitConstructor
+    public: SharedString(const std::string &_str);
+
+    /// \brief Get the string.
+    /// \return The shared copy of the string.
+    public: const std::string &Str() const;
+
+    /// \brief Get the string.
+    /// \return The shared copy of the string.
+    public: operator const std::string &() const
+    {
+      return this->Str();
+    }
+
+    /// \brief Get the number of distinct strings held.
+    /// \return Number of strings.
+    public: static std::size_t Count();
+
+    /// \brief The shared copy, or nullptr for the empty string.
+    private: std::shared_ptr<const std::string> str;
+  };
+
+  /// \brief Index from the names of DOM objects to their position in the
+  /// vector that holds them, so that they are found by name in constant
+  /// time. If several objects have the same name, the first one is found,
+  /// as with a linear search. The index must be rebuilt or extended
+  /// whenever the vector changes.
+  ///
+  /// The names of the objects can be changed through the non-const getters
+  /// of their parent, which do not know the index. The SetName functions of
+  /// the indexed objects call NameChanged, and an index built before falls
+  /// back to a linear search for the names that it does not find, until it
+  /// is rebuilt by Build, or by AddLast or Erase, which rebuild it then.
+  ///
+  /// The index maps the hash of each name to positions, and compares the
+  /// name of the objects at these positions, so that names are found from a
+  /// std::string_view without building a std::string, which
+  /// std::unordered_map cannot do before C++20.
+  class NameIndex
+  {
+    /// \brief Rebuild the index from all the objects of a vector.
+    /// \param[in] _objs The objects.
+    public: template<typename Class>
+            void Build(const std::vector<Class> &_objs)
+    {
+      this->generation = Generation();
+      this->indices.clear();
+      this->indices.reserve(_objs.size());
+      for (std::size_t i = 0; i < _objs.size(); ++i)
+        this->Add(_objs, i);
+    }
+
+    /// \brief Add the last object of a vector to the index, after it was
+    /// appended.
+    /// \param[in] _objs The objects.
+    public: template<typename Class>
+            void AddLast(const std::vector<Class> &_objs)
+    {
+      if (this->generation != Generation())
+        this->Build(_objs);
+      else
+        this->Add(_objs, _objs.size() - 1);
+    }
+
+    /// \brief Erase an object from a vector and from the index. The
+    /// positions of the objects that followed it are shifted, which takes
+    /// linear time but does not hash any name.
+    /// \param[in,out] _objs The objects that the index was built from.
+    /// \param[in] _pos Position of the object to erase.
+    public: template<typename Class>
+            void Erase(std::vector<Class> &_objs, const std::size_t _pos)
+    {
+      const std::string name = _objs[_pos].Name();
+      _objs.erase(_objs.begin() + static_cast<std::ptrdiff_t>(_pos));
+      if (this->generation != Generation())
+      {
+        this->Build(_objs);
+        return;
+      }
+
+      for (auto iter = this->indices.begin(); iter != this->indices.end();)
+      {
+        if (iter->second == _pos)
+        {
+          iter = this->indices.erase(iter);
+          continue;
+        }
+        if (iter->second > _pos)
+          --iter->second;
+        ++iter;
+      }
+
+      // Another object with the same name is found from now on, as with a
+      // linear search.
+      for (std::size_t i = 0; i < _objs.size(); ++i)
+      {
+        if (_objs[i].Name() == name)
+        {
+          this->Add(_objs, i);
+          break;
+        }
+      }
+    }
+
+    /// \brief Find an object by name.
+    /// \param[in] _objs The objects that the index was built from.
+    /// \param[in] _name Name of the object.
+    /// \return The object, or nullptr if there is none with the name.
+    public: template<typename Class>
+            const Class *Find(const std::vector<Class> &_objs,
+                              std::string_view _name) const
+    {
+      const std::size_t pos = this->Position(_objs, _name);
+      return pos < _objs.size() ? &_objs[pos] : nullptr;
+    }
+
+    /// \brief Find an object by name, for modification.
+    /// \param[in] _objs The objects that the index was built from.
+    /// \param[in] _name Name of the object.
+    /// \return The object, or nullptr if there is none with the name.
+    public: template<typename Class>
+            Class *Find(std::vector<Class> &_objs,
+                        std::string_view _name) const
+    {
+      const std::size_t pos = this->Position(_objs, _name);
+      return pos < _objs.size() ? &_objs[pos] : nullptr;
+    }
+
+    /// \brief Find the position of the object with a name.
+    /// \param[in] _objs The objects that the index was built from.
+    /// \param[in] _name Name of the object.
+    /// \return The position, or _objs.size() if there is no object with
+    /// the name.
+    private: template<typename Class>
+             std::size_t Position(const std::vector<Class> &_objs,
+                                  std::string_view _name) const
+    {
+      auto range = this->indices.equal_range(
+          std::hash<std::string_view>()(_name));
+      for (auto iter = range.first; iter != range.second; ++iter)
+      {
+        if (iter->second < _objs.size() && _objs[iter->second].Name() == _name)
+          return iter->second;
+      }
+
+      // A name changed since the index was built may be missing from it.
+      if (this->generation != Generation())
+      {
+        for (std::size_t i = 0; i < _objs.size(); ++i)
+        {
+          if (_objs[i].Name() == _name)
+            return i;
+        }
+      }
+      return _objs.size();
+    }
+
+    /// \brief Add an object to the index, unless an object with the same
+    /// name is already in it.
+    /// \param[in] _objs The objects.
+    /// \param[in] _pos Position of the object.
+    private: template<typename Class>
+             void Add(const std::vector<Class> &_objs, const std::size_t _pos)
+    {
+      const std::string &name = _objs[_pos].Name();
+      if (this->Position(_objs, name) == _objs.size())
+      {
+        this->indices.emplace(std::hash<std::string_view>()(name), _pos);
+      }
+    }
+
+    /// \brief Record that the name of an indexed object may have changed.
+    /// Called by the SetName functions of the indexed objects.
+    public: static void NameChanged();
+
+    /// \brief Get the number of calls to NameChanged.
+    /// \return The number of calls.
+    private: static std::uint64_t Generation();
+
+    /// \brief Position of the first object with each name, by hash of the
+    /// name.
+    private: std::unordered_multimap<std::size_t, std::size_t> indices;
+
+    /// \brief Generation() when the index was last built.
+    private: std::uint64_t generation = 0;
+  };
+
+  /// \brief Fills a CollisionFilter one collision at a time. Used by
+  /// Model::ResolveCollisionFilter and World::ResolveCollisionFilter.
+  class CollisionFilterBuilder
+  {
+    /// \brief Add a collision, in the group of its bitmasks.
+    /// \param[in] _model Index of the model of the collision.
+    /// \param[in] _link Index of the link of the collision.
+    /// \param[in] _collision Index of the collision in its link.
+    /// \param[in] _category Category bitmask of the collision.
+    /// \param[in] _collide Collide bitmask of the collision.
+    public: void Add(uint64_t _model, uint64_t _link, uint64_t _collision,
+                     uint16_t _category, uint16_t _collide);
+
+    /// \brief Compute the matrix of the groups that collide, and move the
+    /// arrays to a filter.
+    /// \param[out] _filter The filter.
+    public: void Finish(CollisionFilter &_filter);
+
+    /// \brief The filter being filled.
+    private: CollisionFilter filter;
+
+    /// \brief Group of each pair of bitmasks, by the category bitmask in
+    /// the high bits and the collide bitmask in the low bits.
+    private: std::unordered_map<uint32_t, uint32_t> groupIndex;
+  };
+
+  /// \brief Fills LightCulling one light at a time. Used by
+  /// World::ResolveLightCulling and Root::ResolveLightCulling.
+  class LightCullingBuilder
+  {
+    /// \brief Add a light, computing its influence radius and bounds.
+    /// \param[in] _model Index of the model of the light, or -1.
+    /// \param[in] _link Index of the link of the light, or -1.
+    /// \param[in] _index Index of the light in its link, world or root.
+    /// \param[in] _light The light.
+    /// \param[in] _pose Pose of the light in the world frame.
+    public: void Add(int64_t _model, int64_t _link, uint64_t _index,
+                     const Light &_light,
+                     const ignition::math::Pose3d &_pose);
+
+    /// \brief Assign the lights to the cells of the grid, and move the
+    /// arrays to a light culling.
+    /// \param[in] _cellSize Size of the cells, or 0 for no grid.
+    /// \param[out] _culling The light culling.
+    public: void Finish(double _cellSize, LightCulling &_culling);
+
+    /// \brief The light culling being filled.
+    private: LightCulling culling;
+  };
+
+  /// \brief Fills SurfaceMaterials one collision at a time. Used by
+  /// Model::ResolveSurfaceMaterials and World::ResolveSurfaceMaterials.
+  class SurfaceMaterialBuilder
+  {
+    /// \brief Add a collision, with the material of its parameters.
+    /// \param[in] _model Index of the model of the collision.
+    /// \param[in] _link Index of the link of the collision.
+    /// \param[in] _collision Index of the collision in its link.
+    /// \param[in] _parameters Surface parameters of the collision.
+    public: void Add(uint64_t _model, uint64_t _link, uint64_t _collision,
+                     const SurfaceParameters &_parameters);
+
+    /// \brief Move the arrays to the materials.
+    /// \param[out] _materials The materials.
+    public: void Finish(SurfaceMaterials &_materials);
+
+    /// \brief The materials being filled.
+    private: SurfaceMaterials materials;
+
+    /// \brief Index of each material, by the bytes of its parameters.
+    private: std::unordered_map<std::string, uint32_t> materialIndex;
+
+    /// \brief Key of the collision being added, reused across collisions.
+    private: std::string key;
+  };
+
+  /// \brief Fills RenderBatches one visual at a time. Used by
+  /// Model::ResolveRenderBatches and World::ResolveRenderBatches.
+  class RenderBatchBuilder
+  {
+    /// \brief Add a visual, in the batch of its geometry, material, cast
+    /// shadows flag and transparency. Visuals with an empty geometry are
+    /// skipped.
+    /// \param[in] _model Index of the model of the visual.
+    /// \param[in] _link Index of the link of the visual.
+    /// \param[in] _index Index of the visual in its link.
+    /// \param[in] _visual The visual.
+    /// \param[in] _pose Resolved pose of the visual.
+    public: void Add(uint64_t _model, uint64_t _link, uint64_t _index,
+                     const Visual &_visual,
+                     const ignition::math::Pose3d &_pose);
+
+    /// \brief Sort the instances by batch, keeping their order within each
+    /// batch, and move the arrays to the batches.
+    /// \param[out] _batches The batches.
+    public: void Finish(RenderBatches &_batches);
+
+    /// \brief The batches being filled, with the instances in the order
+    /// they were added.
+    private: RenderBatches batches;
+
+    /// \brief Batch of each instance, in the order they were added.
+    private: std::vector<std::size_t> instanceBatches;
+
+    /// \brief Index of each batch, by the key of its visuals.
+    private: std::unordered_map<std::string, std::size_t> batchIndex;
+
+    /// \brief Key of the visual being added, reused across visuals.
+    private: std::string key;
+  };
   }
 }
 #endif
@@ -16,9 +16,16 @@
 */
 
 #include <gtest/gtest.h>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
 #include <string>
+#include <string_view>
+#include <vector>
 #include <ignition/math/Pose3.hh>
 #include "sdf/Element.hh"
+#include "sdf/Filesystem.hh"
+#include "sdf/Frame.hh"
 #include "Utils.hh"
 
 /////////////////////////////////////////////////
@@ -122,3 +129,219 @@ TEST(DOMUtils, ReservedNames)
   EXPECT_TRUE(sdf::isReservedName("__world__"));
   EXPECT_TRUE(sdf::isReservedName("__anything__"));
 }
+
+/////////////////////////////////////////////////
+TEST(DOMUtils, NameIndex)
+{
+  std::vector<sdf::Frame> frames(3);
+  frames[0].SetName("a");
+  frames[1].SetName("b");
+  frames[2].SetName("a");
+
+  sdf::NameIndex index;
+  EXPECT_EQ(nullptr, index.Find(frames, "a"));
+
+  // The first object with a name is found, as with a linear search.
+  index.Build(frames);
+  const std::vector<sdf::Frame> &constFrames = frames;
+  EXPECT_EQ(&frames[0], index.Find(constFrames, "a"));
+  EXPECT_EQ(&frames[1], index.Find(frames, "b"));
+  EXPECT_EQ(nullptr, index.Find(frames, "c"));
+
+  frames.emplace_back();
+  frames.back().SetName("c");
+  index.AddLast(frames);
+  EXPECT_EQ(&frames[3], index.Find(frames, "c"));
+  EXPECT_EQ(&frames[0], index.Find(frames, "a"));
+
+  // Names are found from views into other strings.
+  const std::string buffer = "abc";
+  const std::string_view view(buffer);
+  EXPECT_EQ(&frames[1], index.Find(frames, view.substr(1, 1)));
+  EXPECT_EQ(nullptr, index.Find(frames, view));
+
+  // After an erase, the next object with the name is found.
+  index.Erase(frames, 0);
+  EXPECT_EQ(&frames[1], index.Find(frames, "a"));
+  EXPECT_EQ(&frames[0], index.Find(frames, "b"));
+  EXPECT_EQ(&frames[2], index.Find(frames, "c"));
+
+  // Renamed objects are found by their new name only.
+  frames[0].SetName("d");
+  EXPECT_EQ(&frames[0], index.Find(frames, "d"));
+  EXPECT_EQ(nullptr, index.Find(frames, "b"));
+  EXPECT_EQ(&frames[1], index.Find(frames, "a"));
+
+  // Adding an object rebuilds the index.
+  frames.emplace_back();
+  frames.back().SetName("b");
+  index.AddLast(frames);
+  EXPECT_EQ(&frames[3], index.Find(frames, "b"));
+  EXPECT_EQ(&frames[0], index.Find(frames, "d"));
+}
+
+/////////////////////////////////////////////////
+TEST(DOMUtils, SplitScopedName)
+{
+  std::string first = "unchanged";
+  std::string rest = "unchanged";
+  EXPECT_FALSE(sdf::splitScopedName("link", first, rest));
+  EXPECT_EQ("unchanged", first);
+  EXPECT_EQ("unchanged", rest);
+
+  EXPECT_TRUE(sdf::splitScopedName("robot::arm::link", first, rest));
+  EXPECT_EQ("robot", first);
+  EXPECT_EQ("arm::link", rest);
+
+  EXPECT_TRUE(sdf::splitScopedName("arm::link", first, rest));
+  EXPECT_EQ("arm", first);
+  EXPECT_EQ("link", rest);
+}
+
+/////////////////////////////////////////////////
+TEST(DOMUtils, WarningLimit)
+{
+  // Without a limit, every warning is printed.
+  EXPECT_EQ(nullptr, sdf::WarningLimit::Current());
+  EXPECT_TRUE(sdf::warningAllowed("site", "a"));
+  EXPECT_TRUE(sdf::warningAllowed("site", "a"));
+
+  // Each warning is printed twice, and two different warnings per site.
+  sdf::WarningLimit limit(2, 2);
+  {
+    sdf::ScopedWarningLimit scope(&limit);
+    EXPECT_EQ(&limit, sdf::WarningLimit::Current());
+    EXPECT_TRUE(sdf::warningAllowed("site", "a"));
+    EXPECT_TRUE(sdf::warningAllowed("site", "a"));
+    EXPECT_FALSE(sdf::warningAllowed("site", "a"));
+    EXPECT_TRUE(sdf::warningAllowed("site", "b"));
+    EXPECT_FALSE(sdf::warningAllowed("site", "c"));
+    EXPECT_TRUE(sdf::warningAllowed("other", "c"));
+  }
+  EXPECT_EQ(nullptr, sdf::WarningLimit::Current());
+
+  // A scope created from a configuration uses the limit of the thread.
+  sdf::ParserConfig config;
+  {
+    sdf::ScopedWarningLimit scope(&limit);
+    sdf::ScopedWarningLimit nested(config);
+    EXPECT_EQ(&limit, sdf::WarningLimit::Current());
+  }
+  {
+    sdf::ScopedWarningLimit scope(config);
+    EXPECT_NE(nullptr, sdf::WarningLimit::Current());
+    EXPECT_TRUE(sdf::warningAllowed("site", "a"));
+    EXPECT_FALSE(sdf::warningAllowed("site", "a"));
+  }
+
+  config.SetWarningRepeatLimit(0);
+  {
+    sdf::ScopedWarningLimit scope(config);
+    EXPECT_EQ(nullptr, sdf::WarningLimit::Current());
+  }
+}
+
+/////////////////////////////////////////////////
+TEST(DOMUtils, ParallelForInOrder)
+{
+  // Each index creates errors until loading stops.
+  const std::vector<std::size_t> errorCounts = {2, 3, 4, 1, 5};
+  auto run = [&](std::size_t _max, unsigned int _threadCount,
+                 std::vector<std::size_t> &_errors)
+  {
+    _errors.assign(errorCounts.size(), 0);
+    sdf::ErrorLimit limit(_max);
+    sdf::ScopedErrorLimit scope(&limit);
+    const std::size_t kept = sdf::parallelForInOrder(errorCounts.size(),
+        _threadCount, [&](std::size_t _i)
+    {
+      if (sdf::loadStopped())
+        return false;
+      sdf::Errors errors;
+      for (std::size_t e = 0; e < errorCounts[_i] && !sdf::loadStopped(); ++e)
+        errors.push_back({sdf::ErrorCode::ELEMENT_INVALID, "error"});
+      _errors[_i] = errors.size();
+      return true;
+    });
+    _errors.resize(kept);
+    return limit.Counted();
+  };
+
+  // Without a limit, every index is kept.
+  std::vector<std::size_t> sequential, parallel;
+  EXPECT_EQ(15u, run(0, 1, sequential));
+  EXPECT_EQ(15u, run(0, 4, parallel));
+  EXPECT_EQ(errorCounts, sequential);
+  EXPECT_EQ(sequential, parallel);
+
+  // The index at which the limit is reached stops early and the following
+  // ones are dropped, whatever the number of threads.
+  for (std::size_t max : {1u, 2u, 5u, 6u, 14u})
+  {
+    const std::size_t counted = run(max, 1, sequential);
+    EXPECT_EQ(max, counted);
+    EXPECT_EQ(counted, run(max, 4, parallel));
+    EXPECT_EQ(sequential, parallel) << max;
+  }
+  run(6, 4, parallel);
+  EXPECT_EQ(std::vector<std::size_t>({2, 3, 1}), parallel);
+}
+
+/////////////////////////////////////////////////
+TEST(DOMUtils, ReplaceFile)
+{
+  const std::string path = sdf::filesystem::append(
+      sdf::filesystem::current_path(), "utils_test_replace_file.txt");
+  auto write = [](const std::string &_contents)
+  {
+    return [_contents](const std::string &_tmpPath)
+    {
+      std::ofstream out(_tmpPath, std::ios::binary);
+      out << _contents;
+      return static_cast<bool>(out);
+    };
+  };
+  auto read = [&path]()
+  {
+    std::ifstream in(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(in),
+                       std::istreambuf_iterator<char>());
+  };
+
+  // An existing file is replaced.
+  ASSERT_TRUE(sdf::replaceFile(path, write("first")));
+  EXPECT_EQ("first", read());
+  ASSERT_TRUE(sdf::replaceFile(path, write("second")));
+  EXPECT_EQ("second", read());
+
+  // A failed write keeps the file.
+  EXPECT_FALSE(sdf::replaceFile(path, [](const std::string &)
+  {
+    return false;
+  }));
+  EXPECT_EQ("second", read());
+  std::remove(path.c_str());
+}
+
+/////////////////////////////////////////////////
+TEST(DOMUtils, SharedString)
+{
+  const std::size_t count = sdf::SharedString::Count();
+  EXPECT_TRUE(sdf::SharedString().Str().empty());
+  {
+    // Equal strings share one copy.
+    sdf::SharedString a(std::string("/path/to/shared_string_test.dae"));
+    sdf::SharedString b(std::string("/path/to/") + "shared_string_test.dae");
+    EXPECT_EQ(&a.Str(), &b.Str());
+    EXPECT_EQ("/path/to/shared_string_test.dae", b.Str());
+    EXPECT_EQ(count + 1, sdf::SharedString::Count());
+
+    sdf::SharedString c = a;
+    a = sdf::SharedString(std::string("other"));
+    EXPECT_EQ(&b.Str(), &c.Str());
+    EXPECT_EQ(count + 2, sdf::SharedString::Count());
+  }
+
+  // The strings are released with their last holder.
+  EXPECT_EQ(count, sdf::SharedString::Count());
+}
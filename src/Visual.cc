@@ -14,18 +14,23 @@
  * limitations under the License.
  *
 */
+#include <algorithm>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <unordered_map>
 #include <ignition/math/Pose3.hh>
 #include "sdf/Error.hh"
 #include "sdf/Types.hh"
 #include "sdf/Visual.hh"
 #include "sdf/Geometry.hh"
+#include "ElementArena.hh"
+#include "FrameSemantics.hh"
 #include "Utils.hh"
 
 using namespace sdf;
 
-class sdf::VisualPrivate
+class sdf::VisualPrivate : public ArenaAllocated
 {
   /// \brief Default constructor
   public: VisualPrivate() = default;
@@ -58,8 +63,13 @@ class sdf::VisualPrivate
   /// \brief The SDF element pointer used during load.
   public: sdf::ElementPtr sdf;
 
-  /// \brief Pointer to the visual's material properties.
-  public: std::unique_ptr<Material> material;
+  /// \brief Pointer to the visual's material properties, which other
+  /// visuals also point to if materialId is not 0.
+  public: std::shared_ptr<Material> material;
+
+  /// \brief Identifier of the shared material, or 0 if the material is the
+  /// visual's own.
+  public: uint64_t materialId = 0;
 
   /// \brief Name of xml parent object.
   public: std::string xmlParentName;
@@ -67,10 +77,24 @@ class sdf::VisualPrivate
   /// \brief Weak pointer to model's Pose Relative-To Graph.
   public: std::weak_ptr<const sdf::PoseRelativeToGraph> poseRelativeToGraph;
 
+  /// \brief Vertex ids of the frames of SemanticPose in the graph.
+  public: FrameIds frameIds;
+
   /// \brief Visibility flags of a visual. Defaults to 0xFFFFFFFF
   public: uint32_t visibilityFlags = 4294967295u;
 };
 
+/////////////////////////////////////////////////
+/// \brief Find the vertex ids of the frames of the SemanticPose of a
+/// visual again, after its graph or the names of the frames changed.
+/// \param[in,out] _data Private data of the visual.
+static void updateFrameIds(VisualPrivate &_data)
+{
+  _data.frameIds = findFrameIds(_data.poseRelativeToGraph,
+      _data.poseRelativeTo.empty() ? _data.xmlParentName : _data.poseRelativeTo,
+      _data.xmlParentName);
+}
+
 /////////////////////////////////////////////////
 VisualPrivate::VisualPrivate(const VisualPrivate &_visualPrivate)
     : name(_visualPrivate.name),
@@ -82,12 +106,106 @@ VisualPrivate::VisualPrivate(const VisualPrivate &_visualPrivate)
       sdf(_visualPrivate.sdf),
       visibilityFlags(_visualPrivate.visibilityFlags)
 {
-  if (_visualPrivate.material)
+  if (_visualPrivate.materialId != 0)
+  {
+    this->material = _visualPrivate.material;
+    this->materialId = _visualPrivate.materialId;
+  }
+  else if (_visualPrivate.material)
   {
-    this->material = std::make_unique<Material>(*(_visualPrivate.material));
+    this->material = std::make_shared<Material>(*(_visualPrivate.material));
   }
 }
 
+/// \brief A material shared by the visuals that load identical materials.
+struct SharedMaterial
+{
+  /// \brief The material.
+  Material material;
+
+  /// \brief Identifier of the material, unique in the process.
+  uint64_t id = 0;
+};
+
+/// \brief The materials shared by visuals, by the XML of their element.
+struct SharedMaterialCache
+{
+  /// \brief The materials, which expire when no visual uses them anymore.
+  std::unordered_map<std::string, std::weak_ptr<SharedMaterial>> materials;
+
+  /// \brief Number of materials at which the expired ones are removed.
+  std::size_t pruneSize = 64;
+
+  /// \brief Identifier of the next material.
+  uint64_t nextId = 1;
+
+  /// \brief Mutex protecting the other members.
+  std::mutex mutex;
+};
+
+//////////////////////////////////////////////////
+/// \brief Get the cache of shared materials of the process.
+/// \return The cache.
+static SharedMaterialCache &sharedMaterialCache()
+{
+  static SharedMaterialCache cache;
+  return cache;
+}
+
+//////////////////////////////////////////////////
+/// \brief Load a material, or find an identical one loaded before.
+/// \param[in] _sdf The <material> element.
+/// \param[out] _errors Errors of loading the material.
+/// \return The shared material. Materials with errors are not shared.
+static std::shared_ptr<SharedMaterial> loadSharedMaterial(ElementPtr _sdf,
+    Errors &_errors)
+{
+  const std::string key = _sdf->ToString("");
+  SharedMaterialCache &cache = sharedMaterialCache();
+  {
+    std::lock_guard<std::mutex> lock(cache.mutex);
+    auto it = cache.materials.find(key);
+    if (it != cache.materials.end())
+    {
+      if (auto shared = it->second.lock())
+        return shared;
+    }
+  }
+
+  // Loaded without the lock held, so that visuals loaded concurrently with
+  // different materials do not wait for each other.
+  auto shared = std::make_shared<SharedMaterial>();
+  Errors err = shared->material.Load(_sdf);
+  if (!err.empty())
+  {
+    _errors.insert(_errors.end(), err.begin(), err.end());
+    return shared;
+  }
+
+  std::lock_guard<std::mutex> lock(cache.mutex);
+  std::weak_ptr<SharedMaterial> &entry = cache.materials[key];
+  if (auto existing = entry.lock())
+    return existing;
+  shared->id = cache.nextId++;
+  entry = shared;
+
+  // Remove the materials that are no longer used once the cache doubled
+  // in size, so that loading many distinct materials stays linear.
+  if (cache.materials.size() >= cache.pruneSize)
+  {
+    for (auto expired = cache.materials.begin();
+         expired != cache.materials.end();)
+    {
+      if (expired->second.expired())
+        expired = cache.materials.erase(expired);
+      else
+        ++expired;
+    }
+    cache.pruneSize = std::max<std::size_t>(64, cache.materials.size() * 2);
+  }
+  return shared;
+}
+
 /////////////////////////////////////////////////
 Visual::Visual()
   : dataPtr(new VisualPrivate)
@@ -131,7 +249,7 @@ Errors Visual::Load(ElementPtr _sdf)
 {
   Errors errors;
 
-  this->dataPtr->sdf = _sdf;
+  this->dataPtr->sdf = retainedElement(_sdf);
 
   // Check that the provided SDF element is a <visual>
   // This is an error that cannot be recovered, so return an error.
@@ -173,9 +291,20 @@ Errors Visual::Load(ElementPtr _sdf)
 
   if (_sdf->HasElement("material"))
   {
-    this->dataPtr->material.reset(new sdf::Material());
-    Errors err = this->dataPtr->material->Load(_sdf->GetElement("material"));
-    errors.insert(errors.end(), err.begin(), err.end());
+    if (shareMaterials())
+    {
+      auto shared = loadSharedMaterial(_sdf->FindElement("material"), errors);
+      this->dataPtr->material =
+          std::shared_ptr<sdf::Material>(shared, &shared->material);
+      this->dataPtr->materialId = shared->id;
+    }
+    else
+    {
+      this->dataPtr->material = std::make_shared<sdf::Material>();
+      Errors err =
+          this->dataPtr->material->Load(_sdf->FindElement("material"));
+      errors.insert(errors.end(), err.begin(), err.end());
+    }
   }
 
   // Load the pose. Ignore the return value since the pose is optional.
@@ -190,14 +319,14 @@ Errors Visual::Load(ElementPtr _sdf)
   }
 
   // Load the geometry
-  Errors geomErr = this->dataPtr->geom.Load(_sdf->GetElement("geometry"));
+  Errors geomErr = this->dataPtr->geom.Load(_sdf->FindElement("geometry"));
   errors.insert(errors.end(), geomErr.begin(), geomErr.end());
 
   return errors;
 }
 
 /////////////////////////////////////////////////
-std::string Visual::Name() const
+const std::string &Visual::Name() const
 {
   return this->dataPtr->name;
 }
@@ -206,6 +335,7 @@ std::string Visual::Name() const
 void Visual::SetName(const std::string &_name) const
 {
   this->dataPtr->name = _name;
+  NameIndex::NameChanged();
 }
 
 /////////////////////////////////////////////////
@@ -278,6 +408,7 @@ void Visual::SetPoseFrame(const std::string &_frame)
 void Visual::SetPoseRelativeTo(const std::string &_frame)
 {
   this->dataPtr->poseRelativeTo = _frame;
+  updateFrameIds(*this->dataPtr);
 }
 
 /////////////////////////////////////////////////
@@ -296,6 +427,7 @@ void Visual::SetGeom(const Geometry &_geom)
 void Visual::SetXmlParentName(const std::string &_xmlParentName)
 {
   this->dataPtr->xmlParentName = _xmlParentName;
+  updateFrameIds(*this->dataPtr);
 }
 
 /////////////////////////////////////////////////
@@ -303,6 +435,7 @@ void Visual::SetPoseRelativeToGraph(
     std::weak_ptr<const PoseRelativeToGraph> _graph)
 {
   this->dataPtr->poseRelativeToGraph = _graph;
+  updateFrameIds(*this->dataPtr);
 }
 
 /////////////////////////////////////////////////
@@ -312,7 +445,8 @@ sdf::SemanticPose Visual::SemanticPose() const
       this->dataPtr->pose,
       this->dataPtr->poseRelativeTo,
       this->dataPtr->xmlParentName,
-      this->dataPtr->poseRelativeToGraph);
+      this->dataPtr->poseRelativeToGraph,
+      this->dataPtr->frameIds);
 }
 
 /////////////////////////////////////////////////
@@ -330,7 +464,14 @@ sdf::Material *Visual::Material() const
 /////////////////////////////////////////////////
 void Visual::SetMaterial(const sdf::Material &_material)
 {
-  this->dataPtr->material.reset(new sdf::Material(_material));
+  this->dataPtr->material = std::make_shared<sdf::Material>(_material);
+  this->dataPtr->materialId = 0;
+}
+
+/////////////////////////////////////////////////
+uint64_t Visual::MaterialId() const
+{
+  return this->dataPtr->materialId;
 }
 
 /////////////////////////////////////////////////
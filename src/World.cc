@@ -14,19 +14,43 @@
  * limitations under the License.
  *
 */
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <unordered_map>
 #include <unordered_set>
+#include <utility>
 #include <vector>
+#include <ignition/math/Matrix3.hh>
 #include <ignition/math/Vector3.hh>
 
 #include "sdf/Actor.hh"
+#include "sdf/Collision.hh"
+#include "sdf/CollisionGeometry.hh"
+#include "sdf/CollisionFilter.hh"
 #include "sdf/Frame.hh"
 #include "sdf/Light.hh"
+#include "sdf/LightCulling.hh"
+#include "sdf/Link.hh"
 #include "sdf/Model.hh"
 #include "sdf/Physics.hh"
+#include "sdf/RenderBatches.hh"
+#include "sdf/Sensor.hh"
+#include "sdf/SensorSchedule.hh"
+#include "sdf/Surface.hh"
+#include "sdf/SurfaceMaterials.hh"
 #include "sdf/Types.hh"
+#include "sdf/Visual.hh"
 #include "sdf/World.hh"
+#include "sdf/WorldPoses.hh"
 #include "FrameSemantics.hh"
+#include "PoseBatch.hh"
+#include "SpatialIndex.hh"
+#include "TaskPool.hh"
 #include "Utils.hh"
 
 using namespace sdf;
@@ -81,6 +105,24 @@ class sdf::WorldPrivate
   /// \brief The physics profiles specified in this world.
   public: std::vector<Physics> physics;
 
+  /// \brief Index of the frames by name.
+  public: NameIndex frameIndex;
+
+  /// \brief Index of the lights by name.
+  public: NameIndex lightIndex;
+
+  /// \brief Index of the actors by name.
+  public: NameIndex actorIndex;
+
+  /// \brief Index of the models by name.
+  public: NameIndex modelIndex;
+
+  /// \brief Index of the physics profiles by name.
+  public: NameIndex physicsIndex;
+
+  /// \brief Index in physics of the default profile when it was loaded.
+  public: std::size_t defaultPhysics = 0;
+
   /// \brief The SDF element pointer used during load.
   public: sdf::ElementPtr sdf;
 
@@ -93,6 +135,13 @@ class sdf::WorldPrivate
 
   /// \brief Pose Relative-To Graph constructed during Load.
   public: std::shared_ptr<sdf::PoseRelativeToGraph> poseRelativeToGraph;
+
+  /// \brief Spatial index of the models for each ModelBoundsType, built
+  /// by the first query that uses it. It is not copied with the world.
+  public: std::shared_ptr<const SpatialIndex> spatialIndices[2];
+
+  /// \brief Mutex that protects spatialIndices, for concurrent queries.
+  public: std::mutex spatialIndexMutex;
 };
 
 /////////////////////////////////////////////////
@@ -106,6 +155,12 @@ WorldPrivate::WorldPrivate(const WorldPrivate &_worldPrivate)
       models(_worldPrivate.models),
       name(_worldPrivate.name),
       physics(_worldPrivate.physics),
+      frameIndex(_worldPrivate.frameIndex),
+      lightIndex(_worldPrivate.lightIndex),
+      actorIndex(_worldPrivate.actorIndex),
+      modelIndex(_worldPrivate.modelIndex),
+      physicsIndex(_worldPrivate.physicsIndex),
+      defaultPhysics(_worldPrivate.defaultPhysics),
       sdf(_worldPrivate.sdf),
       windLinearVelocity(_worldPrivate.windLinearVelocity)
 {
@@ -134,11 +189,206 @@ WorldPrivate::WorldPrivate(const WorldPrivate &_worldPrivate)
   }
 }
 
+/////////////////////////////////////////////////
+/// \brief Create the graphs of a world that was not loaded, for a frame or
+/// light to be added to them.
+/// \param[in,out] _data Private data of the world.
+static void prepareGraphs(WorldPrivate &_data)
+{
+  if (_data.poseRelativeToGraph)
+  {
+    return;
+  }
+
+  _data.frameAttachedToGraph = std::make_shared<FrameAttachedToGraph>();
+  _data.poseRelativeToGraph = std::make_shared<PoseRelativeToGraph>();
+  addScopeVertex(_data.frameAttachedToGraph.get(),
+      *_data.poseRelativeToGraph, "world", FrameType::WORLD);
+}
+
+/////////////////////////////////////////////////
+/// \brief Discard the spatial indices of a world after its models or their
+/// poses change.
+/// \param[in,out] _data Private data of the world.
+static void resetSpatialIndices(WorldPrivate &_data)
+{
+  std::lock_guard<std::mutex> lock(_data.spatialIndexMutex);
+  for (auto &index : _data.spatialIndices)
+    index.reset();
+}
+
+/////////////////////////////////////////////////
+/// \brief Get the bounds of a model in the world frame.
+/// \param[in] _model The model.
+/// \param[in] _pose Pose of the model frame in the world frame.
+/// \param[in] _bounds The bounds to compute.
+/// \param[out] _item The bounds.
+/// \return True if the bounds could be computed.
+static bool modelBounds(const Model &_model,
+    const ignition::math::Pose3d &_pose, const ModelBoundsType _bounds,
+    SpatialIndex::Item &_item)
+{
+  _item.min = _pose.Pos();
+  _item.max = _pose.Pos();
+  if (_bounds == ModelBoundsType::ORIGIN)
+    return true;
+
+  CollisionGeometry geometry;
+  std::vector<ignition::math::Pose3d> framePoses;
+  if (!_model.ResolveCollisionGeometry(geometry).empty() ||
+      !_model.ResolveFramePoses(framePoses).empty())
+  {
+    return false;
+  }
+
+  const double inf = std::numeric_limits<double>::infinity();
+  double min[3] = {inf, inf, inf};
+  double max[3] = {-inf, -inf, -inf};
+  for (std::size_t i = 0; i < geometry.linkIndices.size(); ++i)
+  {
+    const ignition::math::Vector3d &boxMin = geometry.minCorners[i];
+    const ignition::math::Vector3d &boxMax = geometry.maxCorners[i];
+    if (!std::isfinite(boxMin.X() + boxMin.Y() + boxMin.Z() +
+                       boxMax.X() + boxMax.Y() + boxMax.Z()))
+    {
+      _item.min.Set(-inf, -inf, -inf);
+      _item.max.Set(inf, inf, inf);
+      return true;
+    }
+
+    // The link poses follow the model frame in framePoses. Transform the
+    // center and half size of the box from the link frame to the world
+    // frame, as Link::ResolveCollisionGeometry does from the collision
+    // frame to the link frame.
+    const ignition::math::Pose3d linkPose =
+        _pose * framePoses[1 + geometry.linkIndices[i]];
+    const ignition::math::Matrix3d rot(linkPose.Rot());
+    const ignition::math::Vector3d center = (boxMin + boxMax) * 0.5;
+    const ignition::math::Vector3d half = (boxMax - boxMin) * 0.5;
+    const double c[3] = {center.X(), center.Y(), center.Z()};
+    const double h[3] = {half.X(), half.Y(), half.Z()};
+    const double p[3] = {
+      linkPose.Pos().X(), linkPose.Pos().Y(), linkPose.Pos().Z()};
+    for (int r = 0; r < 3; ++r)
+    {
+      double worldCenter = p[r];
+      double extent = 0;
+      for (int k = 0; k < 3; ++k)
+      {
+        worldCenter += rot(r, k) * c[k];
+        extent += std::abs(rot(r, k)) * h[k];
+      }
+      min[r] = std::min(min[r], worldCenter - extent);
+      max[r] = std::max(max[r], worldCenter + extent);
+    }
+  }
+
+  if (!geometry.linkIndices.empty())
+  {
+    _item.min.Set(min[0], min[1], min[2]);
+    _item.max.Set(max[0], max[1], max[2]);
+  }
+  return true;
+}
+
+/////////////////////////////////////////////////
+/// \brief Get the spatial index of the models of a world, building it if
+/// needed.
+/// \param[in] _world The world.
+/// \param[in,out] _data Private data of the world.
+/// \param[in] _bounds The bounds of the models.
+/// \return The index.
+static std::shared_ptr<const SpatialIndex> spatialIndex(const World &_world,
+    WorldPrivate &_data, const ModelBoundsType _bounds)
+{
+  std::lock_guard<std::mutex> lock(_data.spatialIndexMutex);
+  auto &index = _data.spatialIndices[static_cast<int>(_bounds)];
+  if (index)
+    return index;
+
+  // Resolve all the model poses in one pass, or one by one to skip the
+  // models whose pose can't be resolved.
+  std::vector<ignition::math::Pose3d> poses;
+  const bool resolved = _world.ResolveFramePoses(poses).empty();
+
+  std::vector<SpatialIndex::Item> items;
+  items.reserve(_data.models.size());
+  for (std::size_t m = 0; m < _data.models.size(); ++m)
+  {
+    ignition::math::Pose3d pose;
+    if (resolved)
+      pose = poses[1 + m];
+    else if (!_data.models[m].SemanticPose().Resolve(pose, "world").empty())
+      continue;
+
+    SpatialIndex::Item item;
+    item.id = m;
+    if (modelBounds(_data.models[m], pose, _bounds, item))
+      items.push_back(item);
+  }
+
+  auto newIndex = std::make_shared<SpatialIndex>();
+  newIndex->Build(std::move(items));
+  index = std::move(newIndex);
+  return index;
+}
+
+/////////////////////////////////////////////////
+/// \brief Load one physics profile of a world, as selected by
+/// ParserConfig::SetPhysicsProfile, without loading the others.
+/// \param[in] _sdf The world element.
+/// \param[in] _profile Name of the profile, or "__default__".
+/// \param[out] _physics The loaded profile, or a default profile if it
+/// was not found.
+/// \return Errors.
+static Errors loadPhysicsProfile(const ElementPtr &_sdf,
+    const std::string &_profile, std::vector<Physics> &_physics)
+{
+  Errors errors;
+
+  // The default profile is the first that is marked as default, or the
+  // first profile, as in World::PhysicsDefault.
+  ElementPtr selected;
+  for (const ElementPtr &elem : _sdf->Children("physics"))
+  {
+    if (_profile == "__default__")
+    {
+      if (!selected)
+        selected = elem;
+      if (elem->Get<bool>("default"))
+      {
+        selected = elem;
+        break;
+      }
+    }
+    else if (elem->Get<std::string>("name") == _profile)
+    {
+      selected = elem;
+      break;
+    }
+  }
+
+  _physics.clear();
+  _physics.emplace_back();
+  if (selected)
+  {
+    errors = _physics.back().Load(selected);
+  }
+  else if (_profile != "__default__")
+  {
+    errors.push_back({ErrorCode::ELEMENT_MISSING,
+        "No physics profile with name[" + _profile +
+        "] in world with name[" + _sdf->Get<std::string>("name") + "]."});
+  }
+  return errors;
+}
+
 /////////////////////////////////////////////////
 World::World()
   : dataPtr(new WorldPrivate)
 {
   this->dataPtr->physics.emplace_back(Physics());
+  this->dataPtr->physicsIndex.Build(this->dataPtr->physics);
 }
 
 /////////////////////////////////////////////////
@@ -189,10 +439,23 @@ World &World::operator=(World &&_world)
 
 /////////////////////////////////////////////////
 Errors World::Load(sdf::ElementPtr _sdf)
+{
+  // Keep the checks, material sharing and physics profile set by sdf::Root
+  // for worlds that are loaded lazily.
+  ParserConfig config;
+  config.SetValidation(validationLevel());
+  config.SetShareMaterials(shareMaterials());
+  config.SetPhysicsProfile(physicsProfile());
+  return this->Load(_sdf, config);
+}
+
+/////////////////////////////////////////////////
+Errors World::Load(sdf::ElementPtr _sdf, const ParserConfig &_config)
 {
   Errors errors;
 
   this->dataPtr->sdf = _sdf;
+  resetSpatialIndices(*this->dataPtr);
 
   // Check that the provided SDF element is a <world>
   // This is an error that cannot be recovered, so return an error.
@@ -222,7 +485,7 @@ Errors World::Load(sdf::ElementPtr _sdf)
   // Read the audio element
   if (_sdf->HasElement("audio"))
   {
-    sdf::ElementPtr elem = _sdf->GetElement("audio");
+    sdf::ElementPtr elem = _sdf->FindElement("audio");
     this->dataPtr->audioDevice = elem->Get<std::string>("device",
         this->dataPtr->audioDevice).first;
   }
@@ -230,7 +493,7 @@ Errors World::Load(sdf::ElementPtr _sdf)
   // Read the wind element
   if (_sdf->HasElement("wind"))
   {
-    sdf::ElementPtr elem = _sdf->GetElement("wind");
+    sdf::ElementPtr elem = _sdf->FindElement("wind");
     this->dataPtr->windLinearVelocity =
       elem->Get<ignition::math::Vector3d>("linear_velocity",
           this->dataPtr->windLinearVelocity).first;
@@ -241,7 +504,7 @@ Errors World::Load(sdf::ElementPtr _sdf)
   {
     this->dataPtr->atmosphere.reset(new sdf::Atmosphere());
     Errors atmosphereLoadErrors =
-      this->dataPtr->atmosphere->Load(_sdf->GetElement("atmosphere"));
+      this->dataPtr->atmosphere->Load(_sdf->FindElement("atmosphere"));
     errors.insert(errors.end(), atmosphereLoadErrors.begin(),
         atmosphereLoadErrors.end());
   }
@@ -255,7 +518,10 @@ Errors World::Load(sdf::ElementPtr _sdf)
     _sdf->Get<ignition::math::Vector3d>("magnetic_field",
         this->dataPtr->magneticField).first;
 
-  if (!_sdf->HasUniqueChildNames())
+  const ValidationLevel validation = _config.Validation();
+  ScopedValidationLevel validationScope(validation);
+  ScopedMaterialSharing materialScope(_config.ShareMaterials());
+  if (validation == ValidationLevel::FULL && !_sdf->HasUniqueChildNames())
   {
     sdfwarn << "Non-unique names detected in XML children of world with name["
             << this->Name() << "].\n";
@@ -265,10 +531,14 @@ Errors World::Load(sdf::ElementPtr _sdf)
   // name collisions
   std::unordered_set<std::string> frameNames;
 
-  // Load all the models.
+  // Load all the models. The links of a model are loaded on several
+  // threads too when the models are not.
+  ScopedLoadThreadCount threads(_config.ModelLoadThreadCount());
+  ScopedTaskExecutor executor(_config);
   Errors modelLoadErrors = loadUniqueRepeated<Model>(_sdf, "model",
-      this->dataPtr->models);
+      this->dataPtr->models, _config.ModelLoadThreadCount());
   errors.insert(errors.end(), modelLoadErrors.begin(), modelLoadErrors.end());
+  this->dataPtr->modelIndex.Build(this->dataPtr->models);
 
   // Models are loaded first, and loadUniqueRepeated ensures there are no
   // duplicate names, so these names can be added to frameNames without
@@ -278,8 +548,9 @@ Errors World::Load(sdf::ElementPtr _sdf)
     frameNames.insert(model.Name());
   }
 
-  // Load all the physics.
-  if (_sdf->HasElement("physics"))
+  // Load all the physics, or only the selected profile.
+  const std::string &physicsProfile = _config.PhysicsProfile();
+  if (_sdf->HasElement("physics") && physicsProfile.empty())
   {
     this->dataPtr->physics.clear();
     Errors physicsLoadErrors = loadUniqueRepeated<Physics>(_sdf, "physics",
@@ -287,16 +558,35 @@ Errors World::Load(sdf::ElementPtr _sdf)
     errors.insert(errors.end(), physicsLoadErrors.begin(),
         physicsLoadErrors.end());
   }
+  else if (!physicsProfile.empty())
+  {
+    Errors physicsLoadErrors = loadPhysicsProfile(_sdf, physicsProfile,
+        this->dataPtr->physics);
+    errors.insert(errors.end(), physicsLoadErrors.begin(),
+        physicsLoadErrors.end());
+  }
+  this->dataPtr->physicsIndex.Build(this->dataPtr->physics);
+  this->dataPtr->defaultPhysics = 0;
+  for (std::size_t i = 0; i < this->dataPtr->physics.size(); ++i)
+  {
+    if (this->dataPtr->physics[i].IsDefault())
+    {
+      this->dataPtr->defaultPhysics = i;
+      break;
+    }
+  }
 
   // Load all the actors.
   Errors actorLoadErrors = loadUniqueRepeated<Actor>(_sdf, "actor",
       this->dataPtr->actors);
   errors.insert(errors.end(), actorLoadErrors.begin(), actorLoadErrors.end());
+  this->dataPtr->actorIndex.Build(this->dataPtr->actors);
 
   // Load all the lights.
   Errors lightLoadErrors = loadUniqueRepeated<Light>(_sdf, "light",
       this->dataPtr->lights);
   errors.insert(errors.end(), lightLoadErrors.begin(), lightLoadErrors.end());
+  this->dataPtr->lightIndex.Build(this->dataPtr->lights);
 
   // Load all the frames.
   Errors frameLoadErrors = loadUniqueRepeated<Frame>(_sdf, "frame",
@@ -323,12 +613,13 @@ Errors World::Load(sdf::ElementPtr _sdf)
     }
     frameNames.insert(frameName);
   }
+  this->dataPtr->frameIndex.Build(this->dataPtr->frames);
 
   // Load the Gui
   if (_sdf->HasElement("gui"))
   {
     this->dataPtr->gui.reset(new sdf::Gui());
-    Errors guiLoadErrors = this->dataPtr->gui->Load(_sdf->GetElement("gui"));
+    Errors guiLoadErrors = this->dataPtr->gui->Load(_sdf->FindElement("gui"));
     errors.insert(errors.end(), guiLoadErrors.begin(), guiLoadErrors.end());
   }
 
@@ -337,24 +628,30 @@ Errors World::Load(sdf::ElementPtr _sdf)
   {
     this->dataPtr->scene.reset(new sdf::Scene());
     Errors sceneLoadErrors =
-        this->dataPtr->scene->Load(_sdf->GetElement("scene"));
+        this->dataPtr->scene->Load(_sdf->FindElement("scene"));
     errors.insert(errors.end(), sceneLoadErrors.begin(), sceneLoadErrors.end());
   }
 
   // Build the graphs.
-  this->dataPtr->frameAttachedToGraph =
-      std::make_shared<FrameAttachedToGraph>();
-  Errors frameAttachedToGraphErrors =
-  buildFrameAttachedToGraph(*this->dataPtr->frameAttachedToGraph, this);
-  errors.insert(errors.end(), frameAttachedToGraphErrors.begin(),
-                              frameAttachedToGraphErrors.end());
-  Errors validateFrameAttachedGraphErrors =
-    validateFrameAttachedToGraph(*this->dataPtr->frameAttachedToGraph);
-  errors.insert(errors.end(), validateFrameAttachedGraphErrors.begin(),
-                              validateFrameAttachedGraphErrors.end());
-  for (auto &frame : this->dataPtr->frames)
+  if (validation != ValidationLevel::NONE)
   {
-    frame.SetFrameAttachedToGraph(this->dataPtr->frameAttachedToGraph);
+    this->dataPtr->frameAttachedToGraph =
+        std::make_shared<FrameAttachedToGraph>();
+    Errors frameAttachedToGraphErrors =
+    buildFrameAttachedToGraph(*this->dataPtr->frameAttachedToGraph, this);
+    errors.insert(errors.end(), frameAttachedToGraphErrors.begin(),
+                                frameAttachedToGraphErrors.end());
+    if (validation == ValidationLevel::FULL)
+    {
+      Errors validateFrameAttachedGraphErrors =
+        validateFrameAttachedToGraph(*this->dataPtr->frameAttachedToGraph);
+      errors.insert(errors.end(), validateFrameAttachedGraphErrors.begin(),
+                                  validateFrameAttachedGraphErrors.end());
+    }
+    for (auto &frame : this->dataPtr->frames)
+    {
+      frame.SetFrameAttachedToGraph(this->dataPtr->frameAttachedToGraph);
+    }
   }
 
   this->dataPtr->poseRelativeToGraph = std::make_shared<PoseRelativeToGraph>();
@@ -362,10 +659,13 @@ Errors World::Load(sdf::ElementPtr _sdf)
   buildPoseRelativeToGraph(*this->dataPtr->poseRelativeToGraph, this);
   errors.insert(errors.end(), poseRelativeToGraphErrors.begin(),
                               poseRelativeToGraphErrors.end());
-  Errors validatePoseGraphErrors =
-    validatePoseRelativeToGraph(*this->dataPtr->poseRelativeToGraph);
-  errors.insert(errors.end(), validatePoseGraphErrors.begin(),
-                              validatePoseGraphErrors.end());
+  if (validation == ValidationLevel::FULL)
+  {
+    Errors validatePoseGraphErrors =
+      validatePoseRelativeToGraph(*this->dataPtr->poseRelativeToGraph);
+    errors.insert(errors.end(), validatePoseGraphErrors.begin(),
+                                validatePoseGraphErrors.end());
+  }
   for (auto &frame : this->dataPtr->frames)
   {
     frame.SetPoseRelativeToGraph(this->dataPtr->poseRelativeToGraph);
@@ -380,11 +680,24 @@ Errors World::Load(sdf::ElementPtr _sdf)
     light.SetPoseRelativeToGraph(this->dataPtr->poseRelativeToGraph);
   }
 
+  // The element is only needed to build the graphs.
+  this->dataPtr->sdf = retainedElement(this->dataPtr->sdf);
+
+  const LoadMonitor *monitor = LoadMonitor::Current();
+  if (monitor && monitor->Reporting())
+  {
+    LoadProgress progress;
+    progress.type = LoadProgressType::WORLD_LOADED;
+    progress.name = this->Name();
+    progress.world = this;
+    monitor->Report(progress);
+  }
+
   return errors;
 }
 
 /////////////////////////////////////////////////
-std::string World::Name() const
+const std::string &World::Name() const
 {
   return this->dataPtr->name;
 }
@@ -393,10 +706,11 @@ std::string World::Name() const
 void World::SetName(const std::string &_name) const
 {
   this->dataPtr->name = _name;
+  NameIndex::NameChanged();
 }
 
 /////////////////////////////////////////////////
-std::string World::AudioDevice() const
+const std::string &World::AudioDevice() const
 {
   return this->dataPtr->audioDevice;
 }
@@ -458,29 +772,48 @@ const Model *World::ModelByIndex(const uint64_t _index) const
 }
 
 /////////////////////////////////////////////////
-bool World::ModelNameExists(const std::string &_name) const
+bool World::ModelNameExists(std::string_view _name) const
 {
-  for (auto const &m : this->dataPtr->models)
-  {
-    if (m.Name() == _name)
-    {
-      return true;
-    }
-  }
-  return false;
+  return this->ModelByName(_name) != nullptr;
 }
 
 /////////////////////////////////////////////////
-const Model *World::ModelByName(const std::string &_name) const
+const Model *World::ModelByName(std::string_view _name) const
 {
-  for (auto const &m : this->dataPtr->models)
-  {
-    if (m.Name() == _name)
-    {
-      return &m;
-    }
-  }
-  return nullptr;
+  return this->dataPtr->modelIndex.Find(this->dataPtr->models, _name);
+}
+
+/////////////////////////////////////////////////
+const Link *World::LinkByScopedName(const std::string &_name) const
+{
+  std::string modelName, name;
+  if (!splitScopedName(_name, modelName, name))
+    return nullptr;
+
+  const Model *model = this->ModelByName(modelName);
+  return model ? model->LinkByName(name) : nullptr;
+}
+
+/////////////////////////////////////////////////
+const Joint *World::JointByScopedName(const std::string &_name) const
+{
+  std::string modelName, name;
+  if (!splitScopedName(_name, modelName, name))
+    return nullptr;
+
+  const Model *model = this->ModelByName(modelName);
+  return model ? model->JointByName(name) : nullptr;
+}
+
+/////////////////////////////////////////////////
+const Frame *World::FrameByScopedName(const std::string &_name) const
+{
+  std::string modelName, name;
+  if (!splitScopedName(_name, modelName, name))
+    return this->FrameByName(_name);
+
+  const Model *model = this->ModelByName(modelName);
+  return model ? model->FrameByName(name) : nullptr;
 }
 
 /////////////////////////////////////////////////
@@ -540,29 +873,15 @@ const Frame *World::FrameByIndex(const uint64_t _index) const
 }
 
 /////////////////////////////////////////////////
-bool World::FrameNameExists(const std::string &_name) const
+bool World::FrameNameExists(std::string_view _name) const
 {
-  for (auto const &f : this->dataPtr->frames)
-  {
-    if (f.Name() == _name)
-    {
-      return true;
-    }
-  }
-  return false;
+  return this->FrameByName(_name) != nullptr;
 }
 
 /////////////////////////////////////////////////
-const Frame *World::FrameByName(const std::string &_name) const
+const Frame *World::FrameByName(std::string_view _name) const
 {
-  for (auto const &f : this->dataPtr->frames)
-  {
-    if (f.Name() == _name)
-    {
-      return &f;
-    }
-  }
-  return nullptr;
+  return this->dataPtr->frameIndex.Find(this->dataPtr->frames, _name);
 }
 
 /////////////////////////////////////////////////
@@ -580,16 +899,154 @@ const Light *World::LightByIndex(const uint64_t _index) const
 }
 
 /////////////////////////////////////////////////
-bool World::LightNameExists(const std::string &_name) const
+bool World::LightNameExists(std::string_view _name) const
 {
-  for (auto const &l : this->dataPtr->lights)
+  return this->dataPtr->lightIndex.Find(this->dataPtr->lights, _name) !=
+      nullptr;
+}
+
+/////////////////////////////////////////////////
+Errors World::AddModel(Model &&_model)
+{
+  prepareGraphs(*this->dataPtr);
+
+  // Use the same default relative_to frame as buildPoseRelativeToGraph.
+  Errors errors = addFrameToGraphs(this->dataPtr->frameAttachedToGraph.get(),
+      *this->dataPtr->poseRelativeToGraph, _model.Name(), FrameType::MODEL,
+      "", _model.PoseRelativeTo().empty() ? "world" : _model.PoseRelativeTo(),
+      _model.RawPose(), false);
+  if (!errors.empty())
   {
-    if (l.Name() == _name)
+    return errors;
+  }
+
+  this->dataPtr->models.push_back(std::move(_model));
+  this->dataPtr->modelIndex.AddLast(this->dataPtr->models);
+  this->dataPtr->models.back().SetPoseRelativeToGraph(
+      this->dataPtr->poseRelativeToGraph);
+  resetSpatialIndices(*this->dataPtr);
+  return errors;
+}
+
+/////////////////////////////////////////////////
+Errors World::ReplaceModel(Model &&_model)
+{
+  Errors errors;
+  Model *model =
+      this->dataPtr->modelIndex.Find(this->dataPtr->models, _model.Name());
+  if (!model)
+  {
+    errors.push_back({ErrorCode::ELEMENT_MISSING,
+        "No model with name[" + _model.Name() + "] to replace in world with "
+        "name[" + this->Name() + "]."});
+    return errors;
+  }
+
+  // Only the edge to the model vertex of the pose graph changes, since the
+  // frames of the model are in the graphs of the model.
+  prepareGraphs(*this->dataPtr);
+  if (model->RawPose() != _model.RawPose() ||
+      model->PoseRelativeTo() != _model.PoseRelativeTo())
+  {
+    errors = updatePoseRelativeToGraph(*this->dataPtr->poseRelativeToGraph,
+        _model.Name(),
+        _model.PoseRelativeTo().empty() ? "world" : _model.PoseRelativeTo(),
+        _model.RawPose());
+    if (!errors.empty())
     {
-      return true;
+      return errors;
     }
   }
-  return false;
+
+  *model = std::move(_model);
+  model->SetPoseRelativeToGraph(this->dataPtr->poseRelativeToGraph);
+  resetSpatialIndices(*this->dataPtr);
+  return errors;
+}
+
+/////////////////////////////////////////////////
+Errors World::RemoveModel(const std::string &_name)
+{
+  Errors errors;
+  const Model *model =
+      this->dataPtr->modelIndex.Find(this->dataPtr->models, _name);
+  if (!model)
+  {
+    errors.push_back({ErrorCode::ELEMENT_MISSING,
+        "No model with name[" + _name + "] to remove from world with "
+        "name[" + this->Name() + "]."});
+    return errors;
+  }
+
+  prepareGraphs(*this->dataPtr);
+  errors = removeFrameFromGraphs(this->dataPtr->frameAttachedToGraph.get(),
+      *this->dataPtr->poseRelativeToGraph, _name);
+  if (!errors.empty())
+  {
+    return errors;
+  }
+
+  this->dataPtr->modelIndex.Erase(this->dataPtr->models,
+      static_cast<std::size_t>(model - this->dataPtr->models.data()));
+  resetSpatialIndices(*this->dataPtr);
+  return errors;
+}
+
+/////////////////////////////////////////////////
+Errors World::AddFrame(Frame &&_frame)
+{
+  prepareGraphs(*this->dataPtr);
+
+  // Use the same default attached_to and relative_to frames as
+  // buildFrameAttachedToGraph and buildPoseRelativeToGraph.
+  const std::string attachedTo =
+      _frame.AttachedTo().empty() ? "world" : _frame.AttachedTo();
+  Errors errors = addFrameToGraphs(this->dataPtr->frameAttachedToGraph.get(),
+      *this->dataPtr->poseRelativeToGraph, _frame.Name(), FrameType::FRAME,
+      attachedTo,
+      _frame.PoseRelativeTo().empty() ? attachedTo : _frame.PoseRelativeTo(),
+      _frame.RawPose(), false);
+  if (!errors.empty())
+  {
+    return errors;
+  }
+
+  this->dataPtr->frames.push_back(std::move(_frame));
+  this->dataPtr->frameIndex.AddLast(this->dataPtr->frames);
+  Frame &frame = this->dataPtr->frames.back();
+  frame.SetFrameAttachedToGraph(this->dataPtr->frameAttachedToGraph);
+  frame.SetPoseRelativeToGraph(this->dataPtr->poseRelativeToGraph);
+  return errors;
+}
+
+/////////////////////////////////////////////////
+bool World::AddLight(Light &&_light)
+{
+  if (this->LightNameExists(_light.Name()))
+  {
+    return false;
+  }
+
+  prepareGraphs(*this->dataPtr);
+  this->dataPtr->lights.push_back(std::move(_light));
+  this->dataPtr->lightIndex.AddLast(this->dataPtr->lights);
+  Light &light = this->dataPtr->lights.back();
+  light.SetXmlParentName("world");
+  light.SetPoseRelativeToGraph(this->dataPtr->poseRelativeToGraph);
+  return true;
+}
+
+/////////////////////////////////////////////////
+bool World::AddActor(Actor &&_actor)
+{
+  if (this->ActorNameExists(_actor.Name()))
+  {
+    return false;
+  }
+
+  this->dataPtr->actors.push_back(std::move(_actor));
+  this->dataPtr->actorIndex.AddLast(this->dataPtr->actors);
+  return true;
 }
 
 /////////////////////////////////////////////////
@@ -607,16 +1064,10 @@ const Actor *World::ActorByIndex(const uint64_t _index) const
 }
 
 /////////////////////////////////////////////////
-bool World::ActorNameExists(const std::string &_name) const
+bool World::ActorNameExists(std::string_view _name) const
 {
-  for (auto const &a : this->dataPtr->actors)
-  {
-    if (a.Name() == _name)
-    {
-      return true;
-    }
-  }
-  return false;
+  return this->dataPtr->actorIndex.Find(this->dataPtr->actors, _name) !=
+      nullptr;
 }
 
 //////////////////////////////////////////////////
@@ -638,6 +1089,13 @@ const Physics *World::PhysicsDefault() const
 {
   if (!this->dataPtr->physics.empty())
   {
+    // Profiles can be marked as default after loading, so the cached
+    // default is only used while it is still marked.
+    const Physics &cached =
+        this->dataPtr->physics[this->dataPtr->defaultPhysics];
+    if (cached.IsDefault())
+      return &cached;
+
     for (const Physics &physics : this->dataPtr->physics)
     {
       if (physics.IsDefault())
@@ -651,15 +1109,503 @@ const Physics *World::PhysicsDefault() const
 }
 
 //////////////////////////////////////////////////
-bool World::PhysicsNameExists(const std::string &_name) const
+bool World::PhysicsNameExists(std::string_view _name) const
 {
-  for (const Physics &physics : this->dataPtr->physics)
+  return this->dataPtr->physicsIndex.Find(this->dataPtr->physics, _name) !=
+      nullptr;
+}
+
+/////////////////////////////////////////////////
+Errors World::ResolveFramePoses(std::vector<ignition::math::Pose3d> &_poses,
+    const std::string &_relativeTo) const
+{
+  Errors errors;
+
+  if (!this->dataPtr->poseRelativeToGraph)
   {
-    if (physics.Name() == _name)
+    errors.push_back({ErrorCode::ELEMENT_INVALID,
+        "World has invalid pointer to PoseRelativeToGraph."});
+    return errors;
+  }
+
+  std::vector<std::string> frameNames;
+  frameNames.reserve(1 + this->dataPtr->models.size() +
+      this->dataPtr->frames.size());
+  frameNames.push_back("world");
+  for (auto const &model : this->dataPtr->models)
+  {
+    frameNames.push_back(model.Name());
+  }
+  for (auto const &frame : this->dataPtr->frames)
+  {
+    frameNames.push_back(frame.Name());
+  }
+
+  return resolvePoses(_poses, *this->dataPtr->poseRelativeToGraph,
+      frameNames, _relativeTo.empty() ? "world" : _relativeTo);
+}
+
+/////////////////////////////////////////////////
+/// \brief Poses of the objects of WorldPoses before they are composed, in
+/// the same order.
+struct ObjectPoseBatches
+{
+  /// \brief Pose of the frame that the raw pose of each object is relative
+  /// to, in the frame of its model, or in the world frame for a light of
+  /// the world.
+  PoseBatch frames;
+
+  /// \brief Raw pose of each object.
+  PoseBatch raw;
+
+  /// \brief Pose of the model of each object in the world frame, or the
+  /// identity for a light of the world.
+  PoseBatch models;
+};
+
+/////////////////////////////////////////////////
+/// \brief Append an object to WorldPoses. Its pose in the world frame is
+/// _modelPose * _framePose * _rawPose, which is composed later for all
+/// the objects at once.
+/// \param[in,out] _poses The arrays.
+/// \param[in,out] _batches The poses to compose.
+/// \param[in] _type Kind of the object.
+/// \param[in] _model Index of its model, or -1.
+/// \param[in] _link Index of its link, or -1.
+/// \param[in] _index Index of the object in its parent.
+/// \param[in] _name Scoped name of the object.
+/// \param[in] _framePose Pose of its relative_to frame.
+/// \param[in] _rawPose Raw pose of the object.
+/// \param[in] _modelPose Pose of its model in the world frame.
+static void addObjectPose(WorldPoses &_poses, ObjectPoseBatches &_batches,
+    const WorldPoseType _type, const int64_t _model, const int64_t _link,
+    const uint64_t _index, std::string _name,
+    const ignition::math::Pose3d &_framePose,
+    const ignition::math::Pose3d &_rawPose,
+    const ignition::math::Pose3d &_modelPose)
+{
+  _poses.types.push_back(_type);
+  _poses.modelIndices.push_back(_model);
+  _poses.linkIndices.push_back(_link);
+  _poses.indices.push_back(_index);
+  _poses.names.push_back(std::move(_name));
+  _batches.frames.Add(_framePose);
+  _batches.raw.Add(_rawPose);
+  _batches.models.Add(_modelPose);
+}
+
+/////////////////////////////////////////////////
+/// \brief Find the resolved pose of the frame that the raw pose of an
+/// object is relative to.
+/// \param[in] _frames Resolved poses of the frames of the scope, by name.
+/// \param[in] _relativeTo The relative_to frame of the object.
+/// \param[in] _default The frame used if _relativeTo is empty.
+/// \param[in] _name Scoped name of the object, for errors.
+/// \param[out] _errors Errors.
+/// \return The resolved pose of the frame, or nullptr if it is not found.
+static const ignition::math::Pose3d *relativeToPose(
+    const std::unordered_map<std::string, ignition::math::Pose3d> &_frames,
+    const std::string &_relativeTo, const std::string &_default,
+    const std::string &_name, Errors &_errors)
+{
+  const std::string &frame = _relativeTo.empty() ? _default : _relativeTo;
+  auto frameIt = _frames.find(frame);
+  if (frameIt == _frames.end())
+  {
+    _errors.push_back({ErrorCode::POSE_RELATIVE_TO_INVALID,
+        "relative_to name[" + frame + "] specified by [" + _name +
+        "] does not match a frame name."});
+    return nullptr;
+  }
+  return &frameIt->second;
+}
+
+/////////////////////////////////////////////////
+Errors World::ResolveObjectPoses(WorldPoses &_poses) const
+{
+  std::vector<ignition::math::Pose3d> worldFrames;
+  Errors errors = this->ResolveFramePoses(worldFrames);
+  if (!errors.empty())
+    return errors;
+
+  const auto &models = this->dataPtr->models;
+  const auto &frames = this->dataPtr->frames;
+  std::unordered_map<std::string, ignition::math::Pose3d> worldFrameMap;
+  worldFrameMap.reserve(worldFrames.size());
+  worldFrameMap.emplace("world", worldFrames[0]);
+  for (std::size_t m = 0; m < models.size(); ++m)
+    worldFrameMap.emplace(models[m].Name(), worldFrames[1 + m]);
+  for (std::size_t f = 0; f < frames.size(); ++f)
+  {
+    worldFrameMap.emplace(frames[f].Name(),
+        worldFrames[1 + models.size() + f]);
+  }
+
+  const ignition::math::Pose3d &identity = ignition::math::Pose3d::Zero;
+  WorldPoses result;
+  ObjectPoseBatches batches;
+  std::vector<ignition::math::Pose3d> modelFrames;
+  std::unordered_map<std::string, ignition::math::Pose3d> modelFrameMap;
+  for (std::size_t m = 0; m < models.size(); ++m)
+  {
+    const Model &model = models[m];
+    const ignition::math::Pose3d &modelPose = worldFrames[1 + m];
+    const int64_t modelIndex = static_cast<int64_t>(m);
+    addObjectPose(result, batches, WorldPoseType::MODEL, modelIndex, -1, m,
+        model.Name(), identity, identity, modelPose);
+
+    // The frames of the model are resolved once relative to the model
+    // frame, which covers the frames of nested models since they are
+    // flattened into the model.
+    Errors modelErrors = model.ResolveFramePoses(modelFrames);
+    if (!modelErrors.empty())
     {
-      return true;
+      errors.insert(errors.end(), modelErrors.begin(), modelErrors.end());
+      continue;
+    }
+
+    const uint64_t linkCount = model.LinkCount();
+    const uint64_t jointCount = model.JointCount();
+    modelFrameMap.clear();
+    modelFrameMap.reserve(modelFrames.size());
+    modelFrameMap.emplace("__model__", modelFrames[0]);
+    for (uint64_t l = 0; l < linkCount; ++l)
+      modelFrameMap.emplace(model.LinkByIndex(l)->Name(), modelFrames[1 + l]);
+    for (uint64_t j = 0; j < jointCount; ++j)
+    {
+      modelFrameMap.emplace(model.JointByIndex(j)->Name(),
+          modelFrames[1 + linkCount + j]);
+    }
+    for (uint64_t f = 0; f < model.FrameCount(); ++f)
+    {
+      modelFrameMap.emplace(model.FrameByIndex(f)->Name(),
+          modelFrames[1 + linkCount + jointCount + f]);
+    }
+
+    for (uint64_t l = 0; l < linkCount; ++l)
+    {
+      const Link *link = model.LinkByIndex(l);
+      const int64_t linkIndex = static_cast<int64_t>(l);
+      const std::string linkName = model.Name() + "::" + link->Name();
+      const ignition::math::Pose3d &linkPose = modelFrames[1 + l];
+      addObjectPose(result, batches, WorldPoseType::LINK, modelIndex, -1, l,
+          linkName, linkPose, identity, modelPose);
+
+      // The children of a link are relative to the link by default, or to
+      // another frame of the model.
+      auto addChild = [&](const WorldPoseType _type, const uint64_t _index,
+          const std::string &_name, const std::string &_relativeTo,
+          const ignition::math::Pose3d &_rawPose)
+      {
+        std::string name = linkName + "::" + _name;
+        const ignition::math::Pose3d *framePose = _relativeTo.empty() ?
+            &linkPose : relativeToPose(modelFrameMap, _relativeTo,
+                link->Name(), name, errors);
+        if (framePose)
+        {
+          addObjectPose(result, batches, _type, modelIndex, linkIndex,
+              _index, std::move(name), *framePose, _rawPose, modelPose);
+        }
+      };
+      for (uint64_t i = 0; i < link->VisualCount(); ++i)
+      {
+        const Visual *visual = link->VisualByIndex(i);
+        addChild(WorldPoseType::VISUAL, i, visual->Name(),
+            visual->PoseRelativeTo(), visual->RawPose());
+      }
+      for (uint64_t i = 0; i < link->CollisionCount(); ++i)
+      {
+        const Collision *collision = link->CollisionByIndex(i);
+        addChild(WorldPoseType::COLLISION, i, collision->Name(),
+            collision->PoseRelativeTo(), collision->RawPose());
+      }
+      for (uint64_t i = 0; i < link->SensorCount(); ++i)
+      {
+        const Sensor *sensor = link->SensorByIndex(i);
+        addChild(WorldPoseType::SENSOR, i, sensor->Name(),
+            sensor->PoseRelativeTo(), sensor->RawPose());
+      }
+      for (uint64_t i = 0; i < link->LightCount(); ++i)
+      {
+        const Light *light = link->LightByIndex(i);
+        addChild(WorldPoseType::LIGHT, i, light->Name(),
+            light->PoseRelativeTo(), light->RawPose());
+      }
+    }
+  }
+
+  for (std::size_t i = 0; i < this->dataPtr->lights.size(); ++i)
+  {
+    const Light &light = this->dataPtr->lights[i];
+    const ignition::math::Pose3d *framePose = relativeToPose(worldFrameMap,
+        light.PoseRelativeTo(), "world", light.Name(), errors);
+    if (framePose)
+    {
+      addObjectPose(result, batches, WorldPoseType::LIGHT, -1, -1, i,
+          light.Name(), *framePose, light.RawPose(), identity);
+    }
+  }
+
+  if (!errors.empty())
+    return errors;
+
+  // Compose the poses one level at a time for all the objects: the raw
+  // poses with their relative_to frames, then with their models.
+  composePoses(batches.frames, batches.raw, batches.raw);
+  composePoses(batches.models, batches.raw, batches.raw);
+  result.poses.resize(batches.raw.Size());
+  for (std::size_t i = 0; i < result.poses.size(); ++i)
+    result.poses[i] = batches.raw.Pose(i);
+
+  _poses = std::move(result);
+  return errors;
+}
+
+/////////////////////////////////////////////////
+void World::ResolveCollisionFilter(CollisionFilter &_filter) const
+{
+  CollisionFilterBuilder builder;
+  const auto &models = this->dataPtr->models;
+  for (std::size_t m = 0; m < models.size(); ++m)
+  {
+    for (uint64_t l = 0; l < models[m].LinkCount(); ++l)
+    {
+      const Link *link = models[m].LinkByIndex(l);
+      for (uint64_t c = 0; c < link->CollisionCount(); ++c)
+      {
+        const Contact *contact =
+            link->CollisionByIndex(c)->Surface()->Contact();
+        builder.Add(m, l, c, contact->CategoryBitmask(),
+            contact->CollideBitmask());
+      }
+    }
+  }
+  builder.Finish(_filter);
+}
+
+/////////////////////////////////////////////////
+void World::ResolveSurfaceMaterials(SurfaceMaterials &_materials) const
+{
+  SurfaceMaterialBuilder builder;
+  const auto &models = this->dataPtr->models;
+  for (std::size_t m = 0; m < models.size(); ++m)
+  {
+    for (uint64_t l = 0; l < models[m].LinkCount(); ++l)
+    {
+      const Link *link = models[m].LinkByIndex(l);
+      for (uint64_t c = 0; c < link->CollisionCount(); ++c)
+      {
+        builder.Add(m, l, c,
+            link->CollisionByIndex(c)->Surface()->Parameters());
+      }
     }
   }
+  builder.Finish(_materials);
+}
 
-  return false;
+/////////////////////////////////////////////////
+void World::ResolveSensorSchedule(SensorSchedule &_schedule) const
+{
+  struct Entry
+  {
+    double rate;
+    uint64_t model;
+    uint64_t link;
+    uint64_t sensor;
+  };
+  std::vector<Entry> entries;
+  const auto &models = this->dataPtr->models;
+  for (std::size_t m = 0; m < models.size(); ++m)
+  {
+    for (uint64_t l = 0; l < models[m].LinkCount(); ++l)
+    {
+      const Link *link = models[m].LinkByIndex(l);
+      for (uint64_t s = 0; s < link->SensorCount(); ++s)
+      {
+        double rate = link->SensorByIndex(s)->UpdateRate();
+        if (!(rate > 0) || !std::isfinite(rate))
+          rate = 0;
+        entries.push_back({rate, m, l, s});
+      }
+    }
+  }
+
+  // A stable sort keeps the sensors of each group in document order.
+  std::stable_sort(entries.begin(), entries.end(),
+      [](const Entry &_a, const Entry &_b) {return _a.rate < _b.rate;});
+
+  _schedule.modelIndices.clear();
+  _schedule.linkIndices.clear();
+  _schedule.sensorIndices.clear();
+  _schedule.rates.clear();
+  _schedule.groupOffsets.clear();
+  _schedule.modelIndices.reserve(entries.size());
+  _schedule.linkIndices.reserve(entries.size());
+  _schedule.sensorIndices.reserve(entries.size());
+  for (std::size_t i = 0; i < entries.size(); ++i)
+  {
+    if (i == 0 || entries[i].rate != entries[i - 1].rate)
+    {
+      _schedule.rates.push_back(entries[i].rate);
+      _schedule.groupOffsets.push_back(i);
+    }
+    _schedule.modelIndices.push_back(entries[i].model);
+    _schedule.linkIndices.push_back(entries[i].link);
+    _schedule.sensorIndices.push_back(entries[i].sensor);
+  }
+  _schedule.groupOffsets.push_back(entries.size());
+}
+
+/////////////////////////////////////////////////
+Errors World::ResolveRenderBatches(RenderBatches &_batches) const
+{
+  WorldPoses poses;
+  Errors errors = this->ResolveObjectPoses(poses);
+  if (!errors.empty())
+    return errors;
+
+  RenderBatchBuilder builder;
+  const auto &models = this->dataPtr->models;
+  for (std::size_t i = 0; i < poses.types.size(); ++i)
+  {
+    if (poses.types[i] != WorldPoseType::VISUAL)
+      continue;
+    const uint64_t model = static_cast<uint64_t>(poses.modelIndices[i]);
+    const uint64_t link = static_cast<uint64_t>(poses.linkIndices[i]);
+    builder.Add(model, link, poses.indices[i],
+        *models[model].LinkByIndex(link)->VisualByIndex(poses.indices[i]),
+        poses.poses[i]);
+  }
+  builder.Finish(_batches);
+  return errors;
+}
+
+/////////////////////////////////////////////////
+Errors World::ResolveLightCulling(LightCulling &_culling,
+    const double _cellSize) const
+{
+  WorldPoses poses;
+  Errors errors = this->ResolveObjectPoses(poses);
+  if (!errors.empty())
+    return errors;
+
+  LightCullingBuilder builder;
+  const auto &models = this->dataPtr->models;
+  for (std::size_t i = 0; i < poses.types.size(); ++i)
+  {
+    if (poses.types[i] != WorldPoseType::LIGHT)
+      continue;
+    const Light *light = poses.modelIndices[i] < 0 ?
+        &this->dataPtr->lights[poses.indices[i]] :
+        models[poses.modelIndices[i]].LinkByIndex(
+            poses.linkIndices[i])->LightByIndex(poses.indices[i]);
+    builder.Add(poses.modelIndices[i], poses.linkIndices[i],
+        poses.indices[i], *light, poses.poses[i]);
+  }
+  builder.Finish(_cellSize, _culling);
+  return errors;
+}
+
+/////////////////////////////////////////////////
+Errors World::UpdateFramePose(const std::string &_name,
+    const ignition::math::Pose3d &_pose, const std::string &_relativeTo)
+{
+  Errors errors;
+
+  if (!this->dataPtr->poseRelativeToGraph)
+  {
+    errors.push_back({ErrorCode::ELEMENT_INVALID,
+        "World has invalid pointer to PoseRelativeToGraph."});
+    return errors;
+  }
+
+  Model *model = this->dataPtr->modelIndex.Find(this->dataPtr->models, _name);
+  Frame *frame = model ? nullptr :
+      this->dataPtr->frameIndex.Find(this->dataPtr->frames, _name);
+
+  // Use the same default relative_to frames as buildPoseRelativeToGraph.
+  std::string relativeTo = _relativeTo;
+  if (model)
+  {
+    if (relativeTo.empty())
+      relativeTo = "world";
+  }
+  else if (frame)
+  {
+    if (relativeTo.empty())
+      relativeTo = frame->AttachedTo().empty() ? "world" :
+          frame->AttachedTo();
+  }
+  else
+  {
+    errors.push_back({ErrorCode::POSE_RELATIVE_TO_INVALID,
+        "No model or frame with name[" + _name +
+        "] in world with name[" + this->Name() + "]."});
+    return errors;
+  }
+
+  errors = updatePoseRelativeToGraph(
+      *this->dataPtr->poseRelativeToGraph, _name, relativeTo, _pose);
+  if (!errors.empty())
+  {
+    return errors;
+  }
+
+  if (model)
+  {
+    model->SetRawPose(_pose);
+    model->SetPoseRelativeTo(_relativeTo);
+  }
+  else
+  {
+    frame->SetRawPose(_pose);
+    frame->SetPoseRelativeTo(_relativeTo);
+  }
+
+  // Moving a frame moves the models whose poses are relative to it.
+  resetSpatialIndices(*this->dataPtr);
+  return errors;
+}
+
+/////////////////////////////////////////////////
+std::vector<const Model *> World::ModelsInBox(
+    const ignition::math::Vector3d &_min,
+    const ignition::math::Vector3d &_max,
+    const ModelBoundsType _bounds) const
+{
+  std::vector<const Model *> models;
+  for (const uint64_t m :
+       spatialIndex(*this, *this->dataPtr, _bounds)->InBox(_min, _max))
+  {
+    models.push_back(&this->dataPtr->models[m]);
+  }
+  return models;
+}
+
+/////////////////////////////////////////////////
+std::vector<const Model *> World::ModelsNear(
+    const ignition::math::Vector3d &_point, const double _radius,
+    const ModelBoundsType _bounds) const
+{
+  std::vector<const Model *> models;
+  for (const uint64_t m :
+       spatialIndex(*this, *this->dataPtr, _bounds)->Near(_point, _radius))
+  {
+    models.push_back(&this->dataPtr->models[m]);
+  }
+  return models;
+}
+
+/////////////////////////////////////////////////
+std::size_t World::Compact()
+{
+  resetSpatialIndices(*this->dataPtr);
+  std::size_t bytes = shrinkToFit(this->dataPtr->frames) +
+      shrinkToFit(this->dataPtr->lights) +
+      shrinkToFit(this->dataPtr->actors) +
+      shrinkToFit(this->dataPtr->models) +
+      shrinkToFit(this->dataPtr->physics);
+  for (Model &model : this->dataPtr->models)
+    bytes += model.Compact();
+  return bytes;
 }
@@ -17,7 +17,13 @@
 
 #include <gtest/gtest.h>
 #include <ignition/math/Color.hh>
+#include <ignition/math/Pose3.hh>
 #include <ignition/math/Vector3.hh>
+#include "sdf/Actor.hh"
+#include "sdf/Frame.hh"
+#include "sdf/Light.hh"
+#include "sdf/Link.hh"
+#include "sdf/Model.hh"
 #include "sdf/World.hh"
 
 /////////////////////////////////////////////////
@@ -327,3 +333,55 @@ TEST(DOMWorld, SetScene)
   EXPECT_TRUE(world.Scene()->Shadows());
   EXPECT_TRUE(world.Scene()->OriginVisual());
 }
+
+/////////////////////////////////////////////////
+TEST(DOMWorld, AddFrames)
+{
+  using Pose = ignition::math::Pose3d;
+
+  sdf::World world;
+  world.SetName("built");
+
+  sdf::Frame frame;
+  frame.SetName("table");
+  frame.SetRawPose(Pose(1, 0, 0, 0, 0, 0));
+  EXPECT_TRUE(world.AddFrame(std::move(frame)).empty());
+
+  sdf::Link link;
+  link.SetName("link");
+  sdf::Model model;
+  model.SetName("box");
+  model.SetRawPose(Pose(0, 2, 0, 0, 0, 0));
+  model.SetPoseRelativeTo("table");
+  EXPECT_TRUE(model.AddLink(std::move(link)).empty());
+  EXPECT_TRUE(world.AddModel(std::move(model)).empty());
+
+  sdf::Model duplicate;
+  duplicate.SetName("table");
+  sdf::Errors errors = world.AddModel(std::move(duplicate));
+  ASSERT_EQ(1u, errors.size());
+  EXPECT_EQ(sdf::ErrorCode::DUPLICATE_NAME, errors[0].Code());
+  EXPECT_EQ(1u, world.ModelCount());
+
+  sdf::Light light;
+  light.SetName("sun");
+  EXPECT_TRUE(world.AddLight(std::move(light)));
+  sdf::Light otherLight;
+  otherLight.SetName("sun");
+  EXPECT_FALSE(world.AddLight(std::move(otherLight)));
+  EXPECT_EQ(1u, world.LightCount());
+
+  sdf::Actor actor;
+  actor.SetName("walker");
+  EXPECT_TRUE(world.AddActor(std::move(actor)));
+  EXPECT_TRUE(world.ActorNameExists("walker"));
+
+  ASSERT_NE(nullptr, world.ModelByName("box"));
+  EXPECT_TRUE(world.FrameNameExists("table"));
+
+  Pose pose;
+  EXPECT_TRUE(world.ModelByName("box")->SemanticPose().Resolve(pose).empty());
+  EXPECT_EQ(Pose(1, 2, 0, 0, 0, 0), pose);
+  EXPECT_TRUE(world.LightByIndex(0)->SemanticPose().Resolve(pose).empty());
+  EXPECT_EQ(Pose::Zero, pose);
+}
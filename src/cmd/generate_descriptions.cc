@@ -0,0 +1,72 @@
+/*
+ * Copyright 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include "sdf/Filesystem.hh"
+#include "sdf/SDFImpl.hh"
+#include "sdf/parser.hh"
+
+// Writes the output of `ign sdf --describe` for each version of the
+// specification at build time, so that the command prints a file instead
+// of loading the library and initializing the description.
+
+/////////////////////////////////////////////////
+int main(int _argc, char **_argv)
+{
+  if (_argc < 3)
+  {
+    std::cerr << "Usage: " << _argv[0] << " DIRECTORY VERSION...\n"
+              << "Write the description of each version of the SDFormat "
+              << "specification to DIRECTORY/VERSION.sdf.\n";
+    return 1;
+  }
+
+  const std::string directory = _argv[1];
+  if (!sdf::filesystem::exists(directory) &&
+      !sdf::filesystem::create_directory(directory))
+  {
+    std::cerr << "Unable to create directory [" << directory << "]\n";
+    return 1;
+  }
+
+  for (int i = 2; i < _argc; ++i)
+  {
+    const std::string version = _argv[i];
+    sdf::SDFPtr sdf(new sdf::SDF());
+    sdf->Version(version);
+    if (!sdf::init(sdf))
+    {
+      std::cerr << "Unable to initialize version [" << version << "]\n";
+      return 1;
+    }
+
+    const std::string path =
+        sdf::filesystem::append(directory, version + ".sdf");
+    std::ofstream out(path, std::ios::out | std::ios::binary);
+    sdf->PrintDescription(out);
+    out.close();
+    if (!out)
+    {
+      std::cerr << "Unable to write [" << path << "]\n";
+      return 1;
+    }
+  }
+  return 0;
+}
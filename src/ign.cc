@@ -15,84 +15,160 @@
  *
 */
 
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstddef>
+#include <iomanip>
 #include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
 #include <string.h>
+#include <vector>
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
 
 #include "sdf/sdf_config.h"
 #include "sdf/Filesystem.hh"
+#include "sdf/IncludeCache.hh"
+#include "sdf/ParseEvent.hh"
+#include "sdf/ParserConfig.hh"
 #include "sdf/Root.hh"
 #include "sdf/parser.hh"
 #include "sdf/system_util.hh"
 
 #include "ign.hh"
+#include "Utils.hh"
 
 //////////////////////////////////////////////////
-// cppcheck-suppress unusedFunction
-extern "C" SDFORMAT_VISIBLE int cmdCheck(const char *_path)
+/// \brief Load and check a file, parsing it once.
+/// \param[in] _path Path to the file to validate.
+/// \param[out] _root Root that the file is loaded into.
+/// \param[in] _config Configuration of the load.
+/// \param[out] _out Stream that the errors are printed to.
+/// \return True if the file is valid.
+static bool checkFile(const std::string &_path, sdf::Root &_root,
+    const sdf::ParserConfig &_config, std::ostream &_out)
 {
-  int result = 0;
+  if (!sdf::filesystem::exists(_path))
+  {
+    _out << "Error: File [" << _path << "] does not exist.\n";
+    return false;
+  }
 
-  sdf::Root root;
-  sdf::Errors errors = root.Load(_path);
+  sdf::Errors errors = _root.Load(_path, _config);
   if (!errors.empty())
   {
     for (auto &error : errors)
     {
-      std::cerr << "Error: " << error.Message() << std::endl;
+      _out << "Error: " << error.Message() << std::endl;
     }
-    return -1;
+    return false;
   }
 
-  if (!sdf::checkCanonicalLinkNames(&root))
-  {
-    result = -1;
-  }
-
-  if (!sdf::checkJointParentChildLinkNames(&root))
-  {
-    result = -1;
-  }
+  sdf::ScopedCheckOutput output(_out);
+  return sdf::checkRoot(&_root);
+}
 
-  if (!sdf::checkFrameAttachedToGraph(&root))
+//////////////////////////////////////////////////
+/// \brief Add the SDFormat and URDF files of a directory and of its
+/// subdirectories to a list, in sorted order.
+/// \param[in] _dir Path of the directory.
+/// \param[in,out] _files The list of files.
+static void addDirectoryFiles(const std::string &_dir,
+    std::vector<std::string> &_files)
+{
+  std::vector<std::string> paths;
+  sdf::filesystem::DirIter endIter;
+  for (sdf::filesystem::DirIter dirIter(_dir); dirIter != endIter; ++dirIter)
   {
-    result = -1;
+    paths.push_back(*dirIter);
   }
+  std::sort(paths.begin(), paths.end());
 
-  if (!sdf::checkPoseRelativeToGraph(&root))
+  for (const std::string &path : paths)
   {
-    result = -1;
-  }
+    if (sdf::filesystem::is_directory(path))
+    {
+      addDirectoryFiles(path, _files);
+      continue;
+    }
 
-  if (!sdf::recursiveSiblingUniqueNames(root.Element()))
-  {
-    result = -1;
+    const std::size_t dot = path.rfind('.');
+    const std::string extension =
+        dot == std::string::npos ? std::string() : path.substr(dot);
+    if (extension == ".sdf" || extension == ".world" || extension == ".urdf")
+    {
+      _files.push_back(path);
+    }
   }
+}
 
-  if (!sdf::filesystem::exists(_path))
+//////////////////////////////////////////////////
+// cppcheck-suppress unusedFunction
+extern "C" SDFORMAT_VISIBLE int cmdCheck(const char *_path)
+{
+  sdf::Root root;
+  if (!checkFile(_path, root, sdf::ParserConfig(), std::cerr))
   {
-    std::cerr << "Error: File [" << _path << "] does not exist.\n";
     return -1;
   }
 
-  sdf::SDFPtr sdf(new sdf::SDF());
+  std::cout << "Valid.\n";
+  return 0;
+}
 
-  if (!sdf::init(sdf))
+//////////////////////////////////////////////////
+// cppcheck-suppress unusedFunction
+extern "C" SDFORMAT_VISIBLE int cmdCheckFiles(const char *_paths,
+                                              int _threadCount)
+{
+  std::vector<std::string> files;
+  std::istringstream pathStream(_paths);
+  std::string path;
+  while (std::getline(pathStream, path))
   {
-    std::cerr << "Error: SDF schema initialization failed.\n";
-    return -1;
-  }
+    if (path.empty())
+      continue;
 
-  if (!sdf::readFile(_path, sdf))
-  {
-    std::cerr << "Error: SDF parsing the xml failed.\n";
-    return -1;
+    if (sdf::filesystem::is_directory(path))
+      addDirectoryFiles(path, files);
+    else
+      files.push_back(path);
   }
 
-  if (result == 0)
+  // Each file is checked into its own buffer, and the buffers are printed
+  // in order once all the files are checked.
+  std::vector<std::string> outputs(files.size());
+  std::vector<char> valid(files.size(), 0);
+  sdf::parallelFor(files.size(),
+      static_cast<unsigned int>(std::max(_threadCount, 0)),
+      [&](std::size_t _index)
+      {
+        std::ostringstream out;
+        sdf::Root root;
+        valid[_index] =
+            checkFile(files[_index], root, sdf::ParserConfig(), out);
+        outputs[_index] = out.str();
+      });
+
+  std::size_t invalidCount = 0;
+  for (std::size_t i = 0; i < files.size(); ++i)
   {
-    std::cout << "Valid.\n";
+    std::cout << outputs[i] << files[i] << ": "
+              << (valid[i] ? "Valid." : "Invalid.") << "\n";
+    if (!valid[i])
+      ++invalidCount;
   }
-  return result;
+  std::cout << files.size() - invalidCount << " of " << files.size()
+            << " files are valid.\n";
+
+  return invalidCount == 0 ? 0 : -1;
 }
 
 //////////////////////////////////////////////////
@@ -157,3 +233,601 @@ extern "C" SDFORMAT_VISIBLE int cmdPrint(const char *_path)
 
   return 0;
 }
+
+//////////////////////////////////////////////////
+// cppcheck-suppress unusedFunction
+extern "C" SDFORMAT_VISIBLE int cmdPrintStreaming(const char *_path,
+                                                  int _expandIncludes)
+{
+  if (!sdf::filesystem::exists(_path))
+  {
+    std::cerr << "Error: File [" << _path << "] does not exist.\n";
+    return -1;
+  }
+
+  sdf::Errors errors;
+  if (!sdf::printFileStreaming(_path, std::cout, _expandIncludes != 0,
+        sdf::ParserConfig(), errors))
+  {
+    for (auto &error : errors)
+    {
+      std::cerr << "Error: " << error.Message() << std::endl;
+    }
+    std::cerr << "Error: SDF parsing the xml failed.\n";
+    return -1;
+  }
+
+  return 0;
+}
+
+//////////////////////////////////////////////////
+// cppcheck-suppress unusedFunction
+extern "C" SDFORMAT_VISIBLE int cmdBinary(const char *_path,
+                                          const char *_outPath)
+{
+  if (!sdf::filesystem::exists(_path))
+  {
+    std::cerr << "Error: File [" << _path << "] does not exist.\n";
+    return -1;
+  }
+
+  sdf::Root root;
+  sdf::Errors errors = root.Load(_path);
+  if (errors.empty())
+  {
+    errors = root.SaveBinary(_outPath);
+  }
+
+  if (!errors.empty())
+  {
+    for (auto &error : errors)
+    {
+      std::cerr << "Error: " << error.Message() << std::endl;
+    }
+    return -1;
+  }
+
+  return 0;
+}
+
+//////////////////////////////////////////////////
+// cppcheck-suppress unusedFunction
+extern "C" SDFORMAT_VISIBLE int cmdCompile(const char *_path,
+                                           const char *_outPath)
+{
+  sdf::Root root;
+  if (!checkFile(_path, root, sdf::ParserConfig(), std::cerr))
+  {
+    std::cerr << "Error: [" << _path << "] is not valid, and was not "
+              << "compiled.\n";
+    return -1;
+  }
+
+  sdf::Errors errors = root.SaveBinary(_outPath);
+  if (!errors.empty())
+  {
+    for (auto &error : errors)
+    {
+      std::cerr << "Error: " << error.Message() << std::endl;
+    }
+    return -1;
+  }
+
+  std::cout << "Compiled [" << _path << "] to [" << _outPath << "].\n";
+  return 0;
+}
+
+//////////////////////////////////////////////////
+/// \brief Print the approximate memory used by the elements of a file.
+/// \return 0 on success, -1 if the file could not be loaded.
+// cppcheck-suppress unusedFunction
+extern "C" SDFORMAT_VISIBLE int cmdMemory(const char *_path)
+{
+  if (!sdf::filesystem::exists(_path))
+  {
+    std::cerr << "Error: File [" << _path << "] does not exist.\n";
+    return -1;
+  }
+
+  sdf::Root root;
+  sdf::Errors errors = root.Load(_path);
+  if (!errors.empty())
+  {
+    for (auto &error : errors)
+    {
+      std::cerr << "Error: " << error.Message() << std::endl;
+    }
+    return -1;
+  }
+
+  std::cout << root.MemoryFootprint();
+
+  return 0;
+}
+
+//////////////////////////////////////////////////
+/// \brief Time spent in one parse stage by the loads of a benchmark.
+struct BenchStage
+{
+  /// \brief Name of the stage in the report.
+  const char *name = "";
+
+  /// \brief Number of times the stage ran, over all the loads.
+  std::size_t calls = 0;
+
+  /// \brief Number of elements produced by the stage, over all the loads.
+  std::size_t elements = 0;
+
+  /// \brief Milliseconds spent in the stage by each load. Nested stages,
+  /// such as the reads of included files, are also counted in the stage
+  /// that contains them.
+  std::vector<double> times;
+};
+
+//////////////////////////////////////////////////
+/// \brief Get the name of a parse stage in a benchmark report.
+/// \param[in] _stage The stage.
+/// \return The name.
+static const char *benchStageName(sdf::ParseStage _stage)
+{
+  switch (_stage)
+  {
+    case sdf::ParseStage::READ_FILE:
+      return "read_file";
+    case sdf::ParseStage::FIND_FILE:
+      return "find_file";
+    case sdf::ParseStage::PARSE_XML:
+      return "parse_xml";
+    case sdf::ParseStage::READ_DOC:
+      return "read_doc";
+    case sdf::ParseStage::CONVERT:
+      return "convert";
+    case sdf::ParseStage::INCLUDE:
+      return "include";
+    case sdf::ParseStage::ROOT_LOAD:
+      return "dom_load";
+    case sdf::ParseStage::CHECK:
+      return "check";
+  }
+  return "unknown";
+}
+
+//////////////////////////////////////////////////
+/// \brief Get the mean, minimum and maximum of durations.
+/// \param[in] _times The durations, which must not be empty.
+/// \param[out] _mean The mean.
+/// \param[out] _min The minimum.
+/// \param[out] _max The maximum.
+static void benchStatistics(const std::vector<double> &_times,
+    double &_mean, double &_min, double &_max)
+{
+  _mean = 0;
+  _min = _times.front();
+  _max = _times.front();
+  for (double time : _times)
+  {
+    _mean += time;
+    _min = std::min(_min, time);
+    _max = std::max(_max, time);
+  }
+  _mean /= static_cast<double>(_times.size());
+}
+
+//////////////////////////////////////////////////
+/// \brief Write a string as a JSON string literal.
+/// \param[in] _out Output stream.
+/// \param[in] _str The string.
+static void writeJsonString(std::ostream &_out, const std::string &_str)
+{
+  _out << '"';
+  for (char c : _str)
+  {
+    if (c == '"' || c == '\\')
+      _out << '\\' << c;
+    else if (static_cast<unsigned char>(c) < 0x20)
+    {
+      _out << "\\u" << std::hex << std::setw(4) << std::setfill('0')
+           << static_cast<int>(c) << std::dec << std::setfill(' ');
+    }
+    else
+      _out << c;
+  }
+  _out << '"';
+}
+
+//////////////////////////////////////////////////
+/// \brief Get the peak resident set size of the process.
+/// \return Peak resident set size in kilobytes, or 0 if unknown.
+static std::size_t peakRssKb()
+{
+#ifdef _WIN32
+  return 0;
+#else
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0)
+    return 0;
+#ifdef __APPLE__
+  return static_cast<std::size_t>(usage.ru_maxrss) / 1024;
+#else
+  return static_cast<std::size_t>(usage.ru_maxrss);
+#endif
+#endif
+}
+
+//////////////////////////////////////////////////
+/// \brief Load a file several times, and print the time spent in each
+/// parse stage.
+/// \return 0 on success, -1 if the file could not be loaded.
+// cppcheck-suppress unusedFunction
+extern "C" SDFORMAT_VISIBLE int cmdBench(const char *_path, int _iterations,
+                                         int _json)
+{
+  if (!sdf::filesystem::exists(_path))
+  {
+    std::cerr << "Error: File [" << _path << "] does not exist.\n";
+    return -1;
+  }
+
+  const std::size_t iterations =
+      static_cast<std::size_t>(std::max(_iterations, 1));
+  std::map<sdf::ParseStage, BenchStage> stages;
+  std::vector<double> totals;
+  std::size_t iteration = 0;
+
+  // Stages nest on each thread, so each END event closes the last BEGIN
+  // event of its thread.
+  std::mutex mutex;
+  sdf::ParseEventCallback previousCallback = sdf::parseEventCallback();
+  sdf::setParseEventCallback([&](const sdf::ParseEvent &_event)
+      {
+        using Clock = std::chrono::steady_clock;
+        static thread_local std::vector<Clock::time_point> starts;
+        if (_event.type == sdf::ParseEventType::BEGIN)
+        {
+          starts.push_back(Clock::now());
+          return;
+        }
+        if (starts.empty())
+          return;
+
+        const double time = std::chrono::duration<double, std::milli>(
+            Clock::now() - starts.back()).count();
+        starts.pop_back();
+
+        std::lock_guard<std::mutex> lock(mutex);
+        BenchStage &stage = stages[_event.stage];
+        stage.name = benchStageName(_event.stage);
+        stage.times.resize(iterations, 0.0);
+        stage.times[iteration] += time;
+        ++stage.calls;
+        stage.elements += _event.elementCount;
+      });
+
+  // The messages of the checks are discarded, since only their time
+  // matters.
+  std::ostringstream checkMessages;
+  int result = 0;
+  for (; iteration < iterations; ++iteration)
+  {
+    const auto start = std::chrono::steady_clock::now();
+    sdf::Root root;
+    sdf::Errors errors = root.Load(_path);
+    if (!errors.empty())
+    {
+      for (auto &error : errors)
+      {
+        std::cerr << "Error: " << error.Message() << std::endl;
+      }
+      result = -1;
+      break;
+    }
+    {
+      sdf::ScopedCheckOutput output(checkMessages);
+      sdf::checkRoot(&root);
+    }
+    checkMessages.str("");
+    totals.push_back(std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - start).count());
+  }
+  sdf::setParseEventCallback(previousCallback);
+
+  if (result != 0)
+    return result;
+
+  double mean, min, max;
+  if (_json)
+  {
+    std::cout << "{\"file\": ";
+    writeJsonString(std::cout, _path);
+    benchStatistics(totals, mean, min, max);
+    std::cout << ", \"iterations\": " << iterations
+              << ", \"total\": {\"mean_ms\": " << mean
+              << ", \"min_ms\": " << min << ", \"max_ms\": " << max
+              << "}, \"stages\": {";
+    bool first = true;
+    for (const auto &stage : stages)
+    {
+      benchStatistics(stage.second.times, mean, min, max);
+      std::cout << (first ? "" : ", ") << '"' << stage.second.name
+                << "\": {\"calls\": " << stage.second.calls / iterations
+                << ", \"elements\": " << stage.second.elements / iterations
+                << ", \"mean_ms\": " << mean << ", \"min_ms\": " << min
+                << ", \"max_ms\": " << max << '}';
+      first = false;
+    }
+    std::cout << "}, \"peak_rss_kb\": " << peakRssKb() << "}\n";
+    return 0;
+  }
+
+  std::cout << "File: " << _path << "\n"
+            << "Iterations: " << iterations << "\n\n"
+            << std::left << std::setw(12) << "stage" << std::right
+            << std::setw(8) << "calls" << std::setw(10) << "elements"
+            << std::setw(12) << "mean ms" << std::setw(12) << "min ms"
+            << std::setw(12) << "max ms" << "\n"
+            << std::fixed << std::setprecision(3);
+  for (const auto &stage : stages)
+  {
+    benchStatistics(stage.second.times, mean, min, max);
+    std::cout << std::left << std::setw(12) << stage.second.name
+              << std::right << std::setw(8)
+              << stage.second.calls / iterations << std::setw(10)
+              << stage.second.elements / iterations << std::setw(12) << mean
+              << std::setw(12) << min << std::setw(12) << max << "\n";
+  }
+  benchStatistics(totals, mean, min, max);
+  std::cout << std::left << std::setw(30) << "total" << std::right
+            << std::setw(12) << mean << std::setw(12) << min
+            << std::setw(12) << max << "\n\n"
+            << "Peak RSS: " << peakRssKb() << " kB\n";
+  return 0;
+}
+
+//////////////////////////////////////////////////
+/// \brief Read a JSON string literal.
+/// \param[in] _text The text.
+/// \param[in,out] _pos Position of the opening quote, set to the position
+/// after the closing quote.
+/// \param[out] _str The decoded string.
+/// \return True if the literal is valid.
+static bool readJsonString(const std::string &_text, std::size_t &_pos,
+    std::string &_str)
+{
+  _str.clear();
+  if (_pos >= _text.size() || _text[_pos] != '"')
+    return false;
+
+  for (++_pos; _pos < _text.size(); ++_pos)
+  {
+    const char c = _text[_pos];
+    if (c == '"')
+    {
+      ++_pos;
+      return true;
+    }
+    if (c != '\\')
+    {
+      _str += c;
+      continue;
+    }
+
+    if (++_pos >= _text.size())
+      return false;
+    switch (_text[_pos])
+    {
+      case '"': _str += '"'; break;
+      case '\\': _str += '\\'; break;
+      case '/': _str += '/'; break;
+      case 'b': _str += '\b'; break;
+      case 'f': _str += '\f'; break;
+      case 'n': _str += '\n'; break;
+      case 'r': _str += '\r'; break;
+      case 't': _str += '\t'; break;
+      case 'u':
+      {
+        if (_pos + 4 >= _text.size())
+          return false;
+        unsigned int code = 0;
+        std::istringstream hex(_text.substr(_pos + 1, 4));
+        if (!(hex >> std::hex >> code))
+          return false;
+        _pos += 4;
+
+        // Encode the code point, which is in the basic multilingual plane,
+        // as UTF-8.
+        if (code < 0x80)
+        {
+          _str += static_cast<char>(code);
+        }
+        else if (code < 0x800)
+        {
+          _str += static_cast<char>(0xC0 | (code >> 6));
+          _str += static_cast<char>(0x80 | (code & 0x3F));
+        }
+        else
+        {
+          _str += static_cast<char>(0xE0 | (code >> 12));
+          _str += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+          _str += static_cast<char>(0x80 | (code & 0x3F));
+        }
+        break;
+      }
+      default:
+        return false;
+    }
+  }
+  return false;
+}
+
+//////////////////////////////////////////////////
+/// \brief Parse a JSON object whose values are strings, numbers, booleans
+/// or null.
+/// \param[in] _text The text of the object.
+/// \param[out] _fields Value of each key. Strings are decoded, and other
+/// values are kept as written.
+/// \param[out] _rawFields JSON text of the value of each key.
+/// \return True if the object is valid.
+static bool parseJsonObject(const std::string &_text,
+    std::map<std::string, std::string> &_fields,
+    std::map<std::string, std::string> &_rawFields)
+{
+  auto skipSpace = [&_text](std::size_t &_pos)
+  {
+    while (_pos < _text.size() && std::isspace(
+          static_cast<unsigned char>(_text[_pos])))
+    {
+      ++_pos;
+    }
+  };
+
+  std::size_t pos = 0;
+  skipSpace(pos);
+  if (pos >= _text.size() || _text[pos] != '{')
+    return false;
+  ++pos;
+  skipSpace(pos);
+  if (pos < _text.size() && _text[pos] == '}')
+    return true;
+
+  while (pos < _text.size())
+  {
+    std::string key;
+    skipSpace(pos);
+    if (!readJsonString(_text, pos, key))
+      return false;
+    skipSpace(pos);
+    if (pos >= _text.size() || _text[pos] != ':')
+      return false;
+    ++pos;
+    skipSpace(pos);
+
+    const std::size_t start = pos;
+    if (pos < _text.size() && _text[pos] == '"')
+    {
+      if (!readJsonString(_text, pos, _fields[key]))
+        return false;
+    }
+    else
+    {
+      while (pos < _text.size() && _text[pos] != ',' && _text[pos] != '}' &&
+             !std::isspace(static_cast<unsigned char>(_text[pos])))
+      {
+        ++pos;
+      }
+      if (pos == start)
+        return false;
+      _fields[key] = _text.substr(start, pos - start);
+    }
+    _rawFields[key] = _text.substr(start, pos - start);
+
+    skipSpace(pos);
+    if (pos < _text.size() && _text[pos] == ',')
+    {
+      ++pos;
+      continue;
+    }
+    return pos < _text.size() && _text[pos] == '}';
+  }
+  return false;
+}
+
+//////////////////////////////////////////////////
+/// \brief Write the lines of a text as a JSON array of strings.
+/// \param[in] _out Output stream.
+/// \param[in] _text The text.
+static void writeJsonLines(std::ostream &_out, const std::string &_text)
+{
+  _out << '[';
+  std::istringstream lines(_text);
+  std::string line;
+  bool first = true;
+  while (std::getline(lines, line))
+  {
+    if (line.empty())
+      continue;
+    _out << (first ? "" : ", ");
+    writeJsonString(_out, line);
+    first = false;
+  }
+  _out << ']';
+}
+
+//////////////////////////////////////////////////
+/// \brief Answer the requests of a client of 'ign sdf --serve', one JSON
+/// object per line, until the input ends or a shutdown request. The
+/// include cache and the initialized specification are kept between
+/// requests, so that only the first request pays for them.
+/// \return 0 when the input ends.
+// cppcheck-suppress unusedFunction
+extern "C" SDFORMAT_VISIBLE int cmdServe()
+{
+  sdf::ParserConfig config;
+  config.SetIncludeCache(std::make_shared<sdf::IncludeCache>());
+
+  std::string line;
+  while (std::getline(std::cin, line))
+  {
+    if (line.find_first_not_of(" \t\r") == std::string::npos)
+      continue;
+
+    std::map<std::string, std::string> request;
+    std::map<std::string, std::string> rawRequest;
+    std::ostringstream messages;
+    std::ostringstream output;
+    bool valid = false;
+    bool shutdown = false;
+
+    if (!parseJsonObject(line, request, rawRequest))
+    {
+      messages << "Error: Invalid request, which must be a JSON object on "
+               << "a single line.\n";
+    }
+    else if (request["command"] == "shutdown")
+    {
+      valid = true;
+      shutdown = true;
+    }
+    else if (request["path"].empty())
+    {
+      messages << "Error: The request has no path.\n";
+    }
+    else if (request["command"] == "check")
+    {
+      sdf::Root root;
+      valid = checkFile(request["path"], root, config, messages);
+    }
+    else if (request["command"] == "print")
+    {
+      sdf::Errors errors;
+      sdf::SDFPtr sdf = sdf::readFile(request["path"], config, errors);
+      for (auto &error : errors)
+      {
+        messages << "Error: " << error.Message() << std::endl;
+      }
+      valid = sdf && errors.empty();
+      if (sdf)
+        output << sdf->Root()->ToString("");
+    }
+    else
+    {
+      messages << "Error: Unknown command [" << request["command"]
+               << "]. The commands are check, print and shutdown.\n";
+    }
+
+    std::cout << "{\"id\": "
+              << (rawRequest.count("id") ? rawRequest["id"] : "null")
+              << ", \"valid\": " << (valid ? "true" : "false")
+              << ", \"errors\": ";
+    writeJsonLines(std::cout, messages.str());
+    if (request["command"] == "print")
+    {
+      std::cout << ", \"output\": ";
+      writeJsonString(std::cout, output.str());
+    }
+    std::cout << "}" << std::endl;
+
+    if (shutdown)
+      break;
+  }
+  return 0;
+}
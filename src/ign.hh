@@ -32,6 +32,72 @@ inline namespace SDF_VERSION_NAMESPACE {
 /// \return Zero on success, negative one otherwise.
 extern "C" SDFORMAT_VISIBLE int cmdCheck(const char *_path);
 
+/// \brief External hook to execute 'ign sdf -k' with several files or a
+/// directory from the command line. The files are checked concurrently,
+/// and the result of each is printed in order.
+/// \param[in] _paths Paths to the files to validate, separated by new
+/// lines. The SDFormat and URDF files of a directory and of its
+/// subdirectories are validated.
+/// \param[in] _threadCount Number of threads, or 0 for one per hardware
+/// thread.
+/// \return Zero if every file is valid, negative one otherwise.
+extern "C" SDFORMAT_VISIBLE int cmdCheckFiles(const char *_paths,
+                                              int _threadCount);
+
+/// \brief External hook to execute 'ign sdf -p --stream' from the command
+/// line, which prints a converted file with sdf::printFileStreaming.
+/// \param[in] _path Path to the file to print.
+/// \param[in] _expandIncludes Nonzero to expand the includes and print the
+/// default values, like 'ign sdf -p', zero to only convert the XML.
+/// \return Zero on success, negative one otherwise.
+extern "C" SDFORMAT_VISIBLE int cmdPrintStreaming(const char *_path,
+                                                  int _expandIncludes);
+
+/// \brief External hook to execute 'ign sdf -b' from the command line.
+/// \param[in] _path Path to the SDFormat file to convert.
+/// \param[in] _outPath Path of the binary file to write.
+/// \return Zero on success, negative one otherwise.
+extern "C" SDFORMAT_VISIBLE int cmdBinary(const char *_path,
+                                          const char *_outPath);
+
+/// \brief External hook to execute 'ign sdf -c' from the command line.
+/// Loads a file with its includes expanded and converted to the latest
+/// version, runs the checks of 'ign sdf -k' on it, and writes it in the
+/// binary format if it is valid.
+/// \param[in] _path Path to the SDFormat or URDF file to compile.
+/// \param[in] _outPath Path of the binary file to write.
+/// \return Zero on success, negative one otherwise.
+extern "C" SDFORMAT_VISIBLE int cmdCompile(const char *_path,
+                                           const char *_outPath);
+
+/// \brief External hook to execute 'ign sdf --bench' from the command
+/// line. Loads and checks a file several times, and prints the time spent
+/// in each parse stage, as reported by the parse events, and the peak
+/// resident set size of the process.
+/// \param[in] _path Path to the file to load.
+/// \param[in] _iterations Number of loads.
+/// \param[in] _json Nonzero to print the report as JSON.
+/// \return Zero on success, negative one otherwise.
+extern "C" SDFORMAT_VISIBLE int cmdBench(const char *_path, int _iterations,
+                                         int _json);
+
+/// \brief External hook to execute 'ign sdf --serve' from the command
+/// line. Reads requests from the standard input, one JSON object per line,
+/// and writes one JSON object per line with the response of each, until
+/// the input ends. A request has an "id", which is copied to its response,
+/// a "command", and the "path" of a file:
+///
+///     {"id": 1, "command": "check", "path": "/path/to/model.sdf"}
+///
+/// The "check" command checks the file like 'ign sdf -k', and the "print"
+/// command also returns the converted file in the "output" of the
+/// response, like 'ign sdf -p'. Every response has "valid", and the
+/// "errors" as an array of strings. The "shutdown" command stops the
+/// server. The include cache is kept between requests, and updated when
+/// files change.
+/// \return Zero when the input ends.
+extern "C" SDFORMAT_VISIBLE int cmdServe();
+
 /// \brief External hook to read the library version.
 /// \return C-string representing the version. Ex.: 0.1.2
 extern "C" SDFORMAT_VISIBLE char *ignitionVersion();
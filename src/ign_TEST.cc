@@ -18,9 +18,12 @@
 #include <gtest/gtest.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <sstream>
 #include <string>
 
+#include "sdf/Filesystem.hh"
 #include "sdf/parser.hh"
+#include "sdf/Root.hh"
 #include "sdf/SDFImpl.hh"
 #include "sdf/sdf_config.h"
 #include "test_config.h"
@@ -596,6 +599,47 @@ TEST(check_model_sdf, SDF)
   }
 }
 
+/////////////////////////////////////////////////
+TEST(check_files, SDF)
+{
+  std::string pathBase = PROJECT_SOURCE_PATH;
+  pathBase += "/test/sdf";
+
+  // Check several files on two threads. The results are printed in order.
+  {
+    std::string good = pathBase + "/box_plane_low_friction_test.world";
+    std::string bad = pathBase + "/world_duplicate.sdf";
+
+    std::string output =
+      custom_exec_str(g_ignCommand + " sdf -j 2 -k " + good + " " + bad +
+                      g_sdfVersion);
+    std::size_t goodPos = output.find(good + ": Valid.\n");
+    std::size_t errorPos =
+      output.find("Error: World with name[default] already exists.");
+    std::size_t badPos = output.find(bad + ": Invalid.\n");
+    ASSERT_NE(std::string::npos, goodPos) << output;
+    ASSERT_NE(std::string::npos, errorPos) << output;
+    ASSERT_NE(std::string::npos, badPos) << output;
+    EXPECT_LT(goodPos, errorPos) << output;
+    EXPECT_LT(errorPos, badPos) << output;
+    EXPECT_NE(output.find("1 of 2 files are valid.\n"), std::string::npos)
+      << output;
+  }
+
+  // Check the files of a directory.
+  {
+    std::string path = PROJECT_SOURCE_PATH;
+    path += "/test/integration/model/box";
+
+    std::string output =
+      custom_exec_str(g_ignCommand + " sdf -k " + path + g_sdfVersion);
+    EXPECT_NE(output.find(path + "/model.sdf: Valid.\n"), std::string::npos)
+      << output;
+    EXPECT_NE(output.find("1 of 1 files are valid.\n"), std::string::npos)
+      << output;
+  }
+}
+
 /////////////////////////////////////////////////
 TEST(describe, SDF)
 {
@@ -608,6 +652,23 @@ TEST(describe, SDF)
   EXPECT_EQ(0u, output.find("<element name ='sdf' required ='1'"));
 }
 
+/////////////////////////////////////////////////
+TEST(describe, Preformatted)
+{
+  // The command prints the description generated at build time, which
+  // must be the one of the library.
+  EXPECT_TRUE(sdf::filesystem::exists(sdf::filesystem::append(
+      PROJECT_BINARY_DIR, "sdf", "describe",
+      std::string(SDF_PROTOCOL_VERSION) + ".sdf")));
+
+  sdf::SDFPtr sdf(new sdf::SDF());
+  ASSERT_TRUE(sdf::init(sdf));
+  std::ostringstream expected;
+  sdf->PrintDescription(expected);
+  EXPECT_EQ(expected.str(),
+            custom_exec_str(g_ignCommand + " sdf -d " + g_sdfVersion));
+}
+
 /////////////////////////////////////////////////
 TEST(print, SDF)
 {
@@ -638,6 +699,215 @@ TEST(print, SDF)
   }
 }
 
+/////////////////////////////////////////////////
+TEST(print, Streaming)
+{
+  std::string pathBase = PROJECT_SOURCE_PATH;
+  pathBase += "/test/sdf";
+
+  // Stream a good SDF file
+  {
+    std::string path = pathBase +"/box_plane_low_friction_test.world";
+    std::ostringstream expected;
+    sdf::Errors errors;
+    EXPECT_TRUE(sdf::printFileStreaming(path, expected, true,
+          sdf::ParserConfig(), errors));
+
+    std::string output = custom_exec_str(g_ignCommand + " sdf -p " + path +
+        " --stream" + g_sdfVersion);
+    EXPECT_EQ(expected.str(), output);
+  }
+
+  // Only convert a file with includes
+  {
+    std::string path = pathBase +"/includes.sdf";
+    std::string output = custom_exec_str(g_ignCommand + " sdf -p " + path +
+        " --stream --keep-includes" + g_sdfVersion);
+    EXPECT_NE(std::string::npos, output.find("<include>"));
+  }
+}
+
+/////////////////////////////////////////////////
+TEST(binary, SDF)
+{
+  std::string pathBase = PROJECT_SOURCE_PATH;
+  pathBase += "/test/sdf";
+
+  // Convert a good SDF file
+  {
+    std::string path = pathBase +"/box_plane_low_friction_test.world";
+    std::string outPath = std::string(PROJECT_BINARY_DIR) +
+      "/test/box_plane_low_friction_test.sdfb";
+    sdf::Root root;
+    EXPECT_TRUE(root.Load(path).empty());
+
+    std::string output = custom_exec_str(g_ignCommand + " sdf -b " + path +
+        " -o " + outPath + g_sdfVersion);
+    EXPECT_EQ("", output);
+
+    sdf::Root binaryRoot;
+    EXPECT_TRUE(binaryRoot.LoadBinary(outPath).empty());
+    ASSERT_NE(nullptr, binaryRoot.Element());
+    EXPECT_EQ(root.Element()->ToString(""),
+              binaryRoot.Element()->ToString(""));
+  }
+
+  // Convert a bad SDF file
+  {
+    std::string path = pathBase +"/box_bad_test.world";
+    std::string outPath = std::string(PROJECT_BINARY_DIR) +
+      "/test/box_bad_test.sdfb";
+
+    std::string output = custom_exec_str(g_ignCommand + " sdf -b " + path +
+        " -o " + outPath + g_sdfVersion);
+    EXPECT_NE(std::string::npos, output.find("Error:")) << output;
+  }
+}
+
+/////////////////////////////////////////////////
+TEST(compile, SDF)
+{
+  std::string pathBase = PROJECT_SOURCE_PATH;
+  pathBase += "/test/sdf";
+
+  // Compile a valid SDF file
+  {
+    std::string path = pathBase +"/box_plane_low_friction_test.world";
+    std::string outPath = std::string(PROJECT_BINARY_DIR) +
+      "/test/box_plane_low_friction_test_compiled.sdfb";
+    sdf::Root root;
+    EXPECT_TRUE(root.Load(path).empty());
+
+    std::string output = custom_exec_str(g_ignCommand + " sdf -c " + path +
+        " -o " + outPath + g_sdfVersion);
+    EXPECT_EQ("Compiled [" + path + "] to [" + outPath + "].\n", output);
+
+    sdf::Root binaryRoot;
+    EXPECT_TRUE(binaryRoot.LoadBinary(outPath).empty());
+    ASSERT_NE(nullptr, binaryRoot.Element());
+    EXPECT_EQ(root.Element()->ToString(""),
+              binaryRoot.Element()->ToString(""));
+  }
+
+  // A file that loads but fails the checks is not compiled
+  {
+    std::string path = pathBase +"/world_duplicate.sdf";
+    std::string outPath = std::string(PROJECT_BINARY_DIR) +
+      "/test/world_duplicate_compiled.sdfb";
+
+    std::string output = custom_exec_str(g_ignCommand + " sdf -c " + path +
+        " -o " + outPath + g_sdfVersion);
+    EXPECT_NE(std::string::npos, output.find("was not compiled")) << output;
+    EXPECT_FALSE(sdf::filesystem::exists(outPath));
+  }
+}
+
+/////////////////////////////////////////////////
+TEST(serve, SDF)
+{
+  std::string pathBase = PROJECT_SOURCE_PATH;
+  pathBase += "/test/sdf";
+  std::string good = pathBase + "/box_plane_low_friction_test.world";
+  std::string bad = pathBase + "/world_duplicate.sdf";
+
+  // Each request is answered on its own line, until a shutdown request.
+  std::string requests =
+    "'{\"id\": 1, \"command\": \"check\", \"path\": \"" + good + "\"}' "
+    "'{\"id\": \"b\", \"command\": \"check\", \"path\": \"" + bad +
+    "\"}' "
+    "'{\"id\": 3, \"command\": \"print\", \"path\": \"" + good + "\"}' "
+    "'not json' "
+    "'{\"id\": 5, \"command\": \"shutdown\"}' "
+    "'{\"id\": 6, \"command\": \"check\", \"path\": \"" + good + "\"}'";
+  std::string output = custom_exec_str("printf '%s\\n' " + requests +
+      " | " + g_ignCommand + " sdf --serve" + g_sdfVersion);
+
+  EXPECT_NE(std::string::npos,
+      output.find("{\"id\": 1, \"valid\": true, \"errors\": []}\n"))
+    << output;
+  EXPECT_NE(std::string::npos,
+      output.find("{\"id\": \"b\", \"valid\": false, \"errors\": [\""))
+    << output;
+  EXPECT_NE(std::string::npos, output.find("already exists")) << output;
+  EXPECT_NE(std::string::npos, output.find(
+      "{\"id\": 3, \"valid\": true, \"errors\": [], \"output\": \"<sdf"))
+    << output;
+  EXPECT_NE(std::string::npos,
+      output.find("{\"id\": null, \"valid\": false, \"errors\": [\""))
+    << output;
+  EXPECT_NE(std::string::npos,
+      output.find("{\"id\": 5, \"valid\": true, \"errors\": []}\n"))
+    << output;
+  EXPECT_EQ(std::string::npos, output.find("{\"id\": 6")) << output;
+}
+
+/////////////////////////////////////////////////
+TEST(memory, SDF)
+{
+  std::string pathBase = PROJECT_SOURCE_PATH;
+  pathBase += "/test/sdf";
+
+  // Print the footprint of a good SDF file
+  {
+    std::string path = pathBase +"/box_plane_low_friction_test.world";
+
+    std::string output =
+      custom_exec_str(g_ignCommand + " sdf -m " + path + g_sdfVersion);
+    EXPECT_EQ(0u, output.find("element")) << output;
+    EXPECT_NE(std::string::npos, output.find("\nmodel ")) << output;
+    EXPECT_NE(std::string::npos, output.find("\ntotal ")) << output;
+  }
+
+  // Print the footprint of a bad SDF file
+  {
+    std::string path = pathBase +"/box_bad_test.world";
+
+    std::string output =
+      custom_exec_str(g_ignCommand + " sdf -m " + path + g_sdfVersion);
+    EXPECT_NE(std::string::npos, output.find("Error:")) << output;
+  }
+}
+
+/////////////////////////////////////////////////
+TEST(bench, SDF)
+{
+  std::string pathBase = PROJECT_SOURCE_PATH;
+  pathBase += "/test/sdf";
+  std::string path = pathBase +"/box_plane_low_friction_test.world";
+
+  // Print a table of the parse stages
+  {
+    std::string output =
+      custom_exec_str(g_ignCommand + " sdf --bench " + path + " -n 2" +
+                      g_sdfVersion);
+    EXPECT_NE(std::string::npos, output.find("Iterations: 2\n")) << output;
+    EXPECT_NE(std::string::npos, output.find("\nparse_xml ")) << output;
+    EXPECT_NE(std::string::npos, output.find("\ndom_load ")) << output;
+    EXPECT_NE(std::string::npos, output.find("\ntotal ")) << output;
+    EXPECT_NE(std::string::npos, output.find("Peak RSS: ")) << output;
+  }
+
+  // Print the report as JSON
+  {
+    std::string output =
+      custom_exec_str(g_ignCommand + " sdf --bench " + path +
+                      " -n 2 --json" + g_sdfVersion);
+    EXPECT_EQ(0u, output.find("{\"file\": \"" + path + "\"")) << output;
+    EXPECT_NE(std::string::npos, output.find("\"iterations\": 2")) << output;
+    EXPECT_NE(std::string::npos, output.find("\"parse_xml\": {\"calls\": "))
+      << output;
+    EXPECT_NE(std::string::npos, output.find("\"peak_rss_kb\": ")) << output;
+  }
+
+  // Report the errors of a bad SDF file
+  {
+    std::string output =
+      custom_exec_str(g_ignCommand + " sdf --bench " + pathBase +
+                      "/box_bad_test.world" + g_sdfVersion);
+    EXPECT_NE(std::string::npos, output.find("Error:")) << output;
+  }
+}
+
 /////////////////////////////////////////////////
 /// Main
 int main(int argc, char **argv)
@@ -15,19 +15,39 @@
  *
  */
 
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <iomanip>
 #include <iostream>
 #include <cstdlib>
+#include <cstring>
 #include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <sstream>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
+#include <ignition/math/Pose3.hh>
 #include <ignition/math/SemanticVersion.hh>
 
 #include "sdf/Console.hh"
 #include "sdf/Filesystem.hh"
 #include "sdf/Frame.hh"
+#include "sdf/InternedString.hh"
 #include "sdf/Joint.hh"
 #include "sdf/Link.hh"
 #include "sdf/Model.hh"
+#include "sdf/ModelIndex.hh"
 #include "sdf/Param.hh"
 #include "sdf/Root.hh"
 #include "sdf/SDFImpl.hh"
@@ -36,9 +56,17 @@
 #include "sdf/sdf_config.h"
 
 #include "Converter.hh"
+#include "ElementArena.hh"
+#include "ElementReadTable.hh"
+#include "EmbeddedSdf.hh"
 #include "FrameSemantics.hh"
+#include "MappedFile.hh"
 #include "parser_private.hh"
 #include "parser_urdf.hh"
+#include "ScopedParseEvent.hh"
+#include "SpecVersion.hh"
+#include "TaskPool.hh"
+#include "Utils.hh"
 
 namespace sdf
 {
@@ -53,12 +81,14 @@ inline namespace SDF_VERSION_NAMESPACE {
 /// \param[in] _filename Name of the SDF file
 /// \param[in] _sdf Pointer to an SDF object.
 /// \param[in] _convert Convert to the latest version if true.
+/// \param[in] _config Custom parser configuration
 /// \param[out] _errors Parsing errors will be appended to this variable.
 /// \return True if successful.
 bool readFileInternal(
     const std::string &_filename,
     SDFPtr _sdf,
     const bool _convert,
+    const ParserConfig &_config,
     Errors &_errors);
 
 /// \brief Internal helper for readString, which populates the SDF values
@@ -67,23 +97,72 @@ bool readFileInternal(
 /// This populates the sdf pointer from a string. If the string is from a URDF
 /// file it is converted to SDF first. Conversion to the latest
 /// SDF version is controlled by a function parameter.
-/// \param[in] _xmlString XML string to be parsed.
+/// \param[in] _data XML to be parsed, as described in the overload of
+/// sdf::readString that takes a buffer.
+/// \param[in] _size Size of _data in bytes.
+/// \param[in] _urdfStr The XML as a string, if the caller has one, which
+/// the URDF parser reads. Otherwise the document is printed for it.
 /// \param[in] _sdf Pointer to an SDF object.
 /// \param[in] _convert Convert to the latest version if true.
+/// \param[in] _config Custom parser configuration
 /// \param[out] _errors Parsing errors will be appended to this variable.
 /// \return True if successful.
 bool readStringInternal(
-    const std::string &_xmlString,
+    const char *_data,
+    std::size_t _size,
+    const std::string &_urdfStr,
     SDFPtr _sdf,
     const bool _convert,
+    const ParserConfig &_config,
     Errors &_errors);
 
+//////////////////////////////////////////////////
+/// \brief Parse an XML document from a buffer. TiXmlDocument::Parse reads
+/// up to a null character, so a buffer whose last byte is one is parsed in
+/// place, and other buffers are copied once to add it.
+/// \param[out] _doc Document to parse.
+/// \param[in] _data The buffer.
+/// \param[in] _size Size of the buffer in bytes.
+static void parseXmlBuffer(TiXmlDocument &_doc, const char *_data,
+    const std::size_t _size)
+{
+  if (_size > 0 && _data[_size - 1] == '\0')
+  {
+    _doc.Parse(_data);
+  }
+  else
+  {
+    _doc.Parse(std::string(_data, _size).c_str());
+  }
+}
+
+//////////////////////////////////////////////////
+/// \brief Report a step of reading a file to the progress callback of a
+/// configuration, if any.
+/// \param[in] _config The configuration.
+/// \param[in] _type The step.
+/// \param[in] _filename Path of the file.
+/// \param[in] _bytes Size of the file, for LoadProgressType::FILE_PARSED.
+static void reportFileProgress(const ParserConfig &_config,
+    const LoadProgressType _type, const std::string &_filename,
+    const std::size_t _bytes = 0)
+{
+  if (!_config.ProgressCallback())
+    return;
+
+  LoadProgress progress;
+  progress.type = _type;
+  progress.name = _filename;
+  progress.bytes = _bytes;
+  _config.ProgressCallback()(progress);
+}
+
 //////////////////////////////////////////////////
 template <typename TPtr>
 static inline bool _initFile(const std::string &_filename, TPtr _sdf)
 {
   TiXmlDocument xmlDoc;
-  if (xmlDoc.LoadFile(_filename))
+  if (loadXmlFile(xmlDoc, _filename))
   {
     return initDoc(&xmlDoc, _sdf);
   }
@@ -95,18 +174,125 @@ static inline bool _initFile(const std::string &_filename, TPtr _sdf)
   return false;
 }
 
+//////////////////////////////////////////////////
+/// \brief Initialize an element description from the precompiled
+/// description tables. This is equivalent to calling initXml on the XML
+/// the tables were generated from.
+/// \param[in] _descriptions The precompiled description tables.
+/// \param[in] _index Index of the description in the element table.
+/// \param[in,out] _sdf Element to initialize.
+static void initEmbedded(const EmbeddedSdfDescriptions &_descriptions,
+    unsigned int _index, ElementPtr _sdf)
+{
+  const EmbeddedSdfElement &desc = _descriptions.elements[_index];
+
+  if (desc.ref)
+  {
+    _sdf->SetReferenceSDF(desc.ref);
+  }
+
+  _sdf->SetName(desc.name);
+  _sdf->SetRequired(desc.required);
+
+  if (desc.type)
+  {
+    _sdf->AddValue(desc.type, desc.defaultValue ? desc.defaultValue : "",
+        std::string(desc.required) == "1",
+        desc.description ? desc.description : "");
+  }
+
+  for (unsigned int i = 0; i < desc.attributeCount; ++i)
+  {
+    const EmbeddedSdfAttribute &attr =
+        _descriptions.attributes[desc.firstAttribute + i];
+    _sdf->AddAttribute(attr.name, attr.type, attr.defaultValue,
+        attr.required, attr.description ? attr.description : "");
+  }
+
+  if (desc.description)
+  {
+    _sdf->SetDescription(desc.description);
+  }
+
+  if (desc.copyChildren)
+  {
+    _sdf->SetCopyChildren(true);
+  }
+
+  for (unsigned int i = 0; i < desc.childCount; ++i)
+  {
+    const EmbeddedSdfChild &child =
+        _descriptions.children[desc.firstChild + i];
+
+    ElementPtr element(new Element);
+    if (child.element >= 0)
+    {
+      initEmbedded(_descriptions, static_cast<unsigned int>(child.element),
+          element);
+    }
+    else
+    {
+      initFile(child.filename, element);
+
+      // override description for include elements
+      if (child.description)
+      {
+        element->SetDescription(child.description);
+      }
+    }
+    _sdf->AddElementDescription(element);
+  }
+}
+
+//////////////////////////////////////////////////
+/// \brief Initialize an element description from the precompiled
+/// description of a file of the current SDF version.
+/// \param[in] _filename Name of the description file, such as "root.sdf".
+/// \param[in,out] _sdf Element to initialize.
+/// \return True if a precompiled description of the file exists.
+static bool initEmbeddedFile(const std::string &_filename, ElementPtr _sdf)
+{
+  const EmbeddedSdfFile *file =
+      FindEmbeddedSdf(currentSpecVersion().version, _filename);
+  if (file == nullptr || file->description < 0)
+  {
+    return false;
+  }
+
+  initEmbedded(GetEmbeddedSdfDescriptions(),
+      static_cast<unsigned int>(file->description), _sdf);
+  return true;
+}
+
 //////////////////////////////////////////////////
 bool init(SDFPtr _sdf)
 {
+  if (initEmbeddedFile("root.sdf", _sdf->Root()))
+  {
+    return true;
+  }
+
   std::string xmldata = SDF::EmbeddedSpec("root.sdf", false);
   TiXmlDocument xmlDoc;
   xmlDoc.Parse(xmldata.c_str());
   return initDoc(&xmlDoc, _sdf);
 }
 
+//////////////////////////////////////////////////
+bool init(SDFPtr _sdf, const ParserConfig &_config)
+{
+  ScopedSpecVersion spec(_config);
+  return init(_sdf);
+}
+
 //////////////////////////////////////////////////
 bool initFile(const std::string &_filename, SDFPtr _sdf)
 {
+  if (initEmbeddedFile(_filename, _sdf->Root()))
+  {
+    return true;
+  }
+
   std::string xmldata = SDF::EmbeddedSpec(_filename, true);
   if (!xmldata.empty())
   {
@@ -120,6 +306,11 @@ bool initFile(const std::string &_filename, SDFPtr _sdf)
 //////////////////////////////////////////////////
 bool initFile(const std::string &_filename, ElementPtr _sdf)
 {
+  if (initEmbeddedFile(_filename, _sdf))
+  {
+    return true;
+  }
+
   std::string xmldata = SDF::EmbeddedSpec(_filename, true);
   if (!xmldata.empty())
   {
@@ -321,13 +512,20 @@ bool initXml(TiXmlElement *_xml, ElementPtr _sdf)
 
 //////////////////////////////////////////////////
 SDFPtr readFile(const std::string &_filename, Errors &_errors)
+{
+  return readFile(_filename, ParserConfig(), _errors);
+}
+
+//////////////////////////////////////////////////
+SDFPtr readFile(const std::string &_filename, const ParserConfig &_config,
+    Errors &_errors)
 {
   // Create and initialize the data structure that will hold the parsed SDF data
   sdf::SDFPtr sdfParsed(new sdf::SDF());
-  sdf::init(sdfParsed);
+  sdf::init(sdfParsed, _config);
 
   // Read an SDF file, and store the result in sdfParsed.
-  if (!sdf::readFile(_filename, sdfParsed, _errors))
+  if (!sdf::readFile(_filename, _config, sdfParsed, _errors))
   {
     return SDFPtr();
   }
@@ -364,22 +562,237 @@ bool readFile(const std::string &_filename, SDFPtr _sdf)
 //////////////////////////////////////////////////
 bool readFile(const std::string &_filename, SDFPtr _sdf, Errors &_errors)
 {
-  return readFileInternal(_filename, _sdf, true, _errors);
+  return readFileInternal(_filename, _sdf, true, ParserConfig(), _errors);
+}
+
+//////////////////////////////////////////////////
+bool readFile(const std::string &_filename, const ParserConfig &_config,
+    SDFPtr _sdf, Errors &_errors)
+{
+  return readFileInternal(_filename, _sdf, true, _config, _errors);
 }
 
 //////////////////////////////////////////////////
 bool readFileWithoutConversion(
     const std::string &_filename, SDFPtr _sdf, Errors &_errors)
 {
-  return readFileInternal(_filename, _sdf, false, _errors);
+  return readFileInternal(_filename, _sdf, false, ParserConfig(), _errors);
+}
+
+//////////////////////////////////////////////////
+/// \brief Prefix of the comment that records the origin of a document in
+/// the conversion cache.
+static const char kConversionCacheComment[] = " sdformat conversion cache:";
+
+//////////////////////////////////////////////////
+/// \brief Get the path of the conversion cache entry of a file.
+/// \param[in] _filename Path of the file.
+/// \return Path of the entry, or an empty string if the cache is disabled
+/// or the file cannot be read.
+static std::string conversionCachePath(const std::string &_filename)
+{
+  const std::string cacheDir = conversionCacheDirectory();
+  if (cacheDir.empty())
+  {
+    return "";
+  }
+
+  std::ifstream file(_filename, std::ios::binary);
+  if (!file)
+  {
+    return "";
+  }
+
+  // 64-bit FNV-1a hash of the file content, which is stable across runs
+  // and platforms, unlike std::hash.
+  std::uint64_t hash = 14695981039346656037ull;
+  char buffer[4096];
+  while (file.read(buffer, sizeof(buffer)) || file.gcount() > 0)
+  {
+    for (std::streamsize i = 0; i < file.gcount(); ++i)
+    {
+      hash ^= static_cast<unsigned char>(buffer[i]);
+      hash *= 1099511628211ull;
+    }
+  }
+
+  // Documents converted to different versions have different entries.
+  std::ostringstream name;
+  name << "sdformat-" << SDF_VERSION_FULL << "-"
+       << currentSpecVersion().version << "-" << std::hex
+       << std::setw(16) << std::setfill('0') << hash << ".sdf";
+  return sdf::filesystem::append(cacheDir, name.str());
+}
+
+//////////////////////////////////////////////////
+/// \brief Read a document from the conversion cache.
+/// \param[in] _cachePath Path of the cache entry.
+/// \param[in] _filename Path of the file that was converted.
+/// \param[in] _sdf Pointer to an SDF object.
+/// \param[in] _config Custom parser configuration.
+/// \param[out] _errors Parsing errors will be appended to this variable.
+/// \param[out] _found True if a valid entry was found, in which case the
+/// return value is the result of reading it.
+/// \return True if the entry was read.
+static bool readConversionCache(const std::string &_cachePath,
+    const std::string &_filename, SDFPtr _sdf, const ParserConfig &_config,
+    Errors &_errors, bool &_found)
+{
+  _found = false;
+  if (!sdf::filesystem::exists(_cachePath))
+  {
+    return false;
+  }
+
+  TiXmlDocument doc;
+  if (!loadXmlFile(doc, _cachePath))
+  {
+    sdfwarn << "Ignoring unreadable conversion cache entry[" << _cachePath
+            << "].\n";
+    return false;
+  }
+
+  // The first node records whether the file was URDF and its original
+  // version, which readDoc would otherwise take from the document.
+  const TiXmlComment *comment =
+      doc.FirstChild() ? doc.FirstChild()->ToComment() : nullptr;
+  const TiXmlElement *sdfXml = doc.FirstChildElement("sdf");
+  std::string kind;
+  std::string originalVersion;
+  if (comment && std::string(comment->Value()).rfind(
+        kConversionCacheComment, 0) == 0)
+  {
+    std::istringstream stream(
+        std::string(comment->Value()).substr(
+          sizeof(kConversionCacheComment) - 1));
+    stream >> kind >> originalVersion;
+  }
+  if ((kind != "urdf" && kind != "sdf") || originalVersion.empty() ||
+      !sdfXml || !sdfXml->Attribute("version") ||
+      currentSpecVersion().version != sdfXml->Attribute("version"))
+  {
+    sdfwarn << "Ignoring invalid conversion cache entry[" << _cachePath
+            << "].\n";
+    return false;
+  }
+
+  _found = true;
+  if (_sdf->OriginalVersion().empty())
+  {
+    _sdf->SetOriginalVersion(originalVersion);
+  }
+  if (_sdf->Root()->OriginalVersion().empty())
+  {
+    _sdf->Root()->SetOriginalVersion(originalVersion);
+  }
+
+  sdfdbg << "Reading converted file[" << _filename << "] from cache["
+         << _cachePath << "].\n";
+  return readDoc(&doc, _sdf, kind == "urdf" ? "urdf file" : _filename,
+      true, _config, _errors, true);
+}
+
+//////////////////////////////////////////////////
+/// \brief Store a converted document in the conversion cache.
+/// \param[in] _cachePath Path of the cache entry.
+/// \param[in] _doc The converted document.
+/// \param[in] _urdf True if the document was converted from URDF.
+/// \param[in] _originalVersion Version of the document before conversion.
+static void writeConversionCache(const std::string &_cachePath,
+    const TiXmlDocument &_doc, bool _urdf, const std::string &_originalVersion)
+{
+  TiXmlDocument doc;
+  doc.LinkEndChild(new TiXmlComment((std::string(kConversionCacheComment) +
+        (_urdf ? " urdf " : " sdf ") + _originalVersion + " ").c_str()));
+  for (const TiXmlNode *node = _doc.FirstChild(); node;
+       node = node->NextSibling())
+  {
+    if (!node->ToDeclaration())
+    {
+      doc.LinkEndChild(node->Clone());
+    }
+  }
+
+  // Concurrent readers never see a partial entry.
+  if (!replaceFile(_cachePath, [&doc](const std::string &_tmpPath)
+      {
+        return doc.SaveFile(_tmpPath);
+      }))
+  {
+    sdfdbg << "Unable to write conversion cache entry[" << _cachePath
+           << "].\n";
+  }
+}
+
+//////////////////////////////////////////////////
+/// \brief Convert a URDF document directly to the element tree of an SDF
+/// object, when enabled by ParserConfig::DirectUrdfConversion.
+/// \param[in] _xmlDoc The URDF document.
+/// \param[in] _sdf Pointer to an SDF object.
+/// \param[in] _source Source of the document, "urdf file" or "urdf string".
+/// \param[in] _convert Whether the document is converted to the latest
+/// version, which is required by the direct conversion.
+/// \param[in] _config Custom parser configuration.
+/// \param[in] _urdfStr The string from which _xmlDoc was parsed, if it is
+/// available.
+/// \return True if the document was converted. If false, the document is
+/// converted through SDFormat XML instead.
+static bool readUrdfDirect(TiXmlDocument *_xmlDoc, SDFPtr _sdf,
+    const std::string &_source, bool _convert, const ParserConfig &_config,
+    const std::string &_urdfStr = "")
+{
+  if (!_convert || !_config.DirectUrdfConversion() ||
+      !URDF2SDF::IsURDF(_xmlDoc) || nullptr == _sdf ||
+      nullptr == _sdf->Root())
+  {
+    return false;
+  }
+
+  ScopedParseEvent readEvent(ParseStage::READ_DOC,
+      "sdf::URDF2SDF::InitModelElement", _source);
+
+  // Match the file path and original version that readDoc sets for the
+  // converted document, before the elements inherit them.
+  _sdf->SetFilePath(_source);
+  if (_sdf->OriginalVersion().empty())
+  {
+    _sdf->SetOriginalVersion("1.7");
+  }
+  if (_sdf->Root()->OriginalVersion().empty())
+  {
+    _sdf->Root()->SetOriginalVersion("1.7");
+  }
+
+  URDF2SDF u2g;
+  if (!u2g.InitModelElement(_xmlDoc, _sdf->Root(), _urdfStr))
+  {
+    return false;
+  }
+
+  readEvent.SetElements(_sdf->Root());
+  return true;
 }
 
 //////////////////////////////////////////////////
 bool readFileInternal(const std::string &_filename, SDFPtr _sdf,
-      const bool _convert, Errors &_errors)
+      const bool _convert, const ParserConfig &_config, Errors &_errors)
 {
+  ScopedSpecVersion spec(_config);
+  ScopedElementArena arena(_config.ArenaAllocation());
+  ScopedWarningLimit warningScope(_config);
+  ScopedTaskExecutor executor(_config);
+  ScopedParserConfig configScope(_config);
   TiXmlDocument xmlDoc;
-  std::string filename = sdf::findFile(_filename, true, true);
+  ScopedParseEvent readEvent(ParseStage::READ_FILE, "sdf::readFile",
+      _filename);
+
+  std::string filename;
+  {
+    ScopedParseEvent findEvent(ParseStage::FIND_FILE, "sdf::findFile",
+        _filename);
+    filename = sdf::findFile(_filename, true, true);
+    findEvent.SetPath(filename);
+  }
 
   if (filename.empty())
   {
@@ -387,36 +800,108 @@ bool readFileInternal(const std::string &_filename, SDFPtr _sdf,
     return false;
   }
 
-  if (filesystem::is_directory(filename))
+  // A single query for the common case of a file.
+  filesystem::file_status fileStatus = filesystem::status(filename);
+  if (fileStatus.is_directory())
   {
     filename = getModelFilePath(filename);
+    fileStatus = filesystem::status(filename);
   }
 
-  if (!filesystem::exists(filename))
+  if (!fileStatus.exists())
   {
     sdferr << "File [" << filename << "] doesn't exist.\n";
     return false;
   }
 
-  if (!xmlDoc.LoadFile(filename))
+  readEvent.SetPath(filename);
+  reportFileProgress(_config, LoadProgressType::FILE_RESOLVED, filename);
+
+  const std::string cachePath =
+      _convert ? conversionCachePath(filename) : std::string();
+  if (!cachePath.empty())
   {
-    sdferr << "Error parsing XML in file [" << filename << "]: "
-           << xmlDoc.ErrorDesc() << '\n';
-    return false;
+    bool found = false;
+    const bool result = readConversionCache(
+        cachePath, filename, _sdf, _config, _errors, found);
+    if (found)
+    {
+      if (result)
+      {
+        readEvent.SetElements(_sdf->Root());
+      }
+      return result;
+    }
+  }
+
+  {
+    ScopedParseEvent parseEvent(ParseStage::PARSE_XML,
+        "sdf::loadXmlFile", filename);
+    ScopedLoadTimer parseTimer(&LoadCounters::parseXmlNanoseconds);
+    std::size_t bytes = 0;
+    if (!loadXmlFile(xmlDoc, filename, &bytes))
+    {
+      sdferr << "Error parsing XML in file [" << filename << "]: "
+             << xmlDoc.ErrorDesc() << '\n';
+      return false;
+    }
+    parseEvent.SetElements(&xmlDoc);
+    parseEvent.SetBytes(bytes);
+    LoadCounters::Add(&LoadCounters::bytesRead, bytes);
+    reportFileProgress(_config, LoadProgressType::FILE_PARSED, filename,
+        bytes);
+  }
+
+  // The version before readDoc converts the document in place.
+  std::string originalVersion;
+  {
+    const TiXmlElement *sdfXml = xmlDoc.FirstChildElement("sdf");
+    if (sdfXml && sdfXml->Attribute("version"))
+    {
+      originalVersion = sdfXml->Attribute("version");
+    }
   }
 
   // Suppress deprecation for sdf::URDF2SDF
-  if (readDoc(&xmlDoc, _sdf, filename, _convert, _errors))
+  // The document is only used after reading it to write the cache.
+  const bool writeCache =
+      !cachePath.empty() && originalVersion != currentSpecVersion().version;
+  if (readDoc(&xmlDoc, _sdf, filename, _convert, _config, _errors,
+        !writeCache))
+  {
+    if (writeCache)
+    {
+      writeConversionCache(cachePath, xmlDoc, false, originalVersion);
+    }
+    readEvent.SetElements(_sdf->Root());
+    return true;
+  }
+  else if (readUrdfDirect(&xmlDoc, _sdf, "urdf file", _convert, _config))
   {
+    sdfdbg << "parse from urdf file [" << _filename << "].\n";
+    readEvent.SetElements(_sdf->Root());
     return true;
   }
-  else if (URDF2SDF::IsURDF(filename))
+  else if (URDF2SDF::IsURDF(&xmlDoc))
   {
+    // Convert the document that is already parsed instead of loading the
+    // file again.
     URDF2SDF u2g;
-    TiXmlDocument doc = u2g.InitModelFile(filename);
-    if (sdf::readDoc(&doc, _sdf, "urdf file", _convert, _errors))
+    TiXmlDocument doc = u2g.InitModelDoc(&xmlDoc);
+    const TiXmlElement *sdfXml = doc.FirstChildElement("sdf");
+    if (sdfXml && sdfXml->Attribute("version"))
+    {
+      originalVersion = sdfXml->Attribute("version");
+    }
+    if (sdf::readDoc(&doc, _sdf, "urdf file", _convert, _config, _errors,
+          cachePath.empty()))
     {
+      if (!cachePath.empty())
+      {
+        writeConversionCache(cachePath, doc, true, originalVersion);
+      }
       sdfdbg << "parse from urdf file [" << _filename << "].\n";
+      readEvent.SetElements(_sdf->Root());
       return true;
     }
     else
@@ -445,36 +930,86 @@ bool readString(const std::string &_xmlString, SDFPtr _sdf)
 //////////////////////////////////////////////////
 bool readString(const std::string &_xmlString, SDFPtr _sdf, Errors &_errors)
 {
-  return readStringInternal(_xmlString, _sdf, true, _errors);
+  return readString(_xmlString, ParserConfig(), _sdf, _errors);
+}
+
+//////////////////////////////////////////////////
+bool readString(const std::string &_xmlString, const ParserConfig &_config,
+    SDFPtr _sdf, Errors &_errors)
+{
+  // Include the null terminator of the string so that it is parsed in place.
+  return readStringInternal(_xmlString.c_str(), _xmlString.size() + 1,
+      _xmlString, _sdf, true, _config, _errors);
+}
+
+//////////////////////////////////////////////////
+bool readString(const char *_data, std::size_t _size, SDFPtr _sdf,
+    Errors &_errors)
+{
+  return readString(_data, _size, ParserConfig(), _sdf, _errors);
+}
+
+//////////////////////////////////////////////////
+bool readString(const char *_data, std::size_t _size,
+    const ParserConfig &_config, SDFPtr _sdf, Errors &_errors)
+{
+  return readStringInternal(_data, _size, "", _sdf, true, _config, _errors);
 }
 
 //////////////////////////////////////////////////
 bool readStringWithoutConversion(
     const std::string &_filename, SDFPtr _sdf, Errors &_errors)
 {
-  return readStringInternal(_filename, _sdf, false, _errors);
+  return readStringInternal(_filename.c_str(), _filename.size() + 1,
+      _filename, _sdf, false, ParserConfig(), _errors);
 }
 
 //////////////////////////////////////////////////
-bool readStringInternal(const std::string &_xmlString, SDFPtr _sdf,
-    const bool _convert, Errors &_errors)
+bool readStringInternal(const char *_data, std::size_t _size,
+    const std::string &_urdfStr, SDFPtr _sdf, const bool _convert,
+    const ParserConfig &_config, Errors &_errors)
 {
+  ScopedSpecVersion spec(_config);
+  ScopedElementArena arena(_config.ArenaAllocation());
+  ScopedWarningLimit warningScope(_config);
+  ScopedTaskExecutor executor(_config);
+  ScopedParserConfig configScope(_config);
   TiXmlDocument xmlDoc;
-  xmlDoc.Parse(_xmlString.c_str());
-  if (xmlDoc.Error())
   {
-    sdferr << "Error parsing XML from string: " << xmlDoc.ErrorDesc() << '\n';
-    return false;
+    ScopedParseEvent parseEvent(ParseStage::PARSE_XML,
+        "TiXmlDocument::Parse");
+    ScopedLoadTimer parseTimer(&LoadCounters::parseXmlNanoseconds);
+    LoadCounters::Add(&LoadCounters::bytesRead,
+        (_size > 0 && _data[_size - 1] == '\0') ? _size - 1 : _size);
+    parseXmlBuffer(xmlDoc, _data, _size);
+    if (xmlDoc.Error())
+    {
+      sdferr << "Error parsing XML from string: " << xmlDoc.ErrorDesc()
+             << '\n';
+      return false;
+    }
+    parseEvent.SetElements(&xmlDoc);
+  }
+  if (readDoc(&xmlDoc, _sdf, "data-string", _convert, _config, _errors,
+        true))
+  {
+    return true;
   }
-  if (readDoc(&xmlDoc, _sdf, "data-string", _convert, _errors))
+  else if (readUrdfDirect(&xmlDoc, _sdf, "urdf string", _convert, _config,
+        _urdfStr))
   {
+    sdfdbg << "Parsing from urdf.\n";
     return true;
   }
   else
   {
+    // Convert the document that is already parsed instead of parsing the
+    // string again.
     URDF2SDF u2g;
-    TiXmlDocument doc = u2g.InitModelString(_xmlString);
-    if (sdf::readDoc(&doc, _sdf, "urdf string", _convert, _errors))
+    TiXmlDocument doc = _urdfStr.empty() ? u2g.InitModelDoc(&xmlDoc) :
+        u2g.InitModelDoc(&xmlDoc, _urdfStr);
+    if (sdf::readDoc(&doc, _sdf, "urdf string", _convert, _config,
+          _errors, true))
     {
       sdfdbg << "Parsing from urdf.\n";
       return true;
@@ -504,21 +1039,32 @@ bool readString(const std::string &_xmlString, ElementPtr _sdf)
 
 //////////////////////////////////////////////////
 bool readString(const std::string &_xmlString, ElementPtr _sdf, Errors &_errors)
+{
+  // Include the null terminator of the string so that it is parsed in place.
+  return readString(_xmlString.c_str(), _xmlString.size() + 1, _sdf,
+      _errors);
+}
+
+//////////////////////////////////////////////////
+bool readString(const char *_data, std::size_t _size, ElementPtr _sdf,
+    Errors &_errors)
 {
   TiXmlDocument xmlDoc;
-  xmlDoc.Parse(_xmlString.c_str());
+  parseXmlBuffer(xmlDoc, _data, _size);
   if (xmlDoc.Error())
   {
     sdferr << "Error parsing XML from string: " << xmlDoc.ErrorDesc() << '\n';
     return false;
   }
-  if (readDoc(&xmlDoc, _sdf, "data-string", true, _errors))
+  if (readDoc(&xmlDoc, _sdf, "data-string", true, ParserConfig(), _errors,
+        true))
   {
     return true;
   }
   else
   {
-    sdferr << "parse as sdf version " << SDF::Version() << " failed, "
+    sdferr << "parse as sdf version " << currentSpecVersion().version
+           << " failed, "
            << "should try to parse as old deprecated format\n";
     return false;
   }
@@ -526,8 +1072,11 @@ bool readString(const std::string &_xmlString, ElementPtr _sdf, Errors &_errors)
 
 //////////////////////////////////////////////////
 bool readDoc(TiXmlDocument *_xmlDoc, SDFPtr _sdf,
-    const std::string &_source, bool _convert, Errors &_errors)
+    const std::string &_source, bool _convert, const ParserConfig &_config,
+    Errors &_errors, bool _releaseXml)
 {
+  ScopedParseEvent readEvent(ParseStage::READ_DOC, "sdf::readDoc", _source);
+
   if (!_xmlDoc)
   {
     sdfwarn << "Could not parse the xml from source[" << _source << "]\n";
@@ -564,16 +1113,18 @@ bool readDoc(TiXmlDocument *_xmlDoc, SDFPtr _sdf,
       _sdf->Root()->SetOriginalVersion(sdfNode->Attribute("version"));
     }
 
-    if (_convert
-        && strcmp(sdfNode->Attribute("version"), SDF::Version().c_str()) != 0)
+    const std::string &specVersion = currentSpecVersion().version;
+    if (_convert && sdfNode->Attribute("version") != specVersion)
     {
       sdfdbg << "Converting a deprecated source[" << _source << "].\n";
-      Converter::Convert(_xmlDoc, SDF::Version());
+      ScopedLoadTimer convertTimer(&LoadCounters::convertNanoseconds);
+      LoadCounters::Add(&LoadCounters::conversions);
+      Converter::Convert(_xmlDoc, specVersion);
     }
 
     // parse new sdf xml
     TiXmlElement *elemXml = _xmlDoc->FirstChildElement(_sdf->Root()->GetName());
-    if (!readXml(elemXml, _sdf->Root(), _errors))
+    if (!readXml(elemXml, _sdf->Root(), _config, _errors, _releaseXml))
     {
       _errors.push_back({ErrorCode::ELEMENT_INVALID,
           "Error reading element <" + _sdf->Root()->GetName() + ">"});
@@ -594,13 +1145,17 @@ bool readDoc(TiXmlDocument *_xmlDoc, SDFPtr _sdf,
     return false;
   }
 
+  readEvent.SetElements(_sdf->Root());
   return true;
 }
 
 //////////////////////////////////////////////////
 bool readDoc(TiXmlDocument *_xmlDoc, ElementPtr _sdf,
-             const std::string &_source, bool _convert, Errors &_errors)
+             const std::string &_source, bool _convert,
+             const ParserConfig &_config, Errors &_errors, bool _releaseXml)
 {
+  ScopedParseEvent readEvent(ParseStage::READ_DOC, "sdf::readDoc", _source);
+
   if (!_xmlDoc)
   {
     sdfwarn << "Could not parse the xml\n";
@@ -626,11 +1181,13 @@ bool readDoc(TiXmlDocument *_xmlDoc, ElementPtr _sdf,
       _sdf->SetOriginalVersion(sdfNode->Attribute("version"));
     }
 
-    if (_convert
-        && strcmp(sdfNode->Attribute("version"), SDF::Version().c_str()) != 0)
+    const std::string &specVersion = currentSpecVersion().version;
+    if (_convert && sdfNode->Attribute("version") != specVersion)
     {
       sdfwarn << "Converting a deprecated SDF source[" << _source << "].\n";
-      Converter::Convert(_xmlDoc, SDF::Version());
+      ScopedLoadTimer convertTimer(&LoadCounters::convertNanoseconds);
+      LoadCounters::Add(&LoadCounters::conversions);
+      Converter::Convert(_xmlDoc, specVersion);
     }
 
     TiXmlElement *elemXml = sdfNode;
@@ -641,7 +1198,7 @@ bool readDoc(TiXmlDocument *_xmlDoc, ElementPtr _sdf,
     }
 
     // parse new sdf xml
-    if (!readXml(elemXml, _sdf, _errors))
+    if (!readXml(elemXml, _sdf, _config, _errors, _releaseXml))
     {
       _errors.push_back({ErrorCode::ELEMENT_INVALID,
           "Unable to parse sdf element["+ _sdf->GetName() + "]"});
@@ -661,6 +1218,7 @@ bool readDoc(TiXmlDocument *_xmlDoc, ElementPtr _sdf,
     return false;
   }
 
+  readEvent.SetElements(_sdf);
   return true;
 }
 
@@ -729,6 +1287,19 @@ std::string getBestSupportedModelVersion(TiXmlElement *_modelXML,
 
 //////////////////////////////////////////////////
 std::string getModelFilePath(const std::string &_modelDirPath)
+{
+  const std::shared_ptr<ModelIndex> index = modelIndex();
+  if (index)
+  {
+    std::string modelFilePath = index->FindModelFile(_modelDirPath);
+    if (!modelFilePath.empty())
+      return modelFilePath;
+  }
+  return readModelFilePath(_modelDirPath);
+}
+
+//////////////////////////////////////////////////
+std::string readModelFilePath(const std::string &_modelDirPath)
 {
   std::string configFilePath;
 
@@ -755,7 +1326,7 @@ std::string getModelFilePath(const std::string &_modelDirPath)
   }
 
   TiXmlDocument configFileDoc;
-  if (!configFileDoc.LoadFile(configFilePath))
+  if (!loadXmlFile(configFileDoc, configFilePath))
   {
     sdferr << "Error parsing XML in file ["
            << configFilePath << "]: "
@@ -777,53 +1348,1170 @@ std::string getModelFilePath(const std::string &_modelDirPath)
     return std::string();
   }
 
-  return sdf::filesystem::append(_modelDirPath, modelFileName);
+  // The model file can be compressed, as model.sdf.gz for example.
+  return findXmlFile(sdf::filesystem::append(_modelDirPath, modelFileName));
 }
 
 //////////////////////////////////////////////////
-bool readXml(TiXmlElement *_xml, ElementPtr _sdf, Errors &_errors)
+/// \brief Get the description of a spec file that elements refer to with
+/// their ref attribute, for the version documents are read as on the
+/// calling thread. The description must not be modified, so elements are
+/// copied from it.
+/// \param[in] _ref The name of the reference, such as "model".
+/// \return The description.
+static ElementPtr referencedDescription(const std::string &_ref)
 {
-  // Check if the element pointer is deprecated.
-  if (_sdf->GetRequired() == "-1")
+  // Reading the spec file again for every element that refers to it is
+  // expensive, so the description of each version is built once.
+  const SpecVersion &spec = currentSpecVersion();
+  std::lock_guard<std::mutex> lock(spec.referencedDescriptionsMutex);
+  ElementPtr &description = spec.referencedDescriptions[_ref];
+  if (!description)
   {
-    sdfwarn << "SDF Element[" + _sdf->GetName() + "] is deprecated\n";
+    description.reset(new Element);
+    initFile(_ref + ".sdf", description);
   }
+  return description;
+}
 
-  if (!_xml)
+//////////////////////////////////////////////////
+/// \brief Get the SDF that the documents read for <include> elements are
+/// cloned from, for the version documents are read as on the calling
+/// thread.
+/// \return The template.
+static const SDFPtr &includeSDFTemplate()
+{
+  // NOTE: sdf::init is an expensive call. For performance reason,
+  // a new sdf pointer is created for each include by cloning a fresh sdf
+  // template pointer instead of calling init every time.
+  // The template of each version is initialized exactly once, even when
+  // several threads parse files concurrently, and is only read afterwards.
+  const SpecVersion &spec = currentSpecVersion();
+  std::call_once(spec.includeTemplateOnce, [&spec]()
+  {
+    ScopedSpecVersion scope(spec);
+    SDFPtr result(new SDF);
+    init(result);
+    spec.includeTemplate = result;
+  });
+  return spec.includeTemplate;
+}
+
+//////////////////////////////////////////////////
+void warmup(const std::vector<std::string> &_uris)
+{
+  // The template is built with sdf::init, which also parses the embedded
+  // descriptions, and interns the names of the whole specification.
+  includeSDFTemplate();
+  InternedString();
+  Converter::CompileRecipes(SDF::Version());
+
+  for (const std::string &uri : _uris)
   {
-    if (_sdf->GetRequired() == "1" || _sdf->GetRequired() =="+")
-    {
-      _errors.push_back({ErrorCode::ELEMENT_MISSING,
-          "SDF Element<" + _sdf->GetName() + "> is missing"});
-      return false;
-    }
-    else
-    {
-      return true;
+    findFile(uri, true, true);
+  }
+}
+
+//////////////////////////////////////////////////
+/// \brief Scans the tags of an XML document without parsing it, to split
+/// it into elements that are parsed one at a time by printFileStreaming.
+class XmlScanner
+{
+  /// \brief Constructor.
+  /// \param[in] _data The document.
+  /// \param[in] _size Size of the document in bytes.
+  public: XmlScanner(const char *_data, std::size_t _size)
+    : data(_data), size(_size)
+  {
+  }
+
+  /// \brief Move to the next start or end tag, skipping text, comments,
+  /// CDATA sections, processing instructions and declarations.
+  /// \return False if there is no tag left.
+  public: bool NextTag()
+  {
+    while (this->pos < this->size)
+    {
+      if (this->data[this->pos] != '<')
+        ++this->pos;
+      else if (this->StartsWith("<!--"))
+        this->SkipPast("-->");
+      else if (this->StartsWith("<![CDATA["))
+        this->SkipPast("]]>");
+      else if (this->StartsWith("<?"))
+        this->SkipPast("?>");
+      else if (this->StartsWith("<!"))
+        this->SkipPast(">");
+      else
+        return true;
     }
+    return false;
   }
 
-  if (_xml->GetText() != nullptr && _sdf->GetValue())
+  /// \brief Get whether the tag at the position is an end tag.
+  /// \return True for an end tag.
+  public: bool AtEndTag() const
   {
-    if (!_sdf->GetValue()->SetFromString(_xml->GetText()))
-      return false;
+    return this->pos + 1 < this->size && this->data[this->pos + 1] == '/';
   }
 
-  // check for nested sdf
-  std::string refSDFStr = _sdf->ReferenceSDF();
+  /// \brief Read the tag at the position, and move past it.
+  /// \param[out] _name Name of the element of the tag.
+  /// \param[out] _empty True for an empty element tag, such as <a/>.
+  /// \return False if the tag is malformed.
+  public: bool ReadTag(std::string &_name, bool &_empty)
+  {
+    std::size_t i = this->pos + 1;
+    if (i < this->size && this->data[i] == '/')
+      ++i;
+    const std::size_t nameBegin = i;
+    while (i < this->size && !std::isspace(
+          static_cast<unsigned char>(this->data[i])) &&
+        this->data[i] != '>' && this->data[i] != '/')
+    {
+      ++i;
+    }
+    _name.assign(this->data + nameBegin, i - nameBegin);
+
+    char quote = 0;
+    for (; i < this->size; ++i)
+    {
+      const char c = this->data[i];
+      if (quote)
+      {
+        if (c == quote)
+          quote = 0;
+      }
+      else if (c == '"' || c == '\'')
+      {
+        quote = c;
+      }
+      else if (c == '>')
+      {
+        _empty = this->data[i - 1] == '/';
+        this->pos = i + 1;
+        return !_name.empty();
+      }
+    }
+    return false;
+  }
+
+  /// \brief Move past the content and the end tag of the element whose
+  /// start tag was just read.
+  /// \return False if the document ends first.
+  public: bool SkipElement()
+  {
+    std::string name;
+    bool empty = false;
+    for (std::size_t depth = 1; depth > 0;)
+    {
+      if (!this->NextTag())
+        return false;
+      const bool end = this->AtEndTag();
+      if (!this->ReadTag(name, empty))
+        return false;
+      if (end)
+        --depth;
+      else if (!empty)
+        ++depth;
+    }
+    return true;
+  }
+
+  /// \brief Get the position in the document.
+  /// \return Offset of the next byte to scan.
+  public: std::size_t Position() const
+  {
+    return this->pos;
+  }
+
+  /// \brief Get part of the document, with its line endings normalized
+  /// like TiXmlDocument::LoadFile does.
+  /// \param[in] _begin Offset of the first byte.
+  /// \param[in] _end Offset past the last byte.
+  /// \return The text.
+  public: std::string Text(std::size_t _begin, std::size_t _end) const
+  {
+    std::string text;
+    text.reserve(_end - _begin);
+    for (std::size_t i = _begin; i < _end; ++i)
+    {
+      if (this->data[i] != '\r')
+        text += this->data[i];
+      else if (i + 1 >= _end || this->data[i + 1] != '\n')
+        text += '\n';
+    }
+    return text;
+  }
+
+  /// \brief Get whether the document continues with a string at the
+  /// position.
+  /// \param[in] _str The string.
+  /// \return True if it does.
+  private: bool StartsWith(const char *_str) const
+  {
+    const std::size_t length = std::strlen(_str);
+    return this->size - this->pos >= length &&
+        std::memcmp(this->data + this->pos, _str, length) == 0;
+  }
+
+  /// \brief Move past the next occurrence of a string, or to the end.
+  /// \param[in] _str The string.
+  private: void SkipPast(const char *_str)
+  {
+    const std::size_t length = std::strlen(_str);
+    const char *found = std::search(this->data + this->pos,
+        this->data + this->size, _str, _str + length);
+    this->pos = std::min<std::size_t>(
+        static_cast<std::size_t>(found - this->data) + length, this->size);
+  }
+
+  /// \brief The document.
+  private: const char *data;
+
+  /// \brief Size of the document.
+  private: std::size_t size;
+
+  /// \brief Offset of the next byte to scan.
+  private: std::size_t pos = 0;
+};
+
+//////////////////////////////////////////////////
+/// \brief Append the start tag of an XML element, without its children.
+/// \param[in] _xml The element.
+/// \param[in] _prefix Prefix of the tag.
+/// \param[in,out] _buffer String to append the tag to.
+static void appendStartTag(const TiXmlElement *_xml,
+    const std::string &_prefix, std::string &_buffer)
+{
+  _buffer += _prefix + "<" + _xml->ValueStr();
+  for (const TiXmlAttribute *attribute = _xml->FirstAttribute(); attribute;
+       attribute = attribute->Next())
+  {
+    std::string value;
+    TiXmlBase::EncodeString(attribute->ValueStr(), &value);
+    _buffer += std::string(" ") + attribute->Name() + "='" + value + "'";
+  }
+  _buffer += ">\n";
+}
+
+//////////////////////////////////////////////////
+/// \brief Write an XML element, indented by a prefix.
+/// \param[in] _xml The element.
+/// \param[in] _prefix Prefix of each line.
+/// \param[out] _out Stream to write to.
+static void writeXml(const TiXmlElement *_xml, const std::string &_prefix,
+    std::ostream &_out)
+{
+  TiXmlPrinter printer;
+  printer.SetIndent("  ");
+  _xml->Accept(&printer);
+  std::istringstream lines(printer.Str());
+  std::string line;
+  while (std::getline(lines, line))
+    _out << _prefix << line << '\n';
+}
+
+//////////////////////////////////////////////////
+/// \brief Converts and prints the elements split by printFileStreaming,
+/// each of them wrapped in the start tags of its ancestors.
+class StreamPrinter
+{
+  /// \brief Constructor.
+  /// \param[in] _filename Path of the file, which relative includes are
+  /// resolved from.
+  /// \param[in] _expandIncludes As in printFileStreaming.
+  /// \param[in] _config Parser configuration.
+  /// \param[out] _out Stream to print to.
+  /// \param[out] _errors Errors.
+  public: StreamPrinter(const std::string &_filename, bool _expandIncludes,
+      const ParserConfig &_config, std::ostream &_out, Errors &_errors)
+    : filename(_filename), expandIncludes(_expandIncludes), config(_config),
+      out(_out), errors(_errors)
+  {
+  }
+
+  /// \brief Read and convert a document, which is an element wrapped in
+  /// the start tags of its ancestors.
+  /// \param[in] _text The document.
+  /// \param[out] _doc The converted document.
+  /// \param[out] _sdf The elements read from the document, if includes are
+  /// expanded.
+  /// \return False if the document can't be read.
+  public: bool Read(const std::string &_text, TiXmlDocument &_doc,
+                    SDFPtr &_sdf)
+  {
+    _doc.Parse(_text.c_str());
+    TiXmlElement *sdfXml = _doc.FirstChildElement("sdf");
+    if (_doc.Error() || !sdfXml || !sdfXml->Attribute("version"))
+    {
+      this->errors.push_back({ErrorCode::FILE_READ,
+          "Unable to parse the XML of file[" + this->filename + "]: " +
+          (_doc.Error() ? _doc.ErrorDesc() : "missing <sdf version>")});
+      return false;
+    }
+
+    const std::string &specVersion = currentSpecVersion().version;
+    if (sdfXml->Attribute("version") != specVersion)
+    {
+      ScopedLoadTimer convertTimer(&LoadCounters::convertNanoseconds);
+      LoadCounters::Add(&LoadCounters::conversions);
+      Converter::Convert(&_doc, specVersion, true);
+    }
+    if (!this->expandIncludes)
+      return true;
+
+    // The document is already converted, so readDoc only reads it.
+    _sdf.reset(new SDF);
+    _sdf->Root(includeSDFTemplate()->Root()->Clone());
+    return readDoc(&_doc, _sdf, this->filename, false, this->config,
+        this->errors);
+  }
+
+  /// \brief Print the start tag of the <sdf> element.
+  /// \param[in] _sdfTag The start tag as written in the file.
+  /// \return False if it can't be read.
+  public: bool Begin(const std::string &_sdfTag)
+  {
+    this->sdfTag = _sdfTag;
+    TiXmlDocument doc;
+    SDFPtr sdf;
+    if (!this->Read(_sdfTag + "</sdf>", doc, sdf))
+      return false;
+    std::string buffer;
+    if (sdf)
+      sdf->Root()->AppendStartTag("", buffer);
+    else
+      appendStartTag(doc.FirstChildElement("sdf"), "", buffer);
+    this->out << buffer;
+    return true;
+  }
+
+  /// \brief Print the start tag of a <world> element.
+  /// \param[in] _worldTag The start tag as written in the file.
+  /// \return False if it can't be read.
+  public: bool BeginWorld(const std::string &_worldTag)
+  {
+    this->worldTag = _worldTag;
+    this->worldDefaults.reset();
+    this->printedNames.clear();
+
+    TiXmlDocument doc;
+    SDFPtr sdf;
+    if (!this->Read(this->sdfTag + _worldTag + "</world></sdf>", doc, sdf))
+      return false;
+
+    std::string buffer;
+    if (sdf)
+    {
+      // The children of an empty world are its default elements, printed
+      // after the elements of the file if they are not among them.
+      this->worldDefaults = sdf->Root()->FindElement("world");
+      if (!this->worldDefaults)
+        return false;
+      this->worldDefaults->AppendStartTag("  ", buffer);
+      this->out << buffer;
+    }
+    else
+    {
+      TiXmlElement *worldXml =
+          doc.FirstChildElement("sdf")->FirstChildElement("world");
+      if (!worldXml)
+        return false;
+      appendStartTag(worldXml, "  ", buffer);
+      this->out << buffer;
+    }
+    return true;
+  }
+
+  /// \brief Convert and print a child of the current <world> element, or
+  /// of the <sdf> element if there is no current world.
+  /// \param[in] _text The child as written in the file.
+  /// \return False if it can't be read.
+  public: bool Print(const std::string &_text)
+  {
+    const bool inWorld = !this->worldTag.empty();
+    const std::string text = inWorld ?
+        this->sdfTag + this->worldTag + _text + "</world></sdf>" :
+        this->sdfTag + _text + "</sdf>";
+    const std::string prefix = inWorld ? "    " : "  ";
+
+    TiXmlDocument doc;
+    SDFPtr sdf;
+    if (!this->Read(text, doc, sdf))
+      return false;
+
+    TiXmlElement *parentXml = doc.FirstChildElement("sdf");
+    if (inWorld)
+      parentXml = parentXml->FirstChildElement("world");
+
+    if (!sdf)
+    {
+      // The converted XML is printed as is.
+      for (TiXmlElement *childXml = parentXml->FirstChildElement(); childXml;
+           childXml = childXml->NextSiblingElement())
+      {
+        writeXml(childXml, prefix, this->out);
+      }
+      return true;
+    }
+
+    ElementPtr parent = sdf->Root();
+    if (inWorld)
+      parent = parent->FindElement("world");
+    if (!parent)
+      return false;
+
+    // The default elements added to the wrapping world are not printed.
+    // They are never entities, which is what includes expand to.
+    std::set<std::string> names;
+    for (TiXmlElement *childXml = parentXml->FirstChildElement(); childXml;
+         childXml = childXml->NextSiblingElement())
+    {
+      names.insert(childXml->ValueStr());
+    }
+    const bool hasInclude = names.count("include") > 0;
+    for (const ElementPtr &child : parent->Children())
+    {
+      const std::string &name = child->GetName();
+      if (!inWorld || names.count(name) > 0 || (hasInclude &&
+            (name == "model" || name == "actor" || name == "light")))
+      {
+        child->Write(this->out, prefix);
+        this->printedNames.insert(name);
+      }
+    }
+    return true;
+  }
+
+  /// \brief Print the end tag of the current <world> element, after its
+  /// default elements that were not printed.
+  public: void EndWorld()
+  {
+    if (this->worldDefaults)
+    {
+      for (const ElementPtr &child : this->worldDefaults->Children())
+      {
+        if (this->printedNames.count(child->GetName()) == 0)
+          child->Write(this->out, "    ");
+      }
+    }
+    this->out << "  </world>\n";
+    this->worldTag.clear();
+  }
+
+  /// \brief Print the end tag of the <sdf> element.
+  public: void End()
+  {
+    this->out << "</sdf>\n";
+  }
+
+  /// \brief Path of the file.
+  private: const std::string filename;
+
+  /// \brief True to read the elements, expanding their includes.
+  private: const bool expandIncludes;
+
+  /// \brief Parser configuration.
+  private: const ParserConfig &config;
+
+  /// \brief Stream to print to.
+  private: std::ostream &out;
+
+  /// \brief Errors.
+  private: Errors &errors;
+
+  /// \brief Start tag of the <sdf> element, as written in the file.
+  private: std::string sdfTag;
+
+  /// \brief Start tag of the current <world> element, as written in the
+  /// file, or empty outside of a world.
+  private: std::string worldTag;
+
+  /// \brief The current world read without children, if includes are
+  /// expanded.
+  private: ElementPtr worldDefaults;
+
+  /// \brief Names of the children of the current world printed so far.
+  private: std::set<std::string> printedNames;
+};
+
+//////////////////////////////////////////////////
+/// \brief Print the <sdf> element of a document with printFileStreaming.
+/// \param[in] _scanner Scanner positioned before the start tag of the
+/// <sdf> element.
+/// \param[in] _printer The printer.
+/// \param[in] _filename Path of the file, for the errors.
+/// \param[out] _errors Errors.
+/// \return False if the document is not an SDFormat document, in which case
+/// nothing is printed, or if printing fails.
+static bool printScanned(XmlScanner &_scanner, StreamPrinter &_printer,
+    const std::string &_filename, Errors &_errors)
+{
+  std::string name;
+  bool empty = false;
+  if (!_scanner.NextTag() || _scanner.AtEndTag())
+    return false;
+  std::size_t begin = _scanner.Position();
+  if (!_scanner.ReadTag(name, empty) || name != "sdf")
+    return false;
+  if (!_printer.Begin(_scanner.Text(begin, _scanner.Position())))
+    return false;
+
+  const Error malformed(ErrorCode::FILE_READ,
+      "Malformed XML in file[" + _filename + "]");
+  bool inWorld = false;
+  while (!empty)
+  {
+    if (!_scanner.NextTag())
+    {
+      _errors.push_back(malformed);
+      return false;
+    }
+
+    const bool end = _scanner.AtEndTag();
+    begin = _scanner.Position();
+    bool childEmpty = false;
+    if (!_scanner.ReadTag(name, childEmpty))
+    {
+      _errors.push_back(malformed);
+      return false;
+    }
+
+    if (end)
+    {
+      if (!inWorld)
+        break;
+      _printer.EndWorld();
+      inWorld = false;
+    }
+    else if (name == "world" && !inWorld)
+    {
+      const std::string tag = _scanner.Text(begin, _scanner.Position());
+      if (!_printer.BeginWorld(childEmpty ?
+            tag.substr(0, tag.rfind('/')) + ">" : tag))
+      {
+        return false;
+      }
+      if (childEmpty)
+        _printer.EndWorld();
+      else
+        inWorld = true;
+    }
+    else
+    {
+      if (!childEmpty && !_scanner.SkipElement())
+      {
+        _errors.push_back(malformed);
+        return false;
+      }
+      if (!_printer.Print(_scanner.Text(begin, _scanner.Position())))
+        return false;
+    }
+  }
+
+  _printer.End();
+  return true;
+}
+
+//////////////////////////////////////////////////
+bool printFileStreaming(const std::string &_filename, std::ostream &_out,
+    bool _expandIncludes, const ParserConfig &_config, Errors &_errors)
+{
+  ScopedSpecVersion spec(_config);
+  ScopedWarningLimit warningScope(_config);
+  ScopedTaskExecutor executor(_config);
+  ScopedParserConfig configScope(_config);
+
+  std::string filename = sdf::findFile(_filename, true, true);
+  if (!filename.empty() && sdf::filesystem::is_directory(filename))
+    filename = getModelFilePath(filename);
+  if (filename.empty() || !sdf::filesystem::exists(filename))
+  {
+    _errors.push_back({ErrorCode::FILE_READ,
+        "Unable to find file[" + _filename + "]"});
+    return false;
+  }
+
+  StreamPrinter printer(filename, _expandIncludes, _config, _out, _errors);
+
+  // Plain files are scanned in place. Compressed files and the files of
+  // mounted archives are loaded and printed compactly to be scanned.
+  MappedFile file(filename);
+  const unsigned char *bytes =
+      reinterpret_cast<const unsigned char *>(file.Data());
+  const bool compressed = file.Valid() && file.Size() >= 4 &&
+      ((bytes[0] == 0x1f && bytes[1] == 0x8b) ||
+       (bytes[0] == 0x28 && bytes[1] == 0xb5 && bytes[2] == 0x2f &&
+        bytes[3] == 0xfd));
+  bool printed = false;
+  const std::size_t errorCount = _errors.size();
+  if (file.Valid() && !compressed)
+  {
+    XmlScanner scanner(file.Data(), file.Size());
+    printed = printScanned(scanner, printer, filename, _errors);
+  }
+  else
+  {
+    TiXmlDocument doc;
+    if (loadXmlFile(doc, filename))
+    {
+      TiXmlPrinter xmlPrinter;
+      xmlPrinter.SetStreamPrinting();
+      doc.Accept(&xmlPrinter);
+      XmlScanner scanner(xmlPrinter.CStr(), xmlPrinter.Size());
+      printed = printScanned(scanner, printer, filename, _errors);
+    }
+  }
+
+  if (printed || _errors.size() != errorCount)
+    return printed && _errors.size() == errorCount;
+
+  // Documents that are not SDFormat, such as URDF, are read whole.
+  SDFPtr sdf(new SDF);
+  sdf->Root(includeSDFTemplate()->Root()->Clone());
+  if (!readFileInternal(filename, sdf, true, _config, _errors))
+    return false;
+  sdf->Root()->Write(_out, "");
+  return true;
+}
+
+//////////////////////////////////////////////////
+/// \brief Get the URIs of the <include> children of an element.
+/// \param[in] _xml The element.
+/// \return The URIs, in document order and without duplicates.
+static std::vector<std::string> includeUris(TiXmlElement *_xml)
+{
+  std::vector<std::string> uris;
+  std::set<std::string> uniqueUris;
+  for (TiXmlElement *includeXml = _xml->FirstChildElement("include");
+       includeXml; includeXml = includeXml->NextSiblingElement("include"))
+  {
+    TiXmlElement *uriXml = includeXml->FirstChildElement("uri");
+    if (uriXml && uriXml->GetText() &&
+        uniqueUris.insert(uriXml->GetText()).second)
+    {
+      uris.push_back(uriXml->GetText());
+    }
+  }
+  return uris;
+}
+
+//////////////////////////////////////////////////
+/// \brief Remove the <model> and <include> children of a <world> element
+/// that the model filter of a configuration rejects, before the includes
+/// of the world are resolved.
+/// \param[in,out] _xml The <world> element.
+/// \param[in] _config The configuration, which has a model filter.
+static void filterModels(TiXmlElement *_xml, const ParserConfig &_config)
+{
+  ModelCandidate candidate;
+  if (const char *worldName = _xml->Attribute("name"))
+    candidate.worldName = worldName;
+
+  TiXmlElement *nextXml = nullptr;
+  for (TiXmlElement *childXml = _xml->FirstChildElement(); childXml;
+       childXml = nextXml)
+  {
+    nextXml = childXml->NextSiblingElement();
+
+    const bool isInclude = childXml->ValueStr() == "include";
+    if (!isInclude && childXml->ValueStr() != "model")
+      continue;
+
+    candidate.name.clear();
+    candidate.uri.clear();
+    candidate.hasPose = false;
+    candidate.pose = ignition::math::Pose3d::Zero;
+    candidate.poseRelativeTo.clear();
+
+    if (isInclude)
+    {
+      TiXmlElement *nameXml = childXml->FirstChildElement("name");
+      if (nameXml && nameXml->GetText())
+        candidate.name = nameXml->GetText();
+      TiXmlElement *uriXml = childXml->FirstChildElement("uri");
+      if (uriXml && uriXml->GetText())
+        candidate.uri = uriXml->GetText();
+    }
+    else if (const char *name = childXml->Attribute("name"))
+    {
+      candidate.name = name;
+    }
+
+    if (TiXmlElement *poseXml = childXml->FirstChildElement("pose"))
+    {
+      candidate.hasPose = true;
+      if (poseXml->GetText())
+      {
+        std::istringstream stream(poseXml->GetText());
+        stream >> candidate.pose;
+      }
+      if (const char *relativeTo = poseXml->Attribute("relative_to"))
+        candidate.poseRelativeTo = relativeTo;
+    }
+
+    if (!_config.ModelFilter()(candidate))
+      _xml->RemoveChild(childXml);
+  }
+}
+
+//////////////////////////////////////////////////
+/// \brief Remove the <world> children of the <sdf> element that the world
+/// filter of a configuration rejects, before any of them is read.
+/// \param[in,out] _xml The <sdf> element.
+/// \param[in] _config The configuration, which has a world filter.
+static void filterWorlds(TiXmlElement *_xml, const ParserConfig &_config)
+{
+  TiXmlElement *nextXml = nullptr;
+  for (TiXmlElement *worldXml = _xml->FirstChildElement("world"); worldXml;
+       worldXml = nextXml)
+  {
+    nextXml = worldXml->NextSiblingElement("world");
+    const char *name = worldXml->Attribute("name");
+    if (!_config.WorldFilter()(name ? name : ""))
+      _xml->RemoveChild(worldXml);
+  }
+}
+
+//////////////////////////////////////////////////
+/// \brief Get whether a child of a <world> element is one of its entities,
+/// which the parse scopes skip.
+/// \param[in] _name Name of the child element.
+/// \return True for an entity.
+static bool isWorldEntity(const std::string &_name)
+{
+  return _name == "model" || _name == "include" || _name == "actor" ||
+      _name == "light" || _name == "frame" || _name == "joint" ||
+      _name == "population" || _name == "road";
+}
+
+//////////////////////////////////////////////////
+/// \brief Remove the child elements of an XML element, keeping its
+/// attributes.
+/// \param[in,out] _xml The element.
+static void removeChildElements(TiXmlElement *_xml)
+{
+  TiXmlElement *nextXml = nullptr;
+  for (TiXmlElement *childXml = _xml->FirstChildElement(); childXml;
+       childXml = nextXml)
+  {
+    nextXml = childXml->NextSiblingElement();
+    _xml->RemoveChild(childXml);
+  }
+}
+
+//////////////////////////////////////////////////
+/// \brief Replace an <include> element with the element of the included
+/// entity, with only its attributes, for ParseScope::TOP_LEVEL_NAMES. The
+/// included file is parsed, but neither converted nor read.
+/// \param[in,out] _xml The parent of the include.
+/// \param[in] _includeXml The include.
+/// \return False if the included entity is not found, in which case the
+/// include is kept, so that reading it reports why.
+static bool replaceIncludeWithName(TiXmlElement *_xml,
+    TiXmlElement *_includeXml)
+{
+  TiXmlElement *uriXml = _includeXml->FirstChildElement("uri");
+  if (!uriXml || !uriXml->GetText())
+    return false;
+
+  const std::string modelPath = sdf::findFile(uriXml->GetText(), true, true);
+  if (modelPath.empty() || !sdf::filesystem::is_directory(modelPath))
+    return false;
+  const std::string filename = getModelFilePath(modelPath);
+  TiXmlDocument doc;
+  if (filename.empty() || !loadXmlFile(doc, filename))
+    return false;
+
+  // A URDF file is a model named after its robot.
+  TiXmlElement *entityXml = doc.FirstChildElement("robot");
+  std::string value = "model";
+  if (!entityXml)
+  {
+    TiXmlElement *sdfXml = doc.FirstChildElement("sdf");
+    if (!sdfXml)
+      return false;
+    for (entityXml = sdfXml->FirstChildElement(); entityXml;
+         entityXml = entityXml->NextSiblingElement())
+    {
+      value = entityXml->ValueStr();
+      if (value == "model" || value == "actor" || value == "light")
+        break;
+    }
+    if (!entityXml)
+      return false;
+  }
+
+  TiXmlElement entity(value);
+  for (const TiXmlAttribute *attribute = entityXml->FirstAttribute();
+       attribute; attribute = attribute->Next())
+  {
+    entity.SetAttribute(attribute->Name(), attribute->Value());
+  }
+  TiXmlElement *nameXml = _includeXml->FirstChildElement("name");
+  if (nameXml && nameXml->GetText())
+    entity.SetAttribute("name", nameXml->GetText());
+
+  _xml->InsertBeforeChild(_includeXml, entity);
+  _xml->RemoveChild(_includeXml);
+  return true;
+}
+
+//////////////////////////////////////////////////
+/// \brief Remove the children of an <sdf> or <world> element that are
+/// outside of the parse scope of a configuration, before any of them is
+/// read. See ParseScope.
+/// \param[in,out] _xml The element.
+/// \param[in] _config The configuration, whose scope is not FULL.
+static void limitToScope(TiXmlElement *_xml, const ParserConfig &_config)
+{
+  const ParseScope scope = _config.ParseScope();
+  const bool isSdf = _xml->ValueStr() == "sdf";
+
+  // Included files have no world, so that the scope of the <sdf> element
+  // only applies to the document itself, except for the names, which are
+  // read without reading included files.
+  if (isSdf && scope != ParseScope::TOP_LEVEL_NAMES &&
+      (scope != ParseScope::WORLD_HEADER || !_xml->FirstChildElement("world")))
+  {
+    return;
+  }
+
+  bool worldKept = false;
+  std::size_t modelCount = 0;
+  bool complete = scope == ParseScope::WORLD_HEADER ||
+      (scope == ParseScope::FIRST_MODELS && _config.ScopeModelCount() == 0);
+  TiXmlElement *nextXml = nullptr;
+  for (TiXmlElement *childXml = _xml->FirstChildElement(); childXml;
+       childXml = nextXml)
+  {
+    nextXml = childXml->NextSiblingElement();
+    const std::string &name = childXml->ValueStr();
+
+    if (scope == ParseScope::TOP_LEVEL_NAMES)
+    {
+      if (name == "model" || name == "actor" || name == "light")
+        removeChildElements(childXml);
+      else if (name == "include" && !isSdf)
+        replaceIncludeWithName(_xml, childXml);
+      else if (!isSdf)
+        _xml->RemoveChild(childXml);
+      continue;
+    }
+
+    if (isSdf)
+    {
+      // Keep the first world.
+      if (name == "world" && !worldKept)
+        worldKept = true;
+      else
+        _xml->RemoveChild(childXml);
+      continue;
+    }
+
+    if (!isWorldEntity(name))
+      continue;
+    if (complete)
+    {
+      _xml->RemoveChild(childXml);
+    }
+    else if ((name == "model" || name == "include") &&
+             ++modelCount >= _config.ScopeModelCount())
+    {
+      complete = true;
+    }
+  }
+}
+
+//////////////////////////////////////////////////
+/// \brief Resolve the URIs of the <include> children of an element, and
+/// read the files they include concurrently, so that readXml finds them in
+/// the include cache when it reads the children in order. Files that fail
+/// to read are not stored, so that readXml reads them again and reports
+/// their errors in order.
+/// \param[in] _xml The element.
+/// \param[in] _config Parser configuration, which gives the number of
+/// threads.
+/// \param[in] _includeCache Cache in which the read files are stored.
+/// \param[out] _modelPaths The resolved model directory of each URI that
+/// was found.
+static void prefetchIncludes(TiXmlElement *_xml, const ParserConfig &_config,
+    const std::shared_ptr<IncludeCache> &_includeCache,
+    std::map<std::string, std::string> &_modelPaths)
+{
+  const std::vector<std::string> uris = includeUris(_xml);
+
+  // A single include is read in order without delay.
+  if (uris.size() < 2)
+    return;
+
+  // Files included by the prefetched files are read on their thread.
+  ParserConfig workerConfig = _config;
+  workerConfig.SetIncludeThreadCount(1);
+
+  // The warnings of the prefetched files are deduplicated with those of
+  // the including file, and the files are read as the same version.
+  WarningLimit *warningLimit = WarningLimit::Current();
+  const SpecVersion &spec = currentSpecVersion();
+
+  LoadCounters *counters = LoadCounters::Current();
+  std::vector<std::string> modelPaths(uris.size());
+  parallelFor(uris.size(), _config.IncludeThreadCount(), [&](std::size_t _i)
+  {
+    ScopedLoadCounters countersScope(counters);
+    ScopedWarningLimit warningScope(warningLimit);
+    ScopedSpecVersion specScope(spec);
+    ScopedParserConfig configScope(_config);
+    const std::string modelPath = sdf::findFile(uris[_i], true, true);
+    if (modelPath.empty() || !sdf::filesystem::is_directory(modelPath))
+      return;
+    modelPaths[_i] = modelPath;
+
+    std::string filename = _includeCache->FindModelFile(modelPath);
+    if (filename.empty())
+    {
+      filename = getModelFilePath(modelPath);
+      if (filename.empty())
+        return;
+      _includeCache->InsertModelFile(modelPath, filename);
+    }
+
+    if (_includeCache->Find(filename))
+      return;
+
+    SDFPtr includeSDF(new SDF);
+    includeSDF->Root(includeSDFTemplate()->Root()->Clone());
+    Errors includeErrors;
+    if (readFile(filename, workerConfig, includeSDF, includeErrors) &&
+        includeErrors.empty())
+    {
+      _includeCache->Share(filename, includeSDF->Root());
+    }
+  });
+
+  for (std::size_t i = 0; i < uris.size(); ++i)
+  {
+    if (!modelPaths[i].empty())
+      _modelPaths[uris[i]] = modelPaths[i];
+  }
+}
+
+/////////////////////////////////////////////////
+/// \brief A child element read by readSubtrees before the in-order pass of
+/// readXml reaches it.
+struct SubtreeRead
+{
+  /// \brief The element, whose parent is set but which is not inserted.
+  ElementPtr element;
+
+  /// \brief Result of readXml.
+  bool result = false;
+
+  /// \brief Errors of readXml, reported when the in-order pass reaches the
+  /// element.
+  Errors errors;
+};
+
+/////////////////////////////////////////////////
+/// \brief Nesting depth of the element that readXml reads on this thread.
+static thread_local std::size_t g_readDepth = 0;
+
+/////////////////////////////////////////////////
+/// \brief Sets the nesting depth of the element that readXml reads on
+/// this thread, while it is in scope.
+class ScopedReadDepth
+{
+  /// \brief Constructor.
+  /// \param[in] _depth The depth.
+  public: explicit ScopedReadDepth(std::size_t _depth)
+    : previous(g_readDepth)
+  {
+    g_readDepth = _depth;
+  }
+
+  /// \brief Destructor, which restores the previous depth.
+  public: ~ScopedReadDepth()
+  {
+    g_readDepth = this->previous;
+  }
+
+  /// \brief The previous depth.
+  private: const std::size_t previous;
+};
+
+/////////////////////////////////////////////////
+/// \brief Read the <model>, <actor> and <light> children of a world
+/// concurrently, each into its own element tree. See
+/// ParserConfig::SetReadThreadCount.
+/// \param[in] _xml The XML element of the world.
+/// \param[in] _sdf The element of the world.
+/// \param[in] _table The read table of the world.
+/// \param[in] _config Custom parser configuration.
+/// \param[in] _releaseXml As in readXml.
+/// \return The children that were read, by XML element. Empty if there
+/// are less than two of them, in which case they are read in order.
+static std::unordered_map<const TiXmlElement *, SubtreeRead> readSubtrees(
+    TiXmlElement *_xml, ElementPtr _sdf, const ElementReadTable &_table,
+    const ParserConfig &_config, bool _releaseXml)
+{
+  std::vector<TiXmlElement *> subtreesXml;
+  std::vector<SubtreeRead> reads;
+  for (TiXmlElement *elemXml = _xml->FirstChildElement(); elemXml;
+       elemXml = elemXml->NextSiblingElement())
+  {
+    const std::string &name = elemXml->ValueStr();
+    if (name != "model" && name != "actor" && name != "light")
+      continue;
+    const std::size_t descIndex = _table.ElementDescription(name);
+    if (descIndex == std::string::npos)
+      continue;
+
+    subtreesXml.push_back(elemXml);
+    reads.emplace_back();
+    reads.back().element = _sdf->GetElementDescription(
+        static_cast<unsigned int>(descIndex))->Clone();
+    reads.back().element->SetParent(_sdf);
+  }
+
+  std::unordered_map<const TiXmlElement *, SubtreeRead> result;
+  if (subtreesXml.size() < 2)
+    return result;
+
+  // Files included by the subtrees are read on their thread.
+  ParserConfig workerConfig = _config;
+  workerConfig.SetIncludeThreadCount(1);
+
+  // The warnings of the subtrees are deduplicated with those of the
+  // document, and the subtrees are read as the same version.
+  WarningLimit *warningLimit = WarningLimit::Current();
+  const SpecVersion &spec = currentSpecVersion();
+  const bool arena = ElementArena::Current() != nullptr;
+  const std::size_t depth = g_readDepth;
+  LoadCounters *counters = LoadCounters::Current();
+
+  // The errors of each subtree are counted apart and added to the error
+  // limit of the document once read, so that its count does not depend on
+  // whether the subtrees were read in parallel.
+  ErrorLimit *errorLimit = ErrorLimit::Current();
+  std::vector<std::size_t> errorCounts(reads.size(), 0);
+  parallelFor(reads.size(), _config.ReadThreadCount(), [&](std::size_t _i)
+  {
+    ErrorLimit readLimit(0);
+    ScopedErrorLimit errorScope(errorLimit ? &readLimit : nullptr);
+    ScopedLoadCounters countersScope(counters);
+    ScopedReadDepth depthScope(depth);
+    ScopedWarningLimit warningScope(warningLimit);
+    ScopedSpecVersion specScope(spec);
+    ScopedElementArena arenaScope(arena);
+    ScopedParserConfig configScope(workerConfig);
+    reads[_i].result = readXml(subtreesXml[_i], reads[_i].element,
+        workerConfig, reads[_i].errors, _releaseXml);
+    errorCounts[_i] = readLimit.Counted();
+  });
+  if (errorLimit)
+  {
+    for (const std::size_t count : errorCounts)
+      errorLimit->Add(count);
+  }
+
+  result.reserve(reads.size());
+  for (std::size_t i = 0; i < reads.size(); ++i)
+    result.emplace(subtreesXml[i], std::move(reads[i]));
+  return result;
+}
+
+/////////////////////////////////////////////////
+/// \brief Keep the child elements of an XML element as XML text in an
+/// element, to be read when they are accessed. See
+/// ParserConfig::SetDeferCopiedElements.
+/// \param[in] _sdf Element without child elements.
+/// \param[in] _xml The XML element.
+/// \return False if the child elements cannot be deferred because some of
+/// them are part of the SDF spec, in which case they must be copied.
+static bool deferChildren(ElementPtr _sdf, TiXmlElement *_xml)
+{
+  TiXmlPrinter printer;
+  printer.SetStreamPrinting();
+  for (TiXmlElement *elemXml = _xml->FirstChildElement(); elemXml;
+       elemXml = elemXml->NextSiblingElement())
+  {
+    if (_sdf->HasElementDescription(elemXml->ValueStr()))
+      return false;
+    elemXml->Accept(&printer);
+  }
+
+  if (printer.Size() > 0)
+    _sdf->SetDeferredElements(printer.Str());
+  return true;
+}
+
+//////////////////////////////////////////////////
+bool readXml(TiXmlElement *_xml, ElementPtr _sdf,
+             const ParserConfig &_config, Errors &_errors, bool _releaseXml)
+{
+  if (_config.CancelCallback() && _config.CancelCallback()())
+  {
+    _errors.push_back({ErrorCode::LOAD_CANCELLED,
+        "Reading was cancelled at element <" + _sdf->GetName() + ">."});
+    return false;
+  }
+
+  ScopedReadDepth depthScope(g_readDepth + 1);
+  if (_config.MaxNestingDepth() > 0 &&
+      g_readDepth > _config.MaxNestingDepth())
+  {
+    _errors.push_back({ErrorCode::ELEMENT_NESTING_TOO_DEEP,
+        "SDF Element<" + _sdf->GetName() + "> is nested deeper than the " +
+        std::to_string(_config.MaxNestingDepth()) + " elements allowed."});
+    return false;
+  }
+
+  // Check if the element pointer is deprecated.
+  if (_sdf->GetRequired() == "-1")
+  {
+    const std::string message =
+        "SDF Element[" + _sdf->GetName() + "] is deprecated\n";
+    if (warningAllowed("deprecated element", message))
+      sdfwarn << message;
+  }
+
+  if (!_xml)
+  {
+    if (_sdf->GetRequired() == "1" || _sdf->GetRequired() =="+")
+    {
+      _errors.push_back({ErrorCode::ELEMENT_MISSING,
+          "SDF Element<" + _sdf->GetName() + "> is missing"});
+      return false;
+    }
+    else
+    {
+      return true;
+    }
+  }
+
+  if (_xml->GetText() != nullptr && _sdf->GetValue())
+  {
+    if (!_sdf->GetValue()->SetFromString(_xml->GetText()))
+      return false;
+  }
+
+  // check for nested sdf
+  std::string refSDFStr = _sdf->ReferenceSDF();
   if (!refSDFStr.empty())
   {
-    ElementPtr refSDF;
-    refSDF.reset(new Element);
-    std::string refFilename = refSDFStr + ".sdf";
-    initFile(refFilename, refSDF);
     _sdf->RemoveFromParent();
-    _sdf->Copy(refSDF);
+    _sdf->Copy(referencedDescription(refSDFStr));
   }
 
-  TiXmlAttribute *attribute = _xml->FirstAttribute();
+  // The attributes and child elements are found by name in a table built
+  // once for each element description.
+  const std::shared_ptr<const ElementReadTable> table =
+      ElementReadTable::Get(*_sdf);
+  const bool tableAttributes =
+      table->attributeCount == _sdf->GetAttributeCount();
 
-  unsigned int i = 0;
+  TiXmlAttribute *attribute = _xml->FirstAttribute();
 
   // Iterate over all the attributes defined in the give XML element
   while (attribute)
@@ -839,66 +2527,148 @@ bool readXml(TiXmlElement *_xml, ElementPtr _sdf, Errors &_errors)
       continue;
     }
     // Find the matching attribute in SDF
-    for (i = 0; i < _sdf->GetAttributeCount(); ++i)
+    ParamPtr p = table->Attribute(*_sdf, attribute->NameTStr());
+    if (p)
     {
-      ParamPtr p = _sdf->GetAttribute(i);
-      if (p->GetKey() == attribute->Name())
+      // Set the value of the SDF attribute
+      if (!p->SetFromString(attribute->ValueStr()))
       {
-        // Set the value of the SDF attribute
-        if (!p->SetFromString(attribute->ValueStr()))
-        {
-          _errors.push_back({ErrorCode::ATTRIBUTE_INVALID,
-              "Unable to read attribute[" + p->GetKey() + "]"});
-          return false;
-        }
-        break;
+        _errors.push_back({ErrorCode::ATTRIBUTE_INVALID,
+            "Unable to read attribute[" + p->GetKey() + "]"});
+        return false;
       }
     }
-
-    if (i == _sdf->GetAttributeCount())
+    else
     {
-      sdfwarn << "XML Attribute[" << attribute->Name()
-              << "] in element[" << _xml->Value()
-              << "] not defined in SDF, ignoring.\n";
+      const std::string message = std::string("XML Attribute[") +
+          attribute->Name() + "] in element[" + _xml->Value() +
+          "] not defined in SDF, ignoring.\n";
+      if (warningAllowed("unknown attribute", message))
+        sdfwarn << message;
     }
 
     attribute = attribute->Next();
   }
 
-  // Check that all required attributes have been set
-  for (i = 0; i < _sdf->GetAttributeCount(); ++i)
+  // Check that all required attributes have been set. Only the required
+  // ones are checked if the element has the attributes of the table.
+  const auto requiredAttributeMissing = [&](const ParamPtr &_p)
   {
-    ParamPtr p = _sdf->GetAttribute(i);
-    if (p->GetRequired() && !p->GetSet())
-    {
-      _errors.push_back({ErrorCode::ATTRIBUTE_MISSING,
-          "Required attribute[" + p->GetKey() + "] in element[" + _xml->Value()
-          + "] is not specified in SDF."});
+    if (!_p->GetRequired() || _p->GetSet())
       return false;
+    _errors.push_back({ErrorCode::ATTRIBUTE_MISSING,
+        "Required attribute[" + _p->GetKey() + "] in element[" + _xml->Value()
+        + "] is not specified in SDF."});
+    return true;
+  };
+  if (tableAttributes)
+  {
+    for (const std::size_t index : table->requiredAttributes)
+    {
+      if (requiredAttributeMissing(
+            _sdf->GetAttribute(static_cast<unsigned int>(index))))
+        return false;
+    }
+  }
+  else
+  {
+    for (unsigned int i = 0; i < _sdf->GetAttributeCount(); ++i)
+    {
+      if (requiredAttributeMissing(_sdf->GetAttribute(i)))
+        return false;
     }
   }
 
   if (_sdf->GetCopyChildren())
   {
-    copyChildren(_sdf, _xml, false);
+    if (!_config.DeferCopiedElements() || !deferChildren(_sdf, _xml))
+      copyChildren(_sdf, _xml, false);
   }
   else
   {
     std::string filename;
 
+    // Prefetch the included files concurrently if enabled, into a cache
+    // that only lasts while this element is read if none is configured.
+    auto includeCache = _config.IncludeCache();
+    std::map<std::string, std::string> prefetchedModelPaths;
+
+    // Skip the worlds that are not selected before any of them is read.
+    if (_config.WorldFilter() && _sdf->GetName() == "sdf")
+      filterWorlds(_xml, _config);
+
+    // Skip the models that are not selected before any include of the
+    // world is resolved.
+    if (_config.ModelFilter() && _sdf->GetName() == "world")
+      filterModels(_xml, _config);
+
+    // Skip the parts of the document outside of the parse scope, before
+    // any include is resolved.
+    if (_config.ParseScope() != ParseScope::FULL &&
+        (_sdf->GetName() == "sdf" || _sdf->GetName() == "world"))
+    {
+      limitToScope(_xml, _config);
+    }
+
+    // Hand all the URIs to the batch find callback at once, so that it
+    // resolves them while the children are read.
+    if (_xml->FirstChildElement("include"))
+    {
+      sdf::requestFiles(includeUris(_xml));
+    }
+
+    if (_config.IncludeThreadCount() != 1 &&
+        _xml->FirstChildElement("include"))
+    {
+      if (!includeCache)
+        includeCache = std::make_shared<IncludeCache>();
+      prefetchIncludes(_xml, _config, includeCache, prefetchedModelPaths);
+    }
+
+    // Read the independent children of a world concurrently, once the
+    // included files are being prefetched.
+    std::unordered_map<const TiXmlElement *, SubtreeRead> subtrees;
+    if (_config.ReadThreadCount() != 1 && _sdf->GetName() == "world")
+    {
+      subtrees = readSubtrees(_xml, _sdf, *table, _config, _releaseXml);
+    }
+
+    // Descriptions that child elements were read for, and whether a child
+    // element without description has to be copied.
+    std::vector<bool> descriptionsRead(_sdf->GetElementDescriptionCount());
+    bool unknownElements = false;
+
     // Iterate over all the child elements
     TiXmlElement *elemXml = nullptr;
-    for (elemXml = _xml->FirstChildElement(); elemXml;
-         elemXml = elemXml->NextSiblingElement())
+    TiXmlElement *nextElemXml = nullptr;
+    for (elemXml = _xml->FirstChildElement(); elemXml; elemXml = nextElemXml)
     {
-      if (std::string("include") == elemXml->Value())
+      // Get the next element first, since a read element can be removed.
+      nextElemXml = elemXml->NextSiblingElement();
+
+      const std::size_t descIndex =
+          table->ElementDescription(elemXml->ValueStr());
+      if (descIndex == std::string::npos)
+        unknownElements = true;
+
+      if (elemXml->ValueStr() == "include")
       {
+        ScopedParseEvent includeEvent(ParseStage::INCLUDE, "sdf::readXml");
         std::string modelPath;
 
         if (elemXml->FirstChildElement("uri"))
         {
           std::string uri = elemXml->FirstChildElement("uri")->GetText();
-          modelPath = sdf::findFile(uri, true, true);
+          includeEvent.SetPath(uri);
+          includeEvent.SetUri(uri);
+          {
+            ScopedParseEvent findEvent(ParseStage::FIND_FILE,
+                "sdf::findFile", uri);
+            auto prefetched = prefetchedModelPaths.find(uri);
+            modelPath = prefetched != prefetchedModelPaths.end() ?
+              prefetched->second : sdf::findFile(uri, true, true);
+            findEvent.SetPath(modelPath);
+          }
 
           // Test the model path
           if (modelPath.empty())
@@ -924,8 +2694,17 @@ bool readXml(TiXmlElement *_xml, ElementPtr _sdf, Errors &_errors)
             }
           }
 
-          // Get the config.xml filename
-          filename = getModelFilePath(modelPath);
+          // Get the config.xml filename, which the include cache keeps
+          // for each model directory.
+          filename = includeCache ?
+            includeCache->FindModelFile(modelPath) : std::string();
+          if (filename.empty())
+          {
+            filename = getModelFilePath(modelPath);
+            if (includeCache)
+              includeCache->InsertModelFile(modelPath, filename);
+          }
+          includeEvent.SetPath(filename);
         }
         else
         {
@@ -934,27 +2713,51 @@ bool readXml(TiXmlElement *_xml, ElementPtr _sdf, Errors &_errors)
           continue;
         }
 
-        // NOTE: sdf::init is an expensive call. For performance reason,
-        // a new sdf pointer is created here by cloning a fresh sdf template
-        // pointer instead of calling init every iteration.
-        // SDFPtr includeSDF(new SDF);
-        // init(includeSDF);
-        static SDFPtr includeSDFTemplate;
-        if (!includeSDFTemplate)
+        SDFPtr includeSDF(new SDF);
+
+        ElementPtr cachedRoot;
+        if (includeCache)
         {
-          includeSDFTemplate.reset(new SDF);
-          init(includeSDFTemplate);
+          cachedRoot = includeCache->Find(filename);
         }
-        SDFPtr includeSDF(new SDF);
-        includeSDF->Root(includeSDFTemplate->Root()->Clone());
 
-        if (!readFile(filename, includeSDF))
+        LoadCounters::Add(&LoadCounters::includesResolved);
+        if (cachedRoot)
         {
-          _errors.push_back({ErrorCode::FILE_READ,
-              "Unable to read file[" + filename + "]"});
-          return false;
+          LoadCounters::Add(&LoadCounters::includeCacheHits);
+          includeSDF->Root(cachedRoot);
+        }
+        else
+        {
+          includeSDF->Root(includeSDFTemplate()->Root()->Clone());
+
+          Errors includeErrors;
+          bool result = readFile(filename, _config, includeSDF,
+              includeErrors);
+
+          // Output errors
+          for (auto const &e : includeErrors)
+            std::cerr << e << std::endl;
+
+          if (!result)
+          {
+            _errors.push_back({ErrorCode::FILE_READ,
+                "Unable to read file[" + filename + "]"});
+            return false;
+          }
+
+          // The tree read is stored without cloning it, and this include
+          // applies its overrides to a copy-on-write clone, as the other
+          // includes of the file do, so that only the elements that the
+          // overrides change are copied.
+          if (includeCache)
+          {
+            includeSDF->Root(includeCache->Share(filename, includeSDF->Root()));
+          }
         }
 
+        includeEvent.SetElements(includeSDF->Root());
+
         sdf::ElementPtr topLevelElem;
         bool isModel{false};
         bool isActor{false};
@@ -1027,7 +2830,7 @@ bool readXml(TiXmlElement *_xml, ElementPtr _sdf, Errors &_errors)
               sdf::ElementPtr pluginElem;
               pluginElem = topLevelElem->AddElement("plugin");
 
-              if (!readXml(childElemXml, pluginElem, _errors))
+              if (!readXml(childElemXml, pluginElem, _config, _errors))
               {
                 _errors.push_back({ErrorCode::ELEMENT_INVALID,
                                    "Error reading plugin element"});
@@ -1043,80 +2846,96 @@ bool readXml(TiXmlElement *_xml, ElementPtr _sdf, Errors &_errors)
         }
         else
         {
-          includeSDF->Root()->GetFirstElement()->SetParent(_sdf);
-          _sdf->InsertElement(includeSDF->Root()->GetFirstElement());
-          // TODO: This was used to store the included filename so that when
-          // a world is saved, the included model's SDF is not stored in the
-          // world file. This highlights the need to make model inclusion
-          // a core feature of SDF, and not a hack that that parser handles
-          // includeSDF->Root()->GetFirstElement()->SetInclude(
-          // elemXml->Attribute("filename"));
+          ElementPtr included = includeSDF->Root()->GetFirstElement();
+          included->SetParent(_sdf);
+          _sdf->InsertElement(included);
+
+          // Record the include, so that the world can be saved with it
+          // instead of the included model while the model is unmodified.
+          TiXmlPrinter includePrinter;
+          includePrinter.SetStreamPrinting();
+          elemXml->Accept(&includePrinter);
+          included->SetIncludeXml(includePrinter.Str());
         }
 
         continue;
       }
 
       // Find the matching element in SDF
-      unsigned int descCounter = 0;
-      for (descCounter = 0;
-           descCounter != _sdf->GetElementDescriptionCount(); ++descCounter)
+      if (descIndex == std::string::npos)
+      {
+        const std::string message = std::string("XML Element[") +
+            elemXml->Value() + "], child of element[" + _xml->Value() +
+            "], not defined in SDF. Copying[" + elemXml->Value() + "] " +
+            "as children of [" + _xml->Value() + "].\n";
+        if (warningAllowed("unknown element", message, true))
+          sdfdbg << message;
+        continue;
+      }
+
+      ElementPtr element;
+      bool read = false;
+      auto subtree = subtrees.find(elemXml);
+      if (subtree != subtrees.end())
       {
-        ElementPtr elemDesc = _sdf->GetElementDescription(descCounter);
-        if (elemDesc->GetName() == elemXml->Value())
+        element = subtree->second.element;
+        read = subtree->second.result;
+        _errors.insert(_errors.end(), subtree->second.errors.begin(),
+            subtree->second.errors.end());
+      }
+      else
+      {
+        element = _sdf->GetElementDescription(
+            static_cast<unsigned int>(descIndex))->Clone();
+        element->SetParent(_sdf);
+        read = readXml(elemXml, element, _config, _errors, _releaseXml);
+      }
+
+      if (read)
+      {
+        descriptionsRead[descIndex] = true;
+        _sdf->InsertElement(element);
+        if (_releaseXml)
         {
-          ElementPtr element = elemDesc->Clone();
-          element->SetParent(_sdf);
-          if (readXml(elemXml, element, _errors))
-          {
-            _sdf->InsertElement(element);
-          }
-          else
-          {
-            _errors.push_back({ErrorCode::ELEMENT_INVALID,
-                std::string("Error reading element <") +
-                elemXml->Value() + ">"});
-            return false;
-          }
-          break;
+          _xml->RemoveChild(elemXml);
         }
       }
-
-      if (descCounter == _sdf->GetElementDescriptionCount())
+      else
       {
-        sdfdbg << "XML Element[" << elemXml->Value()
-               << "], child of element[" << _xml->Value()
-               << "], not defined in SDF. Copying[" << elemXml->Value() << "] "
-               << "as children of [" << _xml->Value() << "].\n";
-        continue;
+        _errors.push_back({ErrorCode::ELEMENT_INVALID,
+            std::string("Error reading element <") +
+            elemXml->Value() + ">"});
+        return false;
       }
     }
 
     // Copy unknown elements outside the loop so it only happens one time
-    copyChildren(_sdf, _xml, true);
+    if (unknownElements)
+      copyChildren(_sdf, _xml, true, _config.DeferCopiedElements());
 
-    // Check that all required elements have been set
-    for (unsigned int descCounter = 0;
-         descCounter != _sdf->GetElementDescriptionCount(); ++descCounter)
+    // Check that all required elements have been set. Included elements
+    // are not counted as read, so they are looked up.
+    for (const std::size_t descIndex : table->requiredElements)
     {
-      ElementPtr elemDesc = _sdf->GetElementDescription(descCounter);
+      if (descIndex < descriptionsRead.size() && descriptionsRead[descIndex])
+        continue;
 
-      if (elemDesc->GetRequired() == "1" || elemDesc->GetRequired() == "+")
+      ElementPtr elemDesc =
+          _sdf->GetElementDescription(static_cast<unsigned int>(descIndex));
+      if (!_sdf->HasElement(elemDesc->GetName()))
       {
-        if (!_sdf->HasElement(elemDesc->GetName()))
+        if (_sdf->GetName() == "joint" &&
+            _sdf->Get<std::string>("type") != "ball")
         {
-          if (_sdf->GetName() == "joint" &&
-              _sdf->Get<std::string>("type") != "ball")
-          {
-            _errors.push_back({ErrorCode::ELEMENT_MISSING,
-                "XML Missing required element[" + elemDesc->GetName() +
-                "], child of element[" + _sdf->GetName() + "]"});
-            return false;
-          }
-          else
-          {
-            // Add default element
-            _sdf->AddElement(elemDesc->GetName());
-          }
+          _errors.push_back({ErrorCode::ELEMENT_MISSING,
+              "XML Missing required element[" + elemDesc->GetName() +
+              "], child of element[" + _sdf->GetName() + "]"});
+          return false;
+        }
+        else
+        {
+          // Add default element
+          _sdf->AddElement(elemDesc->GetName());
         }
       }
     }
@@ -1146,58 +2965,270 @@ static void replace_all(std::string &_str,
 }
 
 /////////////////////////////////////////////////
-void copyChildren(ElementPtr _sdf, TiXmlElement *_xml, const bool _onlyUnknown)
+/// \brief Replace the names of the entities of a flattened nested model in
+/// a value printed between two delimiters, exactly like replacing the
+/// quoted and delimited names in the whole printed document would.
+/// \param[in] _replace Map from the original names to the new names.
+/// \param[in] _value The value.
+/// \param[in] _open Delimiter printed before the value.
+/// \param[in] _close Delimiter printed after the value.
+/// \return The value with the names replaced.
+static std::string replaceNestedNames(
+    const std::map<std::string, std::string> &_replace,
+    const std::string &_value, const char _open, const char _close)
 {
-  // Iterate over all the child elements
-  TiXmlElement *elemXml = nullptr;
-  for (elemXml = _xml->FirstChildElement(); elemXml;
-       elemXml = elemXml->NextSiblingElement())
+  // The names are replaced in the order of the map, and a replaced name
+  // may match a later entry.
+  auto iter = _replace.begin();
+  std::string value = _value;
+  while (iter != _replace.end() &&
+         value.find_first_of("\"'<>") == std::string::npos)
+  {
+    // Without quotes or brackets only the whole value can match.
+    iter = _replace.lower_bound(std::max(value, iter->first));
+    if (iter == _replace.end() || iter->first != value)
+      return value;
+    value = iter->second;
+    ++iter;
+  }
+
+  if (iter == _replace.end())
+    return value;
+
+  std::string str = _open + value + _close;
+  for (; iter != _replace.end(); ++iter)
+  {
+    replace_all(str, std::string("\"") + iter->first + "\"",
+                std::string("\"") + iter->second + "\"");
+    replace_all(str, std::string("'") + iter->first + "'",
+                std::string("'") + iter->second + "'");
+    replace_all(str, std::string(">") + iter->first + "<",
+                std::string(">") + iter->second + "<");
+  }
+  return str.substr(1, str.size() - 2);
+}
+
+/////////////////////////////////////////////////
+/// \brief Condense the white space of a text, like TinyXML does when
+/// parsing the text of an element.
+/// \param[in] _text The text.
+/// \return The text without leading and trailing white space, and with
+/// runs of white space replaced by a single space.
+static std::string condenseWhiteSpace(const std::string &_text)
+{
+  std::string result;
+  bool whiteSpace = false;
+  for (const char c : _text)
   {
-    std::string elem_name = elemXml->ValueStr();
+    if (std::isspace(static_cast<unsigned char>(c)))
+    {
+      whiteSpace = true;
+      continue;
+    }
+    if (whiteSpace && !result.empty())
+      result += ' ';
+    whiteSpace = false;
+    result += c;
+  }
+  return result;
+}
 
-    if (_sdf->HasElementDescription(elem_name))
+/////////////////////////////////////////////////
+/// \brief Rename the entities of a nested model in an element tree before
+/// it is flattened into its parent.
+///
+/// Flattening used to print the tree, replace the names in the printed
+/// string and read it back. This produces the same tree without the round
+/// trip: every printed attribute and value is set again from its printed
+/// and renamed string, values that were not printed are reset, unknown
+/// child elements move after the known ones, and the file path and
+/// original version are inherited like readXml does.
+/// \param[in] _elem The element to rename.
+/// \param[in] _replace Map from the original names to the new names.
+/// \param[in] _path The file path the element would get when read.
+/// \param[in] _originalVersion The original version the element would
+/// get when read.
+/// \param[out] _errors Errors setting the renamed values are appended to
+/// this vector.
+static void renameNestedEntities(ElementPtr _elem,
+    const std::map<std::string, std::string> &_replace,
+    const std::string &_path, const std::string &_originalVersion,
+    Errors &_errors)
+{
+  _elem->SetFilePath(_path);
+  _elem->SetOriginalVersion(_originalVersion);
+
+  for (size_t i = 0; i < _elem->GetAttributeCount(); ++i)
+  {
+    ParamPtr attr = _elem->GetAttribute(i);
+    if (!attr->GetSet() && !attr->GetRequired())
     {
-      if (!_onlyUnknown)
-      {
-        sdf::ElementPtr element = _sdf->AddElement(elem_name);
+      attr->Reset();
+      continue;
+    }
 
-        // FIXME: copy attributes
-        for (TiXmlAttribute *attribute = elemXml->FirstAttribute();
-             attribute; attribute = attribute->Next())
-        {
-          element->GetAttribute(attribute->Name())->SetFromString(
-            attribute->ValueStr());
-        }
+    if (!attr->SetFromString(
+          replaceNestedNames(_replace, attr->GetAsString(), '\'', '\'')))
+    {
+      _errors.push_back({ErrorCode::ATTRIBUTE_INVALID,
+          "Unable to read attribute[" + attr->GetKey() + "]"});
+    }
+  }
 
-        // copy value
-        std::string value = elemXml->GetText();
-        if (!value.empty())
-        {
-          element->GetValue()->SetFromString(value);
-        }
-        copyChildren(element, elemXml, _onlyUnknown);
-      }
+  ParamPtr value = _elem->GetValue();
+  if (value)
+  {
+    // Only the values of elements without children are printed, and a
+    // value that is empty once condensed is not read.
+    const std::string text = _elem->GetFirstElement() ? "" :
+        condenseWhiteSpace(
+          replaceNestedNames(_replace, value->GetAsString(), '>', '<'));
+    ElementPtr parent = _elem->GetParent();
+    if (text.empty())
+    {
+      value->Reset();
     }
-    else
+    else if (parent && !parent->HasElementDescription(_elem->GetName()))
     {
-      ElementPtr element(new Element);
-      element->SetParent(_sdf);
-      element->SetName(elem_name);
-      if (elemXml->GetText() != nullptr)
+      // copyChildren stores the text of unknown elements as the default.
+      _elem->AddValue("string", text, true);
+    }
+    else if (!value->SetFromString(text))
+    {
+      _errors.push_back({ErrorCode::ELEMENT_INVALID,
+          "Error reading element <" + _elem->GetName() + ">"});
+    }
+  }
+
+  // readXml adds the unknown child elements after the known ones, except
+  // for elements that copy all their children.
+  if (!_elem->GetCopyChildren())
+  {
+    std::vector<ElementPtr> unknown;
+    bool reorder = false;
+    for (const ElementPtr &child : _elem->Children())
+    {
+      if (!_elem->HasElementDescription(child->GetName()))
+        unknown.push_back(child);
+      else if (!unknown.empty())
+        reorder = true;
+    }
+
+    if (reorder)
+    {
+      for (const auto &child : unknown)
       {
-        element->AddValue("string", elemXml->GetText(), "1");
+        _elem->RemoveChild(child);
+        child->SetParent(_elem);
+        _elem->InsertElement(child);
       }
+    }
+  }
+
+  for (const ElementPtr &child : _elem->Children())
+  {
+    std::string childPath = _path;
+    std::string childOriginalVersion = _originalVersion;
+    ElementPtr desc = _elem->GetElementDescription(child->GetName());
+    if (desc && !desc->ReferenceSDF().empty())
+    {
+      // readXml copies referenced descriptions, which have no path or
+      // version.
+      childPath.clear();
+      childOriginalVersion.clear();
+    }
+    else if (desc)
+    {
+      if (!desc->FilePath().empty() && desc->FilePath() != "data-string")
+        childPath = desc->FilePath();
+      if (!desc->OriginalVersion().empty())
+        childOriginalVersion = desc->OriginalVersion();
+    }
+
+    renameNestedEntities(child, _replace, childPath, childOriginalVersion,
+        _errors);
+  }
+}
+
+/////////////////////////////////////////////////
+void copyChildren(ElementPtr _sdf, TiXmlElement *_xml, const bool _onlyUnknown,
+    const bool _defer)
+{
+  /// \brief An element whose child XML elements are to be copied.
+  struct CopyTask
+  {
+    /// \brief The element.
+    ElementPtr sdf;
+
+    /// \brief The XML element.
+    TiXmlElement *xml;
+
+    /// \brief Whether to defer the children of unknown elements.
+    bool defer;
+  };
+
+  // The XML tree is copied with an explicit stack instead of recursion, so
+  // that deeply nested elements, which are common in plugins, do not
+  // overflow the call stack. The children of an element are added in
+  // document order when it is popped.
+  std::vector<CopyTask> stack;
+  stack.push_back({_sdf, _xml, _defer});
+  while (!stack.empty())
+  {
+    const CopyTask task = std::move(stack.back());
+    stack.pop_back();
+
+    // Iterate over all the child elements
+    for (TiXmlElement *elemXml = task.xml->FirstChildElement(); elemXml;
+         elemXml = elemXml->NextSiblingElement())
+    {
+      std::string elem_name = elemXml->ValueStr();
 
-      for (TiXmlAttribute *attribute = elemXml->FirstAttribute();
-           attribute; attribute = attribute->Next())
+      if (task.sdf->HasElementDescription(elem_name))
       {
-        element->AddAttribute(attribute->Name(), "string", "", 1, "");
-        element->GetAttribute(attribute->Name())->SetFromString(
-          attribute->ValueStr());
+        if (!_onlyUnknown)
+        {
+          sdf::ElementPtr element = task.sdf->AddElement(elem_name);
+
+          // FIXME: copy attributes
+          for (TiXmlAttribute *attribute = elemXml->FirstAttribute();
+               attribute; attribute = attribute->Next())
+          {
+            element->GetAttribute(attribute->Name())->SetFromString(
+              attribute->ValueStr());
+          }
+
+          // copy value
+          std::string value = elemXml->GetText();
+          if (!value.empty())
+          {
+            element->GetValue()->SetFromString(std::move(value));
+          }
+          stack.push_back({element, elemXml, task.defer});
+        }
       }
+      else
+      {
+        ElementPtr element(new Element);
+        element->SetParent(task.sdf);
+        element->SetName(elem_name);
+        if (elemXml->GetText() != nullptr)
+        {
+          element->AddValue("string", elemXml->GetText(), "1");
+        }
+
+        for (TiXmlAttribute *attribute = elemXml->FirstAttribute();
+             attribute; attribute = attribute->Next())
+        {
+          element->AddAttribute(attribute->Name(), "string", "", 1, "");
+          element->GetAttribute(attribute->Name())->SetFromString(
+            attribute->ValueStr());
+        }
 
-      copyChildren(element, elemXml, _onlyUnknown);
-      _sdf->InsertElement(element);
+        if (!task.defer || !deferChildren(element, elemXml))
+          stack.push_back({element, elemXml, false});
+        task.sdf->InsertElement(element);
+      }
     }
   }
 }
@@ -1217,7 +3248,6 @@ void addNestedModel(ElementPtr _sdf, ElementPtr _includeSDF)
 void addNestedModel(ElementPtr _sdf, ElementPtr _includeSDF, Errors &_errors)
 {
   ElementPtr modelPtr = _includeSDF->GetElement("model");
-  ElementPtr elem = modelPtr->GetFirstElement();
   std::map<std::string, std::string> replace;
 
   ignition::math::Pose3d modelPose =
@@ -1266,7 +3296,7 @@ void addNestedModel(ElementPtr _sdf, ElementPtr _includeSDF, Errors &_errors)
 
   nestedModelFramePose->GetAttribute("relative_to")->Set(modelPoseRelativeTo);
 
-  while (elem)
+  for (const ElementPtr &elem : modelPtr->Children())
   {
     if ((elem->GetName() == "link") ||
         (elem->GetName() == "joint") ||
@@ -1304,36 +3334,19 @@ void addNestedModel(ElementPtr _sdf, ElementPtr _includeSDF, Errors &_errors)
 
       // If //frame/@attached_to is set, let the replacement step handle it.
     }
-    elem = elem->GetNextElement();
-  }
-
-  std::string str = _includeSDF->ToString("");
-  for (std::map<std::string, std::string>::iterator iter = replace.begin();
-       iter != replace.end(); ++iter)
-  {
-    replace_all(str, std::string("\"") + iter->first + "\"",
-                std::string("\"") + iter->second + "\"");
-    replace_all(str, std::string("'") + iter->first + "'",
-                std::string("'") + iter->second + "'");
-    replace_all(str, std::string(">") + iter->first + "<",
-                std::string(">") + iter->second + "<");
   }
 
-  _includeSDF->ClearElements();
-  readString(str, _includeSDF, _errors);
+  renameNestedEntities(_includeSDF, replace, _includeSDF->FilePath(),
+      _includeSDF->OriginalVersion(), _errors);
 
-  elem = _includeSDF->GetElement("model")->GetFirstElement();
-  ElementPtr nextElem;
-  while (elem)
+  // The children are inserted in _sdf, and stay in the model element.
+  for (const ElementPtr &elem : modelPtr->Children())
   {
-    nextElem = elem->GetNextElement();
-
     if (elem->GetName() != "pose")
     {
       elem->SetParent(_sdf);
       _sdf->InsertElement(elem);
     }
-    elem = nextElem;
   }
 }
 
@@ -1356,7 +3369,7 @@ bool convertFile(const std::string &_filename, const std::string &_version,
   }
 
   TiXmlDocument xmlDoc;
-  if (xmlDoc.LoadFile(filename))
+  if (loadXmlFile(xmlDoc, filename))
   {
     // read initial sdf version
     std::string originalVersion;
@@ -1373,7 +3386,8 @@ bool convertFile(const std::string &_filename, const std::string &_version,
     if (sdf::Converter::Convert(&xmlDoc, _version, true))
     {
       Errors errors;
-      bool result = sdf::readDoc(&xmlDoc, _sdf, filename, false, errors);
+      bool result = sdf::readDoc(&xmlDoc, _sdf, filename, false,
+          ParserConfig(), errors, true);
 
       // Output errors
       for (auto const &e : errors)
@@ -1420,7 +3434,8 @@ bool convertString(const std::string &_sdfString, const std::string &_version,
     if (sdf::Converter::Convert(&xmlDoc, _version, true))
     {
       Errors errors;
-      bool result = sdf::readDoc(&xmlDoc, _sdf, "data-string", false, errors);
+      bool result = sdf::readDoc(&xmlDoc, _sdf, "data-string", false,
+          ParserConfig(), errors, true);
 
       // Output errors
       for (auto const &e : errors)
@@ -1438,291 +3453,290 @@ bool convertString(const std::string &_sdfString, const std::string &_version,
 }
 
 //////////////////////////////////////////////////
-bool checkCanonicalLinkNames(const sdf::Root *_root)
+bool convertElement(ElementPtr _sdf, const std::string &_version)
 {
-  if (!_root)
+  if (nullptr == _sdf)
   {
-    std::cerr << "Error: invalid sdf::Root pointer, unable to "
-              << "check canonical link names."
-              << std::endl;
+    sdferr << "SDF element is null.\n";
     return false;
   }
 
-  bool result = true;
+  return sdf::Converter::Convert(_sdf, _version, true);
+}
 
-  auto checkModelCanonicalLinkName = [](
-      const sdf::Model *_model) -> bool
-  {
-    bool modelResult = true;
-    std::string canonicalLink = _model->CanonicalLinkName();
-    if (!canonicalLink.empty() && !_model->LinkNameExists(canonicalLink))
-    {
-      std::cerr << "Error: canonical_link with name[" << canonicalLink
-                << "] not found in model with name[" << _model->Name()
-                << "]."
-                << std::endl;
-      modelResult = false;
-    }
-    return modelResult;
-  };
+//////////////////////////////////////////////////
+/// \brief Set the path and the elements reported by the parse event of a
+/// validation pass.
+/// \param[in] _event The parse event.
+/// \param[in] _root The validated Root, which may be null.
+static void setCheckedRoot(ScopedParseEvent &_event, const sdf::Root *_root)
+{
+  if (!_event.Enabled() || !_root || !_root->Element())
+    return;
 
-  for (uint64_t m = 0; m < _root->ModelCount(); ++m)
-  {
-    auto model = _root->ModelByIndex(m);
-    result = checkModelCanonicalLinkName(model) && result;
-  }
+  _event.SetPath(_root->Element()->FilePath());
+  _event.SetElements(_root->Element());
+}
 
-  for (uint64_t w = 0; w < _root->WorldCount(); ++w)
+//////////////////////////////////////////////////
+/// \brief Check the canonical_link of a model, as in
+/// checkCanonicalLinkNames.
+/// \param[in] _model The model.
+/// \return True if the canonical_link is valid.
+static bool checkModelCanonicalLinkName(const sdf::Model *_model)
+{
+  bool modelResult = true;
+  std::string canonicalLink = _model->CanonicalLinkName();
+  if (!canonicalLink.empty() && !_model->LinkNameExists(canonicalLink))
   {
-    auto world = _root->WorldByIndex(w);
-    for (uint64_t m = 0; m < world->ModelCount(); ++m)
-    {
-      auto model = world->ModelByIndex(m);
-      result = checkModelCanonicalLinkName(model) && result;
-    }
+    checkOutput() << "Error: canonical_link with name[" << canonicalLink
+                  << "] not found in model with name[" << _model->Name()
+                  << "]."
+                  << std::endl;
+    modelResult = false;
   }
-
-  return result;
+  return modelResult;
 }
 
 //////////////////////////////////////////////////
-bool checkFrameAttachedToNames(const sdf::Root *_root)
+/// \brief Check the attached_to names of the frames of a model, as in
+/// checkFrameAttachedToNames.
+/// \param[in] _model The model.
+/// \return True if the attached_to names are valid.
+static bool checkModelFrameAttachedToNames(const sdf::Model *_model)
 {
-  bool result = true;
-
-  auto checkModelFrameAttachedToNames = [](
-      const sdf::Model *_model) -> bool
+  bool modelResult = true;
+  for (uint64_t f = 0; f < _model->FrameCount(); ++f)
   {
-    bool modelResult = true;
-    for (uint64_t f = 0; f < _model->FrameCount(); ++f)
-    {
-      auto frame = _model->FrameByIndex(f);
-
-      const std::string &attachedTo = frame->AttachedTo();
+    auto frame = _model->FrameByIndex(f);
 
-      // the attached_to attribute is always permitted to be empty
-      if (attachedTo.empty())
-      {
-        continue;
-      }
+    const std::string &attachedTo = frame->AttachedTo();
 
-      if (attachedTo == frame->Name())
-      {
-        std::cerr << "Error: attached_to name[" << attachedTo
-                  << "] is identical to frame name[" << frame->Name()
-                  << "], causing a graph cycle "
-                  << "in model with name[" << _model->Name()
-                  << "]."
-                  << std::endl;
-        modelResult = false;
-      }
-      else if (!_model->LinkNameExists(attachedTo) &&
-               !_model->JointNameExists(attachedTo) &&
-               !_model->FrameNameExists(attachedTo))
-      {
-        std::cerr << "Error: attached_to name[" << attachedTo
-                  << "] specified by frame with name[" << frame->Name()
-                  << "] does not match a link, joint, or frame name "
-                  << "in model with name[" << _model->Name()
-                  << "]."
-                  << std::endl;
-        modelResult = false;
-      }
+    // the attached_to attribute is always permitted to be empty
+    if (attachedTo.empty())
+    {
+      continue;
     }
-    return modelResult;
-  };
 
-  auto checkWorldFrameAttachedToNames = [](
-      const sdf::World *_world) -> bool
-  {
-    bool worldResult = true;
-    for (uint64_t f = 0; f < _world->FrameCount(); ++f)
+    if (attachedTo == frame->Name())
+    {
+      checkOutput() << "Error: attached_to name[" << attachedTo
+                    << "] is identical to frame name[" << frame->Name()
+                    << "], causing a graph cycle "
+                    << "in model with name[" << _model->Name()
+                    << "]."
+                    << std::endl;
+      modelResult = false;
+    }
+    else if (!_model->LinkNameExists(attachedTo) &&
+             !_model->JointNameExists(attachedTo) &&
+             !_model->FrameNameExists(attachedTo))
     {
-      auto frame = _world->FrameByIndex(f);
+      checkOutput() << "Error: attached_to name[" << attachedTo
+                    << "] specified by frame with name[" << frame->Name()
+                    << "] does not match a link, joint, or frame name "
+                    << "in model with name[" << _model->Name()
+                    << "]."
+                    << std::endl;
+      modelResult = false;
+    }
+  }
+  return modelResult;
+}
 
-      const std::string &attachedTo = frame->AttachedTo();
+//////////////////////////////////////////////////
+/// \brief Check the attached_to names of the frames of a world, as in
+/// checkFrameAttachedToNames.
+/// \param[in] _world The world.
+/// \return True if the attached_to names are valid.
+static bool checkWorldFrameAttachedToNames(const sdf::World *_world)
+{
+  bool worldResult = true;
+  for (uint64_t f = 0; f < _world->FrameCount(); ++f)
+  {
+    auto frame = _world->FrameByIndex(f);
 
-      // the attached_to attribute is always permitted to be empty
-      if (attachedTo.empty())
-      {
-        continue;
-      }
+    const std::string &attachedTo = frame->AttachedTo();
 
-      if (attachedTo == frame->Name())
-      {
-        std::cerr << "Error: attached_to name[" << attachedTo
-                  << "] is identical to frame name[" << frame->Name()
-                  << "], causing a graph cycle "
-                  << "in world with name[" << _world->Name()
-                  << "]."
-                  << std::endl;
-        worldResult = false;
-      }
-      else if (!_world->ModelNameExists(attachedTo) &&
-               !_world->FrameNameExists(attachedTo))
-      {
-        std::cerr << "Error: attached_to name[" << attachedTo
-                  << "] specified by frame with name[" << frame->Name()
-                  << "] does not match a model or frame name "
-                  << "in world with name[" << _world->Name()
-                  << "]."
-                  << std::endl;
-        worldResult = false;
-      }
+    // the attached_to attribute is always permitted to be empty
+    if (attachedTo.empty())
+    {
+      continue;
     }
-    return worldResult;
-  };
-
-  for (uint64_t m = 0; m < _root->ModelCount(); ++m)
-  {
-    auto model = _root->ModelByIndex(m);
-    result = checkModelFrameAttachedToNames(model) && result;
-  }
 
-  for (uint64_t w = 0; w < _root->WorldCount(); ++w)
-  {
-    auto world = _root->WorldByIndex(w);
-    result = checkWorldFrameAttachedToNames(world) && result;
-    for (uint64_t m = 0; m < world->ModelCount(); ++m)
+    if (attachedTo == frame->Name())
+    {
+      checkOutput() << "Error: attached_to name[" << attachedTo
+                    << "] is identical to frame name[" << frame->Name()
+                    << "], causing a graph cycle "
+                    << "in world with name[" << _world->Name()
+                    << "]."
+                    << std::endl;
+      worldResult = false;
+    }
+    else if (!_world->ModelNameExists(attachedTo) &&
+             !_world->FrameNameExists(attachedTo))
     {
-      auto model = world->ModelByIndex(m);
-      result = checkModelFrameAttachedToNames(model) && result;
+      checkOutput() << "Error: attached_to name[" << attachedTo
+                    << "] specified by frame with name[" << frame->Name()
+                    << "] does not match a model or frame name "
+                    << "in world with name[" << _world->Name()
+                    << "]."
+                    << std::endl;
+      worldResult = false;
     }
   }
-
-  return result;
+  return worldResult;
 }
 
 //////////////////////////////////////////////////
-bool recursiveSameTypeUniqueNames(sdf::ElementPtr _elem)
+/// \brief Build and validate the attached_to graph of a model or world, as
+/// in checkFrameAttachedToGraph.
+/// \param[in] _scope The model or world.
+/// \return True if the graph is valid.
+template <typename T>
+static bool checkScopeFrameAttachedToGraph(const T *_scope)
 {
-  if (!shouldValidateElement(_elem))
-    return true;
-
-  bool result = true;
-  auto typeNames = _elem->GetElementTypeNames();
-  for (const std::string &typeName : typeNames)
+  bool scopeResult = true;
+  sdf::FrameAttachedToGraph graph;
+  auto errors = sdf::buildFrameAttachedToGraph(graph, _scope);
+  if (!errors.empty())
   {
-    if (!_elem->HasUniqueChildNames(typeName))
+    for (auto &error : errors)
     {
-      std::cerr << "Error: Non-unique names detected in type "
-                << typeName << " in\n"
-                << _elem->ToString("")
-                << std::endl;
-      result = false;
+      checkOutput() << "Error: " << error.Message() << std::endl;
     }
+    scopeResult = false;
   }
-
-  sdf::ElementPtr child = _elem->GetFirstElement();
-  while (child)
+  errors = sdf::validateFrameAttachedToGraph(graph);
+  if (!errors.empty())
   {
-    result = recursiveSameTypeUniqueNames(child) && result;
-    child = child->GetNextElement();
+    for (auto &error : errors)
+    {
+      checkOutput() << "Error in validateFrameAttachedToGraph: "
+                    << error.Message()
+                    << std::endl;
+    }
+    scopeResult = false;
   }
-
-  return result;
+  return scopeResult;
 }
 
 //////////////////////////////////////////////////
-bool recursiveSiblingUniqueNames(sdf::ElementPtr _elem)
+/// \brief Build and validate the pose relative_to graph of a model or
+/// world, as in checkPoseRelativeToGraph.
+/// \param[in] _scope The model or world.
+/// \return True if the graph is valid.
+template <typename T>
+static bool checkScopePoseRelativeToGraph(const T *_scope)
 {
-  if (!shouldValidateElement(_elem))
-    return true;
-
-  bool result = _elem->HasUniqueChildNames();
-  if (!result)
+  bool scopeResult = true;
+  sdf::PoseRelativeToGraph graph;
+  auto errors = sdf::buildPoseRelativeToGraph(graph, _scope);
+  if (!errors.empty())
   {
-    std::cerr << "Error: Non-unique names detected in "
-              << _elem->ToString("")
-              << std::endl;
-    result = false;
+    for (auto &error : errors)
+    {
+      checkOutput() << "Error: " << error.Message() << std::endl;
+    }
+    scopeResult = false;
   }
-
-  sdf::ElementPtr child = _elem->GetFirstElement();
-  while (child)
+  errors = sdf::validatePoseRelativeToGraph(graph);
+  if (!errors.empty())
   {
-    result = recursiveSiblingUniqueNames(child) && result;
-    child = child->GetNextElement();
+    for (auto &error : errors)
+    {
+      checkOutput() << "Error in validatePoseRelativeToGraph: "
+                    << error.Message()
+                    << std::endl;
+    }
+    scopeResult = false;
   }
-
-  return result;
+  return scopeResult;
 }
 
 //////////////////////////////////////////////////
-bool checkFrameAttachedToGraph(const sdf::Root *_root)
+/// \brief Check the parent and child link names of the joints of a model,
+/// as in checkJointParentChildLinkNames.
+/// \param[in] _model The model.
+/// \return True if the link names are valid.
+static bool checkModelJointParentChildNames(const sdf::Model *_model)
 {
-  bool result = true;
-
-  auto checkModelFrameAttachedToGraph = [](
-      const sdf::Model *_model) -> bool
+  bool modelResult = true;
+  for (uint64_t j = 0; j < _model->JointCount(); ++j)
   {
-    bool modelResult = true;
-    sdf::FrameAttachedToGraph graph;
-    auto errors = sdf::buildFrameAttachedToGraph(graph, _model);
-    if (!errors.empty())
+    auto joint = _model->JointByIndex(j);
+
+    const std::string &parentName = joint->ParentLinkName();
+    if (parentName != "world" && !_model->LinkNameExists(parentName))
     {
-      for (auto &error : errors)
-      {
-        std::cerr << "Error: " << error.Message() << std::endl;
-      }
+      checkOutput() << "Error: parent link with name[" << parentName
+                    << "] specified by joint with name[" << joint->Name()
+                    << "] not found in model with name[" << _model->Name()
+                    << "]."
+                    << std::endl;
       modelResult = false;
     }
-    errors = sdf::validateFrameAttachedToGraph(graph);
-    if (!errors.empty())
+
+    const std::string &childName = joint->ChildLinkName();
+    if (childName != "world" && !_model->LinkNameExists(childName))
     {
-      for (auto &error : errors)
-      {
-        std::cerr << "Error in validateFrameAttachedToGraph: "
-                  << error.Message()
-                  << std::endl;
-      }
+      checkOutput() << "Error: child link with name[" << childName
+                    << "] specified by joint with name[" << joint->Name()
+                    << "] not found in model with name[" << _model->Name()
+                    << "]."
+                    << std::endl;
       modelResult = false;
     }
-    return modelResult;
-  };
 
-  auto checkWorldFrameAttachedToGraph = [](
-      const sdf::World *_world) -> bool
-  {
-    bool worldResult = true;
-    sdf::FrameAttachedToGraph graph;
-    auto errors = sdf::buildFrameAttachedToGraph(graph, _world);
-    if (!errors.empty())
-    {
-      for (auto &error : errors)
-      {
-        std::cerr << "Error: " << error.Message() << std::endl;
-      }
-      worldResult = false;
-    }
-    errors = sdf::validateFrameAttachedToGraph(graph);
-    if (!errors.empty())
+    if (childName == parentName)
     {
-      for (auto &error : errors)
-      {
-        std::cerr << "Error in validateFrameAttachedToGraph: "
-                  << error.Message()
-                  << std::endl;
-      }
-      worldResult = false;
+      checkOutput() << "Error: joint with name[" << joint->Name()
+                    << "] in model with name[" << _model->Name()
+                    << "] must specify different link names for "
+                    << "parent and child, while [" << childName
+                    << "] was specified for both."
+                    << std::endl;
+      modelResult = false;
     }
-    return worldResult;
-  };
+  }
+  return modelResult;
+}
 
-  for (uint64_t m = 0; m < _root->ModelCount(); ++m)
+//////////////////////////////////////////////////
+/// \brief Run checks on every model and world of a root in a single pass.
+/// Worlds are checked before their models, and every object is checked
+/// exhaustively.
+/// \param[in] _root The root.
+/// \param[in] _checkModel Check of a model, or nullptr.
+/// \param[in] _checkWorld Check of a world, or nullptr.
+/// \return True if every check passed.
+static bool checkModelsAndWorlds(const sdf::Root *_root,
+    const std::function<bool(const sdf::Model *)> &_checkModel,
+    const std::function<bool(const sdf::World *)> &_checkWorld)
+{
+  bool result = true;
+  if (_checkModel)
   {
-    auto model = _root->ModelByIndex(m);
-    result = checkModelFrameAttachedToGraph(model) && result;
+    for (uint64_t m = 0; m < _root->ModelCount(); ++m)
+    {
+      result = _checkModel(_root->ModelByIndex(m)) && result;
+    }
   }
 
   for (uint64_t w = 0; w < _root->WorldCount(); ++w)
   {
     auto world = _root->WorldByIndex(w);
-    result = checkWorldFrameAttachedToGraph(world) && result;
-    for (uint64_t m = 0; m < world->ModelCount(); ++m)
+    if (_checkWorld)
     {
-      auto model = world->ModelByIndex(m);
-      result = checkModelFrameAttachedToGraph(model) && result;
+      result = _checkWorld(world) && result;
+    }
+    if (_checkModel)
+    {
+      for (uint64_t m = 0; m < world->ModelCount(); ++m)
+      {
+        result = _checkModel(world->ModelByIndex(m)) && result;
+      }
     }
   }
 
@@ -1730,171 +3744,173 @@ bool checkFrameAttachedToGraph(const sdf::Root *_root)
 }
 
 //////////////////////////////////////////////////
-bool checkPoseRelativeToGraph(const sdf::Root *_root)
+bool checkCanonicalLinkNames(const sdf::Root *_root)
 {
-  bool result = true;
+  ScopedParseEvent checkEvent(ParseStage::CHECK,
+      "sdf::checkCanonicalLinkNames");
+  setCheckedRoot(checkEvent, _root);
 
-  auto checkModelPoseRelativeToGraph = [](
-      const sdf::Model *_model) -> bool
+  if (!_root)
   {
-    bool modelResult = true;
-    sdf::PoseRelativeToGraph graph;
-    auto errors = sdf::buildPoseRelativeToGraph(graph, _model);
-    if (!errors.empty())
-    {
-      for (auto &error : errors)
-      {
-        std::cerr << "Error: " << error.Message() << std::endl;
-      }
-      modelResult = false;
-    }
-    errors = sdf::validatePoseRelativeToGraph(graph);
-    if (!errors.empty())
-    {
-      for (auto &error : errors)
-      {
-        std::cerr << "Error in validatePoseRelativeToGraph: "
-                  << error.Message()
+    checkOutput() << "Error: invalid sdf::Root pointer, unable to "
+                  << "check canonical link names."
                   << std::endl;
-      }
-      modelResult = false;
-    }
-    return modelResult;
-  };
+    return false;
+  }
 
-  auto checkWorldPoseRelativeToGraph = [](
-      const sdf::World *_world) -> bool
-  {
-    bool worldResult = true;
-    sdf::PoseRelativeToGraph graph;
-    auto errors = sdf::buildPoseRelativeToGraph(graph, _world);
-    if (!errors.empty())
-    {
-      for (auto &error : errors)
-      {
-        std::cerr << "Error: " << error.Message() << std::endl;
-      }
-      worldResult = false;
-    }
-    errors = sdf::validatePoseRelativeToGraph(graph);
-    if (!errors.empty())
-    {
-      for (auto &error : errors)
-      {
-        std::cerr << "Error in validatePoseRelativeToGraph: "
-                  << error.Message()
-                  << std::endl;
-      }
-      worldResult = false;
-    }
-    return worldResult;
-  };
+  return checkModelsAndWorlds(_root, checkModelCanonicalLinkName, nullptr);
+}
 
-  for (uint64_t m = 0; m < _root->ModelCount(); ++m)
-  {
-    auto model = _root->ModelByIndex(m);
-    result = checkModelPoseRelativeToGraph(model) && result;
-  }
+//////////////////////////////////////////////////
+bool checkFrameAttachedToNames(const sdf::Root *_root)
+{
+  ScopedParseEvent checkEvent(ParseStage::CHECK,
+      "sdf::checkFrameAttachedToNames");
+  setCheckedRoot(checkEvent, _root);
 
-  for (uint64_t w = 0; w < _root->WorldCount(); ++w)
-  {
-    auto world = _root->WorldByIndex(w);
-    result = checkWorldPoseRelativeToGraph(world) && result;
-    for (uint64_t m = 0; m < world->ModelCount(); ++m)
-    {
-      auto model = world->ModelByIndex(m);
-      result = checkModelPoseRelativeToGraph(model) && result;
-    }
-  }
+  return checkModelsAndWorlds(_root, checkModelFrameAttachedToNames,
+      checkWorldFrameAttachedToNames);
+}
 
-  return result;
+//////////////////////////////////////////////////
+/// \brief Get whether an element and its descendants are checked.
+/// \param[in] _elem The element.
+/// \return False for <plugin> and namespaced elements.
+static bool shouldValidate(const sdf::Element &_elem)
+{
+  // Ignore <plugin> elements, and namespaced elements, whose name has a
+  // colon.
+  const std::string &name = _elem.GetName();
+  return name != "plugin" && name.find(':') == std::string::npos;
 }
 
 //////////////////////////////////////////////////
-bool checkJointParentChildLinkNames(const sdf::Root *_root)
+bool recursiveSameTypeUniqueNames(sdf::ElementPtr _elem)
 {
   bool result = true;
+  _elem->Visit([&result](const sdf::Element &_visited)
+      {
+        if (!shouldValidate(_visited))
+          return false;
 
-  auto checkModelJointParentChildNames = [](
-      const sdf::Model *_model) -> bool
-  {
-    bool modelResult = true;
-    for (uint64_t j = 0; j < _model->JointCount(); ++j)
-    {
-      auto joint = _model->JointByIndex(j);
+        for (const std::string &typeName : _visited.GetElementTypeNames())
+        {
+          if (!_visited.HasUniqueChildNames(typeName))
+          {
+            checkOutput() << "Error: Non-unique names detected in type "
+                          << typeName << " in\n"
+                          << _visited.ToString("")
+                          << std::endl;
+            result = false;
+          }
+        }
+        return true;
+      });
 
-      const std::string &parentName = joint->ParentLinkName();
-      if (parentName != "world" && !_model->LinkNameExists(parentName))
-      {
-        std::cerr << "Error: parent link with name[" << parentName
-                  << "] specified by joint with name[" << joint->Name()
-                  << "] not found in model with name[" << _model->Name()
-                  << "]."
-                  << std::endl;
-        modelResult = false;
-      }
+  return result;
+}
 
-      const std::string &childName = joint->ChildLinkName();
-      if (childName != "world" && !_model->LinkNameExists(childName))
+//////////////////////////////////////////////////
+bool recursiveSiblingUniqueNames(sdf::ElementPtr _elem)
+{
+  bool result = true;
+  _elem->Visit([&result](const sdf::Element &_visited)
       {
-        std::cerr << "Error: child link with name[" << childName
-                  << "] specified by joint with name[" << joint->Name()
-                  << "] not found in model with name[" << _model->Name()
-                  << "]."
-                  << std::endl;
-        modelResult = false;
-      }
+        if (!shouldValidate(_visited))
+          return false;
 
-      if (childName == parentName)
-      {
-        std::cerr << "Error: joint with name[" << joint->Name()
-                  << "] in model with name[" << _model->Name()
-                  << "] must specify different link names for "
-                  << "parent and child, while [" << childName
-                  << "] was specified for both."
-                  << std::endl;
-        modelResult = false;
-      }
-    }
-    return modelResult;
-  };
+        if (!_visited.HasUniqueChildNames())
+        {
+          checkOutput() << "Error: Non-unique names detected in "
+                        << _visited.ToString("")
+                        << std::endl;
+          result = false;
+        }
+        return true;
+      });
 
-  for (uint64_t m = 0; m < _root->ModelCount(); ++m)
-  {
-    auto model = _root->ModelByIndex(m);
-    result = checkModelJointParentChildNames(model) && result;
-  }
+  return result;
+}
 
-  for (uint64_t w = 0; w < _root->WorldCount(); ++w)
-  {
-    auto world = _root->WorldByIndex(w);
-    for (uint64_t m = 0; m < world->ModelCount(); ++m)
-    {
-      auto model = world->ModelByIndex(m);
-      result = checkModelJointParentChildNames(model) && result;
-    }
-  }
+//////////////////////////////////////////////////
+bool checkFrameAttachedToGraph(const sdf::Root *_root)
+{
+  ScopedParseEvent checkEvent(ParseStage::CHECK,
+      "sdf::checkFrameAttachedToGraph");
+  setCheckedRoot(checkEvent, _root);
 
-  return result;
+  return checkModelsAndWorlds(_root,
+      checkScopeFrameAttachedToGraph<sdf::Model>,
+      checkScopeFrameAttachedToGraph<sdf::World>);
 }
 
 //////////////////////////////////////////////////
-bool shouldValidateElement(sdf::ElementPtr _elem)
+bool checkPoseRelativeToGraph(const sdf::Root *_root)
+{
+  ScopedParseEvent checkEvent(ParseStage::CHECK,
+      "sdf::checkPoseRelativeToGraph");
+  setCheckedRoot(checkEvent, _root);
+
+  return checkModelsAndWorlds(_root,
+      checkScopePoseRelativeToGraph<sdf::Model>,
+      checkScopePoseRelativeToGraph<sdf::World>);
+}
+
+//////////////////////////////////////////////////
+bool checkJointParentChildLinkNames(const sdf::Root *_root)
+{
+  ScopedParseEvent checkEvent(ParseStage::CHECK,
+      "sdf::checkJointParentChildLinkNames");
+  setCheckedRoot(checkEvent, _root);
+
+  return checkModelsAndWorlds(_root, checkModelJointParentChildNames,
+      nullptr);
+}
+
+//////////////////////////////////////////////////
+bool checkRoot(const sdf::Root *_root)
 {
-  if (_elem->GetName() == "plugin")
+  ScopedParseEvent checkEvent(ParseStage::CHECK, "sdf::checkRoot");
+  setCheckedRoot(checkEvent, _root);
+
+  if (!_root)
   {
-    // Ignore <plugin> elements
+    checkOutput() << "Error: invalid sdf::Root pointer, unable to "
+                  << "check it."
+                  << std::endl;
     return false;
   }
 
-  // Check if the element name has a colon. This is treated as a namespaced
-  // element and should be ignored
-  if (_elem->GetName().find(":") != std::string::npos)
+  // Each model and world is visited once, while its links, joints and
+  // frames are still in the cache, and every check is run on it.
+  bool result = checkModelsAndWorlds(_root,
+      [](const sdf::Model *_model)
+      {
+        bool modelResult = checkModelCanonicalLinkName(_model);
+        modelResult = checkModelJointParentChildNames(_model) && modelResult;
+        modelResult = checkScopeFrameAttachedToGraph(_model) && modelResult;
+        modelResult = checkScopePoseRelativeToGraph(_model) && modelResult;
+        return modelResult;
+      },
+      [](const sdf::World *_world)
+      {
+        bool worldResult = checkScopeFrameAttachedToGraph(_world);
+        worldResult = checkScopePoseRelativeToGraph(_world) && worldResult;
+        return worldResult;
+      });
+
+  if (_root->Element())
   {
-    return false;
+    result = recursiveSiblingUniqueNames(_root->Element()) && result;
   }
 
-  return true;
+  return result;
+}
+
+//////////////////////////////////////////////////
+bool shouldValidateElement(sdf::ElementPtr _elem)
+{
+  return shouldValidate(*_elem);
 }
 }
 }
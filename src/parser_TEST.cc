@@ -16,8 +16,21 @@
  */
 
 #include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
 #include "sdf/parser.hh"
 #include "sdf/Element.hh"
+#include "sdf/ElementDiff.hh"
+#include "sdf/Filesystem.hh"
+#include "sdf/ParserConfig.hh"
+#include "sdf/Root.hh"
 #include "test_config.h"
 
 /////////////////////////////////////////////////
@@ -343,6 +356,100 @@ TEST(Parser, addNestedModel)
   }
 }
 
+/////////////////////////////////////////////////
+TEST(Parser, addNestedModelCustomElements)
+{
+  const std::string sdfString =
+    "<sdf version='" SDF_VERSION "'>"
+    "<model name='included'>"
+    "  <experimental:params name='parent'>"
+    "    <target>  child </target>"
+    "  </experimental:params>"
+    "  <link name='parent'/>"
+    "  <link name='child'>"
+    "    <pose relative_to='parent'>1 0 0 0 0 0</pose>"
+    "  </link>"
+    "  <plugin name='plugin' filename='libplugin.so'>"
+    "    <link>child</link>"
+    "    <frame name='parent'>unchanged</frame>"
+    "  </plugin>"
+    "</model>"
+    "</sdf>";
+
+  sdf::Errors errors;
+  sdf::SDFPtr sdf = InitSDF();
+  EXPECT_TRUE(sdf::readString(sdfString, sdf, errors));
+  EXPECT_TRUE(errors.empty());
+
+  sdf::ElementPtr elem = std::make_shared<sdf::Element>();
+  sdf::initFile("model.sdf", elem);
+  sdf::addNestedModel(elem, sdf->Root(), errors);
+  EXPECT_TRUE(errors.empty());
+
+  sdf::ElementPtr child = elem->GetElement("link")->GetNextElement("link");
+  ASSERT_NE(nullptr, child);
+  EXPECT_EQ("included::child", child->Get<std::string>("name"));
+  sdf::ElementPtr pose = child->GetElement("pose");
+  EXPECT_EQ("included::parent", pose->Get<std::string>("relative_to"));
+  EXPECT_EQ(ignition::math::Pose3d(1, 0, 0, 0, 0, 0),
+      pose->Get<ignition::math::Pose3d>());
+
+  // Values and attributes of plugins are renamed as well.
+  ASSERT_TRUE(elem->HasElement("plugin"));
+  sdf::ElementPtr plugin = elem->GetElement("plugin");
+  EXPECT_EQ("plugin", plugin->Get<std::string>("name"));
+  EXPECT_EQ("included::child",
+      plugin->GetElement("link")->Get<std::string>());
+  EXPECT_EQ("included::parent",
+      plugin->GetElement("frame")->Get<std::string>("name"));
+  EXPECT_EQ("unchanged", plugin->GetElement("frame")->Get<std::string>());
+
+  // Unknown elements are moved after the known ones, and their values are
+  // condensed like a parsed XML text.
+  ASSERT_TRUE(elem->HasElement("experimental:params"));
+  sdf::ElementPtr params = elem->GetElement("experimental:params");
+  EXPECT_EQ("included::parent", params->Get<std::string>("name"));
+  EXPECT_EQ("included::child",
+      params->GetElement("target")->Get<std::string>());
+  EXPECT_EQ(nullptr, params->GetNextElement());
+}
+
+/////////////////////////////////////////////////
+TEST(Parser, CheckRoot)
+{
+  // checkRoot runs the checks of 'ign sdf -k' in one pass, with the same
+  // result as running them one after the other.
+  for (const std::string file : {
+        "model_canonical_link.sdf",
+        "model_frame_attached_to.sdf",
+        "model_invalid_canonical_link.sdf",
+        "joint_invalid_child.sdf",
+        "joint_invalid_parent_same_as_child.sdf",
+        "model_frame_invalid_attached_to_cycle.sdf",
+        "world_frame_invalid_attached_to.sdf",
+        "world_sibling_same_names.sdf"})
+  {
+    const std::string path = sdf::filesystem::append(PROJECT_SOURCE_PATH,
+        "test", "sdf", file);
+    sdf::Root root;
+    root.Load(path);
+
+    const bool expected =
+        sdf::checkCanonicalLinkNames(&root) &&
+        sdf::checkJointParentChildLinkNames(&root) &&
+        sdf::checkFrameAttachedToGraph(&root) &&
+        sdf::checkPoseRelativeToGraph(&root) &&
+        sdf::recursiveSiblingUniqueNames(root.Element());
+    EXPECT_EQ(expected, sdf::checkRoot(&root)) << file;
+  }
+
+  sdf::Root root;
+  EXPECT_TRUE(root.Load(sdf::filesystem::append(PROJECT_SOURCE_PATH, "test",
+      "sdf", "model_canonical_link.sdf")).empty());
+  EXPECT_TRUE(sdf::checkRoot(&root));
+  EXPECT_FALSE(sdf::checkRoot(nullptr));
+}
+
 /////////////////////////////////////////////////
 TEST(Parser, NameUniqueness)
 {
@@ -532,6 +639,399 @@ TEST(Parser, SyntaxErrorInValues)
 #endif
 }
 
+/////////////////////////////////////////////////
+/// \brief Get the files of a directory.
+std::vector<std::string> ListFiles(const std::string &_dir)
+{
+  std::vector<std::string> files;
+  sdf::filesystem::DirIter endIter;
+  for (sdf::filesystem::DirIter dirIter(_dir); dirIter != endIter; ++dirIter)
+  {
+    files.push_back(*dirIter);
+  }
+  return files;
+}
+
+/////////////////////////////////////////////////
+TEST(Parser, ConversionCache)
+{
+  const std::string cacheDir = sdf::filesystem::append(
+      PROJECT_BINARY_DIR, "test", "parser_TEST_conversion_cache");
+  for (const auto &file : ListFiles(cacheDir))
+  {
+    std::remove(file.c_str());
+  }
+
+  const std::string path16 = sdf::filesystem::append(
+      PROJECT_SOURCE_PATH, "test", "sdf", "joint_complete.sdf");
+  const std::string path18 = sdf::filesystem::append(
+      PROJECT_BINARY_DIR, "test", "parser_TEST_conversion_cache.sdf");
+  {
+    std::ofstream out(path18);
+    out << "<sdf version='" << SDF_PROTOCOL_VERSION << "'>"
+        << "<model name='m'><link name='l'/></model></sdf>";
+  }
+  const std::string pathUrdf = sdf::filesystem::append(
+      PROJECT_SOURCE_PATH, "test", "integration", "fixed_joint_reduction.urdf");
+
+  sdf::SDFPtr expected16 = InitSDF();
+  ASSERT_TRUE(sdf::readFile(path16, expected16));
+  sdf::SDFPtr expectedUrdf = InitSDF();
+  ASSERT_TRUE(sdf::readFile(pathUrdf, expectedUrdf));
+
+  EXPECT_TRUE(sdf::conversionCacheDirectory().empty());
+  sdf::setConversionCacheDirectory(cacheDir);
+  EXPECT_EQ(cacheDir, sdf::conversionCacheDirectory());
+  ASSERT_TRUE(sdf::filesystem::is_directory(cacheDir));
+  EXPECT_TRUE(ListFiles(cacheDir).empty());
+
+  // Files of the current version are not cached.
+  sdf::SDFPtr sdf18 = InitSDF();
+  ASSERT_TRUE(sdf::readFile(path18, sdf18));
+  EXPECT_TRUE(ListFiles(cacheDir).empty());
+
+  // The first read stores the conversion, the second one loads it.
+  for (int i = 0; i < 2; ++i)
+  {
+    sdf::SDFPtr sdf = InitSDF();
+    ASSERT_TRUE(sdf::readFile(path16, sdf));
+    EXPECT_EQ(1u, ListFiles(cacheDir).size());
+    EXPECT_EQ(expected16->Root()->ToString(""), sdf->Root()->ToString(""));
+    EXPECT_EQ(path16, sdf->FilePath());
+    EXPECT_EQ("1.6", sdf->OriginalVersion());
+    EXPECT_EQ("1.6", sdf->Root()->OriginalVersion());
+    EXPECT_EQ(SDF_PROTOCOL_VERSION, sdf->Root()->Get<std::string>("version"));
+  }
+
+  for (int i = 0; i < 2; ++i)
+  {
+    sdf::SDFPtr sdf = InitSDF();
+    ASSERT_TRUE(sdf::readFile(pathUrdf, sdf));
+    EXPECT_EQ(2u, ListFiles(cacheDir).size());
+    EXPECT_EQ(expectedUrdf->Root()->ToString(""), sdf->Root()->ToString(""));
+    EXPECT_EQ("urdf file", sdf->FilePath());
+    EXPECT_EQ("1.7", sdf->OriginalVersion());
+    EXPECT_EQ("1.7", sdf->Root()->OriginalVersion());
+  }
+
+  // Change the cached conversion of the 1.6 file to check that it is the
+  // one that is read.
+  for (const auto &file : ListFiles(cacheDir))
+  {
+    std::ifstream in(file);
+    std::stringstream content;
+    content << in.rdbuf();
+    in.close();
+    std::string text = content.str();
+    const std::string name = "<model name=\"test\">";
+    const size_t pos = text.find(name);
+    if (pos != std::string::npos)
+    {
+      text.replace(pos, name.size(), "<model name=\"cached\">");
+      std::ofstream out(file);
+      out << text;
+    }
+  }
+  {
+    sdf::SDFPtr sdf = InitSDF();
+    ASSERT_TRUE(sdf::readFile(path16, sdf));
+    EXPECT_EQ("cached",
+        sdf->Root()->GetElement("model")->Get<std::string>("name"));
+  }
+
+  // Reading without conversion does not use the cache.
+  {
+    sdf::Errors errors;
+    sdf::SDFPtr sdf = InitSDF();
+    ASSERT_TRUE(sdf::readFileWithoutConversion(path16, sdf, errors));
+    EXPECT_EQ("1.6", sdf->Root()->Get<std::string>("version"));
+    EXPECT_EQ("test",
+        sdf->Root()->GetElement("model")->Get<std::string>("name"));
+  }
+
+  // Invalid entries are ignored and replaced.
+  for (const auto &file : ListFiles(cacheDir))
+  {
+    std::ofstream out(file);
+    out << "<sdf version='1.0'/>";
+  }
+  {
+    sdf::SDFPtr sdf = InitSDF();
+    ASSERT_TRUE(sdf::readFile(path16, sdf));
+    EXPECT_EQ(expected16->Root()->ToString(""), sdf->Root()->ToString(""));
+  }
+
+  sdf::setConversionCacheDirectory("");
+  EXPECT_TRUE(sdf::conversionCacheDirectory().empty());
+  std::remove(path18.c_str());
+  for (const auto &file : ListFiles(cacheDir))
+  {
+    std::remove(file.c_str());
+  }
+}
+
+/////////////////////////////////////////////////
+TEST(Parser, Warmup)
+{
+  const std::string path16 = sdf::filesystem::append(
+      PROJECT_SOURCE_PATH, "test", "sdf", "joint_complete.sdf");
+
+  sdf::SDFPtr expected = InitSDF();
+  ASSERT_TRUE(sdf::readFile(path16, expected));
+
+  // Warming up twice is harmless, and does not change what is read.
+  sdf::warmup({path16});
+  sdf::warmup();
+
+  sdf::SDFPtr sdf = InitSDF();
+  ASSERT_TRUE(sdf::readFile(path16, sdf));
+  EXPECT_EQ(expected->Root()->ToString(""), sdf->Root()->ToString(""));
+  EXPECT_EQ("1.6", sdf->OriginalVersion());
+}
+
+/////////////////////////////////////////////////
+TEST(Parser, SpecVersion)
+{
+  const std::string defaultVersion = sdf::SDF::Version();
+  const std::string sdfString =
+    "<sdf version='1.5'><model name='m'><link name='l'/></model></sdf>";
+
+  // Read the same document as two versions at the same time.
+  auto read = [&](const std::string &_version, std::string &_result)
+  {
+    for (int i = 0; i < 20; ++i)
+    {
+      sdf::ParserConfig config;
+      config.SetSpecVersion(_version);
+      sdf::SDFPtr sdf(new sdf::SDF());
+      if (!sdf::init(sdf, config))
+        return;
+      sdf::Errors errors;
+      if (!sdf::readString(sdfString, config, sdf, errors) || !errors.empty())
+        return;
+      _result = sdf->Root()->Get<std::string>("version");
+    }
+  };
+
+  std::string version16;
+  std::string versionDefault;
+  std::thread thread16(read, "1.6", std::ref(version16));
+  std::thread threadDefault(read, "", std::ref(versionDefault));
+  thread16.join();
+  threadDefault.join();
+
+  EXPECT_EQ("1.6", version16);
+  EXPECT_EQ(defaultVersion, versionDefault);
+  EXPECT_EQ(defaultVersion, sdf::SDF::Version());
+}
+
+/////////////////////////////////////////////////
+TEST(Parser, ReferencedDescription)
+{
+  const std::string sdfString =
+    "<sdf version='1.8'>"
+    "  <model name='outer'>"
+    "    <model name='first'><link name='a'/></model>"
+    "    <model name='second'><link name='b'/><link name='c'/></model>"
+    "  </model>"
+    "</sdf>";
+
+  // Nested models share the description of the model spec, and reading one
+  // does not change what the next one is read from.
+  for (int i = 0; i < 2; ++i)
+  {
+    sdf::SDFPtr sdf = InitSDF();
+    sdf::Errors errors;
+    ASSERT_TRUE(sdf::readString(sdfString, sdf, errors));
+    EXPECT_TRUE(errors.empty());
+
+    sdf::ElementPtr outer = sdf->Root()->GetElement("model");
+    sdf::ElementPtr first = outer->GetElement("model");
+    ASSERT_NE(nullptr, first);
+    EXPECT_EQ("first", first->Get<std::string>("name"));
+    EXPECT_TRUE(first->HasElementDescription("link"));
+    EXPECT_EQ("a", first->GetElement("link")->Get<std::string>("name"));
+
+    sdf::ElementPtr second = first->GetNextElement("model");
+    ASSERT_NE(nullptr, second);
+    EXPECT_EQ("second", second->Get<std::string>("name"));
+    sdf::ElementPtr link = second->GetElement("link");
+    EXPECT_EQ("b", link->Get<std::string>("name"));
+    link = link->GetNextElement("link");
+    ASSERT_NE(nullptr, link);
+    EXPECT_EQ("c", link->Get<std::string>("name"));
+    EXPECT_EQ(nullptr, link->GetNextElement("link"));
+  }
+}
+
+/////////////////////////////////////////////////
+TEST(Parser, ReadThreadCount)
+{
+  std::string worldString = "<sdf version='1.8'><world name='default'>";
+  for (int i = 0; i < 40; ++i)
+  {
+    const std::string index = std::to_string(i);
+    worldString +=
+      "<model name='model" + index + "'>"
+      "  <pose>" + index + " 0 0 0 0 0</pose>"
+      "  <link name='link'><visual name='visual'><geometry>"
+      "    <box><size>1 1 1</size></box>"
+      "  </geometry></visual></link>"
+      "  <model name='nested'><link name='link'/></model>"
+      "</model>"
+      "<light name='light" + index + "' type='point'/>";
+  }
+
+  auto read = [](const std::string &_string, unsigned int _threadCount,
+                 sdf::Errors &_errors)
+  {
+    sdf::ParserConfig config;
+    config.SetReadThreadCount(_threadCount);
+    sdf::SDFPtr sdf = InitSDF();
+    EXPECT_EQ(_errors.empty(),
+        sdf::readString(_string, config, sdf, _errors));
+    return sdf->Root()->ToString("");
+  };
+
+  // The children of the world are read concurrently into the same tree.
+  const std::string validString = worldString + "</world></sdf>";
+  sdf::Errors errors;
+  const std::string expected = read(validString, 1, errors);
+  EXPECT_TRUE(errors.empty());
+  EXPECT_EQ(expected, read(validString, 4, errors));
+  EXPECT_TRUE(errors.empty());
+  EXPECT_EQ(expected, read(validString, 0, errors));
+  EXPECT_TRUE(errors.empty());
+
+  // Errors are reported like when reading on one thread.
+  const std::string invalidString = worldString +
+    "<model name='invalid'><link name='link'/>"
+    "  <joint name='joint' type='revolute'/>"
+    "</model>"
+    "</world></sdf>";
+  sdf::Errors expectedErrors;
+  read(invalidString, 1, expectedErrors);
+  ASSERT_FALSE(expectedErrors.empty());
+  errors.clear();
+  read(invalidString, 4, errors);
+  ASSERT_EQ(expectedErrors.size(), errors.size());
+  for (std::size_t i = 0; i < errors.size(); ++i)
+  {
+    EXPECT_EQ(expectedErrors[i].Code(), errors[i].Code());
+    EXPECT_EQ(expectedErrors[i].Message(), errors[i].Message());
+  }
+}
+
+/////////////////////////////////////////////////
+TEST(Parser, MaxNestingDepth)
+{
+  // Models nested 20 deep, which are read with recursion.
+  std::string nestedString = "<sdf version='1.8'>";
+  for (int i = 0; i < 20; ++i)
+    nestedString += "<model name='m" + std::to_string(i) + "'>";
+  nestedString += "<link name='l'/>";
+  for (int i = 0; i < 20; ++i)
+    nestedString += "</model>";
+  nestedString += "</sdf>";
+
+  sdf::ParserConfig config;
+  sdf::SDFPtr sdf(new sdf::SDF());
+  ASSERT_TRUE(sdf::init(sdf, config));
+  sdf::Errors errors;
+  EXPECT_TRUE(sdf::readString(nestedString, config, sdf, errors));
+  EXPECT_TRUE(errors.empty());
+
+  config.SetMaxNestingDepth(8);
+  sdf.reset(new sdf::SDF());
+  ASSERT_TRUE(sdf::init(sdf, config));
+  EXPECT_FALSE(sdf::readString(nestedString, config, sdf, errors));
+  ASSERT_FALSE(errors.empty());
+  EXPECT_EQ(sdf::ErrorCode::ELEMENT_NESTING_TOO_DEEP, errors[0].Code());
+
+  // The contents of plugins are copied without recursion, and are not
+  // counted.
+  const int pluginDepth = 5000;
+  std::string pluginString = "<sdf version='1.8'><model name='m'>"
+    "<link name='l'/><plugin name='p' filename='p.so'>";
+  for (int i = 0; i < pluginDepth; ++i)
+    pluginString += "<a>";
+  for (int i = 0; i < pluginDepth; ++i)
+    pluginString += "</a>";
+  pluginString += "</plugin></model></sdf>";
+
+  sdf.reset(new sdf::SDF());
+  ASSERT_TRUE(sdf::init(sdf, config));
+  errors.clear();
+  EXPECT_TRUE(sdf::readString(pluginString, config, sdf, errors));
+  EXPECT_TRUE(errors.empty());
+  sdf::ElementPtr elem = sdf->Root()->GetElement("model")->GetElement(
+      "plugin");
+  int depth = 0;
+  while (elem->HasElement("a"))
+  {
+    elem = elem->GetElement("a");
+    ++depth;
+  }
+  EXPECT_EQ(pluginDepth, depth);
+}
+
+/////////////////////////////////////////////////
+TEST(Parser, PrintFileStreaming)
+{
+  const std::string path = sdf::filesystem::append(PROJECT_SOURCE_PATH,
+      "test", "sdf", "box_plane_low_friction_test.world");
+  sdf::SDFPtr expected(new sdf::SDF());
+  ASSERT_TRUE(sdf::init(expected));
+  ASSERT_TRUE(sdf::readFile(path, expected));
+
+  // The streamed document has the same elements as the one read whole,
+  // with the default elements of the world at its end.
+  std::ostringstream stream;
+  sdf::Errors errors;
+  EXPECT_TRUE(sdf::printFileStreaming(path, stream, true,
+        sdf::ParserConfig(), errors));
+  EXPECT_TRUE(errors.empty());
+
+  sdf::SDFPtr streamed(new sdf::SDF());
+  ASSERT_TRUE(sdf::init(streamed));
+  ASSERT_TRUE(sdf::readString(stream.str(), streamed, errors));
+  EXPECT_TRUE(errors.empty());
+  EXPECT_TRUE(
+      sdf::diffElements(expected->Root(), streamed->Root()).empty());
+
+  // Without expanding includes, the XML is only converted.
+  const std::string includesPath = sdf::filesystem::append(
+      PROJECT_SOURCE_PATH, "test", "sdf", "includes.sdf");
+  stream.str("");
+  EXPECT_TRUE(sdf::printFileStreaming(includesPath, stream, false,
+        sdf::ParserConfig(), errors));
+  EXPECT_TRUE(errors.empty());
+  const std::string output = stream.str();
+  EXPECT_EQ(0u, output.find("<sdf version='" + sdf::SDF::Version() + "'>"));
+  EXPECT_NE(std::string::npos, output.find("<uri>test_model</uri>"));
+  std::size_t includeCount = 0;
+  for (std::size_t pos = output.find("<include>"); pos != std::string::npos;
+       pos = output.find("<include>", pos + 1))
+  {
+    ++includeCount;
+  }
+  EXPECT_EQ(6u, includeCount);
+  EXPECT_EQ(std::string::npos, output.find("<physics"));
+
+  // A truncated document is reported.
+  const std::string truncatedPath = sdf::filesystem::append(
+      PROJECT_BINARY_DIR, "test", "truncated.sdf");
+  {
+    std::ofstream truncated(truncatedPath);
+    truncated << "<sdf version='1.8'><world name='w'><model name='m'>";
+  }
+  stream.str("");
+  errors.clear();
+  EXPECT_FALSE(sdf::printFileStreaming(truncatedPath, stream, true,
+        sdf::ParserConfig(), errors));
+  EXPECT_FALSE(errors.empty());
+}
+
 /////////////////////////////////////////////////
 /////////////////////////////////////////////////
 /// Main
@@ -21,6 +21,7 @@
 
 #include <string>
 
+#include "sdf/ParserConfig.hh"
 #include "sdf/SDFImpl.hh"
 #include "sdf/sdf_config.h"
 #include "sdf/system_util.hh"
@@ -51,19 +52,32 @@ namespace sdf
   static bool initXml(TiXmlElement *_xml, ElementPtr _sdf);
 
   /// \brief Populate the SDF values from a TinyXML document
+  /// \param[in] _releaseXml True to remove each XML element from the
+  /// document once it has been read, so that the document and the element
+  /// tree are not held in memory at the same time. The document must not be
+  /// used after reading it in that case. See readXml.
   static bool readDoc(TiXmlDocument *_xmlDoc, SDFPtr _sdf,
                       const std::string &_source, bool _convert,
-                      Errors &_errors);
+                      const ParserConfig &_config, Errors &_errors,
+                      bool _releaseXml = false);
 
   static bool readDoc(TiXmlDocument *_xmlDoc, ElementPtr _sdf,
-      const std::string &_source, bool _convert, Errors &_errors);
+      const std::string &_source, bool _convert, const ParserConfig &_config,
+      Errors &_errors, bool _releaseXml = false);
 
   /// \brief For internal use only. Do not use this function.
   /// \param[in] _xml Pointer to the XML document
   /// \param[in,out] _sdf SDF pointer to parse data into.
+  /// \param[in] _config Custom parser configuration
   /// \param[out] _errors Captures errors found during parsing.
+  /// \param[in] _releaseXml True to remove each child element of _xml that
+  /// matches an element description once it has been read. Included models
+  /// and unknown elements, which are copied after the other children, are
+  /// kept.
   /// \return True on success, false on error.
-  static bool readXml(TiXmlElement *_xml, ElementPtr _sdf, Errors &_errors);
+  static bool readXml(TiXmlElement *_xml, ElementPtr _sdf,
+                      const ParserConfig &_config, Errors &_errors,
+                      bool _releaseXml = false);
 
   /// \brief Copy child XML elements into the _sdf element.
   /// \param[in] _sdf Parent Element.
@@ -71,8 +85,11 @@ namespace sdf
   /// copied.
   /// \param[in] _onlyUnknown True to copy only elements that are NOT part of
   /// the SDF spec. Set this to false to copy everything.
+  /// \param[in] _defer True to keep the child elements of the copied
+  /// elements that are not part of the SDF spec as XML text until they are
+  /// accessed. See ParserConfig::SetDeferCopiedElements.
   static void copyChildren(ElementPtr _sdf, TiXmlElement *_xml,
-                    const bool _onlyUnknown);
+                    const bool _onlyUnknown, const bool _defer = false);
   }
 }
 #endif
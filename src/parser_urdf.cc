@@ -16,12 +16,19 @@
  */
 
 #include <algorithm>
+#include <cctype>
+#include <charconv>
 #include <fstream>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <set>
 #include <sstream>
+#include <stdexcept>
 #include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -34,6 +41,7 @@
 #include "sdf/sdf.hh"
 
 #include "SDFExtension.hh"
+#include "Utils.hh"
 #include "parser_urdf.hh"
 
 using namespace sdf;
@@ -45,19 +53,259 @@ typedef std::shared_ptr<SDFExtension> SDFExtensionPtr;
 typedef std::map<std::string, std::vector<SDFExtensionPtr> >
   StringSDFExtensionPtrMap;
 
-/// create SDF geometry block based on URDF
-StringSDFExtensionPtrMap g_extensions;
-bool g_reduceFixedJoints;
-bool g_enforceLimits;
-std::string g_collisionExt = "_collision";
-std::string g_visualExt = "_visual";
-std::string g_lumpPrefix = "_fixed_joint_lump__";
-urdf::Pose g_initialRobotPose;
-bool g_initialRobotPoseValid = false;
-std::set<std::string> g_fixedJointsTransformedInRevoluteJoints;
-std::set<std::string> g_fixedJointsTransformedInFixedJoints;
+/// \brief Copy an extension with its blobs, which conversions change.
+/// \param[in] _extension The extension.
+/// \return The copy.
+static SDFExtensionPtr copyExtension(const SDFExtension &_extension)
+{
+  auto copy = std::make_shared<SDFExtension>(_extension);
+  for (auto *blobs : {&copy->visual_blobs, &copy->collision_blobs,
+                      &copy->blobs})
+  {
+    for (auto &blob : *blobs)
+      blob = std::make_shared<TiXmlElement>(*blob);
+  }
+  return copy;
+}
+
+/// \brief Extensions parsed from <gazebo> blocks, shared by the
+/// conversions of URDF2SDF::InitModels so that a block that several robots
+/// have is parsed once.
+class SDFExtensionCache
+{
+  /// \brief Get a copy of the extension parsed from a block.
+  /// \param[in] _block The block, printed with its attributes.
+  /// \return The copy, or nullptr if the block was not parsed before.
+  public: SDFExtensionPtr Find(const std::string &_block) const
+  {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    auto iter = this->extensions.find(_block);
+    if (iter == this->extensions.end())
+      return nullptr;
+    return copyExtension(*iter->second);
+  }
+
+  /// \brief Store the extension parsed from a block, before it is changed
+  /// by its conversion.
+  /// \param[in] _block The block, printed with its attributes.
+  /// \param[in] _extension The extension, which is copied.
+  public: void Insert(const std::string &_block,
+                      const SDFExtension &_extension)
+  {
+    SDFExtensionPtr copy = copyExtension(_extension);
+    std::lock_guard<std::mutex> lock(this->mutex);
+    this->extensions.emplace(_block, std::move(copy));
+  }
+
+  /// \brief Guards extensions.
+  private: mutable std::mutex mutex;
+
+  /// \brief The extensions, by printed block.
+  private: std::unordered_map<std::string, SDFExtensionPtr> extensions;
+};
+
+/// \brief State of a conversion, owned by a URDF2SDF instance so that
+/// several instances can convert robots concurrently.
+class URDF2SDFPrivate
+{
+  /// \brief Extensions shared with the other conversions of a batch, or
+  /// nullptr.
+  public: std::shared_ptr<SDFExtensionCache> extensionCache;
+
+  /// \brief Extensions of the <gazebo> blocks, by reference.
+  public: StringSDFExtensionPtrMap extensions;
+
+  /// \brief Whether fixed joints are reduced.
+  public: bool reduceFixedJoints = true;
+
+  /// \brief Whether joint limits are enforced.
+  public: bool enforceLimits = true;
+
+  /// \brief Pose of the robot, from its <origin>.
+  public: urdf::Pose initialRobotPose;
+
+  /// \brief Whether initialRobotPose is set.
+  public: bool initialRobotPoseValid = false;
+
+  /// \brief Fixed joints converted to revolute joints.
+  public: std::set<std::string> fixedJointsTransformedInRevoluteJoints;
+
+  /// \brief Fixed joints that are preserved.
+  public: std::set<std::string> fixedJointsTransformedInFixedJoints;
+};
+
+/// \brief The state of the conversion running on this thread, used by the
+/// conversion functions below. It is set by ScopedConversion in the member
+/// functions of URDF2SDF.
+thread_local URDF2SDFPrivate *g_conversion = nullptr;
+
+/// \brief Sets g_conversion to the state of a URDF2SDF instance while it
+/// exists.
+class ScopedConversion
+{
+  /// \brief Constructor.
+  /// \param[in] _state The state of the conversion.
+  public: explicit ScopedConversion(URDF2SDFPrivate *_state)
+    : previous(g_conversion)
+  {
+    g_conversion = _state;
+  }
+
+  /// \brief Destructor. Restores the previous state.
+  public: ~ScopedConversion()
+  {
+    g_conversion = this->previous;
+  }
+
+  /// \brief The state set before this object.
+  private: URDF2SDFPrivate *previous;
+};
+
+const std::string g_collisionExt = "_collision";
+const std::string g_visualExt = "_visual";
+const std::string g_lumpPrefix = "_fixed_joint_lump__";
 const int g_outputDecimalPrecision = 16;
 
+/////////////////////////////////////////////////
+/// \brief Parse a number at the start of a text like std::stod and
+/// std::stoi do, with std::from_chars instead of the locale dependent C
+/// functions and without copying the text: leading whitespace and a '+'
+/// are skipped, and parsing stops at the first character that is not part
+/// of the number.
+/// \param[in] _str The text.
+/// \return The number.
+/// \throws std::invalid_argument if the text doesn't start with a number.
+/// \throws std::out_of_range if the number is out of the range of T.
+template <typename T>
+T parseNumber(std::string_view _str)
+{
+  const char *first = _str.data();
+  const char *last = first + _str.size();
+  while (first != last && std::isspace(static_cast<unsigned char>(*first)))
+    ++first;
+  if (first != last && *first == '+')
+  {
+    ++first;
+    if (first != last && *first == '-')
+      throw std::invalid_argument("parseNumber");
+  }
+
+  T value{};
+#ifndef __cpp_lib_to_chars
+  if constexpr (std::is_floating_point_v<T>)
+  {
+    return std::stod(std::string(first, last));
+  }
+  else
+#endif
+  {
+    const std::from_chars_result result = std::from_chars(first, last, value);
+    if (result.ec == std::errc::invalid_argument)
+      throw std::invalid_argument("parseNumber");
+    if (result.ec == std::errc::result_out_of_range)
+      throw std::out_of_range("parseNumber");
+  }
+  return value;
+}
+
+/////////////////////////////////////////////////
+/// \brief Append a number to a string as std::ostream writes it with its
+/// default flags, with std::to_chars.
+/// \param[in,out] _out String to append the number to.
+/// \param[in] _value The number.
+/// \param[in] _precision Precision of floating point numbers.
+template <typename T>
+void appendNumber(std::string &_out, const T _value, const int _precision)
+{
+  char buffer[32];
+  std::to_chars_result result;
+  if constexpr (std::is_floating_point_v<T>)
+  {
+#ifdef __cpp_lib_to_chars
+    // General formatting with a precision matches "%.*g", which is what
+    // streams use by default.
+    result = std::to_chars(buffer, buffer + sizeof(buffer), _value,
+        std::chars_format::general, _precision);
+#else
+    std::ostringstream stream;
+    stream.precision(_precision);
+    stream << _value;
+    _out += stream.str();
+    return;
+#endif
+  }
+  else
+  {
+    result = std::to_chars(buffer, buffer + sizeof(buffer), _value);
+  }
+  _out.append(buffer, result.ptr);
+}
+
+/////////////////////////////////////////////////
+/// \brief Index of the child elements of an XML element by name. It is
+/// kept up to date while the extensions of a link, joint or model are
+/// merged into its element, so that finding or replacing a child doesn't
+/// scan all the children merged before it.
+class ChildIndex
+{
+  /// \brief Constructor, which indexes the current children.
+  /// \param[in] _elem The element. Its children must only be added and
+  /// removed through the index while the index is used.
+  public: explicit ChildIndex(TiXmlElement *_elem)
+    : elem(_elem)
+  {
+    for (TiXmlElement *child = _elem->FirstChildElement(); child != nullptr;
+         child = child->NextSiblingElement())
+    {
+      this->children[child->ValueStr()].push_back(child);
+    }
+  }
+
+  /// \brief Get the first child with a name.
+  /// \param[in] _name Name of the child.
+  /// \return The child, or nullptr if there is none.
+  public: TiXmlElement *First(const std::string &_name) const
+  {
+    auto iter = this->children.find(_name);
+    return iter == this->children.end() || iter->second.empty() ?
+        nullptr : iter->second.front();
+  }
+
+  /// \brief Append a child to the element.
+  /// \param[in] _child The child, which the element takes ownership of.
+  /// \return The child, or nullptr if it isn't an element.
+  public: TiXmlElement *Append(TiXmlNode *_child)
+  {
+    TiXmlElement *child = this->elem->LinkEndChild(_child)->ToElement();
+    if (child != nullptr)
+    {
+      this->children[child->ValueStr()].push_back(child);
+    }
+    return child;
+  }
+
+  /// \brief Remove and delete a child of the element.
+  /// \param[in] _child The child.
+  public: void Remove(TiXmlElement *_child)
+  {
+    auto iter = this->children.find(_child->ValueStr());
+    if (iter != this->children.end())
+    {
+      std::vector<TiXmlElement *> &named = iter->second;
+      named.erase(std::remove(named.begin(), named.end(), _child),
+                  named.end());
+    }
+    this->elem->RemoveChild(_child);
+  }
+
+  /// \brief The indexed element.
+  private: TiXmlElement *elem;
+
+  /// \brief Children of the element by name, in document order.
+  private: std::unordered_map<std::string, std::vector<TiXmlElement *>>
+           children;
+};
+
 
 /// \brief parser xml string into urdf::Vector3
 /// \param[in] _key XML key where vector3 value might be
@@ -104,14 +352,21 @@ void ReduceSDFExtensionProjectorTransformReduction(
 ///   when doing fixed joint reduction
 void ReduceSDFExtensionsTransform(SDFExtensionPtr _ge);
 
-/// reduce fixed joints:  lump joints to parent link
-void ReduceJointsToParent(urdf::LinkSharedPtr _link);
+/// reduce fixed joints:  lump joints to the link that _link is lumped into
+void ReduceJointsToParent(urdf::LinkSharedPtr _link,
+                          urdf::LinkSharedPtr _target,
+                          const ignition::math::Pose3d &_linkToTarget);
 
-/// reduce fixed joints:  lump collisions to parent link
-void ReduceCollisionsToParent(urdf::LinkSharedPtr _link);
+/// reduce fixed joints:  lump collisions to the link that _link is lumped
+///   into
+void ReduceCollisionsToParent(urdf::LinkSharedPtr _link,
+                              urdf::LinkSharedPtr _target,
+                              const ignition::math::Pose3d &_linkToTarget);
 
-/// reduce fixed joints:  lump visuals to parent link
-void ReduceVisualsToParent(urdf::LinkSharedPtr _link);
+/// reduce fixed joints:  lump visuals to the link that _link is lumped into
+void ReduceVisualsToParent(urdf::LinkSharedPtr _link,
+                           urdf::LinkSharedPtr _target,
+                           const ignition::math::Pose3d &_linkToTarget);
 
 /// reduce fixed joints:  lump inertial to parent link
 void ReduceInertialToParent(urdf::LinkSharedPtr /*_link*/);
@@ -133,11 +388,15 @@ void CreateJoint(TiXmlElement *_root, urdf::LinkConstSharedPtr _link,
 /// insert extensions into links
 void InsertSDFExtensionLink(TiXmlElement *_elem, const std::string &_linkName);
 
-/// create visual blocks from urdf visuals
-void CreateVisuals(TiXmlElement* _elem, urdf::LinkConstSharedPtr _link);
+/// create visual blocks from urdf visuals, in a TiXmlElement * or an
+/// ElementPtr
+template <typename ElemT>
+void CreateVisuals(ElemT _elem, urdf::LinkConstSharedPtr _link);
 
-/// create collision blocks from urdf collisions
-void CreateCollisions(TiXmlElement* _elem, urdf::LinkConstSharedPtr _link);
+/// create collision blocks from urdf collisions, in a TiXmlElement * or an
+/// ElementPtr
+template <typename ElemT>
+void CreateCollisions(ElemT _elem, urdf::LinkConstSharedPtr _link);
 
 /// create SDF Inertial block based on URDF
 void CreateInertial(TiXmlElement *_elem, urdf::LinkConstSharedPtr _link);
@@ -146,8 +405,9 @@ void CreateInertial(TiXmlElement *_elem, urdf::LinkConstSharedPtr _link);
 void AddTransform(TiXmlElement *_elem,
     const ignition::math::Pose3d &_transform);
 
-/// create SDF from URDF link
-void CreateSDF(TiXmlElement *_root, urdf::LinkConstSharedPtr _link,
+/// create SDF from URDF link, in a TiXmlElement * or an ElementPtr
+template <typename ElemT>
+void CreateSDF(ElemT _root, urdf::LinkConstSharedPtr _link,
                const ignition::math::Pose3d &_transform);
 
 /// create SDF Link block based on URDF
@@ -187,21 +447,36 @@ void ReduceSDFExtensionContactSensorFrameReplace(
     urdf::LinkSharedPtr _link);
 
 /// \brief reduced fixed joints:  apply appropriate updates to urdf
-///   extensions when doing fixed joint reduction
+///   extensions once the fixed joints are reduced
 ///
-/// Take the link's existing list of gazebo extensions, transfer them
-/// into parent link.  Along the way, update local transforms by adding
-/// the additional transform to parent.  Also, look through all
-/// referenced link names with plugins and update references to current
-/// link to the parent link. (ReduceSDFExtensionFrameReplace())
+/// Take the existing list of gazebo extensions of each reduced link and
+/// transfer them into the link it is lumped into.  Along the way, update
+/// local transforms by composing the transforms of the reduced joints.
+/// Also, look through all referenced link names with plugins and update
+/// references to reduced links to the links they are lumped into.
+/// (ReduceSDFExtensionFrameReplace())
 ///
-/// \param[in] _link pointer to urdf link, its extensions will be reduced
-void ReduceSDFExtensionToParent(urdf::LinkSharedPtr _link);
+/// The surviving link and the composed transforms are computed once per
+/// reference, and each blob is rewritten in a single pass, instead of
+/// rewriting the blobs of all the extensions at each reduction.
+///
+/// \param[in] _reducedLinks the reduced links, in the order they were
+/// reduced, which is children before their parents
+void ReduceSDFExtensionsToParents(
+    const std::vector<urdf::LinkSharedPtr> &_reducedLinks);
+
+/// \brief get the names of the links that a blob of an extension refers
+/// to, which are the ones that ReduceSDFExtensionFrameReplace updates
+/// \param[in] _blob the blob
+/// \return the names of the links
+std::vector<std::string> ReferencedLinkNames(TiXmlElement *_blob);
 
 /// reduced fixed joints:  apply appropriate frame updates
-///   in urdf extensions when doing fixed joint reduction
-void ReduceSDFExtensionFrameReplace(SDFExtensionPtr _ge,
-    urdf::LinkSharedPtr _link);
+///   in a blob of urdf extensions for the reduction of a link
+void ReduceSDFExtensionFrameReplace(
+    std::vector<TiXmlElementPtr>::iterator _blobIt,
+    urdf::LinkSharedPtr _link,
+    const ignition::math::Pose3d &_reductionTransform);
 
 /// get value from <key value="..."/> pair and return it as string
 std::string GetKeyValueAsString(TiXmlElement* _elem);
@@ -213,6 +488,25 @@ std::string GetKeyValueAsString(TiXmlElement* _elem);
 void AddKeyValue(TiXmlElement *_elem, const std::string &_key,
                  const std::string &_value);
 
+/// \brief append key value pair to the end of an xml element, replacing
+/// the previous value of the key, like AddKeyValue, with an index of the
+/// children of the element
+/// \param[in] _children index of the children of the xml element
+/// \param[in] _key string containing key to add to xml element
+/// \param[in] _value string containing value for the key added
+void AddKeyValue(ChildIndex &_children, const std::string &_key,
+                 const std::string &_value);
+
+/// \brief create the element of a key value pair for AddKeyValue, and
+/// report the value it replaces
+/// \param[in] _oldElem element of the previous value of the key, or
+/// nullptr if there is none
+/// \param[in] _key string containing key
+/// \param[in] _value string containing value for the key
+/// \return the new element
+TiXmlElement *NewKeyValue(TiXmlElement *_oldElem, const std::string &_key,
+                          const std::string &_value);
+
 /// \brief convert values to string
 /// \param[in] _count number of values in _values array
 /// \param[in] _values array of double values
@@ -221,6 +515,72 @@ std::string Values2str(unsigned int _count, const double *_values);
 
 void CreateGeometry(TiXmlElement *_elem, urdf::GeometrySharedPtr _geometry);
 
+/// \brief Get the name of a collision or visual of a link, which includes
+/// the name of the link it was lumped from.
+/// \param[in] _link The link.
+/// \param[in] _name Name of the collision or visual.
+/// \return The name of the SDFormat collision or visual.
+std::string LumpedName(urdf::LinkConstSharedPtr _link,
+                       const std::string &_name);
+
+/// \brief Get the SDFormat uri of a URDF mesh file name.
+/// \param[in] _filename The file name.
+/// \return The uri, where package:// is replaced by model://.
+std::string MeshUri(const std::string &_filename);
+
+/// \brief Get the SDFormat type of the joint of a link.
+/// \param[in] _link The link.
+/// \param[out] _fixedToRevolute True if it is a fixed joint converted to
+/// a revolute joint, because of the legacy disableFixedJointLumping option.
+/// \return The type, or an empty string if the joint is not converted.
+std::string JointType(urdf::LinkConstSharedPtr _link,
+                      bool &_fixedToRevolute);
+
+/// \brief Add a child element with a value to an element.
+/// \param[in] _elem The parent element.
+/// \param[in] _key Name of the child.
+/// \param[in] _value Value of the child.
+template <typename T>
+void AddKeyValue(ElementPtr _elem, const std::string &_key, const T &_value);
+
+/// \brief Add a child element to an element, like readXml does when it
+/// reads an XML element.
+/// \param[in] _parent The parent element.
+/// \param[in] _name Name of the child.
+/// \return The child, without its required children.
+ElementPtr AddChildElement(ElementPtr _parent, const std::string &_name);
+
+/// \brief Add the missing required elements of an element tree with
+/// default values, like readXml does after reading an XML element.
+/// \param[in] _elem Root of the element tree.
+void AddRequiredElements(ElementPtr _elem);
+
+/// create SDF Collision element based on URDF
+void CreateCollision(ElementPtr _elem, urdf::LinkConstSharedPtr _link,
+                     urdf::CollisionSharedPtr _collision,
+                     const std::string &_oldLinkName);
+
+/// create SDF Visual element based on URDF
+void CreateVisual(ElementPtr _elem, urdf::LinkConstSharedPtr _link,
+                  urdf::VisualSharedPtr _visual,
+                  const std::string &_oldLinkName);
+
+/// create SDF Joint element based on URDF
+void CreateJoint(ElementPtr _model, urdf::LinkConstSharedPtr _link);
+
+/// create SDF Inertial element based on URDF
+void CreateInertial(ElementPtr _elem, urdf::LinkConstSharedPtr _link);
+
+/// create SDF Link element based on URDF
+void CreateLink(ElementPtr _model, urdf::LinkConstSharedPtr _link,
+                ignition::math::Pose3d &_currentTransform);
+
+/// create SDF Geometry element based on URDF
+void CreateGeometry(ElementPtr _elem, urdf::GeometrySharedPtr _geometry);
+
+/// insert the robot origin into the model element
+void InsertRobotOrigin(ElementPtr _elem);
+
 ignition::math::Pose3d inverseTransformToParentFrame(
     ignition::math::Pose3d _transformInLinkFrame,
     urdf::Pose _parentToLinkTransform);
@@ -251,44 +611,59 @@ urdf::Pose CopyPose(ignition::math::Pose3d _pose);
 bool URDF2SDF::IsURDF(const std::string &_filename)
 {
   TiXmlDocument xmlDoc;
+  return xmlDoc.LoadFile(_filename) && IsURDF(&xmlDoc);
+}
 
-  if (xmlDoc.LoadFile(_filename))
-  {
-    std::ostringstream stream;
-    stream << xmlDoc;
-    std::string urdfStr = stream.str();
-    urdf::ModelInterfaceSharedPtr robotModel = urdf::parseURDF(urdfStr);
-    return robotModel != nullptr;
-  }
+////////////////////////////////////////////////////////////////////////////////
+bool URDF2SDF::IsURDF(const TiXmlDocument *_xmlDoc)
+{
+  if (!_xmlDoc)
+    return false;
 
-  return false;
+  const TiXmlElement *robot = _xmlDoc->RootElement();
+  return robot != nullptr && robot->ValueStr() == "robot";
 }
 
 /////////////////////////////////////////////////
 urdf::Vector3 ParseVector3(const std::string &_str, double _scale)
 {
-  std::vector<std::string> pieces = sdf::split(_str, " ");
-  std::vector<double> vals;
-
-  for (unsigned int i = 0; i < pieces.size(); ++i)
+  double vals[3];
+  std::size_t count = 0;
+
+  // The pieces between spaces are parsed in place instead of being split
+  // into strings.
+  const std::string_view str(_str);
+  std::size_t pos = 0;
+  for (unsigned int i = 0; pos <= str.size(); ++i)
   {
-    if (pieces[i] != "")
+    std::size_t end = str.find(' ', pos);
+    if (end == std::string_view::npos)
+      end = str.size();
+    const std::string_view piece = str.substr(pos, end - pos);
+    pos = end + 1;
+
+    if (piece.empty())
+      continue;
+
+    double value;
+    try
     {
-      try
-      {
-        vals.push_back(_scale * std::stod(pieces[i]));
-      }
-      catch(std::invalid_argument &)
-      {
-        sdferr << "xml key [" << _str
-               << "][" << i << "] value [" << pieces[i]
-               << "] is not a valid double from a 3-tuple\n";
-        return urdf::Vector3(0, 0, 0);
-      }
+      value = _scale * parseNumber<double>(piece);
+    }
+    catch(std::invalid_argument &)
+    {
+      sdferr << "xml key [" << _str
+             << "][" << i << "] value [" << piece
+             << "] is not a valid double from a 3-tuple\n";
+      return urdf::Vector3(0, 0, 0);
     }
+
+    if (count < 3)
+      vals[count] = value;
+    ++count;
   }
 
-  if (vals.size() == 3)
+  if (count == 3)
   {
     return urdf::Vector3(vals[0], vals[1], vals[2]);
   }
@@ -324,13 +699,14 @@ urdf::Vector3 ParseVector3(TiXmlNode *_key, double _scale)
 /// \return a string
 std::string Vector32Str(const urdf::Vector3 _vector)
 {
-  std::stringstream ss;
-  ss << _vector.x;
-  ss << " ";
-  ss << _vector.y;
-  ss << " ";
-  ss << _vector.z;
-  return ss.str();
+  // Streams have a default precision of 6.
+  std::string result;
+  appendNumber(result, _vector.x, 6);
+  result += ' ';
+  appendNumber(result, _vector.y, 6);
+  result += ' ';
+  appendNumber(result, _vector.z, 6);
+  return result;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -345,25 +721,10 @@ void ReduceCollisionToParent(urdf::LinkSharedPtr _parentLink,
                              const std::string &_name,
                              urdf::CollisionSharedPtr _collision)
 {
-  // added a check to see if _collision already exist in
-  // _parentLink::collision_array if not, add it.
+  // Each collision is moved once, directly to the link it is lumped into,
+  // so it cannot already be in _parentLink::collision_array.
   _collision->name = _name;
-  std::vector<urdf::CollisionSharedPtr>::iterator collisionIt =
-    find(_parentLink->collision_array.begin(),
-         _parentLink->collision_array.end(),
-         _collision);
-  if (collisionIt != _parentLink->collision_array.end())
-  {
-    sdfwarn << "attempted to add collision [" << _collision->name
-            << "] to link ["
-            << _parentLink->name
-            << "], but it already exists in collision_array under name ["
-            << (*collisionIt)->name << "]\n";
-  }
-  else
-  {
-    _parentLink->collision_array.push_back(_collision);
-  }
+  _parentLink->collision_array.push_back(_collision);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -378,68 +739,119 @@ void ReduceVisualToParent(urdf::LinkSharedPtr _parentLink,
                           const std::string &_name,
                           urdf::VisualSharedPtr _visual)
 {
-  // added a check to see if _visual already exist in
-  // _parentLink::visual_array if not, add it.
+  // Each visual is moved once, directly to the link it is lumped into,
+  // so it cannot already be in _parentLink::visual_array.
   _visual->name = _name;
-  std::vector<urdf::VisualSharedPtr>::iterator visualIt =
-    find(_parentLink->visual_array.begin(),
-         _parentLink->visual_array.end(),
-         _visual);
-  if (visualIt != _parentLink->visual_array.end())
-  {
-    sdfwarn << "attempted to add visual [" << _visual->name
-            << "] to link ["
-            << _parentLink->name
-            << "], but it already exists in visual_array under name ["
-            << (*visualIt)->name << "]\n";
-  }
-  else
-  {
-    _parentLink->visual_array.push_back(_visual);
-  }
+  _parentLink->visual_array.push_back(_visual);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 /// reduce fixed joints by lumping inertial, visual and
 // collision elements of the child link into the parent link
-void ReduceFixedJoints(TiXmlElement *_root, urdf::LinkSharedPtr _link)
+void ReduceFixedJoints(TiXmlElement * /*_root*/, urdf::LinkSharedPtr _link)
 {
-  // if child is attached to self by fixed _link first go up the tree,
-  //   check it's children recursively
-  for (unsigned int i = 0 ; i < _link->child_links.size() ; ++i)
+  // A link of the tree that is being reduced.
+  struct LinkReduction
+  {
+    /// The link.
+    urdf::LinkSharedPtr link;
+
+    /// The link that this link is lumped into, which is the first ancestor
+    /// that is not reduced. Null if this link is not reduced.
+    urdf::LinkSharedPtr target;
+
+    /// Pose of this link in the frame of target.
+    ignition::math::Pose3d linkToTarget;
+
+    /// Next child to visit. Children connected by reduced fixed joints are
+    /// visited first, as indices [0, n), then the other children as
+    /// indices [n, 2n).
+    size_t next = 0;
+  };
+
+  // Visit a link. Visuals, collisions and child joints are moved directly
+  // to the link that it is lumped into, in the order of a depth first
+  // traversal, instead of moving them one level at a time.
+  std::vector<LinkReduction> stack;
+  std::vector<urdf::LinkSharedPtr> reducedLinks;
+  auto visit = [&stack](urdf::LinkSharedPtr _child)
   {
-    if (FixedJointShouldBeReduced(_link->child_links[i]->parent_joint))
+    LinkReduction frame;
+    frame.link = _child;
+
+    // reduce this _link's stuff up the tree to parent but skip first joint
+    //   if it's the world
+    if (!stack.empty() && _child->getParent() &&
+        _child->getParent()->name != "world" && _child->parent_joint &&
+        FixedJointShouldBeReduced(_child->parent_joint))
     {
-      ReduceFixedJoints(_root, _link->child_links[i]);
+      const LinkReduction &parent = stack.back();
+      const ignition::math::Pose3d jointPose =
+          CopyPose(_child->parent_joint->parent_to_joint_origin_transform);
+      if (parent.target)
+      {
+        frame.target = parent.target;
+        frame.linkToTarget =
+            TransformToParentFrame(jointPose, parent.linkToTarget);
+      }
+      else
+      {
+        frame.target = parent.link;
+        frame.linkToTarget = jointPose;
+      }
+
+      sdfdbg << "Fixed Joint Reduction: lumping [" << _child->name
+             << "] to [" << frame.target->name << "]\n";
+      ReduceVisualsToParent(_child, frame.target, frame.linkToTarget);
+      ReduceCollisionsToParent(_child, frame.target, frame.linkToTarget);
+      ReduceJointsToParent(_child, frame.target, frame.linkToTarget);
     }
-  }
+    stack.push_back(frame);
+  };
 
-  // reduce this _link's stuff up the tree to parent but skip first joint
-  //   if it's the world
-  if (_link->getParent() && _link->getParent()->name != "world" &&
-      _link->parent_joint && FixedJointShouldBeReduced(_link->parent_joint) )
+  visit(_link);
+  while (!stack.empty())
   {
-    sdfdbg << "Fixed Joint Reduction: extension lumping from ["
-           << _link->name << "] to [" << _link->getParent()->name << "]\n";
+    LinkReduction &frame = stack.back();
+    const urdf::LinkSharedPtr link = frame.link;
+    const size_t childCount = link->child_links.size();
+
+    // After the children connected by reduced fixed joints, lump the
+    // inertial of this link, which includes the ones of those children, to
+    // the parent link. The extensions are lumped once all the links are
+    // reduced.
+    if (frame.next == childCount && frame.target)
+    {
+      sdfdbg << "Fixed Joint Reduction: extension lumping from ["
+             << link->name << "] to [" << link->getParent()->name << "]\n";
+      reducedLinks.push_back(link);
 
-    // lump sdf extensions to parent, (give them new reference _link names)
-    ReduceSDFExtensionToParent(_link);
+      // reduce _link inertial to parent
+      ReduceInertialToParent(link);
+    }
 
-    // reduce _link elements to parent
-    ReduceInertialToParent(_link);
-    ReduceVisualsToParent(_link);
-    ReduceCollisionsToParent(_link);
-    ReduceJointsToParent(_link);
-  }
+    if (frame.next >= 2 * childCount)
+    {
+      stack.pop_back();
+      continue;
+    }
 
-  // continue down the tree for non-fixed joints
-  for (unsigned int i = 0 ; i < _link->child_links.size() ; ++i)
-  {
-    if (!FixedJointShouldBeReduced(_link->child_links[i]->parent_joint))
+    const bool reducedPass = frame.next < childCount;
+    const urdf::LinkSharedPtr child =
+        link->child_links[frame.next % childCount];
+    ++frame.next;
+
+    // if child is attached to self by fixed _link first go up the tree,
+    //   check it's children, then continue down the tree for non-fixed
+    //   joints
+    if (FixedJointShouldBeReduced(child->parent_joint) == reducedPass)
     {
-      ReduceFixedJoints(_root, _link->child_links[i]);
+      visit(child);
     }
   }
+
+  // lump sdf extensions to parents, (give them new reference _link names)
+  ReduceSDFExtensionsToParents(reducedLinks);
 }
 
 // ODE dMatrix
@@ -907,7 +1319,9 @@ void ReduceInertialToParent(urdf::LinkSharedPtr _link)
 /// \brief reduce fixed joints:  lump visuals to parent link
 /// \param[in] _link take all visuals from _link and lump/move them
 ///            to the parent link (_link->getParentLink()).
-void ReduceVisualsToParent(urdf::LinkSharedPtr _link)
+void ReduceVisualsToParent(urdf::LinkSharedPtr _link,
+                           urdf::LinkSharedPtr _target,
+                           const ignition::math::Pose3d &_linkToTarget)
 {
   // lump all visuals of _link to _link->getParent().
   // modify visual name (urdf 0.3.x) or
@@ -952,14 +1366,12 @@ void ReduceVisualsToParent(urdf::LinkSharedPtr _link)
     }
 
     // transform visual origin from _link frame to
-    // parent link frame before adding to parent
-    (*visualIt)->origin = TransformToParentFrame(
-        (*visualIt)->origin,
-        _link->parent_joint->parent_to_joint_origin_transform);
+    // target link frame before adding to target
+    (*visualIt)->origin = CopyPose(TransformToParentFrame(
+        CopyPose((*visualIt)->origin), _linkToTarget));
 
-    // add the modified visual to parent
-    ReduceVisualToParent(_link->getParent(), newVisualName,
-                         *visualIt);
+    // add the modified visual to target
+    ReduceVisualToParent(_target, newVisualName, *visualIt);
   }
 }
 
@@ -967,7 +1379,9 @@ void ReduceVisualsToParent(urdf::LinkSharedPtr _link)
 /// \brief reduce fixed joints:  lump collisions to parent link
 /// \param[in] _link take all collisions from _link and lump/move them
 ///            to the parent link (_link->getParentLink()).
-void ReduceCollisionsToParent(urdf::LinkSharedPtr _link)
+void ReduceCollisionsToParent(urdf::LinkSharedPtr _link,
+                              urdf::LinkSharedPtr _target,
+                              const ignition::math::Pose3d &_linkToTarget)
 {
   // lump all collisions of _link to _link->getParent().
   // modify collision name (urdf 0.3.x) or
@@ -1010,48 +1424,34 @@ void ReduceCollisionsToParent(urdf::LinkSharedPtr _link)
              << "] with name [" << newCollisionName << "]\n";
     }
     // transform collision origin from _link frame to
-    // parent link frame before adding to parent
-    (*collisionIt)->origin = TransformToParentFrame(
-        (*collisionIt)->origin,
-        _link->parent_joint->parent_to_joint_origin_transform);
+    // target link frame before adding to target
+    (*collisionIt)->origin = CopyPose(TransformToParentFrame(
+        CopyPose((*collisionIt)->origin), _linkToTarget));
 
-    // add the modified collision to parent
-    ReduceCollisionToParent(_link->getParent(), newCollisionName,
-                            *collisionIt);
+    // add the modified collision to target
+    ReduceCollisionToParent(_target, newCollisionName, *collisionIt);
   }
 }
 
 /////////////////////////////////////////////////
-/// reduce fixed joints:  lump joints to parent link
-void ReduceJointsToParent(urdf::LinkSharedPtr _link)
+/// reduce fixed joints:  lump joints to the link that _link is lumped into
+void ReduceJointsToParent(urdf::LinkSharedPtr _link,
+                          urdf::LinkSharedPtr _target,
+                          const ignition::math::Pose3d &_linkToTarget)
 {
   // set child link's parentJoint's parent link to
-  // a parent link up stream that does not have a fixed parentJoint
+  // the link up stream that does not have a fixed parentJoint
   for (unsigned int i = 0 ; i < _link->child_links.size() ; ++i)
   {
     urdf::JointSharedPtr parentJoint = _link->child_links[i]->parent_joint;
     if (!FixedJointShouldBeReduced(parentJoint))
     {
-      // go down the tree until we hit a parent joint that is not fixed
-      urdf::LinkSharedPtr newParentLink = _link;
-      ignition::math::Pose3d jointAnchorTransform;
-      while (newParentLink->parent_joint &&
-             newParentLink->getParent()->name != "world" &&
-             FixedJointShouldBeReduced(newParentLink->parent_joint) )
-      {
-        jointAnchorTransform = jointAnchorTransform * jointAnchorTransform;
-        parentJoint->parent_to_joint_origin_transform =
-          TransformToParentFrame(
-              parentJoint->parent_to_joint_origin_transform,
-              newParentLink->parent_joint->parent_to_joint_origin_transform);
-        newParentLink = newParentLink->getParent();
-      }
-      // now set the _link->child_links[i]->parent_joint's parent link to
-      // the newParentLink
-      _link->child_links[i]->setParent(newParentLink);
-      parentJoint->parent_link_name = newParentLink->name;
-      // and set the _link->child_links[i]->parent_joint's
-      // parent_to_joint_origin_transform as the aggregated anchor transform?
+      parentJoint->parent_to_joint_origin_transform =
+        CopyPose(TransformToParentFrame(
+              CopyPose(parentJoint->parent_to_joint_origin_transform),
+              _linkToTarget));
+      _link->child_links[i]->setParent(_target);
+      parentJoint->parent_link_name = _target->name;
     }
   }
 }
@@ -1070,22 +1470,15 @@ std::string lowerStr(const std::string &_str)
 
 ////////////////////////////////////////////////////////////////////////////////
 URDF2SDF::URDF2SDF()
+  : dataPtr(new URDF2SDFPrivate)
 {
-  // default options
-  g_enforceLimits = true;
-  g_reduceFixedJoints = true;
-  g_extensions.clear();
-  g_collisionExt = "_collision";
-  g_visualExt = "_visual";
-  g_lumpPrefix = "_fixed_joint_lump__";
-  g_initialRobotPoseValid = false;
-  g_fixedJointsTransformedInRevoluteJoints.clear();
-  g_fixedJointsTransformedInFixedJoints.clear();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 URDF2SDF::~URDF2SDF()
 {
+  delete this->dataPtr;
+  this->dataPtr = nullptr;
 }
 
 
@@ -1093,51 +1486,51 @@ URDF2SDF::~URDF2SDF()
 ////////////////////////////////////////////////////////////////////////////////
 std::string Values2str(unsigned int _count, const double *_values)
 {
-  std::stringstream ss;
-  ss.precision(g_outputDecimalPrecision);
+  std::string result;
   for (unsigned int i = 0 ; i < _count ; ++i)
   {
     if (i > 0)
     {
-      ss << " ";
+      result += ' ';
     }
     if (std::fpclassify(_values[i]) == FP_ZERO)
-      ss << 0;
+      result += '0';
     else
-      ss << _values[i];
+      appendNumber(result, _values[i], g_outputDecimalPrecision);
   }
-  return ss.str();
+  return result;
 }
 
 /////////////////////////////////////////////////
 std::string Values2str(unsigned int _count, const int *_values)
 {
-  std::stringstream ss;
+  std::string result;
   for (unsigned int i = 0 ; i < _count ; ++i)
   {
     if (i > 0)
     {
-      ss << " ";
+      result += ' ';
     }
-    ss << _values[i];
+    appendNumber(result, _values[i], 0);
   }
-  return ss.str();
+  return result;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-void AddKeyValue(TiXmlElement *_elem, const std::string &_key,
-                 const std::string &_value)
+TiXmlElement *NewKeyValue(TiXmlElement *_oldElem, const std::string &_key,
+                          const std::string &_value)
 {
-  TiXmlElement* childElem = _elem->FirstChildElement(_key);
-  if (childElem)
+  if (_oldElem)
   {
-    std::string oldValue = GetKeyValueAsString(childElem);
+    std::string oldValue = GetKeyValueAsString(_oldElem);
     if (oldValue != _value)
     {
-      sdfwarn << "multiple inconsistent <" << _key
-              << "> exists due to fixed joint reduction"
-              << " overwriting previous value [" << oldValue
-              << "] with [" << _value << "].\n";
+      const std::string message = "multiple inconsistent <" + _key +
+          "> exists due to fixed joint reduction" +
+          " overwriting previous value [" + oldValue +
+          "] with [" + _value + "].\n";
+      if (warningAllowed("urdf inconsistent value", message))
+        sdfwarn << message;
     }
     else
     {
@@ -1145,15 +1538,40 @@ void AddKeyValue(TiXmlElement *_elem, const std::string &_key,
               << "> exists with [" << _value
               << "] due to fixed joint reduction.\n";
     }
-    _elem->RemoveChild(childElem);  // remove old _elem
   }
 
   TiXmlElement *ekey = new TiXmlElement(_key);
   TiXmlText *textEkey = new TiXmlText(_value);
   ekey->LinkEndChild(textEkey);
+  return ekey;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void AddKeyValue(TiXmlElement *_elem, const std::string &_key,
+                 const std::string &_value)
+{
+  TiXmlElement* childElem = _elem->FirstChildElement(_key);
+  TiXmlElement *ekey = NewKeyValue(childElem, _key, _value);
+  if (childElem)
+  {
+    _elem->RemoveChild(childElem);  // remove old _elem
+  }
   _elem->LinkEndChild(ekey);
 }
 
+////////////////////////////////////////////////////////////////////////////////
+void AddKeyValue(ChildIndex &_children, const std::string &_key,
+                 const std::string &_value)
+{
+  TiXmlElement* childElem = _children.First(_key);
+  TiXmlElement *ekey = NewKeyValue(childElem, _key, _value);
+  if (childElem)
+  {
+    _children.Remove(childElem);  // remove old _elem
+  }
+  _children.Append(ekey);
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 void AddTransform(TiXmlElement *_elem, const ignition::math::Pose3d &_transform)
 {
@@ -1193,11 +1611,12 @@ void ParseRobotOrigin(TiXmlDocument &_urdfXml)
     const char *xyzstr = originXml->Attribute("xyz");
     if (xyzstr == nullptr)
     {
-      g_initialRobotPose.position = urdf::Vector3(0, 0, 0);
+      g_conversion->initialRobotPose.position = urdf::Vector3(0, 0, 0);
     }
     else
     {
-      g_initialRobotPose.position = ParseVector3(std::string(xyzstr));
+      g_conversion->initialRobotPose.position =
+          ParseVector3(std::string(xyzstr));
     }
     const char *rpystr = originXml->Attribute("rpy");
     urdf::Vector3 rpy;
@@ -1209,33 +1628,63 @@ void ParseRobotOrigin(TiXmlDocument &_urdfXml)
     {
       rpy = ParseVector3(std::string(rpystr));
     }
-    g_initialRobotPose.rotation.setFromRPY(rpy.x, rpy.y, rpy.z);
-    g_initialRobotPoseValid = true;
+    g_conversion->initialRobotPose.rotation.setFromRPY(rpy.x, rpy.y, rpy.z);
+    g_conversion->initialRobotPoseValid = true;
   }
 }
 
 /////////////////////////////////////////////////
 void InsertRobotOrigin(TiXmlElement *_elem)
 {
-  if (g_initialRobotPoseValid)
+  if (g_conversion->initialRobotPoseValid)
   {
     // set transform
     double pose[6];
-    pose[0] = g_initialRobotPose.position.x;
-    pose[1] = g_initialRobotPose.position.y;
-    pose[2] = g_initialRobotPose.position.z;
-    g_initialRobotPose.rotation.getRPY(pose[3], pose[4], pose[5]);
+    pose[0] = g_conversion->initialRobotPose.position.x;
+    pose[1] = g_conversion->initialRobotPose.position.y;
+    pose[2] = g_conversion->initialRobotPose.position.z;
+    g_conversion->initialRobotPose.rotation.getRPY(pose[3], pose[4], pose[5]);
     AddKeyValue(_elem, "pose", Values2str(6, pose));
   }
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Read the disableFixedJointLumping and preserveFixedJoint options
+/// of a <gazebo> block, which are kept by the conversion instead of the
+/// extension of the block.
+/// \param[in] _sdfXml The block.
+/// \param[in] _refStr Reference of the block.
+/// \param[in,out] _conversion The state of the conversion.
+static void readFixedJointOptions(TiXmlElement *_sdfXml,
+    const std::string &_refStr, URDF2SDFPrivate &_conversion)
+{
+  for (TiXmlElement *childElem = _sdfXml->FirstChildElement();
+       childElem; childElem = childElem->NextSiblingElement())
+  {
+    std::set<std::string> *joints = nullptr;
+    if (childElem->ValueStr() == "disableFixedJointLumping")
+      joints = &_conversion.fixedJointsTransformedInRevoluteJoints;
+    else if (childElem->ValueStr() == "preserveFixedJoint")
+      joints = &_conversion.fixedJointsTransformedInFixedJoints;
+    else
+      continue;
+
+    std::string valueStr = GetKeyValueAsString(childElem);
+    if (lowerStr(valueStr) == "true" || lowerStr(valueStr) == "yes" ||
+        valueStr == "1")
+    {
+      joints->insert(_refStr);
+    }
+  }
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 void URDF2SDF::ParseSDFExtension(TiXmlDocument &_urdfXml)
 {
   TiXmlElement* robotXml = _urdfXml.FirstChildElement("robot");
 
   // Get all SDF extension elements, put everything in
-  //   g_extensions map, containing a key string
+  //   this->dataPtr->extensions map, containing a key string
   //   (link/joint name) and values
   for (TiXmlElement* sdfXml = robotXml->FirstChildElement("gazebo");
        sdfXml; sdfXml = sdfXml->NextSiblingElement("gazebo"))
@@ -1253,11 +1702,31 @@ void URDF2SDF::ParseSDFExtension(TiXmlDocument &_urdfXml)
       refStr = std::string(ref);
     }
 
-    if (g_extensions.find(refStr) == g_extensions.end())
+    if (this->dataPtr->extensions.find(refStr) ==
+        this->dataPtr->extensions.end())
     {
       // create extension map for reference
       std::vector<SDFExtensionPtr> ge;
-      g_extensions.insert(std::make_pair(refStr, ge));
+      this->dataPtr->extensions.insert(std::make_pair(refStr, ge));
+    }
+
+    readFixedJointOptions(sdfXml, refStr, *this->dataPtr);
+
+    // Take the block from the other robots of the batch, if one of them
+    // has it.
+    std::string block;
+    if (this->dataPtr->extensionCache)
+    {
+      TiXmlPrinter printer;
+      printer.SetStreamPrinting();
+      sdfXml->Accept(&printer);
+      block = printer.Str();
+      if (SDFExtensionPtr cached =
+          this->dataPtr->extensionCache->Find(block))
+      {
+        this->dataPtr->extensions.find(refStr)->second.push_back(cached);
+        continue;
+      }
     }
 
     // create and insert a new SDFExtension into the map
@@ -1358,27 +1827,28 @@ void URDF2SDF::ParseSDFExtension(TiXmlDocument &_urdfXml)
       else if (childElem->ValueStr() == "dampingFactor")
       {
         sdf->isDampingFactor = true;
-        sdf->dampingFactor = std::stod(GetKeyValueAsString(childElem));
+        sdf->dampingFactor =
+            parseNumber<double>(GetKeyValueAsString(childElem));
       }
       else if (childElem->ValueStr() == "maxVel")
       {
         sdf->isMaxVel = true;
-        sdf->maxVel = std::stod(GetKeyValueAsString(childElem));
+        sdf->maxVel = parseNumber<double>(GetKeyValueAsString(childElem));
       }
       else if (childElem->ValueStr() == "minDepth")
       {
         sdf->isMinDepth = true;
-        sdf->minDepth = std::stod(GetKeyValueAsString(childElem));
+        sdf->minDepth = parseNumber<double>(GetKeyValueAsString(childElem));
       }
       else if (childElem->ValueStr() == "mu1")
       {
         sdf->isMu1 = true;
-        sdf->mu1 = std::stod(GetKeyValueAsString(childElem));
+        sdf->mu1 = parseNumber<double>(GetKeyValueAsString(childElem));
       }
       else if (childElem->ValueStr() == "mu2")
       {
         sdf->isMu2 = true;
-        sdf->mu2 = std::stod(GetKeyValueAsString(childElem));
+        sdf->mu2 = parseNumber<double>(GetKeyValueAsString(childElem));
       }
       else if (childElem->ValueStr() == "fdir1")
       {
@@ -1387,12 +1857,12 @@ void URDF2SDF::ParseSDFExtension(TiXmlDocument &_urdfXml)
       else if (childElem->ValueStr() == "kp")
       {
         sdf->isKp = true;
-        sdf->kp = std::stod(GetKeyValueAsString(childElem));
+        sdf->kp = parseNumber<double>(GetKeyValueAsString(childElem));
       }
       else if (childElem->ValueStr() == "kd")
       {
         sdf->isKd = true;
-        sdf->kd = std::stod(GetKeyValueAsString(childElem));
+        sdf->kd = parseNumber<double>(GetKeyValueAsString(childElem));
       }
       else if (childElem->ValueStr() == "selfCollide")
       {
@@ -1413,37 +1883,39 @@ void URDF2SDF::ParseSDFExtension(TiXmlDocument &_urdfXml)
       else if (childElem->ValueStr() == "maxContacts")
       {
         sdf->isMaxContacts = true;
-        sdf->maxContacts = std::stoi(GetKeyValueAsString(childElem));
+        sdf->maxContacts = parseNumber<int>(GetKeyValueAsString(childElem));
       }
       else if (childElem->ValueStr() == "laserRetro")
       {
         sdf->isLaserRetro = true;
-        sdf->laserRetro = std::stod(GetKeyValueAsString(childElem));
+        sdf->laserRetro = parseNumber<double>(GetKeyValueAsString(childElem));
       }
       else if (childElem->ValueStr() == "springReference")
       {
         sdf->isSpringReference = true;
-        sdf->springReference = std::stod(GetKeyValueAsString(childElem));
+        sdf->springReference =
+            parseNumber<double>(GetKeyValueAsString(childElem));
       }
       else if (childElem->ValueStr() == "springStiffness")
       {
         sdf->isSpringStiffness = true;
-        sdf->springStiffness = std::stod(GetKeyValueAsString(childElem));
+        sdf->springStiffness =
+            parseNumber<double>(GetKeyValueAsString(childElem));
       }
       else if (childElem->ValueStr() == "stopCfm")
       {
         sdf->isStopCfm = true;
-        sdf->stopCfm = std::stod(GetKeyValueAsString(childElem));
+        sdf->stopCfm = parseNumber<double>(GetKeyValueAsString(childElem));
       }
       else if (childElem->ValueStr() == "stopErp")
       {
         sdf->isStopErp = true;
-        sdf->stopErp = std::stod(GetKeyValueAsString(childElem));
+        sdf->stopErp = parseNumber<double>(GetKeyValueAsString(childElem));
       }
       else if (childElem->ValueStr() == "fudgeFactor")
       {
         sdf->isFudgeFactor = true;
-        sdf->fudgeFactor = std::stod(GetKeyValueAsString(childElem));
+        sdf->fudgeFactor = parseNumber<double>(GetKeyValueAsString(childElem));
       }
       else if (childElem->ValueStr() == "provideFeedback")
       {
@@ -1469,9 +1941,12 @@ void URDF2SDF::ParseSDFExtension(TiXmlDocument &_urdfXml)
       {
         if (childElem->ValueStr() == "cfmDamping")
         {
-          sdfwarn << "Note that cfmDamping is being deprecated by "
-                  << "implicitSpringDamper, please replace instances "
-                  << "of cfmDamping with implicitSpringDamper in your model.\n";
+          const std::string message =
+              "Note that cfmDamping is being deprecated by "
+              "implicitSpringDamper, please replace instances "
+              "of cfmDamping with implicitSpringDamper in your model.\n";
+          if (warningAllowed("urdf deprecated value", message))
+            sdfwarn << message;
         }
 
         sdf->isImplicitSpringDamper = true;
@@ -1487,25 +1962,11 @@ void URDF2SDF::ParseSDFExtension(TiXmlDocument &_urdfXml)
           sdf->implicitSpringDamper = false;
         }
       }
-      else if (childElem->ValueStr() == "disableFixedJointLumping")
-      {
-        std::string valueStr = GetKeyValueAsString(childElem);
-
-        if (lowerStr(valueStr) == "true" || lowerStr(valueStr) == "yes" ||
-            valueStr == "1")
-        {
-          g_fixedJointsTransformedInRevoluteJoints.insert(refStr);
-        }
-      }
-      else if (childElem->ValueStr() == "preserveFixedJoint")
+      else if (childElem->ValueStr() == "disableFixedJointLumping" ||
+               childElem->ValueStr() == "preserveFixedJoint")
       {
-        std::string valueStr = GetKeyValueAsString(childElem);
-
-        if (lowerStr(valueStr) == "true" || lowerStr(valueStr) == "yes" ||
-            valueStr == "1")
-        {
-          g_fixedJointsTransformedInFixedJoints.insert(refStr);
-        }
+        // read by readFixedJointOptions, since they are not part of the
+        // extension
       }
       else
       {
@@ -1524,21 +1985,25 @@ void URDF2SDF::ParseSDFExtension(TiXmlDocument &_urdfXml)
       }
     }
 
+    if (this->dataPtr->extensionCache)
+      this->dataPtr->extensionCache->Insert(block, *sdf);
+
     // insert into my map
-    (g_extensions.find(refStr))->second.push_back(sdf);
+    (this->dataPtr->extensions.find(refStr))->second.push_back(sdf);
   }
 
   // Handle fixed joints for which both disableFixedJointLumping
   // and preserveFixedJoint options are present
   for (auto& fixedJointConvertedToFixed:
-             g_fixedJointsTransformedInFixedJoints)
+             this->dataPtr->fixedJointsTransformedInFixedJoints)
   {
     // If both options are present, the model creator is aware of the
     // existence of the preserveFixedJoint option and the
     // disableFixedJointLumping option is there only for backward compatibility
     // For this reason, if both options are present then the preserveFixedJoint
     // option has the precedence
-    g_fixedJointsTransformedInRevoluteJoints.erase(fixedJointConvertedToFixed);
+    this->dataPtr->fixedJointsTransformedInRevoluteJoints.erase(
+        fixedJointConvertedToFixed);
   }
 }
 
@@ -1546,314 +2011,303 @@ void URDF2SDF::ParseSDFExtension(TiXmlDocument &_urdfXml)
 void InsertSDFExtensionCollision(TiXmlElement *_elem,
                                  const std::string &_linkName)
 {
-  // loop through extensions for the whole model
-  // and see which ones belong to _linkName
+  // look up the extensions of _linkName, which include the extensions
+  // of the links lumped into it, and see which ones belong to _elem
   // This might be complicated since there's:
   //   - urdf collision name -> sdf collision name conversion
   //   - fixed joint reduction / lumping
-  for (StringSDFExtensionPtrMap::iterator
-      sdfIt = g_extensions.begin();
-      sdfIt != g_extensions.end(); ++sdfIt)
-  {
-    if (sdfIt->first == _linkName)
-    {
-      // std::cerr << "============================\n";
-      // std::cerr << "working on g_extensions for link ["
-      //           << sdfIt->first << "]\n";
-      // if _elem already has a surface element, use it
-      TiXmlNode *surface = _elem->FirstChild("surface");
-      TiXmlNode *friction = nullptr;
-      TiXmlNode *frictionOde = nullptr;
-      TiXmlNode *contact = nullptr;
-      TiXmlNode *contactOde = nullptr;
-
-      // loop through all the gazebo extensions stored in sdfIt->second
-      for (std::vector<SDFExtensionPtr>::iterator ge = sdfIt->second.begin();
-           ge != sdfIt->second.end(); ++ge)
-      {
-        // Check if this blob belongs to _elem based on
-        //   - blob's reference link name (_linkName or sdfIt->first)
-        //   - _elem (destination for blob, which is a collision sdf).
-
-        if (!_elem->Attribute("name"))
-        {
-          sdferr << "ERROR: collision _elem has no name,"
-                 << " something is wrong" << "\n";
-        }
+  auto sdfIt = g_conversion->extensions.find(_linkName);
+  if (sdfIt != g_conversion->extensions.end())
+  {
+    // std::cerr << "============================\n";
+    // std::cerr << "working on g_conversion->extensions for link ["
+    //           << sdfIt->first << "]\n";
+    // if _elem already has a surface element, use it
+    ChildIndex children(_elem);
+    TiXmlElement *surface = children.First("surface");
+    TiXmlNode *friction = nullptr;
+    TiXmlNode *frictionOde = nullptr;
+    TiXmlNode *contact = nullptr;
+    TiXmlNode *contactOde = nullptr;
+
+    // loop through all the gazebo extensions stored in sdfIt->second
+    for (std::vector<SDFExtensionPtr>::iterator ge = sdfIt->second.begin();
+         ge != sdfIt->second.end(); ++ge)
+    {
+      // Check if this blob belongs to _elem based on
+      //   - blob's reference link name (_linkName or sdfIt->first)
+      //   - _elem (destination for blob, which is a collision sdf).
+
+      if (!_elem->Attribute("name"))
+      {
+        sdferr << "ERROR: collision _elem has no name,"
+               << " something is wrong" << "\n";
+      }
 
-        std::string sdfCollisionName(_elem->Attribute("name"));
+      std::string sdfCollisionName(_elem->Attribute("name"));
 
-        // std::cerr << "----------------------------\n";
-        // std::cerr << "blob belongs to [" << _linkName
-        //           << "] with old parent LinkName [" << (*ge)->oldLinkName
-        //           << "]\n";
-        // std::cerr << "_elem sdf collision name [" << sdfCollisionName
-        //           << "]\n";
-        // std::cerr << "----------------------------\n";
+      // std::cerr << "----------------------------\n";
+      // std::cerr << "blob belongs to [" << _linkName
+      //           << "] with old parent LinkName [" << (*ge)->oldLinkName
+      //           << "]\n";
+      // std::cerr << "_elem sdf collision name [" << sdfCollisionName
+      //           << "]\n";
+      // std::cerr << "----------------------------\n";
 
-        std::string lumpCollisionName = g_lumpPrefix +
-          (*ge)->oldLinkName + g_collisionExt;
+      std::string lumpCollisionName = g_lumpPrefix +
+        (*ge)->oldLinkName + g_collisionExt;
 
-        bool wasReduced = (_linkName == (*ge)->oldLinkName);
-        bool collisionNameContainsLinkname =
-          sdfCollisionName.find(_linkName) != std::string::npos;
-        bool collisionNameContainsLumpedLinkname =
-          sdfCollisionName.find(lumpCollisionName) != std::string::npos;
-        bool collisionNameContainsLumpedRef =
-          sdfCollisionName.find(g_lumpPrefix) != std::string::npos;
+      bool wasReduced = (_linkName == (*ge)->oldLinkName);
+      bool collisionNameContainsLinkname =
+        sdfCollisionName.find(_linkName) != std::string::npos;
+      bool collisionNameContainsLumpedLinkname =
+        sdfCollisionName.find(lumpCollisionName) != std::string::npos;
+      bool collisionNameContainsLumpedRef =
+        sdfCollisionName.find(g_lumpPrefix) != std::string::npos;
 
-        if (!collisionNameContainsLinkname)
-        {
-          sdferr << "collision name does not contain link name,"
-                 << " file an issue.\n";
-        }
+      if (!collisionNameContainsLinkname)
+      {
+        sdferr << "collision name does not contain link name,"
+               << " file an issue.\n";
+      }
 
-        // if the collision _elem was not reduced,
-        // its name should not have g_lumpPrefix in it.
-        // otherwise, its name should have
-        // "g_lumpPrefix+[original link name before reduction]".
-        if ((wasReduced && !collisionNameContainsLumpedRef) ||
-            (!wasReduced && collisionNameContainsLumpedLinkname))
+      // if the collision _elem was not reduced,
+      // its name should not have g_lumpPrefix in it.
+      // otherwise, its name should have
+      // "g_lumpPrefix+[original link name before reduction]".
+      if ((wasReduced && !collisionNameContainsLumpedRef) ||
+          (!wasReduced && collisionNameContainsLumpedLinkname))
+      {
+        // insert any blobs (including visual plugins)
+        // warning, if you insert a <surface> sdf here, it might
+        // duplicate what was constructed above.
+        // in the future, we should use blobs (below) in place of
+        // explicitly specified fields (above).
+        if (!(*ge)->collision_blobs.empty())
         {
-          // insert any blobs (including visual plugins)
-          // warning, if you insert a <surface> sdf here, it might
-          // duplicate what was constructed above.
-          // in the future, we should use blobs (below) in place of
-          // explicitly specified fields (above).
-          if (!(*ge)->collision_blobs.empty())
+          std::vector<TiXmlElementPtr>::iterator blob;
+          for (blob = (*ge)->collision_blobs.begin();
+               blob != (*ge)->collision_blobs.end(); ++blob)
           {
-            std::vector<TiXmlElementPtr>::iterator blob;
-            for (blob = (*ge)->collision_blobs.begin();
-                 blob != (*ge)->collision_blobs.end(); ++blob)
-            {
-              // find elements and assign pointers if they exist
-              // for mu1, mu2, minDepth, maxVel, fdir1, kp, kd
-              // otherwise, they are allocated by 'new' below.
-              // std::cerr << ">>>>> working on extension blob: ["
-              //           << (*blob)->Value() << "]\n";
+            // find elements and assign pointers if they exist
+            // for mu1, mu2, minDepth, maxVel, fdir1, kp, kd
+            // otherwise, they are allocated by 'new' below.
+            // std::cerr << ">>>>> working on extension blob: ["
+            //           << (*blob)->Value() << "]\n";
 
-              // print for debug
-              std::ostringstream origStream;
-              std::unique_ptr<TiXmlNode> blobClone((*blob)->Clone());
-              origStream << *blobClone;
-              // std::cerr << "collision extension ["
-              //           << origStream.str() << "]\n";
-
-              if (strcmp((*blob)->Value(), "surface") == 0)
+            if (strcmp((*blob)->Value(), "surface") == 0)
+            {
+              // blob is a <surface>, tread carefully otherwise
+              // we end up with multiple copies of <surface>.
+              // Also, get pointers (contact[Ode], friction[Ode])
+              // below for backwards (non-blob) compatibility.
+              if (surface == nullptr)
               {
-                // blob is a <surface>, tread carefully otherwise
-                // we end up with multiple copies of <surface>.
-                // Also, get pointers (contact[Ode], friction[Ode])
-                // below for backwards (non-blob) compatibility.
-                if (surface == nullptr)
-                {
-                  // <surface> do not exist, it simple,
-                  // just add it to the current collision
-                  // and it's done.
-                  _elem->LinkEndChild((*blob)->Clone());
-                  surface = _elem->LastChild("surface");
-                  // std::cerr << " --- surface created "
-                  //           <<  (void*)surface << "\n";
-                }
-                else
-                {
-                  // <surface> exist already, remove it and
-                  // overwrite with the blob.
-                  _elem->RemoveChild(surface);
-                  _elem->LinkEndChild((*blob)->Clone());
-                  surface = _elem->FirstChild("surface");
-                  // std::cerr << " --- surface exists, replace with blob.\n";
-                }
-
-                // Extra code for backwards compatibility, to
-                // deal with old way of specifying collision attributes
-                // using individual elements listed below:
-                //   "mu"
-                //   "mu2"
-                //   "fdir1"
-                //   "kp"
-                //   "kd"
-                //   "max_vel"
-                //   "min_depth"
-                //   "laser_retro"
-                //   "max_contacts"
-                // Get contact[Ode] and friction[Ode] node pointers
-                // if they exist.
-                contact  = surface->FirstChild("contact");
-                if (contact != nullptr)
-                {
-                  contactOde  = contact->FirstChild("ode");
-                }
-                friction = surface->FirstChild("friction");
-                if (friction != nullptr)
-                {
-                  frictionOde  = friction->FirstChild("ode");
-                }
+                // <surface> do not exist, it simple,
+                // just add it to the current collision
+                // and it's done.
+                surface = children.Append((*blob)->Clone());
+                // std::cerr << " --- surface created "
+                //           <<  (void*)surface << "\n";
               }
               else
               {
-                // If the blob is not a <surface>, we don't have
-                // to worry about backwards compatibility.
-                // Simply add to master element.
-                _elem->LinkEndChild((*blob)->Clone());
+                // <surface> exist already, remove it and
+                // overwrite with the blob.
+                children.Remove(surface);
+                children.Append((*blob)->Clone());
+                surface = children.First("surface");
+                // std::cerr << " --- surface exists, replace with blob.\n";
+              }
+
+              // Extra code for backwards compatibility, to
+              // deal with old way of specifying collision attributes
+              // using individual elements listed below:
+              //   "mu"
+              //   "mu2"
+              //   "fdir1"
+              //   "kp"
+              //   "kd"
+              //   "max_vel"
+              //   "min_depth"
+              //   "laser_retro"
+              //   "max_contacts"
+              // Get contact[Ode] and friction[Ode] node pointers
+              // if they exist.
+              contact  = surface->FirstChild("contact");
+              if (contact != nullptr)
+              {
+                contactOde  = contact->FirstChild("ode");
+              }
+              friction = surface->FirstChild("friction");
+              if (friction != nullptr)
+              {
+                frictionOde  = friction->FirstChild("ode");
               }
             }
+            else
+            {
+              // If the blob is not a <surface>, we don't have
+              // to worry about backwards compatibility.
+              // Simply add to master element.
+              children.Append((*blob)->Clone());
+            }
           }
+        }
 
-          // Extra code for backwards compatibility, to
-          // deal with old way of specifying collision attributes
-          // using individual elements listed below:
-          //   "mu"
-          //   "mu2"
-          //   "fdir1"
-          //   "kp"
-          //   "kd"
-          //   "max_vel"
-          //   "min_depth"
-          //   "laser_retro"
-          //   "max_contacts"
-          // The new way to do this is to specify everything
-          // in collision blobs by using the <collision> tag.
-          // So there's no need for custom code for each property.
+        // Extra code for backwards compatibility, to
+        // deal with old way of specifying collision attributes
+        // using individual elements listed below:
+        //   "mu"
+        //   "mu2"
+        //   "fdir1"
+        //   "kp"
+        //   "kd"
+        //   "max_vel"
+        //   "min_depth"
+        //   "laser_retro"
+        //   "max_contacts"
+        // The new way to do this is to specify everything
+        // in collision blobs by using the <collision> tag.
+        // So there's no need for custom code for each property.
+
+        // construct new elements if not in blobs
+        if (surface == nullptr)
+        {
+          surface  = new TiXmlElement("surface");
+          if (!surface)
+          {
+            // Memory allocation error
+            sdferr << "Memory allocation error while"
+                   << " processing <surface>.\n";
+          }
+          children.Append(surface);
+        }
 
-          // construct new elements if not in blobs
-          if (surface == nullptr)
+        // construct new elements if not in blobs
+        if (contact == nullptr)
+        {
+          if (surface->FirstChild("contact") == nullptr)
           {
-            surface  = new TiXmlElement("surface");
-            if (!surface)
+            contact  = new TiXmlElement("contact");
+            if (!contact)
             {
               // Memory allocation error
               sdferr << "Memory allocation error while"
-                     << " processing <surface>.\n";
+                     << " processing <contact>.\n";
             }
-            _elem->LinkEndChild(surface);
+            surface->LinkEndChild(contact);
+          }
+          else
+          {
+            contact  = surface->FirstChild("contact");
           }
+        }
 
-          // construct new elements if not in blobs
-          if (contact == nullptr)
+        if (contactOde == nullptr)
+        {
+          if (contact->FirstChild("ode") == nullptr)
           {
-            if (surface->FirstChild("contact") == nullptr)
-            {
-              contact  = new TiXmlElement("contact");
-              if (!contact)
-              {
-                // Memory allocation error
-                sdferr << "Memory allocation error while"
-                       << " processing <contact>.\n";
-              }
-              surface->LinkEndChild(contact);
-            }
-            else
+            contactOde  = new TiXmlElement("ode");
+            if (!contactOde)
             {
-              contact  = surface->FirstChild("contact");
+              // Memory allocation error
+              sdferr << "Memory allocation error while"
+                     << " processing <contact><ode>.\n";
             }
+            contact->LinkEndChild(contactOde);
           }
-
-          if (contactOde == nullptr)
+          else
           {
-            if (contact->FirstChild("ode") == nullptr)
-            {
-              contactOde  = new TiXmlElement("ode");
-              if (!contactOde)
-              {
-                // Memory allocation error
-                sdferr << "Memory allocation error while"
-                       << " processing <contact><ode>.\n";
-              }
-              contact->LinkEndChild(contactOde);
-            }
-            else
-            {
-              contactOde  = contact->FirstChild("ode");
-            }
+            contactOde  = contact->FirstChild("ode");
           }
+        }
 
-          if (friction == nullptr)
+        if (friction == nullptr)
+        {
+          if (surface->FirstChild("friction") == nullptr)
           {
-            if (surface->FirstChild("friction") == nullptr)
-            {
-              friction  = new TiXmlElement("friction");
-              if (!friction)
-              {
-                // Memory allocation error
-                sdferr << "Memory allocation error while"
-                       << " processing <friction>.\n";
-              }
-              surface->LinkEndChild(friction);
-            }
-            else
+            friction  = new TiXmlElement("friction");
+            if (!friction)
             {
-              friction  = surface->FirstChild("friction");
+              // Memory allocation error
+              sdferr << "Memory allocation error while"
+                     << " processing <friction>.\n";
             }
+            surface->LinkEndChild(friction);
           }
-
-          if (frictionOde == nullptr)
+          else
           {
-            if (friction->FirstChild("ode") == nullptr)
-            {
-              frictionOde  = new TiXmlElement("ode");
-              if (!frictionOde)
-              {
-                // Memory allocation error
-                sdferr << "Memory allocation error while"
-                       << " processing <friction><ode>.\n";
-              }
-              friction->LinkEndChild(frictionOde);
-            }
-            else
-            {
-              frictionOde  = friction->FirstChild("ode");
-            }
+            friction  = surface->FirstChild("friction");
           }
+        }
 
-          // insert mu1, mu2, kp, kd for collision
-          if ((*ge)->isMu1)
-          {
-            AddKeyValue(frictionOde->ToElement(), "mu",
-                        Values2str(1, &(*ge)->mu1));
-          }
-          if ((*ge)->isMu2)
-          {
-            AddKeyValue(frictionOde->ToElement(), "mu2",
-                        Values2str(1, &(*ge)->mu2));
-          }
-          if (!(*ge)->fdir1.empty())
-          {
-            AddKeyValue(frictionOde->ToElement(), "fdir1", (*ge)->fdir1);
-          }
-          if ((*ge)->isKp)
-          {
-            AddKeyValue(contactOde->ToElement(), "kp",
-                        Values2str(1, &(*ge)->kp));
-          }
-          if ((*ge)->isKd)
-          {
-            AddKeyValue(contactOde->ToElement(), "kd",
-                        Values2str(1, &(*ge)->kd));
-          }
-          // max contact interpenetration correction velocity
-          if ((*ge)->isMaxVel)
-          {
-            AddKeyValue(contactOde->ToElement(), "max_vel",
-                        Values2str(1, &(*ge)->maxVel));
-          }
-          // contact interpenetration margin tolerance
-          if ((*ge)->isMinDepth)
-          {
-            AddKeyValue(contactOde->ToElement(), "min_depth",
-                        Values2str(1, &(*ge)->minDepth));
-          }
-          if ((*ge)->isLaserRetro)
+        if (frictionOde == nullptr)
+        {
+          if (friction->FirstChild("ode") == nullptr)
           {
-            AddKeyValue(_elem, "laser_retro",
-                        Values2str(1, &(*ge)->laserRetro));
+            frictionOde  = new TiXmlElement("ode");
+            if (!frictionOde)
+            {
+              // Memory allocation error
+              sdferr << "Memory allocation error while"
+                     << " processing <friction><ode>.\n";
+            }
+            friction->LinkEndChild(frictionOde);
           }
-          if ((*ge)->isMaxContacts)
+          else
           {
-            AddKeyValue(_elem, "max_contacts",
-                        Values2str(1, &(*ge)->maxContacts));
+            frictionOde  = friction->FirstChild("ode");
           }
         }
+
+        // insert mu1, mu2, kp, kd for collision
+        if ((*ge)->isMu1)
+        {
+          AddKeyValue(frictionOde->ToElement(), "mu",
+                      Values2str(1, &(*ge)->mu1));
+        }
+        if ((*ge)->isMu2)
+        {
+          AddKeyValue(frictionOde->ToElement(), "mu2",
+                      Values2str(1, &(*ge)->mu2));
+        }
+        if (!(*ge)->fdir1.empty())
+        {
+          AddKeyValue(frictionOde->ToElement(), "fdir1", (*ge)->fdir1);
+        }
+        if ((*ge)->isKp)
+        {
+          AddKeyValue(contactOde->ToElement(), "kp",
+                      Values2str(1, &(*ge)->kp));
+        }
+        if ((*ge)->isKd)
+        {
+          AddKeyValue(contactOde->ToElement(), "kd",
+                      Values2str(1, &(*ge)->kd));
+        }
+        // max contact interpenetration correction velocity
+        if ((*ge)->isMaxVel)
+        {
+          AddKeyValue(contactOde->ToElement(), "max_vel",
+                      Values2str(1, &(*ge)->maxVel));
+        }
+        // contact interpenetration margin tolerance
+        if ((*ge)->isMinDepth)
+        {
+          AddKeyValue(contactOde->ToElement(), "min_depth",
+                      Values2str(1, &(*ge)->minDepth));
+        }
+        if ((*ge)->isLaserRetro)
+        {
+          AddKeyValue(children, "laser_retro",
+                      Values2str(1, &(*ge)->laserRetro));
+        }
+        if ((*ge)->isMaxContacts)
+        {
+          AddKeyValue(children, "max_contacts",
+                      Values2str(1, &(*ge)->maxContacts));
+        }
       }
     }
   }
@@ -1863,191 +2317,187 @@ void InsertSDFExtensionCollision(TiXmlElement *_elem,
 void InsertSDFExtensionVisual(TiXmlElement *_elem,
                               const std::string &_linkName)
 {
-  // loop through extensions for the whole model
-  // and see which ones belong to _linkName
+  // look up the extensions of _linkName, which include the extensions
+  // of the links lumped into it, and see which ones belong to _elem
   // This might be complicated since there's:
   //   - urdf visual name -> sdf visual name conversion
   //   - fixed joint reduction / lumping
-  for (StringSDFExtensionPtrMap::iterator
-      sdfIt = g_extensions.begin();
-      sdfIt != g_extensions.end(); ++sdfIt)
+  auto sdfIt = g_conversion->extensions.find(_linkName);
+  if (sdfIt != g_conversion->extensions.end())
   {
-    if (sdfIt->first == _linkName)
+    // std::cerr << "============================\n";
+    // std::cerr << "working on g_conversion->extensions for link ["
+    //           << sdfIt->first << "]\n";
+    // if _elem already has a material element, use it
+    ChildIndex children(_elem);
+    TiXmlElement *material = children.First("material");
+    TiXmlElement *script = nullptr;
+
+    // loop through all the gazebo extensions stored in sdfIt->second
+    for (std::vector<SDFExtensionPtr>::iterator ge = sdfIt->second.begin();
+         ge != sdfIt->second.end(); ++ge)
     {
-      // std::cerr << "============================\n";
-      // std::cerr << "working on g_extensions for link ["
-      //           << sdfIt->first << "]\n";
-      // if _elem already has a material element, use it
-      TiXmlNode *material = _elem->FirstChild("material");
-      TiXmlElement *script = nullptr;
+      // Check if this blob belongs to _elem based on
+      //   - blob's reference link name (_linkName or sdfIt->first)
+      //   - _elem (destination for blob, which is a visual sdf).
 
-      // loop through all the gazebo extensions stored in sdfIt->second
-      for (std::vector<SDFExtensionPtr>::iterator ge = sdfIt->second.begin();
-           ge != sdfIt->second.end(); ++ge)
+      if (!_elem->Attribute("name"))
       {
-        // Check if this blob belongs to _elem based on
-        //   - blob's reference link name (_linkName or sdfIt->first)
-        //   - _elem (destination for blob, which is a visual sdf).
-
-        if (!_elem->Attribute("name"))
-        {
-          sdferr << "ERROR: visual _elem has no name,"
-                 << " something is wrong" << "\n";
-        }
+        sdferr << "ERROR: visual _elem has no name,"
+               << " something is wrong" << "\n";
+      }
 
-        std::string sdfVisualName(_elem->Attribute("name"));
+      std::string sdfVisualName(_elem->Attribute("name"));
 
-        // std::cerr << "----------------------------\n";
-        // std::cerr << "blob belongs to [" << _linkName
-        //           << "] with old parent LinkName [" << (*ge)->oldLinkName
-        //           << "]\n";
-        // std::cerr << "_elem sdf visual name [" << sdfVisualName
-        //           << "]\n";
-        // std::cerr << "----------------------------\n";
+      // std::cerr << "----------------------------\n";
+      // std::cerr << "blob belongs to [" << _linkName
+      //           << "] with old parent LinkName [" << (*ge)->oldLinkName
+      //           << "]\n";
+      // std::cerr << "_elem sdf visual name [" << sdfVisualName
+      //           << "]\n";
+      // std::cerr << "----------------------------\n";
 
-        std::string lumpVisualName = g_lumpPrefix +
-          (*ge)->oldLinkName + g_visualExt;
+      std::string lumpVisualName = g_lumpPrefix +
+        (*ge)->oldLinkName + g_visualExt;
 
-        bool wasReduced = (_linkName == (*ge)->oldLinkName);
-        bool visualNameContainsLinkname =
-          sdfVisualName.find(_linkName) != std::string::npos;
-        bool visualNameContainsLumpedLinkname =
-          sdfVisualName.find(lumpVisualName) != std::string::npos;
-        bool visualNameContainsLumpedRef =
-          sdfVisualName.find(g_lumpPrefix) != std::string::npos;
+      bool wasReduced = (_linkName == (*ge)->oldLinkName);
+      bool visualNameContainsLinkname =
+        sdfVisualName.find(_linkName) != std::string::npos;
+      bool visualNameContainsLumpedLinkname =
+        sdfVisualName.find(lumpVisualName) != std::string::npos;
+      bool visualNameContainsLumpedRef =
+        sdfVisualName.find(g_lumpPrefix) != std::string::npos;
 
-        if (!visualNameContainsLinkname)
-        {
-          sdferr << "visual name does not contain link name,"
-                 << " file an issue.\n";
-        }
+      if (!visualNameContainsLinkname)
+      {
+        sdferr << "visual name does not contain link name,"
+               << " file an issue.\n";
+      }
 
-        // if the visual _elem was not reduced,
-        // its name should not have g_lumpPrefix in it.
-        // otherwise, its name should have
-        // "g_lumpPrefix+[original link name before reduction]".
-        if ((wasReduced && !visualNameContainsLumpedRef) ||
-            (!wasReduced && visualNameContainsLumpedLinkname))
+      // if the visual _elem was not reduced,
+      // its name should not have g_lumpPrefix in it.
+      // otherwise, its name should have
+      // "g_lumpPrefix+[original link name before reduction]".
+      if ((wasReduced && !visualNameContainsLumpedRef) ||
+          (!wasReduced && visualNameContainsLumpedLinkname))
+      {
+        // insert any blobs (including visual plugins)
+        // warning, if you insert a <material> sdf here, it might
+        // duplicate what was constructed above.
+        // in the future, we should use blobs (below) in place of
+        // explicitly specified fields (above).
+        if (!(*ge)->visual_blobs.empty())
         {
-          // insert any blobs (including visual plugins)
-          // warning, if you insert a <material> sdf here, it might
-          // duplicate what was constructed above.
-          // in the future, we should use blobs (below) in place of
-          // explicitly specified fields (above).
-          if (!(*ge)->visual_blobs.empty())
+          std::vector<TiXmlElementPtr>::iterator blob;
+          for (blob = (*ge)->visual_blobs.begin();
+              blob != (*ge)->visual_blobs.end(); ++blob)
           {
-            std::vector<TiXmlElementPtr>::iterator blob;
-            for (blob = (*ge)->visual_blobs.begin();
-                blob != (*ge)->visual_blobs.end(); ++blob)
+            // find elements and assign pointers if they exist
+            // for mu1, mu2, minDepth, maxVel, fdir1, kp, kd
+            // otherwise, they are allocated by 'new' below.
+            // std::cerr << ">>>>> working on extension blob: ["
+            //           << (*blob)->Value() << "]\n";
+
+            // print for debug
+            // std::ostringstream origStream;
+            // origStream << *(*blob)->Clone();
+            // std::cerr << "visual extension ["
+            //           << origStream.str() << "]\n";
+
+            if (strcmp((*blob)->Value(), "material") == 0)
             {
-              // find elements and assign pointers if they exist
-              // for mu1, mu2, minDepth, maxVel, fdir1, kp, kd
-              // otherwise, they are allocated by 'new' below.
-              // std::cerr << ">>>>> working on extension blob: ["
-              //           << (*blob)->Value() << "]\n";
-
-              // print for debug
-              // std::ostringstream origStream;
-              // origStream << *(*blob)->Clone();
-              // std::cerr << "visual extension ["
-              //           << origStream.str() << "]\n";
-
-              if (strcmp((*blob)->Value(), "material") == 0)
+              // blob is a <material>, tread carefully otherwise
+              // we end up with multiple copies of <material>.
+              // Also, get pointers (script)
+              // below for backwards (non-blob) compatibility.
+              if (material == nullptr)
               {
-                // blob is a <material>, tread carefully otherwise
-                // we end up with multiple copies of <material>.
-                // Also, get pointers (script)
-                // below for backwards (non-blob) compatibility.
-                if (material == nullptr)
-                {
-                  // <material> do not exist, it simple,
-                  // just add it to the current visual
-                  // and it's done.
-                  _elem->LinkEndChild((*blob)->Clone());
-                  material = _elem->LastChild("material");
-                  // std::cerr << " --- material created "
-                  //           <<  (void*)material << "\n";
-                }
-                else
-                {
-                  // <material> exist already, remove it and
-                  // overwrite with the blob.
-                  _elem->RemoveChild(material);
-                  _elem->LinkEndChild((*blob)->Clone());
-                  material = _elem->FirstChild("material");
-                  // std::cerr << " --- material exists, replace with blob.\n";
-                }
-
-                // Extra code for backwards compatibility, to
-                // deal with old way of specifying visual attributes
-                // using individual element:
-                //   "script"
-                // Get script node pointers
-                // if they exist.
-                script = material->FirstChildElement("script");
+                // <material> do not exist, it simple,
+                // just add it to the current visual
+                // and it's done.
+                material = children.Append((*blob)->Clone());
+                // std::cerr << " --- material created "
+                //           <<  (void*)material << "\n";
               }
               else
               {
-                // std::cerr << "***** working on extension blob: ["
-                //           << (*blob)->Value() << "]\n";
-                // If the blob is not a <material>, we don't have
-                // to worry about backwards compatibility.
-                // Simply add to master element.
-                _elem->LinkEndChild((*blob)->Clone());
+                // <material> exist already, remove it and
+                // overwrite with the blob.
+                children.Remove(material);
+                children.Append((*blob)->Clone());
+                material = children.First("material");
+                // std::cerr << " --- material exists, replace with blob.\n";
               }
+
+              // Extra code for backwards compatibility, to
+              // deal with old way of specifying visual attributes
+              // using individual element:
+              //   "script"
+              // Get script node pointers
+              // if they exist.
+              script = material->FirstChildElement("script");
+            }
+            else
+            {
+              // std::cerr << "***** working on extension blob: ["
+              //           << (*blob)->Value() << "]\n";
+              // If the blob is not a <material>, we don't have
+              // to worry about backwards compatibility.
+              // Simply add to master element.
+              children.Append((*blob)->Clone());
+            }
+          }
+        }
+
+        // Extra code for backwards compatibility, to
+        // deal with old way of specifying visual attributes
+        // using individual element:
+        //   "script"
+        // The new way to do this is to specify everything
+        // in visual blobs by using the <visual> tag.
+        // So there's no need for custom code for each property.
+
+        // backward compatibility for old code
+        // insert material/script block for visual
+        // (*ge)->material block goes under sdf <material><script><name>.
+        if (!(*ge)->material.empty())
+        {
+          // construct new elements if not in blobs
+          if (material == nullptr)
+          {
+            material  = new TiXmlElement("material");
+            if (!material)
+            {
+              // Memory allocation error
+              sdferr << "Memory allocation error while"
+                     << " processing <material>.\n";
             }
+            children.Append(material);
           }
 
-          // Extra code for backwards compatibility, to
-          // deal with old way of specifying visual attributes
-          // using individual element:
-          //   "script"
-          // The new way to do this is to specify everything
-          // in visual blobs by using the <visual> tag.
-          // So there's no need for custom code for each property.
-
-          // backward compatibility for old code
-          // insert material/script block for visual
-          // (*ge)->material block goes under sdf <material><script><name>.
-          if (!(*ge)->material.empty())
+          if (script == nullptr)
           {
-            // construct new elements if not in blobs
-            if (material == nullptr)
+            if (material->FirstChildElement("script") == nullptr)
             {
-              material  = new TiXmlElement("material");
-              if (!material)
+              script  = new TiXmlElement("script");
+              if (!script)
               {
                 // Memory allocation error
                 sdferr << "Memory allocation error while"
-                       << " processing <material>.\n";
+                       << " processing <script>.\n";
               }
-              _elem->LinkEndChild(material);
+              material->LinkEndChild(script);
             }
-
-            if (script == nullptr)
+            else
             {
-              if (material->FirstChildElement("script") == nullptr)
-              {
-                script  = new TiXmlElement("script");
-                if (!script)
-                {
-                  // Memory allocation error
-                  sdferr << "Memory allocation error while"
-                         << " processing <script>.\n";
-                }
-                material->LinkEndChild(script);
-              }
-              else
-              {
-                script  = material->FirstChildElement("script");
-              }
+              script  = material->FirstChildElement("script");
             }
-
-            AddKeyValue(script, "name", (*ge)->material);
-            // hard code original default gazebo materials files
-            AddKeyValue(script, "uri",
-              "file://media/materials/scripts/gazebo.material");
           }
+
+          AddKeyValue(script, "name", (*ge)->material);
+          // hard code original default gazebo materials files
+          AddKeyValue(script, "uri",
+            "file://media/materials/scripts/gazebo.material");
         }
       }
     }
@@ -2057,50 +2507,48 @@ void InsertSDFExtensionVisual(TiXmlElement *_elem,
 ////////////////////////////////////////////////////////////////////////////////
 void InsertSDFExtensionLink(TiXmlElement *_elem, const std::string &_linkName)
 {
-  for (StringSDFExtensionPtrMap::iterator
-       sdfIt = g_extensions.begin();
-       sdfIt != g_extensions.end(); ++sdfIt)
+  auto sdfIt = g_conversion->extensions.find(_linkName);
+  if (sdfIt != g_conversion->extensions.end())
   {
-    if (sdfIt->first == _linkName)
+    sdfdbg << "inserting extension with reference ["
+           << _linkName << "] into link.\n";
+    ChildIndex children(_elem);
+    for (std::vector<SDFExtensionPtr>::iterator ge =
+        sdfIt->second.begin(); ge != sdfIt->second.end(); ++ge)
     {
-      sdfdbg << "inserting extension with reference ["
-             << _linkName << "] into link.\n";
-      for (std::vector<SDFExtensionPtr>::iterator ge =
-          sdfIt->second.begin(); ge != sdfIt->second.end(); ++ge)
+      // insert gravity
+      if ((*ge)->gravity)
       {
-        // insert gravity
-        if ((*ge)->gravity)
-        {
-          AddKeyValue(_elem, "gravity", "true");
-        }
-        else
-        {
-          AddKeyValue(_elem, "gravity", "false");
-        }
+        AddKeyValue(children, "gravity", "true");
+      }
+      else
+      {
+        AddKeyValue(children, "gravity", "false");
+      }
 
-        // damping factor
-        TiXmlElement *velocityDecay = new TiXmlElement("velocity_decay");
-        if ((*ge)->isDampingFactor)
-        {
-          /// @todo separate linear and angular velocity decay
-          AddKeyValue(velocityDecay, "linear",
-                      Values2str(1, &(*ge)->dampingFactor));
-          AddKeyValue(velocityDecay, "angular",
-                      Values2str(1, &(*ge)->dampingFactor));
-        }
-        _elem->LinkEndChild(velocityDecay);
-        // selfCollide tag
-        if ((*ge)->isSelfCollide)
-        {
-          AddKeyValue(_elem, "self_collide", (*ge)->selfCollide ? "1" : "0");
-        }
-        // insert blobs into body
-        for (std::vector<TiXmlElementPtr>::iterator
-            blobIt = (*ge)->blobs.begin();
-            blobIt != (*ge)->blobs.end(); ++blobIt)
-        {
-          _elem->LinkEndChild((*blobIt)->Clone());
-        }
+      // damping factor
+      TiXmlElement *velocityDecay = new TiXmlElement("velocity_decay");
+      if ((*ge)->isDampingFactor)
+      {
+        /// @todo separate linear and angular velocity decay
+        AddKeyValue(velocityDecay, "linear",
+                    Values2str(1, &(*ge)->dampingFactor));
+        AddKeyValue(velocityDecay, "angular",
+                    Values2str(1, &(*ge)->dampingFactor));
+      }
+      children.Append(velocityDecay);
+      // selfCollide tag
+      if ((*ge)->isSelfCollide)
+      {
+        AddKeyValue(children, "self_collide",
+                    (*ge)->selfCollide ? "1" : "0");
+      }
+      // insert blobs into body
+      for (std::vector<TiXmlElementPtr>::iterator
+          blobIt = (*ge)->blobs.begin();
+          blobIt != (*ge)->blobs.end(); ++blobIt)
+      {
+        children.Append((*blobIt)->Clone());
       }
     }
   }
@@ -2110,144 +2558,141 @@ void InsertSDFExtensionLink(TiXmlElement *_elem, const std::string &_linkName)
 void InsertSDFExtensionJoint(TiXmlElement *_elem,
                              const std::string &_jointName)
 {
-  for (StringSDFExtensionPtrMap::iterator
-      sdfIt = g_extensions.begin();
-      sdfIt != g_extensions.end(); ++sdfIt)
+  auto sdfIt = g_conversion->extensions.find(_jointName);
+  if (sdfIt != g_conversion->extensions.end())
   {
-    if (sdfIt->first == _jointName)
+    ChildIndex children(_elem);
+    for (std::vector<SDFExtensionPtr>::iterator
+        ge = sdfIt->second.begin();
+        ge != sdfIt->second.end(); ++ge)
     {
-      for (std::vector<SDFExtensionPtr>::iterator
-          ge = sdfIt->second.begin();
-          ge != sdfIt->second.end(); ++ge)
+      TiXmlElement *physics = children.First("physics");
+      bool newPhysics = false;
+      if (physics == nullptr)
       {
-        TiXmlElement *physics = _elem->FirstChildElement("physics");
-        bool newPhysics = false;
-        if (physics == nullptr)
-        {
-          physics = new TiXmlElement("physics");
-          newPhysics = true;
-        }
+        physics = new TiXmlElement("physics");
+        newPhysics = true;
+      }
 
-        TiXmlElement *physicsOde = physics->FirstChildElement("ode");
-        bool newPhysicsOde = false;
-        if (physicsOde == nullptr)
-        {
-          physicsOde = new TiXmlElement("ode");
-          newPhysicsOde = true;
-        }
+      TiXmlElement *physicsOde = physics->FirstChildElement("ode");
+      bool newPhysicsOde = false;
+      if (physicsOde == nullptr)
+      {
+        physicsOde = new TiXmlElement("ode");
+        newPhysicsOde = true;
+      }
 
-        TiXmlElement *limit = physicsOde->FirstChildElement("limit");
-        bool newLimit = false;
-        if (limit == nullptr)
-        {
-          limit = new TiXmlElement("limit");
-          newLimit = true;
-        }
+      TiXmlElement *limit = physicsOde->FirstChildElement("limit");
+      bool newLimit = false;
+      if (limit == nullptr)
+      {
+        limit = new TiXmlElement("limit");
+        newLimit = true;
+      }
 
-        TiXmlElement *axis = _elem->FirstChildElement("axis");
-        bool newAxis = false;
-        if (axis == nullptr)
-        {
-          axis = new TiXmlElement("axis");
-          newAxis = true;
-        }
+      TiXmlElement *axis = children.First("axis");
+      bool newAxis = false;
+      if (axis == nullptr)
+      {
+        axis = new TiXmlElement("axis");
+        newAxis = true;
+      }
 
-        TiXmlElement *dynamics = axis->FirstChildElement("dynamics");
-        bool newDynamics = false;
-        if (dynamics == nullptr)
-        {
-          dynamics = new TiXmlElement("dynamics");
-          newDynamics = true;
-        }
+      TiXmlElement *dynamics = axis->FirstChildElement("dynamics");
+      bool newDynamics = false;
+      if (dynamics == nullptr)
+      {
+        dynamics = new TiXmlElement("dynamics");
+        newDynamics = true;
+      }
 
-        // insert stopCfm, stopErp, fudgeFactor
-        if ((*ge)->isStopCfm)
-        {
-          AddKeyValue(limit, "cfm", Values2str(1, &(*ge)->stopCfm));
-        }
-        if ((*ge)->isStopErp)
-        {
-          AddKeyValue(limit, "erp", Values2str(1, &(*ge)->stopErp));
-        }
-        if ((*ge)->isSpringReference)
+      // insert stopCfm, stopErp, fudgeFactor
+      if ((*ge)->isStopCfm)
+      {
+        AddKeyValue(limit, "cfm", Values2str(1, &(*ge)->stopCfm));
+      }
+      if ((*ge)->isStopErp)
+      {
+        AddKeyValue(limit, "erp", Values2str(1, &(*ge)->stopErp));
+      }
+      if ((*ge)->isSpringReference)
+      {
+        AddKeyValue(dynamics, "spring_reference",
+                    Values2str(1, &(*ge)->springReference));
+      }
+      if ((*ge)->isSpringStiffness)
+      {
+        AddKeyValue(dynamics, "spring_stiffness",
+                    Values2str(1, &(*ge)->springStiffness));
+      }
+
+      // insert provideFeedback
+      if ((*ge)->isProvideFeedback)
+      {
+        if ((*ge)->provideFeedback)
         {
-          AddKeyValue(dynamics, "spring_reference",
-                      Values2str(1, &(*ge)->springReference));
+          AddKeyValue(physics, "provide_feedback", "true");
+          AddKeyValue(physicsOde, "provide_feedback", "true");
         }
-        if ((*ge)->isSpringStiffness)
+        else
         {
-          AddKeyValue(dynamics, "spring_stiffness",
-                      Values2str(1, &(*ge)->springStiffness));
+          AddKeyValue(physics, "provide_feedback", "false");
+          AddKeyValue(physicsOde, "provide_feedback", "false");
         }
+      }
 
-        // insert provideFeedback
-        if ((*ge)->isProvideFeedback)
+      // insert implicitSpringDamper
+      if ((*ge)->isImplicitSpringDamper)
+      {
+        if ((*ge)->implicitSpringDamper)
         {
-          if ((*ge)->provideFeedback)
-          {
-            AddKeyValue(physics, "provide_feedback", "true");
-            AddKeyValue(physicsOde, "provide_feedback", "true");
-          }
-          else
-          {
-            AddKeyValue(physics, "provide_feedback", "false");
-            AddKeyValue(physicsOde, "provide_feedback", "false");
-          }
+          AddKeyValue(physicsOde, "implicit_spring_damper", "true");
+          /// \TODO: deprecating cfm_damping, transitional tag below
+          AddKeyValue(physicsOde, "cfm_damping", "true");
         }
-
-        // insert implicitSpringDamper
-        if ((*ge)->isImplicitSpringDamper)
+        else
         {
-          if ((*ge)->implicitSpringDamper)
-          {
-            AddKeyValue(physicsOde, "implicit_spring_damper", "true");
-            /// \TODO: deprecating cfm_damping, transitional tag below
-            AddKeyValue(physicsOde, "cfm_damping", "true");
-          }
-          else
-          {
-            AddKeyValue(physicsOde, "implicit_spring_damper", "false");
-            /// \TODO: deprecating cfm_damping, transitional tag below
-            AddKeyValue(physicsOde, "cfm_damping", "false");
-          }
+          AddKeyValue(physicsOde, "implicit_spring_damper", "false");
+          /// \TODO: deprecating cfm_damping, transitional tag below
+          AddKeyValue(physicsOde, "cfm_damping", "false");
         }
+      }
 
-        // insert fudgeFactor
-        if ((*ge)->isFudgeFactor)
-        {
-          AddKeyValue(physicsOde, "fudge_factor",
-                      Values2str(1, &(*ge)->fudgeFactor));
-        }
+      // insert fudgeFactor
+      if ((*ge)->isFudgeFactor)
+      {
+        AddKeyValue(physicsOde, "fudge_factor",
+                    Values2str(1, &(*ge)->fudgeFactor));
+      }
 
-        if (newDynamics)
-        {
-          axis->LinkEndChild(dynamics);
-        }
-        if (newAxis)
-        {
-          _elem->LinkEndChild(axis);
-        }
+      if (newDynamics)
+      {
+        axis->LinkEndChild(dynamics);
+      }
+      if (newAxis)
+      {
+        children.Append(axis);
+      }
 
-        if (newLimit)
-        {
-          physicsOde->LinkEndChild(limit);
-        }
-        if (newPhysicsOde)
-        {
-          physics->LinkEndChild(physicsOde);
-        }
-        if (newPhysics)
-        {
-          _elem->LinkEndChild(physics);
-        }
+      if (newLimit)
+      {
+        physicsOde->LinkEndChild(limit);
+      }
+      if (newPhysicsOde)
+      {
+        physics->LinkEndChild(physicsOde);
+      }
+      if (newPhysics)
+      {
+        children.Append(physics);
+      }
 
-        // insert all additional blobs into joint
-        for (std::vector<TiXmlElementPtr>::iterator
-            blobIt = (*ge)->blobs.begin();
-            blobIt != (*ge)->blobs.end(); ++blobIt)
-        {
-          _elem->LinkEndChild((*blobIt)->Clone());
-        }
+      // insert all additional blobs into joint
+      for (std::vector<TiXmlElementPtr>::iterator
+          blobIt = (*ge)->blobs.begin();
+          blobIt != (*ge)->blobs.end(); ++blobIt)
+      {
+        children.Append((*blobIt)->Clone());
       }
     }
   }
@@ -2256,35 +2701,30 @@ void InsertSDFExtensionJoint(TiXmlElement *_elem,
 ////////////////////////////////////////////////////////////////////////////////
 void InsertSDFExtensionRobot(TiXmlElement *_elem)
 {
-  for (StringSDFExtensionPtrMap::iterator
-      sdfIt = g_extensions.begin();
-      sdfIt != g_extensions.end(); ++sdfIt)
+  auto sdfIt = g_conversion->extensions.find("");
+  if (sdfIt != g_conversion->extensions.end())
   {
-    if (sdfIt->first.empty())
+    // no reference specified
+    ChildIndex children(_elem);
+    for (std::vector<SDFExtensionPtr>::iterator
+        ge = sdfIt->second.begin(); ge != sdfIt->second.end(); ++ge)
     {
-      // no reference specified
-      for (std::vector<SDFExtensionPtr>::iterator
-          ge = sdfIt->second.begin(); ge != sdfIt->second.end(); ++ge)
+      // insert static flag
+      if ((*ge)->setStaticFlag)
       {
-        // insert static flag
-        if ((*ge)->setStaticFlag)
-        {
-          AddKeyValue(_elem, "static", "true");
-        }
-        else
-        {
-          AddKeyValue(_elem, "static", "false");
-        }
+        AddKeyValue(children, "static", "true");
+      }
+      else
+      {
+        AddKeyValue(children, "static", "false");
+      }
 
-        // copy extension containing blobs and without reference
-        for (std::vector<TiXmlElementPtr>::iterator
-            blobIt = (*ge)->blobs.begin();
-            blobIt != (*ge)->blobs.end(); ++blobIt)
-        {
-          std::ostringstream streamIn;
-          streamIn << *(*blobIt);
-          _elem->LinkEndChild((*blobIt)->Clone());
-        }
+      // copy extension containing blobs and without reference
+      for (std::vector<TiXmlElementPtr>::iterator
+          blobIt = (*ge)->blobs.begin();
+          blobIt != (*ge)->blobs.end(); ++blobIt)
+      {
+        children.Append((*blobIt)->Clone());
       }
     }
   }
@@ -2358,36 +2798,20 @@ void CreateGeometry(TiXmlElement* _elem, urdf::GeometrySharedPtr _geometry)
           //   sdfwarn << "filename referred by mesh ["
           //          << mesh->filename << "] does not appear to exist.\n";
 
-          // Convert package:// to model://,
-          // in ROS, this will work if
-          // the model package is in ROS_PACKAGE_PATH and has a manifest.xml
-          // as a typical ros package does.
-          std::string modelFilename = mesh->filename;
-          std::string packagePrefix("package://");
-          std::string modelPrefix("model://");
-          size_t pos1 = modelFilename.find(packagePrefix, 0);
-          if (pos1 != std::string::npos)
-          {
-            size_t repLen = packagePrefix.size();
-            modelFilename.replace(pos1, repLen, modelPrefix);
-            // sdfwarn << "ros style uri [package://] is"
-            //   << "automatically converted: [" << modelFilename
-            //   << "], make sure your ros package is in GAZEBO_MODEL_PATH"
-            //   << " and switch your manifest to conform to sdf's"
-            //   << " model database format.  See ["
-            //   << "http://sdfsim.org/wiki/Model_database#Model_Manifest_XML"
-            //   << "] for more info.\n";
-          }
-
           // add mesh filename
-          AddKeyValue(geometryType, "uri", modelFilename);
+          AddKeyValue(geometryType, "uri", MeshUri(mesh->filename));
         }
       }
       break;
     default:
-      sdfwarn << "Unknown body type: [" << static_cast<int>(_geometry->type)
-              << "] skipped in geometry\n";
+    {
+      const std::string message = "Unknown body type: [" +
+          std::to_string(static_cast<int>(_geometry->type)) +
+          "] skipped in geometry\n";
+      if (warningAllowed("urdf unknown geometry", message))
+        sdfwarn << message;
       break;
+    }
   }
 
   if (geometryType)
@@ -2461,81 +2885,189 @@ ignition::math::Pose3d inverseTransformToParentFrame(
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-void ReduceSDFExtensionToParent(urdf::LinkSharedPtr _link)
+void ReduceSDFExtensionsToParents(
+    const std::vector<urdf::LinkSharedPtr> &_reducedLinks)
 {
-  /// \todo: move to header
-  /// Take the link's existing list of gazebo extensions, transfer them
-  /// into parent link.  Along the way, update local transforms by adding
-  /// the additional transform to parent.  Also, look through all
-  /// referenced link names with plugins and update references to current
-  /// link to the parent link. (reduceGazeboExtensionFrameReplace())
-
   /// @todo: this is a very complicated module that updates the plugins
   /// based on fixed joint reduction really wish this could be a lot cleaner
+  if (_reducedLinks.empty())
+  {
+    return;
+  }
 
-  std::string linkName = _link->name;
-
-  // update extension map with references to linkName
-  // this->ListSDFExtensions();
-  StringSDFExtensionPtrMap::iterator ext = g_extensions.find(linkName);
-  if (ext != g_extensions.end())
+  // order of the reduction of each reduced link
+  std::unordered_map<std::string, size_t> reductionOrder;
+  for (size_t i = 0; i < _reducedLinks.size(); ++i)
   {
-    sdfdbg << "  REDUCE EXTENSION: moving reference from ["
-           << linkName << "] to [" << _link->getParent()->name << "]\n";
+    reductionOrder[_reducedLinks[i]->name] = i;
+  }
 
-    // update reduction transform (for rays, cameras for now).
-    //   FIXME: contact frames too?
-    for (std::vector<SDFExtensionPtr>::iterator ge = ext->second.begin();
-         ge != ext->second.end(); ++ge)
+  for (StringSDFExtensionPtrMap::iterator
+       sdfIt = g_conversion->extensions.begin();
+       sdfIt != g_conversion->extensions.end(); ++sdfIt)
+  {
+    // the reductions that move these extensions, which are the ones of
+    // the reference link and of its reduced ancestors
+    std::vector<size_t> chain;
+    for (auto order = reductionOrder.find(sdfIt->first);
+         order != reductionOrder.end();
+         order = reductionOrder.find(
+             _reducedLinks[order->second]->getParent()->name))
     {
-      (*ge)->reductionTransform = TransformToParentFrame(
-          (*ge)->reductionTransform,
-          _link->parent_joint->parent_to_joint_origin_transform);
-      // for sensor and projector blocks only
-      ReduceSDFExtensionsTransform((*ge));
+      chain.push_back(order->second);
     }
 
-    // find pointer to the existing extension with the new _link reference
-    std::string parentLinkName = _link->getParent()->name;
-    auto parentExt = g_extensions.find(parentLinkName);
-
-    // if none exist, create new extension with parentLinkName
-    if (parentExt == g_extensions.end())
+    for (std::vector<SDFExtensionPtr>::iterator ge = sdfIt->second.begin();
+         ge != sdfIt->second.end(); ++ge)
     {
-      std::vector<SDFExtensionPtr> ge;
-      g_extensions.insert(std::make_pair(parentLinkName, ge));
-      parentExt = g_extensions.find(parentLinkName);
+      // reduction transform after each reduction of the chain (for
+      // contacts, rays, cameras for now).
+      //   FIXME: contact frames too?
+      std::vector<ignition::math::Pose3d> transforms;
+      transforms.reserve(chain.size());
+      ignition::math::Pose3d transform = (*ge)->reductionTransform;
+      for (size_t order : chain)
+      {
+        transform = TransformToParentFrame(transform,
+            _reducedLinks[order]->parent_joint->
+            parent_to_joint_origin_transform);
+        transforms.push_back(transform);
+      }
+
+      // for extensions with any reference, search and replace reduced
+      // _link names within the plugins with new _link names, in the order
+      // of the reductions, and assign the reduction transform as it is
+      // after that reduction
+      for (std::vector<TiXmlElementPtr>::iterator blobIt =
+           (*ge)->blobs.begin(); blobIt != (*ge)->blobs.end(); ++blobIt)
+      {
+        size_t next = 0;
+        while (true)
+        {
+          size_t order = _reducedLinks.size();
+          for (const std::string &name : ReferencedLinkNames(blobIt->get()))
+          {
+            auto iter = reductionOrder.find(name);
+            if (iter != reductionOrder.end() && iter->second >= next &&
+                iter->second < order)
+            {
+              order = iter->second;
+            }
+          }
+          if (order == _reducedLinks.size())
+          {
+            break;
+          }
+
+          transform = (*ge)->reductionTransform;
+          for (size_t i = 0; i < chain.size() && chain[i] <= order; ++i)
+          {
+            transform = transforms[i];
+          }
+          ReduceSDFExtensionFrameReplace(blobIt, _reducedLinks[order],
+                                         transform);
+          next = order + 1;
+        }
+      }
+
+      if (!chain.empty())
+      {
+        (*ge)->reductionTransform = transforms.back();
+        // for sensor and projector blocks only
+        ReduceSDFExtensionsTransform((*ge));
+      }
     }
+  }
 
-    // move sdf extensions from _link into the parent _link's extensions
-    for (std::vector<SDFExtensionPtr>::iterator ge = ext->second.begin();
-         ge != ext->second.end(); ++ge)
+  // move sdf extensions of each reduced _link into the parent _link's
+  // extensions, in the order of the reductions, so that the extensions of
+  // a link are followed by the ones lumped into it
+  for (const urdf::LinkSharedPtr &link : _reducedLinks)
+  {
+    StringSDFExtensionPtrMap::iterator ext =
+        g_conversion->extensions.find(link->name);
+    if (ext == g_conversion->extensions.end())
     {
-      parentExt->second.push_back(*ge);
+      continue;
     }
+
+    std::string parentLinkName = link->getParent()->name;
+    sdfdbg << "  REDUCE EXTENSION: moving reference from ["
+           << link->name << "] to [" << parentLinkName << "]\n";
+
+    // create the extensions of parentLinkName if none exist
+    std::vector<SDFExtensionPtr> &parentExt =
+        g_conversion->extensions[parentLinkName];
+    parentExt.insert(parentExt.end(), ext->second.begin(),
+                     ext->second.end());
     ext->second.clear();
   }
+}
 
-  // for extensions with empty reference, search and replace
-  // _link name patterns within the plugin with new _link name
-  // and assign the proper reduction transform for the _link name pattern
-  for (StringSDFExtensionPtrMap::iterator sdfIt = g_extensions.begin();
-       sdfIt != g_extensions.end(); ++sdfIt)
+////////////////////////////////////////////////////////////////////////////////
+std::vector<std::string> ReferencedLinkNames(TiXmlElement *_blob)
+{
+  std::vector<std::string> names;
+  auto addName = [&names](TiXmlNode *_key)
   {
-    // update reduction transform (for contacts, rays, cameras for now).
-    for (std::vector<SDFExtensionPtr>::iterator ge = sdfIt->second.begin();
-         ge != sdfIt->second.end(); ++ge)
+    if (_key && _key->ToElement())
+    {
+      names.push_back(GetKeyValueAsString(_key->ToElement()));
+    }
+  };
+
+  if (_blob->ValueStr() == "sensor")
+  {
+    // <contact><collision>[link name]_collision</collision></contact>
+    TiXmlNode *contact = _blob->FirstChild("contact");
+    TiXmlNode *collision =
+        contact ? contact->FirstChild("collision") : nullptr;
+    if (collision && collision->ToElement())
     {
-      ReduceSDFExtensionFrameReplace(*ge, _link);
+      std::string name = GetKeyValueAsString(collision->ToElement());
+      if (name.size() > g_collisionExt.size() &&
+          name.compare(name.size() - g_collisionExt.size(),
+                       g_collisionExt.size(), g_collisionExt) == 0)
+      {
+        name.resize(name.size() - g_collisionExt.size());
+        names.push_back(name);
+      }
     }
   }
+  else if (_blob->ValueStr() == "plugin")
+  {
+    addName(_blob->FirstChild("bodyName"));
+    addName(_blob->FirstChild("frameName"));
+  }
+  else if (_blob->ValueStr() == "gripper")
+  {
+    addName(_blob->FirstChild("gripper_link"));
+    addName(_blob->FirstChild("palm_link"));
+  }
+  else if (_blob->ValueStr() == "joint")
+  {
+    addName(_blob->FirstChild("parent"));
+    addName(_blob->FirstChild("child"));
+  }
 
-  // this->ListSDFExtensions();
+  // <projector>[link name]/[projector name]</projector>
+  TiXmlNode *projector = _blob->FirstChild("projector");
+  if (projector && projector->ToElement())
+  {
+    std::string name = GetKeyValueAsString(projector->ToElement());
+    size_t pos = name.find("/");
+    // a name without slash is reported by
+    // ReduceSDFExtensionProjectorFrameReplace
+    names.push_back(pos == std::string::npos ? name : name.substr(0, pos));
+  }
+  return names;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-void ReduceSDFExtensionFrameReplace(SDFExtensionPtr _ge,
-                                    urdf::LinkSharedPtr _link)
+void ReduceSDFExtensionFrameReplace(
+    std::vector<TiXmlElementPtr>::iterator _blobIt,
+    urdf::LinkSharedPtr _link,
+    const ignition::math::Pose3d &_reductionTransform)
 {
   std::string linkName = _link->name;
   std::string parentLinkName = _link->getParent()->name;
@@ -2548,30 +3080,17 @@ void ReduceSDFExtensionFrameReplace(SDFExtensionPtr _ge,
   //         <collision>base_footprint_collision</collision>
   sdfdbg << "  STRING REPLACE: instances of _link name ["
          << linkName << "] with [" << parentLinkName << "]\n";
-  for (std::vector<TiXmlElementPtr>::iterator blobIt = _ge->blobs.begin();
-       blobIt != _ge->blobs.end(); ++blobIt)
-  {
-    std::ostringstream debugStreamIn;
-    debugStreamIn << *(*blobIt);
-    std::string debugBlob = debugStreamIn.str();
-    sdfdbg << "        INITIAL STRING link ["
-           << linkName << "]-->[" << parentLinkName << "]: ["
-           << debugBlob << "]\n";
-
-    ReduceSDFExtensionContactSensorFrameReplace(blobIt, _link);
-    ReduceSDFExtensionPluginFrameReplace(blobIt, _link,
-                                         "plugin", "bodyName",
-                                         _ge->reductionTransform);
-    ReduceSDFExtensionPluginFrameReplace(blobIt, _link,
-                                         "plugin", "frameName",
-                                         _ge->reductionTransform);
-    ReduceSDFExtensionProjectorFrameReplace(blobIt, _link);
-    ReduceSDFExtensionGripperFrameReplace(blobIt, _link);
-    ReduceSDFExtensionJointFrameReplace(blobIt, _link);
 
-    std::ostringstream debugStreamOut;
-    debugStreamOut << *(*blobIt);
-  }
+  ReduceSDFExtensionContactSensorFrameReplace(_blobIt, _link);
+  ReduceSDFExtensionPluginFrameReplace(_blobIt, _link,
+                                       "plugin", "bodyName",
+                                       _reductionTransform);
+  ReduceSDFExtensionPluginFrameReplace(_blobIt, _link,
+                                       "plugin", "frameName",
+                                       _reductionTransform);
+  ReduceSDFExtensionProjectorFrameReplace(_blobIt, _link);
+  ReduceSDFExtensionGripperFrameReplace(_blobIt, _link);
+  ReduceSDFExtensionJointFrameReplace(_blobIt, _link);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -2592,8 +3111,8 @@ void ReduceSDFExtensionsTransform(SDFExtensionPtr _ge)
 void URDF2SDF::ListSDFExtensions()
 {
   for (StringSDFExtensionPtrMap::iterator
-      sdfIt = g_extensions.begin();
-      sdfIt != g_extensions.end(); ++sdfIt)
+      sdfIt = this->dataPtr->extensions.begin();
+      sdfIt != this->dataPtr->extensions.end(); ++sdfIt)
   {
     int extCount = 0;
     for (std::vector<SDFExtensionPtr>::iterator ge = sdfIt->second.begin();
@@ -2621,8 +3140,8 @@ void URDF2SDF::ListSDFExtensions()
 void URDF2SDF::ListSDFExtensions(const std::string &_reference)
 {
   for (StringSDFExtensionPtrMap::iterator
-      sdfIt = g_extensions.begin();
-      sdfIt != g_extensions.end(); ++sdfIt)
+      sdfIt = this->dataPtr->extensions.begin();
+      sdfIt != this->dataPtr->extensions.end(); ++sdfIt)
   {
     if (sdfIt->first == _reference)
     {
@@ -2645,7 +3164,8 @@ void URDF2SDF::ListSDFExtensions(const std::string &_reference)
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-void CreateSDF(TiXmlElement *_root,
+template <typename ElemT>
+void CreateSDF(ElemT _root,
                urdf::LinkConstSharedPtr _link,
                const ignition::math::Pose3d &_transform)
 {
@@ -2688,7 +3208,7 @@ void CreateSDF(TiXmlElement *_root,
 
   // create <body:...> block for non fixed joint attached bodies
   if ((_link->getParent() && _link->getParent()->name == "world") ||
-      !g_reduceFixedJoints ||
+      !g_conversion->reduceFixedJoints ||
       (!_link->parent_joint ||
        !FixedJointShouldBeReduced(_link->parent_joint)))
   {
@@ -2780,7 +3300,8 @@ void CreateLink(TiXmlElement *_root,
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-void CreateCollisions(TiXmlElement* _elem,
+template <typename ElemT>
+void CreateCollisions(ElemT _elem,
                       urdf::LinkConstSharedPtr _link)
 {
   // loop through all collisions in
@@ -2811,10 +3332,7 @@ void CreateCollisions(TiXmlElement* _elem,
 
     if (collisionCount > 0)
     {
-      std::ostringstream collisionNameStream;
-      collisionNameStream << collisionName
-                          << "_" << collisionCount;
-      collisionName = collisionNameStream.str();
+      collisionName += "_" + std::to_string(collisionCount);
     }
 
     // make a <collision> block
@@ -2825,7 +3343,8 @@ void CreateCollisions(TiXmlElement* _elem,
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-void CreateVisuals(TiXmlElement* _elem,
+template <typename ElemT>
+void CreateVisuals(ElemT _elem,
                    urdf::LinkConstSharedPtr _link)
 {
   // loop through all visuals in
@@ -2856,10 +3375,7 @@ void CreateVisuals(TiXmlElement* _elem,
 
     if (visualCount > 0)
     {
-      std::ostringstream visualNameStream;
-      visualNameStream << visualName
-                       << "_" << visualCount;
-      visualName = visualNameStream.str();
+      visualName += "_" + std::to_string(visualCount);
     }
 
     // make a <visual> block
@@ -2913,54 +3429,8 @@ void CreateJoint(TiXmlElement *_root,
                  ignition::math::Pose3d &/*_currentTransform*/)
 {
   // compute the joint tag
-  std::string jtype;
-  jtype.clear();
-  if (_link->parent_joint != nullptr)
-  {
-    switch (_link->parent_joint->type)
-    {
-      case urdf::Joint::CONTINUOUS:
-      case urdf::Joint::REVOLUTE:
-        jtype = "revolute";
-        break;
-      case urdf::Joint::PRISMATIC:
-        jtype = "prismatic";
-        break;
-      case urdf::Joint::FLOATING:
-      case urdf::Joint::PLANAR:
-        break;
-      case urdf::Joint::FIXED:
-        jtype = "fixed";
-        break;
-      default:
-        sdfwarn << "Unknown joint type: ["
-                << static_cast<int>(_link->parent_joint->type)
-                << "] in link [" << _link->name << "]\n";
-        break;
-    }
-  }
-
-  // If this is a fixed joint and the legacy option disableFixedJointLumping
-  // is present and the new option preserveFixedJoint is not, then the fixed
-  // joint should be converted to a revolute joint with max and mim position
-  // limits set to (0, 0) for backward compatibility
   bool fixedJointConvertedToRevoluteJoint = false;
-  if (jtype == "fixed")
-  {
-    fixedJointConvertedToRevoluteJoint =
-      (g_fixedJointsTransformedInRevoluteJoints.find(_link->parent_joint->name)
-       != g_fixedJointsTransformedInRevoluteJoints.end());
-  }
-
-  // skip if joint type is fixed and it is lumped
-  //   skip/return with the exception of root link being world,
-  //   because there's no lumping there
-  if (_link->getParent() && _link->getParent()->name != "world"
-      && FixedJointShouldBeReduced(_link->parent_joint)
-      && g_reduceFixedJoints)
-  {
-    return;
-  }
+  std::string jtype = JointType(_link, fixedJointConvertedToRevoluteJoint);
 
   if (!jtype.empty())
   {
@@ -3014,7 +3484,7 @@ void CreateJoint(TiXmlElement *_root,
                     Values2str(1, &_link->parent_joint->dynamics->friction));
       }
 
-      if (g_enforceLimits && _link->parent_joint->limits)
+      if (g_conversion->enforceLimits && _link->parent_joint->limits)
       {
         if (jtype == "slider")
         {
@@ -3093,16 +3563,7 @@ void CreateCollision(TiXmlElement* _elem, urdf::LinkConstSharedPtr _link,
   // set its name, if lumped, add original link name
   // for meshes in an original mesh, it's likely
   // _link->name + mesh count
-  if (_oldLinkName.compare(0, _link->name.size(), _link->name) == 0 ||
-      _oldLinkName.empty())
-  {
-    sdfCollision->SetAttribute("name", _oldLinkName);
-  }
-  else
-  {
-    sdfCollision->SetAttribute("name", _link->name
-        + g_lumpPrefix + _oldLinkName);
-  }
+  sdfCollision->SetAttribute("name", LumpedName(_link, _oldLinkName));
 
   // std::cerr << "collision [" << sdfCollision->Attribute("name") << "]\n";
 
@@ -3140,15 +3601,7 @@ void CreateVisual(TiXmlElement *_elem, urdf::LinkConstSharedPtr _link,
   TiXmlElement *sdfVisual = new TiXmlElement("visual");
 
   // set its name
-  if (_oldLinkName.compare(0, _link->name.size(), _link->name) == 0 ||
-      _oldLinkName.empty())
-  {
-    sdfVisual->SetAttribute("name", _oldLinkName);
-  }
-  else
-  {
-    sdfVisual->SetAttribute("name", _link->name + g_lumpPrefix + _oldLinkName);
-  }
+  sdfVisual->SetAttribute("name", LumpedName(_link, _oldLinkName));
 
   // add the visualisation transfrom
   double pose[6];
@@ -3176,11 +3629,400 @@ void CreateVisual(TiXmlElement *_elem, urdf::LinkConstSharedPtr _link,
   _elem->LinkEndChild(sdfVisual);
 }
 
+////////////////////////////////////////////////////////////////////////////////
+std::string LumpedName(urdf::LinkConstSharedPtr _link,
+                       const std::string &_name)
+{
+  if (_name.compare(0, _link->name.size(), _link->name) == 0 ||
+      _name.empty())
+  {
+    return _name;
+  }
+  return _link->name + g_lumpPrefix + _name;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+std::string MeshUri(const std::string &_filename)
+{
+  // Convert package:// to model://,
+  // in ROS, this will work if
+  // the model package is in ROS_PACKAGE_PATH and has a manifest.xml
+  // as a typical ros package does.
+  std::string modelFilename = _filename;
+  std::string packagePrefix("package://");
+  std::string modelPrefix("model://");
+  size_t pos1 = modelFilename.find(packagePrefix, 0);
+  if (pos1 != std::string::npos)
+  {
+    size_t repLen = packagePrefix.size();
+    modelFilename.replace(pos1, repLen, modelPrefix);
+    // sdfwarn << "ros style uri [package://] is"
+    //   << "automatically converted: [" << modelFilename
+    //   << "], make sure your ros package is in GAZEBO_MODEL_PATH"
+    //   << " and switch your manifest to conform to sdf's"
+    //   << " model database format.  See ["
+    //   << "http://sdfsim.org/wiki/Model_database#Model_Manifest_XML"
+    //   << "] for more info.\n";
+  }
+  return modelFilename;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+std::string JointType(urdf::LinkConstSharedPtr _link,
+                      bool &_fixedToRevolute)
+{
+  std::string jtype;
+  _fixedToRevolute = false;
+  if (_link->parent_joint != nullptr)
+  {
+    switch (_link->parent_joint->type)
+    {
+      case urdf::Joint::CONTINUOUS:
+      case urdf::Joint::REVOLUTE:
+        jtype = "revolute";
+        break;
+      case urdf::Joint::PRISMATIC:
+        jtype = "prismatic";
+        break;
+      case urdf::Joint::FLOATING:
+      case urdf::Joint::PLANAR:
+        break;
+      case urdf::Joint::FIXED:
+        jtype = "fixed";
+        break;
+      default:
+        sdfwarn << "Unknown joint type: ["
+                << static_cast<int>(_link->parent_joint->type)
+                << "] in link [" << _link->name << "]\n";
+        break;
+    }
+  }
+
+  // If this is a fixed joint and the legacy option disableFixedJointLumping
+  // is present and the new option preserveFixedJoint is not, then the fixed
+  // joint should be converted to a revolute joint with max and mim position
+  // limits set to (0, 0) for backward compatibility
+  if (jtype == "fixed")
+  {
+    _fixedToRevolute =
+      (g_conversion->fixedJointsTransformedInRevoluteJoints.find(
+         _link->parent_joint->name)
+       != g_conversion->fixedJointsTransformedInRevoluteJoints.end());
+  }
+
+  // skip if joint type is fixed and it is lumped
+  //   skip/return with the exception of root link being world,
+  //   because there's no lumping there
+  if (_link->getParent() && _link->getParent()->name != "world"
+      && FixedJointShouldBeReduced(_link->parent_joint)
+      && g_conversion->reduceFixedJoints)
+  {
+    return "";
+  }
+
+  return jtype;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+ElementPtr AddChildElement(ElementPtr _parent, const std::string &_name)
+{
+  ElementPtr desc = _parent->GetElementDescription(_name);
+  if (!desc)
+  {
+    // Not reached for the elements of a URDF conversion, but keep the
+    // tree usable if the description does not have the element.
+    return _parent->AddElement(_name);
+  }
+
+  ElementPtr child = desc->Clone();
+  child->SetParent(_parent);
+  _parent->InsertElement(child);
+  return child;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+template <typename T>
+void AddKeyValue(ElementPtr _elem, const std::string &_key, const T &_value)
+{
+  AddChildElement(_elem, _key)->GetValue()->Set(_value);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void AddRequiredElements(ElementPtr _elem)
+{
+  for (const ElementPtr &child : _elem->Children())
+  {
+    AddRequiredElements(child);
+  }
+
+  for (unsigned int i = 0; i < _elem->GetElementDescriptionCount(); ++i)
+  {
+    ElementPtr desc = _elem->GetElementDescription(i);
+    if ((desc->GetRequired() == "1" || desc->GetRequired() == "+") &&
+        !_elem->HasElement(desc->GetName()))
+    {
+      _elem->AddElement(desc->GetName());
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+ignition::math::Pose3d RpyPose(const urdf::Pose &_pose)
+{
+  double roll, pitch, yaw;
+  _pose.rotation.getRPY(roll, pitch, yaw);
+  return ignition::math::Pose3d(_pose.position.x, _pose.position.y,
+      _pose.position.z, roll, pitch, yaw);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void CreateGeometry(ElementPtr _elem, urdf::GeometrySharedPtr _geometry)
+{
+  switch (_geometry->type)
+  {
+    case urdf::Geometry::BOX:
+      {
+        urdf::BoxConstSharedPtr box =
+          urdf::dynamic_pointer_cast<urdf::Box>(_geometry);
+        ElementPtr shape =
+          AddChildElement(AddChildElement(_elem, "geometry"), "box");
+        AddKeyValue(shape, "size",
+            ignition::math::Vector3d(box->dim.x, box->dim.y, box->dim.z));
+      }
+      break;
+    case urdf::Geometry::CYLINDER:
+      {
+        urdf::CylinderConstSharedPtr cylinder =
+          urdf::dynamic_pointer_cast<urdf::Cylinder>(_geometry);
+        ElementPtr shape =
+          AddChildElement(AddChildElement(_elem, "geometry"), "cylinder");
+        AddKeyValue(shape, "length", cylinder->length);
+        AddKeyValue(shape, "radius", cylinder->radius);
+      }
+      break;
+    case urdf::Geometry::SPHERE:
+      {
+        urdf::SphereConstSharedPtr sphere =
+          urdf::dynamic_pointer_cast<urdf::Sphere>(_geometry);
+        ElementPtr shape =
+          AddChildElement(AddChildElement(_elem, "geometry"), "sphere");
+        AddKeyValue(shape, "radius", sphere->radius);
+      }
+      break;
+    case urdf::Geometry::MESH:
+      {
+        urdf::MeshConstSharedPtr mesh =
+          urdf::dynamic_pointer_cast<urdf::Mesh>(_geometry);
+        ElementPtr shape =
+          AddChildElement(AddChildElement(_elem, "geometry"), "mesh");
+        AddKeyValue(shape, "scale", ignition::math::Vector3d(
+              mesh->scale.x, mesh->scale.y, mesh->scale.z));
+        if (mesh->filename.empty())
+        {
+          sdferr << "urdf2sdf: mesh geometry with no filename given.\n";
+        }
+        AddKeyValue(shape, "uri", MeshUri(mesh->filename));
+      }
+      break;
+    default:
+      sdfwarn << "Unknown body type: [" << static_cast<int>(_geometry->type)
+              << "] skipped in geometry\n";
+      break;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void CreateCollision(ElementPtr _elem, urdf::LinkConstSharedPtr _link,
+                     urdf::CollisionSharedPtr _collision,
+                     const std::string &_oldLinkName)
+{
+  ElementPtr sdfCollision = AddChildElement(_elem, "collision");
+  sdfCollision->GetAttribute("name")->Set(LumpedName(_link, _oldLinkName));
+  AddKeyValue(sdfCollision, "pose", RpyPose(_collision->origin));
+
+  if (!_collision->geometry)
+  {
+    sdfdbg << "urdf2sdf: collision of link [" << _link->name
+           << "] has no <geometry>.\n";
+  }
+  else
+  {
+    CreateGeometry(sdfCollision, _collision->geometry);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void CreateVisual(ElementPtr _elem, urdf::LinkConstSharedPtr _link,
+                  urdf::VisualSharedPtr _visual,
+                  const std::string &_oldLinkName)
+{
+  ElementPtr sdfVisual = AddChildElement(_elem, "visual");
+  sdfVisual->GetAttribute("name")->Set(LumpedName(_link, _oldLinkName));
+  AddKeyValue(sdfVisual, "pose", RpyPose(_visual->origin));
+
+  if (!_visual->geometry)
+  {
+    sdfdbg << "urdf2sdf: visual of link [" << _link->name
+           << "] has no <geometry>.\n";
+  }
+  else
+  {
+    CreateGeometry(sdfVisual, _visual->geometry);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void CreateInertial(ElementPtr _elem, urdf::LinkConstSharedPtr _link)
+{
+  ElementPtr inertial = AddChildElement(_elem, "inertial");
+  AddKeyValue(inertial, "pose", CopyPose(_link->inertial->origin));
+  AddKeyValue(inertial, "mass", _link->inertial->mass);
+
+  ElementPtr inertia = AddChildElement(inertial, "inertia");
+  AddKeyValue(inertia, "ixx", _link->inertial->ixx);
+  AddKeyValue(inertia, "ixy", _link->inertial->ixy);
+  AddKeyValue(inertia, "ixz", _link->inertial->ixz);
+  AddKeyValue(inertia, "iyy", _link->inertial->iyy);
+  AddKeyValue(inertia, "iyz", _link->inertial->iyz);
+  AddKeyValue(inertia, "izz", _link->inertial->izz);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void CreateJoint(ElementPtr _model, urdf::LinkConstSharedPtr _link)
+{
+  bool fixedToRevolute = false;
+  const std::string jtype = JointType(_link, fixedToRevolute);
+  if (jtype.empty())
+  {
+    return;
+  }
+
+  const urdf::JointSharedPtr &urdfJoint = _link->parent_joint;
+  ElementPtr joint = AddChildElement(_model, "joint");
+  joint->GetAttribute("type")->Set(
+      std::string(fixedToRevolute ? "revolute" : jtype));
+  joint->GetAttribute("name")->Set(urdfJoint->name);
+
+  // Add joint pose relative to parent link
+  std::string relativeTo = _link->getParent()->name;
+  if ("world" == relativeTo)
+  {
+    relativeTo = "__model__";
+  }
+  ElementPtr pose = AddChildElement(joint, "pose");
+  pose->GetValue()->Set(
+      CopyPose(urdfJoint->parent_to_joint_origin_transform));
+  pose->GetAttribute("relative_to")->Set(relativeTo);
+
+  AddKeyValue(joint, "parent", _link->getParent()->name);
+  AddKeyValue(joint, "child", _link->name);
+
+  if (jtype == "fixed" && !fixedToRevolute)
+  {
+    return;
+  }
+
+  ElementPtr axis = AddChildElement(joint, "axis");
+  if (fixedToRevolute)
+  {
+    ElementPtr limit = AddChildElement(axis, "limit");
+    AddKeyValue(limit, "lower", 0.0);
+    AddKeyValue(limit, "upper", 0.0);
+    ElementPtr dynamics = AddChildElement(axis, "dynamics");
+    AddKeyValue(dynamics, "damping", 0.0);
+    AddKeyValue(dynamics, "friction", 0.0);
+    return;
+  }
+
+  AddKeyValue(axis, "xyz", ignition::math::Vector3d(
+        urdfJoint->axis.x, urdfJoint->axis.y, urdfJoint->axis.z));
+
+  ElementPtr limit = AddChildElement(axis, "limit");
+  if (g_conversion->enforceLimits && urdfJoint->limits &&
+      urdfJoint->type != urdf::Joint::CONTINUOUS)
+  {
+    double &lowstop = urdfJoint->limits->lower;
+    double &highstop = urdfJoint->limits->upper;
+    // enforce ode bounds, this will need to be fixed
+    if (lowstop > highstop)
+    {
+      sdfwarn << "urdf2sdf: revolute joint [" << urdfJoint->name
+              << "] with limits: lowStop[" << lowstop
+              << "] > highStop[" << highstop
+              << "], switching the two.\n";
+      std::swap(lowstop, highstop);
+    }
+    AddKeyValue(limit, "lower", lowstop);
+    AddKeyValue(limit, "upper", highstop);
+    AddKeyValue(limit, "effort", urdfJoint->limits->effort);
+    AddKeyValue(limit, "velocity", urdfJoint->limits->velocity);
+  }
+
+  ElementPtr dynamics = AddChildElement(axis, "dynamics");
+  if (urdfJoint->dynamics)
+  {
+    AddKeyValue(dynamics, "damping", urdfJoint->dynamics->damping);
+    AddKeyValue(dynamics, "friction", urdfJoint->dynamics->friction);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void CreateLink(ElementPtr _model, urdf::LinkConstSharedPtr _link,
+                ignition::math::Pose3d &_currentTransform)
+{
+  // The joint comes before its child link, like in the XML conversion.
+  CreateJoint(_model, _link);
+
+  ElementPtr link = AddChildElement(_model, "link");
+  link->GetAttribute("name")->Set(_link->name);
+
+  // this is the transform from parent link to current _link
+  // this transform does not exist for the root link
+  if (_link->parent_joint)
+  {
+    AddChildElement(link, "pose")->GetAttribute("relative_to")->Set(
+        _link->parent_joint->name);
+  }
+  else
+  {
+    sdfdbg << "[" << _link->name << "] has no parent joint\n";
+
+    if (_currentTransform != ignition::math::Pose3d::Zero)
+    {
+      AddKeyValue(link, "pose", _currentTransform);
+    }
+  }
+
+  CreateInertial(link, _link);
+  CreateCollisions(link, _link);
+  CreateVisuals(link, _link);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void InsertRobotOrigin(ElementPtr _elem)
+{
+  if (g_conversion->initialRobotPoseValid)
+  {
+    AddKeyValue(_elem, "pose", RpyPose(g_conversion->initialRobotPose));
+  }
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 TiXmlDocument URDF2SDF::InitModelString(const std::string &_urdfStr,
                                         bool _enforceLimits)
 {
-  g_enforceLimits = _enforceLimits;
+  TiXmlDocument urdfXml;
+  urdfXml.Parse(_urdfStr.c_str());
+  return this->InitModel(_urdfStr, urdfXml, _enforceLimits);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+TiXmlDocument URDF2SDF::InitModel(const std::string &_urdfStr,
+                                  TiXmlDocument &_urdfXml,
+                                  bool _enforceLimits)
+{
+  ScopedConversion conversion(this->dataPtr);
+  this->dataPtr->enforceLimits = _enforceLimits;
 
   // Create a RobotModel from string
   urdf::ModelInterfaceSharedPtr robotModel = urdf::parseURDF(_urdfStr);
@@ -3199,15 +4041,13 @@ TiXmlDocument URDF2SDF::InitModelString(const std::string &_urdfStr,
   ignition::math::Pose3d transform;
 
   // parse sdf extension
-  TiXmlDocument urdfXml;
-  urdfXml.Parse(_urdfStr.c_str());
-  g_extensions.clear();
-  g_fixedJointsTransformedInFixedJoints.clear();
-  g_fixedJointsTransformedInRevoluteJoints.clear();
-  this->ParseSDFExtension(urdfXml);
+  this->dataPtr->extensions.clear();
+  this->dataPtr->fixedJointsTransformedInFixedJoints.clear();
+  this->dataPtr->fixedJointsTransformedInRevoluteJoints.clear();
+  this->ParseSDFExtension(_urdfXml);
 
   // Parse robot pose
-  ParseRobotOrigin(urdfXml);
+  ParseRobotOrigin(_urdfXml);
 
   urdf::LinkConstSharedPtr rootLink = robotModel->getRoot();
 
@@ -3228,7 +4068,7 @@ TiXmlDocument URDF2SDF::InitModelString(const std::string &_urdfStr,
     // parent link recursively
     // using the disabledFixedJointLumping or preserveFixedJoint options
     // is possible to disable fixed joint lumping only for selected joints
-    if (g_reduceFixedJoints)
+    if (this->dataPtr->reduceFixedJoints)
     {
       ReduceFixedJoints(robot, urdf::const_pointer_cast<urdf::Link>(rootLink));
     }
@@ -3282,13 +4122,86 @@ TiXmlDocument URDF2SDF::InitModelString(const std::string &_urdfStr,
   return sdfXmlOut;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+bool URDF2SDF::InitModelElement(TiXmlDocument *_xmlDoc, ElementPtr _sdf,
+                                const std::string &_urdfStr)
+{
+  TiXmlElement *robotXml = _xmlDoc->FirstChildElement("robot");
+  if (!robotXml || robotXml->FirstChildElement("gazebo"))
+  {
+    return false;
+  }
+
+  ScopedConversion conversion(this->dataPtr);
+  this->dataPtr->enforceLimits = true;
+
+  std::string urdfStr = _urdfStr;
+  if (urdfStr.empty())
+  {
+    std::ostringstream stream;
+    stream << *_xmlDoc;
+    urdfStr = stream.str();
+  }
+  urdf::ModelInterfaceSharedPtr robotModel = urdf::parseURDF(urdfStr);
+  if (!robotModel)
+  {
+    sdferr << "Unable to call parseURDF on robot model\n";
+    return false;
+  }
+
+  ignition::math::Pose3d transform;
+
+  this->dataPtr->extensions.clear();
+  this->dataPtr->fixedJointsTransformedInFixedJoints.clear();
+  this->dataPtr->fixedJointsTransformedInRevoluteJoints.clear();
+  ParseRobotOrigin(*_xmlDoc);
+
+  urdf::LinkConstSharedPtr rootLink = robotModel->getRoot();
+
+  // Build the model apart, so that _sdf is only changed on success.
+  ElementPtr robot = _sdf->GetElementDescription("model")->Clone();
+  robot->SetParent(_sdf);
+  robot->GetAttribute("name")->Set(robotModel->getName());
+
+  if (this->dataPtr->reduceFixedJoints)
+  {
+    ReduceFixedJoints(nullptr, urdf::const_pointer_cast<urdf::Link>(rootLink));
+  }
+
+  if (rootLink->name == "world")
+  {
+    for (const auto &child : rootLink->child_links)
+    {
+      CreateSDF(robot, child, transform);
+    }
+  }
+  else
+  {
+    CreateSDF(robot, rootLink, transform);
+  }
+
+  InsertRobotOrigin(robot);
+  AddRequiredElements(robot);
+
+  _sdf->InsertElement(robot);
+  _sdf->GetAttribute("version")->Set(SDF::Version());
+  return true;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 TiXmlDocument URDF2SDF::InitModelDoc(TiXmlDocument* _xmlDoc)
 {
   std::ostringstream stream;
   stream << *_xmlDoc;
   std::string urdfStr = stream.str();
-  return InitModelString(urdfStr);
+  return this->InitModel(urdfStr, *_xmlDoc, true);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+TiXmlDocument URDF2SDF::InitModelDoc(TiXmlDocument *_xmlDoc,
+                                     const std::string &_urdfStr)
+{
+  return this->InitModel(_urdfStr, *_xmlDoc, true);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -3307,17 +4220,67 @@ TiXmlDocument URDF2SDF::InitModelFile(const std::string &_filename)
   return xmlDoc;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+std::vector<URDFConversion> URDF2SDF::InitModels(
+    const std::vector<URDFSource> &_robots, const unsigned int _threadCount)
+{
+  std::vector<URDFConversion> results(_robots.size());
+  auto extensionCache = std::make_shared<SDFExtensionCache>();
+  parallelFor(_robots.size(), _threadCount, [&](const std::size_t _i)
+      {
+        const URDFSource &robot = _robots[_i];
+        URDFConversion &result = results[_i];
+
+        std::string urdfStr = robot.urdf;
+        if (urdfStr.empty())
+        {
+          std::ifstream file(robot.filename, std::ios::binary);
+          std::ostringstream stream;
+          stream << file.rdbuf();
+          if (!file)
+          {
+            result.errors.push_back({ErrorCode::FILE_READ,
+                "Unable to load file[" + robot.filename + "]."});
+            return;
+          }
+          urdfStr = stream.str();
+        }
+
+        TiXmlDocument urdfXml;
+        urdfXml.Parse(urdfStr.c_str());
+        if (urdfXml.Error() || !IsURDF(&urdfXml))
+        {
+          result.errors.push_back({ErrorCode::STRING_READ,
+              "Unable to parse URDF of robot[" + std::to_string(_i) +
+              "]: " + (urdfXml.Error() ? urdfXml.ErrorDesc() :
+              "missing <robot> element")});
+          return;
+        }
+
+        URDF2SDF converter;
+        converter.dataPtr->extensionCache = extensionCache;
+        result.sdf = converter.InitModel(urdfStr, urdfXml, true);
+        if (!result.sdf.FirstChildElement("sdf"))
+        {
+          result.errors.push_back({ErrorCode::ELEMENT_INVALID,
+              "Unable to convert URDF of robot[" + std::to_string(_i) +
+              "]."});
+        }
+      });
+  return results;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 bool FixedJointShouldBeReduced(urdf::JointSharedPtr _jnt)
 {
     // A joint should be lumped only if its type is fixed and
     // the disabledFixedJointLumping or preserveFixedJoint
     // joint options are not set
+    const auto &revolute = g_conversion->fixedJointsTransformedInRevoluteJoints;
+    const auto &fixed = g_conversion->fixedJointsTransformedInFixedJoints;
     return (_jnt->type == urdf::Joint::FIXED &&
-              (g_fixedJointsTransformedInRevoluteJoints.find(_jnt->name) ==
-                 g_fixedJointsTransformedInRevoluteJoints.end()) &&
-              (g_fixedJointsTransformedInFixedJoints.find(_jnt->name) ==
-                 g_fixedJointsTransformedInFixedJoints.end()));
+              (revolute.find(_jnt->name) == revolute.end()) &&
+              (fixed.find(_jnt->name) == fixed.end()));
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -3363,11 +4326,8 @@ void ReduceSDFExtensionSensorTransformReduction(
     reductionQ.getRPY(reductionRpy.x, reductionRpy.y, reductionRpy.z);
 
     // output updated pose to text
-    std::ostringstream poseStream;
-    poseStream << reductionXyz.x << " " << reductionXyz.y
-               << " " << reductionXyz.z << " " << reductionRpy.x
-               << " " << reductionRpy.y << " " << reductionRpy.z;
-    TiXmlText* poseTxt = new TiXmlText(poseStream.str());
+    TiXmlText* poseTxt = new TiXmlText(
+        Vector32Str(reductionXyz) + " " + Vector32Str(reductionRpy));
 
     TiXmlElement* poseKey = new TiXmlElement("pose");
     poseKey->LinkEndChild(poseTxt);
@@ -3418,11 +4378,8 @@ void ReduceSDFExtensionProjectorTransformReduction(
     reductionQ.getRPY(reductionRpy.x, reductionRpy.y, reductionRpy.z);
 
     // output updated pose to text
-    std::ostringstream poseStream;
-    poseStream << reductionXyz.x << " " << reductionXyz.y
-               << " " << reductionXyz.z << " " << reductionRpy.x
-               << " " << reductionRpy.y << " " << reductionRpy.z;
-    TiXmlText* poseTxt = new TiXmlText(poseStream.str());
+    TiXmlText* poseTxt = new TiXmlText(
+        Vector32Str(reductionXyz) + " " + Vector32Str(reductionRpy));
 
     poseKey = new TiXmlElement("pose");
     poseKey->LinkEndChild(poseTxt);
@@ -3533,16 +4490,11 @@ void ReduceSDFExtensionPluginFrameReplace(
                                   _reductionTransform.Rot().Z(),
                                   _reductionTransform.Rot().W());
 
-        std::ostringstream xyzStream, rpyStream;
-        xyzStream << reductionXyz.x << " " << reductionXyz.y << " "
-                  << reductionXyz.z;
         urdf::Vector3 reductionRpy;
         reductionQ.getRPY(reductionRpy.x, reductionRpy.y, reductionRpy.z);
-        rpyStream << reductionRpy.x << " " << reductionRpy.y << " "
-                  << reductionRpy.z;
 
-        TiXmlText* xyzTxt = new TiXmlText(xyzStream.str());
-        TiXmlText* rpyTxt = new TiXmlText(rpyStream.str());
+        TiXmlText* xyzTxt = new TiXmlText(Vector32Str(reductionXyz));
+        TiXmlText* rpyTxt = new TiXmlText(Vector32Str(reductionRpy));
 
         xyzKey->LinkEndChild(xyzTxt);
         rpyKey->LinkEndChild(rpyTxt);
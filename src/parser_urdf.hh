@@ -21,8 +21,10 @@
 #include <sdf/sdf_config.h>
 
 #include <string>
+#include <vector>
 
 #include "sdf/Console.hh"
+#include "sdf/Element.hh"
 #include "sdf/Types.hh"
 #include "sdf/system_util.hh"
 
@@ -32,6 +34,30 @@ namespace sdf
   inline namespace SDF_VERSION_NAMESPACE {
   //
 
+  // Forward declarations.
+  class URDF2SDFPrivate;
+
+  /// \brief A robot to convert with URDF2SDF::InitModels.
+  struct URDFSource
+  {
+    /// \brief Name of the URDF file, which is read if urdf is empty.
+    std::string filename;
+
+    /// \brief The URDF of the robot, or an empty string to read filename.
+    std::string urdf;
+  };
+
+  /// \brief The result of converting a robot with URDF2SDF::InitModels.
+  struct URDFConversion
+  {
+    /// \brief A tinyxml document containing sdf of the robot, which is
+    /// empty if the robot could not be converted.
+    TiXmlDocument sdf;
+
+    /// \brief The errors of reading and converting the robot.
+    Errors errors;
+  };
+
   /// \brief URDF to SDF converter
   ///
   /// This is now deprecated for external usage and will be removed in the next
@@ -45,11 +71,38 @@ namespace sdf
     /// \brief destructor
     public: ~URDF2SDF();
 
+    /// \brief Copy constructor is explicitly deleted.
+    public: URDF2SDF(const URDF2SDF &) = delete;
+
+    /// \brief Copy assignment is explicitly deleted.
+    public: URDF2SDF &operator=(const URDF2SDF &) = delete;
+
     /// \brief convert urdf xml document string to sdf xml document
     /// \param[in] _xmlDoc a tinyxml document containing the urdf model
     /// \return a tinyxml document containing sdf of the model
     public: TiXmlDocument InitModelDoc(TiXmlDocument* _xmlDoc);
 
+    /// \brief convert urdf xml document to sdf xml document, given the
+    /// string from which the document was parsed. This avoids printing the
+    /// document to a string again.
+    /// \param[in] _xmlDoc a tinyxml document containing the urdf model
+    /// \param[in] _urdfStr the string from which _xmlDoc was parsed
+    /// \return a tinyxml document containing sdf of the model
+    public: TiXmlDocument InitModelDoc(TiXmlDocument *_xmlDoc,
+                                       const std::string &_urdfStr);
+
+    /// \brief Convert a urdf xml document directly to an element tree,
+    /// without going through a sdf xml document.
+    /// \param[in] _xmlDoc a tinyxml document containing the urdf model
+    /// \param[in] _sdf The <sdf> element to which the model is added.
+    /// \return True if the model was added. False if the document could not
+    /// be converted, or if it has <gazebo> extensions, which are only
+    /// supported by InitModelDoc. _sdf is not changed in that case.
+    /// \param[in] _urdfStr The string from which _xmlDoc was parsed, if it
+    /// is available. Otherwise the document is printed to a string.
+    public: bool InitModelElement(TiXmlDocument *_xmlDoc, ElementPtr _sdf,
+                                  const std::string &_urdfStr = "");
+
     /// \brief convert urdf file to sdf xml document
     /// \param[in] _urdfStr a string containing filename of the urdf model
     /// \return a tinyxml document containing sdf of the model
@@ -63,11 +116,30 @@ namespace sdf
     public: TiXmlDocument InitModelString(const std::string &_urdfStr,
                                           bool _enforceLimits = true);
 
+    /// \brief Convert many urdf models to sdf xml documents concurrently,
+    /// such as the variants of a robot of a fleet, on the threads shared by
+    /// the parallel stages of the library. The <gazebo> blocks that several
+    /// robots have are parsed once, and copied for the other robots.
+    /// \param[in] _robots The files or strings of the robots.
+    /// \param[in] _threadCount Maximum number of threads, or 0 for one per
+    /// hardware thread.
+    /// \return The result of each robot, in the order of _robots.
+    public: static std::vector<URDFConversion> InitModels(
+        const std::vector<URDFSource> &_robots,
+        unsigned int _threadCount = 0);
+
     /// \brief Return true if the filename is a URDF model.
     /// \param[in] _filename File to check.
     /// \return True if _filename is a URDF model.
     public: static bool IsURDF(const std::string &_filename);
 
+    /// \brief Return true if an XML document is a URDF model, which is a
+    /// document whose root element is <robot>. The model itself is only
+    /// validated by the conversion.
+    /// \param[in] _xmlDoc Document to check.
+    /// \return True if _xmlDoc is a URDF model.
+    public: static bool IsURDF(const TiXmlDocument *_xmlDoc);
+
     /// list extensions for debugging
     public: void ListSDFExtensions();
 
@@ -77,6 +149,18 @@ namespace sdf
     /// things that do not belong in urdf but should be mapped into sdf
     /// @todo: do this using sdf definitions, not hard coded stuff
     private: void ParseSDFExtension(TiXmlDocument &_urdfXml);
+
+    /// \brief Convert a urdf model to sdf.
+    /// \param[in] _urdfStr a string containing model urdf
+    /// \param[in] _urdfXml the same model parsed by tinyxml
+    /// \param[in] _enforceLimits option to enforce joint limits
+    /// \return a tinyxml document containing sdf of the model
+    private: TiXmlDocument InitModel(const std::string &_urdfStr,
+                                     TiXmlDocument &_urdfXml,
+                                     bool _enforceLimits);
+
+    /// \brief Private data pointer.
+    private: URDF2SDFPrivate *dataPtr;
   };
   }
 }
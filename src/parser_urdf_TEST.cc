@@ -18,6 +18,9 @@
 #include <gtest/gtest.h>
 
 #include <list>
+#include <sstream>
+#include <string>
+#include <vector>
 
 #include "sdf/sdf.hh"
 #include "parser_urdf.hh"
@@ -72,6 +75,45 @@ TEST(URDFParser, InitModelDoc_BasicModel_NoThrow)
   );    // NOLINT(whitespace/parens)
 }
 
+/////////////////////////////////////////////////
+TEST(URDFParser, InitModelDoc_WithString)
+{
+  // Converting a document with the string it was parsed from gives the
+  // same result as printing the document to a string.
+  const std::string urdf = getMinimalUrdfTxt();
+  TiXmlDocument doc;
+  doc.Parse(urdf.c_str());
+  sdf::URDF2SDF parser_;
+  std::string withString;
+  withString << parser_.InitModelDoc(&doc, urdf);
+
+  TiXmlDocument doc2;
+  doc2.Parse(urdf.c_str());
+  std::string printed;
+  printed << parser_.InitModelDoc(&doc2);
+
+  EXPECT_FALSE(withString.empty());
+  EXPECT_EQ(printed, withString);
+}
+
+/////////////////////////////////////////////////
+TEST(URDFParser, IsURDF)
+{
+  TiXmlDocument urdf;
+  urdf.Parse(("<?xml version='1.0'?>" + getMinimalUrdfTxt()).c_str());
+  EXPECT_TRUE(sdf::URDF2SDF::IsURDF(&urdf));
+
+  TiXmlDocument sdfDoc;
+  sdfDoc.Parse("<sdf version='1.7'><model name='m'/></sdf>");
+  EXPECT_FALSE(sdf::URDF2SDF::IsURDF(&sdfDoc));
+
+  TiXmlDocument empty;
+  EXPECT_FALSE(sdf::URDF2SDF::IsURDF(&empty));
+  EXPECT_FALSE(sdf::URDF2SDF::IsURDF(nullptr));
+
+  EXPECT_FALSE(sdf::URDF2SDF::IsURDF("/nonexistent/file.urdf"));
+}
+
 /////////////////////////////////////////////////
 TEST(URDFParser, ParseResults_BasicModel_ParseEqualToModel)
 {
@@ -833,6 +875,325 @@ TEST(URDFParser, OutputPrecision)
   EXPECT_EQ("0", poseValues[5]);
 }
 
+/////////////////////////////////////////////////
+TEST(URDFParser, LongFixedJointChain)
+{
+  // A chain of links connected by fixed joints, with a revolute joint in
+  // the middle, is reduced to two links.
+  const int linkCount = 2000;
+  const int revoluteIndex = 1000;
+  std::ostringstream urdf;
+  urdf << "<robot name='chain'>";
+  for (int i = 0; i < linkCount; ++i)
+  {
+    urdf << "<link name='link" << i << "'>"
+         << "  <inertial>"
+         << "    <mass value='1.0'/>"
+         << "    <inertia ixx='1.0' ixy='0.0' ixz='0.0'"
+         << "             iyy='1.0' iyz='0.0' izz='1.0'/>"
+         << "  </inertial>"
+         << "  <visual name='visual" << i << "'>"
+         << "    <geometry><box size='1 1 1'/></geometry>"
+         << "  </visual>"
+         << "</link>";
+    if (i > 0)
+    {
+      urdf << "<joint name='joint" << i << "' type='"
+           << (i == revoluteIndex ? "revolute" : "fixed") << "'>"
+           << "  <parent link='link" << i - 1 << "'/>"
+           << "  <child link='link" << i << "'/>"
+           << "  <origin xyz='1 0 0' rpy='0 0 0'/>"
+           << "  <axis xyz='0 0 1'/>"
+           << "  <limit lower='-1' upper='1' effort='1' velocity='1'/>"
+           << "</joint>";
+    }
+  }
+  urdf << "</robot>";
+
+  sdf::SDF sdf;
+  convertUrdfStrToSdf(urdf.str(), sdf);
+  sdf::ElementPtr model = sdf.Root()->GetElement("model");
+  ASSERT_NE(nullptr, model);
+
+  std::vector<sdf::ElementPtr> links;
+  for (sdf::ElementPtr link = model->GetElement("link"); link;
+       link = link->GetNextElement("link"))
+  {
+    links.push_back(link);
+  }
+  ASSERT_EQ(2u, links.size());
+  EXPECT_EQ("link0", links[0]->Get<std::string>("name"));
+  EXPECT_EQ("link1000", links[1]->Get<std::string>("name"));
+
+  for (size_t l = 0; l < links.size(); ++l)
+  {
+    EXPECT_DOUBLE_EQ(revoluteIndex,
+        links[l]->GetElement("inertial")->Get<double>("mass"));
+
+    int visualCount = 0;
+    for (sdf::ElementPtr visual = links[l]->GetElement("visual"); visual;
+         visual = visual->GetNextElement("visual"))
+    {
+      // Visuals keep the order of the chain and are moved to the frame of
+      // the link they are lumped into.
+      const int index = static_cast<int>(l) * revoluteIndex + visualCount;
+      const std::string lumpedName = "_fixed_joint_lump__visual" +
+          std::to_string(index) + "_visual";
+      EXPECT_NE(std::string::npos,
+          visual->Get<std::string>("name").find(lumpedName));
+      EXPECT_DOUBLE_EQ(visualCount,
+          visual->Get<ignition::math::Pose3d>("pose").Pos().X());
+      ++visualCount;
+    }
+    EXPECT_EQ(revoluteIndex, visualCount);
+  }
+
+  sdf::ElementPtr joint = model->GetElement("joint");
+  ASSERT_NE(nullptr, joint);
+  EXPECT_EQ("joint1000", joint->Get<std::string>("name"));
+  EXPECT_EQ("link0", joint->Get<std::string>("parent"));
+  EXPECT_DOUBLE_EQ(revoluteIndex,
+      joint->Get<ignition::math::Pose3d>("pose").Pos().X());
+  EXPECT_EQ(nullptr, joint->GetNextElement("joint"));
+}
+
+/////////////////////////////////////////////////
+TEST(URDFParser, ReducedExtensionFrames)
+{
+  // link3 is lumped into link2, which is lumped into link1.
+  std::ostringstream urdf;
+  urdf << "<robot name='test_robot'>";
+  for (int i = 1; i <= 3; ++i)
+  {
+    urdf << "<link name='link" << i << "'>"
+         << "  <inertial>"
+         << "    <mass value='1.0'/>"
+         << "    <inertia ixx='1.0' ixy='0.0' ixz='0.0'"
+         << "             iyy='1.0' iyz='0.0' izz='1.0'/>"
+         << "  </inertial>"
+         << "</link>";
+    if (i > 1)
+    {
+      urdf << "<joint name='joint" << i << "' type='fixed'>"
+           << "  <parent link='link" << i - 1 << "'/>"
+           << "  <child link='link" << i << "'/>"
+           << "  <origin xyz='0 0 " << i - 1 << "' rpy='0 0 0'/>"
+           << "</joint>";
+    }
+  }
+  urdf << "<gazebo reference='link3'>"
+       << "  <sensor name='bumper' type='contact'>"
+       << "    <pose>1 1 1 0 0 0</pose>"
+       << "    <contact><collision>link3_collision</collision></contact>"
+       << "  </sensor>"
+       << "</gazebo>"
+       << "<gazebo>"
+       << "  <plugin name='p3d' filename='libp3d.so'>"
+       << "    <bodyName>link3</bodyName>"
+       << "  </plugin>"
+       << "</gazebo>"
+       << "</robot>";
+
+  sdf::URDF2SDF parser;
+  TiXmlDocument doc = parser.InitModelString(urdf.str());
+  TiXmlElement *model = doc.FirstChildElement("sdf")
+      ->FirstChildElement("model");
+  ASSERT_NE(nullptr, model);
+  TiXmlElement *link = model->FirstChildElement("link");
+  ASSERT_NE(nullptr, link);
+  EXPECT_STREQ("link1", link->Attribute("name"));
+  EXPECT_EQ(nullptr, link->NextSiblingElement("link"));
+
+  // The sensor is moved to link1, with the transforms of both joints, and
+  // its collision is renamed once, at the reduction of link3.
+  TiXmlElement *sensor = link->FirstChildElement("sensor");
+  ASSERT_NE(nullptr, sensor);
+  EXPECT_STREQ("0 0 3 0 0 0", sensor->FirstChildElement("pose")->GetText());
+  EXPECT_STREQ("link2_collision_link3", sensor->FirstChildElement("contact")
+      ->FirstChildElement("collision")->GetText());
+
+  // The plugin refers to link1, with an offset through both joints.
+  TiXmlElement *plugin = model->FirstChildElement("plugin");
+  ASSERT_NE(nullptr, plugin);
+  EXPECT_STREQ("link1", plugin->FirstChildElement("bodyName")->GetText());
+  EXPECT_STREQ("0 0 -3", plugin->FirstChildElement("xyzOffset")->GetText());
+  EXPECT_STREQ("0 0 0", plugin->FirstChildElement("rpyOffset")->GetText());
+}
+
+/////////////////////////////////////////////////
+TEST(URDFParser, NumberFormatting)
+{
+  std::ostringstream stream;
+  stream << "<robot name='test_robot'>"
+         << "  <link name='link'>"
+         << "    <inertial>"
+         << "      <origin xyz='1e-3 2 -0.5' rpy='0 0 0'/>"
+         << "      <mass value='0.30000000000000004'/>"
+         << "      <inertia ixx='1' ixy='0' ixz='0' iyy='1' iyz='0' izz='1'/>"
+         << "    </inertial>"
+         << "    <visual>"
+         << "      <geometry>"
+         << "        <mesh filename='package://robot/mesh.dae'"
+         << "              scale='0.1 1e-7 3'/>"
+         << "      </geometry>"
+         << "    </visual>"
+         << "    <collision>"
+         << "      <geometry>"
+         << "        <box size='0.1 0.2 0.30000000000000004'/>"
+         << "      </geometry>"
+         << "    </collision>"
+         << "  </link>"
+         << "  <gazebo reference='link'>"
+         << "    <maxContacts> +12</maxContacts>"
+         << "    <mu1>0.25</mu1>"
+         << "  </gazebo>"
+         << "</robot>";
+
+  const std::string sdf = convertUrdfStrToSdfStr(stream.str());
+  EXPECT_NE(std::string::npos, sdf.find("<pose>0.001 2 -0.5 0 0 0</pose>"))
+      << sdf;
+  EXPECT_NE(std::string::npos, sdf.find("<mass>0.3</mass>")) << sdf;
+  EXPECT_NE(std::string::npos, sdf.find("<scale>0.1 1e-07 3</scale>"))
+      << sdf;
+  EXPECT_NE(std::string::npos, sdf.find("<size>0.1 0.2 0.3</size>")) << sdf;
+  EXPECT_NE(std::string::npos, sdf.find("<max_contacts>12</max_contacts>"))
+      << sdf;
+  EXPECT_NE(std::string::npos, sdf.find("<mu>0.25</mu>")) << sdf;
+}
+
+/////////////////////////////////////////////////
+TEST(URDFParser, InitModels)
+{
+  // Variants of a robot that share their <gazebo> blocks, one of which
+  // preserves a fixed joint.
+  std::vector<sdf::URDFSource> robots;
+  for (int i = 0; i < 8; ++i)
+  {
+    std::ostringstream urdf;
+    urdf << "<robot name='robot" << i << "'>"
+         << "  <link name='link1'/>"
+         << "  <link name='link2'>"
+         << "    <inertial>"
+         << "      <mass value='" << i + 1 << "'/>"
+         << "      <inertia ixx='1.0' ixy='0.0' ixz='0.0'"
+         << "               iyy='1.0' iyz='0.0' izz='1.0'/>"
+         << "    </inertial>"
+         << "  </link>"
+         << "  <joint name='joint1_2' type='fixed'>"
+         << "    <parent link='link1'/>"
+         << "    <child link='link2'/>"
+         << "  </joint>"
+         << "  <gazebo reference='joint1_2'>"
+         << "    <preserveFixedJoint>true</preserveFixedJoint>"
+         << "  </gazebo>"
+         << "  <gazebo reference='link2'>"
+         << "    <mu1>0.5</mu1>"
+         << "    <sensor name='imu' type='imu'/>"
+         << "  </gazebo>"
+         << "</robot>";
+    sdf::URDFSource robot;
+    robot.urdf = urdf.str();
+    robots.push_back(robot);
+  }
+  sdf::URDFSource missing;
+  missing.filename = "/missing/robot.urdf";
+  robots.push_back(missing);
+  sdf::URDFSource invalid;
+  invalid.urdf = "<model name='not_a_robot'/>";
+  robots.push_back(invalid);
+
+  const std::vector<sdf::URDFConversion> results =
+      sdf::URDF2SDF::InitModels(robots, 4);
+  ASSERT_EQ(robots.size(), results.size());
+
+  // Each robot is converted as it is on its own, although the blocks are
+  // parsed once.
+  for (std::size_t i = 0; i < 8; ++i)
+  {
+    EXPECT_TRUE(results[i].errors.empty());
+    TiXmlPrinter printer;
+    results[i].sdf.Accept(&printer);
+    EXPECT_EQ(convertUrdfStrToSdfStr(robots[i].urdf), printer.Str());
+
+    sdf::SDF sdf;
+    sdf.SetFromString(printer.Str());
+    sdf::ElementPtr model = sdf.Root()->GetElement("model");
+    EXPECT_EQ("robot" + std::to_string(i),
+        model->Get<std::string>("name"));
+    EXPECT_EQ("fixed", model->GetElement("joint")->Get<std::string>("type"));
+  }
+
+  EXPECT_EQ(nullptr, results[8].sdf.FirstChildElement("sdf"));
+  ASSERT_EQ(1u, results[8].errors.size());
+  EXPECT_EQ(sdf::ErrorCode::FILE_READ, results[8].errors[0].Code());
+  EXPECT_EQ(nullptr, results[9].sdf.FirstChildElement("sdf"));
+  ASSERT_EQ(1u, results[9].errors.size());
+  EXPECT_EQ(sdf::ErrorCode::STRING_READ, results[9].errors[0].Code());
+}
+
+/////////////////////////////////////////////////
+TEST(URDFParser, MergeManyExtensions)
+{
+  const int count = 300;
+  std::ostringstream stream;
+  stream << "<robot name='test_robot'>"
+         << "  <link name='link'>"
+         << "    <collision>"
+         << "      <geometry><sphere radius='1'/></geometry>"
+         << "    </collision>"
+         << "  </link>";
+  for (int i = 0; i < count; ++i)
+  {
+    stream << "  <gazebo reference='link'>"
+           << "    <mu1>" << i << "</mu1>"
+           << "    <maxContacts>" << i << "</maxContacts>"
+           << "    <selfCollide>" << (i % 2 ? "true" : "false")
+           << "</selfCollide>"
+           << "    <sensor name='sensor" << i << "' type='imu'/>"
+           << "  </gazebo>";
+  }
+  stream << "</robot>";
+
+  sdf::URDF2SDF parser;
+  TiXmlDocument doc = parser.InitModelString(stream.str());
+  TiXmlElement *link = doc.FirstChildElement("sdf")
+      ->FirstChildElement("model")->FirstChildElement("link");
+  ASSERT_NE(nullptr, link);
+
+  auto countChildren = [](TiXmlElement *_elem, const std::string &_name)
+  {
+    int children = 0;
+    for (TiXmlElement *child = _elem->FirstChildElement(_name); child;
+         child = child->NextSiblingElement(_name))
+    {
+      ++children;
+    }
+    return children;
+  };
+
+  // Each key keeps the value of the last extension, and the blobs of all
+  // the extensions are kept in order.
+  EXPECT_EQ(1, countChildren(link, "gravity"));
+  ASSERT_EQ(1, countChildren(link, "self_collide"));
+  EXPECT_STREQ("1", link->FirstChildElement("self_collide")->GetText());
+  ASSERT_EQ(count, countChildren(link, "sensor"));
+  EXPECT_STREQ("sensor0",
+      link->FirstChildElement("sensor")->Attribute("name"));
+
+  TiXmlElement *collision = link->FirstChildElement("collision");
+  ASSERT_NE(nullptr, collision);
+  EXPECT_EQ(1, countChildren(collision, "surface"));
+  ASSERT_EQ(1, countChildren(collision, "max_contacts"));
+  EXPECT_STREQ(std::to_string(count - 1).c_str(),
+      collision->FirstChildElement("max_contacts")->GetText());
+  TiXmlElement *mu = collision->FirstChildElement("surface")
+      ->FirstChildElement("friction")->FirstChildElement("ode")
+      ->FirstChildElement("mu");
+  ASSERT_NE(nullptr, mu);
+  EXPECT_STREQ(std::to_string(count - 1).c_str(), mu->GetText());
+  EXPECT_EQ(nullptr, mu->NextSiblingElement("mu"));
+}
+
 /////////////////////////////////////////////////
 /// Main
 int main(int argc, char **argv)
@@ -0,0 +1,437 @@
+/*
+ * Copyright 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+// Benchmarks for each stage of loading an SDFormat file.
+//
+// Every benchmark reports the time per iteration and, in the "allocs"
+// counter, the number of heap allocations per iteration. The world
+// benchmarks are run on synthetic worlds of 10, 100, 1000 and 10000
+// models, so that results can be compared between releases, for example
+// with:
+//
+//   BENCHMARK_sdformat --benchmark_out=results.json --benchmark_out_format=json
+
+#include <benchmark/benchmark.h>
+#include <tinyxml.h>
+
+#include <atomic>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "sdf/Element.hh"
+#include "sdf/Error.hh"
+#include "sdf/Filesystem.hh"
+#include "sdf/Model.hh"
+#include "sdf/Root.hh"
+#include "sdf/SDFImpl.hh"
+#include "sdf/World.hh"
+#include "sdf/parser.hh"
+#include "sdf/sdf_config.h"
+
+#include "Converter.hh"
+#include "FrameSemantics.hh"
+#include "parser_urdf.hh"
+#include "test_config.h"
+
+/// \brief Number of heap allocations made while counting is enabled.
+static std::atomic<std::size_t> g_allocationCount{0};
+
+/// \brief True while allocations are counted.
+static std::atomic<bool> g_countAllocations{false};
+
+/////////////////////////////////////////////////
+void *operator new(std::size_t _size)
+{
+  if (g_countAllocations.load(std::memory_order_relaxed))
+    g_allocationCount.fetch_add(1, std::memory_order_relaxed);
+
+  if (void *ptr = std::malloc(_size == 0 ? 1 : _size))
+    return ptr;
+  throw std::bad_alloc();
+}
+
+/////////////////////////////////////////////////
+void operator delete(void *_ptr) noexcept
+{
+  std::free(_ptr);
+}
+
+/////////////////////////////////////////////////
+void operator delete(void *_ptr, std::size_t) noexcept
+{
+  std::free(_ptr);
+}
+
+/////////////////////////////////////////////////
+/// \brief Counts the heap allocations of a benchmark and reports them per
+/// iteration when destroyed.
+class AllocationCounter
+{
+  /// \brief Constructor. Starts counting.
+  /// \param[in] _state State of the benchmark.
+  public: explicit AllocationCounter(benchmark::State &_state)
+    : state(_state), start(g_allocationCount.load())
+  {
+    g_countAllocations = true;
+  }
+
+  /// \brief Destructor. Stops counting and reports the allocations.
+  public: ~AllocationCounter()
+  {
+    g_countAllocations = false;
+    this->state.counters["allocs"] = benchmark::Counter(
+        static_cast<double>(g_allocationCount.load() - this->start),
+        benchmark::Counter::kAvgIterations);
+  }
+
+  /// \brief Pause timing and counting, to prepare the next iteration.
+  public: void Pause()
+  {
+    this->state.PauseTiming();
+    g_countAllocations = false;
+  }
+
+  /// \brief Resume timing and counting after Pause.
+  public: void Resume()
+  {
+    g_countAllocations = true;
+    this->state.ResumeTiming();
+  }
+
+  /// \brief State of the benchmark.
+  private: benchmark::State &state;
+
+  /// \brief Allocation count when counting started.
+  private: std::size_t start;
+};
+
+/////////////////////////////////////////////////
+/// \brief Generate a world of models that each have two links connected
+/// by a revolute joint.
+/// \param[in] _modelCount Number of models.
+/// \param[in] _version SDFormat version of the generated world.
+/// \return The world as an SDFormat string.
+std::string syntheticWorld(int64_t _modelCount, const std::string &_version)
+{
+  std::ostringstream stream;
+  stream << "<?xml version='1.0'?>\n"
+         << "<sdf version='" << _version << "'>\n"
+         << "<world name='default'>\n";
+  for (int64_t i = 0; i < _modelCount; ++i)
+  {
+    stream << "<model name='model" << i << "'>\n"
+           << "  <pose>" << i << " 0 0 0 0 0</pose>\n";
+    for (const char *link : {"base", "arm"})
+    {
+      stream << "  <link name='" << link << "'>\n"
+             << "    <pose>0 0 1 0 0 0</pose>\n"
+             << "    <inertial><mass>1</mass></inertial>\n"
+             << "    <collision name='collision'>\n"
+             << "      <geometry><box><size>1 1 1</size></box></geometry>\n"
+             << "    </collision>\n"
+             << "    <visual name='visual'>\n"
+             << "      <geometry><box><size>1 1 1</size></box></geometry>\n"
+             << "    </visual>\n"
+             << "  </link>\n";
+    }
+    stream << "  <joint name='joint' type='revolute'>\n"
+           << "    <parent>base</parent>\n"
+           << "    <child>arm</child>\n"
+           << "    <axis><xyz>0 0 1</xyz></axis>\n"
+           << "  </joint>\n"
+           << "</model>\n";
+  }
+  stream << "</world>\n</sdf>\n";
+  return stream.str();
+}
+
+/////////////////////////////////////////////////
+/// \brief Generate a URDF robot made of a chain of links.
+/// \param[in] _linkCount Number of links.
+/// \return The robot as a URDF string.
+std::string syntheticUrdf(int64_t _linkCount)
+{
+  std::ostringstream stream;
+  stream << "<?xml version='1.0'?>\n<robot name='chain'>\n";
+  for (int64_t i = 0; i < _linkCount; ++i)
+  {
+    stream << "<link name='link" << i << "'>\n"
+           << "  <inertial>\n"
+           << "    <mass value='1'/>\n"
+           << "    <inertia ixx='1' ixy='0' ixz='0' iyy='1' iyz='0' izz='1'/>\n"
+           << "  </inertial>\n"
+           << "  <visual><geometry><box size='1 1 1'/></geometry></visual>\n"
+           << "  <collision><geometry><box size='1 1 1'/></geometry>"
+           << "</collision>\n"
+           << "</link>\n";
+    if (i > 0)
+    {
+      stream << "<joint name='joint" << i << "' type='revolute'>\n"
+             << "  <parent link='link" << i - 1 << "'/>\n"
+             << "  <child link='link" << i << "'/>\n"
+             << "  <origin xyz='0 0 1' rpy='0 0 0'/>\n"
+             << "  <axis xyz='0 0 1'/>\n"
+             << "  <limit lower='-1' upper='1' effort='1' velocity='1'/>\n"
+             << "</joint>\n";
+    }
+  }
+  stream << "</robot>\n";
+  return stream.str();
+}
+
+/////////////////////////////////////////////////
+/// \brief Load a world, aborting the benchmark on errors.
+/// \param[in] _state State of the benchmark.
+/// \param[out] _root Root to load the world into.
+/// \param[in] _sdf SDFormat string of the world.
+/// \return The loaded world, or nullptr on error.
+const sdf::World *loadWorld(benchmark::State &_state, sdf::Root &_root,
+    const std::string &_sdf)
+{
+  sdf::Errors errors = _root.LoadSdfString(_sdf);
+  if (!errors.empty() || _root.WorldCount() == 0)
+  {
+    _state.SkipWithError("Failed to load the synthetic world");
+    return nullptr;
+  }
+  return _root.WorldByIndex(0);
+}
+
+/////////////////////////////////////////////////
+/// \brief sdf::init, which builds the element descriptions of the spec.
+void BM_Init(benchmark::State &_state)
+{
+  AllocationCounter counter(_state);
+  for (auto _ : _state)
+  {
+    sdf::SDFPtr sdfParsed(new sdf::SDF());
+    benchmark::DoNotOptimize(sdf::init(sdfParsed));
+  }
+}
+BENCHMARK(BM_Init)->Unit(benchmark::kMicrosecond);
+
+/////////////////////////////////////////////////
+/// \brief TinyXML parse of a world string.
+void BM_TinyXmlParse(benchmark::State &_state)
+{
+  const std::string world = syntheticWorld(_state.range(0), SDF_VERSION);
+  AllocationCounter counter(_state);
+  for (auto _ : _state)
+  {
+    TiXmlDocument doc;
+    doc.Parse(world.c_str());
+    benchmark::DoNotOptimize(doc.Error());
+  }
+  _state.SetItemsProcessed(_state.iterations() * _state.range(0));
+}
+
+/////////////////////////////////////////////////
+/// \brief Converter::Convert of a 1.4 world to the current version.
+void BM_Convert(benchmark::State &_state)
+{
+  const std::string world = syntheticWorld(_state.range(0), "1.4");
+  AllocationCounter counter(_state);
+  for (auto _ : _state)
+  {
+    counter.Pause();
+    TiXmlDocument doc;
+    doc.Parse(world.c_str());
+    counter.Resume();
+
+    benchmark::DoNotOptimize(sdf::Converter::Convert(&doc, SDF_VERSION, true));
+  }
+  _state.SetItemsProcessed(_state.iterations() * _state.range(0));
+}
+
+/////////////////////////////////////////////////
+/// \brief sdf::readString into an initialized SDF, which is the TinyXML
+/// parse followed by readXml. Subtract BM_TinyXmlParse for readXml alone.
+void BM_ReadString(benchmark::State &_state)
+{
+  const std::string world = syntheticWorld(_state.range(0), SDF_VERSION);
+  AllocationCounter counter(_state);
+  for (auto _ : _state)
+  {
+    counter.Pause();
+    sdf::SDFPtr sdfParsed(new sdf::SDF());
+    sdf::init(sdfParsed);
+    counter.Resume();
+
+    sdf::Errors errors;
+    benchmark::DoNotOptimize(sdf::readString(world, sdfParsed, errors));
+
+    counter.Pause();
+    sdfParsed.reset();
+    counter.Resume();
+  }
+  _state.SetItemsProcessed(_state.iterations() * _state.range(0));
+}
+
+/////////////////////////////////////////////////
+/// \brief Root::LoadSdfString, which reads the string and builds the DOM.
+void BM_RootLoad(benchmark::State &_state)
+{
+  const std::string world = syntheticWorld(_state.range(0), SDF_VERSION);
+  AllocationCounter counter(_state);
+  for (auto _ : _state)
+  {
+    counter.Pause();
+    auto root = std::make_unique<sdf::Root>();
+    counter.Resume();
+
+    sdf::Errors errors = root->LoadSdfString(world);
+    benchmark::DoNotOptimize(errors);
+
+    counter.Pause();
+    root.reset();
+    counter.Resume();
+  }
+  _state.SetItemsProcessed(_state.iterations() * _state.range(0));
+}
+
+/////////////////////////////////////////////////
+/// \brief buildPoseRelativeToGraph of a loaded world.
+void BM_BuildPoseRelativeToGraph(benchmark::State &_state)
+{
+  sdf::Root root;
+  const sdf::World *world = loadWorld(_state, root,
+      syntheticWorld(_state.range(0), SDF_VERSION));
+  if (!world)
+    return;
+
+  AllocationCounter counter(_state);
+  for (auto _ : _state)
+  {
+    sdf::PoseRelativeToGraph graph;
+    benchmark::DoNotOptimize(sdf::buildPoseRelativeToGraph(graph, world));
+  }
+  _state.SetItemsProcessed(_state.iterations() * _state.range(0));
+}
+
+/////////////////////////////////////////////////
+/// \brief resolvePose of every model of a world relative to the world.
+void BM_ResolvePose(benchmark::State &_state)
+{
+  sdf::Root root;
+  const sdf::World *world = loadWorld(_state, root,
+      syntheticWorld(_state.range(0), SDF_VERSION));
+  if (!world)
+    return;
+
+  sdf::PoseRelativeToGraph graph;
+  if (!sdf::buildPoseRelativeToGraph(graph, world).empty())
+  {
+    _state.SkipWithError("Failed to build the pose graph");
+    return;
+  }
+
+  std::vector<std::string> names;
+  for (uint64_t i = 0; i < world->ModelCount(); ++i)
+    names.push_back(world->ModelByIndex(i)->Name());
+
+  AllocationCounter counter(_state);
+  for (auto _ : _state)
+  {
+    for (const auto &name : names)
+    {
+      ignition::math::Pose3d pose;
+      benchmark::DoNotOptimize(
+          sdf::resolvePose(pose, graph, name, "world"));
+    }
+  }
+  _state.SetItemsProcessed(_state.iterations() * _state.range(0));
+}
+
+/////////////////////////////////////////////////
+/// \brief Element::ToString of a loaded world.
+void BM_ElementToString(benchmark::State &_state)
+{
+  sdf::Root root;
+  if (!loadWorld(_state, root, syntheticWorld(_state.range(0), SDF_VERSION)))
+    return;
+
+  AllocationCounter counter(_state);
+  for (auto _ : _state)
+  {
+    benchmark::DoNotOptimize(root.Element()->ToString(""));
+  }
+  _state.SetItemsProcessed(_state.iterations() * _state.range(0));
+}
+
+/////////////////////////////////////////////////
+/// \brief URDF2SDF::InitModelString of a chain of links.
+void BM_URDF2SDF(benchmark::State &_state)
+{
+  const std::string urdf = syntheticUrdf(_state.range(0));
+  AllocationCounter counter(_state);
+  for (auto _ : _state)
+  {
+    sdf::URDF2SDF u2g;
+    TiXmlDocument doc = u2g.InitModelString(urdf);
+    benchmark::DoNotOptimize(doc.Error());
+  }
+  _state.SetItemsProcessed(_state.iterations() * _state.range(0));
+}
+
+/////////////////////////////////////////////////
+/// \brief URDF2SDF::InitModelString of the Atlas robot of the performance
+/// tests, run concurrently by every benchmark thread.
+void BM_URDF2SDFAtlas(benchmark::State &_state)
+{
+  static const std::string urdf = []()
+  {
+    std::ifstream file(sdf::filesystem::append(PROJECT_SOURCE_PATH, "test",
+        "performance", "parser_urdf_atlas.urdf"));
+    std::ostringstream stream;
+    stream << file.rdbuf();
+    return stream.str();
+  }();
+
+  for (auto _ : _state)
+  {
+    sdf::URDF2SDF u2g;
+    TiXmlDocument doc = u2g.InitModelString(urdf);
+    benchmark::DoNotOptimize(doc.Error());
+  }
+  _state.SetItemsProcessed(_state.iterations());
+}
+
+BENCHMARK(BM_TinyXmlParse)
+  ->RangeMultiplier(10)->Range(10, 10000)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_Convert)
+  ->RangeMultiplier(10)->Range(10, 10000)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_ReadString)
+  ->RangeMultiplier(10)->Range(10, 10000)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_RootLoad)
+  ->RangeMultiplier(10)->Range(10, 10000)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_BuildPoseRelativeToGraph)
+  ->RangeMultiplier(10)->Range(10, 10000)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_ResolvePose)
+  ->RangeMultiplier(10)->Range(10, 10000)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_ElementToString)
+  ->RangeMultiplier(10)->Range(10, 10000)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_URDF2SDF)
+  ->RangeMultiplier(10)->Range(10, 1000)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_URDF2SDFAtlas)
+  ->ThreadRange(1, 8)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
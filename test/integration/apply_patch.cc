@@ -0,0 +1,169 @@
+/*
+ * Copyright 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <string>
+#include <gtest/gtest.h>
+
+#include "sdf/Element.hh"
+#include "sdf/Frame.hh"
+#include "sdf/Model.hh"
+#include "sdf/Root.hh"
+#include "sdf/World.hh"
+
+/////////////////////////////////////////////////
+/// \brief Load a world with two models and a frame attached to one of them.
+/// \param[out] _root The root.
+void loadWorld(sdf::Root &_root)
+{
+  const std::string sdf = R"(
+<sdf version="1.8">
+  <world name="default">
+    <model name="box">
+      <pose>1 0 0 0 0 0</pose>
+      <link name="link"/>
+    </model>
+    <model name="sphere">
+      <pose>0 2 0 0 0 0</pose>
+      <link name="link"/>
+    </model>
+    <frame name="above_box" attached_to="box">
+      <pose relative_to="box">0 0 1 0 0 0</pose>
+    </frame>
+  </world>
+</sdf>)";
+  ASSERT_TRUE(_root.LoadSdfString(sdf).empty());
+}
+
+/////////////////////////////////////////////////
+TEST(ApplyPatch, AddReplaceRemove)
+{
+  sdf::Root root;
+  loadWorld(root);
+
+  const std::string patch = R"(
+<patch world="default">
+  <add>
+    <model name="cylinder">
+      <pose relative_to="box">0 0 3 0 0 0</pose>
+      <link name="link"/>
+    </model>
+  </add>
+  <replace>
+    <model name="sphere">
+      <pose>0 5 0 0 0 0</pose>
+      <link name="link"/>
+      <link name="other_link"/>
+    </model>
+  </replace>
+</patch>)";
+  sdf::Errors errors = root.ApplyPatch(patch);
+  EXPECT_TRUE(errors.empty());
+
+  const sdf::World *world = root.WorldByIndex(0);
+  ASSERT_NE(nullptr, world);
+  EXPECT_EQ(3u, world->ModelCount());
+
+  const sdf::Model *cylinder = world->ModelByName("cylinder");
+  ASSERT_NE(nullptr, cylinder);
+  ignition::math::Pose3d pose;
+  EXPECT_TRUE(cylinder->SemanticPose().Resolve(pose, "world").empty());
+  EXPECT_EQ(ignition::math::Pose3d(1, 0, 3, 0, 0, 0), pose);
+
+  const sdf::Model *sphere = world->ModelByName("sphere");
+  ASSERT_NE(nullptr, sphere);
+  EXPECT_EQ(2u, sphere->LinkCount());
+  EXPECT_TRUE(sphere->SemanticPose().Resolve(pose, "world").empty());
+  EXPECT_EQ(ignition::math::Pose3d(0, 5, 0, 0, 0, 0), pose);
+
+  // The elements of the world follow the patch.
+  sdf::ElementPtr worldElem = world->Element();
+  ASSERT_NE(nullptr, worldElem);
+  EXPECT_NE(nullptr, worldElem->FindElement("model"));
+  std::size_t modelElemCount = 0;
+  for (sdf::ElementPtr elem = worldElem->GetElementImpl("model"); elem;
+       elem = elem->GetNextElement("model"))
+  {
+    ++modelElemCount;
+  }
+  EXPECT_EQ(3u, modelElemCount);
+
+  // The box has a frame attached to it, so it can't be removed.
+  errors = root.ApplyPatch("<patch><remove name='box'/></patch>");
+  EXPECT_FALSE(errors.empty());
+  EXPECT_NE(nullptr, world->ModelByName("box"));
+
+  errors = root.ApplyPatch(
+      "<patch><remove name='sphere'/><remove name='cylinder'/></patch>");
+  EXPECT_TRUE(errors.empty());
+  EXPECT_EQ(1u, world->ModelCount());
+  EXPECT_EQ(nullptr, world->ModelByName("sphere"));
+  ASSERT_NE(nullptr, world->ModelByIndex(0));
+  EXPECT_EQ("box", world->ModelByIndex(0)->Name());
+
+  // Adding a model with the name of another is an error.
+  errors = root.ApplyPatch(
+      "<patch><add><model name='box'><link name='l'/></model></add></patch>");
+  EXPECT_FALSE(errors.empty());
+  EXPECT_EQ(1u, world->ModelCount());
+}
+
+/////////////////////////////////////////////////
+TEST(ApplyPatch, Pose)
+{
+  sdf::Root root;
+  loadWorld(root);
+
+  sdf::Errors errors = root.ApplyPatch(
+      "<patch><pose name='box' relative_to='sphere'>1 0 0 0 0 0</pose>"
+      "</patch>");
+  EXPECT_TRUE(errors.empty());
+
+  const sdf::World *world = root.WorldByIndex(0);
+  const sdf::Model *box = world->ModelByName("box");
+  ignition::math::Pose3d pose;
+  EXPECT_TRUE(box->SemanticPose().Resolve(pose, "world").empty());
+  EXPECT_EQ(ignition::math::Pose3d(1, 2, 0, 0, 0, 0), pose);
+
+  // The frame attached to the box moves with it.
+  EXPECT_TRUE(world->FrameByName("above_box")->SemanticPose().Resolve(
+        pose, "world").empty());
+  EXPECT_EQ(ignition::math::Pose3d(1, 2, 1, 0, 0, 0), pose);
+
+  sdf::ElementPtr poseElem = box->Element()->GetElement("pose");
+  EXPECT_EQ("sphere", poseElem->GetAttribute("relative_to")->GetAsString());
+  EXPECT_EQ(ignition::math::Pose3d(1, 0, 0, 0, 0, 0),
+            poseElem->Get<ignition::math::Pose3d>());
+}
+
+/////////////////////////////////////////////////
+TEST(ApplyPatch, Invalid)
+{
+  sdf::Root root;
+  loadWorld(root);
+
+  EXPECT_FALSE(root.ApplyPatch("not xml").empty());
+  EXPECT_FALSE(root.ApplyPatch("<patch world='other'/>").empty());
+  EXPECT_FALSE(root.ApplyPatch("<patch><rename/></patch>").empty());
+  EXPECT_FALSE(root.ApplyPatch(
+        "<patch><pose name='missing'>0 0 0 0 0 0</pose></patch>").empty());
+
+  // The operations before the first error are applied.
+  EXPECT_FALSE(root.ApplyPatch(
+        "<patch><remove name='sphere'/><remove name='missing'/></patch>")
+      .empty());
+  EXPECT_EQ(1u, root.WorldByIndex(0)->ModelCount());
+}
@@ -0,0 +1,262 @@
+/*
+ * Copyright 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <gtest/gtest.h>
+
+#include "sdf/Filesystem.hh"
+#include "sdf/Link.hh"
+#include "sdf/Model.hh"
+#include "sdf/ParserConfig.hh"
+#include "sdf/Root.hh"
+#include "sdf/World.hh"
+#include "sdf/parser.hh"
+#include "test_config.h"
+
+const auto g_testPath = sdf::filesystem::append(PROJECT_SOURCE_PATH, "test");
+
+/////////////////////////////////////////////////
+std::string findFileCb(const std::string &_input)
+{
+  return sdf::filesystem::append(g_testPath, "integration", "model", _input);
+}
+
+/////////////////////////////////////////////////
+/// \brief Get a path for a binary file written by a test.
+/// \param[in] _name Name of the file.
+/// \return Path of the file in the build directory.
+std::string binaryPath(const std::string &_name)
+{
+  return sdf::filesystem::append(PROJECT_BINARY_DIR, "test", _name);
+}
+
+/////////////////////////////////////////////////
+/// \brief Read a whole file.
+/// \param[in] _filename Path of the file.
+/// \return Contents of the file.
+std::string readAll(const std::string &_filename)
+{
+  std::ifstream in(_filename, std::ios::binary);
+  return std::string(std::istreambuf_iterator<char>(in),
+                     std::istreambuf_iterator<char>());
+}
+
+/////////////////////////////////////////////////
+TEST(BinaryFormat, RoundTripIncludes)
+{
+  sdf::setFindCallback(findFileCb);
+
+  const auto worldFile =
+    sdf::filesystem::append(g_testPath, "sdf", "includes.sdf");
+
+  sdf::Root root;
+  sdf::Errors errors = root.Load(worldFile);
+  for (auto e : errors)
+    std::cout << e.Message() << std::endl;
+  ASSERT_TRUE(errors.empty());
+
+  const std::string binaryFile = binaryPath("binary_format_includes.sdfb");
+  errors = root.SaveBinary(binaryFile);
+  EXPECT_TRUE(errors.empty());
+
+  sdf::Root binaryRoot;
+  errors = binaryRoot.LoadBinary(binaryFile);
+  for (auto e : errors)
+    std::cout << e.Message() << std::endl;
+  EXPECT_TRUE(errors.empty());
+
+  ASSERT_NE(nullptr, binaryRoot.Element());
+  EXPECT_EQ(root.Element()->ToString(""), binaryRoot.Element()->ToString(""));
+  EXPECT_EQ(worldFile, binaryRoot.Element()->FilePath());
+  EXPECT_EQ("1.6", binaryRoot.Element()->OriginalVersion());
+  EXPECT_EQ(root.Version(), binaryRoot.Version());
+
+  ASSERT_EQ(1u, binaryRoot.WorldCount());
+  const sdf::World *world = root.WorldByIndex(0);
+  const sdf::World *binaryWorld = binaryRoot.WorldByIndex(0);
+  ASSERT_NE(nullptr, binaryWorld);
+  EXPECT_EQ(world->Name(), binaryWorld->Name());
+  EXPECT_EQ("1.6", binaryWorld->Element()->OriginalVersion());
+  EXPECT_EQ(world->ActorCount(), binaryWorld->ActorCount());
+  EXPECT_EQ(world->LightCount(), binaryWorld->LightCount());
+  ASSERT_EQ(world->ModelCount(), binaryWorld->ModelCount());
+  for (uint64_t i = 0; i < world->ModelCount(); ++i)
+  {
+    const sdf::Model *model = world->ModelByIndex(i);
+    const sdf::Model *binaryModel = binaryWorld->ModelByIndex(i);
+    ASSERT_NE(nullptr, binaryModel);
+    EXPECT_EQ(model->Name(), binaryModel->Name());
+    EXPECT_EQ(model->RawPose(), binaryModel->RawPose());
+    EXPECT_EQ(model->LinkCount(), binaryModel->LinkCount());
+    EXPECT_EQ(model->Element()->FilePath(),
+              binaryModel->Element()->FilePath());
+    EXPECT_EQ(model->Element()->GetInclude(),
+              binaryModel->Element()->GetInclude());
+  }
+
+  // Writing the loaded binary document again gives the same bytes.
+  const std::string binaryFile2 = binaryPath("binary_format_includes2.sdfb");
+  EXPECT_TRUE(binaryRoot.SaveBinary(binaryFile2).empty());
+  EXPECT_EQ(readAll(binaryFile), readAll(binaryFile2));
+
+  // Generating the objects lazily.
+  sdf::ParserConfig config;
+  config.SetLazyDomLoading(true);
+  sdf::Root lazyRoot;
+  EXPECT_TRUE(lazyRoot.LoadBinary(binaryFile, config).empty());
+  ASSERT_EQ(1u, lazyRoot.WorldCount());
+  EXPECT_EQ(world->ModelCount(), lazyRoot.WorldByIndex(0)->ModelCount());
+  EXPECT_TRUE(lazyRoot.LoadDeferred().empty());
+}
+
+/////////////////////////////////////////////////
+TEST(BinaryFormat, RoundTripUnknownElements)
+{
+  const std::string sdfString = R"(
+<sdf version='1.8'>
+  <model name='m'>
+    <link name='l'>
+      <pose>1 2 3 0.1 0.2 0.3</pose>
+      <visual name='v'>
+        <geometry><box><size>1 2 3</size></box></geometry>
+        <material><diffuse>0.1 0.2 0.3 0.4</diffuse></material>
+      </visual>
+    </link>
+    <joint name='j' type='revolute'>
+      <parent>world</parent>
+      <child>l</child>
+      <axis><xyz>0 0 1</xyz><limit><lower>-1.5</lower></limit></axis>
+    </joint>
+    <plugin name='p' filename='libp.so'>
+      <custom attr='x'>text <nested/> </custom>
+      <number>42</number>
+    </plugin>
+  </model>
+</sdf>)";
+
+  sdf::Root root;
+  sdf::Errors errors = root.LoadSdfString(sdfString);
+  ASSERT_TRUE(errors.empty());
+
+  const std::string binaryFile = binaryPath("binary_format_unknown.sdfb");
+  EXPECT_TRUE(root.SaveBinary(binaryFile).empty());
+
+  sdf::Root binaryRoot;
+  errors = binaryRoot.LoadBinary(binaryFile);
+  for (auto e : errors)
+    std::cout << e.Message() << std::endl;
+  EXPECT_TRUE(errors.empty());
+  ASSERT_NE(nullptr, binaryRoot.Element());
+  EXPECT_EQ(root.Element()->ToString(""), binaryRoot.Element()->ToString(""));
+
+  const sdf::Model *model = binaryRoot.ModelByIndex(0);
+  ASSERT_NE(nullptr, model);
+  EXPECT_EQ(ignition::math::Pose3d(1, 2, 3, 0.1, 0.2, 0.3),
+            model->LinkByIndex(0)->RawPose());
+
+  sdf::ElementPtr plugin = model->Element()->GetElement("plugin");
+  ASSERT_NE(nullptr, plugin);
+  ASSERT_TRUE(plugin->HasElement("custom"));
+  sdf::ElementPtr custom = plugin->GetElement("custom");
+  EXPECT_EQ("x", custom->GetAttribute("attr")->GetAsString());
+  EXPECT_TRUE(custom->HasElement("nested"));
+  EXPECT_EQ("42", plugin->GetElement("number")->GetValue()->GetAsString());
+}
+
+/////////////////////////////////////////////////
+TEST(BinaryFormat, NestingTooDeep)
+{
+  // The contents of a plugin are not part of the spec, so they are not
+  // counted when the xml is read, but they are when a binary document is
+  // read.
+  const int depth = 1000;
+  std::string nested;
+  for (int i = 0; i < depth; ++i)
+    nested += "<a>";
+  for (int i = 0; i < depth; ++i)
+    nested += "</a>";
+  const std::string sdfString =
+      "<sdf version='1.8'><model name='m'><link name='l'/>"
+      "<plugin name='p' filename='libp.so'>" + nested +
+      "</plugin></model></sdf>";
+
+  sdf::Root root;
+  ASSERT_TRUE(root.LoadSdfString(sdfString).empty());
+  const std::string binaryFile = binaryPath("binary_format_nested.sdfb");
+  ASSERT_TRUE(root.SaveBinary(binaryFile).empty());
+
+  sdf::Root deepRoot;
+  sdf::Errors errors = deepRoot.LoadBinary(binaryFile);
+  ASSERT_FALSE(errors.empty());
+  EXPECT_EQ(sdf::ErrorCode::ELEMENT_NESTING_TOO_DEEP, errors[0].Code());
+
+  sdf::ParserConfig config;
+  config.SetMaxNestingDepth(16);
+  errors = deepRoot.LoadBinary(binaryFile, config);
+  ASSERT_FALSE(errors.empty());
+  EXPECT_EQ(sdf::ErrorCode::ELEMENT_NESTING_TOO_DEEP, errors[0].Code());
+  EXPECT_NE(std::string::npos, errors[0].Message().find("16"));
+
+  // Without a limit, the document is read.
+  config.SetMaxNestingDepth(0);
+  EXPECT_TRUE(deepRoot.LoadBinary(binaryFile, config).empty());
+  ASSERT_NE(nullptr, deepRoot.ModelByIndex(0));
+}
+
+/////////////////////////////////////////////////
+TEST(BinaryFormat, Errors)
+{
+  sdf::Root root;
+  EXPECT_FALSE(
+      root.SaveBinary(binaryPath("binary_format_empty.sdfb")).empty());
+
+  // Missing file.
+  sdf::Errors errors = root.LoadBinary(binaryPath("does_not_exist.sdfb"));
+  ASSERT_FALSE(errors.empty());
+  EXPECT_EQ(sdf::ErrorCode::FILE_READ, errors[0].Code());
+
+  // An SDFormat file that is not binary.
+  const auto sdfFile =
+    sdf::filesystem::append(g_testPath, "sdf", "empty.sdf");
+  errors = root.LoadBinary(sdfFile);
+  ASSERT_FALSE(errors.empty());
+  EXPECT_EQ(sdf::ErrorCode::FILE_READ, errors[0].Code());
+
+  // Truncated documents fail to load.
+  ASSERT_TRUE(root.LoadSdfString(
+      "<sdf version='1.8'><model name='m'><link name='l'/></model></sdf>")
+      .empty());
+  const std::string binaryFile = binaryPath("binary_format_errors.sdfb");
+  ASSERT_TRUE(root.SaveBinary(binaryFile).empty());
+  const std::string data = readAll(binaryFile);
+  ASSERT_FALSE(data.empty());
+
+  const std::string truncatedFile =
+    binaryPath("binary_format_truncated.sdfb");
+  for (std::size_t size = 1; size < data.size(); ++size)
+  {
+    {
+      std::ofstream out(truncatedFile, std::ios::binary);
+      out.write(data.data(), static_cast<std::streamsize>(size));
+    }
+    sdf::Root truncatedRoot;
+    EXPECT_FALSE(truncatedRoot.LoadBinary(truncatedFile).empty()) << size;
+  }
+}
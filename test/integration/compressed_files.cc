@@ -0,0 +1,169 @@
+/*
+ * Copyright 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <zlib.h>
+
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <gtest/gtest.h>
+
+#include "sdf/Filesystem.hh"
+#include "sdf/Model.hh"
+#include "sdf/Root.hh"
+#include "sdf/World.hh"
+#include "sdf/parser.hh"
+#include "test_config.h"
+
+const auto g_testPath = sdf::filesystem::append(PROJECT_SOURCE_PATH, "test");
+const auto g_outputPath =
+    sdf::filesystem::append(PROJECT_BINARY_DIR, "test", "compressed_files");
+
+/////////////////////////////////////////////////
+/// \brief Write a copy of a file compressed with gzip.
+/// \param[in] _source Path of the file to compress.
+/// \param[in] _target Path of the compressed file.
+/// \return True if the file was written.
+bool gzipFile(const std::string &_source, const std::string &_target)
+{
+  std::ifstream in(_source, std::ios::binary);
+  const std::string contents((std::istreambuf_iterator<char>(in)),
+                             std::istreambuf_iterator<char>());
+  if (contents.empty())
+    return false;
+
+  gzFile out = gzopen(_target.c_str(), "wb");
+  if (!out)
+    return false;
+  const int written = gzwrite(out, contents.data(),
+      static_cast<unsigned int>(contents.size()));
+  return gzclose(out) == Z_OK &&
+      written == static_cast<int>(contents.size());
+}
+
+/////////////////////////////////////////////////
+TEST(CompressedFiles, SdfWithCompressedInclude)
+{
+  sdf::filesystem::create_directory(g_outputPath);
+  const std::string modelPath =
+    sdf::filesystem::append(g_outputPath, "box");
+  sdf::filesystem::create_directory(modelPath);
+
+  // The model file named by model.config only exists compressed.
+  const std::string boxPath =
+    sdf::filesystem::append(g_testPath, "integration", "model", "box");
+  {
+    std::ifstream in(sdf::filesystem::append(boxPath, "model.config"));
+    std::ofstream out(sdf::filesystem::append(modelPath, "model.config"));
+    out << in.rdbuf();
+  }
+  ASSERT_TRUE(gzipFile(sdf::filesystem::append(boxPath, "model.sdf"),
+      sdf::filesystem::append(modelPath, "model.sdf.gz")));
+
+  const std::string worldString =
+    "<?xml version='1.0'?>\n"
+    "<sdf version='1.8'>\n"
+    "  <world name='default'>\n"
+    "    <include>\n"
+    "      <uri>" + modelPath + "</uri>\n"
+    "      <name>box</name>\n"
+    "    </include>\n"
+    "  </world>\n"
+    "</sdf>\n";
+  const std::string worldPath =
+    sdf::filesystem::append(g_outputPath, "world.sdf");
+  {
+    std::ofstream out(worldPath, std::ios::binary);
+    out << worldString;
+  }
+  const std::string compressedWorldPath = worldPath + ".gz";
+  ASSERT_TRUE(gzipFile(worldPath, compressedWorldPath));
+
+  sdf::Root root;
+  sdf::Errors errors = root.Load(worldPath);
+  for (auto e : errors)
+    std::cout << e.Message() << std::endl;
+  ASSERT_TRUE(errors.empty());
+
+  sdf::Root compressedRoot;
+  errors = compressedRoot.Load(compressedWorldPath);
+  for (auto e : errors)
+    std::cout << e.Message() << std::endl;
+  EXPECT_TRUE(errors.empty());
+  ASSERT_NE(nullptr, compressedRoot.Element());
+  EXPECT_EQ(compressedWorldPath, compressedRoot.Element()->FilePath());
+
+  const sdf::World *world = compressedRoot.WorldByIndex(0);
+  ASSERT_NE(nullptr, world);
+  ASSERT_EQ(1u, world->ModelCount());
+  EXPECT_EQ("box", world->ModelByIndex(0)->Name());
+  EXPECT_EQ(sdf::filesystem::append(modelPath, "model.sdf.gz"),
+            world->ModelByIndex(0)->Element()->FilePath());
+  EXPECT_EQ(root.WorldByIndex(0)->ModelByIndex(0)->LinkCount(),
+            world->ModelByIndex(0)->LinkCount());
+
+  // The model directory is also found directly.
+  sdf::SDFPtr modelSdf = sdf::readFile(modelPath);
+  ASSERT_NE(nullptr, modelSdf);
+  EXPECT_TRUE(modelSdf->Root()->HasElement("model"));
+}
+
+/////////////////////////////////////////////////
+TEST(CompressedFiles, Urdf)
+{
+  sdf::filesystem::create_directory(g_outputPath);
+  const std::string urdfPath =
+    sdf::filesystem::append(g_testPath, "integration",
+        "fixed_joint_reduction.urdf");
+  const std::string compressedPath =
+    sdf::filesystem::append(g_outputPath, "fixed_joint_reduction.urdf.gz");
+  ASSERT_TRUE(gzipFile(urdfPath, compressedPath));
+
+  sdf::SDFPtr expected = sdf::readFile(urdfPath);
+  ASSERT_NE(nullptr, expected);
+  sdf::SDFPtr sdf = sdf::readFile(compressedPath);
+  ASSERT_NE(nullptr, sdf);
+  EXPECT_EQ(expected->Root()->ToString(""), sdf->Root()->ToString(""));
+}
+
+/////////////////////////////////////////////////
+TEST(CompressedFiles, Truncated)
+{
+  sdf::filesystem::create_directory(g_outputPath);
+  const std::string urdfPath =
+    sdf::filesystem::append(g_testPath, "integration",
+        "fixed_joint_reduction.urdf");
+  const std::string compressedPath =
+    sdf::filesystem::append(g_outputPath, "truncated.urdf.gz");
+  ASSERT_TRUE(gzipFile(urdfPath, compressedPath));
+
+  std::string contents;
+  {
+    std::ifstream in(compressedPath, std::ios::binary);
+    contents.assign(std::istreambuf_iterator<char>(in),
+                    std::istreambuf_iterator<char>());
+  }
+  {
+    std::ofstream out(compressedPath, std::ios::binary);
+    out.write(contents.data(),
+        static_cast<std::streamsize>(contents.size() / 2));
+  }
+
+  sdf::Root root;
+  EXPECT_FALSE(root.Load(compressedPath).empty());
+}
@@ -0,0 +1,279 @@
+/*
+ * Copyright 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <atomic>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <ignition/math/Pose3.hh>
+
+#include <gtest/gtest.h>
+
+#include "sdf/Element.hh"
+#include "sdf/Filesystem.hh"
+#include "sdf/Frame.hh"
+#include "sdf/Link.hh"
+#include "sdf/Model.hh"
+#include "sdf/ParserConfig.hh"
+#include "sdf/Root.hh"
+#include "sdf/SemanticPose.hh"
+#include "sdf/SDFImpl.hh"
+#include "sdf/parser.hh"
+#include "test_config.h"
+
+const auto g_testPath = sdf::filesystem::append(PROJECT_SOURCE_PATH, "test");
+const auto g_modelsPath =
+    sdf::filesystem::append(g_testPath, "integration", "model");
+
+/////////////////////////////////////////////////
+std::string findFileCb(const std::string &_input)
+{
+  return sdf::filesystem::append(g_modelsPath, _input);
+}
+
+/////////////////////////////////////////////////
+/// \brief Load a file and return its element tree as a string, or an empty
+/// string if loading failed.
+std::string loadToString(const std::string &_file)
+{
+  sdf::Root root;
+  sdf::Errors errors = root.Load(_file);
+  if (!errors.empty() || !root.Element())
+    return "";
+  return root.Element()->ToString("");
+}
+
+/////////////////////////////////////////////////
+/// Load SDF files with includes and URDF files from several threads at once,
+/// while URI paths are being registered, and check that every thread gets
+/// the same result as a single-threaded load.
+TEST(ConcurrentParse, ReadFileFromManyThreads)
+{
+  sdf::setFindCallback(findFileCb);
+
+  const std::vector<std::string> files = {
+    sdf::filesystem::append(g_testPath, "sdf", "includes.sdf"),
+    sdf::filesystem::append(g_testPath, "integration",
+        "fixed_joint_reduction.urdf"),
+  };
+
+  std::vector<std::string> expected;
+  for (const auto &file : files)
+  {
+    expected.push_back(loadToString(file));
+    ASSERT_FALSE(expected.back().empty()) << file;
+  }
+
+  const unsigned int threadCount = 8;
+  const unsigned int iterations = 4;
+  std::atomic<unsigned int> mismatches{0};
+  std::atomic<bool> done{false};
+
+  // Keep modifying the URI map while the other threads call findFile.
+  std::thread uriThread([&done]()
+  {
+    for (unsigned int i = 0; i < 1000u && !done; ++i)
+      sdf::addURIPath("concurrent://", g_modelsPath);
+  });
+
+  std::vector<std::thread> threads;
+  for (unsigned int t = 0; t < threadCount; ++t)
+  {
+    threads.emplace_back([&, t]()
+    {
+      for (unsigned int i = 0; i < iterations; ++i)
+      {
+        const size_t index = (t + i) % files.size();
+        if (loadToString(files[index]) != expected[index])
+          ++mismatches;
+      }
+    });
+  }
+
+  for (auto &thread : threads)
+    thread.join();
+  done = true;
+  uriThread.join();
+
+  EXPECT_EQ(0u, mismatches);
+}
+
+/////////////////////////////////////////////////
+/// Resolve files from several threads at once while other threads
+/// register URI paths and replace the find callback, and check that every
+/// lookup finds the paths registered before it.
+TEST(ConcurrentParse, FindFileWhileRegistering)
+{
+  sdf::setFindCallback(findFileCb);
+  sdf::addURIPath("registered://", g_modelsPath);
+  const std::string expected = sdf::findFile("registered://box/model.sdf");
+  ASSERT_FALSE(expected.empty());
+
+  std::atomic<bool> done{false};
+  std::thread uriThread([&done]()
+  {
+    for (unsigned int i = 0; i < 200u && !done; ++i)
+      sdf::addURIPath("other" + std::to_string(i) + "://", g_modelsPath);
+  });
+  std::thread callbackThread([&done]()
+  {
+    for (unsigned int i = 0; i < 1000u && !done; ++i)
+      sdf::setFindCallback(findFileCb);
+  });
+
+  const unsigned int threadCount = 8;
+  std::atomic<unsigned int> mismatches{0};
+  std::vector<std::thread> threads;
+  for (unsigned int t = 0; t < threadCount; ++t)
+  {
+    threads.emplace_back([&]()
+    {
+      for (unsigned int i = 0; i < 200u; ++i)
+      {
+        if (sdf::findFile("registered://box/model.sdf") != expected ||
+            sdf::findFile("box/model.sdf", false, true) !=
+            findFileCb("box/model.sdf"))
+        {
+          ++mismatches;
+        }
+      }
+    });
+  }
+
+  for (auto &thread : threads)
+    thread.join();
+  done = true;
+  uriThread.join();
+  callbackThread.join();
+
+  EXPECT_EQ(0u, mismatches);
+}
+
+/////////////////////////////////////////////////
+/// \brief Generate a document with top level models, each with a link
+/// placed relative to another link and a frame attached to it.
+/// \param[in] _modelCount Number of models.
+/// \return The SDF string.
+std::string modelsString(unsigned int _modelCount)
+{
+  std::ostringstream stream;
+  stream << "<sdf version='1.7'>";
+  for (unsigned int i = 0; i < _modelCount; ++i)
+  {
+    stream << "<model name='model" << i << "'>"
+           << "<link name='base'><pose>" << i << " 0 0 0 0 0</pose></link>"
+           << "<link name='arm'>"
+           << "<pose relative_to='base'>0 " << i << " 1 0 0 0</pose>"
+           << "</link>"
+           << "<frame name='tip' attached_to='arm'>"
+           << "<pose>0 0 " << i << " 0 0 0</pose>"
+           << "</frame>"
+           << "</model>";
+  }
+  stream << "</sdf>";
+  return stream.str();
+}
+
+/////////////////////////////////////////////////
+/// \brief Read the poses of the links and frames of every model of a root,
+/// starting from a given model, as a string.
+/// \param[in] _root The root.
+/// \param[in] _first Index of the first model read.
+/// \return The poses, or an empty string on error.
+std::string readPoses(const sdf::Root &_root, unsigned int _first)
+{
+  std::ostringstream stream;
+  const unsigned int count = static_cast<unsigned int>(_root.ModelCount());
+  for (unsigned int i = 0; i < count; ++i)
+  {
+    const unsigned int index = (_first + i) % count;
+    const std::string name = "model" + std::to_string(index);
+    if (!_root.ModelNameExists(name))
+      return "";
+    const sdf::Model *model = _root.ModelByIndex(index);
+    const sdf::Link *arm = model ? model->LinkByName("arm") : nullptr;
+    const sdf::Frame *tip = model ? model->FrameByName("tip") : nullptr;
+    if (!arm || !tip || model->Name() != name || !model->Element() ||
+        !model->Element()->FindElement("link"))
+    {
+      return "";
+    }
+
+    ignition::math::Pose3d armPose, tipPose;
+    if (!arm->SemanticPose().Resolve(armPose, "__model__").empty() ||
+        !tip->SemanticPose().Resolve(tipPose, "arm").empty())
+    {
+      return "";
+    }
+    stream << name << " " << armPose << " " << tipPose << "\n";
+  }
+  return stream.str();
+}
+
+/////////////////////////////////////////////////
+/// Read one lazily loaded root from several threads at once, generating
+/// the models on first access, and check that every thread reads the same
+/// poses as a single-threaded read of an eagerly loaded root.
+TEST(ConcurrentParse, ReadRootFromManyThreads)
+{
+  const unsigned int modelCount = 64;
+  const std::string sdfString = modelsString(modelCount);
+
+  sdf::Root eager;
+  ASSERT_TRUE(eager.LoadSdfString(sdfString).empty());
+  const std::string expected = readPoses(eager, 0);
+  ASSERT_FALSE(expected.empty());
+
+  sdf::ParserConfig config;
+  config.SetLazyDomLoading(true);
+  sdf::Root lazy;
+  ASSERT_TRUE(lazy.LoadSdfString(sdfString, config).empty());
+  ASSERT_EQ(modelCount, lazy.ModelCount());
+
+  const unsigned int threadCount = 8;
+  std::atomic<unsigned int> mismatches{0};
+  std::vector<std::thread> threads;
+  for (unsigned int t = 0; t < threadCount; ++t)
+  {
+    threads.emplace_back([&, t]()
+    {
+      // Each thread starts from another model, so that models are
+      // generated by different threads, and every thread reads models
+      // being generated by the others.
+      const unsigned int first = t * modelCount / threadCount;
+      const std::string poses = readPoses(lazy, first);
+      std::istringstream expectedLines(expected);
+      std::string line;
+      std::ostringstream rotated;
+      std::vector<std::string> lines;
+      while (std::getline(expectedLines, line))
+        lines.push_back(line);
+      for (unsigned int i = 0; i < lines.size(); ++i)
+        rotated << lines[(first + i) % lines.size()] << "\n";
+      if (poses != rotated.str())
+        ++mismatches;
+    });
+  }
+
+  for (auto &thread : threads)
+    thread.join();
+
+  EXPECT_EQ(0u, mismatches);
+  EXPECT_TRUE(lazy.LoadDeferred().empty());
+}
@@ -74,6 +74,59 @@ TEST(ConverterIntegration, ParserFileConverter)
   EXPECT_EQ("1.4", sourceElem->OriginalVersion());
 }
 
+/////////////////////////////////////////////////
+/// Convert an element tree that was read without conversion.
+TEST(ConverterIntegration, ElementConverter)
+{
+  const std::string sdfString = R"(
+<sdf version="1.6">
+  <model name="model">
+    <pose frame="world">1 0 0 0 0 0</pose>
+    <link name="parent"/>
+    <link name="child"/>
+    <joint name="joint" type="revolute">
+      <parent>parent</parent>
+      <child>child</child>
+      <axis>
+        <xyz>0 0 1</xyz>
+        <use_parent_model_frame>true</use_parent_model_frame>
+      </axis>
+    </joint>
+  </model>
+</sdf>)";
+
+  sdf::ParserConfig config;
+  config.SetSpecVersion("1.6");
+  sdf::SDFPtr sdf(new sdf::SDF());
+  ASSERT_TRUE(sdf::init(sdf, config));
+  sdf::Errors errors;
+  ASSERT_TRUE(sdf::readString(sdfString, config, sdf, errors));
+  EXPECT_TRUE(errors.empty());
+
+  sdf::ElementPtr rootElem = sdf->Root();
+  ASSERT_TRUE(sdf::convertElement(rootElem, "1.7"));
+  EXPECT_EQ("1.7", rootElem->Get<std::string>("version"));
+
+  sdf::ElementPtr modelElem = rootElem->GetElement("model");
+  sdf::ElementPtr poseElem = modelElem->GetElement("pose");
+  EXPECT_FALSE(poseElem->HasAttribute("frame"));
+  EXPECT_EQ("world", poseElem->Get<std::string>("relative_to"));
+  EXPECT_EQ(ignition::math::Pose3d(1, 0, 0, 0, 0, 0),
+            poseElem->Get<ignition::math::Pose3d>());
+
+  sdf::ElementPtr axisElem =
+      modelElem->GetElement("joint")->GetElement("axis");
+  EXPECT_FALSE(axisElem->HasElement("use_parent_model_frame"));
+  EXPECT_EQ("__model__",
+      axisElem->GetElement("xyz")->Get<std::string>("expressed_in"));
+
+  // Converting again does nothing, and a tree without version can't be
+  // converted.
+  EXPECT_TRUE(sdf::convertElement(rootElem, "1.7"));
+  EXPECT_FALSE(sdf::convertElement(modelElem, "1.7"));
+  EXPECT_FALSE(sdf::convertElement(nullptr, "1.7"));
+}
+
 /////////////////////////////////////////////////
 /// Convert to a previous SDF version
 TEST(ConverterIntegration, convertFileToNotLatestVersion)
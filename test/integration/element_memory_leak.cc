@@ -15,6 +15,7 @@
  *
  */
 
+#include <cstddef>
 #include <iostream>
 #include <string>
 
@@ -87,11 +88,20 @@ TEST(ElementMemoryLeak, SDFCreateDestroy)
   // Allow 15x increase (based on testing with Ubuntu and OSX)
   memoryLimit *= 15;
 
+  // Every tree has the same footprint.
+  std::size_t treeBytes = 0;
+
   for (unsigned int i = 0; i < 50; ++i)
   {
     sdf::SDF modelSDF;
     modelSDF.SetFromString(sdfString);
 
+    const std::size_t bytes = modelSDF.Root()->MemoryFootprint().total.bytes;
+    EXPECT_LT(0u, bytes);
+    if (i == 0)
+      treeBytes = bytes;
+    EXPECT_EQ(treeBytes, bytes);
+
     int memoryUsage = getMemoryUsage();
     EXPECT_LT(memoryUsage, memoryLimit);
   }
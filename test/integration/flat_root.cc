@@ -0,0 +1,224 @@
+/*
+ * Copyright 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "sdf/FlatRoot.hh"
+#include "sdf/Joint.hh"
+#include "sdf/JointAxis.hh"
+#include "sdf/Link.hh"
+#include "sdf/Model.hh"
+#include "sdf/Root.hh"
+#include "sdf/Sensor.hh"
+#include "sdf/World.hh"
+
+/////////////////////////////////////////////////
+/// \brief Copy a buffer to memory aligned to 8 bytes, as a memory mapping
+/// or shared memory segment would be.
+/// \param[in] _buffer The buffer.
+/// \return The copy.
+std::vector<uint64_t> aligned(const std::string &_buffer)
+{
+  std::vector<uint64_t> words((_buffer.size() + 7) / 8);
+  std::memcpy(words.data(), _buffer.data(), _buffer.size());
+  return words;
+}
+
+/////////////////////////////////////////////////
+TEST(FlatRoot, World)
+{
+  const std::string sdfString = R"(
+<sdf version="1.8">
+  <world name="default">
+    <gravity>0 0 -9.8</gravity>
+    <wind><linear_velocity>1 2 3</linear_velocity></wind>
+    <model name="arm">
+      <pose>1 0 0 0 0 0</pose>
+      <static>false</static>
+      <link name="base">
+        <inertial><mass>5</mass></inertial>
+      </link>
+      <link name="upper">
+        <pose>0 0 1 0 0 0</pose>
+        <inertial>
+          <mass>2</mass>
+          <inertia>
+            <ixx>0.1</ixx><iyy>0.2</iyy><izz>0.3</izz>
+            <ixy>0</ixy><ixz>0</ixz><iyz>0</iyz>
+          </inertia>
+        </inertial>
+        <sensor name="imu" type="imu">
+          <pose>0 0 0.1 0 0 0</pose>
+          <topic>arm/imu</topic>
+          <update_rate>100</update_rate>
+        </sensor>
+      </link>
+      <joint name="shoulder" type="revolute">
+        <parent>base</parent>
+        <child>upper</child>
+        <axis>
+          <xyz>1 0 0</xyz>
+          <limit><lower>-1</lower><upper>2</upper></limit>
+        </axis>
+      </joint>
+    </model>
+    <model name="ground">
+      <static>true</static>
+      <link name="plane"/>
+    </model>
+  </world>
+</sdf>)";
+
+  sdf::Root root;
+  ASSERT_TRUE(root.LoadSdfString(sdfString).empty());
+
+  std::string buffer;
+  EXPECT_TRUE(root.WriteFlat(buffer).empty());
+  EXPECT_EQ(0u, buffer.size() % 8);
+  const std::vector<uint64_t> words = aligned(buffer);
+
+  sdf::FlatRoot flat;
+  ASSERT_TRUE(flat.Open(words.data(), buffer.size()).empty());
+  EXPECT_EQ(root.Version(), flat.Version());
+  EXPECT_EQ(0u, flat.ModelCount());
+  ASSERT_EQ(1u, flat.WorldCount());
+
+  const sdf::World *world = root.WorldByIndex(0);
+  const sdf::FlatWorld flatWorld = flat.WorldByIndex(0);
+  EXPECT_EQ("default", flatWorld.Name());
+  EXPECT_EQ(world->Gravity(), flatWorld.Gravity());
+  EXPECT_EQ(world->MagneticField(), flatWorld.MagneticField());
+  EXPECT_EQ(ignition::math::Vector3d(1, 2, 3),
+            flatWorld.WindLinearVelocity());
+  ASSERT_EQ(2u, flatWorld.ModelCount());
+
+  const sdf::FlatModel arm = flatWorld.ModelByIndex(0);
+  EXPECT_EQ("arm", arm.Name());
+  EXPECT_FALSE(arm.Static());
+  EXPECT_EQ(ignition::math::Pose3d(1, 0, 0, 0, 0, 0), arm.Pose());
+  EXPECT_TRUE(flatWorld.ModelByIndex(1).Static());
+  ASSERT_EQ(2u, arm.LinkCount());
+  ASSERT_EQ(1u, arm.JointCount());
+
+  const sdf::FlatLink base = arm.LinkByIndex(0);
+  EXPECT_EQ("base", base.Name());
+  EXPECT_DOUBLE_EQ(5.0, base.Mass());
+  EXPECT_EQ(0u, base.SensorCount());
+
+  const sdf::Link *upperLink = world->ModelByIndex(0)->LinkByIndex(1);
+  const sdf::FlatLink upper = arm.LinkByIndex(1);
+  EXPECT_EQ("upper", upper.Name());
+  EXPECT_EQ(upperLink->RawPose(), upper.RawPose());
+  EXPECT_EQ(upperLink->RawPose(), upper.Pose());
+  EXPECT_DOUBLE_EQ(2.0, upper.Mass());
+  EXPECT_EQ(upperLink->Inertial().MassMatrix().Moi(), upper.Moi());
+
+  ASSERT_EQ(1u, upper.SensorCount());
+  const sdf::FlatSensor imu = upper.SensorByIndex(0);
+  EXPECT_EQ("imu", imu.Name());
+  EXPECT_EQ(sdf::SensorType::IMU, imu.Type());
+  EXPECT_EQ("arm/imu", imu.Topic());
+  EXPECT_DOUBLE_EQ(100.0, imu.UpdateRate());
+  EXPECT_EQ(ignition::math::Pose3d(0, 0, 0.1, 0, 0, 0), imu.Pose());
+
+  const sdf::FlatJoint shoulder = arm.JointByIndex(0);
+  EXPECT_EQ("shoulder", shoulder.Name());
+  EXPECT_EQ(sdf::JointType::REVOLUTE, shoulder.Type());
+  EXPECT_EQ("base", shoulder.ParentLinkName());
+  EXPECT_EQ("upper", shoulder.ChildLinkName());
+  EXPECT_EQ(0, shoulder.ParentLinkIndex());
+  EXPECT_EQ(1, shoulder.ChildLinkIndex());
+  EXPECT_EQ(upperLink->RawPose(), shoulder.Pose());
+  EXPECT_EQ(1u, shoulder.AxisCount());
+  EXPECT_EQ(ignition::math::Vector3d::UnitX, shoulder.AxisXyz(0));
+  EXPECT_DOUBLE_EQ(-1.0, shoulder.AxisLower(0));
+  EXPECT_DOUBLE_EQ(2.0, shoulder.AxisUpper(0));
+  EXPECT_EQ(ignition::math::Vector3d::Zero, shoulder.AxisXyz(1));
+}
+
+/////////////////////////////////////////////////
+TEST(FlatRoot, Model)
+{
+  const std::string sdfString = R"(
+<sdf version="1.8">
+  <model name="box">
+    <pose>0 0 2 0 0 0</pose>
+    <link name="link"/>
+  </model>
+</sdf>)";
+
+  sdf::Root root;
+  ASSERT_TRUE(root.LoadSdfString(sdfString).empty());
+
+  std::string buffer;
+  EXPECT_TRUE(root.WriteFlat(buffer).empty());
+  const std::vector<uint64_t> words = aligned(buffer);
+
+  sdf::FlatRoot flat;
+  ASSERT_TRUE(flat.Open(words.data(), buffer.size()).empty());
+  EXPECT_EQ(0u, flat.WorldCount());
+  ASSERT_EQ(1u, flat.ModelCount());
+  EXPECT_EQ("box", flat.ModelByIndex(0).Name());
+  EXPECT_EQ(ignition::math::Pose3d(0, 0, 2, 0, 0, 0),
+            flat.ModelByIndex(0).Pose());
+  ASSERT_EQ(1u, flat.ModelByIndex(0).LinkCount());
+  EXPECT_EQ("link", flat.ModelByIndex(0).LinkByIndex(0).Name());
+}
+
+/////////////////////////////////////////////////
+TEST(FlatRoot, InvalidBuffers)
+{
+  const std::string sdfString = R"(
+<sdf version="1.8">
+  <model name="box">
+    <link name="link"/>
+  </model>
+</sdf>)";
+
+  sdf::Root root;
+  ASSERT_TRUE(root.LoadSdfString(sdfString).empty());
+  std::string buffer;
+  EXPECT_TRUE(root.WriteFlat(buffer).empty());
+
+  std::vector<uint64_t> words = aligned(buffer);
+  sdf::FlatRoot flat;
+
+  // Truncated.
+  EXPECT_FALSE(flat.Open(words.data(), buffer.size() - 8).empty());
+  EXPECT_EQ(0u, flat.ModelCount());
+  EXPECT_TRUE(flat.Version().empty());
+
+  // Not aligned.
+  EXPECT_FALSE(flat.Open(
+        reinterpret_cast<const char *>(words.data()) + 1,
+        buffer.size() - 1).empty());
+
+  // Not a flat buffer.
+  const std::vector<uint64_t> zeros(words.size(), 0);
+  EXPECT_FALSE(flat.Open(zeros.data(), buffer.size()).empty());
+
+  // A record outside of the buffer. The last words of the header are the
+  // offset and count of the models that are not in a world.
+  const std::size_t modelCountWord = 8;
+  words[modelCountWord] = 1000000;
+  EXPECT_FALSE(flat.Open(words.data(), buffer.size()).empty());
+  EXPECT_EQ(0u, flat.ModelCount());
+}
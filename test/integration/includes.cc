@@ -15,19 +15,27 @@
  *
  */
 
+#include <algorithm>
+#include <future>
 #include <iostream>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <vector>
 #include <gtest/gtest.h>
 
 #include "sdf/Actor.hh"
 #include "sdf/Collision.hh"
 #include "sdf/Filesystem.hh"
 #include "sdf/Geometry.hh"
+#include "sdf/IncludeCache.hh"
 #include "sdf/Light.hh"
 #include "sdf/Link.hh"
 #include "sdf/Mesh.hh"
 #include "sdf/Model.hh"
+#include "sdf/ParserConfig.hh"
 #include "sdf/parser.hh"
+#include "sdf/PrintConfig.hh"
 #include "sdf/Root.hh"
 #include "sdf/SDFImpl.hh"
 #include "sdf/Visual.hh"
@@ -318,3 +326,441 @@ TEST(IncludesTest, Includes_15_convert)
   EXPECT_EQ("1.6", modelElem->OriginalVersion());
   EXPECT_EQ("1.6", linkElem->OriginalVersion());
 }
+
+//////////////////////////////////////////////////
+TEST(IncludesTest, IncludeCache)
+{
+  sdf::setFindCallback(findFileCb);
+
+  const auto worldFile =
+    sdf::filesystem::append(g_testPath, "sdf", "includes.sdf");
+
+  sdf::Root root;
+  sdf::Errors errors = root.Load(worldFile);
+  EXPECT_TRUE(errors.empty());
+  ASSERT_NE(nullptr, root.Element());
+
+  // Each of the three included files is read once and then cloned for the
+  // second include, which applies its own overrides.
+  auto cache = std::make_shared<sdf::IncludeCache>();
+  sdf::ParserConfig config;
+  config.SetIncludeCache(cache);
+
+  sdf::Root cachedRoot;
+  errors = cachedRoot.Load(worldFile, config);
+  EXPECT_TRUE(errors.empty());
+  ASSERT_NE(nullptr, cachedRoot.Element());
+  EXPECT_EQ(3u, cache->Size());
+  EXPECT_EQ(root.Element()->ToString(""), cachedRoot.Element()->ToString(""));
+
+  // A second load is served entirely from the cache.
+  sdf::Root cachedRoot2;
+  errors = cachedRoot2.Load(worldFile, config);
+  EXPECT_TRUE(errors.empty());
+  ASSERT_NE(nullptr, cachedRoot2.Element());
+  EXPECT_EQ(3u, cache->Size());
+  EXPECT_EQ(root.Element()->ToString(""),
+      cachedRoot2.Element()->ToString(""));
+
+  const sdf::World *world = cachedRoot2.WorldByIndex(0);
+  ASSERT_NE(nullptr, world);
+  EXPECT_TRUE(world->ModelNameExists("test_model"));
+  EXPECT_TRUE(world->ModelNameExists("override_model_name"));
+  EXPECT_TRUE(world->LightNameExists("override_light_name"));
+  EXPECT_TRUE(world->ActorNameExists("override_actor_name"));
+}
+
+//////////////////////////////////////////////////
+TEST(IncludesTest, PreserveIncludes)
+{
+  sdf::setFindCallback(findFileCb);
+
+  const auto worldFile =
+    sdf::filesystem::append(g_testPath, "sdf", "includes.sdf");
+
+  sdf::Root root;
+  sdf::Errors errors = root.Load(worldFile);
+  EXPECT_TRUE(errors.empty());
+  ASSERT_NE(nullptr, root.Element());
+  const std::string expanded = root.Element()->ToString("");
+  EXPECT_NE(std::string::npos, expanded.find("<model name='test_model'>"));
+
+  // Unmodified included elements are printed as their includes.
+  sdf::PrintConfig config;
+  config.SetPreserveIncludes(true);
+  std::string preserved = root.Element()->ToString("", config);
+  EXPECT_LT(preserved.size(), expanded.size());
+  EXPECT_EQ(std::string::npos, preserved.find("<model "));
+  EXPECT_EQ(std::string::npos, preserved.find("<light "));
+  EXPECT_EQ(std::string::npos, preserved.find("<actor "));
+  EXPECT_NE(std::string::npos,
+      preserved.find("<include><uri>test_model</uri></include>"));
+  EXPECT_NE(std::string::npos,
+      preserved.find("<name>override_model_name</name>"));
+
+  // Reading the includes again gives the same elements.
+  sdf::Root reloaded;
+  errors = reloaded.LoadSdfString(preserved);
+  EXPECT_TRUE(errors.empty());
+  ASSERT_NE(nullptr, reloaded.Element());
+  EXPECT_EQ(expanded, reloaded.Element()->ToString(""));
+
+  // A modified model is printed in full.
+  sdf::ElementPtr model =
+      root.Element()->GetElement("world")->GetElement("model");
+  model->GetElement("pose")->GetValue()->SetFromString("1 1 1 0 0 0");
+  preserved = root.Element()->ToString("", config);
+  EXPECT_NE(std::string::npos, preserved.find("<model name='test_model'>"));
+  EXPECT_EQ(std::string::npos,
+      preserved.find("<include><uri>test_model</uri></include>"));
+  EXPECT_NE(std::string::npos,
+      preserved.find("<name>override_model_name</name>"));
+}
+
+//////////////////////////////////////////////////
+TEST(IncludesTest, IncludeThreadCount)
+{
+  sdf::setFindCallback(findFileCb);
+
+  const auto worldFile =
+    sdf::filesystem::append(g_testPath, "sdf", "includes.sdf");
+
+  sdf::Root root;
+  sdf::Errors errors = root.Load(worldFile);
+  EXPECT_TRUE(errors.empty());
+  ASSERT_NE(nullptr, root.Element());
+
+  // Prefetching without an include cache gives the same document.
+  sdf::ParserConfig config;
+  config.SetIncludeThreadCount(4);
+  sdf::Root prefetchedRoot;
+  errors = prefetchedRoot.Load(worldFile, config);
+  EXPECT_TRUE(errors.empty());
+  ASSERT_NE(nullptr, prefetchedRoot.Element());
+  EXPECT_EQ(root.Element()->ToString(""),
+      prefetchedRoot.Element()->ToString(""));
+
+  // Prefetched files are stored in the configured include cache.
+  auto cache = std::make_shared<sdf::IncludeCache>();
+  config.SetIncludeCache(cache);
+  sdf::Root cachedRoot;
+  errors = cachedRoot.Load(worldFile, config);
+  EXPECT_TRUE(errors.empty());
+  ASSERT_NE(nullptr, cachedRoot.Element());
+  EXPECT_EQ(3u, cache->Size());
+  EXPECT_EQ(root.Element()->ToString(""),
+      cachedRoot.Element()->ToString(""));
+
+  const sdf::World *world = cachedRoot.WorldByIndex(0);
+  ASSERT_NE(nullptr, world);
+  EXPECT_TRUE(world->ModelNameExists("test_model"));
+  EXPECT_TRUE(world->ModelNameExists("override_model_name"));
+}
+
+//////////////////////////////////////////////////
+TEST(IncludesTest, FindBatchCallback)
+{
+  sdf::setFindCallback(nullptr);
+
+  // Resolve the URIs on another thread, and record each batch.
+  std::mutex mutex;
+  std::vector<std::vector<std::string>> batches;
+  std::vector<std::future<void>> resolvers;
+  sdf::setFindBatchCallback([&](const std::vector<std::string> &_uris)
+      {
+        std::vector<std::shared_future<std::string>> paths;
+        std::lock_guard<std::mutex> lock(mutex);
+        batches.push_back(_uris);
+        for (const std::string &uri : _uris)
+        {
+          auto promise = std::make_shared<std::promise<std::string>>();
+          paths.push_back(promise->get_future().share());
+          resolvers.push_back(std::async(std::launch::async, [promise, uri]()
+              {
+                promise->set_value(findFileCb(uri));
+              }));
+        }
+        return paths;
+      });
+
+  const auto worldFile =
+    sdf::filesystem::append(g_testPath, "sdf", "includes.sdf");
+
+  sdf::Root root;
+  sdf::Errors errors = root.Load(worldFile);
+  EXPECT_TRUE(errors.empty());
+
+  // All the URIs of the world are requested at once, and only once.
+  ASSERT_EQ(1u, batches.size());
+  EXPECT_EQ(std::vector<std::string>({"test_model", "test_light",
+      "test_actor"}), batches[0]);
+
+  const sdf::World *world = root.WorldByIndex(0);
+  ASSERT_NE(nullptr, world);
+  EXPECT_TRUE(world->ModelNameExists("test_model"));
+  EXPECT_TRUE(world->ModelNameExists("override_model_name"));
+  EXPECT_TRUE(world->LightNameExists("override_light_name"));
+  EXPECT_TRUE(world->ActorNameExists("override_actor_name"));
+
+  // A file that was not requested is resolved on its own.
+  EXPECT_EQ(findFileCb("other_model"),
+      sdf::findFile("other_model", true, true));
+  ASSERT_EQ(2u, batches.size());
+  EXPECT_EQ(std::vector<std::string>({"other_model"}), batches[1]);
+
+  sdf::setFindBatchCallback(nullptr);
+}
+
+//////////////////////////////////////////////////
+TEST(IncludesTest, ModelFilter)
+{
+  // Record the URIs that are resolved.
+  std::mutex mutex;
+  std::vector<std::string> resolved;
+  sdf::setFindCallback([&](const std::string &_uri)
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        resolved.push_back(_uri);
+        return findFileCb(_uri);
+      });
+
+  std::vector<sdf::ModelCandidate> candidates;
+  sdf::ParserConfig config;
+  config.SetModelFilter([&](const sdf::ModelCandidate &_candidate)
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        candidates.push_back(_candidate);
+        return _candidate.uri != "test_light" &&
+            (!_candidate.hasPose || _candidate.pose.Pos().X() < 5);
+      });
+
+  const auto worldFile =
+    sdf::filesystem::append(g_testPath, "sdf", "includes.sdf");
+
+  sdf::Root root;
+  sdf::Errors errors = root.Load(worldFile, config);
+  EXPECT_TRUE(errors.empty());
+
+  ASSERT_EQ(6u, candidates.size());
+  EXPECT_EQ("default", candidates[0].worldName);
+  EXPECT_EQ("test_model", candidates[0].uri);
+  EXPECT_TRUE(candidates[0].name.empty());
+  EXPECT_FALSE(candidates[0].hasPose);
+  EXPECT_EQ("override_model_name", candidates[1].name);
+  EXPECT_TRUE(candidates[1].hasPose);
+  EXPECT_EQ(ignition::math::Pose3d(1, 2, 3, 0, 0, 0), candidates[1].pose);
+
+  // The rejected includes are never resolved.
+  EXPECT_EQ(resolved.end(),
+      std::find(resolved.begin(), resolved.end(), "test_light"));
+
+  const sdf::World *world = root.WorldByIndex(0);
+  ASSERT_NE(nullptr, world);
+  EXPECT_EQ(2u, world->ModelCount());
+  EXPECT_TRUE(world->ModelNameExists("test_model"));
+  EXPECT_TRUE(world->ModelNameExists("override_model_name"));
+  EXPECT_EQ(0u, world->LightCount());
+  EXPECT_EQ(1u, world->ActorCount());
+  EXPECT_FALSE(world->ActorNameExists("override_actor_name"));
+
+  sdf::setFindCallback(findFileCb);
+}
+
+//////////////////////////////////////////////////
+TEST(IncludesTest, MultipleWorlds)
+{
+  // Count the times the included model file is parsed.
+  std::mutex mutex;
+  std::size_t modelParses = 0;
+  sdf::ParserConfig config;
+  config.SetParseEventCallback([&](const sdf::ParseEvent &_event)
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (_event.type == sdf::ParseEventType::END &&
+            _event.stage == sdf::ParseStage::PARSE_XML &&
+            _event.path.find("model.sdf") != std::string::npos)
+        {
+          ++modelParses;
+        }
+      });
+
+  const auto worldFile = sdf::filesystem::append(g_testPath, "sdf",
+      "includes_multiple_worlds.sdf");
+
+  // The worlds share the included files.
+  sdf::Root root;
+  EXPECT_TRUE(root.Load(worldFile, config).empty());
+  EXPECT_EQ(3u, root.WorldCount());
+  EXPECT_EQ(1u, modelParses);
+
+  // Only the selected worlds are read.
+  modelParses = 0;
+  sdf::ParserConfig filterConfig = config;
+  filterConfig.SetWorldFilter([](const std::string &_name)
+      {
+        return _name != "first";
+      });
+  sdf::Root filteredRoot;
+  EXPECT_TRUE(filteredRoot.Load(worldFile, filterConfig).empty());
+  ASSERT_EQ(2u, filteredRoot.WorldCount());
+  EXPECT_EQ("second", filteredRoot.WorldByIndex(0)->Name());
+  EXPECT_FALSE(filteredRoot.WorldNameExists("first"));
+
+  // Worlds read on demand are read the first time they are accessed.
+  modelParses = 0;
+  sdf::ParserConfig onDemandConfig = filterConfig;
+  onDemandConfig.SetWorldsOnDemand(true);
+  sdf::Root onDemandRoot;
+  EXPECT_TRUE(onDemandRoot.Load(worldFile, onDemandConfig).empty());
+  EXPECT_EQ(0u, modelParses);
+  ASSERT_EQ(2u, onDemandRoot.WorldCount());
+  EXPECT_TRUE(onDemandRoot.WorldNameExists("second"));
+  EXPECT_TRUE(onDemandRoot.WorldNameExists("third"));
+  EXPECT_FALSE(onDemandRoot.WorldNameExists("first"));
+
+  EXPECT_TRUE(onDemandRoot.LoadWorld("third").empty());
+  EXPECT_EQ(1u, modelParses);
+  const sdf::World *third = onDemandRoot.WorldByIndex(1);
+  ASSERT_NE(nullptr, third);
+  EXPECT_EQ("third", third->Name());
+  EXPECT_TRUE(third->ModelNameExists("third_model"));
+
+  // The other world takes the included file from the include cache.
+  const sdf::World *second = onDemandRoot.WorldByIndex(0);
+  ASSERT_NE(nullptr, second);
+  EXPECT_EQ("second", second->Name());
+  ASSERT_TRUE(second->ModelNameExists("second_model"));
+  EXPECT_EQ(ignition::math::Pose3d(1, 0, 0, 0, 0, 0),
+      second->ModelByName("second_model")->RawPose());
+  EXPECT_EQ(1u, modelParses);
+  EXPECT_EQ(second, onDemandRoot.WorldByIndex(0));
+  EXPECT_TRUE(onDemandRoot.LoadDeferred().empty());
+
+  EXPECT_FALSE(onDemandRoot.LoadWorld("first").empty());
+  EXPECT_FALSE(onDemandRoot.LoadWorld(2u).empty());
+  EXPECT_TRUE(root.LoadWorld("first").empty());
+}
+
+//////////////////////////////////////////////////
+TEST(IncludesTest, ParserConfigFindFile)
+{
+  sdf::setFindCallback(nullptr);
+
+  const auto worldFile =
+    sdf::filesystem::append(g_testPath, "sdf", "includes.sdf");
+
+  // Without any callback, the included models are not found.
+  sdf::Root root;
+  EXPECT_FALSE(root.Load(worldFile).empty());
+
+  // The callback of a configuration only applies to its loads.
+  std::size_t events = 0;
+  sdf::ParserConfig config;
+  config.SetFindFileCallback(findFileCb);
+  config.SetParseEventCallback([&events](const sdf::ParseEvent &)
+      {
+        ++events;
+      });
+  sdf::Root configRoot;
+  EXPECT_TRUE(configRoot.Load(worldFile, config).empty());
+  EXPECT_GT(events, 0u);
+  const sdf::World *world = configRoot.WorldByIndex(0);
+  ASSERT_NE(nullptr, world);
+  EXPECT_TRUE(world->ModelNameExists("test_model"));
+
+  events = 0;
+  sdf::Root otherRoot;
+  EXPECT_FALSE(otherRoot.Load(worldFile).empty());
+  EXPECT_EQ(0u, events);
+
+  // So do the URI paths of a configuration.
+  const std::string sdfString =
+    "<sdf version='1.8'><world name='default'>"
+    "  <include><uri>config://test_model</uri></include>"
+    "</world></sdf>";
+  sdf::ParserConfig uriConfig;
+  uriConfig.AddURIPath("config://", g_modelsPath);
+  ASSERT_EQ(1u, uriConfig.URIPathMap().size());
+  sdf::Root uriRoot;
+  EXPECT_TRUE(uriRoot.LoadSdfString(sdfString, uriConfig).empty());
+  ASSERT_NE(nullptr, uriRoot.WorldByIndex(0));
+  EXPECT_TRUE(uriRoot.WorldByIndex(0)->ModelNameExists("test_model"));
+
+  sdf::Root globalRoot;
+  EXPECT_FALSE(globalRoot.LoadSdfString(sdfString).empty());
+
+  sdf::setFindCallback(findFileCb);
+}
+
+//////////////////////////////////////////////////
+TEST(IncludesTest, ParseScope)
+{
+  // Record the URIs that are resolved and the model files that are parsed.
+  std::mutex mutex;
+  std::vector<std::string> resolved;
+  sdf::setFindCallback([&](const std::string &_uri)
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        resolved.push_back(_uri);
+        return findFileCb(_uri);
+      });
+
+  const auto worldFile =
+    sdf::filesystem::append(g_testPath, "sdf", "includes.sdf");
+
+  // The header of the world resolves no include.
+  sdf::ParserConfig config;
+  config.SetParseScope(sdf::ParseScope::WORLD_HEADER);
+  sdf::Root headerRoot;
+  EXPECT_TRUE(headerRoot.Load(worldFile, config).empty());
+  EXPECT_TRUE(resolved.empty());
+  ASSERT_EQ(1u, headerRoot.WorldCount());
+  const sdf::World *world = headerRoot.WorldByIndex(0);
+  EXPECT_EQ("default", world->Name());
+  EXPECT_EQ(0u, world->ModelCount());
+  EXPECT_EQ(0u, world->LightCount());
+  EXPECT_EQ(0u, world->ActorCount());
+  EXPECT_EQ(1u, world->PhysicsCount());
+
+  // The first models resolve the includes up to the last of them.
+  config.SetParseScope(sdf::ParseScope::FIRST_MODELS);
+  config.SetScopeModelCount(2);
+  sdf::Root modelsRoot;
+  EXPECT_TRUE(modelsRoot.Load(worldFile, config).empty());
+  EXPECT_EQ(2u, resolved.size());
+  world = modelsRoot.WorldByIndex(0);
+  ASSERT_NE(nullptr, world);
+  EXPECT_EQ(2u, world->ModelCount());
+  EXPECT_TRUE(world->ModelNameExists("test_model"));
+  EXPECT_TRUE(world->ModelNameExists("override_model_name"));
+  EXPECT_EQ(0u, world->LightCount());
+  EXPECT_EQ(0u, world->ActorCount());
+
+  // The names are read without reading the included files, and no DOM
+  // object is loaded.
+  resolved.clear();
+  config.SetParseScope(sdf::ParseScope::TOP_LEVEL_NAMES);
+  sdf::Root namesRoot;
+  EXPECT_TRUE(namesRoot.Load(worldFile, config).empty());
+  EXPECT_EQ(6u, resolved.size());
+  EXPECT_EQ(0u, namesRoot.WorldCount());
+
+  sdf::ElementPtr worldElem = namesRoot.Element()->GetElement("world");
+  EXPECT_EQ("default", worldElem->Get<std::string>("name"));
+  std::vector<std::string> names;
+  for (const std::string type : {"model", "light", "actor"})
+  {
+    for (const sdf::ElementPtr &elem : worldElem->Children(type))
+    {
+      EXPECT_FALSE(elem->HasElement("link"));
+      names.push_back(type + ":" + elem->Get<std::string>("name"));
+    }
+  }
+  const std::vector<std::string> expectedNames = {
+    "model:test_model", "model:override_model_name",
+    "light:point_light", "light:override_light_name",
+    "actor:actor", "actor:override_actor_name"};
+  EXPECT_EQ(expectedNames, names);
+
+  sdf::setFindCallback(findFileCb);
+}
@@ -111,3 +111,34 @@ TEST(DOMWorld, LoadLights)
   EXPECT_TRUE(linkLight->SemanticPose().Resolve(pose).empty());
   EXPECT_EQ(ignition::math::Pose3d(11, 13, 15, 0, 0, 0), pose);
 }
+
+//////////////////////////////////////////////////
+TEST(DOMWorld, LoadLightsWithoutOptionalElements)
+{
+  const std::string sdfString =
+    "<sdf version='" SDF_VERSION "'>"
+    "  <world name='default'>"
+    "    <light name='spot_light' type='spot'>"
+    "      <direction>0 0 -1</direction>"
+    "    </light>"
+    "  </world>"
+    "</sdf>";
+
+  sdf::Root root;
+  sdf::Errors errors = root.LoadSdfString(sdfString);
+  EXPECT_TRUE(errors.empty());
+  const sdf::World *world = root.WorldByIndex(0);
+  ASSERT_NE(nullptr, world);
+
+  const sdf::Light *light = world->LightByIndex(0);
+  ASSERT_NE(nullptr, light);
+  EXPECT_DOUBLE_EQ(10.0, light->AttenuationRange());
+  EXPECT_DOUBLE_EQ(1.0, light->LinearAttenuationFactor());
+  EXPECT_DOUBLE_EQ(0.0, light->SpotInnerAngle().Radian());
+
+  // Loading reads the element tree without adding the missing optional
+  // elements to it.
+  ASSERT_NE(nullptr, light->Element());
+  EXPECT_FALSE(light->Element()->HasElement("attenuation"));
+  EXPECT_FALSE(light->Element()->HasElement("spot"));
+}
@@ -46,6 +46,14 @@ TEST(CheckFixForLocal, CheckFixForCxxLocal)
   ASSERT_DOUBLE_EQ(1.5, vectmp[0]);
   ASSERT_DOUBLE_EQ(2.5, vectmp[1]);
 
+  // Values are written with a decimal point as well
+  EXPECT_EQ("1.5 2.5", param.GetAsString());
+  EXPECT_EQ("1.5 2.5", param.GetDefaultAsString());
+  sdf::Param doubleParam("dummyDoubleParam", "double", "0.25", true);
+  EXPECT_EQ("0.25", doubleParam.GetAsString());
+  EXPECT_TRUE(doubleParam.SetFromString("3.5"));
+  EXPECT_EQ("3.5", doubleParam.GetAsString());
+
   // Restore the original global locale
   std::locale prevLocale = std::locale::global(originalGlobalLocale);
   EXPECT_EQ(newLocale, prevLocale);
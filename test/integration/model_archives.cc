@@ -0,0 +1,269 @@
+/*
+ * Copyright 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <utility>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "sdf/Filesystem.hh"
+#include "sdf/Model.hh"
+#include "sdf/Root.hh"
+#include "sdf/SDFImpl.hh"
+#include "sdf/World.hh"
+#include "sdf/parser.hh"
+#include "test_config.h"
+
+const auto g_testPath = sdf::filesystem::append(PROJECT_SOURCE_PATH, "test");
+const auto g_outputPath =
+    sdf::filesystem::append(PROJECT_BINARY_DIR, "test", "model_archives");
+
+/// \brief Members of an archive, as pairs of name and content.
+using Members = std::vector<std::pair<std::string, std::string>>;
+
+/////////////////////////////////////////////////
+/// \brief Read a file of the box test model.
+/// \param[in] _name Name of the file.
+/// \return The content of the file.
+std::string readBoxFile(const std::string &_name)
+{
+  std::ifstream in(sdf::filesystem::append(
+      g_testPath, "integration", "model", "box", _name), std::ios::binary);
+  return std::string((std::istreambuf_iterator<char>(in)),
+                     std::istreambuf_iterator<char>());
+}
+
+/////////////////////////////////////////////////
+/// \brief Write a ustar archive.
+/// \param[in] _path Path of the archive.
+/// \param[in] _members The members.
+void writeTar(const std::string &_path, const Members &_members)
+{
+  std::ofstream out(_path, std::ios::binary);
+  for (const auto &member : _members)
+  {
+    char header[512] = {0};
+    std::strncpy(header, member.first.c_str(), 99);
+    std::snprintf(header + 100, 8, "%07o", 0644);
+    std::snprintf(header + 108, 8, "%07o", 0);
+    std::snprintf(header + 116, 8, "%07o", 0);
+    std::snprintf(header + 124, 12, "%011o",
+        static_cast<unsigned int>(member.second.size()));
+    std::snprintf(header + 136, 12, "%011o", 0);
+    header[156] = '0';
+    std::memcpy(header + 257, "ustar", 6);
+    std::memcpy(header + 263, "00", 2);
+
+    // The checksum is computed with its own field filled with spaces.
+    std::memset(header + 148, ' ', 8);
+    unsigned int checksum = 0;
+    for (char c : header)
+      checksum += static_cast<unsigned char>(c);
+    std::snprintf(header + 148, 8, "%06o", checksum);
+
+    out.write(header, sizeof(header));
+    out.write(member.second.data(),
+        static_cast<std::streamsize>(member.second.size()));
+    const std::string padding((512 - member.second.size() % 512) % 512, '\0');
+    out.write(padding.data(), static_cast<std::streamsize>(padding.size()));
+  }
+  const std::string end(1024, '\0');
+  out.write(end.data(), static_cast<std::streamsize>(end.size()));
+}
+
+/////////////////////////////////////////////////
+/// \brief Compute the CRC-32 of zip archives.
+/// \param[in] _data The bytes.
+/// \return The CRC.
+uint32_t crc32(const std::string &_data)
+{
+  uint32_t crc = 0xFFFFFFFFu;
+  for (char c : _data)
+  {
+    crc ^= static_cast<unsigned char>(c);
+    for (int i = 0; i < 8; ++i)
+      crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1u)));
+  }
+  return ~crc;
+}
+
+/////////////////////////////////////////////////
+/// \brief Append a little-endian integer to a string.
+/// \param[in,out] _out The string.
+/// \param[in] _value The integer.
+/// \param[in] _bytes Number of bytes of the integer.
+void appendInt(std::string &_out, const uint32_t _value, const int _bytes)
+{
+  for (int i = 0; i < _bytes; ++i)
+    _out += static_cast<char>((_value >> (8 * i)) & 0xFF);
+}
+
+/////////////////////////////////////////////////
+/// \brief Write a zip archive whose members are stored.
+/// \param[in] _path Path of the archive.
+/// \param[in] _members The members.
+void writeZip(const std::string &_path, const Members &_members)
+{
+  std::string data;
+  std::string directory;
+  for (const auto &member : _members)
+  {
+    const uint32_t offset = static_cast<uint32_t>(data.size());
+    const uint32_t size = static_cast<uint32_t>(member.second.size());
+    const uint32_t crc = crc32(member.second);
+
+    appendInt(data, 0x04034b50, 4);
+    appendInt(data, 10, 2);
+    appendInt(data, 0, 2);
+    appendInt(data, 0, 2);
+    appendInt(data, 0, 4);
+    appendInt(data, crc, 4);
+    appendInt(data, size, 4);
+    appendInt(data, size, 4);
+    appendInt(data, static_cast<uint32_t>(member.first.size()), 2);
+    appendInt(data, 0, 2);
+    data += member.first + member.second;
+
+    appendInt(directory, 0x02014b50, 4);
+    appendInt(directory, 10, 2);
+    appendInt(directory, 10, 2);
+    appendInt(directory, 0, 2);
+    appendInt(directory, 0, 2);
+    appendInt(directory, 0, 4);
+    appendInt(directory, crc, 4);
+    appendInt(directory, size, 4);
+    appendInt(directory, size, 4);
+    appendInt(directory, static_cast<uint32_t>(member.first.size()), 2);
+    appendInt(directory, 0, 2);
+    appendInt(directory, 0, 2);
+    appendInt(directory, 0, 2);
+    appendInt(directory, 0, 2);
+    appendInt(directory, 0, 4);
+    appendInt(directory, offset, 4);
+    directory += member.first;
+  }
+
+  std::string end;
+  appendInt(end, 0x06054b50, 4);
+  appendInt(end, 0, 2);
+  appendInt(end, 0, 2);
+  appendInt(end, static_cast<uint32_t>(_members.size()), 2);
+  appendInt(end, static_cast<uint32_t>(_members.size()), 2);
+  appendInt(end, static_cast<uint32_t>(directory.size()), 4);
+  appendInt(end, static_cast<uint32_t>(data.size()), 4);
+  appendInt(end, 0, 2);
+
+  std::ofstream out(_path, std::ios::binary);
+  out << data << directory << end;
+}
+
+/////////////////////////////////////////////////
+/// \brief Load a world that includes a model, and check the model.
+/// \param[in] _uri URI of the model.
+/// \param[in] _modelFile Expected path of the model file.
+void checkInclude(const std::string &_uri, const std::string &_modelFile)
+{
+  const std::string worldString =
+    "<sdf version='1.8'><world name='default'><include>"
+    "<uri>" + _uri + "</uri><name>box</name>"
+    "</include></world></sdf>";
+
+  sdf::Root root;
+  sdf::Errors errors = root.LoadSdfString(worldString);
+  for (auto e : errors)
+    std::cout << e.Message() << std::endl;
+  ASSERT_TRUE(errors.empty());
+
+  const sdf::World *world = root.WorldByIndex(0);
+  ASSERT_NE(nullptr, world);
+  ASSERT_EQ(1u, world->ModelCount());
+  EXPECT_EQ("box", world->ModelByIndex(0)->Name());
+  EXPECT_EQ(1u, world->ModelByIndex(0)->LinkCount());
+  EXPECT_EQ(_modelFile, world->ModelByIndex(0)->Element()->FilePath());
+}
+
+/////////////////////////////////////////////////
+TEST(ModelArchives, Tar)
+{
+  sdf::filesystem::create_directory(g_outputPath);
+  const std::string archivePath =
+      sdf::filesystem::append(g_outputPath, "models.tar");
+  writeTar(archivePath, {
+      {"./tar_box/model.config", readBoxFile("model.config")},
+      {"./tar_box/model.sdf", readBoxFile("model.sdf")}});
+  sdf::addURIPath("model://", archivePath);
+
+  // The archive is a directory of its members.
+  const std::string modelPath = archivePath + "/tar_box";
+  EXPECT_TRUE(sdf::filesystem::is_directory(archivePath));
+  EXPECT_TRUE(sdf::filesystem::is_directory(modelPath));
+  EXPECT_TRUE(sdf::filesystem::exists(modelPath + "/model.sdf"));
+  EXPECT_FALSE(sdf::filesystem::is_directory(modelPath + "/model.sdf"));
+  EXPECT_FALSE(sdf::filesystem::exists(modelPath + "/missing.sdf"));
+  EXPECT_EQ(sdf::filesystem::last_write_time(archivePath),
+      sdf::filesystem::status(modelPath + "/model.sdf").write_time);
+
+  EXPECT_EQ(modelPath, sdf::findFile("model://tar_box"));
+  EXPECT_EQ(modelPath + "/model.sdf", sdf::getModelFilePath(modelPath));
+  checkInclude("model://tar_box", modelPath + "/model.sdf");
+
+  sdf::SDFPtr modelSdf = sdf::readFile(modelPath);
+  ASSERT_NE(nullptr, modelSdf);
+  EXPECT_TRUE(modelSdf->Root()->HasElement("model"));
+}
+
+/////////////////////////////////////////////////
+TEST(ModelArchives, Zip)
+{
+  sdf::filesystem::create_directory(g_outputPath);
+  const std::string archivePath =
+      sdf::filesystem::append(g_outputPath, "models.zip");
+  writeZip(archivePath, {
+      {"zip_box/model.config", readBoxFile("model.config")},
+      {"zip_box/model.sdf", readBoxFile("model.sdf")}});
+  sdf::addURIPath("model://", archivePath);
+
+  const std::string modelPath = archivePath + "/zip_box";
+  EXPECT_TRUE(sdf::filesystem::is_directory(modelPath));
+  EXPECT_EQ(modelPath, sdf::findFile("model://zip_box"));
+  EXPECT_EQ(modelPath, sdf::findFile("model://zip_box/"));
+  EXPECT_EQ(modelPath + "/model.config",
+      sdf::findFile("model://zip_box/model.config"));
+  checkInclude("model://zip_box", modelPath + "/model.sdf");
+}
+
+/////////////////////////////////////////////////
+TEST(ModelArchives, NotAnArchive)
+{
+  sdf::filesystem::create_directory(g_outputPath);
+  const std::string path =
+      sdf::filesystem::append(g_outputPath, "not_an_archive.zip");
+  {
+    std::ofstream out(path, std::ios::binary);
+    out << "not an archive";
+  }
+  sdf::addURIPath("model://", path);
+  EXPECT_FALSE(sdf::filesystem::is_directory(path));
+  EXPECT_TRUE(sdf::filesystem::exists(path));
+  EXPECT_TRUE(sdf::findFile("model://not_an_archive_model").empty());
+}
@@ -15,15 +15,27 @@
  *
  */
 
+#include <cmath>
+#include <sstream>
 #include <string>
+#include <utility>
+#include <vector>
 #include <gtest/gtest.h>
 
 #include <ignition/math/Pose3.hh>
+#include "sdf/CollisionGeometry.hh"
 #include "sdf/Element.hh"
 #include "sdf/Error.hh"
 #include "sdf/Filesystem.hh"
+#include "sdf/Frame.hh"
+#include "sdf/Joint.hh"
+#include "sdf/JointAxis.hh"
+#include "sdf/KinematicTree.hh"
 #include "sdf/Link.hh"
 #include "sdf/Model.hh"
+#include "sdf/ModelKinematics.hh"
+#include "sdf/ModelMassProperties.hh"
+#include "sdf/ParserConfig.hh"
 #include "sdf/Root.hh"
 #include "sdf/Types.hh"
 #include "sdf/World.hh"
@@ -217,3 +229,739 @@ TEST(DOMRoot, LoadCanonicalLink)
   EXPECT_EQ(nullptr, model->JointByIndex(0));
 }
 
+
+/////////////////////////////////////////////////
+TEST(DOMModel, ResolveFramePoses)
+{
+  const std::string testFile =
+    sdf::filesystem::append(PROJECT_SOURCE_PATH, "test", "sdf",
+        "model_frame_relative_to_joint.sdf");
+
+  // Load the SDF file
+  sdf::Root root;
+  EXPECT_TRUE(root.Load(testFile).empty());
+
+  const sdf::Model *model = root.ModelByIndex(0);
+  ASSERT_NE(nullptr, model);
+  ASSERT_LT(0u, model->JointCount());
+  ASSERT_LT(0u, model->FrameCount());
+
+  using Pose = ignition::math::Pose3d;
+  for (const std::string relativeTo : {"__model__", "P", "J"})
+  {
+    std::vector<Pose> poses;
+    EXPECT_TRUE(model->ResolveFramePoses(poses, relativeTo).empty());
+    ASSERT_EQ(1u + model->LinkCount() + model->JointCount() +
+        model->FrameCount(), poses.size());
+
+    Pose pose;
+    std::size_t index = 0;
+    for (uint64_t i = 0; i < model->LinkCount(); ++i)
+    {
+      EXPECT_TRUE(model->LinkByIndex(i)->SemanticPose().Resolve(
+          pose, relativeTo).empty());
+      EXPECT_EQ(pose, poses[++index]);
+    }
+    for (uint64_t i = 0; i < model->JointCount(); ++i)
+    {
+      EXPECT_TRUE(model->JointByIndex(i)->SemanticPose().Resolve(
+          pose, relativeTo).empty());
+      EXPECT_EQ(pose, poses[++index]);
+    }
+    for (uint64_t i = 0; i < model->FrameCount(); ++i)
+    {
+      EXPECT_TRUE(model->FrameByIndex(i)->SemanticPose().Resolve(
+          pose, relativeTo).empty());
+      EXPECT_EQ(pose, poses[++index]);
+    }
+  }
+
+  // The implicit model frame is used by default.
+  std::vector<Pose> poses;
+  EXPECT_TRUE(model->ResolveFramePoses(poses).empty());
+  ASSERT_FALSE(poses.empty());
+  EXPECT_EQ(Pose::Zero, poses[0]);
+
+  // An unknown frame is an error, and the output is not changed.
+  std::vector<Pose> unchanged;
+  EXPECT_FALSE(model->ResolveFramePoses(unchanged, "invalid").empty());
+  EXPECT_TRUE(unchanged.empty());
+
+  // A model that was not loaded has no pose graph.
+  sdf::Model emptyModel;
+  EXPECT_FALSE(emptyModel.ResolveFramePoses(unchanged).empty());
+}
+
+/////////////////////////////////////////////////
+TEST(DOMModel, ResolveKinematics)
+{
+  // The links are declared after their children.
+  const std::string sdfString =
+    "<sdf version='1.7'>"
+    "  <model name='M'>"
+    "    <link name='C'><pose>0 0 3 0 0 0</pose></link>"
+    "    <link name='B'><pose>0 0 2 0 0 0</pose></link>"
+    "    <link name='A'>"
+    "      <inertial>"
+    "        <pose>0 0 0.5 0 0 0</pose>"
+    "        <mass>2</mass>"
+    "        <inertia>"
+    "          <ixx>1</ixx><iyy>2</iyy><izz>3</izz>"
+    "          <ixy>0</ixy><ixz>0</ixz><iyz>0</iyz>"
+    "        </inertia>"
+    "      </inertial>"
+    "    </link>"
+    "    <link name='D'><pose>1 0 0 0 0 0</pose></link>"
+    "    <joint name='J1' type='prismatic'>"
+    "      <parent>B</parent><child>C</child>"
+    "      <axis><xyz>1 0 0</xyz></axis>"
+    "    </joint>"
+    "    <joint name='J2' type='revolute'>"
+    "      <pose>0 0 1 0 0 0</pose>"
+    "      <parent>A</parent><child>B</child>"
+    "      <axis>"
+    "        <xyz>0 1 0</xyz>"
+    "        <limit>"
+    "          <lower>-1</lower><upper>1</upper>"
+    "          <effort>10</effort><velocity>2</velocity>"
+    "        </limit>"
+    "      </axis>"
+    "    </joint>"
+    "    <joint name='J3' type='fixed'>"
+    "      <parent>A</parent><child>D</child>"
+    "    </joint>"
+    "  </model>"
+    "</sdf>";
+
+  sdf::Root root;
+  EXPECT_TRUE(root.LoadSdfString(sdfString).empty());
+  const sdf::Model *model = root.ModelByIndex(0);
+  ASSERT_NE(nullptr, model);
+
+  sdf::ModelKinematics kin;
+  EXPECT_TRUE(model->ResolveKinematics(kin).empty());
+
+  using Pose = ignition::math::Pose3d;
+  using Vector3d = ignition::math::Vector3d;
+
+  // Links in depth-first order: A, B, C, D.
+  EXPECT_EQ(std::vector<uint64_t>({2, 1, 0, 3}), kin.linkIndices);
+  EXPECT_EQ(std::vector<int64_t>({-1, 0, 1, 0}), kin.linkParents);
+  EXPECT_EQ(std::vector<int64_t>({-1, 0, 1, 2}), kin.linkJoints);
+  ASSERT_EQ(4u, kin.linkPoses.size());
+  EXPECT_EQ(Pose::Zero, kin.linkPoses[0]);
+  EXPECT_EQ(Pose(0, 0, 2, 0, 0, 0), kin.linkPoses[1]);
+  EXPECT_EQ(Pose(0, 0, 3, 0, 0, 0), kin.linkPoses[2]);
+  EXPECT_EQ(Pose(1, 0, 0, 0, 0, 0), kin.linkPoses[3]);
+  ASSERT_EQ(4u, kin.masses.size());
+  EXPECT_DOUBLE_EQ(2.0, kin.masses[0]);
+  EXPECT_DOUBLE_EQ(model->LinkByName("B")->Inertial().MassMatrix().Mass(),
+      kin.masses[1]);
+  ASSERT_EQ(4u, kin.inertias.size());
+  EXPECT_EQ(ignition::math::Matrix3d(1, 0, 0, 0, 2, 0, 0, 0, 3),
+      kin.inertias[0]);
+  ASSERT_EQ(4u, kin.inertialPoses.size());
+  EXPECT_EQ(Pose(0, 0, 0.5, 0, 0, 0), kin.inertialPoses[0]);
+
+  // Joints in the order of their child link: J2, J1, J3.
+  EXPECT_EQ(std::vector<uint64_t>({1, 0, 2}), kin.jointIndices);
+  EXPECT_EQ(std::vector<sdf::JointType>({sdf::JointType::REVOLUTE,
+      sdf::JointType::PRISMATIC, sdf::JointType::FIXED}), kin.jointTypes);
+  EXPECT_EQ(std::vector<int64_t>({0, 1, 0}), kin.jointParents);
+  EXPECT_EQ(std::vector<int64_t>({1, 2, 3}), kin.jointChildren);
+  ASSERT_EQ(3u, kin.jointPoses.size());
+  EXPECT_EQ(Pose(0, 0, 3, 0, 0, 0), kin.jointPoses[0]);
+  EXPECT_EQ(Pose(0, 0, 3, 0, 0, 0), kin.jointPoses[1]);
+  EXPECT_EQ(Pose(1, 0, 0, 0, 0, 0), kin.jointPoses[2]);
+  ASSERT_EQ(3u, kin.axes.size());
+  EXPECT_EQ(Vector3d::UnitY, kin.axes[0]);
+  EXPECT_EQ(Vector3d::UnitX, kin.axes[1]);
+  EXPECT_EQ(Vector3d::Zero, kin.axes[2]);
+  ASSERT_EQ(3u, kin.lowerLimits.size());
+  EXPECT_DOUBLE_EQ(-1.0, kin.lowerLimits[0]);
+  EXPECT_DOUBLE_EQ(1.0, kin.upperLimits[0]);
+  EXPECT_DOUBLE_EQ(10.0, kin.effortLimits[0]);
+  EXPECT_DOUBLE_EQ(2.0, kin.velocityLimits[0]);
+  const sdf::JointAxis defaultAxis;
+  EXPECT_DOUBLE_EQ(defaultAxis.Lower(), kin.lowerLimits[2]);
+  EXPECT_DOUBLE_EQ(defaultAxis.Upper(), kin.upperLimits[2]);
+
+  // A model that was not loaded has no pose graph, and the output is not
+  // changed.
+  sdf::Model emptyModel;
+  EXPECT_FALSE(emptyModel.ResolveKinematics(kin).empty());
+  EXPECT_EQ(4u, kin.linkIndices.size());
+}
+
+/////////////////////////////////////////////////
+TEST(DOMModel, ResolveJointAxes)
+{
+  const std::string sdfString =
+    "<sdf version='1.7'>"
+    "  <model name='M'>"
+    "    <link name='A'/>"
+    "    <link name='B'><pose>0 0 0 0 0 1.5707963267948966</pose></link>"
+    "    <link name='C'/>"
+    "    <joint name='J1' type='revolute'>"
+    "      <parent>A</parent><child>B</child>"
+    "      <axis><xyz>1 0 0</xyz></axis>"
+    "    </joint>"
+    "    <joint name='J2' type='universal'>"
+    "      <parent>B</parent><child>C</child>"
+    "      <axis><xyz expressed_in='B'>1 0 0</xyz></axis>"
+    "      <axis2><xyz>0 0 1</xyz></axis2>"
+    "    </joint>"
+    "    <joint name='J3' type='fixed'>"
+    "      <parent>A</parent><child>C</child>"
+    "    </joint>"
+    "  </model>"
+    "</sdf>";
+
+  sdf::Root root;
+  EXPECT_TRUE(root.LoadSdfString(sdfString).empty());
+  const sdf::Model *model = root.ModelByIndex(0);
+  ASSERT_NE(nullptr, model);
+
+  using Vector3d = ignition::math::Vector3d;
+  std::vector<Vector3d> axes;
+  EXPECT_TRUE(model->ResolveJointAxes(axes).empty());
+  ASSERT_EQ(6u, axes.size());
+  EXPECT_EQ(Vector3d::Zero, axes[3]);
+  EXPECT_EQ(Vector3d::Zero, axes[4]);
+  EXPECT_EQ(Vector3d::Zero, axes[5]);
+
+  // Same vectors as resolving each axis on its own.
+  for (uint64_t j = 0; j < 2; ++j)
+  {
+    const sdf::Joint *joint = model->JointByIndex(j);
+    for (uint64_t i = 0; i < 2; ++i)
+    {
+      const sdf::JointAxis *axis = joint->Axis(i);
+      if (!axis)
+        continue;
+      Vector3d xyz;
+      EXPECT_TRUE(axis->ResolveXyz(xyz, "__model__").empty());
+      EXPECT_EQ(xyz, axes[2 * j + i]);
+    }
+  }
+  EXPECT_EQ(Vector3d(0, 1, 0), axes[2]);
+
+  // In the coordinates of another frame.
+  EXPECT_TRUE(model->ResolveJointAxes(axes, "B").empty());
+  EXPECT_EQ(Vector3d(1, 0, 0), axes[2]);
+
+  // Unknown frames are errors, and the output is not changed.
+  EXPECT_FALSE(model->ResolveJointAxes(axes, "missing").empty());
+  EXPECT_EQ(6u, axes.size());
+
+  sdf::Model emptyModel;
+  EXPECT_FALSE(emptyModel.ResolveJointAxes(axes).empty());
+}
+
+/////////////////////////////////////////////////
+TEST(DOMModel, KinematicTree)
+{
+  // J4 closes a loop, since D is already the child of J3.
+  const std::string sdfString =
+    "<sdf version='1.7'>"
+    "  <model name='M'>"
+    "    <link name='C'/>"
+    "    <link name='B'/>"
+    "    <link name='A'/>"
+    "    <link name='D'/>"
+    "    <joint name='J1' type='fixed'>"
+    "      <parent>B</parent><child>C</child>"
+    "    </joint>"
+    "    <joint name='J2' type='fixed'>"
+    "      <parent>A</parent><child>B</child>"
+    "    </joint>"
+    "    <joint name='J3' type='fixed'>"
+    "      <parent>A</parent><child>D</child>"
+    "    </joint>"
+    "    <joint name='J4' type='fixed'>"
+    "      <parent>C</parent><child>D</child>"
+    "    </joint>"
+    "  </model>"
+    "</sdf>";
+
+  sdf::Root root;
+  EXPECT_TRUE(root.LoadSdfString(sdfString).empty());
+  const sdf::Model *model = root.ModelByIndex(0);
+  ASSERT_NE(nullptr, model);
+
+  const sdf::KinematicTree &tree = model->KinematicTree();
+  EXPECT_EQ(std::vector<uint64_t>({2, 1, 0, 3}), tree.linkOrder);
+  EXPECT_EQ(std::vector<int64_t>({0, 1, -1, 2}), tree.parentJoints);
+  EXPECT_EQ(std::vector<int64_t>({1, 2, -1, 2}), tree.parentLinks);
+  EXPECT_EQ(std::vector<int64_t>({2, 1, 0, 1}), tree.depths);
+  EXPECT_EQ(std::vector<uint64_t>({0, 0, 1, 3, 3}), tree.childOffsets);
+  EXPECT_EQ(std::vector<uint64_t>({0, 1, 3}), tree.childLinks);
+  EXPECT_EQ(std::vector<int64_t>({1, 2, 2, 0}), tree.jointParents);
+  EXPECT_EQ(std::vector<int64_t>({0, 1, 3, 3}), tree.jointChildren);
+
+  // Adding links and joints updates the tree.
+  sdf::Model copy = *model;
+  sdf::Link link;
+  link.SetName("E");
+  EXPECT_TRUE(copy.AddLink(std::move(link)).empty());
+  EXPECT_EQ(std::vector<uint64_t>({2, 1, 0, 3, 4}),
+      copy.KinematicTree().linkOrder);
+  EXPECT_EQ(0, copy.KinematicTree().depths[4]);
+
+  sdf::Joint joint;
+  joint.SetName("J5");
+  joint.SetType(sdf::JointType::FIXED);
+  joint.SetParentLinkName("D");
+  joint.SetChildLinkName("E");
+  EXPECT_TRUE(copy.AddJoint(std::move(joint)).empty());
+  const sdf::KinematicTree &copyTree = copy.KinematicTree();
+  EXPECT_EQ(std::vector<uint64_t>({2, 1, 0, 3, 4}), copyTree.linkOrder);
+  EXPECT_EQ(4, copyTree.parentJoints[4]);
+  EXPECT_EQ(3, copyTree.parentLinks[4]);
+  EXPECT_EQ(2, copyTree.depths[4]);
+  EXPECT_EQ(std::vector<uint64_t>({0, 0, 1, 3, 4, 4}),
+      copyTree.childOffsets);
+  EXPECT_EQ(std::vector<uint64_t>({0, 1, 3, 4}), copyTree.childLinks);
+
+  // The tree of the original model is unchanged.
+  EXPECT_EQ(4u, model->KinematicTree().linkOrder.size());
+
+  sdf::Model emptyModel;
+  EXPECT_TRUE(emptyModel.KinematicTree().linkOrder.empty());
+  EXPECT_EQ(std::vector<uint64_t>({0}),
+      emptyModel.KinematicTree().childOffsets);
+}
+
+/////////////////////////////////////////////////
+TEST(DOMModel, SelfCollisionExclusions)
+{
+  // A chain of links 0 to 4, and link 5 attached to the world.
+  std::ostringstream model;
+  model << "<self_collide>true</self_collide>";
+  for (int l = 0; l < 6; ++l)
+    model << "<link name='L" << l << "'/>";
+  for (int l = 0; l < 4; ++l)
+  {
+    model << "<joint name='J" << l << "' type='fixed'>"
+          << "<parent>L" << l << "</parent><child>L" << l + 1 << "</child>"
+          << "</joint>";
+  }
+  model << "<joint name='J4' type='fixed'>"
+        << "<parent>world</parent><child>L5</child></joint>";
+  const std::string sdfString =
+      "<sdf version='1.7'><world name='default'>"
+      "<model name='A'>" + model.str() + "</model>"
+      "<model name='B'>" + model.str() + "</model>"
+      "</world></sdf>";
+
+  sdf::Root root;
+  EXPECT_TRUE(root.LoadSdfString(sdfString).empty());
+  const sdf::World *world = root.WorldByIndex(0);
+  ASSERT_NE(nullptr, world);
+  const sdf::Model *modelA = world->ModelByIndex(0);
+  const sdf::Model *modelB = world->ModelByIndex(1);
+  ASSERT_NE(nullptr, modelA);
+  ASSERT_NE(nullptr, modelB);
+
+  auto adjacent = modelA->SelfCollisionExclusions();
+  ASSERT_NE(nullptr, adjacent);
+  EXPECT_EQ(6u, adjacent->linkCount);
+  EXPECT_TRUE(adjacent->selfCollide);
+  EXPECT_EQ(std::vector<uint64_t>({0, 1, 2, 3}), adjacent->firstLinks);
+  EXPECT_EQ(std::vector<uint64_t>({1, 2, 3, 4}), adjacent->secondLinks);
+  EXPECT_TRUE(adjacent->Excluded(2, 1));
+  EXPECT_TRUE(adjacent->Excluded(3, 3));
+  EXPECT_FALSE(adjacent->Excluded(0, 2));
+  EXPECT_FALSE(adjacent->Excluded(4, 5));
+
+  auto twoHops = modelA->SelfCollisionExclusions(2);
+  EXPECT_EQ(std::vector<uint64_t>({0, 0, 1, 1, 2, 2, 3}),
+      twoHops->firstLinks);
+  EXPECT_EQ(std::vector<uint64_t>({1, 2, 2, 3, 3, 4, 4}),
+      twoHops->secondLinks);
+  EXPECT_TRUE(twoHops->Excluded(2, 0));
+  EXPECT_FALSE(twoHops->Excluded(0, 3));
+  EXPECT_TRUE(modelA->SelfCollisionExclusions(0)->firstLinks.empty());
+
+  // Copies of a model share the exclusions.
+  EXPECT_EQ(adjacent, modelB->SelfCollisionExclusions());
+
+  // Without self collision, every pair is excluded.
+  sdf::Model copy = *modelA;
+  copy.SetSelfCollide(false);
+  auto noSelfCollide = copy.SelfCollisionExclusions();
+  EXPECT_NE(adjacent, noSelfCollide);
+  EXPECT_TRUE(noSelfCollide->Excluded(0, 5));
+}
+
+/////////////////////////////////////////////////
+TEST(DOMModel, ResolveMassProperties)
+{
+  // Link B is 2 m from link A along x, and its inertial frame is rotated by
+  // 90 degrees about z.
+  const std::string sdfString =
+    "<sdf version='1.8'>"
+    "  <model name='M'>"
+    "    <link name='A'>"
+    "      <inertial><mass>1</mass><inertia>"
+    "        <ixx>0.1</ixx><iyy>0.1</iyy><izz>0.1</izz>"
+    "      </inertia></inertial>"
+    "    </link>"
+    "    <link name='B'>"
+    "      <pose>2 0 0 0 0 0</pose>"
+    "      <inertial><pose>0 0 0 0 0 1.5707963267948966</pose>"
+    "        <mass>1</mass><inertia>"
+    "        <ixx>0.1</ixx><iyy>0.2</iyy><izz>0.3</izz>"
+    "      </inertia></inertial>"
+    "    </link>"
+    "    <joint name='J' type='revolute'>"
+    "      <parent>A</parent><child>B</child>"
+    "      <axis><xyz>0 0 1</xyz></axis>"
+    "    </joint>"
+    "  </model>"
+    "</sdf>";
+
+  sdf::Root root;
+  EXPECT_TRUE(root.LoadSdfString(sdfString).empty());
+  const sdf::Model *model = root.ModelByIndex(0);
+  ASSERT_NE(nullptr, model);
+
+  sdf::ModelMassProperties props;
+  EXPECT_TRUE(model->ResolveMassProperties(props).empty());
+  const double tol = 1e-12;
+  EXPECT_DOUBLE_EQ(2.0, props.mass);
+  EXPECT_TRUE(props.centerOfMass.Equal(
+      ignition::math::Vector3d(1, 0, 0), tol));
+  EXPECT_NEAR(0.3, props.inertia(0, 0), tol);
+  EXPECT_NEAR(2.2, props.inertia(1, 1), tol);
+  EXPECT_NEAR(2.4, props.inertia(2, 2), tol);
+  EXPECT_NEAR(0.0, props.inertia(0, 1), tol);
+
+  // The subtree of A is the whole model, and that of B is B alone.
+  ASSERT_EQ(2u, props.subtreeMasses.size());
+  EXPECT_DOUBLE_EQ(2.0, props.subtreeMasses[0]);
+  EXPECT_DOUBLE_EQ(1.0, props.subtreeMasses[1]);
+  EXPECT_TRUE(props.subtreeInertias[0].Equal(props.inertia, tol));
+  EXPECT_TRUE(props.subtreeCentersOfMass[1].Equal(
+      ignition::math::Vector3d(2, 0, 0), tol));
+  EXPECT_NEAR(0.2, props.subtreeInertias[1](0, 0), tol);
+  EXPECT_NEAR(0.1, props.subtreeInertias[1](1, 1), tol);
+  EXPECT_NEAR(0.3, props.subtreeInertias[1](2, 2), tol);
+
+  sdf::Model emptyModel;
+  EXPECT_FALSE(emptyModel.ResolveMassProperties(props).empty());
+}
+
+/////////////////////////////////////////////////
+TEST(DOMModel, ResolveCollisionGeometry)
+{
+  const std::string sdfString =
+    "<sdf version='1.7'>"
+    "  <model name='M'>"
+    "    <frame name='F' attached_to='A'><pose>0 0 5 0 0 0</pose></frame>"
+    "    <link name='A'>"
+    "      <collision name='box'>"
+    "        <pose>1 0 0 0 0 1.5707963267948966</pose>"
+    "        <geometry><box><size>1 2 4</size></box></geometry>"
+    "      </collision>"
+    "      <collision name='cylinder'>"
+    "        <pose relative_to='F'>0 0 0 1.5707963267948966 0 0</pose>"
+    "        <geometry>"
+    "          <cylinder><radius>1</radius><length>2</length></cylinder>"
+    "        </geometry>"
+    "      </collision>"
+    "    </link>"
+    "    <link name='B'>"
+    "      <pose>0 0 10 0 0 0</pose>"
+    "      <collision name='sphere'>"
+    "        <geometry><sphere><radius>0.5</radius></sphere></geometry>"
+    "      </collision>"
+    "      <collision name='mesh'>"
+    "        <geometry><mesh><uri>model://m/mesh.dae</uri></mesh></geometry>"
+    "      </collision>"
+    "    </link>"
+    "  </model>"
+    "</sdf>";
+
+  sdf::Root root;
+  EXPECT_TRUE(root.LoadSdfString(sdfString).empty());
+  const sdf::Model *model = root.ModelByIndex(0);
+  ASSERT_NE(nullptr, model);
+
+  sdf::CollisionGeometry geometry;
+  EXPECT_TRUE(model->ResolveCollisionGeometry(geometry).empty());
+
+  using Vector3d = ignition::math::Vector3d;
+  using Matrix3d = ignition::math::Matrix3d;
+  const double tol = 1e-9;
+
+  EXPECT_EQ(std::vector<uint64_t>({0, 0, 1, 1}), geometry.linkIndices);
+  EXPECT_EQ(std::vector<uint64_t>({0, 1, 0, 1}), geometry.collisionIndices);
+  EXPECT_EQ(std::vector<sdf::GeometryType>({sdf::GeometryType::BOX,
+      sdf::GeometryType::CYLINDER, sdf::GeometryType::SPHERE,
+      sdf::GeometryType::MESH}), geometry.types);
+  ASSERT_EQ(4u, geometry.poses.size());
+  ASSERT_EQ(4u, geometry.minCorners.size());
+  ASSERT_EQ(4u, geometry.maxCorners.size());
+  ASSERT_EQ(4u, geometry.volumes.size());
+  ASSERT_EQ(4u, geometry.inertias.size());
+
+  // The box is turned a quarter turn about z, so its x and y sizes swap.
+  EXPECT_TRUE(geometry.minCorners[0].Equal(Vector3d(0, -0.5, -2), tol));
+  EXPECT_TRUE(geometry.maxCorners[0].Equal(Vector3d(2, 0.5, 2), tol));
+  EXPECT_DOUBLE_EQ(8.0, geometry.volumes[0]);
+  EXPECT_TRUE(geometry.inertias[0].Equal(
+      Matrix3d(8.0 * 17 / 12, 0, 0, 0, 8.0 * 20 / 12, 0, 0, 0, 8.0 * 5 / 12),
+      tol));
+
+  // The cylinder is resolved relative to the frame, with its axis along y.
+  EXPECT_TRUE(geometry.poses[1].Pos().Equal(Vector3d(0, 0, 5), tol));
+  EXPECT_TRUE(geometry.minCorners[1].Equal(Vector3d(-1, -1, 4), tol));
+  EXPECT_TRUE(geometry.maxCorners[1].Equal(Vector3d(1, 1, 6), tol));
+  EXPECT_DOUBLE_EQ(2 * IGN_PI, geometry.volumes[1]);
+  const double radial = 2 * IGN_PI * 7 / 12;
+  EXPECT_TRUE(geometry.inertias[1].Equal(
+      Matrix3d(radial, 0, 0, 0, IGN_PI, 0, 0, 0, radial), tol));
+
+  // Bounds are in the frame of the link of each collision.
+  EXPECT_TRUE(geometry.minCorners[2].Equal(Vector3d(-0.5, -0.5, -0.5), tol));
+  EXPECT_TRUE(geometry.maxCorners[2].Equal(Vector3d(0.5, 0.5, 0.5), tol));
+  EXPECT_DOUBLE_EQ(IGN_PI / 6, geometry.volumes[2]);
+
+  // Meshes are unbounded.
+  EXPECT_TRUE(std::isinf(geometry.minCorners[3].X()));
+  EXPECT_TRUE(std::isinf(geometry.maxCorners[3].Z()));
+  EXPECT_DOUBLE_EQ(0.0, geometry.volumes[3]);
+  EXPECT_EQ(Matrix3d::Zero, geometry.inertias[3]);
+
+  // The arrays of a link are those of the model for that link.
+  sdf::CollisionGeometry linkGeometry;
+  EXPECT_TRUE(model->LinkByName("B")->ResolveCollisionGeometry(
+      linkGeometry).empty());
+  EXPECT_EQ(std::vector<uint64_t>({0, 0}), linkGeometry.linkIndices);
+  ASSERT_EQ(2u, linkGeometry.volumes.size());
+  EXPECT_DOUBLE_EQ(geometry.volumes[2], linkGeometry.volumes[0]);
+}
+
+/////////////////////////////////////////////////
+TEST(DOMModel, ValidationLevel)
+{
+  // The frames form cycles, which are only found by validating the graphs.
+  const std::string sdfString =
+    "<sdf version='1.7'>"
+    "  <model name='M'>"
+    "    <link name='L'/>"
+    "    <frame name='F1' attached_to='F2'>"
+    "      <pose relative_to='F2'/>"
+    "    </frame>"
+    "    <frame name='F2' attached_to='F1'>"
+    "      <pose relative_to='F1'/>"
+    "    </frame>"
+    "    <frame name='F3' attached_to='L'/>"
+    "  </model>"
+    "</sdf>";
+
+  auto hasCycleError = [](const sdf::Errors &_errors)
+  {
+    for (const auto &error : _errors)
+    {
+      if (error.Code() == sdf::ErrorCode::FRAME_ATTACHED_TO_CYCLE ||
+          error.Code() == sdf::ErrorCode::POSE_RELATIVE_TO_CYCLE)
+      {
+        return true;
+      }
+    }
+    return false;
+  };
+
+  sdf::Root fullRoot;
+  EXPECT_TRUE(hasCycleError(fullRoot.LoadSdfString(sdfString)));
+
+  sdf::ParserConfig config;
+  config.SetValidation(sdf::ValidationLevel::STRUCTURAL);
+  sdf::Root structuralRoot;
+  EXPECT_FALSE(hasCycleError(
+      structuralRoot.LoadSdfString(sdfString, config)));
+  const sdf::Model *model = structuralRoot.ModelByIndex(0);
+  ASSERT_NE(nullptr, model);
+  std::string body;
+  EXPECT_TRUE(model->FrameByName("F3")->ResolveAttachedToBody(body).empty());
+  EXPECT_EQ("L", body);
+
+  // The attached-to graph is not built.
+  config.SetValidation(sdf::ValidationLevel::NONE);
+  sdf::Root noneRoot;
+  EXPECT_FALSE(hasCycleError(noneRoot.LoadSdfString(sdfString, config)));
+  model = noneRoot.ModelByIndex(0);
+  ASSERT_NE(nullptr, model);
+  EXPECT_FALSE(model->FrameByName("F3")->ResolveAttachedToBody(body).empty());
+}
+
+/////////////////////////////////////////////////
+TEST(DOMModel, UpdateFramePose)
+{
+  const std::string testFile =
+    sdf::filesystem::append(PROJECT_SOURCE_PATH, "test", "sdf",
+        "model_frame_relative_to_joint.sdf");
+
+  // Load the SDF file
+  sdf::Root root;
+  EXPECT_TRUE(root.Load(testFile).empty());
+  ASSERT_NE(nullptr, root.ModelByIndex(0));
+  sdf::Model model = *root.ModelByIndex(0);
+
+  using Pose = ignition::math::Pose3d;
+  std::vector<Pose> poses;
+  EXPECT_TRUE(model.ResolveFramePoses(poses).empty());
+
+  // Poses of an updated model, compared with a copy whose poses are
+  // resolved from scratch.
+  auto expectSamePoses = [](const sdf::Model &_model)
+  {
+    std::vector<Pose> updatedPoses;
+    EXPECT_TRUE(_model.ResolveFramePoses(updatedPoses).empty());
+    sdf::Model copy = _model;
+    std::vector<Pose> copyPoses;
+    EXPECT_TRUE(copy.ResolveFramePoses(copyPoses).empty());
+    ASSERT_EQ(copyPoses.size(), updatedPoses.size());
+    for (std::size_t i = 0; i < copyPoses.size(); ++i)
+    {
+      EXPECT_EQ(copyPoses[i], updatedPoses[i]) << i;
+    }
+  };
+
+  // Move link C, which moves the frames relative to it.
+  Pose pose;
+  EXPECT_TRUE(model.UpdateFramePose("C", Pose(5, 0, 0, 0, 0, 0)).empty());
+  EXPECT_EQ(Pose(5, 0, 0, 0, 0, 0), model.LinkByName("C")->RawPose());
+  EXPECT_TRUE(model.FrameByName("F2")->SemanticPose().Resolve(
+      pose, "__model__").empty());
+  EXPECT_EQ(Pose(5, 0, 2, 0, 0, 0), pose);
+  expectSamePoses(model);
+
+  // Change the relative_to frame of F4.
+  EXPECT_TRUE(
+      model.UpdateFramePose("F4", Pose(0, 1, 0, 0, 0, 0), "P").empty());
+  EXPECT_EQ("P", model.FrameByName("F4")->PoseRelativeTo());
+  EXPECT_TRUE(model.FrameByName("F4")->SemanticPose().Resolve(
+      pose, "__model__").empty());
+  EXPECT_EQ(Pose(1, 1, 0, 0, 0, 0), pose);
+  expectSamePoses(model);
+
+  // An empty relative_to uses the default frame.
+  EXPECT_TRUE(model.UpdateFramePose("F4", Pose(0, 2, 0, 0, 0, 0)).empty());
+  EXPECT_TRUE(model.FrameByName("F4")->PoseRelativeTo().empty());
+  EXPECT_TRUE(model.FrameByName("F4")->SemanticPose().Resolve(
+      pose, "__model__").empty());
+  EXPECT_EQ(Pose(0, 2, 0, 0, 0, 0), pose);
+  expectSamePoses(model);
+
+  // Cycles are rejected without changing the model.
+  auto errors = model.UpdateFramePose("C", Pose::Zero, "F2");
+  ASSERT_EQ(1u, errors.size());
+  EXPECT_EQ(sdf::ErrorCode::POSE_RELATIVE_TO_CYCLE, errors[0].Code());
+  EXPECT_EQ(Pose(5, 0, 0, 0, 0, 0), model.LinkByName("C")->RawPose());
+  EXPECT_TRUE(model.LinkByName("C")->PoseRelativeTo().empty());
+  expectSamePoses(model);
+
+  errors = model.UpdateFramePose("F1", Pose::Zero, "invalid");
+  ASSERT_EQ(1u, errors.size());
+  EXPECT_EQ(sdf::ErrorCode::POSE_RELATIVE_TO_INVALID, errors[0].Code());
+
+  errors = model.UpdateFramePose("invalid", Pose::Zero);
+  ASSERT_EQ(1u, errors.size());
+  EXPECT_EQ(sdf::ErrorCode::POSE_RELATIVE_TO_INVALID, errors[0].Code());
+}
+
+/////////////////////////////////////////////////
+TEST(DOMModel, SharedFrameGraphs)
+{
+  const std::string modelStr =
+      "  <model name='%s'>"
+      "    <pose>%s</pose>"
+      "    <link name='base'><pose>0 0 1 0 0 0</pose></link>"
+      "    <link name='arm'>"
+      "      <pose relative_to='base'>1 0 0 0 0 0</pose>"
+      "    </link>"
+      "    <joint name='j' type='fixed'>"
+      "      <parent>base</parent><child>arm</child>"
+      "    </joint>"
+      "    <frame name='tip' attached_to='arm'>"
+      "      <pose relative_to='j'>0 1 0 0 0 0</pose>"
+      "    </frame>"
+      "  </model>";
+  auto model = [&modelStr](const std::string &_name, const std::string &_pose)
+  {
+    std::string str = modelStr;
+    str.replace(str.find("%s"), 2, _name);
+    str.replace(str.find("%s"), 2, _pose);
+    return str;
+  };
+  const std::string sdfStr =
+      "<sdf version='1.8'><world name='default'>" +
+      model("m1", "0 0 0 0 0 0") + model("m2", "5 0 0 0 0 0") +
+      model("m3", "0 5 0 0 0 0") + "</world></sdf>";
+
+  sdf::Root root;
+  EXPECT_TRUE(root.LoadSdfString(sdfStr).empty());
+  const sdf::World *world = root.WorldByIndex(0);
+  ASSERT_NE(nullptr, world);
+  ASSERT_EQ(3u, world->ModelCount());
+
+  // The models have the same structure, so they resolve the same poses
+  // within the model frame.
+  using Pose = ignition::math::Pose3d;
+  std::vector<Pose> poses1, poses2;
+  EXPECT_TRUE(world->ModelByIndex(0)->ResolveFramePoses(poses1).empty());
+  EXPECT_TRUE(world->ModelByIndex(1)->ResolveFramePoses(poses2).empty());
+  EXPECT_EQ(poses1, poses2);
+  ASSERT_EQ(5u, poses1.size());
+  EXPECT_EQ(Pose(1, 1, 1, 0, 0, 0), poses1[4]);
+
+  // Updating a copy of one model does not change the others.
+  sdf::Model m2 = *world->ModelByIndex(1);
+  EXPECT_TRUE(m2.UpdateFramePose("base", Pose(0, 0, 2, 0, 0, 0)).empty());
+  EXPECT_TRUE(m2.ResolveFramePoses(poses2).empty());
+  EXPECT_EQ(Pose(1, 1, 2, 0, 0, 0), poses2[4]);
+
+  std::vector<Pose> poses3;
+  EXPECT_TRUE(world->ModelByIndex(1)->ResolveFramePoses(poses2).empty());
+  EXPECT_TRUE(world->ModelByIndex(2)->ResolveFramePoses(poses3).empty());
+  EXPECT_EQ(poses1, poses2);
+  EXPECT_EQ(poses1, poses3);
+
+  // A model loaded after the update still gets the original graph.
+  sdf::Root root2;
+  EXPECT_TRUE(root2.LoadSdfString(sdfStr).empty());
+  ASSERT_NE(nullptr, root2.WorldByIndex(0));
+  ASSERT_EQ(3u, root2.WorldByIndex(0)->ModelCount());
+  EXPECT_TRUE(root2.WorldByIndex(0)->ModelByIndex(2)->ResolveFramePoses(
+      poses3).empty());
+  EXPECT_EQ(poses1, poses3);
+
+  // A frame added after an update of the poses of the copy is only added
+  // to the attached-to graph of the copy.
+  sdf::Frame frame;
+  frame.SetName("tool");
+  frame.SetAttachedTo("tip");
+  frame.SetRawPose(Pose(0, 0, 1, 0, 0, 0));
+  EXPECT_TRUE(m2.AddFrame(std::move(frame)).empty());
+  std::string body;
+  ASSERT_NE(nullptr, m2.FrameByName("tool"));
+  EXPECT_TRUE(m2.FrameByName("tool")->ResolveAttachedToBody(body).empty());
+  EXPECT_EQ("arm", body);
+  EXPECT_TRUE(m2.ResolveFramePoses(poses2).empty());
+  ASSERT_EQ(6u, poses2.size());
+  EXPECT_EQ(Pose(1, 1, 3, 0, 0, 0), poses2[5]);
+
+  for (uint64_t i = 0; i < world->ModelCount(); ++i)
+  {
+    const sdf::Model *other = world->ModelByIndex(i);
+    EXPECT_EQ(nullptr, other->FrameByName("tool"));
+    EXPECT_TRUE(other->FrameByName("tip")->ResolveAttachedToBody(
+        body).empty());
+    EXPECT_EQ("arm", body);
+    EXPECT_TRUE(other->ResolveFramePoses(poses2).empty());
+    EXPECT_EQ(poses1, poses2);
+  }
+}
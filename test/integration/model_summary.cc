@@ -0,0 +1,94 @@
+/*
+ * Copyright 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "sdf/Error.hh"
+#include "sdf/Filesystem.hh"
+#include "sdf/ModelSummary.hh"
+
+#include "test_config.h"
+
+/////////////////////////////////////////////////
+TEST(ModelSummary, ModelDirectory)
+{
+  const std::string modelDir = sdf::filesystem::append(PROJECT_SOURCE_PATH,
+      "test", "integration", "model", "test_model_with_frames");
+
+  sdf::ModelSummary summary;
+  EXPECT_TRUE(sdf::peekModel(modelDir, summary).empty());
+  EXPECT_EQ(sdf::filesystem::append(modelDir, "model.sdf"),
+      summary.filePath);
+  EXPECT_EQ("test_model_with_frames", summary.name);
+  EXPECT_EQ("1.7", summary.sdfVersion);
+  EXPECT_EQ(4u, summary.linkCount);
+  EXPECT_EQ(3u, summary.jointCount);
+  EXPECT_EQ(0u, summary.sensorCount);
+  EXPECT_TRUE(summary.includes.empty());
+}
+
+/////////////////////////////////////////////////
+TEST(ModelSummary, ModelVersions)
+{
+  // The model file is selected by model.config, and not converted.
+  const std::string modelDir = sdf::filesystem::append(PROJECT_SOURCE_PATH,
+      "test", "integration", "model", "cococan");
+
+  sdf::ModelSummary summary;
+  EXPECT_TRUE(sdf::peekModel(modelDir, summary).empty());
+  EXPECT_EQ(sdf::filesystem::append(modelDir, "model-1_4.sdf"),
+      summary.filePath);
+  EXPECT_EQ("cococan", summary.name);
+  EXPECT_EQ("1.4", summary.sdfVersion);
+  EXPECT_EQ(1u, summary.linkCount);
+}
+
+/////////////////////////////////////////////////
+TEST(ModelSummary, Includes)
+{
+  const std::string modelFile = sdf::filesystem::append(PROJECT_SOURCE_PATH,
+      "test", "integration", "model", "test_nested_model_with_frames",
+      "model.sdf");
+
+  sdf::ModelSummary summary;
+  EXPECT_TRUE(sdf::peekModel(modelFile, summary).empty());
+  EXPECT_EQ(modelFile, summary.filePath);
+  EXPECT_EQ("test_nested_model_with_frames", summary.name);
+  EXPECT_EQ(0u, summary.linkCount);
+  ASSERT_EQ(1u, summary.includes.size());
+  EXPECT_EQ("test_model_with_frames", summary.includes[0]);
+}
+
+/////////////////////////////////////////////////
+TEST(ModelSummary, Errors)
+{
+  sdf::ModelSummary summary;
+  sdf::Errors errors = sdf::peekModel(sdf::filesystem::append(
+      PROJECT_SOURCE_PATH, "test", "integration", "model", "non-existent"),
+      summary);
+  ASSERT_EQ(1u, errors.size());
+  EXPECT_EQ(sdf::ErrorCode::FILE_READ, errors[0].Code());
+
+  // A world file has no model.
+  errors = sdf::peekModel(sdf::filesystem::append(PROJECT_SOURCE_PATH,
+      "test", "sdf", "empty.sdf"), summary);
+  ASSERT_EQ(1u, errors.size());
+  EXPECT_EQ(sdf::ErrorCode::ELEMENT_MISSING, errors[0].Code());
+  EXPECT_EQ("1.6", summary.sdfVersion);
+}
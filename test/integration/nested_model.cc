@@ -832,3 +832,72 @@ TEST(NestedModel, NestedFrameOnlyModel)
   EXPECT_TRUE(frame2->SemanticPose().Resolve(frame2Pose).empty());
   EXPECT_EQ(frame2ExpPose, frame2Pose);
 }
+
+//////////////////////////////////////////////////
+// Test resolving the scoped names of the children of nested models
+TEST(NestedModel, ScopedNameLookup)
+{
+  const std::string modelRootPath = std::string(PROJECT_SOURCE_PATH)
+      + "/test/integration/model/";
+  const std::string modelPath = modelRootPath +
+      "test_nested_model_with_frames";
+
+  std::ostringstream stream;
+  stream
+    << "<sdf version='1.7'>"
+    << "<world name='default'>"
+    << "  <frame name='world_frame'/>"
+    << "  <model name='ParentModel'>"
+    << "    <include>"
+    << "      <uri>" + modelPath + "</uri>"
+    << "      <name>M1</name>"
+    << "    </include>"
+    << "  </model>"
+    << "</world>"
+    << "</sdf>";
+
+  sdf::setFindCallback(
+      [&](const std::string &_file)
+      {
+        return modelRootPath + _file;
+      });
+
+  sdf::Root root;
+  sdf::Errors errors = root.LoadSdfString(stream.str());
+  EXPECT_TRUE(errors.empty());
+
+  const sdf::World *world = root.WorldByIndex(0);
+  ASSERT_NE(nullptr, world);
+
+  const std::string scope = "M1::test_model_with_frames::";
+  const sdf::Link *link =
+      world->LinkByScopedName("ParentModel::" + scope + "L1");
+  ASSERT_NE(nullptr, link);
+  EXPECT_EQ(scope + "L1", link->Name());
+  EXPECT_EQ(link, root.LinkByScopedName("default::ParentModel::" +
+      scope + "L1"));
+
+  const sdf::Joint *joint =
+      world->JointByScopedName("ParentModel::" + scope + "J1");
+  ASSERT_NE(nullptr, joint);
+  EXPECT_EQ(scope + "J1", joint->Name());
+  EXPECT_EQ(joint, root.JointByScopedName("default::ParentModel::" +
+      scope + "J1"));
+
+  const sdf::Frame *frame =
+      world->FrameByScopedName("ParentModel::" + scope + "F1");
+  ASSERT_NE(nullptr, frame);
+  EXPECT_EQ(scope + "F1", frame->Name());
+  EXPECT_EQ(frame, root.FrameByScopedName("default::ParentModel::" +
+      scope + "F1"));
+
+  const sdf::Frame *worldFrame = world->FrameByScopedName("world_frame");
+  ASSERT_NE(nullptr, worldFrame);
+  EXPECT_EQ(worldFrame, root.FrameByScopedName("default::world_frame"));
+
+  EXPECT_EQ(nullptr, world->LinkByScopedName(scope + "L1"));
+  EXPECT_EQ(nullptr, world->LinkByScopedName("ParentModel::L1"));
+  EXPECT_EQ(nullptr, world->JointByScopedName("ParentModel"));
+  EXPECT_EQ(nullptr, root.LinkByScopedName("ParentModel::" + scope + "L1"));
+  EXPECT_EQ(nullptr, root.FrameByScopedName("world_frame"));
+}
@@ -64,3 +64,56 @@ TEST(PluginAttribute, ParseAttributes)
               std::string("value"));
   }
 }
+
+////////////////////////////////////////
+// make sure that deferred plugin elements are read as they would have been
+// copied
+TEST(PluginAttribute, DeferCopiedElements)
+{
+  std::ostringstream stream;
+  stream
+    << "<sdf version='" << SDF_VERSION << "'>"
+    << "<model name='model'>"
+    << "  <link name='link'/>"
+    << "  <plugin name='example' filename='libexample.so'>"
+    << "    <user attribute='attribute' />"
+    << "    <value attribute='a &amp; b'>1 &lt; 2<nested>text</nested></value>"
+    << "  </plugin>"
+    << "  <custom:element custom:attribute='1'>"
+    << "    <custom:child>value</custom:child>"
+    << "  </custom:element>"
+    << "</model>"
+    << "</sdf>";
+
+  sdf::SDFPtr copied(new sdf::SDF());
+  sdf::init(copied);
+  sdf::Errors errors;
+  ASSERT_TRUE(sdf::readString(stream.str(), sdf::ParserConfig(), copied,
+      errors));
+  EXPECT_TRUE(errors.empty());
+
+  sdf::ParserConfig config;
+  config.SetDeferCopiedElements(true);
+  sdf::SDFPtr deferred(new sdf::SDF());
+  sdf::init(deferred);
+  ASSERT_TRUE(sdf::readString(stream.str(), config, deferred, errors));
+  EXPECT_TRUE(errors.empty());
+
+  sdf::ElementPtr model = deferred->Root()->GetElement("model");
+  sdf::ElementPtr plugin = model->GetElement("plugin");
+  sdf::ElementPtr custom = model->GetElement("custom:element");
+  EXPECT_TRUE(plugin->ElementsDeferred());
+  EXPECT_TRUE(custom->ElementsDeferred());
+  EXPECT_EQ("example", plugin->Get<std::string>("name"));
+  EXPECT_EQ("1", custom->GetAttribute("custom:attribute")->GetAsString());
+
+  sdf::ElementPtr value = plugin->GetElement("value");
+  EXPECT_FALSE(plugin->ElementsDeferred());
+  EXPECT_TRUE(custom->ElementsDeferred());
+  EXPECT_EQ("a & b", value->GetAttribute("attribute")->GetAsString());
+  EXPECT_EQ("1 < 2", value->Get<std::string>(""));
+  EXPECT_TRUE(value->HasElement("nested"));
+
+  EXPECT_EQ(copied->Root()->ToString(""), deferred->Root()->ToString(""));
+  EXPECT_FALSE(custom->ElementsDeferred());
+}
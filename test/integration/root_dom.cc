@@ -15,12 +15,24 @@
  *
  */
 
+#include <ctime>
+#include <fstream>
+#include <future>
+#include <mutex>
 #include <string>
+#include <vector>
 #include <gtest/gtest.h>
+#ifndef _WIN32
+#include <utime.h>
+#endif
 
 #include "sdf/Error.hh"
 #include "sdf/Filesystem.hh"
+#include "sdf/IncludeCache.hh"
+#include "sdf/LoadHandle.hh"
+#include "sdf/Link.hh"
 #include "sdf/Model.hh"
+#include "sdf/ParserConfig.hh"
 #include "sdf/Root.hh"
 #include "sdf/Types.hh"
 #include "sdf/World.hh"
@@ -109,3 +121,211 @@ TEST(DOMRoot, LoadDuplicateModels)
   EXPECT_EQ(1u, root.ModelCount());
   EXPECT_EQ("robot1", root.ModelByIndex(0)->Name());
 }
+
+/////////////////////////////////////////////////
+TEST(DOMRoot, LoadAsync)
+{
+  const std::string testFile =
+    sdf::filesystem::append(PROJECT_SOURCE_PATH, "test", "sdf",
+        "empty.sdf");
+
+  std::mutex mutex;
+  std::vector<sdf::LoadProgress> progress;
+  sdf::ParserConfig config;
+  config.SetProgressCallback([&](const sdf::LoadProgress &_progress)
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        progress.push_back(_progress);
+      });
+
+  sdf::Root root;
+  sdf::LoadHandle handle = root.LoadAsync(testFile, config);
+  ASSERT_TRUE(handle.Valid());
+  EXPECT_TRUE(handle.Wait().empty());
+  EXPECT_TRUE(handle.Ready());
+  EXPECT_TRUE(handle.Wait().empty());
+
+  ASSERT_EQ(1u, root.WorldCount());
+  EXPECT_EQ(1u, root.WorldByIndex(0)->ModelCount());
+
+  ASSERT_EQ(4u, progress.size());
+  EXPECT_EQ(sdf::LoadProgressType::FILE_RESOLVED, progress[0].type);
+  EXPECT_EQ(testFile, progress[0].name);
+  EXPECT_EQ(sdf::LoadProgressType::FILE_PARSED, progress[1].type);
+  EXPECT_EQ(testFile, progress[1].name);
+  EXPECT_LT(0u, progress[1].bytes);
+  EXPECT_EQ(sdf::LoadProgressType::MODEL_LOADED, progress[2].type);
+  EXPECT_EQ("ground_plane", progress[2].name);
+  EXPECT_TRUE(progress[2].model != nullptr);
+  EXPECT_EQ(sdf::LoadProgressType::WORLD_LOADED, progress[3].type);
+  EXPECT_EQ("default", progress[3].name);
+  EXPECT_TRUE(progress[3].world != nullptr);
+
+  sdf::LoadHandle empty;
+  EXPECT_FALSE(empty.Valid());
+  EXPECT_FALSE(empty.Ready());
+  EXPECT_TRUE(empty.Wait().empty());
+}
+
+/////////////////////////////////////////////////
+TEST(DOMRoot, LoadAsyncCancel)
+{
+  const std::string testFile =
+    sdf::filesystem::append(PROJECT_SOURCE_PATH, "test", "sdf",
+        "empty.sdf");
+
+  // Hold the load once the file is resolved, until it is cancelled.
+  std::promise<void> resolved;
+  std::promise<void> cancelled;
+  std::shared_future<void> cancelledFuture = cancelled.get_future().share();
+  sdf::ParserConfig config;
+  config.SetProgressCallback([&](const sdf::LoadProgress &_progress)
+      {
+        if (_progress.type == sdf::LoadProgressType::FILE_RESOLVED)
+        {
+          resolved.set_value();
+          cancelledFuture.wait();
+        }
+      });
+
+  sdf::Root root;
+  sdf::LoadHandle handle = root.LoadAsync(testFile, config);
+  resolved.get_future().wait();
+  handle.Cancel();
+  cancelled.set_value();
+
+  sdf::Errors errors = handle.Wait();
+  bool hasCancelled = false;
+  for (const sdf::Error &error : errors)
+    hasCancelled |= error.Code() == sdf::ErrorCode::LOAD_CANCELLED;
+  EXPECT_TRUE(hasCancelled);
+  EXPECT_EQ(0u, root.WorldCount());
+}
+
+/////////////////////////////////////////////////
+TEST(DOMRoot, LoadCancelCallback)
+{
+  const std::string testFile =
+    sdf::filesystem::append(PROJECT_SOURCE_PATH, "test", "sdf",
+        "root_multiple_models.sdf");
+
+  // Cancel once the first model is loaded, so the others are skipped.
+  bool cancel = false;
+  sdf::ParserConfig config;
+  config.SetProgressCallback([&](const sdf::LoadProgress &_progress)
+      {
+        if (_progress.type == sdf::LoadProgressType::MODEL_LOADED)
+          cancel = true;
+      });
+  config.SetCancelCallback([&]()
+      {
+        return cancel;
+      });
+
+  sdf::Root root;
+  sdf::Errors errors = root.Load(testFile, config);
+  ASSERT_FALSE(errors.empty());
+  EXPECT_EQ(sdf::ErrorCode::LOAD_CANCELLED, errors.back().Code());
+  EXPECT_EQ(1u, root.ModelCount());
+  EXPECT_EQ("robot1", root.ModelByIndex(0)->Name());
+}
+
+#ifndef _WIN32
+/////////////////////////////////////////////////
+/// \brief Write a model directory with one link, and set the modification
+/// time of its model file.
+/// \param[in] _dir Path of the model directory.
+/// \param[in] _link Name of the link.
+/// \param[in] _time Modification time of the model file.
+void writeReloadModel(const std::string &_dir, const std::string &_link,
+    std::time_t _time)
+{
+  sdf::filesystem::create_directory(_dir);
+  {
+    std::ofstream out(sdf::filesystem::append(_dir, "model.config"));
+    out << "<?xml version='1.0'?>\n"
+        << "<model><name>m</name><sdf version='1.8'>model.sdf</sdf>"
+        << "</model>\n";
+  }
+  const std::string modelFile = sdf::filesystem::append(_dir, "model.sdf");
+  {
+    std::ofstream out(modelFile);
+    out << "<?xml version='1.0'?>\n"
+        << "<sdf version='1.8'><model name='m'><link name='" << _link
+        << "'/></model></sdf>\n";
+  }
+  struct utimbuf times;
+  times.actime = _time;
+  times.modtime = _time;
+  utime(modelFile.c_str(), &times);
+}
+
+/////////////////////////////////////////////////
+TEST(DOMRoot, Reload)
+{
+  const std::string dir = sdf::filesystem::append(PROJECT_BINARY_DIR,
+      "test", "root_reload");
+  sdf::filesystem::create_directory(dir);
+  const std::string first = sdf::filesystem::append(dir, "first");
+  const std::string second = sdf::filesystem::append(dir, "second");
+  writeReloadModel(first, "link", 1000);
+  writeReloadModel(second, "link", 1000);
+
+  const std::string worldFile = sdf::filesystem::append(dir, "world.sdf");
+  {
+    std::ofstream out(worldFile);
+    out << "<?xml version='1.0'?>\n"
+        << "<sdf version='1.8'>\n"
+        << "  <world name='first'>\n"
+        << "    <include><uri>" << first << "</uri></include>\n"
+        << "  </world>\n"
+        << "  <world name='second'>\n"
+        << "    <include><uri>" << second << "</uri></include>\n"
+        << "  </world>\n"
+        << "</sdf>\n";
+  }
+
+  sdf::Root root;
+  EXPECT_FALSE(root.Reload().empty());
+
+  sdf::ParserConfig config;
+  config.SetIncludeCache(std::make_shared<sdf::IncludeCache>());
+  ASSERT_TRUE(root.Load(worldFile, config).empty());
+  ASSERT_EQ(2u, root.WorldCount());
+  const sdf::Model *firstModel = root.WorldByIndex(0)->ModelByIndex(0);
+  const sdf::Model *secondModel = root.WorldByIndex(1)->ModelByIndex(0);
+  ASSERT_NE(nullptr, firstModel);
+  ASSERT_NE(nullptr, secondModel);
+
+  // Nothing is reloaded when no file changed.
+  EXPECT_TRUE(root.Reload().empty());
+  EXPECT_EQ(firstModel, root.WorldByIndex(0)->ModelByIndex(0));
+  EXPECT_EQ(secondModel, root.WorldByIndex(1)->ModelByIndex(0));
+
+  // Only the world that includes the changed model is reloaded.
+  writeReloadModel(first, "changed_link", 2000);
+  EXPECT_TRUE(root.Reload().empty());
+  ASSERT_EQ(2u, root.WorldCount());
+  const sdf::Model *reloadedModel = root.WorldByIndex(0)->ModelByIndex(0);
+  ASSERT_NE(nullptr, reloadedModel);
+  EXPECT_TRUE(reloadedModel->LinkNameExists("changed_link"));
+  EXPECT_FALSE(reloadedModel->LinkNameExists("link"));
+  EXPECT_EQ(secondModel, root.WorldByIndex(1)->ModelByIndex(0));
+  EXPECT_TRUE(secondModel->LinkNameExists("link"));
+
+  // A change of the loaded file reloads everything.
+  {
+    std::ofstream out(worldFile, std::ios::app);
+    out << "\n";
+  }
+  struct utimbuf times;
+  times.actime = 3000;
+  times.modtime = 3000;
+  utime(worldFile.c_str(), &times);
+  EXPECT_TRUE(root.Reload().empty());
+  ASSERT_EQ(2u, root.WorldCount());
+  EXPECT_TRUE(root.WorldByIndex(0)->ModelByIndex(0)->LinkNameExists(
+      "changed_link"));
+  EXPECT_TRUE(root.WorldByIndex(1)->ModelByIndex(0)->LinkNameExists("link"));
+}
+#endif
@@ -0,0 +1,229 @@
+/*
+ * Copyright 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <tinyxml.h>
+#include <ignition/math/Pose3.hh>
+
+#include "sdf/sdf.hh"
+
+#include "test_config.h"
+
+/////////////////////////////////////////////////
+/// \brief Split a parameter value in numbers.
+/// \param[in] _value The value.
+/// \param[out] _numbers The numbers.
+/// \return True if the whole value is a list of numbers.
+bool ToNumbers(const std::string &_value, std::vector<double> &_numbers)
+{
+  std::istringstream stream(_value);
+  double number;
+  while (stream >> number)
+  {
+    _numbers.push_back(number);
+  }
+  return stream.eof() && !_numbers.empty();
+}
+
+/////////////////////////////////////////////////
+/// \brief Check that two parameters are equal, up to the rounding of the
+/// values that the conversion through XML prints.
+void ExpectParamNear(sdf::ParamPtr _expected, sdf::ParamPtr _actual)
+{
+  ASSERT_NE(nullptr, _expected);
+  ASSERT_NE(nullptr, _actual);
+  EXPECT_EQ(_expected->GetKey(), _actual->GetKey());
+  EXPECT_EQ(_expected->GetTypeName(), _actual->GetTypeName());
+  EXPECT_EQ(_expected->GetSet(), _actual->GetSet()) << _expected->GetKey();
+
+  const double tol = 1e-9;
+  if (_expected->GetTypeName() == "pose")
+  {
+    ignition::math::Pose3d expected, actual;
+    ASSERT_TRUE(_expected->Get(expected));
+    ASSERT_TRUE(_actual->Get(actual));
+    EXPECT_TRUE(expected.Pos().Equal(actual.Pos(), tol))
+      << expected << " != " << actual;
+    EXPECT_TRUE(expected.Rot().Equal(actual.Rot(), tol) ||
+                expected.Rot().Equal(-actual.Rot(), tol))
+      << expected << " != " << actual;
+    return;
+  }
+
+  std::vector<double> expected, actual;
+  if (ToNumbers(_expected->GetAsString(), expected) &&
+      ToNumbers(_actual->GetAsString(), actual))
+  {
+    ASSERT_EQ(expected.size(), actual.size());
+    for (size_t i = 0; i < expected.size(); ++i)
+    {
+      EXPECT_NEAR(expected[i], actual[i], tol) << _expected->GetKey();
+    }
+  }
+  else
+  {
+    EXPECT_EQ(_expected->GetAsString(), _actual->GetAsString());
+  }
+}
+
+/////////////////////////////////////////////////
+/// \brief Check that two element trees are equal, up to the rounding of the
+/// values that the conversion through XML prints.
+void ExpectElementNear(sdf::ElementPtr _expected, sdf::ElementPtr _actual)
+{
+  ASSERT_NE(nullptr, _expected);
+  ASSERT_NE(nullptr, _actual);
+  ASSERT_EQ(_expected->GetName(), _actual->GetName());
+  EXPECT_EQ(_expected->FilePath(), _actual->FilePath());
+  EXPECT_EQ(_expected->OriginalVersion(), _actual->OriginalVersion());
+
+  ASSERT_EQ(_expected->GetAttributeCount(), _actual->GetAttributeCount());
+  for (size_t i = 0; i < _expected->GetAttributeCount(); ++i)
+  {
+    ExpectParamNear(_expected->GetAttribute(i), _actual->GetAttribute(i));
+  }
+
+  ASSERT_EQ(nullptr == _expected->GetValue(), nullptr == _actual->GetValue());
+  if (_expected->GetValue())
+  {
+    ExpectParamNear(_expected->GetValue(), _actual->GetValue());
+  }
+
+  sdf::ElementPtr expectedChild = _expected->GetFirstElement();
+  sdf::ElementPtr actualChild = _actual->GetFirstElement();
+  while (expectedChild && actualChild)
+  {
+    ExpectElementNear(expectedChild, actualChild);
+    expectedChild = expectedChild->GetNextElement();
+    actualChild = actualChild->GetNextElement();
+  }
+  EXPECT_EQ(nullptr, expectedChild) << "missing child of "
+    << _actual->GetName();
+  EXPECT_EQ(nullptr, actualChild) << "extra child of "
+    << _actual->GetName();
+}
+
+/////////////////////////////////////////////////
+/// \brief Read a URDF file with and without the direct conversion, and
+/// check that the element trees are equivalent.
+void CheckUrdfFile(const std::string &_filename)
+{
+  SCOPED_TRACE(_filename);
+
+  sdf::SDFPtr expected(new sdf::SDF());
+  sdf::init(expected);
+  sdf::Errors errors;
+  ASSERT_TRUE(sdf::readFile(_filename, expected, errors));
+  EXPECT_TRUE(errors.empty());
+
+  sdf::ParserConfig config;
+  config.SetDirectUrdfConversion(true);
+  sdf::SDFPtr actual(new sdf::SDF());
+  sdf::init(actual);
+  ASSERT_TRUE(sdf::readFile(_filename, config, actual, errors));
+  EXPECT_TRUE(errors.empty());
+
+  EXPECT_EQ(expected->FilePath(), actual->FilePath());
+  EXPECT_EQ(expected->OriginalVersion(), actual->OriginalVersion());
+  ExpectElementNear(expected->Root(), actual->Root());
+
+  sdf::Root root;
+  EXPECT_TRUE(root.Load(actual, config).empty());
+}
+
+/////////////////////////////////////////////////
+TEST(UrdfDirectConversion, Files)
+{
+  for (const std::string name : {"fixed_joint_reduction.urdf",
+                                 "fixed_joint_reduction_simple.urdf",
+                                 "fixed_joint_reduction_visual.urdf",
+                                 "fixed_joint_reduction_collision.urdf",
+                                 "urdf_joint_parameters.urdf"})
+  {
+    CheckUrdfFile(sdf::filesystem::append(
+          PROJECT_SOURCE_PATH, "test", "integration", name));
+  }
+}
+
+/////////////////////////////////////////////////
+TEST(UrdfDirectConversion, AtlasWithoutExtensions)
+{
+  const std::string filename = sdf::filesystem::append(
+      PROJECT_SOURCE_PATH, "test", "performance", "parser_urdf_atlas.urdf");
+
+  TiXmlDocument doc;
+  ASSERT_TRUE(doc.LoadFile(filename));
+  TiXmlElement *robot = doc.FirstChildElement("robot");
+  ASSERT_NE(nullptr, robot);
+  while (TiXmlElement *gazebo = robot->FirstChildElement("gazebo"))
+  {
+    robot->RemoveChild(gazebo);
+  }
+  std::ostringstream stream;
+  stream << doc;
+
+  sdf::SDFPtr expected(new sdf::SDF());
+  sdf::init(expected);
+  sdf::Errors errors;
+  ASSERT_TRUE(sdf::readString(stream.str(), expected, errors));
+  EXPECT_TRUE(errors.empty());
+
+  sdf::ParserConfig config;
+  config.SetDirectUrdfConversion(true);
+  sdf::SDFPtr actual(new sdf::SDF());
+  sdf::init(actual);
+  ASSERT_TRUE(sdf::readString(stream.str(), config, actual, errors));
+  EXPECT_TRUE(errors.empty());
+
+  ExpectElementNear(expected->Root(), actual->Root());
+
+  // Some Atlas links have invalid inertias, which are reported the same way
+  // for both conversions.
+  sdf::Root expectedRoot;
+  sdf::Root root;
+  EXPECT_EQ(expectedRoot.Load(expected).size(),
+            root.Load(actual, config).size());
+  ASSERT_NE(nullptr, root.ModelByIndex(0));
+  EXPECT_LT(10u, root.ModelByIndex(0)->LinkCount());
+}
+
+/////////////////////////////////////////////////
+TEST(UrdfDirectConversion, ExtensionsFallBack)
+{
+  const std::string filename = sdf::filesystem::append(PROJECT_SOURCE_PATH,
+      "test", "integration", "urdf_gazebo_extensions.urdf");
+
+  sdf::SDFPtr expected(new sdf::SDF());
+  sdf::init(expected);
+  ASSERT_TRUE(sdf::readFile(filename, expected));
+
+  sdf::ParserConfig config;
+  config.SetDirectUrdfConversion(true);
+  sdf::SDFPtr actual(new sdf::SDF());
+  sdf::init(actual);
+  sdf::Errors errors;
+  ASSERT_TRUE(sdf::readFile(filename, config, actual, errors));
+  EXPECT_TRUE(errors.empty());
+
+  // URDF with <gazebo> extensions is converted through XML, so the result
+  // is identical.
+  EXPECT_EQ(expected->Root()->ToString(""), actual->Root()->ToString(""));
+}
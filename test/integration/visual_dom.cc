@@ -25,6 +25,7 @@
 #include "sdf/Joint.hh"
 #include "sdf/Link.hh"
 #include "sdf/Model.hh"
+#include "sdf/ParserConfig.hh"
 #include "sdf/Root.hh"
 #include "sdf/Types.hh"
 #include "sdf/Visual.hh"
@@ -417,3 +418,84 @@ TEST(DOMVisual, VisibilityFlags)
 
   EXPECT_EQ(0x00000001u, vis1->VisibilityFlags());
 }
+
+//////////////////////////////////////////////////
+TEST(DOMVisual, SharedMaterials)
+{
+  const std::string red =
+    "<material><diffuse>1 0 0 1</diffuse></material>";
+  const std::string blue =
+    "<material><diffuse>0 0 1 1</diffuse></material>";
+  const std::string sdfString =
+    "<sdf version='1.8'>"
+    "  <model name='model'>"
+    "    <link name='link'>"
+    "      <visual name='v1'>"
+    "        <geometry><sphere><radius>1</radius></sphere></geometry>" + red +
+    "      </visual>"
+    "      <visual name='v2'>"
+    "        <geometry><box><size>1 1 1</size></box></geometry>" + red +
+    "      </visual>"
+    "      <visual name='v3'>"
+    "        <geometry><sphere><radius>1</radius></sphere></geometry>" + blue +
+    "      </visual>"
+    "      <visual name='v4'>"
+    "        <geometry><sphere><radius>1</radius></sphere></geometry>"
+    "      </visual>"
+    "    </link>"
+    "  </model>"
+    "</sdf>";
+
+  // Materials are not shared by default.
+  sdf::Root ownRoot;
+  EXPECT_TRUE(ownRoot.LoadSdfString(sdfString).empty());
+  const sdf::Link *ownLink = ownRoot.ModelByIndex(0)->LinkByIndex(0);
+  ASSERT_NE(nullptr, ownLink);
+  EXPECT_EQ(0u, ownLink->VisualByName("v1")->MaterialId());
+  EXPECT_NE(ownLink->VisualByName("v1")->Material(),
+            ownLink->VisualByName("v2")->Material());
+
+  sdf::ParserConfig config;
+  config.SetShareMaterials(true);
+  sdf::Root root;
+  EXPECT_TRUE(root.LoadSdfString(sdfString, config).empty());
+  const sdf::Link *link = root.ModelByIndex(0)->LinkByIndex(0);
+  ASSERT_NE(nullptr, link);
+
+  const sdf::Visual *v1 = link->VisualByName("v1");
+  const sdf::Visual *v2 = link->VisualByName("v2");
+  const sdf::Visual *v3 = link->VisualByName("v3");
+  const sdf::Visual *v4 = link->VisualByName("v4");
+  ASSERT_NE(nullptr, v1);
+  ASSERT_NE(nullptr, v2);
+  ASSERT_NE(nullptr, v3);
+  ASSERT_NE(nullptr, v4);
+
+  // Identical materials are the same instance, with the same identifier.
+  EXPECT_NE(0u, v1->MaterialId());
+  EXPECT_EQ(v1->MaterialId(), v2->MaterialId());
+  EXPECT_EQ(v1->Material(), v2->Material());
+  EXPECT_NE(0u, v3->MaterialId());
+  EXPECT_NE(v1->MaterialId(), v3->MaterialId());
+  EXPECT_EQ(ignition::math::Color(0, 0, 1, 1), v3->Material()->Diffuse());
+  EXPECT_EQ(0u, v4->MaterialId());
+  EXPECT_EQ(nullptr, v4->Material());
+
+  // Materials are shared across documents while they are in use.
+  sdf::Root root2;
+  EXPECT_TRUE(root2.LoadSdfString(sdfString, config).empty());
+  EXPECT_EQ(v1->MaterialId(), root2.ModelByIndex(0)->LinkByIndex(0)->
+      VisualByName("v2")->MaterialId());
+
+  // Copies keep sharing the material.
+  sdf::Visual copy(*v1);
+  EXPECT_EQ(v1->MaterialId(), copy.MaterialId());
+  EXPECT_EQ(v1->Material(), copy.Material());
+
+  // Setting a material gives the visual its own.
+  sdf::Material material;
+  material.SetDiffuse(ignition::math::Color(1, 0, 0, 1));
+  copy.SetMaterial(material);
+  EXPECT_EQ(0u, copy.MaterialId());
+  EXPECT_NE(v1->Material(), copy.Material());
+}
@@ -15,16 +15,34 @@
  *
  */
 
+#include <array>
+#include <cmath>
+#include <cstdint>
 #include <iostream>
+#include <sstream>
 #include <string>
+#include <vector>
 #include <gtest/gtest.h>
 
 #include "sdf/SDFImpl.hh"
 #include "sdf/parser.hh"
+#include "sdf/CollisionFilter.hh"
 #include "sdf/Frame.hh"
+#include "sdf/Geometry.hh"
+#include "sdf/Light.hh"
+#include "sdf/LightCulling.hh"
+#include "sdf/Link.hh"
 #include "sdf/Model.hh"
+#include "sdf/ParserConfig.hh"
+#include "sdf/Physics.hh"
+#include "sdf/RenderBatches.hh"
 #include "sdf/Root.hh"
+#include "sdf/Sensor.hh"
+#include "sdf/SensorSchedule.hh"
+#include "sdf/Surface.hh"
+#include "sdf/SurfaceMaterials.hh"
 #include "sdf/World.hh"
+#include "sdf/WorldPoses.hh"
 #include "sdf/Filesystem.hh"
 #include "test_config.h"
 
@@ -146,6 +164,70 @@ TEST(DOMWorld, Load)
   EXPECT_TRUE(world->FrameByName("frame1")->PoseRelativeTo().empty());
 }
 
+/////////////////////////////////////////////////
+TEST(DOMWorld, PhysicsProfile)
+{
+  const std::string sdfString = R"(
+<sdf version="1.8">
+  <world name="default">
+    <physics name="slow" type="ode">
+      <max_step_size>0.0001</max_step_size>
+    </physics>
+    <physics name="fast" type="ode" default="true">
+      <max_step_size>0.01</max_step_size>
+    </physics>
+    <physics name="medium" type="ode">
+      <max_step_size>0.001</max_step_size>
+    </physics>
+  </world>
+</sdf>)";
+
+  // Every profile.
+  sdf::Root root;
+  EXPECT_TRUE(root.LoadSdfString(sdfString).empty());
+  const sdf::World *world = root.WorldByIndex(0);
+  EXPECT_EQ(3u, world->PhysicsCount());
+  ASSERT_NE(nullptr, world->PhysicsDefault());
+  EXPECT_EQ("fast", world->PhysicsDefault()->Name());
+
+  // The default profile.
+  sdf::ParserConfig config;
+  config.SetPhysicsProfile("__default__");
+  sdf::Root defaultRoot;
+  EXPECT_TRUE(defaultRoot.LoadSdfString(sdfString, config).empty());
+  world = defaultRoot.WorldByIndex(0);
+  ASSERT_EQ(1u, world->PhysicsCount());
+  EXPECT_EQ("fast", world->PhysicsDefault()->Name());
+  EXPECT_FALSE(world->PhysicsNameExists("slow"));
+
+  // The other profiles stay in the element tree.
+  std::size_t physicsElemCount = 0;
+  for (const sdf::ElementPtr &elem : world->Element()->Children("physics"))
+  {
+    EXPECT_NE(nullptr, elem);
+    ++physicsElemCount;
+  }
+  EXPECT_EQ(3u, physicsElemCount);
+
+  // A named profile, including for worlds loaded lazily.
+  config.SetPhysicsProfile("medium");
+  config.SetLazyDomLoading(true);
+  sdf::Root namedRoot;
+  EXPECT_TRUE(namedRoot.LoadSdfString(sdfString, config).empty());
+  world = namedRoot.WorldByIndex(0);
+  ASSERT_EQ(1u, world->PhysicsCount());
+  EXPECT_EQ("medium", world->PhysicsDefault()->Name());
+  EXPECT_DOUBLE_EQ(0.001, world->PhysicsDefault()->MaxStepSize());
+
+  // A missing profile.
+  config.SetPhysicsProfile("missing");
+  config.SetLazyDomLoading(false);
+  sdf::Root missingRoot;
+  sdf::Errors errors = missingRoot.LoadSdfString(sdfString, config);
+  ASSERT_FALSE(errors.empty());
+  EXPECT_EQ(sdf::ErrorCode::ELEMENT_MISSING, errors[0].Code());
+}
+
 /////////////////////////////////////////////////
 TEST(DOMWorld, LoadModelFrameSameName)
 {
@@ -220,3 +302,761 @@ TEST(DOMWorld, LoadModelFrameSameName)
       SemanticPose().Resolve(pose, "ground").empty());
   EXPECT_EQ(Pose(0, -2, 3, 0, 0, 0), pose);
 }
+
+/////////////////////////////////////////////////
+TEST(DOMWorld, ResolveFramePoses)
+{
+  const std::string testFile =
+    sdf::filesystem::append(PROJECT_SOURCE_PATH, "test", "sdf",
+        "world_model_frame_same_name.sdf");
+
+  // Load the SDF file
+  sdf::Root root;
+  EXPECT_TRUE(root.Load(testFile).empty());
+
+  using Pose = ignition::math::Pose3d;
+  const sdf::World *world = root.WorldByIndex(0);
+  ASSERT_NE(nullptr, world);
+
+  std::vector<Pose> poses;
+  EXPECT_TRUE(world->ResolveFramePoses(poses).empty());
+  ASSERT_EQ(4u, poses.size());
+  EXPECT_EQ(Pose::Zero, poses[0]);
+  EXPECT_EQ(Pose(1, 0, 0, 0, 0, 0), poses[1]);
+  EXPECT_EQ(Pose(0, 2, 0, 0, 0, 0), poses[2]);
+  EXPECT_EQ(Pose(0, 0, 3, 0, 0, 0), poses[3]);
+
+  EXPECT_TRUE(world->ResolveFramePoses(poses, "base").empty());
+  ASSERT_EQ(4u, poses.size());
+  EXPECT_EQ(Pose(-1, 0, 0, 0, 0, 0), poses[0]);
+  EXPECT_EQ(Pose::Zero, poses[1]);
+  EXPECT_EQ(Pose(-1, 2, 0, 0, 0, 0), poses[2]);
+  EXPECT_EQ(Pose(-1, 0, 3, 0, 0, 0), poses[3]);
+
+  EXPECT_FALSE(world->ResolveFramePoses(poses, "invalid").empty());
+
+  sdf::World emptyWorld;
+  EXPECT_FALSE(emptyWorld.ResolveFramePoses(poses).empty());
+}
+
+/////////////////////////////////////////////////
+TEST(DOMWorld, ResolveObjectPoses)
+{
+  const std::string sdfString = R"(
+<sdf version="1.8">
+  <world name="default">
+    <frame name="F"><pose>0 0 5 0 0 0</pose></frame>
+    <model name="arm">
+      <pose>1 0 0 0 0 0</pose>
+      <frame name="tool"><pose>0 3 0 0 0 0</pose></frame>
+      <link name="base"/>
+      <link name="upper">
+        <pose>0 0 1 0 0 0</pose>
+        <visual name="v">
+          <pose>0 0 0.5 0 0 0</pose>
+          <geometry><box><size>1 1 1</size></box></geometry>
+        </visual>
+        <collision name="c">
+          <pose relative_to="tool">0 0 0 0 0 0</pose>
+          <geometry><box><size>1 1 1</size></box></geometry>
+        </collision>
+        <sensor name="imu" type="imu">
+          <pose>0 0 0.1 0 0 0</pose>
+        </sensor>
+      </link>
+    </model>
+    <light name="sun" type="directional">
+      <pose relative_to="F">0 1 0 0 0 0</pose>
+    </light>
+  </world>
+</sdf>)";
+
+  sdf::Root root;
+  ASSERT_TRUE(root.LoadSdfString(sdfString).empty());
+  const sdf::World *world = root.WorldByIndex(0);
+  ASSERT_NE(nullptr, world);
+
+  sdf::WorldPoses poses;
+  EXPECT_TRUE(world->ResolveObjectPoses(poses).empty());
+  ASSERT_EQ(7u, poses.poses.size());
+  ASSERT_EQ(7u, poses.types.size());
+  ASSERT_EQ(7u, poses.names.size());
+  EXPECT_EQ(7u, poses.modelIndices.size());
+  EXPECT_EQ(7u, poses.linkIndices.size());
+  EXPECT_EQ(7u, poses.indices.size());
+
+  using Pose = ignition::math::Pose3d;
+  const std::vector<sdf::WorldPoseType> types = {
+    sdf::WorldPoseType::MODEL, sdf::WorldPoseType::LINK,
+    sdf::WorldPoseType::LINK, sdf::WorldPoseType::VISUAL,
+    sdf::WorldPoseType::COLLISION, sdf::WorldPoseType::SENSOR,
+    sdf::WorldPoseType::LIGHT};
+  const std::vector<std::string> names = {
+    "arm", "arm::base", "arm::upper", "arm::upper::v", "arm::upper::c",
+    "arm::upper::imu", "sun"};
+  EXPECT_EQ(types, poses.types);
+  EXPECT_EQ(names, poses.names);
+  EXPECT_EQ(Pose(1, 0, 0, 0, 0, 0), poses.poses[0]);
+  EXPECT_EQ(Pose(1, 0, 0, 0, 0, 0), poses.poses[1]);
+  EXPECT_EQ(Pose(1, 0, 1, 0, 0, 0), poses.poses[2]);
+  EXPECT_EQ(Pose(1, 0, 1.5, 0, 0, 0), poses.poses[3]);
+  EXPECT_EQ(Pose(1, 3, 0, 0, 0, 0), poses.poses[4]);
+  EXPECT_EQ(Pose(0, 1, 5, 0, 0, 0), poses.poses[6]);
+  EXPECT_EQ(1, poses.linkIndices[4]);
+  EXPECT_EQ(0, poses.modelIndices[4]);
+  EXPECT_EQ(-1, poses.modelIndices[6]);
+
+  // The poses are those of the SemanticPose of each object.
+  Pose pose;
+  const sdf::Sensor *imu =
+      world->ModelByIndex(0)->LinkByIndex(1)->SensorByIndex(0);
+  EXPECT_TRUE(imu->SemanticPose().Resolve(pose, "world").empty());
+  EXPECT_EQ(pose, poses.poses[5]);
+  EXPECT_TRUE(world->LightByIndex(0)->SemanticPose().Resolve(
+      pose, "world").empty());
+  EXPECT_EQ(pose, poses.poses[6]);
+
+  sdf::World emptyWorld;
+  EXPECT_FALSE(emptyWorld.ResolveObjectPoses(poses).empty());
+  EXPECT_EQ(7u, poses.poses.size());
+}
+
+/////////////////////////////////////////////////
+TEST(DOMWorld, UpdateFramePose)
+{
+  const std::string testFile =
+    sdf::filesystem::append(PROJECT_SOURCE_PATH, "test", "sdf",
+        "world_model_frame_same_name.sdf");
+
+  // Load the SDF file
+  sdf::Root root;
+  EXPECT_TRUE(root.Load(testFile).empty());
+  ASSERT_NE(nullptr, root.WorldByIndex(0));
+  sdf::World world = *root.WorldByIndex(0);
+
+  using Pose = ignition::math::Pose3d;
+  Pose pose;
+  EXPECT_TRUE(world.ModelByName("ground")->SemanticPose().Resolve(
+      pose, "base").empty());
+  EXPECT_EQ(Pose(-1, 2, 0, 0, 0, 0), pose);
+
+  // Place the ground model relative to the base model.
+  EXPECT_TRUE(
+      world.UpdateFramePose("ground", Pose(0, 1, 0, 0, 0, 0), "base").empty());
+  EXPECT_EQ("base", world.ModelByName("ground")->PoseRelativeTo());
+  EXPECT_TRUE(world.ModelByName("ground")->SemanticPose().Resolve(
+      pose, "world").empty());
+  EXPECT_EQ(Pose(1, 1, 0, 0, 0, 0), pose);
+
+  // Moving the base model moves the ground model with it.
+  EXPECT_TRUE(world.UpdateFramePose("base", Pose(3, 0, 0, 0, 0, 0)).empty());
+  std::vector<Pose> poses;
+  EXPECT_TRUE(world.ResolveFramePoses(poses).empty());
+  ASSERT_EQ(4u, poses.size());
+  EXPECT_EQ(Pose(3, 0, 0, 0, 0, 0), poses[1]);
+  EXPECT_EQ(Pose(3, 1, 0, 0, 0, 0), poses[2]);
+  EXPECT_EQ(Pose(0, 0, 3, 0, 0, 0), poses[3]);
+
+  // Cycles are rejected.
+  auto errors = world.UpdateFramePose("base", Pose::Zero, "ground");
+  ASSERT_EQ(1u, errors.size());
+  EXPECT_EQ(sdf::ErrorCode::POSE_RELATIVE_TO_CYCLE, errors[0].Code());
+  EXPECT_EQ(Pose(3, 0, 0, 0, 0, 0), world.ModelByName("base")->RawPose());
+}
+
+/////////////////////////////////////////////////
+TEST(DOMWorld, ModelsInRegion)
+{
+  const std::string sdfString = R"(
+<sdf version="1.8">
+  <world name="default">
+    <model name="ground">
+      <static>true</static>
+      <link name="link">
+        <collision name="plane">
+          <geometry><plane><normal>0 0 1</normal></plane></geometry>
+        </collision>
+      </link>
+    </model>
+    <model name="box">
+      <pose>10 0 0 0 0 0</pose>
+      <link name="link">
+        <pose>0 0 1 0 0 0</pose>
+        <collision name="collision">
+          <geometry><box><size>4 2 2</size></box></geometry>
+        </collision>
+      </link>
+    </model>
+    <model name="marker">
+      <pose relative_to="box">0 5 0 0 0 0</pose>
+      <link name="link"/>
+    </model>
+  </world>
+</sdf>)";
+
+  sdf::Root root;
+  ASSERT_TRUE(root.LoadSdfString(sdfString).empty());
+  sdf::World world = *root.WorldByIndex(0);
+
+  using Vector3 = ignition::math::Vector3d;
+  auto names = [](const std::vector<const sdf::Model *> &_models)
+  {
+    std::vector<std::string> result;
+    for (const sdf::Model *model : _models)
+      result.push_back(model->Name());
+    return result;
+  };
+
+  // By origin.
+  EXPECT_EQ(std::vector<std::string>({"box"}),
+      names(world.ModelsInBox(Vector3(9, -1, -1), Vector3(11, 1, 1))));
+  EXPECT_EQ(std::vector<std::string>({"ground", "box"}),
+      names(world.ModelsNear(Vector3(5, 0, 0), 5)));
+  EXPECT_EQ(std::vector<std::string>({"marker"}),
+      names(world.ModelsNear(Vector3(10, 5, 0), 1)));
+  EXPECT_TRUE(world.ModelsInBox(Vector3(11.5, -1, -1), Vector3(12, 1, 1))
+      .empty());
+
+  // By collision bounds. The box spans 8 to 12 along x and 0 to 2 along z,
+  // and the ground plane is in every region.
+  const auto collision = sdf::ModelBoundsType::COLLISION;
+  EXPECT_EQ(std::vector<std::string>({"ground", "box"}),
+      names(world.ModelsInBox(Vector3(11.5, -1, -1), Vector3(12, 1, 1),
+          collision)));
+  EXPECT_EQ(std::vector<std::string>({"ground"}),
+      names(world.ModelsInBox(Vector3(10, 0, 2.5), Vector3(10, 0, 3),
+          collision)));
+  EXPECT_EQ(std::vector<std::string>({"ground", "box", "marker"}),
+      names(world.ModelsNear(Vector3(10, 3, 1), 2.5, collision)));
+
+  // Moving a model updates the index, along with the models placed
+  // relative to it.
+  EXPECT_TRUE(
+      world.UpdateFramePose("box", ignition::math::Pose3d::Zero).empty());
+  EXPECT_EQ(std::vector<std::string>({"ground", "box"}),
+      names(world.ModelsNear(Vector3::Zero, 1)));
+  EXPECT_EQ(std::vector<std::string>({"marker"}),
+      names(world.ModelsInBox(Vector3(0, 5, 0), Vector3(0, 5, 0))));
+}
+
+/////////////////////////////////////////////////
+TEST(DOMWorld, LoadModelsOnThreads)
+{
+  // Models with errors and a duplicate name, whose errors must be reported
+  // in the same order for any number of threads.
+  std::ostringstream stream;
+  stream << "<sdf version='1.8'><world name='default'>";
+  for (int i = 0; i < 40; ++i)
+  {
+    const std::string name = "model" + std::to_string(i % 30);
+    stream << "<model name='" << name << "'>"
+           << "<frame name='F' attached_to='link'/>"
+           << "<link name='link'>"
+           << "<pose relative_to='" << (i % 7 == 0 ? "invalid" : "F")
+           << "'>" << i << " 0 0 0 0 0</pose>"
+           << "</link>"
+           << "</model>";
+  }
+  stream << "</world></sdf>";
+
+  sdf::Errors serialErrors;
+  std::vector<std::string> serialNames;
+  for (unsigned int threads : {1u, 4u, 0u})
+  {
+    sdf::ParserConfig config;
+    config.SetModelLoadThreadCount(threads);
+    sdf::Root root;
+    sdf::Errors errors = root.LoadSdfString(stream.str(), config);
+    EXPECT_FALSE(errors.empty());
+
+    std::vector<std::string> names;
+    for (uint64_t w = 0; w < root.WorldCount(); ++w)
+    {
+      const sdf::World *world = root.WorldByIndex(w);
+      for (uint64_t m = 0; m < world->ModelCount(); ++m)
+      {
+        names.push_back(world->ModelByIndex(m)->Name());
+      }
+    }
+
+    if (threads == 1u)
+    {
+      serialErrors = errors;
+      serialNames = names;
+      continue;
+    }
+
+    ASSERT_EQ(serialErrors.size(), errors.size()) << threads;
+    for (std::size_t i = 0; i < errors.size(); ++i)
+    {
+      EXPECT_EQ(serialErrors[i].Code(), errors[i].Code());
+      EXPECT_EQ(serialErrors[i].Message(), errors[i].Message());
+    }
+    EXPECT_EQ(serialNames, names);
+  }
+}
+
+/////////////////////////////////////////////////
+TEST(DOMWorld, LoadLinksOnThreads)
+{
+  // A single model, whose links are loaded on several threads, with links
+  // that have errors and a duplicate name.
+  std::ostringstream stream;
+  stream << "<sdf version='1.8'><world name='default'><model name='M'>";
+  for (int i = 0; i < 40; ++i)
+  {
+    stream << "<link name='link" << (i % 30) << "'>"
+           << "<pose relative_to='" << (i % 7 == 0 ? "invalid" : "__model__")
+           << "'>" << i << " 0 0 0 0 0</pose>"
+           << "<visual name='V'><geometry><box/></geometry></visual>"
+           << "</link>";
+  }
+  stream << "</model></world></sdf>";
+
+  sdf::Errors serialErrors;
+  std::vector<std::string> serialNames;
+  for (unsigned int threads : {1u, 4u, 0u})
+  {
+    sdf::ParserConfig config;
+    config.SetModelLoadThreadCount(threads);
+    sdf::Root root;
+    sdf::Errors errors = root.LoadSdfString(stream.str(), config);
+    EXPECT_FALSE(errors.empty());
+
+    ASSERT_EQ(1u, root.WorldCount());
+    const sdf::Model *model = root.WorldByIndex(0)->ModelByIndex(0);
+    ASSERT_NE(nullptr, model);
+    std::vector<std::string> names;
+    for (uint64_t l = 0; l < model->LinkCount(); ++l)
+    {
+      names.push_back(model->LinkByIndex(l)->Name());
+      EXPECT_EQ(model->LinkByIndex(l),
+          model->LinkByName(model->LinkByIndex(l)->Name()));
+    }
+
+    if (threads == 1u)
+    {
+      EXPECT_EQ(30u, names.size());
+      serialErrors = errors;
+      serialNames = names;
+      continue;
+    }
+
+    ASSERT_EQ(serialErrors.size(), errors.size()) << threads;
+    for (std::size_t i = 0; i < errors.size(); ++i)
+    {
+      EXPECT_EQ(serialErrors[i].Code(), errors[i].Code());
+      EXPECT_EQ(serialErrors[i].Message(), errors[i].Message());
+    }
+    EXPECT_EQ(serialNames, names);
+  }
+}
+
+/////////////////////////////////////////////////
+TEST(DOMWorld, MaxErrors)
+{
+  // Every model has an error.
+  std::ostringstream stream;
+  stream << "<sdf version='1.8'><world name='default'>";
+  for (int i = 0; i < 100; ++i)
+  {
+    stream << "<model name='model" << i << "'>"
+           << "<link name='link'>"
+           << "<pose relative_to='invalid'/>"
+           << "</link>"
+           << "</model>";
+  }
+  stream << "</world></sdf>";
+
+  sdf::Root allRoot;
+  const sdf::Errors allErrors = allRoot.LoadSdfString(stream.str());
+  ASSERT_LT(5u, allErrors.size());
+
+  // Loading stops at the limit, and the errors of the first models are
+  // reported.
+  for (unsigned int threads : {1u, 4u})
+  {
+    sdf::ParserConfig config;
+    config.SetModelLoadThreadCount(threads);
+    config.SetMaxErrors(5);
+    sdf::Root root;
+    sdf::Errors errors = root.LoadSdfString(stream.str(), config);
+    ASSERT_FALSE(errors.empty());
+    EXPECT_GE(5u, errors.size());
+    EXPECT_EQ(allErrors[0].Message(), errors[0].Message());
+  }
+
+  // The callback gets the errors instead of the returned vector.
+  sdf::ParserConfig config;
+  std::vector<std::string> messages;
+  config.SetErrorCallback([&](const sdf::Error &_error)
+      {
+        messages.push_back(_error.Message());
+      });
+  sdf::Root root;
+  EXPECT_TRUE(root.LoadSdfString(stream.str(), config).empty());
+  ASSERT_EQ(allErrors.size(), messages.size());
+  for (std::size_t i = 0; i < messages.size(); ++i)
+  {
+    EXPECT_EQ(allErrors[i].Message(), messages[i]);
+  }
+}
+
+/////////////////////////////////////////////////
+TEST(DOMWorld, ResolveCollisionFilter)
+{
+  // Collisions of two models with the collide and category bitmasks:
+  // a 0x1/0x1, b 0x2/0x2, c 0x3/unset (0x3), d 0x4/0x1, e 0x1/0x1.
+  auto collision = [](const std::string &_name, const std::string &_collide,
+      const std::string &_category)
+  {
+    std::ostringstream out;
+    out << "<collision name='" << _name << "'>"
+        << "<geometry><sphere><radius>1</radius></sphere></geometry>"
+        << "<surface><contact><collide_bitmask>" << _collide
+        << "</collide_bitmask>";
+    if (!_category.empty())
+      out << "<category_bitmask>" << _category << "</category_bitmask>";
+    out << "</contact></surface></collision>";
+    return out.str();
+  };
+  std::ostringstream stream;
+  stream << "<sdf version='1.8'><world name='default'>"
+         << "<model name='m1'><link name='l1'>"
+         << collision("a", "1", "1") << collision("b", "2", "2")
+         << "</link><link name='l2'>" << collision("c", "3", "")
+         << "</link></model>"
+         << "<model name='m2'><link name='l'>"
+         << collision("d", "4", "1") << collision("e", "1", "1")
+         << "</link></model></world></sdf>";
+
+  sdf::Root root;
+  ASSERT_TRUE(root.LoadSdfString(stream.str()).empty());
+  const sdf::World *world = root.WorldByIndex(0);
+  ASSERT_NE(nullptr, world);
+
+  sdf::CollisionFilter filter;
+  world->ResolveCollisionFilter(filter);
+  ASSERT_EQ(5u, filter.groups.size());
+  EXPECT_EQ(std::vector<uint64_t>({0, 0, 0, 1, 1}), filter.modelIndices);
+  EXPECT_EQ(std::vector<uint64_t>({0, 0, 1, 0, 0}), filter.linkIndices);
+  EXPECT_EQ(std::vector<uint64_t>({0, 1, 0, 0, 1}),
+      filter.collisionIndices);
+
+  // a and e share a group.
+  ASSERT_EQ(4u, filter.categoryBitmasks.size());
+  EXPECT_EQ(filter.groups[0], filter.groups[4]);
+  EXPECT_EQ(3u, filter.categoryBitmasks[filter.groups[2]]);
+  EXPECT_EQ(1u, filter.WordsPerRow());
+  EXPECT_EQ(4u, filter.matrix.size());
+
+  EXPECT_TRUE(filter.Collide(0, 4));
+  EXPECT_FALSE(filter.Collide(0, 1));
+  EXPECT_TRUE(filter.Collide(0, 2));
+  EXPECT_TRUE(filter.Collide(1, 2));
+  // d collides with a through its category only.
+  EXPECT_TRUE(filter.Collide(0, 3));
+  EXPECT_TRUE(filter.Collide(3, 0));
+  EXPECT_FALSE(filter.Collide(1, 3));
+  EXPECT_FALSE(filter.Collide(3, 3));
+
+  // The filter of a model has the same groups for its own collisions.
+  sdf::CollisionFilter modelFilter;
+  world->ModelByIndex(0)->ResolveCollisionFilter(modelFilter);
+  EXPECT_EQ(std::vector<uint64_t>({0, 0, 0}), modelFilter.modelIndices);
+  EXPECT_EQ(3u, modelFilter.categoryBitmasks.size());
+  EXPECT_FALSE(modelFilter.Collide(0, 1));
+  EXPECT_TRUE(modelFilter.Collide(1, 2));
+
+  sdf::World emptyWorld;
+  emptyWorld.ResolveCollisionFilter(filter);
+  EXPECT_TRUE(filter.groups.empty());
+  EXPECT_TRUE(filter.matrix.empty());
+}
+
+/////////////////////////////////////////////////
+TEST(DOMWorld, ResolveSurfaceMaterials)
+{
+  auto collision = [](const std::string &_name, const std::string &_surface)
+  {
+    return "<collision name='" + _name + "'>"
+        "<geometry><sphere><radius>1</radius></sphere></geometry>" +
+        _surface + "</collision>";
+  };
+  const std::string ice = "<surface><friction><ode><mu>0.1</mu>"
+      "<mu2>0.05</mu2></ode></friction></surface>";
+  const std::string rubber = "<surface><friction><ode><mu>1.2</mu></ode>"
+      "<torsional><coefficient>0.5</coefficient>"
+      "<use_patch_radius>false</use_patch_radius>"
+      "<surface_radius>0.1</surface_radius></torsional></friction>"
+      "<bounce><restitution_coefficient>0.8</restitution_coefficient>"
+      "<threshold>0.01</threshold></bounce></surface>";
+  // Contact parameters do not make a material of their own.
+  const std::string filtered =
+      "<surface><contact><collide_bitmask>2</collide_bitmask></contact>"
+      "</surface>";
+  std::ostringstream stream;
+  stream << "<sdf version='1.8'><world name='default'>"
+         << "<model name='m1'><link name='l1'>"
+         << collision("a", ice) << collision("b", "")
+         << "</link><link name='l2'>" << collision("c", rubber)
+         << "</link></model>"
+         << "<model name='m2'><link name='l'>"
+         << collision("d", filtered) << collision("e", ice)
+         << "</link></model></world></sdf>";
+
+  sdf::Root root;
+  ASSERT_TRUE(root.LoadSdfString(stream.str()).empty());
+  const sdf::World *world = root.WorldByIndex(0);
+  ASSERT_NE(nullptr, world);
+
+  sdf::SurfaceMaterials materials;
+  world->ResolveSurfaceMaterials(materials);
+  EXPECT_EQ(std::vector<uint64_t>({0, 0, 0, 1, 1}), materials.modelIndices);
+  EXPECT_EQ(std::vector<uint64_t>({0, 0, 1, 0, 0}), materials.linkIndices);
+  EXPECT_EQ(std::vector<uint64_t>({0, 1, 0, 0, 1}),
+      materials.collisionIndices);
+  EXPECT_EQ(std::vector<uint32_t>({0, 1, 2, 1, 0}), materials.materials);
+
+  ASSERT_EQ(3u, materials.MaterialCount());
+  EXPECT_EQ(std::vector<double>({0.1, 1, 1.2}), materials.mu);
+  EXPECT_EQ(std::vector<double>({0.05, 1, 1}), materials.mu2);
+  EXPECT_EQ(std::vector<double>({1, 1, 0.5}),
+      materials.torsionalCoefficients);
+  EXPECT_EQ(std::vector<bool>({true, true, false}),
+      materials.usePatchRadius);
+  EXPECT_EQ(std::vector<double>({0, 0, 0.1}), materials.surfaceRadii);
+  EXPECT_EQ(std::vector<double>({0, 0, 0.8}),
+      materials.restitutionCoefficients);
+  EXPECT_EQ(std::vector<double>({100000, 100000, 0.01}),
+      materials.bounceThresholds);
+  EXPECT_EQ(3u, materials.fdir1.size());
+
+  // The materials of a model are those of its own collisions.
+  sdf::SurfaceMaterials modelMaterials;
+  world->ModelByIndex(1)->ResolveSurfaceMaterials(modelMaterials);
+  EXPECT_EQ(std::vector<uint64_t>({0, 0}), modelMaterials.modelIndices);
+  EXPECT_EQ(std::vector<uint32_t>({0, 1}), modelMaterials.materials);
+  EXPECT_EQ(std::vector<double>({1, 0.1}), modelMaterials.mu);
+
+  sdf::World emptyWorld;
+  emptyWorld.ResolveSurfaceMaterials(materials);
+  EXPECT_EQ(0u, materials.MaterialCount());
+  EXPECT_TRUE(materials.materials.empty());
+}
+
+/////////////////////////////////////////////////
+TEST(DOMWorld, ResolveSensorSchedule)
+{
+  auto sensor = [](const std::string &_name, const std::string &_rate)
+  {
+    std::ostringstream out;
+    out << "<sensor name='" << _name << "' type='altimeter'>";
+    if (!_rate.empty())
+      out << "<update_rate>" << _rate << "</update_rate>";
+    out << "</sensor>";
+    return out.str();
+  };
+  std::ostringstream stream;
+  stream << "<sdf version='1.8'><world name='default'>"
+         << "<model name='m1'><link name='l1'>"
+         << sensor("a", "30") << sensor("b", "")
+         << "</link><link name='l2'>" << sensor("c", "10")
+         << "</link></model>"
+         << "<model name='m2'><link name='l'>"
+         << sensor("d", "30") << sensor("e", "-1")
+         << "</link></model></world></sdf>";
+
+  sdf::Root root;
+  ASSERT_TRUE(root.LoadSdfString(stream.str()).empty());
+  const sdf::World *world = root.WorldByIndex(0);
+  ASSERT_NE(nullptr, world);
+
+  sdf::SensorSchedule schedule;
+  world->ResolveSensorSchedule(schedule);
+  ASSERT_EQ(3u, schedule.GroupCount());
+  EXPECT_EQ(std::vector<double>({0, 10, 30}), schedule.rates);
+  EXPECT_EQ(std::vector<std::size_t>({0, 2, 3, 5}), schedule.groupOffsets);
+
+  // b, e, then c, then a, d.
+  EXPECT_EQ(std::vector<uint64_t>({0, 1, 0, 0, 1}), schedule.modelIndices);
+  EXPECT_EQ(std::vector<uint64_t>({0, 0, 1, 0, 0}), schedule.linkIndices);
+  EXPECT_EQ(std::vector<uint64_t>({1, 1, 0, 0, 0}), schedule.sensorIndices);
+  EXPECT_EQ(3u, schedule.GroupBegin(2));
+  EXPECT_EQ(5u, schedule.GroupEnd(2));
+
+  // With 1 ms steps, the 10 Hz group is due every 100 steps.
+  EXPECT_TRUE(schedule.GroupDue(0, 0.001, 0.002));
+  EXPECT_FALSE(schedule.GroupDue(1, 0.001, 0.002));
+  EXPECT_TRUE(schedule.GroupDue(1, 0.0995, 0.1005));
+  EXPECT_TRUE(schedule.GroupDue(2, 0.033, 0.034));
+
+  sdf::World emptyWorld;
+  emptyWorld.ResolveSensorSchedule(schedule);
+  EXPECT_EQ(0u, schedule.GroupCount());
+  EXPECT_EQ(std::vector<std::size_t>({0}), schedule.groupOffsets);
+}
+
+/////////////////////////////////////////////////
+TEST(DOMWorld, ResolveRenderBatches)
+{
+  auto visual = [](const std::string &_name, const std::string &_geometry,
+      const std::string &_extra)
+  {
+    return "<visual name='" + _name + "'>" + _extra + "<geometry>" +
+        _geometry + "</geometry></visual>";
+  };
+  const std::string box = "<box><size>1 1 1</size></box>";
+  const std::string red =
+      "<material><diffuse>1 0 0 1</diffuse></material>";
+  std::ostringstream stream;
+  stream << "<sdf version='1.8'><world name='default'>"
+         << "<model name='m1'><pose>1 0 0 0 0 0</pose><link name='l1'>"
+         << visual("a", box, red + "<pose>0 0 1 0 0 0</pose>")
+         << visual("b", "<sphere><radius>0.5</radius></sphere>", "")
+         << visual("c", box, red + "<cast_shadows>false</cast_shadows>")
+         << "</link><link name='l2'><pose>0 2 0 0 0 0</pose>"
+         << visual("d", box, red + "<visibility_flags>2</visibility_flags>")
+         << "</link></model>"
+         << "<model name='m2'><pose>5 0 0 0 0 0</pose><link name='l'>"
+         << visual("e", box, red) << visual("f", "<empty/>", "")
+         << "</link></model></world></sdf>";
+
+  sdf::ParserConfig config;
+  config.SetShareMaterials(true);
+  sdf::Root root;
+  ASSERT_TRUE(root.LoadSdfString(stream.str(), config).empty());
+  const sdf::World *world = root.WorldByIndex(0);
+  ASSERT_NE(nullptr, world);
+
+  // a, d, e, then b, then c. f has no geometry.
+  sdf::RenderBatches batches;
+  ASSERT_TRUE(world->ResolveRenderBatches(batches).empty());
+  ASSERT_EQ(3u, batches.BatchCount());
+  EXPECT_EQ(std::vector<std::size_t>({0, 3, 4, 5}), batches.batchOffsets);
+  EXPECT_EQ(std::vector<uint64_t>({0, 0, 1, 0, 0}), batches.modelIndices);
+  EXPECT_EQ(std::vector<uint64_t>({0, 1, 0, 0, 0}), batches.linkIndices);
+  EXPECT_EQ(std::vector<uint64_t>({0, 0, 0, 1, 2}), batches.visualIndices);
+  EXPECT_EQ(sdf::GeometryType::BOX, batches.geometries[0]->Type());
+  EXPECT_EQ(sdf::GeometryType::SPHERE, batches.geometries[1]->Type());
+  EXPECT_NE(nullptr, batches.materials[0]);
+  EXPECT_EQ(nullptr, batches.materials[1]);
+  EXPECT_EQ(batches.materials[0], batches.materials[2]);
+  EXPECT_EQ(std::vector<bool>({true, true, false}), batches.castShadows);
+  EXPECT_EQ(ignition::math::Pose3d(1, 0, 1, 0, 0, 0), batches.poses[0]);
+  EXPECT_EQ(ignition::math::Pose3d(1, 2, 0, 0, 0, 0), batches.poses[1]);
+  EXPECT_EQ(ignition::math::Pose3d(5, 0, 0, 0, 0, 0), batches.poses[2]);
+  EXPECT_EQ(2u, batches.visibilityFlags[1]);
+  EXPECT_EQ(UINT32_MAX, batches.visibilityFlags[0]);
+
+  // The batches of a model have poses in the model frame.
+  const sdf::Model *model = world->ModelByIndex(0);
+  ASSERT_TRUE(model->ResolveRenderBatches(batches).empty());
+  EXPECT_EQ(std::vector<std::size_t>({0, 2, 3, 4}), batches.batchOffsets);
+  EXPECT_EQ(std::vector<uint64_t>({0, 0, 0, 0}), batches.modelIndices);
+  EXPECT_EQ(ignition::math::Pose3d(0, 0, 1, 0, 0, 0), batches.poses[0]);
+  EXPECT_EQ(ignition::math::Pose3d(0, 2, 0, 0, 0, 0), batches.poses[1]);
+
+  // Materials that are not shared are not batched.
+  sdf::Root unshared;
+  ASSERT_TRUE(unshared.LoadSdfString(stream.str()).empty());
+  ASSERT_TRUE(
+      unshared.WorldByIndex(0)->ResolveRenderBatches(batches).empty());
+  EXPECT_EQ(5u, batches.BatchCount());
+}
+
+/////////////////////////////////////////////////
+TEST(DOMWorld, ResolveLightCulling)
+{
+  const std::string sdfString = R"(
+<sdf version="1.8">
+  <world name="default">
+    <model name="lamp">
+      <pose>0.5 0.5 0.5 0 0 0</pose>
+      <link name="bulb">
+        <light name="bulb" type="point">
+          <attenuation><range>0.4</range></attenuation>
+        </light>
+      </link>
+    </model>
+    <light name="spot" type="spot">
+      <pose>10.5 0.5 10.5 0 0 0</pose>
+      <direction>0 0 -1</direction>
+      <attenuation><range>1</range></attenuation>
+      <spot>
+        <inner_angle>1</inner_angle>
+        <outer_angle>2</outer_angle>
+        <falloff>1</falloff>
+      </spot>
+    </light>
+    <light name="sun" type="directional"/>
+  </world>
+</sdf>)";
+
+  sdf::Root root;
+  ASSERT_TRUE(root.LoadSdfString(sdfString).empty());
+  const sdf::World *world = root.WorldByIndex(0);
+  ASSERT_NE(nullptr, world);
+
+  sdf::LightCulling culling;
+  ASSERT_TRUE(world->ResolveLightCulling(culling).empty());
+  ASSERT_EQ(3u, culling.LightCount());
+  EXPECT_EQ(std::vector<sdf::LightType>({sdf::LightType::POINT,
+      sdf::LightType::SPOT, sdf::LightType::DIRECTIONAL}), culling.types);
+  EXPECT_EQ(std::vector<int64_t>({0, -1, -1}), culling.modelIndices);
+  EXPECT_EQ(std::vector<int64_t>({0, -1, -1}), culling.linkIndices);
+  EXPECT_EQ(std::vector<uint64_t>({0, 0, 1}), culling.indices);
+  EXPECT_EQ(ignition::math::Pose3d(0.5, 0.5, 0.5, 0, 0, 0),
+      culling.poses[0]);
+
+  // The ranges are smaller than the attenuation distances.
+  EXPECT_DOUBLE_EQ(0.4, culling.radii[0]);
+  EXPECT_DOUBLE_EQ(1.0, culling.radii[1]);
+  EXPECT_TRUE(std::isinf(culling.radii[2]));
+  EXPECT_EQ(ignition::math::Vector3d(0.5, 0.5, 0.5),
+      culling.boundCenters[0]);
+  EXPECT_DOUBLE_EQ(0.4, culling.boundRadii[0]);
+
+  // The cone of the spot light is wider than 90 degrees, so its bounds
+  // are the sphere around the rim of its cap.
+  EXPECT_EQ(ignition::math::Vector3d(0, 0, -1), culling.directions[1]);
+  EXPECT_DOUBLE_EQ(std::cos(0.5), culling.spotCosInner[1]);
+  EXPECT_DOUBLE_EQ(std::cos(1.0), culling.spotCosOuter[1]);
+  EXPECT_DOUBLE_EQ(std::sin(1.0), culling.boundRadii[1]);
+  EXPECT_DOUBLE_EQ(10.5 - std::cos(1.0), culling.boundCenters[1].Z());
+  EXPECT_DOUBLE_EQ(-1.0, culling.spotCosOuter[0]);
+
+  EXPECT_EQ(0u, culling.CellCount());
+  EXPECT_EQ(std::vector<std::size_t>({0}), culling.cellOffsets);
+
+  // The point light is in one cell, the spot light in 3 x 3 x 2 cells and
+  // the directional light in none.
+  ASSERT_TRUE(world->ResolveLightCulling(culling, 1.0).empty());
+  EXPECT_DOUBLE_EQ(1.0, culling.cellSize);
+  ASSERT_EQ(19u, culling.CellCount());
+  EXPECT_EQ(19u, culling.cellLights.size());
+  EXPECT_EQ((std::array<int32_t, 3>{0, 0, 0}), culling.cells[0]);
+  EXPECT_EQ(0u, culling.CellBegin(0));
+  EXPECT_EQ(1u, culling.CellEnd(0));
+  EXPECT_EQ(0u, culling.cellLights[0]);
+  for (std::size_t c = 1; c < culling.CellCount(); ++c)
+  {
+    ASSERT_EQ(1u, culling.CellEnd(c) - culling.CellBegin(c));
+    EXPECT_EQ(1u, culling.cellLights[culling.CellBegin(c)]);
+  }
+
+  // The lights of a root are in the world frame.
+  sdf::Root lights;
+  ASSERT_TRUE(lights.LoadSdfString(
+      "<sdf version='1.8'><light name='l' type='point'>"
+      "<pose>1 2 3 0 0 0</pose></light></sdf>").empty());
+  lights.ResolveLightCulling(culling);
+  ASSERT_EQ(1u, culling.LightCount());
+  EXPECT_EQ(ignition::math::Pose3d(1, 2, 3, 0, 0, 0), culling.poses[0]);
+  EXPECT_DOUBLE_EQ(10.0, culling.radii[0]);
+  EXPECT_EQ(-1, culling.modelIndices[0]);
+
+  sdf::World emptyWorld;
+  EXPECT_FALSE(emptyWorld.ResolveLightCulling(culling).empty());
+  EXPECT_EQ(1u, culling.LightCount());
+}
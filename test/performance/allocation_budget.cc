@@ -0,0 +1,245 @@
+/*
+ * Copyright 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <new>
+#include <sstream>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "sdf/sdf.hh"
+
+#include "test_config.h"
+
+// The allocations of the whole process, including those of the library,
+// are counted by replacing the global allocation functions. The other
+// forms of operator new and delete call these ones by default.
+
+/// \brief True while allocations are counted.
+static std::atomic<bool> g_counting{false};
+
+/// \brief Number of allocations counted.
+static std::atomic<uint64_t> g_allocations{0};
+
+/// \brief Number of bytes allocated while counting.
+static std::atomic<uint64_t> g_bytes{0};
+
+/////////////////////////////////////////////////
+void *operator new(std::size_t _size)
+{
+  if (g_counting.load(std::memory_order_relaxed))
+  {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    g_bytes.fetch_add(_size, std::memory_order_relaxed);
+  }
+  void *ptr = std::malloc(_size == 0 ? 1 : _size);
+  if (!ptr)
+    throw std::bad_alloc();
+  return ptr;
+}
+
+/////////////////////////////////////////////////
+void operator delete(void *_ptr) noexcept
+{
+  std::free(_ptr);
+}
+
+/////////////////////////////////////////////////
+void operator delete(void *_ptr, std::size_t) noexcept
+{
+  std::free(_ptr);
+}
+
+/// \brief Allocations of a stage.
+struct AllocationCount
+{
+  /// \brief Number of allocations.
+  uint64_t allocations = 0;
+
+  /// \brief Number of bytes allocated.
+  uint64_t bytes = 0;
+};
+
+/// \brief Counts the allocations made during its lifetime.
+class ScopedAllocationCount
+{
+  /// \brief Constructor.
+  /// \param[out] _count Set to the allocations when this object is
+  /// destroyed.
+  public: explicit ScopedAllocationCount(AllocationCount &_count)
+    : count(_count)
+  {
+    g_allocations = 0;
+    g_bytes = 0;
+    g_counting = true;
+  }
+
+  /// \brief Destructor.
+  public: ~ScopedAllocationCount()
+  {
+    g_counting = false;
+    this->count.allocations = g_allocations;
+    this->count.bytes = g_bytes;
+  }
+
+  /// \brief The allocations.
+  private: AllocationCount &count;
+};
+
+/////////////////////////////////////////////////
+/// \brief Read the budgets of the stages. Each line of the file has the
+/// name of a stage followed by its maximum number of allocations and
+/// bytes. Empty lines and lines that start with # are ignored.
+/// \return The budget of each stage.
+std::map<std::string, AllocationCount> budgets()
+{
+  std::string path = sdf::filesystem::append(PROJECT_SOURCE_PATH, "test",
+      "performance", "allocation_budgets.txt");
+  if (const char *budgetPath = std::getenv("SDF_ALLOCATION_BUDGETS"))
+    path = budgetPath;
+
+  std::map<std::string, AllocationCount> result;
+  std::ifstream file(path);
+  EXPECT_TRUE(file.is_open()) << path;
+  std::string line;
+  while (std::getline(file, line))
+  {
+    if (line.empty() || line[0] == '#')
+      continue;
+    std::istringstream stream(line);
+    std::string stage;
+    AllocationCount budget;
+    if (stream >> stage >> budget.allocations >> budget.bytes)
+      result[stage] = budget;
+  }
+  return result;
+}
+
+/////////////////////////////////////////////////
+/// \brief Check the allocations of a stage against its budget.
+/// \param[in] _stage Name of the stage.
+/// \param[in] _count The allocations of the stage.
+void checkBudget(const std::string &_stage, const AllocationCount &_count)
+{
+  std::cout << "Stage[" << _stage << "] allocations[" << _count.allocations
+            << "] bytes[" << _count.bytes << "]" << std::endl;
+  ::testing::Test::RecordProperty(_stage + "_allocations",
+      std::to_string(_count.allocations));
+  ::testing::Test::RecordProperty(_stage + "_bytes",
+      std::to_string(_count.bytes));
+
+  static const std::map<std::string, AllocationCount> kBudgets = budgets();
+  auto budget = kBudgets.find(_stage);
+  ASSERT_NE(kBudgets.end(), budget)
+      << "No budget for stage[" << _stage << "]";
+  EXPECT_LE(_count.allocations, budget->second.allocations)
+      << "Stage[" << _stage << "] exceeds its allocation budget.";
+  EXPECT_LE(_count.bytes, budget->second.bytes)
+      << "Stage[" << _stage << "] exceeds its byte budget.";
+}
+
+/////////////////////////////////////////////////
+/// \brief Generate a world with many models.
+/// \param[in] _modelCount Number of models in the world.
+/// \return The SDF string of the world.
+std::string syntheticWorld(int _modelCount)
+{
+  std::ostringstream stream;
+  stream << "<sdf version='" << SDF_VERSION << "'>"
+         << "<world name='default'>";
+  for (int i = 0; i < _modelCount; ++i)
+  {
+    stream << "<model name='model" << i << "'>"
+           << "<pose>" << i << " 0 0 0 0 0</pose>"
+           << "<link name='link'>"
+           << "<inertial><mass>1</mass></inertial>"
+           << "<collision name='collision'>"
+           << "<geometry><box><size>1 1 1</size></box></geometry>"
+           << "</collision>"
+           << "<visual name='visual'>"
+           << "<geometry><box><size>1 1 1</size></box></geometry>"
+           << "</visual>"
+           << "</link>"
+           << "</model>";
+  }
+  stream << "</world></sdf>";
+  return stream.str();
+}
+
+/////////////////////////////////////////////////
+TEST(AllocationBudget, Init)
+{
+  AllocationCount count;
+  {
+    sdf::SDFPtr sdfParsed(new sdf::SDF());
+    ScopedAllocationCount scope(count);
+    EXPECT_TRUE(sdf::init(sdfParsed));
+  }
+  checkBudget("init", count);
+}
+
+/////////////////////////////////////////////////
+TEST(AllocationBudget, ReadFileAtlas)
+{
+  const std::string filename = sdf::filesystem::append(PROJECT_SOURCE_PATH,
+      "test", "performance", "parser_urdf_atlas.urdf");
+
+  // The first read fills the caches of the library, such as the parsed
+  // description of the specification, so that the measured read is that
+  // of an application that already loaded a file.
+  EXPECT_NE(nullptr, sdf::readFile(filename));
+
+  AllocationCount count;
+  {
+    ScopedAllocationCount scope(count);
+    sdf::SDFPtr sdfParsed = sdf::readFile(filename);
+    EXPECT_NE(nullptr, sdfParsed);
+  }
+  checkBudget("read_file_atlas", count);
+}
+
+/////////////////////////////////////////////////
+TEST(AllocationBudget, SyntheticWorld)
+{
+  const int modelCount = 1000;
+  const std::string world = syntheticWorld(modelCount);
+
+  sdf::SDFPtr sdfParsed(new sdf::SDF());
+  sdf::init(sdfParsed);
+
+  AllocationCount readCount;
+  {
+    ScopedAllocationCount scope(readCount);
+    EXPECT_TRUE(sdf::readString(world, sdfParsed));
+  }
+  checkBudget("read_string_world", readCount);
+
+  AllocationCount loadCount;
+  {
+    sdf::Root root;
+    ScopedAllocationCount scope(loadCount);
+    EXPECT_TRUE(root.Load(sdfParsed).empty());
+    EXPECT_EQ(1u, root.WorldCount());
+  }
+  checkBudget("root_load_world", loadCount);
+}
@@ -0,0 +1,123 @@
+/*
+ * Copyright 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "sdf/Frame.hh"
+#include "sdf/Model.hh"
+#include "sdf/ParserConfig.hh"
+#include "sdf/Root.hh"
+#include "sdf/SemanticPose.hh"
+#include "sdf/sdf_config.h"
+
+/////////////////////////////////////////////////
+/// \brief Generate a document with many top level models.
+/// \param[in] _modelCount Number of models.
+/// \return The SDF string.
+std::string modelsString(int _modelCount)
+{
+  std::ostringstream stream;
+  stream << "<sdf version='" << SDF_VERSION << "'>";
+  for (int i = 0; i < _modelCount; ++i)
+  {
+    stream << "<model name='model" << i << "'>"
+           << "<link name='base'><pose>" << i << " 0 0 0 0 0</pose></link>"
+           << "<link name='arm'>"
+           << "<pose relative_to='base'>0 1 0 0 0 0</pose>"
+           << "</link>"
+           << "<frame name='tip' attached_to='arm'/>"
+           << "</model>";
+  }
+  stream << "</sdf>";
+  return stream.str();
+}
+
+/////////////////////////////////////////////////
+/// \brief Get every model of a root and resolve the pose of a frame of
+/// each, starting from a given model.
+/// \param[in] _root The root.
+/// \param[in] _modelCount Number of models.
+/// \param[in] _first Index of the first model read.
+/// \return Number of reads that failed.
+int readModels(const sdf::Root &_root, int _modelCount, int _first)
+{
+  int failures = 0;
+  ignition::math::Pose3d pose;
+  for (int i = 0; i < _modelCount; ++i)
+  {
+    const sdf::Model *model = _root.ModelByIndex((_first + i) % _modelCount);
+    const sdf::Frame *tip = model ? model->FrameByName("tip") : nullptr;
+    if (!tip || !tip->SemanticPose().Resolve(pose, "base").empty())
+      ++failures;
+  }
+  return failures;
+}
+
+/////////////////////////////////////////////////
+/// Read a lazily loaded root from one thread, then from one thread per
+/// hardware thread, and print the throughput of each. The reads of the
+/// second pass find the models generated, so they take no lock.
+TEST(ConcurrentRead, ReadLazyRoot5000Models_performance)
+{
+  const int modelCount = 5000;
+  const int passes = 4;
+  sdf::ParserConfig config;
+  config.SetLazyDomLoading(true);
+  sdf::Root root;
+  ASSERT_TRUE(root.LoadSdfString(modelsString(modelCount), config).empty());
+
+  // The first pass generates the models from several threads.
+  const int threadCount =
+      std::max(2, static_cast<int>(std::thread::hardware_concurrency()));
+  std::atomic<int> failures{0};
+  auto readAll = [&](int _threads)
+  {
+    std::vector<std::thread> threads;
+    const auto start = std::chrono::steady_clock::now();
+    for (int t = 0; t < _threads; ++t)
+    {
+      threads.emplace_back([&, t]()
+      {
+        for (int p = 0; p < passes; ++p)
+          failures += readModels(root, modelCount, t * modelCount / _threads);
+      });
+    }
+    for (auto &thread : threads)
+      thread.join();
+    const std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+    return _threads * passes * modelCount / elapsed.count();
+  };
+
+  readAll(threadCount);
+  EXPECT_EQ(0, failures);
+
+  const double single = readAll(1);
+  const double multi = readAll(threadCount);
+  EXPECT_EQ(0, failures);
+  std::cout << "Reads per second: " << single << " from 1 thread, "
+            << multi << " from " << threadCount << " threads\n";
+}
@@ -0,0 +1,110 @@
+/*
+ * Copyright 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include "world_generator.hh"
+
+/////////////////////////////////////////////////
+/// \brief Print the usage of the tool.
+/// \param[in] _name Name of the executable.
+void usage(const char *_name)
+{
+  std::cerr
+    << "Usage: " << _name << " [options]\n"
+    << "Print a generated SDF world, or URDF robot, to stdout.\n\n"
+    << "  --models N       Number of models of the world (1).\n"
+    << "  --links N        Number of links of each model (1).\n"
+    << "  --depth N        Number of levels of nested models (0).\n"
+    << "  --frames N       Length of the chain of frames of each model (0).\n"
+    << "  --includes N     Number of included models (0), written to\n"
+    << "                   the directory of --include-dir.\n"
+    << "  --include-dir P  Directory of the included models.\n"
+    << "  --urdf N         Print a URDF robot with N links instead.\n"
+    << "  --fixed          Attach the links of the URDF robot with fixed\n"
+    << "                   joints.\n";
+}
+
+/////////////////////////////////////////////////
+int main(int _argc, char **_argv)
+{
+  WorldGeneratorOptions options;
+  int urdfLinks = 0;
+  bool fixedJoints = false;
+
+  for (int i = 1; i < _argc; ++i)
+  {
+    const std::string arg = _argv[i];
+    if (arg == "--fixed")
+    {
+      fixedJoints = true;
+      continue;
+    }
+    if (i + 1 >= _argc)
+    {
+      usage(_argv[0]);
+      return 1;
+    }
+
+    const std::string value = _argv[++i];
+    if (arg == "--models")
+      options.modelCount = std::atoi(value.c_str());
+    else if (arg == "--links")
+      options.linksPerModel = std::atoi(value.c_str());
+    else if (arg == "--depth")
+      options.nestingDepth = std::atoi(value.c_str());
+    else if (arg == "--frames")
+      options.frameChainDepth = std::atoi(value.c_str());
+    else if (arg == "--includes")
+      options.includeFanout = std::atoi(value.c_str());
+    else if (arg == "--include-dir")
+      options.includeDirectory = value;
+    else if (arg == "--urdf")
+      urdfLinks = std::atoi(value.c_str());
+    else
+    {
+      usage(_argv[0]);
+      return 1;
+    }
+  }
+
+  if (urdfLinks > 0)
+  {
+    std::cout << generateUrdf(urdfLinks, fixedJoints) << std::endl;
+    return 0;
+  }
+
+  if (options.includeFanout > 0)
+  {
+    if (options.includeDirectory.empty())
+    {
+      std::cerr << "--includes requires --include-dir.\n";
+      return 1;
+    }
+    if (!writeIncludeModels(options))
+    {
+      std::cerr << "Unable to write the included models to ["
+                << options.includeDirectory << "].\n";
+      return 1;
+    }
+  }
+
+  std::cout << generateWorld(options) << std::endl;
+  return 0;
+}
@@ -0,0 +1,163 @@
+/*
+ * Copyright 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "sdf/sdf.hh"
+
+/// \brief Number of times each lookup is repeated.
+static const int iterations = 200;
+
+/////////////////////////////////////////////////
+/// \brief Generate a world with many models.
+/// \param[in] _modelCount Number of models in the world.
+/// \return The SDF string of the world.
+std::string modelWorld(int _modelCount)
+{
+  std::ostringstream stream;
+  stream << "<sdf version='" << SDF_VERSION << "'>"
+         << "<world name='default'>";
+  for (int i = 0; i < _modelCount; ++i)
+  {
+    stream << "<model name='model" << i << "'>"
+           << "<link name='link'>"
+           << "<visual name='visual'>"
+           << "<geometry><box><size>1 1 1</size></box></geometry>"
+           << "</visual>"
+           << "</link>"
+           << "</model>";
+  }
+  stream << "</world></sdf>";
+  return stream.str();
+}
+
+/////////////////////////////////////////////////
+/// \brief Call a function for an element and all its descendants.
+/// \param[in] _elem The element.
+/// \param[in] _func The function.
+void visit(const sdf::ElementPtr &_elem,
+    const std::function<void (const sdf::ElementPtr &)> &_func)
+{
+  _func(_elem);
+  for (auto child = _elem->GetFirstElement(); child;
+       child = child->GetNextElement())
+  {
+    visit(child, _func);
+  }
+}
+
+/////////////////////////////////////////////////
+/// \brief Get the heap memory used by a std::string copy of a string,
+/// which is none for strings that fit in the small string buffer.
+/// \param[in] _str The string.
+/// \return Number of bytes.
+std::size_t heapBytes(const std::string &_str)
+{
+  return _str.capacity() > std::string().capacity() ? _str.capacity() + 1 : 0;
+}
+
+/////////////////////////////////////////////////
+TEST(InternedString, Memory_performance)
+{
+  sdf::SDFPtr sdf(new sdf::SDF());
+  ASSERT_TRUE(sdf::init(sdf));
+  ASSERT_TRUE(sdf::readString(modelWorld(2000), sdf));
+
+  // Memory that the names, requirements, keys, type names and descriptions
+  // would use if every element and parameter held its own copies.
+  std::size_t stringCount = 0;
+  std::size_t copyBytes = 0;
+  auto countParam = [&](const sdf::ParamPtr &_param)
+  {
+    stringCount += 3;
+    copyBytes += 3 * sizeof(std::string) + heapBytes(_param->GetKey()) +
+        heapBytes(_param->GetTypeName()) +
+        heapBytes(_param->GetDescription());
+  };
+  visit(sdf->Root(), [&](const sdf::ElementPtr &_elem)
+  {
+    stringCount += 3;
+    copyBytes += 3 * sizeof(std::string) + heapBytes(_elem->GetName()) +
+        heapBytes(_elem->GetRequired()) + heapBytes(_elem->GetDescription());
+    for (std::size_t i = 0; i < _elem->GetAttributeCount(); ++i)
+      countParam(_elem->GetAttribute(i));
+    if (_elem->GetValue())
+      countParam(_elem->GetValue());
+  });
+
+  const std::size_t internedBytes = stringCount * sizeof(sdf::InternedString);
+  std::cout << stringCount << " strings: " << copyBytes
+            << " bytes as copies, " << internedBytes << " bytes interned plus "
+            << sdf::InternedString::TableBytes() << " bytes in a table of "
+            << sdf::InternedString::TableSize() << " strings\n";
+  EXPECT_LT(internedBytes, copyBytes);
+}
+
+/////////////////////////////////////////////////
+TEST(InternedString, Lookup_performance)
+{
+  // Names that share a long prefix, like the type names of Param, are the
+  // slowest to tell apart by string comparison.
+  const std::vector<std::string> vocabulary = {
+      "ignition::math::Vector2i", "ignition::math::Vector2d",
+      "ignition::math::Vector3d", "ignition::math::Pose3d",
+      "ignition::math::Quaterniond", "ignition::math::Color"};
+  std::vector<std::string> strings;
+  std::vector<sdf::InternedString> interned;
+  for (int i = 0; i < 10000; ++i)
+  {
+    // Copy each string, so that std::string comparisons can not
+    // short-circuit on equal data pointers.
+    strings.push_back(std::string(vocabulary[i % vocabulary.size()]));
+    interned.push_back(strings.back());
+  }
+  const std::string target = vocabulary.back();
+  const sdf::InternedString internedTarget(target);
+
+  std::size_t stringMatches = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < iterations; ++i)
+  {
+    for (const auto &str : strings)
+      stringMatches += (str == target);
+  }
+  const std::chrono::duration<double, std::milli> stringTime =
+      std::chrono::steady_clock::now() - start;
+
+  std::size_t internedMatches = 0;
+  start = std::chrono::steady_clock::now();
+  for (int i = 0; i < iterations; ++i)
+  {
+    for (const auto &str : interned)
+      internedMatches += (str == internedTarget);
+  }
+  const std::chrono::duration<double, std::milli> internedTime =
+      std::chrono::steady_clock::now() - start;
+
+  EXPECT_EQ(stringMatches, internedMatches);
+  std::cout << "std::string compare " << stringTime.count()
+            << " ms, InternedString compare " << internedTime.count()
+            << " ms\n";
+}
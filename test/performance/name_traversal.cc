@@ -0,0 +1,102 @@
+/*
+ * Copyright 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <chrono>
+#include <iostream>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "sdf/sdf.hh"
+
+#include "world_generator.hh"
+
+// Applications that bridge a loaded world to a simulator read the names of
+// every object, often in loops. This test compares traversals that read the
+// names by reference, as the getters return them, with traversals that copy
+// each name, as the getters used to.
+
+/////////////////////////////////////////////////
+/// \brief Read the names of the objects of a world.
+/// \param[in] _world The world.
+/// \param[in] _copy True to copy each name.
+/// \return Total length of the names.
+std::size_t traverseNames(const sdf::World &_world, bool _copy)
+{
+  std::size_t length = 0;
+  auto read = [&](const std::string &_name)
+  {
+    if (_copy)
+    {
+      std::string copy = _name;
+      length += copy.size();
+    }
+    else
+    {
+      length += _name.size();
+    }
+  };
+
+  read(_world.Name());
+  for (uint64_t m = 0; m < _world.ModelCount(); ++m)
+  {
+    const sdf::Model *model = _world.ModelByIndex(m);
+    read(model->Name());
+    for (uint64_t l = 0; l < model->LinkCount(); ++l)
+    {
+      const sdf::Link *link = model->LinkByIndex(l);
+      read(link->Name());
+      for (uint64_t v = 0; v < link->VisualCount(); ++v)
+        read(link->VisualByIndex(v)->Name());
+      for (uint64_t c = 0; c < link->CollisionCount(); ++c)
+        read(link->CollisionByIndex(c)->Name());
+    }
+  }
+  return length;
+}
+
+/////////////////////////////////////////////////
+TEST(NameTraversal, World_performance)
+{
+  WorldGeneratorOptions options;
+  options.modelCount = 1000;
+  options.linksPerModel = 10;
+
+  sdf::Root root;
+  ASSERT_TRUE(root.LoadSdfString(generateWorld(options)).empty());
+  ASSERT_EQ(1u, root.WorldCount());
+  const sdf::World *world = root.WorldByIndex(0);
+
+  const int repeat = 100;
+  std::size_t lengths[2] = {0, 0};
+  double durations[2] = {0, 0};
+  for (bool copy : {false, true})
+  {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < repeat; ++i)
+      lengths[copy] += traverseNames(*world, copy);
+    durations[copy] = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - start).count();
+  }
+  EXPECT_EQ(lengths[false], lengths[true]);
+
+  std::cout << "Traversals[" << repeat << "] by reference[" << durations[0]
+            << " ms] by copy[" << durations[1] << " ms]" << std::endl;
+  ::testing::Test::RecordProperty("reference_ms",
+      std::to_string(durations[0]));
+  ::testing::Test::RecordProperty("copy_ms", std::to_string(durations[1]));
+}
@@ -0,0 +1,126 @@
+/*
+ * Copyright 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <locale>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <ignition/math/Color.hh>
+#include <ignition/math/Pose3.hh>
+#include <ignition/math/Vector3.hh>
+
+#include "sdf/Param.hh"
+
+/// \brief Number of times each value is parsed.
+static const int iterations = 20000;
+
+/////////////////////////////////////////////////
+/// \brief Parse a value the way Param::ValueFromString used to, with a
+/// std::stringstream using the classic locale.
+template <typename T>
+bool parseWithStringStream(const std::string &_input, T &_value)
+{
+  std::stringstream ss(_input);
+  ss.imbue(std::locale::classic());
+  ss >> _value;
+  return !ss.fail();
+}
+
+/////////////////////////////////////////////////
+/// \brief Parse the given strings with Param::SetFromString and with a
+/// std::stringstream, check that both give the same values and print how
+/// long each took.
+template <typename T>
+void compareParsers(const std::string &_typeName,
+    const std::vector<std::string> &_inputs)
+{
+  sdf::Param param("key", _typeName, _inputs.front(), false);
+
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < iterations; ++i)
+  {
+    for (const auto &input : _inputs)
+      EXPECT_TRUE(param.SetFromString(input));
+  }
+  const std::chrono::duration<double, std::milli> paramTime =
+      std::chrono::steady_clock::now() - start;
+
+  start = std::chrono::steady_clock::now();
+  for (int i = 0; i < iterations; ++i)
+  {
+    for (const auto &input : _inputs)
+    {
+      T value;
+      EXPECT_TRUE(parseWithStringStream(input, value));
+    }
+  }
+  const std::chrono::duration<double, std::milli> streamTime =
+      std::chrono::steady_clock::now() - start;
+
+  for (const auto &input : _inputs)
+  {
+    T expected;
+    ASSERT_TRUE(parseWithStringStream(input, expected));
+    ASSERT_TRUE(param.SetFromString(input));
+    T value;
+    ASSERT_TRUE(param.Get(value));
+    EXPECT_EQ(expected, value) << input;
+  }
+
+  std::cout << _typeName << ": Param::SetFromString " << paramTime.count()
+            << " ms, std::stringstream " << streamTime.count() << " ms\n";
+}
+
+/////////////////////////////////////////////////
+TEST(ParamParse, Vector3d_performance)
+{
+  compareParsers<ignition::math::Vector3d>("vector3",
+      {"0 0 0", "1.5 -2.25 3e-3", "  0.123456789 1000000 -7  "});
+}
+
+/////////////////////////////////////////////////
+TEST(ParamParse, Pose3d_performance)
+{
+  compareParsers<ignition::math::Pose3d>("pose",
+      {"0 0 0 0 0 0", "1 2 3 0.1 0.2 0.3", "-0.5 +0.25 1e2 3.14 -1.57 0"});
+}
+
+/////////////////////////////////////////////////
+TEST(ParamParse, Color_performance)
+{
+  compareParsers<ignition::math::Color>("color",
+      {"0 0 0 1", "0.1 0.2 0.3 0.4", "1 0.5 0.25 1"});
+}
+
+/////////////////////////////////////////////////
+TEST(ParamParse, Time_performance)
+{
+  compareParsers<sdf::Time>("time", {"0 0", "10 500", "-3 999999999"});
+}
+
+/////////////////////////////////////////////////
+TEST(ParamParse, Uint64_performance)
+{
+  compareParsers<std::uint64_t>("uint64_t",
+      {"0", "42", "18446744073709551615"});
+}
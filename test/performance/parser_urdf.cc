@@ -15,7 +15,12 @@
  *
  */
 
+#include <algorithm>
+#include <chrono>
+#include <iostream>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include <gtest/gtest.h>
 
@@ -29,8 +34,75 @@ TEST(URDFParser, AtlasURDF_5runs_performance)
     URDF_TEST_FILE = sdf::filesystem::append(PROJECT_SOURCE_PATH, "test",
                                              "performance",
                                              "parser_urdf_atlas.urdf");
+  using Clock = std::chrono::steady_clock;
+  std::chrono::duration<double, std::milli> total(0);
+  std::chrono::duration<double, std::milli> fastest(0);
   for (int i = 0; i < 5; i++)
   {
+    const auto start = Clock::now();
     sdf::SDFPtr root = sdf::readFile(URDF_TEST_FILE);
+    const std::chrono::duration<double, std::milli> time =
+        Clock::now() - start;
+    ASSERT_NE(nullptr, root);
+
+    total += time;
+    if (i == 0 || time < fastest)
+      fastest = time;
   }
+
+  std::cout << "Converting the Atlas URDF took " << total.count() / 5
+            << " ms on average, " << fastest.count() << " ms at best\n";
+  ::testing::Test::RecordProperty("conversion_ms",
+      static_cast<int>(fastest.count()));
+}
+
+/////////////////////////////////////////////////
+TEST(URDFParser, AtlasURDF_parallel_performance)
+{
+  const std::string
+    URDF_TEST_FILE = sdf::filesystem::append(PROJECT_SOURCE_PATH, "test",
+                                             "performance",
+                                             "parser_urdf_atlas.urdf");
+  const int runs = 5;
+  const unsigned int threadCount =
+    std::max(2u, std::min(8u, std::thread::hardware_concurrency()));
+
+  using Clock = std::chrono::steady_clock;
+  auto start = Clock::now();
+  sdf::SDFPtr expected = sdf::readFile(URDF_TEST_FILE);
+  ASSERT_NE(nullptr, expected);
+  const std::string expectedStr = expected->Root()->ToString("");
+  const auto serialTime = Clock::now() - start;
+
+  // Each thread converts the robot several times, and every conversion
+  // must match the serial one.
+  std::vector<std::string> results(threadCount * runs);
+  std::vector<std::thread> threads;
+  start = Clock::now();
+  for (unsigned int t = 0; t < threadCount; ++t)
+  {
+    threads.emplace_back([&, t]()
+    {
+      for (int i = 0; i < runs; ++i)
+      {
+        sdf::SDFPtr sdf = sdf::readFile(URDF_TEST_FILE);
+        if (sdf)
+          results[t * runs + i] = sdf->Root()->ToString("");
+      }
+    });
+  }
+  for (auto &thread : threads)
+    thread.join();
+  const auto parallelTime = Clock::now() - start;
+
+  for (const auto &result : results)
+    EXPECT_EQ(expectedStr, result);
+
+  using std::chrono::duration_cast;
+  using std::chrono::milliseconds;
+  std::cout << threadCount * runs << " conversions on " << threadCount
+            << " threads took "
+            << duration_cast<milliseconds>(parallelTime).count()
+            << " ms, one conversion took "
+            << duration_cast<milliseconds>(serialTime).count() << " ms\n";
 }
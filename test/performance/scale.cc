@@ -0,0 +1,149 @@
+/*
+ * Copyright 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <iostream>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "sdf/sdf.hh"
+
+#include "test_config.h"
+#include "world_generator.hh"
+
+// Each test loads generated documents of growing size, from 10 times to
+// 10000 times the size of the test assets, so that costs that grow faster
+// than the documents show up as a test that times out.
+
+/////////////////////////////////////////////////
+/// \brief Load a generated world, and check that it loads without errors.
+/// \param[in] _options Parameters of the world.
+/// \param[out] _root The loaded world.
+void loadWorld(const WorldGeneratorOptions &_options, sdf::Root &_root)
+{
+  sdf::Errors errors = _root.LoadSdfString(generateWorld(_options));
+  for (const auto &error : errors)
+    std::cerr << error << std::endl;
+  EXPECT_TRUE(errors.empty());
+  ASSERT_EQ(1u, _root.WorldCount());
+}
+
+/////////////////////////////////////////////////
+TEST(Scale, Models_performance)
+{
+  for (int count : {10, 100, 1000, 10000})
+  {
+    WorldGeneratorOptions options;
+    options.modelCount = count;
+    sdf::Root root;
+    loadWorld(options, root);
+    EXPECT_EQ(static_cast<uint64_t>(count),
+              root.WorldByIndex(0)->ModelCount());
+  }
+}
+
+/////////////////////////////////////////////////
+TEST(Scale, LinksPerModel_performance)
+{
+  for (int count : {10, 100, 1000})
+  {
+    WorldGeneratorOptions options;
+    options.linksPerModel = count;
+    sdf::Root root;
+    loadWorld(options, root);
+    const sdf::Model *model = root.WorldByIndex(0)->ModelByIndex(0);
+    ASSERT_NE(nullptr, model);
+    EXPECT_EQ(static_cast<uint64_t>(count), model->LinkCount());
+    EXPECT_EQ(static_cast<uint64_t>(count - 1), model->JointCount());
+  }
+}
+
+/////////////////////////////////////////////////
+TEST(Scale, NestingDepth_performance)
+{
+  for (int depth : {10, 100})
+  {
+    WorldGeneratorOptions options;
+    options.linksPerModel = 2;
+    options.nestingDepth = depth;
+    sdf::Root root;
+    loadWorld(options, root);
+    const sdf::Model *model = root.WorldByIndex(0)->ModelByIndex(0);
+    int levels = 0;
+    while (model && model->ModelCount() > 0)
+    {
+      model = model->ModelByIndex(0);
+      ++levels;
+    }
+    EXPECT_EQ(depth, levels);
+  }
+}
+
+/////////////////////////////////////////////////
+TEST(Scale, FrameChainDepth_performance)
+{
+  for (int depth : {10, 100, 1000})
+  {
+    WorldGeneratorOptions options;
+    options.frameChainDepth = depth;
+    sdf::Root root;
+    loadWorld(options, root);
+    const sdf::Model *model = root.WorldByIndex(0)->ModelByIndex(0);
+    ASSERT_NE(nullptr, model);
+    EXPECT_EQ(static_cast<uint64_t>(depth), model->FrameCount());
+  }
+}
+
+/////////////////////////////////////////////////
+TEST(Scale, IncludeFanout_performance)
+{
+  for (int fanout : {10, 100})
+  {
+    WorldGeneratorOptions options;
+    options.modelCount = 0;
+    options.linksPerModel = 2;
+    options.includeFanout = fanout;
+    options.includeDirectory = sdf::filesystem::append(PROJECT_BINARY_DIR,
+        "scale_includes_" + std::to_string(fanout));
+    ASSERT_TRUE(writeIncludeModels(options));
+
+    sdf::Root root;
+    loadWorld(options, root);
+    EXPECT_EQ(static_cast<uint64_t>(fanout),
+              root.WorldByIndex(0)->ModelCount());
+    EXPECT_TRUE(root.WorldByIndex(0)->ModelNameExists("included0"));
+  }
+}
+
+/////////////////////////////////////////////////
+TEST(Scale, Urdf_performance)
+{
+  for (int count : {10, 100, 1000})
+  {
+    sdf::Root root;
+    EXPECT_TRUE(root.LoadSdfString(generateUrdf(count)).empty());
+    ASSERT_EQ(1u, root.ModelCount());
+    EXPECT_EQ(static_cast<uint64_t>(count),
+              root.ModelByIndex(0)->LinkCount());
+
+    // Fixed joints are lumped into the first link.
+    sdf::Root lumped;
+    EXPECT_TRUE(lumped.LoadSdfString(generateUrdf(count, true)).empty());
+    ASSERT_EQ(1u, lumped.ModelCount());
+    EXPECT_EQ(1u, lumped.ModelByIndex(0)->LinkCount());
+  }
+}
@@ -0,0 +1,247 @@
+/*
+ * Copyright 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "sdf/Link.hh"
+#include "sdf/Model.hh"
+#include "sdf/ParserConfig.hh"
+#include "sdf/Root.hh"
+#include "sdf/SemanticPose.hh"
+#include "sdf/World.hh"
+
+#include "world_generator.hh"
+
+// Each test measures the throughput of a parallel stage or of concurrent
+// calls at 1 to N threads, N being the number of hardware threads, and
+// prints the speedup over 1 thread. A speedup that stays near 1 as threads
+// are added points to contention, such as a global lock.
+
+/////////////////////////////////////////////////
+/// \brief Get the thread counts measured: the powers of 2 below the number
+/// of hardware threads, and that number.
+/// \return The thread counts, from 1.
+std::vector<unsigned int> threadCounts()
+{
+  const unsigned int maxThreads =
+      std::max(2u, std::thread::hardware_concurrency());
+  std::vector<unsigned int> counts;
+  for (unsigned int count = 1; count < maxThreads; count *= 2)
+    counts.push_back(count);
+  counts.push_back(maxThreads);
+  return counts;
+}
+
+/////////////////////////////////////////////////
+/// \brief Run a function on several threads at once, and measure the
+/// throughput of its calls.
+/// \param[in] _threads Number of threads.
+/// \param[in] _callsPerThread Number of calls of each thread.
+/// \param[in] _func Function called with the index of the thread and of
+/// the call. It returns the number of failures.
+/// \param[out] _failures Incremented by the failures of the calls.
+/// \return Calls per second, over all the threads.
+double measureCalls(unsigned int _threads, int _callsPerThread,
+    const std::function<int(unsigned int, int)> &_func,
+    std::atomic<int> &_failures)
+{
+  std::vector<std::thread> threads;
+  const auto start = std::chrono::steady_clock::now();
+  for (unsigned int t = 0; t < _threads; ++t)
+  {
+    threads.emplace_back([&, t]()
+    {
+      for (int i = 0; i < _callsPerThread; ++i)
+        _failures += _func(t, i);
+    });
+  }
+  for (auto &thread : threads)
+    thread.join();
+  const std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+  return _threads * _callsPerThread / elapsed.count();
+}
+
+/////////////////////////////////////////////////
+/// \brief Print the speedup curve of a benchmark, and record the speedup
+/// at the largest thread count as a property of the test.
+/// \param[in] _name Name of the benchmark.
+/// \param[in] _unit Unit of the throughput, such as "loads/s".
+/// \param[in] _counts The thread counts.
+/// \param[in] _throughputs The throughput at each thread count.
+void printSpeedups(const std::string &_name, const std::string &_unit,
+                   const std::vector<unsigned int> &_counts,
+                   const std::vector<double> &_throughputs)
+{
+  std::cout << _name << ":\n";
+  for (std::size_t i = 0; i < _counts.size(); ++i)
+  {
+    std::cout << "  " << std::setw(3) << _counts[i] << " threads: "
+              << std::setw(10) << std::fixed << std::setprecision(1)
+              << _throughputs[i] << " " << _unit << ", speedup "
+              << std::setprecision(2) << _throughputs[i] / _throughputs[0]
+              << "\n";
+  }
+  ::testing::Test::RecordProperty("speedup_percent", static_cast<int>(
+      100 * _throughputs.back() / _throughputs.front()));
+}
+
+/////////////////////////////////////////////////
+/// Independent roots loaded from as many threads, which share nothing
+/// but the library, such as the cached schema and findFile.
+TEST(ThreadScaling, IndependentLoads_performance)
+{
+  WorldGeneratorOptions options;
+  options.modelCount = 20;
+  options.linksPerModel = 5;
+  const std::string world = generateWorld(options);
+  const int loadsPerThread = 20;
+
+  std::atomic<int> failures{0};
+  auto load = [&](unsigned int, int)
+  {
+    sdf::Root root;
+    return root.LoadSdfString(world).empty() && root.WorldCount() == 1u ?
+        0 : 1;
+  };
+
+  const std::vector<unsigned int> counts = threadCounts();
+  std::vector<double> throughputs;
+  for (unsigned int count : counts)
+    throughputs.push_back(measureCalls(count, loadsPerThread, load, failures));
+  EXPECT_EQ(0, failures);
+  printSpeedups("Independent Root::Load", "loads/s", counts, throughputs);
+}
+
+/////////////////////////////////////////////////
+/// One large world loaded with the parallel stages of the parser, each
+/// set to the thread count.
+TEST(ThreadScaling, LargeWorldLoad_performance)
+{
+  WorldGeneratorOptions options;
+  options.modelCount = 2000;
+  options.linksPerModel = 3;
+  const std::string world = generateWorld(options);
+
+  const std::vector<unsigned int> counts = threadCounts();
+  std::vector<double> throughputs;
+  for (unsigned int count : counts)
+  {
+    sdf::ParserConfig config;
+    config.SetReadThreadCount(count);
+    config.SetModelLoadThreadCount(count);
+
+    // The best of a few loads, since a single load is short and noisy.
+    double best = 0;
+    for (int run = 0; run < 3; ++run)
+    {
+      sdf::Root root;
+      const auto start = std::chrono::steady_clock::now();
+      const sdf::Errors errors = root.LoadSdfString(world, config);
+      const std::chrono::duration<double> elapsed =
+          std::chrono::steady_clock::now() - start;
+      EXPECT_TRUE(errors.empty());
+      ASSERT_EQ(1u, root.WorldCount());
+      EXPECT_EQ(static_cast<uint64_t>(options.modelCount),
+                root.WorldByIndex(0)->ModelCount());
+      best = std::max(best, 1 / elapsed.count());
+    }
+    throughputs.push_back(best);
+  }
+  printSpeedups("Parallel load of one world with 2000 models", "loads/s",
+                counts, throughputs);
+}
+
+/////////////////////////////////////////////////
+/// URDF robots converted from as many threads.
+TEST(ThreadScaling, UrdfConversion_performance)
+{
+  const std::string urdf = generateUrdf(100);
+  const int conversionsPerThread = 10;
+
+  std::atomic<int> failures{0};
+  auto convert = [&](unsigned int, int)
+  {
+    sdf::Root root;
+    return root.LoadSdfString(urdf).empty() && root.ModelCount() == 1u ?
+        0 : 1;
+  };
+
+  const std::vector<unsigned int> counts = threadCounts();
+  std::vector<double> throughputs;
+  for (unsigned int count : counts)
+  {
+    throughputs.push_back(
+        measureCalls(count, conversionsPerThread, convert, failures));
+  }
+  EXPECT_EQ(0, failures);
+  printSpeedups("URDF conversion", "conversions/s", counts, throughputs);
+}
+
+/////////////////////////////////////////////////
+/// Poses of the links of a shared root resolved from as many threads.
+TEST(ThreadScaling, PoseQueries_performance)
+{
+  WorldGeneratorOptions options;
+  options.modelCount = 200;
+  options.linksPerModel = 10;
+  sdf::Root root;
+  ASSERT_TRUE(root.LoadSdfString(generateWorld(options)).empty());
+  const sdf::World *world = root.WorldByIndex(0);
+  ASSERT_NE(nullptr, world);
+
+  // Each call resolves the pose of the last link of every model relative
+  // to its first link, starting from a model that depends on the thread.
+  const int queriesPerThread = 20;
+  std::atomic<int> failures{0};
+  auto query = [&](unsigned int _thread, int)
+  {
+    int queryFailures = 0;
+    ignition::math::Pose3d pose;
+    for (int i = 0; i < options.modelCount; ++i)
+    {
+      const sdf::Model *model = world->ModelByIndex(
+          (_thread * 17 + i) % options.modelCount);
+      const sdf::Link *link =
+          model ? model->LinkByIndex(options.linksPerModel - 1) : nullptr;
+      if (!link || !link->SemanticPose().Resolve(pose, "link0").empty())
+        ++queryFailures;
+    }
+    return queryFailures;
+  };
+
+  const std::vector<unsigned int> counts = threadCounts();
+  std::vector<double> throughputs;
+  for (unsigned int count : counts)
+  {
+    throughputs.push_back(
+        measureCalls(count, queriesPerThread, query, failures));
+  }
+  EXPECT_EQ(0, failures);
+  printSpeedups("Pose queries on a shared root", "calls/s", counts,
+                throughputs);
+}
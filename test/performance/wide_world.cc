@@ -0,0 +1,165 @@
+/*
+ * Copyright 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <sstream>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "sdf/sdf.hh"
+
+/////////////////////////////////////////////////
+/// \brief Generate a world with many models.
+/// \param[in] _modelCount Number of models in the world.
+/// \return The SDF string of the world.
+std::string wideWorld(int _modelCount)
+{
+  std::ostringstream stream;
+  stream << "<sdf version='" << SDF_VERSION << "'>"
+         << "<world name='default'>";
+  for (int i = 0; i < _modelCount; ++i)
+  {
+    stream << "<model name='model" << i << "'>"
+           << "<pose>" << i << " 0 0 0 0 0</pose>"
+           << "<link name='link'>"
+           << "<collision name='collision'>"
+           << "<geometry><box><size>1 1 1</size></box></geometry>"
+           << "</collision>"
+           << "<visual name='visual'>"
+           << "<geometry><box><size>1 1 1</size></box></geometry>"
+           << "</visual>"
+           << "</link>"
+           << "</model>";
+  }
+  stream << "</world></sdf>";
+  return stream.str();
+}
+
+/////////////////////////////////////////////////
+TEST(WideWorld, Load5000Models_performance)
+{
+  const int modelCount = 5000;
+  sdf::Root root;
+  sdf::Errors errors = root.LoadSdfString(wideWorld(modelCount));
+  EXPECT_TRUE(errors.empty());
+
+  ASSERT_EQ(1u, root.WorldCount());
+  const sdf::World *world = root.WorldByIndex(0);
+  ASSERT_NE(nullptr, world);
+  EXPECT_EQ(static_cast<uint64_t>(modelCount), world->ModelCount());
+  EXPECT_TRUE(world->ModelNameExists("model0"));
+  EXPECT_TRUE(world->ModelNameExists("model4999"));
+}
+
+/////////////////////////////////////////////////
+TEST(WideWorld, ElementLookup5000Models_performance)
+{
+  const int modelCount = 5000;
+  sdf::SDFPtr sdfParsed(new sdf::SDF());
+  sdf::init(sdfParsed);
+  ASSERT_TRUE(sdf::readString(wideWorld(modelCount), sdfParsed));
+
+  sdf::ElementPtr world = sdfParsed->Root()->GetElement("world");
+  ASSERT_NE(nullptr, world);
+
+  // Look up children of the wide world element as the DOM loaders do.
+  for (int i = 0; i < modelCount; ++i)
+  {
+    EXPECT_TRUE(world->HasElement("model"));
+    EXPECT_FALSE(world->HasElement("road"));
+    EXPECT_NE(nullptr, world->GetElementImpl("gravity"));
+    EXPECT_NE(nullptr, world->GetElementDescription("light"));
+  }
+}
+
+/////////////////////////////////////////////////
+TEST(WideWorld, Load5000ModelsThreads_performance)
+{
+  const int modelCount = 5000;
+  sdf::SDFPtr sdfParsed(new sdf::SDF());
+  sdf::init(sdfParsed);
+  ASSERT_TRUE(sdf::readString(wideWorld(modelCount), sdfParsed));
+
+  sdf::ParserConfig config;
+  config.SetModelLoadThreadCount(0);
+  sdf::Root root;
+  sdf::Errors errors = root.Load(sdfParsed, config);
+  EXPECT_TRUE(errors.empty());
+
+  ASSERT_EQ(1u, root.WorldCount());
+  const sdf::World *world = root.WorldByIndex(0);
+  ASSERT_NE(nullptr, world);
+  ASSERT_EQ(static_cast<uint64_t>(modelCount), world->ModelCount());
+  for (int i = 0; i < modelCount; ++i)
+  {
+    EXPECT_EQ("model" + std::to_string(i), world->ModelByIndex(i)->Name());
+  }
+}
+
+/////////////////////////////////////////////////
+TEST(WideWorld, UniqueChildNames5000Models_performance)
+{
+  const int modelCount = 5000;
+  sdf::SDFPtr sdfParsed(new sdf::SDF());
+  sdf::init(sdfParsed);
+  ASSERT_TRUE(sdf::readString(wideWorld(modelCount), sdfParsed));
+
+  sdf::ElementPtr world = sdfParsed->Root()->GetElement("world");
+  ASSERT_NE(nullptr, world);
+  EXPECT_TRUE(world->HasUniqueChildNames());
+  EXPECT_TRUE(world->HasUniqueChildNames("model"));
+  EXPECT_EQ(static_cast<std::size_t>(modelCount),
+            world->CountNamedElements("model").size());
+
+  // A duplicate at the end is reported once by Load.
+  sdf::ElementPtr duplicate = world->AddElement("model");
+  duplicate->GetAttribute("name")->Set<std::string>("model0");
+  EXPECT_FALSE(world->HasUniqueChildNames("model"));
+  EXPECT_EQ(2u, world->CountNamedElements("model")["model0"]);
+
+  sdf::Root root;
+  sdf::Errors errors = root.Load(sdfParsed);
+  ASSERT_FALSE(errors.empty());
+  EXPECT_EQ(sdf::ErrorCode::DUPLICATE_NAME, errors[0].Code());
+}
+
+/////////////////////////////////////////////////
+TEST(WideWorld, ModelByName5000Models_performance)
+{
+  const int modelCount = 5000;
+  sdf::Root root;
+  EXPECT_TRUE(root.LoadSdfString(wideWorld(modelCount)).empty());
+
+  const sdf::World *world = root.WorldByIndex(0);
+  ASSERT_NE(nullptr, world);
+
+  // Look up every model and its children by name, as controllers do while
+  // setting up.
+  for (int i = 0; i < modelCount; ++i)
+  {
+    const std::string name = "model" + std::to_string(i);
+    EXPECT_TRUE(world->ModelNameExists(name));
+    const sdf::Model *model = world->ModelByName(name);
+    ASSERT_NE(nullptr, model);
+    EXPECT_EQ(name, model->Name());
+    const sdf::Link *link = model->LinkByName("link");
+    ASSERT_NE(nullptr, link);
+    EXPECT_NE(nullptr, link->VisualByName("visual"));
+    EXPECT_NE(nullptr, link->CollisionByName("collision"));
+  }
+  EXPECT_FALSE(world->ModelNameExists("model" + std::to_string(modelCount)));
+}
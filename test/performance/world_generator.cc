@@ -0,0 +1,199 @@
+/*
+ * Copyright 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include "sdf/Filesystem.hh"
+#include "sdf/sdf_config.h"
+
+#include "world_generator.hh"
+
+/////////////////////////////////////////////////
+/// \brief Write a model, and its nested models.
+/// \param[in,out] _stream Stream to write to.
+/// \param[in] _options Parameters of the model.
+/// \param[in] _name Name of the model.
+/// \param[in] _depth Nesting level of the model, 0 for the outermost one.
+/// \param[in] _x Position of the model along the x axis.
+static void writeModel(std::ostream &_stream,
+    const WorldGeneratorOptions &_options, const std::string &_name,
+    int _depth, int _x)
+{
+  _stream << "<model name='" << _name << "'>"
+          << "<pose>" << _x << " 0 0 0 0 0</pose>";
+
+  for (int i = 0; i < _options.linksPerModel; ++i)
+  {
+    _stream << "<link name='link" << i << "'>"
+            << "<pose>0 0 " << i << " 0 0 0</pose>"
+            << "<inertial><mass>1</mass></inertial>"
+            << "<collision name='collision'>"
+            << "<geometry><box><size>1 1 1</size></box></geometry>"
+            << "</collision>"
+            << "<visual name='visual'>"
+            << "<geometry><box><size>1 1 1</size></box></geometry>"
+            << "</visual>"
+            << "</link>";
+  }
+
+  for (int i = 1; i < _options.linksPerModel; ++i)
+  {
+    _stream << "<joint name='joint" << i << "' type='revolute'>"
+            << "<parent>link" << i - 1 << "</parent>"
+            << "<child>link" << i << "</child>"
+            << "<axis><xyz>0 0 1</xyz></axis>"
+            << "</joint>";
+  }
+
+  for (int i = 0; i < _options.frameChainDepth; ++i)
+  {
+    const std::string parent =
+        i == 0 ? "link0" : "frame" + std::to_string(i - 1);
+    _stream << "<frame name='frame" << i << "' attached_to='" << parent
+            << "'>"
+            << "<pose relative_to='" << parent << "'>0 0 1 0 0 0</pose>"
+            << "</frame>";
+  }
+
+  if (_depth < _options.nestingDepth)
+    writeModel(_stream, _options, "nested", _depth + 1, 0);
+
+  _stream << "</model>";
+}
+
+/////////////////////////////////////////////////
+std::string generateWorld(const WorldGeneratorOptions &_options)
+{
+  std::ostringstream stream;
+  stream << "<sdf version='" << SDF_VERSION << "'>"
+         << "<world name='default'>";
+
+  // Models are placed in a row, so that they do not overlap.
+  for (int i = 0; i < _options.modelCount; ++i)
+    writeModel(stream, _options, "model" + std::to_string(i), 0, i * 2);
+
+  for (int i = 0; i < _options.includeFanout; ++i)
+  {
+    stream << "<include>"
+           << "<uri>" << includeModelPath(_options, i) << "</uri>"
+           << "<name>included" << i << "</name>"
+           << "<pose>" << i * 2 << " 10 0 0 0 0</pose>"
+           << "</include>";
+  }
+
+  stream << "</world></sdf>";
+  return stream.str();
+}
+
+/////////////////////////////////////////////////
+std::string generateModel(const WorldGeneratorOptions &_options,
+                          const std::string &_name)
+{
+  std::ostringstream stream;
+  stream << "<sdf version='" << SDF_VERSION << "'>";
+  writeModel(stream, _options, _name, 0, 0);
+  stream << "</sdf>";
+  return stream.str();
+}
+
+/////////////////////////////////////////////////
+std::string generateUrdf(int _linkCount, bool _fixedJoints)
+{
+  std::ostringstream stream;
+  stream << "<robot name='robot'>";
+
+  for (int i = 0; i < _linkCount; ++i)
+  {
+    stream << "<link name='link" << i << "'>"
+           << "<inertial>"
+           << "<mass value='1'/>"
+           << "<inertia ixx='1' ixy='0' ixz='0' iyy='1' iyz='0' izz='1'/>"
+           << "</inertial>"
+           << "<collision>"
+           << "<geometry><box size='1 1 1'/></geometry>"
+           << "</collision>"
+           << "<visual>"
+           << "<geometry><box size='1 1 1'/></geometry>"
+           << "</visual>"
+           << "</link>";
+  }
+
+  for (int i = 1; i < _linkCount; ++i)
+  {
+    stream << "<joint name='joint" << i << "' type='"
+           << (_fixedJoints ? "fixed" : "revolute") << "'>"
+           << "<parent link='link" << i - 1 << "'/>"
+           << "<child link='link" << i << "'/>"
+           << "<origin xyz='0 0 1' rpy='0 0 0'/>";
+    if (!_fixedJoints)
+    {
+      stream << "<axis xyz='0 0 1'/>"
+             << "<limit lower='-1' upper='1' effort='10' velocity='1'/>";
+    }
+    stream << "</joint>";
+  }
+
+  stream << "</robot>";
+  return stream.str();
+}
+
+/////////////////////////////////////////////////
+std::string includeModelPath(const WorldGeneratorOptions &_options,
+                             int _index)
+{
+  return sdf::filesystem::append(_options.includeDirectory,
+      "model" + std::to_string(_index));
+}
+
+/////////////////////////////////////////////////
+bool writeIncludeModels(const WorldGeneratorOptions &_options)
+{
+  if (_options.includeFanout <= 0)
+    return true;
+
+  if (!sdf::filesystem::exists(_options.includeDirectory) &&
+      !sdf::filesystem::create_directory(_options.includeDirectory))
+  {
+    return false;
+  }
+
+  for (int i = 0; i < _options.includeFanout; ++i)
+  {
+    const std::string modelPath = includeModelPath(_options, i);
+    if (!sdf::filesystem::exists(modelPath) &&
+        !sdf::filesystem::create_directory(modelPath))
+    {
+      return false;
+    }
+
+    std::ofstream config(sdf::filesystem::append(modelPath, "model.config"));
+    config << "<?xml version='1.0'?>"
+           << "<model>"
+           << "<name>model" << i << "</name>"
+           << "<sdf version='" << SDF_VERSION << "'>model.sdf</sdf>"
+           << "</model>";
+
+    std::ofstream model(sdf::filesystem::append(modelPath, "model.sdf"));
+    model << generateModel(_options, "model" + std::to_string(i));
+
+    if (!config || !model)
+      return false;
+  }
+  return true;
+}
@@ -0,0 +1,84 @@
+/*
+ * Copyright 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef SDF_TEST_WORLD_GENERATOR_HH_
+#define SDF_TEST_WORLD_GENERATOR_HH_
+
+#include <string>
+
+/// \brief Parameters of a generated world. Every generated document is
+/// valid, so that loading it exercises the whole parser and its checks.
+struct WorldGeneratorOptions
+{
+  /// \brief Number of models in the world.
+  int modelCount = 1;
+
+  /// \brief Number of links of each model. The links are a chain, each
+  /// attached to the previous one by a revolute joint.
+  int linksPerModel = 1;
+
+  /// \brief Number of levels of nested models in each model. Each level
+  /// has the links of linksPerModel.
+  int nestingDepth = 0;
+
+  /// \brief Number of frames of each model. Each frame is attached to,
+  /// and has its pose relative to, the previous one, the first being
+  /// attached to the first link.
+  int frameChainDepth = 0;
+
+  /// \brief Number of models included by the world, each from its own
+  /// model directory written by writeIncludeModels. Every included model
+  /// is generated with the other options.
+  int includeFanout = 0;
+
+  /// \brief Directory of the included model directories.
+  std::string includeDirectory;
+};
+
+/// \brief Generate an SDF world.
+/// \param[in] _options Parameters of the world.
+/// \return The SDF string of the world.
+std::string generateWorld(const WorldGeneratorOptions &_options);
+
+/// \brief Generate an SDF file with one model.
+/// \param[in] _options Parameters of the model. modelCount and
+/// includeFanout are not used.
+/// \param[in] _name Name of the model.
+/// \return The SDF string of the model.
+std::string generateModel(const WorldGeneratorOptions &_options,
+                          const std::string &_name);
+
+/// \brief Generate a URDF robot whose links form a chain.
+/// \param[in] _linkCount Number of links.
+/// \param[in] _fixedJoints True to attach the links with fixed joints,
+/// which the converter lumps together, instead of revolute joints.
+/// \return The URDF string of the robot.
+std::string generateUrdf(int _linkCount, bool _fixedJoints = false);
+
+/// \brief Write the model directories included by a world generated with
+/// the same options, each with a model.config and a model.sdf file.
+/// \param[in] _options Parameters of the world.
+/// \return True if every file was written.
+bool writeIncludeModels(const WorldGeneratorOptions &_options);
+
+/// \brief Get the directory of an included model.
+/// \param[in] _options Parameters of the world.
+/// \param[in] _index Index of the include, in [0, includeFanout).
+/// \return Path of the model directory.
+std::string includeModelPath(const WorldGeneratorOptions &_options,
+                             int _index);
+
+#endif